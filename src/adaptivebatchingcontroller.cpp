@@ -0,0 +1,139 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "adaptivebatchingcontroller.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ovms {
+
+// gaps longer than this are idle periods rather than arrival rate
+static constexpr double MAX_SAMPLE_GAP_MICROSECONDS = 1'000'000.0;
+static constexpr double HEADROOM_DECREASE = 0.8;
+static constexpr double HEADROOM_INCREASE = 0.02;
+// headroom grows only while observed p99 is below this part of the SLO
+static constexpr double HEADROOM_GROWTH_THRESHOLD = 0.8;
+
+AdaptiveBatchingController::AdaptiveBatchingController(size_t maxBatchSize, std::chrono::microseconds maxQueueDelay, std::chrono::microseconds latencySlo) :
+    maxBatchSize(std::max<size_t>(maxBatchSize, 1)),
+    maxQueueDelay(maxQueueDelay.count() > 0 ? maxQueueDelay : latencySlo / 2),
+    latencySlo(latencySlo) {
+    latencyWindow.reserve(LATENCY_WINDOW_SIZE);
+}
+
+void AdaptiveBatchingController::recordArrival(size_t batchSize, std::chrono::steady_clock::time_point arrival) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (anyArrival && batchSize > 0) {
+        const double gap = std::min(MAX_SAMPLE_GAP_MICROSECONDS,
+            static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(arrival - lastArrival).count()));
+        const double sampleGap = std::max(gap, 0.0) / batchSize;
+        if (sampleGapMicroseconds == 0.0) {
+            sampleGapMicroseconds = std::max(sampleGap, 1.0);
+        } else {
+            sampleGapMicroseconds = std::max(sampleGapMicroseconds + ARRIVAL_SMOOTHING * (sampleGap - sampleGapMicroseconds), 1.0);
+        }
+    }
+    anyArrival = true;
+    lastArrival = std::max(lastArrival, arrival);
+}
+
+void AdaptiveBatchingController::recordBatch(size_t batchSize, uint64_t inferenceMicroseconds, const std::vector<uint64_t>& requestLatenciesMicroseconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const double x = static_cast<double>(batchSize);
+    const double y = static_cast<double>(inferenceMicroseconds);
+    fitWeight = fitWeight * LATENCY_FIT_DECAY + 1.0;
+    fitSumX = fitSumX * LATENCY_FIT_DECAY + x;
+    fitSumY = fitSumY * LATENCY_FIT_DECAY + y;
+    fitSumXX = fitSumXX * LATENCY_FIT_DECAY + x * x;
+    fitSumXY = fitSumXY * LATENCY_FIT_DECAY + x * y;
+    for (auto latency : requestLatenciesMicroseconds) {
+        if (latencyWindow.size() < LATENCY_WINDOW_SIZE) {
+            latencyWindow.push_back(latency);
+        } else {
+            latencyWindow[latencyWindowNext] = latency;
+        }
+        latencyWindowNext = (latencyWindowNext + 1) % LATENCY_WINDOW_SIZE;
+    }
+    latenciesSinceHeadroomUpdate += requestLatenciesMicroseconds.size();
+    updateHeadroom();
+    updateDecision();
+}
+
+AdaptiveBatchingDecision AdaptiveBatchingController::getDecision() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return decision;
+}
+
+double AdaptiveBatchingController::predictInferenceMicroseconds(size_t batchSize) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return predictInferenceMicrosecondsUnlocked(batchSize);
+}
+
+double AdaptiveBatchingController::predictInferenceMicrosecondsUnlocked(size_t batchSize) const {
+    if (fitWeight == 0.0) {
+        return 0.0;
+    }
+    const double meanX = fitSumX / fitWeight;
+    const double meanY = fitSumY / fitWeight;
+    const double varianceX = fitSumXX / fitWeight - meanX * meanX;
+    if (varianceX < 1e-6) {
+        // a single observed batch size does not tell the fixed cost apart, assuming none overestimates larger batches
+        return meanX > 0.0 ? meanY / meanX * batchSize : meanY;
+    }
+    const double slope = std::max((fitSumXY / fitWeight - meanX * meanY) / varianceX, 0.0);
+    const double intercept = meanY - slope * meanX;
+    return std::max(intercept + slope * batchSize, 0.0);
+}
+
+void AdaptiveBatchingController::updateHeadroom() {
+    if (latenciesSinceHeadroomUpdate < HEADROOM_UPDATE_PERIOD || latencyWindow.size() < HEADROOM_UPDATE_PERIOD) {
+        return;
+    }
+    latenciesSinceHeadroomUpdate = 0;
+    std::vector<uint64_t> sorted(latencyWindow);
+    const size_t index = (sorted.size() * 99 - 1) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    decision.observedP99Microseconds = sorted[index];
+    const auto slo = static_cast<uint64_t>(latencySlo.count());
+    if (decision.observedP99Microseconds > slo) {
+        decision.headroom = std::max(decision.headroom * HEADROOM_DECREASE, MIN_HEADROOM);
+    } else if (decision.observedP99Microseconds < slo * HEADROOM_GROWTH_THRESHOLD) {
+        decision.headroom = std::min(decision.headroom + HEADROOM_INCREASE, 1.0);
+    }
+}
+
+void AdaptiveBatchingController::updateDecision() {
+    decision.arrivalRate = sampleGapMicroseconds > 0.0 ? 1'000'000.0 / sampleGapMicroseconds : 0.0;
+    const double budget = decision.headroom * latencySlo.count();
+    size_t target = 1;
+    double targetGather = 0.0;
+    // without two arrivals there is no rate to gather larger batches at
+    const size_t largestCandidate = sampleGapMicroseconds > 0.0 ? maxBatchSize : 1;
+    for (size_t batchSize = 2; batchSize <= largestCandidate; ++batchSize) {
+        const double gather = (batchSize - 1) * sampleGapMicroseconds;
+        if (gather > maxQueueDelay.count()) {
+            break;
+        }
+        if (gather + 2 * predictInferenceMicrosecondsUnlocked(batchSize) <= budget) {
+            target = batchSize;
+            targetGather = gather;
+        }
+    }
+    decision.targetBatchSize = target;
+    decision.queueDelay = std::chrono::microseconds(static_cast<int64_t>(std::ceil(targetGather)));
+}
+
+}  // namespace ovms
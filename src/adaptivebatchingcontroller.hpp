@@ -0,0 +1,131 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Current choice of adaptive batching controller together with observations it is based on
+ */
+struct AdaptiveBatchingDecision {
+    size_t targetBatchSize = 1;
+    std::chrono::microseconds queueDelay{0};
+    /**
+     * @brief Smoothed rate of arriving samples (batch elements) per second
+     */
+    double arrivalRate = 0.0;
+    /**
+     * @brief p99 latency of the last LATENCY_WINDOW_SIZE requests, from enqueueing into the batcher to the end of inference
+     */
+    uint64_t observedP99Microseconds = 0;
+    /**
+     * @brief Part of the SLO which predicted latency of the target batch may use, lowered while observed p99 exceeds the SLO
+     */
+    double headroom = 1.0;
+};
+
+/**
+ * @brief Picks dynamic batching queue delay and target batch size from observed arrival rate and batch inference latency
+ *
+ * Inference latency is modeled as linear in batch size, fitted with exponentially decayed least squares over executed batches.
+ * The largest batch size whose predicted latency - time to gather it at the current arrival rate and twice its inference,
+ * as the batch may wait for the previous one - fits in headroom * SLO is chosen. Queue delay is the time to gather it.
+ * Headroom is decreased multiplicatively when observed p99 exceeds the SLO and increased slowly while it is well below,
+ * which corrects what the model does not capture, e.g. serialization or contention between streams.
+ *
+ * Methods are safe to call concurrently, they are called once per request or batch.
+ */
+class AdaptiveBatchingController {
+public:
+    static constexpr size_t LATENCY_WINDOW_SIZE = 256;
+    /**
+     * @brief Number of recorded request latencies after which headroom is reconsidered
+     */
+    static constexpr size_t HEADROOM_UPDATE_PERIOD = 64;
+    static constexpr double ARRIVAL_SMOOTHING = 0.05;
+    static constexpr double LATENCY_FIT_DECAY = 0.98;
+    static constexpr double MIN_HEADROOM = 0.1;
+
+    /**
+     * @param maxBatchSize network batch size, the upper bound of target batch size
+     * @param maxQueueDelay upper bound of queue delay, 0 bounds it by half of the SLO
+     * @param latencySlo target p99 latency of requests
+     */
+    AdaptiveBatchingController(size_t maxBatchSize, std::chrono::microseconds maxQueueDelay, std::chrono::microseconds latencySlo);
+
+    /**
+     * @brief Records arrival of a request with given batch size
+     */
+    void recordArrival(size_t batchSize, std::chrono::steady_clock::time_point arrival);
+
+    /**
+     * @brief Records executed batch and latencies of requests it contained, updates the decision
+     *
+     * @param batchSize gathered batch size
+     * @param inferenceMicroseconds duration of the inference of the whole batch
+     * @param requestLatenciesMicroseconds time from enqueueing to the end of inference of each request in the batch
+     */
+    void recordBatch(size_t batchSize, uint64_t inferenceMicroseconds, const std::vector<uint64_t>& requestLatenciesMicroseconds);
+
+    AdaptiveBatchingDecision getDecision() const;
+
+    std::chrono::microseconds getLatencySlo() const {
+        return latencySlo;
+    }
+
+    /**
+     * @brief Predicted inference duration of a batch in microseconds, proportional to the batch size until two different sizes were observed
+     */
+    double predictInferenceMicroseconds(size_t batchSize) const;
+
+private:
+    double predictInferenceMicrosecondsUnlocked(size_t batchSize) const;
+
+    void updateHeadroom();
+
+    void updateDecision();
+
+    const size_t maxBatchSize;
+    const std::chrono::microseconds maxQueueDelay;
+    const std::chrono::microseconds latencySlo;
+
+    mutable std::mutex mutex;
+
+    std::chrono::steady_clock::time_point lastArrival;
+    bool anyArrival = false;
+    // smoothed gap between arriving samples
+    double sampleGapMicroseconds = 0.0;
+
+    // decayed sums of least squares fit of inference latency by batch size
+    double fitWeight = 0.0;
+    double fitSumX = 0.0;
+    double fitSumY = 0.0;
+    double fitSumXX = 0.0;
+    double fitSumXY = 0.0;
+
+    std::vector<uint64_t> latencyWindow;
+    size_t latencyWindowNext = 0;
+    size_t latenciesSinceHeadroomUpdate = 0;
+
+    AdaptiveBatchingDecision decision;
+};
+
+}  // namespace ovms
@@ -0,0 +1,73 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "adminauthorization.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+namespace {
+const std::string_view BEARER_PREFIX = "Bearer ";
+const char* const WHITESPACE = " \t\r\n";
+
+/**
+ * @brief Takes the same time for any mismatch position, so the token cannot be guessed byte by byte
+ */
+bool constantTimeEquals(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    unsigned char difference = 0;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        difference |= static_cast<unsigned char>(lhs[i] ^ rhs[i]);
+    }
+    return difference == 0;
+}
+}  // namespace
+
+Status AdminAuthorization::loadTokenFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Cannot open admin token file: {}", path);
+        return StatusCode::FILE_INVALID;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const auto begin = content.find_first_not_of(WHITESPACE);
+    if (begin == std::string::npos) {
+        SPDLOG_ERROR("Admin token file is empty: {}", path);
+        return StatusCode::FILE_INVALID;
+    }
+    configure(content.substr(begin, content.find_last_not_of(WHITESPACE) - begin + 1));
+    SPDLOG_INFO("Admin API enabled with token from: {}", path);
+    return StatusCode::OK;
+}
+
+Status AdminAuthorization::authorize(std::string_view authorizationHeader) const {
+    if (!isEnabled()) {
+        return StatusCode::ADMIN_API_DISABLED;
+    }
+    if (authorizationHeader.substr(0, BEARER_PREFIX.size()) != BEARER_PREFIX ||
+        !constantTimeEquals(authorizationHeader.substr(BEARER_PREFIX.size()), token)) {
+        SPDLOG_WARN("Rejected admin request with invalid token");
+        return StatusCode::ADMIN_UNAUTHORIZED;
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
@@ -0,0 +1,71 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Guards admin REST endpoints, like CPU profiling, with a bearer token read from a file.
+ * Admin endpoints are disabled until the token is configured.
+ */
+class AdminAuthorization {
+public:
+    static AdminAuthorization& instance() {
+        static AdminAuthorization instance;
+        return instance;
+    }
+
+    AdminAuthorization() = default;
+
+    AdminAuthorization(const AdminAuthorization&) = delete;
+    AdminAuthorization& operator=(const AdminAuthorization&) = delete;
+
+    /**
+     * @brief Reads the token from the file, surrounding whitespace is ignored
+     *
+     * @return Status FILE_INVALID when the file cannot be read or holds no token
+     */
+    Status loadTokenFile(const std::string& path);
+
+    /**
+     * @brief Sets the token, empty token disables admin endpoints
+     */
+    void configure(std::string token) {
+        this->token = std::move(token);
+    }
+
+    bool isEnabled() const {
+        return !token.empty();
+    }
+
+    /**
+     * @brief Checks value of Authorization header, which has to be "Bearer <token>"
+     *
+     * @return Status ADMIN_API_DISABLED when no token is configured, ADMIN_UNAUTHORIZED when the header does not match
+     */
+    Status authorize(std::string_view authorizationHeader) const;
+
+private:
+    std::string token;
+};
+
+}  // namespace ovms
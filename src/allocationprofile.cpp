@@ -0,0 +1,182 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "allocationprofile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace ovms {
+
+namespace {
+constexpr size_t SHARDS_COUNT = 32;
+
+// plain relaxed counters, constant initialized so allocations made before static initialization are counted too
+struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, ALLOCATION_PHASES_COUNT> entries;
+    std::array<std::atomic<uint64_t>, ALLOCATION_PHASES_COUNT> allocations;
+    std::array<std::atomic<uint64_t>, ALLOCATION_PHASES_COUNT> bytes;
+};
+
+Shard shards[SHARDS_COUNT];
+std::atomic<size_t> nextShard{0};
+
+Shard& threadShard() {
+    thread_local const size_t index = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS_COUNT;
+    return shards[index];
+}
+}  // namespace
+
+thread_local AllocationPhase AllocationProfile::currentPhase = AllocationPhase::OTHER;
+
+const char* toString(AllocationPhase phase) {
+    switch (phase) {
+    case AllocationPhase::OTHER:
+        return "other";
+    case AllocationPhase::PARSE:
+        return "parse";
+    case AllocationPhase::VALIDATE:
+        return "validate";
+    case AllocationPhase::DESERIALIZE:
+        return "deserialize";
+    case AllocationPhase::INFER:
+        return "infer";
+    case AllocationPhase::SERIALIZE:
+        return "serialize";
+    case AllocationPhase::PIPELINE_ORCHESTRATION:
+        return "pipeline_orchestration";
+    default:
+        return "unknown";
+    }
+}
+
+AllocationProfile::Counters AllocationProfile::get(AllocationPhase phase) {
+    const size_t index = static_cast<size_t>(phase);
+    Counters counters;
+    for (const auto& shard : shards) {
+        counters.entries += shard.entries[index].load(std::memory_order_relaxed);
+        counters.allocations += shard.allocations[index].load(std::memory_order_relaxed);
+        counters.bytes += shard.bytes[index].load(std::memory_order_relaxed);
+    }
+    return counters;
+}
+
+void AllocationProfile::countEntry(AllocationPhase phase) {
+    threadShard().entries[static_cast<size_t>(phase)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationProfile::recordAllocation(size_t bytes) {
+    const size_t index = static_cast<size_t>(currentPhase);
+    auto& shard = threadShard();
+    shard.allocations[index].fetch_add(1, std::memory_order_relaxed);
+    shard.bytes[index].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+}  // namespace ovms
+
+#ifdef OVMS_ALLOCATION_PROFILING
+namespace {
+void* allocate(std::size_t size) {
+    ovms::AllocationProfile::recordAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        void* pointer = std::malloc(size);
+        if (pointer) {
+            return pointer;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    ovms::AllocationProfile::recordAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        void* pointer = nullptr;
+        if (posix_memalign(&pointer, std::max(static_cast<std::size_t>(alignment), sizeof(void*)), size) == 0) {
+            return pointer;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+}  // namespace
+
+// memory of all the variants is released with free
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+#endif
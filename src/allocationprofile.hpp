@@ -0,0 +1,123 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ovms {
+
+/**
+ * @brief Request handling phases heap allocations are attributed to, allocations outside of them are counted as other
+ */
+enum class AllocationPhase {
+    OTHER,
+    PARSE,
+    VALIDATE,
+    DESERIALIZE,
+    INFER,
+    SERIALIZE,
+    PIPELINE_ORCHESTRATION,
+    COUNT
+};
+
+constexpr size_t ALLOCATION_PHASES_COUNT = static_cast<size_t>(AllocationPhase::COUNT);
+
+const char* toString(AllocationPhase phase);
+
+/**
+ * @brief Counts heap allocations and allocated bytes per request handling phase
+ *
+ * Enabled at build time with OVMS_ALLOCATION_PROFILING, which replaces global operator new so every allocation
+ * is attributed to the phase the allocating thread is in. Counters are sharded between threads to avoid contention.
+ * Allocations done directly with malloc, including the ones inside OpenVINO plugins, are not counted.
+ * Without the define phase guards compile to nothing.
+ */
+class AllocationProfile {
+public:
+#ifdef OVMS_ALLOCATION_PROFILING
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    struct Counters {
+        // number of times the phase was entered, which is once per request for most phases
+        uint64_t entries = 0;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+    };
+
+    /**
+     * @brief Sums counters of all threads, values are zero unless profiling is enabled
+     */
+    static Counters get(AllocationPhase phase);
+
+    /**
+     * @brief Switches calling thread to the phase
+     *
+     * @return phase to be restored with leave
+     */
+    static AllocationPhase enter(AllocationPhase phase) {
+#ifdef OVMS_ALLOCATION_PROFILING
+        const AllocationPhase previous = currentPhase;
+        if (previous != phase) {
+            countEntry(phase);
+            currentPhase = phase;
+        }
+        return previous;
+#else
+        return phase;
+#endif
+    }
+
+    static void leave(AllocationPhase previous) {
+#ifdef OVMS_ALLOCATION_PROFILING
+        currentPhase = previous;
+#endif
+    }
+
+    /**
+     * @brief Counts allocation in the current phase of calling thread, called by replaced global operator new
+     */
+    static void recordAllocation(size_t bytes);
+
+private:
+    static void countEntry(AllocationPhase phase);
+
+    static thread_local AllocationPhase currentPhase;
+};
+
+/**
+ * @brief Attributes allocations of the calling thread to the phase until destruction, nested guards restore outer phase
+ */
+class AllocationPhaseGuard {
+public:
+    explicit AllocationPhaseGuard(AllocationPhase phase) :
+        previous(AllocationProfile::enter(phase)) {}
+
+    ~AllocationPhaseGuard() {
+        AllocationProfile::leave(previous);
+    }
+
+    AllocationPhaseGuard(const AllocationPhaseGuard&) = delete;
+    AllocationPhaseGuard& operator=(const AllocationPhaseGuard&) = delete;
+
+private:
+    const AllocationPhase previous;
+};
+
+}  // namespace ovms
@@ -0,0 +1,355 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "async_prediction_service.hpp"
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <google/protobuf/arena.h>
+#include <grpcpp/impl/codegen/proto_utils.h>
+#include <grpcpp/server_context.h>
+#include <spdlog/spdlog.h>
+
+#include "compression.hpp"
+#include "deadline.hpp"
+#include "get_model_metadata_impl.hpp"
+#include "hotpathtimings.hpp"
+#include "inplacerequestparser.hpp"
+#include "logging.hpp"
+#include "modelinstanceunloadguard.hpp"
+#include "model_service.hpp"
+#include "modelmanager.hpp"
+#include "pipeline.hpp"
+#include "pipelinescheduler.hpp"
+#include "prediction_service_utils.hpp"
+#include "requesttimings.hpp"
+#include "samplingprofiler.hpp"
+#include "saturation.hpp"
+#include "status.hpp"
+#include "tracing.hpp"
+#include "trafficcapture.hpp"
+
+using tensorflow::serving::GetModelMetadataRequest;
+using tensorflow::serving::GetModelMetadataResponse;
+using tensorflow::serving::GetModelStatusRequest;
+using tensorflow::serving::GetModelStatusResponse;
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+namespace ovms {
+
+namespace {
+/**
+ * @brief State of a single call, used as completion queue tag
+ */
+class CallData {
+public:
+    virtual ~CallData() = default;
+
+    /**
+     * @brief Advances the call after its completion queue event
+     *
+     * @param ok false when the event failed, e.g. server is shutting down
+     */
+    virtual void proceed(bool ok) = 0;
+};
+
+/**
+ * @brief State of a single Predict call. Object deletes itself when call is done.
+ */
+class PredictCallData : public CallData {
+public:
+    PredictCallData(AsyncPredictionServiceImpl& service, grpc::ServerCompletionQueue* completionQueue, PipelineScheduler& pipelineScheduler, bool zeroCopyInputs) :
+        service(service),
+        completionQueue(completionQueue),
+        pipelineScheduler(pipelineScheduler),
+        zeroCopyInputs(zeroCopyInputs),
+        request(google::protobuf::Arena::CreateMessage<PredictRequest>(&arena)),
+        response(google::protobuf::Arena::CreateMessage<PredictResponse>(&arena)),
+        responder(&context) {
+        service.RequestPredict(&context, &requestBuffer, &responder, completionQueue, completionQueue, this);
+    }
+
+    void proceed(bool ok) override {
+        if (state == State::FINISHING || !ok) {
+            // either call is completed or server is shutting down and the call was never started
+            delete this;
+            return;
+        }
+        // keep one call waiting for the client all the time
+        new PredictCallData(service, completionQueue, pipelineScheduler, zeroCopyInputs);
+        state = State::FINISHING;
+        process();
+    }
+
+private:
+    enum class State {
+        WAITING_FOR_CALL,
+        FINISHING
+    };
+
+    Status parseRequest() {
+        // captured requests are serialized again, their tensors have to be stored in the message
+        if (zeroCopyInputs && !TrafficCapture::instance().isEnabled()) {
+            return parsePredictRequestInPlace(requestBuffer, *request, inPlaceTensors);
+        }
+        if (!grpc::SerializationTraits<PredictRequest>::Deserialize(&requestBuffer, request).ok()) {
+            return StatusCode::MALFORMED_REQUEST_MESSAGE;
+        }
+        return StatusCode::OK;
+    }
+
+    void process() {
+        timer.emplace();
+        auto status = parseRequest();
+        if (!status.ok()) {
+            SPDLOG_DEBUG("Parsing async gRPC request failed. {}", status.string());
+            finish(status);
+            return;
+        }
+        OVMS_HOT_PATH_DEBUG("Processing async gRPC request for model: {}; version: {}",
+            request->model_spec().name(),
+            request->model_spec().version().value());
+        if (SaturationMonitor::instance().shouldShedRequest()) {
+            OVMS_HOT_PATH_DEBUG("Shedding async gRPC request, server is saturated");
+            finish(StatusCode::SERVER_SATURATED);
+            return;
+        }
+        networkRequest.emplace();
+        const auto traceContext = Tracer::instance().startRequest(getTraceparent(context));
+        requestSpan = Span("Predict", &traceContext, true);
+        if (requestSpan.isRecording()) {
+            requestSpan.setAttribute("rpc.system", "grpc");
+            requestSpan.setAttribute("rpc.method", "Predict");
+            requestSpan.setAttribute("ovms.model_name", request->model_spec().name());
+        }
+        // asynchronous stages take the context when they are started
+        TraceScope traceScope(requestSpan.getContext());
+        if (isServerTimingRequested(context)) {
+            timings.emplace();
+        }
+        RequestTimingsScope timingsScope(timings ? &*timings : nullptr);
+
+        ModelManager& manager = ModelManager::getInstance();
+        std::shared_ptr<ModelInstance> modelInstance;
+        std::unique_ptr<ModelInstanceUnloadGuard> modelInstanceUnloadGuard;
+        status = getModelInstance(manager, request->model_spec().name(), request->model_spec().version().value(), modelInstance, modelInstanceUnloadGuard);
+
+        if (status == StatusCode::MODEL_NAME_MISSING) {
+            SPDLOG_INFO("Requested model: {} does not exist. Searching for pipeline with that name...", request->model_spec().name());
+            status = getPipeline(manager, pipeline, request, response);
+        }
+        if (!status.ok()) {
+            SPDLOG_INFO("Getting modelInstance or pipeline failed. {}", status.string());
+            finish(status);
+            return;
+        }
+        TrafficCapture::instance().capture(*request, pipeline ? CapturedTarget::PIPELINE : CapturedTarget::MODEL);
+
+        const deadline_t deadline = deadlineFromSystemClock(context.deadline());
+        if (pipeline) {
+            // call is finished by scheduler worker once exit node is done, pipeline is destroyed together with the call
+            pipeline->setDeadline(deadline);
+            pipeline->executeAsync(pipelineScheduler, [this](Status status) { finish(status); });
+            return;
+        }
+        inPlaceTensors.copyConvertedInputs(*request, modelInstance->getInputsInfo());
+        const auto compressionThreshold = modelInstance->getModelConfig().getGrpcCompressionThreshold();
+        inferenceAsync(
+            std::move(modelInstance), request, response, std::move(modelInstanceUnloadGuard),
+            [this, compressionThreshold](Status status) {
+                if (status.ok()) {
+                    setGrpcResponseCompression(context, response->ByteSizeLong(), compressionThreshold);
+                }
+                finish(status);
+            },
+            deadline);
+    }
+
+    void finish(const Status& status) {
+        const uint64_t processingMicroseconds = timer ? timer->stop() : 0;
+        if (timings) {
+            context.AddTrailingMetadata(SERVER_TIMING_TRAILING_METADATA, timings->toServerTiming());
+        }
+        if (!status.ok()) {
+            requestSpan.setError(status.string());
+            requestSpan.end();
+            responder.FinishWithError(status.grpc(), this);
+            return;
+        }
+        grpc::ByteBuffer responseBuffer;
+        bool ownBuffer;
+        const auto serializationStatus = grpc::SerializationTraits<PredictResponse>::Serialize(*response, &responseBuffer, &ownBuffer);
+        if (!serializationStatus.ok()) {
+            requestSpan.setError(serializationStatus.error_message());
+            requestSpan.end();
+            responder.FinishWithError(serializationStatus, this);
+            return;
+        }
+        OVMS_HOT_PATH_DEBUG("Total async gRPC request processing time: {:.3f} ms", processingMicroseconds / 1000.0);
+        requestSpan.end();
+        responder.Finish(responseBuffer, grpc::Status::OK, this);
+    }
+
+    AsyncPredictionServiceImpl& service;
+    grpc::ServerCompletionQueue* completionQueue;
+    PipelineScheduler& pipelineScheduler;
+    const bool zeroCopyInputs;
+    grpc::ServerContext context;
+    grpc::ByteBuffer requestBuffer;
+    // all messages of the call are allocated in blocks of its arena and freed together with the call
+    google::protobuf::Arena arena;
+    PredictRequest* request;
+    PredictResponse* response;
+    // declared after the arena, tensors are unregistered before the request is freed
+    InPlaceRequestTensors inPlaceTensors;
+    grpc::ServerAsyncResponseWriter<grpc::ByteBuffer> responder;
+    State state = State::WAITING_FOR_CALL;
+    std::optional<HotPathTimer<HotPathStage::GRPC_PREDICT>> timer;
+    // counted from the start of processing, not while waiting for the call
+    std::optional<NetworkRequestGuard> networkRequest;
+    std::unique_ptr<Pipeline> pipeline;
+    Span requestSpan;
+    // filled by inference stages until the call is finished
+    std::optional<RequestTimings> timings;
+};
+
+/**
+ * @brief State of a single call which is processed right away on the polling thread. Object deletes itself when call is done.
+ */
+template <typename Service, typename Request, typename Response>
+class UnaryCallData : public CallData {
+public:
+    /**
+     * @brief Async API method of the service requesting the next call
+     */
+    using request_call_t = void (Service::*)(grpc::ServerContext*, Request*, grpc::ServerAsyncResponseWriter<Response>*,
+        grpc::CompletionQueue*, grpc::ServerCompletionQueue*, void*);
+    using process_t = Status (*)(const Request*, Response*);
+
+    UnaryCallData(Service& service, request_call_t requestCall, process_t process, grpc::ServerCompletionQueue* completionQueue) :
+        service(service),
+        requestCall(requestCall),
+        process(process),
+        completionQueue(completionQueue),
+        responder(&context) {
+        (service.*requestCall)(&context, &request, &responder, completionQueue, completionQueue, this);
+    }
+
+    void proceed(bool ok) override {
+        if (finishing || !ok) {
+            delete this;
+            return;
+        }
+        new UnaryCallData(service, requestCall, process, completionQueue);
+        finishing = true;
+        auto status = process(&request, &response);
+        if (!status.ok()) {
+            responder.FinishWithError(status.grpc(), this);
+            return;
+        }
+        responder.Finish(response, grpc::Status::OK, this);
+    }
+
+private:
+    Service& service;
+    const request_call_t requestCall;
+    const process_t process;
+    grpc::ServerCompletionQueue* completionQueue;
+    grpc::ServerContext context;
+    Request request;
+    Response response;
+    grpc::ServerAsyncResponseWriter<Response> responder;
+    bool finishing = false;
+};
+
+using GetModelMetadataCallData = UnaryCallData<AsyncPredictionServiceImpl, GetModelMetadataRequest, GetModelMetadataResponse>;
+using GetModelStatusCallData = UnaryCallData<AsyncModelServiceImpl, GetModelStatusRequest, GetModelStatusResponse>;
+
+Status processGetModelMetadata(const GetModelMetadataRequest* request, GetModelMetadataResponse* response) {
+    return GetModelMetadataImpl::getModelStatus(request, response);
+}
+
+Status processGetModelStatus(const GetModelStatusRequest* request, GetModelStatusResponse* response) {
+    return GetModelStatusImpl::getModelStatus(request, response, ModelManager::getInstance());
+}
+}  // namespace
+
+grpc::Status AsyncModelServiceImpl::HandleReloadConfigRequest(
+    grpc::ServerContext* context,
+    const tensorflow::serving::ReloadConfigRequest* request,
+    tensorflow::serving::ReloadConfigResponse* response) {
+    // config is reloaded automatically, same as in ModelServiceImpl
+    return grpc::Status::OK;
+}
+
+AsyncPredictionHandler::AsyncPredictionHandler(grpc::ServerBuilder& builder, uint completionQueuesCount, const cpu_list_t& cpus, bool zeroCopyInputs) :
+    cpus(cpus),
+    zeroCopyInputs(zeroCopyInputs),
+    pipelineScheduler(std::make_unique<PipelineScheduler>(completionQueuesCount)) {
+    builder.RegisterService(&predictionService);
+    builder.RegisterService(&modelService);
+    completionQueues.reserve(completionQueuesCount);
+    for (uint i = 0; i < completionQueuesCount; ++i) {
+        completionQueues.push_back(builder.AddCompletionQueue());
+    }
+}
+
+AsyncPredictionHandler::~AsyncPredictionHandler() {
+    shutdown();
+}
+
+void AsyncPredictionHandler::start() {
+    SPDLOG_DEBUG("Starting async gRPC completion queues: {}", completionQueues.size());
+    pollingThreads.reserve(completionQueues.size());
+    for (size_t i = 0; i < completionQueues.size(); ++i) {
+        auto completionQueue = completionQueues[i].get();
+        new PredictCallData(predictionService, completionQueue, *pipelineScheduler, zeroCopyInputs);
+        new GetModelMetadataCallData(predictionService, &AsyncPredictionServiceImpl::RequestGetModelMetadata, processGetModelMetadata, completionQueue);
+        new GetModelStatusCallData(modelService, &AsyncModelServiceImpl::RequestGetModelStatus, processGetModelStatus, completionQueue);
+        pollingThreads.emplace_back(&AsyncPredictionHandler::pollCompletionQueue, this, completionQueue, cpus.empty() ? -1 : cpus[i % cpus.size()]);
+    }
+}
+
+void AsyncPredictionHandler::shutdown() {
+    if (stopped) {
+        return;
+    }
+    stopped = true;
+    for (auto& completionQueue : completionQueues) {
+        completionQueue->Shutdown();
+    }
+    for (auto& thread : pollingThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void AsyncPredictionHandler::pollCompletionQueue(grpc::ServerCompletionQueue* completionQueue, int cpu) {
+    setCurrentThreadName("ovms_grpc_cq");
+    if (cpu >= 0 && !pinCurrentThread({cpu})) {
+        SPDLOG_WARN("Could not pin completion queue thread to cpu: {}", cpu);
+    }
+    void* tag;
+    bool ok;
+    while (completionQueue->Next(&tag, &ok)) {
+        static_cast<CallData*>(tag)->proceed(ok);
+    }
+}
+
+}  // namespace ovms
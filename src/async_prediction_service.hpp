@@ -0,0 +1,105 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/server_builder.h>
+#include <grpcpp/server_context.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/model_service.grpc.pb.h"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "numa.hpp"
+#include "pipelinescheduler.hpp"
+
+namespace ovms {
+
+/**
+ * @brief PredictionService with Predict and GetModelMetadata served through completion queues.
+ * Predict messages are received serialized so that tensors can be referenced in place.
+ */
+using AsyncPredictionServiceImpl = tensorflow::serving::PredictionService::WithAsyncMethod_GetModelMetadata<
+    tensorflow::serving::PredictionService::WithRawMethod_Predict<tensorflow::serving::PredictionService::Service>>;
+
+/**
+ * @brief ModelService with GetModelStatus served through completion queues, config reload request stays synchronous
+ */
+class AsyncModelServiceImpl final : public tensorflow::serving::ModelService::WithAsyncMethod_GetModelStatus<tensorflow::serving::ModelService::Service> {
+public:
+    grpc::Status HandleReloadConfigRequest(
+        grpc::ServerContext* context,
+        const tensorflow::serving::ReloadConfigRequest* request,
+        tensorflow::serving::ReloadConfigResponse* response) override;
+};
+
+/**
+ * @brief Drives asynchronous Predict, GetModelMetadata and GetModelStatus calls of a single gRPC server
+ *
+ * Each completion queue is polled by a single thread pinned to its own cpu, which only accepts calls and starts inferences.
+ * Predict calls are finished from OpenVINO completion callbacks so a handful of threads keeps as many calls
+ * in flight as there are infer requests available. Metadata and status calls are processed on the polling thread.
+ * Pipelines are driven by a shared scheduler with as many workers as there are completion queues, their calls
+ * are finished once the exit node is done, so the number of pipelines in flight is not limited by threads.
+ */
+class AsyncPredictionHandler {
+public:
+    /**
+     * @brief Registers services and completion queues in the builder, has to be called before the server is built
+     *
+     * @param builder
+     * @param completionQueuesCount
+     * @param cpus polling threads are pinned to the cpus one by one, in round robin when there are more queues than cpus.
+     * Threads are not pinned when empty.
+     * @param zeroCopyInputs large tensor_content of Predict inputs is referenced in received message instead of being copied
+     */
+    AsyncPredictionHandler(grpc::ServerBuilder& builder, uint completionQueuesCount, const cpu_list_t& cpus = {}, bool zeroCopyInputs = false);
+
+    ~AsyncPredictionHandler();
+
+    AsyncPredictionHandler(const AsyncPredictionHandler&) = delete;
+    AsyncPredictionHandler& operator=(const AsyncPredictionHandler&) = delete;
+
+    /**
+     * @brief Starts polling threads, has to be called after the server is started
+     */
+    void start();
+
+    /**
+     * @brief Shuts down completion queues and waits for polling threads, has to be called after the server shutdown
+     */
+    void shutdown();
+
+private:
+    void pollCompletionQueue(grpc::ServerCompletionQueue* completionQueue, int cpu);
+
+    AsyncPredictionServiceImpl predictionService;
+    AsyncModelServiceImpl modelService;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> completionQueues;
+    const cpu_list_t cpus;
+    const bool zeroCopyInputs;
+    std::vector<std::thread> pollingThreads;
+    bool stopped = false;
+    // destroyed first, pipelines still in flight finish their calls on completion queues
+    std::unique_ptr<PipelineScheduler> pipelineScheduler;
+};
+
+}  // namespace ovms
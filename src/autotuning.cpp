@@ -0,0 +1,109 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "autotuning.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+namespace ovms {
+
+std::vector<TuningCandidate> getTuningCandidates(size_t cpusCount) {
+    std::vector<TuningCandidate> candidates;
+    for (uint32_t streams = 1; streams <= std::max<size_t>(cpusCount, 1); streams *= 2) {
+        candidates.push_back({streams, streams});
+        candidates.push_back({streams, streams * 2});
+    }
+    return candidates;
+}
+
+bool selectTuningCandidate(const std::vector<TuningMeasurement>& measurements, uint32_t latencyTargetMs, TuningCandidate& selected) {
+    const TuningMeasurement* best = nullptr;
+    for (const auto& measurement : measurements) {
+        if (latencyTargetMs > 0 && measurement.latencyMs > latencyTargetMs) {
+            continue;
+        }
+        if (!best || measurement.throughput > best->throughput) {
+            best = &measurement;
+        }
+    }
+    if (!best) {
+        for (const auto& measurement : measurements) {
+            if (!best || measurement.latencyMs < best->latencyMs) {
+                best = &measurement;
+            }
+        }
+    }
+    if (!best) {
+        return false;
+    }
+    selected = best->candidate;
+    return true;
+}
+
+std::string TuningResultsStore::getResultPath(const std::string& key) const {
+    return (std::filesystem::path(directory) / (key + ".tuning")).string();
+}
+
+bool TuningResultsStore::load(const std::string& key, TuningCandidate& result) const {
+    const auto path = getResultPath(key);
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        SPDLOG_DEBUG("Tuning result cache miss: {}", path);
+        return false;
+    }
+    TuningCandidate loaded;
+    if (!(file >> loaded.streams >> loaded.nireq) || loaded.streams == 0 || loaded.nireq == 0) {
+        SPDLOG_WARN("Invalid tuning result: {}; model will be tuned again", path);
+        return false;
+    }
+    result = loaded;
+    return true;
+}
+
+void TuningResultsStore::store(const std::string& key, const TuningCandidate& result) const {
+    const auto path = getResultPath(key);
+    std::stringstream tmpSuffix;
+    tmpSuffix << ".tmp." << getpid() << "." << std::this_thread::get_id();
+    const auto tmpPath = path + tmpSuffix.str();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        SPDLOG_WARN("Cannot create tuning results directory: {}; error: {}", directory, error.message());
+        return;
+    }
+    {
+        std::ofstream file(tmpPath);
+        file << result.streams << " " << result.nireq << std::endl;
+        if (!file) {
+            SPDLOG_WARN("Cannot write tuning result: {}", tmpPath);
+            std::filesystem::remove(tmpPath, error);
+            return;
+        }
+    }
+    std::filesystem::rename(tmpPath, path, error);
+    if (error) {
+        SPDLOG_WARN("Cannot store tuning result: {}; error: {}", path, error.message());
+        std::filesystem::remove(tmpPath, error);
+    }
+}
+
+}  // namespace ovms
@@ -0,0 +1,100 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Number of CPU_THROUGHPUT_STREAMS and infer requests benchmarked by load time auto-tuning
+ */
+struct TuningCandidate {
+    uint32_t streams = 0;
+    uint32_t nireq = 0;
+
+    bool operator==(const TuningCandidate& rhs) const {
+        return streams == rhs.streams && nireq == rhs.nireq;
+    }
+};
+
+struct TuningMeasurement {
+    TuningCandidate candidate;
+    /**
+     * @brief Inferences per second with all infer requests running at once
+     */
+    double throughput = 0;
+    /**
+     * @brief Average time of one inference
+     */
+    double latencyMs = 0;
+};
+
+/**
+ * @brief Lists candidates for the host: powers of 2 streams up to the number of cpus, each with one and two infer requests per stream
+ *
+ * @param cpusCount cpus available to inference streams of the model
+ */
+std::vector<TuningCandidate> getTuningCandidates(size_t cpusCount);
+
+/**
+ * @brief Chooses candidate with the highest throughput among ones meeting latency target.
+ * When none meets it, the one with the lowest latency is chosen.
+ *
+ * @param measurements
+ * @param latencyTargetMs 0 means there is no target
+ * @param selected
+ *
+ * @return false if there are no measurements
+ */
+bool selectTuningCandidate(const std::vector<TuningMeasurement>& measurements, uint32_t latencyTargetMs, TuningCandidate& selected);
+
+/**
+ * @brief Tuning results kept next to compiled networks in the compiled network cache directory, so auto-tuning
+ * is skipped on restart. Results are keyed the same way as compiled networks, any change of the model or host
+ * specific inputs only causes a miss.
+ */
+class TuningResultsStore {
+public:
+    /**
+     * @param directory store is disabled when empty
+     */
+    TuningResultsStore(const std::string& directory) :
+        directory(directory) {}
+
+    bool isEnabled() const {
+        return !directory.empty();
+    }
+
+    std::string getResultPath(const std::string& key) const;
+
+    /**
+     * @return true if result was found and is valid
+     */
+    bool load(const std::string& key, TuningCandidate& result) const;
+
+    /**
+     * @brief Stores result, failures are logged and only cause tuning to run again next time
+     */
+    void store(const std::string& key, const TuningCandidate& result) const;
+
+private:
+    const std::string directory;
+};
+
+}  // namespace ovms
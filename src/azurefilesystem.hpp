@@ -131,6 +131,10 @@ public:
    */
     StatusCode deleteFileFolder(const std::string& path) override;
 
+    const char* getBackendName() const override {
+        return "azure";
+    }
+
     static const std::string AZURE_URL_FILE_PREFIX;
 
     static const std::string AZURE_URL_BLOB_PREFIX;
@@ -15,9 +15,13 @@
 //*****************************************************************************
 #include "azurestorage.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
 
 #include "azurefilesystem.hpp"
+#include "fetchedobjects.hpp"
 #include "logging.hpp"
 
 namespace ovms {
@@ -410,7 +414,7 @@ std::string AzureStorageBlob::getLastPathPart(const std::string& path) {
     return proper_path.substr(part_start + 1, part_end - part_start - 1);
 }
 
-StatusCode AzureStorageBlob::downloadFile(const std::string& local_path) {
+StatusCode AzureStorageBlob::getFileProperties(uint64_t* size, std::string* contentMd5) {
     try {
         if (!isPathValidationOk_) {
             auto status = checkPath(fullUri_);
@@ -424,7 +428,8 @@ StatusCode AzureStorageBlob::downloadFile(const std::string& local_path) {
             return StatusCode::AS_FILE_NOT_FOUND;
         }
 
-        as_blob_.download_to_file(local_path);
+        *size = as_blob_.properties().size();
+        *contentMd5 = as_blob_.properties().content_md5();
         return StatusCode::OK;
     } catch (const as::storage_exception& e) {
         SPDLOG_LOGGER_ERROR(azurestorage_logger, "Unable to access path: {}", extractAzureStorageExceptionMessage(e));
@@ -435,7 +440,46 @@ StatusCode AzureStorageBlob::downloadFile(const std::string& local_path) {
     return StatusCode::AS_FILE_NOT_FOUND;
 }
 
+StatusCode AzureStorageBlob::downloadFileRange(const std::string& local_path, uint64_t offset, uint64_t length) {
+    try {
+        // each range gets its own reference, blob properties are updated by every download
+        as::cloud_blob blob = as_container_.get_blob_reference(blockpath_);
+        concurrency::streams::container_buffer<std::vector<uint8_t>> buffer;
+        concurrency::streams::ostream output_stream(buffer);
+        blob.download_range_to_stream(output_stream, offset, length);
+        return writeFileRange(local_path, offset, buffer.collection());
+    } catch (const as::storage_exception& e) {
+        SPDLOG_LOGGER_ERROR(azurestorage_logger, "Unable to download range from {} to {} of {}: {}", offset, offset + length, fullPath_,
+            extractAzureStorageExceptionMessage(e));
+    } catch (const std::exception& e) {
+        SPDLOG_LOGGER_ERROR(azurestorage_logger, "Unable to download range from {} to {} of {}: {}", offset, offset + length, fullPath_, e.what());
+    }
+
+    return StatusCode::AS_FILE_INVALID;
+}
+
+StatusCode AzureStorageBlob::downloadFile(const std::string& local_path) {
+    uint64_t size = 0;
+    std::string contentMd5;
+    auto status = getFileProperties(&size, &contentMd5);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    return downloadFiles({{this, local_path, size, contentMd5}});
+}
+
 StatusCode AzureStorageBlob::downloadFileFolderTo(const std::string& local_path) {
+    std::vector<std::shared_ptr<AzureStorageAdapter>> storages;
+    std::vector<RemoteFile> files;
+    auto status = listFolderFiles(local_path, storages, files);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    return downloadFiles(files);
+}
+
+StatusCode AzureStorageBlob::listFolderFiles(const std::string& local_path, std::vector<std::shared_ptr<AzureStorageAdapter>>& storages,
+    std::vector<RemoteFile>& files) {
     try {
         if (!isPathValidationOk_) {
             auto status = checkPath(fullUri_);
@@ -443,7 +487,7 @@ StatusCode AzureStorageBlob::downloadFileFolderTo(const std::string& local_path)
                 return status;
         }
 
-        SPDLOG_LOGGER_TRACE(azurestorage_logger, "Downloading dir {} and saving to {}", fullPath_, local_path);
+        SPDLOG_LOGGER_TRACE(azurestorage_logger, "Listing dir {} to save to {}", fullPath_, local_path);
         bool is_dir;
         auto status = this->isDirectory(&is_dir);
         if (status != StatusCode::OK) {
@@ -462,8 +506,8 @@ StatusCode AzureStorageBlob::downloadFileFolderTo(const std::string& local_path)
             return status;
         }
 
-        std::set<std::string> files;
-        status = getDirectoryFiles(&files);
+        std::set<std::string> dir_files;
+        status = getDirectoryFiles(&dir_files);
         if (status != StatusCode::OK) {
             return status;
         }
@@ -487,16 +531,16 @@ StatusCode AzureStorageBlob::downloadFileFolderTo(const std::string& local_path)
             if (mkdir_status != StatusCode::OK) {
                 return status;
             }
-            auto download_dir_status =
-                azureSubdirStorageObj->downloadFileFolderTo(local_dir_path);
-            if (download_dir_status != StatusCode::OK) {
-                SPDLOG_LOGGER_WARN(azurestorage_logger, "Unable to download directory from {} to {}",
+            auto list_dir_status =
+                azureSubdirStorageObj->listFolderFiles(local_dir_path, storages, files);
+            if (list_dir_status != StatusCode::OK) {
+                SPDLOG_LOGGER_WARN(azurestorage_logger, "Unable to list directory {} to download to {}",
                     remote_dir_path, local_dir_path);
-                return download_dir_status;
+                return list_dir_status;
             }
         }
 
-        for (auto&& f : files) {
+        for (auto&& f : dir_files) {
             std::string remote_file_path = joinPath({fullUri_, f});
             std::string local_file_path = joinPath({local_path, f});
             SPDLOG_LOGGER_TRACE(azurestorage_logger, "Processing file {} from {} -> {}", f, remote_file_path,
@@ -511,13 +555,16 @@ StatusCode AzureStorageBlob::downloadFileFolderTo(const std::string& local_path)
                 return status;
             }
 
-            auto download_status =
-                azureFiledirStorageObj->downloadFile(local_file_path);
-            if (download_status != StatusCode::OK) {
+            uint64_t size = 0;
+            std::string contentMd5;
+            status = azureFiledirStorageObj->getFileProperties(&size, &contentMd5);
+            if (status != StatusCode::OK) {
                 SPDLOG_LOGGER_WARN(azurestorage_logger, "Unable to save file from {} to {}", remote_file_path,
                     local_file_path);
-                return download_status;
+                return status;
             }
+            storages.push_back(azureFiledirStorageObj);
+            files.push_back({azureFiledirStorageObj.get(), local_file_path, size, contentMd5});
         }
         return StatusCode::OK;
     } catch (const as::storage_exception& e) {
@@ -988,7 +1035,26 @@ StatusCode AzureStorageFile::deleteFileFolder() {
     return StatusCode::AS_FILE_NOT_FOUND;
 }
 
-StatusCode AzureStorageFile::downloadFile(const std::string& local_path) {
+as::cloud_file_directory AzureStorageFile::getLastWorkingSubdir() {
+    as::cloud_file_directory as_last_working_subdir;
+    std::string tmp_dir = "";
+
+    try {
+        for (std::vector<std::string>::size_type i = 0; i != subdirs_.size(); i++) {
+            tmp_dir = tmp_dir + (i == 0 ? "" : "/") + subdirs_[i];
+            as::cloud_file_directory as_tmp_subdir = as_share_.get_directory_reference(tmp_dir);
+            if (!as_tmp_subdir.exists()) {
+                break;
+            }
+
+            as_last_working_subdir = as_tmp_subdir;
+        }
+    } catch (const as::storage_exception& e) {
+    }
+    return as_last_working_subdir;
+}
+
+StatusCode AzureStorageFile::getFileProperties(uint64_t* size, std::string* contentMd5) {
     try {
         if (!isPathValidationOk_) {
             auto status = checkPath(fullUri_);
@@ -996,29 +1062,15 @@ StatusCode AzureStorageFile::downloadFile(const std::string& local_path) {
                 return status;
         }
 
-        as::cloud_file_directory as_last_working_subdir;
-        std::string tmp_dir = "";
-
-        try {
-            for (std::vector<std::string>::size_type i = 0; i != subdirs_.size(); i++) {
-                tmp_dir = tmp_dir + (i == 0 ? "" : "/") + subdirs_[i];
-                as::cloud_file_directory as_tmp_subdir = as_share_.get_directory_reference(tmp_dir);
-                if (!as_tmp_subdir.exists()) {
-                    break;
-                }
-
-                as_last_working_subdir = as_tmp_subdir;
-            }
-        } catch (const as::storage_exception& e) {
-        }
-
-        as_file1_ = as_last_working_subdir.get_file_reference(_XPLATSTR(file_));
+        as_file_directory_ = getLastWorkingSubdir();
+        as_file1_ = as_file_directory_.get_file_reference(_XPLATSTR(file_));
         if (!as_file1_.exists()) {
             SPDLOG_LOGGER_WARN(azurestorage_logger, "File does not exist: {} -> {}", fullPath_, file_);
             return StatusCode::AS_FILE_NOT_FOUND;
         }
 
-        as_file1_.download_to_file(local_path);
+        *size = as_file1_.properties().length();
+        *contentMd5 = as_file1_.properties().content_md5();
         return StatusCode::OK;
     } catch (const as::storage_exception& e) {
         SPDLOG_LOGGER_ERROR(azurestorage_logger, "Unable to access path: {}", extractAzureStorageExceptionMessage(e));
@@ -1029,7 +1081,46 @@ StatusCode AzureStorageFile::downloadFile(const std::string& local_path) {
     return StatusCode::AS_FILE_NOT_FOUND;
 }
 
+StatusCode AzureStorageFile::downloadFileRange(const std::string& local_path, uint64_t offset, uint64_t length) {
+    try {
+        // each range gets its own reference, file properties are updated by every download
+        as::cloud_file file = as_file_directory_.get_file_reference(_XPLATSTR(file_));
+        concurrency::streams::container_buffer<std::vector<uint8_t>> buffer;
+        concurrency::streams::ostream output_stream(buffer);
+        file.download_range_to_stream(output_stream, offset, length);
+        return writeFileRange(local_path, offset, buffer.collection());
+    } catch (const as::storage_exception& e) {
+        SPDLOG_LOGGER_ERROR(azurestorage_logger, "Unable to download range from {} to {} of {}: {}", offset, offset + length, fullPath_,
+            extractAzureStorageExceptionMessage(e));
+    } catch (const std::exception& e) {
+        SPDLOG_LOGGER_ERROR(azurestorage_logger, "Unable to download range from {} to {} of {}: {}", offset, offset + length, fullPath_, e.what());
+    }
+
+    return StatusCode::AS_FILE_INVALID;
+}
+
+StatusCode AzureStorageFile::downloadFile(const std::string& local_path) {
+    uint64_t size = 0;
+    std::string contentMd5;
+    auto status = getFileProperties(&size, &contentMd5);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    return downloadFiles({{this, local_path, size, contentMd5}});
+}
+
 StatusCode AzureStorageFile::downloadFileFolderTo(const std::string& local_path) {
+    std::vector<std::shared_ptr<AzureStorageAdapter>> storages;
+    std::vector<RemoteFile> files;
+    auto status = listFolderFiles(local_path, storages, files);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    return downloadFiles(files);
+}
+
+StatusCode AzureStorageFile::listFolderFiles(const std::string& local_path, std::vector<std::shared_ptr<AzureStorageAdapter>>& storages,
+    std::vector<RemoteFile>& files) {
     try {
         if (!isPathValidationOk_) {
             auto status = checkPath(fullUri_);
@@ -1037,7 +1128,7 @@ StatusCode AzureStorageFile::downloadFileFolderTo(const std::string& local_path)
                 return status;
         }
 
-        SPDLOG_LOGGER_TRACE(azurestorage_logger, "Downloading dir {} and saving to {}", fullPath_, local_path);
+        SPDLOG_LOGGER_TRACE(azurestorage_logger, "Listing dir {} to save to {}", fullPath_, local_path);
         bool is_dir;
         auto status = this->isDirectory(&is_dir);
         if (status != StatusCode::OK) {
@@ -1056,8 +1147,8 @@ StatusCode AzureStorageFile::downloadFileFolderTo(const std::string& local_path)
             return status;
         }
 
-        std::set<std::string> files;
-        status = getDirectoryFiles(&files);
+        std::set<std::string> dir_files;
+        status = getDirectoryFiles(&dir_files);
         if (status != StatusCode::OK) {
             return status;
         }
@@ -1081,16 +1172,16 @@ StatusCode AzureStorageFile::downloadFileFolderTo(const std::string& local_path)
             if (mkdir_status != StatusCode::OK) {
                 return status;
             }
-            auto download_dir_status =
-                azureSubdirStorageObj->downloadFileFolderTo(local_dir_path);
-            if (download_dir_status != StatusCode::OK) {
-                SPDLOG_LOGGER_WARN(azurestorage_logger, "Unable to download directory from {} to {}",
+            auto list_dir_status =
+                azureSubdirStorageObj->listFolderFiles(local_dir_path, storages, files);
+            if (list_dir_status != StatusCode::OK) {
+                SPDLOG_LOGGER_WARN(azurestorage_logger, "Unable to list directory {} to download to {}",
                     remote_dir_path, local_dir_path);
-                return download_dir_status;
+                return list_dir_status;
             }
         }
 
-        for (auto&& f : files) {
+        for (auto&& f : dir_files) {
             std::string remote_file_path = joinPath({fullUri_, f});
             std::string local_file_path = joinPath({local_path, f});
             SPDLOG_LOGGER_TRACE(azurestorage_logger, "Processing file {} from {} -> {}", f, remote_file_path,
@@ -1105,13 +1196,16 @@ StatusCode AzureStorageFile::downloadFileFolderTo(const std::string& local_path)
                 return status;
             }
 
-            auto download_status =
-                azureFileStorageObj->downloadFile(local_file_path);
-            if (download_status != StatusCode::OK) {
+            uint64_t size = 0;
+            std::string contentMd5;
+            status = azureFileStorageObj->getFileProperties(&size, &contentMd5);
+            if (status != StatusCode::OK) {
                 SPDLOG_LOGGER_WARN(azurestorage_logger, "Unable to save file from {} to {}", remote_file_path,
                     local_file_path);
-                return download_status;
+                return status;
             }
+            storages.push_back(azureFileStorageObj);
+            files.push_back({azureFileStorageObj.get(), local_file_path, size, contentMd5});
         }
         return StatusCode::OK;
     } catch (const as::storage_exception& e) {
@@ -1123,6 +1217,82 @@ StatusCode AzureStorageFile::downloadFileFolderTo(const std::string& local_path)
     return StatusCode::AS_FILE_NOT_FOUND;
 }
 
+StatusCode AzureStorageAdapter::writeFileRange(const std::string& local_path, uint64_t offset, const std::vector<uint8_t>& data) {
+    std::fstream output_file(local_path.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+    output_file.seekp(offset);
+    output_file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    output_file.close();
+    if (output_file.fail()) {
+        SPDLOG_LOGGER_ERROR(azurestorage_logger, "Unable to save range from {} to {} into {}", offset, offset + data.size(), local_path);
+        return StatusCode::AS_FILE_INVALID;
+    }
+    return StatusCode::OK;
+}
+
+static std::string contentId(const AzureStorageAdapter::RemoteFile& file) {
+    return file.contentMd5.empty() ? "" : "md5:" + file.contentMd5;
+}
+
+StatusCode AzureStorageAdapter::downloadFiles(const std::vector<RemoteFile>& files) {
+    const uint64_t partSize = FileSystem::getDownloadSetting("AZURE_DOWNLOAD_PART_SIZE_MB", 16) * 1024 * 1024;
+    const size_t downloadConnections = FileSystem::getDownloadSetting("AZURE_DOWNLOAD_CONNECTIONS", 8);
+
+    std::vector<uint64_t> sizes;
+    sizes.reserve(files.size());
+    std::vector<bool> reused(files.size(), false);
+    for (size_t i = 0; i < files.size(); ++i) {
+        const auto& file = files[i];
+        reused[i] = FetchedObjects::instance().reuse(contentId(file), file.size, file.localPath);
+        sizes.push_back(reused[i] ? 0 : file.size);
+        if (reused[i]) {
+            continue;
+        }
+        // parts are written in place, file gets its final size up front
+        std::ofstream output_file(file.localPath.c_str(), std::ios::binary);
+        output_file.close();
+        std::error_code error;
+        fs::resize_file(file.localPath, file.size, error);
+        if (error) {
+            SPDLOG_LOGGER_ERROR(azurestorage_logger, "Failed to create local file: {} {}", file.localPath, error.message());
+            return StatusCode::PATH_INVALID;
+        }
+    }
+
+    const auto parts = FileSystem::splitIntoParts(sizes, partSize);
+    std::atomic<size_t> nextPart{0};
+    std::atomic<bool> failed{false};
+    auto downloadParts = [&]() {
+        // remaining parts are skipped after the first failure, the whole download is retried anyway
+        for (size_t part = nextPart++; part < parts.size() && !failed; part = nextPart++) {
+            const auto [fileIndex, offset] = parts[part];
+            const auto& file = files[fileIndex];
+            const uint64_t length = std::min(partSize, file.size - offset);
+            if (file.storage->downloadFileRange(file.localPath, offset, length) != StatusCode::OK) {
+                failed = true;
+            }
+        }
+    };
+    const size_t connections = std::min(downloadConnections, parts.size());
+    SPDLOG_LOGGER_DEBUG(azurestorage_logger, "Downloading {} files in {} parts with {} connections", files.size(), parts.size(), connections);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < connections; ++i) {
+        workers.emplace_back(downloadParts);
+    }
+    downloadParts();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return StatusCode::AS_FILE_INVALID;
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!reused[i]) {
+            FetchedObjects::instance().add(contentId(files[i]), files[i].size, files[i].localPath);
+        }
+    }
+    return StatusCode::OK;
+}
+
 std::vector<std::string> AzureStorageAdapter::FindSubdirectories(std::string path) {
     std::vector<std::string> output;
 
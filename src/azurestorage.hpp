@@ -19,6 +19,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <spdlog/spdlog.h>
@@ -43,6 +44,17 @@ using files_list_t = std::set<std::string>;
 
 class AzureStorageAdapter {
 public:
+    /**
+     * @brief File of a folder download, its size is known before its ranges are requested
+     */
+    struct RemoteFile {
+        AzureStorageAdapter* storage;
+        std::string localPath;
+        uint64_t size;
+        // unchanged files of other versions are linked instead of downloaded
+        std::string contentMd5;
+    };
+
     AzureStorageAdapter() {}
 
     virtual StatusCode fileExists(bool* exists) = 0;
@@ -58,6 +70,32 @@ public:
     virtual StatusCode downloadFileFolderTo(const std::string& local_path) = 0;
     virtual StatusCode checkPath(const std::string& path) = 0;
 
+    /**
+     * @brief Checks that the file exists and reads its size and MD5 hash, which is empty if it was not set on upload
+     */
+    virtual StatusCode getFileProperties(uint64_t* size, std::string* contentMd5) = 0;
+
+    /**
+     * @brief Downloads part of the file into already existing local file at the same offset
+     */
+    virtual StatusCode downloadFileRange(const std::string& local_path, uint64_t offset, uint64_t length) = 0;
+
+    /**
+     * @brief Recursively collects files of the folder and creates their local directories
+     *
+     * @param local_path
+     * @param storages keep storage objects of collected files alive until they are downloaded
+     * @param files
+     */
+    virtual StatusCode listFolderFiles(const std::string& local_path, std::vector<std::shared_ptr<AzureStorageAdapter>>& storages,
+        std::vector<RemoteFile>& files) = 0;
+
+    /**
+     * @brief Downloads files split into ranges of AZURE_DOWNLOAD_PART_SIZE_MB, with AZURE_DOWNLOAD_CONNECTIONS
+     * ranges requested in parallel regardless of which file they belong to
+     */
+    StatusCode downloadFiles(const std::vector<RemoteFile>& files);
+
     std::string joinPath(std::initializer_list<std::string> segments);
     StatusCode CreateLocalDir(const std::string& path);
     bool isAbsolutePath(const std::string& path);
@@ -66,6 +104,8 @@ public:
 protected:
     const std::string extractAzureStorageExceptionMessage(const as::storage_exception& e);
 
+    StatusCode writeFileRange(const std::string& local_path, uint64_t offset, const std::vector<uint8_t>& data);
+
 private:
     virtual StatusCode parseFilePath(const std::string& path) = 0;
 };
@@ -98,6 +138,13 @@ public:
 
     StatusCode downloadFileFolderTo(const std::string& local_path) override;
 
+    StatusCode getFileProperties(uint64_t* size, std::string* contentMd5) override;
+
+    StatusCode downloadFileRange(const std::string& local_path, uint64_t offset, uint64_t length) override;
+
+    StatusCode listFolderFiles(const std::string& local_path, std::vector<std::shared_ptr<AzureStorageAdapter>>& storages,
+        std::vector<RemoteFile>& files) override;
+
 private:
     std::string getLastPathPart(const std::string& path);
 
@@ -156,9 +203,18 @@ public:
 
     StatusCode downloadFileFolderTo(const std::string& local_path) override;
 
+    StatusCode getFileProperties(uint64_t* size, std::string* contentMd5) override;
+
+    StatusCode downloadFileRange(const std::string& local_path, uint64_t offset, uint64_t length) override;
+
+    StatusCode listFolderFiles(const std::string& local_path, std::vector<std::shared_ptr<AzureStorageAdapter>>& storages,
+        std::vector<RemoteFile>& files) override;
+
 private:
     StatusCode parseFilePath(const std::string& path) override;
 
+    as::cloud_file_directory getLastWorkingSubdir();
+
     bool isPathValidationOk_;
 
     std::string fullPath_;
@@ -181,6 +237,8 @@ private:
 
     as::cloud_file_directory as_directory_;
 
+    as::cloud_file_directory as_file_directory_;
+
     as::cloud_file as_file1_;
 };
 
@@ -0,0 +1,313 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "batchsplitter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "deserialization.hpp"
+#include "dynamicbatcher.hpp"
+#include "imagedecoder.hpp"
+#include "serialization.hpp"
+#include "sharedmemory.hpp"
+#include "transposition.hpp"
+
+namespace ovms {
+
+namespace {
+struct SplitInput {
+    std::shared_ptr<TensorInfo> networkInput;
+    size_t rowByteSize = 0;
+    // whole request input in network layout and precision, points to request memory or to staging
+    const char* data = nullptr;
+    std::vector<char> staging;
+};
+
+struct SplitOutput {
+    std::shared_ptr<TensorInfo> networkOutput;
+    size_t rowByteSize = 0;
+    std::vector<char> data;
+};
+
+struct SplitBatchContext {
+    size_t networkBatchSize = 0;
+    size_t batchSize = 0;
+    const tensorflow::serving::PredictRequest* request = nullptr;
+    tensorflow::serving::PredictResponse* response = nullptr;
+    std::function<void(Status)> callback;
+    std::vector<SplitInput> inputs;
+    std::vector<SplitOutput> outputs;
+    std::atomic<size_t> remainingChunks{0};
+    // chunks which get a stream after another one failed are not inferred
+    std::atomic<bool> failed{false};
+    std::mutex statusMutex;
+    Status status = StatusCode::OK;
+};
+
+size_t getRowByteSize(const TensorInfo& tensor) {
+    const auto& shape = tensor.getShape();
+    size_t byteSize = tensor.getPrecision().size();
+    for (size_t i = 1; i < shape.size(); i++) {
+        byteSize *= shape[i];
+    }
+    return byteSize;
+}
+
+Status stageInput(const tensorflow::TensorProto& requestInput, SplitInput& input, size_t batchSize) {
+    const auto& networkInput = *input.networkInput;
+    const size_t byteSize = batchSize * input.rowByteSize;
+    if (isImageInputRequested(requestInput, networkInput)) {
+        input.staging.resize(byteSize);
+        input.data = input.staging.data();
+        return decodeImages(requestInput, networkInput, input.staging.data(), batchSize);
+    }
+    if (!networkInput.isLayoutTransposed() && !isSharedMemoryReference(requestInput) &&
+        !isPrecisionConversionRequested(requestInput, networkInput.getPrecision()) && requestInput.tensor_content().size() == byteSize) {
+        // chunks are copied into infer request blobs straight from the request
+        input.data = requestInput.tensor_content().data();
+        return StatusCode::OK;
+    }
+    std::vector<char> converted;
+    input.staging.resize(byteSize);
+    char* destination = input.staging.data();
+    if (networkInput.isLayoutTransposed()) {
+        converted.resize(byteSize);
+        destination = converted.data();
+    }
+    auto status = copyRequestInput(requestInput, networkInput, destination, byteSize);
+    if (!status.ok()) {
+        return status;
+    }
+    if (networkInput.isLayoutTransposed()) {
+        shape_t shape = networkInput.getShape();
+        shape[0] = batchSize;
+        transposeNhwcToNchw(converted.data(), input.staging.data(), shape, networkInput.getPrecision().size());
+    }
+    input.data = input.staging.data();
+    return StatusCode::OK;
+}
+
+void finishChunk(std::shared_ptr<SplitBatchContext> context, const Status& status) {
+    if (!status.ok()) {
+        std::lock_guard<std::mutex> lock(context->statusMutex);
+        if (context->status.ok()) {
+            context->status = status;
+        }
+        context->failed.store(true, std::memory_order_relaxed);
+    }
+    if (context->remainingChunks.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    Status result = context->status;
+    for (auto it = context->outputs.begin(); result.ok() && it != context->outputs.end(); ++it) {
+        if (it->networkOutput->isReduced()) {
+            auto shape = it->networkOutput->getShape();
+            shape[0] = context->batchSize;
+            result = serializeReducedOutput(*context->response, it->networkOutput, it->data.data(), shape);
+            continue;
+        }
+        auto& tensorProto = (*context->response->mutable_outputs())[it->networkOutput->getMappedName()];
+        OutputQuantization quantization;
+        result = serializeBatchToTensorProto(tensorProto, it->networkOutput, it->data.data(), context->batchSize, &quantization);
+        if (result.ok() && it->networkOutput->isQuantized()) {
+            serializeOutputQuantization(*context->response, it->networkOutput->getMappedName(), quantization);
+        }
+    }
+    if (result.ok()) {
+        result = writeOutputsToSharedMemory(context->response, &context->request->output_filter());
+    }
+    auto callback = std::move(context->callback);
+    context.reset();
+    callback(result);
+}
+
+Status copyChunkOutputs(SplitBatchContext& context, InferenceEngine::InferRequest& inferRequest, size_t offset, size_t rows) {
+    for (auto& output : context.outputs) {
+        InferenceEngine::Blob::Ptr blob;
+        try {
+            blob = inferRequest.GetBlob(output.networkOutput->getName());
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            Status status = StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+            SPDLOG_ERROR("{}: {}", status.string(), e.what());
+            return status;
+        }
+        if (blob->byteSize() < rows * output.rowByteSize) {
+            return StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+        }
+        std::memcpy(output.data.data() + offset * output.rowByteSize, blob->cbuffer().as<const char*>(), rows * output.rowByteSize);
+    }
+    return StatusCode::OK;
+}
+
+void inferChunk(std::shared_ptr<SplitBatchContext> context, OVInferRequestsQueue& inferRequestsQueue, size_t chunk, int streamId) {
+    if (streamId == EXPIRED_STREAM_ID) {
+        finishChunk(std::move(context), StatusCode::DEADLINE_EXCEEDED);
+        return;
+    }
+    if (context->failed.load(std::memory_order_relaxed)) {
+        inferRequestsQueue.returnStream(streamId);
+        finishChunk(std::move(context), StatusCode::OK);
+        return;
+    }
+    const size_t networkBatchSize = context->networkBatchSize;
+    const size_t offset = chunk * networkBatchSize;
+    const size_t rows = std::min(networkBatchSize, context->batchSize - offset);
+    auto& inferRequest = inferRequestsQueue.getInferRequest(streamId);
+    Status status = StatusCode::OK;
+    try {
+        const auto& preallocatedBlobs = inferRequestsQueue.getPreallocatedInputBlobs(streamId);
+        auto& chunkBlobs = inferRequestsQueue.getChunkInputBlobs(streamId);
+        for (const auto& input : context->inputs) {
+            const auto& name = input.networkInput->getName();
+            // blobs set by other requests may point to their memory, so chunk is always written into blob of the stream
+            auto preallocatedBlobIt = preallocatedBlobs.find(name);
+            InferenceEngine::Blob::Ptr blob;
+            if (preallocatedBlobIt != preallocatedBlobs.end()) {
+                blob = preallocatedBlobIt->second;
+            } else {
+                auto& chunkBlob = chunkBlobs[name];
+                if (!chunkBlob || chunkBlob->getTensorDesc() != input.networkInput->getTensorDesc()) {
+                    chunkBlob = allocateConvertedBlob(input.networkInput->getTensorDesc());
+                }
+                blob = chunkBlob;
+            }
+            if (!blob) {
+                chunkBlobs.erase(name);
+                status = StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
+                break;
+            }
+            char* destination = blob->buffer().as<char*>();
+            const size_t byteSize = rows * input.rowByteSize;
+            std::memcpy(destination, input.data + offset * input.rowByteSize, byteSize);
+            // padding rows of the last chunk are zeroed, their outputs are dropped
+            std::memset(destination + byteSize, 0, (networkBatchSize - rows) * input.rowByteSize);
+            inferRequest.SetBlob(name, blob);
+        }
+        if (status.ok()) {
+            inferRequest.SetCompletionCallback(std::function<void(InferenceEngine::InferRequest, InferenceEngine::StatusCode)>(
+                [context, &inferRequestsQueue, offset, rows, streamId, &inferRequest](InferenceEngine::InferRequest, InferenceEngine::StatusCode code) {
+                    // copies outlive the callback reset, same as in inferenceAsync
+                    auto finishedContext = context;
+                    auto& finishedInferRequestsQueue = inferRequestsQueue;
+                    const int finishedStreamId = streamId;
+                    auto& finishedInferRequest = inferRequest;
+                    Status status = StatusCode::OK;
+                    if (code != InferenceEngine::StatusCode::OK) {
+                        status = StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+                        SPDLOG_ERROR("Async infer of split batch failed {}: {}", status.string(), code);
+                    } else {
+                        status = copyChunkOutputs(*finishedContext, finishedInferRequest, offset, rows);
+                    }
+                    finishedInferRequest.SetCompletionCallback([]() {});  // reset callback on infer request
+                    finishedInferRequestsQueue.returnStream(finishedStreamId);
+                    finishChunk(std::move(finishedContext), status);
+                }));
+            inferRequest.StartAsync();
+            return;
+        }
+    } catch (const InferenceEngine::details::InferenceEngineException& e) {
+        status = StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+        SPDLOG_ERROR("Async infer of split batch caught an exception {}: {}", status.string(), e.what());
+        inferRequest.SetCompletionCallback([]() {});
+    }
+    inferRequestsQueue.returnStream(streamId);
+    finishChunk(std::move(context), status);
+}
+}  // namespace
+
+void inferSplitBatchAsync(const std::vector<OVInferRequestsQueue*>& inferRequestsQueues,
+    ReplicaRouting routing,
+    const tensor_map_t& inputsInfo,
+    const tensor_map_t& outputsInfo,
+    size_t networkBatchSize,
+    const tensorflow::serving::PredictRequest* request,
+    tensorflow::serving::PredictResponse* response,
+    std::function<void(Status)> callback,
+    const deadline_t& deadline) {
+    if (networkBatchSize == 0 || request->inputs().empty() || inferRequestsQueues.empty()) {
+        callback(StatusCode::INTERNAL_ERROR);
+        return;
+    }
+    auto context = std::make_shared<SplitBatchContext>();
+    context->networkBatchSize = networkBatchSize;
+    // inputs were validated to have the same batch size
+    context->batchSize = static_cast<size_t>(request->inputs().begin()->second.tensor_shape().dim(0).size());
+    context->request = request;
+    context->response = response;
+    context->callback = std::move(callback);
+    for (const auto& [mappedName, networkInput] : inputsInfo) {
+        auto requestInputIt = request->inputs().find(mappedName);
+        if (requestInputIt == request->inputs().end()) {
+            context->callback(StatusCode::INVALID_MISSING_INPUT);
+            return;
+        }
+        SplitInput input;
+        input.networkInput = networkInput;
+        input.rowByteSize = getRowByteSize(*networkInput);
+        context->inputs.push_back(std::move(input));
+        auto status = stageInput(requestInputIt->second, context->inputs.back(), context->batchSize);
+        if (!status.ok()) {
+            context->callback(status);
+            return;
+        }
+    }
+    for (const auto& [mappedName, networkOutput] : outputsInfo) {
+        if (!isOutputRequested(&request->output_filter(), mappedName)) {
+            continue;
+        }
+        SplitOutput output;
+        output.networkOutput = networkOutput;
+        output.rowByteSize = getRowByteSize(*networkOutput);
+        output.data.resize(context->batchSize * output.rowByteSize);
+        context->outputs.push_back(std::move(output));
+    }
+    const size_t chunks = (context->batchSize + networkBatchSize - 1) / networkBatchSize;
+    context->remainingChunks.store(chunks, std::memory_order_relaxed);
+    SPDLOG_DEBUG("Request with batch size: {} is split into: {} inferences of batch size: {}", context->batchSize, chunks, networkBatchSize);
+    std::vector<const OVInferRequestsQueue*> routedQueues(inferRequestsQueues.begin(), inferRequestsQueues.end());
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        // load of the queues counts streams and waiters taken by previous chunks
+        auto& inferRequestsQueue = *inferRequestsQueues[routedQueues.size() == 1 ? 0 : selectReplica(routedQueues, routing)];
+        inferRequestsQueue.getIdleStream(
+            [context, &inferRequestsQueue, chunk](int streamId) { inferChunk(context, inferRequestsQueue, chunk, streamId); }, deadline);
+    }
+}
+
+Status inferSplitBatch(const std::vector<OVInferRequestsQueue*>& inferRequestsQueues,
+    ReplicaRouting routing,
+    const tensor_map_t& inputsInfo,
+    const tensor_map_t& outputsInfo,
+    size_t networkBatchSize,
+    const tensorflow::serving::PredictRequest* request,
+    tensorflow::serving::PredictResponse* response,
+    const deadline_t& deadline) {
+    std::promise<Status> promise;
+    auto future = promise.get_future();
+    inferSplitBatchAsync(
+        inferRequestsQueues, routing, inputsInfo, outputsInfo, networkBatchSize, request, response,
+        [&promise](Status status) { promise.set_value(status); }, deadline);
+    return future.get();
+}
+
+}  // namespace ovms
@@ -0,0 +1,77 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "deadline.hpp"
+#include "ovinferrequestsqueue.hpp"
+#include "replicarouting.hpp"
+#include "status.hpp"
+#include "tensorinfo.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Starts inference of validated request with batch size different from the network one. Request is cut into chunks
+ * of network batch size along the 0th dimension, the last one zero-padded, and chunks are inferred in parallel on as many
+ * streams as are idle. Valid rows of chunk outputs are concatenated into the response. Request smaller than network batch
+ * is a single padded chunk.
+ *
+ * Streams are taken one by one with non-blocking getIdleStream, so concurrently split requests never wait for each other
+ * while holding streams. Each chunk is routed to the least loaded of the queues, so chunks of a single request are inferred
+ * on all replicas of the model. Chunk is written into the preallocated input blob of the stream, or into the chunk input
+ * blob the stream keeps for split batches.
+ *
+ * @param inferRequestsQueues streams of model instance and of its replicas, inputs blobs are set on infer requests used
+ * @param routing how chunks are routed between the queues
+ * @param inputsInfo model instance inputs, 0th dimension has to be the batch
+ * @param outputsInfo model instance outputs, 0th dimension has to be the batch
+ * @param networkBatchSize
+ * @param request
+ * @param response
+ * @param callback called with the result once all chunks are inferred, request, response, queues and tensor maps have to be valid until then
+ * @param deadline chunks which did not get a stream before it fail the request
+ */
+void inferSplitBatchAsync(const std::vector<OVInferRequestsQueue*>& inferRequestsQueues,
+    ReplicaRouting routing,
+    const tensor_map_t& inputsInfo,
+    const tensor_map_t& outputsInfo,
+    size_t networkBatchSize,
+    const tensorflow::serving::PredictRequest* request,
+    tensorflow::serving::PredictResponse* response,
+    std::function<void(Status)> callback,
+    const deadline_t& deadline = NO_DEADLINE);
+
+/**
+ * @brief Infers validated request with batch size different from the network one and waits for the result
+ */
+Status inferSplitBatch(const std::vector<OVInferRequestsQueue*>& inferRequestsQueues,
+    ReplicaRouting routing,
+    const tensor_map_t& inputsInfo,
+    const tensor_map_t& outputsInfo,
+    size_t networkBatchSize,
+    const tensorflow::serving::PredictRequest* request,
+    tensorflow::serving::PredictResponse* response,
+    const deadline_t& deadline = NO_DEADLINE);
+
+}  // namespace ovms
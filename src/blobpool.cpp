@@ -0,0 +1,75 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "blobpool.hpp"
+
+#include <exception>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "deserialization.hpp"
+
+namespace ovms {
+
+InferenceEngine::Blob::Ptr BlobPool::acquire(const std::string& name, const InferenceEngine::TensorDesc& tensorDesc) {
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        auto& blobs = idleBlobs[name];
+        while (!blobs.empty()) {
+            auto blob = std::move(blobs.back());
+            blobs.pop_back();
+            // network reshape changes dimensions, blobs of previous shape are dropped
+            if (blob->getTensorDesc() == tensorDesc) {
+                return blob;
+            }
+        }
+    }
+    if (remoteContext) {
+        try {
+            return remoteContext->CreateBlob(tensorDesc);
+        } catch (const std::exception& e) {
+            SPDLOG_DEBUG("Cannot allocate device blob: {}; exception message: {}", name, e.what());
+            return nullptr;
+        }
+    }
+    return allocateConvertedBlob(tensorDesc);
+}
+
+InferenceEngine::Blob::Ptr BlobPool::wrap(const std::string& name, InferenceEngine::Blob::Ptr blob) {
+    std::weak_ptr<BlobPool> pool = shared_from_this();
+    auto raw = blob.get();
+    return InferenceEngine::Blob::Ptr(raw, [pool, name, blob = std::move(blob)](InferenceEngine::Blob*) mutable {
+        if (auto existingPool = pool.lock()) {
+            existingPool->release(name, std::move(blob));
+        }
+    });
+}
+
+void BlobPool::release(const std::string& name, InferenceEngine::Blob::Ptr blob) {
+    std::unique_lock<std::mutex> lock(mtx);
+    auto& blobs = idleBlobs[name];
+    if (blobs.size() < maxIdleBlobsPerName) {
+        blobs.push_back(std::move(blob));
+    }
+}
+
+size_t BlobPool::getIdleBlobsCount(const std::string& name) {
+    std::unique_lock<std::mutex> lock(mtx);
+    auto it = idleBlobs.find(name);
+    return it == idleBlobs.end() ? 0 : it->second.size();
+}
+
+}  // namespace ovms
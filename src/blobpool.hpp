@@ -0,0 +1,78 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+namespace ovms {
+
+/**
+ * @brief Keeps spare output blobs of a network so that pipeline nodes can take inference results
+ * away from infer requests without copying them
+ *
+ * Node replaces infer request output with a blob acquired from the pool and passes the original one
+ * to following nodes. The original is returned to the pool once the last of them drops it.
+ * Pool created with remote context allocates blobs in device memory, so that results stay on the device.
+ */
+class BlobPool : public std::enable_shared_from_this<BlobPool> {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param maxIdleBlobsPerName blobs returned above this count are freed
+     * @param remoteContext device memory context blobs are allocated in, host memory is used when not set
+     */
+    BlobPool(size_t maxIdleBlobsPerName, InferenceEngine::RemoteContext::Ptr remoteContext = nullptr) :
+        maxIdleBlobsPerName(maxIdleBlobsPerName),
+        remoteContext(std::move(remoteContext)) {}
+
+    /**
+     * @brief Takes idle blob out of the pool or allocates a new one
+     *
+     * @param name network output name
+     * @param tensorDesc
+     *
+     * @return blob or nullptr if precision is not supported or device blob cannot be allocated
+     */
+    InferenceEngine::Blob::Ptr acquire(const std::string& name, const InferenceEngine::TensorDesc& tensorDesc);
+
+    /**
+     * @brief Gives blob sharing memory with the one passed, which is returned to the pool when the result is released
+     *
+     * @param name network output name
+     * @param blob taken away from infer request
+     */
+    InferenceEngine::Blob::Ptr wrap(const std::string& name, InferenceEngine::Blob::Ptr blob);
+
+    size_t getIdleBlobsCount(const std::string& name);
+
+private:
+    void release(const std::string& name, InferenceEngine::Blob::Ptr blob);
+
+    const size_t maxIdleBlobsPerName;
+    const InferenceEngine::RemoteContext::Ptr remoteContext;
+    std::mutex mtx;
+    std::unordered_map<std::string, std::vector<InferenceEngine::Blob::Ptr>> idleBlobs;
+};
+
+}  // namespace ovms
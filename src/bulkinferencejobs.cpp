@@ -0,0 +1,665 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "bulkinferencejobs.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "filesystem.hpp"
+#include "modelinstance.hpp"
+#include "modelinstanceunloadguard.hpp"
+#include "modelmanager.hpp"
+#include "npyfile.hpp"
+#include "pipeline.hpp"
+#include "prediction_service_utils.hpp"
+#include "samplingprofiler.hpp"
+#include "saturation.hpp"
+
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+namespace ovms {
+
+const char* toString(BulkJobState state) {
+    switch (state) {
+    case BulkJobState::QUEUED:
+        return "QUEUED";
+    case BulkJobState::RUNNING:
+        return "RUNNING";
+    case BulkJobState::SUCCEEDED:
+        return "SUCCEEDED";
+    case BulkJobState::FAILED:
+        return "FAILED";
+    case BulkJobState::CANCELLED:
+        return "CANCELLED";
+    }
+    return "UNKNOWN";
+}
+
+static bool isFinished(BulkJobState state) {
+    return state == BulkJobState::SUCCEEDED || state == BulkJobState::FAILED || state == BulkJobState::CANCELLED;
+}
+
+static bool isCloudPath(const std::string& path) {
+    return path.find("://") != std::string::npos;
+}
+
+/**
+ * @brief Resolves symbolic links of existing part of local path and strips trailing slashes
+ *
+ * @return empty when local path cannot be resolved
+ */
+static std::string normalizePath(const std::string& path) {
+    std::string normalized = path;
+    if (!isCloudPath(path)) {
+        std::error_code ec;
+        normalized = std::filesystem::weakly_canonical(std::filesystem::absolute(path, ec), ec).string();
+        if (ec) {
+            return "";
+        }
+    }
+    while (normalized.size() > 1 && normalized.back() == '/') {
+        normalized.pop_back();
+    }
+    return normalized;
+}
+
+namespace {
+
+/**
+ * @brief Writes outputs of a shard in batch order as its batches are inferred
+ *
+ * Outputs on local storage are appended to their files. Cloud storages store whole objects,
+ * so outputs written there are collected and stored when the shard is done.
+ * Files of a shard which is not finished are removed.
+ */
+class ShardOutputWriter {
+public:
+    ShardOutputWriter(const std::string& outputPath, const std::string& shard, size_t records, size_t window) :
+        outputPath(outputPath),
+        shard(shard),
+        records(records),
+        window(window),
+        local(!isCloudPath(outputPath)),
+        fs(ModelManager::getFilesystem(outputPath)) {}
+
+    ~ShardOutputWriter() {
+        if (finished || !local) {
+            return;
+        }
+        for (auto& [name, output] : outputs) {
+            output.file.close();
+            std::error_code ec;
+            std::filesystem::remove(output.path, ec);
+        }
+    }
+
+    /**
+     * @brief Waits until batch is less than window batches ahead of the next batch to write,
+     * which bounds responses kept until the batches before them are inferred
+     *
+     * @return false when writing failed or was aborted
+     */
+    bool waitForTurn(size_t batch) {
+        std::unique_lock lock(mtx);
+        turnCondition.wait(lock, [this, batch]() { return aborted || batch < nextBatch + window; });
+        return !aborted;
+    }
+
+    /**
+     * @brief Stops batches waiting for their turn, used when inference fails or job is cancelled
+     */
+    void abort() {
+        {
+            std::unique_lock lock(mtx);
+            aborted = true;
+        }
+        turnCondition.notify_all();
+    }
+
+    Status write(size_t batch, size_t batchSize, PredictResponse&& response) {
+        std::unique_lock lock(mtx);
+        if (aborted) {
+            return StatusCode::OK;
+        }
+        pending.emplace(batch, std::make_pair(batchSize, std::move(response)));
+        Status status;
+        while (!pending.empty() && pending.begin()->first == nextBatch) {
+            status = append(pending.begin()->second.first, pending.begin()->second.second);
+            pending.erase(pending.begin());
+            if (!status.ok()) {
+                aborted = true;
+                break;
+            }
+            ++nextBatch;
+        }
+        lock.unlock();
+        turnCondition.notify_all();
+        return status;
+    }
+
+    /**
+     * @brief Closes local files and stores cloud objects once all batches are written
+     */
+    Status finish(size_t batches) {
+        if (aborted || nextBatch != batches) {
+            return Status(StatusCode::INTERNAL_ERROR, "not all batches of the shard were written");
+        }
+        for (auto& [name, output] : outputs) {
+            if (local) {
+                output.file.close();
+                if (!output.file) {
+                    return Status(StatusCode::FILESYSTEM_ERROR, output.path);
+                }
+                continue;
+            }
+            auto code = fs->writeFile(output.path, output.content);
+            if (code != StatusCode::OK) {
+                return Status(code, output.path);
+            }
+        }
+        finished = true;
+        return StatusCode::OK;
+    }
+
+private:
+    struct Output {
+        std::string path;
+        tensorflow::DataType dtype;
+        tensorflow::TensorShapeProto shape;
+        size_t entrySize = 0;
+        std::ofstream file;
+        std::string content;
+    };
+
+    // first batch defines outputs, header of each is written with number of records of the shard
+    Status open(const PredictResponse& response) {
+        for (const auto& [name, proto] : response.outputs()) {
+            if (proto.tensor_shape().dim_size() < 1) {
+                return Status(StatusCode::INVALID_BATCH_SIZE, "output: " + name + " cannot be merged along 0th dimension");
+            }
+            auto& output = outputs[name];
+            output.path = fs->joinPath({outputPath, name, shard});
+            output.dtype = proto.dtype();
+            output.shape = proto.tensor_shape();
+            output.shape.mutable_dim(0)->set_size(records);
+            output.entrySize = tensorflow::DataTypeSize(proto.dtype());
+            for (int i = 1; i < output.shape.dim_size(); ++i) {
+                output.entrySize *= output.shape.dim(i).size();
+            }
+            std::string header;
+            auto status = serializeNpyHeader(output.dtype, output.shape, header);
+            if (!status.ok()) {
+                return Status(status.getCode(), "output: " + name + "; " + status.string());
+            }
+            if (!local) {
+                output.content = std::move(header);
+                output.content.reserve(output.content.size() + records * output.entrySize);
+                continue;
+            }
+            std::error_code ec;
+            std::filesystem::create_directories(std::filesystem::path(output.path).parent_path(), ec);
+            output.file.open(output.path, std::ios::out | std::ios::binary | std::ios::trunc);
+            output.file.write(header.data(), header.size());
+            if (ec || !output.file) {
+                return Status(StatusCode::FILESYSTEM_ERROR, output.path);
+            }
+        }
+        return StatusCode::OK;
+    }
+
+    Status append(size_t batchSize, const PredictResponse& response) {
+        if (outputs.empty()) {
+            auto status = open(response);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+        if (static_cast<size_t>(response.outputs_size()) != outputs.size()) {
+            return Status(StatusCode::INVALID_BATCH_SIZE, "outputs of batches cannot be merged along 0th dimension");
+        }
+        for (auto& [name, output] : outputs) {
+            auto it = response.outputs().find(name);
+            if (it == response.outputs().end() || it->second.dtype() != output.dtype ||
+                it->second.tensor_shape().dim_size() != output.shape.dim_size() ||
+                it->second.tensor_shape().dim(0).size() != static_cast<int64_t>(batchSize) ||
+                it->second.tensor_content().size() != batchSize * output.entrySize) {
+                return Status(StatusCode::INVALID_BATCH_SIZE, "output: " + name + " cannot be merged along 0th dimension");
+            }
+            const auto& content = it->second.tensor_content();
+            if (!local) {
+                output.content.append(content);
+                continue;
+            }
+            output.file.write(content.data(), content.size());
+            if (!output.file) {
+                return Status(StatusCode::FILESYSTEM_ERROR, output.path);
+            }
+        }
+        return StatusCode::OK;
+    }
+
+    const std::string outputPath;
+    const std::string shard;
+    const size_t records;
+    const size_t window;
+    const bool local;
+    std::shared_ptr<FileSystem> fs;
+
+    std::mutex mtx;
+    std::condition_variable turnCondition;
+    // inferred batches waiting for the batches before them, batch to its size and response
+    std::map<size_t, std::pair<size_t, PredictResponse>> pending;
+    size_t nextBatch = 0;
+    bool aborted = false;
+    bool finished = false;
+    std::map<std::string, Output> outputs;
+};
+
+}  // namespace
+
+BulkInferenceJobs& BulkInferenceJobs::instance() {
+    // manager is constructed first, so it is destroyed after the jobs
+    static BulkInferenceJobs instance(ModelManager::getInstance());
+    return instance;
+}
+
+BulkInferenceJobs::BulkInferenceJobs(ModelManager& manager) :
+    manager(manager) {}
+
+Status BulkInferenceJobs::configure(bool enabled, const std::string& root) {
+    if (!enabled) {
+        this->enabled = false;
+        return StatusCode::OK;
+    }
+    const std::string normalized = root.empty() || FileSystem::isPathEscaped(root) ? "" : normalizePath(root);
+    if (normalized.empty()) {
+        SPDLOG_ERROR("Bulk inference jobs require a root directory, got: {}", root);
+        return Status(StatusCode::PATH_INVALID, "bulk jobs root: " + root);
+    }
+    {
+        std::unique_lock lock(mtx);
+        this->root = normalized;
+    }
+    this->enabled = true;
+    SPDLOG_INFO("Bulk inference jobs are accepted for inputs and outputs inside of: {}", normalized);
+    return StatusCode::OK;
+}
+
+bool BulkInferenceJobs::isInsideRoot(const std::string& path) const {
+    if (FileSystem::isPathEscaped(path) || isCloudPath(path) != isCloudPath(root)) {
+        return false;
+    }
+    const std::string normalized = normalizePath(path);
+    if (normalized.empty()) {
+        return false;
+    }
+    const std::string prefix = root.back() == '/' ? root : root + "/";
+    return normalized == root || normalized.compare(0, prefix.size(), prefix) == 0;
+}
+
+BulkInferenceJobs::~BulkInferenceJobs() {
+    {
+        std::unique_lock lock(mtx);
+        stopRequested = true;
+        for (auto& [id, job] : jobs) {
+            job->cancelRequested = true;
+        }
+    }
+    jobsCondition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+Status BulkInferenceJobs::submit(const BulkJobSpec& spec, uint64_t& id) {
+    if (!enabled) {
+        return StatusCode::BULK_JOBS_DISABLED;
+    }
+    if (spec.inputs.empty()) {
+        return Status(StatusCode::INVALID_NO_OF_INPUTS, "bulk job requires at least one input directory");
+    }
+    auto job = std::make_shared<Job>();
+    job->status.spec = spec;
+    job->status.submitted = std::chrono::system_clock::now();
+    {
+        std::unique_lock lock(mtx);
+        if (!isInsideRoot(spec.outputPath)) {
+            return Status(StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT, spec.outputPath);
+        }
+        for (const auto& [name, directory] : spec.inputs) {
+            if (!isInsideRoot(directory)) {
+                return Status(StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT, directory);
+            }
+        }
+        id = nextId++;
+        job->status.id = id;
+        jobs.emplace(id, job);
+        queue.push_back(std::move(job));
+        if (!worker.joinable()) {
+            worker = std::thread(&BulkInferenceJobs::run, this);
+        }
+    }
+    SPDLOG_INFO("Bulk inference job: {} queued; servable: {}; output: {}", id, spec.servableName, spec.outputPath);
+    jobsCondition.notify_all();
+    return StatusCode::OK;
+}
+
+Status BulkInferenceJobs::getStatus(uint64_t id, BulkJobStatus& status) const {
+    std::unique_lock lock(mtx);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return StatusCode::BULK_JOB_NOT_FOUND;
+    }
+    status = it->second->status;
+    return StatusCode::OK;
+}
+
+std::vector<BulkJobStatus> BulkInferenceJobs::list() const {
+    std::unique_lock lock(mtx);
+    std::vector<BulkJobStatus> result;
+    result.reserve(jobs.size());
+    for (const auto& [id, job] : jobs) {
+        result.push_back(job->status);
+    }
+    return result;
+}
+
+Status BulkInferenceJobs::cancel(uint64_t id) {
+    std::unique_lock lock(mtx);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return StatusCode::BULK_JOB_NOT_FOUND;
+    }
+    auto& job = *it->second;
+    if (isFinished(job.status.state)) {
+        return StatusCode::BULK_JOB_FINISHED;
+    }
+    job.cancelRequested = true;
+    if (job.status.state == BulkJobState::QUEUED) {
+        queue.erase(std::remove(queue.begin(), queue.end(), it->second), queue.end());
+        job.status.state = BulkJobState::CANCELLED;
+        job.status.finished = std::chrono::system_clock::now();
+        lock.unlock();
+        jobsCondition.notify_all();
+    }
+    SPDLOG_INFO("Bulk inference job: {} cancelled", id);
+    return StatusCode::OK;
+}
+
+bool BulkInferenceJobs::wait(uint64_t id, std::chrono::milliseconds timeout) const {
+    std::unique_lock lock(mtx);
+    return jobsCondition.wait_for(lock, timeout, [this, id]() {
+        auto it = jobs.find(id);
+        return it == jobs.end() || isFinished(it->second->status.state);
+    });
+}
+
+void BulkInferenceJobs::updateStatus(Job& job, const std::function<void(BulkJobStatus&)>& update) {
+    std::unique_lock lock(mtx);
+    update(job.status);
+}
+
+void BulkInferenceJobs::run() {
+    setCurrentThreadName("ovms_bulk_jobs");
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock lock(mtx);
+            jobsCondition.wait(lock, [this]() { return stopRequested || !queue.empty(); });
+            if (stopRequested) {
+                return;
+            }
+            job = queue.front();
+            queue.pop_front();
+            job->status.state = BulkJobState::RUNNING;
+            job->status.started = std::chrono::system_clock::now();
+        }
+        const auto status = execute(*job);
+        {
+            std::unique_lock lock(mtx);
+            job->status.finished = std::chrono::system_clock::now();
+            if (job->cancelRequested) {
+                job->status.state = BulkJobState::CANCELLED;
+            } else if (status.ok()) {
+                job->status.state = BulkJobState::SUCCEEDED;
+            } else {
+                job->status.state = BulkJobState::FAILED;
+                job->status.error = status.string();
+            }
+            // oldest finished jobs are forgotten first, ids grow with submission order
+            size_t finishedJobs = std::count_if(jobs.begin(), jobs.end(), [](const auto& entry) { return isFinished(entry.second->status.state); });
+            for (auto it = jobs.begin(); it != jobs.end() && finishedJobs > BULK_JOB_HISTORY_SIZE;) {
+                if (isFinished(it->second->status.state)) {
+                    it = jobs.erase(it);
+                    --finishedJobs;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        SPDLOG_INFO("Bulk inference job: {} finished; {}", job->status.id, status.string());
+        jobsCondition.notify_all();
+    }
+}
+
+Status BulkInferenceJobs::execute(Job& job) {
+    const auto& spec = job.status.spec;
+    Target target;
+    auto status = resolveTarget(spec, target);
+    if (!status.ok()) {
+        return status;
+    }
+    std::vector<std::string> shards;
+    status = listShards(spec, shards);
+    if (!status.ok()) {
+        return status;
+    }
+    updateStatus(job, [&shards](BulkJobStatus& jobStatus) { jobStatus.shardsTotal = shards.size(); });
+    SPDLOG_INFO("Bulk inference job: {} started; servable: {}; shards: {}; batch size: {}; parallelism: {}",
+        job.status.id, spec.servableName, shards.size(), target.batchSize, target.parallelism);
+    for (const auto& shard : shards) {
+        if (job.cancelRequested) {
+            return StatusCode::OK;
+        }
+        status = processShard(job, target, shard);
+        if (!status.ok()) {
+            return Status(status.getCode(), "shard: " + shard + "; " + status.string());
+        }
+        updateStatus(job, [](BulkJobStatus& jobStatus) { ++jobStatus.shardsDone; });
+    }
+    return StatusCode::OK;
+}
+
+Status BulkInferenceJobs::resolveTarget(const BulkJobSpec& spec, Target& target) {
+    auto instance = manager.findModelInstance(spec.servableName, spec.version);
+    if (instance) {
+        target.pipeline = false;
+        target.version = instance->getVersion();
+        target.batchSize = spec.batchSize > 0 ? spec.batchSize : std::max<size_t>(1, instance->getBatchSize());
+        target.parallelism = spec.parallelism > 0 ? spec.parallelism : std::max<size_t>(1, instance->getInferRequestsQueue().getInferRequestsCount());
+        return StatusCode::OK;
+    }
+    if (manager.pipelineDefinitionExists(spec.servableName)) {
+        target.pipeline = true;
+        target.batchSize = spec.batchSize > 0 ? spec.batchSize : 1;
+        target.parallelism = spec.parallelism > 0 ? spec.parallelism : 1;
+        return StatusCode::OK;
+    }
+    return StatusCode::MODEL_MISSING;
+}
+
+Status BulkInferenceJobs::listShards(const BulkJobSpec& spec, std::vector<std::string>& shards) {
+    const auto& directory = spec.inputs.begin()->second;
+    auto fs = ModelManager::getFilesystem(directory);
+    files_list_t files;
+    auto code = fs->getDirectoryFiles(directory, &files);
+    if (code != StatusCode::OK) {
+        return Status(code, directory);
+    }
+    const std::string extension = ".npy";
+    for (const auto& file : files) {
+        // local storage lists full paths, cloud storages list names
+        const std::string name = file.substr(file.find_last_of('/') + 1);
+        if (name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+            shards.push_back(name);
+        }
+    }
+    if (shards.empty()) {
+        return Status(StatusCode::BULK_JOB_NO_SHARDS, directory);
+    }
+    std::sort(shards.begin(), shards.end());
+    return StatusCode::OK;
+}
+
+Status BulkInferenceJobs::processShard(Job& job, const Target& target, const std::string& shard) {
+    const auto& spec = job.status.spec;
+    std::map<std::string, tensorflow::TensorProto> inputs;
+    size_t records = 0;
+    for (const auto& [name, directory] : spec.inputs) {
+        auto fs = ModelManager::getFilesystem(directory);
+        const std::string path = fs->joinPath({directory, shard});
+        std::string content;
+        auto code = fs->readFileToMemory(path, &content);
+        if (code != StatusCode::OK) {
+            return Status(code, path);
+        }
+        auto& proto = inputs[name];
+        auto status = parseNpy(content, proto);
+        if (!status.ok()) {
+            return Status(status.getCode(), path + ": " + status.string());
+        }
+        const int64_t entries = proto.tensor_shape().dim_size() > 0 ? proto.tensor_shape().dim(0).size() : 0;
+        if (entries <= 0 || (records != 0 && records != static_cast<size_t>(entries))) {
+            return Status(StatusCode::INVALID_BATCH_SIZE, path + " has to have the same positive number of records as other inputs");
+        }
+        records = entries;
+    }
+
+    const size_t batches = (records + target.batchSize - 1) / target.batchSize;
+    ShardOutputWriter writer(spec.outputPath, shard, records, 2 * target.parallelism);
+    std::atomic<size_t> nextBatch{0};
+    std::atomic<bool> failed{false};
+    std::mutex errorMtx;
+    Status error;
+    auto inferBatches = [&]() {
+        PredictRequest request;
+        PredictResponse response;
+        for (size_t batch = nextBatch++; batch < batches && !failed; batch = nextBatch++) {
+            if (!writer.waitForTurn(batch)) {
+                return;
+            }
+            if (!waitForSpareCapacity(job, target)) {
+                writer.abort();
+                return;
+            }
+            const size_t first = batch * target.batchSize;
+            const size_t batchSize = std::min(target.batchSize, records - first);
+            request.Clear();
+            request.mutable_model_spec()->set_name(spec.servableName);
+            if (!target.pipeline) {
+                request.mutable_model_spec()->mutable_version()->set_value(target.version);
+            }
+            Status status;
+            for (const auto& [name, proto] : inputs) {
+                status = sliceBatch(proto, first, batchSize, (*request.mutable_inputs())[name]);
+                if (!status.ok()) {
+                    break;
+                }
+            }
+            if (status.ok()) {
+                response.Clear();
+                status = inferBatch(job, target, request, response);
+            }
+            if (status.ok()) {
+                status = writer.write(batch, batchSize, std::move(response));
+            }
+            if (!status.ok()) {
+                writer.abort();
+                std::unique_lock lock(errorMtx);
+                if (!failed.exchange(true)) {
+                    error = status;
+                }
+                return;
+            }
+            updateStatus(job, [batchSize](BulkJobStatus& jobStatus) {
+                ++jobStatus.batchesDone;
+                jobStatus.recordsDone += batchSize;
+            });
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(target.parallelism, batches); ++i) {
+        threads.emplace_back(inferBatches);
+    }
+    inferBatches();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        return error;
+    }
+    if (job.cancelRequested) {
+        return StatusCode::OK;
+    }
+    return writer.finish(batches);
+}
+
+Status BulkInferenceJobs::inferBatch(Job& job, const Target& target, const PredictRequest& request, PredictResponse& response) {
+    if (target.pipeline) {
+        std::unique_ptr<Pipeline> pipeline;
+        auto status = getPipeline(manager, pipeline, &request, &response);
+        if (!status.ok()) {
+            return status;
+        }
+        return pipeline->execute();
+    }
+    std::shared_ptr<ModelInstance> instance;
+    std::unique_ptr<ModelInstanceUnloadGuard> unloadGuard;
+    auto status = getModelInstance(manager, job.status.spec.servableName, target.version, instance, unloadGuard);
+    if (!status.ok()) {
+        return status;
+    }
+    return inference(*instance, &request, &response, unloadGuard);
+}
+
+bool BulkInferenceJobs::waitForSpareCapacity(Job& job, const Target& target) {
+    while (!job.cancelRequested) {
+        bool spare = true;
+        if (target.pipeline) {
+            spare = SaturationMonitor::instance().measure(manager).saturation < 1.0;
+        } else {
+            auto instance = manager.findModelInstance(job.status.spec.servableName, target.version);
+            ModelSaturation saturation;
+            // unavailable model is reported by the inference
+            if (instance && instance->getSaturation(saturation)) {
+                spare = saturation.waitingRequests == 0 && saturation.idleStreams > 0;
+            }
+        }
+        if (spare) {
+            return true;
+        }
+        updateStatus(job, [](BulkJobStatus& jobStatus) { ++jobStatus.yields; });
+        std::this_thread::sleep_for(BULK_JOB_BACKOFF);
+    }
+    return false;
+}
+
+}  // namespace ovms
@@ -0,0 +1,220 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "model_version_policy.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+class ModelManager;
+
+enum class BulkJobState {
+    QUEUED,
+    RUNNING,
+    SUCCEEDED,
+    FAILED,
+    CANCELLED
+};
+
+const char* toString(BulkJobState state);
+
+/**
+ * @brief Dataset and servable of a bulk inference job
+ *
+ * Every input reads shards from its own directory on any storage supported by FileSystem. Shards are .npy files,
+ * a shard named the same in all input directories forms one set of records split along 0th dimension.
+ * Outputs of each shard are stored as <outputPath>/<output name>/<shard name>.
+ */
+struct BulkJobSpec {
+    // model or pipeline
+    std::string servableName;
+    model_version_t version = 0;
+    // input name to directory with its shards
+    std::map<std::string, std::string> inputs;
+    std::string outputPath;
+    // records in one inference, 0 uses batch size of the model and 1 for pipelines
+    size_t batchSize = 0;
+    // inferences in flight at once, 0 uses number of infer requests of the model and 1 for pipelines
+    size_t parallelism = 0;
+};
+
+struct BulkJobStatus {
+    uint64_t id = 0;
+    BulkJobSpec spec;
+    BulkJobState state = BulkJobState::QUEUED;
+    size_t shardsTotal = 0;
+    size_t shardsDone = 0;
+    uint64_t recordsDone = 0;
+    uint64_t batchesDone = 0;
+    // times the job waited for live traffic to leave spare capacity
+    uint64_t yields = 0;
+    std::string error;
+    std::chrono::system_clock::time_point submitted;
+    std::chrono::system_clock::time_point started;
+    std::chrono::system_clock::time_point finished;
+};
+
+/**
+ * @brief Time a job waits before checking for spare capacity again
+ */
+const std::chrono::milliseconds BULK_JOB_BACKOFF{5};
+
+/**
+ * @brief Number of finished jobs kept for status requests, older ones are forgotten
+ */
+constexpr size_t BULK_JOB_HISTORY_SIZE = 100;
+
+/**
+ * @brief Streams datasets from storage through batched inference of models and pipelines on spare capacity
+ *
+ * Jobs are executed one at a time in submission order by a single thread, each shard is inferred by parallelism threads
+ * and outputs of its batches are written in order as they are inferred.
+ * Live traffic has priority: a batch of a model is started only when no predict request waits for a stream of the model
+ * and one of its streams is idle, a batch of a pipeline when streams of all models are not saturated.
+ */
+class BulkInferenceJobs {
+public:
+    /**
+     * @brief Jobs of the server, using models of ModelManager::getInstance
+     */
+    static BulkInferenceJobs& instance();
+
+    explicit BulkInferenceJobs(ModelManager& manager);
+
+    /**
+     * @brief Jobs read and write storage on behalf of REST clients, so they are rejected until enabled with a root
+     *
+     * @param enabled
+     * @param root local directory or cloud storage location, inputs and outputs of jobs have to be inside of it
+     *
+     * @return Status
+     */
+    Status configure(bool enabled, const std::string& root);
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    /**
+     * @brief Cancels running job and forgets queued ones
+     */
+    ~BulkInferenceJobs();
+
+    BulkInferenceJobs(const BulkInferenceJobs&) = delete;
+    BulkInferenceJobs& operator=(const BulkInferenceJobs&) = delete;
+
+    /**
+     * @brief Queues job, dataset is checked once it is started
+     *
+     * Inputs and output have to be inside of the root, local paths are compared after resolving symbolic links.
+     *
+     * @param spec
+     * @param id assigned to the job
+     *
+     * @return Status
+     */
+    Status submit(const BulkJobSpec& spec, uint64_t& id);
+
+    Status getStatus(uint64_t id, BulkJobStatus& status) const;
+
+    std::vector<BulkJobStatus> list() const;
+
+    /**
+     * @brief Stops job after batches in flight are done, shards already written are kept
+     */
+    Status cancel(uint64_t id);
+
+    /**
+     * @brief Waits until job is finished
+     *
+     * @return false on timeout
+     */
+    bool wait(uint64_t id, std::chrono::milliseconds timeout) const;
+
+private:
+    struct Job {
+        BulkJobStatus status;
+        std::atomic<bool> cancelRequested{false};
+    };
+
+    /**
+     * @brief Servable resolved when the job starts
+     */
+    struct Target {
+        bool pipeline = false;
+        model_version_t version = 0;
+        size_t batchSize = 1;
+        size_t parallelism = 1;
+    };
+
+    void run();
+
+    Status execute(Job& job);
+
+    Status resolveTarget(const BulkJobSpec& spec, Target& target);
+
+    Status listShards(const BulkJobSpec& spec, std::vector<std::string>& shards);
+
+    Status processShard(Job& job, const Target& target, const std::string& shard);
+
+    Status inferBatch(Job& job, const Target& target, const tensorflow::serving::PredictRequest& request,
+        tensorflow::serving::PredictResponse& response);
+
+    /**
+     * @brief Waits until live traffic leaves spare capacity for the next batch
+     *
+     * @return false when job is cancelled meanwhile
+     */
+    bool waitForSpareCapacity(Job& job, const Target& target);
+
+    void updateStatus(Job& job, const std::function<void(BulkJobStatus&)>& update);
+
+    bool isInsideRoot(const std::string& path) const;
+
+    ModelManager& manager;
+    std::atomic<bool> enabled{false};
+    // guarded by mtx, local root is canonical
+    std::string root;
+
+    mutable std::mutex mtx;
+    mutable std::condition_variable jobsCondition;
+    std::map<uint64_t, std::shared_ptr<Job>> jobs;
+    std::deque<std::shared_ptr<Job>> queue;
+    uint64_t nextId = 1;
+    bool stopRequested = false;
+    std::thread worker;
+};
+
+}  // namespace ovms
@@ -0,0 +1,152 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "chunkedpredictrequest.hpp"
+
+#include <cstring>
+#include <limits>
+#include <new>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow/core/framework/types.h"
+#pragma GCC diagnostic pop
+
+#include "deserialization.hpp"
+#include "sharedmemory.hpp"
+
+namespace ovms {
+
+static bool isStreamedInput(const tensorflow::TensorProto& proto) {
+    return proto.dtype() != tensorflow::DataType::DT_STRING &&
+           proto.dtype() != tensorflow::DataType::DT_INVALID &&
+           proto.tensor_content().empty() &&
+           proto.string_val_size() == 0 &&
+           getRepeatedFieldValueCount(proto) == 0;
+}
+
+bool ChunkedRequestsBudget::reserve(size_t bytes) {
+    size_t current = reserved.load(std::memory_order_relaxed);
+    do {
+        if (bytes > byteSize || current > byteSize - bytes) {
+            return false;
+        }
+    } while (!reserved.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+    return true;
+}
+
+Status ChunkedPredictRequest::start(tensorflow::serving::PredictRequest&& header) {
+    if (started) {
+        SPDLOG_DEBUG("Chunked request is already started");
+        return StatusCode::MALFORMED_REQUEST_MESSAGE;
+    }
+    started = true;
+    request = std::move(header);
+    for (auto& [name, proto] : *request.mutable_inputs()) {
+        if (!isStreamedInput(proto)) {
+            continue;
+        }
+        const size_t elementSize = tensorflow::DataTypeSize(proto.dtype());
+        if (elementSize == 0) {
+            continue;
+        }
+        size_t byteSize = elementSize;
+        for (const auto& dim : proto.tensor_shape().dim()) {
+            if (dim.size() < 0) {
+                return StatusCode::INVALID_SHAPE;
+            }
+            if (dim.size() > 0 && byteSize > std::numeric_limits<size_t>::max() / static_cast<size_t>(dim.size())) {
+                return StatusCode::CHUNKED_REQUEST_TOO_LARGE;
+            }
+            byteSize *= static_cast<size_t>(dim.size());
+        }
+        if (byteSize == 0) {
+            continue;
+        }
+        if (byteSize > maxByteSize - streamedByteSize) {
+            SPDLOG_DEBUG("Chunked request inputs exceed limit: {} bytes", maxByteSize);
+            return StatusCode::CHUNKED_REQUEST_TOO_LARGE;
+        }
+        streamedByteSize += byteSize;
+        streamedInputs[name] = {&proto, nullptr, byteSize, 0};
+        proto.add_string_val(sharedMemoryReferenceToString({MESSAGE_TENSOR_REGION_NAME, 0, byteSize}));
+    }
+    SPDLOG_DEBUG("Chunked request for model: {} streams {} inputs of {} bytes", request.model_spec().name(), streamedInputs.size(), streamedByteSize);
+    return StatusCode::OK;
+}
+
+Status ChunkedPredictRequest::allocate(const std::string& inputName, StreamedInput& input) {
+    if (budget && !budget->reserve(input.byteSize)) {
+        SPDLOG_DEBUG("Chunked input: {} of {} bytes exceeds memory left for chunked requests", inputName, input.byteSize);
+        return StatusCode::CHUNKED_REQUEST_TOO_LARGE;
+    }
+    auto sharedBudget = budget;
+    const size_t byteSize = input.byteSize;
+    // not initialized, each byte is written once by received chunks; blobs wrapping it may outlive the request
+    std::shared_ptr<char> memory(new (std::nothrow) char[byteSize], [sharedBudget, byteSize](char* data) {
+        delete[] data;
+        if (sharedBudget) {
+            sharedBudget->release(byteSize);
+        }
+    });
+    if (!memory) {
+        SPDLOG_DEBUG("Allocating {} bytes for chunked input: {} failed", byteSize, inputName);
+        return StatusCode::CHUNKED_REQUEST_TOO_LARGE;
+    }
+    input.data = memory.get();
+    tensors.add(input.proto, SharedMemoryRegion::wrap(inputName, memory.get(), byteSize, memory));
+    return StatusCode::OK;
+}
+
+Status ChunkedPredictRequest::append(const std::string& inputName, const std::string& data) {
+    auto it = streamedInputs.find(inputName);
+    if (it == streamedInputs.end()) {
+        SPDLOG_DEBUG("Chunk of input: {} which is not streamed", inputName);
+        return StatusCode::INVALID_MISSING_INPUT;
+    }
+    auto& input = it->second;
+    if (data.size() > input.byteSize - input.received) {
+        SPDLOG_DEBUG("Chunks of input: {} exceed its size: {} bytes", inputName, input.byteSize);
+        return StatusCode::INVALID_CONTENT_SIZE;
+    }
+    if (input.data == nullptr) {
+        auto status = allocate(inputName, input);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    std::memcpy(input.data + input.received, data.data(), data.size());
+    input.received += data.size();
+    return StatusCode::OK;
+}
+
+Status ChunkedPredictRequest::finish() const {
+    if (!started) {
+        SPDLOG_DEBUG("Chunked request has no request in the first chunk");
+        return StatusCode::MALFORMED_REQUEST_MESSAGE;
+    }
+    for (const auto& [name, input] : streamedInputs) {
+        if (input.received != input.byteSize) {
+            SPDLOG_DEBUG("Received {} of {} bytes of chunked input: {}", input.received, input.byteSize, name);
+            return StatusCode::INVALID_CONTENT_SIZE;
+        }
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
@@ -0,0 +1,157 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "inplacerequestparser.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Default limit of the summed size of inputs of a single chunked request
+ */
+const size_t DEFAULT_CHUNKED_REQUEST_MAX_MB = 1024;
+
+/**
+ * @brief Default limit of memory of inputs of all chunked requests received at once
+ */
+const size_t DEFAULT_CHUNKED_REQUESTS_BUDGET_MB = 4096;
+
+/**
+ * @brief Default time to receive all chunks of a request, a request without them fails and releases its memory
+ */
+const std::chrono::seconds DEFAULT_CHUNKED_REQUEST_READ_TIMEOUT{60};
+
+/**
+ * @brief Limits memory of streamed inputs of all chunked requests, shared by the requests of a service
+ */
+class ChunkedRequestsBudget {
+public:
+    explicit ChunkedRequestsBudget(size_t byteSize) :
+        byteSize(byteSize) {}
+
+    /**
+     * @return false when bytes do not fit into the budget left by other requests
+     */
+    bool reserve(size_t bytes);
+
+    void release(size_t bytes) {
+        reserved.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    size_t getReservedByteSize() const {
+        return reserved.load(std::memory_order_relaxed);
+    }
+
+private:
+    const size_t byteSize;
+    std::atomic<size_t> reserved{0};
+};
+
+/**
+ * @brief Assembles PredictRequest received in chunks of PredictChunked call
+ *
+ * The first chunk carries the request. Its inputs without values are streamed: their size is checked from the dtype
+ * and shape, but memory for their content is allocated and taken from the budget only when their first chunk arrives.
+ * Chunks are copied into it as they are received, so each byte is copied once while the rest of the request is still
+ * being transferred. Streamed inputs are replaced with "shm:@message:0:<byte size>" references, so the allocated memory
+ * is wrapped into input blobs without another copy when precision and layout match.
+ */
+class ChunkedPredictRequest {
+public:
+    /**
+     * @param maxByteSize limit of summed size of streamed inputs
+     * @param budget memory shared with other requests, unlimited when not set
+     */
+    explicit ChunkedPredictRequest(size_t maxByteSize, std::shared_ptr<ChunkedRequestsBudget> budget = nullptr) :
+        maxByteSize(maxByteSize),
+        budget(std::move(budget)) {}
+
+    ChunkedPredictRequest(const ChunkedPredictRequest&) = delete;
+    ChunkedPredictRequest& operator=(const ChunkedPredictRequest&) = delete;
+
+    /**
+     * @brief Takes the request of the first chunk and checks sizes of its streamed inputs
+     */
+    Status start(tensorflow::serving::PredictRequest&& header);
+
+    /**
+     * @brief Copies chunk data after previously received data of the input, allocating the input at its first chunk
+     *
+     * @return Status CHUNKED_REQUEST_TOO_LARGE when the input does not fit into the budget
+     */
+    Status append(const std::string& inputName, const std::string& data);
+
+    /**
+     * @brief Checks that content of all streamed inputs was received
+     */
+    Status finish() const;
+
+    bool isStarted() const {
+        return started;
+    }
+
+    /**
+     * @brief Summed size of streamed inputs declared by the first chunk
+     */
+    size_t getStreamedByteSize() const {
+        return streamedByteSize;
+    }
+
+    const tensorflow::serving::PredictRequest& getRequest() const {
+        return request;
+    }
+
+    /**
+     * @brief Copies streamed inputs which the model converts into tensor_content, see InPlaceRequestTensors::copyConvertedInputs
+     */
+    void copyConvertedInputs(const tensor_map_t& inputsInfo) {
+        tensors.copyConvertedInputs(request, inputsInfo);
+    }
+
+private:
+    struct StreamedInput {
+        const tensorflow::TensorProto* proto = nullptr;
+        char* data = nullptr;
+        size_t byteSize = 0;
+        size_t received = 0;
+    };
+
+    Status allocate(const std::string& inputName, StreamedInput& input);
+
+    const size_t maxByteSize;
+    const std::shared_ptr<ChunkedRequestsBudget> budget;
+    bool started = false;
+    size_t streamedByteSize = 0;
+
+    tensorflow::serving::PredictRequest request;
+    std::map<std::string, StreamedInput> streamedInputs;
+    // declared after request, so tensors are unregistered before request is destroyed
+    InPlaceRequestTensors tensors;
+};
+
+}  // namespace ovms
@@ -0,0 +1,86 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "cloudlistingcache.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ovms {
+
+namespace {
+std::string appendSlash(const std::string& path) {
+    return (path.empty() || path.back() == '/') ? path : path + "/";
+}
+
+bool startsWith(const std::string& text, const std::string& prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+}  // namespace
+
+void CloudListingCache::store(const std::string& prefix, std::vector<std::string> keys) {
+    std::sort(keys.begin(), keys.end());
+    std::lock_guard<std::mutex> lock(mutex);
+    listings[appendSlash(prefix)] = std::move(keys);
+}
+
+void CloudListingCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    listings.clear();
+}
+
+const std::vector<std::string>* CloudListingCache::findListing(const std::string& directory) const {
+    for (const auto& [prefix, keys] : listings) {
+        if (startsWith(directory, prefix)) {
+            return &keys;
+        }
+    }
+    return nullptr;
+}
+
+bool CloudListingCache::isDirectory(const std::string& path, bool* isDirectory) const {
+    const std::string directory = appendSlash(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto* keys = findListing(directory);
+    if (keys == nullptr) {
+        return false;
+    }
+    auto it = std::lower_bound(keys->begin(), keys->end(), directory);
+    *isDirectory = it != keys->end() && startsWith(*it, directory);
+    return true;
+}
+
+bool CloudListingCache::getDirectorySubdirs(const std::string& path, std::set<std::string>* subdirs) const {
+    const std::string directory = appendSlash(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto* keys = findListing(directory);
+    if (keys == nullptr) {
+        return false;
+    }
+    for (auto it = std::lower_bound(keys->begin(), keys->end(), directory); it != keys->end() && startsWith(*it, directory); ++it) {
+        const size_t end = it->find('/', directory.size());
+        if (end != std::string::npos && end > directory.size()) {
+            subdirs->insert(it->substr(directory.size(), end - directory.size()));
+        }
+    }
+    return true;
+}
+
+size_t CloudListingCache::getListingsCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return listings.size();
+}
+
+}  // namespace ovms
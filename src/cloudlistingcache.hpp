@@ -0,0 +1,76 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Object keys listed once under prefixes shared by repositories of several cloud stored models
+ *
+ * Checking model versions on each watcher cycle costs a few listing requests per model. When models share a parent
+ * prefix, a single paginated listing of it is stored here for the duration of the cycle and directory queries of all
+ * of them are answered from it.
+ */
+class CloudListingCache {
+public:
+    static CloudListingCache& instance() {
+        static CloudListingCache instance;
+        return instance;
+    }
+
+    /**
+     * @brief Stores listing of prefix
+     *
+     * @param prefix url of directory, e.g. s3://bucket/models
+     * @param keys urls of all objects under prefix
+     */
+    void store(const std::string& prefix, std::vector<std::string> keys);
+
+    /**
+     * @brief Drops all listings, so that following queries reach the storage
+     */
+    void clear();
+
+    /**
+     * @return false when no listing covers the path and storage has to be queried
+     */
+    bool isDirectory(const std::string& path, bool* isDirectory) const;
+
+    /**
+     * @return false when no listing covers the path and storage has to be queried
+     */
+    bool getDirectorySubdirs(const std::string& path, std::set<std::string>* subdirs) const;
+
+    size_t getListingsCount() const;
+
+private:
+    CloudListingCache() = default;
+
+    const std::vector<std::string>* findListing(const std::string& directory) const;
+
+    mutable std::mutex mutex;
+    // keyed by prefix with trailing slash
+    std::map<std::string, std::vector<std::string>> listings;
+};
+
+}  // namespace ovms
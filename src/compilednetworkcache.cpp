@@ -0,0 +1,265 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "compilednetworkcache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <openssl/evp.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+namespace ovms {
+
+namespace {
+void updateWithField(EVP_MD_CTX* context, const std::string& field) {
+    // length prefix keeps concatenated fields unambiguous
+    const uint64_t size = field.size();
+    EVP_DigestUpdate(context, &size, sizeof(size));
+    EVP_DigestUpdate(context, field.data(), field.size());
+}
+
+bool updateWithFile(EVP_MD_CTX* context, const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        EVP_DigestUpdate(context, buffer.data(), file.gcount());
+    }
+    return file.eof();
+}
+
+using digest_context_t = std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>;
+
+digest_context_t createDigestContext() {
+    digest_context_t context(EVP_MD_CTX_new(), &EVP_MD_CTX_free);
+    if (context && !EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr)) {
+        context.reset();
+    }
+    return context;
+}
+
+std::string finishDigest(EVP_MD_CTX* context) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestSize = 0;
+    if (!EVP_DigestFinal_ex(context, digest, &digestSize)) {
+        return "";
+    }
+    static const char* hexDigits = "0123456789abcdef";
+    std::string key;
+    key.reserve(2 * digestSize);
+    for (unsigned int i = 0; i < digestSize; ++i) {
+        key.push_back(hexDigits[digest[i] >> 4]);
+        key.push_back(hexDigits[digest[i] & 0xf]);
+    }
+    return key;
+}
+}  // namespace
+
+std::string CompiledNetworkCache::hashFiles(const std::vector<std::string>& modelFiles) {
+    auto context = createDigestContext();
+    if (!context) {
+        return "";
+    }
+    for (const auto& modelFile : modelFiles) {
+        if (!updateWithFile(context.get(), modelFile)) {
+            SPDLOG_WARN("Cannot read model file: {} to compute compiled network cache key", modelFile);
+            return "";
+        }
+    }
+    return finishDigest(context.get());
+}
+
+std::string CompiledNetworkCache::hashContents(const std::vector<const std::string*>& modelContents) {
+    auto context = createDigestContext();
+    if (!context) {
+        return "";
+    }
+    for (const auto* contents : modelContents) {
+        EVP_DigestUpdate(context.get(), contents->data(), contents->size());
+    }
+    return finishDigest(context.get());
+}
+
+std::string CompiledNetworkCache::hashBuffer(const void* data, size_t size) {
+    auto context = createDigestContext();
+    if (!context) {
+        return "";
+    }
+    EVP_DigestUpdate(context.get(), data, size);
+    return finishDigest(context.get());
+}
+
+std::string CompiledNetworkCache::computeKey(const std::string& filesHash,
+    const std::string& device,
+    const plugin_config_t& pluginConfig,
+    const std::string& networkDescription) {
+    auto context = createDigestContext();
+    if (!context) {
+        return "";
+    }
+    updateWithField(context.get(), filesHash);
+    updateWithField(context.get(), device);
+    for (const auto& [key, value] : pluginConfig) {
+        updateWithField(context.get(), key);
+        updateWithField(context.get(), value);
+    }
+    updateWithField(context.get(), networkDescription);
+    return finishDigest(context.get());
+}
+
+std::string CompiledNetworkCache::describeNetwork(const InferenceEngine::CNNNetwork& network) {
+    std::stringstream description;
+    description << "ie:" << InferenceEngine::GetInferenceEngineVersion()->buildNumber << ";batch:" << network.getBatchSize();
+    for (const auto& [name, input] : network.getInputsInfo()) {
+        const auto& desc = input->getTensorDesc();
+        description << ";in:" << name << ":" << desc.getPrecision().name() << ":" << desc.getLayout();
+        for (auto dim : desc.getDims()) {
+            description << ":" << dim;
+        }
+    }
+    for (const auto& [name, output] : network.getOutputsInfo()) {
+        description << ";out:" << name << ":" << output->getPrecision().name() << ":" << output->getLayout();
+    }
+    return description.str();
+}
+
+std::string CompiledNetworkCache::getNetworkPath(const std::string& key) const {
+    return (std::filesystem::path(directory) / (key + ".blob")).string();
+}
+
+std::string CompiledNetworkCache::computeConvertedNetworkKey(const std::string& filesHash) {
+    auto context = createDigestContext();
+    if (!context) {
+        return "";
+    }
+    updateWithField(context.get(), filesHash);
+    updateWithField(context.get(), "onnx-ir");
+    updateWithField(context.get(), InferenceEngine::GetInferenceEngineVersion()->buildNumber);
+    return finishDigest(context.get());
+}
+
+void CompiledNetworkCache::getConvertedNetworkPaths(const std::string& key, std::string& xmlPath, std::string& binPath) const {
+    xmlPath = (std::filesystem::path(directory) / (key + ".xml")).string();
+    binPath = (std::filesystem::path(directory) / (key + ".bin")).string();
+}
+
+bool CompiledNetworkCache::hasConvertedNetwork(const std::string& key) const {
+    std::string xmlPath, binPath;
+    getConvertedNetworkPaths(key, xmlPath, binPath);
+    std::error_code error;
+    // .xml file is stored last
+    return std::filesystem::exists(xmlPath, error) && std::filesystem::exists(binPath, error);
+}
+
+void CompiledNetworkCache::removeConvertedNetwork(const std::string& key) const {
+    std::string xmlPath, binPath;
+    getConvertedNetworkPaths(key, xmlPath, binPath);
+    std::error_code error;
+    std::filesystem::remove(xmlPath, error);
+    std::filesystem::remove(binPath, error);
+}
+
+void CompiledNetworkCache::storeConvertedNetwork(const std::string& key, const InferenceEngine::CNNNetwork& network) const {
+    std::string xmlPath, binPath;
+    getConvertedNetworkPaths(key, xmlPath, binPath);
+    std::stringstream tmpSuffix;
+    tmpSuffix << ".tmp." << getpid() << "." << std::this_thread::get_id();
+    const auto tmpXmlPath = xmlPath + tmpSuffix.str();
+    const auto tmpBinPath = binPath + tmpSuffix.str();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        SPDLOG_WARN("Cannot create compiled network cache directory: {}; error: {}", directory, error.message());
+        return;
+    }
+    try {
+        network.serialize(tmpXmlPath, tmpBinPath);
+    } catch (const std::exception& e) {
+        SPDLOG_WARN("Network converted from ONNX is not cached, serialization failed: {}", e.what());
+        std::filesystem::remove(tmpXmlPath, error);
+        std::filesystem::remove(tmpBinPath, error);
+        return;
+    }
+    // weights are renamed first, so that servers sharing the cache never see .xml without its .bin
+    std::filesystem::rename(tmpBinPath, binPath, error);
+    if (!error) {
+        std::filesystem::rename(tmpXmlPath, xmlPath, error);
+    }
+    if (error) {
+        SPDLOG_WARN("Cannot store network converted from ONNX: {}; error: {}", xmlPath, error.message());
+        std::filesystem::remove(tmpXmlPath, error);
+        std::filesystem::remove(tmpBinPath, error);
+        return;
+    }
+    SPDLOG_INFO("Stored network converted from ONNX in cache: {}", xmlPath);
+}
+
+bool CompiledNetworkCache::tryImport(InferenceEngine::Core& engine, const std::string& key, const std::string& device, const plugin_config_t& pluginConfig,
+    InferenceEngine::ExecutableNetwork& network) const {
+    const auto path = getNetworkPath(key);
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        SPDLOG_DEBUG("Compiled network cache miss: {}", path);
+        return false;
+    }
+    try {
+        network = engine.ImportNetwork(path, device, pluginConfig);
+    } catch (const std::exception& e) {
+        SPDLOG_WARN("Cannot import compiled network: {}; error: {}; network will be compiled again", path, e.what());
+        std::filesystem::remove(path, error);
+        return false;
+    }
+    SPDLOG_INFO("Imported compiled network from cache: {}", path);
+    return true;
+}
+
+void CompiledNetworkCache::store(const std::string& key, InferenceEngine::ExecutableNetwork& network) const {
+    const auto path = getNetworkPath(key);
+    std::stringstream tmpSuffix;
+    tmpSuffix << ".tmp." << getpid() << "." << std::this_thread::get_id();
+    const auto tmpPath = path + tmpSuffix.str();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        SPDLOG_WARN("Cannot create compiled network cache directory: {}; error: {}", directory, error.message());
+        return;
+    }
+    try {
+        network.Export(tmpPath);
+    } catch (const std::exception& e) {
+        // e.g. device plugin does not support export
+        SPDLOG_INFO("Compiled network is not cached, export failed: {}", e.what());
+        std::filesystem::remove(tmpPath, error);
+        return;
+    }
+    // servers sharing the cache see either the complete file or no file
+    std::filesystem::rename(tmpPath, path, error);
+    if (error) {
+        SPDLOG_WARN("Cannot store compiled network: {}; error: {}", path, error.message());
+        std::filesystem::remove(tmpPath, error);
+        return;
+    }
+    SPDLOG_INFO("Stored compiled network in cache: {}", path);
+}
+
+}  // namespace ovms
@@ -0,0 +1,140 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+#include "modelconfig.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Persistent directory of compiled networks, so that loading a model does not compile it for the device again
+ *
+ * Networks are exported to files named after the key of their compilation inputs: content of model files, device,
+ * plugin config and network inputs and outputs with their shapes, layouts and precisions. Any change of them
+ * results in a new key, so cached networks are never invalidated, only missed. Devices not supporting export
+ * are compiled every time.
+ */
+class CompiledNetworkCache {
+public:
+    /**
+     * @param directory where compiled networks are stored, cache is disabled when empty
+     */
+    CompiledNetworkCache(const std::string& directory) :
+        directory(directory) {}
+
+    bool isEnabled() const {
+        return !directory.empty();
+    }
+
+    /**
+     * @brief Hashes content of model files, computed once per model load and shared by networks compiled for all devices
+     *
+     * @return hex encoded SHA-256 or empty string when any of the files cannot be read
+     */
+    static std::string hashFiles(const std::vector<std::string>& modelFiles);
+
+    /**
+     * @brief Hashes model files already read into memory, equal to hashFiles of the same files on disk
+     *
+     * @return hex encoded SHA-256 or empty string on digest failure
+     */
+    static std::string hashContents(const std::vector<const std::string*>& modelContents);
+
+    /**
+     * @brief Hashes single buffer, equal to hashFiles of a file with the same contents
+     *
+     * @return hex encoded SHA-256 or empty string on digest failure
+     */
+    static std::string hashBuffer(const void* data, size_t size);
+
+    /**
+     * @brief Computes key of the compiled network
+     *
+     * @param filesHash hash of files read into the network
+     * @param device
+     * @param pluginConfig
+     * @param networkDescription description of reshaped network, see describeNetwork
+     *
+     * @return hex encoded SHA-256
+     */
+    static std::string computeKey(const std::string& filesHash,
+        const std::string& device,
+        const plugin_config_t& pluginConfig,
+        const std::string& networkDescription);
+
+    /**
+     * @brief Describes network state affecting compilation: inference engine version, batch size, inputs and outputs
+     */
+    static std::string describeNetwork(const InferenceEngine::CNNNetwork& network);
+
+    std::string getNetworkPath(const std::string& key) const;
+
+    /**
+     * @brief Computes key of IR converted from ONNX model, IR format depends on inference engine version only
+     *
+     * @param filesHash hash of ONNX model file
+     *
+     * @return hex encoded SHA-256
+     */
+    static std::string computeConvertedNetworkKey(const std::string& filesHash);
+
+    /**
+     * @brief Gets paths of converted network .xml and .bin files
+     */
+    void getConvertedNetworkPaths(const std::string& key, std::string& xmlPath, std::string& binPath) const;
+
+    /**
+     * @brief Checks if network converted from ONNX is cached
+     */
+    bool hasConvertedNetwork(const std::string& key) const;
+
+    /**
+     * @brief Removes converted network which cannot be read, so that it is replaced by next store
+     */
+    void removeConvertedNetwork(const std::string& key) const;
+
+    /**
+     * @brief Serializes network read from ONNX model into IR, files appear in the cache only once both are completely written
+     *
+     * Failures are logged, they only cause the ONNX model to be read again next time.
+     */
+    void storeConvertedNetwork(const std::string& key, const InferenceEngine::CNNNetwork& network) const;
+
+    /**
+     * @brief Imports cached network, corrupted file is removed so that it is replaced by next store
+     *
+     * @return true if network was found and imported
+     */
+    bool tryImport(InferenceEngine::Core& engine, const std::string& key, const std::string& device, const plugin_config_t& pluginConfig,
+        InferenceEngine::ExecutableNetwork& network) const;
+
+    /**
+     * @brief Exports compiled network, file appears in the cache only once it is completely written
+     *
+     * Failures are logged, they only cause the network to be compiled again next time.
+     */
+    void store(const std::string& key, InferenceEngine::ExecutableNetwork& network) const;
+
+private:
+    const std::string directory;
+};
+
+}  // namespace ovms
@@ -0,0 +1,127 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "compression.hpp"
+
+#include <cctype>
+#include <limits>
+
+#include <spdlog/spdlog.h>
+#include <zlib.h>
+
+namespace ovms {
+
+namespace {
+// 15 bits window with 16 added selects gzip header and trailer instead of zlib ones
+const int GZIP_WINDOW_BITS = 15 + 16;
+const int DEFAULT_MEMORY_LEVEL = 8;
+
+std::string_view trimWhitespace(std::string_view value) {
+    const auto begin = value.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    const auto end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(lhs[i])) != std::tolower(static_cast<unsigned char>(rhs[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if coding parameters reject it with zero quality value, e.g. "q=0" or "q=0.000"
+ */
+bool isRejected(std::string_view parameters) {
+    while (!parameters.empty()) {
+        const auto separator = parameters.find(';');
+        const auto parameter = trimWhitespace(parameters.substr(0, separator));
+        parameters = separator == std::string_view::npos ? std::string_view() : parameters.substr(separator + 1);
+        if (parameter.size() < 2 || std::tolower(static_cast<unsigned char>(parameter[0])) != 'q' || parameter[1] != '=') {
+            continue;
+        }
+        const auto quality = parameter.substr(2);
+        return quality.find_first_not_of("0.") == std::string_view::npos;
+    }
+    return false;
+}
+}  // namespace
+
+ContentEncoding negotiateContentEncoding(std::string_view acceptEncoding) {
+    bool wildcardAccepted = false;
+    while (!acceptEncoding.empty()) {
+        const auto separator = acceptEncoding.find(',');
+        const auto entry = acceptEncoding.substr(0, separator);
+        acceptEncoding = separator == std::string_view::npos ? std::string_view() : acceptEncoding.substr(separator + 1);
+
+        const auto parametersStart = entry.find(';');
+        const auto coding = trimWhitespace(entry.substr(0, parametersStart));
+        const bool rejected = parametersStart != std::string_view::npos && isRejected(entry.substr(parametersStart + 1));
+        if (equalsIgnoreCase(coding, GZIP_CONTENT_ENCODING) || equalsIgnoreCase(coding, "x-gzip")) {
+            // explicit entry takes precedence over wildcard
+            return rejected ? ContentEncoding::IDENTITY : ContentEncoding::GZIP;
+        }
+        if (coding == "*") {
+            wildcardAccepted = !rejected;
+        }
+    }
+    return wildcardAccepted ? ContentEncoding::GZIP : ContentEncoding::IDENTITY;
+}
+
+Status compressGzip(std::string_view input, std::string* output) {
+    if (input.size() > std::numeric_limits<uInt>::max()) {
+        SPDLOG_DEBUG("Data of size: {} is too big for single pass gzip compression", input.size());
+        return StatusCode::RESPONSE_COMPRESSION_FAILED;
+    }
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, GZIP_WINDOW_BITS, DEFAULT_MEMORY_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+        SPDLOG_DEBUG("Failed to initialize gzip compression: {}", stream.msg ? stream.msg : "");
+        return StatusCode::RESPONSE_COMPRESSION_FAILED;
+    }
+    // bound includes gzip header and trailer, so the data is compressed in a single deflate call
+    output->resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output->data());
+    stream.avail_out = static_cast<uInt>(output->size());
+    const int result = deflate(&stream, Z_FINISH);
+    const auto compressedSize = stream.total_out;
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        SPDLOG_DEBUG("Gzip compression failed with code: {}", result);
+        output->clear();
+        return StatusCode::RESPONSE_COMPRESSION_FAILED;
+    }
+    output->resize(compressedSize);
+    return StatusCode::OK;
+}
+
+void setGrpcResponseCompression(grpc::ServerContext& context, size_t responseSize, size_t threshold) {
+    if (!isCompressionRequired(responseSize, threshold)) {
+        return;
+    }
+    SPDLOG_DEBUG("Compressing gRPC response of size: {} bytes", responseSize);
+    context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+}
+
+}  // namespace ovms
@@ -0,0 +1,81 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <grpcpp/server_context.h>
+
+#include "status.hpp"
+
+namespace ovms {
+
+const char ACCEPT_ENCODING_HEADER[] = "Accept-Encoding";
+const char CONTENT_ENCODING_HEADER[] = "Content-Encoding";
+const char GZIP_CONTENT_ENCODING[] = "gzip";
+
+enum class ContentEncoding {
+    IDENTITY,
+    GZIP
+};
+
+/**
+ * @brief Checks if response of given size should be compressed
+ *
+ * @param size serialized response size in bytes
+ * @param threshold minimum compressed response size, 0 disables compression
+ *
+ * @return bool
+ */
+inline bool isCompressionRequired(size_t size, size_t threshold) {
+    return threshold > 0 && size >= threshold;
+}
+
+/**
+ * @brief Selects response content coding from Accept-Encoding request header value
+ *
+ * Codings listed with q=0 are treated as not accepted. Identity is returned when no supported coding is accepted.
+ *
+ * @param acceptEncoding header value, e.g. "gzip, deflate;q=0.5"
+ *
+ * @return ContentEncoding
+ */
+ContentEncoding negotiateContentEncoding(std::string_view acceptEncoding);
+
+/**
+ * @brief Compresses data into gzip format
+ *
+ * Fastest compression level is used, response compression runs on request processing thread.
+ *
+ * @param input
+ * @param output replaced with compressed data
+ *
+ * @return Status
+ */
+Status compressGzip(std::string_view input, std::string* output);
+
+/**
+ * @brief Enables gzip compression of gRPC response message when it is not smaller than threshold.
+ * Has to be called before the response is sent. Compression is skipped by gRPC if client does not accept gzip.
+ *
+ * @param context
+ * @param responseSize serialized response size in bytes
+ * @param threshold minimum compressed response size, 0 disables compression
+ */
+void setGrpcResponseCompression(grpc::ServerContext& context, size_t responseSize, size_t threshold);
+
+}  // namespace ovms
@@ -24,16 +24,21 @@
 #include <boost/algorithm/string.hpp>
 #include <sysexits.h>
 
+#include "containerlimits.hpp"
 #include "version.hpp"
 
 namespace ovms {
 
-const uint AVAILABLE_CORES = std::thread::hardware_concurrency();
+// cgroup CPU quota and cpuset of the container are respected, not only host core count
+const uint AVAILABLE_CORES = getEffectiveCpuCount();
 const uint MAX_PORT_NUMBER = std::numeric_limits<ushort>::max();
 
 const uint64_t DEFAULT_REST_WORKERS = AVAILABLE_CORES * 4.0;
 const std::string DEFAULT_REST_WORKERS_STRING{std::to_string(DEFAULT_REST_WORKERS)};
 const uint64_t MAX_REST_WORKERS = 10'000;
+const std::string DEFAULT_MODEL_LOADING_PARALLELISM_STRING{std::to_string(std::max(1u, AVAILABLE_CORES / 4))};
+// sizeof(sockaddr_un::sun_path) including terminating null character
+const size_t MAX_UNIX_SOCKET_PATH_LENGTH = 107;
 
 Config& Config::parse(int argc, char** argv) {
     try {
@@ -61,27 +66,181 @@ Config& Config::parse(int argc, char** argv) {
                 "Network interface address to bind to for the REST API",
                 cxxopts::value<std::string>()->default_value("0.0.0.0"),
                 "REST_BIND_ADDRESS")
+            ("grpc_unix_socket",
+                "path of unix domain socket the gRPC server listens on, in addition to the port. With port set to 0 the gRPC server listens only on the socket",
+                cxxopts::value<std::string>(), "GRPC_UNIX_SOCKET")
+            ("rest_unix_socket",
+                "path of unix domain socket the REST server listens on, in addition to rest_port. Has no effect if rest_port is not set",
+                cxxopts::value<std::string>(), "REST_UNIX_SOCKET")
             ("grpc_workers",
                 "number of gRPC servers. Default 1. Increase for multi client, high throughput scenarios",
                 cxxopts::value<uint>()->default_value("1"),
                 "GRPC_WORKERS")
+            ("grpc_async_predict",
+                "serve Predict, GetModelMetadata and GetModelStatus calls asynchronously; gRPC threads are not blocked for the time of the inference. One completion queue per CPU core is used unless grpc_workers sets their number",
+                cxxopts::value<bool>()->default_value("false"),
+                "GRPC_ASYNC_PREDICT")
+            ("grpc_zero_copy_inputs",
+                "reference tensor_content of large Predict inputs in the received gRPC message instead of copying it. Requires grpc_async_predict",
+                cxxopts::value<bool>()->default_value("false"),
+                "GRPC_ZERO_COPY_INPUTS")
+            ("grpc_chunked_request_max_mb",
+                "limit of summed size in megabytes of inputs streamed with PredictChunked gRPC call. Memory of an input is allocated when its first chunk is received",
+                cxxopts::value<uint>()->default_value("1024"),
+                "GRPC_CHUNKED_REQUEST_MAX_MB")
+            ("grpc_chunked_requests_budget_mb",
+                "limit of memory in megabytes of inputs of all PredictChunked gRPC calls received at once",
+                cxxopts::value<uint>()->default_value("4096"),
+                "GRPC_CHUNKED_REQUESTS_BUDGET_MB")
+            ("grpc_chunked_request_read_timeout_s",
+                "time in seconds to receive all chunks of PredictChunked gRPC call, slower calls are cancelled",
+                cxxopts::value<uint>()->default_value("60"),
+                "GRPC_CHUNKED_REQUEST_READ_TIMEOUT_S")
             ("rest_workers",
                 "number of worker threads in REST server - has no effect if rest_port is not set. Default value depends on number of CPUs. ",
                 cxxopts::value<uint>()->default_value(DEFAULT_REST_WORKERS_STRING.c_str()),
                 "REST_WORKERS")
+            ("rest_inference_workers",
+                "number of threads running inference of REST predict requests parsed by rest_workers threads. Default 0 runs inference in rest_workers threads",
+                cxxopts::value<uint>()->default_value("0"),
+                "REST_INFERENCE_WORKERS")
+            ("rest_inference_queue_size",
+                "maximum number of REST predict requests waiting for rest_inference_workers thread, requests above it are rejected with HTTP status 429. Default 0 means no limit",
+                cxxopts::value<uint64_t>()->default_value("0"),
+                "REST_INFERENCE_QUEUE_SIZE")
+            ("rest_compression_threshold",
+                "minimum size in bytes of REST response compressed with gzip when client sends Accept-Encoding: gzip header. Default 0 disables compression",
+                cxxopts::value<uint64_t>()->default_value("0"),
+                "BYTES")
             ("log_level",
                 "serving log level - one of DEBUG, INFO, ERROR",
                 cxxopts::value<std::string>()->default_value("INFO"), "LOG_LEVEL")
             ("log_path",
                 "optional path to the log file",
                 cxxopts::value<std::string>(), "LOG_PATH")
+            ("log_queue_size",
+                "number of log messages queued for the background logging thread. 0 means logging synchronously in the calling threads",
+                cxxopts::value<uint32_t>()->default_value("0"), "LOG_QUEUE_SIZE")
+            ("log_queue_overflow",
+                "what happens to a message logged when the log queue is full: drop (the oldest queued message is dropped) or block",
+                cxxopts::value<std::string>()->default_value("drop"), "LOG_QUEUE_OVERFLOW")
             ("grpc_channel_arguments",
                 "A comma separated list of arguments to be passed to the grpc server. (e.g. grpc.max_connection_age_ms=2000)",
                 cxxopts::value<std::string>(), "GRPC_CHANNEL_ARGUMENTS")
+            ("network_cpus",
+                "cpu list in sysfs format (e.g. 0-3,8) gRPC and REST threads are pinned to. These cpus are not used by inference streams",
+                cxxopts::value<std::string>(), "NETWORK_CPUS")
+            ("background_cpus",
+                "cpu list in sysfs format (e.g. 4) model manager threads, like config and model files watcher, are pinned to. These cpus are not used by inference streams",
+                cxxopts::value<std::string>(), "BACKGROUND_CPUS")
+            ("saturation_threshold",
+                "in-flight predict requests per inference stream above which GET /v1/ready reports the server as not ready. Default 0 disables saturation checks",
+                cxxopts::value<double>()->default_value("0"),
+                "SATURATION_THRESHOLD")
+            ("saturation_shed_requests",
+                "reject new predict requests while saturation is above saturation_threshold; REST connections receiving the rejection are closed",
+                cxxopts::value<bool>()->default_value("false"),
+                "SATURATION_SHED_REQUESTS")
+            ("bulk_jobs",
+                "accept bulk inference jobs on REST API /v1/jobs, streaming npy shards from model repository storages through models and pipelines on spare capacity. Requires bulk_jobs_root and admin_token_file",
+                cxxopts::value<bool>()->default_value("false"),
+                "BULK_JOBS")
+            ("bulk_jobs_root",
+                "local directory or cloud storage location; inputs and outputs of bulk inference jobs have to be inside of it",
+                cxxopts::value<std::string>(), "BULK_JOBS_ROOT")
+            ("admin_token_file",
+                "file with bearer token required by admin REST API, like CPU profiling on /v1/admin/profile. Admin API is disabled when not set",
+                cxxopts::value<std::string>(), "ADMIN_TOKEN_FILE")
+            ("trace_endpoint",
+                "OTLP/HTTP collector address spans are exported to, e.g. http://collector:4318. Tracing is disabled when not set",
+                cxxopts::value<std::string>(), "TRACE_ENDPOINT")
+            ("trace_sampling_ratio",
+                "part of requests without sampled W3C traceparent which are traced, from 0 to 1. Sampling decision passed in traceparent is always respected",
+                cxxopts::value<double>()->default_value("0"),
+                "TRACE_SAMPLING_RATIO")
+            ("traffic_capture_path",
+                "binary log sampled gRPC and REST predict requests are written to together with their arrival times, for replay with load generator. Capture is disabled when not set",
+                cxxopts::value<std::string>(), "TRAFFIC_CAPTURE_PATH")
+            ("traffic_capture_ratio",
+                "part of predict requests written to traffic_capture_path, from 0 to 1",
+                cxxopts::value<double>()->default_value("1"),
+                "TRAFFIC_CAPTURE_RATIO")
+            ("traffic_capture_max_mb",
+                "size of traffic_capture_path after which capture is stopped",
+                cxxopts::value<uint32_t>()->default_value("1024"),
+                "TRAFFIC_CAPTURE_MAX_MB")
             ("file_system_poll_wait_seconds",
                 "Time interval between config and model versions changes detection. Default is 1. Zero or negative value disables changes monitoring.",
                 cxxopts::value<uint>()->default_value("1"),
-                "SECONDS");
+                "SECONDS")
+            ("file_system_watch_mode",
+                "How changes of model repositories and config file are detected: poll - each of them is checked every file_system_poll_wait_seconds, "
+                "inotify - local repositories are reloaded as soon as they change, cloud ones are still polled. Default is poll.",
+                cxxopts::value<std::string>()->default_value("poll"),
+                "FILE_SYSTEM_WATCH_MODE")
+            ("model_loading_parallelism",
+                "Maximum number of models loaded at once at startup and on configuration reload. Default is a quarter of CPU cores.",
+                cxxopts::value<uint>()->default_value(DEFAULT_MODEL_LOADING_PARALLELISM_STRING.c_str()),
+                "MODEL_LOADING_PARALLELISM")
+            ("compiled_network_cache_dir",
+                "Directory where networks compiled for target devices are stored and imported from on following loads. Cache is disabled when not set.",
+                cxxopts::value<std::string>(),
+                "COMPILED_NETWORK_CACHE_DIR")
+            ("cloud_model_cache_dir",
+                "Directory where model versions downloaded from cloud storage are kept and reused on following loads and restarts "
+                "while their remote objects do not change. Cache is disabled when not set.",
+                cxxopts::value<std::string>(),
+                "CLOUD_MODEL_CACHE_DIR")
+            ("cloud_model_cache_size_mb",
+                "Disk space in MB of cloud_model_cache_dir, least recently used model versions which are not loaded are evicted to fit it. Default 0 means no limit.",
+                cxxopts::value<uint64_t>()->default_value("0"),
+                "CLOUD_MODEL_CACHE_SIZE_MB")
+            ("cloud_model_streaming",
+                "Load IR and ONNX models stored in S3 or Google Cloud Storage by reading their files straight into memory instead of downloading them "
+                "into a temporary directory first.",
+                cxxopts::value<bool>()->default_value("false"),
+                "CLOUD_MODEL_STREAMING")
+            ("mmap_model_weights",
+                "Map weights files of local IR models into memory instead of reading them, so instances of the same model share page cache pages. "
+                "Model files must not be modified in place while they are served.",
+                cxxopts::value<bool>()->default_value("false"),
+                "MMAP_MODEL_WEIGHTS")
+            ("deduplicate_model_weights",
+                "Share one weights buffer between versions and models whose IR weights files have identical contents, detected by content hash. "
+                "Combined with mmap_model_weights shared buffers are mapped.",
+                cxxopts::value<bool>()->default_value("false"),
+                "DEDUPLICATE_MODEL_WEIGHTS")
+            ("convert_onnx_models",
+                "Convert local ONNX models into IR stored in compiled_network_cache_dir once and read the IR by later loads and reshapes of the same model file.",
+                cxxopts::value<bool>()->default_value("false"),
+                "CONVERT_ONNX_MODELS")
+            ("fuse_pipeline_models",
+                "Fuse chains of pipeline model nodes, each read only by the next one on the same device and plugin config, into single networks inferred by one node.",
+                cxxopts::value<bool>()->default_value("false"),
+                "FUSE_PIPELINE_MODELS")
+            ("models_memory_budget_mb",
+                "Memory in MB which all loaded models can use. Loading of model versions which would exceed it is refused and retried when models change. Default 0 means no limit.",
+                cxxopts::value<uint64_t>()->default_value("0"),
+                "MODELS_MEMORY_BUDGET_MB")
+            ("lazy_models_memory_budget_mb",
+                "Memory in MB which activated models with lazy loading can use, least recently used idle models are deactivated to fit it. Default 0 means no limit.",
+                cxxopts::value<uint64_t>()->default_value("0"),
+                "LAZY_MODELS_MEMORY_BUDGET_MB")
+            ("tensor_arena_mb",
+                "Memory in MB for 64 byte aligned input, output and pipeline blobs, reserved at startup in huge pages on each NUMA node and reused between requests. "
+                "Default 0 disables the arena and blobs are allocated on the heap.",
+                cxxopts::value<uint64_t>()->default_value("0"),
+                "TENSOR_ARENA_MB")
+            ("inference_slots",
+                "Number of inferences running at once on the whole server, free slots are given to models by scheduling_priority and scheduling_weight. "
+                "Default 0 disables the scheduling.",
+                cxxopts::value<uint32_t>()->default_value("0"),
+                "INFERENCE_SLOTS")
+            ("cpu_streams_budget",
+                "Number of CPU streams shared by models without CPU_THROUGHPUT_STREAMS and nireq set. Streams are redistributed by load of the models "
+                "every file_system_poll_wait_seconds, networks with changed streams are recompiled in background. Default 0 disables rebalancing.",
+                cxxopts::value<uint32_t>()->default_value("0"),
+                "CPU_STREAMS_BUDGET");
         options->add_options("multi model")
             ("config_path",
                 "absolute path to json configuration file",
@@ -191,8 +350,33 @@ void Config::validate() {
     }
 
     // check grpc_workers value
+    if (result->count("file_system_watch_mode") && this->fileSystemWatchMode() != "poll" && this->fileSystemWatchMode() != "inotify") {
+        std::cerr << "file_system_watch_mode should be poll or inotify" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    if (this->logQueueOverflow() != "drop" && this->logQueueOverflow() != "block") {
+        std::cerr << "log_queue_overflow should be drop or block" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    if (result->count("model_loading_parallelism") && this->modelLoadingParallelism() < 1) {
+        std::cerr << "model_loading_parallelism should be at least 1" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    if (this->grpcZeroCopyInputs() && !this->grpcAsyncPredict()) {
+        std::cerr << "grpc_zero_copy_inputs requires grpc_async_predict" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    if (this->convertOnnxModels() && this->compiledNetworkCacheDir().empty()) {
+        std::cerr << "convert_onnx_models requires compiled_network_cache_dir" << std::endl;
+        exit(EX_USAGE);
+    }
+
     if (result->count("grpc_workers") && ((this->grpcWorkers() > AVAILABLE_CORES) || (this->grpcWorkers() < 1))) {
-        std::cerr << "grpc_workers count should be from 1 to CPU core count : " << AVAILABLE_CORES << std::endl;
+        std::cerr << "grpc_workers count should be from 1 to available CPU count : " << AVAILABLE_CORES << std::endl;
         exit(EX_USAGE);
     }
 
@@ -207,6 +391,12 @@ void Config::validate() {
         exit(EX_USAGE);
     }
 
+    // check rest_inference_workers value
+    if (result->count("rest_inference_workers") && (this->restInferenceWorkers() > MAX_REST_WORKERS)) {
+        std::cerr << "rest_inference_workers count should be from 0 to " << MAX_REST_WORKERS << std::endl;
+        exit(EX_USAGE);
+    }
+
     // check docker ports
     if (result->count("port") && ((this->port() > MAX_PORT_NUMBER) || (this->port() < 0))) {
         std::cerr << "port number out of range from 0 to " << MAX_PORT_NUMBER << std::endl;
@@ -231,6 +421,56 @@ void Config::validate() {
         exit(EX_USAGE);
     }
 
+    if (result->count("saturation_threshold") && this->saturationThreshold() < 0) {
+        std::cerr << "saturation_threshold should not be negative" << std::endl;
+        exit(EX_USAGE);
+    }
+    if (result->count("saturation_shed_requests") && this->saturationShedRequests() && this->saturationThreshold() <= 0) {
+        std::cerr << "saturation_shed_requests is set but saturation_threshold is not set" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    if (this->bulkJobs() && (this->bulkJobsRoot().empty() || this->adminTokenFile().empty())) {
+        std::cerr << "bulk_jobs requires bulk_jobs_root and admin_token_file" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    if (result->count("trace_sampling_ratio") && (this->traceSamplingRatio() < 0 || this->traceSamplingRatio() > 1)) {
+        std::cerr << "trace_sampling_ratio should be in range from 0 to 1" << std::endl;
+        exit(EX_USAGE);
+    }
+    if (result->count("trace_sampling_ratio") && this->traceEndpoint().empty()) {
+        std::cerr << "trace_sampling_ratio is set but trace_endpoint is not set" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    if (result->count("traffic_capture_ratio") && (this->trafficCaptureRatio() < 0 || this->trafficCaptureRatio() > 1)) {
+        std::cerr << "traffic_capture_ratio should be in range from 0 to 1" << std::endl;
+        exit(EX_USAGE);
+    }
+    if ((result->count("traffic_capture_ratio") || result->count("traffic_capture_max_mb")) && this->trafficCapturePath().empty()) {
+        std::cerr << "traffic_capture_ratio or traffic_capture_max_mb is set but traffic_capture_path is not set" << std::endl;
+        exit(EX_USAGE);
+    }
+
+    // check unix socket paths
+    if (result->count("grpc_unix_socket") && (this->grpcUnixSocket().empty() || this->grpcUnixSocket().size() > MAX_UNIX_SOCKET_PATH_LENGTH)) {
+        std::cerr << "grpc_unix_socket path should have from 1 to " << MAX_UNIX_SOCKET_PATH_LENGTH << " characters" << std::endl;
+        exit(EX_USAGE);
+    }
+    if (result->count("rest_unix_socket") && (this->restUnixSocket().empty() || this->restUnixSocket().size() > MAX_UNIX_SOCKET_PATH_LENGTH)) {
+        std::cerr << "rest_unix_socket path should have from 1 to " << MAX_UNIX_SOCKET_PATH_LENGTH << " characters" << std::endl;
+        exit(EX_USAGE);
+    }
+    if (result->count("rest_unix_socket") && this->restPort() == 0) {
+        std::cerr << "rest_unix_socket is set but rest_port is not set. rest_port is required to start rest servers" << std::endl;
+        exit(EX_USAGE);
+    }
+    if (result->count("grpc_unix_socket") && result->count("rest_unix_socket") && this->grpcUnixSocket() == this->restUnixSocket()) {
+        std::cerr << "grpc_unix_socket and rest_unix_socket cannot have the same values" << std::endl;
+        exit(EX_USAGE);
+    }
+
     // port and rest_port cannot be the same
     if (this->port() == this->restPort()) {
         std::cerr << "port and rest_port cannot have the same values" << std::endl;
@@ -147,6 +147,28 @@ public:
         return "0.0.0.0";
     }
 
+    /**
+         * @brief Get the path of unix domain socket gRPC server listens on
+         * 
+         * @return const std::string&
+         */
+    const std::string& grpcUnixSocket() {
+        if (result->count("grpc_unix_socket"))
+            return result->operator[]("grpc_unix_socket").as<std::string>();
+        return empty;
+    }
+
+    /**
+         * @brief Get the path of unix domain socket REST server listens on
+         * 
+         * @return const std::string&
+         */
+    const std::string& restUnixSocket() {
+        if (result->count("rest_unix_socket"))
+            return result->operator[]("rest_unix_socket").as<std::string>();
+        return empty;
+    }
+
     /**
          * @brief Gets the gRPC workers count
          * 
@@ -156,6 +178,60 @@ public:
         return result->operator[]("grpc_workers").as<uint>();
     }
 
+    /**
+         * @brief Checks if the gRPC workers count was given, otherwise default one is used
+         * 
+         * @return bool
+         */
+    bool grpcWorkersSet() {
+        return result->count("grpc_workers");
+    }
+
+    /**
+         * @brief Checks if Predict, GetModelMetadata and GetModelStatus calls should be served with asynchronous gRPC API
+         * 
+         * @return bool
+         */
+    bool grpcAsyncPredict() {
+        return result->operator[]("grpc_async_predict").as<bool>();
+    }
+
+    /**
+         * @brief Checks if large tensors of async Predict calls should be referenced in received messages instead of being copied
+         * 
+         * @return bool
+         */
+    bool grpcZeroCopyInputs() {
+        return result->operator[]("grpc_zero_copy_inputs").as<bool>();
+    }
+
+    /**
+         * @brief Gets the limit of summed size of inputs of a single PredictChunked call in megabytes
+         * 
+         * @return uint
+         */
+    uint grpcChunkedRequestMaxMb() {
+        return result->operator[]("grpc_chunked_request_max_mb").as<uint>();
+    }
+
+    /**
+         * @brief Gets the limit of memory of inputs of all PredictChunked calls received at once in megabytes
+         *
+         * @return uint
+         */
+    uint grpcChunkedRequestsBudgetMb() {
+        return result->operator[]("grpc_chunked_requests_budget_mb").as<uint>();
+    }
+
+    /**
+         * @brief Gets the time to receive all chunks of PredictChunked call in seconds
+         *
+         * @return uint
+         */
+    uint grpcChunkedRequestReadTimeoutS() {
+        return result->operator[]("grpc_chunked_request_read_timeout_s").as<uint>();
+    }
+
     /**
          * @brief Gets the rest workers count
          * 
@@ -165,6 +241,33 @@ public:
         return result->operator[]("rest_workers").as<uint>();
     }
 
+    /**
+         * @brief Gets the number of threads running REST inference, 0 runs it in REST workers
+         * 
+         * @return uint
+         */
+    uint restInferenceWorkers() {
+        return result->operator[]("rest_inference_workers").as<uint>();
+    }
+
+    /**
+         * @brief Gets the maximum number of REST requests waiting for inference thread, 0 means no limit
+         * 
+         * @return uint64_t
+         */
+    uint64_t restInferenceQueueSize() {
+        return result->operator[]("rest_inference_queue_size").as<uint64_t>();
+    }
+
+    /**
+         * @brief Gets the minimum size of compressed REST response, 0 disables compression
+         * 
+         * @return uint64_t
+         */
+    uint64_t restCompressionThreshold() {
+        return result->operator[]("rest_compression_threshold").as<uint64_t>();
+    }
+
     /**
          * @brief Get the model name
          * 
@@ -276,6 +379,24 @@ public:
         return empty;
     }
 
+    /**
+        * @brief Get the size of the asynchronous logging queue, 0 when logging synchronously
+        *
+        * @return uint32_t
+        */
+    uint32_t logQueueSize() {
+        return result->operator[]("log_queue_size").as<uint32_t>();
+    }
+
+    /**
+        * @brief Get the log queue overflow policy
+        *
+        * @return const std::string&
+        */
+    const std::string& logQueueOverflow() {
+        return result->operator[]("log_queue_overflow").as<std::string>();
+    }
+
     /**
         * @brief Get the plugin config
         *
@@ -287,6 +408,126 @@ public:
         return empty;
     }
 
+    /**
+        * @brief Get cpu list of gRPC and REST threads
+        *
+        * @return const std::string&
+        */
+    const std::string& networkCpus() {
+        if (result->count("network_cpus"))
+            return result->operator[]("network_cpus").as<std::string>();
+        return empty;
+    }
+
+    /**
+        * @brief Get cpu list of model manager threads
+        *
+        * @return const std::string&
+        */
+    const std::string& backgroundCpus() {
+        if (result->count("background_cpus"))
+            return result->operator[]("background_cpus").as<std::string>();
+        return empty;
+    }
+
+    /**
+        * @brief Get saturation above which server is not ready, 0 disables saturation checks
+        *
+        * @return double
+        */
+    double saturationThreshold() {
+        return result->operator[]("saturation_threshold").as<double>();
+    }
+
+    /**
+        * @brief Checks if new predict requests are rejected while server is saturated
+        *
+        * @return bool
+        */
+    bool saturationShedRequests() {
+        return result->operator[]("saturation_shed_requests").as<bool>();
+    }
+
+    /**
+        * @brief Checks if bulk inference jobs are accepted on REST API
+        *
+        * @return bool
+        */
+    bool bulkJobs() {
+        return result->operator[]("bulk_jobs").as<bool>();
+    }
+
+    /**
+        * @brief Get location which has to contain inputs and outputs of bulk inference jobs
+        *
+        * @return const std::string&
+        */
+    const std::string& bulkJobsRoot() {
+        if (result->count("bulk_jobs_root"))
+            return result->operator[]("bulk_jobs_root").as<std::string>();
+        return empty;
+    }
+
+    /**
+        * @brief Get path of admin API bearer token file, empty when admin API is disabled
+        *
+        * @return const std::string&
+        */
+    const std::string& adminTokenFile() {
+        if (result->count("admin_token_file"))
+            return result->operator[]("admin_token_file").as<std::string>();
+        return empty;
+    }
+
+    /**
+        * @brief Get OTLP/HTTP collector address, empty when tracing is disabled
+        *
+        * @return const std::string&
+        */
+    const std::string& traceEndpoint() {
+        if (result->count("trace_endpoint"))
+            return result->operator[]("trace_endpoint").as<std::string>();
+        return empty;
+    }
+
+    /**
+        * @brief Get part of requests without sampled traceparent which are traced
+        *
+        * @return double
+        */
+    double traceSamplingRatio() {
+        return result->operator[]("trace_sampling_ratio").as<double>();
+    }
+
+    /**
+        * @brief Get path of traffic capture log, empty when capture is disabled
+        *
+        * @return const std::string&
+        */
+    const std::string& trafficCapturePath() {
+        if (result->count("traffic_capture_path"))
+            return result->operator[]("traffic_capture_path").as<std::string>();
+        return empty;
+    }
+
+    /**
+        * @brief Get part of predict requests written to traffic capture log
+        *
+        * @return double
+        */
+    double trafficCaptureRatio() {
+        return result->operator[]("traffic_capture_ratio").as<double>();
+    }
+
+    /**
+        * @brief Get size of traffic capture log in megabytes after which capture is stopped
+        *
+        * @return uint32_t
+        */
+    uint32_t trafficCaptureMaxMb() {
+        return result->operator[]("traffic_capture_max_mb").as<uint32_t>();
+    }
+
     /**
      * @brief Get the filesystem pool wait time in seconds
      * 
@@ -295,5 +536,146 @@ public:
     uint filesystemPollWaitSeconds() {
         return result->operator[]("file_system_poll_wait_seconds").as<uint>();
     }
+
+    /**
+     * @brief Get the way changes of model repositories and config file are detected
+     *
+     * @return const std::string poll or inotify
+     */
+    const std::string fileSystemWatchMode() {
+        return result->operator[]("file_system_watch_mode").as<std::string>();
+    }
+
+    /**
+     * @brief Get the maximum number of models loaded at once
+     *
+     * @return uint
+     */
+    uint modelLoadingParallelism() {
+        return result->operator[]("model_loading_parallelism").as<uint>();
+    }
+
+    /**
+     * @brief Get the directory of compiled networks cache
+     *
+     * @return const std::string empty when cache is disabled
+     */
+    const std::string compiledNetworkCacheDir() {
+        if (result != nullptr && result->count("compiled_network_cache_dir")) {
+            return result->operator[]("compiled_network_cache_dir").as<std::string>();
+        }
+        return "";
+    }
+
+    /**
+     * @brief Get the directory of cloud model cache
+     *
+     * @return const std::string empty when cache is disabled
+     */
+    const std::string cloudModelCacheDir() {
+        if (result != nullptr && result->count("cloud_model_cache_dir")) {
+            return result->operator[]("cloud_model_cache_dir").as<std::string>();
+        }
+        return "";
+    }
+
+    /**
+     * @brief Get the disk space of cloud model cache
+     *
+     * @return uint64_t MB, 0 means no limit
+     */
+    uint64_t cloudModelCacheSizeMb() {
+        return result->operator[]("cloud_model_cache_size_mb").as<uint64_t>();
+    }
+
+    /**
+     * @brief Checks if models from cloud storage are read into memory without local copies
+     *
+     * @return bool
+     */
+    bool cloudModelStreaming() {
+        return result != nullptr && result->operator[]("cloud_model_streaming").as<bool>();
+    }
+
+    /**
+     * @brief Checks if weights files of local IR models are mapped into memory
+     *
+     * @return bool
+     */
+    bool mmapModelWeights() {
+        return result != nullptr && result->operator[]("mmap_model_weights").as<bool>();
+    }
+
+    /**
+     * @brief Checks if weights buffers of IR models with identical weights files are shared
+     *
+     * @return bool
+     */
+    bool deduplicateModelWeights() {
+        return result != nullptr && result->operator[]("deduplicate_model_weights").as<bool>();
+    }
+
+    /**
+     * @brief Checks if ONNX models are converted into IR cached in compiled network cache directory
+     *
+     * @return bool
+     */
+    bool convertOnnxModels() {
+        return result != nullptr && result->operator[]("convert_onnx_models").as<bool>();
+    }
+
+    /**
+     * @brief Checks if chains of pipeline models on the same device are fused into single networks
+     *
+     * @return bool
+     */
+    bool fusePipelineModels() {
+        return result != nullptr && result->operator[]("fuse_pipeline_models").as<bool>();
+    }
+
+    /**
+     * @brief Get the memory budget of all loaded models
+     *
+     * @return uint64_t MB, 0 means no limit
+     */
+    uint64_t modelsMemoryBudgetMb() {
+        return result->operator[]("models_memory_budget_mb").as<uint64_t>();
+    }
+
+    /**
+     * @brief Get the memory budget of models with lazy loading
+     *
+     * @return uint64_t MB, 0 means no limit
+     */
+    uint64_t lazyModelsMemoryBudgetMb() {
+        return result->operator[]("lazy_models_memory_budget_mb").as<uint64_t>();
+    }
+
+    /**
+     * @brief Get the memory limit of tensor arena
+     *
+     * @return uint64_t MB, 0 means arena is disabled
+     */
+    uint64_t tensorArenaMb() {
+        return result->operator[]("tensor_arena_mb").as<uint64_t>();
+    }
+
+    /**
+     * @brief Get the number of inferences running at once on the whole server
+     *
+     * @return uint32_t, 0 means scheduling is disabled
+     */
+    uint32_t inferenceSlots() {
+        return result->operator[]("inference_slots").as<uint32_t>();
+    }
+
+    /**
+     * @brief Get the number of CPU streams rebalanced between models
+     *
+     * @return uint32_t, 0 means rebalancing is disabled
+     */
+    uint32_t cpuStreamsBudget() {
+        return result->operator[]("cpu_streams_budget").as<uint32_t>();
+    }
 };
 }  // namespace ovms
@@ -0,0 +1,218 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "containerlimits.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "numa.hpp"
+#include "stringutils.hpp"
+
+namespace ovms {
+
+static const char* CGROUP_ROOT_PATH = "/sys/fs/cgroup";
+static const char* PROC_SELF_CGROUP_PATH = "/proc/self/cgroup";
+
+// cgroup v1 reports page aligned LONG_MAX when memory is not limited
+static const uint64_t CGROUP_V1_UNLIMITED_MEMORY_THRESHOLD = 1ull << 62;
+
+static bool fileExists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+static bool readFirstLine(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    if (!file.good() || !std::getline(file, line)) {
+        return false;
+    }
+    trim(line);
+    return !line.empty();
+}
+
+static bool parseInt64(const std::string& text, int64_t& value) {
+    try {
+        size_t parsed = 0;
+        value = std::stoll(text, &parsed);
+        return parsed == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+CgroupPaths readCgroupPaths(const std::string& procCgroupPath) {
+    CgroupPaths paths;
+    std::ifstream file(procCgroupPath);
+    std::string line;
+    // "<hierarchy id>:<controllers>:<path>", cgroup v2 entry has id 0 and no controllers
+    while (std::getline(file, line)) {
+        const auto firstColon = line.find(':');
+        const auto secondColon = firstColon == std::string::npos ? std::string::npos : line.find(':', firstColon + 1);
+        if (secondColon == std::string::npos) {
+            continue;
+        }
+        const std::string controllers = line.substr(firstColon + 1, secondColon - firstColon - 1);
+        const std::string path = line.substr(secondColon + 1);
+        if (controllers.empty()) {
+            paths.unified = path;
+            continue;
+        }
+        for (const auto& controller : tokenize(controllers, ',')) {
+            if (controller == "cpu") {
+                paths.cpu = path;
+            } else if (controller == "memory") {
+                paths.memory = path;
+            }
+        }
+    }
+    return paths;
+}
+
+/**
+ * @brief Lists cgroup directory of the process and its ancestors up to the mount point, limits of all of them apply.
+ * Without cgroup namespace the full path is listed while only the cgroup of the container may be mounted,
+ * then only the mount point is used.
+ */
+static std::vector<std::string> getCgroupDirectories(const std::string& mountPoint, const std::string& cgroupPath) {
+    std::vector<std::string> directories;
+    std::string path = cgroupPath;
+    while (!path.empty() && path.back() == '/') {
+        path.pop_back();
+    }
+    if (!path.empty() && fileExists(mountPoint + path)) {
+        for (; !path.empty(); path = path.substr(0, path.rfind('/'))) {
+            directories.push_back(mountPoint + path);
+        }
+    }
+    directories.push_back(mountPoint);
+    return directories;
+}
+
+static void applyCpuQuota(int64_t quota, int64_t period, ContainerLimits& limits) {
+    if (quota <= 0 || period <= 0) {
+        return;
+    }
+    const double cpus = static_cast<double>(quota) / period;
+    if (limits.cpuQuota == 0.0 || cpus < limits.cpuQuota) {
+        limits.cpuQuota = cpus;
+    }
+}
+
+static void applyMemoryLimit(int64_t memory, ContainerLimits& limits) {
+    if (memory <= 0) {
+        return;
+    }
+    if (limits.memoryLimitBytes == 0 || static_cast<uint64_t>(memory) < limits.memoryLimitBytes) {
+        limits.memoryLimitBytes = memory;
+    }
+}
+
+static void readCgroupV2Limits(const std::string& cgroupRoot, const CgroupPaths& paths, ContainerLimits& limits) {
+    const auto directories = getCgroupDirectories(cgroupRoot, paths.unified);
+    limits.cgroupPath = directories.front();
+    for (const auto& directory : directories) {
+        std::string line;
+        // "<quota> <period>" or "max <period>"
+        if (readFirstLine(directory + "/cpu.max", line)) {
+            auto fields = tokenize(line, ' ');
+            int64_t quota, period;
+            if (fields.size() == 2 && fields[0] != "max" && parseInt64(fields[0], quota) && parseInt64(fields[1], period)) {
+                applyCpuQuota(quota, period, limits);
+            }
+        }
+        if (readFirstLine(directory + "/memory.max", line) && line != "max") {
+            int64_t memory;
+            if (parseInt64(line, memory)) {
+                applyMemoryLimit(memory, limits);
+            }
+        }
+    }
+}
+
+static void readCgroupV1Limits(const std::string& cgroupRoot, const CgroupPaths& paths, ContainerLimits& limits) {
+    for (const auto& controller : {"/cpu", "/cpu,cpuacct"}) {
+        if (!fileExists(cgroupRoot + controller)) {
+            continue;
+        }
+        const auto directories = getCgroupDirectories(cgroupRoot + controller, paths.cpu);
+        limits.cgroupPath = directories.front();
+        for (const auto& directory : directories) {
+            std::string quotaLine, periodLine;
+            int64_t quota, period;
+            // quota -1 means not limited
+            if (readFirstLine(directory + "/cpu.cfs_quota_us", quotaLine) && readFirstLine(directory + "/cpu.cfs_period_us", periodLine) &&
+                parseInt64(quotaLine, quota) && parseInt64(periodLine, period)) {
+                applyCpuQuota(quota, period, limits);
+            }
+        }
+        break;
+    }
+    for (const auto& directory : getCgroupDirectories(cgroupRoot + "/memory", paths.memory)) {
+        std::string line;
+        int64_t memory;
+        if (readFirstLine(directory + "/memory.limit_in_bytes", line) && parseInt64(line, memory) && static_cast<uint64_t>(memory) < CGROUP_V1_UNLIMITED_MEMORY_THRESHOLD) {
+            applyMemoryLimit(memory, limits);
+        }
+    }
+}
+
+ContainerLimits readContainerLimits(const std::string& cgroupRoot, const CgroupPaths& paths) {
+    ContainerLimits limits;
+    limits.cgroupV2 = fileExists(cgroupRoot + "/cgroup.controllers");
+    if (limits.cgroupV2) {
+        readCgroupV2Limits(cgroupRoot, paths, limits);
+    } else {
+        readCgroupV1Limits(cgroupRoot, paths, limits);
+    }
+    return limits;
+}
+
+uint32_t computeEffectiveCpuCount(const ContainerLimits& limits, uint32_t hostCpus) {
+    uint32_t cpus = hostCpus;
+    if (limits.cpusetCpus > 0 && (cpus == 0 || limits.cpusetCpus < cpus)) {
+        cpus = limits.cpusetCpus;
+    }
+    if (limits.cpuQuota > 0) {
+        const uint32_t quotaCpus = static_cast<uint32_t>(std::ceil(limits.cpuQuota));
+        if (cpus == 0 || quotaCpus < cpus) {
+            cpus = quotaCpus;
+        }
+    }
+    return std::max(cpus, 1u);
+}
+
+const ContainerLimits& getContainerLimits() {
+    static const ContainerLimits limits = []() {
+        ContainerLimits detected = readContainerLimits(CGROUP_ROOT_PATH, readCgroupPaths(PROC_SELF_CGROUP_PATH));
+        // affinity mask already reflects cpuset of the cgroup and taskset of the process
+        detected.cpusetCpus = getAllowedCpus().size();
+        return detected;
+    }();
+    return limits;
+}
+
+uint32_t getEffectiveCpuCount() {
+    static const uint32_t cpus = computeEffectiveCpuCount(getContainerLimits(), std::thread::hardware_concurrency());
+    return cpus;
+}
+
+}  // namespace ovms
@@ -0,0 +1,95 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ovms {
+
+/**
+ * @brief Resource limits of the cgroup the server runs in
+ */
+struct ContainerLimits {
+    /** @brief CPU bandwidth quota expressed in CPUs, e.g. 2.5 for 250ms per 100ms period, 0 when not limited */
+    double cpuQuota = 0.0;
+    /** @brief Number of cpus the process is allowed to run on, 0 when unknown */
+    size_t cpusetCpus = 0;
+    /** @brief Memory limit in bytes, 0 when not limited */
+    uint64_t memoryLimitBytes = 0;
+    /** @brief Limits were read from cgroup v2 unified hierarchy */
+    bool cgroupV2 = false;
+    /** @brief Cgroup directory of the process CPU quota was read from, its ancestors are checked as well */
+    std::string cgroupPath;
+};
+
+/**
+ * @brief Cgroup paths of the process, relative to mount points of their hierarchies
+ */
+struct CgroupPaths {
+    /** @brief Path in cgroup v2 unified hierarchy */
+    std::string unified;
+    /** @brief Path in cgroup v1 hierarchy with cpu controller */
+    std::string cpu;
+    /** @brief Path in cgroup v1 hierarchy with memory controller */
+    std::string memory;
+};
+
+/**
+ * @brief Reads cgroup paths of the process from entries of /proc/self/cgroup format, e.g. "0::/kubepods/pod1/container1"
+ *
+ * @param procCgroupPath
+ *
+ * @return paths, empty if file is missing
+ */
+CgroupPaths readCgroupPaths(const std::string& procCgroupPath);
+
+/**
+ * @brief Reads CPU quota and memory limit of cgroup v2 unified hierarchy, or cgroup v1 cpu and memory controllers
+ * if the root does not contain cgroup.controllers file. Limits of the cgroup of the process and of its ancestors
+ * are read and the smallest ones are used. Paths which do not exist under the mount point, as in containers
+ * without cgroup namespace, fall back to the mount point. Missing or malformed files leave the limit unset.
+ *
+ * @param cgroupRoot mount point of the cgroup filesystem, e.g. /sys/fs/cgroup
+ * @param paths cgroup paths of the process
+ *
+ * @return limits, cpusetCpus is left unset
+ */
+ContainerLimits readContainerLimits(const std::string& cgroupRoot, const CgroupPaths& paths);
+
+/**
+ * @brief Computes number of CPUs the server can actually use, the smallest of host cpus, cpuset and rounded up CPU quota
+ *
+ * @param limits
+ * @param hostCpus cpus reported by the host, 0 when unknown
+ *
+ * @return at least 1
+ */
+uint32_t computeEffectiveCpuCount(const ContainerLimits& limits, uint32_t hostCpus);
+
+/**
+ * @brief Gets limits of the cgroup the server runs in, detected once at first call
+ */
+const ContainerLimits& getContainerLimits();
+
+/**
+ * @brief Gets number of CPUs the server can use, used instead of host core count to size thread pools and default parameters
+ *
+ * @return at least 1
+ */
+uint32_t getEffectiveCpuCount();
+
+}  // namespace ovms
@@ -0,0 +1,88 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "cpupartitioning.hpp"
+
+#include <algorithm>
+#include <set>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+Status parseAvailableCpuList(const std::string& cpuList, const std::set<int>& availableCpus, cpu_list_t& cpus) {
+    if (!parseCpuList(cpuList, cpus)) {
+        SPDLOG_ERROR("Could not parse cpu list: {}", cpuList);
+        return StatusCode::CPU_LIST_WRONG_FORMAT;
+    }
+    for (int cpu : cpus) {
+        if (availableCpus.count(cpu) == 0) {
+            SPDLOG_ERROR("Cpu: {} of cpu list: {} is not available to the process", cpu, cpuList);
+            return StatusCode::CPU_LIST_WRONG_FORMAT;
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return StatusCode::OK;
+}
+
+Status CpuPartitioning::configure(const std::string& networkCpus, const std::string& backgroundCpus) {
+    const cpu_list_t allowedCpus = getAllowedCpus();
+    const std::set<int> availableCpus(allowedCpus.begin(), allowedCpus.end());
+    auto status = parseAvailableCpuList(networkCpus, availableCpus, this->networkCpus);
+    if (!status.ok()) {
+        return status;
+    }
+    status = parseAvailableCpuList(backgroundCpus, availableCpus, this->backgroundCpus);
+    if (!status.ok()) {
+        return status;
+    }
+    inferenceCpus.clear();
+    if (this->networkCpus.empty() && this->backgroundCpus.empty()) {
+        return StatusCode::OK;
+    }
+    for (int cpu : allowedCpus) {
+        if (std::find(this->networkCpus.begin(), this->networkCpus.end(), cpu) == this->networkCpus.end() &&
+            std::find(this->backgroundCpus.begin(), this->backgroundCpus.end(), cpu) == this->backgroundCpus.end()) {
+            inferenceCpus.push_back(cpu);
+        }
+    }
+    if (inferenceCpus.empty()) {
+        SPDLOG_WARN("No cpus left for inference streams by network and background cpus, streams can use all cpus");
+        inferenceCpus = allowedCpus;
+    }
+    return StatusCode::OK;
+}
+
+void CpuPartitioning::logLayout() const {
+    if (inferenceCpus.empty()) {
+        SPDLOG_DEBUG("CPU partitioning is not used");
+        return;
+    }
+    SPDLOG_INFO("CPU partitioning; network threads: {}; background threads: {}; inference streams: {}",
+        networkCpus.empty() ? "not pinned" : formatCpuList(networkCpus),
+        backgroundCpus.empty() ? "not pinned" : formatCpuList(backgroundCpus),
+        formatCpuList(inferenceCpus));
+}
+
+void CpuPartitioning::runOnCpus(const cpu_list_t& cpus, const std::function<void()>& function) {
+    if (cpus.empty()) {
+        function();
+        return;
+    }
+    runPinnedToCpus(cpus, function);
+}
+
+}  // namespace ovms
@@ -0,0 +1,102 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <functional>
+#include <set>
+#include <string>
+
+#include "numa.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Parses cpu list, sorted and without duplicates
+ *
+ * @return CPU_LIST_WRONG_FORMAT if cpu list is malformed or contains cpus outside of availableCpus
+ */
+Status parseAvailableCpuList(const std::string& cpuList, const std::set<int>& availableCpus, cpu_list_t& cpus);
+
+/**
+ * @brief Cpus assigned to groups of server threads, so network threads, inference streams and background
+ * tasks do not compete for the same cores. Nothing is pinned unless network or background cpus are given.
+ */
+class CpuPartitioning {
+public:
+    static CpuPartitioning& instance() {
+        static CpuPartitioning instance;
+        return instance;
+    }
+
+    /**
+     * @brief Sets cpus of thread groups, remaining cpus of the process are used by inference streams.
+     * Has to be called before any thread of the process is pinned.
+     *
+     * @param networkCpus cpu list of gRPC and REST threads, empty to leave them unpinned
+     * @param backgroundCpus cpu list of model manager threads, e.g. config and model files watcher, empty to leave them unpinned
+     *
+     * @return CPU_LIST_WRONG_FORMAT if cpu list is malformed or contains cpus the process cannot run on
+     */
+    Status configure(const std::string& networkCpus, const std::string& backgroundCpus);
+
+    /**
+     * @brief Logs cpus of each thread group
+     */
+    void logLayout() const;
+
+    /**
+     * @brief Runs function in a thread pinned to network cpus, or in the calling thread if they are not set.
+     * Threads started by the function inherit the affinity.
+     */
+    void runOnNetworkCpus(const std::function<void()>& function) const {
+        runOnCpus(networkCpus, function);
+    }
+
+    /**
+     * @brief Runs function in a thread pinned to background cpus, or in the calling thread if they are not set.
+     * Threads started by the function inherit the affinity.
+     */
+    void runOnBackgroundCpus(const std::function<void()>& function) const {
+        runOnCpus(backgroundCpus, function);
+    }
+
+    const cpu_list_t& getNetworkCpus() const {
+        return networkCpus;
+    }
+
+    const cpu_list_t& getBackgroundCpus() const {
+        return backgroundCpus;
+    }
+
+    /**
+     * @brief Gets cpus of inference streams of models without cpus in their config, empty when partitioning is not used
+     */
+    const cpu_list_t& getInferenceCpus() const {
+        return inferenceCpus;
+    }
+
+private:
+    CpuPartitioning() = default;
+
+    static void runOnCpus(const cpu_list_t& cpus, const std::function<void()>& function);
+
+    cpu_list_t networkCpus;
+    cpu_list_t backgroundCpus;
+    cpu_list_t inferenceCpus;
+};
+
+}  // namespace ovms
@@ -0,0 +1,64 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "criticalpathestimator.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ovms {
+
+CriticalPathEstimator::CriticalPathEstimator(std::vector<std::vector<size_t>> dependants) :
+    dependants(std::move(dependants)),
+    latencies(std::make_unique<std::atomic<uint64_t>[]>(this->dependants.size())),
+    priorities(std::make_unique<std::atomic<uint64_t>[]>(this->dependants.size())) {
+    for (size_t nodeId = 0; nodeId < this->dependants.size(); ++nodeId) {
+        latencies[nodeId].store(0, std::memory_order_relaxed);
+        priorities[nodeId].store(0, std::memory_order_relaxed);
+    }
+    recompute();
+}
+
+void CriticalPathEstimator::recordLatency(size_t nodeId, uint64_t microseconds) {
+    if (nodeId >= dependants.size()) {
+        return;
+    }
+    // measured latency is never 0 so that it is distinguished from unmeasured node
+    microseconds = std::max<uint64_t>(microseconds, 1);
+    auto previous = latencies[nodeId].load(std::memory_order_relaxed);
+    // exponentially weighted moving average, single slow execution does not reorder the pipeline
+    auto smoothed = previous == 0 ? microseconds : (previous * 7 + microseconds) / 8;
+    latencies[nodeId].store(smoothed, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(recomputeMtx, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    recompute();
+}
+
+void CriticalPathEstimator::recompute() {
+    // dependants have higher ids, so they are computed before the node in reverse order
+    for (size_t nodeId = dependants.size(); nodeId-- > 0;) {
+        auto latency = latencies[nodeId].load(std::memory_order_relaxed);
+        uint64_t priority = latency == 0 ? DEFAULT_NODE_LATENCY_MICROSECONDS : latency;
+        uint64_t longestDependantPath = 0;
+        for (auto dependantId : dependants[nodeId]) {
+            longestDependantPath = std::max(longestDependantPath, priorities[dependantId].load(std::memory_order_relaxed));
+        }
+        priorities[nodeId].store(priority + longestDependantPath, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace ovms
@@ -0,0 +1,74 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Estimates remaining critical path of each pipeline node, shared by all pipelines of one execution plan
+ *
+ * Priority of a node is its own latency plus the highest priority among its dependants, so it tells how long
+ * the pipeline still runs after the node starts. When several nodes compete for inference streams the one with
+ * the higher priority is started first. Latencies are measured by executed pipelines and smoothed, nodes not
+ * measured yet count as DEFAULT_NODE_LATENCY_MICROSECONDS so that priority falls back to downstream path length.
+ */
+class CriticalPathEstimator {
+public:
+    static constexpr uint64_t DEFAULT_NODE_LATENCY_MICROSECONDS = 1;
+
+    /**
+     * @param dependants ids of dependants of each node, node ids are expected to be in topological order
+     */
+    CriticalPathEstimator(std::vector<std::vector<size_t>> dependants);
+
+    CriticalPathEstimator(const CriticalPathEstimator&) = delete;
+    CriticalPathEstimator& operator=(const CriticalPathEstimator&) = delete;
+
+    /**
+     * @brief Gives remaining critical path length in microseconds, without locking
+     */
+    uint64_t getPriority(size_t nodeId) const {
+        return priorities[nodeId].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Updates smoothed latency of the node and recomputes priorities
+     *
+     * Recomputation is skipped when another pipeline is doing it at the moment, its result is refreshed by following measurement.
+     */
+    void recordLatency(size_t nodeId, uint64_t microseconds);
+
+    size_t getNodesCount() const {
+        return dependants.size();
+    }
+
+private:
+    void recompute();
+
+    const std::vector<std::vector<size_t>> dependants;
+    // 0 means that node was not measured yet
+    std::unique_ptr<std::atomic<uint64_t>[]> latencies;
+    std::unique_ptr<std::atomic<uint64_t>[]> priorities;
+    std::mutex recomputeMtx;
+};
+
+}  // namespace ovms
@@ -0,0 +1,271 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "custom_node.hpp"
+
+#include <functional>
+#include <numeric>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "logging.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Exposes output memory allocated by custom node library to the blob and frees it with library release
+ */
+class CustomNodeOutputAllocator : public InferenceEngine::IAllocator {
+    void* data;
+    release_fn release;
+
+public:
+    CustomNodeOutputAllocator(void* data, release_fn release) :
+        data(data),
+        release(release) {}
+
+    void* lock(void* handle, InferenceEngine::LockOp = InferenceEngine::LOCK_FOR_WRITE) noexcept override {
+        return handle;
+    }
+
+    void unlock(void* handle) noexcept override {}
+
+    void* alloc(size_t size) noexcept override {
+        return data;
+    }
+
+    bool free(void* handle) noexcept override {
+        return release(handle) == 0;
+    }
+
+    void Release() noexcept override {}
+};
+
+InferenceEngine::Precision toInferenceEnginePrecision(CustomNodeTensorPrecision precision) {
+    static const std::unordered_map<int, InferenceEngine::Precision> precisionMap{
+        {FP32, InferenceEngine::Precision::FP32},
+        {FP16, InferenceEngine::Precision::FP16},
+        {U8, InferenceEngine::Precision::U8},
+        {I8, InferenceEngine::Precision::I8},
+        {I16, InferenceEngine::Precision::I16},
+        {U16, InferenceEngine::Precision::U16},
+        {I32, InferenceEngine::Precision::I32},
+        {I64, InferenceEngine::Precision::I64}};
+    auto it = precisionMap.find(precision);
+    if (it == precisionMap.end()) {
+        return InferenceEngine::Precision::UNSPECIFIED;
+    }
+    return it->second;
+}
+
+CustomNodeTensorPrecision toCustomNodeTensorPrecision(const InferenceEngine::Precision& precision) {
+    switch (precision) {
+    case InferenceEngine::Precision::FP32:
+        return FP32;
+    case InferenceEngine::Precision::FP16:
+        return FP16;
+    case InferenceEngine::Precision::U8:
+        return U8;
+    case InferenceEngine::Precision::I8:
+        return I8;
+    case InferenceEngine::Precision::I16:
+        return I16;
+    case InferenceEngine::Precision::U16:
+        return U16;
+    case InferenceEngine::Precision::I32:
+        return I32;
+    case InferenceEngine::Precision::I64:
+        return I64;
+    default:
+        return UNSPECIFIED;
+    }
+}
+
+template <typename T>
+static InferenceEngine::Blob::Ptr makeLibraryBlob(const InferenceEngine::TensorDesc& desc, const std::shared_ptr<InferenceEngine::IAllocator>& allocator) {
+    auto blob = InferenceEngine::make_shared_blob<T>(desc, allocator);
+    blob->allocate();
+    return blob;
+}
+
+CustomNode::CustomNode(const std::string& nodeName, const NodeLibrary& library, const parameters_t& parameters,
+    std::unordered_map<std::string, std::string> nodeOutputNameAlias) :
+    Node(nodeName),
+    library(library),
+    parameters(parameters),
+    nodeOutputNameAlias(std::move(nodeOutputNameAlias)) {
+    // parameters are not modified later, so library receives pointers to their strings
+    libraryParameters.reserve(this->parameters.size());
+    for (const auto& [key, value] : this->parameters) {
+        libraryParameters.push_back({key.c_str(), value.c_str()});
+    }
+}
+
+Status CustomNode::execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
+    Status status;
+    {
+        StageTimer timer(this->metrics, NodeStage::INFERENCE);
+        status = executeLibrary();
+    }
+    // Library does not keep references to inputs after execution
+    this->inputBlobs.clear();
+    notifyEndQueue.push(*this);
+    return status;
+}
+
+Status CustomNode::executeLibrary() {
+    std::vector<struct CustomNodeTensor> inputs;
+    std::vector<std::vector<uint64_t>> inputsDims;
+    inputs.reserve(this->inputBlobs.size());
+    inputsDims.reserve(this->inputBlobs.size());
+    for (const auto& [name, blob] : this->inputBlobs) {
+        const auto& desc = blob->getTensorDesc();
+        const auto& dims = desc.getDims();
+        inputsDims.emplace_back(dims.begin(), dims.end());
+        inputs.push_back({name.c_str(),
+            blob->buffer().as<uint8_t*>(),
+            static_cast<uint64_t>(blob->byteSize()),
+            inputsDims.back().data(),
+            static_cast<uint64_t>(inputsDims.back().size()),
+            toCustomNodeTensorPrecision(desc.getPrecision())});
+    }
+
+    struct CustomNodeTensor* outputs = nullptr;
+    int outputsCount = 0;
+    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "[Node: {}] Executing custom node library with {} inputs", getName(), inputs.size());
+    int result = library.execute(inputs.data(), static_cast<int>(inputs.size()), &outputs, &outputsCount,
+        libraryParameters.data(), static_cast<int>(libraryParameters.size()));
+    if (result != 0) {
+        SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Custom node library execution failed with: {}", getName(), result);
+        return StatusCode::NODE_LIBRARY_EXECUTION_FAILED;
+    }
+    if (outputs == nullptr || outputsCount <= 0) {
+        SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Custom node library returned no outputs", getName());
+        if (outputs != nullptr) {
+            library.release(outputs);
+        }
+        return StatusCode::NODE_LIBRARY_OUTPUTS_CORRUPTED;
+    }
+
+    Status status = StatusCode::OK;
+    for (int i = 0; i < outputsCount; ++i) {
+        auto& tensor = outputs[i];
+        InferenceEngine::Blob::Ptr blob;
+        // data buffer ownership moves to the blob, buffer is released here in case of failure
+        auto outputStatus = status.ok() ? createOutputBlob(tensor, blob) : status;
+        if (outputStatus.ok()) {
+            resultBlobs.emplace(tensor.name, std::move(blob));
+        } else {
+            status = outputStatus;
+            if (tensor.data != nullptr) {
+                library.release(tensor.data);
+            }
+        }
+        if (tensor.name != nullptr) {
+            library.release(const_cast<char*>(tensor.name));
+        }
+        if (tensor.dims != nullptr) {
+            library.release(tensor.dims);
+        }
+    }
+    library.release(outputs);
+    if (!status.ok()) {
+        resultBlobs.clear();
+    }
+    return status;
+}
+
+Status CustomNode::createOutputBlob(const struct CustomNodeTensor& tensor, InferenceEngine::Blob::Ptr& blob) {
+    if (tensor.name == nullptr || tensor.data == nullptr || tensor.dims == nullptr || tensor.dimsCount == 0) {
+        SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Custom node library returned output with missing name, data or dims", getName());
+        return StatusCode::NODE_LIBRARY_OUTPUTS_CORRUPTED;
+    }
+    const auto precision = toInferenceEnginePrecision(tensor.precision);
+    if (precision == InferenceEngine::Precision::UNSPECIFIED) {
+        SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Custom node library returned output: {} with unsupported precision: {}", getName(), tensor.name, tensor.precision);
+        return StatusCode::NODE_LIBRARY_INVALID_PRECISION;
+    }
+    InferenceEngine::SizeVector dims(tensor.dims, tensor.dims + tensor.dimsCount);
+    const size_t expectedBytes = std::accumulate(dims.begin(), dims.end(), precision.size(), std::multiplies<size_t>());
+    if (expectedBytes != tensor.dataBytes) {
+        SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Custom node library returned output: {} with {} bytes while its shape requires {}",
+            getName(), tensor.name, tensor.dataBytes, expectedBytes);
+        return StatusCode::NODE_LIBRARY_OUTPUTS_CORRUPTED;
+    }
+
+    const InferenceEngine::TensorDesc desc{precision, dims, InferenceEngine::TensorDesc::getLayoutByDims(dims)};
+    auto allocator = std::make_shared<CustomNodeOutputAllocator>(tensor.data, library.release);
+    switch (tensor.precision) {
+    case FP32:
+        blob = makeLibraryBlob<float>(desc, allocator);
+        break;
+    case FP16:
+    case U16:
+        blob = makeLibraryBlob<uint16_t>(desc, allocator);
+        break;
+    case U8:
+        blob = makeLibraryBlob<uint8_t>(desc, allocator);
+        break;
+    case I8:
+        blob = makeLibraryBlob<int8_t>(desc, allocator);
+        break;
+    case I16:
+        blob = makeLibraryBlob<int16_t>(desc, allocator);
+        break;
+    case I32:
+        blob = makeLibraryBlob<int32_t>(desc, allocator);
+        break;
+    case I64:
+        blob = makeLibraryBlob<int64_t>(desc, allocator);
+        break;
+    default:
+        return StatusCode::NODE_LIBRARY_INVALID_PRECISION;
+    }
+    return StatusCode::OK;
+}
+
+Status CustomNode::fetchResults(BlobMap& outputs) {
+    StageTimer timer(this->metrics, NodeStage::FETCH_RESULTS);
+    for (const auto& node : this->next) {
+        for (const auto& pair : node.get().getMappingByDependency(*this)) {
+            const auto& alias = pair.first;
+            if (outputs.count(alias) == 1) {
+                continue;
+            }
+            const auto& libraryOutputName = nodeOutputNameAlias.count(alias) == 1 ? nodeOutputNameAlias.at(alias) : alias;
+            auto it = resultBlobs.find(libraryOutputName);
+            if (it == resultBlobs.end()) {
+                SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Custom node library did not return required output: {}", getName(), libraryOutputName);
+                return StatusCode::NODE_LIBRARY_MISSING_OUTPUT;
+            }
+            outputs.emplace(alias, it->second);
+            SPDLOG_DEBUG("[Node: {}]: Blob with name {} has been prepared", getName(), alias);
+        }
+    }
+    this->release();
+    return StatusCode::OK;
+}
+
+void CustomNode::release() {
+    resultBlobs.clear();
+}
+
+void CustomNode::reset() {
+    release();
+    Node::reset();
+}
+
+}  // namespace ovms
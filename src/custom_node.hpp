@@ -0,0 +1,70 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "custom_node_interface.h"
+#include "node.hpp"
+#include "node_library.hpp"
+
+namespace ovms {
+
+using parameters_t = std::unordered_map<std::string, std::string>;
+
+/**
+ * @brief Executes custom node library in pipeline thread
+ *
+ * Library reads input blobs memory in place and returns outputs allocated by itself. Output blobs are wrapped
+ * around memory of the library without copying and it is released with library release once blobs are destroyed.
+ */
+class CustomNode : public Node {
+    NodeLibrary library;
+    parameters_t parameters;
+    std::vector<struct CustomNodeParam> libraryParameters;
+    std::unordered_map<std::string, std::string> nodeOutputNameAlias;
+
+    BlobMap resultBlobs;
+
+public:
+    CustomNode(const std::string& nodeName, const NodeLibrary& library, const parameters_t& parameters,
+        std::unordered_map<std::string, std::string> nodeOutputNameAlias = {});
+
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override;
+
+    Status fetchResults(BlobMap& outputs) override;
+
+    void release() override;
+
+    void reset() override;
+
+private:
+    Status executeLibrary();
+
+    Status createOutputBlob(const struct CustomNodeTensor& tensor, InferenceEngine::Blob::Ptr& blob);
+};
+
+/**
+ * @brief Maps library tensor precision to blob precision, unknown precision is returned as UNSPECIFIED
+ */
+InferenceEngine::Precision toInferenceEnginePrecision(CustomNodeTensorPrecision precision);
+
+CustomNodeTensorPrecision toCustomNodeTensorPrecision(const InferenceEngine::Precision& precision);
+
+}  // namespace ovms
@@ -0,0 +1,82 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief C API of custom node libraries executed inside DAG pipelines.
+ *
+ * Library is loaded with dlopen and is required to export execute and release symbols.
+ * Input tensors point to pipeline memory and must not be modified nor freed by the library.
+ * Output tensors array together with each output name, data and dims buffer are allocated
+ * by the library and returned to it with release once the server does not need them anymore.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    UNSPECIFIED,
+    FP32,
+    FP16,
+    U8,
+    I8,
+    I16,
+    U16,
+    I32,
+    I64
+} CustomNodeTensorPrecision;
+
+struct CustomNodeTensor {
+    const char* name;
+    uint8_t* data;
+    uint64_t dataBytes;
+    uint64_t* dims;
+    uint64_t dimsCount;
+    CustomNodeTensorPrecision precision;
+};
+
+struct CustomNodeParam {
+    const char* key;
+    const char* value;
+};
+
+/**
+ * @brief Executes node processing
+ *
+ * @param inputs array of input tensors
+ * @param inputsCount
+ * @param outputs set to array of output tensors allocated by the library
+ * @param outputsCount set to number of output tensors
+ * @param params array of node parameters from pipeline configuration
+ * @param paramsCount
+ *
+ * @return 0 on success, outputs are not read by the server otherwise
+ */
+int execute(const struct CustomNodeTensor* inputs, int inputsCount, struct CustomNodeTensor** outputs, int* outputsCount, const struct CustomNodeParam* params, int paramsCount);
+
+/**
+ * @brief Releases memory allocated by execute - outputs array, names, data and dims buffers
+ *
+ * @return 0 on success
+ */
+int release(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,9 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,12 +27,59 @@ enum class CustomLoaderStatus {
     OK,                /*!< Success */
     MODEL_TYPE_IR,     /*!< When model buffers are returned, they belong to IR model */
     MODEL_TYPE_ONNX,   /*!< When model buffers are returned, they belong to ONXX model */
-    MODEL_TYPE_BLOB,   /*!< When model buffers are returned, they belong to Blob */
+    MODEL_TYPE_BLOB,   /*!< When model buffers are returned, model buffer holds network precompiled for the target device */
     MODEL_LOAD_ERROR,  /*!< Error while loading the model */
     MODEL_BLACKLISTED, /*!< Model is blacklisted. Do not load */
-    INTERNAL_ERROR     /*!< generic error */
+    INTERNAL_ERROR,    /*!< generic error */
+    NOT_IMPLEMENTED    /*!< Optional interface function is not implemented by the loader */
 };
 
+/**
+ * @brief Memory owned by the custom loader, e.g. decrypted data or a mapped file, returned to OVMS without a copy
+ */
+struct CustomLoaderBuffer {
+    const uint8_t* data = nullptr; /*!< Start of the buffer, has to stay valid until release is called */
+    size_t size = 0;               /*!< Size of the buffer in bytes */
+    std::function<void()> release; /*!< Called once when OVMS stops using the buffer, may be empty */
+};
+
+/**
+ * @brief Declares which calls of the loader OVMS may make at the same time for different models
+ */
+enum class CustomLoaderThreadSafety {
+    SERIALIZED, /*!< Loader functions are never called concurrently, asynchronous loads still complete in parallel */
+    CONCURRENT  /*!< Loader functions may be called concurrently from several model loading threads */
+};
+
+/**
+ * @brief Called once by the loader when an asynchronous load finishes, with the status loadModelBuffers would return
+ */
+using custom_loader_callback_t = std::function<void(CustomLoaderStatus status, CustomLoaderBuffer model, CustomLoaderBuffer weights)>;
+
+/**
+ * @brief Changes of models pushed by loaders which registered an event callback
+ */
+enum class CustomLoaderEvent {
+    BLACKLISTED,   /*!< Version must not be served, it is unloaded */
+    UNBLACKLISTED, /*!< Blacklisted version may be loaded again */
+    MODEL_CHANGED  /*!< Content returned for the version changed, it is loaded again */
+};
+
+/**
+ * @brief Called by the loader from any thread to notify OVMS about a change of a model version
+ */
+using custom_loader_event_callback_t = std::function<void(CustomLoaderEvent event, const std::string& modelName, int version)>;
+
+/**
+ * @brief Version of the interface which loaders derived from this header implement by default
+ */
+constexpr int CUSTOM_LOADER_INTERFACE_VERSION_1 = 1;
+
+/**
+ * @brief Version of the interface in which models are loaded with loadModelBuffers
+ */
+constexpr int CUSTOM_LOADER_INTERFACE_VERSION_2 = 2;
+
 /**
      * @brief This class is the custom loader interface base class.
      * Custom Loader implementation shall derive from this base calss
@@ -58,6 +108,69 @@ public:
          */
     virtual CustomLoaderStatus loaderInit(const std::string& loaderConfigFile) = 0;
 
+    /**
+         * @brief Version of the interface implemented by the loader. Loaders of version 2 are loaded with loadModelBuffers
+         * and loaders of version 1 with loadModelWithSharedWeights and loadModel.
+         *
+         * @return CUSTOM_LOADER_INTERFACE_VERSION_1 or CUSTOM_LOADER_INTERFACE_VERSION_2
+         */
+    virtual int getInterfaceVersion() const {
+        return CUSTOM_LOADER_INTERFACE_VERSION_1;
+    }
+
+    /**
+         * @brief Thread safety level of the loader, OVMS serializes calls of SERIALIZED loaders
+         *
+         * @return thread safety level
+         */
+    virtual CustomLoaderThreadSafety getThreadSafety() const {
+        return CustomLoaderThreadSafety::SERIALIZED;
+    }
+
+    /**
+         * @brief Start loading the model in the background, e.g. while waiting for a remote key service, and return immediately.
+         * Version 2 only. Loading threads of OVMS wait for the callback without blocking calls of other models, so loads
+         * of many models progress at once also through a SERIALIZED loader. When NOT_IMPLEMENTED is returned loadModelBuffers
+         * is called instead.
+         *
+         * @param model name required to be loaded - defined under model config in the config file
+         * @param base path where the required model files are present
+         * @param version of the model
+         * @param loader config parameters json as string
+         * @param callback called exactly once with the result and buffers when OK is returned, never called otherwise
+         * @return status OK when the load was started
+         */
+    virtual CustomLoaderStatus loadModelBuffersAsync(const std::string& modelName,
+        const std::string& basePath,
+        const int version,
+        const std::string& loaderOptions,
+        custom_loader_callback_t callback) {
+        return CustomLoaderStatus::NOT_IMPLEMENTED;
+    }
+
+    /**
+         * @brief Load the model by the custom loader into buffers it owns, which OVMS uses without copying them.
+         * Weights buffer is used as weights blob of the network for as long as the network is used, model buffer
+         * is released as soon as the network is read. Buffers are released also when loading fails.
+         * When NOT_IMPLEMENTED is returned, version 1 functions are called instead.
+         *
+         * @param model name required to be loaded - defined under model config in the config file
+         * @param base path where the required model files are present
+         * @param version of the model
+         * @param loader config parameters json as string
+         * @param model buffer, .xml or .onnx file content
+         * @param weights buffer, .bin file content of IR models
+         * @return status (On success, the return value will specify the type of model (IR,ONNX) read into buffers)
+         */
+    virtual CustomLoaderStatus loadModelBuffers(const std::string& modelName,
+        const std::string& basePath,
+        const int version,
+        const std::string& loaderOptions,
+        CustomLoaderBuffer& model,
+        CustomLoaderBuffer& weights) {
+        return CustomLoaderStatus::NOT_IMPLEMENTED;
+    }
+
     /**
          * @brief Load the model by the custom loader
          *
@@ -76,6 +189,29 @@ public:
         std::vector<uint8_t>& modelBuffer,
         std::vector<uint8_t>& weights) = 0;
 
+    /**
+         * @brief Load the model by the custom loader with weights kept in memory owned by the loader, e.g. a mapped file,
+         * so they are not copied into a vector. Optional, when NOT_IMPLEMENTED is returned loadModel is called instead.
+         *
+         * @param model name required to be loaded - defined under model config in the config file
+         * @param base path where the required model files are present
+         * @param version of the model
+         * @param loader config parameters json as string
+         * @param vector of uint8_t of model
+         * @param weights held by OVMS as long as the network read from them is used, deleter releases the memory
+         * @param size of weights in bytes
+         * @return status (On success, the return value will specify the type of model (IR,ONNX) read into buffers)
+         */
+    virtual CustomLoaderStatus loadModelWithSharedWeights(const std::string& modelName,
+        const std::string& basePath,
+        const int version,
+        const std::string& loaderOptions,
+        std::vector<uint8_t>& modelBuffer,
+        std::shared_ptr<const uint8_t>& weights,
+        size_t& weightsSize) {
+        return CustomLoaderStatus::NOT_IMPLEMENTED;
+    }
+
     /**
          * @brief Get the model black list status
          *
@@ -87,6 +223,18 @@ public:
         return CustomLoaderStatus::OK;
     }
 
+    /**
+         * @brief Register the callback through which the loader pushes blacklist and change events. Called once after loaderInit.
+         * When OK is returned OVMS reacts to the events right away and no longer polls getModelBlacklistStatus,
+         * versions are not blacklisted until BLACKLISTED event is pushed for them.
+         *
+         * @param callback valid until loaderDeInit is called
+         * @return status OK when events will be pushed, NOT_IMPLEMENTED by default
+         */
+    virtual CustomLoaderStatus registerEventCallback(custom_loader_event_callback_t callback) {
+        return CustomLoaderStatus::NOT_IMPLEMENTED;
+    }
+
     /**
          * @brief Unload model resources by custom loader once model is unloaded by OVMS
          *
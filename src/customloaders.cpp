@@ -16,6 +16,8 @@
 
 #include "customloaders.hpp"
 
+#include <limits>
+
 #include <spdlog/spdlog.h>
 
 #include "customloaderinterface.hpp"
@@ -69,12 +71,85 @@ Status CustomLoaders::move(const std::string& name) {
     return StatusCode::OK;
 }
 
+std::unique_lock<std::mutex> CustomLoaders::lockForCall(const std::shared_ptr<CustomLoaderInterface>& loader) {
+    if (loader->getThreadSafety() == CustomLoaderThreadSafety::CONCURRENT) {
+        return std::unique_lock<std::mutex>();
+    }
+    std::mutex* callMutex = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(callMutexesMtx);
+        auto& entry = callMutexes[loader.get()];
+        if (entry == nullptr) {
+            entry = std::make_unique<std::mutex>();
+        }
+        // mutexes are never removed, so the pointer outlives the map lock
+        callMutex = entry.get();
+    }
+    return std::unique_lock<std::mutex>(*callMutex);
+}
+
+void CustomLoaders::setPushingEvents(const CustomLoaderInterface* loader) {
+    std::lock_guard<std::mutex> lock(pushedEventsMtx);
+    pushedEvents[loader];
+}
+
+bool CustomLoaders::isPushingEvents(const CustomLoaderInterface* loader) const {
+    std::lock_guard<std::mutex> lock(pushedEventsMtx);
+    return pushedEvents.count(loader) > 0;
+}
+
+void CustomLoaders::handleEvent(const CustomLoaderInterface* loader, CustomLoaderEvent event, const std::string& modelName, int version) {
+    std::lock_guard<std::mutex> lock(pushedEventsMtx);
+    auto it = pushedEvents.find(loader);
+    if (it == pushedEvents.end()) {
+        return;
+    }
+    const auto key = std::make_pair(modelName, version);
+    switch (event) {
+    case CustomLoaderEvent::BLACKLISTED:
+        SPDLOG_INFO("Custom loader blacklisted model: {} version: {}", modelName, version);
+        it->second.blacklisted.insert(key);
+        break;
+    case CustomLoaderEvent::UNBLACKLISTED:
+        SPDLOG_INFO("Custom loader unblacklisted model: {} version: {}", modelName, version);
+        it->second.blacklisted.erase(key);
+        break;
+    case CustomLoaderEvent::MODEL_CHANGED:
+        SPDLOG_INFO("Custom loader reported change of model: {} version: {}", modelName, version);
+        it->second.changed.insert(key);
+        break;
+    }
+}
+
+bool CustomLoaders::isBlacklisted(const CustomLoaderInterface* loader, const std::string& modelName, int version) const {
+    std::lock_guard<std::mutex> lock(pushedEventsMtx);
+    auto it = pushedEvents.find(loader);
+    return it != pushedEvents.end() && it->second.blacklisted.count({modelName, version}) > 0;
+}
+
+std::set<int> CustomLoaders::takeChangedVersions(const CustomLoaderInterface* loader, const std::string& modelName) {
+    std::lock_guard<std::mutex> lock(pushedEventsMtx);
+    std::set<int> versions;
+    auto it = pushedEvents.find(loader);
+    if (it == pushedEvents.end()) {
+        return versions;
+    }
+    auto& changed = it->second.changed;
+    for (auto versionIt = changed.lower_bound({modelName, std::numeric_limits<int>::min()}); versionIt != changed.end() && versionIt->first == modelName;) {
+        versions.insert(versionIt->second);
+        versionIt = changed.erase(versionIt);
+    }
+    return versions;
+}
+
 Status CustomLoaders::finalize() {
     // By now the remaining loaders in current list are not there in new config. Delete them
     for (auto it = customLoaderInterfacePtrs.begin(); it != customLoaderInterfacePtrs.end(); it++) {
         SPDLOG_INFO("Loader {} is not there in new list.. deleting the same", it->first);
         auto loaderPtr = (it->second).second;
         loaderPtr->loaderDeInit();
+        std::lock_guard<std::mutex> lock(pushedEventsMtx);
+        pushedEvents.erase(loaderPtr.get());
     }
 
     SPDLOG_INFO("Clearing the list");
@@ -17,6 +17,8 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -45,6 +47,19 @@ private:
 
     std::vector<std::string> currentCustomLoaderNames;
 
+    std::mutex callMutexesMtx;
+    std::map<const CustomLoaderInterface*, std::unique_ptr<std::mutex>> callMutexes;
+
+    /**
+         * @brief State pushed by a loader which registered an event callback
+         */
+    struct PushedEvents {
+        std::set<std::pair<std::string, int>> blacklisted;
+        std::set<std::pair<std::string, int>> changed;
+    };
+    mutable std::mutex pushedEventsMtx;
+    std::map<const CustomLoaderInterface*, PushedEvents> pushedEvents;
+
 public:
     /**
          * @brief Gets the instance of the CustomLoaders
@@ -88,5 +103,37 @@ public:
          * @return status
          */
     Status finalize();
+
+    /**
+         * @brief Lock to be held while calling functions of the loader, owns nothing for CONCURRENT loaders
+         *
+         * @return lock
+         */
+    std::unique_lock<std::mutex> lockForCall(const std::shared_ptr<CustomLoaderInterface>& loader);
+
+    /**
+         * @brief Marks the loader as pushing its events, its blacklist is no longer polled
+         */
+    void setPushingEvents(const CustomLoaderInterface* loader);
+
+    /**
+         * @brief Checks if the loader registered an event callback
+         */
+    bool isPushingEvents(const CustomLoaderInterface* loader) const;
+
+    /**
+         * @brief Records an event pushed by the loader
+         */
+    void handleEvent(const CustomLoaderInterface* loader, CustomLoaderEvent event, const std::string& modelName, int version);
+
+    /**
+         * @brief Checks if the version was blacklisted by an event of the loader
+         */
+    bool isBlacklisted(const CustomLoaderInterface* loader, const std::string& modelName, int version) const;
+
+    /**
+         * @brief Gives versions of the model reported as changed by the loader since the previous call
+         */
+    std::set<int> takeChangedVersions(const CustomLoaderInterface* loader, const std::string& modelName);
 };
 }  // namespace ovms
@@ -0,0 +1,73 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "customnodelibrarymanager.hpp"
+
+#include <dlfcn.h>
+
+#include <spdlog/spdlog.h>
+
+#include "logging.hpp"
+
+namespace ovms {
+
+Status CustomNodeLibraryManager::loadLibrary(const std::string& name, const std::string& basePath) {
+    std::unique_lock<std::mutex> lock(librariesMtx);
+    auto it = libraries.find(name);
+    if (it != libraries.end()) {
+        if (it->second.first != basePath) {
+            SPDLOG_LOGGER_WARN(modelmanager_logger, "Custom node library name: {} is already loaded from: {}, reload from: {} is not supported",
+                name, it->second.first, basePath);
+        }
+        return StatusCode::NODE_LIBRARY_ALREADY_LOADED;
+    }
+
+    SPDLOG_LOGGER_INFO(modelmanager_logger, "Loading custom node library name: {}; base_path: {}", name, basePath);
+    void* handle = dlopen(basePath.c_str(), RTLD_LAZY | RTLD_LOCAL);
+    if (!handle) {
+        SPDLOG_LOGGER_ERROR(modelmanager_logger, "Cannot open custom node library: {} {}", basePath, dlerror());
+        return StatusCode::NODE_LIBRARY_LOAD_FAILED_OPEN;
+    }
+
+    NodeLibrary library;
+    library.execute = reinterpret_cast<execute_fn>(dlsym(handle, "execute"));
+    if (library.execute == nullptr) {
+        SPDLOG_LOGGER_ERROR(modelmanager_logger, "Cannot load symbol execute of custom node library: {} {}", basePath, dlerror());
+        dlclose(handle);
+        return StatusCode::NODE_LIBRARY_LOAD_FAILED_SYM;
+    }
+    library.release = reinterpret_cast<release_fn>(dlsym(handle, "release"));
+    if (library.release == nullptr) {
+        SPDLOG_LOGGER_ERROR(modelmanager_logger, "Cannot load symbol release of custom node library: {} {}", basePath, dlerror());
+        dlclose(handle);
+        return StatusCode::NODE_LIBRARY_LOAD_FAILED_SYM;
+    }
+
+    libraries.emplace(name, std::make_pair(basePath, library));
+    SPDLOG_LOGGER_INFO(modelmanager_logger, "Successfully loaded custom node library name: {}; base_path: {}", name, basePath);
+    return StatusCode::OK;
+}
+
+Status CustomNodeLibraryManager::getLibrary(const std::string& name, NodeLibrary& library) const {
+    std::unique_lock<std::mutex> lock(librariesMtx);
+    auto it = libraries.find(name);
+    if (it == libraries.end()) {
+        return StatusCode::NODE_LIBRARY_MISSING;
+    }
+    library = it->second.second;
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
@@ -0,0 +1,60 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "node_library.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Loads custom node libraries referenced by pipeline nodes
+ *
+ * Libraries are never unloaded, since nodes of pipelines still in progress may execute them.
+ * Reloading library under the same name with changed path is not supported.
+ */
+class CustomNodeLibraryManager {
+    std::unordered_map<std::string, std::pair<std::string, NodeLibrary>> libraries;
+    mutable std::mutex librariesMtx;
+
+public:
+    /**
+     * @brief Opens library and resolves its execute and release symbols
+     *
+     * @param name of the library referred by pipeline nodes
+     * @param basePath path to shared object file
+     *
+     * @return Status
+     */
+    Status loadLibrary(const std::string& name, const std::string& basePath);
+
+    /**
+     * @brief Gets entry points of already loaded library
+     *
+     * @param name
+     * @param library
+     *
+     * @return Status
+     */
+    Status getLibrary(const std::string& name, NodeLibrary& library) const;
+};
+
+}  // namespace ovms
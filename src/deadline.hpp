@@ -0,0 +1,54 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+
+namespace ovms {
+
+/**
+ * @brief Point in time after which request result is not needed by the client anymore
+ */
+using deadline_t = std::chrono::steady_clock::time_point;
+
+const deadline_t NO_DEADLINE = deadline_t::max();
+
+/**
+ * @brief Checks if deadline already passed, requests without deadline never expire
+ */
+inline bool isDeadlineExceeded(const deadline_t& deadline) {
+    return deadline != NO_DEADLINE && std::chrono::steady_clock::now() >= deadline;
+}
+
+/**
+ * @brief Converts deadline in system clock, as reported by gRPC, to steady clock one
+ */
+inline deadline_t deadlineFromSystemClock(const std::chrono::system_clock::time_point& deadline) {
+    if (deadline == std::chrono::system_clock::time_point::max()) {
+        return NO_DEADLINE;
+    }
+    return std::chrono::steady_clock::now() +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(deadline - std::chrono::system_clock::now());
+}
+
+/**
+ * @brief Deadline for client timeout counted from now
+ */
+inline deadline_t deadlineAfter(const std::chrono::milliseconds& timeout) {
+    return std::chrono::steady_clock::now() + timeout;
+}
+
+}  // namespace ovms
@@ -0,0 +1,100 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "deadlinetimer.hpp"
+
+#include "samplingprofiler.hpp"
+
+namespace ovms {
+
+DeadlineTimer::DeadlineTimer() :
+    thread(&DeadlineTimer::run, this) {}
+
+DeadlineTimer::~DeadlineTimer() {
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        stopRequested = true;
+    }
+    scheduledCondition.notify_all();
+    thread.join();
+}
+
+DeadlineTimer::timer_id_t DeadlineTimer::schedule(const deadline_t& deadline, std::function<void()> callback) {
+    if (deadline == NO_DEADLINE) {
+        return NO_TIMER;
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    const timer_id_t id = nextId++;
+    const bool earliest = timers.empty() || deadline < timers.begin()->first.first;
+    timers.emplace(std::make_pair(deadline, id), std::move(callback));
+    deadlines.emplace(id, deadline);
+    if (earliest) {
+        // timer thread sleeps until the previous earliest deadline
+        scheduledCondition.notify_one();
+    }
+    return id;
+}
+
+bool DeadlineTimer::cancel(timer_id_t id) {
+    if (id == NO_TIMER) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    auto it = deadlines.find(id);
+    if (it != deadlines.end()) {
+        timers.erase(std::make_pair(it->second, id));
+        deadlines.erase(it);
+        return true;
+    }
+    if (std::this_thread::get_id() != thread.get_id()) {
+        finishedCondition.wait(lock, [this, id]() { return runningId != id; });
+    }
+    return false;
+}
+
+size_t DeadlineTimer::getScheduledCount() const {
+    std::unique_lock<std::mutex> lock(mtx);
+    return timers.size();
+}
+
+void DeadlineTimer::run() {
+    setCurrentThreadName("ovms_deadlines");
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopRequested) {
+        if (timers.empty()) {
+            scheduledCondition.wait(lock);
+            continue;
+        }
+        auto first = timers.begin();
+        if (first->first.first > std::chrono::steady_clock::now()) {
+            // copied, the timer may be cancelled while waiting
+            const deadline_t earliest = first->first.first;
+            scheduledCondition.wait_until(lock, earliest);
+            continue;
+        }
+        runningId = first->first.second;
+        auto callback = std::move(first->second);
+        deadlines.erase(runningId);
+        timers.erase(first);
+        lock.unlock();
+        callback();
+        callback = nullptr;
+        lock.lock();
+        runningId = NO_TIMER;
+        finishedCondition.notify_all();
+    }
+}
+
+}  // namespace ovms
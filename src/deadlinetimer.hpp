@@ -0,0 +1,92 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "deadline.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Single thread calling callbacks once their deadlines pass, used by requests waiting without a thread
+ * blocked on them, e.g. asynchronously executed pipelines or queued waiters, so that they fail on time
+ * instead of only when they make progress
+ */
+class DeadlineTimer {
+public:
+    using timer_id_t = uint64_t;
+
+    /**
+     * @brief Id never returned by schedule, callers can use it for no timer
+     */
+    static constexpr timer_id_t NO_TIMER = 0;
+
+    DeadlineTimer();
+
+    /**
+     * @brief Stops the thread, callbacks which did not run by then are dropped
+     */
+    ~DeadlineTimer();
+
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    static DeadlineTimer& instance() {
+        static DeadlineTimer timer;
+        return timer;
+    }
+
+    /**
+     * @brief Calls callback on the timer thread once deadline passes, callbacks have to be short and must not block
+     *
+     * @return id for cancel, NO_TIMER for NO_DEADLINE which never passes
+     */
+    timer_id_t schedule(const deadline_t& deadline, std::function<void()> callback);
+
+    /**
+     * @brief Cancels callback which did not run yet. If it is running on the timer thread waits until it returns,
+     * so that objects used by the callback can be destroyed afterwards. Called from the callback itself does not wait.
+     *
+     * @return true when callback was cancelled before it started
+     */
+    bool cancel(timer_id_t id);
+
+    size_t getScheduledCount() const;
+
+private:
+    void run();
+
+    mutable std::mutex mtx;
+    std::condition_variable scheduledCondition;
+    std::condition_variable finishedCondition;
+    // ordered by deadline, id keeps entries of the same deadline unique
+    std::map<std::pair<deadline_t, timer_id_t>, std::function<void()>> timers;
+    std::unordered_map<timer_id_t, deadline_t> deadlines;
+    timer_id_t nextId = NO_TIMER + 1;
+    timer_id_t runningId = NO_TIMER;
+    bool stopRequested = false;
+    std::thread thread;
+};
+
+}  // namespace ovms
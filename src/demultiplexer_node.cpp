@@ -0,0 +1,356 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "demultiplexer_node.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+#include <spdlog/spdlog.h>
+
+#include "deserialization.hpp"
+#include "ov_utils.hpp"
+#include "tensorinfo.hpp"
+
+namespace ovms {
+
+DemultiplexerNode::DemultiplexerNode(const std::string& nodeName, const std::string& modelName, std::optional<model_version_t> modelVersion,
+    ModelManager& modelManager,
+    std::unordered_map<std::string, std::string> nodeOutputNameAlias,
+    std::vector<DemultiplexedStep> steps) :
+    Node(nodeName),
+    modelName(modelName),
+    modelVersion(modelVersion),
+    modelManager(modelManager),
+    nodeOutputNameAlias(std::move(nodeOutputNameAlias)),
+    steps(std::move(steps)) {
+    slicesQueue.setPushListener([this]() { relaySliceMessage(); });
+    // steps depend only on the node model and preceding steps, as ensured by pipeline validation
+    for (size_t i = 0; i < this->steps.size(); ++i) {
+        auto& inputs = stepsInputs.emplace_back();
+        for (const auto& [dependencyName, mapping] : this->steps[i].dependencies) {
+            if (dependencyName == getName()) {
+                inputs.emplace_back(0, mapping);
+                continue;
+            }
+            auto it = std::find_if(this->steps.begin(), this->steps.begin() + i,
+                [&dependencyName](const DemultiplexedStep& step) { return step.nodeName == dependencyName; });
+            if (it == this->steps.begin() + i) {
+                SPDLOG_WARN("[Node: {}] Demultiplexed step: {} depends on unknown step: {}", getName(), this->steps[i].nodeName, dependencyName);
+                continue;
+            }
+            inputs.emplace_back(1 + std::distance(this->steps.begin(), it), mapping);
+        }
+    }
+}
+
+DemultiplexerNode::~DemultiplexerNode() {
+    release();
+}
+
+void DemultiplexerNode::relaySliceMessage() {
+    std::unique_lock<std::mutex> lock(relayMtx);
+    if (this->notifyEndQueue != nullptr) {
+        this->notifyEndQueue->push(*this);
+    }
+    relayedSlicesMessagesCount++;
+    relayedCondition.notify_all();
+}
+
+Status DemultiplexerNode::execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
+    if (slices.empty()) {
+        auto status = split();
+        if (!status.ok()) {
+            notifyEndQueue.push(*this);
+            return status;
+        }
+        {
+            std::unique_lock<std::mutex> lock(relayMtx);
+            this->notifyEndQueue = &notifyEndQueue;
+        }
+        SPDLOG_DEBUG("[Node: {}] Starting inference of {} demultiplexed elements", getName(), slices.size());
+        for (size_t i = 0; i < slices.size(); ++i) {
+            startSlice(i);
+        }
+    } else {
+        // Each following call is triggered by exactly one relayed message, so the message is already in the queue
+        auto& slice = slicesQueue.pull().get();
+        pulledSlicesMessagesCount++;
+        processSliceMessage(slice.getId());
+    }
+    if (finishedSlicesCount < slices.size()) {
+        return StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET;
+    }
+    SPDLOG_DEBUG("[Node: {}] All {} demultiplexed elements finished with: {}", getName(), slices.size(), slicesStatus.string());
+    notifyEndQueue.push(*this);
+    return slicesStatus;
+}
+
+Status DemultiplexerNode::split() {
+    if (this->inputBlobs.empty()) {
+        SPDLOG_DEBUG("[Node: {}] No inputs to demultiplex", getName());
+        return StatusCode::INVALID_MISSING_INPUT;
+    }
+    std::optional<size_t> slicesCount;
+    for (const auto& [name, blob] : this->inputBlobs) {
+        const auto& dims = blob->getTensorDesc().getDims();
+        if (dims.empty()) {
+            std::stringstream ss;
+            ss << "Input: " << name << " has no dimension to demultiplex";
+            const std::string details = ss.str();
+            SPDLOG_DEBUG("[Node: {}] {}", getName(), details);
+            return Status(StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS, details);
+        }
+        if (slicesCount && slicesCount.value() != dims[0]) {
+            std::stringstream ss;
+            ss << "Expected: " << slicesCount.value() << "; Actual: " << dims[0] << "; input: " << name;
+            const std::string details = ss.str();
+            SPDLOG_DEBUG("[Node: {}] Inputs differ in 0th dimension - {}", getName(), details);
+            return Status(StatusCode::INVALID_BATCH_SIZE, details);
+        }
+        slicesCount = dims[0];
+    }
+    if (slicesCount.value() == 0) {
+        SPDLOG_DEBUG("[Node: {}] Inputs have no elements to demultiplex", getName());
+        return Status(StatusCode::INVALID_BATCH_SIZE, "Inputs of demultiplexer node have no elements");
+    }
+
+    requiredOutputNames.clear();
+    for (const auto& node : this->next) {
+        for (const auto& pair : node.get().getMappingByDependency(*this)) {
+            requiredOutputNames.push_back(pair.first);
+        }
+    }
+    stagesRequiredOutputNames.assign(steps.size() + 1, {});
+    stagesRequiredOutputNames.back() = requiredOutputNames;
+    for (const auto& inputs : stepsInputs) {
+        for (const auto& [stage, mapping] : inputs) {
+            for (const auto& pair : mapping) {
+                stagesRequiredOutputNames[stage].push_back(pair.first);
+            }
+        }
+    }
+    for (size_t i = 0; i < slicesCount.value(); ++i) {
+        auto slice = std::make_unique<DemultiplexedNode>(getName() + "_" + std::to_string(i), modelName, modelVersion, modelManager,
+            nodeOutputNameAlias, stagesRequiredOutputNames[0]);
+        slice->setId(i);
+        // slices are measured as executions of the demultiplexer node
+        slice->setMetrics(this->metrics);
+        slices.emplace_back(std::move(slice));
+    }
+    for (const auto& [name, blob] : this->inputBlobs) {
+        const auto& desc = blob->getTensorDesc();
+        auto sliceDims = desc.getDims();
+        sliceDims[0] = 1;
+        const InferenceEngine::TensorDesc sliceDesc{desc.getPrecision(), sliceDims, desc.getLayout()};
+        const size_t sliceByteSize = blob->byteSize() / slices.size();
+        const auto source = blob->cbuffer().as<const char*>();
+        for (size_t i = 0; i < slices.size(); ++i) {
+            auto sliceBlob = allocateConvertedBlob(sliceDesc);
+            if (!sliceBlob) {
+                return StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
+            }
+            std::memcpy(sliceBlob->buffer().as<char*>(), source + i * sliceByteSize, sliceByteSize);
+            slices[i]->setInput(name, std::move(sliceBlob));
+        }
+    }
+    this->inputBlobs.clear();
+    slicesStates.assign(slices.size(), SliceState::IN_FLIGHT);
+    slicesStages.assign(slices.size(), 0);
+    slicesOutputs.assign(slices.size(), std::vector<BlobMap>(steps.size() + 1));
+    return StatusCode::OK;
+}
+
+Status DemultiplexerNode::startNextStage(size_t index) {
+    const size_t stage = ++slicesStages[index];
+    const auto& step = steps[stage - 1];
+    auto node = std::make_unique<DemultiplexedNode>(step.nodeName + "_" + std::to_string(index), step.modelName, step.modelVersion, modelManager,
+        step.nodeOutputNameAlias, stagesRequiredOutputNames[stage]);
+    node->setId(index);
+    node->setMetrics(this->metrics);
+    for (const auto& [dependencyStage, mapping] : stepsInputs[stage - 1]) {
+        const auto& dependencyOutputs = slicesOutputs[index][dependencyStage];
+        for (const auto& [alias, inputName] : mapping) {
+            auto it = dependencyOutputs.find(alias);
+            if (it == dependencyOutputs.end()) {
+                SPDLOG_DEBUG("[Node: {}] Missing output: {} for demultiplexed step: {} of element: {}", getName(), alias, step.nodeName, index);
+                return StatusCode::INVALID_MISSING_INPUT;
+            }
+            node->setInput(inputName, it->second);
+        }
+    }
+    finishedStageNodes.push_back(std::move(slices[index]));
+    slices[index] = std::move(node);
+    startSlice(index);
+    return StatusCode::OK;
+}
+
+void DemultiplexerNode::startSlice(size_t index) {
+    auto status = slices[index]->execute(slicesQueue);
+    if (status == StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET) {
+        slicesStates[index] = SliceState::WAITING_FOR_STREAM;
+        return;
+    }
+    if (!status.ok()) {
+        // failed slice notifies the queue anyway
+        SPDLOG_DEBUG("[Node: {}] Demultiplexed element: {} failed with: {}", getName(), index, status.string());
+        if (slicesStatus.ok()) {
+            slicesStatus = status;
+        }
+        slicesStates[index] = SliceState::FAILED;
+        return;
+    }
+    slicesStates[index] = SliceState::IN_FLIGHT;
+}
+
+void DemultiplexerNode::processSliceMessage(size_t index) {
+    switch (slicesStates[index]) {
+    case SliceState::WAITING_FOR_STREAM:
+        startSlice(index);
+        return;
+    case SliceState::IN_FLIGHT: {
+        auto status = slices[index]->fetchResults(slicesOutputs[index][slicesStages[index]]);
+        if (status.ok() && slicesStages[index] < steps.size()) {
+            // failed elements do not start their following steps
+            status = slicesStatus.ok() ? startNextStage(index) : slicesStatus;
+            if (status.ok()) {
+                return;
+            }
+        }
+        if (!status.ok() && slicesStatus.ok()) {
+            slicesStatus = status;
+        }
+        break;
+    }
+    case SliceState::FAILED:
+        slices[index]->release();
+        break;
+    case SliceState::FINISHED:
+        return;
+    }
+    slicesStates[index] = SliceState::FINISHED;
+    finishedSlicesCount++;
+}
+
+Status DemultiplexerNode::fetchResults(BlobMap& outputs) {
+    if (!slicesStatus.ok()) {
+        return slicesStatus;
+    }
+    for (const auto& alias : requiredOutputNames) {
+        if (outputs.count(alias) == 1) {
+            continue;
+        }
+        size_t gatheredSize = 0;
+        std::vector<InferenceEngine::Blob::Ptr> parts;
+        parts.reserve(slicesOutputs.size());
+        for (auto& sliceStagesOutputs : slicesOutputs) {
+            const auto& sliceOutputs = sliceStagesOutputs.back();
+            auto it = sliceOutputs.find(alias);
+            if (it == sliceOutputs.end()) {
+                SPDLOG_WARN("[Node: {}] Cannot find output: {} of demultiplexed element", getName(), alias);
+                return StatusCode::INVALID_MISSING_OUTPUT;
+            }
+            const auto& dims = it->second->getTensorDesc().getDims();
+            if (dims.empty() || (parts.size() > 0 &&
+                                    !std::equal(dims.begin() + 1, dims.end(), parts[0]->getTensorDesc().getDims().begin() + 1, parts[0]->getTensorDesc().getDims().end()))) {
+                SPDLOG_DEBUG("[Node: {}] Output: {} of demultiplexed elements cannot be gathered, shape: {}", getName(), alias, TensorInfo::shapeToString(dims));
+                return StatusCode::INVALID_SHAPE;
+            }
+            gatheredSize += dims[0];
+            parts.push_back(it->second);
+        }
+        const auto& desc = parts[0]->getTensorDesc();
+        auto gatheredDims = desc.getDims();
+        gatheredDims[0] = gatheredSize;
+        // gathered output of the pipeline becomes response tensor_content without copying
+        auto gathered = allocateStringBlob({desc.getPrecision(), gatheredDims, desc.getLayout()});
+        if (!gathered) {
+            return StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION;
+        }
+        auto destination = gathered->buffer().as<char*>();
+        for (const auto& part : parts) {
+            std::memcpy(destination, part->cbuffer().as<const char*>(), part->byteSize());
+            destination += part->byteSize();
+        }
+        outputs.emplace(alias, std::move(gathered));
+        SPDLOG_DEBUG("[Node: {}]: Blob with name {} gathered from {} elements", getName(), alias, parts.size());
+    }
+    this->release();
+    return StatusCode::OK;
+}
+
+void DemultiplexerNode::release() {
+    {
+        std::unique_lock<std::mutex> lock(relayMtx);
+        this->notifyEndQueue = nullptr;
+    }
+    size_t awaitedMessagesCount = 0;
+    for (size_t i = 0; i < slices.size(); ++i) {
+        switch (slicesStates[i]) {
+        case SliceState::WAITING_FOR_STREAM:
+            // stream assigned after disarming is returned right away, slice is not started anymore
+            slices[i]->release();
+            slicesStates[i] = SliceState::FINISHED;
+            break;
+        case SliceState::IN_FLIGHT:
+        case SliceState::FAILED:
+            awaitedMessagesCount++;
+            break;
+        case SliceState::FINISHED:
+            break;
+        }
+    }
+    if (awaitedMessagesCount > 0) {
+        SPDLOG_DEBUG("[Node: {}] Waiting for {} demultiplexed elements in flight", getName(), awaitedMessagesCount);
+    }
+    while (awaitedMessagesCount > 0) {
+        auto& slice = slicesQueue.pull().get();
+        pulledSlicesMessagesCount++;
+        auto& state = slicesStates[slice.getId()];
+        if (state == SliceState::IN_FLIGHT || state == SliceState::FAILED) {
+            state = SliceState::FINISHED;
+            awaitedMessagesCount--;
+        }
+    }
+    // messages of slices which got stream before disarming are left
+    while (slicesQueue.tryPull(0)) {
+        pulledSlicesMessagesCount++;
+    }
+    // pushing threads may be still relaying messages which were pulled
+    std::unique_lock<std::mutex> lock(relayMtx);
+    relayedCondition.wait(lock, [this]() { return relayedSlicesMessagesCount >= pulledSlicesMessagesCount; });
+    lock.unlock();
+    for (auto& slice : slices) {
+        slice->release();
+    }
+    slicesOutputs.clear();
+}
+
+void DemultiplexerNode::reset() {
+    release();
+    slices.clear();
+    finishedStageNodes.clear();
+    slicesStates.clear();
+    slicesStages.clear();
+    finishedSlicesCount = 0;
+    slicesStatus = StatusCode::OK;
+    pulledSlicesMessagesCount = 0;
+    relayedSlicesMessagesCount = 0;
+    Node::reset();
+}
+
+}  // namespace ovms
@@ -0,0 +1,150 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dl_node.hpp"
+#include "model_version_policy.hpp"  // for model_version_t typename
+#include "node.hpp"
+
+namespace ovms {
+
+class ModelManager;
+
+/**
+ * @brief Model node inferring one element of demultiplexed inputs
+ */
+class DemultiplexedNode : public DLNode {
+    const std::vector<std::string>& requiredOutputNames;
+
+public:
+    DemultiplexedNode(const std::string& nodeName, const std::string& modelName, std::optional<model_version_t> modelVersion,
+        ModelManager& modelManager,
+        std::unordered_map<std::string, std::string> nodeOutputNameAlias,
+        const std::vector<std::string>& requiredOutputNames) :
+        DLNode(nodeName, modelName, modelVersion, modelManager, std::move(nodeOutputNameAlias)),
+        requiredOutputNames(requiredOutputNames) {}
+
+    void setInput(const std::string& name, InferenceEngine::Blob::Ptr blob) {
+        this->inputBlobs[name] = std::move(blob);
+    }
+
+protected:
+    std::vector<std::string> getRequiredOutputNames() const override {
+        return requiredOutputNames;
+    }
+};
+
+/**
+ * @brief Model inferred for each demultiplexed element after the model of demultiplexer node
+ */
+struct DemultiplexedStep {
+    std::string nodeName;
+    std::string modelName;
+    std::optional<model_version_t> modelVersion;
+    std::unordered_map<std::string, std::string> nodeOutputNameAlias;
+    // outputs of the demultiplexer node model or of preceding steps of the same element, by node name
+    std::vector<std::pair<std::string, InputPairs>> dependencies;
+};
+
+/**
+ * @brief Splits its inputs along 0th dimension and infers each element with a separate infer request in parallel,
+ * outputs of all elements are concatenated back along 0th dimension
+ *
+ * Used for per-object processing of detection results, e.g. N crops are classified with N inferences of a model
+ * with batch size 1. Each element can be processed further by a subgraph of steps, which are inferred in order
+ * once the inputs of the element they depend on are ready. Following nodes receive gathered outputs of the last step.
+ *
+ * Node is driven by the pipeline in the same way as a node waiting for inference stream. It returns
+ * PIPELINE_STREAM_ID_NOT_READY_YET until all elements are inferred and is notified with each element progress.
+ */
+class DemultiplexerNode : public Node {
+    enum class SliceState {
+        WAITING_FOR_STREAM,
+        IN_FLIGHT,
+        FAILED,
+        FINISHED
+    };
+
+    std::string modelName;
+    std::optional<model_version_t> modelVersion;
+    ModelManager& modelManager;
+    const std::unordered_map<std::string, std::string> nodeOutputNameAlias;
+    const std::vector<DemultiplexedStep> steps;
+    // stage 0 is the node model, stage i is steps[i - 1]; dependencies of steps as stage indexes
+    std::vector<std::vector<std::pair<size_t, InputPairs>>> stepsInputs;
+
+    std::vector<std::string> requiredOutputNames;
+    // outputs of each stage used by following stages, the last stage gives outputs required by following nodes
+    std::vector<std::vector<std::string>> stagesRequiredOutputNames;
+    std::vector<std::unique_ptr<DemultiplexedNode>> slices;
+    // nodes of finished stages, kept until reset as messages already pulled may still reference them
+    std::vector<std::unique_ptr<DemultiplexedNode>> finishedStageNodes;
+    std::vector<SliceState> slicesStates;
+    std::vector<size_t> slicesStages;
+    // outputs of every stage of every element
+    std::vector<std::vector<BlobMap>> slicesOutputs;
+    size_t finishedSlicesCount = 0;
+    Status slicesStatus;
+
+    // Slices notify this queue, each of their messages is relayed to the pipeline as a message of this node
+    MpscQueue<std::reference_wrapper<Node>> slicesQueue;
+    size_t pulledSlicesMessagesCount = 0;
+    std::mutex relayMtx;
+    std::condition_variable relayedCondition;
+    MpscQueue<std::reference_wrapper<Node>>* notifyEndQueue = nullptr;
+    size_t relayedSlicesMessagesCount = 0;
+
+public:
+    DemultiplexerNode(const std::string& nodeName, const std::string& modelName, std::optional<model_version_t> modelVersion,
+        ModelManager& modelManager,
+        std::unordered_map<std::string, std::string> nodeOutputNameAlias = {},
+        std::vector<DemultiplexedStep> steps = {});
+
+    ~DemultiplexerNode() override;
+
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override;
+
+    Status fetchResults(BlobMap& outputs) override;
+
+    /**
+     * @brief Stops starting elements and waits for inferences already in flight, so that none of them notifies the pipeline later
+     */
+    void release() override;
+
+    void reset() override;
+
+    size_t getSlicesCount() const {
+        return slices.size();
+    }
+
+private:
+    Status split();
+    void startSlice(size_t index);
+    Status startNextStage(size_t index);
+    void processSliceMessage(size_t index);
+    void relaySliceMessage();
+};
+
+}  // namespace ovms
@@ -15,6 +15,8 @@
 //*****************************************************************************
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -27,8 +29,15 @@
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #pragma GCC diagnostic pop
 
+#include "imagedecoder.hpp"
+#include "logging.hpp"
+#include "narrowing.hpp"
+#include "ovinferrequestsqueue.hpp"
+#include "sharedmemory.hpp"
 #include "status.hpp"
+#include "tensorarena.hpp"
 #include "tensorinfo.hpp"
+#include "transposition.hpp"
 
 namespace ovms {
 
@@ -40,53 +49,313 @@ InferenceEngine::Blob::Ptr makeBlob(const tensorflow::TensorProto& requestInput,
         const_cast<T*>(reinterpret_cast<const T*>(requestInput.tensor_content().data())));
 }
 
+/**
+ * @brief Wraps values of repeated field with the same memory layout as network input, used when tensor_content is empty
+ */
+template <typename T, typename V>
+InferenceEngine::Blob::Ptr makeBlob(const google::protobuf::RepeatedField<V>& values,
+    const std::shared_ptr<TensorInfo>& tensorInfo) {
+    static_assert(sizeof(T) == sizeof(V), "repeated field values have to match blob precision size");
+    return InferenceEngine::make_shared_blob<T>(
+        tensorInfo->getTensorDesc(),
+        const_cast<T*>(reinterpret_cast<const T*>(values.data())));
+}
+
+/**
+ * @brief Checks if values of given precision are converted from tensor proto instead of being used in place
+ */
+inline bool isConversionRequired(const InferenceEngine::Precision& precision) {
+    return precision == InferenceEngine::Precision::FP16 || precision == InferenceEngine::Precision::U16;
+}
+
+/**
+ * @brief Checks if values sent in int_val instead of tensor_content are narrowed to 8 or 16 bit network input
+ */
+inline bool isRepeatedFieldConversionRequired(const tensorflow::TensorProto& requestInput, const InferenceEngine::Precision& precision) {
+    return requestInput.tensor_content().empty() &&
+           (precision == InferenceEngine::Precision::I16 ||
+               precision == InferenceEngine::Precision::U8 ||
+               precision == InferenceEngine::Precision::I8);
+}
+
+/**
+ * @brief Gets number of values in repeated field used for request dtype when tensor_content is empty
+ *
+ * @return number of values, -1 if dtype has no supported repeated field
+ */
+inline int getRepeatedFieldValueCount(const tensorflow::TensorProto& requestInput) {
+    switch (requestInput.dtype()) {
+    case tensorflow::DataType::DT_FLOAT:
+        return requestInput.float_val_size();
+    case tensorflow::DataType::DT_HALF:
+        return requestInput.half_val_size();
+    case tensorflow::DataType::DT_INT32:
+    case tensorflow::DataType::DT_INT16:
+    case tensorflow::DataType::DT_UINT16:
+    case tensorflow::DataType::DT_INT8:
+    case tensorflow::DataType::DT_UINT8:
+        return requestInput.int_val_size();
+    case tensorflow::DataType::DT_INT64:
+        return requestInput.int64_val_size();
+    case tensorflow::DataType::DT_BOOL:
+        return requestInput.bool_val_size();
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Gets repeated field values which have the same memory layout as network input of request dtype
+ *
+ * @return pointer to values, nullptr if values of request dtype are padded in repeated field
+ */
+inline const void* getRepeatedFieldData(const tensorflow::TensorProto& requestInput) {
+    switch (requestInput.dtype()) {
+    case tensorflow::DataType::DT_FLOAT:
+        return requestInput.float_val().data();
+    case tensorflow::DataType::DT_INT32:
+        return requestInput.int_val().data();
+    case tensorflow::DataType::DT_INT64:
+        return requestInput.int64_val().data();
+    case tensorflow::DataType::DT_BOOL:
+        return requestInput.bool_val().data();
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Checks if network input of given precision can be filled with converted FP32 request data
+ */
+inline bool isConvertibleFromFp32(const InferenceEngine::Precision& precision) {
+    return precision == InferenceEngine::Precision::FP16 ||
+           precision == InferenceEngine::Precision::BF16 ||
+           precision == InferenceEngine::Precision::U8 ||
+           precision == InferenceEngine::Precision::I8;
+}
+
+/**
+ * @brief Checks if FP32 request input is converted to lower precision of network input.
+ * Validation allows such requests only for inputs with conversion enabled in model config.
+ */
+inline bool isFp32ConversionRequested(const tensorflow::TensorProto& requestInput, const InferenceEngine::Precision& precision) {
+    return requestInput.dtype() == tensorflow::DataType::DT_FLOAT && isConvertibleFromFp32(precision);
+}
+
+/**
+ * @brief Checks if I64 request input is narrowed to I32 network input
+ */
+inline bool isI64ConversionRequested(const tensorflow::TensorProto& requestInput, const InferenceEngine::Precision& precision) {
+    return requestInput.dtype() == tensorflow::DataType::DT_INT64 && precision == InferenceEngine::Precision::I32;
+}
+
+/**
+ * @brief Checks if request input of other precision than network input is converted during deserialization
+ */
+inline bool isPrecisionConversionRequested(const tensorflow::TensorProto& requestInput, const InferenceEngine::Precision& precision) {
+    return isFp32ConversionRequested(requestInput, precision) || isI64ConversionRequested(requestInput, precision);
+}
+
+/**
+ * @brief Checks if conversion from request precision configured in model config is supported for network input
+ *
+ * @param requestPrecision precision as string, e.g. FP32
+ * @param precision network input precision
+ */
+inline bool isPrecisionConversionSupported(const std::string& requestPrecision, const InferenceEngine::Precision& precision) {
+    return (requestPrecision == "FP32" && isConvertibleFromFp32(precision)) ||
+           (requestPrecision == "I64" && precision == InferenceEngine::Precision::I32);
+}
+
+/**
+ * @brief Converts FP32 values into memory of network input precision
+ */
+inline void convertFromFp32(const float* source, const InferenceEngine::Precision& precision, void* destination, size_t count) {
+    switch (precision) {
+    case InferenceEngine::Precision::FP16:
+        narrowFp32ToFp16(source, static_cast<uint16_t*>(destination), count);
+        break;
+    case InferenceEngine::Precision::BF16:
+        narrowFp32ToBf16(source, static_cast<uint16_t*>(destination), count);
+        break;
+    case InferenceEngine::Precision::U8:
+        narrowFp32ToU8(source, static_cast<uint8_t*>(destination), count);
+        break;
+    case InferenceEngine::Precision::I8:
+        narrowFp32ToI8(source, static_cast<int8_t*>(destination), count);
+        break;
+    default:
+        break;
+    }
+}
+
+template <typename T>
+InferenceEngine::Blob::Ptr makeConvertedBlob(const InferenceEngine::TensorDesc& tensorDesc) {
+    auto& arena = TensorArena::instance();
+    if (arena.isEnabled()) {
+        return InferenceEngine::make_shared_blob<T>(tensorDesc, arena.getBlobAllocator());
+    }
+    return InferenceEngine::make_shared_blob<T>(tensorDesc);
+}
+
+/**
+ * @brief Allocates blob for inputs filled by conversion or layout transposition instead of being used in place.
+ * Memory comes from the tensor arena when it is enabled.
+ */
+inline InferenceEngine::Blob::Ptr allocateConvertedBlob(const InferenceEngine::TensorDesc& tensorDesc) {
+    InferenceEngine::Blob::Ptr blob;
+    switch (tensorDesc.getPrecision()) {
+    case InferenceEngine::Precision::FP32:
+        blob = makeConvertedBlob<float>(tensorDesc);
+        break;
+    case InferenceEngine::Precision::FP16:
+    case InferenceEngine::Precision::BF16:
+    case InferenceEngine::Precision::U16:
+        blob = makeConvertedBlob<uint16_t>(tensorDesc);
+        break;
+    case InferenceEngine::Precision::U8:
+        blob = makeConvertedBlob<uint8_t>(tensorDesc);
+        break;
+    case InferenceEngine::Precision::I8:
+        blob = makeConvertedBlob<int8_t>(tensorDesc);
+        break;
+    case InferenceEngine::Precision::I16:
+        blob = makeConvertedBlob<int16_t>(tensorDesc);
+        break;
+    case InferenceEngine::Precision::I32:
+        blob = makeConvertedBlob<int32_t>(tensorDesc);
+        break;
+    case InferenceEngine::Precision::I64:
+        blob = makeConvertedBlob<int64_t>(tensorDesc);
+        break;
+    case InferenceEngine::Precision::BOOL:
+        blob = makeConvertedBlob<uint8_t>(tensorDesc);
+        break;
+    default:
+        return nullptr;
+    }
+    blob->allocate();
+    return blob;
+}
+
+/**
+ * @brief Converts zero padded 8 and 16 bit values, FP32 or I64 values of tensor proto into blob memory.
+ * 16 bit values packed in tensor_content are copied as they are.
+ */
+inline void convertTensorProto(const tensorflow::TensorProto& requestInput,
+    const InferenceEngine::Precision& precision,
+    const InferenceEngine::Blob::Ptr& blob) {
+    if (isFp32ConversionRequested(requestInput, precision)) {
+        const bool isPacked = !requestInput.tensor_content().empty();
+        const float* values = isPacked ? reinterpret_cast<const float*>(requestInput.tensor_content().data()) : requestInput.float_val().data();
+        const size_t valuesCount = isPacked ? requestInput.tensor_content().size() / sizeof(float) : static_cast<size_t>(requestInput.float_val_size());
+        convertFromFp32(values, precision, blob->buffer().as<void*>(), std::min(valuesCount, blob->size()));
+        return;
+    }
+    if (isI64ConversionRequested(requestInput, precision)) {
+        const bool isPacked = !requestInput.tensor_content().empty();
+        const int64_t* values = isPacked ? reinterpret_cast<const int64_t*>(requestInput.tensor_content().data()) : requestInput.int64_val().data();
+        const size_t valuesCount = isPacked ? requestInput.tensor_content().size() / sizeof(int64_t) : static_cast<size_t>(requestInput.int64_val_size());
+        narrowI64ToI32(values, blob->buffer().as<int32_t*>(), std::min(valuesCount, blob->size()));
+        return;
+    }
+    if (isRepeatedFieldConversionRequired(requestInput, precision) && precision != InferenceEngine::Precision::I16) {
+        // 8 bit values are padded in int_val as well
+        narrowToUint8(requestInput.int_val().data(), blob->buffer().as<uint8_t*>(),
+            std::min(static_cast<size_t>(requestInput.int_val_size()), blob->size()));
+        return;
+    }
+    uint16_t* ptr = blob->buffer().as<uint16_t*>();
+    if (!requestInput.tensor_content().empty()) {
+        std::memcpy(ptr, requestInput.tensor_content().data(), std::min(requestInput.tensor_content().size(), blob->byteSize()));
+    } else if (precision == InferenceEngine::Precision::FP16) {
+        // Needs conversion due to zero padding for each value:
+        // https://github.com/tensorflow/tensorflow/blob/v2.2.0/tensorflow/core/framework/tensor.proto#L45
+        narrowToUint16(requestInput.half_val().data(), ptr, static_cast<size_t>(requestInput.half_val_size()));
+    } else {
+        // Needs conversion due to zero padding for each value:
+        // https://github.com/tensorflow/tensorflow/blob/v2.2.0/tensorflow/core/framework/tensor.proto#L55
+        narrowToUint16(requestInput.int_val().data(), ptr, static_cast<size_t>(requestInput.int_val_size()));
+    }
+}
+
+/**
+ * @brief Transposes NHWC request data into NCHW blob. Data requiring conversion is converted
+ * into temporary blob first.
+ */
+inline void transposeTensorProto(const tensorflow::TensorProto& requestInput,
+    const std::shared_ptr<TensorInfo>& tensorInfo,
+    const InferenceEngine::Blob::Ptr& blob) {
+    const auto& precision = tensorInfo->getPrecision();
+    const void* source = requestInput.tensor_content().data();
+    InferenceEngine::Blob::Ptr converted;
+    if (isPrecisionConversionRequested(requestInput, precision) ||
+        isRepeatedFieldConversionRequired(requestInput, precision) ||
+        (isConversionRequired(precision) && requestInput.tensor_content().empty())) {
+        converted = allocateConvertedBlob(tensorInfo->getTensorDesc());
+        convertTensorProto(requestInput, precision, converted);
+        source = converted->buffer().as<const void*>();
+    } else if (requestInput.tensor_content().empty()) {
+        source = getRepeatedFieldData(requestInput);
+    }
+    transposeNhwcToNchw(source, blob->buffer().as<void*>(), tensorInfo->getShape(), precision.size());
+}
+
 class ConcreteTensorProtoDeserializator {
 public:
     static InferenceEngine::Blob::Ptr deserializeTensorProto(
         const tensorflow::TensorProto& requestInput,
         const std::shared_ptr<TensorInfo>& tensorInfo) {
-        switch (tensorInfo->getPrecision()) {
-        case InferenceEngine::Precision::FP32:
-            return makeBlob<float>(requestInput, tensorInfo);
-        case InferenceEngine::Precision::FP16: {
-            // Needs conversion due to zero padding for each value:
-            // https://github.com/tensorflow/tensorflow/blob/v2.2.0/tensorflow/core/framework/tensor.proto#L45
-            auto blob = InferenceEngine::make_shared_blob<uint16_t>(tensorInfo->getTensorDesc());
-            blob->allocate();
-            uint16_t* ptr = blob->buffer().as<uint16_t*>();
-            auto size = static_cast<size_t>(requestInput.half_val_size());
-            for (size_t i = 0; i < size; i++) {
-                ptr[i] = requestInput.half_val(i);
+        if (tensorInfo->isLayoutTransposed()) {
+            auto blob = allocateConvertedBlob(tensorInfo->getTensorDesc());
+            if (blob) {
+                transposeTensorProto(requestInput, tensorInfo, blob);
             }
             return blob;
         }
+        if (isPrecisionConversionRequested(requestInput, tensorInfo->getPrecision()) ||
+            isRepeatedFieldConversionRequired(requestInput, tensorInfo->getPrecision())) {
+            auto blob = allocateConvertedBlob(tensorInfo->getTensorDesc());
+            convertTensorProto(requestInput, tensorInfo->getPrecision(), blob);
+            return blob;
+        }
+        switch (tensorInfo->getPrecision()) {
+        case InferenceEngine::Precision::FP32:
+            if (requestInput.tensor_content().empty()) {
+                return makeBlob<float>(requestInput.float_val(), tensorInfo);
+            }
+            return makeBlob<float>(requestInput, tensorInfo);
         case InferenceEngine::Precision::U8:
             return makeBlob<uint8_t>(requestInput, tensorInfo);
         case InferenceEngine::Precision::I8:
             return makeBlob<int8_t>(requestInput, tensorInfo);
+        case InferenceEngine::Precision::FP16:
         case InferenceEngine::Precision::U16: {
-            // Needs conversion due to zero padding for each value:
-            // https://github.com/tensorflow/tensorflow/blob/v2.2.0/tensorflow/core/framework/tensor.proto#L55
-            auto blob = InferenceEngine::make_shared_blob<uint16_t>(tensorInfo->getTensorDesc());
-            blob->allocate();
-            uint16_t* ptr = blob->buffer().as<uint16_t*>();
-            auto size = static_cast<size_t>(requestInput.int_val_size());
-            for (size_t i = 0; i < size; i++) {
-                ptr[i] = requestInput.int_val(i);
-            }
+            auto blob = allocateConvertedBlob(tensorInfo->getTensorDesc());
+            convertTensorProto(requestInput, tensorInfo->getPrecision(), blob);
             return blob;
         }
         case InferenceEngine::Precision::I16:
             return makeBlob<int16_t>(requestInput, tensorInfo);
         case InferenceEngine::Precision::I32:
+            if (requestInput.tensor_content().empty()) {
+                return makeBlob<int32_t>(requestInput.int_val(), tensorInfo);
+            }
             return makeBlob<int32_t>(requestInput, tensorInfo);
-
         case InferenceEngine::Precision::I64:
-
+            if (requestInput.tensor_content().empty()) {
+                return makeBlob<int64_t>(requestInput.int64_val(), tensorInfo);
+            }
+            return makeBlob<int64_t>(requestInput, tensorInfo);
+        case InferenceEngine::Precision::BOOL:
+            // bool values take single byte both in tensor_content and bool_val
+            if (requestInput.tensor_content().empty()) {
+                return makeBlob<uint8_t>(requestInput.bool_val(), tensorInfo);
+            }
+            return makeBlob<uint8_t>(requestInput, tensorInfo);
         case InferenceEngine::Precision::MIXED:
         case InferenceEngine::Precision::Q78:
         case InferenceEngine::Precision::BIN:
-        case InferenceEngine::Precision::BOOL:
         case InferenceEngine::Precision::CUSTOM:
         default:
             return nullptr;
@@ -101,29 +370,169 @@ InferenceEngine::Blob::Ptr deserializeTensorProto(
     return TensorProtoDeserializator::deserializeTensorProto(requestInput, tensorInfo);
 }
 
+/**
+ * @brief Sets input referencing shared memory region on infer request. Region memory is used in place,
+ * unless the input has preallocated blob which stays set on infer request, then the memory is copied into it.
+ */
+inline Status deserializeSharedMemoryInput(const tensorflow::TensorProto& requestInput,
+    const std::shared_ptr<TensorInfo>& tensorInfo,
+    InferenceEngine::InferRequest& inferRequest,
+    const blob_map_t* preallocatedBlobs) {
+    if (preallocatedBlobs && isConversionRequired(tensorInfo->getPrecision())) {
+        auto preallocatedBlobItr = preallocatedBlobs->find(tensorInfo->getName());
+        if (preallocatedBlobItr != preallocatedBlobs->end()) {
+            const auto& blob = preallocatedBlobItr->second;
+            return copySharedMemoryReference(requestInput, blob->buffer().as<char*>(), blob->byteSize());
+        }
+    }
+    InferenceEngine::Blob::Ptr blob;
+    auto status = deserializeSharedMemoryReference(requestInput, tensorInfo->getTensorDesc(), blob);
+    if (!status.ok()) {
+        return status;
+    }
+    inferRequest.SetBlob(tensorInfo->getName(), blob);
+    return StatusCode::OK;
+}
+
+/**
+ * @brief Decodes encoded images of request input into preallocated blob of image input, or a newly allocated one
+ * if there is none. Blob is set on infer request since other requests may have replaced it with one pointing to their data.
+ */
+inline Status deserializeImageInput(const tensorflow::TensorProto& requestInput,
+    const std::shared_ptr<TensorInfo>& tensorInfo,
+    InferenceEngine::InferRequest& inferRequest,
+    const blob_map_t* preallocatedBlobs) {
+    InferenceEngine::Blob::Ptr blob;
+    if (preallocatedBlobs) {
+        auto preallocatedBlobItr = preallocatedBlobs->find(tensorInfo->getName());
+        if (preallocatedBlobItr != preallocatedBlobs->end()) {
+            blob = preallocatedBlobItr->second;
+        }
+    }
+    if (!blob) {
+        blob = allocateConvertedBlob(tensorInfo->getTensorDesc());
+        if (!blob) {
+            return StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
+        }
+    }
+    auto status = decodeImages(requestInput, *tensorInfo, blob->buffer().as<void*>(), tensorInfo->getShape()[0]);
+    if (!status.ok()) {
+        return status;
+    }
+    inferRequest.SetBlob(tensorInfo->getName(), blob);
+    return StatusCode::OK;
+}
+
+/**
+ * @brief Wraps request data of input resized by the plugin into blob with request shape instead of network shape.
+ * Plugin resizes it to network shape as part of the inference.
+ */
+inline Status deserializeResizedInput(const tensorflow::TensorProto& requestInput,
+    const std::shared_ptr<TensorInfo>& tensorInfo,
+    InferenceEngine::InferRequest& inferRequest) {
+    InferenceEngine::SizeVector dims;
+    for (const auto& dim : requestInput.tensor_shape().dim()) {
+        dims.push_back(dim.size());
+    }
+    const InferenceEngine::TensorDesc tensorDesc(tensorInfo->getPrecision(), dims, tensorInfo->getLayout());
+    InferenceEngine::Blob::Ptr blob;
+    const bool inPlace = !isSharedMemoryReference(requestInput) && !isPrecisionConversionRequested(requestInput, tensorInfo->getPrecision());
+    if (inPlace && tensorInfo->getPrecision() == InferenceEngine::Precision::U8 && requestInput.tensor_content().size()) {
+        blob = InferenceEngine::make_shared_blob<uint8_t>(tensorDesc,
+            const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(requestInput.tensor_content().data())));
+    } else if (inPlace && tensorInfo->getPrecision() == InferenceEngine::Precision::FP32 && requestInput.tensor_content().size()) {
+        blob = InferenceEngine::make_shared_blob<float>(tensorDesc,
+            const_cast<float*>(reinterpret_cast<const float*>(requestInput.tensor_content().data())));
+    } else if (inPlace && tensorInfo->getPrecision() == InferenceEngine::Precision::FP32 && requestInput.float_val_size()) {
+        blob = InferenceEngine::make_shared_blob<float>(tensorDesc, const_cast<float*>(requestInput.float_val().data()));
+    } else {
+        // resize is applied to U8 and FP32 data in request memory, it is not combined with conversions nor shared memory
+        Status status = StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
+        OVMS_HOT_PATH_DEBUG("Input: {} resized by plugin requires U8 or FP32 data sent in request; {}", tensorInfo->getMappedName(), status.string());
+        return status;
+    }
+    inferRequest.SetBlob(tensorInfo->getName(), blob);
+    return StatusCode::OK;
+}
+
+/**
+ * @brief Sets request inputs on infer request. Inputs requiring conversion are written into preallocated blobs
+ * if there are any, the rest is wrapped into blobs pointing to request or shared memory region.
+ *
+ * @param request
+ * @param inputMap
+ * @param inferRequest
+ * @param preallocatedBlobs blobs already set on infer request, keyed by network input name
+ *
+ * @return Status
+ */
 template <class TensorProtoDeserializator>
 Status deserializePredictRequest(
     const tensorflow::serving::PredictRequest& request,
     const tensor_map_t& inputMap,
-    InferenceEngine::InferRequest& inferRequest) {
+    InferenceEngine::InferRequest& inferRequest,
+    const blob_map_t* preallocatedBlobs = nullptr) {
     try {
         for (const auto& pair : inputMap) {
             const auto& name = pair.first;
             auto tensorInfo = pair.second;
             auto requestInputItr = request.inputs().find(name);
             if (requestInputItr == request.inputs().end()) {
-                SPDLOG_DEBUG("Failed to deserialize request. Validation of request failed");
+                OVMS_HOT_PATH_DEBUG("Failed to deserialize request. Validation of request failed");
                 return Status(StatusCode::INTERNAL_ERROR, "Failed to deserialize request");
             }
             auto& requestInput = requestInputItr->second;
 
+            if (isImageInputRequested(requestInput, *tensorInfo)) {
+                auto status = deserializeImageInput(requestInput, tensorInfo, inferRequest, preallocatedBlobs);
+                if (!status.ok()) {
+                    return status;
+                }
+                continue;
+            }
+
+            if (tensorInfo->isResized()) {
+                auto status = deserializeResizedInput(requestInput, tensorInfo, inferRequest);
+                if (!status.ok()) {
+                    return status;
+                }
+                continue;
+            }
+
+            if (isSharedMemoryReference(requestInput)) {
+                auto status = deserializeSharedMemoryInput(requestInput, tensorInfo, inferRequest, preallocatedBlobs);
+                if (!status.ok()) {
+                    return status;
+                }
+                continue;
+            }
+
+            const bool isPrecisionConversion = isPrecisionConversionRequested(requestInput, tensorInfo->getPrecision());
+            if (preallocatedBlobs && (isConversionRequired(tensorInfo->getPrecision()) || isPrecisionConversion ||
+                                         isRepeatedFieldConversionRequired(requestInput, tensorInfo->getPrecision()) || tensorInfo->isLayoutTransposed())) {
+                auto preallocatedBlobItr = preallocatedBlobs->find(tensorInfo->getName());
+                if (preallocatedBlobItr != preallocatedBlobs->end()) {
+                    if (tensorInfo->isLayoutTransposed()) {
+                        // transposed inputs are never used in place, preallocated blob stays set
+                        transposeTensorProto(requestInput, tensorInfo, preallocatedBlobItr->second);
+                        continue;
+                    }
+                    convertTensorProto(requestInput, tensorInfo->getPrecision(), preallocatedBlobItr->second);
+                    if (!isConversionRequired(tensorInfo->getPrecision())) {
+                        // 8 and 32 bit requests without conversion replace the blob with one pointing to request memory
+                        inferRequest.SetBlob(tensorInfo->getName(), preallocatedBlobItr->second);
+                    }
+                    continue;
+                }
+            }
+
             InferenceEngine::Blob::Ptr blob =
                 deserializeTensorProto<TensorProtoDeserializator>(
                     requestInput, tensorInfo);
 
             if (blob == nullptr) {
                 Status status = StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
-                SPDLOG_DEBUG(status.string());
+                OVMS_HOT_PATH_DEBUG(status.string());
                 return status;
             }
             inferRequest.SetBlob(tensorInfo->getName(), blob);
@@ -133,11 +542,11 @@ Status deserializePredictRequest(
         // OV can throw exceptions derived from std::logic_error.
     } catch (const InferenceEngine::details::InferenceEngineException& e) {
         Status status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
-        SPDLOG_DEBUG("{}: {}", status.string(), e.what());
+        OVMS_HOT_PATH_DEBUG("{}: {}", status.string(), e.what());
         return status;
     } catch (std::logic_error& e) {
         Status status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
-        SPDLOG_DEBUG("{}: {}", status.string(), e.what());
+        OVMS_HOT_PATH_DEBUG("{}: {}", status.string(), e.what());
         return status;
     }
 
@@ -15,42 +15,78 @@
 //*****************************************************************************
 #include "dl_node.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <inference_engine.hpp>
 #include <spdlog/spdlog.h>
 
+#include "deserialization.hpp"
+#include "logging.hpp"
 #include "modelmanager.hpp"
+#include "narrowing.hpp"
 #include "ov_utils.hpp"
 #include "ovinferrequestsqueue.hpp"
 #include "prediction_service_utils.hpp"
+#include "transposition.hpp"
 
 namespace ovms {
 
-const uint WAIT_FOR_STREAM_ID_TIMEOUT_MICROSECONDS = 1;
-
-Status DLNode::execute(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
+Status DLNode::execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
     Status status;
     if (this->nodeStreamIdGuard == nullptr) {
-        status = requestExecuteRequiredResources();
+        status = requestExecuteRequiredResources(notifyEndQueue);
         if (!status.ok()) {
             notifyEndQueue.push(*this);
             return status;
         }
+        if (this->cachedOutputBlobs != nullptr) {
+            notifyEndQueue.push(*this);
+            return StatusCode::OK;
+        }
+        if (this->dynamicBatcher != nullptr) {
+            executeInBatch(notifyEndQueue);
+            return StatusCode::OK;
+        }
+        // Deferred node is pushed to notifyEndQueue once stream id is assigned, execution is continued then.
+        // Stream id may be already there, but continuing now would leave the notification for a node in flight.
+        if (this->nodeStreamIdGuard->isDeferred()) {
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Could not acquire stream Id right away", getName());
+            return StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET;
+        }
     }
-    auto streamId = this->nodeStreamIdGuard->tryGetId(WAIT_FOR_STREAM_ID_TIMEOUT_MICROSECONDS);
+    auto streamId = this->nodeStreamIdGuard->tryGetId();
     if (!streamId) {
-        SPDLOG_DEBUG("[Node: {}] Could not acquire stream Id right away", getName());
+        if (this->nodeStreamIdGuard->isExpired()) {
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Deadline passed while waiting for stream Id", getName());
+            notifyEndQueue.push(*this);
+            return StatusCode::DEADLINE_EXCEEDED;
+        }
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Stream Id is not assigned yet", getName());
         return StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET;
     }
-    auto& inferRequestsQueue = this->model->getInferRequestsQueue();
+    if (this->metrics != nullptr) {
+        this->metrics->recordSince(NodeStage::STREAM_WAIT, this->streamWaitStart);
+    }
+    auto& inferRequestsQueue = this->nodeStreamIdGuard->getInferRequestsQueue();
     auto& inferRequest = inferRequestsQueue.getInferRequest(streamId.value());
-    status = setInputsForInference(inferRequest);
+    {
+        StageTimer timer(this->metrics, NodeStage::INPUT_SETUP);
+        status = setInputsForInference(inferRequest, inferRequestsQueue.getPreallocatedInputBlobs(streamId.value()));
+    }
     if (!status.ok()) {
         notifyEndQueue.push(*this);
         return status;
     }
+    if (!this->deviceResidentOutputs.empty()) {
+        setDeviceOutputsForInference(inferRequest, inferRequestsQueue);
+    }
     status = executeInference(notifyEndQueue, inferRequest);
     if (!status.ok()) {
         notifyEndQueue.push(*this);
@@ -59,7 +95,7 @@ Status DLNode::execute(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQ
     return status;
 }
 
-Status DLNode::requestExecuteRequiredResources() {
+Status DLNode::requestExecuteRequiredResources(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
     Status status = StatusCode::OK;
     status = getModelInstance(
         this->modelManager,
@@ -69,7 +105,19 @@ Status DLNode::requestExecuteRequiredResources() {
         this->modelUnloadGuard);
 
     if (!status.ok()) {
-        SPDLOG_DEBUG("Getting modelInstance failed for node: {} with: {}", getName(), status.string());
+        OVMS_HOT_PATH_DEBUG("Getting modelInstance failed for node: {} with: {}", getName(), status.string());
+        return status;
+    }
+    // inputs of cached or batched inferences are read on the host
+    if (this->resultCache != nullptr || this->model->getDynamicBatcher() != nullptr) {
+        status = downloadDeviceInputs(nullptr);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+
+    // Key is created from inputs as received, before any conversion or model reshape
+    if (this->resultCache != nullptr && tryGetCachedResults()) {
         return status;
     }
 
@@ -77,12 +125,29 @@ Status DLNode::requestExecuteRequiredResources() {
     if (!status.ok()) {
         return status;
     }
-    auto& inferRequestsQueue = this->model->getInferRequestsQueue();
-    this->nodeStreamIdGuard = std::make_unique<NodeStreamIdGuard>(inferRequestsQueue);
+    this->dynamicBatcher = this->model->getDynamicBatcher();
+    if (this->dynamicBatcher != nullptr) {
+        // stream is taken by dynamic batcher for the whole batch
+        return status;
+    }
+    // replica is selected once, inputs have to be in memory of its device or on the host
+    auto& inferRequestsQueue = this->model->getInferRequestsQueue(this->inferRequestsPool);
+    status = downloadDeviceInputs(inferRequestsQueue.getRemoteContext());
+    if (!status.ok()) {
+        return status;
+    }
+    if (this->metrics != nullptr) {
+        this->streamWaitStart = std::chrono::steady_clock::now();
+    }
+    auto onStreamIdReady = [this, &notifyEndQueue]() {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Stream Id assigned to deferred node", getName());
+        notifyEndQueue.push(*this);
+    };
+    this->nodeStreamIdGuard = std::make_unique<NodeStreamIdGuard>(inferRequestsQueue, std::move(onStreamIdReady), getPriority(), getDeadline());
     return status;
 }
 
-Status DLNode::setInputsForInference(InferenceEngine::InferRequest& infer_request) {
+Status DLNode::setInputsForInference(InferenceEngine::InferRequest& infer_request, const blob_map_t& preallocatedBlobs) {
     Status status = StatusCode::OK;
     try {
         // Prepare inference request, fill with input blobs
@@ -92,6 +157,18 @@ Status DLNode::setInputsForInference(InferenceEngine::InferRequest& infer_reques
                 SPDLOG_WARN("DLNode::{} [Node name: {}]; cannot find real model input name for alias: {}", __FUNCTION__, getName(), kv.first);
                 return StatusCode::INTERNAL_ERROR;
             }
+            // Preallocated blobs have to stay set on infer request, predict requests write into them
+            auto preallocatedBlobItr = preallocatedBlobs.find(realModelInputName);
+            if (preallocatedBlobItr != preallocatedBlobs.end()) {
+                const auto& preallocatedBlob = preallocatedBlobItr->second;
+                if (preallocatedBlob->byteSize() != kv.second->byteSize()) {
+                    OVMS_HOT_PATH_DEBUG("[Node: {}] Input: {} size: {} does not match model input size: {}",
+                        getName(), realModelInputName, kv.second->byteSize(), preallocatedBlob->byteSize());
+                    return StatusCode::INVALID_CONTENT_SIZE;
+                }
+                std::memcpy((void*)preallocatedBlob->buffer(), (void*)kv.second->buffer(), preallocatedBlob->byteSize());
+                continue;
+            }
             infer_request.SetBlob(realModelInputName, kv.second);
         }
         // OV implementation the InferenceEngineException is not
@@ -99,171 +176,443 @@ Status DLNode::setInputsForInference(InferenceEngine::InferRequest& infer_reques
         // OV can throw exceptions derived from std::logic_error.
     } catch (const InferenceEngine::details::InferenceEngineException& e) {
         status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
-        SPDLOG_DEBUG("[Node: {}] {}; exception message: {}", getName(), status.string(), e.what());
+        OVMS_HOT_PATH_DEBUG("[Node: {}] {}; exception message: {}", getName(), status.string(), e.what());
     } catch (std::logic_error& e) {
         status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
-        SPDLOG_DEBUG("[Node: {}] {}; exception message: {}", getName(), status.string(), e.what());
+        OVMS_HOT_PATH_DEBUG("[Node: {}] {}; exception message: {}", getName(), status.string(), e.what());
     } catch (...) {
         status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
-        SPDLOG_DEBUG("[Node: {}] {}; with unknown exception", getName(), status.string());
+        OVMS_HOT_PATH_DEBUG("[Node: {}] {}; with unknown exception", getName(), status.string());
     }
     return status;
 }
 
-Status DLNode::executeInference(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQueue, InferenceEngine::InferRequest& infer_request) {
+void DLNode::setDeviceOutputsForInference(InferenceEngine::InferRequest& infer_request, OVInferRequestsQueue& inferRequestsQueue) {
+    this->hostOutputBlobs.clear();
+    auto* deviceBlobPool = inferRequestsQueue.getDeviceOutputBlobPool();
+    if (deviceBlobPool == nullptr) {
+        return;
+    }
+    const auto& outputsInfo = this->model->getOutputsInfo();
+    for (const auto& modelOutputName : this->deviceResidentOutputs) {
+        auto it = outputsInfo.find(modelOutputName);
+        if (it == outputsInfo.end()) {
+            continue;
+        }
+        const auto& realModelOutputName = it->second->getName();
+        try {
+            auto hostBlob = infer_request.GetBlob(realModelOutputName);
+            auto deviceBlob = deviceBlobPool->acquire(realModelOutputName, hostBlob->getTensorDesc());
+            if (!deviceBlob) {
+                continue;
+            }
+            infer_request.SetBlob(realModelOutputName, deviceBlob);
+            this->hostOutputBlobs.emplace(realModelOutputName, std::move(hostBlob));
+        } catch (const std::exception& e) {
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Cannot keep output: {} in device memory, it will be downloaded to the host; exception message: {}",
+                getName(), realModelOutputName, e.what());
+        }
+    }
+}
+
+void DLNode::restoreHostOutputBlobs() {
+    if (this->hostOutputBlobs.empty()) {
+        return;
+    }
+    auto streamId = this->nodeStreamIdGuard != nullptr ? this->nodeStreamIdGuard->tryGetId() : std::nullopt;
+    if (streamId) {
+        auto& infer_request = this->nodeStreamIdGuard->getInferRequestsQueue().getInferRequest(streamId.value());
+        for (const auto& [realModelOutputName, hostBlob] : this->hostOutputBlobs) {
+            try {
+                infer_request.SetBlob(realModelOutputName, hostBlob);
+            } catch (const std::exception& e) {
+                OVMS_HOT_PATH_DEBUG("[Node: {}] Cannot restore host output blob: {}; exception message: {}", getName(), realModelOutputName, e.what());
+            }
+        }
+    }
+    this->hostOutputBlobs.clear();
+}
+
+Status DLNode::downloadDeviceInputs(const InferenceEngine::RemoteContext::Ptr& targetContext) {
+    for (auto& [name, blob] : this->inputBlobs) {
+        auto* remoteBlob = blob->as<InferenceEngine::RemoteBlob>();
+        if (remoteBlob == nullptr || (targetContext != nullptr && remoteBlob->getContext() == targetContext)) {
+            continue;
+        }
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Downloading input: {} from device memory", getName(), name);
+        InferenceEngine::Blob::Ptr hostBlob;
+        auto status = blobClone(hostBlob, blob);
+        if (!status.ok()) {
+            return status;
+        }
+        blob = std::move(hostBlob);
+    }
+    return StatusCode::OK;
+}
+
+Status DLNode::executeInference(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue, InferenceEngine::InferRequest& infer_request) {
     try {
-        SPDLOG_DEBUG("Setting completion callback for node name: {}", this->getName());
+        OVMS_HOT_PATH_DEBUG("Setting completion callback for node name: {}", this->getName());
         infer_request.SetCompletionCallback([this, &notifyEndQueue, &infer_request]() {
-            SPDLOG_DEBUG("Completion callback received for node name: {}", this->getName());
+            OVMS_HOT_PATH_DEBUG("Completion callback received for node name: {}", this->getName());
+            if (this->metrics != nullptr) {
+                this->metrics->recordSince(NodeStage::INFERENCE, this->inferenceStart);
+            }
             // After inference is completed, input blobs are not needed anymore
             this->inputBlobs.clear();
             notifyEndQueue.push(*this);
             infer_request.SetCompletionCallback([]() {});  // reset callback on infer request
         });
-        SPDLOG_DEBUG("Starting infer async for node name: {}", getName());
+        OVMS_HOT_PATH_DEBUG("Starting infer async for node name: {}", getName());
+        if (this->metrics != nullptr) {
+            this->inferenceStart = std::chrono::steady_clock::now();
+        }
         infer_request.StartAsync();
     } catch (const InferenceEngine::details::InferenceEngineException& e) {
-        SPDLOG_DEBUG("[Node: {}] Exception occured when starting async inference or setting completion callback on model: {}, error: {}",
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Exception occured when starting async inference or setting completion callback on model: {}, error: {}",
             getName(), modelName, e.what());
         return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
     } catch (const std::exception& e) {
-        SPDLOG_DEBUG("[Node: {}] Exception occured when starting async inference or setting completion callback on  model: {}, error: {}",
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Exception occured when starting async inference or setting completion callback on  model: {}, error: {}",
             getName(), modelName, e.what());
         return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
     } catch (...) {
-        SPDLOG_DEBUG("[Node: {}] Unknown exception occured when starting async inference or setting completion callback on model: {}",
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Unknown exception occured when starting async inference or setting completion callback on model: {}",
             getName(), modelName);
         return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
     }
     return StatusCode::OK;
 }
 
+void DLNode::executeInBatch(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
+    // only outputs required in following nodes are split out of the batch
+    std::set<std::string> outputNames;
+    for (const auto& alias : getRequiredOutputNames()) {
+        outputNames.insert(nodeOutputNameAlias.count(alias) == 1 ? nodeOutputNameAlias.at(alias) : alias);
+    }
+    OVMS_HOT_PATH_DEBUG("[Node: {}] Enqueuing inputs in dynamic batcher of model: {}", getName(), modelName);
+    if (this->metrics != nullptr) {
+        // includes time spent gathering the batch
+        this->inferenceStart = std::chrono::steady_clock::now();
+    }
+    this->dynamicBatcher->inferAsync(&this->inputBlobs, &this->batchedOutputBlobs, std::move(outputNames), [this, &notifyEndQueue](Status status) {
+        OVMS_HOT_PATH_DEBUG("Batched inference finished for node name: {}", this->getName());
+        if (this->metrics != nullptr) {
+            this->metrics->recordSince(NodeStage::INFERENCE, this->inferenceStart);
+        }
+        this->batchedInferenceStatus = status;
+        // After inference is completed, input blobs are not needed anymore
+        this->inputBlobs.clear();
+        notifyEndQueue.push(*this);
+    },
+        getDeadline());
+}
+
+std::string DLNode::createResultCacheKey(model_version_t version, const BlobMap& inputs) {
+    std::vector<std::string> names;
+    names.reserve(inputs.size());
+    size_t keySize = sizeof(version);
+    for (const auto& [name, blob] : inputs) {
+        names.push_back(name);
+        keySize += name.size() + blob->byteSize() + 64;
+    }
+    std::sort(names.begin(), names.end());
+    std::string key;
+    key.reserve(keySize);
+    key.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    for (const auto& name : names) {
+        const auto& blob = inputs.at(name);
+        const auto& desc = blob->getTensorDesc();
+        // name and dims are length prefixed so that different inputs cannot produce the same key
+        const uint64_t nameSize = name.size();
+        key.append(reinterpret_cast<const char*>(&nameSize), sizeof(nameSize));
+        key.append(name);
+        const int32_t precision = desc.getPrecision();
+        key.append(reinterpret_cast<const char*>(&precision), sizeof(precision));
+        const uint64_t dimsCount = desc.getDims().size();
+        key.append(reinterpret_cast<const char*>(&dimsCount), sizeof(dimsCount));
+        for (uint64_t dim : desc.getDims()) {
+            key.append(reinterpret_cast<const char*>(&dim), sizeof(dim));
+        }
+        key.append(blob->cbuffer().as<const char*>(), blob->byteSize());
+    }
+    return key;
+}
+
+bool DLNode::tryGetCachedResults() {
+    this->resultCacheKey = createResultCacheKey(this->model->getVersion(), this->inputBlobs);
+    std::shared_ptr<const BlobMap> cached;
+    if (!this->resultCache->get(this->resultCacheKey, cached)) {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Result cache miss", getName());
+        return false;
+    }
+    OVMS_HOT_PATH_DEBUG("[Node: {}] Result cache hit, skipping inference", getName());
+    this->cachedOutputBlobs = std::move(cached);
+    this->resultCacheKey.clear();
+    this->inputBlobs.clear();
+    return true;
+}
+
+Status DLNode::fetchCachedResults(BlobMap& outputs) {
+    for (const auto& output_name : getRequiredOutputNames()) {
+        if (outputs.count(output_name) == 1) {
+            continue;
+        }
+        auto it = this->cachedOutputBlobs->find(output_name);
+        if (it == this->cachedOutputBlobs->end()) {
+            SPDLOG_WARN("[Node: {}] Cannot find cached output for alias {}", getName(), output_name);
+            return StatusCode::INVALID_MISSING_OUTPUT;
+        }
+        outputs.emplace(output_name, it->second);
+        OVMS_HOT_PATH_DEBUG("[Node: {}]: Cached blob with name {} has been prepared", getName(), output_name);
+    }
+    this->cachedOutputBlobs.reset();
+    this->release();
+    return StatusCode::OK;
+}
+
+void DLNode::cacheResults(const BlobMap& outputs) {
+    if (this->resultCache == nullptr || this->resultCacheKey.empty()) {
+        return;
+    }
+    // Cached blobs are shared with following nodes, none of them writes into its inputs
+    auto cached = std::make_shared<BlobMap>();
+    for (const auto& output_name : getRequiredOutputNames()) {
+        auto it = outputs.find(output_name);
+        if (it != outputs.end()) {
+            cached->emplace(output_name, it->second);
+        }
+    }
+    this->resultCache->put(this->resultCacheKey, std::move(cached));
+    this->resultCacheKey.clear();
+}
+
+Status DLNode::fetchBatchedResults(BlobMap& outputs) {
+    if (!this->batchedInferenceStatus.ok()) {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Batched inference failed: {}", getName(), this->batchedInferenceStatus.string());
+        return this->batchedInferenceStatus;
+    }
+    // Fill outputs map with part of the batch belonging to this node, blobs are already copied by the batcher
+    for (const auto& output_name : getRequiredOutputNames()) {
+        if (outputs.count(output_name) == 1) {
+            continue;
+        }
+        const auto& modelOutputName = nodeOutputNameAlias.count(output_name) == 1 ? nodeOutputNameAlias.at(output_name) : output_name;
+        auto it = this->batchedOutputBlobs.find(modelOutputName);
+        if (it == this->batchedOutputBlobs.end()) {
+            SPDLOG_WARN("[Node: {}] Cannot find batched output for alias {}", getName(), output_name);
+            return StatusCode::INVALID_MISSING_OUTPUT;
+        }
+        outputs.emplace(std::make_pair(output_name, it->second));
+        OVMS_HOT_PATH_DEBUG("[Node: {}]: Blob with name {} has been prepared", getName(), output_name);
+    }
+    this->batchedOutputBlobs.clear();
+    cacheResults(outputs);
+    // After results are fetched, model is not needed anymore
+    this->release();
+    return StatusCode::OK;
+}
+
 Status DLNode::fetchResults(BlobMap& outputs) {
+    StageTimer timer(this->metrics, NodeStage::FETCH_RESULTS);
+    if (this->cachedOutputBlobs != nullptr) {
+        return fetchCachedResults(outputs);
+    }
     // ::execute needs to be executed before ::fetchResults
     if (this->model == nullptr) {
-        SPDLOG_DEBUG("[Node: {}] Fetching results failed due to earlier execution failure", getName());
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Fetching results failed due to earlier execution failure", getName());
         return StatusCode::UNKNOWN_ERROR;
     }
+    if (this->dynamicBatcher != nullptr) {
+        return fetchBatchedResults(outputs);
+    }
 
     // Get infer request corresponding to this node model
     auto streamId = this->nodeStreamIdGuard->tryGetId();
     if (!streamId) {
-        SPDLOG_DEBUG("[Node: {}] Fetching results failed - node had stream Id never assigned", getName());
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Fetching results failed - node had stream Id never assigned", getName());
         return StatusCode::UNKNOWN_ERROR;
     }
-    auto& infer_request = this->model->getInferRequestsQueue().getInferRequest(streamId.value());
+    auto& infer_request = this->nodeStreamIdGuard->getInferRequestsQueue().getInferRequest(streamId.value());
     // Wait for blob results
-    SPDLOG_DEBUG("[Node: {}] Waiting for infer request with streamId: {} to finish", getName(), streamId.value());
+    OVMS_HOT_PATH_DEBUG("[Node: {}] Waiting for infer request with streamId: {} to finish", getName(), streamId.value());
     auto ov_status = infer_request.Wait(InferenceEngine::IInferRequest::RESULT_READY);
-    SPDLOG_DEBUG("[Node: {}] Infer request with streamId: {} finished", getName(), streamId.value());
+    OVMS_HOT_PATH_DEBUG("[Node: {}] Infer request with streamId: {} finished", getName(), streamId.value());
     this->inputBlobs.clear();
     if (ov_status != InferenceEngine::StatusCode::OK) {
         Status status = StatusCode::OV_INTERNAL_INFERENCE_ERROR;
-        SPDLOG_DEBUG("[Node: {}] Async infer failed: {}; OV StatusCode: {}", getName(), status.string(), ov_status);
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Async infer failed: {}; OV StatusCode: {}", getName(), status.string(), ov_status);
         return status;
     }
 
     // Fill outputs map with result blobs. Fetch only those that are required in following nodes.
-    for (const auto& node : this->next) {
-        for (const auto& pair : node.get().getMappingByDependency(*this)) {
-            const auto& output_name = pair.first;
-            if (outputs.count(output_name) == 1) {
-                continue;
-            }
+    // Several aliases can point to the same model output, which can be taken from infer request only once.
+    std::unordered_map<std::string, InferenceEngine::Blob::Ptr> takenBlobs;
+    auto& outputBlobPool = this->nodeStreamIdGuard->getInferRequestsQueue().getOutputBlobPool();
+    for (const auto& output_name : getRequiredOutputNames()) {
+        if (outputs.count(output_name) == 1) {
+            continue;
+        }
 
-            try {
-                std::string realModelOutputName;
-                if (!getRealOutputName(output_name, &realModelOutputName).ok()) {
-                    SPDLOG_WARN("[Node: {}] Cannot find real model output name for alias{}", getName(), output_name);
-                    return StatusCode::INTERNAL_ERROR;
-                }
-                SPDLOG_DEBUG("[Node: {}] Getting blob from model: {}, inferRequestStreamId: {}, blobName: {}",
-                    getName(), modelName, streamId.value(), realModelOutputName);
-                const auto blob = infer_request.GetBlob(realModelOutputName);
-                SPDLOG_DEBUG("[Node: {}] Creating copy of blob from model: {}, inferRequestStreamId: {}, blobName: {}",
-                    getName(), modelName, streamId.value(), realModelOutputName);
-                InferenceEngine::Blob::Ptr copiedBlob;
-                auto status = blobClone(copiedBlob, blob);
+        try {
+            std::string realModelOutputName;
+            if (!getRealOutputName(output_name, &realModelOutputName).ok()) {
+                SPDLOG_WARN("[Node: {}] Cannot find real model output name for alias{}", getName(), output_name);
+                return StatusCode::INTERNAL_ERROR;
+            }
+            auto takenBlobIt = takenBlobs.find(realModelOutputName);
+            if (takenBlobIt == takenBlobs.end()) {
+                InferenceEngine::Blob::Ptr blob;
+                auto status = takeOutputBlob(infer_request, outputBlobPool, realModelOutputName, blob);
                 if (!status.ok()) {
-                    SPDLOG_DEBUG("Could not clone result blob; node name: {}; model name: {}; output: {}",
-                        getName(),
-                        this->modelName,
-                        realModelOutputName);
                     return status;
                 }
-                outputs.emplace(std::make_pair(output_name, std::move(copiedBlob)));
-            } catch (const InferenceEngine::details::InferenceEngineException& e) {
-                Status status = StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
-                SPDLOG_DEBUG("[Node: {}] Error during getting blob {}; exception message: {}", getName(), status.string(), e.what());
-                return status;
+                takenBlobIt = takenBlobs.emplace(realModelOutputName, std::move(blob)).first;
             }
-            SPDLOG_DEBUG("[Node: {}]: Blob with name {} has been prepared", getName(), output_name);
+            outputs.emplace(std::make_pair(output_name, takenBlobIt->second));
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            Status status = StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Error during getting blob {}; exception message: {}", getName(), status.string(), e.what());
+            return status;
         }
+        OVMS_HOT_PATH_DEBUG("[Node: {}]: Blob with name {} has been prepared", getName(), output_name);
     }
+    cacheResults(outputs);
     // After results are fetched, model and inference request are not needed anymore
     this->release();
     return StatusCode::OK;
 }
 
+std::vector<std::string> DLNode::getRequiredOutputNames() const {
+    std::vector<std::string> names;
+    for (const auto& node : this->next) {
+        for (const auto& pair : node.get().getMappingByDependency(*this)) {
+            names.push_back(pair.first);
+        }
+    }
+    return names;
+}
+
+Status DLNode::takeOutputBlob(InferenceEngine::InferRequest& infer_request, BlobPool& outputBlobPool, const std::string& realModelOutputName, InferenceEngine::Blob::Ptr& blob) {
+    OVMS_HOT_PATH_DEBUG("[Node: {}] Getting blob from model: {}, blobName: {}", getName(), modelName, realModelOutputName);
+    auto resultBlob = infer_request.GetBlob(realModelOutputName);
+    auto hostBlobIt = this->hostOutputBlobs.find(realModelOutputName);
+    if (hostBlobIt != this->hostOutputBlobs.end()) {
+        // result stays in device memory, it goes back to the device pool when following nodes release it
+        infer_request.SetBlob(realModelOutputName, hostBlobIt->second);
+        this->hostOutputBlobs.erase(hostBlobIt);
+        blob = this->nodeStreamIdGuard->getInferRequestsQueue().getDeviceOutputBlobPool()->wrap(realModelOutputName, std::move(resultBlob));
+        return StatusCode::OK;
+    }
+    // Result is taken away from infer request and replaced with spare blob, it goes back to the pool when following nodes release it
+    auto replacement = outputBlobPool.acquire(realModelOutputName, resultBlob->getTensorDesc());
+    if (replacement) {
+        try {
+            infer_request.SetBlob(realModelOutputName, replacement);
+            blob = outputBlobPool.wrap(realModelOutputName, std::move(resultBlob));
+            return StatusCode::OK;
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Cannot replace output blob: {}, it will be copied instead; exception message: {}", getName(), realModelOutputName, e.what());
+        }
+    }
+    OVMS_HOT_PATH_DEBUG("[Node: {}] Creating copy of blob from model: {}, blobName: {}", getName(), modelName, realModelOutputName);
+    auto status = blobClone(blob, resultBlob);
+    if (!status.ok()) {
+        OVMS_HOT_PATH_DEBUG("Could not clone result blob; node name: {}; model name: {}; output: {}",
+            getName(),
+            this->modelName,
+            realModelOutputName);
+    }
+    return status;
+}
+
 Status DLNode::validate(const InferenceEngine::Blob::Ptr& blob, const TensorInfo& info) {
     if (info.getPrecision() != blob->getTensorDesc().getPrecision()) {
-        std::stringstream ss;
-        ss << "Expected: " << info.getPrecisionAsString()
-           << "; Actual: " << TensorInfo::getPrecisionAsString(blob->getTensorDesc().getPrecision());
-        const std::string details = ss.str();
-        SPDLOG_DEBUG("[Node: {}] Invalid precision - {}", getName(), details);
-        return Status(StatusCode::INVALID_PRECISION, details);
+        auto status = Status::withDetails(StatusCode::INVALID_PRECISION,
+            "Expected: ", info.getPrecisionAsString(), "; Actual: ", TensorInfo::getPrecisionAsString(blob->getTensorDesc().getPrecision()));
+        OVMS_HOT_PATH_DEBUG("[Node: {}] {}", getName(), status.string());
+        return status;
     }
 
     // If batch size differes, check if remaining dimensions are equal
     if (info.getShape()[0] != blob->getTensorDesc().getDims()[0]) {
         // If remaining dimensions are equal, it is invalid batch size
-        std::stringstream ss;
         if (std::equal(info.getShape().begin() + 1, info.getShape().end(), blob->getTensorDesc().getDims().begin() + 1)) {
-            ss << "Expected: " << info.getShape()[0] << "; Actual: " << blob->getTensorDesc().getDims()[0];
-            const std::string details = ss.str();
-            SPDLOG_DEBUG("[Node: {}] Invalid batch size - {}", getName(), details);
-            return Status(StatusCode::INVALID_BATCH_SIZE, details);
+            auto status = Status::withDetails(StatusCode::INVALID_BATCH_SIZE,
+                "Expected: ", info.getShape()[0], "; Actual: ", blob->getTensorDesc().getDims()[0]);
+            OVMS_HOT_PATH_DEBUG("[Node: {}] {}", getName(), status.string());
+            return status;
         } else {
             // Otherwise whole shape is incorrect
-            ss << "Expected: " << TensorInfo::shapeToString(info.getShape())
-               << "; Actual: " << TensorInfo::shapeToString(blob->getTensorDesc().getDims());
-            const std::string details = ss.str();
-            SPDLOG_DEBUG("Node: {}] Invalid shape - {}", getName(), details);
-            return Status(StatusCode::INVALID_SHAPE, details);
+            auto status = Status::withDetails(StatusCode::INVALID_SHAPE,
+                "Expected: ", TensorInfo::shapeToString(info.getShape()), "; Actual: ", TensorInfo::shapeToString(blob->getTensorDesc().getDims()));
+            OVMS_HOT_PATH_DEBUG("[Node: {}] {}", getName(), status.string());
+            return status;
         }
     }
 
     if (info.getShape() != blob->getTensorDesc().getDims()) {
-        std::stringstream ss;
-        ss << "Expected: " << TensorInfo::shapeToString(info.getShape())
-           << "; Actual: " << TensorInfo::shapeToString(blob->getTensorDesc().getDims());
-        const std::string details = ss.str();
-        SPDLOG_DEBUG("Node: {}] Invalid shape - {}", getName(), details);
-        return Status(StatusCode::INVALID_SHAPE, details);
+        auto status = Status::withDetails(StatusCode::INVALID_SHAPE,
+            "Expected: ", TensorInfo::shapeToString(info.getShape()), "; Actual: ", TensorInfo::shapeToString(blob->getTensorDesc().getDims()));
+        OVMS_HOT_PATH_DEBUG("[Node: {}] {}", getName(), status.string());
+        return status;
     }
 
     return StatusCode::OK;
 }
 
+Status DLNode::transposeBlob(InferenceEngine::Blob::Ptr& blob) {
+    const auto& dims = blob->getTensorDesc().getDims();
+    if (dims.size() != 4) {
+        auto status = Status::withDetails(StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS, "Expected: 4 dimensions; Actual: ", TensorInfo::shapeToString(dims));
+        OVMS_HOT_PATH_DEBUG("[Node: {}] NHWC input - {}", getName(), status.string());
+        return status;
+    }
+    const auto& precision = blob->getTensorDesc().getPrecision();
+    auto transposed = allocateConvertedBlob({precision, nhwcToNchwShape(dims), InferenceEngine::Layout::NCHW});
+    if (!transposed) {
+        return StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
+    }
+    transposeNhwcToNchw(blob->cbuffer().as<const void*>(), transposed->buffer().as<void*>(), transposed->getTensorDesc().getDims(), precision.size());
+    blob = transposed;
+    return StatusCode::OK;
+}
+
+void DLNode::narrowI64Blob(InferenceEngine::Blob::Ptr& blob) {
+    const auto& description = blob->getTensorDesc();
+    auto narrowed = allocateConvertedBlob({InferenceEngine::Precision::I32, description.getDims(), description.getLayout()});
+    narrowI64ToI32(blob->cbuffer().as<const int64_t*>(), narrowed->buffer().as<int32_t*>(), blob->size());
+    blob = narrowed;
+}
+
 Status DLNode::prepareInputsAndModelForInference() {
     size_t requestedBatchSize = 0;
     std::map<std::string, shape_t> requestedReshapes;
 
     // Validate each blob against its OV tensor info
     const auto& inputsInfo = this->model->getInputsInfo();
-    for (const auto& kv : this->inputBlobs) {
+    for (auto& kv : this->inputBlobs) {
         const auto& name = kv.first;
         auto& blob = kv.second;
 
         if (inputsInfo.count(name) == 0) {
-            std::stringstream ss;
-            ss << "Required input: " << name;
-            const std::string details = ss.str();
-            SPDLOG_DEBUG("[Node: {}] Missing input with specific name - {}", getName(), details);
-            return Status(StatusCode::INVALID_MISSING_INPUT, details);
+            auto status = Status::withDetails(StatusCode::INVALID_MISSING_INPUT, "Required input: ", name);
+            OVMS_HOT_PATH_DEBUG("[Node: {}] {}", getName(), status.string());
+            return status;
         }
         auto& inputInfo = *inputsInfo.at(name);
+        const auto& inputConversions = this->model->getModelConfig().getInputConversions();
+        if (blob->getTensorDesc().getPrecision() == InferenceEngine::Precision::I64 &&
+            inputInfo.getPrecision() == InferenceEngine::Precision::I32 &&
+            inputConversions.count(name) && inputConversions.at(name) == "I64") {
+            narrowI64Blob(blob);
+        }
+        if (inputInfo.isLayoutTransposed()) {
+            auto status = transposeBlob(blob);
+            if (!status.ok()) {
+                return status;
+            }
+        }
         auto status = validate(blob, inputInfo);
         if (status.ok()) {
             continue;
@@ -274,6 +623,15 @@ Status DLNode::prepareInputsAndModelForInference() {
             return status;
         }
 
+        // Dynamic batcher combines inputs of many nodes up to its max batch size, network batch size stays the same
+        if (status == StatusCode::INVALID_BATCH_SIZE && this->model->getDynamicBatcher() != nullptr) {
+            const auto batchSize = blob->getTensorDesc().getDims()[0];
+            if (batchSize > 0 && batchSize <= this->model->getDynamicBatcher()->getMaxBatchSize()) {
+                continue;
+            }
+            return status;
+        }
+
         // If batch size is incorrect, perform network batch size change if allowed (shape mode=auto or batch size=auto)
         if (status == StatusCode::INVALID_BATCH_SIZE) {
             if (this->model->getModelConfig().getBatchingMode() == Mode::AUTO) {
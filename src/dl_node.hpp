@@ -15,12 +15,17 @@
 //*****************************************************************************
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "executinstreamidguard.hpp"
+#include "lrucache.hpp"
 #include "model_version_policy.hpp"  // for model_version_t typename
 #include "modelinstance.hpp"
 #include "modelinstanceunloadguard.hpp"
@@ -31,6 +36,11 @@ namespace ovms {
 
 class ModelManager;
 
+/**
+ * @brief Outputs of cacheable model node keyed by model version and content of node inputs
+ */
+using node_result_cache_t = LRUCache<std::string, std::shared_ptr<const BlobMap>>;
+
 class DLNode : public Node {
     std::string modelName;
     std::optional<model_version_t> modelVersion;
@@ -41,6 +51,27 @@ class DLNode : public Node {
     std::unique_ptr<NodeStreamIdGuard> nodeStreamIdGuard;
     std::unique_ptr<ModelInstanceUnloadGuard> modelUnloadGuard;
 
+    // set when model has dynamic batching enabled, node is then inferred together with other requests to the model
+    DynamicBatcher* dynamicBatcher = nullptr;
+    BlobMap batchedOutputBlobs;
+    Status batchedInferenceStatus;
+
+    // set for nodes marked as cacheable, shared by all pipelines of the definition
+    std::shared_ptr<node_result_cache_t> resultCache;
+    std::string resultCacheKey;
+    std::shared_ptr<const BlobMap> cachedOutputBlobs;
+
+    // model outputs set to device blobs for the inference, host blobs they replaced are restored once results are taken
+    std::set<std::string> deviceResidentOutputs;
+    std::unordered_map<std::string, InferenceEngine::Blob::Ptr> hostOutputBlobs;
+
+    // pool of model infer requests reserved for the pipeline, shared queue is used when the model has no such pool
+    std::string inferRequestsPool;
+
+    // measured only when node has metrics set
+    std::chrono::steady_clock::time_point streamWaitStart;
+    std::chrono::steady_clock::time_point inferenceStart;
+
 public:
     DLNode(const std::string& nodeName, const std::string& modelName, std::optional<model_version_t> modelVersion,
         ModelManager& modelManager,
@@ -52,12 +83,48 @@ public:
         nodeOutputNameAlias(nodeOutputNameAlias) {
     }
 
-    Status execute(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQueue) override;
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override;
 
     Status fetchResults(BlobMap& outputs) override;
 
     Status validate(const InferenceEngine::Blob::Ptr& blob, const TensorInfo& info);
 
+    /**
+     * @brief Enables memoization of node outputs, inference is skipped when the same inputs were already inferred by the same model version
+     */
+    void setResultCache(std::shared_ptr<node_result_cache_t> resultCache) {
+        this->resultCache = std::move(resultCache);
+    }
+
+    /**
+     * @brief Sets model outputs passed to following nodes in device memory, they all infer on the same device
+     */
+    void setDeviceResidentOutputs(std::set<std::string> deviceResidentOutputs) {
+        this->deviceResidentOutputs = std::move(deviceResidentOutputs);
+    }
+
+    /**
+     * @brief Sets name of model infer requests pool streams are taken from, pipeline name by default
+     */
+    void setInferRequestsPool(std::string inferRequestsPool) {
+        this->inferRequestsPool = std::move(inferRequestsPool);
+    }
+
+    /**
+     * @brief Creates result cache key from model version and inputs precision, shape and content sorted by name
+     */
+    static std::string createResultCacheKey(model_version_t version, const BlobMap& inputs);
+
+    /**
+     * @brief Replaces NHWC blob with its NCHW copy, used for model inputs with NHWC:NCHW layout
+     */
+    Status transposeBlob(InferenceEngine::Blob::Ptr& blob);
+
+    /**
+     * @brief Replaces I64 blob with its I32 copy, used for I32 model inputs with I64 input conversion
+     */
+    static void narrowI64Blob(InferenceEngine::Blob::Ptr& blob);
+
     /**
      * @brief
      * Prepare inputs - if required, perform precision conversion
@@ -66,21 +133,30 @@ public:
      */
     Status prepareInputsAndModelForInference();
 
-    bool tryDisarmStreamIdGuard(const uint microseconds = 1) override {
-        SPDLOG_DEBUG("Trying to disarm stream id guard of node: {}", getName());
-        if (this->nodeStreamIdGuard == nullptr) {
-            return true;
-        }
-        return this->nodeStreamIdGuard->tryDisarm(microseconds);
-    }
-
     void release() override {
         SPDLOG_DEBUG("Releasing resources for node {}", getName());
+        restoreHostOutputBlobs();
         this->nodeStreamIdGuard.reset();
+        this->dynamicBatcher = nullptr;
         this->model.reset();
         this->modelUnloadGuard.reset();
     }
 
+    void reset() override {
+        release();
+        this->batchedOutputBlobs.clear();
+        this->batchedInferenceStatus = StatusCode::OK;
+        this->resultCacheKey.clear();
+        this->cachedOutputBlobs.reset();
+        Node::reset();
+    }
+
+protected:
+    /**
+     * @brief Gives aliases of outputs fetched by ::fetchResults, by default those read by following nodes
+     */
+    virtual std::vector<std::string> getRequiredOutputNames() const;
+
 private:
     Status getRealInputName(const std::string& alias, std::string* result) const {
         if (this->model->getInputsInfo().count(alias) == 0) {
@@ -99,9 +175,36 @@ private:
         return StatusCode::OK;
     }
 
-    Status requestExecuteRequiredResources();
-    Status setInputsForInference(InferenceEngine::InferRequest& infer_request);
-    Status executeInference(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQueue, InferenceEngine::InferRequest& infer_request);
+    Status requestExecuteRequiredResources(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue);
+    Status setInputsForInference(InferenceEngine::InferRequest& infer_request, const blob_map_t& preallocatedBlobs);
+    Status executeInference(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue, InferenceEngine::InferRequest& infer_request);
+
+    /**
+     * @brief Replaces device resident outputs of infer request with blobs in device memory, outputs which cannot be replaced stay on the host
+     */
+    void setDeviceOutputsForInference(InferenceEngine::InferRequest& infer_request, OVInferRequestsQueue& inferRequestsQueue);
+
+    /**
+     * @brief Puts host output blobs back on infer request, so that later inferences of the model do not write into results passed on
+     */
+    void restoreHostOutputBlobs();
+
+    /**
+     * @brief Copies inputs left in memory of other device to the host, e.g. when model was reloaded on another device after validation
+     *
+     * @param targetContext context of infer requests queue the node infers with, inputs in its memory are kept, nullptr downloads all device inputs
+     */
+    Status downloadDeviceInputs(const InferenceEngine::RemoteContext::Ptr& targetContext);
+    void executeInBatch(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue);
+    Status fetchBatchedResults(BlobMap& outputs);
+    bool tryGetCachedResults();
+    Status fetchCachedResults(BlobMap& outputs);
+    void cacheResults(const BlobMap& outputs);
+
+    /**
+     * @brief Takes result blob away from infer request and replaces it with pooled one, falls back to copying
+     */
+    Status takeOutputBlob(InferenceEngine::InferRequest& infer_request, BlobPool& outputBlobPool, const std::string& realModelOutputName, InferenceEngine::Blob::Ptr& blob);
 };
 
 }  // namespace ovms
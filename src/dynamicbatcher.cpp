@@ -0,0 +1,474 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "dynamicbatcher.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "deserialization.hpp"
+#include "imagedecoder.hpp"
+#include "logging.hpp"
+#include "narrowing.hpp"
+#include "samplingprofiler.hpp"
+#include "serialization.hpp"
+#include "sharedmemory.hpp"
+#include "transposition.hpp"
+
+namespace ovms {
+
+Status copyRequestInput(const tensorflow::TensorProto& requestInput, const TensorInfo& networkInput, char* destination, size_t byteSize) {
+    if (isSharedMemoryReference(requestInput)) {
+        return copySharedMemoryReference(requestInput, destination, byteSize);
+    }
+    if (isFp32ConversionRequested(requestInput, networkInput.getPrecision())) {
+        const size_t count = byteSize / networkInput.getPrecision().size();
+        const bool isPacked = !requestInput.tensor_content().empty();
+        if ((isPacked ? requestInput.tensor_content().size() / sizeof(float) : static_cast<size_t>(requestInput.float_val_size())) != count) {
+            return StatusCode::INVALID_CONTENT_SIZE;
+        }
+        convertFromFp32(isPacked ? reinterpret_cast<const float*>(requestInput.tensor_content().data()) : requestInput.float_val().data(),
+            networkInput.getPrecision(), destination, count);
+        return StatusCode::OK;
+    }
+    if (isI64ConversionRequested(requestInput, networkInput.getPrecision())) {
+        const size_t count = byteSize / sizeof(int32_t);
+        const bool isPacked = !requestInput.tensor_content().empty();
+        if ((isPacked ? requestInput.tensor_content().size() / sizeof(int64_t) : static_cast<size_t>(requestInput.int64_val_size())) != count) {
+            return StatusCode::INVALID_CONTENT_SIZE;
+        }
+        narrowI64ToI32(isPacked ? reinterpret_cast<const int64_t*>(requestInput.tensor_content().data()) : requestInput.int64_val().data(),
+            reinterpret_cast<int32_t*>(destination), count);
+        return StatusCode::OK;
+    }
+    // 16 bit values packed in tensor_content are copied as other precisions
+    const auto dtype = requestInput.tensor_content().empty() ? requestInput.dtype() : tensorflow::DataType::DT_INVALID;
+    switch (dtype) {
+    case tensorflow::DataType::DT_HALF:
+        narrowToUint16(requestInput.half_val().data(), reinterpret_cast<uint16_t*>(destination),
+            static_cast<size_t>(requestInput.half_val_size()));
+        break;
+    case tensorflow::DataType::DT_UINT16:
+        narrowToUint16(requestInput.int_val().data(), reinterpret_cast<uint16_t*>(destination),
+            static_cast<size_t>(requestInput.int_val_size()));
+        break;
+    case tensorflow::DataType::DT_INT16:
+        if (requestInput.int_val_size() * sizeof(int16_t) != byteSize) {
+            return StatusCode::INVALID_CONTENT_SIZE;
+        }
+        narrowToUint16(requestInput.int_val().data(), reinterpret_cast<uint16_t*>(destination), byteSize / sizeof(int16_t));
+        break;
+    case tensorflow::DataType::DT_INT8:
+    case tensorflow::DataType::DT_UINT8:
+        if (static_cast<size_t>(requestInput.int_val_size()) != byteSize) {
+            return StatusCode::INVALID_CONTENT_SIZE;
+        }
+        narrowToUint8(requestInput.int_val().data(), reinterpret_cast<uint8_t*>(destination), byteSize);
+        break;
+    case tensorflow::DataType::DT_FLOAT:
+    case tensorflow::DataType::DT_INT32:
+    case tensorflow::DataType::DT_INT64:
+    case tensorflow::DataType::DT_BOOL:
+        // repeated values of these types are laid out as in network input
+        if (getRepeatedFieldValueCount(requestInput) * networkInput.getPrecision().size() != byteSize) {
+            return StatusCode::INVALID_CONTENT_SIZE;
+        }
+        std::memcpy(destination, getRepeatedFieldData(requestInput), byteSize);
+        break;
+    default:
+        if (requestInput.tensor_content().size() != byteSize) {
+            return StatusCode::INVALID_CONTENT_SIZE;
+        }
+        std::memcpy(destination, requestInput.tensor_content().data(), byteSize);
+    }
+    return StatusCode::OK;
+}
+
+DynamicBatcher::DynamicBatcher(const std::string& modelName,
+    OVInferRequestsQueue& inferRequestsQueue,
+    const tensor_map_t& inputsInfo,
+    const tensor_map_t& outputsInfo,
+    size_t maxBatchSize,
+    std::chrono::microseconds maxQueueDelay,
+    std::chrono::microseconds latencySlo,
+    std::shared_ptr<ModelMetrics> metrics) :
+    modelName(modelName),
+    inferRequestsQueue(inferRequestsQueue),
+    inputsInfo(inputsInfo),
+    outputsInfo(outputsInfo),
+    maxBatchSize(maxBatchSize),
+    maxQueueDelay(maxQueueDelay),
+    metrics(std::move(metrics)),
+    adaptiveController(latencySlo.count() > 0 ? std::make_unique<AdaptiveBatchingController>(maxBatchSize, maxQueueDelay, latencySlo) : nullptr) {
+    SPDLOG_INFO("Starting dynamic batcher for model: {}; max batch size: {}; max queue delay: {} us; latency SLO: {} us",
+        modelName, maxBatchSize, maxQueueDelay.count(), latencySlo.count());
+    worker = std::thread(&DynamicBatcher::run, this);
+}
+
+DynamicBatcher::~DynamicBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopRequested = true;
+    }
+    queueCondition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    batch_t rejected;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        while (!pendingRequests.empty()) {
+            rejected.push_back(std::move(pendingRequests.front()));
+            pendingRequests.pop_front();
+        }
+        pendingBatchSize = 0;
+    }
+    finishBatch(rejected, StatusCode::MODEL_VERSION_NOT_LOADED_ANYMORE);
+    SPDLOG_INFO("Stopped dynamic batcher for model: {}", modelName);
+}
+
+Status DynamicBatcher::infer(const tensorflow::serving::PredictRequest* request, tensorflow::serving::PredictResponse* response, const deadline_t& deadline) {
+    std::promise<Status> promise;
+    auto result = promise.get_future();
+    inferAsync(
+        request, response, [&promise](Status status) { promise.set_value(status); }, deadline);
+    return result.get();
+}
+
+void DynamicBatcher::inferAsync(const tensorflow::serving::PredictRequest* request, tensorflow::serving::PredictResponse* response, std::function<void(Status)> callback,
+    const deadline_t& deadline) {
+    auto pending = std::make_unique<PendingRequest>();
+    pending->request = request;
+    pending->response = response;
+    pending->batchSize = request->inputs().begin()->second.tensor_shape().dim(0).size();
+    pending->enqueueTime = std::chrono::steady_clock::now();
+    pending->deadline = deadline;
+    pending->callback = std::move(callback);
+    enqueue(std::move(pending));
+}
+
+void DynamicBatcher::inferAsync(const BlobMap* inputs, BlobMap* outputs, std::set<std::string> outputNames, std::function<void(Status)> callback,
+    const deadline_t& deadline) {
+    auto pending = std::make_unique<PendingRequest>();
+    pending->inputBlobs = inputs;
+    pending->outputBlobs = outputs;
+    pending->outputNames = std::move(outputNames);
+    pending->batchSize = inputs->begin()->second->getTensorDesc().getDims()[0];
+    pending->enqueueTime = std::chrono::steady_clock::now();
+    pending->deadline = deadline;
+    pending->callback = std::move(callback);
+    enqueue(std::move(pending));
+}
+
+bool DynamicBatcher::PendingRequest::isOutputRequested(const std::string& name) const {
+    if (request == nullptr) {
+        return outputNames.count(name) > 0;
+    }
+    return ovms::isOutputRequested(&request->output_filter(), name);
+}
+
+void DynamicBatcher::enqueue(std::unique_ptr<PendingRequest> pending) {
+    if (adaptiveController) {
+        adaptiveController->recordArrival(pending->batchSize, pending->enqueueTime);
+    }
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (stopRequested) {
+            lock.unlock();
+            pending->callback(StatusCode::MODEL_VERSION_NOT_LOADED_ANYMORE);
+            return;
+        }
+        pendingBatchSize += pending->batchSize;
+        pendingRequests.push_back(std::move(pending));
+    }
+    queueCondition.notify_one();
+}
+
+void DynamicBatcher::run() {
+    setCurrentThreadName("ovms_batcher");
+    SPDLOG_DEBUG("Dynamic batcher thread for model: {} started", modelName);
+    while (true) {
+        auto batch = std::make_shared<batch_t>();
+        batch_t expired;
+        if (!collectBatch(*batch, expired)) {
+            break;
+        }
+        finishBatch(expired, StatusCode::DEADLINE_EXCEEDED);
+        if (batch->empty()) {
+            continue;
+        }
+        executeBatch(std::move(batch));
+    }
+    SPDLOG_DEBUG("Dynamic batcher thread for model: {} stopped", modelName);
+}
+
+bool DynamicBatcher::collectBatch(batch_t& batch, batch_t& expired) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCondition.wait(lock, [this]() { return stopRequested || !pendingRequests.empty(); });
+    if (stopRequested) {
+        return false;
+    }
+    auto queueDelay = maxQueueDelay;
+    size_t targetBatchSize = maxBatchSize;
+    if (adaptiveController) {
+        const auto decision = adaptiveController->getDecision();
+        queueDelay = decision.queueDelay;
+        targetBatchSize = decision.targetBatchSize;
+    }
+    // The oldest request decides how long we can wait for the batch to fill up
+    const auto deadline = pendingRequests.front()->enqueueTime + queueDelay;
+    queueCondition.wait_until(lock, deadline, [this, targetBatchSize]() { return stopRequested || pendingBatchSize >= targetBatchSize; });
+    if (stopRequested) {
+        return false;
+    }
+    size_t gatheredBatchSize = 0;
+    while (!pendingRequests.empty() &&
+           gatheredBatchSize + pendingRequests.front()->batchSize <= maxBatchSize) {
+        pendingBatchSize -= pendingRequests.front()->batchSize;
+        if (isDeadlineExceeded(pendingRequests.front()->deadline)) {
+            // expired requests do not take place in the batch
+            expired.push_back(std::move(pendingRequests.front()));
+            pendingRequests.pop_front();
+            continue;
+        }
+        gatheredBatchSize += pendingRequests.front()->batchSize;
+        batch.push_back(std::move(pendingRequests.front()));
+        pendingRequests.pop_front();
+    }
+    OVMS_HOT_PATH_DEBUG("Model: {} gathered {} requests with total batch size: {}", modelName, batch.size(), gatheredBatchSize);
+    return true;
+}
+
+void DynamicBatcher::executeBatch(std::shared_ptr<batch_t> batch) {
+    if (metrics) {
+        size_t gatheredBatchSize = 0;
+        for (const auto& pending : *batch) {
+            gatheredBatchSize += pending->batchSize;
+        }
+        metrics->recordBatchSize(gatheredBatchSize);
+    }
+    // Waiting for idle infer request is a natural backpressure, meanwhile next batch is gathered
+    auto stageStart = std::chrono::steady_clock::now();
+    auto idleStreamId = inferRequestsQueue.tryGetIdleStream();
+    const int streamId = idleStreamId ? idleStreamId.value() : inferRequestsQueue.getIdleStream().get();
+    auto& inferRequest = inferRequestsQueue.getInferRequest(streamId);
+    if (metrics) {
+        metrics->recordStageSince(ModelStage::STREAM_WAIT, stageStart);
+        stageStart = std::chrono::steady_clock::now();
+    }
+
+    auto status = setInputs(*batch, inferRequest);
+    if (metrics) {
+        metrics->recordStageSince(ModelStage::DESERIALIZATION, stageStart);
+    }
+    if (!status.ok()) {
+        inferRequestsQueue.returnStream(streamId);
+        finishBatch(*batch, status);
+        return;
+    }
+
+    try {
+        inferRequest.SetCompletionCallback(std::function<void(InferenceEngine::InferRequest, InferenceEngine::StatusCode)>(
+            [this, batch, streamId, &inferRequest, inferStart = std::chrono::steady_clock::now()](InferenceEngine::InferRequest, InferenceEngine::StatusCode code) {
+                // copies outlive the callback reset, same as in inferenceAsync
+                auto batcher = this;
+                auto finishedBatch = batch;
+                const int finishedStreamId = streamId;
+                auto& finishedInferRequest = inferRequest;
+                const uint64_t inferenceMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - inferStart).count();
+                if (batcher->metrics) {
+                    batcher->metrics->recordStage(ModelStage::INFERENCE, inferenceMicroseconds);
+                }
+                Status status = StatusCode::OK;
+                if (code != InferenceEngine::StatusCode::OK) {
+                    status = StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+                    SPDLOG_ERROR("Async infer failed for model: {}; {}: {}", batcher->modelName, status.string(), code);
+                } else {
+                    const auto serializeStart = std::chrono::steady_clock::now();
+                    status = batcher->serializeOutputs(*finishedBatch, finishedInferRequest);
+                    if (batcher->metrics) {
+                        batcher->metrics->recordStageSince(ModelStage::SERIALIZATION, serializeStart);
+                    }
+                }
+                finishedInferRequest.SetCompletionCallback([]() {});  // reset callback on infer request
+                batcher->inferRequestsQueue.returnStream(finishedStreamId);
+                if (batcher->adaptiveController && status.ok()) {
+                    batcher->recordAdaptiveBatch(*finishedBatch, inferenceMicroseconds);
+                }
+                finishBatch(*finishedBatch, status);
+            }));
+        inferRequest.StartAsync();
+    } catch (const InferenceEngine::details::InferenceEngineException& e) {
+        status = StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+        SPDLOG_ERROR("Async caught an exception for model: {}; {}: {}", modelName, status.string(), e.what());
+        inferRequest.SetCompletionCallback([]() {});
+        inferRequestsQueue.returnStream(streamId);
+        finishBatch(*batch, status);
+    }
+}
+
+void DynamicBatcher::recordAdaptiveBatch(const batch_t& batch, uint64_t inferenceMicroseconds) {
+    const auto now = std::chrono::steady_clock::now();
+    size_t gatheredBatchSize = 0;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(batch.size());
+    for (const auto& pending : batch) {
+        gatheredBatchSize += pending->batchSize;
+        latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - pending->enqueueTime).count());
+    }
+    adaptiveController->recordBatch(gatheredBatchSize, inferenceMicroseconds, latencies);
+}
+
+Status DynamicBatcher::setInputs(const batch_t& batch, InferenceEngine::InferRequest& inferRequest) {
+    for (const auto& [mappedName, networkInput] : inputsInfo) {
+        InferenceEngine::Blob::Ptr blob;
+        try {
+            blob = inferRequest.GetBlob(networkInput->getName());
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            Status status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
+            SPDLOG_ERROR("{}: {}", status.string(), e.what());
+            return status;
+        }
+        const size_t batchByteSize = blob->byteSize() / maxBatchSize;
+        char* destination = (char*)blob->buffer();
+        size_t offset = 0;
+        // NHWC request data is gathered in staging buffer and transposed into its part of the batch
+        std::vector<char> staging;
+        for (const auto& pending : batch) {
+            const size_t byteSize = pending->batchSize * batchByteSize;
+            if (offset + byteSize > blob->byteSize()) {
+                return StatusCode::INVALID_BATCH_SIZE;
+            }
+            char* target = destination + offset;
+            if (pending->inputBlobs != nullptr) {
+                // blobs of pipeline nodes are already in network layout and precision
+                auto inputBlobIt = pending->inputBlobs->find(mappedName);
+                if (inputBlobIt == pending->inputBlobs->end()) {
+                    return StatusCode::INVALID_MISSING_INPUT;
+                }
+                if (inputBlobIt->second->byteSize() != byteSize) {
+                    return StatusCode::INVALID_CONTENT_SIZE;
+                }
+                std::memcpy(target, inputBlobIt->second->cbuffer().as<const char*>(), byteSize);
+                offset += byteSize;
+                continue;
+            }
+            const auto& requestInput = pending->request->inputs().at(mappedName);
+            if (isImageInputRequested(requestInput, *networkInput)) {
+                // images are decoded in network input layout
+                auto status = decodeImages(requestInput, *networkInput, target, pending->batchSize);
+                if (!status.ok()) {
+                    return status;
+                }
+                offset += byteSize;
+                continue;
+            }
+            if (networkInput->isLayoutTransposed()) {
+                staging.resize(byteSize);
+                target = staging.data();
+            }
+            auto status = copyRequestInput(requestInput, *networkInput, target, byteSize);
+            if (!status.ok()) {
+                return status;
+            }
+            if (networkInput->isLayoutTransposed()) {
+                shape_t shape = networkInput->getShape();
+                shape[0] = pending->batchSize;
+                transposeNhwcToNchw(staging.data(), destination + offset, shape, networkInput->getPrecision().size());
+            }
+            offset += byteSize;
+        }
+    }
+    return StatusCode::OK;
+}
+
+Status DynamicBatcher::serializeOutputs(const batch_t& batch, InferenceEngine::InferRequest& inferRequest) {
+    for (const auto& [mappedName, networkOutput] : outputsInfo) {
+        const auto& name = mappedName;
+        if (std::none_of(batch.begin(), batch.end(), [&name](const auto& pending) { return pending->isOutputRequested(name); })) {
+            continue;
+        }
+        InferenceEngine::Blob::Ptr blob;
+        try {
+            blob = inferRequest.GetBlob(networkOutput->getName());
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            Status status = StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+            SPDLOG_ERROR("{}: {}", status.string(), e.what());
+            return status;
+        }
+        size_t batchOffset = 0;
+        const size_t batchByteSize = blob->byteSize() / maxBatchSize;
+        for (const auto& pending : batch) {
+            if (!pending->isOutputRequested(mappedName)) {
+                batchOffset += pending->batchSize;
+                continue;
+            }
+            if (pending->outputBlobs != nullptr) {
+                // node gets its own copy of its part of the batch
+                const auto& tensorDesc = blob->getTensorDesc();
+                auto dims = tensorDesc.getDims();
+                dims[0] = pending->batchSize;
+                auto outputBlob = allocateConvertedBlob({tensorDesc.getPrecision(), dims, tensorDesc.getLayout()});
+                if (!outputBlob) {
+                    return StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION;
+                }
+                std::memcpy(outputBlob->buffer().as<char*>(), blob->cbuffer().as<const char*>() + batchOffset * batchByteSize, pending->batchSize * batchByteSize);
+                (*pending->outputBlobs)[mappedName] = std::move(outputBlob);
+                batchOffset += pending->batchSize;
+                continue;
+            }
+            if (networkOutput->isReduced()) {
+                auto shape = networkOutput->getShape();
+                shape[0] = pending->batchSize;
+                auto status = serializeReducedOutput(*pending->response, networkOutput, blob->cbuffer().as<const char*>() + batchOffset * batchByteSize, shape);
+                if (!status.ok()) {
+                    return status;
+                }
+                batchOffset += pending->batchSize;
+                continue;
+            }
+            auto& tensorProto = (*pending->response->mutable_outputs())[mappedName];
+            OutputQuantization quantization;
+            auto status = serializeBlobBatchToTensorProto(tensorProto, networkOutput, blob, batchOffset, pending->batchSize, &quantization);
+            if (!status.ok()) {
+                return status;
+            }
+            if (networkOutput->isQuantized()) {
+                serializeOutputQuantization(*pending->response, mappedName, quantization);
+            }
+            batchOffset += pending->batchSize;
+        }
+    }
+    return StatusCode::OK;
+}
+
+void DynamicBatcher::finishBatch(batch_t& batch, const Status& status) {
+    for (auto& pending : batch) {
+        if (!status.ok() || pending->request == nullptr) {
+            pending->callback(status);
+            continue;
+        }
+        // failure to write into client region affects only the request which referenced it
+        pending->callback(writeOutputsToSharedMemory(pending->response, &pending->request->output_filter()));
+    }
+}
+
+}  // namespace ovms
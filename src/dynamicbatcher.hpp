@@ -0,0 +1,191 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "adaptivebatchingcontroller.hpp"
+#include "deadline.hpp"
+#include "modelmetrics.hpp"
+#include "node.hpp"
+#include "ovinferrequestsqueue.hpp"
+#include "status.hpp"
+#include "tensorinfo.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Copies or converts values of single request input into memory in network input precision
+ *
+ * @param byteSize size of destination, has to match request values after conversion
+ */
+Status copyRequestInput(const tensorflow::TensorProto& requestInput, const TensorInfo& networkInput, char* destination, size_t byteSize);
+
+/**
+ * @brief Gathers concurrent predict requests of a single model instance along the 0th dimension
+ * and executes them with one inference.
+ *
+ * Network batch size is expected to be equal to max batch size. Requests are copied into infer request
+ * input blobs one after another, remaining part of the batch is left unused. Outputs are split back
+ * into each of the responses. Blobs of pipeline model nodes are batched together with predict requests.
+ */
+class DynamicBatcher {
+public:
+    /**
+     * @brief Construct a new Dynamic Batcher and starts the batch gathering thread
+     *
+     * @param modelName used for logging
+     * @param inferRequestsQueue infer requests pool of model instance
+     * @param inputsInfo model instance inputs
+     * @param outputsInfo model instance outputs
+     * @param maxBatchSize maximum number of batches gathered in one inference
+     * @param maxQueueDelay maximum time the oldest request waits for the batch to fill up
+     * @param latencySlo when set, queue delay up to maxQueueDelay and target batch size are adapted to keep p99 latency below it
+     * @param metrics statistics of model instance, gathered batch sizes and stage durations are recorded there when set
+     */
+    DynamicBatcher(const std::string& modelName,
+        OVInferRequestsQueue& inferRequestsQueue,
+        const tensor_map_t& inputsInfo,
+        const tensor_map_t& outputsInfo,
+        size_t maxBatchSize,
+        std::chrono::microseconds maxQueueDelay,
+        std::chrono::microseconds latencySlo = std::chrono::microseconds(0),
+        std::shared_ptr<ModelMetrics> metrics = nullptr);
+
+    /**
+     * @brief Stops batch gathering thread. Requests which were not scheduled yet are rejected.
+     */
+    ~DynamicBatcher();
+
+    DynamicBatcher(const DynamicBatcher&) = delete;
+    DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+
+    /**
+     * @brief Enqueues already validated request and waits until its batch is inferred
+     *
+     * @param request
+     * @param response
+     * @param deadline request is dropped if it passes before its batch is gathered
+     *
+     * @return Status
+     */
+    Status infer(const tensorflow::serving::PredictRequest* request, tensorflow::serving::PredictResponse* response, const deadline_t& deadline = NO_DEADLINE);
+
+    /**
+     * @brief Enqueues already validated request without waiting for the inference
+     *
+     * @param request
+     * @param response
+     * @param callback called with the result once the batch is inferred, request and response have to be valid until then
+     * @param deadline request is dropped if it passes before its batch is gathered
+     */
+    void inferAsync(const tensorflow::serving::PredictRequest* request, tensorflow::serving::PredictResponse* response, std::function<void(Status)> callback,
+        const deadline_t& deadline = NO_DEADLINE);
+
+    /**
+     * @brief Enqueues input blobs of pipeline model node without waiting for the inference
+     *
+     * @param inputs keyed by model input name, already validated and in network layout, batch size is taken from the first one
+     * @param outputs filled with copies of the node part of the batch for each of outputNames
+     * @param outputNames model output names needed by following nodes
+     * @param callback called with the result once the batch is inferred, inputs and outputs have to be valid until then
+     * @param deadline request is dropped if it passes before its batch is gathered
+     */
+    void inferAsync(const BlobMap* inputs, BlobMap* outputs, std::set<std::string> outputNames, std::function<void(Status)> callback,
+        const deadline_t& deadline = NO_DEADLINE);
+
+    size_t getMaxBatchSize() const {
+        return maxBatchSize;
+    }
+
+    /**
+     * @brief Get adaptive batching controller
+     *
+     * @return controller or nullptr if no latency SLO is set
+     */
+    const AdaptiveBatchingController* getAdaptiveController() const {
+        return adaptiveController.get();
+    }
+
+private:
+    struct PendingRequest {
+        const tensorflow::serving::PredictRequest* request = nullptr;
+        tensorflow::serving::PredictResponse* response = nullptr;
+        // set instead of request and response for pipeline model nodes
+        const BlobMap* inputBlobs = nullptr;
+        BlobMap* outputBlobs = nullptr;
+        std::set<std::string> outputNames;
+        size_t batchSize;
+        std::chrono::steady_clock::time_point enqueueTime;
+        deadline_t deadline;
+        std::function<void(Status)> callback;
+
+        bool isOutputRequested(const std::string& name) const;
+    };
+
+    using batch_t = std::vector<std::unique_ptr<PendingRequest>>;
+
+    void run();
+
+    bool collectBatch(batch_t& batch, batch_t& expired);
+
+    void enqueue(std::unique_ptr<PendingRequest> pending);
+
+    void executeBatch(std::shared_ptr<batch_t> batch);
+
+    void recordAdaptiveBatch(const batch_t& batch, uint64_t inferenceMicroseconds);
+
+    Status setInputs(const batch_t& batch, InferenceEngine::InferRequest& inferRequest);
+
+    Status serializeOutputs(const batch_t& batch, InferenceEngine::InferRequest& inferRequest);
+
+    static void finishBatch(batch_t& batch, const Status& status);
+
+    const std::string modelName;
+    OVInferRequestsQueue& inferRequestsQueue;
+    const tensor_map_t& inputsInfo;
+    const tensor_map_t& outputsInfo;
+    const size_t maxBatchSize;
+    const std::chrono::microseconds maxQueueDelay;
+    const std::shared_ptr<ModelMetrics> metrics;
+    const std::unique_ptr<AdaptiveBatchingController> adaptiveController;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<std::unique_ptr<PendingRequest>> pendingRequests;
+    size_t pendingBatchSize = 0;
+    bool stopRequested = false;
+
+    std::thread worker;
+};
+
+}  // namespace ovms
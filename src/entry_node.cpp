@@ -15,12 +15,20 @@
 //*****************************************************************************
 #include "entry_node.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
+#include "containerlimits.hpp"
+#include "deserialization.hpp"
+#include "sharedmemory.hpp"
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wall"
 #include "tensorflow/core/framework/tensor.h"
@@ -28,48 +36,144 @@
 
 namespace ovms {
 
+namespace {
+/**
+ * @brief Size of blob allocated for the input, 0 when blob is created over request memory
+ */
+size_t getConvertedBytes(const tensorflow::TensorProto& proto) {
+    if (isSharedMemoryReference(proto) || !proto.tensor_content().empty()) {
+        return 0;
+    }
+    switch (proto.dtype()) {
+    case tensorflow::DataType::DT_UINT8:
+    case tensorflow::DataType::DT_INT8:
+    case tensorflow::DataType::DT_INT16:
+        return static_cast<size_t>(getRepeatedFieldValueCount(proto)) * tensorflow::DataTypeSize(proto.dtype());
+    default:
+        return 0;
+    }
+}
+}  // namespace
+
 Status EntryNode::fetchResults(BlobMap& outputs) {
-    // Fill outputs map with tensorflow predict request inputs. Fetch only those that are required in following nodes
+    // Fetch only inputs required in following nodes, input used by several nodes is fetched once and its blob is shared
+    std::vector<const std::string*> names;
     for (const auto& node : this->next) {
         for (const auto& pair : node.get().getMappingByDependency(*this)) {
             const auto& output_name = pair.first;
-            if (outputs.count(output_name) == 1) {
-                continue;
+            if (std::none_of(names.begin(), names.end(), [&output_name](const std::string* name) { return *name == output_name; })) {
+                names.push_back(&output_name);
             }
+        }
+    }
+    outputs.reserve(names.size());
 
-            if (request->inputs().count(output_name) == 0) {
-                std::stringstream ss;
-                ss << "Required input: " << output_name;
-                const std::string details = ss.str();
-                SPDLOG_DEBUG("[Node: {}] Missing input with specific name", getName(), details);
-                return Status(StatusCode::INVALID_MISSING_INPUT, details);
-            }
-            const auto& tensor_proto = request->inputs().at(output_name);
-            InferenceEngine::Blob::Ptr blob;
-            SPDLOG_DEBUG("[Node: {}] Deserializing input: {}", getName(), output_name);
-            auto status = deserialize(tensor_proto, blob);
-            if (!status.ok()) {
-                return status;
+    if (requestBlobs) {
+        for (const auto* output_name : names) {
+            auto it = requestBlobs->find(*output_name);
+            if (it == requestBlobs->end()) {
+                return missingInput(*output_name);
             }
+            outputs.emplace(*output_name, it->second);
+        }
+        return StatusCode::OK;
+    }
 
-            outputs[output_name] = blob;
+    std::vector<const tensorflow::TensorProto*> protos;
+    protos.reserve(names.size());
+    for (const auto* output_name : names) {
+        auto it = request->inputs().find(*output_name);
+        if (it == request->inputs().end()) {
+            return missingInput(*output_name);
+        }
+        protos.push_back(&it->second);
+    }
 
-            SPDLOG_DEBUG("[Node: {}]: blob with name {} has been prepared", getName(), output_name);
+    // Blobs over tensor_content, repeated fields and shared memory are only wrapped, large inputs converted from padded values are copied in parallel
+    std::vector<InferenceEngine::Blob::Ptr> blobs(names.size());
+    std::vector<size_t> converted;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (getConvertedBytes(*protos[i]) >= PARALLEL_DESERIALIZATION_MIN_BYTES) {
+            converted.push_back(i);
+            continue;
         }
+        SPDLOG_DEBUG("[Node: {}] Deserializing input: {}", getName(), *names[i]);
+        auto status = deserialize(*protos[i], blobs[i]);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    auto status = deserializeInParallel(protos, converted, blobs);
+    if (!status.ok()) {
+        return status;
+    }
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        outputs.emplace(*names[i], std::move(blobs[i]));
+        SPDLOG_DEBUG("[Node: {}]: blob with name {} has been prepared", getName(), *names[i]);
     }
+    return StatusCode::OK;
+}
+
+Status EntryNode::missingInput(const std::string& name) const {
+    std::stringstream ss;
+    ss << "Required input: " << name;
+    const std::string details = ss.str();
+    SPDLOG_DEBUG("[Node: {}] Missing input with specific name", getName(), details);
+    return Status(StatusCode::INVALID_MISSING_INPUT, details);
+}
 
+Status EntryNode::deserializeInParallel(const std::vector<const tensorflow::TensorProto*>& protos, const std::vector<size_t>& indexes,
+    std::vector<InferenceEngine::Blob::Ptr>& blobs) {
+    const size_t threadsCount = std::min({indexes.size(), MAX_DESERIALIZATION_THREADS,
+        static_cast<size_t>(getEffectiveCpuCount())});
+    if (threadsCount <= 1) {
+        for (auto index : indexes) {
+            auto status = deserialize(*protos[index], blobs[index]);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+        return StatusCode::OK;
+    }
+    SPDLOG_DEBUG("[Node: {}] Deserializing {} inputs in {} threads", getName(), indexes.size(), threadsCount);
+    std::vector<Status> statuses(indexes.size());
+    std::atomic<size_t> nextInput{0};
+    auto worker = [&]() {
+        for (size_t i = nextInput++; i < indexes.size(); i = nextInput++) {
+            statuses[i] = deserialize(*protos[indexes[i]], blobs[indexes[i]]);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadsCount - 1);
+    for (size_t i = 1; i < threadsCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& status : statuses) {
+        if (!status.ok()) {
+            return status;
+        }
+    }
     return StatusCode::OK;
 }
 
 Status EntryNode::deserialize(const tensorflow::TensorProto& proto, InferenceEngine::Blob::Ptr& blob) {
+    if (isSharedMemoryReference(proto)) {
+        return deserializeSharedMemory(proto, blob);
+    }
     InferenceEngine::TensorDesc description;
-    if (proto.tensor_content().size() == 0) {
+    const bool isPaddedContent = proto.tensor_content().empty();
+    if (isPaddedContent && getRepeatedFieldValueCount(proto) <= 0) {
         const std::string details = "Tensor content size can't be 0";
         SPDLOG_DEBUG("[Node: {}] {}", getName(), details);
         return Status(StatusCode::INVALID_CONTENT_SIZE, details);
     }
 
-    // Assuming content is in proto.tensor_content
+    // Content is in proto.tensor_content or in repeated field of proto dtype
 
     InferenceEngine::SizeVector shape;
     for (int i = 0; i < proto.tensor_shape().dim_size(); i++) {
@@ -80,7 +184,15 @@ Status EntryNode::deserialize(const tensorflow::TensorProto& proto, InferenceEng
 
     size_t tensor_count = std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<size_t>());
 
-    if (proto.tensor_content().size() != tensor_count * tensorflow::DataTypeSize(proto.dtype())) {
+    if (isPaddedContent) {
+        if (static_cast<size_t>(getRepeatedFieldValueCount(proto)) != tensor_count) {
+            std::stringstream ss;
+            ss << "Expected: " << tensor_count << "; Actual: " << getRepeatedFieldValueCount(proto);
+            const std::string details = ss.str();
+            SPDLOG_DEBUG("[Node {}] Invalid number of values in tensor proto container - {}", getName(), details);
+            return Status(StatusCode::INVALID_VALUE_COUNT, details);
+        }
+    } else if (proto.tensor_content().size() != tensor_count * tensorflow::DataTypeSize(proto.dtype())) {
         std::stringstream ss;
         ss << "Expected: " << tensor_count * tensorflow::DataTypeSize(proto.dtype()) << "; Actual: " << proto.tensor_content().size();
         const std::string details = ss.str();
@@ -89,31 +201,55 @@ Status EntryNode::deserialize(const tensorflow::TensorProto& proto, InferenceEng
     }
 
     // description.setLayout();  // Layout info is stored in model instance. If we find out it is required, then need to be set right before inference.
+    // 8 and 16 bit values are zero padded in int_val, other repeated fields are used in place
+    const void* data = isPaddedContent ? getRepeatedFieldData(proto) : proto.tensor_content().data();
     try {
         switch (proto.dtype()) {
         case tensorflow::DataType::DT_FLOAT:
             description.setPrecision(InferenceEngine::Precision::FP32);
-            blob = InferenceEngine::make_shared_blob<float>(description, (float*)proto.tensor_content().data());
+            blob = InferenceEngine::make_shared_blob<float>(description, (float*)data);
             break;
         case tensorflow::DataType::DT_UINT8:
             description.setPrecision(InferenceEngine::Precision::U8);
-            blob = InferenceEngine::make_shared_blob<uint8_t>(description, (uint8_t*)proto.tensor_content().data());
+            if (isPaddedContent) {
+                blob = allocateConvertedBlob(description);
+                convertTensorProto(proto, description.getPrecision(), blob);
+                break;
+            }
+            blob = InferenceEngine::make_shared_blob<uint8_t>(description, (uint8_t*)data);
             break;
         case tensorflow::DataType::DT_INT8:
             description.setPrecision(InferenceEngine::Precision::I8);
-            blob = InferenceEngine::make_shared_blob<int8_t>(description, (int8_t*)proto.tensor_content().data());
+            if (isPaddedContent) {
+                blob = allocateConvertedBlob(description);
+                convertTensorProto(proto, description.getPrecision(), blob);
+                break;
+            }
+            blob = InferenceEngine::make_shared_blob<int8_t>(description, (int8_t*)data);
             break;
         case tensorflow::DataType::DT_INT16:
             description.setPrecision(InferenceEngine::Precision::I16);
-            blob = InferenceEngine::make_shared_blob<int16_t>(description, (int16_t*)proto.tensor_content().data());
+            if (isPaddedContent) {
+                blob = allocateConvertedBlob(description);
+                convertTensorProto(proto, description.getPrecision(), blob);
+                break;
+            }
+            blob = InferenceEngine::make_shared_blob<int16_t>(description, (int16_t*)data);
             break;
         case tensorflow::DataType::DT_INT32:
             description.setPrecision(InferenceEngine::Precision::I32);
-            blob = InferenceEngine::make_shared_blob<int32_t>(description, (int32_t*)proto.tensor_content().data());
+            blob = InferenceEngine::make_shared_blob<int32_t>(description, (int32_t*)data);
+            break;
+        case tensorflow::DataType::DT_INT64:
+            description.setPrecision(InferenceEngine::Precision::I64);
+            blob = InferenceEngine::make_shared_blob<int64_t>(description, (int64_t*)data);
+            break;
+        case tensorflow::DataType::DT_BOOL:
+            description.setPrecision(InferenceEngine::Precision::BOOL);
+            blob = InferenceEngine::make_shared_blob<uint8_t>(description, (uint8_t*)data);
             break;
         case tensorflow::DataType::DT_HALF:
         case tensorflow::DataType::DT_UINT16:
-        case tensorflow::DataType::DT_INT64:
         default: {
             std::stringstream ss;
             ss << "Actual: " << TensorInfo::getDataTypeAsString(proto.dtype());
@@ -136,4 +272,60 @@ Status EntryNode::deserialize(const tensorflow::TensorProto& proto, InferenceEng
 
     return StatusCode::OK;
 }
+
+Status EntryNode::deserializeSharedMemory(const tensorflow::TensorProto& proto, InferenceEngine::Blob::Ptr& blob) {
+    InferenceEngine::TensorDesc description;
+    InferenceEngine::SizeVector shape;
+    for (int i = 0; i < proto.tensor_shape().dim_size(); i++) {
+        shape.emplace_back(proto.tensor_shape().dim(i).size());
+    }
+    description.setDims(shape);
+
+    // Region keeps values in network layout, 16 bit values are not padded as in repeated fields
+    switch (proto.dtype()) {
+    case tensorflow::DataType::DT_FLOAT:
+        description.setPrecision(InferenceEngine::Precision::FP32);
+        break;
+    case tensorflow::DataType::DT_HALF:
+        description.setPrecision(InferenceEngine::Precision::FP16);
+        break;
+    case tensorflow::DataType::DT_UINT8:
+        description.setPrecision(InferenceEngine::Precision::U8);
+        break;
+    case tensorflow::DataType::DT_INT8:
+        description.setPrecision(InferenceEngine::Precision::I8);
+        break;
+    case tensorflow::DataType::DT_INT16:
+        description.setPrecision(InferenceEngine::Precision::I16);
+        break;
+    case tensorflow::DataType::DT_UINT16:
+        description.setPrecision(InferenceEngine::Precision::U16);
+        break;
+    case tensorflow::DataType::DT_INT32:
+        description.setPrecision(InferenceEngine::Precision::I32);
+        break;
+    case tensorflow::DataType::DT_INT64:
+        description.setPrecision(InferenceEngine::Precision::I64);
+        break;
+    case tensorflow::DataType::DT_BOOL:
+        description.setPrecision(InferenceEngine::Precision::BOOL);
+        break;
+    default: {
+        std::stringstream ss;
+        ss << "Actual: " << TensorInfo::getDataTypeAsString(proto.dtype());
+        const std::string details = ss.str();
+        SPDLOG_DEBUG("[Node: {}] Unsupported deserialization precision - {}", getName(), details);
+        return Status(StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION, details);
+    }
+    }
+
+    try {
+        return deserializeSharedMemoryReference(proto, description, blob);
+    } catch (const InferenceEngine::details::InferenceEngineException& e) {
+        Status status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
+        SPDLOG_DEBUG("[Node: {}] Exception thrown during deserialization of shared memory reference; {}; exception message: {}",
+            getName(), status.string(), e.what());
+        return status;
+    }
+}
 }  // namespace ovms
@@ -15,6 +15,7 @@
 //*****************************************************************************
 #pragma once
 #include <string>
+#include <vector>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wall"
@@ -28,15 +29,43 @@ namespace ovms {
 
 const std::string ENTRY_NODE_NAME = "request";
 
+// Inputs converted from padded repeated fields are copied in parallel when there are several ones of at least this size
+const size_t PARALLEL_DESERIALIZATION_MIN_BYTES = 1024 * 1024;
+const size_t MAX_DESERIALIZATION_THREADS = 4;
+
 class EntryNode : public Node {
-    const tensorflow::serving::PredictRequest* request;
+    const tensorflow::serving::PredictRequest* request = nullptr;
+    const BlobMap* requestBlobs = nullptr;
 
 public:
+    EntryNode() :
+        Node(ENTRY_NODE_NAME) {}
+
     EntryNode(const tensorflow::serving::PredictRequest* request) :
         Node(ENTRY_NODE_NAME),
         request(request) {}
 
-    Status execute(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQueue) override {
+    /**
+     * @brief Passes blobs of in-process request to following nodes as they are, without deserialization
+     */
+    EntryNode(const BlobMap* requestBlobs) :
+        Node(ENTRY_NODE_NAME),
+        requestBlobs(requestBlobs) {}
+
+    /**
+     * @brief Sets request read by the node, used when node is reused by another pipeline
+     */
+    void bind(const tensorflow::serving::PredictRequest* request) {
+        this->request = request;
+        this->requestBlobs = nullptr;
+    }
+
+    void bind(const BlobMap* requestBlobs) {
+        this->request = nullptr;
+        this->requestBlobs = requestBlobs;
+    }
+
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override {
         notifyEndQueue.push(*this);
         return StatusCode::OK;
     }
@@ -50,6 +79,15 @@ public:
 
     // Deserialize proto to blob
     Status deserialize(const tensorflow::TensorProto& proto, InferenceEngine::Blob::Ptr& blob);
+
+    // Wrap shared memory region referenced by proto into blob
+    Status deserializeSharedMemory(const tensorflow::TensorProto& proto, InferenceEngine::Blob::Ptr& blob);
+
+private:
+    Status missingInput(const std::string& name) const;
+
+    Status deserializeInParallel(const std::vector<const tensorflow::TensorProto*>& protos, const std::vector<size_t>& indexes,
+        std::vector<InferenceEngine::Blob::Ptr>& blobs);
 };
 
 }  // namespace ovms
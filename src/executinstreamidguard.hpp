@@ -15,19 +15,42 @@
 //*****************************************************************************
 #pragma once
 
+#include <future>
+
+#include "deadline.hpp"
 #include "ovinferrequestsqueue.hpp"
 
 namespace ovms {
 struct ExecutingStreamIdGuard {
-    ExecutingStreamIdGuard(ovms::OVInferRequestsQueue& inferRequestsQueue) :
+    ExecutingStreamIdGuard(ovms::OVInferRequestsQueue& inferRequestsQueue, const deadline_t& deadline = NO_DEADLINE) :
         inferRequestsQueue_(inferRequestsQueue),
-        id_(inferRequestsQueue_.getIdleStream().get()) {}
+        id_(acquireStreamId(inferRequestsQueue_, deadline)) {}
     ~ExecutingStreamIdGuard() {
-        inferRequestsQueue_.returnStream(id_);
+        if (id_ != EXPIRED_STREAM_ID) {
+            inferRequestsQueue_.returnStream(id_);
+        }
     }
+    /**
+     * @brief Gets acquired stream id or EXPIRED_STREAM_ID if deadline passed while waiting for it
+     */
     int getId() { return id_; }
 
 private:
+    static int acquireStreamId(ovms::OVInferRequestsQueue& inferRequestsQueue, const deadline_t& deadline) {
+        // avoid allocating future shared state when there is an idle stream
+        auto streamId = inferRequestsQueue.tryGetIdleStream();
+        if (streamId) {
+            return streamId.value();
+        }
+        if (deadline == NO_DEADLINE) {
+            return inferRequestsQueue.getIdleStream().get();
+        }
+        std::promise<int> idleStreamPromise;
+        auto idleStreamFuture = idleStreamPromise.get_future();
+        inferRequestsQueue.getIdleStream([&idleStreamPromise](int streamId) { idleStreamPromise.set_value(streamId); }, deadline);
+        return idleStreamFuture.get();
+    }
+
     ovms::OVInferRequestsQueue& inferRequestsQueue_;
     const int id_;
 };
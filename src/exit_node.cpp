@@ -25,13 +25,27 @@
 #include "tensorflow/core/framework/tensor.h"
 #pragma GCC diagnostic pop
 
+#include "narrowing.hpp"
+#include "ov_utils.hpp"
+
 namespace ovms {
 
 Status ExitNode::fetchResults(BlobMap&) {
-    // Serialize results to proto
-    for (const auto& kv : this->inputBlobs) {
+    if (responseBlobs) {
+        // blobs received from model nodes are copies owned by the pipeline, not by infer requests
+        for (const auto& [output_name, blob] : this->inputBlobs) {
+            (*responseBlobs)[output_name] = blob;
+        }
+        return StatusCode::OK;
+    }
+    // Serialize results to proto, output precision encodings and reductions of models are not applied to pipeline outputs
+    for (auto& kv : this->inputBlobs) {
         const auto& output_name = kv.first;
         auto& blob = kv.second;
+        if (!isOutputRequested(outputFilter, output_name)) {
+            SPDLOG_DEBUG("[Node: {}] Skipping output not requested in output filter: {}", getName(), output_name);
+            continue;
+        }
         SPDLOG_DEBUG("[Node: {}] Serializing response from pipeline. Output name: {}", getName(), output_name);
         auto& proto = (*this->response->mutable_outputs())[output_name];
         auto status = serialize(blob, proto);
@@ -42,10 +56,10 @@ Status ExitNode::fetchResults(BlobMap&) {
         SPDLOG_DEBUG("[Node: {}] Serialized blob to proto: blob name {}", getName(), output_name);
     }
 
-    return StatusCode::OK;
+    return writeOutputsToSharedMemory(this->response, outputFilter);
 }
 
-Status ExitNode::serialize(const InferenceEngine::Blob::Ptr& blob, tensorflow::TensorProto& proto) {
+Status ExitNode::serialize(InferenceEngine::Blob::Ptr& blob, tensorflow::TensorProto& proto) {
     // Set size
     for (size_t dim : blob->getTensorDesc().getDims()) {
         proto.mutable_tensor_shape()->add_dim()->set_size(dim);
@@ -72,11 +86,14 @@ Status ExitNode::serialize(const InferenceEngine::Blob::Ptr& blob, tensorflow::T
         proto.set_dtype(tensorflow::DataTypeToEnum<uint32_t>::value);  // 2 byte padding [v1, v0, 0, 0, u1, u0, 0, 0, ...]
         break;
     case InferenceEngine::Precision::FP16:
-        proto.set_dtype(tensorflow::DataTypeToEnum<float>::value);  // 2 byte padding [v1, v0, 0, 0, u1, u0, 0, 0, ...]
+        proto.set_dtype(tensorflow::DataTypeToEnum<float>::value);  // widened to FP32 below
         break;
     case InferenceEngine::Precision::I64:
         proto.set_dtype(tensorflow::DataTypeToEnum<int32_t>::value);  // Manually tested that OV I64 = TF int32_t
         break;
+    case InferenceEngine::Precision::BOOL:
+        proto.set_dtype(tensorflow::DataTypeToEnum<bool>::value);
+        break;
     default:
         std::stringstream ss;
         ss << "Actual: " << TensorInfo::getPrecisionAsString(blob->getTensorDesc().getPrecision());
@@ -87,6 +104,15 @@ Status ExitNode::serialize(const InferenceEngine::Blob::Ptr& blob, tensorflow::T
     }
 
     // Set content
+    if (blob->getTensorDesc().getPrecision() == InferenceEngine::Precision::FP16) {
+        proto.mutable_tensor_content()->resize(blob->size() * sizeof(float));
+        widenFp16ToFp32(blob->buffer().as<const uint16_t*>(), reinterpret_cast<float*>(&(*proto.mutable_tensor_content())[0]), blob->size());
+        return StatusCode::OK;
+    }
+    // Blob copied out of the infer request by the last node is not referenced anymore, its memory is moved into the response
+    if (takeStringBlobStorage(blob, *proto.mutable_tensor_content())) {
+        return StatusCode::OK;
+    }
     proto.mutable_tensor_content()->assign((char*)blob->buffer(), blob->byteSize());
 
     return StatusCode::OK;
@@ -23,6 +23,7 @@
 #pragma GCC diagnostic pop
 
 #include "node.hpp"
+#include "serialization.hpp"
 #include "tensorinfo.hpp"
 
 namespace ovms {
@@ -30,17 +31,47 @@ namespace ovms {
 const std::string EXIT_NODE_NAME = "response";
 
 class ExitNode : public Node {
-    tensorflow::serving::PredictResponse* response;
+    tensorflow::serving::PredictResponse* response = nullptr;
+    const output_filter_t* outputFilter = nullptr;
+    BlobMap* responseBlobs = nullptr;
 
 public:
-    ExitNode(tensorflow::serving::PredictResponse* response) :
+    ExitNode() :
+        Node(EXIT_NODE_NAME) {
+    }
+
+    ExitNode(tensorflow::serving::PredictResponse* response, const output_filter_t* outputFilter = nullptr) :
+        Node(EXIT_NODE_NAME),
+        response(response),
+        outputFilter(outputFilter) {
+    }
+
+    /**
+     * @brief Hands received blobs to in-process request as they are, without serialization
+     */
+    ExitNode(BlobMap* responseBlobs) :
         Node(EXIT_NODE_NAME),
-        response(response) {
+        responseBlobs(responseBlobs) {
+    }
+
+    /**
+     * @brief Sets response written by the node, used when node is reused by another pipeline
+     */
+    void bind(tensorflow::serving::PredictResponse* response, const output_filter_t* outputFilter = nullptr) {
+        this->response = response;
+        this->outputFilter = outputFilter;
+        this->responseBlobs = nullptr;
+    }
+
+    void bind(BlobMap* responseBlobs) {
+        this->response = nullptr;
+        this->outputFilter = nullptr;
+        this->responseBlobs = responseBlobs;
     }
 
     // Exit node does not have execute logic.
     // It serializes its received input blobs to proto in ::fetchResults
-    Status execute(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQueue) override {
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override {
         notifyEndQueue.push(*this);
         return StatusCode::OK;
     }
@@ -52,7 +83,10 @@ public:
         throw std::logic_error("This node cannot have dependant");
     }
 
-    Status serialize(const InferenceEngine::Blob::Ptr& blob, tensorflow::TensorProto& proto);
+    /**
+     * @brief Serializes blob into proto, memory of blob allocated with allocateStringBlob and not referenced elsewhere is moved instead of copied
+     */
+    Status serialize(InferenceEngine::Blob::Ptr& blob, tensorflow::TensorProto& proto);
 };
 
 }  // namespace ovms
@@ -0,0 +1,97 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "fetchedobjects.hpp"
+
+#include <system_error>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+namespace fs = std::filesystem;
+
+std::string FetchedObjects::getKey(const std::string& contentId, uint64_t size) {
+    return contentId + ":" + std::to_string(size);
+}
+
+bool FetchedObjects::reuse(const std::string& contentId, uint64_t size, const std::string& localPath) {
+    if (contentId.empty()) {
+        return false;
+    }
+    LocalFile file;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = files.find(getKey(contentId, size));
+        if (it == files.end()) {
+            return false;
+        }
+        std::error_code error;
+        if (fs::file_size(it->second.path, error) != size || error ||
+            fs::last_write_time(it->second.path, error) != it->second.modificationTime || error) {
+            SPDLOG_DEBUG("Local copy of object {} changed: {}", contentId, it->second.path);
+            files.erase(it);
+            return false;
+        }
+        file = it->second;
+    }
+    if (file.path == localPath) {
+        return true;
+    }
+    std::error_code error;
+    fs::remove(localPath, error);
+    // versions are never modified in place, so they can share inodes
+    fs::create_hard_link(file.path, localPath, error);
+    if (error) {
+        error.clear();
+        fs::copy_file(file.path, localPath, fs::copy_options::overwrite_existing, error);
+    }
+    if (error) {
+        SPDLOG_DEBUG("Cannot reuse local copy {} of object {}: {}", file.path, contentId, error.message());
+        return false;
+    }
+    SPDLOG_DEBUG("Reused local copy {} of object {} as {}", file.path, contentId, localPath);
+    return true;
+}
+
+void FetchedObjects::add(const std::string& contentId, uint64_t size, const std::string& localPath) {
+    if (contentId.empty()) {
+        return;
+    }
+    std::error_code error;
+    const auto modificationTime = fs::last_write_time(localPath, error);
+    if (error) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    files[getKey(contentId, size)] = {localPath, modificationTime};
+}
+
+void FetchedObjects::relocate(const std::string& fromDirectory, const std::string& toDirectory) {
+    const std::string prefix = fromDirectory + "/";
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [key, file] : files) {
+        if (file.path.compare(0, prefix.size(), prefix) == 0) {
+            file.path = toDirectory + "/" + file.path.substr(prefix.size());
+        }
+    }
+}
+
+size_t FetchedObjects::getCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return files.size();
+}
+
+}  // namespace ovms
@@ -0,0 +1,77 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ovms {
+
+/**
+ * @brief Local files of objects already downloaded from cloud storage, identified by their content, e.g. ETag or MD5 hash,
+ * and size. Downloading model versions links or copies unchanged objects from earlier downloads, so that only new
+ * and changed files are transferred.
+ *
+ * Files modified or removed after they were added are detected by their size and modification time and forgotten.
+ */
+class FetchedObjects {
+public:
+    static FetchedObjects& instance() {
+        static FetchedObjects instance;
+        return instance;
+    }
+
+    /**
+     * @brief Hard links or copies local file of the same object into local path
+     *
+     * @param contentId identifier of object content, objects without one are never reused
+     * @param size
+     * @param localPath replaced if it exists
+     *
+     * @return true if object was reused and does not need to be downloaded
+     */
+    bool reuse(const std::string& contentId, uint64_t size, const std::string& localPath);
+
+    /**
+     * @brief Remembers downloaded file as a local copy of the object
+     */
+    void add(const std::string& contentId, uint64_t size, const std::string& localPath);
+
+    /**
+     * @brief Updates paths of files moved together with their directory
+     */
+    void relocate(const std::string& fromDirectory, const std::string& toDirectory);
+
+    size_t getCount() const;
+
+private:
+    FetchedObjects() = default;
+
+    struct LocalFile {
+        std::string path;
+        std::filesystem::file_time_type modificationTime;
+    };
+
+    static std::string getKey(const std::string& contentId, uint64_t size);
+
+    mutable std::mutex mutex;
+    std::map<std::string, LocalFile> files;
+};
+
+}  // namespace ovms
@@ -15,9 +15,12 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <spdlog/spdlog.h>
@@ -92,6 +95,28 @@ public:
      */
     virtual StatusCode readTextFile(const std::string& path, std::string* contents) = 0;
 
+    /**
+     * @brief Read the whole content of the given binary file into memory, used when loading models without local copies
+     * 
+     * @param path 
+     * @param contents 
+     * @return StatusCode 
+     */
+    virtual StatusCode readFileToMemory(const std::string& path, std::string* contents) {
+        return readTextFile(path, contents);
+    }
+
+    /**
+     * @brief Write the whole content of the given file, replacing it when it exists. Used to store results of bulk inference jobs.
+     * 
+     * @param path 
+     * @param contents 
+     * @return StatusCode NOT_IMPLEMENTED when storage does not support it
+     */
+    virtual StatusCode writeFile(const std::string& path, const std::string& contents) {
+        return StatusCode::NOT_IMPLEMENTED;
+    }
+
     /**
      * @brief Download a remote directory
      * 
@@ -111,6 +136,38 @@ public:
     */
     virtual StatusCode downloadModelVersions(const std::string& path, std::string* local_path, const std::vector<model_version_t>& versions) = 0;
 
+    /**
+    * @brief Describes remote objects of model version with metadata-only requests, e.g. their names with ETags
+    * or generations, so that a local copy can be validated without downloading it again
+    *
+    * @param path
+    * @param version
+    * @param fingerprint changes whenever any of the version files changes
+    * @return StatusCode NOT_IMPLEMENTED when storage cannot identify its objects, versions are not cached then
+    */
+    virtual StatusCode getVersionFingerprint(const std::string& path, model_version_t version, std::string* fingerprint) {
+        return StatusCode::NOT_IMPLEMENTED;
+    }
+
+    /**
+    * @brief Lists urls of all objects under the prefix with as few requests as the storage allows
+    *
+    * @param path
+    * @param keys
+    * @param maxKeys listing is abandoned when there are more objects
+    * @return StatusCode NOT_IMPLEMENTED when storage does not support it
+    */
+    virtual StatusCode listObjectKeys(const std::string& path, std::vector<std::string>* keys, size_t maxKeys) {
+        return StatusCode::NOT_IMPLEMENTED;
+    }
+
+    /**
+     * @brief Name of the storage backend reported in download statistics
+     */
+    virtual const char* getBackendName() const {
+        return "local";
+    }
+
     /**
      * @brief Delete a folder
      *
@@ -141,6 +198,46 @@ public:
         return StatusCode::OK;
     }
 
+    /**
+     * @brief Reads positive download setting of cloud storage backends from environment variable
+     *
+     * @param name of environment variable
+     * @param defaultValue used when variable is not set or invalid
+     * @return size_t
+     */
+    static size_t getDownloadSetting(const char* name, size_t defaultValue) {
+        const char* value = std::getenv(name);
+        if (value == nullptr) {
+            return defaultValue;
+        }
+        try {
+            const long long parsed = std::stoll(value);
+            if (parsed > 0) {
+                return static_cast<size_t>(parsed);
+            }
+        } catch (const std::exception&) {
+        }
+        SPDLOG_WARN("Invalid value of {}: {}, using default: {}", name, value, defaultValue);
+        return defaultValue;
+    }
+
+    /**
+     * @brief Splits objects into ranges of at most part size for parallel ranged reads, empty objects get no part
+     *
+     * @param sizes of objects in bytes
+     * @param partSize
+     * @return pairs of object index and range offset, each range ends where the next one of the object starts
+     */
+    static std::vector<std::pair<size_t, uint64_t>> splitIntoParts(const std::vector<uint64_t>& sizes, uint64_t partSize) {
+        std::vector<std::pair<size_t, uint64_t>> parts;
+        for (size_t object = 0; object < sizes.size(); ++object) {
+            for (uint64_t offset = 0; offset < sizes[object]; offset += partSize) {
+                parts.emplace_back(object, offset);
+            }
+        }
+        return parts;
+    }
+
     static bool isPathEscaped(const std::string& path) {
         return std::string::npos != path.find("../") || std::string::npos != path.find("/..");
     }
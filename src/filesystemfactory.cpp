@@ -0,0 +1,42 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "filesystemfactory.hpp"
+
+#include "azurefilesystem.hpp"
+#include "gcsfilesystem.hpp"
+#include "instrumentedfilesystem.hpp"
+#include "localfilesystem.hpp"
+#include "s3filesystem.hpp"
+
+namespace ovms {
+
+std::shared_ptr<FileSystem> createFilesystem(const std::string& basePath) {
+    if (basePath.rfind(S3FileSystem::S3_URL_PREFIX, 0) == 0) {
+        return std::make_shared<InstrumentedFileSystem>(S3FileSystem::getShared(basePath));
+    }
+    if (basePath.rfind(GCSFileSystem::GCS_URL_PREFIX, 0) == 0) {
+        return std::make_shared<InstrumentedFileSystem>(GCSFileSystem::getShared());
+    }
+    if (basePath.rfind(AzureFileSystem::AZURE_URL_FILE_PREFIX, 0) == 0) {
+        return std::make_shared<InstrumentedFileSystem>(std::make_shared<AzureFileSystem>());
+    }
+    if (basePath.rfind(AzureFileSystem::AZURE_URL_BLOB_PREFIX, 0) == 0) {
+        return std::make_shared<InstrumentedFileSystem>(std::make_shared<AzureFileSystem>());
+    }
+    return std::make_shared<InstrumentedFileSystem>(std::make_shared<LocalFileSystem>());
+}
+
+}  // namespace ovms
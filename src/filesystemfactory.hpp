@@ -0,0 +1,36 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "filesystem.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Creates the file system matching the scheme of the given path
+ *
+ * Calls made through the returned file system are reported in storage metrics.
+ *
+ * @param basePath local path or s3://, gs://, az://, azfs:// url
+ *
+ * @return file system able to access basePath
+ */
+std::shared_ptr<FileSystem> createFilesystem(const std::string& basePath);
+
+}  // namespace ovms
@@ -0,0 +1,101 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "filesystemmetrics.hpp"
+
+namespace ovms {
+
+FileSystemMetrics& FileSystemMetrics::instance() {
+    static FileSystemMetrics instance;
+    return instance;
+}
+
+const char* toString(FileSystemOperation operation) {
+    switch (operation) {
+    case FileSystemOperation::FILE_EXISTS:
+        return "file_exists";
+    case FileSystemOperation::IS_DIRECTORY:
+        return "is_directory";
+    case FileSystemOperation::GET_DIRECTORY_CONTENTS:
+        return "get_directory_contents";
+    case FileSystemOperation::GET_DIRECTORY_SUBDIRS:
+        return "get_directory_subdirs";
+    case FileSystemOperation::GET_DIRECTORY_FILES:
+        return "get_directory_files";
+    case FileSystemOperation::READ_TEXT_FILE:
+        return "read_text_file";
+    case FileSystemOperation::READ_FILE_TO_MEMORY:
+        return "read_file_to_memory";
+    case FileSystemOperation::WRITE_FILE:
+        return "write_file";
+    case FileSystemOperation::DOWNLOAD_FILE_FOLDER:
+        return "download_file_folder";
+    case FileSystemOperation::DOWNLOAD_MODEL_VERSIONS:
+        return "download_model_versions";
+    case FileSystemOperation::GET_VERSION_FINGERPRINT:
+        return "get_version_fingerprint";
+    case FileSystemOperation::LIST_OBJECT_KEYS:
+        return "list_object_keys";
+    case FileSystemOperation::DELETE_FILE_FOLDER:
+        return "delete_file_folder";
+    default:
+        return "unknown";
+    }
+}
+
+std::shared_ptr<FileSystemMetrics::Backend> FileSystemMetrics::getBackend(const std::string& backend) {
+    // file system calls are done by model management, lookup under lock is not on the inference path
+    std::unique_lock<std::mutex> lock(backendsMtx);
+    auto& entry = backends[backend];
+    if (entry == nullptr) {
+        entry = std::make_shared<Backend>();
+    }
+    return entry;
+}
+
+void FileSystemMetrics::recordOperation(const std::string& backend, FileSystemOperation operation, uint64_t microseconds, bool succeeded, uint64_t bytes) {
+    auto backendMetrics = getBackend(backend);
+    auto& metrics = backendMetrics->operations[static_cast<size_t>(operation)];
+    metrics.calls.record(microseconds);
+    if (!succeeded) {
+        metrics.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    metrics.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void FileSystemMetrics::recordRetry(const std::string& backend) {
+    getBackend(backend)->retries.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FileSystemMetrics::recordDownloadSince(const std::string& backend, std::chrono::steady_clock::time_point start, bool succeeded) {
+    auto metrics = getBackend(backend);
+    if (succeeded) {
+        metrics->downloads.recordSince(start);
+    } else {
+        metrics->failures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<const FileSystemMetrics::Backend>>> FileSystemMetrics::getBackends() const {
+    std::unique_lock<std::mutex> lock(backendsMtx);
+    std::vector<std::pair<std::string, std::shared_ptr<const Backend>>> result;
+    result.reserve(backends.size());
+    for (const auto& [name, metrics] : backends) {
+        result.emplace_back(name, metrics);
+    }
+    return result;
+}
+
+}  // namespace ovms
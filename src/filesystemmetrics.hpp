@@ -0,0 +1,98 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "latencyhistogram.hpp"
+
+namespace ovms {
+
+/**
+ * @brief File system calls measured for each storage backend
+ */
+enum class FileSystemOperation {
+    FILE_EXISTS,
+    IS_DIRECTORY,
+    GET_DIRECTORY_CONTENTS,
+    GET_DIRECTORY_SUBDIRS,
+    GET_DIRECTORY_FILES,
+    READ_TEXT_FILE,
+    READ_FILE_TO_MEMORY,
+    WRITE_FILE,
+    DOWNLOAD_FILE_FOLDER,
+    DOWNLOAD_MODEL_VERSIONS,
+    GET_VERSION_FINGERPRINT,
+    LIST_OBJECT_KEYS,
+    DELETE_FILE_FOLDER,
+    COUNT
+};
+
+const char* toString(FileSystemOperation operation);
+
+/**
+ * @brief Durations and failures of model downloads and of file system calls of each storage backend, kept since the server started
+ */
+class FileSystemMetrics {
+public:
+    struct Operation {
+        LatencyHistogram calls;
+        std::atomic<uint64_t> errors{0};
+        // contents read or size of local copies made by the calls
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    struct Backend {
+        LatencyHistogram downloads;
+        std::atomic<uint64_t> failures{0};
+        std::array<Operation, static_cast<size_t>(FileSystemOperation::COUNT)> operations;
+        // requests repeated by the storage client after transient errors or throttling
+        std::atomic<uint64_t> retries{0};
+    };
+
+    static FileSystemMetrics& instance();
+
+    void recordDownloadSince(const std::string& backend, std::chrono::steady_clock::time_point start, bool succeeded);
+
+    /**
+     * @brief Records a file system call, failed calls count as errors and are also included in durations
+     */
+    void recordOperation(const std::string& backend, FileSystemOperation operation, uint64_t microseconds, bool succeeded, uint64_t bytes);
+
+    void recordRetry(const std::string& backend);
+
+    /**
+     * @brief Gives backends which were used, ordered by name
+     */
+    std::vector<std::pair<std::string, std::shared_ptr<const Backend>>> getBackends() const;
+
+private:
+    std::shared_ptr<Backend> getBackend(const std::string& backend);
+
+    mutable std::mutex backendsMtx;
+    std::map<std::string, std::shared_ptr<Backend>> backends;
+};
+
+}  // namespace ovms
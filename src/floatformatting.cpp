@@ -0,0 +1,371 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "floatformatting.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace ovms {
+
+namespace {
+
+// Shortest float representation follows Ryu algorithm by Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018.
+constexpr int FLOAT_MANTISSA_BITS = 23;
+constexpr int FLOAT_EXPONENT_BITS = 8;
+constexpr int FLOAT_BIAS = 127;
+constexpr int FLOAT_POW5_INV_BITCOUNT = 59;
+constexpr int FLOAT_POW5_BITCOUNT = 61;
+
+// floor(2^(bitlength(5^i) - 1 + FLOAT_POW5_INV_BITCOUNT) / 5^i) + 1
+constexpr uint64_t FLOAT_POW5_INV_SPLIT[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u,
+    295147905179352826u, 472236648286964522u, 377789318629571618u,
+    302231454903657294u, 483570327845851670u, 386856262276681336u,
+    309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u,
+    324518553658426727u, 519229685853482763u, 415383748682786211u,
+    332306998946228969u, 531691198313966350u, 425352958651173080u,
+    340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u,
+    356811923176489971u, 570899077082383953u, 456719261665907162u,
+    365375409332725730u,
+};
+
+// floor(5^i / 2^(bitlength(5^i) - FLOAT_POW5_BITCOUNT))
+constexpr uint64_t FLOAT_POW5_SPLIT[47] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u,
+    2251799813685248000u, 1407374883553280000u, 1759218604441600000u,
+    2199023255552000000u, 1374389534720000000u, 1717986918400000000u,
+    2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+    2048000000000000000u, 1280000000000000000u, 1600000000000000000u,
+    2000000000000000000u, 1250000000000000000u, 1562500000000000000u,
+    1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u,
+    1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+    1818989403545856475u, 2273736754432320594u, 1421085471520200371u,
+    1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u,
+    1694065894508600678u, 2117582368135750847u, 1323488980084844279u,
+    1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+    1615587133892632177u, 2019483917365790221u,
+};
+
+/**
+ * @brief Returns number of bits of 5^e, valid for 0 <= e <= 3528
+ */
+inline int32_t pow5bits(int32_t e) {
+    return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+/**
+ * @brief Returns floor(log10(2^e)), valid for 0 <= e <= 1650
+ */
+inline uint32_t log10Pow2(int32_t e) {
+    return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+/**
+ * @brief Returns floor(log10(5^e)), valid for 0 <= e <= 2620
+ */
+inline uint32_t log10Pow5(int32_t e) {
+    return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+inline uint32_t pow5Factor(uint32_t value) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+inline bool multipleOfPowerOf5(uint32_t value, uint32_t p) {
+    return pow5Factor(value) >= p;
+}
+
+inline bool multipleOfPowerOf2(uint32_t value, uint32_t p) {
+    return (value & ((1u << p) - 1)) == 0;
+}
+
+inline uint32_t mulShift(uint32_t m, uint64_t factor, int32_t shift) {
+    const uint64_t bits0 = static_cast<uint64_t>(m) * static_cast<uint32_t>(factor);
+    const uint64_t bits1 = static_cast<uint64_t>(m) * static_cast<uint32_t>(factor >> 32);
+    const uint64_t sum = (bits0 >> 32) + bits1;
+    return static_cast<uint32_t>(sum >> (shift - 32));
+}
+
+/**
+ * @brief Computes shortest digits and decimal exponent of finite, non zero float, value = digits * 10^exponent
+ */
+void shortestFloatDigits(uint32_t ieeeMantissa, uint32_t ieeeExponent, uint32_t& digits, int32_t& exponent) {
+    int32_t e2;
+    uint32_t m2;
+    if (ieeeExponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieeeMantissa;
+    } else {
+        e2 = static_cast<int32_t>(ieeeExponent) - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+    }
+    const bool acceptBounds = (m2 & 1) == 0;
+
+    // Interval of values rounding to this float
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+    const uint32_t mm = 4 * m2 - 1 - mmShift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    uint8_t lastRemovedDigit = 0;
+    if (e2 >= 0) {
+        const uint32_t q = log10Pow2(e2);
+        e10 = static_cast<int32_t>(q);
+        const int32_t k = FLOAT_POW5_INV_BITCOUNT + pow5bits(q) - 1;
+        const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+        vr = mulShift(mv, FLOAT_POW5_INV_SPLIT[q], i);
+        vp = mulShift(mp, FLOAT_POW5_INV_SPLIT[q], i);
+        vm = mulShift(mm, FLOAT_POW5_INV_SPLIT[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            const int32_t l = FLOAT_POW5_INV_BITCOUNT + pow5bits(q - 1) - 1;
+            lastRemovedDigit = static_cast<uint8_t>(mulShift(mv, FLOAT_POW5_INV_SPLIT[q - 1], -e2 + static_cast<int32_t>(q) - 1 + l) % 10);
+        }
+        if (q <= 9) {
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+            } else if (acceptBounds) {
+                vmIsTrailingZeros = multipleOfPowerOf5(mm, q);
+            } else {
+                vp -= multipleOfPowerOf5(mp, q);
+            }
+        }
+    } else {
+        const uint32_t q = log10Pow5(-e2);
+        e10 = static_cast<int32_t>(q) + e2;
+        const int32_t i = -e2 - static_cast<int32_t>(q);
+        const int32_t k = pow5bits(i) - FLOAT_POW5_BITCOUNT;
+        int32_t j = static_cast<int32_t>(q) - k;
+        vr = mulShift(mv, FLOAT_POW5_SPLIT[i], j);
+        vp = mulShift(mp, FLOAT_POW5_SPLIT[i], j);
+        vm = mulShift(mm, FLOAT_POW5_SPLIT[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = static_cast<int32_t>(q) - 1 - (pow5bits(i + 1) - FLOAT_POW5_BITCOUNT);
+            lastRemovedDigit = static_cast<uint8_t>(mulShift(mv, FLOAT_POW5_SPLIT[i + 1], j) % 10);
+        }
+        if (q <= 1) {
+            vrIsTrailingZeros = true;
+            if (acceptBounds) {
+                vmIsTrailingZeros = mmShift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 31) {
+            vrIsTrailingZeros = multipleOfPowerOf2(mv, q - 1);
+        }
+    }
+
+    // Remove digits as long as the shortened value stays within the interval
+    int32_t removed = 0;
+    uint32_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = static_cast<uint8_t>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            // Round even if the exact value is .....50..0
+            lastRemovedDigit = 4;
+        }
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        while (vp / 10 > vm / 10) {
+            lastRemovedDigit = static_cast<uint8_t>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || lastRemovedDigit >= 5);
+    }
+    digits = output;
+    exponent = e10 + removed;
+}
+
+char* writeExponent(int exponent, char* buffer) {
+    if (exponent < 0) {
+        *buffer++ = '-';
+        exponent = -exponent;
+    }
+    if (exponent >= 100) {
+        *buffer++ = static_cast<char>('0' + exponent / 100);
+        exponent %= 100;
+        *buffer++ = static_cast<char>('0' + exponent / 10);
+        *buffer++ = static_cast<char>('0' + exponent % 10);
+    } else if (exponent >= 10) {
+        *buffer++ = static_cast<char>('0' + exponent / 10);
+        *buffer++ = static_cast<char>('0' + exponent % 10);
+    } else {
+        *buffer++ = static_cast<char>('0' + exponent);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Places decimal point or exponent into digits already written at the beginning of buffer,
+ * the same way rapidjson writer does, value = digits * 10^exponent
+ *
+ * @return end of written number
+ */
+char* prettify(char* buffer, int length, int exponent) {
+    const int pointPosition = length + exponent;
+    if (exponent >= 0 && pointPosition <= 21) {
+        // 1234e7 -> 12340000000.0
+        std::memset(buffer + length, '0', exponent);
+        buffer[pointPosition] = '.';
+        buffer[pointPosition + 1] = '0';
+        return buffer + pointPosition + 2;
+    }
+    if (pointPosition > 0 && pointPosition <= 21) {
+        // 1234e-2 -> 12.34
+        std::memmove(buffer + pointPosition + 1, buffer + pointPosition, length - pointPosition);
+        buffer[pointPosition] = '.';
+        return buffer + length + 1;
+    }
+    if (pointPosition > -6 && pointPosition <= 0) {
+        // 1234e-6 -> 0.001234
+        const int offset = 2 - pointPosition;
+        std::memmove(buffer + offset, buffer, length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        std::memset(buffer + 2, '0', offset - 2);
+        return buffer + length + offset;
+    }
+    if (length == 1) {
+        // 1e30
+        buffer[1] = 'e';
+        return writeExponent(pointPosition - 1, buffer + 2);
+    }
+    // 1234e30 -> 1.234e33
+    std::memmove(buffer + 2, buffer + 1, length - 1);
+    buffer[1] = '.';
+    buffer[length + 1] = 'e';
+    return writeExponent(pointPosition - 1, buffer + length + 2);
+}
+
+/**
+ * @brief Writes zero or non finite value, returns 0 for other values
+ */
+template <typename T>
+size_t formatSpecialValue(T value, char* buffer) {
+    const char* text = nullptr;
+    if (std::isnan(value)) {
+        text = "NaN";
+    } else if (std::isinf(value)) {
+        text = value < 0 ? "-Infinity" : "Infinity";
+    } else if (value == 0) {
+        text = std::signbit(value) ? "-0.0" : "0.0";
+    } else {
+        return 0;
+    }
+    const size_t length = std::strlen(text);
+    std::memcpy(buffer, text, length);
+    return length;
+}
+
+}  // namespace
+
+size_t formatFloat(float value, char* buffer) {
+    size_t length = formatSpecialValue(value, buffer);
+    if (length != 0) {
+        return length;
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char* begin = buffer;
+    if (bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) {
+        *buffer++ = '-';
+    }
+    uint32_t digits;
+    int32_t exponent;
+    shortestFloatDigits(bits & ((1u << FLOAT_MANTISSA_BITS) - 1),
+        (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1),
+        digits, exponent);
+    char reversed[10];
+    int digitsCount = 0;
+    do {
+        reversed[digitsCount++] = static_cast<char>('0' + digits % 10);
+        digits /= 10;
+    } while (digits != 0);
+    for (int i = 0; i < digitsCount; i++) {
+        buffer[i] = reversed[digitsCount - 1 - i];
+    }
+    return prettify(buffer, digitsCount, exponent) - begin;
+}
+
+size_t formatDouble(double value, char* buffer) {
+    size_t length = formatSpecialValue(value, buffer);
+    if (length != 0) {
+        return length;
+    }
+    // d.ddde[+-]x with up to 17 significant digits, fewer are used when they parse back to the same value
+    char scientific[FORMATTED_NUMBER_BUFFER_SIZE];
+    for (int precision = 15; precision <= 17; precision++) {
+        std::snprintf(scientific, sizeof(scientific), "%.*e", precision - 1, value);
+        if (precision == 17 || std::strtod(scientific, nullptr) == value) {
+            break;
+        }
+    }
+    char* begin = buffer;
+    const char* source = scientific;
+    if (*source == '-') {
+        *buffer++ = *source++;
+    }
+    int digitsCount = 0;
+    for (; *source != 'e'; source++) {
+        if (*source != '.') {
+            buffer[digitsCount++] = *source;
+        }
+    }
+    const int scientificExponent = std::atoi(source + 1);
+    while (digitsCount > 1 && buffer[digitsCount - 1] == '0') {
+        digitsCount--;
+    }
+    return prettify(buffer, digitsCount, scientificExponent - digitsCount + 1) - begin;
+}
+
+}  // namespace ovms
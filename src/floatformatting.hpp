@@ -0,0 +1,53 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+
+namespace ovms {
+
+/**
+ * @brief Size of buffer sufficient for any value written by formatFloat and formatDouble
+ */
+constexpr size_t FORMATTED_NUMBER_BUFFER_SIZE = 32;
+
+/**
+ * @brief Writes shortest decimal representation of float value which parses back to the same value
+ *
+ * Numbers are written in the same notation as rapidjson writer uses for doubles, e.g. 5.0, 0.001, 1e30, 1.5e-7.
+ * Non finite values are written as NaN, Infinity and -Infinity literals accepted by JSON parsers of TensorFlow Serving.
+ *
+ * @param value
+ * @param buffer destination of at least FORMATTED_NUMBER_BUFFER_SIZE bytes, not null terminated
+ *
+ * @return number of characters written
+ */
+size_t formatFloat(float value, char* buffer);
+
+/**
+ * @brief Writes decimal representation of double value which parses back to the same value
+ *
+ * Notation is the same as in formatFloat. Up to 17 significant digits are written, shortest representation
+ * is not searched for since double precision outputs are rare.
+ *
+ * @param value
+ * @param buffer destination of at least FORMATTED_NUMBER_BUFFER_SIZE bytes, not null terminated
+ *
+ * @return number of characters written
+ */
+size_t formatDouble(double value, char* buffer);
+
+}  // namespace ovms
@@ -0,0 +1,194 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "fused_node.hpp"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <inference_engine.hpp>
+#include <spdlog/spdlog.h>
+
+#include "logging.hpp"
+#include "ov_utils.hpp"
+#include "ovinferrequestsqueue.hpp"
+
+namespace ovms {
+
+Status FusedNode::execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
+    if (this->nodeStreamIdGuard == nullptr) {
+        if (this->metrics != nullptr) {
+            this->streamWaitStart = std::chrono::steady_clock::now();
+        }
+        auto onStreamIdReady = [this, &notifyEndQueue]() {
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Stream Id assigned to deferred node", getName());
+            notifyEndQueue.push(*this);
+        };
+        this->nodeStreamIdGuard = std::make_unique<NodeStreamIdGuard>(this->network->getInferRequestsQueue(), std::move(onStreamIdReady), getPriority(), getDeadline());
+        if (this->nodeStreamIdGuard->isDeferred()) {
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Could not acquire stream Id right away", getName());
+            return StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET;
+        }
+    }
+    auto streamId = this->nodeStreamIdGuard->tryGetId();
+    if (!streamId) {
+        if (this->nodeStreamIdGuard->isExpired()) {
+            OVMS_HOT_PATH_DEBUG("[Node: {}] Deadline passed while waiting for stream Id", getName());
+            notifyEndQueue.push(*this);
+            return StatusCode::DEADLINE_EXCEEDED;
+        }
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Stream Id is not assigned yet", getName());
+        return StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET;
+    }
+    if (this->metrics != nullptr) {
+        this->metrics->recordSince(NodeStage::STREAM_WAIT, this->streamWaitStart);
+    }
+    auto& inferRequest = this->network->getInferRequestsQueue().getInferRequest(streamId.value());
+    Status status;
+    {
+        StageTimer timer(this->metrics, NodeStage::INPUT_SETUP);
+        status = setInputsForInference(inferRequest);
+    }
+    if (!status.ok()) {
+        notifyEndQueue.push(*this);
+        return status;
+    }
+    try {
+        inferRequest.SetCompletionCallback([this, &notifyEndQueue, &inferRequest]() {
+            OVMS_HOT_PATH_DEBUG("Completion callback received for node name: {}", this->getName());
+            if (this->metrics != nullptr) {
+                this->metrics->recordSince(NodeStage::INFERENCE, this->inferenceStart);
+            }
+            this->inputBlobs.clear();
+            notifyEndQueue.push(*this);
+            inferRequest.SetCompletionCallback([]() {});
+        });
+        if (this->metrics != nullptr) {
+            this->inferenceStart = std::chrono::steady_clock::now();
+        }
+        inferRequest.StartAsync();
+    } catch (const std::exception& e) {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Exception occured when starting async inference of fused network: {}, error: {}",
+            getName(), this->network->getName(), e.what());
+        notifyEndQueue.push(*this);
+        return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+    }
+    return StatusCode::OK;
+}
+
+Status FusedNode::setInputsForInference(InferenceEngine::InferRequest& inferRequest) {
+    const auto& inputsInfo = this->network->getInputsInfo();
+    try {
+        for (const auto& [name, blob] : this->inputBlobs) {
+            auto it = inputsInfo.find(name);
+            if (it == inputsInfo.end()) {
+                SPDLOG_WARN("[Node: {}] Cannot find input: {} of fused network", getName(), name);
+                return StatusCode::INTERNAL_ERROR;
+            }
+            const auto& info = *it->second;
+            // models of fused network are not reshaped or converting inputs, blobs have to match the network
+            if (info.getPrecision() != blob->getTensorDesc().getPrecision()) {
+                return Status::withDetails(StatusCode::INVALID_PRECISION,
+                    "Expected: ", info.getPrecisionAsString(), "; Actual: ", TensorInfo::getPrecisionAsString(blob->getTensorDesc().getPrecision()));
+            }
+            const auto& dims = blob->getTensorDesc().getDims();
+            if (shape_t(dims.begin(), dims.end()) != info.getShape()) {
+                return Status::withDetails(StatusCode::INVALID_SHAPE,
+                    "Expected: ", TensorInfo::shapeToString(info.getShape()), "; Actual: ", TensorInfo::shapeToString(shape_t(dims.begin(), dims.end())));
+            }
+            inferRequest.SetBlob(info.getName(), blob);
+        }
+    } catch (const std::exception& e) {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Setting inputs of fused network failed; exception message: {}", getName(), e.what());
+        return StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
+    }
+    return StatusCode::OK;
+}
+
+Status FusedNode::fetchResults(BlobMap& outputs) {
+    StageTimer timer(this->metrics, NodeStage::FETCH_RESULTS);
+    auto streamId = this->nodeStreamIdGuard != nullptr ? this->nodeStreamIdGuard->tryGetId() : std::nullopt;
+    if (!streamId) {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Fetching results failed - node had stream Id never assigned", getName());
+        return StatusCode::UNKNOWN_ERROR;
+    }
+    auto& inferRequest = this->network->getInferRequestsQueue().getInferRequest(streamId.value());
+    auto ovStatus = inferRequest.Wait(InferenceEngine::IInferRequest::RESULT_READY);
+    this->inputBlobs.clear();
+    if (ovStatus != InferenceEngine::StatusCode::OK) {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Async infer of fused network failed; OV StatusCode: {}", getName(), ovStatus);
+        return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+    }
+    const auto& outputsInfo = this->network->getOutputsInfo();
+    // several aliases can point to the same output, which can be taken from infer request only once
+    std::unordered_map<std::string, InferenceEngine::Blob::Ptr> takenBlobs;
+    for (const auto& outputName : getRequiredOutputNames()) {
+        if (outputs.count(outputName) == 1) {
+            continue;
+        }
+        auto aliasIt = this->nodeOutputNameAlias.find(outputName);
+        const auto& modelOutputName = aliasIt == this->nodeOutputNameAlias.end() ? outputName : aliasIt->second;
+        auto outputIt = outputsInfo.find(modelOutputName);
+        if (outputIt == outputsInfo.end()) {
+            SPDLOG_WARN("[Node: {}] Cannot find output of fused network for alias {}", getName(), outputName);
+            return StatusCode::INTERNAL_ERROR;
+        }
+        const auto& realOutputName = outputIt->second->getName();
+        auto takenBlobIt = takenBlobs.find(realOutputName);
+        if (takenBlobIt == takenBlobs.end()) {
+            InferenceEngine::Blob::Ptr blob;
+            auto status = takeOutputBlob(inferRequest, realOutputName, blob);
+            if (!status.ok()) {
+                return status;
+            }
+            takenBlobIt = takenBlobs.emplace(realOutputName, std::move(blob)).first;
+        }
+        outputs.emplace(outputName, takenBlobIt->second);
+    }
+    this->release();
+    return StatusCode::OK;
+}
+
+Status FusedNode::takeOutputBlob(InferenceEngine::InferRequest& inferRequest, const std::string& realOutputName, InferenceEngine::Blob::Ptr& blob) {
+    try {
+        auto resultBlob = inferRequest.GetBlob(realOutputName);
+        // result is taken away from infer request and replaced with spare blob, as model nodes do
+        auto& outputBlobPool = this->network->getInferRequestsQueue().getOutputBlobPool();
+        auto replacement = outputBlobPool.acquire(realOutputName, resultBlob->getTensorDesc());
+        if (replacement) {
+            inferRequest.SetBlob(realOutputName, replacement);
+            blob = outputBlobPool.wrap(realOutputName, std::move(resultBlob));
+            return StatusCode::OK;
+        }
+        return blobClone(blob, resultBlob);
+    } catch (const std::exception& e) {
+        OVMS_HOT_PATH_DEBUG("[Node: {}] Error during getting blob {}; exception message: {}", getName(), realOutputName, e.what());
+        return StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+    }
+}
+
+std::vector<std::string> FusedNode::getRequiredOutputNames() const {
+    std::vector<std::string> names;
+    for (const auto& node : this->next) {
+        for (const auto& pair : node.get().getMappingByDependency(*this)) {
+            names.push_back(pair.first);
+        }
+    }
+    return names;
+}
+
+}  // namespace ovms
@@ -0,0 +1,73 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fusednetwork.hpp"
+#include "node.hpp"
+#include "nodestreamidguard.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Infers a chain of pipeline models fused into one network, replaces DL nodes of the chain
+ *
+ * Node takes name and output aliases of the last model node of the chain and inputs of the first one.
+ */
+class FusedNode : public Node {
+    std::shared_ptr<FusedNetwork> network;
+    const std::unordered_map<std::string, std::string> nodeOutputNameAlias;
+    std::unique_ptr<NodeStreamIdGuard> nodeStreamIdGuard;
+
+    // measured only when node has metrics set
+    std::chrono::steady_clock::time_point streamWaitStart;
+    std::chrono::steady_clock::time_point inferenceStart;
+
+public:
+    FusedNode(const std::string& nodeName, std::shared_ptr<FusedNetwork> network, std::unordered_map<std::string, std::string> nodeOutputNameAlias = {}) :
+        Node(nodeName),
+        network(std::move(network)),
+        nodeOutputNameAlias(std::move(nodeOutputNameAlias)) {
+    }
+
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override;
+
+    Status fetchResults(BlobMap& outputs) override;
+
+    void release() override {
+        this->nodeStreamIdGuard.reset();
+    }
+
+    void reset() override {
+        release();
+        Node::reset();
+    }
+
+private:
+    Status setInputsForInference(InferenceEngine::InferRequest& inferRequest);
+
+    Status takeOutputBlob(InferenceEngine::InferRequest& inferRequest, const std::string& realOutputName, InferenceEngine::Blob::Ptr& blob);
+
+    std::vector<std::string> getRequiredOutputNames() const;
+};
+
+}  // namespace ovms
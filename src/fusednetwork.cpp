@@ -0,0 +1,190 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "fusednetwork.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <ngraph/function.hpp>
+#include <ngraph/op/parameter.hpp>
+#include <spdlog/spdlog.h>
+
+#include "logging.hpp"
+#include "modelconfig.hpp"
+
+namespace ovms {
+
+namespace {
+
+// CNNNetwork names output of a node with several outputs after the node and the output index
+std::string getTensorName(const ngraph::Output<ngraph::Node>& output) {
+    const auto* node = output.get_node();
+    if (node->get_output_size() == 1) {
+        return node->get_friendly_name();
+    }
+    return node->get_friendly_name() + "." + std::to_string(output.get_index());
+}
+
+bool findResultValue(const ngraph::Function& function, const std::string& name, ngraph::Output<ngraph::Node>& value) {
+    for (const auto& result : function.get_results()) {
+        auto resultValue = result->input_value(0);
+        if (getTensorName(resultValue) == name) {
+            value = resultValue;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<ngraph::op::Parameter> findParameter(const ngraph::Function& function, const std::string& name) {
+    for (const auto& parameter : function.get_parameters()) {
+        if (parameter->get_friendly_name() == name) {
+            return parameter;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+bool FusedNetwork::isFusible(ModelInstance& model) {
+    const auto& config = model.getModelConfig();
+    if (config.isStateful() || config.isDynamicBatchingEnabled() || config.isDynamicParameterEnabled() ||
+        config.isBatchSplitEnabled() || config.isBatchPaddingEnabled() ||
+        config.isNumaReplicasEnabled() || !config.getReplicaDevices().empty() || config.getReplicasCount() > 1 ||
+        !config.getInferRequestsPools().empty() || !config.getInputConversions().empty() || !config.getImageInputs().empty() ||
+        !config.getPreprocessing().empty() || !config.getOutputPrecisions().empty() || !config.getOutputReductions().empty()) {
+        return false;
+    }
+    const auto& inputs = model.getInputsInfo();
+    const auto& outputs = model.getOutputsInfo();
+    return std::none_of(inputs.begin(), inputs.end(), [](const auto& pair) { return pair.second->isLayoutTransposed(); }) &&
+           std::all_of(outputs.begin(), outputs.end(), [](const auto& pair) { return pair.second->getOutputEncoding() == OutputEncoding::NONE; });
+}
+
+Status FusedNetwork::create(const std::vector<Stage>& stages, std::shared_ptr<FusedNetwork>& fused) {
+    if (stages.size() < 2) {
+        return Status(StatusCode::INTERNAL_ERROR, "fused network needs at least two models");
+    }
+    auto network = std::make_shared<FusedNetwork>();
+    std::vector<std::shared_ptr<ngraph::Function>> functions;
+    // nodes are renamed only after connecting, traversal of connected function would reach into previous stages
+    std::vector<ngraph::NodeVector> stagesOps;
+    size_t nireq = 1;
+    for (const auto& stage : stages) {
+        std::shared_ptr<InferenceEngine::ExecutableNetwork> compiled;
+        auto function = stage.model->cloneNetworkFunction(compiled);
+        if (!function) {
+            return Status(StatusCode::INTERNAL_ERROR, "network of model " + stage.model->getName() + " has no nGraph function");
+        }
+        network->sources.push_back({stage.nodeName, stage.model, compiled, stage.outputNameAliases, stage.mapping});
+        stagesOps.push_back(function->get_ops());
+        functions.push_back(std::move(function));
+        nireq = std::max(nireq, stage.model->getInferRequestsQueue().getInferRequestsCount());
+        network->name += (network->name.empty() ? "" : "+") + stage.nodeName;
+    }
+    for (size_t i = 1; i < stages.size(); ++i) {
+        const auto& producer = stages[i - 1];
+        const auto& consumer = stages[i];
+        size_t connectedInputs = 0;
+        for (const auto& [alias, inputName] : consumer.mapping) {
+            auto aliasIt = producer.outputNameAliases.find(alias);
+            const auto& modelOutputName = aliasIt == producer.outputNameAliases.end() ? alias : aliasIt->second;
+            auto outputIt = producer.model->getOutputsInfo().find(modelOutputName);
+            auto inputIt = consumer.model->getInputsInfo().find(inputName);
+            if (outputIt == producer.model->getOutputsInfo().end() || inputIt == consumer.model->getInputsInfo().end()) {
+                return Status(StatusCode::INTERNAL_ERROR, "cannot find " + modelOutputName + " output or " + inputName + " input");
+            }
+            ngraph::Output<ngraph::Node> value;
+            auto parameter = findParameter(*functions[i], inputIt->second->getName());
+            if (!findResultValue(*functions[i - 1], outputIt->second->getName(), value) || !parameter) {
+                return Status(StatusCode::INTERNAL_ERROR, "cannot find " + modelOutputName + " output or " + inputName + " input in nGraph function");
+            }
+            if (value.get_element_type() != parameter->get_element_type() || value.get_partial_shape() != parameter->get_partial_shape()) {
+                return Status(StatusCode::INTERNAL_ERROR, "output " + modelOutputName + " of " + producer.nodeName +
+                                                              " differs in type or shape from input " + inputName + " of " + consumer.nodeName);
+            }
+            parameter->output(0).replace(value);
+            ++connectedInputs;
+        }
+        if (connectedInputs != functions[i]->get_parameters().size()) {
+            return Status(StatusCode::INTERNAL_ERROR, "not all inputs of " + consumer.nodeName + " are read from " + producer.nodeName);
+        }
+    }
+    // names of fused models may repeat, only inputs of the first model and outputs of the last one keep theirs
+    for (size_t i = 0; i + 1 < stages.size(); ++i) {
+        for (const auto& op : stagesOps[i]) {
+            if (i == 0 && ngraph::is_type<ngraph::op::Parameter>(op)) {
+                continue;
+            }
+            op->set_friendly_name(stages[i].nodeName + "/" + op->get_friendly_name());
+        }
+    }
+    const auto& first = *stages.front().model;
+    const auto& last = *stages.back().model;
+    auto function = std::make_shared<ngraph::Function>(functions.back()->get_results(), functions.front()->get_parameters(), network->name);
+    try {
+        InferenceEngine::CNNNetwork cnnNetwork(function);
+        auto networkInputs = cnnNetwork.getInputsInfo();
+        for (const auto& [mappedName, input] : first.getInputsInfo()) {
+            auto it = networkInputs.find(input->getName());
+            if (it == networkInputs.end()) {
+                return Status(StatusCode::INTERNAL_ERROR, "fused network has no input " + input->getName());
+            }
+            it->second->setPrecision(input->getPrecision());
+            it->second->setLayout(input->getLayout());
+        }
+        auto networkOutputs = cnnNetwork.getOutputsInfo();
+        for (const auto& [mappedName, output] : last.getOutputsInfo()) {
+            auto it = networkOutputs.find(output->getName());
+            if (it == networkOutputs.end()) {
+                return Status(StatusCode::INTERNAL_ERROR, "fused network has no output " + output->getName());
+            }
+            it->second->setPrecision(output->getPrecision());
+        }
+        network->execNetwork = stages.front().model->compileFusedNetwork(cnnNetwork);
+        if (!network->execNetwork) {
+            return Status(StatusCode::INTERNAL_ERROR, "model " + first.getName() + " was unloaded");
+        }
+        network->inferRequestsQueue = std::make_unique<OVInferRequestsQueue>(*network->execNetwork, nireq);
+    } catch (const std::exception& e) {
+        return Status(StatusCode::INTERNAL_ERROR, std::string("compiling fused network failed: ") + e.what());
+    }
+    network->inputsInfo = first.getInputsInfo();
+    network->outputsInfo = last.getOutputsInfo();
+    SPDLOG_LOGGER_INFO(modelmanager_logger, "Fused models of nodes: {} into one network with {} infer requests", network->name, nireq);
+    fused = std::move(network);
+    return StatusCode::OK;
+}
+
+bool FusedNetwork::isCompiledFrom(const std::vector<Stage>& stages) const {
+    if (stages.size() != sources.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const auto& source = sources[i];
+        const auto& stage = stages[i];
+        auto execNetwork = source.execNetwork.lock();
+        if (source.nodeName != stage.nodeName || source.model.lock() != stage.model || execNetwork == nullptr ||
+            execNetwork != stage.model->getExecutableNetwork() ||
+            source.outputNameAliases != stage.outputNameAliases || source.mapping != stage.mapping) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace ovms
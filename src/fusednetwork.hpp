@@ -0,0 +1,112 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+#include "modelinstance.hpp"
+#include "node.hpp"
+#include "ovinferrequestsqueue.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Network compiled from a chain of pipeline models, inferred by a single node instead of one node per model
+ *
+ * Outputs of each model are connected to inputs of the next one in nGraph function, so the plugin optimizes
+ * across model boundaries and intermediate results are neither taken from infer requests nor passed between nodes.
+ */
+class FusedNetwork {
+public:
+    struct Stage {
+        std::string nodeName;
+        std::shared_ptr<ModelInstance> model;
+        std::unordered_map<std::string, std::string> outputNameAliases;
+        // output aliases of previous stage mapped to model inputs, empty for the first stage
+        InputPairs mapping;
+    };
+
+private:
+    /**
+     * @brief Stage the network was compiled from, models are not kept alive by the fused network
+     */
+    struct Source {
+        std::string nodeName;
+        std::weak_ptr<ModelInstance> model;
+        std::weak_ptr<InferenceEngine::ExecutableNetwork> execNetwork;
+        std::unordered_map<std::string, std::string> outputNameAliases;
+        InputPairs mapping;
+    };
+
+    std::string name;
+    std::vector<Source> sources;
+    tensor_map_t inputsInfo;
+    tensor_map_t outputsInfo;
+    std::shared_ptr<InferenceEngine::ExecutableNetwork> execNetwork;
+    std::unique_ptr<OVInferRequestsQueue> inferRequestsQueue;
+
+public:
+    /**
+     * @brief Checks if model inputs and outputs are passed to and from its network without any conversion or request specific reshape
+     */
+    static bool isFusible(ModelInstance& model);
+
+    /**
+     * @brief Connects networks of stages and compiles the result on device of the first stage
+     *
+     * Every output read by the next stage has to have the same element type and shape as the input it is connected to.
+     */
+    static Status create(const std::vector<Stage>& stages, std::shared_ptr<FusedNetwork>& fused);
+
+    /**
+     * @brief Checks if the network was compiled from the same nodes and connections and from networks the models still infer,
+     * so that revalidated pipeline reuses it instead of compiling it again
+     */
+    bool isCompiledFrom(const std::vector<Stage>& stages) const;
+
+    /**
+     * @brief Node names of stages joined with '+', used in logs
+     */
+    const std::string& getName() const {
+        return name;
+    }
+
+    /**
+     * @brief Inputs of the first stage model, keyed by mapped name
+     */
+    const tensor_map_t& getInputsInfo() const {
+        return inputsInfo;
+    }
+
+    /**
+     * @brief Outputs of the last stage model, keyed by mapped name
+     */
+    const tensor_map_t& getOutputsInfo() const {
+        return outputsInfo;
+    }
+
+    OVInferRequestsQueue& getInferRequestsQueue() {
+        return *inferRequestsQueue;
+    }
+};
+
+}  // namespace ovms
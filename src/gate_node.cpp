@@ -0,0 +1,182 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "gate_node.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "logging.hpp"
+#include "narrowing.hpp"
+
+namespace ovms {
+
+bool parseGateReduction(const std::string& str, GateReduction& reduction) {
+    static const std::unordered_map<std::string, GateReduction> reductions{
+        {"max", GateReduction::MAX},
+        {"min", GateReduction::MIN},
+        {"sum", GateReduction::SUM},
+        {"size", GateReduction::SIZE}};
+    auto it = reductions.find(str);
+    if (it == reductions.end()) {
+        return false;
+    }
+    reduction = it->second;
+    return true;
+}
+
+bool parseGateComparison(const std::string& str, GateComparison& comparison) {
+    static const std::unordered_map<std::string, GateComparison> comparisons{
+        {">", GateComparison::GREATER},
+        {">=", GateComparison::GREATER_EQUAL},
+        {"<", GateComparison::LESS},
+        {"<=", GateComparison::LESS_EQUAL},
+        {"==", GateComparison::EQUAL},
+        {"!=", GateComparison::NOT_EQUAL}};
+    auto it = comparisons.find(str);
+    if (it == comparisons.end()) {
+        return false;
+    }
+    comparison = it->second;
+    return true;
+}
+
+template <typename T>
+static double reduce(const T* data, size_t count, GateReduction reduction) {
+    switch (reduction) {
+    case GateReduction::MAX:
+        return static_cast<double>(*std::max_element(data, data + count));
+    case GateReduction::MIN:
+        return static_cast<double>(*std::min_element(data, data + count));
+    default: {
+        double sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += static_cast<double>(data[i]);
+        }
+        return sum;
+    }
+    }
+}
+
+static bool compare(double lhs, GateComparison comparison, double rhs) {
+    switch (comparison) {
+    case GateComparison::GREATER:
+        return lhs > rhs;
+    case GateComparison::GREATER_EQUAL:
+        return lhs >= rhs;
+    case GateComparison::LESS:
+        return lhs < rhs;
+    case GateComparison::LESS_EQUAL:
+        return lhs <= rhs;
+    case GateComparison::EQUAL:
+        return lhs == rhs;
+    default:
+        return lhs != rhs;
+    }
+}
+
+Status GateCondition::evaluate(const InferenceEngine::Blob::Ptr& blob, bool& passed) const {
+    const size_t count = blob->size();
+    if (reduction == GateReduction::SIZE) {
+        passed = compare(static_cast<double>(count), comparison, value);
+        return StatusCode::OK;
+    }
+    if (count == 0) {
+        passed = false;
+        return StatusCode::OK;
+    }
+    double reduced = 0;
+    const auto buffer = blob->buffer();
+    switch (blob->getTensorDesc().getPrecision()) {
+    case InferenceEngine::Precision::FP32:
+        reduced = reduce(buffer.as<const float*>(), count, reduction);
+        break;
+    case InferenceEngine::Precision::FP16: {
+        std::vector<float> widened(count);
+        widenFp16ToFp32(buffer.as<const uint16_t*>(), widened.data(), count);
+        reduced = reduce(widened.data(), count, reduction);
+        break;
+    }
+    case InferenceEngine::Precision::I64:
+        reduced = reduce(buffer.as<const int64_t*>(), count, reduction);
+        break;
+    case InferenceEngine::Precision::I32:
+        reduced = reduce(buffer.as<const int32_t*>(), count, reduction);
+        break;
+    case InferenceEngine::Precision::I16:
+        reduced = reduce(buffer.as<const int16_t*>(), count, reduction);
+        break;
+    case InferenceEngine::Precision::U16:
+        reduced = reduce(buffer.as<const uint16_t*>(), count, reduction);
+        break;
+    case InferenceEngine::Precision::I8:
+        reduced = reduce(buffer.as<const int8_t*>(), count, reduction);
+        break;
+    case InferenceEngine::Precision::U8:
+    case InferenceEngine::Precision::BOOL:
+        reduced = reduce(buffer.as<const uint8_t*>(), count, reduction);
+        break;
+    default:
+        return StatusCode::INVALID_PRECISION;
+    }
+    passed = compare(reduced, comparison, value);
+    return StatusCode::OK;
+}
+
+GateNode::GateNode(const std::string& nodeName, const GateCondition& condition,
+    std::unordered_map<std::string, std::string> nodeOutputNameAlias) :
+    Node(nodeName),
+    condition(condition),
+    nodeOutputNameAlias(std::move(nodeOutputNameAlias)) {}
+
+Status GateNode::execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) {
+    Status status;
+    auto it = this->inputBlobs.find(condition.input);
+    if (it == this->inputBlobs.end()) {
+        SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Missing gate condition input: {}", getName(), condition.input);
+        status = StatusCode::INVALID_MISSING_INPUT;
+    } else {
+        status = condition.evaluate(it->second, passed);
+        if (!status.ok()) {
+            SPDLOG_LOGGER_ERROR(dag_executor_logger, "[Node: {}] Gate condition input: {} has unsupported precision", getName(), condition.input);
+        } else {
+            SPDLOG_LOGGER_DEBUG(dag_executor_logger, "[Node: {}] Gate condition {}, dependants are {}", getName(),
+                passed ? "passed" : "failed", passed ? "executed" : "skipped");
+        }
+    }
+    notifyEndQueue.push(*this);
+    return status;
+}
+
+Status GateNode::fetchResults(BlobMap& outputs) {
+    if (!passed) {
+        this->inputBlobs.clear();
+        return StatusCode::OK;
+    }
+    for (const auto& [alias, inputName] : nodeOutputNameAlias) {
+        auto it = this->inputBlobs.find(inputName);
+        if (it != this->inputBlobs.end()) {
+            outputs.emplace(alias, it->second);
+        }
+    }
+    this->inputBlobs.clear();
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
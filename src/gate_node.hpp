@@ -0,0 +1,101 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "node.hpp"
+
+namespace ovms {
+
+enum class GateReduction {
+    MAX,
+    MIN,
+    SUM,
+    SIZE
+};
+
+enum class GateComparison {
+    GREATER,
+    GREATER_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    EQUAL,
+    NOT_EQUAL
+};
+
+/**
+ * @brief Predicate of gate node, input blob is reduced to a single value which is compared with configured one
+ */
+struct GateCondition {
+    std::string input;
+    GateReduction reduction = GateReduction::MAX;
+    GateComparison comparison = GateComparison::GREATER;
+    double value = 0;
+
+    bool operator==(const GateCondition& other) const {
+        return input == other.input && reduction == other.reduction && comparison == other.comparison && value == other.value;
+    }
+
+    /**
+     * @brief Evaluates the condition on values of the blob
+     *
+     * Max, min and sum of empty blob fail the condition, size is 0 then.
+     *
+     * @param blob
+     * @param passed
+     *
+     * @return Status INVALID_PRECISION when blob precision cannot be reduced
+     */
+    Status evaluate(const InferenceEngine::Blob::Ptr& blob, bool& passed) const;
+};
+
+bool parseGateReduction(const std::string& str, GateReduction& reduction);
+
+bool parseGateComparison(const std::string& str, GateComparison& comparison);
+
+/**
+ * @brief Passes its inputs through to following nodes when condition on one of them holds
+ *
+ * When condition fails, all nodes depending on the gate are skipped together with their dependants,
+ * so that the subgraph consumes no inference. Outputs of skipped nodes are not present in the response.
+ */
+class GateNode : public Node {
+    GateCondition condition;
+    // key: alias, value: input of the gate passed under the alias
+    std::unordered_map<std::string, std::string> nodeOutputNameAlias;
+    bool passed = false;
+
+public:
+    GateNode(const std::string& nodeName, const GateCondition& condition,
+        std::unordered_map<std::string, std::string> nodeOutputNameAlias = {});
+
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override;
+
+    Status fetchResults(BlobMap& outputs) override;
+
+    bool isSkippingDependants() const override {
+        return !passed;
+    }
+
+    void reset() override {
+        Node::reset();
+        passed = false;
+    }
+};
+
+}  // namespace ovms
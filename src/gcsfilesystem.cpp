@@ -25,12 +25,20 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "gcsfilesystem.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "cloudlistingcache.hpp"
+#include "fetchedobjects.hpp"
 #include "logging.hpp"
 #include "stringutils.hpp"
 
@@ -96,6 +104,18 @@ GCSFileSystem::GCSFileSystem(const gcs::v1::ClientOptions& options) :
 
 GCSFileSystem::~GCSFileSystem() { SPDLOG_LOGGER_TRACE(gcs_logger, "GCSFileSystem dtor"); }
 
+std::shared_ptr<GCSFileSystem> GCSFileSystem::getShared() {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<GCSFileSystem>> filesystems;
+    const char* credentials = std::getenv("GOOGLE_APPLICATION_CREDENTIALS");
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& filesystem = filesystems[credentials != nullptr ? credentials : ""];
+    if (!filesystem) {
+        filesystem = std::make_shared<GCSFileSystem>();
+    }
+    return filesystem;
+}
+
 StatusCode GCSFileSystem::fileExists(const std::string& path, bool* exists) {
     *exists = false;
     std::string bucket, object;
@@ -140,6 +160,10 @@ StatusCode GCSFileSystem::isDirectory(const std::string& path,
         *is_directory = true;
         return StatusCode::OK;
     }
+    // answered from listing of a prefix shared with other models in this watcher cycle
+    if (CloudListingCache::instance().isDirectory(GCS_URL_PREFIX + bucket + "/" + object, is_directory)) {
+        return StatusCode::OK;
+    }
     for (auto&& meta :
         client_.ListObjects(bucket, gcs::Prefix(appendSlash(object)))) {
         if (meta) {
@@ -187,24 +211,27 @@ GCSFileSystem::getDirectoryContents(const std::string& path,
 StatusCode GCSFileSystem::getDirectorySubdirs(const std::string& path,
     std::set<std::string>* subdirs) {
     SPDLOG_LOGGER_TRACE(gcs_logger, "Listing directory subdirs: {}", path);
-    auto status = this->getDirectoryContents(path, subdirs);
+    std::string bucket, directory_path;
+    auto status = this->parsePath(path, &bucket, &directory_path);
     if (status != StatusCode::OK) {
-        SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to list directory subdir content {} -> {}", path,
+        SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to list directory subdirs {} -> {}", path,
             ovms::Status(status).string());
         return status;
     }
-    for (auto item = subdirs->begin(); item != subdirs->end();) {
-        bool is_directory;
-        auto status = this->isDirectory(joinPath({path, *item}), &is_directory);
-        if (status != StatusCode::OK) {
-            SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to list directory subdir content {} -> {}", path,
-                ovms::Status(status).string());
-            return status;
+    if (CloudListingCache::instance().getDirectorySubdirs(GCS_URL_PREFIX + bucket + "/" + directory_path, subdirs)) {
+        return StatusCode::OK;
+    }
+    // names of all objects under the directory tell which items are subdirectories, without listing each of them
+    const std::string full_directory = appendSlash(directory_path);
+    for (auto&& meta : client_.ListObjects(bucket, gcs::Prefix(full_directory))) {
+        if (!meta) {
+            SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to list directory subdirs {}. Error: {}", path, meta.status().message());
+            return StatusCode::GCS_INVALID_ACCESS;
         }
-        if (!is_directory) {
-            item = subdirs->erase(item);
-        } else {
-            ++item;
+        const std::string& name = meta->name();
+        const size_t name_end = name.find("/", full_directory.size());
+        if (name_end != std::string::npos && name_end > full_directory.size()) {
+            subdirs->insert(name.substr(full_directory.size(), name_end - full_directory.size()));
         }
     }
     SPDLOG_LOGGER_TRACE(gcs_logger, "Listing directory subdirs ok: {}", path);
@@ -271,18 +298,74 @@ StatusCode GCSFileSystem::readTextFile(const std::string& path,
     return StatusCode::OK;
 }
 
-StatusCode GCSFileSystem::downloadFile(const std::string& remote_path,
-    const std::string& local_path) {
-    SPDLOG_LOGGER_TRACE(gcs_logger, "Saving file {} to {}", remote_path, local_path);
-    std::string contents;
-    auto read_status = this->readTextFile(remote_path, &contents);
-    if (read_status != StatusCode::OK) {
-        SPDLOG_LOGGER_ERROR(gcs_logger, "Failed to get object at {}", remote_path);
-        return read_status;
-    }
-    std::ofstream output_file(local_path.c_str(), std::ios::binary);
-    output_file << contents;
-    output_file.close();
+StatusCode GCSFileSystem::writeFile(const std::string& path,
+    const std::string& contents) {
+    std::string bucket, object;
+    auto status = parsePath(path, &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    auto metadata = client_.InsertObject(bucket, object, contents);
+    if (!metadata) {
+        SPDLOG_LOGGER_ERROR(gcs_logger, "Uploading file {} has failed: {}", path, metadata.status().message());
+        return StatusCode::FILESYSTEM_ERROR;
+    }
+    return StatusCode::OK;
+}
+
+StatusCode GCSFileSystem::readFileToMemory(const std::string& path,
+    std::string* contents) {
+    std::string bucket, object;
+    auto status = parsePath(path, &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    auto meta = client_.GetObjectMetadata(bucket, object);
+    if (!meta) {
+        SPDLOG_LOGGER_ERROR(gcs_logger, "Reading file -> file does not exist at {}", path);
+        return StatusCode::GCS_FILE_NOT_FOUND;
+    }
+    const uint64_t size = meta->size();
+    // parts are read in place, buffer gets its final size up front
+    contents->assign(size, '\0');
+    if (size == 0) {
+        // an empty object has no byte range that could be requested
+        return StatusCode::OK;
+    }
+    const auto parts = splitIntoParts({size}, downloadPartSize_);
+    std::atomic<size_t> nextPart{0};
+    std::atomic<bool> failed{false};
+    auto readParts = [&]() {
+        for (size_t part = nextPart++; part < parts.size() && !failed; part = nextPart++) {
+            const uint64_t offset = parts[part].second;
+            const uint64_t end = std::min(offset + downloadPartSize_, size);
+            gcs::ObjectReadStream stream = client_.ReadObject(bucket, object, gcs::ReadRange(offset, end));
+            if (!stream) {
+                SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to read {} range from {} to {}", path, offset, end);
+                failed = true;
+                return;
+            }
+            stream.read(contents->data() + offset, end - offset);
+            if (static_cast<uint64_t>(stream.gcount()) != end - offset) {
+                SPDLOG_LOGGER_ERROR(gcs_logger, "Read of {} range from {} to {} is incomplete", path, offset, end);
+                failed = true;
+                return;
+            }
+        }
+    };
+    const size_t connections = std::min(downloadConnections_, parts.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < connections; ++i) {
+        workers.emplace_back(readParts);
+    }
+    readParts();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return StatusCode::GCS_FILE_INVALID;
+    }
+    SPDLOG_LOGGER_TRACE(gcs_logger, "File {} has been read into memory (bytes={})", path, size);
     return StatusCode::OK;
 }
 
@@ -296,6 +379,8 @@ StatusCode GCSFileSystem::downloadModelVersions(const std::string& path,
     }
 
     StatusCode result = StatusCode::OK;
+    // objects of all versions are downloaded together, so versions do not wait for each other
+    std::vector<RemoteObject> objects;
     for (auto& ver : versions) {
         std::string versionpath = path;
         if (!endsWith(versionpath, "/")) {
@@ -308,18 +393,32 @@ StatusCode GCSFileSystem::downloadModelVersions(const std::string& path,
         }
         lpath.append(std::to_string(ver));
         fs::create_directory(lpath);
-        auto status = downloadFileFolder(versionpath, lpath);
+        auto status = listFolderObjects(versionpath, lpath, objects);
         if (status != StatusCode::OK) {
             result = status;
             SPDLOG_LOGGER_ERROR(gcs_logger, "Failed to download model version {}", versionpath);
         }
     }
+    auto status = downloadObjects(objects);
+    if (status != StatusCode::OK) {
+        result = status;
+        SPDLOG_LOGGER_ERROR(gcs_logger, "Failed to download model versions from {}", path);
+    }
 
     return result;
 }
 
 StatusCode GCSFileSystem::downloadFileFolder(const std::string& path, const std::string& local_path) {
     SPDLOG_LOGGER_TRACE(gcs_logger, "Downloading dir {} and saving to {}", path, local_path);
+    std::vector<RemoteObject> objects;
+    auto status = listFolderObjects(path, local_path, objects);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    return downloadObjects(objects);
+}
+
+StatusCode GCSFileSystem::listFolderObjects(const std::string& path, const std::string& local_path, std::vector<RemoteObject>& objects) {
     bool is_dir;
     auto status = this->isDirectory(path, &is_dir);
     if (status != StatusCode::OK) {
@@ -330,53 +429,146 @@ StatusCode GCSFileSystem::downloadFileFolder(const std::string& path, const std:
         SPDLOG_LOGGER_ERROR(gcs_logger, "Path is not a directory: {}", path);
         return StatusCode::GCS_FILE_NOT_FOUND;
     }
-
-    std::set<std::string> dirs;
-    status = getDirectorySubdirs(path, &dirs);
+    std::string bucket, directory_path;
+    status = parsePath(path, &bucket, &directory_path);
     if (status != StatusCode::OK) {
         return status;
     }
-
-    std::set<std::string> files;
-    status = getDirectoryFiles(path, &files);
-    if (status != StatusCode::OK) {
-        return status;
+    const std::string prefix = appendSlash(directory_path);
+    // listing without delimiter returns objects of all subdirectories with their sizes
+    for (auto&& meta : client_.ListObjects(bucket, gcs::Prefix(prefix))) {
+        if (!meta) {
+            SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to list directory {}. Error: {}", path, meta.status().message());
+            return StatusCode::GCS_INVALID_ACCESS;
+        }
+        const std::string relative_path = meta->name().substr(prefix.size());
+        if (relative_path.empty() || endsWith(relative_path, "/") ||
+            !std::any_of(acceptedFiles.begin(), acceptedFiles.end(), [&relative_path](const std::string& x) {
+                return endsWith(relative_path, x);
+            })) {
+            continue;
+        }
+        const std::string local_file_path = joinPath({local_path, relative_path});
+        std::error_code error;
+        fs::create_directories(fs::path(local_file_path).parent_path(), error);
+        if (error) {
+            SPDLOG_LOGGER_ERROR(gcs_logger, "Failed to create local folder for: {} {}", local_file_path, error.message());
+            return StatusCode::PATH_INVALID;
+        }
+        SPDLOG_LOGGER_TRACE(gcs_logger, "Processing file {} -> {}", meta->name(), local_file_path);
+        // composite objects have no MD5 hash
+        const std::string contentId = meta->md5_hash().empty() ? "crc32c:" + meta->crc32c() : "md5:" + meta->md5_hash();
+        objects.push_back({bucket, meta->name(), local_file_path, meta->size(), contentId});
     }
+    return StatusCode::OK;
+}
 
-    for (auto&& d : dirs) {
-        std::string remote_dir_path = joinPath({path, d});
-        std::string local_dir_path = joinPath({local_path, d});
-        SPDLOG_LOGGER_TRACE(gcs_logger, "Processing directory {} from {} -> {}", d, remote_dir_path,
-            local_dir_path);
-        auto mkdir_status = CreateLocalDir(local_dir_path);
-        if (mkdir_status != StatusCode::OK) {
-            return status;
+StatusCode GCSFileSystem::downloadObjects(const std::vector<RemoteObject>& objects) {
+    std::vector<uint64_t> sizes;
+    sizes.reserve(objects.size());
+    std::vector<bool> reused(objects.size(), false);
+    for (size_t i = 0; i < objects.size(); ++i) {
+        reused[i] = FetchedObjects::instance().reuse(objects[i].contentId, objects[i].size, objects[i].localPath);
+        sizes.push_back(reused[i] ? 0 : objects[i].size);
+        if (reused[i]) {
+            continue;
         }
-        auto download_dir_status =
-            this->downloadFileFolder(remote_dir_path, local_dir_path);
-        if (download_dir_status != StatusCode::OK) {
-            SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to download directory from {} to {}",
-                remote_dir_path, local_dir_path);
-            return download_dir_status;
+        // parts are written in place, file gets its final size up front
+        std::ofstream output_file(objects[i].localPath.c_str(), std::ios::binary);
+        output_file.close();
+        std::error_code error;
+        fs::resize_file(objects[i].localPath, objects[i].size, error);
+        if (error) {
+            SPDLOG_LOGGER_ERROR(gcs_logger, "Failed to create local file: {} {}", objects[i].localPath, error.message());
+            return StatusCode::PATH_INVALID;
         }
     }
 
-    for (auto&& f : files) {
-        if (std::any_of(acceptedFiles.begin(), acceptedFiles.end(), [&f](const std::string& x) {
-                return f.size() > 0 && endsWith(f, x);
-            })) {
-            std::string remote_file_path = joinPath({path, f});
-            std::string local_file_path = joinPath({local_path, f});
-            SPDLOG_LOGGER_TRACE(gcs_logger, "Processing file {} from {} -> {}", f, remote_file_path,
-                local_file_path);
-            auto download_status =
-                this->downloadFile(remote_file_path, local_file_path);
-            if (download_status != StatusCode::OK) {
-                SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to save file from {} to {}", remote_file_path,
-                    local_file_path);
-                return download_status;
+    const auto parts = splitIntoParts(sizes, downloadPartSize_);
+    std::atomic<size_t> nextPart{0};
+    std::atomic<bool> failed{false};
+    auto downloadParts = [&]() {
+        for (size_t part = nextPart++; part < parts.size(); part = nextPart++) {
+            const auto [objectIndex, offset] = parts[part];
+            const auto& object = objects[objectIndex];
+            const uint64_t end = std::min(offset + downloadPartSize_, object.size);
+            gcs::ObjectReadStream stream = client_.ReadObject(object.bucket, object.object, gcs::ReadRange(offset, end));
+            if (!stream) {
+                SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to read gs://{}/{} range from {} to {}", object.bucket, object.object, offset, end);
+                failed = true;
+                continue;
+            }
+            std::fstream output_file(object.localPath.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+            output_file.seekp(offset);
+            output_file << stream.rdbuf();
+            output_file.close();
+            if (!stream.status().ok() || output_file.fail()) {
+                SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to save gs://{}/{} range from {} to {} into {}", object.bucket, object.object, offset, end,
+                    object.localPath);
+                failed = true;
             }
         }
+    };
+    const size_t connections = std::min(downloadConnections_, parts.size());
+    SPDLOG_LOGGER_DEBUG(gcs_logger, "Downloading {} objects in {} parts with {} connections", objects.size(), parts.size(), connections);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < connections; ++i) {
+        workers.emplace_back(downloadParts);
+    }
+    downloadParts();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return StatusCode::GCS_FILE_INVALID;
+    }
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (!reused[i]) {
+            FetchedObjects::instance().add(objects[i].contentId, objects[i].size, objects[i].localPath);
+        }
+    }
+    return StatusCode::OK;
+}
+
+StatusCode GCSFileSystem::getVersionFingerprint(const std::string& path, model_version_t version, std::string* fingerprint) {
+    std::string bucket, object;
+    auto status = parsePath(joinPath({path, std::to_string(version)}), &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    std::stringstream description;
+    bool found = false;
+    for (auto&& meta : client_.ListObjects(bucket, gcs::Prefix(appendSlash(object)))) {
+        if (!meta) {
+            SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to list model version {}/{}. Error: {}", path, version, meta.status().message());
+            return StatusCode::GCS_INVALID_ACCESS;
+        }
+        description << meta->name() << ":" << meta->generation() << ":" << meta->size() << "\n";
+        found = true;
+    }
+    if (!found) {
+        return StatusCode::GCS_FILE_NOT_FOUND;
+    }
+    *fingerprint = description.str();
+    return StatusCode::OK;
+}
+
+StatusCode GCSFileSystem::listObjectKeys(const std::string& path, std::vector<std::string>* keys, size_t maxKeys) {
+    std::string bucket, object;
+    auto status = parsePath(path, &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    for (auto&& meta : client_.ListObjects(bucket, gcs::Prefix(appendSlash(object)))) {
+        if (!meta) {
+            SPDLOG_LOGGER_ERROR(gcs_logger, "Unable to list objects under {}. Error: {}", path, meta.status().message());
+            return StatusCode::GCS_INVALID_ACCESS;
+        }
+        if (keys->size() == maxKeys) {
+            SPDLOG_LOGGER_DEBUG(gcs_logger, "More than {} objects under {}, listing is abandoned", maxKeys, path);
+            return StatusCode::GCS_FAILED_LIST_OBJECTS;
+        }
+        keys->push_back(GCS_URL_PREFIX + bucket + "/" + meta->name());
     }
     return StatusCode::OK;
 }
@@ -15,6 +15,8 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <regex>
 #include <string>
 #include <vector>
@@ -46,6 +48,13 @@ public:
    */
     virtual ~GCSFileSystem();
 
+    /**
+   * @brief Get the file system shared by all paths with the same credentials, so connections of the client are reused
+   *
+   * @return std::shared_ptr<GCSFileSystem>
+   */
+    static std::shared_ptr<GCSFileSystem> getShared();
+
     /**
    * @brief Check if given path or file exists
    *
@@ -104,6 +113,26 @@ public:
     StatusCode readTextFile(const std::string& path,
         std::string* contents) override;
 
+    /**
+   * @brief Read the content of the given object into memory with parallel ranged reads
+   *
+   * @param path
+   * @param contents
+   * @return StatusCode
+   */
+    StatusCode readFileToMemory(const std::string& path,
+        std::string* contents) override;
+
+    /**
+   * @brief Upload the content of the given object with a single request
+   *
+   * @param path
+   * @param contents
+   * @return StatusCode
+   */
+    StatusCode writeFile(const std::string& path,
+        const std::string& contents) override;
+
     /**
    * @brief Download a remote directory
    *
@@ -123,6 +152,26 @@ public:
      */
     StatusCode downloadModelVersions(const std::string& path, std::string* local_path, const std::vector<model_version_t>& versions) override;
 
+    /**
+     * @brief Lists names, generations and sizes of objects of model version
+     *
+     * @param path
+     * @param version
+     * @param fingerprint
+     * @return StatusCode
+     */
+    StatusCode getVersionFingerprint(const std::string& path, model_version_t version, std::string* fingerprint) override;
+
+    /**
+     * @brief Lists urls of all objects under the prefix
+     *
+     * @param path
+     * @param keys
+     * @param maxKeys
+     * @return StatusCode
+     */
+    StatusCode listObjectKeys(const std::string& path, std::vector<std::string>* keys, size_t maxKeys) override;
+
     /**
    * @brief Delete a folder
    *
@@ -131,9 +180,46 @@ public:
    */
     StatusCode deleteFileFolder(const std::string& path) override;
 
+    const char* getBackendName() const override {
+        return "gcs";
+    }
+
     static const std::string GCS_URL_PREFIX;
 
+    static constexpr size_t DEFAULT_DOWNLOAD_PART_SIZE_MB = 16;
+    static constexpr size_t DEFAULT_DOWNLOAD_CONNECTIONS = 8;
+
 private:
+    /**
+     * @brief Object to download together with its local destination
+     */
+    struct RemoteObject {
+        std::string bucket;
+        std::string object;
+        std::string localPath;
+        uint64_t size;
+        // MD5 hash or CRC32C checksum, unchanged objects of other versions are linked instead of downloaded
+        std::string contentId;
+    };
+
+    /**
+     * @brief Lists accepted model files under the folder with one listing request and creates their local directories
+     *
+     * @param path
+     * @param local_path
+     * @param objects appended with files found
+     * @return StatusCode
+     */
+    StatusCode listFolderObjects(const std::string& path, const std::string& local_path, std::vector<RemoteObject>& objects);
+
+    /**
+     * @brief Downloads objects with ranged reads spread over a pool of connections, failed objects do not stop the others
+     *
+     * @param objects
+     * @return StatusCode
+     */
+    StatusCode downloadObjects(const std::vector<RemoteObject>& objects);
+
     /**
     * @brief
     *
@@ -146,20 +232,20 @@ private:
         std::string* object);
 
     /**
-    *
     * @brief
     *
-    * @param remote_path
-    * @param local_path
     */
-    StatusCode downloadFile(const std::string& remote_path,
-        const std::string& local_path);
+    google::cloud::storage::Client client_;
 
     /**
-    * @brief
-    *
-    */
-    google::cloud::storage::Client client_;
+     * @brief Size of ranges fetched with one read, set with GCS_DOWNLOAD_PART_SIZE_MB environment variable
+     */
+    uint64_t downloadPartSize_ = getDownloadSetting("GCS_DOWNLOAD_PART_SIZE_MB", DEFAULT_DOWNLOAD_PART_SIZE_MB) * 1024 * 1024;
+
+    /**
+     * @brief Number of parallel reads of one download, set with GCS_DOWNLOAD_CONNECTIONS environment variable
+     */
+    size_t downloadConnections_ = getDownloadSetting("GCS_DOWNLOAD_CONNECTIONS", DEFAULT_DOWNLOAD_CONNECTIONS);
 };
 
 }  // namespace ovms
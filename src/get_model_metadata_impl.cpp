@@ -15,6 +15,8 @@
 //*****************************************************************************
 #include "get_model_metadata_impl.hpp"
 
+#include <utility>
+
 #include <google/protobuf/util/json_util.h>
 
 using google::protobuf::util::JsonPrintOptions;
@@ -35,6 +37,35 @@ Status GetModelMetadataImpl::getModelStatus(
     const tensorflow::serving::GetModelMetadataRequest* request,
     tensorflow::serving::GetModelMetadataResponse* response,
     ModelManager& manager) {
+    std::shared_ptr<const ModelMetadata> metadata;
+    auto status = getMetadata(request, metadata, manager);
+    if (!status.ok()) {
+        return status;
+    }
+    response->CopyFrom(metadata->response);
+    return StatusCode::OK;
+}
+
+Status GetModelMetadataImpl::getModelStatusJson(
+    const tensorflow::serving::GetModelMetadataRequest* request,
+    std::string* output) {
+    auto status = validate(request);
+    if (!status.ok()) {
+        return status;
+    }
+    std::shared_ptr<const ModelMetadata> metadata;
+    status = getMetadata(request, metadata, ModelManager::getInstance());
+    if (!status.ok()) {
+        return status;
+    }
+    *output = metadata->json;
+    return StatusCode::OK;
+}
+
+Status GetModelMetadataImpl::getMetadata(
+    const tensorflow::serving::GetModelMetadataRequest* request,
+    std::shared_ptr<const ModelMetadata>& metadata,
+    ModelManager& manager) {
     const auto& name = request->model_spec().name();
     model_version_t version = request->model_spec().has_version() ? request->model_spec().version().value() : 0;
 
@@ -45,7 +76,7 @@ Status GetModelMetadataImpl::getModelStatus(
         if (!pipelineDefinition) {
             return StatusCode::MODEL_NAME_MISSING;
         }
-        return buildResponse(*pipelineDefinition, response, manager);
+        return getMetadata(*pipelineDefinition, metadata, manager);
     }
 
     std::shared_ptr<ModelInstance> instance = nullptr;
@@ -65,7 +96,7 @@ Status GetModelMetadataImpl::getModelStatus(
         }
     }
 
-    return buildResponse(instance, response);
+    return getMetadata(instance, metadata);
 }
 
 Status GetModelMetadataImpl::validate(
@@ -101,15 +132,41 @@ void GetModelMetadataImpl::convert(
         *input.mutable_name() = name;
         *input.mutable_tensor_shape() = tensorflow::TensorShapeProto();
 
-        for (auto dim : tensor->getShape()) {
+        // Inputs transposed by the server are reported in NHWC layout expected in requests
+        for (auto dim : tensor->getRequestShape()) {
             input.mutable_tensor_shape()->add_dim()->set_size(dim);
         }
     }
 }
 
-Status GetModelMetadataImpl::buildResponse(
+Status GetModelMetadataImpl::createMetadata(
+    const std::string& name,
+    model_version_t version,
+    const tensor_map_t& inputs,
+    const tensor_map_t& outputs,
+    std::shared_ptr<const ModelMetadata>& metadata) {
+    auto created = std::make_shared<ModelMetadata>();
+    auto& response = created->response;
+    response.mutable_model_spec()->set_name(name);
+    response.mutable_model_spec()->mutable_version()->set_value(version);
+
+    tensorflow::serving::SignatureDefMap def;
+    convert(inputs, ((*def.mutable_signature_def())["serving_default"]).mutable_inputs());
+    convert(outputs, ((*def.mutable_signature_def())["serving_default"]).mutable_outputs());
+
+    (*response.mutable_metadata())["signature_def"].PackFrom(def);
+
+    auto status = serializeResponse2Json(&response, &created->json);
+    if (!status.ok()) {
+        return status;
+    }
+    metadata = std::move(created);
+    return StatusCode::OK;
+}
+
+Status GetModelMetadataImpl::getMetadata(
     std::shared_ptr<ModelInstance> instance,
-    tensorflow::serving::GetModelMetadataResponse* response) {
+    std::shared_ptr<const ModelMetadata>& metadata) {
 
     std::unique_ptr<ModelInstanceUnloadGuard> unloadGuard;
 
@@ -119,21 +176,23 @@ Status GetModelMetadataImpl::buildResponse(
         return status;
     }
 
-    response->Clear();
-    response->mutable_model_spec()->set_name(instance->getName());
-    response->mutable_model_spec()->mutable_version()->set_value(instance->getVersion());
-
-    tensorflow::serving::SignatureDefMap def;
-    convert(instance->getInputsInfo(), ((*def.mutable_signature_def())["serving_default"]).mutable_inputs());
-    convert(instance->getOutputsInfo(), ((*def.mutable_signature_def())["serving_default"]).mutable_outputs());
+    uint64_t generation;
+    metadata = instance->getMetadataCache().get(generation);
+    if (metadata) {
+        return StatusCode::OK;
+    }
 
-    (*response->mutable_metadata())["signature_def"].PackFrom(def);
+    status = createMetadata(instance->getName(), instance->getVersion(), instance->getInputsInfo(), instance->getOutputsInfo(), metadata);
+    if (!status.ok()) {
+        return status;
+    }
+    instance->getMetadataCache().put(generation, metadata);
     return StatusCode::OK;
 }
 
-Status GetModelMetadataImpl::buildResponse(
+Status GetModelMetadataImpl::getMetadata(
     PipelineDefinition& pipelineDefinition,
-    tensorflow::serving::GetModelMetadataResponse* response,
+    std::shared_ptr<const ModelMetadata>& metadata,
     const ModelManager& manager) {
 
     // 0 meaning immediately return unload guard if possible, otherwise do not wait for available state
@@ -143,6 +202,12 @@ Status GetModelMetadataImpl::buildResponse(
         return status;
     }
 
+    uint64_t generation;
+    metadata = pipelineDefinition.getMetadataCache().get(generation);
+    if (metadata) {
+        return StatusCode::OK;
+    }
+
     tensor_map_t inputs, outputs;
     status = pipelineDefinition.getInputsInfo(inputs, manager);
     if (!status.ok()) {
@@ -153,15 +218,36 @@ Status GetModelMetadataImpl::buildResponse(
         return status;
     }
 
-    response->Clear();
-    response->mutable_model_spec()->set_name(pipelineDefinition.getName());
-    response->mutable_model_spec()->mutable_version()->set_value(1);
+    status = createMetadata(pipelineDefinition.getName(), pipelineDefinition.getVersion(), inputs, outputs, metadata);
+    if (!status.ok()) {
+        return status;
+    }
+    pipelineDefinition.getMetadataCache().put(generation, metadata);
+    return StatusCode::OK;
+}
 
-    tensorflow::serving::SignatureDefMap def;
-    convert(inputs, ((*def.mutable_signature_def())["serving_default"]).mutable_inputs());
-    convert(outputs, ((*def.mutable_signature_def())["serving_default"]).mutable_outputs());
+Status GetModelMetadataImpl::buildResponse(
+    std::shared_ptr<ModelInstance> instance,
+    tensorflow::serving::GetModelMetadataResponse* response) {
+    std::shared_ptr<const ModelMetadata> metadata;
+    auto status = getMetadata(instance, metadata);
+    if (!status.ok()) {
+        return status;
+    }
+    response->CopyFrom(metadata->response);
+    return StatusCode::OK;
+}
 
-    (*response->mutable_metadata())["signature_def"].PackFrom(def);
+Status GetModelMetadataImpl::buildResponse(
+    PipelineDefinition& pipelineDefinition,
+    tensorflow::serving::GetModelMetadataResponse* response,
+    const ModelManager& manager) {
+    std::shared_ptr<const ModelMetadata> metadata;
+    auto status = getMetadata(pipelineDefinition, metadata, manager);
+    if (!status.ok()) {
+        return status;
+    }
+    response->CopyFrom(metadata->response);
     return StatusCode::OK;
 }
 
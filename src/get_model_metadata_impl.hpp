@@ -24,6 +24,7 @@
 #include "tensorflow_serving/apis/get_model_metadata.pb.h"
 #pragma GCC diagnostic pop
 
+#include "metadatacache.hpp"
 #include "modelmanager.hpp"
 #include "status.hpp"
 
@@ -48,6 +49,24 @@ public:
         tensorflow::serving::GetModelMetadataResponse* response,
         const ModelManager& manager);
 
+    /**
+     * @brief Gets metadata of available model version, built on first call after the version is loaded
+     */
+    static Status getMetadata(
+        std::shared_ptr<ModelInstance> instance,
+        std::shared_ptr<const ModelMetadata>& metadata);
+    /**
+     * @brief Gets metadata of available pipeline definition, built on first call after the definition or any of its models changes
+     */
+    static Status getMetadata(
+        PipelineDefinition& pipelineDefinition,
+        std::shared_ptr<const ModelMetadata>& metadata,
+        const ModelManager& manager);
+    static Status getMetadata(
+        const tensorflow::serving::GetModelMetadataRequest* request,
+        std::shared_ptr<const ModelMetadata>& metadata,
+        ModelManager& manager);
+
     static Status getModelStatus(
         const tensorflow::serving::GetModelMetadataRequest* request,
         tensorflow::serving::GetModelMetadataResponse* response);
@@ -55,8 +74,22 @@ public:
         const tensorflow::serving::GetModelMetadataRequest* request,
         tensorflow::serving::GetModelMetadataResponse* response,
         ModelManager& manager);
+    /**
+     * @brief Gets metadata of requested model or pipeline serialized to REST API json
+     */
+    static Status getModelStatusJson(
+        const tensorflow::serving::GetModelMetadataRequest* request,
+        std::string* output);
     static Status createGrpcRequest(std::string model_name, std::optional<int64_t> model_version, tensorflow::serving::GetModelMetadataRequest* request);
     static Status serializeResponse2Json(const tensorflow::serving::GetModelMetadataResponse* response, std::string* output);
+
+private:
+    static Status createMetadata(
+        const std::string& name,
+        model_version_t version,
+        const tensor_map_t& inputs,
+        const tensor_map_t& outputs,
+        std::shared_ptr<const ModelMetadata>& metadata);
 };
 
 }  // namespace ovms
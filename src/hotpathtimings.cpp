@@ -0,0 +1,71 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "hotpathtimings.hpp"
+
+#include <algorithm>
+
+namespace ovms {
+
+const char* toString(HotPathStage stage) {
+    switch (stage) {
+    case HotPathStage::GRPC_PREDICT:
+        return "grpc_predict";
+    case HotPathStage::REST_PREDICT:
+        return "rest_predict";
+    case HotPathStage::REST_PARSING:
+        return "rest_parsing";
+    case HotPathStage::REST_SERIALIZATION:
+        return "rest_serialization";
+    case HotPathStage::INFERENCE:
+        return "inference";
+    case HotPathStage::PIPELINE_EXECUTION:
+        return "pipeline_execution";
+    default:
+        return "unknown";
+    }
+}
+
+HotPathTimings& HotPathTimings::instance() {
+    static HotPathTimings instance;
+    return instance;
+}
+
+HotPathTimings::ThreadRegistration::ThreadRegistration() :
+    histograms(std::make_unique<Histograms>()) {
+    auto& timings = HotPathTimings::instance();
+    std::lock_guard<std::mutex> lock(timings.mtx);
+    timings.threads.push_back(histograms.get());
+}
+
+HotPathTimings::ThreadRegistration::~ThreadRegistration() {
+    auto& timings = HotPathTimings::instance();
+    std::lock_guard<std::mutex> lock(timings.mtx);
+    for (size_t stage = 0; stage < HOT_PATH_STAGES_COUNT; ++stage) {
+        timings.retired.stages[stage].add(histograms->stages[stage]);
+    }
+    timings.threads.erase(std::remove(timings.threads.begin(), timings.threads.end(), histograms.get()), timings.threads.end());
+}
+
+void HotPathTimings::collect(HotPathStage stage, LatencyHistogram& histogram) const {
+    const size_t index = static_cast<size_t>(stage);
+    std::lock_guard<std::mutex> lock(mtx);
+    histogram.add(retired.stages[index]);
+    for (const auto* thread : threads) {
+        histogram.add(thread->stages[index]);
+    }
+}
+
+}  // namespace ovms
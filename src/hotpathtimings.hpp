@@ -0,0 +1,136 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "latencyhistogram.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Request handling stages timed for every request, independently of the model or pipeline served
+ */
+enum class HotPathStage {
+    GRPC_PREDICT,
+    REST_PREDICT,
+    REST_PARSING,
+    REST_SERIALIZATION,
+    INFERENCE,
+    PIPELINE_EXECUTION,
+    COUNT
+};
+
+constexpr size_t HOT_PATH_STAGES_COUNT = static_cast<size_t>(HotPathStage::COUNT);
+
+const char* toString(HotPathStage stage);
+
+/**
+ * @brief Process wide latency histograms of hot path stages, cheap enough to be always enabled
+ *
+ * Each thread records into its own histograms, so recording neither takes a lock nor shares cache lines
+ * with other threads. Histograms of a thread are merged into retired ones when the thread exits.
+ * Reading merges histograms of all threads and takes a lock held only while threads register or exit.
+ */
+class HotPathTimings {
+public:
+    static HotPathTimings& instance();
+
+    template <HotPathStage stage>
+    static void record(uint64_t microseconds) {
+        static_assert(stage != HotPathStage::COUNT, "Not a hot path stage.");
+        threadHistograms().stages[static_cast<size_t>(stage)].recordExclusive(microseconds);
+    }
+
+    template <HotPathStage stage>
+    static void recordSince(std::chrono::steady_clock::time_point start) {
+        record<stage>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    /**
+     * @brief Adds durations of the stage recorded by all threads so far to the histogram
+     */
+    void collect(HotPathStage stage, LatencyHistogram& histogram) const;
+
+    HotPathTimings(const HotPathTimings&) = delete;
+    HotPathTimings& operator=(const HotPathTimings&) = delete;
+
+private:
+    HotPathTimings() = default;
+
+    struct Histograms {
+        std::array<LatencyHistogram, HOT_PATH_STAGES_COUNT> stages;
+    };
+
+    class ThreadRegistration {
+    public:
+        ThreadRegistration();
+        ~ThreadRegistration();
+        Histograms& get() { return *histograms; }
+
+    private:
+        std::unique_ptr<Histograms> histograms;
+    };
+
+    static Histograms& threadHistograms() {
+        thread_local ThreadRegistration registration;
+        return registration.get();
+    }
+
+    mutable std::mutex mtx;
+    std::vector<const Histograms*> threads;
+    Histograms retired;
+};
+
+/**
+ * @brief Records duration of the stage from construction until stop or destruction, whichever comes first
+ */
+template <HotPathStage stage>
+class HotPathTimer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool stopped = false;
+
+public:
+    HotPathTimer() = default;
+
+    ~HotPathTimer() {
+        stop();
+    }
+
+    /**
+     * @brief Records the duration once
+     *
+     * @return microseconds since construction
+     */
+    uint64_t stop() {
+        const uint64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        if (!stopped) {
+            stopped = true;
+            HotPathTimings::record<stage>(microseconds);
+        }
+        return microseconds;
+    }
+
+    HotPathTimer(const HotPathTimer&) = delete;
+    HotPathTimer& operator=(const HotPathTimer&) = delete;
+};
+
+}  // namespace ovms
@@ -15,155 +15,139 @@
 //*****************************************************************************
 #include "http_rest_api_handler.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <spdlog/spdlog.h>
 
-#include "filesystem.hpp"
+#include "adminauthorization.hpp"
+#include "allocationprofile.hpp"
+#include "bulkinferencejobs.hpp"
 #include "get_model_metadata_impl.hpp"
+#include "filesystemmetrics.hpp"
+#include "hotpathtimings.hpp"
+#include "inferencescheduler.hpp"
+#include "loadprofile.hpp"
+#include "logging.hpp"
 #include "model_service.hpp"
 #include "modelinstanceunloadguard.hpp"
+#include "modelmetrics.hpp"
+#include "modelsmemorybudget.hpp"
+#include "pipeline_factory.hpp"
+#include "pipelinemetrics.hpp"
+#include "prometheus.hpp"
 #include "prediction_service_utils.hpp"
+#include "protoarena.hpp"
 #include "rest_parser.hpp"
+#include "rest_router.hpp"
 #include "rest_utils.hpp"
-
-#define DEBUG
-#include "timer.hpp"
+#include "samplingprofiler.hpp"
+#include "saturation.hpp"
+#include "sharedmemory.hpp"
+#include "streamsbudget.hpp"
+#include "tensorarena.hpp"
+#include "tracing.hpp"
+#include "trafficcapture.hpp"
 
 using tensorflow::serving::PredictRequest;
 using tensorflow::serving::PredictResponse;
 
 namespace ovms {
 
-const std::string HttpRestApiHandler::kPathRegexExp = R"((.?)\/v1\/models\/.*)";
-const std::string HttpRestApiHandler::predictionRegexExp =
-    R"((.?)\/v1\/models\/([^\/:]+)(?:(?:\/versions\/(\d+))|(?:\/labels\/(\w+)))?:(classify|regress|predict))";
-const std::string HttpRestApiHandler::modelstatusRegexExp =
-    R"((.?)\/v1\/models(?:\/([^\/:]+))?(?:(?:\/versions\/(\d+))|(?:\/labels\/(\w+)))?(?:\/(metadata))?)";
-
-Status HttpRestApiHandler::validateUrlAndMethod(
-    const std::string_view http_method,
-    const std::string& request_path,
-    std::smatch* sm) {
-
-    if (http_method != "POST" && http_method != "GET") {
-        return StatusCode::REST_UNSUPPORTED_METHOD;
-    }
-
-    if (FileSystem::isPathEscaped(request_path)) {
-        SPDLOG_ERROR("Path {} escape with .. is forbidden.", request_path);
-        return StatusCode::PATH_INVALID;
-    }
-
-    if (!std::regex_match(request_path, *sm, sanityRegex)) {
-        return StatusCode::REST_INVALID_URL;
-    }
-
-    if (http_method == "POST") {
-        if (std::regex_match(request_path, *sm, predictionRegex)) {
-            return StatusCode::OK;
-        } else if (std::regex_match(request_path, *sm, modelstatusRegex)) {
-            return StatusCode::REST_UNSUPPORTED_METHOD;
-        }
-    } else if (http_method == "GET") {
-        if (std::regex_match(request_path, *sm, modelstatusRegex)) {
-            return StatusCode::OK;
-        } else if (std::regex_match(request_path, *sm, predictionRegex)) {
-            return StatusCode::REST_UNSUPPORTED_METHOD;
-        }
-    }
-    return StatusCode::REST_INVALID_URL;
-}
-
-Status HttpRestApiHandler::parseModelVersion(std::string& model_version_str, std::optional<int64_t>& model_version) {
-    if (!model_version_str.empty()) {
-        try {
-            model_version = std::stoll(model_version_str.c_str());
-        } catch (std::exception& e) {
-            SPDLOG_ERROR("Couldn't parse model version {}", model_version_str);
-            return StatusCode::REST_COULD_NOT_PARSE_VERSION;
-        }
-    }
-    return StatusCode::OK;
-}
-
-Status HttpRestApiHandler::dispatchToProcessor(
-    const std::string_view request_path,
-    const std::string& request_body,
-    std::string* response,
-    const HttpRequestComponents& request_components) {
-
-    if (FileSystem::isPathEscaped({request_path.begin(), request_path.end()})) {
-        SPDLOG_ERROR("Path {} escape with .. is forbidden.", request_path);
-        return StatusCode::PATH_INVALID;
-    }
-
-    if (request_components.http_method == "POST") {
-        if (request_components.processing_method == "predict") {
-            return processPredictRequest(request_components.model_name, request_components.model_version,
-                request_components.model_version_label, request_body, response);
-        } else {
-            SPDLOG_WARN("Requested REST resource {} not found", std::string(request_path));
-            return StatusCode::REST_NOT_FOUND;
-        }
-    } else if (request_components.http_method == "GET") {
-        if (!request_components.model_subresource.empty() && request_components.model_subresource == "metadata") {
-            return processModelMetadataRequest(request_components.model_name, request_components.model_version,
-                request_components.model_version_label, response);
-        } else {
-            return processModelStatusRequest(request_components.model_name, request_components.model_version,
-                request_components.model_version_label, response);
-        }
-    }
-    return StatusCode::UNKNOWN_ERROR;
-}
-
 Status HttpRestApiHandler::processRequest(
     const std::string_view http_method,
     const std::string_view request_path,
     const std::string& request_body,
     std::vector<std::pair<std::string, std::string>>* headers,
-    std::string* response) {
-
-    std::smatch sm;
-    std::string request_path_str(request_path);
-    if (FileSystem::isPathEscaped(request_path_str)) {
-        SPDLOG_ERROR("Path {} escape with .. is forbidden.", request_path);
-        return StatusCode::PATH_INVALID;
-    }
+    std::string* response,
+    const deadline_t& deadline,
+    const std::string_view inference_header_length,
+    std::unique_ptr<RestPredictCall>* deferredPredict,
+    const std::string_view authorization) {
 
-    auto status = validateUrlAndMethod(http_method, request_path_str, &sm);
+    RestRoute route;
+    auto status = routeRestRequest(http_method, request_path, route);
     if (!status.ok()) {
         return status;
     }
 
     headers->clear();
     response->clear();
-    headers->push_back({"Content-Type", "application/json"});
-
-    HttpRequestComponents requestComponents;
-    requestComponents.http_method = http_method;
+    headers->emplace_back("Content-Type", "application/json");
 
-    requestComponents.model_name = sm[2];
-    std::string model_version_str = sm[3];
-    std::string model_version_label_str = sm[4];
-    if (requestComponents.http_method == "POST")
-        requestComponents.processing_method = sm[5];
-    else
-        requestComponents.model_subresource = sm[5];
-
-    status = parseModelVersion(model_version_str, requestComponents.model_version);
-    if (!status.ok())
-        return status;
+    switch (route.resource) {
+    case RestResource::SHARED_MEMORY:
+        return processSharedMemoryRequest(std::string(route.name), route.operation, request_body, response);
+    case RestResource::INFER_REQUESTS:
+        return processInferRequestsResizeRequest(std::string(route.name), route.version, route.label, request_body, authorization, response);
+    case RestResource::BULK_JOBS:
+        return processBulkJobsRequest(route.operation, route.name, request_body, authorization, response);
+    case RestResource::MODEL_STATUS:
+        return processModelStatusRequest(route.name, route.version, route.label, response);
+    case RestResource::MODEL_METADATA:
+        return processModelMetadataRequest(route.name, route.version, route.label, response);
+    case RestResource::BATCH_PREDICT:
+        if (deferredPredict != nullptr) {
+            // I/O thread would otherwise wait for inferences of all entries
+            auto call = std::make_unique<RestPredictCall>();
+            call->deadline = deadline;
+            call->batchRequest = &request_body;
+            *deferredPredict = std::move(call);
+            return StatusCode::OK;
+        }
+        return processBatchPredictRequest(request_body, response, headers, deadline);
+    case RestResource::READINESS:
+        return processReadinessRequest(response);
+    case RestResource::METRICS:
+        return processMetricsRequest(response);
+    case RestResource::PROMETHEUS_METRICS:
+        headers->clear();
+        headers->emplace_back("Content-Type", PrometheusWriter::CONTENT_TYPE);
+        return processPrometheusMetricsRequest(response);
+    case RestResource::PROFILE:
+        return processProfileRequest(request_body, authorization, headers, response);
+    case RestResource::PREDICT:
+        break;
+    }
+    if (route.operation != "predict") {
+        SPDLOG_WARN("Requested REST resource {} not found", request_path);
+        return StatusCode::REST_NOT_FOUND;
+    }
 
-    if (!model_version_label_str.empty()) {
-        requestComponents.model_version_label = model_version_label_str;
+    std::optional<size_t> binaryHeaderLength;
+    if (!inference_header_length.empty()) {
+        size_t length = 0;
+        const auto end = inference_header_length.data() + inference_header_length.size();
+        auto result = std::from_chars(inference_header_length.data(), end, length);
+        if (result.ec != std::errc() || result.ptr != end) {
+            OVMS_HOT_PATH_DEBUG("Invalid {} header value: {}", INFERENCE_HEADER_CONTENT_LENGTH_HEADER, std::string(inference_header_length));
+            return StatusCode::REST_BINARY_HEADER_INVALID;
+        }
+        binaryHeaderLength = length;
+    }
+    if (deferredPredict != nullptr) {
+        auto call = std::make_unique<RestPredictCall>();
+        status = parsePredictRequest(std::string(route.name), route.version, request_body, deadline, binaryHeaderLength, *call);
+        if (!status.ok()) {
+            return status;
+        }
+        *deferredPredict = std::move(call);
+        return StatusCode::OK;
     }
-    return dispatchToProcessor(request_path, request_body, response, requestComponents);
+    return processPredictRequest(std::string(route.name), route.version, route.label, request_body, response, deadline,
+        binaryHeaderLength, headers);
 }
 
 Status HttpRestApiHandler::processPredictRequest(
@@ -171,108 +155,333 @@ Status HttpRestApiHandler::processPredictRequest(
     const std::optional<int64_t>& modelVersion,
     const std::optional<std::string_view>& modelVersionLabel,
     const std::string& request,
-    std::string* response) {
+    std::string* response,
+    const deadline_t& deadline,
+    const std::optional<size_t>& binaryHeaderLength,
+    std::vector<std::pair<std::string, std::string>>* headers) {
     // model_version_label currently is not in use
 
-    Timer timer;
-    timer.start("total");
-    using std::chrono::microseconds;
-
-    SPDLOG_DEBUG("Processing REST request for model: {}; version: {}",
-        modelName, modelVersion.value_or(0));
-
-    ModelManager& modelManager = ModelManager::getInstance();
-    Order requestOrder;
-    tensorflow::serving::PredictResponse responseProto;
-    Status status;
-
-    if (modelManager.modelExists(modelName)) {
-        SPDLOG_DEBUG("Found model with name: {}. Searching for requested version...", modelName);
-        status = processSingleModelRequest(modelName, modelVersion, request, requestOrder, responseProto);
-    } else if (modelManager.pipelineDefinitionExists(modelName)) {
-        SPDLOG_DEBUG("Found pipeline with name: {}", modelName);
-        status = processPipelineRequest(modelName, request, requestOrder, responseProto);
-    } else {
-        SPDLOG_WARN("Model or pipeline matching request parameters not found - name: {}, version: {}", modelName, modelVersion.value_or(0));
-        status = StatusCode::MODEL_NAME_MISSING;
-    }
+    HotPathTimer<HotPathStage::REST_PREDICT> timer;
+    // parser of the call is reused by requests handled in this thread, so their tensor buffers are not allocated again
+    thread_local RestPredictCall call;
+    auto status = parsePredictRequest(modelName, modelVersion, request, deadline, binaryHeaderLength, call);
     if (!status.ok())
         return status;
-
-    status = makeJsonFromPredictResponse(responseProto, response, requestOrder);
+    status = executePredictRequest(call, response, headers);
     if (!status.ok())
         return status;
 
-    timer.stop("total");
-    SPDLOG_DEBUG("Total REST request processing time: {} ms", timer.elapsed<std::chrono::microseconds>("total") / 1000);
+    const uint64_t processingMicroseconds = timer.stop();
+    OVMS_HOT_PATH_DEBUG("Total REST request processing time: {:.3f} ms", processingMicroseconds / 1000.0);
     return StatusCode::OK;
 }
 
-Status HttpRestApiHandler::processSingleModelRequest(const std::string& modelName,
+Status HttpRestApiHandler::parsePredictRequest(
+    const std::string& modelName,
     const std::optional<int64_t>& modelVersion,
     const std::string& request,
-    Order& requestOrder,
-    tensorflow::serving::PredictResponse& responseProto) {
+    const deadline_t& deadline,
+    const std::optional<size_t>& binaryHeaderLength,
+    RestPredictCall& call) {
+    return preparePredictCall(modelName, modelVersion, deadline, binaryHeaderLength, call,
+        [&request, &binaryHeaderLength](RestParser& parser) {
+            return binaryHeaderLength.has_value() ? parser.parseBinary(request, binaryHeaderLength.value()) : parser.parse(request.c_str());
+        });
+}
 
+Status HttpRestApiHandler::preparePredictCall(
+    const std::string& modelName,
+    const std::optional<int64_t>& modelVersion,
+    const deadline_t& deadline,
+    const std::optional<size_t>& binaryHeaderLength,
+    RestPredictCall& call,
+    const std::function<Status(RestParser&)>& parse) {
+    OVMS_HOT_PATH_DEBUG("Processing REST request for model: {}; version: {}",
+        modelName, modelVersion.value_or(0));
+
+    ModelManager& modelManager = ModelManager::getInstance();
     std::shared_ptr<ModelInstance> modelInstance;
     std::unique_ptr<ModelInstanceUnloadGuard> modelInstanceUnloadGuard;
-    auto status = getModelInstance(
-        ModelManager::getInstance(),
-        modelName,
-        modelVersion.value_or(0),
-        modelInstance,
-        modelInstanceUnloadGuard);
+    if (modelManager.modelExists(modelName)) {
+        OVMS_HOT_PATH_DEBUG("Found model with name: {}. Searching for requested version...", modelName);
+        auto status = getModelInstance(modelManager, modelName, modelVersion.value_or(0), modelInstance, modelInstanceUnloadGuard);
+        if (!status.ok()) {
+            SPDLOG_WARN("Requested model instance - name: {}, version: {} - does not exist.", modelName, modelVersion.value_or(0));
+            return status;
+        }
+        call.parser.reset(modelInstance->getInputsInfo());
+    } else if (modelManager.pipelineDefinitionExists(modelName)) {
+        OVMS_HOT_PATH_DEBUG("Found pipeline with name: {}", modelName);
+        call.parser.reset({});
+    } else {
+        SPDLOG_WARN("Model or pipeline matching request parameters not found - name: {}, version: {}", modelName, modelVersion.value_or(0));
+        return StatusCode::MODEL_NAME_MISSING;
+    }
 
-    if (!status.ok()) {
-        SPDLOG_WARN("Requested model instance - name: {}, version: {} - does not exist.", modelName, modelVersion.value_or(0));
-        return status;
+    HotPathTimer<HotPathStage::REST_PARSING> timer;
+    ProfilerTag profilerTag("rest_parsing");
+    Span parseSpan("parse");
+    Status status;
+    {
+        AllocationPhaseGuard allocationPhase(AllocationPhase::PARSE);
+        status = parse(call.parser);
     }
-    Timer timer;
-    timer.start("parse");
-    RestParser requestParser(modelInstance->getInputsInfo());
-    status = requestParser.parse(request.c_str());
     if (!status.ok()) {
+        parseSpan.setError(status.string());
         return status;
     }
-    requestOrder = requestParser.getOrder();
-    timer.stop("parse");
-    SPDLOG_DEBUG("JSON request parsing time: {} ms", timer.elapsed<std::chrono::microseconds>("parse") / 1000);
+    parseSpan.end();
+    const uint64_t parsingMicroseconds = timer.stop();
+    OVMS_HOT_PATH_DEBUG("JSON request parsing time: {:.3f} ms", parsingMicroseconds / 1000.0);
 
-    tensorflow::serving::PredictRequest& requestProto = requestParser.getProto();
+    tensorflow::serving::PredictRequest& requestProto = call.parser.getProto();
     requestProto.mutable_model_spec()->set_name(modelName);
-    if (modelVersion.has_value()) {
+    if (modelInstance && modelVersion.has_value()) {
         requestProto.mutable_model_spec()->mutable_version()->set_value(modelVersion.value());
     }
-    status = inference(*modelInstance, &requestProto, &responseProto, modelInstanceUnloadGuard);
-    return status;
+    TrafficCapture::instance().capture(requestProto, modelInstance ? CapturedTarget::MODEL : CapturedTarget::PIPELINE);
+    call.modelName = modelName;
+    call.deadline = deadline;
+    call.binaryHeaderLength = binaryHeaderLength;
+    call.modelInstance = std::move(modelInstance);
+    call.modelInstanceUnloadGuard = std::move(modelInstanceUnloadGuard);
+    return StatusCode::OK;
 }
 
-Status HttpRestApiHandler::processPipelineRequest(const std::string& modelName,
-    const std::string& request,
-    Order& requestOrder,
-    tensorflow::serving::PredictResponse& responseProto) {
+Status HttpRestApiHandler::executePredictRequest(
+    RestPredictCall& call,
+    std::string* response,
+    std::vector<std::pair<std::string, std::string>>* headers) {
+    if (call.batchRequest != nullptr) {
+        return processBatchPredictRequest(*call.batchRequest, response, headers, call.deadline);
+    }
+    // response message is allocated on arena reused by requests handled in this thread
+    ThreadLocalArenaGuard arenaGuard;
+    tensorflow::serving::PredictResponse& responseProto = *arenaGuard.create<tensorflow::serving::PredictResponse>();
+    tensorflow::serving::PredictRequest& requestProto = call.parser.getProto();
+    Status status;
+    if (call.modelInstance) {
+        status = inference(*call.modelInstance, &requestProto, &responseProto, call.modelInstanceUnloadGuard, call.deadline);
+        call.modelInstanceUnloadGuard.reset();
+        call.modelInstance.reset();
+    } else {
+        status = executePipeline(call, responseProto);
+    }
+    if (!status.ok())
+        return status;
 
-    std::unique_ptr<Pipeline> pipelinePtr;
+    HotPathTimer<HotPathStage::REST_SERIALIZATION> serializationTimer;
+    ProfilerTag profilerTag("rest_serialization");
+    AllocationPhaseGuard allocationPhase(AllocationPhase::SERIALIZE);
+    if (call.binaryHeaderLength.has_value()) {
+        size_t headerLength = 0;
+        status = makeBinaryPredictResponse(responseProto, call.modelName, response, &headerLength);
+        if (!status.ok())
+            return status;
+        if (headers != nullptr) {
+            for (auto& header : *headers) {
+                if (header.first == "Content-Type") {
+                    header.second = "application/octet-stream";
+                }
+            }
+            headers->push_back({INFERENCE_HEADER_CONTENT_LENGTH_HEADER, std::to_string(headerLength)});
+        }
+    } else {
+        status = makeJsonFromPredictResponse(responseProto, response, call.parser.getOrder());
+        if (!status.ok())
+            return status;
+    }
+    return StatusCode::OK;
+}
 
-    Timer timer;
-    timer.start("parse");
-    RestParser requestParser;
-    auto status = requestParser.parse(request.c_str());
+Status HttpRestApiHandler::executePipeline(RestPredictCall& call, tensorflow::serving::PredictResponse& responseProto) {
+    std::unique_ptr<Pipeline> pipelinePtr;
+    auto status = getPipeline(ModelManager::getInstance(), pipelinePtr, &call.parser.getProto(), &responseProto);
     if (!status.ok()) {
         return status;
     }
-    requestOrder = requestParser.getOrder();
-    timer.stop("parse");
-    SPDLOG_DEBUG("JSON request parsing time: {} ms", timer.elapsed<std::chrono::microseconds>("parse") / 1000);
+    pipelinePtr->setDeadline(call.deadline);
+    return pipelinePtr->execute();
+}
 
-    tensorflow::serving::PredictRequest& requestProto = requestParser.getProto();
-    requestProto.mutable_model_spec()->set_name(modelName);
-    status = getPipeline(ModelManager::getInstance(), pipelinePtr, &requestProto, &responseProto);
+/**
+ * @brief Collects entries of batch predict request body, elements of JSON array or objects in consecutive lines
+ *
+ * @param request body
+ * @param documents parsed documents, entries point into them
+ * @param entries predict requests
+ * @param isArray set when body is JSON array
+ */
+static Status parseBatchPredictEntries(const std::string& request, std::vector<rapidjson::Document>& documents,
+    std::vector<rapidjson::Value*>& entries, bool& isArray) {
+    const auto begin = request.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return StatusCode::REST_BATCH_REQUEST_INVALID;
+    }
+    isArray = request[begin] == '[';
+    if (isArray) {
+        documents.resize(1);
+        if (documents[0].Parse(request.c_str()).HasParseError()) {
+            return StatusCode::JSON_INVALID;
+        }
+        for (auto& entry : documents[0].GetArray()) {
+            entries.push_back(&entry);
+        }
+        return StatusCode::OK;
+    }
+    size_t lineBegin = 0;
+    while (lineBegin < request.size()) {
+        auto lineEnd = std::min(request.find('\n', lineBegin), request.size());
+        std::string_view line(request.data() + lineBegin, lineEnd - lineBegin);
+        if (line.find_first_not_of(" \t\r") != std::string_view::npos) {
+            documents.emplace_back();
+            if (documents.back().Parse(line.data(), line.size()).HasParseError()) {
+                return StatusCode::JSON_INVALID;
+            }
+        }
+        lineBegin = lineEnd + 1;
+    }
+    for (auto& document : documents) {
+        entries.push_back(&document);
+    }
+    return StatusCode::OK;
+}
+
+/**
+ * @brief Removes line breaks and indentation of pretty printed JSON, so it fits into a single line.
+ * Line breaks inside of string values are escaped, so all of them are whitespace.
+ */
+static void removeLineBreaks(std::string& json) {
+    size_t end = 0;
+    for (size_t i = 0; i < json.size(); ++i) {
+        if (json[i] == '\n') {
+            while (i + 1 < json.size() && json[i + 1] == ' ') {
+                ++i;
+            }
+            continue;
+        }
+        json[end++] = json[i];
+    }
+    json.resize(end);
+}
+
+Status HttpRestApiHandler::parseBatchPredictEntry(rapidjson::Value& entry, const deadline_t& deadline, RestPredictCall& call) {
+    if (!entry.IsObject()) {
+        return StatusCode::REST_BODY_IS_NOT_AN_OBJECT;
+    }
+    auto nameItr = entry.FindMember("model_name");
+    if (nameItr == entry.MemberEnd() || !nameItr->value.IsString()) {
+        OVMS_HOT_PATH_DEBUG("Batch predict request entry requires model_name string");
+        return StatusCode::REST_BATCH_REQUEST_INVALID;
+    }
+    std::optional<int64_t> modelVersion;
+    auto versionItr = entry.FindMember("model_version");
+    if (versionItr != entry.MemberEnd()) {
+        if (!versionItr->value.IsInt64() || versionItr->value.GetInt64() < 0) {
+            return StatusCode::REST_COULD_NOT_PARSE_VERSION;
+        }
+        modelVersion = versionItr->value.GetInt64();
+    }
+    return preparePredictCall(nameItr->value.GetString(), modelVersion, deadline, std::nullopt, call,
+        [&entry](RestParser& parser) { return parser.parse(entry); });
+}
+
+Status HttpRestApiHandler::processBatchPredictRequest(
+    const std::string& request,
+    std::string* response,
+    std::vector<std::pair<std::string, std::string>>* headers,
+    const deadline_t& deadline) {
+    const auto batchStart = std::chrono::steady_clock::now();
+    std::vector<rapidjson::Document> documents;
+    std::vector<rapidjson::Value*> entries;
+    bool isArray = false;
+    auto status = parseBatchPredictEntries(request, documents, entries, isArray);
     if (!status.ok()) {
         return status;
     }
-    status = pipelinePtr->execute();
-    return status;
+    if (entries.empty() || entries.size() > MAX_BATCH_PREDICT_REQUESTS) {
+        OVMS_HOT_PATH_DEBUG("Batch predict request has {} entries, it should have from 1 to {}", entries.size(), MAX_BATCH_PREDICT_REQUESTS);
+        return StatusCode::REST_BATCH_REQUEST_INVALID;
+    }
+    OVMS_HOT_PATH_DEBUG("Processing batch predict request with {} entries", entries.size());
+
+    struct BatchPredictEntry {
+        RestPredictCall call;
+        tensorflow::serving::PredictResponse* response = nullptr;
+        Status status;
+    };
+    // responses are allocated on arena reused by requests handled in this thread
+    ThreadLocalArenaGuard arenaGuard;
+    std::vector<BatchPredictEntry> batch(entries.size());
+    std::mutex mutex;
+    std::condition_variable entryFinished;
+    size_t inFlight = 0;
+    // model entries are inferred concurrently, so they can be gathered by dynamic batching,
+    // next entries are parsed in the meantime
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto& entry = batch[i];
+        entry.response = arenaGuard.create<tensorflow::serving::PredictResponse>();
+        entry.status = parseBatchPredictEntry(*entries[i], deadline, entry.call);
+        if (!entry.status.ok()) {
+            continue;
+        }
+        if (!entry.call.modelInstance) {
+            entry.status = executePipeline(entry.call, *entry.response);
+            continue;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            entryFinished.wait(lock, [&inFlight] { return inFlight < MAX_BATCH_PREDICT_IN_FLIGHT; });
+            ++inFlight;
+        }
+        inferenceAsync(
+            std::move(entry.call.modelInstance), &entry.call.parser.getProto(), entry.response, std::move(entry.call.modelInstanceUnloadGuard),
+            [&entry, &mutex, &entryFinished, &inFlight](Status status) {
+                std::lock_guard<std::mutex> lock(mutex);
+                entry.status = status;
+                --inFlight;
+                entryFinished.notify_all();
+            },
+            deadline);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        entryFinished.wait(lock, [&inFlight] { return inFlight == 0; });
+    }
+
+    // results are written in the order of entries, one line each
+    response->clear();
+    if (isArray) {
+        response->append("[\n");
+    }
+    std::string line;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto& entry = batch[i];
+        if (entry.status.ok()) {
+            entry.status = makeJsonFromPredictResponse(*entry.response, &line, entry.call.parser.getOrder());
+        }
+        if (!entry.status.ok()) {
+            line = "{\"error\": \"" + entry.status.string() + "\"}";
+        }
+        removeLineBreaks(line);
+        response->append(line);
+        if (isArray && i + 1 < batch.size()) {
+            response->push_back(',');
+        }
+        response->push_back('\n');
+    }
+    if (isArray) {
+        response->push_back(']');
+    } else if (headers != nullptr) {
+        for (auto& header : *headers) {
+            if (header.first == "Content-Type") {
+                header.second = "application/x-ndjson";
+            }
+        }
+    }
+    OVMS_HOT_PATH_DEBUG("Total REST batch predict request processing time: {:.3f} ms",
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count());
+    return StatusCode::OK;
 }
 
 Status HttpRestApiHandler::processModelMetadataRequest(
@@ -282,22 +491,13 @@ Status HttpRestApiHandler::processModelMetadataRequest(
     std::string* response) {
     // model_version_label currently is not in use
     tensorflow::serving::GetModelMetadataRequest grpc_request;
-    tensorflow::serving::GetModelMetadataResponse grpc_response;
     Status status;
     std::string modelName(model_name);
     status = GetModelMetadataImpl::createGrpcRequest(modelName, model_version, &grpc_request);
     if (!status.ok()) {
         return status;
     }
-    status = GetModelMetadataImpl::getModelStatus(&grpc_request, &grpc_response);
-    if (!status.ok()) {
-        return status;
-    }
-    status = GetModelMetadataImpl::serializeResponse2Json(&grpc_response, response);
-    if (!status.ok()) {
-        return status;
-    }
-    return StatusCode::OK;
+    return GetModelMetadataImpl::getModelStatusJson(&grpc_request, response);
 }
 
 Status HttpRestApiHandler::processModelStatusRequest(
@@ -306,7 +506,7 @@ Status HttpRestApiHandler::processModelStatusRequest(
     const std::optional<std::string_view>& model_version_label,
     std::string* response) {
     // model_version_label currently is not in use
-    SPDLOG_DEBUG("Processing model status request");
+    OVMS_HOT_PATH_DEBUG("Processing model status request");
     tensorflow::serving::GetModelStatusRequest grpc_request;
     tensorflow::serving::GetModelStatusResponse grpc_response;
     Status status;
@@ -326,4 +526,712 @@ Status HttpRestApiHandler::processModelStatusRequest(
     return StatusCode::OK;
 }
 
+Status HttpRestApiHandler::processSharedMemoryRequest(
+    const std::string& regionName,
+    const std::string_view operation,
+    const std::string& request,
+    std::string* response) {
+    auto& registry = SharedMemoryRegistry::getInstance();
+    Status status;
+    if (operation == "unregister") {
+        status = registry.unregisterRegion(regionName);
+    } else {
+        // {"key": "/shm_object_name", "byte_size": 1048576}
+        rapidjson::Document doc;
+        if (doc.Parse(request.c_str()).HasParseError() || !doc.IsObject()) {
+            return StatusCode::REST_BODY_IS_NOT_AN_OBJECT;
+        }
+        auto key = doc.FindMember("key");
+        auto byteSize = doc.FindMember("byte_size");
+        if (key == doc.MemberEnd() || !key->value.IsString() ||
+            byteSize == doc.MemberEnd() || !byteSize->value.IsUint64()) {
+            OVMS_HOT_PATH_DEBUG("Shared memory region registration requires key string and byte_size number");
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+        status = registry.registerRegion(regionName, key->value.GetString(), byteSize->value.GetUint64());
+    }
+    if (!status.ok()) {
+        return status;
+    }
+    *response = "{}";
+    return StatusCode::OK;
+}
+
+Status HttpRestApiHandler::processInferRequestsResizeRequest(
+    const std::string& modelName,
+    const std::optional<int64_t>& modelVersion,
+    const std::optional<std::string_view>& modelVersionLabel,
+    const std::string& request,
+    const std::string_view authorization,
+    std::string* response) {
+    auto status = AdminAuthorization::instance().authorize(authorization);
+    if (!status.ok()) {
+        return status;
+    }
+    if (modelVersionLabel.has_value()) {
+        // version labels are not resolved yet, resizing default version instead would change a model nobody asked for
+        SPDLOG_DEBUG("Infer requests resize of model: {} requested with version label: {} which is not supported", modelName, modelVersionLabel.value());
+        return StatusCode::REST_INVALID_URL;
+    }
+    // {"nireq": 8}
+    rapidjson::Document doc;
+    if (doc.Parse(request.c_str()).HasParseError() || !doc.IsObject()) {
+        return StatusCode::REST_BODY_IS_NOT_AN_OBJECT;
+    }
+    auto nireq = doc.FindMember("nireq");
+    if (nireq == doc.MemberEnd() || !nireq->value.IsUint()) {
+        SPDLOG_DEBUG("Infer requests resize requires nireq number");
+        return StatusCode::REST_MALFORMED_REQUEST;
+    }
+    auto instance = ModelManager::getInstance().findModelInstance(modelName, modelVersion.value_or(0));
+    if (!instance) {
+        return StatusCode::MODEL_MISSING;
+    }
+    uint32_t appliedNireq = 0;
+    status = instance->resizeInferRequests(nireq->value.GetUint(), appliedNireq);
+    if (!status.ok()) {
+        return status;
+    }
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("nireq");
+    writer.Uint(appliedNireq);
+    writer.EndObject();
+    response->assign(buffer.GetString());
+    return StatusCode::OK;
+}
+
+static uint64_t toUnixMilliseconds(const std::chrono::system_clock::time_point& time) {
+    if (time == std::chrono::system_clock::time_point()) {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+static void writeBulkJobStatus(rapidjson::Writer<rapidjson::StringBuffer>& writer, const BulkJobStatus& job) {
+    writer.StartObject();
+    writer.Key("id");
+    writer.Uint64(job.id);
+    writer.Key("model_name");
+    writer.String(job.spec.servableName.c_str());
+    writer.Key("model_version");
+    writer.Int64(job.spec.version);
+    writer.Key("output_path");
+    writer.String(job.spec.outputPath.c_str());
+    writer.Key("state");
+    writer.String(toString(job.state));
+    writer.Key("shards_total");
+    writer.Uint64(job.shardsTotal);
+    writer.Key("shards_done");
+    writer.Uint64(job.shardsDone);
+    writer.Key("batches_done");
+    writer.Uint64(job.batchesDone);
+    writer.Key("records_done");
+    writer.Uint64(job.recordsDone);
+    writer.Key("yields");
+    writer.Uint64(job.yields);
+    writer.Key("submitted_ms");
+    writer.Uint64(toUnixMilliseconds(job.submitted));
+    writer.Key("started_ms");
+    writer.Uint64(toUnixMilliseconds(job.started));
+    writer.Key("finished_ms");
+    writer.Uint64(toUnixMilliseconds(job.finished));
+    if (!job.error.empty()) {
+        writer.Key("error");
+        writer.String(job.error.c_str());
+    }
+    writer.EndObject();
+}
+
+static Status parseBulkJobSpec(const std::string& request, BulkJobSpec& spec) {
+    // {"model_name": "resnet", "inputs": {"data": "s3://bucket/dataset/data"}, "output_path": "s3://bucket/results", "batch_size": 32}
+    rapidjson::Document doc;
+    if (doc.Parse(request.c_str()).HasParseError() || !doc.IsObject()) {
+        return StatusCode::REST_BODY_IS_NOT_AN_OBJECT;
+    }
+    auto name = doc.FindMember("model_name");
+    auto inputs = doc.FindMember("inputs");
+    auto outputPath = doc.FindMember("output_path");
+    if (name == doc.MemberEnd() || !name->value.IsString() ||
+        inputs == doc.MemberEnd() || !inputs->value.IsObject() || inputs->value.MemberCount() == 0 ||
+        outputPath == doc.MemberEnd() || !outputPath->value.IsString()) {
+        SPDLOG_DEBUG("Bulk job requires model_name string, inputs object and output_path string");
+        return StatusCode::REST_MALFORMED_REQUEST;
+    }
+    spec.servableName = name->value.GetString();
+    spec.outputPath = outputPath->value.GetString();
+    for (const auto& input : inputs->value.GetObject()) {
+        if (!input.value.IsString()) {
+            SPDLOG_DEBUG("Bulk job input: {} directory has to be a string", input.name.GetString());
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+        spec.inputs[input.name.GetString()] = input.value.GetString();
+    }
+    auto version = doc.FindMember("model_version");
+    if (version != doc.MemberEnd()) {
+        if (!version->value.IsInt64() || version->value.GetInt64() < 0) {
+            return StatusCode::REST_COULD_NOT_PARSE_VERSION;
+        }
+        spec.version = version->value.GetInt64();
+    }
+    for (auto [key, value] : {std::make_pair("batch_size", &spec.batchSize), std::make_pair("parallelism", &spec.parallelism)}) {
+        auto member = doc.FindMember(key);
+        if (member == doc.MemberEnd()) {
+            continue;
+        }
+        if (!member->value.IsUint()) {
+            SPDLOG_DEBUG("Bulk job {} has to be a non negative number", key);
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+        *value = member->value.GetUint();
+    }
+    return StatusCode::OK;
+}
+
+Status HttpRestApiHandler::processBulkJobsRequest(
+    const std::string_view operation,
+    const std::string_view jobId,
+    const std::string& request,
+    const std::string_view authorization,
+    std::string* response) {
+    auto& jobs = BulkInferenceJobs::instance();
+    if (!jobs.isEnabled()) {
+        return StatusCode::BULK_JOBS_DISABLED;
+    }
+    // jobs read and write storage with permissions of the server
+    auto status = AdminAuthorization::instance().authorize(authorization);
+    if (!status.ok()) {
+        return status;
+    }
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    if (operation == "list") {
+        writer.StartObject();
+        writer.Key("jobs");
+        writer.StartArray();
+        for (const auto& job : jobs.list()) {
+            writeBulkJobStatus(writer, job);
+        }
+        writer.EndArray();
+        writer.EndObject();
+        response->assign(buffer.GetString(), buffer.GetSize());
+        return StatusCode::OK;
+    }
+    uint64_t id = 0;
+    if (operation == "submit") {
+        BulkJobSpec spec;
+        status = parseBulkJobSpec(request, spec);
+        if (status.ok()) {
+            status = jobs.submit(spec, id);
+        }
+    } else {
+        auto result = std::from_chars(jobId.data(), jobId.data() + jobId.size(), id);
+        if (result.ec != std::errc()) {
+            return StatusCode::BULK_JOB_NOT_FOUND;
+        }
+        if (operation == "cancel") {
+            status = jobs.cancel(id);
+        }
+    }
+    if (!status.ok()) {
+        return status;
+    }
+    BulkJobStatus job;
+    status = jobs.getStatus(id, job);
+    if (!status.ok()) {
+        return status;
+    }
+    writeBulkJobStatus(writer, job);
+    response->assign(buffer.GetString(), buffer.GetSize());
+    return StatusCode::OK;
+}
+
+static Status parseProfileOptions(const std::string& request, ProfileOptions& options) {
+    // {"seconds": 10, "frequency": 99, "format": "folded"}, all fields are optional
+    if (request.empty()) {
+        return StatusCode::OK;
+    }
+    rapidjson::Document doc;
+    if (doc.Parse(request.c_str()).HasParseError() || !doc.IsObject()) {
+        return StatusCode::REST_BODY_IS_NOT_AN_OBJECT;
+    }
+    auto seconds = doc.FindMember("seconds");
+    if (seconds != doc.MemberEnd()) {
+        if (!seconds->value.IsNumber()) {
+            SPDLOG_DEBUG("Profile seconds has to be a number");
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+        options.duration = std::chrono::milliseconds(static_cast<int64_t>(seconds->value.GetDouble() * 1000));
+    }
+    auto frequency = doc.FindMember("frequency");
+    if (frequency != doc.MemberEnd()) {
+        if (!frequency->value.IsUint()) {
+            SPDLOG_DEBUG("Profile frequency has to be a non negative number");
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+        options.frequency = frequency->value.GetUint();
+    }
+    auto format = doc.FindMember("format");
+    if (format != doc.MemberEnd()) {
+        const std::string_view value = format->value.IsString() ? format->value.GetString() : "";
+        if (value == "folded") {
+            options.format = ProfileFormat::FOLDED;
+        } else if (value == "pprof") {
+            options.format = ProfileFormat::PPROF;
+        } else {
+            SPDLOG_DEBUG("Profile format has to be folded or pprof");
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+    }
+    return StatusCode::OK;
+}
+
+Status HttpRestApiHandler::processProfileRequest(
+    const std::string& request,
+    const std::string_view authorization,
+    std::vector<std::pair<std::string, std::string>>* headers,
+    std::string* response) {
+    auto status = AdminAuthorization::instance().authorize(authorization);
+    if (!status.ok()) {
+        return status;
+    }
+    ProfileOptions options;
+    status = parseProfileOptions(request, options);
+    if (!status.ok()) {
+        return status;
+    }
+    status = SamplingProfiler::instance().profile(options, *response);
+    if (!status.ok()) {
+        response->clear();
+        return status;
+    }
+    headers->clear();
+    headers->emplace_back("Content-Type", options.format == ProfileFormat::FOLDED ? "text/plain" : "application/octet-stream");
+    return StatusCode::OK;
+}
+
+Status HttpRestApiHandler::processReadinessRequest(std::string* response) {
+    auto& monitor = SaturationMonitor::instance();
+    const auto report = monitor.measure(ModelManager::getInstance());
+    const bool saturated = monitor.getThreshold() > 0.0 && report.saturation > monitor.getThreshold();
+    const auto modelsReadiness = ModelManager::getInstance().getModelsReadiness();
+    const bool ready = !saturated && modelsReadiness.coreModelsReady;
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("ready");
+    writer.Bool(ready);
+    writer.Key("core_models_ready");
+    writer.Bool(modelsReadiness.coreModelsReady);
+    writer.Key("not_ready_models");
+    writer.StartArray();
+    for (const auto& name : modelsReadiness.notReadyModels) {
+        writer.String(name.c_str());
+    }
+    writer.EndArray();
+    writer.Key("saturation");
+    writer.Double(report.saturation);
+    writer.Key("threshold");
+    writer.Double(monitor.getThreshold());
+    writer.Key("network_requests");
+    writer.Uint64(report.networkRequests);
+    writer.Key("rest_queued_requests");
+    writer.Uint64(report.restQueuedRequests);
+    writer.Key("models");
+    writer.StartArray();
+    for (const auto& model : report.models) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(model.name.c_str());
+        writer.Key("version");
+        writer.Int64(model.version);
+        writer.Key("in_flight_requests");
+        writer.Uint64(model.inFlightRequests);
+        writer.Key("streams");
+        writer.Uint64(model.streams);
+        writer.Key("idle_streams");
+        writer.Uint64(model.idleStreams);
+        writer.Key("waiting_requests");
+        writer.Uint64(model.waitingRequests);
+        writer.Key("saturation");
+        writer.Double(model.saturation());
+        writer.Key("response_cache_hits");
+        writer.Uint64(model.responseCacheHits);
+        writer.Key("response_cache_misses");
+        writer.Uint64(model.responseCacheMisses);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    response->assign(buffer.GetString(), buffer.GetSize());
+    if (!modelsReadiness.coreModelsReady) {
+        return StatusCode::CORE_MODELS_NOT_READY;
+    }
+    return saturated ? StatusCode::SERVER_SATURATED : StatusCode::OK;
+}
+
+static void writeLatencyHistogram(rapidjson::Writer<rapidjson::StringBuffer>& writer, const LatencyHistogram& histogram) {
+    writer.StartObject();
+    writer.Key("count");
+    writer.Uint64(histogram.getCount());
+    writer.Key("mean_us");
+    writer.Double(histogram.getMean());
+    writer.Key("p50_us");
+    writer.Uint64(histogram.getPercentile(50));
+    writer.Key("p90_us");
+    writer.Uint64(histogram.getPercentile(90));
+    writer.Key("p99_us");
+    writer.Uint64(histogram.getPercentile(99));
+    writer.Key("max_us");
+    writer.Uint64(histogram.getMax());
+    writer.EndObject();
+}
+
+Status HttpRestApiHandler::processMetricsRequest(std::string* response) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("pipelines");
+    writer.StartArray();
+    ModelManager::getInstance().getPipelineFactory().forEachDefinition([&writer](const PipelineDefinition& definition) {
+        if (definition.getStateCode() == PipelineDefinitionStateCode::RETIRED) {
+            return;
+        }
+        const auto& metrics = definition.getMetrics();
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(definition.getName().c_str());
+        writer.Key("end_to_end");
+        writeLatencyHistogram(writer, metrics.getEndToEnd());
+        writer.Key("nodes");
+        writer.StartArray();
+        for (const auto& [nodeName, nodeMetrics] : metrics.getNodes()) {
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(nodeName.c_str());
+            for (size_t stage = 0; stage < NODE_STAGES_COUNT; ++stage) {
+                writer.Key(toString(static_cast<NodeStage>(stage)));
+                writeLatencyHistogram(writer, nodeMetrics->get(static_cast<NodeStage>(stage)));
+            }
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    });
+    writer.EndArray();
+    writer.Key("models");
+    writer.StartArray();
+    for (const auto& instance : ModelManager::getInstance().getModelInstances()) {
+        if (instance->getStatus().getState() != ModelVersionState::AVAILABLE) {
+            continue;
+        }
+        const auto usage = instance->getMemoryUsage();
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(instance->getName().c_str());
+        writer.Key("version");
+        writer.Int64(instance->getVersion());
+        writer.Key("memory");
+        writer.StartObject();
+        writer.Key("network_bytes");
+        writer.Uint64(usage.network);
+        writer.Key("executable_network_bytes");
+        writer.Uint64(usage.executableNetwork);
+        writer.Key("infer_requests_bytes");
+        writer.Uint64(usage.inferRequests);
+        writer.Key("response_cache_bytes");
+        writer.Uint64(usage.responseCache);
+        writer.Key("total_bytes");
+        writer.Uint64(usage.total());
+        writer.EndObject();
+        const auto loadProfile = instance->getLoadProfile();
+        writer.Key("load_profile");
+        writer.StartObject();
+        writer.Key("total_us");
+        writer.Uint64(loadProfile.totalMicroseconds);
+        for (size_t phase = 0; phase < LOAD_PHASES_COUNT; ++phase) {
+            writer.Key((std::string(toString(static_cast<LoadPhase>(phase))) + "_us").c_str());
+            writer.Uint64(loadProfile.get(static_cast<LoadPhase>(phase)));
+        }
+        writer.EndObject();
+        const auto& metrics = *instance->getMetrics();
+        writer.Key("statistics");
+        writer.StartObject();
+        writer.Key("requests");
+        writer.Uint64(metrics.getRequests());
+        writer.Key("errors");
+        writer.Uint64(metrics.getErrors());
+        writer.Key("requests_per_second");
+        writer.Double(metrics.getRequestsPerSecond());
+        for (size_t stage = 0; stage < MODEL_STAGES_COUNT; ++stage) {
+            writer.Key(toString(static_cast<ModelStage>(stage)));
+            writeLatencyHistogram(writer, metrics.get(static_cast<ModelStage>(stage)));
+        }
+        writer.Key("batch_sizes");
+        writer.StartArray();
+        for (size_t bucket = 0; bucket < ModelMetrics::BATCH_SIZE_BUCKETS_COUNT; ++bucket) {
+            if (metrics.getBatchSizeCount(bucket) == 0) {
+                continue;
+            }
+            writer.StartObject();
+            writer.Key("max_batch_size");
+            writer.Uint64(ModelMetrics::getBatchSizeBucketUpperBound(bucket));
+            writer.Key("count");
+            writer.Uint64(metrics.getBatchSizeCount(bucket));
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        // every replica has its own batcher, which adapts to the requests routed to it
+        const auto batchers = instance->getDynamicBatchers();
+        const bool adaptiveBatching = !batchers.empty() && batchers.front()->getAdaptiveController() != nullptr;
+        if (adaptiveBatching) {
+            writer.Key("adaptive_batching");
+            writer.StartArray();
+        }
+        for (size_t replica = 0; adaptiveBatching && replica < batchers.size(); ++replica) {
+            const auto& controller = *batchers[replica]->getAdaptiveController();
+            const auto decision = controller.getDecision();
+            writer.StartObject();
+            writer.Key("replica");
+            writer.Uint64(replica);
+            writer.Key("latency_slo_us");
+            writer.Int64(controller.getLatencySlo().count());
+            writer.Key("target_batch_size");
+            writer.Uint64(decision.targetBatchSize);
+            writer.Key("queue_delay_us");
+            writer.Int64(decision.queueDelay.count());
+            writer.Key("arrival_rate");
+            writer.Double(decision.arrivalRate);
+            writer.Key("observed_p99_us");
+            writer.Uint64(decision.observedP99Microseconds);
+            writer.Key("headroom");
+            writer.Double(decision.headroom);
+            writer.EndObject();
+        }
+        if (adaptiveBatching) {
+            writer.EndArray();
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+    const auto& memoryBudget = ModelsMemoryBudget::instance();
+    writer.Key("models_memory");
+    writer.StartObject();
+    writer.Key("used_bytes");
+    writer.Uint64(memoryBudget.getUsed());
+    writer.Key("budget_bytes");
+    writer.Uint64(memoryBudget.getLimit());
+    writer.Key("process_resident_bytes");
+    writer.Uint64(ModelsMemoryBudget::getResidentMemory());
+    writer.EndObject();
+    writer.Key("hot_path");
+    writer.StartObject();
+    for (size_t stage = 0; stage < HOT_PATH_STAGES_COUNT; ++stage) {
+        LatencyHistogram histogram;
+        HotPathTimings::instance().collect(static_cast<HotPathStage>(stage), histogram);
+        writer.Key(toString(static_cast<HotPathStage>(stage)));
+        writeLatencyHistogram(writer, histogram);
+    }
+    writer.EndObject();
+    if (AllocationProfile::ENABLED) {
+        writer.Key("allocations");
+        writer.StartObject();
+        for (size_t phase = 0; phase < ALLOCATION_PHASES_COUNT; ++phase) {
+            const auto counters = AllocationProfile::get(static_cast<AllocationPhase>(phase));
+            writer.Key(toString(static_cast<AllocationPhase>(phase)));
+            writer.StartObject();
+            writer.Key("entries");
+            writer.Uint64(counters.entries);
+            writer.Key("allocations");
+            writer.Uint64(counters.allocations);
+            writer.Key("bytes");
+            writer.Uint64(counters.bytes);
+            writer.Key("allocations_per_entry");
+            writer.Double(counters.entries > 0 ? static_cast<double>(counters.allocations) / counters.entries : 0.0);
+            writer.Key("bytes_per_entry");
+            writer.Double(counters.entries > 0 ? static_cast<double>(counters.bytes) / counters.entries : 0.0);
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+    writer.EndObject();
+    response->assign(buffer.GetString(), buffer.GetSize());
+    return StatusCode::OK;
+}
+
+Status HttpRestApiHandler::processPrometheusMetricsRequest(std::string* response) {
+    PrometheusWriter writer;
+    const auto instances = ModelManager::getInstance().getModelInstances();
+    auto versionLabels = [](const ModelInstance& instance) -> PrometheusWriter::labels_t {
+        return {{"name", instance.getName()}, {"version", std::to_string(instance.getVersion())}};
+    };
+    for (const auto& instance : instances) {
+        writer.counter("ovms_requests_total", "Predict requests of model version", versionLabels(*instance), instance->getMetrics()->getRequests());
+    }
+    for (const auto& instance : instances) {
+        writer.counter("ovms_request_errors_total", "Predict requests of model version which ended with an error", versionLabels(*instance),
+            instance->getMetrics()->getErrors());
+    }
+    for (const auto& instance : instances) {
+        for (size_t stage = 0; stage < MODEL_STAGES_COUNT; ++stage) {
+            auto labels = versionLabels(*instance);
+            labels.emplace_back("stage", toString(static_cast<ModelStage>(stage)));
+            writer.histogram("ovms_inference_stage_duration_seconds", "Duration of model version inference stages", labels,
+                instance->getMetrics()->get(static_cast<ModelStage>(stage)));
+        }
+    }
+    for (const auto& instance : instances) {
+        writer.histogram("ovms_model_load_duration_seconds", "Duration of model version loads", versionLabels(*instance),
+            instance->getMetrics()->getLoads());
+    }
+    for (const auto& instance : instances) {
+        writer.histogram("ovms_model_reload_duration_seconds", "Duration of model version reloads", versionLabels(*instance),
+            instance->getMetrics()->getReloads());
+    }
+    const auto report = SaturationMonitor::instance().measure(ModelManager::getInstance());
+    auto saturationLabels = [](const ModelSaturation& model) -> PrometheusWriter::labels_t {
+        return {{"name", model.name}, {"version", std::to_string(model.version)}};
+    };
+    for (const auto& model : report.models) {
+        writer.gauge("ovms_streams", "Inference streams of available model version", saturationLabels(model), model.streams);
+    }
+    for (const auto& model : report.models) {
+        writer.gauge("ovms_idle_streams", "Idle inference streams of available model version", saturationLabels(model), model.idleStreams);
+    }
+    for (const auto& model : report.models) {
+        writer.gauge("ovms_waiting_requests", "Requests waiting for an idle inference stream", saturationLabels(model), model.waitingRequests);
+    }
+    std::vector<std::pair<std::string, const PipelineMetrics*>> pipelines;
+    ModelManager::getInstance().getPipelineFactory().forEachDefinition([&pipelines](const PipelineDefinition& definition) {
+        if (definition.getStateCode() != PipelineDefinitionStateCode::RETIRED) {
+            pipelines.emplace_back(definition.getName(), &definition.getMetrics());
+        }
+    });
+    for (const auto& [name, metrics] : pipelines) {
+        writer.counter("ovms_pipeline_requests_total", "Requests of pipeline", {{"name", name}}, metrics->getEndToEnd().getCount());
+    }
+    for (const auto& [name, metrics] : pipelines) {
+        writer.counter("ovms_pipeline_request_errors_total", "Requests of pipeline which ended with an error", {{"name", name}}, metrics->getErrors());
+    }
+    for (const auto& [name, metrics] : pipelines) {
+        writer.histogram("ovms_pipeline_duration_seconds", "End to end duration of pipeline requests", {{"name", name}}, metrics->getEndToEnd());
+    }
+    const auto backends = FileSystemMetrics::instance().getBackends();
+    for (const auto& [backend, metrics] : backends) {
+        writer.histogram("ovms_model_download_duration_seconds", "Duration of model downloads from storage", {{"backend", backend}}, metrics->downloads);
+    }
+    for (const auto& [backend, metrics] : backends) {
+        writer.counter("ovms_model_download_failures_total", "Failed model downloads from storage", {{"backend", backend}},
+            metrics->failures.load(std::memory_order_relaxed));
+    }
+    // only operations which were called are reported
+    auto forEachOperation = [&backends](const std::function<void(const PrometheusWriter::labels_t&, const FileSystemMetrics::Operation&)>& write) {
+        for (const auto& [backend, metrics] : backends) {
+            for (size_t i = 0; i < metrics->operations.size(); ++i) {
+                if (metrics->operations[i].calls.getCount() > 0) {
+                    write({{"backend", backend}, {"operation", toString(static_cast<FileSystemOperation>(i))}}, metrics->operations[i]);
+                }
+            }
+        }
+    };
+    forEachOperation([&writer](const PrometheusWriter::labels_t& labels, const FileSystemMetrics::Operation& operation) {
+        writer.histogram("ovms_storage_operation_duration_seconds", "Duration of storage calls", labels, operation.calls);
+    });
+    forEachOperation([&writer](const PrometheusWriter::labels_t& labels, const FileSystemMetrics::Operation& operation) {
+        writer.counter("ovms_storage_operation_errors_total", "Storage calls which failed", labels, operation.errors.load(std::memory_order_relaxed));
+    });
+    forEachOperation([&writer](const PrometheusWriter::labels_t& labels, const FileSystemMetrics::Operation& operation) {
+        writer.counter("ovms_storage_operation_bytes_total", "Bytes read or downloaded by storage calls", labels, operation.bytes.load(std::memory_order_relaxed));
+    });
+    for (size_t stage = 0; stage < HOT_PATH_STAGES_COUNT; ++stage) {
+        LatencyHistogram histogram;
+        HotPathTimings::instance().collect(static_cast<HotPathStage>(stage), histogram);
+        writer.histogram("ovms_hot_path_duration_seconds", "Duration of request handling stages of all models and pipelines",
+            {{"stage", toString(static_cast<HotPathStage>(stage))}}, histogram);
+    }
+    if (AllocationProfile::ENABLED) {
+        for (size_t phase = 0; phase < ALLOCATION_PHASES_COUNT; ++phase) {
+            writer.counter("ovms_allocations_total", "Heap allocations made in request handling phase", {{"phase", toString(static_cast<AllocationPhase>(phase))}},
+                AllocationProfile::get(static_cast<AllocationPhase>(phase)).allocations);
+        }
+        for (size_t phase = 0; phase < ALLOCATION_PHASES_COUNT; ++phase) {
+            writer.counter("ovms_allocated_bytes_total", "Heap bytes allocated in request handling phase", {{"phase", toString(static_cast<AllocationPhase>(phase))}},
+                AllocationProfile::get(static_cast<AllocationPhase>(phase)).bytes);
+        }
+        for (size_t phase = 0; phase < ALLOCATION_PHASES_COUNT; ++phase) {
+            writer.counter("ovms_allocation_phase_entries_total", "Entries into request handling phase", {{"phase", toString(static_cast<AllocationPhase>(phase))}},
+                AllocationProfile::get(static_cast<AllocationPhase>(phase)).entries);
+        }
+    }
+    auto& tensorArena = TensorArena::instance();
+    if (tensorArena.isEnabled()) {
+        const auto arenaNodes = tensorArena.getStatistics();
+        for (const auto& node : arenaNodes) {
+            writer.gauge("ovms_tensor_arena_reserved_bytes", "Memory mapped by tensor arena", {{"numa_node", std::to_string(node.numaNode)}}, node.reservedBytes);
+        }
+        for (const auto& node : arenaNodes) {
+            writer.gauge("ovms_tensor_arena_huge_tlb_bytes", "Tensor arena memory backed by reserved huge pages", {{"numa_node", std::to_string(node.numaNode)}},
+                node.hugeTlbBytes);
+        }
+        for (const auto& node : arenaNodes) {
+            writer.gauge("ovms_tensor_arena_used_bytes", "Tensor arena memory of blobs in use", {{"numa_node", std::to_string(node.numaNode)}}, node.usedBytes);
+        }
+        for (const auto& node : arenaNodes) {
+            writer.counter("ovms_tensor_arena_allocations_total", "Blobs allocated from tensor arena", {{"numa_node", std::to_string(node.numaNode)}},
+                node.allocations);
+        }
+        for (const auto& node : arenaNodes) {
+            writer.counter("ovms_tensor_arena_reused_allocations_total", "Blobs allocated from memory freed earlier", {{"numa_node", std::to_string(node.numaNode)}},
+                node.reusedAllocations);
+        }
+        writer.counter("ovms_tensor_arena_heap_allocations_total", "Blobs allocated on the heap because tensor arena limit was reached", {},
+            tensorArena.getHeapAllocations());
+    }
+    auto& scheduler = InferenceScheduler::instance();
+    if (scheduler.isEnabled()) {
+        writer.gauge("ovms_inference_slots", "Inferences allowed to run at once", {}, scheduler.getSlotsCount());
+        writer.gauge("ovms_inference_slots_used", "Inference slots currently granted", {}, scheduler.getUsedSlotsCount());
+        const auto clients = scheduler.getStatistics();
+        for (const auto& client : clients) {
+            writer.counter("ovms_scheduler_grants_total", "Inference slots granted to model version", {{"name", client.name}, {"priority", toString(client.priority)}},
+                client.grants);
+        }
+        for (const auto& client : clients) {
+            writer.counter("ovms_scheduler_delayed_grants_total", "Inference slots granted after waiting for another model to release one",
+                {{"name", client.name}, {"priority", toString(client.priority)}}, client.delayedGrants);
+        }
+        for (const auto& client : clients) {
+            writer.counter("ovms_scheduler_wait_microseconds_total", "Time requests of model version waited for inference slots",
+                {{"name", client.name}, {"priority", toString(client.priority)}}, client.waitMicroseconds);
+        }
+        for (const auto& client : clients) {
+            writer.gauge("ovms_scheduler_waiting_requests", "Requests of model version waiting for inference slot",
+                {{"name", client.name}, {"priority", toString(client.priority)}}, client.waiting);
+        }
+    }
+    auto& streamsBudget = StreamsBudget::instance();
+    if (streamsBudget.isEnabled()) {
+        writer.gauge("ovms_cpu_streams_budget", "CPU streams rebalanced between models", {}, streamsBudget.getStreamsCount());
+        writer.counter("ovms_cpu_streams_rebalances_total", "Networks recompiled with rebalanced streams", {}, streamsBudget.getRebalancesCount());
+        const auto assignments = streamsBudget.getAssignments();
+        for (const auto& model : assignments) {
+            writer.gauge("ovms_model_cpu_streams", "CPU streams assigned to model version by the latest rebalance",
+                {{"name", model.name}, {"version", std::to_string(model.version)}}, model.streams);
+        }
+        for (const auto& model : assignments) {
+            writer.gauge("ovms_model_busy_cpu_streams", "Average CPU streams of model version busy between the two latest rebalances",
+                {{"name", model.name}, {"version", std::to_string(model.version)}}, model.busyStreams);
+        }
+    }
+    for (const auto& [backend, metrics] : backends) {
+        writer.counter("ovms_storage_retries_total", "Storage requests retried by the client after transient errors or throttling", {{"backend", backend}},
+            metrics->retries.load(std::memory_order_relaxed));
+    }
+    response->assign(writer.getText());
+    return StatusCode::OK;
+}
+
 }  // namespace ovms
@@ -15,8 +15,11 @@
 //*****************************************************************************
 #pragma once
 
-#include <regex>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -25,58 +28,69 @@
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #pragma GCC diagnostic pop
 
+#include "deadline.hpp"
+#include "modelinstanceunloadguard.hpp"
 #include "rest_parser.hpp"
 #include "status.hpp"
 
 namespace ovms {
 
-struct HttpRequestComponents {
-    std::string_view http_method;
-    std::string model_name;
-    std::optional<int64_t> model_version;
-    std::optional<std::string_view> model_version_label;
-    std::string processing_method;
-    std::string model_subresource;
+class ModelInstance;
+
+/**
+ * @brief Maximum number of predict requests in a single batch predict request
+ */
+constexpr size_t MAX_BATCH_PREDICT_REQUESTS = 1024;
+
+/**
+ * @brief Maximum number of batch predict request entries waiting for inference at once
+ */
+constexpr size_t MAX_BATCH_PREDICT_IN_FLIGHT = 128;
+
+/**
+ * @brief Predict request parsed by HttpRestApiHandler::parsePredictRequest, waiting for
+ * HttpRestApiHandler::executePredictRequest which may run in another thread
+ */
+struct RestPredictCall {
+    std::string modelName;
+    deadline_t deadline = NO_DEADLINE;
+    std::optional<size_t> binaryHeaderLength;
+    /**
+     * @brief Model instance the request was parsed for, empty for pipelines. It is released by executePredictRequest.
+     */
+    std::shared_ptr<ModelInstance> modelInstance;
+    std::unique_ptr<ModelInstanceUnloadGuard> modelInstanceUnloadGuard;
+    RestParser parser;
+    /**
+     * @brief Body of deferred batch predict request, its entries are parsed by executePredictRequest.
+     * It points to request body of the caller, which has to outlive the call.
+     */
+    const std::string* batchRequest = nullptr;
 };
 
 class HttpRestApiHandler {
 public:
-    static const std::string kPathRegexExp;
-    static const std::string predictionRegexExp;
-    static const std::string modelstatusRegexExp;
-
     /**
      * @brief Construct a new HttpRest Api Handler
      * 
      * @param timeout_in_ms 
      */
     HttpRestApiHandler(int timeout_in_ms) :
-        sanityRegex(kPathRegexExp),
-        predictionRegex(predictionRegexExp),
-        modelstatusRegex(modelstatusRegexExp),
         timeout_in_ms(timeout_in_ms) {}
 
-    Status validateUrlAndMethod(
-        const std::string_view http_method,
-        const std::string& request_path,
-        std::smatch* sm);
-
-    Status parseModelVersion(std::string& model_version_str, std::optional<int64_t>& model_version);
-
-    Status dispatchToProcessor(
-        const std::string_view request_path,
-        const std::string& request_body,
-        std::string* response,
-        const HttpRequestComponents& request_components);
-
     /**
-     * @brief Process Request
+     * @brief Process Request, path is recognized by routeRestRequest
      * 
      * @param http_method 
      * @param request_path 
      * @param request_body 
      * @param headers 
      * @param resposnse 
+     * @param deadline taken from client timeout header
+     * @param inference_header_length value of Inference-Header-Content-Length header, empty for JSON requests
+     * @param deferredPredict when given, predict requests are only parsed and returned in it, to be completed
+     * with executePredictRequest. Batch predict requests are returned without parsing. Other requests are processed right away.
+     * @param authorization value of Authorization header, checked by admin requests
      *
      * @return StatusCode 
      */
@@ -85,7 +99,11 @@ public:
         const std::string_view request_path,
         const std::string& request_body,
         std::vector<std::pair<std::string, std::string>>* headers,
-        std::string* response);
+        std::string* response,
+        const deadline_t& deadline = NO_DEADLINE,
+        const std::string_view inference_header_length = {},
+        std::unique_ptr<RestPredictCall>* deferredPredict = nullptr,
+        const std::string_view authorization = {});
 
     /**
      * @brief Process predict request
@@ -95,6 +113,9 @@ public:
      * @param modelVersionLabel 
      * @param request 
      * @param response 
+     * @param deadline 
+     * @param binaryHeaderLength size of JSON header of binary tensor request, std::nullopt for JSON requests
+     * @param headers response headers, binary tensor response sets its content type and header length
      *
      * @return StatusCode 
      */
@@ -103,20 +124,62 @@ public:
         const std::optional<int64_t>& modelVersion,
         const std::optional<std::string_view>& modelVersionLabel,
         const std::string& request,
-        std::string* response);
+        std::string* response,
+        const deadline_t& deadline = NO_DEADLINE,
+        const std::optional<size_t>& binaryHeaderLength = std::nullopt,
+        std::vector<std::pair<std::string, std::string>>* headers = nullptr);
 
-    Status processSingleModelRequest(
+    /**
+     * @brief Parses predict request body for model or pipeline, model instance is held until the call is executed
+     *
+     * @param modelName 
+     * @param modelVersion 
+     * @param request 
+     * @param deadline 
+     * @param binaryHeaderLength size of JSON header of binary tensor request, std::nullopt for JSON requests
+     * @param call parsed request
+     *
+     * @return StatusCode 
+     */
+    Status parsePredictRequest(
         const std::string& modelName,
         const std::optional<int64_t>& modelVersion,
         const std::string& request,
-        Order& requestOrder,
-        tensorflow::serving::PredictResponse& responseProto);
+        const deadline_t& deadline,
+        const std::optional<size_t>& binaryHeaderLength,
+        RestPredictCall& call);
 
-    Status processPipelineRequest(
-        const std::string& modelName,
+    /**
+     * @brief Runs inference of parsed predict request and serializes the response
+     *
+     * @param call request parsed by parsePredictRequest or deferred batch predict request
+     * @param response 
+     * @param headers response headers, binary tensor response sets its content type and header length
+     *
+     * @return StatusCode 
+     */
+    Status executePredictRequest(
+        RestPredictCall& call,
+        std::string* response,
+        std::vector<std::pair<std::string, std::string>>* headers);
+
+    /**
+     * @brief Process batch predict request, body is JSON array or JSON Lines of predict requests with
+     * model_name and optional model_version. Model requests are inferred concurrently, response contains
+     * result or error of each request in the order of the body, one per line.
+     *
+     * @param request
+     * @param response
+     * @param headers JSON Lines response sets its content type
+     * @param deadline applied to each of the requests
+     *
+     * @return StatusCode of the whole request, errors of single requests are only reported in the response
+     */
+    Status processBatchPredictRequest(
         const std::string& request,
-        Order& requestOrder,
-        tensorflow::serving::PredictResponse& responseProto);
+        std::string* response,
+        std::vector<std::pair<std::string, std::string>>* headers,
+        const deadline_t& deadline = NO_DEADLINE);
 
     /**
      * @brief Process Model Metadata request
@@ -149,10 +212,122 @@ public:
         const std::optional<std::string_view>& model_version_label,
         std::string* response);
 
+    /**
+     * @brief Process shared memory region registration request
+     *
+     * @param regionName name referenced by predict requests
+     * @param operation register or unregister
+     * @param request body with shm_open key and byte size of the region to register
+     * @param response
+     *
+     * @return StatusCode
+     */
+    Status processSharedMemoryRequest(
+        const std::string& regionName,
+        const std::string_view operation,
+        const std::string& request,
+        std::string* response);
+
+    /**
+     * @brief Process resize of model version infer requests queue
+     *
+     * @param modelName
+     * @param modelVersion default version is resized when not set
+     * @param modelVersionLabel version labels are not supported, request with it is rejected
+     * @param request body with requested nireq
+     * @param authorization value of Authorization header with admin bearer token
+     * @param response filled with nireq applied to the queue
+     *
+     * @return StatusCode ADMIN_UNAUTHORIZED when the token does not match
+     */
+    Status processInferRequestsResizeRequest(
+        const std::string& modelName,
+        const std::optional<int64_t>& modelVersion,
+        const std::optional<std::string_view>& modelVersionLabel,
+        const std::string& request,
+        const std::string_view authorization,
+        std::string* response);
+
+    /**
+     * @brief Process submission, listing, status or cancellation of bulk inference jobs
+     *
+     * @param operation submit, list, status or cancel
+     * @param jobId id of the job for status and cancel
+     * @param request body with job description to submit
+     * @param authorization value of Authorization header with admin bearer token
+     * @param response filled with status of the job or of all jobs
+     *
+     * @return StatusCode ADMIN_UNAUTHORIZED when the token does not match
+     */
+    Status processBulkJobsRequest(
+        const std::string_view operation,
+        const std::string_view jobId,
+        const std::string& request,
+        const std::string_view authorization,
+        std::string* response);
+
+    /**
+     * @brief Process CPU profiling request, blocks for the profile duration
+     *
+     * @param request optional body with profile seconds, frequency and format
+     * @param authorization value of Authorization header with admin bearer token
+     * @param headers response headers, content type depends on profile format
+     * @param response filled with folded stacks or gzip compressed pprof profile
+     *
+     * @return StatusCode ADMIN_UNAUTHORIZED when the token does not match, PROFILER_BUSY when another profile is running
+     */
+    Status processProfileRequest(
+        const std::string& request,
+        const std::string_view authorization,
+        std::vector<std::pair<std::string, std::string>>* headers,
+        std::string* response);
+
+    /**
+     * @brief Process readiness request, reports saturation of the server and readiness of its models
+     *
+     * @param response
+     *
+     * @return StatusCode CORE_MODELS_NOT_READY if any core model is not available, SERVER_SATURATED if saturation is above the configured threshold
+     */
+    Status processReadinessRequest(std::string* response);
+
+    /**
+     * @brief Process metrics request, reports latency histograms of pipelines and their nodes
+     *
+     * @param response
+     *
+     * @return StatusCode
+     */
+    Status processMetricsRequest(std::string* response);
+
+    /**
+     * @brief Process Prometheus scrape, reports request counters, latencies and stream availability of models and pipelines,
+     * model load durations and model downloads in Prometheus text format
+     *
+     * @param response
+     *
+     * @return StatusCode
+     */
+    Status processPrometheusMetricsRequest(std::string* response);
+
 private:
-    const std::regex sanityRegex;
-    const std::regex predictionRegex;
-    const std::regex modelstatusRegex;
+    /**
+     * @brief Finds model instance or pipeline of predict request and fills its proto with parse
+     */
+    Status preparePredictCall(
+        const std::string& modelName,
+        const std::optional<int64_t>& modelVersion,
+        const deadline_t& deadline,
+        const std::optional<size_t>& binaryHeaderLength,
+        RestPredictCall& call,
+        const std::function<Status(RestParser&)>& parse);
+
+    /**
+     * @brief Parses single entry of batch predict request
+     */
+    Status parseBatchPredictEntry(rapidjson::Value& entry, const deadline_t& deadline, RestPredictCall& call);
+
+    Status executePipeline(RestPredictCall& call, tensorflow::serving::PredictResponse& responseProto);
 
     int timeout_in_ms;
 };
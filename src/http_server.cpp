@@ -15,45 +15,84 @@
 //*****************************************************************************
 #include "http_server.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <exception>
 #include <memory>
-#include <regex>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wall"
 #include "tensorflow_serving/util/net_http/server/public/httpserver.h"
 #include "tensorflow_serving/util/net_http/server/public/response_code_enum.h"
 #include "tensorflow_serving/util/net_http/server/public/server_request_interface.h"
-#include "tensorflow_serving/util/threadpool_executor.h"
 #pragma GCC diagnostic pop
 
+#include "compression.hpp"
+#include "deadline.hpp"
 #include "http_rest_api_handler.hpp"
+#include "requesttimings.hpp"
+#include "rest_router.hpp"
+#include "rest_utils.hpp"
+#include "saturation.hpp"
+#include "stageexecutor.hpp"
 #include "status.hpp"
+#include "tracing.hpp"
 
 namespace ovms {
 
 namespace net_http = tensorflow::serving::net_http;
 
+/**
+ * @brief Optional client timeout in milliseconds, requests not started until then are dropped
+ */
+const char REQUEST_TIMEOUT_HEADER[] = "Request-Timeout-Ms";
+
+/**
+ * @brief Upper limit of memory reserved for request body before it is read. Content-Length is sent by the client,
+ * so larger bodies are only grown while they are actually read and a false header cannot make the server reserve more.
+ */
+const size_t MAX_PREALLOCATED_BODY_SIZE = 16 * 1024 * 1024;
+
+/**
+ * @brief Upper limit of request body and response buffers kept by request processing thread for the next request
+ */
+const size_t MAX_REUSED_BUFFER_SIZE = 16 * 1024 * 1024;
+
+/**
+ * @brief Threads reading, parsing and routing requests. Unless REST inference workers are set, they run inference as well.
+ */
 class RequestExecutor final : public net_http::EventExecutor {
 public:
     explicit RequestExecutor(int num_threads) :
-        executor_(tensorflow::Env::Default(), "httprestserver", num_threads) {}
+        executor_("httprestserver", num_threads) {}
 
-    void Schedule(std::function<void()> fn) override { executor_.Schedule(fn); }
+    void Schedule(std::function<void()> fn) override { executor_.Schedule(std::move(fn)); }
 
 private:
-    tensorflow::serving::ThreadPoolExecutor executor_;
+    StageExecutor executor_;
 };
 
 class RestApiRequestDispatcher {
 public:
-    RestApiRequestDispatcher(int timeout_in_ms) :
-        regex_(HttpRestApiHandler::kPathRegexExp) {
+    RestApiRequestDispatcher(int timeout_in_ms, size_t compression_threshold, int inference_workers, size_t inference_queue_size) :
+        compression_threshold_(compression_threshold) {
         handler_ = std::make_unique<HttpRestApiHandler>(timeout_in_ms);
+        if (inference_workers > 0) {
+            inference_executor_ = std::make_unique<StageExecutor>("restinference", inference_workers, inference_queue_size);
+        }
     }
 
     net_http::RequestHandler dispatch(net_http::ServerRequestInterface* req) {
@@ -63,26 +102,240 @@ public:
     }
 
 private:
-    void processRequest(net_http::ServerRequestInterface* req) {
-        SPDLOG_DEBUG("REST request {}", req->uri_path());
+    /**
+     * @brief Request body and response of the request handled by the current thread, reused by its next requests
+     */
+    struct ThreadBuffers {
         std::string body;
+        std::string output;
+        std::vector<std::pair<std::string, std::string>> headers;
+
+        void clear() {
+            for (auto* buffer : {&body, &output}) {
+                if (buffer->capacity() > MAX_REUSED_BUFFER_SIZE) {
+                    std::string().swap(*buffer);
+                } else {
+                    buffer->clear();
+                }
+            }
+            headers.clear();
+        }
+    };
+
+    static ThreadBuffers& getThreadBuffers() {
+        thread_local ThreadBuffers buffers;
+        return buffers;
+    }
+
+    static deadline_t getDeadline(net_http::ServerRequestInterface* req) {
+        const auto timeoutHeader = req->GetRequestHeader(REQUEST_TIMEOUT_HEADER);
+        if (timeoutHeader.empty()) {
+            return NO_DEADLINE;
+        }
+        try {
+            const int64_t timeoutMs = std::stoll(std::string(timeoutHeader));
+            if (timeoutMs > 0) {
+                return deadlineAfter(std::chrono::milliseconds(timeoutMs));
+            }
+        } catch (const std::exception&) {
+            // handled below as invalid value
+        }
+        SPDLOG_DEBUG("Ignoring invalid {} header value: {}", REQUEST_TIMEOUT_HEADER, std::string(timeoutHeader));
+        return NO_DEADLINE;
+    }
+
+    static size_t getContentLength(net_http::ServerRequestInterface* req) {
+        const auto lengthHeader = req->GetRequestHeader("Content-Length");
+        size_t length = 0;
+        const auto end = lengthHeader.data() + lengthHeader.size();
+        auto result = std::from_chars(lengthHeader.data(), end, length);
+        if (result.ec != std::errc() || result.ptr != end) {
+            return 0;
+        }
+        return std::min(length, MAX_PREALLOCATED_BODY_SIZE);
+    }
+
+    void compressResponse(net_http::ServerRequestInterface* req,
+        std::vector<std::pair<std::string, std::string>>& headers,
+        std::string& output) const {
+        if (!isCompressionRequired(output.size(), compression_threshold_)) {
+            return;
+        }
+        headers.emplace_back("Vary", ACCEPT_ENCODING_HEADER);
+        const auto acceptEncoding = req->GetRequestHeader(ACCEPT_ENCODING_HEADER);
+        if (negotiateContentEncoding(std::string_view(acceptEncoding.data(), acceptEncoding.size())) != ContentEncoding::GZIP) {
+            return;
+        }
+        std::string compressed;
+        auto status = compressGzip(output, &compressed);
+        if (!status.ok()) {
+            SPDLOG_WARN("Sending uncompressed response of size: {} bytes. {}", output.size(), status.string());
+            return;
+        }
+        SPDLOG_DEBUG("Compressed REST response from {} to {} bytes", output.size(), compressed.size());
+        output = std::move(compressed);
+        headers.emplace_back(CONTENT_ENCODING_HEADER, GZIP_CONTENT_ENCODING);
+    }
+
+    static void readBody(net_http::ServerRequestInterface* req, std::string& body) {
+        // body is already buffered by the server, reserving it up front avoids reallocations while copying the chunks
+        body.reserve(getContentLength(req));
         int64_t num_bytes = 0;
         auto request_chunk = req->ReadRequestBytes(&num_bytes);
         while (request_chunk != nullptr) {
             body.append(std::string_view(request_chunk.get(), num_bytes));
             request_chunk = req->ReadRequestBytes(&num_bytes);
         }
-
-        std::vector<std::pair<std::string, std::string>> headers;
-        std::string output;
         SPDLOG_DEBUG("Processing HTTP request: {} {} body: {} bytes",
             req->http_method(),
             req->uri_path(),
             body.size());
-        const auto status = handler_->processRequest(req->http_method(), req->uri_path(), body, &headers, &output);
+    }
+
+    Status processRequest(net_http::ServerRequestInterface* req, const std::string& body,
+        std::vector<std::pair<std::string, std::string>>& headers, std::string& output,
+        std::unique_ptr<RestPredictCall>* deferredPredict = nullptr) {
+        const auto inferenceHeaderLength = req->GetRequestHeader(INFERENCE_HEADER_CONTENT_LENGTH_HEADER);
+        const auto authorization = req->GetRequestHeader("Authorization");
+        return handler_->processRequest(req->http_method(), req->uri_path(), body, &headers, &output, getDeadline(req),
+            std::string_view(inferenceHeaderLength.data(), inferenceHeaderLength.size()), deferredPredict,
+            std::string_view(authorization.data(), authorization.size()));
+    }
+
+    void processRequest(net_http::ServerRequestInterface* req) {
+        SPDLOG_DEBUG("REST request {}", req->uri_path());
+        if (SaturationMonitor::instance().shouldShedRequest() && isInferenceRequest(req->http_method(), req->uri_path())) {
+            shedRequest(req);
+            return;
+        }
+        if (inference_executor_) {
+            processRequestInStages(req);
+            return;
+        }
+        NetworkRequestGuard networkRequest;
+        const auto traceContext = startRequestTrace(req);
+        Span requestSpan = startRequestSpan(req, traceContext);
+        TraceScope traceScope(requestSpan.getContext());
+        std::optional<RequestTimings> timings;
+        startRequestTimings(req, timings);
+        RequestTimingsScope timingsScope(timings ? &*timings : nullptr);
+        auto& buffers = getThreadBuffers();
+        readBody(req, buffers.body);
+        const auto status = processRequest(req, buffers.body, buffers.headers, buffers.output);
+        if (!status.ok()) {
+            requestSpan.setError(status.string());
+        }
+        addServerTiming(timings, buffers.headers);
+        reply(req, status, buffers.headers, buffers.output);
+        buffers.clear();
+    }
+
+    static TraceContext startRequestTrace(net_http::ServerRequestInterface* req) {
+        if (!Tracer::instance().isEnabled()) {
+            return TraceContext();
+        }
+        const auto traceparent = req->GetRequestHeader(TRACEPARENT_HEADER);
+        return Tracer::instance().startRequest(std::string_view(traceparent.data(), traceparent.size()));
+    }
+
+    static void startRequestTimings(net_http::ServerRequestInterface* req, std::optional<RequestTimings>& timings) {
+        const auto header = req->GetRequestHeader(SERVER_TIMING_REQUEST_HEADER);
+        if (isServerTimingRequested(std::string_view(header.data(), header.size()))) {
+            timings.emplace();
+        }
+    }
+
+    static void addServerTiming(const std::optional<RequestTimings>& timings, std::vector<std::pair<std::string, std::string>>& headers) {
+        if (timings) {
+            headers.emplace_back(SERVER_TIMING_RESPONSE_HEADER, timings->toServerTiming());
+        }
+    }
+
+    static Span startRequestSpan(net_http::ServerRequestInterface* req, const TraceContext& traceContext) {
+        Span span("HTTP " + std::string(req->http_method()), &traceContext, true);
+        if (span.isRecording()) {
+            span.setAttribute("http.method", std::string(req->http_method()));
+            span.setAttribute("http.target", std::string(req->uri_path()));
+        }
+        return span;
+    }
+
+    /**
+     * @brief Request read by I/O thread, waiting for inference worker
+     */
+    struct StagedCall {
+        std::string body;
+        std::string output;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::unique_ptr<RestPredictCall> predict;
+        NetworkRequestGuard networkRequest;
+        // ended once the response is sent by inference worker
+        Span span;
+        std::optional<RequestTimings> timings;
+    };
+
+    /**
+     * @brief Rejects request without reading it and closes the connection, so the client reconnects through the load balancer
+     */
+    void shedRequest(net_http::ServerRequestInterface* req) const {
+        SPDLOG_DEBUG("Shedding REST request {}, server is saturated", req->uri_path());
+        std::vector<std::pair<std::string, std::string>> headers{{"Content-Type", "application/json"}, {"Connection", "close"}};
+        std::string output;
+        reply(req, StatusCode::SERVER_SATURATED, headers, output);
+    }
+
+    /**
+     * @brief Parses request in the current I/O thread and hands inference of predict requests over to inference workers,
+     * which send the response when it is ready
+     */
+    void processRequestInStages(net_http::ServerRequestInterface* req) {
+        auto call = std::make_shared<StagedCall>();
+        const auto traceContext = startRequestTrace(req);
+        call->span = startRequestSpan(req, traceContext);
+        TraceScope traceScope(call->span.getContext());
+        startRequestTimings(req, call->timings);
+        RequestTimingsScope timingsScope(call->timings ? &*call->timings : nullptr);
+        readBody(req, call->body);
+        auto status = processRequest(req, call->body, call->headers, call->output, &call->predict);
+        if (!status.ok()) {
+            call->span.setError(status.string());
+        }
+        if (!status.ok() || !call->predict) {
+            addServerTiming(call->timings, call->headers);
+            reply(req, status, call->headers, call->output);
+            return;
+        }
+        auto& monitor = SaturationMonitor::instance();
+        monitor.increaseRestQueuedRequests();
+        const bool scheduled = inference_executor_->Schedule([this, req, call, &monitor]() {
+            monitor.decreaseRestQueuedRequests();
+            TraceScope traceScope(call->span.getContext());
+            RequestTimingsScope timingsScope(call->timings ? &*call->timings : nullptr);
+            auto status = handler_->executePredictRequest(*call->predict, &call->output, &call->headers);
+            // model instance is released before the response is sent
+            call->predict.reset();
+            if (!status.ok()) {
+                call->span.setError(status.string());
+            }
+            addServerTiming(call->timings, call->headers);
+            reply(req, status, call->headers, call->output);
+            call->span.end();
+        });
+        if (!scheduled) {
+            monitor.decreaseRestQueuedRequests();
+            call->predict.reset();
+            call->span.setError(Status(StatusCode::REST_INFERENCE_QUEUE_FULL).string());
+            addServerTiming(call->timings, call->headers);
+            reply(req, StatusCode::REST_INFERENCE_QUEUE_FULL, call->headers, call->output);
+        }
+    }
+
+    void reply(net_http::ServerRequestInterface* req, const Status& status,
+        std::vector<std::pair<std::string, std::string>>& headers, std::string& output) const {
         if (!status.ok() && output.empty()) {
             output.append("{\"error\": \"" + status.string() + "\"}");
         }
+        compressResponse(req, headers, output);
         const auto http_status = status.http();
         for (const auto& kv : headers) {
             req->OverwriteResponseHeader(kv.first, kv.second);
@@ -97,14 +350,75 @@ private:
         req->ReplyWithStatus(http_status);
     }
 
-    const std::regex regex_;
+    const size_t compression_threshold_;
     std::unique_ptr<HttpRestApiHandler> handler_;
+    // destroyed first, waits for running inferences which use the handler
+    std::unique_ptr<StageExecutor> inference_executor_;
 };
 
-std::unique_ptr<http_server> createAndStartHttpServer(const std::string& address, int port, int num_threads, int timeout_in_ms) {
+/**
+ * @brief Creates listening unix domain socket, replacing stale socket file left by previous run
+ *
+ * @param path
+ *
+ * @return socket descriptor, -1 on failure
+ */
+bool removeStaleUnixSocket(const std::string& path) {
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) != 0) {
+        return true;
+    }
+    if (!S_ISSOCK(existing.st_mode)) {
+        SPDLOG_ERROR("Unix socket path exists and is not a socket: {}", path);
+        return false;
+    }
+    if (unlink(path.c_str()) != 0) {
+        SPDLOG_ERROR("Failed to remove existing unix socket: {} {}", path, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static int createUnixSocket(const std::string& path) {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        SPDLOG_ERROR("Unix socket path too long: {}", path);
+        return -1;
+    }
+    if (!removeStaleUnixSocket(path)) {
+        return -1;
+    }
+    int s = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s == -1) {
+        SPDLOG_ERROR("Failed to create unix socket: {}", path);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, path.size());
+
+    if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(s, SOMAXCONN) < 0) {
+        SPDLOG_ERROR("Failed to listen on unix socket: {}", path);
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+std::unique_ptr<http_server> createAndStartHttpServer(const std::string& address, int port, int num_threads, int timeout_in_ms, size_t compression_threshold,
+    int inference_workers, size_t inference_queue_size, const std::string& unix_socket_path) {
     auto options = std::make_unique<net_http::ServerOptions>();
     options->AddPort(static_cast<uint32_t>(port));
     options->SetAddress(address);
+    if (!unix_socket_path.empty()) {
+        // ownership is passed to the server, socket is closed when server is destroyed
+        const int unix_socket = createUnixSocket(unix_socket_path);
+        if (unix_socket < 0) {
+            return nullptr;
+        }
+        options->SetUnixSocket(unix_socket);
+    }
     options->SetExecutor(std::make_unique<RequestExecutor>(num_threads));
 
     auto server = net_http::CreateEvHTTPServer(std::move(options));
@@ -114,7 +428,7 @@ std::unique_ptr<http_server> createAndStartHttpServer(const std::string& address
     }
 
     std::shared_ptr<RestApiRequestDispatcher> dispatcher =
-        std::make_shared<RestApiRequestDispatcher>(timeout_in_ms);
+        std::make_shared<RestApiRequestDispatcher>(timeout_in_ms, compression_threshold, inference_workers, inference_queue_size);
 
     net_http::RequestHandlerOptions handler_options;
     server->RegisterRequestDispatcher(
@@ -125,6 +439,12 @@ std::unique_ptr<http_server> createAndStartHttpServer(const std::string& address
 
     if (server->StartAcceptingRequests()) {
         SPDLOG_INFO("REST server listening on port {} with {} threads", port, num_threads);
+        if (!unix_socket_path.empty()) {
+            SPDLOG_INFO("REST server listening on unix socket {}", unix_socket_path);
+        }
+        if (inference_workers > 0) {
+            SPDLOG_INFO("REST inference runs on {} separate threads", inference_workers);
+        }
         return server;
     }
 
@@ -33,9 +33,23 @@ using http_server = tensorflow::serving::net_http::HTTPServerInterface;
  * @param port 
  * @param num_threads 
  * @param timeout_in_m
+ * @param compression_threshold minimum size of response compressed with gzip when client accepts it, 0 disables compression
+ * @param inference_workers threads running inference of predict requests parsed by num_threads I/O threads,
+ * 0 runs inference in I/O threads
+ * @param inference_queue_size maximum number of predict requests waiting for inference worker, 0 means no limit
+ * @param unix_socket_path path of unix domain socket server listens on in addition to the port, empty disables it
  *  
  * @return std::unique_ptr<http_server> 
  */
-std::unique_ptr<http_server> createAndStartHttpServer(const std::string& address, int port, int num_threads, int timeout_in_ms);
+/**
+ * @brief Removes socket left at the path by previous run, which would fail the bind
+ *
+ * @param path
+ * @return false if other file than a socket exists at the path or it cannot be removed
+ */
+bool removeStaleUnixSocket(const std::string& path);
+
+std::unique_ptr<http_server> createAndStartHttpServer(const std::string& address, int port, int num_threads, int timeout_in_ms, size_t compression_threshold = 0,
+    int inference_workers = 0, size_t inference_queue_size = 0, const std::string& unix_socket_path = "");
 
 }  // namespace ovms
@@ -0,0 +1,306 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "imagedecoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <string>
+
+#include <jpeglib.h>
+#include <png.h>
+#include <spdlog/spdlog.h>
+
+#include "containerlimits.hpp"
+#include "narrowing.hpp"
+#include "parallelworkers.hpp"
+
+namespace ovms {
+
+namespace {
+
+const unsigned char JPEG_SIGNATURE[] = {0xFF, 0xD8, 0xFF};
+const unsigned char PNG_SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+bool hasSignature(std::string_view encoded, const unsigned char* signature, size_t length) {
+    return encoded.size() >= length && std::memcmp(encoded.data(), signature, length) == 0;
+}
+
+struct JpegErrorManager {
+    jpeg_error_mgr manager;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX] = {};
+};
+
+void onJpegError(j_common_ptr info) {
+    auto* error = reinterpret_cast<JpegErrorManager*>(info->err);
+    (*info->err->format_message)(info, error->message);
+    std::longjmp(error->jump, 1);
+}
+
+void ignoreJpegMessage(j_common_ptr) {}
+
+Status decodeJpeg(std::string_view encoded, size_t channels, ImageColorOrder colorOrder,
+    size_t minHeight, size_t minWidth, DecodedImage& image) {
+    jpeg_decompress_struct info;
+    JpegErrorManager error;
+    info.err = jpeg_std_error(&error.manager);
+    error.manager.error_exit = onJpegError;
+    error.manager.output_message = ignoreJpegMessage;
+    // no objects with destructors are created between setjmp and decoding calls which may jump back here
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&info);
+        SPDLOG_DEBUG("Failed to decode JPEG image: {}", error.message);
+        return Status(StatusCode::IMAGE_DECODING_FAILED, error.message);
+    }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, reinterpret_cast<const unsigned char*>(encoded.data()), static_cast<unsigned long>(encoded.size()));
+    jpeg_read_header(&info, TRUE);
+    if (static_cast<size_t>(info.image_width) * info.image_height > MAX_DECODED_IMAGE_PIXELS) {
+        SPDLOG_DEBUG("JPEG image size: {}x{} exceeds decoding limit", info.image_width, info.image_height);
+        jpeg_destroy_decompress(&info);
+        return Status(StatusCode::IMAGE_DECODING_FAILED, "Image is too big");
+    }
+    if (channels == 1) {
+        info.out_color_space = JCS_GRAYSCALE;
+    } else {
+        info.out_color_space = colorOrder == ImageColorOrder::BGR ? JCS_EXT_BGR : JCS_EXT_RGB;
+    }
+    // IDCT scaling by N/8 skips most of the decoding work for images much bigger than the network input
+    info.scale_num = 8;
+    info.scale_denom = 8;
+    for (unsigned int scale = 1; scale < 8; ++scale) {
+        if ((info.image_width * scale + 7) / 8 >= minWidth && (info.image_height * scale + 7) / 8 >= minHeight) {
+            info.scale_num = scale;
+            break;
+        }
+    }
+    info.dct_method = JDCT_ISLOW;
+    jpeg_start_decompress(&info);
+    image.height = info.output_height;
+    image.width = info.output_width;
+    image.channels = info.output_components;
+    const size_t rowSize = image.width * image.channels;
+    image.pixels.resize(rowSize * image.height);
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW row = image.pixels.data() + info.output_scanline * rowSize;
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return StatusCode::OK;
+}
+
+Status decodePng(std::string_view encoded, size_t channels, ImageColorOrder colorOrder, DecodedImage& image) {
+    png_image png;
+    std::memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&png, encoded.data(), encoded.size())) {
+        SPDLOG_DEBUG("Failed to read PNG image header: {}", png.message);
+        return Status(StatusCode::IMAGE_DECODING_FAILED, png.message);
+    }
+    if (static_cast<size_t>(png.width) * png.height > MAX_DECODED_IMAGE_PIXELS) {
+        SPDLOG_DEBUG("PNG image size: {}x{} exceeds decoding limit", png.width, png.height);
+        png_image_free(&png);
+        return Status(StatusCode::IMAGE_DECODING_FAILED, "Image is too big");
+    }
+    if (channels == 1) {
+        png.format = PNG_FORMAT_GRAY;
+    } else {
+        png.format = colorOrder == ImageColorOrder::BGR ? PNG_FORMAT_BGR : PNG_FORMAT_RGB;
+    }
+    image.height = png.height;
+    image.width = png.width;
+    image.channels = channels;
+    // transparent pixels are composited onto zero initialized buffer
+    image.pixels.assign(PNG_IMAGE_SIZE(png), 0);
+    if (!png_image_finish_read(&png, nullptr, image.pixels.data(), 0, nullptr)) {
+        SPDLOG_DEBUG("Failed to decode PNG image: {}", png.message);
+        png_image_free(&png);
+        return Status(StatusCode::IMAGE_DECODING_FAILED, png.message);
+    }
+    return StatusCode::OK;
+}
+
+/**
+ * @brief Source pixels and weight of the second one for bilinear interpolation of single output coordinate
+ */
+struct InterpolationPoint {
+    size_t first;
+    size_t second;
+    float weight;
+};
+
+std::vector<InterpolationPoint> getInterpolationPoints(size_t sourceSize, size_t targetSize) {
+    std::vector<InterpolationPoint> points(targetSize);
+    const float scale = static_cast<float>(sourceSize) / targetSize;
+    for (size_t i = 0; i < targetSize; ++i) {
+        // pixel centers are aligned, same as in OpenCV INTER_LINEAR
+        const float position = std::min(std::max((i + 0.5f) * scale - 0.5f, 0.0f), static_cast<float>(sourceSize - 1));
+        const size_t first = static_cast<size_t>(position);
+        points[i] = {first, std::min(first + 1, sourceSize - 1), position - first};
+    }
+    return points;
+}
+
+void storeRow(const float* row, size_t y, size_t height, size_t width, size_t channels, bool planar,
+    const InferenceEngine::Precision& precision, void* destination, std::vector<float>& staging) {
+    const size_t count = width * channels;
+    const float* values = row;
+    size_t offset = y * count;
+    if (planar && channels > 1) {
+        staging.resize(count);
+        for (size_t c = 0; c < channels; ++c) {
+            for (size_t x = 0; x < width; ++x) {
+                staging[c * width + x] = row[x * channels + c];
+            }
+        }
+        values = staging.data();
+    }
+    // planar rows are stored as one chunk per channel
+    const size_t chunks = planar ? channels : 1;
+    const size_t chunkSize = count / chunks;
+    for (size_t c = 0; c < chunks; ++c) {
+        if (planar) {
+            offset = c * height * width + y * width;
+        }
+        const float* chunk = values + c * chunkSize;
+        switch (precision) {
+        case InferenceEngine::Precision::U8: {
+            auto* target = static_cast<uint8_t*>(destination) + offset;
+            for (size_t i = 0; i < chunkSize; ++i) {
+                target[i] = static_cast<uint8_t>(chunk[i] + 0.5f);
+            }
+            break;
+        }
+        case InferenceEngine::Precision::FP16:
+            narrowFp32ToFp16(chunk, static_cast<uint16_t*>(destination) + offset, chunkSize);
+            break;
+        case InferenceEngine::Precision::FP32:
+            std::memcpy(static_cast<float*>(destination) + offset, chunk, chunkSize * sizeof(float));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+}  // namespace
+
+bool isImageInputSupported(const TensorInfo& networkInput) {
+    const auto& shape = networkInput.getShape();
+    const auto& precision = networkInput.getPrecision();
+    return shape.size() == 4 && (shape[1] == 1 || shape[1] == 3) && shape[2] > 0 && shape[3] > 0 &&
+           (networkInput.getLayout() == InferenceEngine::Layout::NCHW || networkInput.getLayout() == InferenceEngine::Layout::NHWC) &&
+           (precision == InferenceEngine::Precision::U8 || precision == InferenceEngine::Precision::FP16 || precision == InferenceEngine::Precision::FP32);
+}
+
+Status decodeImage(std::string_view encoded, size_t channels, ImageColorOrder colorOrder,
+    size_t minHeight, size_t minWidth, DecodedImage& image) {
+    if (hasSignature(encoded, JPEG_SIGNATURE, sizeof(JPEG_SIGNATURE))) {
+        return decodeJpeg(encoded, channels, colorOrder, minHeight, minWidth, image);
+    }
+    if (hasSignature(encoded, PNG_SIGNATURE, sizeof(PNG_SIGNATURE))) {
+        return decodePng(encoded, channels, colorOrder, image);
+    }
+    return Status(StatusCode::IMAGE_DECODING_FAILED, "Unsupported image format, JPEG or PNG expected");
+}
+
+void resizeImage(const DecodedImage& image, size_t height, size_t width, bool planar,
+    const InferenceEngine::Precision& precision, void* destination) {
+    const size_t channels = image.channels;
+    const auto rows = getInterpolationPoints(image.height, height);
+    const auto columns = getInterpolationPoints(image.width, width);
+    const size_t sourceRowSize = image.width * channels;
+    std::vector<float> row(width * channels);
+    std::vector<float> staging;
+    for (size_t y = 0; y < height; ++y) {
+        const uint8_t* top = image.pixels.data() + rows[y].first * sourceRowSize;
+        const uint8_t* bottom = image.pixels.data() + rows[y].second * sourceRowSize;
+        const float verticalWeight = rows[y].weight;
+        for (size_t x = 0; x < width; ++x) {
+            const size_t left = columns[x].first * channels;
+            const size_t right = columns[x].second * channels;
+            const float horizontalWeight = columns[x].weight;
+            for (size_t c = 0; c < channels; ++c) {
+                const float upper = top[left + c] + (top[right + c] - top[left + c]) * horizontalWeight;
+                const float lower = bottom[left + c] + (bottom[right + c] - bottom[left + c]) * horizontalWeight;
+                row[x * channels + c] = upper + (lower - upper) * verticalWeight;
+            }
+        }
+        storeRow(row.data(), y, height, width, channels, planar, precision, destination, staging);
+    }
+}
+
+Status decodeImages(const tensorflow::TensorProto& requestInput, const TensorInfo& networkInput,
+    void* destination, size_t imagesCount) {
+    if (static_cast<size_t>(requestInput.string_val_size()) != imagesCount) {
+        std::stringstream ss;
+        ss << "Expected: " << imagesCount << " images; Actual: " << requestInput.string_val_size();
+        return Status(StatusCode::INVALID_VALUE_COUNT, ss.str());
+    }
+    const auto& shape = networkInput.getShape();
+    const size_t channels = shape[1];
+    const size_t height = shape[2];
+    const size_t width = shape[3];
+    const bool planar = networkInput.getLayout() != InferenceEngine::Layout::NHWC;
+    const auto& precision = networkInput.getPrecision();
+    const size_t imageByteSize = channels * height * width * precision.size();
+
+    auto decode = [&](size_t index) -> Status {
+        try {
+            DecodedImage image;
+            auto status = decodeImage(requestInput.string_val(index), channels, networkInput.getImageColorOrder(), height, width, image);
+            if (!status.ok()) {
+                SPDLOG_DEBUG("Failed to decode image: {} of input: {}; {}", index, networkInput.getMappedName(), status.string());
+                return status;
+            }
+            resizeImage(image, height, width, planar, precision, static_cast<char*>(destination) + index * imageByteSize);
+        } catch (const std::exception& e) {
+            SPDLOG_DEBUG("Failed to decode image: {} of input: {}; {}", index, networkInput.getMappedName(), e.what());
+            return StatusCode::IMAGE_DECODING_FAILED;
+        }
+        return StatusCode::OK;
+    };
+
+    const size_t threadsCount = std::min({imagesCount, MAX_IMAGE_DECODING_THREADS,
+        static_cast<size_t>(getEffectiveCpuCount())});
+    if (threadsCount <= 1) {
+        for (size_t i = 0; i < imagesCount; ++i) {
+            auto status = decode(i);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+        return StatusCode::OK;
+    }
+    std::vector<Status> statuses(imagesCount);
+    ParallelWorkers::instance().run(imagesCount, threadsCount, [&statuses, &decode](size_t index) {
+        statuses[index] = decode(index);
+    });
+    for (const auto& status : statuses) {
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
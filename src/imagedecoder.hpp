@@ -0,0 +1,111 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow/core/framework/tensor.h"
+#pragma GCC diagnostic pop
+
+#include "status.hpp"
+#include "tensorinfo.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Upper limit of decoded image size, protects from images declaring huge dimensions in a few bytes
+ */
+const size_t MAX_DECODED_IMAGE_PIXELS = 64 * 1024 * 1024;
+
+/**
+ * @brief Maximum number of threads decoding images of a single request input
+ */
+const size_t MAX_IMAGE_DECODING_THREADS = 8;
+
+/**
+ * @brief Pixels of decoded image in HWC layout, 8 bits per channel
+ */
+struct DecodedImage {
+    std::vector<uint8_t> pixels;
+    size_t height = 0;
+    size_t width = 0;
+    size_t channels = 0;
+};
+
+/**
+ * @brief Checks if request input carries encoded images for network input accepting them
+ */
+inline bool isImageInputRequested(const tensorflow::TensorProto& requestInput, const TensorInfo& networkInput) {
+    return networkInput.isImageInput() && requestInput.dtype() == tensorflow::DataType::DT_STRING;
+}
+
+/**
+ * @brief Checks if decoded images can be written into network input.
+ * Input has to be 4 dimensional, in NCHW or NHWC layout, with 1 or 3 channels of U8, FP16 or FP32 precision.
+ */
+bool isImageInputSupported(const TensorInfo& networkInput);
+
+/**
+ * @brief Decodes JPEG or PNG image, format is detected from the data signature
+ *
+ * JPEG images are scaled down by the decoder as long as they stay at least as big as requested size.
+ *
+ * @param encoded image file content
+ * @param channels 1 for grayscale, 3 for color images
+ * @param colorOrder channel order of color images
+ * @param minHeight height the image will be resized to, used to select JPEG scaling
+ * @param minWidth width the image will be resized to, used to select JPEG scaling
+ * @param image decoded pixels
+ *
+ * @return Status
+ */
+Status decodeImage(std::string_view encoded, size_t channels, ImageColorOrder colorOrder,
+    size_t minHeight, size_t minWidth, DecodedImage& image);
+
+/**
+ * @brief Resizes decoded image with bilinear interpolation and writes it in given layout and precision
+ *
+ * @param image decoded image
+ * @param height target height
+ * @param width target width
+ * @param planar writes channels one after another (CHW) instead of interleaved (HWC)
+ * @param precision U8, FP16 or FP32
+ * @param destination memory of height * width * channels values
+ */
+void resizeImage(const DecodedImage& image, size_t height, size_t width, bool planar,
+    const InferenceEngine::Precision& precision, void* destination);
+
+/**
+ * @brief Decodes encoded images from string_val of request input into consecutive batches of network input.
+ * Images are resized to network input height and width, batches are decoded in parallel.
+ *
+ * @param requestInput DT_STRING tensor with one encoded image per batch
+ * @param networkInput image input
+ * @param destination memory of imagesCount batches of network input
+ * @param imagesCount number of batches, has to match number of images in request input
+ *
+ * @return Status
+ */
+Status decodeImages(const tensorflow::TensorProto& requestInput, const TensorInfo& networkInput,
+    void* destination, size_t imagesCount);
+
+}  // namespace ovms
@@ -0,0 +1,241 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "inferencescheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+const char* toString(SchedulingPriority priority) {
+    switch (priority) {
+    case SchedulingPriority::LOW:
+        return "low";
+    case SchedulingPriority::NORMAL:
+        return "normal";
+    case SchedulingPriority::HIGH:
+        return "high";
+    default:
+        return "unknown";
+    }
+}
+
+bool parseSchedulingPriority(const std::string& value, SchedulingPriority& priority) {
+    for (size_t i = 0; i < SCHEDULING_PRIORITIES_COUNT; ++i) {
+        if (value == toString(static_cast<SchedulingPriority>(i))) {
+            priority = static_cast<SchedulingPriority>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+InferenceScheduler& InferenceScheduler::instance() {
+    static InferenceScheduler instance;
+    return instance;
+}
+
+void InferenceScheduler::configure(size_t slots) {
+    std::unique_lock<std::mutex> lock(mtx);
+    this->enabled.store(slots > 0, std::memory_order_release);
+    this->slots = slots;
+    if (slots > 0) {
+        SPDLOG_INFO("Inference scheduler enabled with {} slots", slots);
+    }
+    serveWaiters(lock);
+}
+
+std::shared_ptr<InferenceScheduler::Client> InferenceScheduler::registerClient(const std::string& name, uint32_t weight, SchedulingPriority priority) {
+    auto client = std::make_shared<Client>(*this, name, std::max<uint32_t>(weight, 1), priority);
+    std::lock_guard<std::mutex> lock(mtx);
+    clients.push_back(client.get());
+    return client;
+}
+
+void InferenceScheduler::unregisterClient(Client* client) {
+    std::vector<DeadlineTimer::timer_id_t> timers;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+        for (const auto& waiter : client->waiters) {
+            timers.push_back(waiter.timerId);
+        }
+    }
+    // timers must not run for the client once it is destroyed, expiring ones do not find it registered anymore
+    for (auto timerId : timers) {
+        DeadlineTimer::instance().cancel(timerId);
+    }
+}
+
+void InferenceScheduler::grant(Client& client) {
+    const auto now = std::chrono::steady_clock::now();
+    auto& classVirtualTime = classVirtualTimes[static_cast<size_t>(client.priority)];
+    // clients coming back from idle start from the virtual time of the clients being served
+    client.virtualTime = std::max(client.virtualTime, classVirtualTime);
+    classVirtualTime = client.virtualTime;
+    client.grantTimes.push_back(now);
+    client.grants++;
+    usedSlots++;
+}
+
+bool InferenceScheduler::tryAcquire(Client& client) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (enabled && usedSlots >= slots) {
+        return false;
+    }
+    // free slot means nobody of any priority is waiting
+    grant(client);
+    return true;
+}
+
+void InferenceScheduler::acquire(Client& client, std::function<void(bool)> callback, const deadline_t& deadline) {
+    uint64_t waiterId = 0;
+    bool granted = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!enabled.load(std::memory_order_relaxed) || usedSlots < slots) {
+            grant(client);
+            granted = true;
+        } else if (!isDeadlineExceeded(deadline)) {
+            waiterId = nextWaiterId++;
+            client.waiters.push_back(Waiter{std::move(callback), deadline, std::chrono::steady_clock::now(), waiterId});
+            callback = nullptr;
+        }
+    }
+    if (callback) {
+        // granted right away or deadline already passed
+        callback(granted);
+        return;
+    }
+    if (deadline == NO_DEADLINE) {
+        return;
+    }
+    // waiter is expired at its deadline even if no slot is released meanwhile
+    auto timerId = DeadlineTimer::instance().schedule(deadline, [this, client = &client, waiterId]() { expireWaiter(client, waiterId); });
+    std::unique_lock<std::mutex> lock(mtx);
+    auto it = std::find_if(client.waiters.begin(), client.waiters.end(), [waiterId](const Waiter& waiter) { return waiter.id == waiterId; });
+    if (it != client.waiters.end()) {
+        it->timerId = timerId;
+        return;
+    }
+    // served or expired before the timer was stored
+    lock.unlock();
+    DeadlineTimer::instance().cancel(timerId);
+}
+
+void InferenceScheduler::expireWaiter(Client* client, uint64_t waiterId) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+        return;
+    }
+    auto it = std::find_if(client->waiters.begin(), client->waiters.end(), [waiterId](const Waiter& waiter) { return waiter.id == waiterId; });
+    if (it == client->waiters.end()) {
+        return;
+    }
+    auto callback = std::move(it->callback);
+    client->waiters.erase(it);
+    lock.unlock();
+    callback(false);
+}
+
+void InferenceScheduler::release(Client& client) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (client.grantTimes.empty()) {
+        SPDLOG_ERROR("Inference slot released by scheduler client: {} which does not hold any", client.name);
+        return;
+    }
+    const auto held = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - client.grantTimes.front()).count();
+    client.grantTimes.pop_front();
+    client.virtualTime += static_cast<double>(held) / client.weight;
+    usedSlots--;
+    serveWaiters(lock);
+}
+
+InferenceScheduler::Client* InferenceScheduler::pickWaitingClient() {
+    for (size_t priority = SCHEDULING_PRIORITIES_COUNT; priority-- > 0;) {
+        Client* picked = nullptr;
+        for (Client* client : clients) {
+            if (client->priority != static_cast<SchedulingPriority>(priority) || client->waiters.empty()) {
+                continue;
+            }
+            if (picked == nullptr || client->virtualTime < picked->virtualTime ||
+                (client->virtualTime == picked->virtualTime && client->waiters.front().enqueueTime < picked->waiters.front().enqueueTime)) {
+                picked = client;
+            }
+        }
+        if (picked != nullptr) {
+            return picked;
+        }
+    }
+    return nullptr;
+}
+
+void InferenceScheduler::serveWaiters(std::unique_lock<std::mutex>& lock) {
+    while (!enabled || usedSlots < slots) {
+        Client* client = pickWaitingClient();
+        if (client == nullptr) {
+            return;
+        }
+        auto waiter = std::move(client->waiters.front());
+        client->waiters.pop_front();
+        if (isDeadlineExceeded(waiter.deadline)) {
+            lock.unlock();
+            DeadlineTimer::instance().cancel(waiter.timerId);
+            waiter.callback(false);
+            lock.lock();
+            continue;
+        }
+        grant(*client);
+        client->delayedGrants++;
+        client->waitMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waiter.enqueueTime).count();
+        // slot holder may start the inference right away, do not hold the lock meanwhile
+        lock.unlock();
+        DeadlineTimer::instance().cancel(waiter.timerId);
+        waiter.callback(true);
+        lock.lock();
+    }
+}
+
+size_t InferenceScheduler::getSlotsCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return slots;
+}
+
+size_t InferenceScheduler::getUsedSlotsCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return usedSlots;
+}
+
+std::vector<InferenceScheduler::ClientStatistics> InferenceScheduler::getStatistics() const {
+    std::vector<ClientStatistics> statistics;
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const Client* client : clients) {
+        ClientStatistics entry;
+        entry.name = client->name;
+        entry.priority = client->priority;
+        entry.weight = client->weight;
+        entry.grants = client->grants;
+        entry.delayedGrants = client->delayedGrants;
+        entry.waitMicroseconds = client->waitMicroseconds;
+        entry.waiting = client->waiters.size();
+        statistics.push_back(std::move(entry));
+    }
+    return statistics;
+}
+
+}  // namespace ovms
@@ -0,0 +1,220 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "deadline.hpp"
+#include "deadlinetimer.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Priority class of a model, waiting requests of higher class always get inference slots first
+ */
+enum class SchedulingPriority {
+    LOW,
+    NORMAL,
+    HIGH,
+    COUNT
+};
+
+constexpr size_t SCHEDULING_PRIORITIES_COUNT = static_cast<size_t>(SchedulingPriority::COUNT);
+
+const char* toString(SchedulingPriority priority);
+
+/**
+ * @brief Parses "low", "normal" or "high"
+ *
+ * @return false if value is not one of them
+ */
+bool parseSchedulingPriority(const std::string& value, SchedulingPriority& priority);
+
+/**
+ * @brief Limits number of inferences running at once on the whole server and hands free slots out to models
+ * by priority class and, within a class, by weighted fair share of slot time
+ *
+ * Each model version registers a client. A client is charged the time its slots were held divided by its weight,
+ * the waiting client with the lowest charge gets the next free slot. A client which starts waiting after being idle
+ * is charged at least as much as the clients served recently, so idle time is not saved up for a burst.
+ */
+class InferenceScheduler {
+public:
+    class Client;
+
+    struct ClientStatistics {
+        std::string name;
+        SchedulingPriority priority;
+        uint32_t weight;
+        uint64_t grants = 0;
+        // grants which had to wait for a slot
+        uint64_t delayedGrants = 0;
+        uint64_t waitMicroseconds = 0;
+        size_t waiting = 0;
+    };
+
+    /**
+     * @brief Scheduler shared by all models, disabled until configured
+     */
+    static InferenceScheduler& instance();
+
+    InferenceScheduler() = default;
+
+    /**
+     * @brief Sets number of inferences running at once, slots above a decreased count are taken away when released
+     *
+     * @param slots 0 disables scheduling, slots are granted right away afterwards
+     */
+    void configure(size_t slots);
+
+    bool isEnabled() const {
+        return enabled.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Creates client of model version, it is unregistered when released
+     *
+     * @param weight share of slot time relative to other clients of the same priority, at least 1
+     */
+    std::shared_ptr<Client> registerClient(const std::string& name, uint32_t weight, SchedulingPriority priority);
+
+    /**
+     * @brief Takes slot if one is free and nobody waits for it
+     */
+    bool tryAcquire(Client& client);
+
+    /**
+     * @brief Takes slot right away or once it is released by another client
+     *
+     * @param callback called with true when slot is granted, with false when deadline passed while waiting.
+     * It may be called from the thread releasing a slot or from the deadline timer thread right at the deadline.
+     * @param deadline
+     */
+    void acquire(Client& client, std::function<void(bool)> callback, const deadline_t& deadline = NO_DEADLINE);
+
+    /**
+     * @brief Returns slot granted to the client and hands it out to the next waiting client
+     */
+    void release(Client& client);
+
+    size_t getSlotsCount() const;
+
+    size_t getUsedSlotsCount() const;
+
+    std::vector<ClientStatistics> getStatistics() const;
+
+private:
+    struct Waiter {
+        std::function<void(bool)> callback;
+        deadline_t deadline;
+        std::chrono::steady_clock::time_point enqueueTime;
+        uint64_t id;
+        DeadlineTimer::timer_id_t timerId = DeadlineTimer::NO_TIMER;
+    };
+
+    /**
+     * @brief Marks slot as used by client, has to be called with the lock held
+     */
+    void grant(Client& client);
+
+    /**
+     * @brief Picks waiting client of the highest priority with the lowest virtual time, has to be called with the lock held
+     */
+    Client* pickWaitingClient();
+
+    void serveWaiters(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * @brief Called by deadline timer, drops the waiter if it was not served before its deadline
+     */
+    void expireWaiter(Client* client, uint64_t waiterId);
+
+    void unregisterClient(Client* client);
+
+    mutable std::mutex mtx;
+    // read without the lock on the load path to decide whether to register a client
+    std::atomic<bool> enabled{false};
+    uint64_t nextWaiterId = 0;
+    size_t slots = 0;
+    size_t usedSlots = 0;
+    std::array<double, SCHEDULING_PRIORITIES_COUNT> classVirtualTimes{};
+    std::vector<Client*> clients;
+
+    friend class Client;
+};
+
+/**
+ * @brief Model version registered in the scheduler
+ */
+class InferenceScheduler::Client {
+public:
+    Client(InferenceScheduler& scheduler, const std::string& name, uint32_t weight, SchedulingPriority priority) :
+        scheduler(scheduler),
+        name(name),
+        weight(weight),
+        priority(priority) {}
+
+    ~Client() {
+        scheduler.unregisterClient(this);
+    }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    InferenceScheduler& getScheduler() const {
+        return scheduler;
+    }
+
+    const std::string& getName() const {
+        return name;
+    }
+
+    SchedulingPriority getPriority() const {
+        return priority;
+    }
+
+    uint32_t getWeight() const {
+        return weight;
+    }
+
+private:
+    friend class InferenceScheduler;
+
+    InferenceScheduler& scheduler;
+    const std::string name;
+    const uint32_t weight;
+    const SchedulingPriority priority;
+    // slot time charged so far divided by weight, in microseconds
+    double virtualTime = 0.0;
+    std::deque<Waiter> waiters;
+    // start times of slots currently held, charged in order of grants
+    std::deque<std::chrono::steady_clock::time_point> grantTimes;
+    uint64_t grants = 0;
+    uint64_t delayedGrants = 0;
+    uint64_t waitMicroseconds = 0;
+};
+
+}  // namespace ovms
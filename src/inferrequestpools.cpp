@@ -0,0 +1,50 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "inferrequestpools.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ovinferrequestsqueue.hpp"
+
+namespace ovms {
+
+const std::string DIRECT_INFER_REQUESTS_POOL = "direct";
+
+bool computeInferRequestsPoolSizes(const infer_requests_pools_config_t& pools, uint32_t nireq, std::map<std::string, uint32_t>& sizes) {
+    sizes.clear();
+    uint64_t reserved = 0;
+    for (const auto& [name, pool] : pools) {
+        uint32_t size = pool.nireq > 0 ? pool.nireq : static_cast<uint32_t>(std::lround(pool.share * nireq));
+        size = std::max<uint32_t>(size, 1);
+        sizes[name] = size;
+        reserved += size;
+    }
+    if (reserved >= nireq) {
+        sizes.clear();
+        return false;
+    }
+    return true;
+}
+
+OVInferRequestsQueue& selectInferRequestsPoolQueue(OVInferRequestsQueue& pool, OVInferRequestsQueue& shared) {
+    if (pool.getIdleStreamsCount() == 0 && shared.getIdleStreamsCount() > 0 && shared.getWaitersCount() == 0) {
+        return shared;
+    }
+    return pool;
+}
+
+}  // namespace ovms
@@ -0,0 +1,65 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace ovms {
+
+class OVInferRequestsQueue;
+
+/**
+ * @brief Name of the pool serving requests sent directly to the model, other pools are named after pipelines
+ */
+extern const std::string DIRECT_INFER_REQUESTS_POOL;
+
+/**
+ * @brief Infer requests reserved for one class of traffic of a model, either a fixed number or a share of model nireq
+ */
+struct InferRequestsPoolConfig {
+    uint32_t nireq = 0;
+    double share = 0;
+
+    bool operator==(const InferRequestsPoolConfig& rhs) const {
+        return nireq == rhs.nireq && share == rhs.share;
+    }
+    bool operator!=(const InferRequestsPoolConfig& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+using infer_requests_pools_config_t = std::map<std::string, InferRequestsPoolConfig>;
+
+/**
+ * @brief Splits model nireq between configured pools, infer requests left are shared by the rest of the traffic
+ *
+ * Share is rounded, but every pool gets at least one infer request.
+ *
+ * @return false if pools would leave no infer request for shared queue
+ */
+bool computeInferRequestsPoolSizes(const infer_requests_pools_config_t& pools, uint32_t nireq, std::map<std::string, uint32_t>& sizes);
+
+/**
+ * @brief Chooses queue for a request of the pool, pool borrows an idle stream of the shared queue when all of its own are busy
+ *
+ * Shared queue lends streams only when nobody waits for it, and it never takes streams reserved by pools,
+ * so a burst of one traffic class cannot starve the others.
+ */
+OVInferRequestsQueue& selectInferRequestsPoolQueue(OVInferRequestsQueue& pool, OVInferRequestsQueue& shared);
+
+}  // namespace ovms
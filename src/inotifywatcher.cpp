@@ -0,0 +1,198 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "inotifywatcher.hpp"
+
+#include <filesystem>
+#include <vector>
+
+#include <poll.h>
+#include <spdlog/spdlog.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "logging.hpp"
+
+namespace ovms {
+
+static const uint32_t WATCHED_EVENTS = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE |
+                                       IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+InotifyWatcher::InotifyWatcher() :
+    fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+    wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (fd < 0) {
+        SPDLOG_LOGGER_WARN(modelmanager_logger, "Could not create inotify instance, errno: {}", errno);
+    }
+}
+
+InotifyWatcher::~InotifyWatcher() {
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+}
+
+void InotifyWatcher::wake() {
+    if (wakeFd >= 0) {
+        const uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Could not wake inotify watcher, errno: {}", errno);
+        }
+    }
+}
+
+bool InotifyWatcher::watchDirectory(const std::string& path, const std::string& tag) {
+    if (!isValid()) {
+        return false;
+    }
+    int wd = inotify_add_watch(fd, path.c_str(), WATCHED_EVENTS);
+    if (wd < 0) {
+        SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Could not watch directory: {} errno: {}", path, errno);
+        return false;
+    }
+    watchTags[wd].insert(tag);
+    return true;
+}
+
+bool InotifyWatcher::watchTree(const std::string& path, const std::string& tag) {
+    if (!isValid()) {
+        return false;
+    }
+    std::error_code error;
+    if (!std::filesystem::is_directory(path, error)) {
+        return false;
+    }
+    int wd = inotify_add_watch(fd, path.c_str(), WATCHED_EVENTS);
+    if (wd < 0) {
+        SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Could not watch directory: {} errno: {}", path, errno);
+        return false;
+    }
+    watchTags[wd].insert(tag);
+    treeRoots[wd] = path;
+    for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+        if (entry.is_directory(error)) {
+            // subdirectory removed in the meantime is reported by the parent
+            watchDirectory(entry.path().string(), tag);
+        }
+    }
+    SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Watching directory: {} for changes of: {}", path, tag);
+    return true;
+}
+
+void InotifyWatcher::unwatch(const std::string& tag) {
+    for (auto it = watchTags.begin(); it != watchTags.end();) {
+        it->second.erase(tag);
+        if (it->second.empty()) {
+            inotify_rm_watch(fd, it->first);
+            treeRoots.erase(it->first);
+            it = watchTags.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::set<std::string> InotifyWatcher::getTags() const {
+    std::set<std::string> tags;
+    for (const auto& [wd, watchedTags] : watchTags) {
+        tags.insert(watchedTags.begin(), watchedTags.end());
+    }
+    return tags;
+}
+
+bool InotifyWatcher::readEvents(std::chrono::milliseconds timeout, std::set<std::string>& changedTags) {
+    struct pollfd pfds[] = {{fd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+    if (poll(pfds, wakeFd >= 0 ? 2 : 1, timeout.count()) <= 0) {
+        return false;
+    }
+    if (wakeFd >= 0 && (pfds[1].revents & POLLIN)) {
+        uint64_t count = 0;
+        while (read(wakeFd, &count, sizeof(count)) > 0) {
+        }
+        woken = true;
+    }
+    alignas(struct inotify_event) char buffer[4096];
+    bool anyEvent = false;
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            // EAGAIN when all events are read
+            break;
+        }
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                // events were lost, every watched directory has to be checked
+                for (const auto& [wd, tags] : watchTags) {
+                    changedTags.insert(tags.begin(), tags.end());
+                }
+                anyEvent = true;
+                continue;
+            }
+            auto it = watchTags.find(event->wd);
+            if (it == watchTags.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                // directory was removed, the change is also reported by its parent
+                treeRoots.erase(event->wd);
+                watchTags.erase(it);
+                continue;
+            }
+            changedTags.insert(it->second.begin(), it->second.end());
+            auto root = treeRoots.find(event->wd);
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) && event->len > 0 && root != treeRoots.end()) {
+                // files copied into a new version directory after its creation are reported as well
+                const auto tags = it->second;
+                for (const auto& tag : tags) {
+                    watchDirectory(root->second + "/" + event->name, tag);
+                }
+            }
+            anyEvent = true;
+        }
+    }
+    return anyEvent;
+}
+
+std::set<std::string> InotifyWatcher::waitForChanges(std::chrono::milliseconds timeout, std::chrono::milliseconds quietPeriod) {
+    std::set<std::string> changedTags;
+    if (!isValid()) {
+        return changedTags;
+    }
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (changedTags.empty()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return changedTags;
+        }
+        readEvents(remaining, changedTags);
+        if (woken) {
+            woken = false;
+            return changedTags;
+        }
+    }
+    // directory changing all the time is reported after timeout at the latest
+    deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline && readEvents(quietPeriod, changedTags)) {
+    }
+    return changedTags;
+}
+
+}  // namespace ovms
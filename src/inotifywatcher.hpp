@@ -0,0 +1,101 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+
+namespace ovms {
+
+/**
+ * @brief Reports changes of local directories with inotify, so the model manager reloads only models
+ * whose repository changed. Each watched directory is identified by tags, e.g. names of models stored in it.
+ */
+class InotifyWatcher {
+public:
+    InotifyWatcher();
+    ~InotifyWatcher();
+
+    InotifyWatcher(const InotifyWatcher&) = delete;
+    InotifyWatcher& operator=(const InotifyWatcher&) = delete;
+
+    /**
+     * @brief Checks if inotify instance was created
+     */
+    bool isValid() const {
+        return fd >= 0;
+    }
+
+    /**
+     * @brief Watches directory for entries being created, removed, renamed or written
+     *
+     * @param path local directory
+     * @param tag reported when the directory changes
+     *
+     * @return false if path cannot be watched
+     */
+    bool watchDirectory(const std::string& path, const std::string& tag);
+
+    /**
+     * @brief Watches directory and its direct subdirectories for entries being created, removed, renamed or written.
+     * Subdirectories created later, e.g. new versions, are watched as soon as their creation is read.
+     *
+     * @param path local directory
+     * @param tag reported when any of the directories changes
+     *
+     * @return false if path is not a local directory or it cannot be watched
+     */
+    bool watchTree(const std::string& path, const std::string& tag);
+
+    /**
+     * @brief Stops reporting changes with tag, directories without other tags are no longer watched
+     */
+    void unwatch(const std::string& tag);
+
+    /**
+     * @brief Gets tags of watched directories
+     */
+    std::set<std::string> getTags() const;
+
+    /**
+     * @brief Waits for changes of watched directories. After the first change, following ones are gathered
+     * until no change comes for quiet period, so copying files of a new version is reported once.
+     *
+     * @param timeout maximum time to wait for the first change, and to gather following ones
+     * @param quietPeriod time without changes after which gathering stops
+     *
+     * @return tags of changed directories, empty on timeout
+     */
+    std::set<std::string> waitForChanges(std::chrono::milliseconds timeout, std::chrono::milliseconds quietPeriod);
+
+    /**
+     * @brief Makes waiting waitForChanges return right away, safe to call from any thread
+     */
+    void wake();
+
+private:
+    bool readEvents(std::chrono::milliseconds timeout, std::set<std::string>& changedTags);
+
+    int fd = -1;
+    int wakeFd = -1;
+    bool woken = false;
+    std::map<int, std::set<std::string>> watchTags;
+    std::map<int, std::string> treeRoots;
+};
+
+}  // namespace ovms
@@ -0,0 +1,324 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "inplacerequestparser.hpp"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+namespace {
+// field numbers of tensorflow_serving/apis/predict.proto and tensorflow/core/framework/tensor.proto
+const uint64_t PREDICT_REQUEST_INPUTS_FIELD = 2;
+const uint64_t MAP_ENTRY_KEY_FIELD = 1;
+const uint64_t MAP_ENTRY_VALUE_FIELD = 2;
+const uint64_t TENSOR_CONTENT_FIELD = 4;
+
+const uint64_t WIRE_TYPE_VARINT = 0;
+const uint64_t WIRE_TYPE_FIXED64 = 1;
+const uint64_t WIRE_TYPE_LENGTH_DELIMITED = 2;
+const uint64_t WIRE_TYPE_FIXED32 = 5;
+
+/**
+ * @brief Reads protocol buffers encoding spread over slices of a message
+ */
+class SliceReader {
+public:
+    explicit SliceReader(const std::vector<grpc::Slice>& slices) :
+        slices(slices) {}
+
+    size_t position() const {
+        return consumed;
+    }
+
+    bool readVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (!normalize()) {
+                return false;
+            }
+            const uint8_t byte = slices[index].begin()[offset++];
+            ++consumed;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool append(size_t byteSize, std::string& destination) {
+        while (byteSize > 0) {
+            if (!normalize()) {
+                return false;
+            }
+            const size_t chunk = std::min(byteSize, slices[index].size() - offset);
+            destination.append(reinterpret_cast<const char*>(slices[index].begin()) + offset, chunk);
+            offset += chunk;
+            consumed += chunk;
+            byteSize -= chunk;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns following bytes when they are stored in a single slice, nullptr otherwise
+     */
+    const char* contiguous(size_t byteSize, const grpc::Slice*& slice) {
+        if (!normalize() || slices[index].size() - offset < byteSize) {
+            return nullptr;
+        }
+        slice = &slices[index];
+        const char* data = reinterpret_cast<const char*>(slices[index].begin()) + offset;
+        offset += byteSize;
+        consumed += byteSize;
+        return data;
+    }
+
+private:
+    // skips exhausted slices, returns false at the end of the message
+    bool normalize() {
+        while (index < slices.size() && offset == slices[index].size()) {
+            ++index;
+            offset = 0;
+        }
+        return index < slices.size();
+    }
+
+    const std::vector<grpc::Slice>& slices;
+    size_t index = 0;
+    size_t offset = 0;
+    size_t consumed = 0;
+};
+
+void appendVarint(std::string& destination, uint64_t value) {
+    while (value >= 0x80) {
+        destination.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    destination.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Re-encodes single field following the tag, groups are not supported
+ */
+bool copyField(SliceReader& reader, uint64_t tag, std::string& destination) {
+    appendVarint(destination, tag);
+    uint64_t value;
+    switch (tag & 0x7) {
+    case WIRE_TYPE_VARINT:
+        if (!reader.readVarint(value)) {
+            return false;
+        }
+        appendVarint(destination, value);
+        return true;
+    case WIRE_TYPE_FIXED64:
+        return reader.append(8, destination);
+    case WIRE_TYPE_FIXED32:
+        return reader.append(4, destination);
+    case WIRE_TYPE_LENGTH_DELIMITED:
+        if (!reader.readVarint(value)) {
+            return false;
+        }
+        appendVarint(destination, value);
+        return reader.append(value, destination);
+    default:
+        return false;
+    }
+}
+
+struct InPlaceContent {
+    const char* data = nullptr;
+    size_t byteSize = 0;
+    grpc::Slice slice;
+};
+
+bool parseTensor(SliceReader& reader, size_t end, size_t minInPlaceByteSize, tensorflow::TensorProto& proto, std::optional<InPlaceContent>& content) {
+    std::string serialized;
+    while (reader.position() < end) {
+        uint64_t tag;
+        if (!reader.readVarint(tag)) {
+            return false;
+        }
+        if ((tag >> 3) != TENSOR_CONTENT_FIELD || (tag & 0x7) != WIRE_TYPE_LENGTH_DELIMITED) {
+            if (!copyField(reader, tag, serialized)) {
+                return false;
+            }
+            continue;
+        }
+        uint64_t byteSize;
+        if (!reader.readVarint(byteSize)) {
+            return false;
+        }
+        const grpc::Slice* slice = nullptr;
+        const char* data = byteSize >= minInPlaceByteSize ? reader.contiguous(byteSize, slice) : nullptr;
+        if (data != nullptr) {
+            content = InPlaceContent{data, byteSize, *slice};
+            continue;
+        }
+        // last occurrence of the field wins
+        content.reset();
+        appendVarint(serialized, tag);
+        appendVarint(serialized, byteSize);
+        if (!reader.append(byteSize, serialized)) {
+            return false;
+        }
+    }
+    return reader.position() == end && proto.MergeFromString(serialized);
+}
+
+bool parseInputsEntry(SliceReader& reader, size_t end, size_t minInPlaceByteSize,
+    std::string& name, tensorflow::TensorProto& proto, std::optional<InPlaceContent>& content) {
+    while (reader.position() < end) {
+        uint64_t tag;
+        if (!reader.readVarint(tag)) {
+            return false;
+        }
+        const uint64_t field = tag >> 3;
+        if ((tag & 0x7) == WIRE_TYPE_LENGTH_DELIMITED && (field == MAP_ENTRY_KEY_FIELD || field == MAP_ENTRY_VALUE_FIELD)) {
+            uint64_t byteSize;
+            if (!reader.readVarint(byteSize)) {
+                return false;
+            }
+            if (field == MAP_ENTRY_KEY_FIELD) {
+                name.clear();
+                if (!reader.append(byteSize, name)) {
+                    return false;
+                }
+            } else if (!parseTensor(reader, reader.position() + byteSize, minInPlaceByteSize, proto, content)) {
+                return false;
+            }
+            continue;
+        }
+        // unknown fields of map entries are dropped by protobuf as well
+        std::string ignored;
+        if (!copyField(reader, tag, ignored)) {
+            return false;
+        }
+    }
+    return reader.position() == end;
+}
+}  // namespace
+
+void InPlaceRequestTensors::add(const tensorflow::TensorProto* proto, std::shared_ptr<SharedMemoryRegion> region) {
+    MessageTensorRegistry::getInstance().registerTensor(proto, std::move(region));
+    tensors.push_back(proto);
+}
+
+void InPlaceRequestTensors::copyConvertedInputs(tensorflow::serving::PredictRequest& request, const tensor_map_t& inputsInfo) {
+    for (auto& [name, proto] : *request.mutable_inputs()) {
+        auto it = std::find(tensors.begin(), tensors.end(), &proto);
+        auto input = inputsInfo.find(name);
+        if (it == tensors.end() || input == inputsInfo.end()) {
+            continue;
+        }
+        const auto& tensorInfo = *input->second;
+        if (proto.dtype() == tensorInfo.getPrecisionAsDataType() && !tensorInfo.isLayoutTransposed() && !tensorInfo.isResized()) {
+            continue;
+        }
+        auto region = MessageTensorRegistry::getInstance().findRegion(&proto);
+        MessageTensorRegistry::getInstance().unregisterTensor(&proto);
+        tensors.erase(it);
+        if (region == nullptr) {
+            continue;
+        }
+        SPDLOG_DEBUG("Input: {} is converted by the model, copying {} bytes of its content", name, region->getByteSize());
+        proto.clear_string_val();
+        proto.set_tensor_content(region->getData(), region->getByteSize());
+    }
+}
+
+void InPlaceRequestTensors::release() {
+    for (const auto* proto : tensors) {
+        MessageTensorRegistry::getInstance().unregisterTensor(proto);
+    }
+    tensors.clear();
+}
+
+Status parsePredictRequestInPlace(const grpc::ByteBuffer& buffer,
+    tensorflow::serving::PredictRequest& request,
+    InPlaceRequestTensors& tensors,
+    size_t minInPlaceByteSize) {
+    std::vector<grpc::Slice> slices;
+    if (!buffer.Dump(&slices).ok()) {
+        return StatusCode::MALFORMED_REQUEST_MESSAGE;
+    }
+    SliceReader reader(slices);
+    const size_t end = buffer.Length();
+    std::string serialized;
+    std::map<std::string, tensorflow::TensorProto> inputs;
+    std::map<std::string, InPlaceContent> contents;
+    while (reader.position() < end) {
+        uint64_t tag;
+        if (!reader.readVarint(tag)) {
+            SPDLOG_DEBUG("Malformed request message at byte: {}", reader.position());
+            return StatusCode::MALFORMED_REQUEST_MESSAGE;
+        }
+        if ((tag >> 3) != PREDICT_REQUEST_INPUTS_FIELD || (tag & 0x7) != WIRE_TYPE_LENGTH_DELIMITED) {
+            if (!copyField(reader, tag, serialized)) {
+                SPDLOG_DEBUG("Malformed request message at byte: {}", reader.position());
+                return StatusCode::MALFORMED_REQUEST_MESSAGE;
+            }
+            continue;
+        }
+        uint64_t byteSize;
+        std::string name;
+        tensorflow::TensorProto proto;
+        std::optional<InPlaceContent> content;
+        if (!reader.readVarint(byteSize) ||
+            !parseInputsEntry(reader, reader.position() + byteSize, minInPlaceByteSize, name, proto, content)) {
+            SPDLOG_DEBUG("Malformed request message input at byte: {}", reader.position());
+            return StatusCode::MALFORMED_REQUEST_MESSAGE;
+        }
+        // same as protobuf map parsing, the last entry of repeated name replaces previous ones
+        inputs[name] = std::move(proto);
+        if (content) {
+            contents[name] = std::move(*content);
+        } else {
+            contents.erase(name);
+        }
+    }
+    if (reader.position() != end || !request.ParseFromString(serialized)) {
+        SPDLOG_DEBUG("Malformed request message");
+        return StatusCode::MALFORMED_REQUEST_MESSAGE;
+    }
+    auto& requestInputs = *request.mutable_inputs();
+    for (auto& [name, proto] : inputs) {
+        requestInputs[name] = std::move(proto);
+    }
+    // tensor addresses are registered once the map is complete
+    for (auto& [name, content] : contents) {
+        auto& proto = requestInputs.at(name);
+        if (proto.dtype() == tensorflow::DataType::DT_STRING || proto.string_val_size() > 0) {
+            proto.set_tensor_content(content.data, content.byteSize);
+            continue;
+        }
+        proto.clear_tensor_content();
+        proto.add_string_val(sharedMemoryReferenceToString({MESSAGE_TENSOR_REGION_NAME, 0, content.byteSize}));
+        // inference does not write into input blobs
+        auto region = SharedMemoryRegion::wrap(name, const_cast<char*>(content.data), content.byteSize,
+            std::make_shared<grpc::Slice>(std::move(content.slice)));
+        tensors.add(&proto, std::move(region));
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
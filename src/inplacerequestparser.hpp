@@ -0,0 +1,96 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <grpcpp/support/byte_buffer.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "sharedmemory.hpp"
+#include "status.hpp"
+#include "tensorinfo.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Smallest tensor_content which is referenced in the received message instead of being copied
+ */
+const size_t MIN_IN_PLACE_TENSOR_BYTE_SIZE = 64 * 1024;
+
+/**
+ * @brief Keeps request tensors registered in MessageTensorRegistry for the time the request is processed
+ */
+class InPlaceRequestTensors {
+public:
+    InPlaceRequestTensors() = default;
+
+    ~InPlaceRequestTensors() {
+        release();
+    }
+
+    InPlaceRequestTensors(const InPlaceRequestTensors&) = delete;
+    InPlaceRequestTensors& operator=(const InPlaceRequestTensors&) = delete;
+
+    void add(const tensorflow::TensorProto* proto, std::shared_ptr<SharedMemoryRegion> region);
+
+    /**
+     * @brief Unregisters tensors, blobs created from them keep the message memory until they are released
+     */
+    void release();
+
+    /**
+     * @brief Copies referenced content back into tensor_content of request inputs which are not used by the model as they
+     * are, because of precision conversion, layout transposition or resize. References are used by the inference only in place.
+     *
+     * @param request holding the registered tensors
+     * @param inputsInfo inputs of the model the request is sent to
+     */
+    void copyConvertedInputs(tensorflow::serving::PredictRequest& request, const tensor_map_t& inputsInfo);
+
+    size_t size() const {
+        return tensors.size();
+    }
+
+private:
+    std::vector<const tensorflow::TensorProto*> tensors;
+};
+
+/**
+ * @brief Parses serialized PredictRequest without copying large tensor_content of inputs.
+ *
+ * Inputs with tensor_content of at least minInPlaceByteSize bytes, stored in a single slice of the buffer,
+ * are replaced with "shm:@message:0:<byte size>" references resolved by existing shared memory paths.
+ * Slices are kept alive by the blobs using them. All other fields are parsed the same way as by protobuf.
+ *
+ * @param buffer received message
+ * @param request
+ * @param tensors filled with tensors referencing the buffer, has to outlive request processing and be released before request is destroyed
+ * @param minInPlaceByteSize
+ *
+ * @return Status
+ */
+Status parsePredictRequestInPlace(const grpc::ByteBuffer& buffer,
+    tensorflow::serving::PredictRequest& request,
+    InPlaceRequestTensors& tensors,
+    size_t minInPlaceByteSize = MIN_IN_PLACE_TENSOR_BYTE_SIZE);
+
+}  // namespace ovms
@@ -0,0 +1,259 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "inprocess.hpp"
+
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "config.hpp"
+#include "deserialization.hpp"
+#include "executinstreamidguard.hpp"
+#include "logging.hpp"
+#include "modelinstance.hpp"
+#include "modelinstanceunloadguard.hpp"
+#include "modelmanager.hpp"
+#include "pendingrequestguard.hpp"
+#include "pipeline.hpp"
+#include "pipelinedefinition.hpp"
+#include "prediction_service_utils.hpp"
+#include "transposition.hpp"
+
+namespace ovms {
+
+namespace {
+/**
+ * @brief Points blobs of infer request into memory of the caller, original blobs are set back before the stream
+ * is returned so following inferences neither read caller inputs nor write into returned outputs
+ */
+class InProcessBlobsGuard {
+public:
+    InProcessBlobsGuard(InferenceEngine::InferRequest& inferRequest) :
+        inferRequest(inferRequest) {}
+
+    ~InProcessBlobsGuard() {
+        for (const auto& [name, blob] : originalBlobs) {
+            inferRequest.SetBlob(name, blob);
+        }
+    }
+
+    void set(const std::string& name, const InferenceEngine::Blob::Ptr& blob) {
+        // the first replaced blob is the one owned by infer request
+        if (originalBlobs.count(name) == 0) {
+            originalBlobs[name] = inferRequest.GetBlob(name);
+        }
+        inferRequest.SetBlob(name, blob);
+    }
+
+    Status prepareOutputs(const tensor_map_t& outputsInfo, BlobMap& outputs) {
+        for (const auto& [name, tensorInfo] : outputsInfo) {
+            auto blob = allocateConvertedBlob(tensorInfo->getTensorDesc());
+            if (blob == nullptr) {
+                return StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION;
+            }
+            set(tensorInfo->getName(), blob);
+            outputs[name] = std::move(blob);
+        }
+        return StatusCode::OK;
+    }
+
+private:
+    InferenceEngine::InferRequest& inferRequest;
+    std::map<std::string, InferenceEngine::Blob::Ptr> originalBlobs;
+};
+}  // namespace
+
+Status InProcessServer::start(int argc, char** argv) {
+    auto& config = Config::instance().parse(argc, argv);
+    configure_logger(config.logLevel(), config.logPath(), config.logQueueSize(), config.logQueueOverflow() == "drop");
+    return ModelManager::getInstance().start();
+}
+
+void InProcessServer::stop() {
+    ModelManager::getInstance().join();
+}
+
+InferenceEngine::Blob::Ptr InProcessServer::wrapBuffer(const InferenceEngine::TensorDesc& tensorDesc, void* data) {
+    switch (tensorDesc.getPrecision()) {
+    case InferenceEngine::Precision::FP32:
+        return InferenceEngine::make_shared_blob<float>(tensorDesc, static_cast<float*>(data));
+    case InferenceEngine::Precision::FP16:
+    case InferenceEngine::Precision::BF16:
+    case InferenceEngine::Precision::U16:
+        return InferenceEngine::make_shared_blob<uint16_t>(tensorDesc, static_cast<uint16_t*>(data));
+    case InferenceEngine::Precision::U8:
+    case InferenceEngine::Precision::BOOL:
+        return InferenceEngine::make_shared_blob<uint8_t>(tensorDesc, static_cast<uint8_t*>(data));
+    case InferenceEngine::Precision::I8:
+        return InferenceEngine::make_shared_blob<int8_t>(tensorDesc, static_cast<int8_t*>(data));
+    case InferenceEngine::Precision::I16:
+        return InferenceEngine::make_shared_blob<int16_t>(tensorDesc, static_cast<int16_t*>(data));
+    case InferenceEngine::Precision::I32:
+        return InferenceEngine::make_shared_blob<int32_t>(tensorDesc, static_cast<int32_t*>(data));
+    case InferenceEngine::Precision::I64:
+        return InferenceEngine::make_shared_blob<int64_t>(tensorDesc, static_cast<int64_t*>(data));
+    default:
+        return nullptr;
+    }
+}
+
+Status InProcessServer::infer(const std::string& name, model_version_t version, const BlobMap& inputs, BlobMap& outputs,
+    const deadline_t& deadline) {
+    return infer(ModelManager::getInstance(), name, version, inputs, outputs, deadline);
+}
+
+Status InProcessServer::infer(ModelManager& manager, const std::string& name, model_version_t version, const BlobMap& inputs, BlobMap& outputs,
+    const deadline_t& deadline) {
+    if (manager.findModelByName(name) == nullptr) {
+        auto pipelineDefinition = manager.getPipelineFactory().findDefinitionByName(name);
+        if (!pipelineDefinition) {
+            return StatusCode::MODEL_NAME_MISSING;
+        }
+        std::unique_ptr<Pipeline> pipeline;
+        auto status = pipelineDefinition->create(pipeline, &inputs, &outputs, manager);
+        if (!status.ok()) {
+            return status;
+        }
+        pipeline->setDeadline(deadline);
+        return pipeline->execute();
+    }
+
+    std::shared_ptr<ModelInstance> modelInstance;
+    std::unique_ptr<ModelInstanceUnloadGuard> modelInstanceUnloadGuard;
+    auto status = getModelInstance(manager, name, version, modelInstance, modelInstanceUnloadGuard);
+    if (!status.ok()) {
+        return status;
+    }
+    return inferModel(*modelInstance, inputs, outputs, deadline);
+}
+
+Status InProcessServer::validate(const ModelInstance& modelInstance, const BlobMap& inputs) {
+    const auto& inputsInfo = modelInstance.getInputsInfo();
+    if (inputs.size() != inputsInfo.size()) {
+        std::stringstream ss;
+        ss << "Expected: " << inputsInfo.size() << "; Actual: " << inputs.size();
+        const std::string details = ss.str();
+        SPDLOG_DEBUG("[Model: {} version: {}] Invalid number of inputs - {}", modelInstance.getName(), modelInstance.getVersion(), details);
+        return Status(StatusCode::INVALID_NO_OF_INPUTS, details);
+    }
+    for (const auto& [name, tensorInfo] : inputsInfo) {
+        auto it = inputs.find(name);
+        if (it == inputs.end() || it->second == nullptr) {
+            const std::string details = "Required input: " + name;
+            SPDLOG_DEBUG("[Model: {} version: {}] Missing input with specific name - {}", modelInstance.getName(), modelInstance.getVersion(), details);
+            return Status(StatusCode::INVALID_MISSING_INPUT, details);
+        }
+        const auto& tensorDesc = it->second->getTensorDesc();
+        if (tensorDesc.getPrecision() != tensorInfo->getPrecision()) {
+            std::stringstream ss;
+            ss << "Expected: " << tensorInfo->getPrecisionAsString()
+               << "; Actual: " << TensorInfo::getPrecisionAsString(tensorDesc.getPrecision());
+            const std::string details = ss.str();
+            SPDLOG_DEBUG("[Model: {} version: {}] Invalid precision - {}", modelInstance.getName(), modelInstance.getVersion(), details);
+            return Status(StatusCode::INVALID_PRECISION, details);
+        }
+        if (tensorDesc.getDims() != tensorInfo->getRequestShape()) {
+            std::stringstream ss;
+            ss << "Expected: " << TensorInfo::shapeToString(tensorInfo->getRequestShape())
+               << "; Actual: " << TensorInfo::shapeToString(tensorDesc.getDims());
+            const std::string details = ss.str();
+            SPDLOG_DEBUG("[Model: {} version: {}] Invalid shape - {}", modelInstance.getName(), modelInstance.getVersion(), details);
+            return Status(StatusCode::INVALID_SHAPE, details);
+        }
+    }
+    return StatusCode::OK;
+}
+
+Status InProcessServer::inferModel(ModelInstance& modelInstance, const BlobMap& inputs, BlobMap& outputs, const deadline_t& deadline) {
+    auto status = validate(modelInstance, inputs);
+    if (!status.ok()) {
+        return status;
+    }
+    if (isDeadlineExceeded(deadline)) {
+        return StatusCode::DEADLINE_EXCEEDED;
+    }
+
+    PendingRequestGuard pendingRequestGuard(modelInstance);
+    if (!pendingRequestGuard.isAdmitted()) {
+        SPDLOG_DEBUG("Rejecting in-process request to model {}, version {}; pending requests limit: {} reached",
+            modelInstance.getName(), modelInstance.getVersion(), modelInstance.getModelConfig().getMaxPendingRequests());
+        return StatusCode::TOO_MANY_PENDING_REQUESTS;
+    }
+
+    auto& inferRequestsQueue = modelInstance.getInferRequestsQueue(DIRECT_INFER_REQUESTS_POOL);
+    ExecutingStreamIdGuard executingStreamIdGuard(inferRequestsQueue, deadline);
+    int executingInferId = executingStreamIdGuard.getId();
+    if (executingInferId == EXPIRED_STREAM_ID || isDeadlineExceeded(deadline)) {
+        return StatusCode::DEADLINE_EXCEEDED;
+    }
+    InferenceEngine::InferRequest& inferRequest = inferRequestsQueue.getInferRequest(executingInferId);
+    const auto& preallocatedBlobs = inferRequestsQueue.getPreallocatedInputBlobs(executingInferId);
+
+    // has to be released before the stream is returned
+    InProcessBlobsGuard blobsGuard(inferRequest);
+    try {
+        for (const auto& [name, tensorInfo] : modelInstance.getInputsInfo()) {
+            const auto& input = inputs.at(name);
+            auto preallocatedBlobItr = preallocatedBlobs.find(tensorInfo->getName());
+            if (tensorInfo->isLayoutTransposed()) {
+                auto blob = preallocatedBlobItr != preallocatedBlobs.end() ? preallocatedBlobItr->second : allocateConvertedBlob(tensorInfo->getTensorDesc());
+                transposeNhwcToNchw(input->cbuffer().as<const void*>(), blob->buffer().as<void*>(),
+                    tensorInfo->getShape(), tensorInfo->getPrecision().size());
+                if (preallocatedBlobItr == preallocatedBlobs.end()) {
+                    blobsGuard.set(tensorInfo->getName(), blob);
+                }
+                continue;
+            }
+            // Preallocated blobs have to stay set on infer request, predict requests write into them
+            if (preallocatedBlobItr != preallocatedBlobs.end()) {
+                std::memcpy(preallocatedBlobItr->second->buffer().as<void*>(), input->cbuffer().as<const void*>(), preallocatedBlobItr->second->byteSize());
+                continue;
+            }
+            // caller blob is wrapped again with network layout, data is used in place
+            auto blob = wrapBuffer(tensorInfo->getTensorDesc(), input->buffer().as<void*>());
+            if (blob == nullptr) {
+                return StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
+            }
+            blobsGuard.set(tensorInfo->getName(), blob);
+        }
+        status = blobsGuard.prepareOutputs(modelInstance.getOutputsInfo(), outputs);
+        if (!status.ok()) {
+            outputs.clear();
+            return status;
+        }
+    } catch (const InferenceEngine::details::InferenceEngineException& e) {
+        outputs.clear();
+        status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
+        SPDLOG_DEBUG("{}: {}", status.string(), e.what());
+        return status;
+    } catch (std::logic_error& e) {
+        outputs.clear();
+        status = StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR;
+        SPDLOG_DEBUG("{}: {}", status.string(), e.what());
+        return status;
+    }
+
+    status = performInference(inferRequestsQueue, executingInferId, inferRequest);
+    if (!status.ok()) {
+        outputs.clear();
+    }
+    return status;
+}
+
+}  // namespace ovms
@@ -0,0 +1,88 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <inference_engine.hpp>
+
+#include "deadline.hpp"
+#include "model_version_policy.hpp"
+#include "node.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+class ModelInstance;
+class ModelManager;
+
+/**
+ * @brief In-process inference API for applications embedding the model server. Models and pipelines are served
+ * by the same model manager as in the standalone server, including config reloads, but requests are passed
+ * as blobs over caller memory and outputs are returned as blobs written by inference. There is no protobuf
+ * encoding and no network involved.
+ */
+class InProcessServer {
+public:
+    /**
+     * @brief Parses model server options as the ovms binary does and starts model manager with config watcher.
+     * gRPC and REST servers are not started.
+     *
+     * @param argc
+     * @param argv
+     *
+     * @return Status
+     */
+    static Status start(int argc, char** argv);
+
+    /**
+     * @brief Stops config watcher of model manager
+     */
+    static void stop();
+
+    /**
+     * @brief Wraps caller memory into blob without copying, memory has to stay valid until inference returns
+     *
+     * @param tensorDesc precision and shape of the data, in NHWC order for inputs with NHWC layout in model config
+     * @param data
+     *
+     * @return blob or nullptr if precision is not supported
+     */
+    static InferenceEngine::Blob::Ptr wrapBuffer(const InferenceEngine::TensorDesc& tensorDesc, void* data);
+
+    /**
+     * @brief Runs inference of model or pipeline of given name
+     *
+     * @param name model or pipeline name
+     * @param version model version, 0 for default version; ignored for pipelines
+     * @param inputs blobs with exact precision and shape of model inputs, used in place where possible
+     * @param outputs filled with blobs owned by caller, they are not reused by following inferences
+     * @param deadline request is dropped with DEADLINE_EXCEEDED if it passes before inference is started
+     *
+     * @return Status
+     */
+    static Status infer(const std::string& name, model_version_t version, const BlobMap& inputs, BlobMap& outputs,
+        const deadline_t& deadline = NO_DEADLINE);
+    static Status infer(ModelManager& manager, const std::string& name, model_version_t version, const BlobMap& inputs, BlobMap& outputs,
+        const deadline_t& deadline = NO_DEADLINE);
+
+private:
+    static Status inferModel(ModelInstance& modelInstance, const BlobMap& inputs, BlobMap& outputs, const deadline_t& deadline);
+    static Status validate(const ModelInstance& modelInstance, const BlobMap& inputs);
+};
+
+}  // namespace ovms
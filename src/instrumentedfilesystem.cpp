@@ -0,0 +1,128 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "instrumentedfilesystem.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+#include "filesystemmetrics.hpp"
+
+namespace ovms {
+
+namespace {
+uint64_t microsecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+uint64_t InstrumentedFileSystem::getLocalDirectorySize(const std::string& path) {
+    uint64_t size = 0;
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+        std::error_code sizeError;
+        if (it->is_regular_file(sizeError)) {
+            const auto fileSize = it->file_size(sizeError);
+            if (!sizeError) {
+                size += fileSize;
+            }
+        }
+    }
+    return size;
+}
+
+StatusCode InstrumentedFileSystem::record(FileSystemOperation operation, std::chrono::steady_clock::time_point start, StatusCode status, uint64_t bytes) {
+    FileSystemMetrics::instance().recordOperation(getBackendName(), operation, microsecondsSince(start), status == StatusCode::OK, bytes);
+    return status;
+}
+
+StatusCode InstrumentedFileSystem::fileExists(const std::string& path, bool* exists) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::FILE_EXISTS, start, backend->fileExists(path, exists));
+}
+
+StatusCode InstrumentedFileSystem::isDirectory(const std::string& path, bool* is_dir) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::IS_DIRECTORY, start, backend->isDirectory(path, is_dir));
+}
+
+StatusCode InstrumentedFileSystem::getDirectoryContents(const std::string& path, files_list_t* contents) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::GET_DIRECTORY_CONTENTS, start, backend->getDirectoryContents(path, contents));
+}
+
+StatusCode InstrumentedFileSystem::getDirectorySubdirs(const std::string& path, files_list_t* subdirs) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::GET_DIRECTORY_SUBDIRS, start, backend->getDirectorySubdirs(path, subdirs));
+}
+
+StatusCode InstrumentedFileSystem::getDirectoryFiles(const std::string& path, files_list_t* files) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::GET_DIRECTORY_FILES, start, backend->getDirectoryFiles(path, files));
+}
+
+StatusCode InstrumentedFileSystem::readTextFile(const std::string& path, std::string* contents) {
+    const auto start = std::chrono::steady_clock::now();
+    auto status = backend->readTextFile(path, contents);
+    return record(FileSystemOperation::READ_TEXT_FILE, start, status, status == StatusCode::OK ? contents->size() : 0);
+}
+
+StatusCode InstrumentedFileSystem::readFileToMemory(const std::string& path, std::string* contents) {
+    const auto start = std::chrono::steady_clock::now();
+    auto status = backend->readFileToMemory(path, contents);
+    return record(FileSystemOperation::READ_FILE_TO_MEMORY, start, status, status == StatusCode::OK ? contents->size() : 0);
+}
+
+StatusCode InstrumentedFileSystem::writeFile(const std::string& path, const std::string& contents) {
+    const auto start = std::chrono::steady_clock::now();
+    auto status = backend->writeFile(path, contents);
+    return record(FileSystemOperation::WRITE_FILE, start, status, status == StatusCode::OK ? contents.size() : 0);
+}
+
+StatusCode InstrumentedFileSystem::downloadFileFolder(const std::string& path, const std::string& local_path) {
+    const auto start = std::chrono::steady_clock::now();
+    auto status = backend->downloadFileFolder(path, local_path);
+    const auto microseconds = microsecondsSince(start);
+    const uint64_t bytes = status == StatusCode::OK ? getLocalDirectorySize(local_path) : 0;
+    FileSystemMetrics::instance().recordOperation(getBackendName(), FileSystemOperation::DOWNLOAD_FILE_FOLDER, microseconds, status == StatusCode::OK, bytes);
+    return status;
+}
+
+StatusCode InstrumentedFileSystem::downloadModelVersions(const std::string& path, std::string* local_path, const std::vector<model_version_t>& versions) {
+    const auto start = std::chrono::steady_clock::now();
+    auto status = backend->downloadModelVersions(path, local_path, versions);
+    const auto microseconds = microsecondsSince(start);
+    // local models are used in place, nothing is copied
+    const uint64_t bytes = (status == StatusCode::OK && *local_path != path) ? getLocalDirectorySize(*local_path) : 0;
+    FileSystemMetrics::instance().recordOperation(getBackendName(), FileSystemOperation::DOWNLOAD_MODEL_VERSIONS, microseconds, status == StatusCode::OK, bytes);
+    return status;
+}
+
+StatusCode InstrumentedFileSystem::getVersionFingerprint(const std::string& path, model_version_t version, std::string* fingerprint) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::GET_VERSION_FINGERPRINT, start, backend->getVersionFingerprint(path, version, fingerprint));
+}
+
+StatusCode InstrumentedFileSystem::listObjectKeys(const std::string& path, std::vector<std::string>* keys, size_t maxKeys) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::LIST_OBJECT_KEYS, start, backend->listObjectKeys(path, keys, maxKeys));
+}
+
+StatusCode InstrumentedFileSystem::deleteFileFolder(const std::string& path) {
+    const auto start = std::chrono::steady_clock::now();
+    return record(FileSystemOperation::DELETE_FILE_FOLDER, start, backend->deleteFileFolder(path));
+}
+
+}  // namespace ovms
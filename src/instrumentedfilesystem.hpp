@@ -0,0 +1,75 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "filesystem.hpp"
+#include "filesystemmetrics.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Wraps a storage backend and records durations, errors and transferred bytes of its calls in FileSystemMetrics
+ *
+ * Every call of the file system interface is measured. Listings the backend makes internally, e.g. getDirectoryContents
+ * called by its getDirectorySubdirs, are part of the outer call.
+ */
+class InstrumentedFileSystem : public FileSystem {
+public:
+    explicit InstrumentedFileSystem(std::shared_ptr<FileSystem> backend) :
+        backend(std::move(backend)) {}
+
+    StatusCode fileExists(const std::string& path, bool* exists) override;
+    StatusCode isDirectory(const std::string& path, bool* is_dir) override;
+    StatusCode getDirectoryContents(const std::string& path, files_list_t* contents) override;
+    StatusCode getDirectorySubdirs(const std::string& path, files_list_t* subdirs) override;
+    StatusCode getDirectoryFiles(const std::string& path, files_list_t* files) override;
+    StatusCode readTextFile(const std::string& path, std::string* contents) override;
+    StatusCode readFileToMemory(const std::string& path, std::string* contents) override;
+    StatusCode writeFile(const std::string& path, const std::string& contents) override;
+    StatusCode downloadFileFolder(const std::string& path, const std::string& local_path) override;
+    StatusCode downloadModelVersions(const std::string& path, std::string* local_path, const std::vector<model_version_t>& versions) override;
+    StatusCode getVersionFingerprint(const std::string& path, model_version_t version, std::string* fingerprint) override;
+    StatusCode listObjectKeys(const std::string& path, std::vector<std::string>* keys, size_t maxKeys) override;
+    const char* getBackendName() const override {
+        return backend->getBackendName();
+    }
+    StatusCode deleteFileFolder(const std::string& path) override;
+
+    /**
+     * @brief Sum of sizes of regular files in the local directory tree, 0 when it cannot be listed
+     */
+    static uint64_t getLocalDirectorySize(const std::string& path);
+
+private:
+    /**
+     * @brief Records call started at start which finished with status
+     *
+     * @return status
+     */
+    StatusCode record(FileSystemOperation operation, std::chrono::steady_clock::time_point start, StatusCode status, uint64_t bytes = 0);
+
+    std::shared_ptr<FileSystem> backend;
+};
+
+}  // namespace ovms
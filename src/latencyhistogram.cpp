@@ -0,0 +1,107 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "latencyhistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ovms {
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::getBucketIndex(uint64_t microseconds) {
+    microseconds = std::min(microseconds, MAX_TRACKED_MICROSECONDS);
+    if (microseconds < SUB_BUCKETS_COUNT) {
+        return microseconds;
+    }
+    size_t magnitude = 63 - __builtin_clzll(microseconds);
+    size_t shift = magnitude - SUB_BUCKETS_BITS;
+    size_t subBucket = (microseconds >> shift) - SUB_BUCKETS_COUNT;
+    return SUB_BUCKETS_COUNT + shift * SUB_BUCKETS_COUNT + subBucket;
+}
+
+uint64_t LatencyHistogram::getBucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS_COUNT) {
+        return index;
+    }
+    size_t shift = (index - SUB_BUCKETS_COUNT) / SUB_BUCKETS_COUNT;
+    uint64_t subBucket = (index - SUB_BUCKETS_COUNT) % SUB_BUCKETS_COUNT;
+    return ((SUB_BUCKETS_COUNT + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t microseconds) {
+    buckets[getBucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(microseconds, std::memory_order_relaxed);
+    auto currentMax = max.load(std::memory_order_relaxed);
+    while (currentMax < microseconds && !max.compare_exchange_weak(currentMax, microseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::recordExclusive(uint64_t microseconds) {
+    auto& bucket = buckets[getBucketIndex(microseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum.store(sum.load(std::memory_order_relaxed) + microseconds, std::memory_order_relaxed);
+    if (max.load(std::memory_order_relaxed) < microseconds) {
+        max.store(microseconds, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    for (size_t index = 0; index < BUCKETS_COUNT; ++index) {
+        buckets[index].fetch_add(other.getBucketCount(index), std::memory_order_relaxed);
+    }
+    count.fetch_add(other.getCount(), std::memory_order_relaxed);
+    sum.fetch_add(other.getSum(), std::memory_order_relaxed);
+    const auto otherMax = other.getMax();
+    auto currentMax = max.load(std::memory_order_relaxed);
+    while (currentMax < otherMax && !max.compare_exchange_weak(currentMax, otherMax, std::memory_order_relaxed)) {
+    }
+}
+
+double LatencyHistogram::getMean() const {
+    auto recordedCount = getCount();
+    if (recordedCount == 0) {
+        return 0;
+    }
+    return static_cast<double>(sum.load(std::memory_order_relaxed)) / recordedCount;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    auto recordedCount = getCount();
+    if (recordedCount == 0) {
+        return 0;
+    }
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    auto requiredCount = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * recordedCount)));
+    uint64_t seenCount = 0;
+    for (size_t index = 0; index < BUCKETS_COUNT; ++index) {
+        seenCount += buckets[index].load(std::memory_order_relaxed);
+        if (seenCount >= requiredCount) {
+            // bucket bound may exceed any recorded value
+            return std::min(getBucketUpperBound(index), getMax());
+        }
+    }
+    // values recorded while reading are missing from buckets seen already
+    return getMax();
+}
+
+}  // namespace ovms
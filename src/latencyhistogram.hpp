@@ -0,0 +1,93 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace ovms {
+
+/**
+ * @brief Lock-free histogram of latencies in microseconds with log-linear buckets
+ *
+ * Each power of two range is split into SUB_BUCKETS_COUNT equal buckets, as in HDR histograms, so reported
+ * percentiles are within 1/SUB_BUCKETS_COUNT of the recorded values while memory stays constant.
+ * Values above MAX_TRACKED_MICROSECONDS are counted in the last bucket. Recording costs a few relaxed atomic operations.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKETS_BITS = 4;
+    static constexpr size_t SUB_BUCKETS_COUNT = 1 << SUB_BUCKETS_BITS;
+    static constexpr size_t MAX_MAGNITUDE = 39;
+    static constexpr uint64_t MAX_TRACKED_MICROSECONDS = (uint64_t(1) << (MAX_MAGNITUDE + 1)) - 1;
+    static constexpr size_t BUCKETS_COUNT = SUB_BUCKETS_COUNT + (MAX_MAGNITUDE + 1 - SUB_BUCKETS_BITS) * SUB_BUCKETS_COUNT;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t microseconds);
+
+    /**
+     * @return recorded microseconds
+     */
+    uint64_t recordSince(std::chrono::steady_clock::time_point start) {
+        const uint64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        record(microseconds);
+        return microseconds;
+    }
+
+    /**
+     * @brief Records with plain loads and stores instead of atomic read-modify-write, when only one thread records into the histogram.
+     * Other threads may read it meanwhile.
+     */
+    void recordExclusive(uint64_t microseconds);
+
+    /**
+     * @brief Adds values recorded by other histogram
+     */
+    void add(const LatencyHistogram& other);
+
+    uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return max.load(std::memory_order_relaxed); }
+    uint64_t getSum() const { return sum.load(std::memory_order_relaxed); }
+    uint64_t getBucketCount(size_t index) const { return buckets[index].load(std::memory_order_relaxed); }
+
+    double getMean() const;
+
+    /**
+     * @brief Gives the upper bound of the bucket containing given percentile of recorded values
+     *
+     * @param percentile in range from 0 to 100
+     *
+     * @return 0 when nothing was recorded
+     */
+    uint64_t getPercentile(double percentile) const;
+
+    static size_t getBucketIndex(uint64_t microseconds);
+    static uint64_t getBucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS_COUNT> buckets;
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+}  // namespace ovms
@@ -0,0 +1,101 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "lazymodelsbudget.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "logging.hpp"
+#include "modelinstance.hpp"
+
+namespace ovms {
+
+void LazyModelsBudget::setLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = bytes;
+}
+
+size_t LazyModelsBudget::getLimit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return limit;
+}
+
+size_t LazyModelsBudget::getUsed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+void LazyModelsBudget::reserve(ModelInstance& instance, size_t bytes) {
+    while (true) {
+        std::vector<std::shared_ptr<ModelInstance>> candidates;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (reservations.count(&instance)) {
+                return;
+            }
+            if (limit == 0 || used + bytes <= limit) {
+                reservations[&instance] = {instance.weak_from_this(), bytes};
+                used += bytes;
+                return;
+            }
+            for (auto& [key, reservation] : reservations) {
+                auto candidate = reservation.instance.lock();
+                if (candidate) {
+                    candidates.push_back(std::move(candidate));
+                }
+            }
+        }
+        // deactivation releases its reservation so it has to be done without holding the lock
+        std::sort(candidates.begin(), candidates.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs->getLastUsed() < rhs->getLastUsed(); });
+        bool deactivated = false;
+        for (auto& candidate : candidates) {
+            if (candidate->deactivateIfIdle(std::chrono::steady_clock::now())) {
+                SPDLOG_LOGGER_INFO(modelmanager_logger, "Deactivated model: {} version: {} to fit memory budget of lazily loaded models",
+                    candidate->getName(), candidate->getVersion());
+                deactivated = true;
+                break;
+            }
+        }
+        if (!deactivated) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (reservations.count(&instance)) {
+                return;
+            }
+            SPDLOG_LOGGER_WARN(modelmanager_logger, "Activating model: {} version: {} exceeds memory budget of lazily loaded models: {} MB, all activated models are in use",
+                instance.getName(), instance.getVersion(), limit / (1024 * 1024));
+            reservations[&instance] = {instance.weak_from_this(), bytes};
+            used += bytes;
+            return;
+        }
+    }
+}
+
+void LazyModelsBudget::release(const ModelInstance& instance) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = reservations.find(&instance);
+    if (it == reservations.end()) {
+        return;
+    }
+    used -= it->second.bytes;
+    reservations.erase(it);
+}
+
+}  // namespace ovms
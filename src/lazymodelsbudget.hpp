@@ -0,0 +1,80 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ovms {
+
+class ModelInstance;
+
+/**
+ * @brief Memory budget shared by activated lazily loaded model versions. When activating a version would exceed
+ * the limit, least recently used idle versions are deactivated first.
+ */
+class LazyModelsBudget {
+public:
+    static LazyModelsBudget& instance() {
+        static LazyModelsBudget instance;
+        return instance;
+    }
+
+    /**
+     * @brief Sets memory limit of activated lazily loaded model versions
+     *
+     * @param bytes 0 means no limit
+     */
+    void setLimit(size_t bytes);
+
+    size_t getLimit() const;
+
+    /**
+     * @brief Gets memory reserved by activated lazily loaded model versions
+     */
+    size_t getUsed() const;
+
+    /**
+     * @brief Reserves memory for model version about to be activated, deactivating least recently used idle versions
+     * until it fits the limit. Reservation is made even if it does not fit since there is nothing idle left to deactivate.
+     * Reserving again for the same instance does nothing.
+     *
+     * @param instance has to be owned by shared_ptr to be deactivated by activation of other versions
+     * @param bytes estimated memory usage of activated instance
+     */
+    void reserve(ModelInstance& instance, size_t bytes);
+
+    /**
+     * @brief Releases reservation of deactivated or unloaded model version, does nothing if there is none
+     */
+    void release(const ModelInstance& instance);
+
+private:
+    LazyModelsBudget() = default;
+
+    struct Reservation {
+        std::weak_ptr<ModelInstance> instance;
+        size_t bytes;
+    };
+
+    mutable std::mutex mutex;
+    size_t limit = 0;
+    size_t used = 0;
+    std::map<const ModelInstance*, Reservation> reservations;
+};
+
+}  // namespace ovms
@@ -0,0 +1,728 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "loadgenerator.hpp"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <grpcpp/grpcpp.h>
+
+#include "rest_utils.hpp"
+#include "threadsafequeue.hpp"
+#include "trafficcapture.hpp"
+
+namespace ovms {
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+uint64_t microsecondsBetween(Clock::time_point from, Clock::time_point to) {
+    if (to <= from) {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+std::string formatMilliseconds(uint64_t microseconds) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", microseconds / 1000.0);
+    return buffer;
+}
+
+std::string formatLatency(const LatencyHistogram& histogram) {
+    std::stringstream ss;
+    ss << "p50: " << formatMilliseconds(histogram.getPercentile(50))
+       << " p90: " << formatMilliseconds(histogram.getPercentile(90))
+       << " p99: " << formatMilliseconds(histogram.getPercentile(99))
+       << " p99.9: " << formatMilliseconds(histogram.getPercentile(99.9))
+       << " max: " << formatMilliseconds(histogram.getMax())
+       << " mean: " << formatMilliseconds(static_cast<uint64_t>(histogram.getMean()));
+    return ss.str();
+}
+
+/**
+ * @brief Window of intended send times which are measured
+ */
+struct LoadWindow {
+    Clock::time_point start;
+    Clock::time_point measureStart;
+    Clock::time_point end;
+
+    explicit LoadWindow(const LoadGeneratorOptions& options) :
+        start(Clock::now()),
+        measureStart(start + options.warmup),
+        end(measureStart + options.duration) {}
+
+    bool isMeasured(Clock::time_point intended) const {
+        return intended >= measureStart && intended < end;
+    }
+};
+
+/**
+ * @brief Prints progress of the load every report interval until destroyed
+ */
+class ProgressReporter {
+public:
+    ProgressReporter(const LoadGeneratorOptions& options, const LoadStatistics& statistics) {
+        if (options.reportInterval.count() <= 0) {
+            return;
+        }
+        thread = std::thread([this, interval = options.reportInterval, &statistics]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopRequested) {
+                if (condition.wait_for(lock, interval, [this]() { return stopRequested; })) {
+                    break;
+                }
+                std::cout << "[--] succeeded: " << statistics.getSucceeded() << " failed: " << statistics.getFailed()
+                          << " latency ms " << formatLatency(statistics.getLatency()) << std::endl;
+            }
+        });
+    }
+
+    ~ProgressReporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopRequested = true;
+        }
+        condition.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopRequested = false;
+    std::thread thread;
+};
+
+struct GrpcCall {
+    grpc::ClientContext context;
+    tensorflow::serving::PredictResponse response;
+    grpc::Status status;
+    std::unique_ptr<grpc::ClientAsyncResponseReader<tensorflow::serving::PredictResponse>> reader;
+    Clock::time_point intended;
+    Clock::time_point sent;
+    size_t stream;
+};
+
+/**
+ * @brief Calls spread over channels, each with its own completion queue and polling thread
+ */
+class GrpcLoad {
+public:
+    GrpcLoad(const LoadGeneratorOptions& options, const std::vector<tensorflow::serving::PredictRequest>& payloads, LoadStatistics& statistics) :
+        options(options),
+        payloads(payloads),
+        statistics(statistics),
+        window(options),
+        closedLoop(options.rate <= 0 && options.replayArrivals.empty()),
+        limit(options.concurrency > 0 ? options.concurrency : (closedLoop ? options.streams : std::numeric_limits<size_t>::max())) {
+        const std::string target = options.address + ":" + std::to_string(options.port);
+        for (size_t i = 0; i < options.streams; i++) {
+            // separate channel arguments keep channels from sharing one connection
+            grpc::ChannelArguments arguments;
+            arguments.SetInt("ovms_load_generator_stream", i);
+            arguments.SetMaxReceiveMessageSize(std::numeric_limits<int>::max());
+            stubs.push_back(tensorflow::serving::PredictionService::NewStub(
+                grpc::CreateCustomChannel(target, grpc::InsecureChannelCredentials(), arguments)));
+            queues.push_back(std::make_unique<grpc::CompletionQueue>());
+        }
+    }
+
+    void run() {
+        for (size_t i = 0; i < options.streams; i++) {
+            pollers.emplace_back([this, i]() { poll(i); });
+        }
+        if (closedLoop) {
+            for (size_t i = 0; i < limit; i++) {
+                submit(Clock::now());
+            }
+            std::this_thread::sleep_until(window.end);
+        } else if (!options.replayArrivals.empty()) {
+            for (auto arrival : options.replayArrivals) {
+                const auto intended = window.start + arrival;
+                if (intended >= window.end) {
+                    break;
+                }
+                std::this_thread::sleep_until(intended);
+                submit(intended);
+            }
+        } else {
+            ArrivalSchedule schedule(options.rate, options.distribution, window.start, options.seed);
+            for (auto intended = schedule.next(); intended < window.end; intended = schedule.next()) {
+                std::this_thread::sleep_until(intended);
+                submit(intended);
+            }
+        }
+        finish();
+    }
+
+private:
+    void submit(Clock::time_point intended) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (inFlight >= limit) {
+                backlog.push_back(intended);
+                return;
+            }
+            inFlight++;
+        }
+        start(intended, nextStream++ % options.streams);
+    }
+
+    void start(Clock::time_point intended, size_t stream) {
+        auto call = new GrpcCall();
+        call->intended = intended;
+        call->stream = stream;
+        if (options.timeout.count() > 0) {
+            call->context.set_deadline(std::chrono::system_clock::now() + options.timeout);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            live.insert(call);
+        }
+        const auto& payload = payloads[nextPayload++ % payloads.size()];
+        call->sent = Clock::now();
+        call->reader = stubs[stream]->PrepareAsyncPredict(&call->context, payload, queues[stream].get());
+        call->reader->StartCall();
+        call->reader->Finish(&call->response, &call->status, call);
+    }
+
+    void poll(size_t stream) {
+        void* tag;
+        bool ok;
+        while (queues[stream]->Next(&tag, &ok)) {
+            std::unique_ptr<GrpcCall> call(static_cast<GrpcCall*>(tag));
+            const auto now = Clock::now();
+            if (window.isMeasured(call->intended)) {
+                if (call->status.ok()) {
+                    statistics.recordSuccess(microsecondsBetween(call->intended, now), microsecondsBetween(call->sent, now));
+                } else {
+                    statistics.recordError("gRPC " + std::to_string(call->status.error_code()) + ": " + call->status.error_message());
+                }
+            }
+            std::optional<Clock::time_point> next;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                live.erase(call.get());
+                if (closedLoop && !stopping && now < window.end) {
+                    next = now;
+                } else if (!backlog.empty() && !stopping) {
+                    next = backlog.front();
+                    backlog.pop_front();
+                } else {
+                    inFlight--;
+                }
+            }
+            if (next) {
+                start(*next, stream);
+            } else {
+                drained.notify_all();
+            }
+        }
+    }
+
+    void finish() {
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+        // arrivals which never got a free slot are failures of the measured load
+        for (auto intended : backlog) {
+            if (window.isMeasured(intended)) {
+                statistics.recordError("not sent before the end, concurrency limit reached");
+            }
+        }
+        backlog.clear();
+        const auto drainTimeout = std::max<std::chrono::milliseconds>(options.timeout, std::chrono::seconds(10));
+        if (!drained.wait_for(lock, drainTimeout, [this]() { return inFlight == 0; })) {
+            for (auto call : live) {
+                call->context.TryCancel();
+            }
+            drained.wait(lock, [this]() { return inFlight == 0; });
+        }
+        lock.unlock();
+        for (auto& queue : queues) {
+            queue->Shutdown();
+        }
+        for (auto& poller : pollers) {
+            poller.join();
+        }
+    }
+
+    const LoadGeneratorOptions& options;
+    const std::vector<tensorflow::serving::PredictRequest>& payloads;
+    LoadStatistics& statistics;
+    const LoadWindow window;
+    const bool closedLoop;
+    const size_t limit;
+
+    std::vector<std::unique_ptr<tensorflow::serving::PredictionService::Stub>> stubs;
+    std::vector<std::unique_ptr<grpc::CompletionQueue>> queues;
+    std::vector<std::thread> pollers;
+    std::atomic<size_t> nextPayload{0};
+    std::atomic<size_t> nextStream{0};
+
+    std::mutex mutex;
+    std::condition_variable drained;
+    size_t inFlight = 0;
+    bool stopping = false;
+    std::deque<Clock::time_point> backlog;
+    std::set<GrpcCall*> live;
+};
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    auto first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return "";
+    }
+    return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+}
+
+}  // namespace
+
+ArrivalSchedule::ArrivalSchedule(double rate, Distribution distribution, Clock::time_point start, uint64_t seed) :
+    distribution(distribution),
+    start(start),
+    intervalSeconds(1.0 / rate),
+    generator(seed),
+    exponential(rate) {}
+
+Clock::time_point ArrivalSchedule::next() {
+    auto intended = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(elapsedSeconds));
+    elapsedSeconds += distribution == Distribution::CONSTANT ? intervalSeconds : exponential(generator);
+    return intended;
+}
+
+void LoadStatistics::recordSuccess(uint64_t latencyMicroseconds, uint64_t serviceMicroseconds) {
+    latency.record(latencyMicroseconds);
+    serviceTime.record(serviceMicroseconds);
+    succeeded.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadStatistics::recordError(const std::string& reason) {
+    failed.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(errorsMutex);
+    errors[reason]++;
+}
+
+std::map<std::string, uint64_t> LoadStatistics::getErrors() const {
+    std::lock_guard<std::mutex> lock(errorsMutex);
+    return errors;
+}
+
+std::string LoadStatistics::report(double seconds, double offeredRate) const {
+    const uint64_t total = getSucceeded() + getFailed();
+    std::stringstream ss;
+    ss << "Requests: " << total << " succeeded: " << getSucceeded() << " failed: " << getFailed();
+    if (total > 0) {
+        char errorRate[32];
+        std::snprintf(errorRate, sizeof(errorRate), "%.3f", 100.0 * getFailed() / total);
+        ss << " error rate: " << errorRate << "%";
+    }
+    ss << std::endl;
+    char throughput[64];
+    std::snprintf(throughput, sizeof(throughput), "%.2f", seconds > 0 ? getSucceeded() / seconds : 0.0);
+    ss << "Throughput: " << throughput << " requests/s";
+    if (offeredRate > 0) {
+        std::snprintf(throughput, sizeof(throughput), "%.2f", offeredRate);
+        ss << " offered: " << throughput << " requests/s";
+    }
+    ss << std::endl;
+    ss << "Latency ms " << formatLatency(latency) << std::endl;
+    ss << "Service time ms " << formatLatency(serviceTime) << std::endl;
+    for (const auto& [reason, count] : getErrors()) {
+        ss << "Error: " << reason << " count: " << count << std::endl;
+    }
+    return ss.str();
+}
+
+HttpConnection::HttpConnection(const std::string& host, uint16_t port, std::chrono::milliseconds timeout) :
+    host(host),
+    port(port),
+    timeout(timeout) {}
+
+HttpConnection::~HttpConnection() {
+    disconnect();
+}
+
+bool HttpConnection::connect(std::string& error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int result = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+    if (result != 0) {
+        error = std::string("cannot resolve address: ") + gai_strerror(result);
+        return false;
+    }
+    for (auto address = addresses; address != nullptr; address = address->ai_next) {
+        socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket < 0) {
+            continue;
+        }
+        if (::connect(socket, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        ::close(socket);
+        socket = -1;
+    }
+    freeaddrinfo(addresses);
+    if (socket < 0) {
+        error = "cannot connect";
+        return false;
+    }
+    int noDelay = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    if (timeout.count() > 0) {
+        timeval value{};
+        value.tv_sec = timeout.count() / 1000;
+        value.tv_usec = (timeout.count() % 1000) * 1000;
+        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+        setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value));
+    }
+    buffer.clear();
+    return true;
+}
+
+void HttpConnection::disconnect() {
+    if (socket >= 0) {
+        ::close(socket);
+        socket = -1;
+    }
+    buffer.clear();
+}
+
+bool HttpConnection::readMore(std::string& error) {
+    char chunk[64 * 1024];
+    auto received = ::recv(socket, chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+        error = received == 0 ? "connection closed by server" : std::string("receive failed: ") + std::strerror(errno);
+        return false;
+    }
+    buffer.append(chunk, received);
+    return true;
+}
+
+bool HttpConnection::readLine(std::string& line, std::string& error) {
+    size_t end;
+    while ((end = buffer.find("\r\n")) == std::string::npos) {
+        if (!readMore(error)) {
+            return false;
+        }
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 2);
+    return true;
+}
+
+bool HttpConnection::readBytes(size_t count, std::string& error) {
+    while (buffer.size() < count) {
+        if (!readMore(error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HttpConnection::parseResponseHead(const std::string& head, ResponseHead& parsed) {
+    std::stringstream lines(head);
+    std::string line;
+    if (!std::getline(lines, line)) {
+        return false;
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    auto firstSpace = line.find(' ');
+    if (line.compare(0, 5, "HTTP/") != 0 || firstSpace == std::string::npos) {
+        return false;
+    }
+    try {
+        parsed.status = std::stoi(line.substr(firstSpace + 1, 3));
+    } catch (const std::exception&) {
+        return false;
+    }
+    parsed.close = line.compare(0, 8, "HTTP/1.0") == 0;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        auto colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        const std::string name = toLower(trim(line.substr(0, colon)));
+        const std::string value = toLower(trim(line.substr(colon + 1)));
+        if (name == "content-length") {
+            try {
+                parsed.contentLength = std::stoull(value);
+            } catch (const std::exception&) {
+                return false;
+            }
+        } else if (name == "transfer-encoding") {
+            parsed.chunked = value.find("chunked") != std::string::npos;
+        } else if (name == "connection") {
+            parsed.close = value == "close";
+        }
+    }
+    return true;
+}
+
+bool HttpConnection::send(const std::string& request, int& httpStatus, std::string& error) {
+    // a kept alive connection may have been closed by the server meanwhile, such a request is retried once
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const bool reused = socket >= 0;
+        if (!reused && !connect(error)) {
+            return false;
+        }
+        size_t sentBytes = 0;
+        while (sentBytes < request.size()) {
+            auto sent = ::send(socket, request.data() + sentBytes, request.size() - sentBytes, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                break;
+            }
+            sentBytes += sent;
+        }
+        std::string head;
+        std::string line;
+        bool received = sentBytes == request.size();
+        while (received && (received = readLine(line, error)) && !line.empty()) {
+            head += line + "\r\n";
+        }
+        if (!received) {
+            disconnect();
+            if (reused && head.empty()) {
+                continue;
+            }
+            if (error.empty()) {
+                error = std::string("send failed: ") + std::strerror(errno);
+            }
+            return false;
+        }
+        ResponseHead parsed;
+        if (!parseResponseHead(head, parsed)) {
+            error = "invalid response";
+            disconnect();
+            return false;
+        }
+        httpStatus = parsed.status;
+        if (parsed.chunked) {
+            for (;;) {
+                if (!readLine(line, error)) {
+                    disconnect();
+                    return false;
+                }
+                size_t chunkSize = std::strtoull(line.c_str(), nullptr, 16);
+                if (chunkSize == 0) {
+                    // trailers end with an empty line
+                    while (readLine(line, error) && !line.empty()) {
+                    }
+                    break;
+                }
+                if (!readBytes(chunkSize + 2, error)) {
+                    disconnect();
+                    return false;
+                }
+                buffer.erase(0, chunkSize + 2);
+            }
+        } else if (parsed.contentLength) {
+            if (!readBytes(*parsed.contentLength, error)) {
+                disconnect();
+                return false;
+            }
+            buffer.erase(0, *parsed.contentLength);
+        } else {
+            // body ends with the connection
+            std::string ignored;
+            while (readMore(ignored)) {
+                buffer.clear();
+            }
+            parsed.close = true;
+        }
+        if (parsed.close) {
+            disconnect();
+        }
+        return true;
+    }
+    return false;
+}
+
+Status makeHttpPredictRequest(const LoadGeneratorOptions& options, const tensorflow::serving::PredictRequest& request, std::string& httpRequest) {
+    // REST request body has the layout of a response, with instances instead of predictions and inputs instead of outputs
+    tensorflow::serving::PredictResponse tensors;
+    *tensors.mutable_outputs() = request.inputs();
+    std::string body;
+    auto status = makeJsonFromPredictResponse(tensors, &body, options.restOrder);
+    if (!status.ok()) {
+        return status;
+    }
+    const std::string from = options.restOrder == Order::ROW ? "\"predictions\"" : "\"outputs\"";
+    const std::string to = options.restOrder == Order::ROW ? "\"instances\"" : "\"inputs\"";
+    body.replace(body.find(from), from.size(), to);
+
+    const bool hasModelSpec = !request.model_spec().name().empty();
+    const int64_t version = hasModelSpec ? request.model_spec().version().value() : options.modelVersion;
+    std::string path = "/v1/models/" + (hasModelSpec ? request.model_spec().name() : options.modelName);
+    if (version > 0) {
+        path += "/versions/" + std::to_string(version);
+    }
+    path += ":predict";
+    httpRequest = "POST " + path + " HTTP/1.1\r\n" +
+                  "Host: " + options.address + ":" + std::to_string(options.port) + "\r\n" +
+                  "Content-Type: application/json\r\n" +
+                  "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" +
+                  body;
+    return StatusCode::OK;
+}
+
+Status runGrpcLoad(const LoadGeneratorOptions& options, const std::vector<tensorflow::serving::PredictRequest>& payloads, LoadStatistics& statistics) {
+    if (payloads.empty() || options.streams == 0) {
+        return Status(StatusCode::INTERNAL_ERROR, "load needs at least one payload and stream");
+    }
+    GrpcLoad load(options, payloads, statistics);
+    ProgressReporter reporter(options, statistics);
+    load.run();
+    return StatusCode::OK;
+}
+
+Status runRestLoad(const LoadGeneratorOptions& options, const std::vector<std::string>& payloads, LoadStatistics& statistics) {
+    if (payloads.empty() || options.streams == 0) {
+        return Status(StatusCode::INTERNAL_ERROR, "load needs at least one payload and stream");
+    }
+    const LoadWindow window(options);
+    const bool closedLoop = options.rate <= 0 && options.replayArrivals.empty();
+    ThreadSafeQueue<Clock::time_point> arrivals;
+    std::atomic<bool> arrivalsFinished{false};
+    std::atomic<size_t> nextPayload{0};
+    ProgressReporter reporter(options, statistics);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < options.streams; i++) {
+        workers.emplace_back([&]() {
+            HttpConnection connection(options.address, options.port, options.timeout);
+            for (;;) {
+                Clock::time_point intended;
+                if (closedLoop) {
+                    intended = Clock::now();
+                    if (intended >= window.end) {
+                        break;
+                    }
+                } else {
+                    auto arrival = arrivals.tryPull(100'000);
+                    if (!arrival) {
+                        if (arrivalsFinished) {
+                            break;
+                        }
+                        continue;
+                    }
+                    intended = *arrival;
+                }
+                const auto sent = Clock::now();
+                int httpStatus = 0;
+                std::string error;
+                const bool received = connection.send(payloads[nextPayload++ % payloads.size()], httpStatus, error);
+                const auto now = Clock::now();
+                if (!window.isMeasured(intended)) {
+                    continue;
+                }
+                if (!received) {
+                    statistics.recordError(error);
+                } else if (httpStatus != 200) {
+                    statistics.recordError("HTTP " + std::to_string(httpStatus));
+                } else {
+                    statistics.recordSuccess(microsecondsBetween(intended, now), microsecondsBetween(sent, now));
+                }
+            }
+        });
+    }
+    if (!options.replayArrivals.empty()) {
+        for (auto arrival : options.replayArrivals) {
+            const auto intended = window.start + arrival;
+            if (intended >= window.end) {
+                break;
+            }
+            std::this_thread::sleep_until(intended);
+            arrivals.push(intended);
+        }
+        arrivalsFinished = true;
+    } else if (!closedLoop) {
+        ArrivalSchedule schedule(options.rate, options.distribution, window.start, options.seed);
+        for (auto intended = schedule.next(); intended < window.end; intended = schedule.next()) {
+            std::this_thread::sleep_until(intended);
+            arrivals.push(intended);
+        }
+        arrivalsFinished = true;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return StatusCode::OK;
+}
+
+Status prepareReplay(const std::string& path, double speed, LoadGeneratorOptions& options, std::vector<tensorflow::serving::PredictRequest>& payloads) {
+    TrafficLogReader reader;
+    auto status = reader.open(path);
+    if (!status.ok()) {
+        return status;
+    }
+    CapturedRequest record;
+    std::optional<std::chrono::microseconds> first;
+    std::chrono::microseconds previous{0};
+    while (reader.next(record, status)) {
+        if (!first) {
+            first = record.arrival;
+        }
+        // records are written in capture order, which may differ slightly from arrival order of concurrent requests
+        const auto arrival = std::max(std::chrono::microseconds(static_cast<int64_t>((record.arrival - *first).count() / speed)), previous);
+        options.replayArrivals.push_back(arrival);
+        previous = arrival;
+        payloads.push_back(std::move(record.request));
+    }
+    if (!status.ok()) {
+        return status;
+    }
+    if (payloads.empty()) {
+        return Status(StatusCode::FILE_INVALID, "traffic log has no requests: " + path);
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
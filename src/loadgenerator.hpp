@@ -0,0 +1,208 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "latencyhistogram.hpp"
+#include "rest_parser.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Intended send times of open-loop load, independent of how fast the server responds
+ */
+class ArrivalSchedule {
+public:
+    enum class Distribution {
+        CONSTANT,
+        POISSON
+    };
+
+    /**
+     * @param rate requests per second, has to be positive
+     * @param distribution CONSTANT sends in equal intervals, POISSON in exponentially distributed ones
+     * @param start intended time of the first request
+     * @param seed of the exponential distribution
+     */
+    ArrivalSchedule(double rate, Distribution distribution, std::chrono::steady_clock::time_point start, uint64_t seed = 0);
+
+    /**
+     * @brief Gives intended time of the next request
+     */
+    std::chrono::steady_clock::time_point next();
+
+private:
+    const Distribution distribution;
+    const std::chrono::steady_clock::time_point start;
+    const double intervalSeconds;
+    double elapsedSeconds = 0;
+    std::mt19937_64 generator;
+    std::exponential_distribution<double> exponential;
+};
+
+/**
+ * @brief Results of the measured part of the load, safe to record from many threads
+ *
+ * Latency is counted from the intended send time, so that time spent waiting for a free stream on the
+ * client side is not omitted when the server cannot keep up. Service time is counted from the actual send.
+ */
+class LoadStatistics {
+public:
+    void recordSuccess(uint64_t latencyMicroseconds, uint64_t serviceMicroseconds);
+
+    void recordError(const std::string& reason);
+
+    uint64_t getSucceeded() const { return succeeded.load(std::memory_order_relaxed); }
+    uint64_t getFailed() const { return failed.load(std::memory_order_relaxed); }
+    const LatencyHistogram& getLatency() const { return latency; }
+    const LatencyHistogram& getServiceTime() const { return serviceTime; }
+    std::map<std::string, uint64_t> getErrors() const;
+
+    /**
+     * @brief Human readable summary
+     *
+     * @param seconds duration of the measured part of the load
+     * @param offeredRate requests per second intended to be sent, 0 for closed loop
+     */
+    std::string report(double seconds, double offeredRate) const;
+
+private:
+    LatencyHistogram latency;
+    LatencyHistogram serviceTime;
+    std::atomic<uint64_t> succeeded{0};
+    std::atomic<uint64_t> failed{0};
+    mutable std::mutex errorsMutex;
+    std::map<std::string, uint64_t> errors;
+};
+
+struct LoadGeneratorOptions {
+    std::string address = "localhost";
+    uint16_t port = 9178;
+    std::string modelName;
+    int64_t modelVersion = 0;
+    // requests per second, 0 sends next request as soon as previous one on the stream finished
+    double rate = 0;
+    ArrivalSchedule::Distribution distribution = ArrivalSchedule::Distribution::POISSON;
+    // gRPC channels or REST connections
+    uint32_t streams = 1;
+    // maximum requests in flight over all gRPC channels, 0 means not limited in open loop and one per channel in closed loop
+    uint32_t concurrency = 0;
+    std::chrono::milliseconds duration{std::chrono::seconds(60)};
+    std::chrono::milliseconds warmup{std::chrono::seconds(5)};
+    // 0 means no deadline
+    std::chrono::milliseconds timeout{0};
+    std::chrono::milliseconds reportInterval{std::chrono::seconds(10)};
+    Order restOrder = Order::ROW;
+    uint64_t seed = 0;
+    // intended send times since the start of the load, one per payload in their order, replace rate when not empty
+    std::vector<std::chrono::microseconds> replayArrivals;
+};
+
+/**
+ * @brief Minimal HTTP/1.1 client sending prepared requests over one keep-alive connection
+ */
+class HttpConnection {
+public:
+    /**
+     * @param timeout of sending and receiving on the socket, 0 means no timeout
+     */
+    HttpConnection(const std::string& host, uint16_t port, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+    ~HttpConnection();
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    /**
+     * @brief Sends the request and reads the whole response, reconnecting first when needed
+     *
+     * @param request complete request with headers
+     * @param httpStatus status code of response
+     * @param error filled when no response was received
+     *
+     * @return true when response was received
+     */
+    bool send(const std::string& request, int& httpStatus, std::string& error);
+
+    struct ResponseHead {
+        int status = 0;
+        std::optional<size_t> contentLength;
+        bool chunked = false;
+        bool close = false;
+    };
+
+    /**
+     * @brief Parses status line and headers, without the terminating empty line
+     */
+    static bool parseResponseHead(const std::string& head, ResponseHead& parsed);
+
+private:
+    bool connect(std::string& error);
+    void disconnect();
+    bool readMore(std::string& error);
+    bool readLine(std::string& line, std::string& error);
+    bool readBytes(size_t count, std::string& error);
+
+    const std::string host;
+    const uint16_t port;
+    const std::chrono::milliseconds timeout;
+    int socket = -1;
+    std::string buffer;
+};
+
+/**
+ * @brief Builds complete HTTP predict request with JSON body in options.restOrder, sent to model_spec of the request
+ * or to options.modelName when it is not set
+ */
+Status makeHttpPredictRequest(const LoadGeneratorOptions& options, const tensorflow::serving::PredictRequest& request, std::string& httpRequest);
+
+/**
+ * @brief Sends predict requests over gRPC asynchronous API, arrivals are not delayed by pending responses
+ *
+ * @param payloads sent in turns
+ * @param statistics filled with results of requests intended to be sent after warmup
+ */
+Status runGrpcLoad(const LoadGeneratorOptions& options, const std::vector<tensorflow::serving::PredictRequest>& payloads, LoadStatistics& statistics);
+
+/**
+ * @brief Sends predict requests over REST API, each stream is one connection with one request in flight
+ *
+ * @param payloads complete HTTP requests sent in turns
+ * @param statistics filled with results of requests intended to be sent after warmup
+ */
+Status runRestLoad(const LoadGeneratorOptions& options, const std::vector<std::string>& payloads, LoadStatistics& statistics);
+
+/**
+ * @brief Reads requests captured by TrafficCapture as payloads and their arrivals into options.replayArrivals,
+ * arrivals are scaled by speed and counted from the first one
+ */
+Status prepareReplay(const std::string& path, double speed, LoadGeneratorOptions& options, std::vector<tensorflow::serving::PredictRequest>& payloads);
+
+}  // namespace ovms
@@ -0,0 +1,234 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+// Open-loop load generator for gRPC and REST predict API:
+// bazel run -c opt //src:ovms_load_generator -- --model_name resnet --npy data=imgs.npy --rate 500
+// Replay of traffic captured with --traffic_capture_path, at twice the original speed:
+// bazel run -c opt //src:ovms_load_generator -- --replay /tmp/traffic.bin --replay_speed 2
+#include <sysexits.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include "loadgenerator.hpp"
+#include "npyfile.hpp"
+
+using namespace ovms;
+
+namespace {
+// payloads are copies of npy data split into batches, their number is limited to bound memory
+const size_t MAX_PAYLOADS = 1024;
+
+Status preparePayloads(const cxxopts::ParseResult& result, const LoadGeneratorOptions& options, std::vector<tensorflow::serving::PredictRequest>& payloads) {
+    std::map<std::string, tensorflow::TensorProto> inputs;
+    for (const auto& entry : result["npy"].as<std::vector<std::string>>()) {
+        auto separator = entry.find('=');
+        if (separator == std::string::npos || separator == 0) {
+            return Status(StatusCode::INTERNAL_ERROR, "npy has to be given as input_name=path: " + entry);
+        }
+        auto status = loadNpyFile(entry.substr(separator + 1), inputs[entry.substr(0, separator)]);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    const size_t batchSize = result["batch_size"].as<uint32_t>();
+    size_t payloadsCount = 1;
+    if (batchSize > 0) {
+        size_t entries = std::numeric_limits<size_t>::max();
+        for (const auto& [name, input] : inputs) {
+            if (input.tensor_shape().dim_size() < 1 || input.tensor_shape().dim(0).size() <= 0) {
+                return Status(StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS, "npy of input: " + name + " has no entries to make batches of");
+            }
+            entries = std::min<size_t>(entries, input.tensor_shape().dim(0).size());
+        }
+        payloadsCount = std::min(std::max<size_t>(entries / batchSize, 1), MAX_PAYLOADS);
+    }
+    for (size_t i = 0; i < payloadsCount; i++) {
+        tensorflow::serving::PredictRequest request;
+        request.mutable_model_spec()->set_name(options.modelName);
+        if (options.modelVersion > 0) {
+            request.mutable_model_spec()->mutable_version()->set_value(options.modelVersion);
+        }
+        for (const auto& [name, input] : inputs) {
+            auto& proto = (*request.mutable_inputs())[name];
+            if (batchSize == 0) {
+                proto = input;
+                continue;
+            }
+            auto status = sliceBatch(input, i * batchSize, batchSize, proto);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+        payloads.push_back(std::move(request));
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    cxxopts::Options options(argv[0], "OpenVINO Model Server load generator");
+    // clang-format off
+    options.add_options()
+        ("h, help",
+            "show this help message and exit")
+        ("api",
+            "grpc or rest",
+            cxxopts::value<std::string>()->default_value("grpc"), "API")
+        ("address",
+            "server address",
+            cxxopts::value<std::string>()->default_value("localhost"), "ADDRESS")
+        ("port",
+            "gRPC or REST port of the server",
+            cxxopts::value<uint16_t>()->default_value("9178"), "PORT")
+        ("model_name",
+            "name of the model or pipeline",
+            cxxopts::value<std::string>(), "MODEL_NAME")
+        ("model_version",
+            "model version, 0 means the default one",
+            cxxopts::value<int64_t>()->default_value("0"), "MODEL_VERSION")
+        ("npy",
+            "comma separated input_name=path pairs of .npy files with input data",
+            cxxopts::value<std::vector<std::string>>(), "NPY")
+        ("batch_size",
+            "number of npy entries along 0th dimension sent in one request, consecutive requests send consecutive entries. 0 sends whole npy content",
+            cxxopts::value<uint32_t>()->default_value("1"), "BATCH_SIZE")
+        ("rate",
+            "requests per second sent regardless of responses. 0 means closed loop: next request of a stream is sent when the previous one finished",
+            cxxopts::value<double>()->default_value("0"), "RATE")
+        ("arrival",
+            "distribution of intervals between requests: poisson or constant",
+            cxxopts::value<std::string>()->default_value("poisson"), "ARRIVAL")
+        ("streams",
+            "number of gRPC channels or REST connections",
+            cxxopts::value<uint32_t>()->default_value("1"), "STREAMS")
+        ("concurrency",
+            "maximum gRPC requests in flight, 0 means not limited with rate and one per stream in closed loop. REST sends one request per connection",
+            cxxopts::value<uint32_t>()->default_value("0"), "CONCURRENCY")
+        ("duration_seconds",
+            "how long the load is measured",
+            cxxopts::value<uint32_t>()->default_value("60"), "DURATION_SECONDS")
+        ("warmup_seconds",
+            "how long the load is sent before the measurement",
+            cxxopts::value<uint32_t>()->default_value("5"), "WARMUP_SECONDS")
+        ("timeout_ms",
+            "deadline of a single request, 0 means none",
+            cxxopts::value<uint32_t>()->default_value("0"), "TIMEOUT_MS")
+        ("report_every_seconds",
+            "interval of progress reports, 0 disables them",
+            cxxopts::value<uint32_t>()->default_value("10"), "REPORT_EVERY_SECONDS")
+        ("rest_order",
+            "format of REST request body: row or column",
+            cxxopts::value<std::string>()->default_value("row"), "REST_ORDER")
+        ("seed",
+            "seed of poisson arrivals",
+            cxxopts::value<uint64_t>()->default_value("0"), "SEED")
+        ("replay",
+            "traffic log written by the server with traffic_capture_path. Captured requests are sent to their models and pipelines at their arrival times instead of npy data and rate",
+            cxxopts::value<std::string>(), "REPLAY")
+        ("replay_speed",
+            "speed of the replay, 2 sends requests twice as fast as they arrived. Duration defaults to the whole log and warmup to 0",
+            cxxopts::value<double>()->default_value("1"), "REPLAY_SPEED");
+    // clang-format on
+
+    std::unique_ptr<cxxopts::ParseResult> result;
+    try {
+        result = std::make_unique<cxxopts::ParseResult>(options.parse(argc, argv));
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "error parsing options: " << e.what() << std::endl;
+        return EX_USAGE;
+    }
+    if (result->count("help")) {
+        std::cout << options.help() << std::endl;
+        return EX_OK;
+    }
+    const std::string api = (*result)["api"].as<std::string>();
+    const std::string arrival = (*result)["arrival"].as<std::string>();
+    const std::string restOrder = (*result)["rest_order"].as<std::string>();
+    const bool replay = result->count("replay") > 0;
+    if ((!replay && (!result->count("model_name") || !result->count("npy"))) || (*result)["replay_speed"].as<double>() <= 0 || (api != "grpc" && api != "rest") ||
+        (arrival != "poisson" && arrival != "constant") || (restOrder != "row" && restOrder != "column") ||
+        (*result)["rate"].as<double>() < 0 || (*result)["streams"].as<uint32_t>() == 0) {
+        std::cerr << options.help() << std::endl;
+        return EX_USAGE;
+    }
+
+    LoadGeneratorOptions loadOptions;
+    loadOptions.address = (*result)["address"].as<std::string>();
+    loadOptions.port = (*result)["port"].as<uint16_t>();
+    if (result->count("model_name")) {
+        loadOptions.modelName = (*result)["model_name"].as<std::string>();
+    }
+    loadOptions.modelVersion = (*result)["model_version"].as<int64_t>();
+    loadOptions.rate = (*result)["rate"].as<double>();
+    loadOptions.distribution = arrival == "constant" ? ArrivalSchedule::Distribution::CONSTANT : ArrivalSchedule::Distribution::POISSON;
+    loadOptions.streams = (*result)["streams"].as<uint32_t>();
+    loadOptions.concurrency = (*result)["concurrency"].as<uint32_t>();
+    loadOptions.duration = std::chrono::seconds((*result)["duration_seconds"].as<uint32_t>());
+    loadOptions.warmup = std::chrono::seconds((*result)["warmup_seconds"].as<uint32_t>());
+    loadOptions.timeout = std::chrono::milliseconds((*result)["timeout_ms"].as<uint32_t>());
+    loadOptions.reportInterval = std::chrono::seconds((*result)["report_every_seconds"].as<uint32_t>());
+    loadOptions.restOrder = restOrder == "column" ? Order::COLUMN : Order::ROW;
+    loadOptions.seed = (*result)["seed"].as<uint64_t>();
+
+    std::vector<tensorflow::serving::PredictRequest> payloads;
+    auto status = replay ? prepareReplay((*result)["replay"].as<std::string>(), (*result)["replay_speed"].as<double>(), loadOptions, payloads)
+                         : preparePayloads(*result, loadOptions, payloads);
+    if (!status.ok()) {
+        std::cerr << status.string() << std::endl;
+        return EX_DATAERR;
+    }
+    if (replay) {
+        if (!result->count("warmup_seconds")) {
+            loadOptions.warmup = std::chrono::milliseconds(0);
+        }
+        if (!result->count("duration_seconds")) {
+            // the last request is still measured
+            loadOptions.duration = std::chrono::duration_cast<std::chrono::milliseconds>(loadOptions.replayArrivals.back()) + std::chrono::milliseconds(1);
+        }
+    }
+    const size_t replayedRequests = replay ? payloads.size() : 0;
+
+    LoadStatistics statistics;
+    if (api == "grpc") {
+        status = runGrpcLoad(loadOptions, payloads, statistics);
+    } else {
+        std::vector<std::string> httpRequests(payloads.size());
+        for (size_t i = 0; i < payloads.size() && status.ok(); i++) {
+            status = makeHttpPredictRequest(loadOptions, payloads[i], httpRequests[i]);
+        }
+        payloads.clear();
+        if (status.ok()) {
+            status = runRestLoad(loadOptions, httpRequests, statistics);
+        }
+    }
+    if (!status.ok()) {
+        std::cerr << status.string() << std::endl;
+        return EX_SOFTWARE;
+    }
+    const double seconds = std::chrono::duration<double>(loadOptions.duration).count();
+    std::cout << statistics.report(seconds, replay ? replayedRequests / seconds : loadOptions.rate);
+    return EX_OK;
+}
@@ -0,0 +1,60 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "loadprofile.hpp"
+
+#include <cstdio>
+
+namespace ovms {
+
+const char* toString(LoadPhase phase) {
+    switch (phase) {
+    case LoadPhase::DOWNLOAD:
+        return "download";
+    case LoadPhase::CUSTOM_LOADER:
+        return "custom_loader";
+    case LoadPhase::READ_NETWORK:
+        return "read_network";
+    case LoadPhase::RESHAPE:
+        return "reshape";
+    case LoadPhase::AUTOTUNE:
+        return "autotune";
+    case LoadPhase::LOAD_NETWORK:
+        return "load_network";
+    case LoadPhase::INFER_REQUESTS:
+        return "infer_requests";
+    case LoadPhase::WARMUP:
+        return "warmup";
+    }
+    return "unknown";
+}
+
+std::string LoadProfile::toString() const {
+    std::string result;
+    for (size_t phase = 0; phase < LOAD_PHASES_COUNT; ++phase) {
+        if (microseconds[phase] == 0) {
+            continue;
+        }
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%s: %.1f ms", ovms::toString(static_cast<LoadPhase>(phase)), microseconds[phase] / 1000.0);
+        if (!result.empty()) {
+            result += "; ";
+        }
+        result += buffer;
+    }
+    return result;
+}
+
+}  // namespace ovms
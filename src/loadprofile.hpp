@@ -0,0 +1,68 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ovms {
+
+/**
+ * @brief Phases of loading a model version measured separately
+ */
+enum class LoadPhase {
+    DOWNLOAD,
+    CUSTOM_LOADER,
+    READ_NETWORK,
+    RESHAPE,
+    AUTOTUNE,
+    LOAD_NETWORK,
+    INFER_REQUESTS,
+    WARMUP
+};
+
+constexpr size_t LOAD_PHASES_COUNT = 8;
+
+const char* toString(LoadPhase phase);
+
+/**
+ * @brief Durations of phases of the latest load of a model version, phases skipped by the load stay at zero
+ */
+struct LoadProfile {
+    std::array<uint64_t, LOAD_PHASES_COUNT> microseconds{};
+    uint64_t totalMicroseconds = 0;
+
+    void record(LoadPhase phase, uint64_t duration) {
+        microseconds[static_cast<size_t>(phase)] += duration;
+    }
+
+    void recordSince(LoadPhase phase, std::chrono::steady_clock::time_point start) {
+        record(phase, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    uint64_t get(LoadPhase phase) const {
+        return microseconds[static_cast<size_t>(phase)];
+    }
+
+    /**
+     * @brief Lists non zero phases in milliseconds, for logging
+     */
+    std::string toString() const;
+};
+
+}  // namespace ovms
@@ -138,6 +138,30 @@ StatusCode LocalFileSystem::readTextFile(const std::string& path, std::string* c
     return StatusCode::OK;
 }
 
+StatusCode LocalFileSystem::writeFile(const std::string& path, const std::string& contents) {
+    if (isPathEscaped(path)) {
+        SPDLOG_ERROR("Path {} escape with .. is forbidden.", path);
+        return StatusCode::PATH_INVALID;
+    }
+    std::error_code ec;
+    const auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+        if (ec) {
+            SPDLOG_DEBUG("Couldn't create directory {}: {}", parent.string(), ec.message());
+            return StatusCode::FILESYSTEM_ERROR;
+        }
+    }
+    std::ofstream output(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    output.write(contents.data(), contents.size());
+    output.close();
+    if (!output) {
+        SPDLOG_DEBUG("Couldn't write file {}", path);
+        return StatusCode::FILESYSTEM_ERROR;
+    }
+    return StatusCode::OK;
+}
+
 StatusCode LocalFileSystem::downloadFileFolder(const std::string& path, const std::string& local_path) {
     // For LocalFileSystem there is no need to download
     return StatusCode::OK;
@@ -85,6 +85,15 @@ public:
      */
     StatusCode readTextFile(const std::string& path, std::string* contents) override;
 
+    /**
+     * @brief Write the content of the given file, parent directories are created
+     * 
+     * @param path 
+     * @param contents 
+     * @return StatusCode 
+     */
+    StatusCode writeFile(const std::string& path, const std::string& contents) override;
+
     /**
      * @brief Download a remote directory
      * 
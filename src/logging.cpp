@@ -40,8 +40,23 @@ void set_log_level(const std::string log_level, std::shared_ptr<spdlog::logger>
     }
 }
 
-void register_loggers(const std::string log_level, std::vector<spdlog::sink_ptr> sinks) {
+void make_async(std::shared_ptr<spdlog::logger>& logger, spdlog::async_overflow_policy policy) {
+    logger = std::make_shared<spdlog::async_logger>(logger->name(), logger->sinks().begin(), logger->sinks().end(), spdlog::thread_pool(), policy);
+}
+
+void register_loggers(const std::string log_level, std::vector<spdlog::sink_ptr> sinks, size_t queue_size, bool drop_on_overflow) {
     auto serving_logger = std::make_shared<spdlog::logger>("serving", begin(sinks), end(sinks));
+    if (queue_size > 0) {
+        // one worker keeps the order of messages and lets the sinks stay single threaded
+        spdlog::init_thread_pool(queue_size, 1);
+        auto policy = drop_on_overflow ? spdlog::async_overflow_policy::overrun_oldest : spdlog::async_overflow_policy::block;
+        make_async(serving_logger, policy);
+        make_async(gcs_logger, policy);
+        make_async(azurestorage_logger, policy);
+        make_async(s3_logger, policy);
+        make_async(modelmanager_logger, policy);
+        make_async(dag_executor_logger, policy);
+    }
     serving_logger->set_pattern(default_pattern);
     gcs_logger->set_pattern(default_pattern);
     azurestorage_logger->set_pattern(default_pattern);
@@ -64,13 +79,13 @@ void register_loggers(const std::string log_level, std::vector<spdlog::sink_ptr>
     spdlog::set_default_logger(serving_logger);
 }
 
-void configure_logger(const std::string log_level, const std::string log_path) {
+void configure_logger(const std::string log_level, const std::string log_path, size_t queue_size, bool drop_on_overflow) {
     std::vector<spdlog::sink_ptr> sinks;
     sinks.push_back(std::make_shared<spdlog::sinks::stdout_sink_st>());
     if (!log_path.empty()) {
         sinks.push_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_path));
     }
-    register_loggers(log_level, sinks);
+    register_loggers(log_level, sinks, queue_size, drop_on_overflow);
 }
 
 }  // namespace ovms
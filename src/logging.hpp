@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_sinks.h>
 #include <spdlog/spdlog.h>
@@ -30,6 +31,53 @@ extern std::shared_ptr<spdlog::logger> s3_logger;
 extern std::shared_ptr<spdlog::logger> modelmanager_logger;
 extern std::shared_ptr<spdlog::logger> dag_executor_logger;
 
-void configure_logger(const std::string log_level, const std::string log_path);
+/**
+ * @brief Debug and trace logging of request processing hot paths.
+ *
+ * With OVMS_STRIP_HOT_PATH_DEBUG_LOGS defined (bazel --define=strip_hot_path_debug_logs=true) the calls are
+ * kept only for type checking and removed by the compiler, including evaluation of their arguments.
+ * Otherwise they behave like the corresponding SPDLOG_* macros.
+ */
+#ifdef OVMS_STRIP_HOT_PATH_DEBUG_LOGS
+#define OVMS_HOT_PATH_DEBUG(...)                 \
+    do {                                         \
+        if (false) {                             \
+            spdlog::debug(__VA_ARGS__);          \
+        }                                        \
+    } while (0)
+#define OVMS_HOT_PATH_TRACE(...)                 \
+    do {                                         \
+        if (false) {                             \
+            spdlog::trace(__VA_ARGS__);          \
+        }                                        \
+    } while (0)
+#define OVMS_HOT_PATH_LOGGER_DEBUG(logger, ...)  \
+    do {                                         \
+        if (false) {                             \
+            (logger)->debug(__VA_ARGS__);        \
+        }                                        \
+    } while (0)
+#define OVMS_HOT_PATH_LOGGER_TRACE(logger, ...)  \
+    do {                                         \
+        if (false) {                             \
+            (logger)->trace(__VA_ARGS__);        \
+        }                                        \
+    } while (0)
+#else
+#define OVMS_HOT_PATH_DEBUG(...) SPDLOG_DEBUG(__VA_ARGS__)
+#define OVMS_HOT_PATH_TRACE(...) SPDLOG_TRACE(__VA_ARGS__)
+#define OVMS_HOT_PATH_LOGGER_DEBUG(logger, ...) SPDLOG_LOGGER_DEBUG(logger, __VA_ARGS__)
+#define OVMS_HOT_PATH_LOGGER_TRACE(logger, ...) SPDLOG_LOGGER_TRACE(logger, __VA_ARGS__)
+#endif
+
+/**
+ * @brief Configures sinks and levels of all the loggers
+ *
+ * @param log_level one of DEBUG, INFO, ERROR
+ * @param log_path optional log file, stdout is always used
+ * @param queue_size when not 0, messages are formatted and written by a background thread through a queue of that many messages
+ * @param drop_on_overflow when the queue is full, drop the oldest messages instead of blocking the logging thread
+ */
+void configure_logger(const std::string log_level, const std::string log_path, size_t queue_size = 0, bool drop_on_overflow = true);
 
 }  // namespace ovms
@@ -0,0 +1,164 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Thread safe cache with bounded number of entries, least recently used entry is evicted first
+ *
+ * Evicted values are destroyed after the lock is released so expensive destructors do not block other users.
+ */
+template <typename Key, typename Value>
+class LRUCache {
+public:
+    LRUCache(size_t capacity = 0) :
+        capacity(capacity) {}
+
+    /**
+     * @brief Returns cached value and marks it as most recently used. If there is none, value created by factory is inserted.
+     *
+     * Factory is called with the lock held and should be cheap.
+     *
+     * @param key
+     * @param factory
+     * @param inserted set to true if value was created by factory
+     *
+     * @return Value
+     */
+    Value getOrInsert(const Key& key, const std::function<Value()>& factory, bool& inserted) {
+        std::vector<Value> evicted;
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            inserted = false;
+            return it->second->second;
+        }
+        Value value = factory();
+        entries.emplace_front(key, value);
+        index[key] = entries.begin();
+        inserted = true;
+        evict(evicted);
+        return value;
+    }
+
+    /**
+     * @brief Gets cached value and marks it as most recently used
+     *
+     * @param key
+     * @param value set on hit
+     *
+     * @return true on hit
+     */
+    bool get(const Key& key, Value& value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return false;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        value = it->second->second;
+        return true;
+    }
+
+    /**
+     * @brief Inserts value or replaces the one already cached under the key, evicting least recently used entries above the capacity
+     *
+     * @param key
+     * @param value
+     */
+    void put(const Key& key, Value value) {
+        std::vector<Value> evicted;
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            evicted.push_back(std::move(it->second->second));
+            it->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+        entries.emplace_front(key, std::move(value));
+        index[key] = entries.begin();
+        evict(evicted);
+    }
+
+    /**
+     * @brief Removes entry only if it still holds given value
+     *
+     * @param key
+     * @param value
+     *
+     * @return true if entry was removed
+     */
+    bool remove(const Key& key, const Value& value) {
+        Value removed;
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(key);
+        if (it == index.end() || !(it->second->second == value)) {
+            return false;
+        }
+        removed = std::move(it->second->second);
+        entries.erase(it->second);
+        index.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Removes all entries and sets new capacity
+     *
+     * @param newCapacity
+     */
+    void reset(size_t newCapacity) {
+        std::list<std::pair<Key, Value>> removed;
+        std::lock_guard<std::mutex> lock(mtx);
+        removed.swap(entries);
+        index.clear();
+        capacity = newCapacity;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return entries.size();
+    }
+
+    size_t getCapacity() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return capacity;
+    }
+
+private:
+    void evict(std::vector<Value>& evicted) {
+        while (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            evicted.push_back(std::move(entries.back().second));
+            entries.pop_back();
+        }
+    }
+
+    mutable std::mutex mtx;
+    size_t capacity;
+    std::list<std::pair<Key, Value>> entries;
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator> index;
+};
+}  // namespace ovms
@@ -0,0 +1,58 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "mappedfile.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ovms {
+
+Status MappedFile::map(const std::string& path, std::shared_ptr<MappedFile>& mapped) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SPDLOG_ERROR("Cannot open file: {} for mapping; error: {}", path, std::strerror(errno));
+        return StatusCode::FILE_INVALID;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        SPDLOG_ERROR("Cannot map empty or unreadable file: {}", path);
+        close(fd);
+        return StatusCode::FILE_INVALID;
+    }
+    const size_t length = static_cast<size_t>(fileStat.st_size);
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // mapping stays valid after the descriptor is closed
+    close(fd);
+    if (address == MAP_FAILED) {
+        SPDLOG_ERROR("Cannot map file: {}; error: {}", path, std::strerror(errno));
+        return StatusCode::FILE_INVALID;
+    }
+    SPDLOG_DEBUG("Mapped file: {} of size: {}", path, length);
+    mapped.reset(new MappedFile(address, length));
+    return StatusCode::OK;
+}
+
+MappedFile::~MappedFile() {
+    munmap(address, length);
+}
+
+}  // namespace ovms
@@ -0,0 +1,67 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Read only memory mapping of a whole file, unmapped on destruction
+ *
+ * Pages are shared with the page cache, so model instances mapping the same file do not hold separate copies
+ * and reading the file consists of page faults instead of copying it into the heap.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps file into memory
+     *
+     * @param path
+     * @param mapped
+     *
+     * @return Status FILE_INVALID if file cannot be opened, is empty or cannot be mapped
+     */
+    static Status map(const std::string& path, std::shared_ptr<MappedFile>& mapped);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const {
+        return static_cast<const uint8_t*>(address);
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    MappedFile(void* address, size_t length) :
+        address(address),
+        length(length) {}
+
+    void* const address;
+    const size_t length;
+};
+
+}  // namespace ovms
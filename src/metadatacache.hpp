@@ -0,0 +1,82 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/get_model_metadata.pb.h"
+#pragma GCC diagnostic pop
+
+namespace ovms {
+
+/**
+ * @brief Metadata response of model version or pipeline definition together with its REST API representation
+ */
+struct ModelMetadata {
+    tensorflow::serving::GetModelMetadataResponse response;
+    std::string json;
+};
+
+/**
+ * @brief Holds metadata built once for model version or pipeline definition until it is invalidated by reload or change of used models
+ */
+class MetadataCache {
+public:
+    /**
+     * @brief Gets cached metadata
+     *
+     * @param generation set to value which has to be passed to put when metadata is missing
+     *
+     * @return metadata or nullptr if it was not built yet or was invalidated
+     */
+    std::shared_ptr<const ModelMetadata> get(uint64_t& generation) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        generation = this->generation;
+        return metadata;
+    }
+
+    /**
+     * @brief Stores built metadata unless cache was invalidated since generation was read
+     *
+     * @param generation
+     * @param metadata
+     */
+    void put(uint64_t generation, std::shared_ptr<const ModelMetadata> metadata) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (generation == this->generation) {
+            this->metadata = std::move(metadata);
+        }
+    }
+
+    void invalidate() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++generation;
+        metadata.reset();
+    }
+
+private:
+    mutable std::mutex mtx;
+    uint64_t generation = 0;
+    std::shared_ptr<const ModelMetadata> metadata;
+};
+
+}  // namespace ovms
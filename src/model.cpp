@@ -15,27 +15,97 @@
 //*****************************************************************************
 #include "model.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <thread>
 #include <utility>
 
+#include "config.hpp"
 #include "customloaders.hpp"
+#include "filesystemmetrics.hpp"
 #include "localfilesystem.hpp"
 #include "logging.hpp"
+#include "modelcache.hpp"
 #include "modelmanager.hpp"
 
 namespace ovms {
 
+/**
+ * @brief Links versions found in the cloud model cache into a temporary model directory and downloads only the
+ * remaining ones, which are then moved into the cache. Storages which cannot fingerprint versions are downloaded as before.
+ */
+static StatusCode downloadCachedModels(std::shared_ptr<FileSystem>& fs, const std::string& basePath, std::string* localPath, const model_versions_t& versions) {
+    auto& cache = ModelCache::instance();
+    std::map<model_version_t, std::string> keys;
+    for (const auto version : versions) {
+        std::string fingerprint;
+        if (fs->getVersionFingerprint(basePath, version, &fingerprint) != StatusCode::OK) {
+            return fs->downloadModelVersions(basePath, localPath, versions);
+        }
+        keys[version] = ModelCache::computeKey(basePath, version, fingerprint);
+    }
+
+    std::vector<model_version_t> missing;
+    for (const auto& [version, key] : keys) {
+        if (!cache.acquire(key)) {
+            missing.push_back(version);
+        }
+    }
+    SPDLOG_INFO("Found {} of {} versions of model {} in cloud model cache", versions.size() - missing.size(), versions.size(), basePath);
+    StatusCode sc = missing.empty() ? FileSystem::createTempPath(localPath) : fs->downloadModelVersions(basePath, localPath, missing);
+    if (sc != StatusCode::OK) {
+        for (const auto& [version, key] : keys) {
+            if (std::find(missing.begin(), missing.end(), version) == missing.end()) {
+                cache.release(cache.getEntryPath(key));
+            }
+        }
+        return sc;
+    }
+    for (const auto& [version, key] : keys) {
+        const std::string versionPath = *localPath + "/" + std::to_string(version);
+        // versions which cannot be stored in the cache are loaded from the download directory
+        if (std::find(missing.begin(), missing.end(), version) != missing.end() && !cache.insert(key, versionPath)) {
+            continue;
+        }
+        std::error_code error;
+        std::filesystem::create_directory_symlink(cache.getEntryPath(key), versionPath, error);
+        if (error) {
+            SPDLOG_ERROR("Cannot link cloud model cache entry {} to {}: {}", cache.getEntryPath(key), versionPath, error.message());
+            cache.release(cache.getEntryPath(key));
+            return StatusCode::PATH_INVALID;
+        }
+    }
+    return sc;
+}
+
 StatusCode downloadModels(std::shared_ptr<FileSystem>& fs, ModelConfig& config, std::shared_ptr<model_versions_t> versions) {
     if (versions->size() == 0) {
         return StatusCode::OK;
     }
 
+    if (ovms::Config::instance().cloudModelStreaming() && (std::string(fs->getBackendName()) == "s3" || std::string(fs->getBackendName()) == "gcs")) {
+        // instances read model files from the storage into memory when they load
+        config.setLocalPath(config.getBasePath());
+        config.setDownloadMicroseconds(0);
+        SPDLOG_INFO("Model files will be read from {} into memory", config.getBasePath());
+        return StatusCode::OK;
+    }
+
     std::string localPath;
     SPDLOG_INFO("Getting model from {}", config.getBasePath());
-    auto sc = fs->downloadModelVersions(config.getBasePath(), &localPath, *versions);
+    const auto downloadStart = std::chrono::steady_clock::now();
+    auto sc = ModelCache::instance().isEnabled() ? downloadCachedModels(fs, config.getBasePath(), &localPath, *versions) : fs->downloadModelVersions(config.getBasePath(), &localPath, *versions);
+    FileSystemMetrics::instance().recordDownloadSince(fs->getBackendName(), downloadStart, sc == StatusCode::OK);
+    // versions downloaded together report the time of the whole download
+    config.setDownloadMicroseconds(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - downloadStart).count());
     if (sc != StatusCode::OK) {
         SPDLOG_ERROR("Couldn't download model from {}", config.getBasePath());
         return sc;
@@ -75,13 +145,24 @@ const std::map<model_version_t, const ModelInstance&> Model::getModelVersionsMap
     return std::move(modelInstancesMapCopy);
 }
 
+std::vector<std::shared_ptr<ModelInstance>> Model::getModelInstances() const {
+    std::shared_lock lock(modelVersionsMtx);
+    std::vector<std::shared_ptr<ModelInstance>> instances;
+    instances.reserve(modelVersions.size());
+    for (const auto& [version, instance] : modelVersions) {
+        instances.push_back(instance);
+    }
+    return instances;
+}
+
 const std::map<model_version_t, std::shared_ptr<ModelInstance>>& Model::getModelVersions() const {
     return modelVersions;
 }
 
 void Model::updateDefaultVersion(int ignoredVersion) {
     model_version_t newDefaultVersion = 0;
-    SPDLOG_INFO("Updating default version for model: {}, from: {}", getName(), defaultVersion);
+    SPDLOG_INFO("Updating default version for model: {}, from: {}", getName(), defaultVersion.load());
+    std::shared_lock lock(modelVersionsMtx);
     for (const auto& [version, versionInstance] : modelVersions) {
         if (version != ignoredVersion &&
             version > newDefaultVersion &&
@@ -98,11 +179,12 @@ void Model::updateDefaultVersion(int ignoredVersion) {
 }
 
 const std::shared_ptr<ModelInstance> Model::getDefaultModelInstance() const {
-    std::shared_lock lock(modelVersionsMtx);
+    // default version is updated only after the snapshot containing it is published
     auto defaultVersion = getDefaultVersion();
-    const auto modelInstanceIt = modelVersions.find(defaultVersion);
+    auto snapshot = getModelVersionsSnapshot();
+    const auto modelInstanceIt = snapshot->find(defaultVersion);
 
-    if (modelVersions.end() == modelInstanceIt) {
+    if (snapshot->end() == modelInstanceIt) {
         SPDLOG_WARN("Default version: {} for model: {} not found", defaultVersion, getName());
         return nullptr;
     }
@@ -124,6 +206,7 @@ Status Model::addVersion(const ModelConfig& config) {
     }
     std::unique_lock lock(modelVersionsMtx);
     modelVersions[version] = std::move(modelInstance);
+    std::atomic_store(&modelVersionsSnapshot, std::make_shared<const model_versions_snapshot_t>(modelVersions));
     lock.unlock();
     updateDefaultVersion();
     subscriptionManager.notifySubscribers();
@@ -132,9 +215,8 @@ Status Model::addVersion(const ModelConfig& config) {
 
 Status Model::addVersions(std::shared_ptr<model_versions_t> versionsToStart, ovms::ModelConfig& config, std::shared_ptr<FileSystem>& fs, std::shared_ptr<model_versions_t> versionsFailed) {
     Status result = StatusCode::OK;
-    downloadModels(fs, config, versionsToStart);
     versionsFailed->clear();
-    for (const auto version : *versionsToStart) {
+    auto addDownloadedVersion = [&](const model_version_t version) {
         SPDLOG_INFO("Will add model: {}; version: {} ...", getName(), version);
         config.setVersion(version);
         config.parseModelMapping();
@@ -148,6 +230,90 @@ Status Model::addVersions(std::shared_ptr<model_versions_t> versionsToStart, ovm
             result = status;
             cleanupModelTmpFiles(config);
         }
+    };
+    if (versionsToStart->size() < 2 || std::string(fs->getBackendName()) == "local") {
+        downloadModels(fs, config, versionsToStart);
+        for (const auto version : *versionsToStart) {
+            addDownloadedVersion(version);
+        }
+        return result;
+    }
+
+    // versions are downloaded one by one ahead of the compilation of previous ones,
+    // at most PIPELINED_DOWNLOADS_AHEAD of them wait on disk for compilation
+    struct DownloadedVersion {
+        model_version_t version;
+        StatusCode status;
+        std::string localPath;
+        uint64_t downloadMicroseconds;
+    };
+    std::mutex downloadedMutex;
+    std::condition_variable downloadedCondition;
+    std::deque<DownloadedVersion> downloaded;
+    bool downloadStopped = false;
+    // compilation stage changes config of each version, downloader works on its own copy
+    const ModelConfig downloadConfig = config;
+    std::thread downloader([&]() {
+        for (const auto version : *versionsToStart) {
+            {
+                std::unique_lock<std::mutex> lock(downloadedMutex);
+                downloadedCondition.wait(lock, [&downloaded, &downloadStopped]() { return downloadStopped || downloaded.size() < PIPELINED_DOWNLOADS_AHEAD; });
+                if (downloadStopped) {
+                    return;
+                }
+            }
+            ModelConfig versionConfig = downloadConfig;
+            auto status = downloadModels(fs, versionConfig, std::make_shared<model_versions_t>(model_versions_t{version}));
+            {
+                std::lock_guard<std::mutex> lock(downloadedMutex);
+                downloaded.push_back({version, status, versionConfig.getLocalPath(), versionConfig.getDownloadMicroseconds()});
+            }
+            downloadedCondition.notify_all();
+        }
+    });
+    // compilation may throw, downloader has to be stopped and joined on every exit from this scope
+    struct DownloaderGuard {
+        std::thread& downloader;
+        std::mutex& mutex;
+        std::condition_variable& condition;
+        bool& stopped;
+        std::deque<DownloadedVersion>& downloaded;
+        const ModelConfig& config;
+        ~DownloaderGuard() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopped = true;
+            }
+            condition.notify_all();
+            if (downloader.joinable()) {
+                downloader.join();
+            }
+            // versions downloaded ahead of a compilation which threw are not loaded
+            for (const auto& version : downloaded) {
+                if (version.status == StatusCode::OK) {
+                    ModelConfig versionConfig = config;
+                    versionConfig.setVersion(version.version);
+                    versionConfig.setLocalPath(version.localPath);
+                    Model::cleanupModelTmpFiles(versionConfig);
+                }
+            }
+        }
+    } downloaderGuard{downloader, downloadedMutex, downloadedCondition, downloadStopped, downloaded, downloadConfig};
+    for (size_t i = 0; i < versionsToStart->size(); ++i) {
+        std::unique_lock<std::mutex> lock(downloadedMutex);
+        downloadedCondition.wait(lock, [&downloaded]() { return !downloaded.empty(); });
+        const auto next = std::move(downloaded.front());
+        downloaded.pop_front();
+        lock.unlock();
+        downloadedCondition.notify_all();
+        if (next.status != StatusCode::OK) {
+            versionsFailed->push_back(next.version);
+            result = next.status;
+            continue;
+        }
+        config.setLocalPath(next.localPath);
+        config.setDownloadMicroseconds(next.downloadMicroseconds);
+        addDownloadedVersion(next.version);
     }
     return result;
 }
@@ -167,6 +333,7 @@ Status Model::retireVersions(std::shared_ptr<model_versions_t> versionsToRetire)
             continue;
         }
         cleanupModelTmpFiles(modelVersion->getModelConfig());
+        // new versions are already loaded, switch requests to them first and unload once in-flight requests finish
         updateDefaultVersion(version);
         modelVersion->unloadModel();
     }
@@ -179,6 +346,7 @@ void Model::retireAllVersions() {
         auto& customloaders = ovms::CustomLoaders::instance();
         auto loaderPtr = customloaders.find(customLoaderName);
         if (loaderPtr != nullptr) {
+            auto callLock = customloaders.lockForCall(loaderPtr);
             loaderPtr->retireModel(name);
         } else {
             SPDLOG_LOGGER_ERROR(modelmanager_logger, "Could not find custom loader for model: {} but it is using custom loader: {}", getName(), customLoaderName);
@@ -214,12 +382,24 @@ Status Model::reloadVersions(std::shared_ptr<model_versions_t> versionsToReload,
             result = StatusCode::UNKNOWN_ERROR;
             continue;
         }
+        // local copy of a version which is still loaded is replaced by the new download once the version is reloaded,
+        // retired versions have their copy removed already
+        std::optional<ModelConfig> replacedCopyConfig;
         if (modelVersion->getStatus().getState() == ModelVersionState::END || modelVersion->getModelConfig().getBasePath() != config.getBasePath()) {
-            downloadModels(fs, config, versionsToReload);
+            if (modelVersion->getStatus().getState() != ModelVersionState::END) {
+                replacedCopyConfig = modelVersion->getModelConfig();
+            }
+            // objects unchanged since the previous download are linked from its local copy
+            downloadModels(fs, config, std::make_shared<model_versions_t>(model_versions_t{version}));
         } else {
             config.setLocalPath(modelVersion->getModelConfig().getLocalPath());
+            config.setDownloadMicroseconds(0);
         }
         status = modelVersion->reloadModel(config);
+        if (replacedCopyConfig && replacedCopyConfig->getPath() != config.getPath()) {
+            // releases the cloud model cache entry pinned by the previous copy
+            cleanupModelTmpFiles(*replacedCopyConfig);
+        }
         if (!status.ok()) {
             SPDLOG_ERROR("Error occurred while loading model: {}; version: {}; error: {}",
                 getName(),
@@ -239,6 +419,10 @@ Status Model::cleanupModelTmpFiles(const ModelConfig& config) {
     auto lfstatus = StatusCode::OK;
 
     if (config.isCloudStored()) {
+        std::error_code error;
+        if (std::filesystem::is_symlink(config.getPath(), error)) {
+            ModelCache::instance().release(std::filesystem::read_symlink(config.getPath(), error).string());
+        }
         LocalFileSystem lfs;
         lfstatus = lfs.deleteFileFolder(config.getPath());
         if (lfstatus != StatusCode::OK) {
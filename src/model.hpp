@@ -15,6 +15,7 @@
 //*****************************************************************************
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <shared_mutex>
@@ -28,6 +29,9 @@
 
 namespace ovms {
 class PipelineDefinition;
+
+using model_versions_snapshot_t = std::map<model_version_t, std::shared_ptr<ModelInstance>>;
+
 /*     * @brief This class represent inference models
      */
 class Model {
@@ -38,7 +42,8 @@ private:
     mutable std::shared_mutex modelVersionsMtx;
 
     /**
-      * @brief Update default version
+      * @brief Update default version to the highest available one, published atomically so requests switch
+      * to a new version only after it is loaded and warmed up
       *
       * @param ignoredVersion Version to exclude from being selected as the default version
       */
@@ -55,11 +60,18 @@ protected:
          */
     std::map<model_version_t, std::shared_ptr<ModelInstance>> modelVersions;
 
+    /**
+         * @brief Copy of modelVersions published with each added version, read without locking modelVersionsMtx
+         * so that request routing does not contend with version loading. std::atomic_load of shared_ptr is not
+         * lock-free, standard library guards it with a short internal spinlock
+         */
+    std::shared_ptr<const model_versions_snapshot_t> modelVersionsSnapshot = std::make_shared<const model_versions_snapshot_t>();
+
     /**
          * @brief Model default version
          *
          */
-    model_version_t defaultVersion = 0;
+    std::atomic<model_version_t> defaultVersion = 0;
 
     /**
          * @brief Get default version
@@ -67,8 +79,9 @@ protected:
          * @return default version
          */
     const model_version_t getDefaultVersion() const {
-        SPDLOG_DEBUG("Getting default version for model: {}, {}", getName(), defaultVersion);
-        return defaultVersion;
+        model_version_t version = defaultVersion;
+        SPDLOG_DEBUG("Getting default version for model: {}, {}", getName(), version);
+        return version;
     }
 
     /**
@@ -140,6 +153,23 @@ public:
      */
     const std::map<model_version_t, const ModelInstance&> getModelVersionsMapCopy() const;
 
+    /**
+     * @brief Gets model versions instances, safe to use while versions are added
+     *
+     * @return model versions instances
+     */
+    std::vector<std::shared_ptr<ModelInstance>> getModelInstances() const;
+
+    /**
+     * @brief Gets immutable snapshot of model versions instances without taking locks used by inference and loading,
+     * the atomic load only briefly takes the standard library lock guarding the shared_ptr
+     *
+     * @return model versions instances at the time of the last added version
+     */
+    std::shared_ptr<const model_versions_snapshot_t> getModelVersionsSnapshot() const {
+        return std::atomic_load(&modelVersionsSnapshot);
+    }
+
     /**
          * @brief Finds ModelInstance with specific version
          *
@@ -148,9 +178,9 @@ public:
          * @return specific model version
          */
     const std::shared_ptr<ModelInstance> getModelInstanceByVersion(const model_version_t& version) const {
-        std::shared_lock lock(modelVersionsMtx);
-        auto it = modelVersions.find(version);
-        return it != modelVersions.end() ? it->second : nullptr;
+        auto snapshot = getModelVersionsSnapshot();
+        auto it = snapshot->find(version);
+        return it != snapshot->end() ? it->second : nullptr;
     }
 
     /**
@@ -162,6 +192,11 @@ public:
          */
     Status addVersions(std::shared_ptr<model_versions_t> versions, ovms::ModelConfig& config, std::shared_ptr<FileSystem>& fs, std::shared_ptr<model_versions_t> versionsFailed);
 
+    /**
+         * @brief Number of versions of cloud stored models downloaded ahead of the version being compiled
+         */
+    static constexpr size_t PIPELINED_DOWNLOADS_AHEAD = 1;
+
     /**
          * @brief Retires versions of Model
          *
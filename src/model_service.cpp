@@ -38,13 +38,17 @@ using google::protobuf::util::MessageToJsonString;
 namespace ovms {
 
 void addStatusToResponse(tensorflow::serving::GetModelStatusResponse* response, model_version_t version, const ModelVersionStatus& model_version_status) {
-    SPDLOG_DEBUG("add_status_to_response version={} status={}", version, model_version_status.getStateString());
+    addStatusToResponse(response, version, model_version_status.getSnapshot());
+}
+
+void addStatusToResponse(tensorflow::serving::GetModelStatusResponse* response, model_version_t version, const ModelVersionStatusSnapshot& model_version_status) {
+    SPDLOG_DEBUG("add_status_to_response version={} status={}", version, ModelVersionStateToString(model_version_status.state));
     auto status_to_fill = response->add_model_version_status();
-    status_to_fill->set_state(static_cast<tensorflow::serving::ModelVersionStatus_State>(static_cast<int>(model_version_status.getState())));
+    status_to_fill->set_state(static_cast<tensorflow::serving::ModelVersionStatus_State>(static_cast<int>(model_version_status.state)));
     status_to_fill->set_version(version);
     status_to_fill->clear_status();
-    status_to_fill->mutable_status()->set_error_code(static_cast<tensorflow::error::Code>(static_cast<int>(model_version_status.getErrorCode())));
-    status_to_fill->mutable_status()->set_error_message(model_version_status.getErrorMsg());
+    status_to_fill->mutable_status()->set_error_code(static_cast<tensorflow::error::Code>(static_cast<int>(model_version_status.errorCode)));
+    status_to_fill->mutable_status()->set_error_message(ModelVersionStatusErrorCodeToString(model_version_status.errorCode));
 }
 
 void addStatusToResponse(tensorflow::serving::GetModelStatusResponse* response, const model_version_t version, const PipelineDefinitionStatus& pipeline_status) {
@@ -108,22 +112,23 @@ Status GetModelStatusImpl::getModelStatus(
     }
 
     SPDLOG_DEBUG("requested model: {}, has_version: {} (version: {})", requested_model_name, has_requested_version, requested_version);
+    // status reads use published snapshots only, so they do not contend with inference or loading
+    auto modelVersionsInstances = model_ptr->getModelVersionsSnapshot();
     if (has_requested_version && requested_version != 0) {
         // return details only for a specific version of requested model; NOT_FOUND otherwise. If requested_version == 0, default is returned.
-        std::shared_ptr<ModelInstance> model_instance = model_ptr->getModelInstanceByVersion(requested_version);
-        if (!model_instance) {
+        auto it = modelVersionsInstances->find(requested_version);
+        if (it == modelVersionsInstances->end()) {
             SPDLOG_WARN("requested model {} in version {} was not found.", requested_model_name, requested_version);
             return StatusCode::MODEL_VERSION_MISSING;
         }
-        const auto& status = model_instance->getStatus();
-        SPDLOG_DEBUG("adding model {} - {} :: {} to response", requested_model_name, requested_version, status.getStateString());
+        const auto status = it->second->getStatus().getSnapshot();
+        SPDLOG_DEBUG("adding model {} - {} :: {} to response", requested_model_name, requested_version, ModelVersionStateToString(status.state));
         addStatusToResponse(response, requested_version, status);
     } else {
         // return status details of all versions of a requested model.
-        auto modelVersionsInstances = model_ptr->getModelVersionsMapCopy();
-        for (const auto& [modelVersion, modelInstance] : modelVersionsInstances) {
-            const auto& status = modelInstance.getStatus();
-            SPDLOG_DEBUG("adding model {} - {} :: {} to response", requested_model_name, modelVersion, status.getStateString());
+        for (const auto& [modelVersion, modelInstance] : *modelVersionsInstances) {
+            const auto status = modelInstance->getStatus().getSnapshot();
+            SPDLOG_DEBUG("adding model {} - {} :: {} to response", requested_model_name, modelVersion, ModelVersionStateToString(status.state));
             addStatusToResponse(response, modelVersion, status);
         }
     }
@@ -34,6 +34,7 @@
 namespace ovms {
 
 void addStatusToResponse(tensorflow::serving::GetModelStatusResponse* response, model_version_t version, const ModelVersionStatus& model_version_status);
+void addStatusToResponse(tensorflow::serving::GetModelStatusResponse* response, model_version_t version, const ModelVersionStatusSnapshot& model_version_status);
 
 class ModelServiceImpl final : public tensorflow::serving::ModelService::Service {
 public:
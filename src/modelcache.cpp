@@ -0,0 +1,239 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "modelcache.hpp"
+
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <thread>
+
+#include <openssl/evp.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include "fetchedobjects.hpp"
+
+namespace ovms {
+
+namespace fs = std::filesystem;
+
+namespace {
+// copies of downloads from another file system are renamed to entry names only once complete
+const std::string PARTIAL_SUFFIX = ".partial";
+
+bool isKey(const std::string& name) {
+    return name.size() == 2 * 32 && name.find_first_not_of("0123456789abcdef") == std::string::npos;
+}
+
+uint64_t getDirectorySize(const fs::path& path) {
+    uint64_t bytes = 0;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(path, error); !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        if (it->is_regular_file(error)) {
+            bytes += it->file_size(error);
+        }
+    }
+    return bytes;
+}
+}  // namespace
+
+void ModelCache::configure(const std::string& directory, uint64_t quotaBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->directory.clear();
+    entries.clear();
+    used = 0;
+    quota = quotaBytes;
+    if (directory.empty()) {
+        return;
+    }
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        SPDLOG_ERROR("Cannot create cloud model cache directory: {} {}, cache is disabled", directory, error.message());
+        return;
+    }
+    for (const auto& item : fs::directory_iterator(directory, error)) {
+        const std::string name = item.path().filename().string();
+        if (!isKey(name) || !item.is_directory()) {
+            if (name.find(PARTIAL_SUFFIX) != std::string::npos) {
+                SPDLOG_DEBUG("Removing unfinished cloud model cache entry: {}", item.path().string());
+                std::error_code removeError;
+                fs::remove_all(item.path(), removeError);
+            }
+            continue;
+        }
+        Entry entry;
+        std::error_code timeError;
+        entry.bytes = getDirectorySize(item.path());
+        entry.lastUse = fs::last_write_time(item.path(), timeError);
+        used += entry.bytes;
+        entries.emplace(name, entry);
+    }
+    this->directory = directory;
+    while (this->directory.size() > 1 && this->directory.back() == '/') {
+        this->directory.pop_back();
+    }
+    SPDLOG_INFO("Cloud model cache: {} holds {} model versions using {} MB", this->directory, entries.size(), used / (1024 * 1024));
+    evict();
+}
+
+bool ModelCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !directory.empty();
+}
+
+std::string ModelCache::computeKey(const std::string& basePath, model_version_t version, const std::string& fingerprint) {
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context(EVP_MD_CTX_new(), &EVP_MD_CTX_free);
+    if (!context || !EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr)) {
+        return "";
+    }
+    for (const std::string& field : {basePath, std::to_string(version), fingerprint}) {
+        // length prefix keeps concatenated fields unambiguous
+        const uint64_t size = field.size();
+        EVP_DigestUpdate(context.get(), &size, sizeof(size));
+        EVP_DigestUpdate(context.get(), field.data(), field.size());
+    }
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestSize = 0;
+    if (!EVP_DigestFinal_ex(context.get(), digest, &digestSize)) {
+        return "";
+    }
+    static const char* hexDigits = "0123456789abcdef";
+    std::string key;
+    key.reserve(2 * digestSize);
+    for (unsigned int i = 0; i < digestSize; ++i) {
+        key.push_back(hexDigits[digest[i] >> 4]);
+        key.push_back(hexDigits[digest[i] & 0xf]);
+    }
+    return key;
+}
+
+std::string ModelCache::getEntryPath(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return directory.empty() ? "" : directory + "/" + key;
+}
+
+bool ModelCache::acquire(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (directory.empty() || it == entries.end()) {
+        return false;
+    }
+    const std::string entryPath = directory + "/" + key;
+    std::error_code error;
+    if (!fs::is_directory(entryPath, error)) {
+        SPDLOG_WARN("Cloud model cache entry was removed: {}", entryPath);
+        used -= it->second.bytes;
+        entries.erase(it);
+        return false;
+    }
+    it->second.users++;
+    it->second.lastUse = fs::file_time_type::clock::now();
+    // last use survives restarts as modification time of the entry
+    fs::last_write_time(entryPath, it->second.lastUse, error);
+    return true;
+}
+
+bool ModelCache::insert(const std::string& key, const std::string& versionPath) {
+    const std::string entryPath = getEntryPath(key);
+    if (entryPath.empty()) {
+        return false;
+    }
+    std::error_code error;
+    fs::rename(versionPath, entryPath, error);
+    if (error && !fs::is_directory(entryPath)) {
+        // download directory is on another file system
+        const std::string stagingPath = entryPath + PARTIAL_SUFFIX + "." + std::to_string(::getpid()) + "." +
+                                        std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        error.clear();
+        fs::copy(versionPath, stagingPath, fs::copy_options::recursive, error);
+        if (!error) {
+            fs::rename(stagingPath, entryPath, error);
+        }
+        if (error && !fs::is_directory(entryPath)) {
+            SPDLOG_WARN("Cannot store model version: {} in cloud model cache: {}", versionPath, error.message());
+            std::error_code removeError;
+            fs::remove_all(stagingPath, removeError);
+            return false;
+        }
+        std::error_code removeError;
+        fs::remove_all(stagingPath, removeError);
+    }
+    // left in place when the entry was inserted by a concurrent download
+    fs::remove_all(versionPath, error);
+    FetchedObjects::instance().relocate(versionPath, entryPath);
+
+    const uint64_t bytes = getDirectorySize(entryPath);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [it, inserted] = entries.try_emplace(key);
+    if (inserted) {
+        it->second.bytes = bytes;
+        used += bytes;
+    }
+    it->second.users++;
+    it->second.lastUse = fs::file_time_type::clock::now();
+    SPDLOG_DEBUG("Stored {} MB in cloud model cache entry: {}", bytes / (1024 * 1024), entryPath);
+    evict();
+    return true;
+}
+
+void ModelCache::release(const std::string& entryPath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (directory.empty()) {
+        return;
+    }
+    const std::string key = fs::path(entryPath).filename().string();
+    auto it = entries.find(key);
+    if (entryPath != directory + "/" + key || it == entries.end() || it->second.users == 0) {
+        return;
+    }
+    it->second.users--;
+    evict();
+}
+
+uint64_t ModelCache::getUsed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+void ModelCache::evict() {
+    if (quota == 0) {
+        return;
+    }
+    while (used > quota) {
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.users == 0 && (victim == entries.end() || it->second.lastUse < victim->second.lastUse)) {
+                victim = it;
+            }
+        }
+        if (victim == entries.end()) {
+            SPDLOG_DEBUG("Cloud model cache uses {} MB above quota, remaining entries are in use", (used - quota) / (1024 * 1024));
+            return;
+        }
+        const std::string entryPath = directory + "/" + victim->first;
+        SPDLOG_INFO("Evicting least recently used cloud model cache entry: {}", entryPath);
+        std::error_code error;
+        fs::remove_all(entryPath, error);
+        if (error) {
+            SPDLOG_WARN("Cannot remove cloud model cache entry: {} {}", entryPath, error.message());
+        }
+        used -= victim->second.bytes;
+        entries.erase(victim);
+    }
+}
+
+}  // namespace ovms
@@ -0,0 +1,106 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "model_version_policy.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Persistent local directory of model versions downloaded from cloud storage, so that restarts and
+ * reschedules of the server reuse local copies instead of downloading them again
+ *
+ * Entries are named after the key of model base path, version and the fingerprint of its remote objects, e.g. their
+ * names with ETags or generations, which is read with listing requests only. Any change of remote files results in
+ * a new key, stale entries are only missed and evicted in least recently used order once the quota is exceeded.
+ * Entries are linked into temporary model directories and stay pinned until the model versions using them are unloaded.
+ */
+class ModelCache {
+public:
+    static ModelCache& instance() {
+        static ModelCache instance;
+        return instance;
+    }
+
+    /**
+     * @brief Sets cache directory and scans entries stored there by previous runs, unfinished entries are removed
+     *
+     * @param directory cache is disabled when empty or when it cannot be created
+     * @param quotaBytes disk space of all entries, 0 means no limit
+     */
+    void configure(const std::string& directory, uint64_t quotaBytes);
+
+    bool isEnabled() const;
+
+    /**
+     * @brief Computes key of model version entry
+     *
+     * @return hex encoded SHA-256
+     */
+    static std::string computeKey(const std::string& basePath, model_version_t version, const std::string& fingerprint);
+
+    std::string getEntryPath(const std::string& key) const;
+
+    /**
+     * @brief Pins entry and marks it as most recently used
+     *
+     * @return true if entry is cached
+     */
+    bool acquire(const std::string& key);
+
+    /**
+     * @brief Moves downloaded version directory into the cache as a pinned entry and evicts least recently used
+     * entries above the quota. Entry already inserted by a concurrent download is reused and the directory removed.
+     *
+     * @return false if the directory could not be moved, it is left in place then
+     */
+    bool insert(const std::string& key, const std::string& versionPath);
+
+    /**
+     * @brief Unpins entry of unloaded model version, does nothing for paths outside of the cache
+     */
+    void release(const std::string& entryPath);
+
+    /**
+     * @brief Gets disk space used by all entries
+     */
+    uint64_t getUsed() const;
+
+private:
+    ModelCache() = default;
+
+    struct Entry {
+        uint64_t bytes = 0;
+        std::filesystem::file_time_type lastUse;
+        size_t users = 0;
+    };
+
+    void evict();
+
+    mutable std::mutex mutex;
+    std::string directory;
+    uint64_t quota = 0;
+    uint64_t used = 0;
+    std::map<std::string, Entry> entries;
+};
+
+}  // namespace ovms
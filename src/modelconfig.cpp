@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <set>
 #include <sstream>
 
 #include <rapidjson/istreamwrapper.h>
@@ -24,6 +25,8 @@
 #include <rapidjson/writer.h>
 #include <spdlog/spdlog.h>
 
+#include "cpupartitioning.hpp"
+#include "filesystemfactory.hpp"
 #include "schema.hpp"
 #include "stringutils.hpp"
 
@@ -62,6 +65,86 @@ bool ModelConfig::isReloadRequired(const ModelConfig& rhs) const {
         SPDLOG_DEBUG("ModelConfig {} reload required due to nireq mismatch", this->name);
         return true;
     }
+    if (this->maxNireq != rhs.maxNireq || this->nireqAutoscalingWaitMs != rhs.nireqAutoscalingWaitMs) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to nireq resizing mismatch", this->name);
+        return true;
+    }
+    if (this->dynamicBatchingMaxBatchSize != rhs.dynamicBatchingMaxBatchSize ||
+        this->dynamicBatchingMaxQueueDelayMicroseconds != rhs.dynamicBatchingMaxQueueDelayMicroseconds ||
+        this->dynamicBatchingLatencySloMicroseconds != rhs.dynamicBatchingLatencySloMicroseconds) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to dynamic batching mismatch", this->name);
+        return true;
+    }
+    if (this->shapeCacheSize != rhs.shapeCacheSize) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to shape cache size mismatch", this->name);
+        return true;
+    }
+    if (this->warmupIterations != rhs.warmupIterations ||
+        this->warmupDataPath != rhs.warmupDataPath) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to warmup mismatch", this->name);
+        return true;
+    }
+    if (this->autoTuning != rhs.autoTuning ||
+        this->autoTuningLatencyTargetMs != rhs.autoTuningLatencyTargetMs) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to auto-tuning mismatch", this->name);
+        return true;
+    }
+    if (this->inferRequestsPools != rhs.inferRequestsPools) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to infer requests pools mismatch", this->name);
+        return true;
+    }
+    if (this->maxPendingRequests != rhs.maxPendingRequests) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to max pending requests mismatch", this->name);
+        return true;
+    }
+    if (this->grpcCompressionThreshold != rhs.grpcCompressionThreshold) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to gRPC compression threshold mismatch", this->name);
+        return true;
+    }
+    if (this->responseCacheSizeMb != rhs.responseCacheSizeMb) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to response cache size mismatch", this->name);
+        return true;
+    }
+    if (this->lazyLoading != rhs.lazyLoading ||
+        this->idleUnloadTimeoutSeconds != rhs.idleUnloadTimeoutSeconds ||
+        this->idleHibernation != rhs.idleHibernation) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to lazy loading mismatch", this->name);
+        return true;
+    }
+    if (this->singleFlight != rhs.singleFlight) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to single flight mismatch", this->name);
+        return true;
+    }
+    if (this->batchSplit != rhs.batchSplit || this->batchPadding != rhs.batchPadding) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to batch split or padding mismatch", this->name);
+        return true;
+    }
+    if (this->schedulingWeight != rhs.schedulingWeight || this->schedulingPriority != rhs.schedulingPriority) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to scheduling parameters mismatch", this->name);
+        return true;
+    }
+    if (this->stateful != rhs.stateful ||
+        this->maxSequenceNumber != rhs.maxSequenceNumber ||
+        this->sequenceTimeoutSeconds != rhs.sequenceTimeoutSeconds) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to stateful parameters mismatch", this->name);
+        return true;
+    }
+    if (this->numaReplicas != rhs.numaReplicas) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to NUMA replicas mismatch", this->name);
+        return true;
+    }
+    if (this->cpus != rhs.cpus) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to cpus mismatch", this->name);
+        return true;
+    }
+    if (this->replicaDevices != rhs.replicaDevices || this->replicaRouting != rhs.replicaRouting) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to device replicas mismatch", this->name);
+        return true;
+    }
+    if (this->replicasCount != rhs.replicasCount) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to replicas count mismatch", this->name);
+        return true;
+    }
     if (this->pluginConfig != rhs.pluginConfig) {
         SPDLOG_DEBUG("ModelConfig {} reload required due to plugin config mismatch", this->name);
         return true;
@@ -74,6 +157,26 @@ bool ModelConfig::isReloadRequired(const ModelConfig& rhs) const {
         SPDLOG_DEBUG("ModelConfig {} reload required due to named layout mismatch", this->name);
         return true;
     }
+    if (this->inputConversions != rhs.inputConversions) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to input conversion mismatch", this->name);
+        return true;
+    }
+    if (this->outputPrecisions != rhs.outputPrecisions) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to output precision mismatch", this->name);
+        return true;
+    }
+    if (this->outputReductions != rhs.outputReductions) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to output reduction mismatch", this->name);
+        return true;
+    }
+    if (this->imageInputs != rhs.imageInputs) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to image inputs mismatch", this->name);
+        return true;
+    }
+    if (this->preprocessing != rhs.preprocessing) {
+        SPDLOG_DEBUG("ModelConfig {} reload required due to preprocessing mismatch", this->name);
+        return true;
+    }
     if (!isShapeConfigurationEqual(rhs)) {
         SPDLOG_DEBUG("ModelConfig {} reload required due to shape configuration mismatch", this->name);
         return true;
@@ -302,14 +405,24 @@ Status ModelConfig::parseModelMapping() {
     std::filesystem::path path = this->getPath();
     path.append(MAPPING_CONFIG_JSON);
 
-    std::ifstream ifs(path.c_str());
-    if (!ifs.good()) {
-        return StatusCode::FILE_INVALID;
-    }
-
     rapidjson::Document doc;
-    rapidjson::IStreamWrapper isw(ifs);
-    if (doc.ParseStream(isw).HasParseError()) {
+    if (isStreamedFromCloud()) {
+        auto fs = createFilesystem(path.string());
+        bool exists = false;
+        std::string contents;
+        if (fs->fileExists(path.string(), &exists) != StatusCode::OK || !exists || fs->readTextFile(path.string(), &contents) != StatusCode::OK) {
+            return StatusCode::FILE_INVALID;
+        }
+        doc.Parse(contents.c_str());
+    } else {
+        std::ifstream ifs(path.c_str());
+        if (!ifs.good()) {
+            return StatusCode::FILE_INVALID;
+        }
+        rapidjson::IStreamWrapper isw(ifs);
+        doc.ParseStream(isw);
+    }
+    if (doc.HasParseError()) {
         SPDLOG_ERROR("Configuration file is not a valid JSON file.");
         return StatusCode::JSON_INVALID;
     }
@@ -359,6 +472,146 @@ Status ModelConfig::parseNode(const rapidjson::Value& v) {
     if (v.HasMember("nireq"))
         this->setNireq(v["nireq"].GetUint64());
 
+    if (v.HasMember("max_nireq"))
+        this->setMaxNireq(v["max_nireq"].GetUint64());
+
+    if (v.HasMember("nireq_autoscaling_wait_ms"))
+        this->setNireqAutoscalingWaitMs(v["nireq_autoscaling_wait_ms"].GetUint());
+
+    if (v.HasMember("dynamic_batching")) {
+        const auto& batching = v["dynamic_batching"];
+        this->setDynamicBatchingMaxBatchSize(batching["max_batch_size"].GetUint64());
+        if (batching.HasMember("max_queue_delay_microseconds")) {
+            this->setDynamicBatchingMaxQueueDelayMicroseconds(batching["max_queue_delay_microseconds"].GetUint64());
+        }
+        if (batching.HasMember("latency_slo_microseconds")) {
+            this->setDynamicBatchingLatencySloMicroseconds(batching["latency_slo_microseconds"].GetUint64());
+        }
+    }
+
+    if (v.HasMember("shape_cache_size"))
+        this->setShapeCacheSize(v["shape_cache_size"].GetUint64());
+
+    if (v.HasMember("max_pending_requests"))
+        this->setMaxPendingRequests(v["max_pending_requests"].GetUint64());
+
+    if (v.HasMember("grpc_compression_threshold"))
+        this->setGrpcCompressionThreshold(v["grpc_compression_threshold"].GetUint64());
+
+    if (v.HasMember("response_cache_size_mb"))
+        this->setResponseCacheSizeMb(v["response_cache_size_mb"].GetUint64());
+
+    if (v.HasMember("single_flight"))
+        this->setSingleFlight(v["single_flight"].GetBool());
+
+    if (v.HasMember("batch_split"))
+        this->setBatchSplit(v["batch_split"].GetBool());
+
+    if (v.HasMember("batch_padding"))
+        this->setBatchPadding(v["batch_padding"].GetBool());
+
+    if (v.HasMember("scheduling_weight"))
+        this->setSchedulingWeight(v["scheduling_weight"].GetUint());
+
+    if (v.HasMember("scheduling_priority")) {
+        SchedulingPriority priority;
+        if (!parseSchedulingPriority(v["scheduling_priority"].GetString(), priority)) {
+            SPDLOG_ERROR("Unknown scheduling_priority: {} of model: {}", v["scheduling_priority"].GetString(), this->name);
+            return StatusCode::JSON_INVALID;
+        }
+        this->setSchedulingPriority(priority);
+    }
+
+    if (v.HasMember("lazy_loading"))
+        this->setLazyLoading(v["lazy_loading"].GetBool());
+
+    if (v.HasMember("idle_unload_timeout_seconds"))
+        this->setIdleUnloadTimeoutSeconds(v["idle_unload_timeout_seconds"].GetUint64());
+
+    if (v.HasMember("idle_hibernation"))
+        this->setIdleHibernation(v["idle_hibernation"].GetBool());
+
+    if (v.HasMember("numa_replicas"))
+        this->setNumaReplicas(v["numa_replicas"].GetBool());
+
+    if (v.HasMember("stateful"))
+        this->setStateful(v["stateful"].GetBool());
+
+    if (v.HasMember("max_sequence_number"))
+        this->setMaxSequenceNumber(v["max_sequence_number"].GetUint());
+
+    if (v.HasMember("sequence_timeout_seconds"))
+        this->setSequenceTimeoutSeconds(v["sequence_timeout_seconds"].GetUint());
+
+    if (v.HasMember("cpus")) {
+        // streams pinned to cpus the process cannot run on would fail to load
+        const cpu_list_t allowedCpus = getAllowedCpus();
+        cpu_list_t cpus;
+        auto status = parseAvailableCpuList(v["cpus"].GetString(), std::set<int>(allowedCpus.begin(), allowedCpus.end()), cpus);
+        if (!status.ok()) {
+            SPDLOG_ERROR("Couldn't parse cpus: {} of model: {}", v["cpus"].GetString(), this->name);
+            return status;
+        }
+        this->setCpus(cpus);
+    }
+
+    if (v.HasMember("replica_devices")) {
+        std::vector<std::string> devices;
+        for (const auto& device : v["replica_devices"].GetArray()) {
+            devices.emplace_back(device.GetString());
+        }
+        this->setReplicaDevices(devices);
+    }
+
+    if (v.HasMember("replica_routing")) {
+        ReplicaRouting routing;
+        if (!parseReplicaRouting(v["replica_routing"].GetString(), routing)) {
+            SPDLOG_ERROR("Unknown replica_routing: {} of model: {}", v["replica_routing"].GetString(), this->name);
+            return StatusCode::JSON_INVALID;
+        }
+        this->setReplicaRouting(routing);
+    }
+
+    if (v.HasMember("replicas"))
+        this->setReplicasCount(v["replicas"].GetUint());
+
+    if (v.HasMember("load_priority"))
+        this->setLoadPriority(v["load_priority"].GetInt());
+
+    if (v.HasMember("warmup")) {
+        const auto& warmup = v["warmup"];
+        this->setWarmupIterations(warmup.HasMember("iterations") ? warmup["iterations"].GetUint64() : 1);
+        if (warmup.HasMember("data_path")) {
+            this->setWarmupDataPath(warmup["data_path"].GetString());
+        }
+        SPDLOG_DEBUG("warmup: iterations: {}, data_path: {}", getWarmupIterations(), getWarmupDataPath());
+    }
+
+    if (v.HasMember("auto_tune")) {
+        const auto& autoTune = v["auto_tune"];
+        this->setAutoTuning(true);
+        if (autoTune.HasMember("latency_target_ms")) {
+            this->setAutoTuningLatencyTargetMs(autoTune["latency_target_ms"].GetUint());
+        }
+        SPDLOG_DEBUG("auto_tune: latency_target_ms: {}", getAutoTuningLatencyTargetMs());
+    }
+
+    if (v.HasMember("infer_request_pools")) {
+        infer_requests_pools_config_t pools;
+        for (auto& pool : v["infer_request_pools"].GetObject()) {
+            InferRequestsPoolConfig poolConfig;
+            if (pool.value.HasMember("nireq")) {
+                poolConfig.nireq = pool.value["nireq"].GetUint();
+            }
+            if (pool.value.HasMember("share")) {
+                poolConfig.share = pool.value["share"].GetDouble();
+            }
+            SPDLOG_DEBUG("infer_request_pools: {}: nireq: {}, share: {}", pool.name.GetString(), poolConfig.nireq, poolConfig.share);
+            pools[pool.name.GetString()] = poolConfig;
+        }
+        this->setInferRequestsPools(pools);
+    }
+
     if (v.HasMember("shape")) {
         // Legacy format as string
         if (v["shape"].IsString()) {
@@ -409,6 +662,68 @@ Status ModelConfig::parseNode(const rapidjson::Value& v) {
         }
     }
 
+    if (v.HasMember("input_conversion")) {
+        for (auto& s : v["input_conversion"].GetObject()) {
+            this->inputConversions[s.name.GetString()] = s.value.GetString();
+        }
+    }
+
+    if (v.HasMember("output_precision")) {
+        for (auto& s : v["output_precision"].GetObject()) {
+            this->outputPrecisions[s.name.GetString()] = s.value.GetString();
+        }
+    }
+
+    if (v.HasMember("output_reduction")) {
+        for (auto& s : v["output_reduction"].GetObject()) {
+            OutputReduction reduction;
+            if (!parseOutputReductionType(s.value["type"].GetString(), reduction.type)) {
+                SPDLOG_ERROR("Reduction type of output: {} should be argmax or top_k", s.name.GetString());
+                return StatusCode::JSON_INVALID;
+            }
+            if (s.value.HasMember("k")) {
+                reduction.k = s.value["k"].GetUint();
+            }
+            if (s.value.HasMember("threshold")) {
+                reduction.threshold = s.value["threshold"].GetFloat();
+            }
+            this->outputReductions[s.name.GetString()] = reduction;
+        }
+    }
+
+    if (v.HasMember("image_inputs")) {
+        for (auto& s : v["image_inputs"].GetObject()) {
+            this->imageInputs[s.name.GetString()] = s.value.GetString();
+        }
+    }
+
+    if (v.HasMember("preprocessing")) {
+        for (auto& s : v["preprocessing"].GetObject()) {
+            PreprocessingInfo info;
+            const auto& p = s.value;
+            if (p.HasMember("resize")) {
+                info.resizeAlgorithm = p["resize"].GetString();
+            }
+            if (p.HasMember("mean")) {
+                for (auto& value : p["mean"].GetArray()) {
+                    info.mean.push_back(value.GetFloat());
+                }
+            }
+            if (p.HasMember("scale")) {
+                for (auto& value : p["scale"].GetArray()) {
+                    info.scale.push_back(value.GetFloat());
+                }
+            }
+            if (p.HasMember("color_format")) {
+                info.colorFormat = p["color_format"].GetString();
+            }
+            if (p.HasMember("u8_input")) {
+                info.u8Input = p["u8_input"].GetBool();
+            }
+            this->preprocessing[s.name.GetString()] = std::move(info);
+        }
+    }
+
     if (v.HasMember("plugin_config")) {
         if (!parsePluginConfig(v["plugin_config"]).ok()) {
             SPDLOG_WARN("Couldn't parse plugin config");
@@ -460,6 +775,70 @@ Status ModelConfig::parseNode(const rapidjson::Value& v) {
         setBatchSize(0);
     }
 
+    if (isDynamicBatchingEnabled()) {
+        SPDLOG_DEBUG("dynamic_batching: max_batch_size: {}, max_queue_delay_microseconds: {}, latency_slo_microseconds: {}",
+            getDynamicBatchingMaxBatchSize(), getDynamicBatchingMaxQueueDelayMicroseconds(), getDynamicBatchingLatencySloMicroseconds());
+        if (getBatchingMode() == AUTO || anyShapeSetToAuto()) {
+            SPDLOG_WARN("Dynamic batching cannot be used together with automatic batch size or shape. Dynamic batching will be disabled.");
+            setDynamicBatchingMaxBatchSize(0);
+            setDynamicBatchingMaxQueueDelayMicroseconds(0);
+        }
+    }
+
+    if (anyInputResized() && isDynamicBatchingEnabled()) {
+        // requests with different image sizes cannot be copied into one batch
+        SPDLOG_WARN("Dynamic batching cannot be used together with resized inputs of model: {}. Dynamic batching will be disabled.", getName());
+        setDynamicBatchingMaxBatchSize(0);
+        setDynamicBatchingMaxQueueDelayMicroseconds(0);
+    }
+
+    if (isBatchSplitEnabled()) {
+        // split is done into chunks of the fixed network batch, each of them with the same input shapes
+        if (getBatchingMode() == AUTO || isDynamicBatchingEnabled() || anyInputResized() || isStateful()) {
+            SPDLOG_WARN("Batch split cannot be used together with automatic batch size, dynamic batching, resized inputs or stateful model: {}. Batch split will be disabled.", getName());
+            setBatchSplit(false);
+        }
+    }
+
+    if (isBatchPaddingEnabled()) {
+        // with automatic batch size network is reloaded only for bigger batches, smaller ones are padded
+        if (isDynamicBatchingEnabled() || anyInputResized() || isStateful()) {
+            SPDLOG_WARN("Batch padding cannot be used together with dynamic batching, resized inputs or stateful model: {}. Batch padding will be disabled.", getName());
+            setBatchPadding(false);
+        }
+    }
+
+    if (isStateful()) {
+        SPDLOG_DEBUG("stateful: max_sequence_number: {}, sequence_timeout_seconds: {}", getMaxSequenceNumber(), getSequenceTimeoutSeconds());
+        // memory states have the shape of the loaded network, reshaping would drop states of all sequences
+        if (getBatchingMode() == AUTO || anyShapeSetToAuto()) {
+            SPDLOG_ERROR("Stateful model: {} cannot have automatic batch size or shape", getName());
+            return StatusCode::JSON_INVALID;
+        }
+        // responses depend on sequence state, so they cannot be batched with other sequences or shared between requests
+        if (isDynamicBatchingEnabled() || getResponseCacheSizeMb() > 0 || isSingleFlightEnabled()) {
+            SPDLOG_WARN("Dynamic batching, response cache and single flight cannot be used with stateful model: {}. They will be disabled.", getName());
+            setDynamicBatchingMaxBatchSize(0);
+            setDynamicBatchingMaxQueueDelayMicroseconds(0);
+            setResponseCacheSizeMb(0);
+            setSingleFlight(false);
+        }
+    }
+
+    if (!getInferRequestsPools().empty() &&
+        (isStateful() || isDynamicBatchingEnabled() || isNumaReplicasEnabled() || !getReplicaDevices().empty())) {
+        // infer requests of such models are not split between queues of traffic classes
+        SPDLOG_WARN("Infer request pools cannot be used with stateful model, dynamic batching or replicas of model: {}. Infer request pools will be disabled.", getName());
+        setInferRequestsPools({});
+    }
+
+    if (getShapeCacheSize() > 0) {
+        SPDLOG_DEBUG("shape_cache_size: {}", getShapeCacheSize());
+        if (getBatchingMode() != AUTO && !anyShapeSetToAuto()) {
+            SPDLOG_WARN("shape_cache_size has effect only with automatic batch size or shape.");
+        }
+    }
+
     // if the config has models which require custom loader to be used, then load the same here
     if (v.HasMember("custom_loader_options")) {
         if (!parseCustomLoaderOptionsConfig(v["custom_loader_options"]).ok()) {
@@ -25,7 +25,12 @@
 
 #include <rapidjson/document.h>
 
+#include "inferencescheduler.hpp"
+#include "inferrequestpools.hpp"
 #include "model_version_policy.hpp"
+#include "numa.hpp"
+#include "outputreduction.hpp"
+#include "replicarouting.hpp"
 #include "status.hpp"
 
 namespace ovms {
@@ -50,12 +55,45 @@ struct ShapeInfo {
 };
 
 using shapes_map_t = std::unordered_map<std::string, ShapeInfo>;
+
+/**
+ * @brief Preprocessing of network input executed by OpenVINO plugin as part of the inference
+ */
+struct PreprocessingInfo {
+    // BILINEAR or AREA, requests can carry images of any height and width when set
+    std::string resizeAlgorithm;
+    // per channel values, request data is transformed into (value - mean) / scale
+    std::vector<float> mean;
+    std::vector<float> scale;
+    // RGB or BGR channel order of request data, network is expected to take BGR
+    std::string colorFormat;
+    // requests carry U8 data regardless of network input precision
+    bool u8Input = false;
+
+    bool operator==(const PreprocessingInfo& rhs) const {
+        return this->resizeAlgorithm == rhs.resizeAlgorithm && this->mean == rhs.mean && this->scale == rhs.scale &&
+               this->colorFormat == rhs.colorFormat && this->u8Input == rhs.u8Input;
+    }
+
+    bool operator!=(const PreprocessingInfo& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+using preprocessing_map_t = std::unordered_map<std::string, PreprocessingInfo>;
 using layouts_map_t = std::unordered_map<std::string, std::string>;
 using mapping_config_t = std::unordered_map<std::string, std::string>;
+using input_conversions_map_t = std::unordered_map<std::string, std::string>;
+using output_precisions_map_t = std::unordered_map<std::string, std::string>;
+using image_inputs_map_t = std::unordered_map<std::string, std::string>;
 using plugin_config_t = std::map<std::string, std::string>;
 using custom_loader_options_config_t = std::map<std::string, std::string>;
 
+constexpr uint32_t DEFAULT_MAX_SEQUENCE_NUMBER = 500;
+constexpr uint32_t DEFAULT_SEQUENCE_TIMEOUT_SECONDS = 60;
+
 const std::string ANONYMOUS_INPUT_NAME = "ANONYMOUS_INPUT_NAME";
+const std::string NHWC_TO_NCHW_LAYOUT = "NHWC:NCHW";
 const std::string MAPPING_CONFIG_JSON = "mapping_config.json";
 
 /**
@@ -78,6 +116,11 @@ private:
          */
     std::string localPath;
 
+    /**
+         * @brief Time of downloading model files for the upcoming load, set at runtime and not present in config file
+         */
+    uint64_t downloadMicroseconds = 0;
+
     /**
          * @brief Target device
          */
@@ -103,6 +146,161 @@ private:
          */
     uint64_t nireq;
 
+    /**
+         * @brief Number of infer requests the queue can be resized to at runtime, 0 keeps it at nireq
+         */
+    uint64_t maxNireq = 0;
+
+    /**
+         * @brief Average wait for infer request above which the queue grows, 0 disables autoscaling
+         */
+    uint32_t nireqAutoscalingWaitMs = 0;
+
+    /**
+         * @brief Maximum size of a server side gathered batch, 0 disables dynamic batching
+         */
+    size_t dynamicBatchingMaxBatchSize = 0;
+
+    /**
+         * @brief Maximum time the oldest request waits for a batch to fill up
+         */
+    uint64_t dynamicBatchingMaxQueueDelayMicroseconds = 0;
+
+    /**
+         * @brief Target p99 latency of batched requests, queue delay and batch size are adapted to it when set
+         */
+    uint64_t dynamicBatchingLatencySloMicroseconds = 0;
+
+    /**
+         * @brief Number of networks compiled for request shapes other than the loaded one, 0 reloads the model on mismatch
+         */
+    size_t shapeCacheSize = 0;
+
+    /**
+         * @brief Create executable network and infer requests on each NUMA node of the host
+         */
+    bool numaReplicas = false;
+
+    /**
+         * @brief Cpus inference streams are pinned to, empty uses inference cpus of the server
+         */
+    cpu_list_t cpus;
+
+    /**
+         * @brief Devices other than target device the model is loaded on as well, requests are routed between all of them
+         */
+    std::vector<std::string> replicaDevices;
+
+    /**
+         * @brief Policy choosing device replica serving the request
+         */
+    ReplicaRouting replicaRouting = ReplicaRouting::LEAST_QUEUED;
+
+    /**
+         * @brief Number of executable networks with own infer requests on target device, on CPU each pinned to its group of cpus
+         */
+    uint32_t replicasCount = 1;
+
+    /**
+         * @brief Models with higher priority are loaded first, models with priority above 0 are core models
+         */
+    int32_t loadPriority = 0;
+
+    /**
+         * @brief Maximum number of requests waiting for or running inference, 0 means no limit
+         */
+    uint64_t maxPendingRequests = 0;
+
+    /**
+         * @brief Minimum size of gRPC Predict response compressed with gzip, 0 disables compression
+         */
+    uint64_t grpcCompressionThreshold = 0;
+
+    /**
+         * @brief Size of predict responses cache in megabytes, 0 disables the cache
+         */
+    uint64_t responseCacheSizeMb = 0;
+
+    /**
+         * @brief Coalesce concurrent requests with identical inputs into a single inference
+         */
+    bool singleFlight = false;
+
+    /**
+         * @brief Requests with batch size bigger than the network one are split into several parallel inferences
+         */
+    bool batchSplit = false;
+
+    /**
+         * @brief Requests with batch size smaller than the network one are zero-padded instead of reloading the network
+         */
+    bool batchPadding = false;
+
+    /**
+         * @brief Model version is compiled on first use instead of on load, and may be deactivated when idle
+         */
+    bool lazyLoading = false;
+
+    /**
+         * @brief Time after last use when lazily loaded model version is deactivated, 0 keeps it active
+         */
+    uint64_t idleUnloadTimeoutSeconds = 0;
+
+    /**
+         * @brief Deactivated lazily loaded model version keeps its parsed network, so activation only compiles it
+         */
+    bool idleHibernation = false;
+
+    /**
+         * @brief Memory states of the network are kept by the server between requests of the same sequence
+         */
+    bool stateful = false;
+
+    /**
+         * @brief Maximum number of sequences of stateful model version started and not ended at once
+         */
+    uint32_t maxSequenceNumber = DEFAULT_MAX_SEQUENCE_NUMBER;
+
+    /**
+         * @brief Time after the last request when sequence of stateful model is dropped, 0 keeps idle sequences
+         */
+    uint32_t sequenceTimeoutSeconds = DEFAULT_SEQUENCE_TIMEOUT_SECONDS;
+
+    /**
+         * @brief Share of inference slots given to the model against other models of the same scheduling priority
+         */
+    uint32_t schedulingWeight = 1;
+
+    /**
+         * @brief Priority class of the model when waiting for inference slots
+         */
+    SchedulingPriority schedulingPriority = SchedulingPriority::NORMAL;
+
+    /**
+         * @brief Number of synthetic inferences run on each infer request before model becomes available, 0 disables warmup
+         */
+    size_t warmupIterations = 0;
+
+    /**
+         * @brief Directory with raw warmup input data files named after inputs, zeros are used when empty
+         */
+    std::string warmupDataPath;
+
+    /**
+         * @brief Benchmark streams and nireq combinations at load time and use the best one
+         */
+    bool autoTuning = false;
+
+    /**
+         * @brief Maximum average inference latency of the auto-tuned combination, 0 means only throughput is compared
+         */
+    uint32_t autoTuningLatencyTargetMs = 0;
+
+    /**
+         * @brief Infer requests reserved for direct traffic and for pipelines using the model, keyed by pool name
+         */
+    infer_requests_pools_config_t inferRequestsPools;
+
     /**
          * @brief Plugin config
          */
@@ -123,6 +321,31 @@ private:
          */
     layouts_map_t layouts;
 
+    /**
+         * @brief Map of network input names to request precisions converted to network precision
+         */
+    input_conversions_map_t inputConversions;
+
+    /**
+         * @brief Map of network output names to precisions sent in responses
+         */
+    output_precisions_map_t outputPrecisions;
+
+    /**
+         * @brief Map of network output names to reductions applied before they are sent in predict responses
+         */
+    output_reductions_map_t outputReductions;
+
+    /**
+         * @brief Map of network input names accepting encoded images to channel order of decoded images
+         */
+    image_inputs_map_t imageInputs;
+
+    /**
+         * @brief Map of network input names to preprocessing executed by the plugin
+         */
+    preprocessing_map_t preprocessing;
+
     /**
          * @brief Model version
          */
@@ -277,6 +500,20 @@ public:
         this->localPath = localPath;
     }
 
+    /**
+         * @brief Get time of downloading model files for the upcoming load
+         */
+    uint64_t getDownloadMicroseconds() const {
+        return this->downloadMicroseconds;
+    }
+
+    /**
+         * @brief Set time of downloading model files for the upcoming load
+         */
+    void setDownloadMicroseconds(uint64_t downloadMicroseconds) {
+        this->downloadMicroseconds = downloadMicroseconds;
+    }
+
     /**
          * @brief Get the target device
          * 
@@ -427,200 +664,910 @@ public:
     }
 
     /**
-         * @brief Get the plugin config
+         * @brief Get the number of infer requests the queue can be resized to
          * 
-         * @return const std::string&
+         * @return uint64_t 
          */
-    const plugin_config_t& getPluginConfig() const {
-        return this->pluginConfig;
+    uint64_t getMaxNireq() const {
+        return this->maxNireq;
     }
 
     /**
-         * @brief Set the plugin config
+         * @brief Set the number of infer requests the queue can be resized to
          * 
-         * @param pluginConfig 
+         * @param maxNireq 
          */
-    void setPluginConfig(const plugin_config_t& pluginConfig) {
-        this->pluginConfig = pluginConfig;
+    void setMaxNireq(const uint64_t maxNireq) {
+        this->maxNireq = maxNireq;
     }
 
     /**
-         * @brief Parses json node for plugin config keys and values
-         * 
-         * @param json node representing plugin_config
+         * @brief Get the average wait for infer request above which the queue grows
          * 
-         * @return status
+         * @return uint32_t milliseconds, 0 when autoscaling is disabled
          */
-    Status parsePluginConfig(const rapidjson::Value& node);
+    uint32_t getNireqAutoscalingWaitMs() const {
+        return this->nireqAutoscalingWaitMs;
+    }
 
     /**
-         * @brief Parses string for plugin config keys and values
+         * @brief Set the average wait for infer request above which the queue grows
          * 
-         * @param string representing plugin_config
-         * 
-         * @return status
+         * @param nireqAutoscalingWaitMs 
          */
-    Status parsePluginConfig(std::string command) {
-        rapidjson::Document node;
-        if (command.empty()) {
-            return StatusCode::OK;
-        }
-        if (node.Parse(command.c_str()).HasParseError()) {
-            return StatusCode::PLUGIN_CONFIG_WRONG_FORMAT;
-        }
-
-        return parsePluginConfig(node);
+    void setNireqAutoscalingWaitMs(const uint32_t nireqAutoscalingWaitMs) {
+        this->nireqAutoscalingWaitMs = nireqAutoscalingWaitMs;
     }
 
     /**
-         * @brief Parses value from json and extracts shapes info
-         * 
-         * @param rapidjson::Value& node
+         * @brief Checks if requests should be gathered into batches on the server side
          * 
-         * @return status
+         * @return bool
          */
-    Status parseShapeParameter(const rapidjson::Value& node);
+    bool isDynamicBatchingEnabled() const {
+        return this->dynamicBatchingMaxBatchSize > 0;
+    }
 
     /**
-         * @brief Parses value from string and extracts shapes info
+         * @brief Get the dynamic batching max batch size
          * 
-         * @param string
+         * @return size_t
+         */
+    size_t getDynamicBatchingMaxBatchSize() const {
+        return this->dynamicBatchingMaxBatchSize;
+    }
+
+    /**
+         * @brief Set the dynamic batching max batch size
          * 
-         * @return status
+         * @param maxBatchSize 
          */
-    Status parseShapeParameter(const std::string& command);
+    void setDynamicBatchingMaxBatchSize(const size_t maxBatchSize) {
+        this->dynamicBatchingMaxBatchSize = maxBatchSize;
+    }
 
     /**
-         * @brief Returns true if any input shape specified in shapes map is in AUTO mode
+         * @brief Get the dynamic batching max queue delay in microseconds
          * 
-         * @return bool
+         * @return uint64_t
          */
-    bool anyShapeSetToAuto() const {
-        for (const auto& [name, shapeInfo] : getShapes()) {
-            if (shapeInfo.shapeMode == AUTO)
-                return true;
-        }
-        return false;
+    uint64_t getDynamicBatchingMaxQueueDelayMicroseconds() const {
+        return this->dynamicBatchingMaxQueueDelayMicroseconds;
     }
 
     /**
-         * @brief Get the shapes
+         * @brief Set the dynamic batching max queue delay in microseconds
          * 
-         * @return const shapes_map_t& 
+         * @param maxQueueDelayMicroseconds 
          */
-    const shapes_map_t& getShapes() const {
-        return this->shapes;
+    void setDynamicBatchingMaxQueueDelayMicroseconds(const uint64_t maxQueueDelayMicroseconds) {
+        this->dynamicBatchingMaxQueueDelayMicroseconds = maxQueueDelayMicroseconds;
     }
 
     /**
-         * @brief Set the shapes
+         * @brief Get the dynamic batching latency SLO in microseconds, 0 keeps the fixed queue delay
          * 
-         * @param shapes 
+         * @return uint64_t
          */
-    void setShapes(const shapes_map_t& shapes) {
-        this->shapes = shapes;
+    uint64_t getDynamicBatchingLatencySloMicroseconds() const {
+        return this->dynamicBatchingLatencySloMicroseconds;
     }
 
     /**
-        * @brief Returns true if shape with certain name is in AUTO mode
+         * @brief Set the dynamic batching latency SLO in microseconds
          * 
-         * @return bool
+         * @param latencySloMicroseconds 
          */
-    bool isShapeAuto(const std::string& name) const {
-        auto it = getShapes().find(name);
-        if (it == getShapes().end()) {
-            it = getShapes().find(ANONYMOUS_INPUT_NAME);
-        }
-        if (it == getShapes().end()) {
-            return false;
-        }
-        return it->second.shapeMode == Mode::AUTO;
+    void setDynamicBatchingLatencySloMicroseconds(const uint64_t latencySloMicroseconds) {
+        this->dynamicBatchingLatencySloMicroseconds = latencySloMicroseconds;
     }
 
-    bool isShapeAnonymous() const {
-        return getShapes().size() == 1 && getShapes().begin()->first == ANONYMOUS_INPUT_NAME;
+    /**
+         * @brief Get the number of cached networks compiled for other request shapes
+         * 
+         * @return size_t
+         */
+    size_t getShapeCacheSize() const {
+        return this->shapeCacheSize;
     }
 
-    bool isShapeAnonymousFixed() const {
-        return isShapeAnonymous() && !isShapeAuto(ANONYMOUS_INPUT_NAME);
+    /**
+         * @brief Set the number of cached networks compiled for other request shapes
+         * 
+         * @param shapeCacheSize 
+         */
+    void setShapeCacheSize(const size_t shapeCacheSize) {
+        this->shapeCacheSize = shapeCacheSize;
     }
 
-    bool isCloudStored() const {
-        return getLocalPath() != getBasePath();
+    /**
+         * @brief Checks if model should be replicated on each NUMA node
+         * 
+         * @return bool
+         */
+    bool isNumaReplicasEnabled() const {
+        return this->numaReplicas;
     }
 
     /**
-         * @brief Sets the shape from the string representation
-         *
-         * @param shape
-         * @param str
-         * @return Status
+         * @brief Set NUMA replicas
+         * 
+         * @param numaReplicas 
          */
-    static Status parseShape(ShapeInfo& shapeInfo, const std::string& str);
+    void setNumaReplicas(const bool numaReplicas) {
+        this->numaReplicas = numaReplicas;
+    }
 
     /**
-         * @brief Add a single named shape
+         * @brief Get cpus inference streams are pinned to
          * 
-         * @param name 
-         * @param shape 
+         * @return const cpu_list_t&
          */
-    void addShape(const std::string& name, const ShapeInfo& shapeInfo) {
-        this->shapes[name] = shapeInfo;
+    const cpu_list_t& getCpus() const {
+        return this->cpus;
     }
 
-    void removeShape(const std::string& name) {
-        this->shapes.erase(name);
+    /**
+         * @brief Set cpus inference streams are pinned to
+         * 
+         * @param cpus 
+         */
+    void setCpus(const cpu_list_t& cpus) {
+        this->cpus = cpus;
     }
 
     /**
-         * @brief Get the layouts
+         * @brief Get devices the model is replicated on besides target device
          * 
-         * @return const std::string& 
+         * @return const std::vector<std::string>&
          */
-    const std::string& getLayout() const {
-        return this->layout;
+    const std::vector<std::string>& getReplicaDevices() const {
+        return this->replicaDevices;
     }
 
     /**
-         * @brief Set the layout
+         * @brief Set devices the model is replicated on besides target device
          * 
-         * @param layout
+         * @param replicaDevices 
          */
-    void setLayout(const std::string& layout) {
-        this->layout = layout;
-        this->layouts.clear();
+    void setReplicaDevices(const std::vector<std::string>& replicaDevices) {
+        this->replicaDevices = replicaDevices;
     }
 
     /**
-         * @brief Get the layouts
+         * @brief Get policy routing requests between device replicas
          * 
-         * @return const layouts_map_t& 
+         * @return ReplicaRouting
          */
-    const layouts_map_t& getLayouts() const {
-        return this->layouts;
+    ReplicaRouting getReplicaRouting() const {
+        return this->replicaRouting;
     }
 
     /**
-         * @brief Set the layouts
+         * @brief Set policy routing requests between device replicas
          * 
-         * @param layouts 
+         * @param replicaRouting 
          */
-    void setLayouts(const layouts_map_t& layouts) {
-        this->layouts = layouts;
-        this->layout = "";
+    void setReplicaRouting(const ReplicaRouting replicaRouting) {
+        this->replicaRouting = replicaRouting;
     }
 
     /**
-         * @brief Add a named layout
+         * @brief Get number of replicas on target device
          * 
-         * @param name 
-         * @param layout 
+         * @return uint32_t
          */
-    void addLayout(const std::string& name, const std::string& layout) {
+    uint32_t getReplicasCount() const {
+        return this->replicasCount;
+    }
+
+    /**
+         * @brief Set number of replicas on target device
+         * 
+         * @param replicasCount 
+         */
+    void setReplicasCount(const uint32_t replicasCount) {
+        this->replicasCount = replicasCount;
+    }
+
+    /**
+         * @brief Get load priority
+         * 
+         * @return int32_t
+         */
+    int32_t getLoadPriority() const {
+        return this->loadPriority;
+    }
+
+    /**
+         * @brief Set load priority
+         * 
+         * @param loadPriority 
+         */
+    void setLoadPriority(const int32_t loadPriority) {
+        this->loadPriority = loadPriority;
+    }
+
+    /**
+         * @brief Core models are loaded before the server starts, the rest may keep loading in the background
+         * 
+         * @return bool
+         */
+    bool isCoreModel() const {
+        return this->loadPriority > 0;
+    }
+
+    /**
+         * @brief Get the maximum number of pending requests
+         * 
+         * @return uint64_t
+         */
+    uint64_t getMaxPendingRequests() const {
+        return this->maxPendingRequests;
+    }
+
+    /**
+         * @brief Set the maximum number of pending requests
+         * 
+         * @param maxPendingRequests 
+         */
+    void setMaxPendingRequests(const uint64_t maxPendingRequests) {
+        this->maxPendingRequests = maxPendingRequests;
+    }
+
+    /**
+         * @brief Get the minimum size of compressed gRPC response
+         * 
+         * @return uint64_t
+         */
+    uint64_t getGrpcCompressionThreshold() const {
+        return this->grpcCompressionThreshold;
+    }
+
+    /**
+         * @brief Set the minimum size of compressed gRPC response, 0 disables compression
+         * 
+         * @param grpcCompressionThreshold 
+         */
+    void setGrpcCompressionThreshold(const uint64_t grpcCompressionThreshold) {
+        this->grpcCompressionThreshold = grpcCompressionThreshold;
+    }
+
+    /**
+         * @brief Get the size of predict responses cache in megabytes
+         * 
+         * @return uint64_t
+         */
+    uint64_t getResponseCacheSizeMb() const {
+        return this->responseCacheSizeMb;
+    }
+
+    /**
+         * @brief Set the size of predict responses cache in megabytes, 0 disables the cache
+         * 
+         * @param responseCacheSizeMb 
+         */
+    void setResponseCacheSizeMb(const uint64_t responseCacheSizeMb) {
+        this->responseCacheSizeMb = responseCacheSizeMb;
+    }
+
+    /**
+         * @brief Checks if concurrent identical requests share a single inference
+         * 
+         * @return bool
+         */
+    bool isSingleFlightEnabled() const {
+        return this->singleFlight;
+    }
+
+    /**
+         * @brief Set single flight
+         * 
+         * @param singleFlight 
+         */
+    void setSingleFlight(const bool singleFlight) {
+        this->singleFlight = singleFlight;
+    }
+
+    /**
+         * @brief Checks if requests with bigger batch size than the network one are split into network batch size inferences
+         * 
+         * @return bool
+         */
+    bool isBatchSplitEnabled() const {
+        return this->batchSplit;
+    }
+
+    /**
+         * @brief Set batch split
+         * 
+         * @param batchSplit 
+         */
+    void setBatchSplit(const bool batchSplit) {
+        this->batchSplit = batchSplit;
+    }
+
+    /**
+         * @brief Checks if requests with smaller batch size than the network one are padded to the network batch size
+         * 
+         * @return bool
+         */
+    bool isBatchPaddingEnabled() const {
+        return this->batchPadding;
+    }
+
+    /**
+         * @brief Set batch padding
+         * 
+         * @param batchPadding 
+         */
+    void setBatchPadding(const bool batchPadding) {
+        this->batchPadding = batchPadding;
+    }
+
+    /**
+         * @brief Get the share of inference slots against other models of the same priority
+         * 
+         * @return uint32_t
+         */
+    uint32_t getSchedulingWeight() const {
+        return this->schedulingWeight;
+    }
+
+    /**
+         * @brief Set the share of inference slots
+         * 
+         * @param schedulingWeight 
+         */
+    void setSchedulingWeight(const uint32_t schedulingWeight) {
+        this->schedulingWeight = schedulingWeight;
+    }
+
+    /**
+         * @brief Get the priority class of the model when waiting for inference slots
+         * 
+         * @return SchedulingPriority
+         */
+    SchedulingPriority getSchedulingPriority() const {
+        return this->schedulingPriority;
+    }
+
+    /**
+         * @brief Set the scheduling priority
+         * 
+         * @param schedulingPriority 
+         */
+    void setSchedulingPriority(const SchedulingPriority schedulingPriority) {
+        this->schedulingPriority = schedulingPriority;
+    }
+
+    /**
+         * @brief Checks if model version is compiled on first use
+         * 
+         * @return bool
+         */
+    bool isLazyLoadingEnabled() const {
+        return this->lazyLoading;
+    }
+
+    /**
+         * @brief Set lazy loading
+         * 
+         * @param lazyLoading 
+         */
+    void setLazyLoading(const bool lazyLoading) {
+        this->lazyLoading = lazyLoading;
+    }
+
+    /**
+         * @brief Get the time after last use when lazily loaded model version is deactivated
+         * 
+         * @return uint64_t
+         */
+    uint64_t getIdleUnloadTimeoutSeconds() const {
+        return this->idleUnloadTimeoutSeconds;
+    }
+
+    /**
+         * @brief Set the time after last use when lazily loaded model version is deactivated, 0 keeps it active
+         * 
+         * @param idleUnloadTimeoutSeconds 
+         */
+    void setIdleUnloadTimeoutSeconds(const uint64_t idleUnloadTimeoutSeconds) {
+        this->idleUnloadTimeoutSeconds = idleUnloadTimeoutSeconds;
+    }
+
+    /**
+         * @brief Checks if deactivated model version keeps its parsed network in memory
+         * 
+         * @return bool
+         */
+    bool isIdleHibernationEnabled() const {
+        return this->idleHibernation;
+    }
+
+    /**
+         * @brief Set if deactivated model version keeps its parsed network in memory
+         * 
+         * @param idleHibernation 
+         */
+    void setIdleHibernation(const bool idleHibernation) {
+        this->idleHibernation = idleHibernation;
+    }
+
+    /**
+         * @brief Checks if the server keeps memory states of the network for each sequence of requests
+         * 
+         * @return bool
+         */
+    bool isStateful() const {
+        return this->stateful;
+    }
+
+    /**
+         * @brief Set stateful
+         * 
+         * @param stateful 
+         */
+    void setStateful(const bool stateful) {
+        this->stateful = stateful;
+    }
+
+    /**
+         * @brief Get the maximum number of concurrent sequences
+         * 
+         * @return uint32_t
+         */
+    uint32_t getMaxSequenceNumber() const {
+        return this->maxSequenceNumber;
+    }
+
+    /**
+         * @brief Set the maximum number of concurrent sequences
+         * 
+         * @param maxSequenceNumber 
+         */
+    void setMaxSequenceNumber(const uint32_t maxSequenceNumber) {
+        this->maxSequenceNumber = maxSequenceNumber;
+    }
+
+    /**
+         * @brief Get the idle sequence timeout in seconds
+         * 
+         * @return uint32_t
+         */
+    uint32_t getSequenceTimeoutSeconds() const {
+        return this->sequenceTimeoutSeconds;
+    }
+
+    /**
+         * @brief Set the idle sequence timeout in seconds
+         * 
+         * @param sequenceTimeoutSeconds 
+         */
+    void setSequenceTimeoutSeconds(const uint32_t sequenceTimeoutSeconds) {
+        this->sequenceTimeoutSeconds = sequenceTimeoutSeconds;
+    }
+
+    /**
+         * @brief Get the number of warmup inferences on each infer request
+         * 
+         * @return size_t
+         */
+    size_t getWarmupIterations() const {
+        return this->warmupIterations;
+    }
+
+    /**
+         * @brief Set the number of warmup inferences on each infer request
+         * 
+         * @param warmupIterations 
+         */
+    void setWarmupIterations(const size_t warmupIterations) {
+        this->warmupIterations = warmupIterations;
+    }
+
+    /**
+         * @brief Get the warmup data directory
+         * 
+         * @return const std::string&
+         */
+    const std::string& getWarmupDataPath() const {
+        return this->warmupDataPath;
+    }
+
+    /**
+         * @brief Set the warmup data directory
+         * 
+         * @param warmupDataPath 
+         */
+    void setWarmupDataPath(const std::string& warmupDataPath) {
+        this->warmupDataPath = warmupDataPath;
+    }
+
+    /**
+         * @brief Checks if streams and nireq are auto-tuned at load time
+         * 
+         * @return bool
+         */
+    bool isAutoTuningEnabled() const {
+        return this->autoTuning;
+    }
+
+    /**
+         * @brief Set auto-tuning of streams and nireq
+         * 
+         * @param autoTuning 
+         */
+    void setAutoTuning(const bool autoTuning) {
+        this->autoTuning = autoTuning;
+    }
+
+    /**
+         * @brief Get latency target of auto-tuning
+         * 
+         * @return uint32_t
+         */
+    uint32_t getAutoTuningLatencyTargetMs() const {
+        return this->autoTuningLatencyTargetMs;
+    }
+
+    /**
+         * @brief Set latency target of auto-tuning
+         * 
+         * @param autoTuningLatencyTargetMs 
+         */
+    void setAutoTuningLatencyTargetMs(const uint32_t autoTuningLatencyTargetMs) {
+        this->autoTuningLatencyTargetMs = autoTuningLatencyTargetMs;
+    }
+
+    /**
+         * @brief Get infer requests pools
+         * 
+         * @return const infer_requests_pools_config_t&
+         */
+    const infer_requests_pools_config_t& getInferRequestsPools() const {
+        return this->inferRequestsPools;
+    }
+
+    /**
+         * @brief Set infer requests pools
+         * 
+         * @param inferRequestsPools 
+         */
+    void setInferRequestsPools(const infer_requests_pools_config_t& inferRequestsPools) {
+        this->inferRequestsPools = inferRequestsPools;
+    }
+
+    /**
+         * @brief Get the plugin config
+         * 
+         * @return const std::string&
+         */
+    const plugin_config_t& getPluginConfig() const {
+        return this->pluginConfig;
+    }
+
+    /**
+         * @brief Set the plugin config
+         * 
+         * @param pluginConfig 
+         */
+    void setPluginConfig(const plugin_config_t& pluginConfig) {
+        this->pluginConfig = pluginConfig;
+    }
+
+    /**
+         * @brief Parses json node for plugin config keys and values
+         * 
+         * @param json node representing plugin_config
+         * 
+         * @return status
+         */
+    Status parsePluginConfig(const rapidjson::Value& node);
+
+    /**
+         * @brief Parses string for plugin config keys and values
+         * 
+         * @param string representing plugin_config
+         * 
+         * @return status
+         */
+    Status parsePluginConfig(std::string command) {
+        rapidjson::Document node;
+        if (command.empty()) {
+            return StatusCode::OK;
+        }
+        if (node.Parse(command.c_str()).HasParseError()) {
+            return StatusCode::PLUGIN_CONFIG_WRONG_FORMAT;
+        }
+
+        return parsePluginConfig(node);
+    }
+
+    /**
+         * @brief Parses value from json and extracts shapes info
+         * 
+         * @param rapidjson::Value& node
+         * 
+         * @return status
+         */
+    Status parseShapeParameter(const rapidjson::Value& node);
+
+    /**
+         * @brief Parses value from string and extracts shapes info
+         * 
+         * @param string
+         * 
+         * @return status
+         */
+    Status parseShapeParameter(const std::string& command);
+
+    /**
+         * @brief Returns true if any input shape specified in shapes map is in AUTO mode
+         * 
+         * @return bool
+         */
+    bool anyShapeSetToAuto() const {
+        for (const auto& [name, shapeInfo] : getShapes()) {
+            if (shapeInfo.shapeMode == AUTO)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+         * @brief Get the shapes
+         * 
+         * @return const shapes_map_t& 
+         */
+    const shapes_map_t& getShapes() const {
+        return this->shapes;
+    }
+
+    /**
+         * @brief Set the shapes
+         * 
+         * @param shapes 
+         */
+    void setShapes(const shapes_map_t& shapes) {
+        this->shapes = shapes;
+    }
+
+    /**
+        * @brief Returns true if shape with certain name is in AUTO mode
+         * 
+         * @return bool
+         */
+    bool isShapeAuto(const std::string& name) const {
+        auto it = getShapes().find(name);
+        if (it == getShapes().end()) {
+            it = getShapes().find(ANONYMOUS_INPUT_NAME);
+        }
+        if (it == getShapes().end()) {
+            return false;
+        }
+        return it->second.shapeMode == Mode::AUTO;
+    }
+
+    bool isShapeAnonymous() const {
+        return getShapes().size() == 1 && getShapes().begin()->first == ANONYMOUS_INPUT_NAME;
+    }
+
+    bool isShapeAnonymousFixed() const {
+        return isShapeAnonymous() && !isShapeAuto(ANONYMOUS_INPUT_NAME);
+    }
+
+    bool isCloudStored() const {
+        return getLocalPath() != getBasePath();
+    }
+
+    /**
+         * @brief Checks if model files are read from cloud storage into memory instead of a local copy
+         */
+    bool isStreamedFromCloud() const {
+        return getLocalPath().find("://") != std::string::npos;
+    }
+
+    /**
+         * @brief Sets the shape from the string representation
+         *
+         * @param shape
+         * @param str
+         * @return Status
+         */
+    static Status parseShape(ShapeInfo& shapeInfo, const std::string& str);
+
+    /**
+         * @brief Add a single named shape
+         * 
+         * @param name 
+         * @param shape 
+         */
+    void addShape(const std::string& name, const ShapeInfo& shapeInfo) {
+        this->shapes[name] = shapeInfo;
+    }
+
+    void removeShape(const std::string& name) {
+        this->shapes.erase(name);
+    }
+
+    /**
+         * @brief Get the layouts
+         * 
+         * @return const std::string& 
+         */
+    const std::string& getLayout() const {
+        return this->layout;
+    }
+
+    /**
+         * @brief Set the layout
+         * 
+         * @param layout
+         */
+    void setLayout(const std::string& layout) {
+        this->layout = layout;
+        this->layouts.clear();
+    }
+
+    /**
+         * @brief Get the layouts
+         * 
+         * @return const layouts_map_t& 
+         */
+    const layouts_map_t& getLayouts() const {
+        return this->layouts;
+    }
+
+    /**
+         * @brief Set the layouts
+         * 
+         * @param layouts 
+         */
+    void setLayouts(const layouts_map_t& layouts) {
+        this->layouts = layouts;
+        this->layout = "";
+    }
+
+    /**
+         * @brief Add a named layout
+         * 
+         * @param name 
+         * @param layout 
+         */
+    void addLayout(const std::string& name, const std::string& layout) {
         this->layouts[name] = layout;
         this->layout = "";
     }
 
+    /**
+         * @brief Get the input precision conversions
+         * 
+         * @return const input_conversions_map_t& 
+         */
+    const input_conversions_map_t& getInputConversions() const {
+        return this->inputConversions;
+    }
+
+    /**
+         * @brief Set the input precision conversions
+         * 
+         * @param inputConversions 
+         */
+    void setInputConversions(const input_conversions_map_t& inputConversions) {
+        this->inputConversions = inputConversions;
+    }
+
+    /**
+         * @brief Checks if request with given precision is converted to the precision of network input
+         * 
+         * @param name network input name
+         * @param requestPrecision precision as string, e.g. FP32
+         * @return bool
+         */
+    bool isInputConversionEnabled(const std::string& name, const std::string& requestPrecision) const {
+        auto it = this->inputConversions.find(name);
+        return it != this->inputConversions.end() && it->second == requestPrecision;
+    }
+
+    /**
+         * @brief Get the output precisions sent in responses
+         * 
+         * @return const output_precisions_map_t& 
+         */
+    const output_precisions_map_t& getOutputPrecisions() const {
+        return this->outputPrecisions;
+    }
+
+    /**
+         * @brief Set the output precisions sent in responses
+         * 
+         * @param outputPrecisions 
+         */
+    void setOutputPrecisions(const output_precisions_map_t& outputPrecisions) {
+        this->outputPrecisions = outputPrecisions;
+    }
+
+    /**
+         * @brief Checks if FP16 output is sent as packed half precision values instead of being widened to FP32
+         * 
+         * @param name network output name
+         * @return bool
+         */
+    bool isHalfPrecisionOutput(const std::string& name) const {
+        auto it = this->outputPrecisions.find(name);
+        return it != this->outputPrecisions.end() && it->second == "FP16";
+    }
+
+    /**
+         * @brief Get the output reductions applied before outputs are sent in predict responses
+         * 
+         * @return const output_reductions_map_t& 
+         */
+    const output_reductions_map_t& getOutputReductions() const {
+        return this->outputReductions;
+    }
+
+    /**
+         * @brief Set the output reductions applied before outputs are sent in predict responses
+         * 
+         * @param outputReductions 
+         */
+    void setOutputReductions(const output_reductions_map_t& outputReductions) {
+        this->outputReductions = outputReductions;
+    }
+
+    /**
+         * @brief Get the inputs accepting encoded images
+         * 
+         * @return const image_inputs_map_t& 
+         */
+    const image_inputs_map_t& getImageInputs() const {
+        return this->imageInputs;
+    }
+
+    /**
+         * @brief Set the inputs accepting encoded images
+         * 
+         * @param imageInputs map of network input names to channel order, RGB or BGR
+         */
+    void setImageInputs(const image_inputs_map_t& imageInputs) {
+        this->imageInputs = imageInputs;
+    }
+
+    /**
+         * @brief Get the inputs preprocessed by the plugin
+         * 
+         * @return const preprocessing_map_t& 
+         */
+    const preprocessing_map_t& getPreprocessing() const {
+        return this->preprocessing;
+    }
+
+    /**
+         * @brief Set the inputs preprocessed by the plugin
+         * 
+         * @param preprocessing map of network input names to preprocessing
+         */
+    void setPreprocessing(const preprocessing_map_t& preprocessing) {
+        this->preprocessing = preprocessing;
+    }
+
+    /**
+         * @brief Checks if any input is resized by the plugin, its requests may have different shapes then
+         * 
+         * @return bool
+         */
+    bool anyInputResized() const {
+        for (const auto& [name, info] : this->preprocessing) {
+            if (!info.resizeAlgorithm.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     /**
          * @brief Get the version
          * 
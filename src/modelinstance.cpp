@@ -16,22 +16,56 @@
 #include "modelinstance.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <streambuf>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
+
+#include <filesystem>
 
 #include <dirent.h>
+#include <ngraph/graph_util.hpp>
 #include <spdlog/spdlog.h>
 #include <sys/types.h>
 
+#include "compilednetworkcache.hpp"
 #include "config.hpp"
+#include "containerlimits.hpp"
 #include "customloaders.hpp"
+#include "deserialization.hpp"
 #include "filesystem.hpp"
+#include "filesystemfactory.hpp"
+#include "imagedecoder.hpp"
+#include "inferencescheduler.hpp"
+#include "lazymodelsbudget.hpp"
 #include "logging.hpp"
+#include "mappedfile.hpp"
+#include "modelmanager.hpp"
+#include "cpupartitioning.hpp"
+#include "numa.hpp"
+#include "replicarouting.hpp"
+#include "shapeprofile.hpp"
+#include "sharedmemory.hpp"
+#include "streamsbudget.hpp"
 #include "stringutils.hpp"
+#include "tensorarena.hpp"
+#include "transposition.hpp"
+#include "weightsregistry.hpp"
 
 using namespace InferenceEngine;
 
@@ -42,9 +76,32 @@ const char* NIREQ = "NIREQ";
 
 const uint MAX_NIREQ_COUNT = 100000;
 
-const int DEFAULT_OV_STREAMS = std::thread::hardware_concurrency() / 4;
+// waiting for in-flight inferences is woken up by the last of them, interval only paces the progress logs
+const uint UNLOAD_AVAILABILITY_LOGGING_INTERVAL_MILLISECONDS = 1000;
+
+const size_t AUTO_TUNING_ITERATIONS = 10;
 
-const uint UNLOAD_AVAILABILITY_CHECKING_INTERVAL_MILLISECONDS = 10;
+const std::chrono::milliseconds DEFAULT_CUSTOM_LOADER_LOAD_TIMEOUT{600000};
+
+/**
+ * @brief Gives time loading thread waits for callback of loadModelBuffersAsync, load_timeout_ms of custom loader options
+ */
+static std::chrono::milliseconds getCustomLoaderLoadTimeout(const custom_loader_options_config_t& options) {
+    auto it = options.find("load_timeout_ms");
+    if (it == options.end()) {
+        return DEFAULT_CUSTOM_LOADER_LOAD_TIMEOUT;
+    }
+    try {
+        size_t parsed = 0;
+        const auto milliseconds = std::stoul(it->second, &parsed);
+        if (parsed == it->second.size() && milliseconds > 0) {
+            return std::chrono::milliseconds(milliseconds);
+        }
+    } catch (const std::exception&) {
+    }
+    SPDLOG_WARN("Invalid custom loader option load_timeout_ms: {}, using default: {}", it->second, DEFAULT_CUSTOM_LOADER_LOAD_TIMEOUT.count());
+    return DEFAULT_CUSTOM_LOADER_LOAD_TIMEOUT;
+}
 
 void ModelInstance::subscribe(PipelineDefinition& pd) {
     subscriptionManager.subscribe(pd);
@@ -53,6 +110,49 @@ void ModelInstance::subscribe(PipelineDefinition& pd) {
 void ModelInstance::unsubscribe(PipelineDefinition& pd) {
     subscriptionManager.unsubscribe(pd);
 }
+/**
+ * @brief Sets preprocessing executed by the plugin on network input, options which cannot be applied are ignored with a warning
+ *
+ * @return true if request data of the input is resized to network shape
+ */
+static bool applyPreprocessing(const std::string& name, InputInfo& input, const PreprocessingInfo& info, bool layoutTransposed) {
+    auto& preProcess = input.getPreProcess();
+    const auto& dims = input.getTensorDesc().getDims();
+    const size_t channels = dims.size() >= 2 ? dims[1] : 0;
+    bool resized = false;
+    if (info.resizeAlgorithm.size()) {
+        if (dims.size() != 4 || layoutTransposed) {
+            SPDLOG_WARN("Input: {} resize requires 4 dimensional shape without layout: {} and will be ignored", name, NHWC_TO_NCHW_LAYOUT);
+        } else {
+            preProcess.setResizeAlgorithm(info.resizeAlgorithm == "AREA" ? ResizeAlgorithm::RESIZE_AREA : ResizeAlgorithm::RESIZE_BILINEAR);
+            resized = true;
+        }
+    }
+    if (info.mean.size() || info.scale.size()) {
+        if ((info.mean.size() && info.mean.size() != channels) || (info.scale.size() && info.scale.size() != channels)) {
+            SPDLOG_WARN("Input: {} mean and scale have to be set for each of: {} channels and will be ignored", name, channels);
+        } else {
+            preProcess.init(channels);
+            for (size_t c = 0; c < channels; c++) {
+                preProcess[c]->meanValue = info.mean.size() ? info.mean[c] : 0.0f;
+                preProcess[c]->stdScale = info.scale.size() ? info.scale[c] : 1.0f;
+            }
+            preProcess.setVariant(MEAN_VALUE);
+        }
+    }
+    if (info.colorFormat.size()) {
+        if (dims.size() != 4 || channels != 3) {
+            SPDLOG_WARN("Input: {} color format requires 3 channel images and will be ignored", name);
+        } else {
+            preProcess.setColorFormat(info.colorFormat == "RGB" ? ColorFormat::RGB : ColorFormat::BGR);
+        }
+    }
+    if (info.u8Input) {
+        input.setPrecision(Precision::U8);
+    }
+    return resized;
+}
+
 Status ModelInstance::loadInputTensors(const ModelConfig& config, const DynamicModelParameter& parameter) {
     if (config.isShapeAnonymousFixed() && network->getInputsInfo().size() > 1) {
         Status status = StatusCode::ANONYMOUS_FIXED_SHAPE_NOT_ALLOWED;
@@ -73,6 +173,11 @@ Status ModelInstance::loadInputTensors(const ModelConfig& config, const DynamicM
             return StatusCode::CONFIG_SHAPE_IS_NOT_IN_NETWORK;
         }
     }
+    for (const auto& [name, preprocessing] : config.getPreprocessing()) {
+        if (networkInputs.count(name) == 0) {
+            SPDLOG_WARN("Preprocessing of input: {} not found in network will be ignored", name);
+        }
+    }
     this->inputsInfo.clear();
     for (const auto& pair : networkInputs) {
         const auto& name = pair.first;
@@ -84,15 +189,40 @@ Status ModelInstance::loadInputTensors(const ModelConfig& config, const DynamicM
         auto shape = input->getTensorDesc().getDims();
 
         // Data from config
+        std::string layoutName;
         if (config.getLayout().size()) {
             // Single layout for all inputs
-            layout = TensorInfo::getLayoutFromString(config.getLayout());
+            layoutName = config.getLayout();
         } else if (config.getLayouts().count(name)) {
             // Layout defined for specific input
-            layout = TensorInfo::getLayoutFromString(config.getLayouts().at(name));
+            layoutName = config.getLayouts().at(name);
+        }
+        bool layoutTransposed = false;
+        if (layoutName == NHWC_TO_NCHW_LAYOUT) {
+            if (shape.size() == 4) {
+                // Data is transposed by the server, network keeps NCHW layout
+                layout = InferenceEngine::Layout::NCHW;
+                layoutTransposed = true;
+            } else {
+                SPDLOG_WARN("Input: {} layout: {} requires 4 dimensional shape and will be ignored", name, NHWC_TO_NCHW_LAYOUT);
+            }
+        } else if (layoutName.size()) {
+            layout = TensorInfo::getLayoutFromString(layoutName);
         }
         input->setLayout(layout);
 
+        bool resized = false;
+        if (config.getPreprocessing().count(name)) {
+            resized = applyPreprocessing(name, *input, config.getPreprocessing().at(name), layoutTransposed);
+            precision = input->getPrecision();
+        }
+
+        if (config.getInputConversions().count(name) &&
+            !isPrecisionConversionSupported(config.getInputConversions().at(name), precision)) {
+            SPDLOG_WARN("Input: {} conversion from: {} to precision: {} is not supported and will be ignored",
+                name, config.getInputConversions().at(name), TensorInfo::getPrecisionAsString(precision));
+        }
+
         if (config.getBatchSize() > 0 || parameter.isBatchSizeRequested()) {
             // leave shape untouched
         } else if (config.isShapeAuto(name) && parameter.isShapeRequested(name)) {
@@ -112,6 +242,16 @@ Status ModelInstance::loadInputTensors(const ModelConfig& config, const DynamicM
 
         auto mappingName = config.getMappingInputByKey(name);
         auto tensor = std::make_shared<TensorInfo>(name, mappingName, precision, shape, layout);
+        tensor->setLayoutTransposed(layoutTransposed);
+        tensor->setResized(resized);
+        if (config.getImageInputs().count(name)) {
+            tensor->setImageColorOrder(config.getImageInputs().at(name) == "BGR" ? ImageColorOrder::BGR : ImageColorOrder::RGB);
+            if (!isImageInputSupported(*tensor)) {
+                SPDLOG_WARN("Input: {} with shape: {} and precision: {} cannot accept decoded images, image input configuration will be ignored",
+                    name, TensorInfo::shapeToString(shape), TensorInfo::getPrecisionAsString(precision));
+                tensor->setImageColorOrder(ImageColorOrder::NONE);
+            }
+        }
         std::string precision_str = tensor->getPrecisionAsString();
         this->inputsInfo[tensor->getMappedName()] = std::move(tensor);
         std::stringstream shape_stream;
@@ -137,9 +277,20 @@ Status ModelInstance::loadInputTensors(const ModelConfig& config, const DynamicM
     return StatusCode::OK;
 }
 
-void ModelInstance::loadOutputTensors(const ModelConfig& config) {
-    this->outputsInfo.clear();
-    for (const auto& pair : network->getOutputsInfo()) {
+namespace {
+OutputEncoding getOutputEncoding(const std::string& outputPrecision) {
+    if (outputPrecision == "FP16") {
+        return OutputEncoding::FP16;
+    }
+    if (outputPrecision == "BF16") {
+        return OutputEncoding::BF16;
+    }
+    return OutputEncoding::I8;
+}
+
+template <typename OutputsDataMap>
+Status fillOutputsInfo(const OutputsDataMap& networkOutputs, const ModelConfig& config, tensor_map_t& outputsInfo) {
+    for (const auto& pair : networkOutputs) {
         const auto& name = pair.first;
         auto output = pair.second;
 
@@ -149,13 +300,164 @@ void ModelInstance::loadOutputTensors(const ModelConfig& config) {
         auto shape = output->getDims();
         auto mappingName = config.getMappingOutputByKey(name);
         auto tensor = std::make_shared<TensorInfo>(name, mappingName, precision, shape, layout);
+        auto precisionIt = config.getOutputPrecisions().find(name);
+        if (precisionIt != config.getOutputPrecisions().end() && precisionIt->second != "FP32") {
+            const auto& outputPrecision = precisionIt->second;
+            if (precision == InferenceEngine::Precision::FP16 && outputPrecision == "FP16") {
+                tensor->setHalfPrecisionResponse(true);
+            } else if (precision == InferenceEngine::Precision::FP32) {
+                tensor->setOutputEncoding(getOutputEncoding(outputPrecision));
+            } else {
+                SPDLOG_WARN("Output: {} has precision: {}, {} output precision will be ignored",
+                    name, TensorInfo::getPrecisionAsString(precision), outputPrecision);
+            }
+        }
+        auto reductionIt = config.getOutputReductions().find(name);
+        if (reductionIt != config.getOutputReductions().end()) {
+            if ((precision == InferenceEngine::Precision::FP32 || precision == InferenceEngine::Precision::FP16) && !shape.empty()) {
+                tensor->setOutputReduction(reductionIt->second);
+            } else {
+                SPDLOG_WARN("Output: {} has precision: {} and {} dimensions, output reduction will be ignored",
+                    name, TensorInfo::getPrecisionAsString(precision), shape.size());
+            }
+        }
         std::string precision_str = tensor->getPrecisionAsString();
-        this->outputsInfo[tensor->getMappedName()] = std::move(tensor);
+        outputsInfo[tensor->getMappedName()] = std::move(tensor);
         std::stringstream shape_stream;
         std::copy(shape.begin(), shape.end(), std::ostream_iterator<size_t>(shape_stream, " "));
         SPDLOG_INFO("Output name: {} ; mapping name: {}; shape: {} ; precision: {}, layout:{}",
-            name, mappingName, shape_stream.str(), precision_str, TensorInfo::getStringFromLayout(output->getLayout()));
+            name, mappingName, shape_stream.str(), precision_str, TensorInfo::getStringFromLayout(layout));
+    }
+    // indices of top_k reduction and quantization parameters of I8 encoding are sent in additional outputs,
+    // they cannot replace another output of the model
+    for (const auto& [mappedName, tensor] : outputsInfo) {
+        if (tensor->getOutputReduction().type == OutputReductionType::TOP_K && outputsInfo.count(mappedName + "_indices")) {
+            SPDLOG_ERROR("Output: {} has top_k reduction, its indices output name: {}_indices is already used by the model", mappedName, mappedName);
+            return StatusCode::OUTPUT_REDUCTION_NAME_COLLISION;
+        }
+        if (tensor->isQuantized() && !tensor->isReduced()) {
+            for (const char* suffix : {"_scale", "_zero_point"}) {
+                if (outputsInfo.count(mappedName + suffix)) {
+                    SPDLOG_ERROR("Output: {} is encoded as I8, its quantization output name: {}{} is already used by the model", mappedName, mappedName, suffix);
+                    return StatusCode::OUTPUT_QUANTIZATION_NAME_COLLISION;
+                }
+            }
+        }
+    }
+    return StatusCode::OK;
+}
+
+/**
+ * @brief Reads precompiled blob kept in memory by ImportNetwork without copying it into a string stream.
+ * Seeking is supported since import rewinds the stream after checking its header.
+ */
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    MemoryStreamBuffer(const uint8_t* data, size_t size) {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override {
+        char* position = direction == std::ios_base::beg ? eback() : (direction == std::ios_base::cur ? gptr() : egptr());
+        if (!(which & std::ios_base::in) || offset < eback() - position || offset > egptr() - position) {
+            return pos_type(off_type(-1));
+        }
+        position += offset;
+        setg(eback(), position, egptr());
+        return pos_type(position - eback());
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override {
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+};
+
+/**
+ * @brief Limits CPU plugin threads to CPU quota of the container. Plugin sizes its thread pools by cpus
+ * in the affinity mask only, which makes streams oversubscribe quota smaller than the cpuset.
+ */
+void limitCpuThreadsToContainer(const ModelConfig& config, plugin_config_t& pluginConfig) {
+    if (!config.isDeviceUsed("CPU") || pluginConfig.count("CPU_THREADS_NUM") > 0) {
+        return;
+    }
+    const uint32_t effectiveCpus = getEffectiveCpuCount();
+    if (effectiveCpus < getAllowedCpus().size()) {
+        pluginConfig["CPU_THREADS_NUM"] = std::to_string(effectiveCpus);
+    }
+}
+
+/**
+ * @brief Streams threads inherit affinity of the loading thread, plugin must not bind them to other cores
+ */
+void limitCpuThreadsToPinnedCpus(const cpu_list_t& cpus, plugin_config_t& pluginConfig) {
+    if (pluginConfig.count("CPU_BIND_THREAD") == 0) {
+        pluginConfig["CPU_BIND_THREAD"] = "NO";
+    }
+    if (pluginConfig.count("CPU_THREADS_NUM") == 0) {
+        pluginConfig["CPU_THREADS_NUM"] = std::to_string(std::min<size_t>(cpus.size(), getEffectiveCpuCount()));
+    }
+}
+}  // namespace
+
+Status ModelInstance::loadOutputTensors(const ModelConfig& config) {
+    this->outputsInfo.clear();
+    return fillOutputsInfo(network->getOutputsInfo(), config, this->outputsInfo);
+}
+
+Status ModelInstance::loadImportedTensors(const ModelConfig& config) {
+    const auto networkInputs = execNetwork->GetInputsInfo();
+    if (config.isShapeAnonymousFixed() && networkInputs.size() > 1) {
+        Status status = StatusCode::ANONYMOUS_FIXED_SHAPE_NOT_ALLOWED;
+        SPDLOG_WARN(status.string());
+        return status;
+    }
+    if (config.getBatchSize() > 0 || config.getBatchingMode() != FIXED || !config.getShapes().empty()) {
+        SPDLOG_WARN("Model: {} version: {} is imported from precompiled blob, configured batch size and shapes are ignored", getName(), getVersion());
+    }
+    this->inputsInfo.clear();
+    importedBatchSize = 0;
+    for (const auto& pair : networkInputs) {
+        const auto& name = pair.first;
+        const auto& input = pair.second;
+        auto precision = input->getPrecision();
+        auto layout = input->getLayout();
+        const auto shape = input->getTensorDesc().getDims();
+        bool layoutTransposed = false;
+        const std::string layoutName = config.getLayout().size() ? config.getLayout() : (config.getLayouts().count(name) ? config.getLayouts().at(name) : "");
+        if (layoutName == NHWC_TO_NCHW_LAYOUT && shape.size() == 4 && layout == InferenceEngine::Layout::NCHW) {
+            // network layout is compiled into the blob, only transposition by the server can be applied
+            layoutTransposed = true;
+        } else if (layoutName.size()) {
+            SPDLOG_WARN("Input: {} layout: {} cannot be applied to network imported from precompiled blob and will be ignored", name, layoutName);
+        }
+        if (config.getPreprocessing().count(name)) {
+            SPDLOG_WARN("Input: {} preprocessing cannot be applied to network imported from precompiled blob and will be ignored", name);
+        }
+        if (importedBatchSize == 0 && !shape.empty()) {
+            importedBatchSize = shape[0];
+        }
+        auto mappingName = config.getMappingInputByKey(name);
+        auto tensor = std::make_shared<TensorInfo>(name, mappingName, precision, shape, layout);
+        tensor->setLayoutTransposed(layoutTransposed);
+        if (config.getImageInputs().count(name)) {
+            tensor->setImageColorOrder(config.getImageInputs().at(name) == "BGR" ? ImageColorOrder::BGR : ImageColorOrder::RGB);
+            if (!isImageInputSupported(*tensor)) {
+                SPDLOG_WARN("Input: {} with shape: {} and precision: {} cannot accept decoded images, image input configuration will be ignored",
+                    name, TensorInfo::shapeToString(shape), TensorInfo::getPrecisionAsString(precision));
+                tensor->setImageColorOrder(ImageColorOrder::NONE);
+            }
+        }
+        SPDLOG_INFO("Input name: {}; mapping_name: {}; shape: {}; precision: {}, layout:{}",
+            name, mappingName, TensorInfo::shapeToString(shape), tensor->getPrecisionAsString(), TensorInfo::getStringFromLayout(layout));
+        this->inputsInfo[tensor->getMappedName()] = std::move(tensor);
+    }
+    if (importedBatchSize == 0) {
+        importedBatchSize = 1;
     }
+    this->outputsInfo.clear();
+    return fillOutputsInfo(execNetwork->GetOutputsInfo(), config, this->outputsInfo);
 }
 
 // Temporary methods. To be replaces with proper storage class.
@@ -215,6 +517,13 @@ uint ModelInstance::getNumOfParallelInferRequestsUnbounded(const ModelConfig& mo
         // nireq is set globally for all models in ovms startup parameters
         return ovmsConfig.nireq();
     }
+    if (tuning.nireq > 0) {
+        return tuning.nireq;
+    }
+    if (rebalancedStreams > 0) {
+        // one infer request per stream keeps all of them busy without queueing inside the plugin
+        return rebalancedStreams;
+    }
     std::string key = METRIC_KEY(OPTIMAL_NUMBER_OF_INFER_REQUESTS);
     try {
         numberOfParallelInferRequests = execNetwork->GetMetric(key).as<unsigned int>();
@@ -222,6 +531,11 @@ uint ModelInstance::getNumOfParallelInferRequestsUnbounded(const ModelConfig& mo
         SPDLOG_WARN("Failed to query OPTIMAL_NUMBER_OF_INFER_REQUESTS with error {}. Using 1 nireq.", ex.what());
         numberOfParallelInferRequests = 1u;
     }
+    // more CPU infer requests than cpus available to the container only queue up inside the plugin
+    if (modelConfig.getTargetDevice() == "CPU" && numberOfParallelInferRequests > getEffectiveCpuCount()) {
+        SPDLOG_DEBUG("Limiting nireq of model: {} from {} to available CPU count: {}", getName(), numberOfParallelInferRequests, getEffectiveCpuCount());
+        numberOfParallelInferRequests = getEffectiveCpuCount();
+    }
     return numberOfParallelInferRequests;
 }
 
@@ -237,8 +551,16 @@ uint ModelInstance::getNumOfParallelInferRequests(const ModelConfig& modelConfig
     return nireq;
 }
 
-void ModelInstance::loadOVEngine() {
-    engine = std::make_unique<InferenceEngine::Core>();
+std::shared_ptr<InferenceEngine::Core> ModelInstance::getSharedEngine() {
+    static std::mutex sharedEngineMutex;
+    static std::weak_ptr<InferenceEngine::Core> sharedEngine;
+    std::lock_guard<std::mutex> lock(sharedEngineMutex);
+    auto engine = sharedEngine.lock();
+    if (engine) {
+        return engine;
+    }
+    SPDLOG_DEBUG("Creating inference engine core shared by models");
+    engine = std::make_shared<InferenceEngine::Core>();
     if (ovms::Config::instance().cpuExtensionLibraryPath() != "") {
         SPDLOG_INFO("Loading custom CPU extension from {}", ovms::Config::instance().cpuExtensionLibraryPath());
         try {
@@ -254,16 +576,133 @@ void ModelInstance::loadOVEngine() {
             throw;
         }
     }
+    sharedEngine = engine;
+    return engine;
+}
+
+void ModelInstance::loadOVEngine() {
+    engine = getSharedEngine();
 }
 
 std::unique_ptr<InferenceEngine::CNNNetwork> ModelInstance::loadOVCNNNetworkPtr(const std::string& modelFile) {
     return std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(modelFile));
 }
 
+Status ModelInstance::loadOVCNNNetworkWithMappedWeights(const std::string& modelFile, const std::string& weightsFile) {
+    std::shared_ptr<MappedFile> mapped;
+    auto status = MappedFile::map(weightsFile, mapped);
+    if (!status.ok()) {
+        return status;
+    }
+    std::ifstream file(modelFile);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Cannot open model file: {}", modelFile);
+        return StatusCode::FILE_INVALID;
+    }
+    const std::string model((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    // blob only points to the mapping, constants of the network are read from it without a copy
+    auto weights = make_shared_blob<uint8_t>({Precision::U8, {mapped->size()}, C}, const_cast<uint8_t*>(mapped->data()), mapped->size());
+    network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(model, weights));
+    mappedWeights = mapped;
+    return StatusCode::OK;
+}
+
+Status ModelInstance::loadOVCNNNetworkWithSharedWeights(const std::string& modelFile, const std::string& weightsFile) {
+    std::shared_ptr<const WeightsBuffer> shared;
+    auto status = WeightsRegistry::instance().acquire(weightsFile, ovms::Config::instance().mmapModelWeights(), shared);
+    if (!status.ok()) {
+        return status;
+    }
+    std::ifstream file(modelFile);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Cannot open model file: {}", modelFile);
+        return StatusCode::FILE_INVALID;
+    }
+    const std::string model((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    // constants of every network reading the buffer point into it, it is released with the last of them
+    auto weights = make_shared_blob<uint8_t>({Precision::U8, {shared->size}, C}, const_cast<uint8_t*>(shared->data), shared->size);
+    network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(model, weights));
+    mappedWeights = shared;
+    return StatusCode::OK;
+}
+
+Status ModelInstance::loadOVCNNNetworkConvertedFromOnnx(const std::string& modelFile) {
+    CompiledNetworkCache cache(ovms::Config::instance().compiledNetworkCacheDir());
+    if (cache.isEnabled() && modelFilesHash.empty()) {
+        modelFilesHash = CompiledNetworkCache::hashFiles(modelFiles);
+    }
+    const std::string key = cache.isEnabled() && !modelFilesHash.empty() ? CompiledNetworkCache::computeConvertedNetworkKey(modelFilesHash) : "";
+    if (!key.empty() && cache.hasConvertedNetwork(key)) {
+        std::string xmlPath, binPath;
+        cache.getConvertedNetworkPaths(key, xmlPath, binPath);
+        try {
+            if (ovms::Config::instance().deduplicateModelWeights() || ovms::Config::instance().mmapModelWeights()) {
+                auto status = ovms::Config::instance().deduplicateModelWeights() ? loadOVCNNNetworkWithSharedWeights(xmlPath, binPath) : loadOVCNNNetworkWithMappedWeights(xmlPath, binPath);
+                if (status.ok()) {
+                    SPDLOG_DEBUG("Read network converted from ONNX: {} for model: {} version: {}", xmlPath, getName(), getVersion());
+                    return status;
+                }
+            } else {
+                network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(xmlPath, binPath));
+                SPDLOG_DEBUG("Read network converted from ONNX: {} for model: {} version: {}", xmlPath, getName(), getVersion());
+                return StatusCode::OK;
+            }
+        } catch (const std::exception& e) {
+            SPDLOG_WARN("Cannot read network converted from ONNX: {}; error: {}; ONNX model will be converted again", xmlPath, e.what());
+        }
+        cache.removeConvertedNetwork(key);
+    }
+    network = loadOVCNNNetworkPtr(modelFile);
+    if (!key.empty()) {
+        // stored before the network is reshaped, so that it is reused for any shape
+        cache.storeConvertedNetwork(key, *network);
+    }
+    return StatusCode::OK;
+}
+
+Status ModelInstance::loadOVCNNNetworkFromMemory() {
+    const auto& model = *modelContents[0];
+    if (modelContents.size() == OV_MODEL_FILES_EXTENSIONS.size() && ovms::Config::instance().deduplicateModelWeights()) {
+        auto fetched = std::make_shared<WeightsBuffer>();
+        fetched->data = reinterpret_cast<const uint8_t*>(modelContents[1]->data());
+        fetched->size = modelContents[1]->size();
+        fetched->owner = modelContents[1];
+        auto shared = WeightsRegistry::instance().share(std::move(fetched));
+        network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(model,
+            make_shared_blob<uint8_t>({Precision::U8, {shared->size}, C}, const_cast<uint8_t*>(shared->data), shared->size)));
+        mappedWeights = shared;
+    } else if (modelContents.size() == OV_MODEL_FILES_EXTENSIONS.size()) {
+        auto weights = modelContents[1];
+        // blob only points to the fetched buffer, which is kept alive together with the network
+        network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(model,
+            make_shared_blob<uint8_t>({Precision::U8, {weights->size()}, C}, reinterpret_cast<uint8_t*>(const_cast<char*>(weights->data())), weights->size())));
+        mappedWeights = weights;
+    } else {
+        network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(model, InferenceEngine::Blob::CPtr()));
+    }
+    modelContents.clear();
+    return StatusCode::OK;
+}
+
 Status ModelInstance::loadOVCNNNetwork() {
     auto& modelFile = modelFiles[0];
     SPDLOG_DEBUG("Try reading model file: {}", modelFile);
     try {
+        mappedWeights.reset();
+        if (!modelContents.empty()) {
+            return loadOVCNNNetworkFromMemory();
+        }
+        const bool irModel = modelFiles.size() == OV_MODEL_FILES_EXTENSIONS.size() && endsWith(modelFile, OV_MODEL_FILES_EXTENSIONS[0]);
+        if (irModel && ovms::Config::instance().deduplicateModelWeights()) {
+            return loadOVCNNNetworkWithSharedWeights(modelFile, modelFiles[1]);
+        }
+        if (irModel && ovms::Config::instance().mmapModelWeights()) {
+            return loadOVCNNNetworkWithMappedWeights(modelFile, modelFiles[1]);
+        }
+        const bool onnxModel = modelFiles.size() == ONNX_MODEL_FILES_EXTENSIONS.size() && endsWith(modelFile, ONNX_MODEL_FILES_EXTENSIONS[0]);
+        if (onnxModel && ovms::Config::instance().convertOnnxModels()) {
+            return loadOVCNNNetworkConvertedFromOnnx(modelFile);
+        }
         network = loadOVCNNNetworkPtr(modelFile);
     } catch (std::exception& e) {
         SPDLOG_ERROR("Error: {}; occurred during loading CNNNetwork for model: {} version: {}", e.what(), getName(), getVersion());
@@ -277,6 +716,11 @@ Status ModelInstance::loadOVCNNNetworkUsingCustomLoader() {
     try {
         std::vector<uint8_t> model;
         std::vector<uint8_t> weights;
+        std::shared_ptr<const uint8_t> sharedWeights;
+        size_t sharedWeightsSize = 0;
+        mappedWeights.reset();
+        importedNetworkBlob.reset();
+        importedNetworkBlobSize = 0;
 
         SPDLOG_INFO("loading CNNNetwork for model: {} basepath: {} <> {} version: {}", getName(), getPath(), this->config.getBasePath().c_str(), getVersion());
 
@@ -290,24 +734,135 @@ Status ModelInstance::loadOVCNNNetworkUsingCustomLoader() {
             throw std::invalid_argument("customloader not exisiting");
         }
 
-        CustomLoaderStatus res = customLoaderInterfacePtr->loadModel(this->config.getName(),
-            this->config.getBasePath(),
-            getVersion(),
-            this->config.getCustomLoaderOptionsConfigStr(), model, weights);
+        // calls of SERIALIZED loaders for other models wait until this one returns
+        auto callLock = customloaders.lockForCall(customLoaderInterfacePtr);
+        CustomLoaderStatus res = CustomLoaderStatus::NOT_IMPLEMENTED;
+        if (customLoaderInterfacePtr->getInterfaceVersion() >= CUSTOM_LOADER_INTERFACE_VERSION_2) {
+            CustomLoaderBuffer modelBuffer;
+            CustomLoaderBuffer weightsBuffer;
+            // outlives the wait, callback of abandoned load only releases the buffers
+            struct AsyncLoad {
+                std::mutex mtx;
+                std::condition_variable loadedNotify;
+                bool loaded = false;
+                bool abandoned = false;
+                CustomLoaderStatus status = CustomLoaderStatus::INTERNAL_ERROR;
+                CustomLoaderBuffer model;
+                CustomLoaderBuffer weights;
+            };
+            auto asyncLoad = std::make_shared<AsyncLoad>();
+            res = customLoaderInterfacePtr->loadModelBuffersAsync(this->config.getName(),
+                this->config.getBasePath(),
+                getVersion(),
+                this->config.getCustomLoaderOptionsConfigStr(),
+                [asyncLoad](CustomLoaderStatus status, CustomLoaderBuffer model, CustomLoaderBuffer weights) {
+                    std::unique_lock<std::mutex> lock(asyncLoad->mtx);
+                    if (asyncLoad->abandoned) {
+                        lock.unlock();
+                        for (auto* buffer : {&model, &weights}) {
+                            if (buffer->release) {
+                                buffer->release();
+                            }
+                        }
+                        return;
+                    }
+                    asyncLoad->status = status;
+                    asyncLoad->model = std::move(model);
+                    asyncLoad->weights = std::move(weights);
+                    asyncLoad->loaded = true;
+                    asyncLoad->loadedNotify.notify_all();
+                });
+            if (res == CustomLoaderStatus::OK) {
+                // other loads through the loader are started while this one is waited for
+                if (callLock.owns_lock()) {
+                    callLock.unlock();
+                }
+                const auto timeout = getCustomLoaderLoadTimeout(customLoaderOptionsConfig);
+                std::unique_lock<std::mutex> lock(asyncLoad->mtx);
+                if (asyncLoad->loadedNotify.wait_for(lock, timeout, [&asyncLoad]() { return asyncLoad->loaded; })) {
+                    res = asyncLoad->status;
+                    modelBuffer = std::move(asyncLoad->model);
+                    weightsBuffer = std::move(asyncLoad->weights);
+                } else {
+                    asyncLoad->abandoned = true;
+                    SPDLOG_ERROR("Loader: {} did not load model: {} version: {} within {} ms", loaderName, getName(), getVersion(), timeout.count());
+                    res = CustomLoaderStatus::INTERNAL_ERROR;
+                }
+            } else if (res == CustomLoaderStatus::NOT_IMPLEMENTED) {
+                res = customLoaderInterfacePtr->loadModelBuffers(this->config.getName(),
+                    this->config.getBasePath(),
+                    getVersion(),
+                    this->config.getCustomLoaderOptionsConfigStr(), modelBuffer, weightsBuffer);
+            }
+            if (res != CustomLoaderStatus::NOT_IMPLEMENTED && callLock.owns_lock()) {
+                callLock.unlock();
+            }
+            // buffers are released by the loader once the last reference is dropped, also on errors
+            auto takeBuffer = [](CustomLoaderBuffer& buffer) {
+                return std::shared_ptr<const uint8_t>(buffer.data, [release = std::move(buffer.release)](const uint8_t*) {
+                    if (release) {
+                        release();
+                    }
+                });
+            };
+            auto ownedModel = takeBuffer(modelBuffer);
+            auto ownedWeights = takeBuffer(weightsBuffer);
+            if (res == CustomLoaderStatus::MODEL_TYPE_IR || res == CustomLoaderStatus::MODEL_TYPE_ONNX) {
+                const std::string strModel(reinterpret_cast<const char*>(ownedModel.get()), modelBuffer.size);
+                ownedModel.reset();
+                if (res == CustomLoaderStatus::MODEL_TYPE_IR) {
+                    network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(strModel,
+                        make_shared_blob<uint8_t>({Precision::U8, {weightsBuffer.size}, C}, const_cast<uint8_t*>(ownedWeights.get()), weightsBuffer.size)));
+                    mappedWeights = ownedWeights;
+                } else {
+                    network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(strModel, InferenceEngine::Blob::CPtr()));
+                }
+                return StatusCode::OK;
+            } else if (res == CustomLoaderStatus::MODEL_TYPE_BLOB) {
+                importedNetworkBlob = ownedModel;
+                importedNetworkBlobSize = modelBuffer.size;
+                return StatusCode::OK;
+            }
+        }
+        if (res == CustomLoaderStatus::NOT_IMPLEMENTED) {
+            res = customLoaderInterfacePtr->loadModelWithSharedWeights(this->config.getName(),
+                this->config.getBasePath(),
+                getVersion(),
+                this->config.getCustomLoaderOptionsConfigStr(), model, sharedWeights, sharedWeightsSize);
+        }
+        if (res == CustomLoaderStatus::NOT_IMPLEMENTED) {
+            res = customLoaderInterfacePtr->loadModel(this->config.getName(),
+                this->config.getBasePath(),
+                getVersion(),
+                this->config.getCustomLoaderOptionsConfigStr(), model, weights);
+        }
+        if (callLock.owns_lock()) {
+            callLock.unlock();
+        }
 
         if ((res == CustomLoaderStatus::MODEL_LOAD_ERROR) || (res == CustomLoaderStatus::INTERNAL_ERROR)) {
             return StatusCode::INTERNAL_ERROR;
         }
 
+        if (res == CustomLoaderStatus::MODEL_TYPE_BLOB) {
+            // precompiled network is imported by loadOVExecutableNetwork, there is no CNNNetwork to read
+            auto blob = std::make_shared<std::vector<uint8_t>>(std::move(model));
+            importedNetworkBlob = std::shared_ptr<const uint8_t>(blob, blob->data());
+            importedNetworkBlobSize = blob->size();
+            return StatusCode::OK;
+        }
+
         std::string strModel(model.begin(), model.end());
 
-        if (res == CustomLoaderStatus::MODEL_TYPE_IR) {
+        if (res == CustomLoaderStatus::MODEL_TYPE_IR && sharedWeights) {
+            network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(strModel,
+                make_shared_blob<uint8_t>({Precision::U8, {sharedWeightsSize}, C}, const_cast<uint8_t*>(sharedWeights.get()), sharedWeightsSize)));
+            mappedWeights = sharedWeights;
+        } else if (res == CustomLoaderStatus::MODEL_TYPE_IR) {
             network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(strModel,
                 make_shared_blob<uint8_t>({Precision::U8, {weights.size()}, C}, weights.data())));
         } else if (res == CustomLoaderStatus::MODEL_TYPE_ONNX) {
             network = std::make_unique<InferenceEngine::CNNNetwork>(engine->ReadNetwork(strModel, InferenceEngine::Blob::CPtr()));
-        } else if (res == CustomLoaderStatus::MODEL_TYPE_BLOB) {
-            return StatusCode::INTERNAL_ERROR;
         }
     } catch (std::exception& e) {
         SPDLOG_ERROR("Error: {}; occurred during loading CNNNetwork for model: {} version: {}", e.what(), getName(), getVersion());
@@ -317,7 +872,37 @@ Status ModelInstance::loadOVCNNNetworkUsingCustomLoader() {
 }
 
 void ModelInstance::loadExecutableNetworkPtr(const plugin_config_t& pluginConfig) {
-    execNetwork = std::make_shared<InferenceEngine::ExecutableNetwork>(engine->LoadNetwork(*network, targetDevice, pluginConfig));
+    execNetwork = compileExecutableNetwork(targetDevice, pluginConfig);
+}
+
+std::shared_ptr<InferenceEngine::ExecutableNetwork> ModelInstance::compileExecutableNetwork(const std::string& device, const plugin_config_t& pluginConfig) {
+    if (importedNetworkBlob) {
+        MemoryStreamBuffer blobBuffer(importedNetworkBlob.get(), importedNetworkBlobSize);
+        std::istream blobStream(&blobBuffer);
+        return std::make_shared<InferenceEngine::ExecutableNetwork>(engine->ImportNetwork(blobStream, device, pluginConfig));
+    }
+    CompiledNetworkCache cache(ovms::Config::instance().compiledNetworkCacheDir());
+    std::string key;
+    // networks of custom loaders are not read from model files, so their key would not identify them
+    if (cache.isEnabled() && !this->config.isCustomLoaderRequiredToLoadModel()) {
+        if (modelFilesHash.empty()) {
+            modelFilesHash = CompiledNetworkCache::hashFiles(modelFiles);
+        }
+        if (!modelFilesHash.empty()) {
+            key = CompiledNetworkCache::computeKey(modelFilesHash, device, pluginConfig, CompiledNetworkCache::describeNetwork(*network));
+        }
+    }
+    if (!key.empty()) {
+        InferenceEngine::ExecutableNetwork imported;
+        if (cache.tryImport(*engine, key, device, pluginConfig, imported)) {
+            return std::make_shared<InferenceEngine::ExecutableNetwork>(std::move(imported));
+        }
+    }
+    auto compiled = std::make_shared<InferenceEngine::ExecutableNetwork>(engine->LoadNetwork(*network, device, pluginConfig));
+    if (!key.empty()) {
+        cache.store(key, *compiled);
+    }
+    return compiled;
 }
 
 plugin_config_t ModelInstance::prepareDefaultPluginConfig(const ModelConfig& config) {
@@ -336,10 +921,357 @@ plugin_config_t ModelInstance::prepareDefaultPluginConfig(const ModelConfig& con
     return pluginConfig;
 }
 
+void ModelInstance::loadNumaReplicasExecutableNetworks(const std::map<int, cpu_list_t>& numaNodes, plugin_config_t& pluginConfig) {
+    // Streams threads inherit affinity of the loading thread, plugin must not bind them to other cores
+    if (pluginConfig.count("CPU_BIND_THREAD") == 0) {
+        pluginConfig["CPU_BIND_THREAD"] = "NO";
+    }
+    std::shared_ptr<InferenceEngine::ExecutableNetwork> primaryExecNetwork;
+    for (const auto& [numaNode, cpus] : numaNodes) {
+        runPinnedToCpus(cpus, [this, &pluginConfig]() { loadExecutableNetworkPtr(pluginConfig); });
+        SPDLOG_INFO("Loaded model: {}; version: {}; replica on NUMA node: {}", getName(), getVersion(), numaNode);
+        if (!primaryExecNetwork) {
+            primaryExecNetwork = execNetwork;
+            primaryCpus = cpus;
+            continue;
+        }
+        Replica replica;
+        replica.numaNode = numaNode;
+        replica.cpus = cpus;
+        replica.execNetwork = execNetwork;
+        replicas.push_back(std::move(replica));
+    }
+    execNetwork = primaryExecNetwork;
+}
+
+plugin_config_t ModelInstance::prepareReplicaPluginConfig(const ModelConfig& config, const std::string& device) {
+    static const std::vector<std::string> devicePrefixes{"CPU_", "GPU_", "MYRIAD_", "HDDL_", "GNA_"};
+    plugin_config_t pluginConfig;
+    for (const auto& [key, value] : config.getPluginConfig()) {
+        const bool otherDeviceKey = std::any_of(devicePrefixes.begin(), devicePrefixes.end(), [&key, &device](const std::string& prefix) {
+            return key.rfind(prefix, 0) == 0 && device.find(prefix.substr(0, prefix.size() - 1)) == std::string::npos;
+        });
+        if (!otherDeviceKey) {
+            pluginConfig[key] = value;
+        }
+    }
+    if (device.find("CPU") != std::string::npos && pluginConfig.count("CPU_THROUGHPUT_STREAMS") == 0) {
+        pluginConfig["CPU_THROUGHPUT_STREAMS"] = "CPU_THROUGHPUT_AUTO";
+    }
+    if (device.find("GPU") != std::string::npos && pluginConfig.count("GPU_THROUGHPUT_STREAMS") == 0) {
+        pluginConfig["GPU_THROUGHPUT_STREAMS"] = "GPU_THROUGHPUT_AUTO";
+    }
+    return pluginConfig;
+}
+
+void ModelInstance::loadDeviceReplicasExecutableNetworks(const ModelConfig& config) {
+    for (const auto& device : config.getReplicaDevices()) {
+        Replica replica;
+        replica.device = device;
+        replica.execNetwork = compileExecutableNetwork(device, prepareReplicaPluginConfig(config, device));
+        SPDLOG_INFO("Loaded model: {}; version: {}; replica on device: {}", getName(), getVersion(), device);
+        replicas.push_back(std::move(replica));
+    }
+    routedReplicas = true;
+}
+
+void ModelInstance::loadTargetDeviceReplicasExecutableNetworks(uint32_t replicasCount, const cpu_list_t& cpus, const plugin_config_t& pluginConfig) {
+    // on CPU each replica gets its own group of cpus so their streams do not compete for cores
+    std::vector<cpu_list_t> cpuGroups;
+    if (targetDevice == "CPU") {
+        cpuGroups = splitCpuList(cpus.empty() ? getAllowedCpus() : cpus, replicasCount);
+        if (!cpuGroups.empty() && cpuGroups.size() < replicasCount) {
+            SPDLOG_WARN("Model: {} has more replicas: {} than cpus available. Loading {} replicas.", getName(), replicasCount, cpuGroups.size());
+        }
+    }
+    const size_t loadedReplicasCount = cpuGroups.empty() ? replicasCount : cpuGroups.size();
+    std::shared_ptr<InferenceEngine::ExecutableNetwork> primaryExecNetwork;
+    for (size_t i = 0; i < loadedReplicasCount; i++) {
+        cpu_list_t replicaCpus;
+        if (cpuGroups.empty()) {
+            loadExecutableNetworkPtr(pluginConfig);
+        } else {
+            replicaCpus = cpuGroups[i];
+            plugin_config_t replicaPluginConfig = pluginConfig;
+            loadPinnedExecutableNetwork(replicaCpus, replicaPluginConfig);
+        }
+        SPDLOG_INFO("Loaded model: {}; version: {}; replica: {} on device: {}", getName(), getVersion(), i, targetDevice);
+        if (!primaryExecNetwork) {
+            primaryExecNetwork = execNetwork;
+            continue;
+        }
+        Replica replica;
+        replica.device = targetDevice;
+        replica.cpus = replicaCpus;
+        replica.execNetwork = execNetwork;
+        replicas.push_back(std::move(replica));
+    }
+    execNetwork = primaryExecNetwork;
+    primaryCpus = cpuGroups.empty() ? cpu_list_t() : cpuGroups.front();
+    routedReplicas = true;
+}
+
+bool ModelInstance::isStreamsRebalancingSupported(const ModelConfig& config) const {
+    return StreamsBudget::instance().isEnabled() &&
+           config.getTargetDevice() == "CPU" &&
+           config.getPluginConfig().count(CPU_THROUGHPUT_STREAMS) == 0 &&
+           config.getNireq() == 0 &&
+           ovms::Config::instance().nireq() == 0 &&
+           !config.isAutoTuningEnabled() &&
+           !config.isStateful() &&
+           !config.isLazyLoadingEnabled() &&
+           !config.isNumaReplicasEnabled() &&
+           config.getReplicaDevices().empty() &&
+           config.getReplicasCount() <= 1 &&
+           !config.isCustomLoaderRequiredToLoadModel();
+}
+
+bool ModelInstance::getStreamsLoad(ModelStreamsLoad& load) {
+    std::unique_lock<std::recursive_mutex> loadingLock(loadingMutex, std::try_to_lock);
+    if (!loadingLock.owns_lock() || getStatus().getState() != ModelVersionState::AVAILABLE || !inferRequestsQueue || rebalancedStreams == 0) {
+        return false;
+    }
+    load.name = getName();
+    load.version = getVersion();
+    load.streams = rebalancedStreams;
+    load.streamHoldMicroseconds = inferRequestsQueue->getTotalStreamHoldMicroseconds();
+    load.waitingRequests = inferRequestsQueue->getWaitersCount();
+    return true;
+}
+
+Status ModelInstance::rebalanceStreams(uint32_t streams) {
+    ModelConfig config;
+    {
+        std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+        config = this->config;
+    }
+    // network is compiled without loading lock, requests are served by the current one meanwhile
+    auto staged = std::make_shared<ModelInstance>(getName(), getVersion());
+    staged->metrics = metrics;
+    staged->rebalancedStreams = streams;
+    SPDLOG_INFO("Model: {} version: {} compiling network with {} streams", getName(), getVersion(), streams);
+    auto status = staged->loadModel(config);
+    if (!status.ok()) {
+        SPDLOG_WARN("Model: {} version: {} failed to compile network with {} streams; {}", getName(), getVersion(), streams, status.string());
+        staged->unloadModel();
+        return status;
+    }
+    std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+    // version reloaded with new configuration or shape meanwhile is rebalanced again in the next cycle
+    if (this->status.getState() != ModelVersionState::AVAILABLE || rebalancedStreams == 0 || this->config.isReloadRequired(config)) {
+        SPDLOG_DEBUG("Model: {} version: {} changed while compiling network with {} streams, it is dropped", getName(), getVersion(), streams);
+        return StatusCode::OK;
+    }
+    stagedRebalance = staged;
+    const auto previousStreams = rebalancedStreams;
+    rebalancedStreams = streams;
+    status = reloadModel(config);
+    stagedRebalance.reset();
+    if (!status.ok()) {
+        rebalancedStreams = previousStreams;
+        return this->recoverFromReloadingError(status);
+    }
+    SPDLOG_INFO("Model: {} version: {} streams rebalanced from {} to {}", getName(), getVersion(), previousStreams, streams);
+    return status;
+}
+
+Status ModelInstance::resizeInferRequestsQueues(uint32_t nireq) {
+    if (!inferRequestsQueue || nireq == 0 || nireq > inferRequestsQueue->getCapacity()) {
+        const size_t capacity = inferRequestsQueue ? inferRequestsQueue->getCapacity() : 0;
+        return Status(StatusCode::INVALID_NIREQ, "nireq has to be between 1 and " + std::to_string(capacity));
+    }
+    inferRequestsQueue->resize(nireq);
+    for (auto& replica : replicas) {
+        replica.inferRequestsQueue->resize(nireq);
+    }
+    return StatusCode::OK;
+}
+
+Status ModelInstance::resizeInferRequests(uint32_t nireq, uint32_t& appliedNireq) {
+    std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+    if (!isServable()) {
+        return StatusCode::MODEL_VERSION_NOT_LOADED_YET;
+    }
+    if (config.isStateful()) {
+        // retiring infer request would drop memory states of sequences kept in it
+        return Status(StatusCode::NIREQ_RESIZE_NOT_SUPPORTED, "model is stateful");
+    }
+    auto status = resizeInferRequestsQueues(nireq);
+    if (!status.ok()) {
+        return status;
+    }
+    appliedNireq = inferRequestsQueue->getStreamsLimit();
+    SPDLOG_INFO("Model: {} version: {} infer requests queue resized to {}", getName(), getVersion(), appliedNireq);
+    return status;
+}
+
+void ModelInstance::autoscaleInferRequests() {
+    const uint32_t waitThresholdMs = config.getNireqAutoscalingWaitMs();
+    if (waitThresholdMs == 0 || config.isStateful()) {
+        return;
+    }
+    std::unique_lock<std::recursive_mutex> loadingLock(loadingMutex, std::try_to_lock);
+    if (!loadingLock.owns_lock() || !isServable() || !inferRequestsQueue) {
+        return;
+    }
+    auto& queue = *inferRequestsQueue;
+    InferRequestsAutoscalingSample sample;
+    sample.valid = true;
+    sample.time = std::chrono::steady_clock::now();
+    sample.waits = queue.getWaitsCount();
+    sample.waitMicroseconds = queue.getTotalWaitMicroseconds();
+    sample.streamHoldMicroseconds = queue.getTotalStreamHoldMicroseconds();
+    const auto last = autoscalingSample;
+    autoscalingSample = sample;
+    if (!last.valid || sample.time <= last.time) {
+        return;
+    }
+    const uint64_t waits = sample.waits - last.waits;
+    const uint64_t averageWaitMicroseconds = waits > 0 ? (sample.waitMicroseconds - last.waitMicroseconds) / waits : 0;
+    const size_t streams = queue.getStreamsLimit();
+    const double elapsedMicroseconds = std::chrono::duration<double, std::micro>(sample.time - last.time).count();
+    const double utilization = (sample.streamHoldMicroseconds - last.streamHoldMicroseconds) / (elapsedMicroseconds * streams);
+    size_t target = streams;
+    if (averageWaitMicroseconds > waitThresholdMs * 1000ull) {
+        target = std::min(queue.getCapacity(), streams + std::max<size_t>(1, streams / 4));
+    } else if (waits == 0 && utilization < 0.5 && streams > minAutoscaledInferRequests) {
+        // one infer request at a time, so a short lull does not undo the growth
+        target = streams - 1;
+    }
+    if (target == streams) {
+        return;
+    }
+    SPDLOG_INFO("Model: {} version: {} autoscaling infer requests from {} to {}; average wait: {} us; utilization: {:.2f}",
+        getName(), getVersion(), streams, target, averageWaitMicroseconds, utilization);
+    resizeInferRequestsQueues(target);
+}
+
+bool ModelInstance::getSaturation(ModelSaturation& saturation) {
+    // instance being loaded is not serving requests, skipping it avoids waiting for the load
+    std::unique_lock<std::recursive_mutex> loadingLock(loadingMutex, std::try_to_lock);
+    if (!loadingLock.owns_lock() || getStatus().getState() != ModelVersionState::AVAILABLE || !inferRequestsQueue) {
+        return false;
+    }
+    saturation.name = getName();
+    saturation.version = getVersion();
+    saturation.inFlightRequests = getPredictRequestsHandlesCount();
+    saturation.streams = inferRequestsQueue->getInferRequestsCount();
+    saturation.idleStreams = inferRequestsQueue->getIdleStreamsCount();
+    saturation.waitingRequests = inferRequestsQueue->getWaitersCount();
+    saturation.responseCacheHits = responseCache.getHits();
+    saturation.responseCacheMisses = responseCache.getMisses();
+    for (const auto& replica : replicas) {
+        saturation.streams += replica.inferRequestsQueue->getInferRequestsCount();
+        saturation.idleStreams += replica.inferRequestsQueue->getIdleStreamsCount();
+        saturation.waitingRequests += replica.inferRequestsQueue->getWaitersCount();
+    }
+    for (const auto& [name, pool] : inferRequestsPools) {
+        saturation.streams += pool->getInferRequestsCount();
+        saturation.idleStreams += pool->getIdleStreamsCount();
+        saturation.waitingRequests += pool->getWaitersCount();
+    }
+    return true;
+}
+
+ModelInstance::Replica* ModelInstance::getServingReplica() {
+    if (replicas.empty()) {
+        return nullptr;
+    }
+    if (routedReplicas) {
+        std::vector<const OVInferRequestsQueue*> queues;
+        queues.reserve(replicas.size() + 1);
+        queues.push_back(inferRequestsQueue.get());
+        for (const auto& replica : replicas) {
+            queues.push_back(replica.inferRequestsQueue.get());
+        }
+        const size_t selected = selectReplica(queues, config.getReplicaRouting());
+        return selected == 0 ? nullptr : &replicas[selected - 1];
+    }
+    const int numaNode = getCurrentNumaNode();
+    for (auto& replica : replicas) {
+        if (replica.numaNode == numaNode) {
+            return &replica;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<OVInferRequestsQueue*> ModelInstance::getSplitBatchInferRequestsQueues(const std::string& pool) {
+    if (inferRequestsPools.count(pool) > 0) {
+        return {&getInferRequestsQueue(pool)};
+    }
+    std::vector<OVInferRequestsQueue*> queues;
+    queues.reserve(replicas.size() + 1);
+    queues.push_back(inferRequestsQueue.get());
+    for (auto& replica : replicas) {
+        queues.push_back(replica.inferRequestsQueue.get());
+    }
+    return queues;
+}
+
+void ModelInstance::loadPinnedExecutableNetwork(const cpu_list_t& cpus, plugin_config_t& pluginConfig) {
+    limitCpuThreadsToPinnedCpus(cpus, pluginConfig);
+    runPinnedToCpus(cpus, [this, &pluginConfig]() { loadExecutableNetworkPtr(pluginConfig); });
+    primaryCpus = cpus;
+    SPDLOG_INFO("Loaded model: {}; version: {}; streams pinned to cpus: {}", getName(), getVersion(), formatCpuList(cpus));
+}
+
 Status ModelInstance::loadOVExecutableNetwork(const ModelConfig& config) {
-    plugin_config_t pluginConfig = prepareDefaultPluginConfig(config);
+    const bool deviceReplicas = !config.getReplicaDevices().empty();
+    plugin_config_t pluginConfig = deviceReplicas ? prepareReplicaPluginConfig(config, config.getTargetDevice()) : prepareDefaultPluginConfig(config);
+    if (tuning.streams > 0) {
+        pluginConfig[CPU_THROUGHPUT_STREAMS] = std::to_string(tuning.streams);
+    }
+    if (rebalancedStreams > 0) {
+        pluginConfig[CPU_THROUGHPUT_STREAMS] = std::to_string(rebalancedStreams);
+    }
+    replicas.clear();
+    routedReplicas = false;
+    primaryCpus.clear();
     try {
-        loadExecutableNetworkPtr(pluginConfig);
+        cpu_list_t cpus = config.getCpus().empty() ? CpuPartitioning::instance().getInferenceCpus() : config.getCpus();
+        if (!config.isDeviceUsed("CPU")) {
+            cpus.clear();
+        }
+        std::map<int, cpu_list_t> numaNodes;
+        if (config.isNumaReplicasEnabled() && deviceReplicas) {
+            SPDLOG_WARN("NUMA replicas for model: {} are not used together with replica devices. Loading single executable network on each device.", getName());
+        } else if (config.isNumaReplicasEnabled()) {
+            numaNodes = getNumaNodesCpus();
+            if (!cpus.empty()) {
+                // replicas are placed only on nodes with cpus assigned to the model
+                for (auto it = numaNodes.begin(); it != numaNodes.end();) {
+                    auto& nodeCpus = it->second;
+                    nodeCpus.erase(std::remove_if(nodeCpus.begin(), nodeCpus.end(),
+                                       [&cpus](int cpu) { return std::find(cpus.begin(), cpus.end(), cpu) == cpus.end(); }),
+                        nodeCpus.end());
+                    it = nodeCpus.empty() ? numaNodes.erase(it) : std::next(it);
+                }
+            }
+            if (numaNodes.size() < 2 || !config.isDeviceUsed("CPU")) {
+                SPDLOG_WARN("NUMA replicas for model: {} require CPU device on a host with multiple NUMA nodes. Found {} NUMA nodes. Loading single executable network.",
+                    getName(), numaNodes.size());
+                numaNodes.clear();
+            }
+        }
+        const bool targetDeviceReplicas = config.getReplicasCount() > 1;
+        if (targetDeviceReplicas && (deviceReplicas || !numaNodes.empty())) {
+            SPDLOG_WARN("Replicas count of model: {} is not used together with replica devices or NUMA replicas.", getName());
+        }
+        if (!numaNodes.empty()) {
+            loadNumaReplicasExecutableNetworks(numaNodes, pluginConfig);
+        } else if (targetDeviceReplicas && !deviceReplicas) {
+            loadTargetDeviceReplicasExecutableNetworks(config.getReplicasCount(), cpus, pluginConfig);
+        } else if (!cpus.empty()) {
+            loadPinnedExecutableNetwork(cpus, pluginConfig);
+        } else {
+            limitCpuThreadsToContainer(config, pluginConfig);
+            loadExecutableNetworkPtr(pluginConfig);
+        }
+        if (deviceReplicas) {
+            loadDeviceReplicasExecutableNetworks(config);
+        }
+        execNetworkMappedWeights = mappedWeights;
     } catch (std::exception& e) {
         Status status = StatusCode::CANNOT_LOAD_NETWORK_INTO_TARGET_DEVICE;
         SPDLOG_ERROR("{}; error: {}; model: {}; version: {}; device: {}",
@@ -366,6 +1298,13 @@ Status ModelInstance::fetchModelFilepaths() {
     }
 
     SPDLOG_DEBUG("Getting model files from path: {}", path);
+    modelFiles.clear();
+    modelFilesHash.clear();
+    modelContents.clear();
+    streamedFilesSize = 0;
+    if (this->config.isStreamedFromCloud()) {
+        return fetchStreamedModelFiles();
+    }
     if (!dirExists(path)) {
         SPDLOG_ERROR("Missing model directory {}", path);
         return StatusCode::PATH_INVALID;
@@ -405,43 +1344,370 @@ Status ModelInstance::prepareInferenceRequestsQueue(const ModelConfig& config) {
     if (numberOfParallelInferRequests == 0) {
         return Status(StatusCode::INVALID_NIREQ, "Exceeded allowed nireq value");
     }
-    inferRequestsQueue = std::make_unique<OVInferRequestsQueue>(*execNetwork, numberOfParallelInferRequests);
-    SPDLOG_INFO("Loaded model {}; version: {}; batch size: {}; No of InferRequests: {}",
-        getName(),
-        getVersion(),
-        getBatchSize(),
+    // one client for all replicas, so the model version gets its share of slots regardless of replicas count.
+    // Client is kept over reloads, so the version is registered once and keeps its charged slot time.
+    if (!InferenceScheduler::instance().isEnabled()) {
+        schedulerClient.reset();
+    } else if (!schedulerClient ||
+               schedulerClient->getWeight() != std::max<uint32_t>(config.getSchedulingWeight(), 1) ||
+               schedulerClient->getPriority() != config.getSchedulingPriority()) {
+        schedulerClient = InferenceScheduler::instance().registerClient(
+            getName() + ":" + std::to_string(getVersion()), config.getSchedulingWeight(), config.getSchedulingPriority());
+    }
+    // memory states of sequences are kept in infer requests, so queues of stateful models are never resized
+    const uint maxInferRequests = config.isStateful() ? numberOfParallelInferRequests : std::min<uint64_t>(std::max<uint64_t>(numberOfParallelInferRequests, config.getMaxNireq()), MAX_NIREQ_COUNT);
+    std::map<std::string, uint32_t> poolSizes;
+    uint32_t reservedInferRequests = 0;
+    if (!config.getInferRequestsPools().empty()) {
+        if (config.isStateful() || config.isDynamicBatchingEnabled() || !replicas.empty()) {
+            SPDLOG_WARN("Model: {} version: {} infer request pools are not supported with stateful models, dynamic batching and replicas, all traffic will share infer requests",
+                getName(), getVersion());
+        } else if (!computeInferRequestsPoolSizes(config.getInferRequestsPools(), numberOfParallelInferRequests, poolSizes)) {
+            SPDLOG_WARN("Model: {} version: {} infer request pools would reserve all of {} infer requests, all traffic will share infer requests",
+                getName(), getVersion(), numberOfParallelInferRequests);
+        }
+        for (const auto& [name, size] : poolSizes) {
+            reservedInferRequests += size;
+        }
+    }
+    auto createQueue = [this, &config](InferenceEngine::ExecutableNetwork& network, uint32_t nireq, uint32_t maxNireq) {
+        auto queue = createInferRequestsQueue(network, nireq, maxNireq);
+        if (schedulerClient) {
+            queue->setSchedulerClient(schedulerClient);
+        }
+        for (const auto& [mappedName, input] : inputsInfo) {
+            if (isConversionRequired(input->getPrecision()) || input->isLayoutTransposed() || input->isImageInput() ||
+                (config.getInputConversions().count(input->getName()) &&
+                    isPrecisionConversionSupported(config.getInputConversions().at(input->getName()), input->getPrecision()))) {
+                queue->preallocateInputBlob(input->getName(), input->getTensorDesc());
+            }
+        }
+        // queues of pinned replicas are created on their NUMA node cpus, so arena memory is local to them
+        if (TensorArena::instance().isEnabled()) {
+            for (const auto& [mappedName, output] : outputsInfo) {
+                queue->preallocateOutputBlob(output->getName(), output->getTensorDesc());
+            }
+        }
+        return queue;
+    };
+    auto createPinnedQueue = [&createQueue](const cpu_list_t& cpus, InferenceEngine::ExecutableNetwork& network, std::unique_ptr<OVInferRequestsQueue>& queue, uint32_t nireq, uint32_t maxNireq) {
+        if (cpus.empty()) {
+            queue = createQueue(network, nireq, maxNireq);
+            return;
+        }
+        // Infer requests blobs are allocated from pinned threads to be placed in local memory
+        runPinnedToCpus(cpus, [&network, &queue, &createQueue, nireq, maxNireq]() { queue = createQueue(network, nireq, maxNireq); });
+    };
+    // pools are carved out of model nireq and keep their size, only the shared queue is autoscaled
+    const uint32_t sharedInferRequests = numberOfParallelInferRequests - reservedInferRequests;
+    createPinnedQueue(primaryCpus, *execNetwork, inferRequestsQueue, sharedInferRequests, maxInferRequests - reservedInferRequests);
+    inferRequestsPools.clear();
+    for (const auto& [name, size] : poolSizes) {
+        createPinnedQueue(primaryCpus, *execNetwork, inferRequestsPools[name], size, size);
+        SPDLOG_INFO("Model: {} version: {} reserved {} infer requests for pool: {}", getName(), getVersion(), size, name);
+    }
+    for (auto& replica : replicas) {
+        createPinnedQueue(replica.cpus, *replica.execNetwork, replica.inferRequestsQueue, numberOfParallelInferRequests, maxInferRequests);
+    }
+    // autoscaling never shrinks the queue below its load time size
+    minAutoscaledInferRequests = sharedInferRequests;
+    autoscalingSample = InferRequestsAutoscalingSample();
+    SPDLOG_INFO("Loaded model {}; version: {}; batch size: {}; No of InferRequests: {}",
+        getName(),
+        getVersion(),
+        getBatchSize(),
         numberOfParallelInferRequests);
     return StatusCode::OK;
 }
 
+void ModelInstance::prepareBatchSplit(const ModelConfig& config) {
+    batchSplit = false;
+    batchPadding = false;
+    if (!config.isBatchSplitEnabled() && !config.isBatchPaddingEnabled()) {
+        return;
+    }
+    const size_t batchSize = getBatchSize();
+    auto hasBatchDimension = [batchSize](const tensor_map_t& tensors) {
+        return std::all_of(tensors.begin(), tensors.end(), [batchSize](const auto& pair) {
+            const auto& shape = pair.second->getShape();
+            return !shape.empty() && shape[0] == batchSize && !pair.second->isResized();
+        });
+    };
+    if (batchSize == 0 || !hasBatchDimension(getInputsInfo()) || !hasBatchDimension(getOutputsInfo())) {
+        SPDLOG_WARN("Model: {} version: {} inputs and outputs do not have batch size: {} in the first dimension, batch split and padding will be disabled",
+            getName(), getVersion(), batchSize);
+        return;
+    }
+    batchSplit = config.isBatchSplitEnabled();
+    batchPadding = config.isBatchPaddingEnabled();
+}
+
+void ModelInstance::prepareDynamicBatcher(const ModelConfig& config) {
+    if (!config.isDynamicBatchingEnabled()) {
+        return;
+    }
+    dynamicBatcher = std::make_unique<DynamicBatcher>(getName(),
+        *inferRequestsQueue,
+        inputsInfo,
+        outputsInfo,
+        config.getDynamicBatchingMaxBatchSize(),
+        std::chrono::microseconds(config.getDynamicBatchingMaxQueueDelayMicroseconds()),
+        std::chrono::microseconds(config.getDynamicBatchingLatencySloMicroseconds()),
+        metrics);
+    for (auto& replica : replicas) {
+        replica.dynamicBatcher = std::make_unique<DynamicBatcher>(getName(),
+            *replica.inferRequestsQueue,
+            inputsInfo,
+            outputsInfo,
+            config.getDynamicBatchingMaxBatchSize(),
+            std::chrono::microseconds(config.getDynamicBatchingMaxQueueDelayMicroseconds()),
+            std::chrono::microseconds(config.getDynamicBatchingLatencySloMicroseconds()),
+            metrics);
+    }
+}
+
+Status ModelInstance::readWarmupData(const ModelConfig& config, std::map<std::string, std::string>& warmupData) {
+    if (config.getWarmupDataPath().empty()) {
+        return StatusCode::OK;
+    }
+    for (const auto& [mappedName, input] : inputsInfo) {
+        const std::string filePath = config.getWarmupDataPath() + "/" + mappedName + ".bin";
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) {
+            SPDLOG_ERROR("Could not open warmup data file: {} for model: {}; version: {}", filePath, getName(), getVersion());
+            return StatusCode::FILE_INVALID;
+        }
+        warmupData[input->getName()].assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    return StatusCode::OK;
+}
+
+Status ModelInstance::warmupInferRequestsQueue(OVInferRequestsQueue& inferRequestsQueue, const std::map<std::string, std::string>& warmupData, size_t iterations) {
+    const size_t inferRequestsCount = inferRequestsQueue.getInferRequestsCount();
+    for (size_t i = 0; i < inferRequestsCount; i++) {
+        auto& inferRequest = inferRequestsQueue.getInferRequest(i);
+        for (const auto& [mappedName, input] : inputsInfo) {
+            auto blob = inferRequest.GetBlob(input->getName());
+            char* buffer = (char*)blob->buffer();
+            auto data = warmupData.find(input->getName());
+            if (data == warmupData.end()) {
+                std::memset(buffer, 0, blob->byteSize());
+                continue;
+            }
+            if (data->second.size() != blob->byteSize()) {
+                SPDLOG_ERROR("Warmup data of input: {} has size: {}, expected: {}; model: {}; version: {}",
+                    mappedName, data->second.size(), blob->byteSize(), getName(), getVersion());
+                return StatusCode::INVALID_CONTENT_SIZE;
+            }
+            std::memcpy(buffer, data->second.data(), blob->byteSize());
+        }
+    }
+    for (size_t iteration = 0; iteration < iterations; iteration++) {
+        // all infer requests run at once, the same as under load
+        for (size_t i = 0; i < inferRequestsCount; i++) {
+            inferRequestsQueue.getInferRequest(i).StartAsync();
+        }
+        for (size_t i = 0; i < inferRequestsCount; i++) {
+            auto code = inferRequestsQueue.getInferRequest(i).Wait(InferenceEngine::IInferRequest::RESULT_READY);
+            if (code != InferenceEngine::StatusCode::OK) {
+                SPDLOG_ERROR("Warmup inference failed for model: {}; version: {}; OV StatusCode: {}", getName(), getVersion(), code);
+                return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+            }
+        }
+    }
+    return StatusCode::OK;
+}
+
+Status ModelInstance::benchmarkTuningCandidate(const TuningCandidate& candidate, const cpu_list_t& pinnedCpus, plugin_config_t pluginConfig, TuningMeasurement& measurement) {
+    pluginConfig[CPU_THROUGHPUT_STREAMS] = std::to_string(candidate.streams);
+    try {
+        InferenceEngine::ExecutableNetwork compiled;
+        if (pinnedCpus.empty()) {
+            compiled = engine->LoadNetwork(*network, targetDevice, pluginConfig);
+        } else {
+            runPinnedToCpus(pinnedCpus, [this, &compiled, &pluginConfig]() { compiled = engine->LoadNetwork(*network, targetDevice, pluginConfig); });
+        }
+        OVInferRequestsQueue queue(compiled, candidate.nireq);
+        // first round is not measured, it includes lazy initialization of infer requests
+        auto status = warmupInferRequestsQueue(queue, {}, 1);
+        if (!status.ok()) {
+            return status;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        status = warmupInferRequestsQueue(queue, {}, AUTO_TUNING_ITERATIONS);
+        if (!status.ok()) {
+            return status;
+        }
+        const double elapsedMs = std::max(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), 0.001);
+        measurement.candidate = candidate;
+        measurement.throughput = candidate.nireq * AUTO_TUNING_ITERATIONS * 1000.0 / elapsedMs;
+        // all infer requests run at once, each of them waits for the whole round
+        measurement.latencyMs = elapsedMs / AUTO_TUNING_ITERATIONS;
+    } catch (const std::exception& e) {
+        SPDLOG_WARN("Auto-tuning of model: {} version: {} failed for streams: {} nireq: {}; error: {}",
+            getName(), getVersion(), candidate.streams, candidate.nireq, e.what());
+        return StatusCode::CANNOT_LOAD_NETWORK_INTO_TARGET_DEVICE;
+    }
+    return StatusCode::OK;
+}
+
+void ModelInstance::autoTune(const ModelConfig& config) {
+    if (config.getTargetDevice() != "CPU" || !config.getReplicaDevices().empty() || config.isNumaReplicasEnabled() || config.getReplicasCount() > 1) {
+        SPDLOG_WARN("Auto-tuning of model: {} is supported only on CPU device without replicas, skipping it", getName());
+        return;
+    }
+    if (config.getPluginConfig().count(CPU_THROUGHPUT_STREAMS) > 0 || config.getNireq() > 0 || ovms::Config::instance().nireq() > 0) {
+        SPDLOG_INFO("Auto-tuning of model: {} skipped, {} or nireq is configured", getName(), CPU_THROUGHPUT_STREAMS);
+        return;
+    }
+    // candidates are compiled with the same cpus and threads as the network loaded afterwards
+    plugin_config_t pluginConfig = prepareDefaultPluginConfig(config);
+    const cpu_list_t pinnedCpus = config.getCpus().empty() ? CpuPartitioning::instance().getInferenceCpus() : config.getCpus();
+    cpu_list_t cpus = pinnedCpus;
+    if (pinnedCpus.empty()) {
+        limitCpuThreadsToContainer(config, pluginConfig);
+        cpus = getAllowedCpus();
+    } else {
+        limitCpuThreadsToPinnedCpus(pinnedCpus, pluginConfig);
+    }
+
+    TuningResultsStore store(ovms::Config::instance().compiledNetworkCacheDir());
+    std::string key;
+    if (store.isEnabled() && !config.isCustomLoaderRequiredToLoadModel()) {
+        if (modelFilesHash.empty()) {
+            modelFilesHash = CompiledNetworkCache::hashFiles(modelFiles);
+        }
+        if (!modelFilesHash.empty()) {
+            // result is valid only for the same latency target and cpus
+            plugin_config_t keyConfig = pluginConfig;
+            keyConfig["AUTO_TUNING_LATENCY_TARGET_MS"] = std::to_string(config.getAutoTuningLatencyTargetMs());
+            keyConfig["AUTO_TUNING_CPUS"] = formatCpuList(cpus);
+            key = CompiledNetworkCache::computeKey(modelFilesHash, targetDevice, keyConfig, CompiledNetworkCache::describeNetwork(*network));
+        }
+    }
+    if (!key.empty() && store.load(key, tuning)) {
+        SPDLOG_INFO("Model: {} version: {} uses stored auto-tuning result; streams: {}; nireq: {}", getName(), getVersion(), tuning.streams, tuning.nireq);
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<TuningMeasurement> measurements;
+    for (const auto& candidate : getTuningCandidates(std::min<size_t>(cpus.size(), getEffectiveCpuCount()))) {
+        TuningMeasurement measurement;
+        if (!benchmarkTuningCandidate(candidate, pinnedCpus, pluginConfig, measurement).ok()) {
+            continue;
+        }
+        SPDLOG_DEBUG("Auto-tuning of model: {} version: {}; streams: {}; nireq: {}; throughput: {:.1f} fps; latency: {:.2f} ms",
+            getName(), getVersion(), candidate.streams, candidate.nireq, measurement.throughput, measurement.latencyMs);
+        measurements.push_back(measurement);
+    }
+    if (!selectTuningCandidate(measurements, config.getAutoTuningLatencyTargetMs(), tuning)) {
+        SPDLOG_WARN("Auto-tuning of model: {} version: {} failed, using default streams and nireq", getName(), getVersion());
+        return;
+    }
+    SPDLOG_INFO("Auto-tuning of model: {} version: {} finished in {} ms; streams: {}; nireq: {}", getName(), getVersion(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(), tuning.streams, tuning.nireq);
+    if (!key.empty()) {
+        store.store(key, tuning);
+    }
+}
+
+Status ModelInstance::warmup(const ModelConfig& config) {
+    if (config.getWarmupIterations() == 0) {
+        return StatusCode::OK;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::map<std::string, std::string> warmupData;
+    auto status = readWarmupData(config, warmupData);
+    if (!status.ok()) {
+        return status;
+    }
+    status = warmupInferRequestsQueue(*inferRequestsQueue, warmupData, config.getWarmupIterations());
+    for (auto& replica : replicas) {
+        if (!status.ok()) {
+            break;
+        }
+        status = warmupInferRequestsQueue(*replica.inferRequestsQueue, warmupData, config.getWarmupIterations());
+    }
+    for (auto& [name, pool] : inferRequestsPools) {
+        if (!status.ok()) {
+            break;
+        }
+        status = warmupInferRequestsQueue(*pool, warmupData, config.getWarmupIterations());
+    }
+    if (!status.ok()) {
+        return status;
+    }
+    SPDLOG_INFO("Warmup of model: {}; version: {} finished in {} ms", getName(), getVersion(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    return StatusCode::OK;
+}
+
 void ModelInstance::configureBatchSize(const ModelConfig& config, const DynamicModelParameter& parameter) {
     if (parameter.isBatchSizeRequested()) {
         network->setBatchSize(parameter.getBatchSize());
+    } else if (config.isDynamicBatchingEnabled()) {
+        network->setBatchSize(config.getDynamicBatchingMaxBatchSize());
     } else if (config.getBatchSize() > 0) {
         network->setBatchSize(config.getBatchSize());
     }
 }
 
 Status ModelInstance::loadModelImpl(const ModelConfig& config, const DynamicModelParameter& parameter) {
+    const auto loadStart = std::chrono::steady_clock::now();
+    LoadProfile profile;
+    profile.record(LoadPhase::DOWNLOAD, config.getDownloadMicroseconds());
     subscriptionManager.notifySubscribers();
+    metadataCache.invalidate();
+    cancelShapePrecompilation();
     this->path = config.getPath();
     this->targetDevice = config.getTargetDevice();
     this->config = config;
-    auto status = fetchModelFilepaths();
+    // activations of lazily loaded version from the kept config do not download again
+    this->config.setDownloadMicroseconds(0);
+    this->maxPendingRequests = config.getMaxPendingRequests();
+    shapeVariants.reset(config.getShapeCacheSize());
+    responseCache.reset(config.getResponseCacheSizeMb() * 1024 * 1024);
+    // batch size or shape change requested by predict request only reshapes the network kept in memory,
+    // neither model files nor warmup data are read again so reshape takes only compilation time
+    const bool reshapeOnly = !parameter.isDefault() && this->network;
+    // hibernated version kept its parsed network and model files, activation neither reads nor tunes them again
+    const bool resumingHibernated = hibernated && this->network;
+    hibernated = false;
+    Status status = StatusCode::OK;
+    if (!reshapeOnly && !resumingHibernated) {
+        stagedReshapes.reset(1);
+        status = fetchModelFilepaths();
+    }
     if (!status.ok()) {
         this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
         return status;
     }
+    const size_t modelFilesSize = getModelFilesSize();
+    const size_t responseCacheCapacity = config.getResponseCacheSizeMb() * 1024 * 1024;
+    if (memoryReservation == 0) {
+        // reservation is released by unloading or destroying the instance, also when loading fails
+        const size_t estimatedMemory = modelFilesSize + responseCacheCapacity;
+        status = ModelsMemoryBudget::instance().reserve(getName(), getVersion(), estimatedMemory);
+        if (!status.ok()) {
+            this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
+            return status;
+        }
+        memoryReservation = estimatedMemory;
+    }
     try {
         if (!this->engine)
             loadOVEngine();
         status = StatusCode::OK;
         if (!this->network) {
+            const auto readStart = std::chrono::steady_clock::now();
             if (this->config.isCustomLoaderRequiredToLoadModel()) {
                 // loading the model using the custom loader
                 status = loadOVCNNNetworkUsingCustomLoader();
+                profile.recordSince(LoadPhase::CUSTOM_LOADER, readStart);
             } else {
                 status = loadOVCNNNetwork();
+                profile.recordSince(LoadPhase::READ_NETWORK, readStart);
             }
         }
 
@@ -450,19 +1716,97 @@ Status ModelInstance::loadModelImpl(const ModelConfig& config, const DynamicMode
             return status;
         }
 
-        configureBatchSize(this->config, parameter);
-        status = loadInputTensors(this->config, parameter);
+        // precompiled blob is imported without reading and reshaping CNNNetwork, its inputs are known once it is imported
+        const bool importingBlob = this->importedNetworkBlob != nullptr;
+        if (importingBlob && !parameter.isDefault()) {
+            importedNetworkBlob.reset();
+            SPDLOG_WARN("Model: {} version: {} is imported from precompiled blob and cannot be reshaped", getName(), getVersion());
+            this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
+            return StatusCode::RESHAPE_ERROR;
+        }
+        const auto reshapeStart = std::chrono::steady_clock::now();
+        if (!importingBlob) {
+            configureBatchSize(this->config, parameter);
+            status = loadInputTensors(this->config, parameter);
+            if (!status.ok()) {
+                this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
+                return status;
+            }
+            status = loadOutputTensors(this->config);
+            if (!status.ok()) {
+                this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
+                return status;
+            }
+        }
+        profile.recordSince(LoadPhase::RESHAPE, reshapeStart);
+        if (!reshapeOnly && !resumingHibernated) {
+            // tuned for the configured shape, result is kept when predict requests change it
+            tuning = TuningCandidate();
+            if (this->config.isAutoTuningEnabled() && importingBlob) {
+                SPDLOG_WARN("Model: {} version: {} is imported from precompiled blob, auto-tuning is skipped", getName(), getVersion());
+            } else if (this->config.isAutoTuningEnabled()) {
+                const auto autoTuneStart = std::chrono::steady_clock::now();
+                autoTune(this->config);
+                profile.recordSince(LoadPhase::AUTOTUNE, autoTuneStart);
+            }
+        }
+        // assigned streams are kept by reloads until the config fixes streams or nireq, new versions start with one stream
+        if (!isStreamsRebalancingSupported(this->config)) {
+            rebalancedStreams = 0;
+        } else if (rebalancedStreams == 0) {
+            rebalancedStreams = 1;
+        }
+        // growth of resident memory is attributed to the version only on its first compilation, on reload old networks are still held
+        const bool measureCompilation = !execNetwork;
+        const size_t residentMemoryBeforeCompilation = ModelsMemoryBudget::getResidentMemory();
+        const auto compilationStart = std::chrono::steady_clock::now();
+        if (reshapeOnly && stagedReshape) {
+            adoptExecutableNetworks(*stagedReshape);
+        } else if (stagedRebalance) {
+            adoptExecutableNetworks(*stagedRebalance);
+        } else {
+            status = loadOVExecutableNetwork(this->config);
+        }
+        // blob is not kept after import, next load of the version asks the custom loader for it again
+        importedNetworkBlob.reset();
+        if (importingBlob && status.ok()) {
+            status = loadImportedTensors(this->config);
+        }
+        profile.recordSince(LoadPhase::LOAD_NETWORK, compilationStart);
         if (!status.ok()) {
             this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
             return status;
         }
-        loadOutputTensors(this->config);
-        status = loadOVExecutableNetwork(this->config);
+        const size_t residentMemoryAfterCompilation = ModelsMemoryBudget::getResidentMemory();
+        dynamicBatcher.reset();
+        const auto inferRequestsStart = std::chrono::steady_clock::now();
+        status = prepareInferenceRequestsQueue(this->config);
+        profile.recordSince(LoadPhase::INFER_REQUESTS, inferRequestsStart);
         if (!status.ok()) {
             this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
             return status;
         }
-        status = prepareInferenceRequestsQueue(this->config);
+        prepareDynamicBatcher(this->config);
+        prepareBatchSplit(this->config);
+        // Memory states are kept in infer requests of the previous network, they are not valid after reload
+        sequenceManager = this->config.isStateful() ? std::make_unique<SequenceManager>(getName(), this->config.getMaxSequenceNumber(), std::chrono::seconds(this->config.getSequenceTimeoutSeconds())) : nullptr;
+        prepareValidationPlan();
+        {
+            std::lock_guard<std::mutex> lock(memoryUsageMutex);
+            memoryUsage.network = modelFilesSize;
+            if (measureCompilation) {
+                memoryUsage.executableNetwork = residentMemoryAfterCompilation > residentMemoryBeforeCompilation ? residentMemoryAfterCompilation - residentMemoryBeforeCompilation : 0;
+            }
+            memoryUsage.inferRequests = getInferRequestsMemory();
+            const size_t measuredMemory = memoryUsage.network + memoryUsage.executableNetwork + memoryUsage.inferRequests + responseCacheCapacity;
+            ModelsMemoryBudget::instance().update(memoryReservation, measuredMemory);
+            memoryReservation = measuredMemory;
+        }
+        if (!reshapeOnly) {
+            const auto warmupStart = std::chrono::steady_clock::now();
+            status = warmup(this->config);
+            profile.recordSince(LoadPhase::WARMUP, warmupStart);
+        }
         if (!status.ok()) {
             this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
             return status;
@@ -472,11 +1816,140 @@ Status ModelInstance::loadModelImpl(const ModelConfig& config, const DynamicMode
         this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
         return StatusCode::NETWORK_NOT_LOADED;
     }
+    profile.totalMicroseconds = profile.get(LoadPhase::DOWNLOAD) +
+                                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - loadStart).count();
+    SPDLOG_INFO("Model: {} version: {} loaded in {:.1f} ms; {}", getName(), getVersion(), profile.totalMicroseconds / 1000.0, profile.toString());
+    {
+        std::lock_guard<std::mutex> lock(loadProfileMutex);
+        loadProfile = profile;
+    }
     this->status.setAvailable();
     modelLoadedNotify.notify_all();
+    if (!reshapeOnly) {
+        // variants were dropped together with the previous network
+        scheduleShapePrecompilation();
+    }
     return status;
 }
 
+void ModelInstance::waitForInferencesToFinish() {
+    std::unique_lock<std::mutex> lock(inferencesFinishedMutex);
+    ++inferencesFinishedWaiters;
+    inferencesFinishedNotify.wait_for(lock, std::chrono::milliseconds(UNLOAD_AVAILABILITY_LOGGING_INTERVAL_MILLISECONDS),
+        [this]() { return canUnloadInstance(); });
+    --inferencesFinishedWaiters;
+}
+
+ModelInstance::~ModelInstance() {
+    LazyModelsBudget::instance().release(*this);
+    releaseMemory();
+}
+
+std::shared_ptr<FileSystem> ModelInstance::createModelFilesystem() const {
+    return createFilesystem(path);
+}
+
+Status ModelInstance::fetchStreamedModelFiles() {
+    auto fs = createModelFilesystem();
+    std::set<std::string> files;
+    auto status = fs->getDirectoryFiles(path, &files);
+    if (status != StatusCode::OK) {
+        SPDLOG_ERROR("Missing model directory {}", path);
+        return status;
+    }
+    auto findFiles = [this, &fs, &files](const std::vector<std::string>& extensions) {
+        modelFiles.clear();
+        for (const auto& extension : extensions) {
+            auto file = std::find_if(files.begin(), files.end(), [&extension](const std::string& name) { return endsWith(name, extension); });
+            if (file == files.end()) {
+                return false;
+            }
+            modelFiles.push_back(fs->joinPath({path, *file}));
+        }
+        return true;
+    };
+    if (!findFiles(OV_MODEL_FILES_EXTENSIONS) && !findFiles(ONNX_MODEL_FILES_EXTENSIONS)) {
+        SPDLOG_ERROR("Could not find file for model: {} version: {} in path: {}", getName(), getVersion(), path);
+        modelFiles.clear();
+        return StatusCode::FILE_INVALID;
+    }
+    const auto readStart = std::chrono::steady_clock::now();
+    std::vector<const std::string*> contents;
+    for (const auto& file : modelFiles) {
+        auto buffer = std::make_shared<std::string>();
+        status = fs->readFileToMemory(file, buffer.get());
+        if (status != StatusCode::OK) {
+            SPDLOG_ERROR("Could not read model file: {} into memory", file);
+            modelContents.clear();
+            return status;
+        }
+        streamedFilesSize += buffer->size();
+        contents.push_back(buffer.get());
+        modelContents.push_back(std::move(buffer));
+    }
+    // files are not on disk to be hashed later, compiled network cache and tuning results are keyed by their contents
+    if (!ovms::Config::instance().compiledNetworkCacheDir().empty()) {
+        modelFilesHash = CompiledNetworkCache::hashContents(contents);
+    }
+    SPDLOG_DEBUG("Model: {} version: {} files read from {} into memory (bytes={}) in {} ms", getName(), getVersion(), path, streamedFilesSize,
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - readStart).count());
+    return StatusCode::OK;
+}
+
+size_t ModelInstance::getModelFilesSize() const {
+    if (this->config.isStreamedFromCloud()) {
+        return streamedFilesSize;
+    }
+    size_t filesSize = 0;
+    for (const auto& file : modelFiles) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(file, error);
+        if (!error) {
+            filesSize += size;
+        }
+    }
+    return filesSize;
+}
+
+size_t ModelInstance::getInferRequestsMemory() const {
+    size_t inferRequestsMemory = 0;
+    auto addQueue = [this, &inferRequestsMemory](OVInferRequestsQueue& queue) {
+        for (size_t i = 0; i < queue.getInferRequestsCount(); ++i) {
+            auto& inferRequest = queue.getInferRequest(i);
+            for (const auto& [name, input] : inputsInfo) {
+                inferRequestsMemory += inferRequest.GetBlob(input->getName())->byteSize();
+            }
+            for (const auto& [name, output] : outputsInfo) {
+                inferRequestsMemory += inferRequest.GetBlob(output->getName())->byteSize();
+            }
+        }
+    };
+    if (inferRequestsQueue) {
+        addQueue(*inferRequestsQueue);
+    }
+    for (const auto& replica : replicas) {
+        addQueue(*replica.inferRequestsQueue);
+    }
+    for (const auto& [name, pool] : inferRequestsPools) {
+        addQueue(*pool);
+    }
+    return inferRequestsMemory;
+}
+
+void ModelInstance::releaseMemory() {
+    ModelsMemoryBudget::instance().release(memoryReservation);
+    memoryReservation = 0;
+    std::lock_guard<std::mutex> lock(memoryUsageMutex);
+    memoryUsage = ModelMemoryUsage();
+}
+
+ModelMemoryUsage ModelInstance::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(memoryUsageMutex);
+    auto usage = memoryUsage;
+    usage.responseCache = responseCache.getSizeBytes();
+    return usage;
+}
+
 Status ModelInstance::loadModel(const ModelConfig& config) {
     std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
     SPDLOG_INFO("Loading model: {}, version: {}, from path: {}, with target device: {} ...",
@@ -488,18 +1961,152 @@ Status ModelInstance::loadModel(const ModelConfig& config) {
     }
     this->status = ModelVersionStatus(config.getName(), config.getVersion());
     this->status.setLoading();
-    return loadModelImpl(config);
+    releaseHibernatedNetwork();
+    if (config.isLazyLoadingEnabled()) {
+        return registerLazily(config);
+    }
+    activated = true;
+    const auto loadStart = std::chrono::steady_clock::now();
+    auto status = loadModelImpl(config);
+    if (status.ok()) {
+        metrics->recordLoadSince(loadStart);
+    }
+    return status;
 }
 
 Status ModelInstance::reloadModel(const ModelConfig& config, const DynamicModelParameter& parameter) {
     std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+    if (parameter.isDefault()) {
+        // config or model files may have changed since the network was kept
+        releaseHibernatedNetwork();
+    }
+    if (config.isLazyLoadingEnabled() && parameter.isDefault()) {
+        if (activated) {
+            bool isPermanent = false;
+            unloadModel(isPermanent);
+        }
+        this->status.setLoading();
+        return registerLazily(config);
+    }
     this->status.setLoading();
     while (!canUnloadInstance()) {
         SPDLOG_INFO("Waiting to reload model: {} version: {}. Blocked by: {} inferences in progress.",
-            getName(), getVersion(), predictRequestsHandlesCount);
-        std::this_thread::sleep_for(std::chrono::milliseconds(UNLOAD_AVAILABILITY_CHECKING_INTERVAL_MILLISECONDS));
+            getName(), getVersion(), getPredictRequestsHandlesCount());
+        waitForInferencesToFinish();
+    }
+    if (!config.isLazyLoadingEnabled()) {
+        LazyModelsBudget::instance().release(*this);
+        activated = true;
+    }
+    const auto reloadStart = std::chrono::steady_clock::now();
+    auto status = loadModelImpl(config, parameter);
+    if (status.ok()) {
+        metrics->recordReloadSince(reloadStart);
+    }
+    return status;
+}
+
+Status ModelInstance::registerLazily(const ModelConfig& config) {
+    subscriptionManager.notifySubscribers();
+    metadataCache.invalidate();
+    cancelShapePrecompilation();
+    this->path = config.getPath();
+    this->targetDevice = config.getTargetDevice();
+    this->config = config;
+    this->maxPendingRequests = config.getMaxPendingRequests();
+    auto status = fetchModelFilepaths();
+    if (!status.ok()) {
+        this->status.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
+        return status;
+    }
+    estimatedMemoryUsage = getModelFilesSize();
+    // streamed files are read again on activation
+    modelContents.clear();
+    activated = false;
+    SPDLOG_INFO("Model: {} version: {} registered for lazy loading, network will be compiled on first use", getName(), getVersion());
+    this->status.setAvailable();
+    modelLoadedNotify.notify_all();
+    return StatusCode::OK;
+}
+
+Status ModelInstance::activate() {
+    std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+    if (activated || this->status.getState() != ModelVersionState::AVAILABLE) {
+        // activated by concurrent request or being reloaded
+        return StatusCode::OK;
+    }
+    SPDLOG_INFO("Activating model: {} version: {} ...", getName(), getVersion());
+    auto start = std::chrono::steady_clock::now();
+    LazyModelsBudget::instance().reserve(*this, estimatedMemoryUsage);
+    this->status.setLoading();
+    activated = true;
+    auto status = loadModelImpl(this->config);
+    if (!status.ok()) {
+        SPDLOG_ERROR("Activation of model: {} version: {} failed: {}", getName(), getVersion(), status.string());
+        bool isPermanent = false;
+        unloadModel(isPermanent);
+        // next request retries the activation
+        activated = false;
+        this->status.setAvailable();
+        modelLoadedNotify.notify_all();
+        return status;
+    }
+    lastUsed = std::chrono::steady_clock::now();
+    SPDLOG_INFO("Activated model: {} version: {} in {} ms", getName(), getVersion(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(lastUsed.load() - start).count());
+    return StatusCode::OK;
+}
+
+bool ModelInstance::deactivateIfIdle(std::chrono::steady_clock::time_point usedBefore) {
+    std::unique_lock<std::recursive_mutex> loadingLock(loadingMutex, std::try_to_lock);
+    if (!loadingLock.owns_lock()) {
+        return false;
+    }
+    if (!this->config.isLazyLoadingEnabled() || !activated ||
+        this->status.getState() != ModelVersionState::AVAILABLE ||
+        lastUsed.load() >= usedBefore ||
+        !canUnloadInstance() ||
+        subscriptionManager.isSubscribed()) {
+        return false;
     }
-    return loadModelImpl(config, parameter);
+    if (this->config.isIdleHibernationEnabled()) {
+        SPDLOG_INFO("Hibernating idle model: {} version: {}", getName(), getVersion());
+        hibernate();
+    } else {
+        SPDLOG_INFO("Deactivating idle model: {} version: {}", getName(), getVersion());
+        bool isPermanent = false;
+        unloadModel(isPermanent);
+    }
+    activated = false;
+    this->status.setAvailable();
+    modelLoadedNotify.notify_all();
+    return true;
+}
+
+void ModelInstance::hibernate() {
+    // weights referenced by the network and the engine which read it have to outlive unloading together with it
+    auto keptEngine = engine;
+    auto keptNetwork = std::move(network);
+    auto keptMappedWeights = mappedWeights;
+    auto keptModelFiles = modelFiles;
+    bool isPermanent = false;
+    unloadModel(isPermanent);
+    mappedWeights = std::move(keptMappedWeights);
+    network = std::move(keptNetwork);
+    engine = std::move(keptEngine);
+    modelFiles = std::move(keptModelFiles);
+    hibernated = true;
+}
+
+void ModelInstance::releaseHibernatedNetwork() {
+    if (!hibernated) {
+        return;
+    }
+    network.reset();
+    mappedWeights.reset();
+    engine.reset();
+    modelFiles.clear();
+    hibernated = false;
 }
 
 Status ModelInstance::recoverFromReloadingError(const Status& status) {
@@ -543,16 +2150,322 @@ Status ModelInstance::reloadModel(size_t batchSize, std::map<std::string, shape_
     return status;
 }
 
+bool ModelInstance::isShapeVariantRequired(const Status& validationStatus) const {
+    return (validationStatus.batchSizeChangeRequired() || validationStatus.reshapeRequired()) &&
+           config.getShapeCacheSize() > 0;
+}
+
+void ModelInstance::prepareShapeVariantConfig(const tensorflow::serving::PredictRequest* request,
+    const Status& validationStatus,
+    ModelConfig& variantConfig,
+    std::string& key) {
+    variantConfig = config;
+    variantConfig.setShapeCacheSize(0);
+    key.clear();
+    if (validationStatus.batchSizeChangeRequired()) {
+        const size_t requestBatchSize = request->inputs().begin()->second.tensor_shape().dim(0).size();
+        variantConfig.setBatchingParams(requestBatchSize);
+        key = "batch_size:" + std::to_string(requestBatchSize);
+    } else {
+        shapes_map_t variantShapes;
+        for (const auto& [name, shapeInfo] : config.getShapes()) {
+            if (shapeInfo.shapeMode == FIXED) {
+                variantShapes[name] = shapeInfo;
+            }
+        }
+        // inputs info is ordered by name so the key does not depend on request inputs order
+        for (const auto& [mappedName, networkInput] : getInputsInfo()) {
+            // encoded images are resized to the network input, they never change its shape
+            if (!config.isShapeAuto(networkInput->getName()) || isImageInputRequested(request->inputs().at(mappedName), *networkInput)) {
+                continue;
+            }
+            ShapeInfo shapeInfo;
+            shapeInfo.shapeMode = FIXED;
+            for (const auto& dim : request->inputs().at(mappedName).tensor_shape().dim()) {
+                shapeInfo.shape.push_back(dim.size());
+            }
+            if (networkInput->isLayoutTransposed()) {
+                shapeInfo.shape = nhwcToNchwShape(shapeInfo.shape);
+            }
+            key += mappedName + ":" + TensorInfo::shapeToString(shapeInfo.shape) + ";";
+            variantShapes[networkInput->getName()] = std::move(shapeInfo);
+        }
+        variantConfig.setShapes(variantShapes);
+    }
+}
+
+Status ModelInstance::compileShapeVariant(LRUCache<std::string, std::shared_ptr<ModelInstance>>& variants,
+    const std::string& key,
+    const ModelConfig& variantConfig,
+    std::shared_ptr<ModelInstance>& shapeVariant) {
+    bool inserted = false;
+    shapeVariant = variants.getOrInsert(
+        key, [this]() {
+            auto variant = createShapeVariant();
+            // requests served by the variant are reported as requests of this version
+            variant->metrics = metrics;
+            variant->shapeProfileEnabled = false;
+            return variant;
+        },
+        inserted);
+    if (!inserted) {
+        SPDLOG_DEBUG("Model: {} version: {} using cached network for shape: {}", getName(), getVersion(), key);
+        return StatusCode::OK;
+    }
+
+    SPDLOG_INFO("Model: {} version: {} compiling network for shape: {}", getName(), getVersion(), key);
+    auto status = shapeVariant->loadModel(variantConfig);
+    if (!status.ok()) {
+        SPDLOG_WARN("Model: {} version: {} failed to compile network for shape: {}; {}", getName(), getVersion(), key, status.string());
+        variants.remove(key, shapeVariant);
+        // wakes up requests waiting for this shape
+        shapeVariant->unloadModel();
+        shapeVariant.reset();
+    }
+    return status;
+}
+
+Status ModelInstance::getShapeVariant(const tensorflow::serving::PredictRequest* request,
+    const Status& validationStatus,
+    std::shared_ptr<ModelInstance>& shapeVariant) {
+    ModelConfig variantConfig;
+    std::string key;
+    prepareShapeVariantConfig(request, validationStatus, variantConfig, key);
+    shapeHistogram.record(key);
+    return compileShapeVariant(shapeVariants, key, variantConfig, shapeVariant);
+}
+
+bool ModelInstance::prepareShapeVariantConfig(const std::string& key, ModelConfig& variantConfig) const {
+    size_t batchSize = 0;
+    std::map<std::string, shape_t> requestShapes;
+    if (!parseShapeSignature(key, batchSize, requestShapes)) {
+        return false;
+    }
+    variantConfig = config;
+    variantConfig.setShapeCacheSize(0);
+    if (batchSize > 0) {
+        if (config.getBatchingMode() != AUTO) {
+            return false;
+        }
+        variantConfig.setBatchingParams(batchSize);
+        return true;
+    }
+    shapes_map_t variantShapes;
+    for (const auto& [name, shapeInfo] : config.getShapes()) {
+        if (shapeInfo.shapeMode == FIXED) {
+            variantShapes[name] = shapeInfo;
+        }
+    }
+    // signatures hold shapes in network layout already
+    for (auto& [mappedName, shape] : requestShapes) {
+        auto input = getInputsInfo().find(mappedName);
+        if (input == getInputsInfo().end() || !config.isShapeAuto(input->second->getName())) {
+            return false;
+        }
+        ShapeInfo shapeInfo;
+        shapeInfo.shapeMode = FIXED;
+        shapeInfo.shape = std::move(shape);
+        variantShapes[input->second->getName()] = std::move(shapeInfo);
+    }
+    variantConfig.setShapes(variantShapes);
+    return true;
+}
+
+void ModelInstance::scheduleShapePrecompilation() {
+    ShapeProfileStore store(ovms::Config::instance().compiledNetworkCacheDir());
+    if (!shapeProfileEnabled || !store.isEnabled() || !config.isDynamicParameterEnabled()) {
+        return;
+    }
+    if (!shapeHistoryLoaded) {
+        shapeHistoryLoaded = true;
+        std::map<std::string, uint64_t> history;
+        if (store.load(getName(), getVersion(), history)) {
+            shapeHistogram.merge(history, SHAPE_HISTORY_WEIGHT);
+        }
+    }
+    // without shape cache only the shape of the next reload can be staged
+    const auto keys = shapeHistogram.getTopKeys(std::max<size_t>(config.getShapeCacheSize(), 1));
+    if (keys.empty()) {
+        return;
+    }
+    SPDLOG_INFO("Model: {} version: {} will precompile {} shapes from traffic history", getName(), getVersion(), keys.size());
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(precompilationMutex);
+        generation = precompilationGeneration;
+    }
+    std::weak_ptr<ModelInstance> weakInstance = weak_from_this();
+    ShapePrecompilationQueue::instance().submit([weakInstance, keys, generation]() {
+        if (auto instance = weakInstance.lock()) {
+            instance->precompileShapeVariants(keys, generation);
+        }
+    });
+}
+
+void ModelInstance::cancelShapePrecompilation() {
+    std::unique_lock<std::mutex> lock(precompilationMutex);
+    ++precompilationGeneration;
+    precompilationStopped.wait(lock, [this]() { return !precompilationRunning; });
+}
+
+void ModelInstance::precompileShapeVariants(const std::vector<std::string>& keys, uint64_t generation) {
+    {
+        std::lock_guard<std::mutex> lock(precompilationMutex);
+        if (generation != precompilationGeneration) {
+            return;
+        }
+        precompilationRunning = true;
+    }
+    // config and inputs info are not replaced until the task stops, loads wait for it in cancelShapePrecompilation
+    auto& variants = config.getShapeCacheSize() > 0 ? shapeVariants : stagedReshapes;
+    for (const auto& key : keys) {
+        {
+            std::lock_guard<std::mutex> lock(precompilationMutex);
+            if (generation != precompilationGeneration) {
+                SPDLOG_DEBUG("Model: {} version: {} was loaded again or unloaded, shape precompilation stopped", getName(), getVersion());
+                break;
+            }
+        }
+        ModelConfig variantConfig;
+        if (!prepareShapeVariantConfig(key, variantConfig)) {
+            SPDLOG_DEBUG("Model: {} version: {} skips precompilation of shape: {} not matching the model", getName(), getVersion(), key);
+            continue;
+        }
+        std::shared_ptr<ModelInstance> variant;
+        compileShapeVariant(variants, key, variantConfig, variant);
+    }
+    {
+        std::lock_guard<std::mutex> lock(precompilationMutex);
+        precompilationRunning = false;
+    }
+    precompilationStopped.notify_all();
+}
+
+void ModelInstance::persistShapeProfile() {
+    ShapeProfileStore store(ovms::Config::instance().compiledNetworkCacheDir());
+    if (!store.isEnabled() || !shapeHistogram.takeChanged()) {
+        return;
+    }
+    store.store(getName(), getVersion(), shapeHistogram.getCounts());
+}
+
+Status ModelInstance::reloadModelInBackground(const tensorflow::serving::PredictRequest* request,
+    const Status& validationStatus,
+    const DynamicModelParameter& parameter,
+    const uint waitForModelLoadedTimeoutMilliseconds,
+    std::unique_ptr<ModelInstanceUnloadGuard>& unloadGuard) {
+    ModelConfig variantConfig;
+    std::string key;
+    prepareShapeVariantConfig(request, validationStatus, variantConfig, key);
+    shapeHistogram.record(key);
+    // network for the new shape is compiled without loading lock, requests matching current shape are served meanwhile
+    // and requests for the same new shape wait for the staged instance only
+    std::shared_ptr<ModelInstance> staged;
+    auto status = compileShapeVariant(stagedReshapes, key, variantConfig, staged);
+    if (!status.ok()) {
+        return status;
+    }
+    {
+        std::unique_ptr<ModelInstanceUnloadGuard> stagedUnloadGuard;
+        status = staged->waitForLoaded(waitForModelLoadedTimeoutMilliseconds, stagedUnloadGuard);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+
+    unloadGuard.reset();
+    std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+    if (this->status.getState() == ModelVersionState::AVAILABLE && validate(request).ok()) {
+        SPDLOG_DEBUG("Model: {} version: {} already reloaded for shape: {}", getName(), getVersion(), key);
+        unloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*this);
+        return StatusCode::OK;
+    }
+    SPDLOG_INFO("Will reload model: {} version: {} with staged network for shape: {}", getName(), getVersion(), key);
+    // staged network is dropped when model was loaded with new configuration meanwhile, then it is compiled again
+    if (stagedReshapes.remove(key, staged)) {
+        stagedReshape = staged;
+    }
+    status = reloadModel(config, parameter);
+    stagedReshape.reset();
+    if (!status.ok()) {
+        return this->recoverFromReloadingError(status);
+    }
+    unloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*this);
+    return status;
+}
+
+void ModelInstance::adoptExecutableNetworks(const ModelInstance& compiled) {
+    execNetwork = compiled.execNetwork;
+    execNetworkMappedWeights = compiled.execNetworkMappedWeights;
+    primaryCpus = compiled.primaryCpus;
+    routedReplicas = compiled.routedReplicas;
+    replicas.clear();
+    for (const auto& compiledReplica : compiled.replicas) {
+        Replica replica;
+        replica.numaNode = compiledReplica.numaNode;
+        replica.device = compiledReplica.device;
+        replica.cpus = compiledReplica.cpus;
+        replica.execNetwork = compiledReplica.execNetwork;
+        replicas.push_back(std::move(replica));
+    }
+    SPDLOG_INFO("Model: {} version: {} uses network compiled in background", getName(), getVersion());
+}
+
+std::shared_ptr<ngraph::Function> ModelInstance::cloneNetworkFunction(std::shared_ptr<InferenceEngine::ExecutableNetwork>& compiled) {
+    std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+    compiled = execNetwork;
+    if (!network || !network->getFunction()) {
+        return nullptr;
+    }
+    return ngraph::clone_function(*network->getFunction());
+}
+
+std::shared_ptr<InferenceEngine::ExecutableNetwork> ModelInstance::getExecutableNetwork() {
+    std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+    return execNetwork;
+}
+
+std::shared_ptr<InferenceEngine::ExecutableNetwork> ModelInstance::compileFusedNetwork(const InferenceEngine::CNNNetwork& fusedNetwork) {
+    std::shared_ptr<InferenceEngine::Core> core;
+    std::string device;
+    plugin_config_t pluginConfig;
+    {
+        std::lock_guard<std::recursive_mutex> loadingLock(loadingMutex);
+        core = engine;
+        device = targetDevice;
+        pluginConfig = prepareDefaultPluginConfig(config);
+    }
+    if (!core) {
+        return nullptr;
+    }
+    // compiled without loading lock so loads and reloads of the model are not blocked,
+    // fused network is not cached, its key would have to cover files of all fused models
+    return std::make_shared<InferenceEngine::ExecutableNetwork>(core->LoadNetwork(fusedNetwork, device, pluginConfig));
+}
+
 Status ModelInstance::waitForLoaded(const uint waitForModelLoadedTimeoutMilliseconds,
     std::unique_ptr<ModelInstanceUnloadGuard>& modelInstanceUnloadGuard) {
     // order is important here for performance reasons
     // assumption: model is already loaded for most of the calls
     modelInstanceUnloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*this);
-    if (getStatus().getState() == ModelVersionState::AVAILABLE) {
+    if (isServable()) {
+        lastUsed = std::chrono::steady_clock::now();
         SPDLOG_DEBUG("Model: {}, version: {} already loaded", getName(), getVersion());
         return StatusCode::OK;
     }
     modelInstanceUnloadGuard.reset();
+    if (getStatus().getState() == ModelVersionState::AVAILABLE) {
+        auto status = activate();
+        if (!status.ok()) {
+            return status;
+        }
+        modelInstanceUnloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*this);
+        if (isServable()) {
+            lastUsed = std::chrono::steady_clock::now();
+            return StatusCode::OK;
+        }
+        modelInstanceUnloadGuard.reset();
+    }
 
     // wait several time since no guarantee that cv wakeup will be triggered before calling wait_for
     const uint waitLoadedTimestepMilliseconds = 100;
@@ -572,11 +2485,25 @@ Status ModelInstance::waitForLoaded(const uint waitForModelLoadedTimeoutMillisec
                 getName(), getVersion(), waitCheckpoints - waitCheckpointsCounter);
         }
         modelInstanceUnloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*this);
-        if (getStatus().getState() == ModelVersionState::AVAILABLE) {
+        if (isServable()) {
+            lastUsed = std::chrono::steady_clock::now();
             SPDLOG_INFO("Succesfully waited for model: {}, version: {}", getName(), getVersion());
             return StatusCode::OK;
         }
         modelInstanceUnloadGuard.reset();
+        if (getStatus().getState() == ModelVersionState::AVAILABLE) {
+            // deactivated while waiting
+            auto status = activate();
+            if (!status.ok()) {
+                return status;
+            }
+            modelInstanceUnloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*this);
+            if (isServable()) {
+                lastUsed = std::chrono::steady_clock::now();
+                return StatusCode::OK;
+            }
+            modelInstanceUnloadGuard.reset();
+        }
         if (ModelVersionState::AVAILABLE < getStatus().getState()) {
             SPDLOG_INFO("Stopped waiting for model: {} version: {} since it is unloading.", getName(), getVersion());
             return StatusCode::MODEL_VERSION_NOT_LOADED_ANYMORE;
@@ -601,18 +2528,38 @@ void ModelInstance::unloadModel(bool isPermanent) {
         this->status.setLoading();
     }
     subscriptionManager.notifySubscribers();
+    metadataCache.invalidate();
     while (!canUnloadInstance()) {
         SPDLOG_DEBUG("Waiting to unload model: {} version: {}. Blocked by: {} inferences in progres.",
-            getName(), getVersion(), predictRequestsHandlesCount);
-        std::this_thread::sleep_for(std::chrono::milliseconds(UNLOAD_AVAILABILITY_CHECKING_INTERVAL_MILLISECONDS));
+            getName(), getVersion(), getPredictRequestsHandlesCount());
+        waitForInferencesToFinish();
     }
+    cancelShapePrecompilation();
+    shapeVariants.reset(0);
+    stagedReshapes.reset(1);
+    if (responseCache.isEnabled()) {
+        SPDLOG_INFO("Response cache of model: {} version: {} had {} hits and {} misses", getName(), getVersion(), responseCache.getHits(), responseCache.getMisses());
+    }
+    responseCache.reset(0);
+    replicas.clear();
+    routedReplicas = false;
+    primaryCpus.clear();
+    dynamicBatcher.reset();
+    sequenceManager.reset();
+    inferRequestsPools.clear();
     inferRequestsQueue.reset();
     execNetwork.reset();
     network.reset();
+    hibernated = false;
+    execNetworkMappedWeights.reset();
+    mappedWeights.reset();
     engine.reset();
     outputsInfo.clear();
     inputsInfo.clear();
     modelFiles.clear();
+    modelContents.clear();
+    LazyModelsBudget::instance().release(*this);
+    releaseMemory();
     if (isPermanent) {
         status.setEnd();
     }
@@ -627,21 +2574,27 @@ void ModelInstance::unloadModel(bool isPermanent) {
                 loaderName, getName(), getVersion());
         } else {
             // once model is unloaded, notify custom loader object about the unload
+            auto callLock = customloaders.lockForCall(customLoaderInterfacePtr);
             customLoaderInterfacePtr->unloadModel(getName(), getVersion());
         }
     }
 }
 
+bool ModelInstance::isPrecisionConversionEnabled(const ovms::TensorInfo& networkInput,
+    const tensorflow::TensorProto& requestInput) {
+    return isPrecisionConversionRequested(requestInput, networkInput.getPrecision()) &&
+           getModelConfig().isInputConversionEnabled(networkInput.getName(), TensorInfo::getDataTypeAsString(requestInput.dtype()));
+}
+
 const Status ModelInstance::validatePrecision(const ovms::TensorInfo& networkInput,
     const tensorflow::TensorProto& requestInput) {
-    // Network and request must have the same precision
-    if (requestInput.dtype() != networkInput.getPrecisionAsDataType()) {
-        std::stringstream ss;
-        ss << "Expected: " << networkInput.getPrecisionAsString()
-           << "; Actual: " << TensorInfo::getDataTypeAsString(requestInput.dtype());
-        const std::string details = ss.str();
-        SPDLOG_DEBUG("[Model: {} version: {}] Invalid precision - {}", getName(), getVersion(), details);
-        return Status(StatusCode::INVALID_PRECISION, details);
+    // Network and request must have the same precision, unless conversion of request precision is enabled for the input
+    if (requestInput.dtype() != networkInput.getPrecisionAsDataType() &&
+        !isPrecisionConversionEnabled(networkInput, requestInput)) {
+        auto status = Status::withDetails(StatusCode::INVALID_PRECISION,
+            "Expected: ", networkInput.getPrecisionAsString(), "; Actual: ", TensorInfo::getDataTypeAsString(requestInput.dtype()));
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+        return status;
     }
     return StatusCode::OK;
 }
@@ -649,21 +2602,29 @@ const Status ModelInstance::validatePrecision(const ovms::TensorInfo& networkInp
 const Status ModelInstance::validateNumberOfShapeDimensions(const ovms::TensorInfo& networkInput,
     const tensorflow::TensorProto& requestInput) {
     // Network and request must have the same number of shape dimensions, higher than 0
-    auto& shape = networkInput.getShape();
+    const auto shape = networkInput.getRequestShape();
     if (requestInput.tensor_shape().dim_size() <= 0 ||
         shape.size() != static_cast<size_t>(requestInput.tensor_shape().dim_size())) {
-        std::stringstream ss;
-        ss << "Expected: " << TensorInfo::shapeToString(shape)
-           << "; Actual: " << TensorInfo::tensorShapeToString(requestInput.tensor_shape());
-        const std::string details = ss.str();
-        SPDLOG_DEBUG("[Model: {} version: {}] Invalid number of shape dimensions - {}", getName(), getVersion(), details);
-        return Status(StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS, details);
+        auto status = Status::withDetails(StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS,
+            "Expected: ", TensorInfo::shapeToString(shape), "; Actual: ", TensorInfo::tensorShapeToString(requestInput.tensor_shape()));
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+        return status;
     }
     return StatusCode::OK;
 }
 
 const bool ModelInstance::checkBatchSizeMismatch(const ovms::TensorInfo& networkInput,
     const tensorflow::TensorProto& requestInput) {
+    const auto requestBatchSize = requestInput.tensor_shape().dim(0).size();
+    if (requestBatchSize > 0 && (isBatchSplitRequired(requestBatchSize) || isBatchPaddingRequired(requestBatchSize))) {
+        // bigger batches are split into inferences of network batch size, smaller ones are padded to it
+        return false;
+    }
+    if (dynamicBatcher) {
+        // Batch gathered on the server side can contain requests of any batch size up to the network one
+        auto requestBatchSize = requestInput.tensor_shape().dim(0).size();
+        return requestBatchSize <= 0 || static_cast<size_t>(requestBatchSize) > getBatchSize();
+    }
     if (static_cast<size_t>(requestInput.tensor_shape().dim(0).size()) != getBatchSize())
         return true;
     return false;
@@ -672,12 +2633,15 @@ const bool ModelInstance::checkBatchSizeMismatch(const ovms::TensorInfo& network
 const bool ModelInstance::checkShapeMismatch(const ovms::TensorInfo& networkInput,
     const tensorflow::TensorProto& requestInput,
     const Mode& batchingMode) {
-    // Network and request must have the same shape
-    auto& shape = networkInput.getShape();
+    // Network and request must have the same shape, in NHWC order if request data is transposed
+    const auto shape = networkInput.getRequestShape();
     int i = (batchingMode == AUTO) ? 1 : 0;  // If batch size is automatic, omit first dimension
     for (; i < requestInput.tensor_shape().dim_size(); i++) {
+        if (requestInput.tensor_shape().dim(i).size() <= 0 && networkInput.isResizedDimension(i)) {
+            return true;
+        }
         if (requestInput.tensor_shape().dim(i).size() < 0 ||
-            shape[i] != static_cast<size_t>(requestInput.tensor_shape().dim(i).size())) {
+            (shape[i] != static_cast<size_t>(requestInput.tensor_shape().dim(i).size()) && !networkInput.isResizedDimension(i))) {
             return true;
         }
     }
@@ -687,17 +2651,18 @@ const bool ModelInstance::checkShapeMismatch(const ovms::TensorInfo& networkInpu
 const Status ModelInstance::validateTensorContentSize(const ovms::TensorInfo& networkInput,
     const tensorflow::TensorProto& requestInput) {
     /*
-    int8        data in request.tensor_content
-    uint8       data in request.tensor_content
-    int16       data in request.tensor_content
-    uint16      request.tensor_content is empty, data located in request.int_val
-    int32       data in request.tensor_content
+    int8        data in request.tensor_content or request.int_val
+    uint8       data in request.tensor_content or request.int_val
+    int16       data in request.tensor_content or request.int_val
+    uint16      request.tensor_content is empty, data located in request.int_val, or packed in request.tensor_content
+    int32       data in request.tensor_content or request.int_val
     uint32      data in request.tensor_content
-    int64       data in request.tensor_content
+    int64       data in request.tensor_content or request.int64_val
     uint64      data in request.tensor_content
-    float16     request.tensor_content is empty, data located in request.half_val
-    float32     data in request.tensor_content
+    float16     request.tensor_content is empty, data located in request.half_val, or packed in request.tensor_content
+    float32     data in request.tensor_content or request.float_val
     double      data in request.tensor_content
+    bool        data in request.tensor_content or request.bool_val
 
     _TENSOR_CONTENT_TYPES
     https://github.com/tensorflow/tensorflow/blob/903a6399aab19b549fefd0ead836af644f3d00f8/tensorflow/python/framework/tensor_util.py#L237
@@ -708,48 +2673,192 @@ const Status ModelInstance::validateTensorContentSize(const ovms::TensorInfo& ne
         expectedValueCount *= requestInput.tensor_shape().dim(i).size();
     }
 
+    if (isSharedMemoryReference(requestInput)) {
+        // Region memory is used as network input in place, it cannot be converted nor transposed
+        if (isPrecisionConversionEnabled(networkInput, requestInput) || networkInput.isLayoutTransposed()) {
+            auto status = Status::withDetails(StatusCode::INVALID_SHARED_MEMORY_REFERENCE,
+                "Input: ", networkInput.getMappedName(), " requires conversion of request data");
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
+        }
+        return validateSharedMemoryReference(requestInput, expectedValueCount * networkInput.getPrecision().size());
+    }
+
     // Network expects tensor content size or value count
-    if (requestInput.dtype() == tensorflow::DataType::DT_UINT16) {
+    const bool isPaddedContent = requestInput.tensor_content().empty();
+    if (requestInput.dtype() == tensorflow::DataType::DT_UINT16 && isPaddedContent) {
         if (requestInput.int_val_size() < 0 ||
             expectedValueCount != static_cast<size_t>(requestInput.int_val_size())) {
-            std::stringstream ss;
-            ss << "Expected: " << expectedValueCount << "; Actual: " << requestInput.int_val_size();
-            const std::string details = ss.str();
-            SPDLOG_DEBUG("[Model: {} version: {}] Invalid number of values in tensor proto container - {}", getName(), getVersion(), details);
-            return Status(StatusCode::INVALID_VALUE_COUNT, details);
+            auto status = Status::withDetails(StatusCode::INVALID_VALUE_COUNT, "Expected: ", expectedValueCount, "; Actual: ", requestInput.int_val_size());
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
         }
-    } else if (requestInput.dtype() == tensorflow::DataType::DT_HALF) {
+    } else if (requestInput.dtype() == tensorflow::DataType::DT_HALF && isPaddedContent) {
         if (requestInput.half_val_size() < 0 ||
             expectedValueCount != static_cast<size_t>(requestInput.half_val_size())) {
-            std::stringstream ss;
-            ss << "Expected: " << expectedValueCount << "; Actual: " << requestInput.half_val_size();
-            const std::string details = ss.str();
-            SPDLOG_DEBUG("[Model: {} version: {}] Invalid number of values in tensor proto container - {}", getName(), getVersion(), details);
-            return Status(StatusCode::INVALID_VALUE_COUNT, details);
+            auto status = Status::withDetails(StatusCode::INVALID_VALUE_COUNT, "Expected: ", expectedValueCount, "; Actual: ", requestInput.half_val_size());
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
+        }
+    } else if (isPaddedContent && getRepeatedFieldValueCount(requestInput) > 0) {
+        if (expectedValueCount != static_cast<size_t>(getRepeatedFieldValueCount(requestInput))) {
+            auto status = Status::withDetails(StatusCode::INVALID_VALUE_COUNT, "Expected: ", expectedValueCount, "; Actual: ", getRepeatedFieldValueCount(requestInput));
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
         }
     } else {
-        size_t expectedContentSize = expectedValueCount * networkInput.getPrecision().size();
+        size_t elementSize = networkInput.getPrecision().size();
+        if (isPrecisionConversionEnabled(networkInput, requestInput)) {
+            // converted values are sent in request precision
+            elementSize = tensorflow::DataTypeSize(requestInput.dtype());
+        }
+        size_t expectedContentSize = expectedValueCount * elementSize;
         if (expectedContentSize != requestInput.tensor_content().size()) {
-            std::stringstream ss;
-            ss << "Expected: " << expectedContentSize << " bytes; Actual: " << requestInput.tensor_content().size() << " bytes";
-            const std::string details = ss.str();
-            SPDLOG_DEBUG("[Model: {} version: {}] Invalid content size of tensor proto - {}", getName(), getVersion(), details);
-            return Status(StatusCode::INVALID_CONTENT_SIZE, details);
+            auto status = Status::withDetails(StatusCode::INVALID_CONTENT_SIZE,
+                "Expected: ", expectedContentSize, " bytes; Actual: ", requestInput.tensor_content().size(), " bytes");
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
         }
     }
     return StatusCode::OK;
 }
 
+const Status ModelInstance::validateImageInput(const ovms::TensorInfo& networkInput,
+    const tensorflow::TensorProto& requestInput) {
+    // Request carries one encoded image per batch, decoded images are resized to network input
+    if (requestInput.tensor_shape().dim_size() != 1) {
+        auto status = Status::withDetails(StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS,
+            "Expected: (", getBatchSize(), ") for encoded images; Actual: ", TensorInfo::tensorShapeToString(requestInput.tensor_shape()));
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+        return status;
+    }
+    if (checkBatchSizeMismatch(networkInput, requestInput)) {
+        if (getModelConfig().getBatchingMode() == AUTO && requestInput.tensor_shape().dim(0).size() > 0) {
+            return StatusCode::BATCHSIZE_CHANGE_REQUIRED;
+        }
+        auto status = Status::withDetails(StatusCode::INVALID_BATCH_SIZE,
+            "Expected: ", (dynamicBatcher ? "at most " : ""), getBatchSize(), "; Actual: ", requestInput.tensor_shape().dim(0).size());
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+        return status;
+    }
+    if (requestInput.string_val_size() != requestInput.tensor_shape().dim(0).size()) {
+        auto status = Status::withDetails(StatusCode::INVALID_VALUE_COUNT,
+            "Expected: ", requestInput.tensor_shape().dim(0).size(), " images; Actual: ", requestInput.string_val_size());
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+        return status;
+    }
+    return StatusCode::OK;
+}
+
+void ModelInstance::prepareValidationPlan() {
+    validationPlan.clear();
+    // shapes of requests to resized inputs vary, they are always validated in full
+    for (const auto& [mappedName, networkInput] : inputsInfo) {
+        if (networkInput->isResized()) {
+            return;
+        }
+    }
+    validationPlan.reserve(inputsInfo.size());
+    for (const auto& [mappedName, networkInput] : inputsInfo) {
+        ValidationPlanInput input;
+        input.name = mappedName;
+        input.dtype = networkInput->getPrecisionAsDataType();
+        input.shape = networkInput->getRequestShape();
+        const size_t valueCount = std::accumulate(input.shape.begin(), input.shape.end(), size_t(1), std::multiplies<size_t>());
+        input.contentSize = valueCount * networkInput->getPrecision().size();
+        input.convertedDtype = tensorflow::DataType::DT_INVALID;
+        input.convertedContentSize = 0;
+        for (auto dtype : {tensorflow::DataType::DT_FLOAT, tensorflow::DataType::DT_INT64}) {
+            if (config.isInputConversionEnabled(networkInput->getName(), TensorInfo::getDataTypeAsString(dtype)) &&
+                isPrecisionConversionSupported(TensorInfo::getDataTypeAsString(dtype), networkInput->getPrecision())) {
+                input.convertedDtype = dtype;
+                input.convertedContentSize = valueCount * tensorflow::DataTypeSize(dtype);
+            }
+        }
+        validationPlan.push_back(std::move(input));
+    }
+}
+
+bool ModelInstance::matchesValidationPlan(const tensorflow::serving::PredictRequest* request) const {
+    const int specialInputs = sequenceManager ? static_cast<int>(countSequenceSpecialInputs(*request)) : 0;
+    if (validationPlan.empty() || validationPlan.size() != static_cast<size_t>(request->inputs_size() - specialInputs)) {
+        return false;
+    }
+    for (const auto& input : validationPlan) {
+        auto it = request->inputs().find(input.name);
+        if (it == request->inputs().end()) {
+            return false;
+        }
+        const auto& requestInput = it->second;
+        size_t expectedContentSize = input.contentSize;
+        if (requestInput.dtype() != input.dtype) {
+            if (input.convertedDtype == tensorflow::DataType::DT_INVALID || requestInput.dtype() != input.convertedDtype) {
+                return false;
+            }
+            expectedContentSize = input.convertedContentSize;
+        }
+        const auto& dims = requestInput.tensor_shape().dim();
+        if (dims.size() <= 0 || static_cast<size_t>(dims.size()) != input.shape.size()) {
+            return false;
+        }
+        int i = 0;
+        if (dynamicBatcher) {
+            // Batch gathered on the server side can contain requests of any batch size up to the network one
+            const auto requestBatchSize = dims[0].size();
+            if (requestBatchSize <= 0 || static_cast<size_t>(requestBatchSize) > input.shape[0]) {
+                return false;
+            }
+            expectedContentSize = expectedContentSize / input.shape[0] * requestBatchSize;
+            i = 1;
+        }
+        for (; i < dims.size(); i++) {
+            if (dims[i].size() != static_cast<int64_t>(input.shape[i])) {
+                return false;
+            }
+        }
+        if (requestInput.tensor_content().size() != expectedContentSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
 const Status ModelInstance::validate(const tensorflow::serving::PredictRequest* request) {
+    // Requested outputs have to exist, empty filter requests all of them
+    for (const auto& entry : request->output_filter()) {
+        const std::string outputName(getOutputFilterEntryName(entry));
+        if (getOutputsInfo().count(outputName) == 0) {
+            auto status = Status::withDetails(StatusCode::INVALID_MISSING_OUTPUT, "Requested output: ", outputName);
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
+        }
+        // Size of output written into region is checked once it is serialized
+        std::optional<SharedMemoryReference> destination;
+        auto status = getOutputFilterEntryDestination(entry, destination);
+        if (!status.ok()) {
+            return status;
+        }
+        if (destination && SharedMemoryRegistry::getInstance().findRegion(destination->regionName) == nullptr) {
+            status = Status::withDetails(StatusCode::INVALID_SHARED_MEMORY_REFERENCE,
+                "Region: ", destination->regionName, " of output: ", outputName, " is not registered");
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
+        }
+    }
+
+    // Most requests are valid, detailed validation is done only to find out why request does not match the plan
+    if (matchesValidationPlan(request)) {
+        return StatusCode::OK;
+    }
+
     Status finalStatus = StatusCode::OK;
 
-    // Network and request must have the same amount of inputs
-    if (request->inputs_size() < 0 || getInputsInfo().size() != static_cast<size_t>(request->inputs_size())) {
-        std::stringstream ss;
-        ss << "Expected: " << getInputsInfo().size() << "; Actual: " << request->inputs_size();
-        const std::string details = ss.str();
-        SPDLOG_DEBUG("[Model: {} version: {}] Invalid number of inputs - {}", getName(), getVersion(), details);
-        return Status(StatusCode::INVALID_NO_OF_INPUTS, details);
+    // Network and request must have the same amount of inputs, sequence inputs of stateful models are not passed to network
+    const int requestInputsSize = request->inputs_size() - (sequenceManager ? static_cast<int>(countSequenceSpecialInputs(*request)) : 0);
+    if (requestInputsSize < 0 || getInputsInfo().size() != static_cast<size_t>(requestInputsSize)) {
+        auto status = Status::withDetails(StatusCode::INVALID_NO_OF_INPUTS, "Expected: ", getInputsInfo().size(), "; Actual: ", requestInputsSize);
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+        return status;
     }
 
     for (const auto& pair : getInputsInfo()) {
@@ -759,17 +2868,25 @@ const Status ModelInstance::validate(const tensorflow::serving::PredictRequest*
 
         // Network and request must have the same names of inputs
         if (it == request->inputs().end()) {
-            std::stringstream ss;
-            ss << "Required input: " << name;
-            const std::string details = ss.str();
-            SPDLOG_DEBUG("[Model: {} version: {}] Missing input with specific name - {}", getName(), getVersion(), details);
-            return Status(StatusCode::INVALID_MISSING_INPUT, details);
+            auto status = Status::withDetails(StatusCode::INVALID_MISSING_INPUT, "Required input: ", name);
+            OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+            return status;
         }
 
         auto& requestInput = it->second;
         Mode batchingMode = getModelConfig().getBatchingMode();
         Mode shapeMode = getModelConfig().isShapeAuto(name) ? AUTO : FIXED;
 
+        if (isImageInputRequested(requestInput, *networkInput)) {
+            auto status = validateImageInput(*networkInput, requestInput);
+            if (status == StatusCode::BATCHSIZE_CHANGE_REQUIRED) {
+                finalStatus = status;
+            } else if (!status.ok()) {
+                return status;
+            }
+            continue;
+        }
+
         auto status = validatePrecision(*networkInput, requestInput);
         if (!status.ok())
             return status;
@@ -782,24 +2899,22 @@ const Status ModelInstance::validate(const tensorflow::serving::PredictRequest*
             if (batchingMode == AUTO) {
                 finalStatus = StatusCode::BATCHSIZE_CHANGE_REQUIRED;
             } else if (shapeMode != AUTO) {
-                std::stringstream ss;
-                ss << "Expected: " << getBatchSize() << "; Actual: " << requestInput.tensor_shape().dim(0).size();
-                const std::string details = ss.str();
-                SPDLOG_DEBUG("[Model: {} version: {}] Invalid batch size - {}", getName(), getVersion(), details);
-                return Status(StatusCode::INVALID_BATCH_SIZE, details);
+                status = Status::withDetails(StatusCode::INVALID_BATCH_SIZE,
+                    "Expected: ", (dynamicBatcher ? "at most " : ""), getBatchSize(), "; Actual: ", requestInput.tensor_shape().dim(0).size());
+                OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+                return status;
             }
         }
 
-        if (checkShapeMismatch(*networkInput, requestInput, batchingMode)) {
+        // Batch dimension was already validated against dynamic batcher or batch split limits
+        if (checkShapeMismatch(*networkInput, requestInput, (dynamicBatcher || batchSplit || batchPadding) ? AUTO : batchingMode)) {
             if (shapeMode == AUTO) {
                 finalStatus = StatusCode::RESHAPE_REQUIRED;
             } else {
-                std::stringstream ss;
-                ss << "Expected: " << TensorInfo::shapeToString(networkInput->getShape())
-                   << "; Actual: " << TensorInfo::tensorShapeToString(requestInput.tensor_shape());
-                const std::string details = ss.str();
-                SPDLOG_DEBUG("[Model: {} version: {}] Invalid shape - {}", getName(), getVersion(), details);
-                return Status(StatusCode::INVALID_SHAPE, details);
+                status = Status::withDetails(StatusCode::INVALID_SHAPE,
+                    "Expected: ", TensorInfo::shapeToString(networkInput->getRequestShape()), "; Actual: ", TensorInfo::tensorShapeToString(requestInput.tensor_shape()));
+                OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", getName(), getVersion(), status.string());
+                return status;
             }
         }
 
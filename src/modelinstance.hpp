@@ -15,10 +15,13 @@
 //*****************************************************************************
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -31,14 +34,30 @@
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #pragma GCC diagnostic pop
 
+#include "autotuning.hpp"
 #include "customloaderconfig.hpp"
 #include "customloaderinterface.hpp"
+#include "dynamicbatcher.hpp"
+#include "inferrequestpools.hpp"
+#include "loadprofile.hpp"
+#include "lrucache.hpp"
+#include "metadatacache.hpp"
 #include "modelchangesubscription.hpp"
 #include "modelconfig.hpp"
 #include "modelinstanceunloadguard.hpp"
+#include "modelmetrics.hpp"
+#include "modelsmemorybudget.hpp"
 #include "modelversionstatus.hpp"
+#include "numa.hpp"
 #include "ovinferrequestsqueue.hpp"
+#include "responsecache.hpp"
+#include "saturation.hpp"
+#include "sequencemanager.hpp"
+#include "shapeprofile.hpp"
+#include "shardedcounter.hpp"
+#include "singleflight.hpp"
 #include "status.hpp"
+#include "streamsbudget.hpp"
 #include "tensorinfo.hpp"
 
 namespace ovms {
@@ -59,6 +78,7 @@ public:
 
     bool isBatchSizeRequested() const { return batchSize > 0; }
     bool isShapeRequested(const std::string& name) const { return shapes.count(name) && shapes.at(name).size() > 0; }
+    bool isDefault() const { return batchSize == 0 && shapes.empty(); }
 
     int getBatchSize() const { return batchSize; }
     const shape_t& getShape(const std::string& name) const { return shapes.at(name); }
@@ -68,17 +88,29 @@ private:
     std::map<std::string, shape_t> shapes;
 };
 
+class FileSystem;
 class PipelineDefinition;
 
 /**
      * @brief This class contains all the information about inference engine model
      */
-class ModelInstance {
+class ModelInstance : public std::enable_shared_from_this<ModelInstance> {
 protected:
     /**
-         * @brief Inference Engine core object
+         * @brief Inference Engine core object, shared by all model instances
          */
-    std::unique_ptr<InferenceEngine::Core> engine;
+    std::shared_ptr<InferenceEngine::Core> engine;
+
+    /**
+         * @brief Memory weights of the network are read from without a copy, mapped weights file or memory of custom loader.
+         * Declared before the networks so that it outlives them.
+         */
+    std::shared_ptr<const void> mappedWeights;
+
+    /**
+         * @brief Weights memory of the network execNetwork was compiled from, plugins may keep referencing constants of the network
+         */
+    std::shared_ptr<const void> execNetworkMappedWeights;
 
     /**
          * @brief Inference Engine CNNNetwork object
@@ -90,6 +122,17 @@ protected:
          */
     std::shared_ptr<InferenceEngine::ExecutableNetwork> execNetwork;
 
+    /**
+         * @brief Precompiled network returned by custom loader, imported instead of compiling network and released once imported
+         */
+    std::shared_ptr<const uint8_t> importedNetworkBlob;
+    size_t importedNetworkBlobSize = 0;
+
+    /**
+         * @brief Batch size of network imported from precompiled blob, which has no CNNNetwork to read it from
+         */
+    size_t importedBatchSize = 0;
+
     /**
          * @brief Model name
          */
@@ -128,10 +171,55 @@ protected:
     virtual std::unique_ptr<InferenceEngine::CNNNetwork> loadOVCNNNetworkPtr(const std::string& modelFile);
 
     /**
-         * @brief Load OV Engine
+         * @brief Reads IR network with weights file mapped into memory instead of reading it into the heap
+         *
+         * @param modelFile .xml file
+         * @param weightsFile .bin file
+         *
+         * @return Status
+         */
+    Status loadOVCNNNetworkWithMappedWeights(const std::string& modelFile, const std::string& weightsFile);
+
+    /**
+         * @brief Reads IR network with weights buffer shared with other networks read from identical weights files
+         *
+         * @param modelFile .xml file
+         * @param weightsFile .bin file, mapped when mmap_model_weights is set
+         *
+         * @return Status
+         */
+    Status loadOVCNNNetworkWithSharedWeights(const std::string& modelFile, const std::string& weightsFile);
+
+    /**
+         * @brief Reads IR converted from ONNX model stored in compiled network cache, the ONNX model is read
+         * and converted when it is not cached yet
+         *
+         * @param modelFile .onnx file
+         *
+         * @return Status
+         */
+    Status loadOVCNNNetworkConvertedFromOnnx(const std::string& modelFile);
+
+    /**
+         * @brief Reads network from model files contents fetched from cloud storage, weights blob points to the fetched buffer
+         *
+         * @return Status
+         */
+    Status loadOVCNNNetworkFromMemory();
+
+    /**
+         * @brief Load OV Engine, shared by all model instances
          */
     void loadOVEngine();
 
+    /**
+         * @brief Gets inference engine core shared by all model instances, so plugins, extensions and their thread pools
+         * are initialized once. Created on first use and destroyed when the last instance using it is unloaded.
+         *
+         * @return core with custom CPU extension added
+         */
+    static std::shared_ptr<InferenceEngine::Core> getSharedEngine();
+
     /**
          * @brief Loads OV CNNNetwork
          *
@@ -144,6 +232,11 @@ protected:
          */
     virtual void loadExecutableNetworkPtr(const plugin_config_t& pluginConfig);
 
+    /**
+         * @brief Compiles network for the device or imports it from compiled network cache when enabled
+         */
+    std::shared_ptr<InferenceEngine::ExecutableNetwork> compileExecutableNetwork(const std::string& device, const plugin_config_t& pluginConfig);
+
     /**
          * @brief Loads OV ExecutableNetwork
          *
@@ -163,6 +256,20 @@ protected:
          */
     Status fetchModelFilepaths();
 
+    /**
+         * @brief Finds model files of a version streamed from cloud storage and reads their contents into memory
+         *
+         * @return Status
+         */
+    Status fetchStreamedModelFiles();
+
+    /**
+         * @brief Creates file system used to read model files streamed from cloud storage
+         *
+         * @return file system matching the model path
+         */
+    virtual std::shared_ptr<FileSystem> createModelFilesystem() const;
+
     /**
          * @brief Find file path with extension in model path
          *
@@ -198,6 +305,26 @@ protected:
          */
     Status loadOVCNNNetworkUsingCustomLoader();
 
+    /**
+         * @brief Creates execution stream pool of the network, the version and each of its replicas get their own
+         *
+         * @param network
+         * @param nireq number of infer requests handed out
+         * @param maxNireq number of infer requests the queue can be resized to
+         *
+         * @return execution stream pool
+         */
+    virtual std::unique_ptr<OVInferRequestsQueue> createInferRequestsQueue(InferenceEngine::ExecutableNetwork& network, uint32_t nireq, uint32_t maxNireq) {
+        return std::make_unique<OVInferRequestsQueue>(network, nireq, maxNireq);
+    }
+
+    /**
+         * @brief Creates instance compiling network of this version for another shape or batch size
+         */
+    virtual std::shared_ptr<ModelInstance> createShapeVariant() const {
+        return std::make_shared<ModelInstance>(getName(), getVersion());
+    }
+
 private:
     /**
          * @brief Holds the information about inputs and it's parameters
@@ -214,23 +341,335 @@ private:
       */
     std::vector<std::string> modelFiles;
 
+    /**
+      * @brief Hash of model files content, part of compiled network cache keys, computed on first use in each load
+      */
+    std::string modelFilesHash;
+
+    /**
+      * @brief Contents of model files read straight from cloud storage, in modelFiles order, released once the network is read
+      */
+    std::vector<std::shared_ptr<const std::string>> modelContents;
+
+    /**
+      * @brief Sum of sizes of model files read straight from cloud storage
+      */
+    size_t streamedFilesSize = 0;
+
+    /**
+         * @brief Streams and nireq chosen by auto-tuning, zeros when model is not auto-tuned
+         */
+    TuningCandidate tuning;
+
+    /**
+         * @brief Streams and nireq assigned by streams budget, 0 when streams of the model are not rebalanced
+         */
+    uint32_t rebalancedStreams = 0;
+
+    /**
+         * @brief Queue statistics at the previous autoscaling check
+         */
+    struct InferRequestsAutoscalingSample {
+        bool valid = false;
+        std::chrono::steady_clock::time_point time;
+        uint64_t waits = 0;
+        uint64_t waitMicroseconds = 0;
+        uint64_t streamHoldMicroseconds = 0;
+    };
+    InferRequestsAutoscalingSample autoscalingSample;
+
+    /**
+         * @brief Number of infer requests the queues were created with
+         */
+    size_t minAutoscaledInferRequests = 0;
+
+    /**
+         * @brief Resizes queues of the instance and its replicas, has to be called with loading lock held
+         */
+    Status resizeInferRequestsQueues(uint32_t nireq);
+
+    /**
+         * @brief Checks if streams of the model can be set by streams budget, the model must not fix streams nor nireq
+         */
+    bool isStreamsRebalancingSupported(const ModelConfig& config) const;
+
+    /**
+      * @brief Memory attributed to the loaded version, response cache part is taken from the cache when reported
+      */
+    ModelMemoryUsage memoryUsage;
+    mutable std::mutex memoryUsageMutex;
+
+    /**
+      * @brief Phase durations of the latest successful load
+      */
+    LoadProfile loadProfile;
+    mutable std::mutex loadProfileMutex;
+
+    /**
+      * @brief Memory reserved in models memory budget, estimated before loading and measured after it
+      */
+    size_t memoryReservation = 0;
+
+    /**
+      * @brief Sum of model files sizes
+      */
+    size_t getModelFilesSize() const;
+
+    /**
+      * @brief Sum of input and output blobs sizes of all infer requests
+      */
+    size_t getInferRequestsMemory() const;
+
+    /**
+      * @brief Releases memory reserved in models memory budget
+      */
+    void releaseMemory();
+
+    /**
+         * @brief Request input expected by validation plan
+         */
+    struct ValidationPlanInput {
+        std::string name;
+        tensorflow::DataType dtype;
+        tensorflow::DataType convertedDtype;
+        shape_t shape;
+        size_t contentSize;
+        size_t convertedContentSize;
+    };
+
+    /**
+         * @brief Inputs of valid requests with data in tensor_content, prepared at load time.
+         * Requests not matching it go through detailed validation which builds error details.
+         */
+    std::vector<ValidationPlanInput> validationPlan;
+
+    /**
+         * @brief Requests with bigger batch size than the network one are split, enabled in model config
+         * when all inputs and outputs have batch in 0th dimension
+         */
+    bool batchSplit = false;
+
+    /**
+         * @brief Requests with smaller batch size than the network one are padded, enabled in model config
+         * when all inputs and outputs have batch in 0th dimension
+         */
+    bool batchPadding = false;
+
     /**
          * @brief OpenVINO inference execution stream pool
          */
     std::unique_ptr<OVInferRequestsQueue> inferRequestsQueue;
 
     /**
-         * @brief Holds current usage count in predict requests
+         * @brief Client of the inference scheduler shared by queues of the version and its replicas, kept over reloads
+         */
+    std::shared_ptr<InferenceScheduler::Client> schedulerClient;
+
+    /**
+         * @brief Infer requests reserved for direct traffic or pipelines, keyed by pool name, carved out of the primary network nireq
+         */
+    std::map<std::string, std::unique_ptr<OVInferRequestsQueue>> inferRequestsPools;
+
+    /**
+         * @brief Gathers concurrent requests into a single inference, enabled in model config
+         */
+    std::unique_ptr<DynamicBatcher> dynamicBatcher;
+
+    /**
+         * @brief Memory states of sequences, created only for stateful models
+         */
+    std::unique_ptr<SequenceManager> sequenceManager;
+
+    /**
+         * @brief Live throughput and latency statistics, shared with shape variants and kept across reloads
+         */
+    std::shared_ptr<ModelMetrics> metrics = std::make_shared<ModelMetrics>();
+
+protected:
+    /**
+         * @brief Model instances compiled for request shapes different than the loaded one, keyed by shape signature
+         */
+    LRUCache<std::string, std::shared_ptr<ModelInstance>> shapeVariants;
+
+    /**
+         * @brief Model instance compiled in background for the latest requested shape when shape cache is not used
+         */
+    LRUCache<std::string, std::shared_ptr<ModelInstance>> stagedReshapes{1};
+
+    /**
+         * @brief Requests for shapes different than the loaded one by shape signature, persisted for precompilation
+         */
+    ShapeHistogram shapeHistogram;
+
+    /**
+         * @brief Cleared for shape variants, which neither count shapes nor precompile them
+         */
+    bool shapeProfileEnabled = true;
+
+    /**
+         * @brief Set once persisted shape history is merged into the histogram, reloads do not merge it again
+         */
+    bool shapeHistoryLoaded = false;
+
+    /**
+         * @brief Guards state of the precompilation task, which reads config and inputs info without loading lock
+         */
+    std::mutex precompilationMutex;
+    std::condition_variable precompilationStopped;
+    /**
+         * @brief Incremented by each load and unload, tasks scheduled before it stop
+         */
+    uint64_t precompilationGeneration = 0;
+    bool precompilationRunning = false;
+
+    /**
+         * @brief Queues background compilation of the most frequent shapes from persisted traffic history,
+         * into shape variants or staged reshape when shape cache is not used
+         */
+    void scheduleShapePrecompilation();
+
+    /**
+         * @brief Compiles networks for shape signatures which are not cached yet, stops when the version is loaded again or unloaded
+         *
+         * @param generation of precompilation when the task was scheduled
+         */
+    void precompileShapeVariants(const std::vector<std::string>& keys, uint64_t generation);
+
+    /**
+         * @brief Stops scheduled precompilation and waits until the running one finishes its current compilation,
+         * called under loading lock before config or network are replaced
+         */
+    void cancelShapePrecompilation();
+
+private:
+    /**
+         * @brief Staged instance whose executable networks are taken over by reload in progress, set under loading lock
+         */
+    std::shared_ptr<ModelInstance> stagedReshape;
+
+    /**
+         * @brief Staged instance compiled with streams assigned by streams budget, taken over by reload in progress, set under loading lock
+         */
+    std::shared_ptr<ModelInstance> stagedRebalance;
+
+    /**
+         * @brief Responses of repeated requests, cleared on each load and unload
+         */
+    ResponseCache responseCache;
+
+    /**
+         * @brief Identical requests in flight, used when single flight is enabled in model config
+         */
+    SingleFlight singleFlight;
+
+    /**
+         * @brief Executable network with its own infer requests, pinned to cpus of a single NUMA node or loaded on another device
+         */
+    struct Replica {
+        int numaNode = -1;
+        std::string device;
+        cpu_list_t cpus;
+        std::shared_ptr<InferenceEngine::ExecutableNetwork> execNetwork;
+        std::unique_ptr<OVInferRequestsQueue> inferRequestsQueue;
+        std::unique_ptr<DynamicBatcher> dynamicBatcher;
+    };
+
+    /**
+         * @brief Replicas for NUMA nodes other than the first one or for replica devices, enabled in model config.
+         * First node or target device is served by execNetwork, inferRequestsQueue and dynamicBatcher.
+         */
+    std::vector<Replica> replicas;
+
+    /**
+         * @brief Device replicas are chosen by load of their queues, NUMA replicas by the node of calling thread
+         */
+    bool routedReplicas = false;
+
+    /**
+         * @brief Cpus execNetwork streams are pinned to, NUMA node of the primary replica or cpus set by model config
+         * and CPU partitioning. Empty when streams are not pinned.
+         */
+    cpu_list_t primaryCpus;
+
+    /**
+         * @brief Holds current usage count in predict requests, sharded by thread so that guards of concurrent
+         * requests do not contend on one cache line
          * 
          * Needed for gating model unloading.
          */
-    std::atomic<uint64_t> predictRequestsHandlesCount = 0;
+    ShardedCounter predictRequestsHandlesCount;
+
+    /**
+         * @brief Notified when the last predict request handle is released while unload or reload waits for it
+         */
+    std::condition_variable inferencesFinishedNotify;
+    std::mutex inferencesFinishedMutex;
+    std::atomic<uint32_t> inferencesFinishedWaiters = 0;
+
+    /**
+         * @brief Blocks until in-flight predict requests finish or logging interval passes
+         */
+    void waitForInferencesToFinish();
+
+    /**
+         * @brief Number of requests admitted for inference and not finished yet
+         */
+    std::atomic<uint64_t> pendingRequestsCount = 0;
+
+    /**
+         * @brief Limit of pending requests taken from currently loaded config, 0 means no limit
+         */
+    std::atomic<uint64_t> maxPendingRequests = 0;
 
     /**
          * @brief Lock to disable concurrent modelinstance load/unload/reload
          */
     std::recursive_mutex loadingMutex;
 
+    /**
+         * @brief False when lazily loaded model version is registered but its network is not compiled
+         */
+    std::atomic<bool> activated{true};
+
+    /**
+         * @brief True when deactivated version kept its parsed network, model files and engine for the next activation
+         */
+    bool hibernated = false;
+
+    /**
+         * @brief Releases compiled network and infer requests of the version, keeping what is needed to compile it again
+         */
+    void hibernate();
+
+    /**
+         * @brief Drops the network kept by hibernation, e.g. when version is registered again with new config
+         */
+    void releaseHibernatedNetwork();
+
+    /**
+         * @brief Time of last request admitted by waitForLoaded, used to find idle lazily loaded versions
+         */
+    std::atomic<std::chrono::steady_clock::time_point> lastUsed{std::chrono::steady_clock::now()};
+
+    /**
+         * @brief Memory reserved in lazy models budget when version is activated, estimated from model files size
+         */
+    size_t estimatedMemoryUsage = 0;
+
+    /**
+         * @brief Registers lazily loaded model version as available without compiling its network
+         *
+         * @return status
+         */
+    Status registerLazily(const ModelConfig& config);
+
+    /**
+         * @brief Compiles network of lazily loaded model version on its first use
+         *
+         * @return status
+         */
+    Status activate();
+
     /**
          * @brief Internal method for loading inputs
          *
@@ -242,8 +681,17 @@ private:
          * @brief Internal method for loading outputs
          *
          * @param config
+         *
+         * @return status, error when additional outputs of top_k reductions or I8 encoding collide with model outputs
+         */
+    Status loadOutputTensors(const ModelConfig& config);
+
+    /**
+         * @brief Internal method for loading inputs and outputs of network imported from precompiled blob, shapes are fixed by the blob
+         *
+         * @param config
          */
-    void loadOutputTensors(const ModelConfig& config);
+    Status loadImportedTensors(const ModelConfig& config);
 
     /**
          * @brief Performs model loading
@@ -257,6 +705,143 @@ private:
          */
     void configureBatchSize(const ModelConfig& config, const DynamicModelParameter& parameter = DynamicModelParameter());
 
+    /**
+         * @brief Prepares config of model instance compiled for request shapes
+         *
+         * @param request
+         * @param validationStatus either batch size change or reshape required
+         * @param variantConfig config with fixed request batch size or shapes
+         * @param key shape signature
+         */
+    void prepareShapeVariantConfig(const tensorflow::serving::PredictRequest* request,
+        const Status& validationStatus,
+        ModelConfig& variantConfig,
+        std::string& key);
+
+    /**
+         * @brief Prepares config of model instance compiled for persisted shape signature
+         *
+         * @return false when signature does not match inputs with automatic batch size or shape
+         */
+    bool prepareShapeVariantConfig(const std::string& key, ModelConfig& variantConfig) const;
+
+    /**
+         * @brief Gets model instance from variants or compiles it on cache miss, removed from variants if compilation fails
+         *
+         * @return Status
+         */
+    Status compileShapeVariant(LRUCache<std::string, std::shared_ptr<ModelInstance>>& variants,
+        const std::string& key,
+        const ModelConfig& variantConfig,
+        std::shared_ptr<ModelInstance>& shapeVariant);
+
+    /**
+         * @brief Takes over executable networks of instance compiled for the same shapes, infer requests are created by loading
+         */
+    void adoptExecutableNetworks(const ModelInstance& compiled);
+
+    /**
+         * @brief Creates dynamic batcher if it is enabled in config
+         */
+    void prepareDynamicBatcher(const ModelConfig& config);
+
+    /**
+         * @brief Enables batch split and padding if they are set in config and supported by network inputs and outputs
+         */
+    void prepareBatchSplit(const ModelConfig& config);
+
+    /**
+         * @brief Runs synthetic inferences on every infer request so the first requests do not pay for lazy initialization
+         *
+         * @param config
+         *
+         * @return Status
+         */
+    Status warmup(const ModelConfig& config);
+
+    /**
+         * @brief Reads warmup data of each input from <data_path>/<input name>.bin
+         *
+         * @param config
+         * @param warmupData raw input data keyed by network input name, empty if zeros should be used
+         *
+         * @return Status
+         */
+    Status readWarmupData(const ModelConfig& config, std::map<std::string, std::string>& warmupData);
+
+    /**
+         * @brief Fills inputs of all infer requests of the pool and runs them concurrently
+         *
+         * @param inferRequestsQueue
+         * @param warmupData
+         * @param iterations
+         *
+         * @return Status
+         */
+    Status warmupInferRequestsQueue(OVInferRequestsQueue& inferRequestsQueue, const std::map<std::string, std::string>& warmupData, size_t iterations);
+
+    /**
+         * @brief Chooses streams and nireq by benchmarking candidates on synthetic inputs, or takes result stored by previous load.
+         * Failures are logged and leave default streams and nireq.
+         *
+         * @param config
+         */
+    void autoTune(const ModelConfig& config);
+
+    /**
+         * @brief Compiles network with candidate streams and measures inferences of candidate nireq running at once
+         *
+         * @param candidate
+         * @param pinnedCpus cpus the network is compiled on, so streams threads inherit their affinity, empty to leave it unpinned
+         * @param pluginConfig
+         * @param measurement
+         *
+         * @return Status
+         */
+    Status benchmarkTuningCandidate(const TuningCandidate& candidate, const cpu_list_t& pinnedCpus, plugin_config_t pluginConfig, TuningMeasurement& measurement);
+
+    /**
+         * @brief Loads executable network on each NUMA node from a thread pinned to the node cpus
+         *
+         * @param numaNodes
+         * @param pluginConfig
+         */
+    void loadNumaReplicasExecutableNetworks(const std::map<int, cpu_list_t>& numaNodes, plugin_config_t& pluginConfig);
+
+    /**
+         * @brief Create executable network with streams pinned to cpus
+         */
+    void loadPinnedExecutableNetwork(const cpu_list_t& cpus, plugin_config_t& pluginConfig);
+
+    /**
+         * @brief Loads replicas count executable networks on target device, on CPU streams of each are pinned to a separate group of cpus
+         *
+         * @param replicasCount
+         * @param cpus split between replicas, all allowed cpus if empty
+         * @param pluginConfig
+         */
+    void loadTargetDeviceReplicasExecutableNetworks(uint32_t replicasCount, const cpu_list_t& cpus, const plugin_config_t& pluginConfig);
+
+    /**
+         * @brief Loads executable network on each of replica devices
+         *
+         * @param config
+         */
+    void loadDeviceReplicasExecutableNetworks(const ModelConfig& config);
+
+    /**
+         * @brief Gets least loaded device replica or replica of NUMA node calling thread runs on
+         *
+         * @return Replica or nullptr if request should be served by the primary executable network
+         */
+    Replica* getServingReplica();
+
+    /**
+         * @brief Checks if request input of other precision is accepted for network input as configured in input_conversion
+         */
+    bool isPrecisionConversionEnabled(const ovms::TensorInfo& networkInput,
+        const tensorflow::TensorProto& requestInput);
+
     const Status validatePrecision(const ovms::TensorInfo& networkInput,
         const tensorflow::TensorProto& requestInput);
 
@@ -273,6 +858,24 @@ private:
     const Status validateTensorContentSize(const ovms::TensorInfo& networkInput,
         const tensorflow::TensorProto& requestInput);
 
+    /**
+         * @brief Validates encoded images sent to an image input, their size is not known until they are decoded
+         */
+    const Status validateImageInput(const ovms::TensorInfo& networkInput,
+        const tensorflow::TensorProto& requestInput);
+
+    /**
+         * @brief Prepares validation plan from inputs info and model config
+         */
+    void prepareValidationPlan();
+
+    /**
+         * @brief Checks request against validation plan without allocations
+         *
+         * @return true if request is valid, false if detailed validation is needed
+         */
+    bool matchesValidationPlan(const tensorflow::serving::PredictRequest* request) const;
+
     uint32_t getNumOfParallelInferRequests(const ModelConfig& config);
     uint32_t getNumOfParallelInferRequestsUnbounded(const ModelConfig& config);
 
@@ -287,6 +890,11 @@ private:
 
     ModelChangeSubscription subscriptionManager;
 
+    /**
+         * @brief Metadata response built once per loaded model version
+         */
+    MetadataCache metadataCache;
+
 public:
     /**
          * @brief A default constructor
@@ -299,22 +907,118 @@ public:
     /**
          * @brief Destroy the Model Instance object
          */
-    virtual ~ModelInstance() = default;
+    virtual ~ModelInstance();
 
     /**
          * @brief Increases predict requests usage count
+         *
+         * @return shard of the count to pass to decreasePredictRequestsHandlesCount
          */
-    void increasePredictRequestsHandlesCount() {
-        ++predictRequestsHandlesCount;
+    size_t increasePredictRequestsHandlesCount() {
+        return predictRequestsHandlesCount.increment();
     }
 
     /**
          * @brief Decreases predict requests usage count
+         *
+         * @param shard returned by increasePredictRequestsHandlesCount
+         */
+    void decreasePredictRequestsHandlesCount(size_t shard) {
+        predictRequestsHandlesCount.decrement(shard);
+        // shards are summed only while unload or reload waits
+        if (inferencesFinishedWaiters > 0 && canUnloadInstance()) {
+            std::lock_guard<std::mutex> lock(inferencesFinishedMutex);
+            inferencesFinishedNotify.notify_all();
+        }
+    }
+
+    /**
+         * @brief Gets number of predict requests holding the instance
+         */
+    uint64_t getPredictRequestsHandlesCount() const {
+        return predictRequestsHandlesCount.get();
+    }
+
+    /**
+         * @brief Admits request for inference unless pending requests limit is reached
+         *
+         * @return false if request should be rejected
+         */
+    bool tryAdmitPendingRequest() {
+        const uint64_t limit = maxPendingRequests;
+        if (++pendingRequestsCount > limit && limit > 0) {
+            --pendingRequestsCount;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+         * @brief Releases request admitted with tryAdmitPendingRequest
+         */
+    void releasePendingRequest() {
+        --pendingRequestsCount;
+    }
+
+    /**
+         * @brief Gets the number of requests waiting for or running inference
+         *
+         * @return pending requests count
          */
-    void decreasePredictRequestsHandlesCount() {
-        --predictRequestsHandlesCount;
+    uint64_t getPendingRequestsCount() const {
+        return pendingRequestsCount;
     }
 
+    /**
+         * @brief Gets in-flight requests and streams usage summed over NUMA replicas
+         *
+         * @param saturation filled with load of the instance
+         *
+         * @return false if instance is not available or it is being reloaded
+         */
+    bool getSaturation(ModelSaturation& saturation);
+
+    /**
+         * @brief Gets load of instance with streams rebalanced by streams budget
+         *
+         * @param load filled with streams and their usage
+         *
+         * @return false if streams are not rebalanced, instance is not available or it is being reloaded
+         */
+    bool getStreamsLoad(ModelStreamsLoad& load);
+
+    /**
+         * @brief Compiles network with new number of streams in background and switches to it,
+         * requests are served by the current network until the new one is ready
+         *
+         * @param streams
+         *
+         * @return Status
+         */
+    Status rebalanceStreams(uint32_t streams);
+
+    /**
+         * @brief Changes number of infer requests without reloading, in-flight inferences are not interrupted
+         *
+         * @param nireq between 1 and max_nireq of the model, or the load time nireq if it is bigger
+         * @param appliedNireq number of infer requests handed out after the resize, it is lower than nireq
+         * when not all new infer requests could be created
+         *
+         * @return Status NIREQ_RESIZE_NOT_SUPPORTED for stateful models
+         */
+    Status resizeInferRequests(uint32_t nireq, uint32_t& appliedNireq);
+
+    /**
+         * @brief Grows infer requests queue when average wait for infer request since the previous check exceeds
+         * nireq_autoscaling_wait_ms and shrinks it back when streams are mostly idle
+         */
+    void autoscaleInferRequests();
+
+    /**
+         * @brief Stores histogram of request shapes in compiled network cache directory when it changed since the previous call
+         */
+    void persistShapeProfile();
+
     /**
          * @brief Gets the model name
          * 
@@ -366,7 +1070,27 @@ public:
          * @return batch size
          */
     virtual size_t getBatchSize() const {
-        return network->getBatchSize();
+        return network ? network->getBatchSize() : importedBatchSize;
+    }
+
+    /**
+         * @brief Checks if request with given batch size is split into several inferences of network batch size
+         *
+         * @param requestBatchSize
+         * @return bool
+         */
+    bool isBatchSplitRequired(size_t requestBatchSize) const {
+        return batchSplit && requestBatchSize > getBatchSize();
+    }
+
+    /**
+         * @brief Checks if request with given batch size is zero-padded to network batch size
+         *
+         * @param requestBatchSize
+         * @return bool
+         */
+    bool isBatchPaddingRequired(size_t requestBatchSize) const {
+        return batchPadding && requestBatchSize > 0 && requestBatchSize < getBatchSize();
     }
 
     /**
@@ -402,16 +1126,133 @@ public:
          * @return bool 
          */
     virtual bool canUnloadInstance() const {
-        return 0 == predictRequestsHandlesCount;
+        return predictRequestsHandlesCount.isZero();
     }
 
     /**
-         * @brief Get OV streams pool
+         * @brief Get OV streams pool, local to NUMA node of calling thread if NUMA replicas are enabled,
+         * least loaded one if device replicas are enabled
          * 
          * @return OVStreamsQueue
          */
     OVInferRequestsQueue& getInferRequestsQueue() {
-        return *inferRequestsQueue;
+        auto replica = getServingReplica();
+        return replica ? *replica->inferRequestsQueue : *inferRequestsQueue;
+    }
+
+    /**
+         * @brief Get OV streams pool reserved for the traffic class, direct requests or pipeline name,
+         * shared one if the model has no such pool
+         * 
+         * @return OVStreamsQueue
+         */
+    OVInferRequestsQueue& getInferRequestsQueue(const std::string& pool) {
+        auto it = inferRequestsPools.find(pool);
+        if (it == inferRequestsPools.end()) {
+            return getInferRequestsQueue();
+        }
+        return selectInferRequestsPoolQueue(*it->second, *inferRequestsQueue);
+    }
+
+    /**
+         * @brief Get OV streams pools chunks of split batch are spread over, the one reserved for the traffic class
+         * if the model has such pool, otherwise pools of the version and of each of its replicas
+         *
+         * @return queues, the first one serves execNetwork or the reserved pool
+         */
+    std::vector<OVInferRequestsQueue*> getSplitBatchInferRequestsQueues(const std::string& pool);
+
+    /**
+         * @brief Copies nGraph function of the network, so that it can be fused with functions of other pipeline models
+         * 
+         * @param compiled set to the network compiled from the copied function, replaced by each load and reshape of the model
+         *
+         * @return function or nullptr if network is not kept, e.g. when it was imported from compiled blob
+         */
+    std::shared_ptr<ngraph::Function> cloneNetworkFunction(std::shared_ptr<InferenceEngine::ExecutableNetwork>& compiled);
+
+    /**
+         * @brief Network inferred by the model, replaced by each load and reshape of the model
+         */
+    std::shared_ptr<InferenceEngine::ExecutableNetwork> getExecutableNetwork();
+
+    /**
+         * @brief Compiles network fused from this model and following pipeline models with target device and plugin config of this model
+         *
+         * @return nullptr if the model is unloaded
+         */
+    std::shared_ptr<InferenceEngine::ExecutableNetwork> compileFusedNetwork(const InferenceEngine::CNNNetwork& fusedNetwork);
+
+    /**
+         * @brief Get predict responses cache
+         * 
+         * @return ResponseCache or nullptr if the cache is disabled
+         */
+    ResponseCache* getResponseCache() {
+        return responseCache.isEnabled() ? &responseCache : nullptr;
+    }
+
+    /**
+         * @brief Get identical requests coalescing
+         * 
+         * @return SingleFlight or nullptr if single flight is disabled
+         */
+    SingleFlight* getSingleFlight() {
+        return config.isSingleFlightEnabled() ? &singleFlight : nullptr;
+    }
+
+    /**
+         * @brief Get live statistics of the model version
+         */
+    const std::shared_ptr<ModelMetrics>& getMetrics() const {
+        return metrics;
+    }
+
+    /**
+         * @brief Get dynamic batcher
+         * 
+         * @return DynamicBatcher or nullptr if dynamic batching is disabled
+         */
+    DynamicBatcher* getDynamicBatcher() {
+        auto replica = getServingReplica();
+        return replica ? replica->dynamicBatcher.get() : dynamicBatcher.get();
+    }
+
+    /**
+         * @brief Get dynamic batchers of the version and of each of its replicas
+         * 
+         * @return batchers in order of replicas, the first one serves execNetwork, empty if dynamic batching is disabled
+         */
+    std::vector<const DynamicBatcher*> getDynamicBatchers() const {
+        std::vector<const DynamicBatcher*> batchers;
+        if (!dynamicBatcher) {
+            return batchers;
+        }
+        batchers.push_back(dynamicBatcher.get());
+        for (const auto& replica : replicas) {
+            if (replica.dynamicBatcher) {
+                batchers.push_back(replica.dynamicBatcher.get());
+            }
+        }
+        return batchers;
+    }
+
+    /**
+         * @brief Get sequence manager
+         *
+         * @return SequenceManager or nullptr if model is not stateful
+         */
+    SequenceManager* getSequenceManager() {
+        return sequenceManager.get();
+    }
+
+    /**
+         * @brief Drops sequences of stateful model which exceeded sequence timeout
+         */
+    void removeIdleSequences() {
+        if (sequenceManager) {
+            sequenceManager->removeIdleSequences(std::chrono::steady_clock::now());
+        }
     }
 
     /**
@@ -421,6 +1262,13 @@ public:
          */
     static plugin_config_t prepareDefaultPluginConfig(const ModelConfig& config);
 
+    /**
+         * @brief Plugin config for one of the devices model is replicated on, keys prefixed with other device names are skipped
+         *
+         * @return plugin config
+         */
+    static plugin_config_t prepareReplicaPluginConfig(const ModelConfig& config, const std::string& device);
+
     /**
          * @brief Loads model version, reads CNN network model from files (*.xml and *.bin files) and creates inference engine
          *
@@ -458,7 +1306,62 @@ public:
     virtual void unloadModel(bool isPermanent = true);
 
     /**
-         * @brief Wait for model to change to AVAILABLE state
+         * @brief Checks if network is compiled, false only for lazily loaded versions waiting for their first use
+         *
+         * @return bool
+         */
+    bool isActivated() const {
+        return activated;
+    }
+
+    /**
+         * @brief Checks if deactivated version keeps its parsed network, so its activation does not read model files
+         *
+         * @return bool
+         */
+    bool isHibernated() const {
+        return hibernated;
+    }
+
+    /**
+         * @brief Gets memory attributed to the loaded version, all zeros when it is not loaded
+         *
+         * @return ModelMemoryUsage
+         */
+    ModelMemoryUsage getMemoryUsage() const;
+
+    /**
+         * @brief Gets phase durations of the latest successful load, all zeros before the first one
+         */
+    LoadProfile getLoadProfile() const {
+        std::lock_guard<std::mutex> lock(loadProfileMutex);
+        return loadProfile;
+    }
+
+    std::chrono::steady_clock::time_point getLastUsed() const {
+        return lastUsed;
+    }
+
+    /**
+         * @brief Deactivates lazily loaded model version, so it is compiled again on next use
+         *
+         * With idle hibernation parsed network is kept, so only its compilation is repeated.
+         * Does nothing if version is busy: it is being loaded, has inferences in progress or is used by pipelines.
+         *
+         * @param usedBefore version is deactivated only if it was last used before that time
+         *
+         * @return true if version was deactivated
+         */
+    bool deactivateIfIdle(std::chrono::steady_clock::time_point usedBefore);
+
+private:
+    bool isServable() const {
+        return this->status.getState() == ModelVersionState::AVAILABLE && activated;
+    }
+
+public:
+    /**
+         * @brief Wait for model to change to AVAILABLE state, lazily loaded version is activated if needed
          *
          * @param waitForModelLoadedTimeoutMilliseconds
          * @param modelInstanceUnloadGuard
@@ -474,6 +1377,55 @@ public:
 
     const ModelChangeSubscription& getSubscribtionManager() const { return subscriptionManager; }
 
+    /**
+         * @brief Get metadata cache, invalidated whenever model version subscribers are notified about its change
+         * 
+         * @return MetadataCache
+         */
+    MetadataCache& getMetadataCache() { return metadataCache; }
+
     const Status validate(const tensorflow::serving::PredictRequest* request);
+
+    /**
+         * @brief Checks if request should be served by a network compiled for its shape instead of reloading the model
+         *
+         * @param validationStatus
+         *
+         * @return bool
+         */
+    bool isShapeVariantRequired(const Status& validationStatus) const;
+
+    /**
+         * @brief Gets model instance compiled for request shapes. Network is compiled only on cache miss,
+         * requests for already cached shapes are not blocked meanwhile. Waiting for the variant to be loaded is up to the caller.
+         *
+         * @param request
+         * @param validationStatus either batch size change or reshape required
+         * @param shapeVariant
+         *
+         * @return Status
+         */
+    Status getShapeVariant(const tensorflow::serving::PredictRequest* request,
+        const Status& validationStatus,
+        std::shared_ptr<ModelInstance>& shapeVariant);
+
+    /**
+         * @brief Reloads model version with request batch size or shape. Network for the new shape is compiled in background,
+         * meanwhile requests matching the current shape are served and only requests for the new shape wait.
+         * Loading lock is taken just to swap the executable network and recreate infer requests.
+         *
+         * @param request
+         * @param validationStatus either batch size change or reshape required
+         * @param parameter new batch size or shapes
+         * @param waitForModelLoadedTimeoutMilliseconds time to wait for network compiled by concurrent request for the same shape
+         * @param unloadGuard released for the reload, set again on success
+         *
+         * @return Status
+         */
+    Status reloadModelInBackground(const tensorflow::serving::PredictRequest* request,
+        const Status& validationStatus,
+        const DynamicModelParameter& parameter,
+        const uint waitForModelLoadedTimeoutMilliseconds,
+        std::unique_ptr<ModelInstanceUnloadGuard>& unloadGuard);
 };
 }  // namespace ovms
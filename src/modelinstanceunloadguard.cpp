@@ -19,11 +19,11 @@
 
 namespace ovms {
 ModelInstanceUnloadGuard::ModelInstanceUnloadGuard(ModelInstance& modelInstance) :
-    modelInstance(modelInstance) {
-    modelInstance.increasePredictRequestsHandlesCount();
+    modelInstance(modelInstance),
+    shard(modelInstance.increasePredictRequestsHandlesCount()) {
 }
 
 ModelInstanceUnloadGuard::~ModelInstanceUnloadGuard() {
-    modelInstance.decreasePredictRequestsHandlesCount();
+    modelInstance.decreasePredictRequestsHandlesCount(shard);
 }
 }  // namespace ovms
@@ -15,6 +15,8 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstddef>
+
 namespace ovms {
 class ModelInstance;
 
@@ -26,5 +28,7 @@ public:
 
 private:
     ModelInstance& modelInstance;
+    // shard of in-flight requests count incremented by the guard
+    const size_t shard;
 };
 }  // namespace ovms
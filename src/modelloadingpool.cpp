@@ -0,0 +1,115 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "modelloadingpool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "logging.hpp"
+
+namespace ovms {
+
+ModelLoadingPool::ModelLoadingPool(size_t parallelism) :
+    parallelism(std::max<size_t>(parallelism, 1)) {}
+
+ModelLoadingPool::~ModelLoadingPool() {
+    waitAll();
+}
+
+void ModelLoadingPool::submit(const std::string& modelName, load_function_t load) {
+    std::unique_lock lock(mtx);
+    pendingTasks.push_back({modelName, std::move(load)});
+    progress[modelName].pendingCount++;
+    submittedCount++;
+    if (runningWorkersCount < parallelism) {
+        runningWorkersCount++;
+        workers.emplace_back(&ModelLoadingPool::run, this);
+    }
+}
+
+void ModelLoadingPool::run() {
+    std::unique_lock lock(mtx);
+    while (true) {
+        // loads of the same model are serialized, they would race on its versions
+        auto it = std::find_if(pendingTasks.begin(), pendingTasks.end(), [this](const Task& task) {
+            return loadingModels.count(task.modelName) == 0;
+        });
+        if (it == pendingTasks.end()) {
+            // remaining tasks are picked up by workers loading their models
+            break;
+        }
+        Task task = std::move(*it);
+        pendingTasks.erase(it);
+        loadingModels.insert(task.modelName);
+        lock.unlock();
+
+        SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Started loading model: {}", task.modelName);
+        auto start = std::chrono::steady_clock::now();
+        Status status;
+        try {
+            status = task.load();
+        } catch (const std::exception& e) {
+            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Exception occurred while loading model: {}; {}", task.modelName, e.what());
+            status = StatusCode::UNKNOWN_ERROR;
+        }
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        loadingModels.erase(task.modelName);
+        auto& modelProgress = progress[task.modelName];
+        modelProgress.pendingCount--;
+        modelProgress.lastStatus = status;
+        finishedCount++;
+        SPDLOG_LOGGER_INFO(modelmanager_logger, "Loading model: {} finished in {} ms with status: {}; {} of {} models loaded",
+            task.modelName, elapsedMs, status.string(), finishedCount, submittedCount);
+        finishedCondition.notify_all();
+    }
+    runningWorkersCount--;
+}
+
+Status ModelLoadingPool::wait(const std::string& modelName) {
+    std::unique_lock lock(mtx);
+    auto it = progress.find(modelName);
+    if (it == progress.end()) {
+        return StatusCode::OK;
+    }
+    finishedCondition.wait(lock, [&it]() { return it->second.pendingCount == 0; });
+    return it->second.lastStatus;
+}
+
+void ModelLoadingPool::waitAll() {
+    std::unique_lock lock(mtx);
+    finishedCondition.wait(lock, [this]() { return finishedCount == submittedCount; });
+    auto finishedWorkers = std::move(workers);
+    workers.clear();
+    lock.unlock();
+    for (auto& worker : finishedWorkers) {
+        worker.join();
+    }
+}
+
+size_t ModelLoadingPool::getSubmittedCount() const {
+    std::unique_lock lock(mtx);
+    return submittedCount;
+}
+
+size_t ModelLoadingPool::getFinishedCount() const {
+    std::unique_lock lock(mtx);
+    return finishedCount;
+}
+
+}  // namespace ovms
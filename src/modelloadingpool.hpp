@@ -0,0 +1,106 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Loads models on a bounded number of threads, so that networks of independent models are read and compiled concurrently
+ *
+ * Models are loaded in order of submission. Each model can be awaited on its own, which lets pipelines be validated
+ * as soon as the models they use are loaded, while the rest of the models are still loading.
+ */
+class ModelLoadingPool {
+public:
+    using load_function_t = std::function<Status()>;
+
+    /**
+     * @param parallelism maximum number of models loaded at once, 0 is treated as 1
+     */
+    ModelLoadingPool(size_t parallelism);
+
+    /**
+     * @brief Waits for all submitted models
+     */
+    ~ModelLoadingPool();
+
+    ModelLoadingPool(const ModelLoadingPool&) = delete;
+    ModelLoadingPool& operator=(const ModelLoadingPool&) = delete;
+
+    /**
+     * @brief Schedules loading of the model, model submitted again is not loaded until its previous load finishes
+     *
+     * @param modelName used for progress reporting and waiting
+     * @param load loading function, executed on one of the pool threads
+     */
+    void submit(const std::string& modelName, load_function_t load);
+
+    /**
+     * @brief Blocks until all submitted loads of the model finish
+     *
+     * @return Status of the last load, OK for models which were not submitted
+     */
+    Status wait(const std::string& modelName);
+
+    /**
+     * @brief Blocks until all submitted models are loaded
+     */
+    void waitAll();
+
+    size_t getSubmittedCount() const;
+
+    size_t getFinishedCount() const;
+
+private:
+    struct Task {
+        std::string modelName;
+        load_function_t load;
+    };
+
+    struct Progress {
+        size_t pendingCount = 0;
+        Status lastStatus = StatusCode::OK;
+    };
+
+    void run();
+
+    const size_t parallelism;
+
+    mutable std::mutex mtx;
+    std::condition_variable finishedCondition;
+    std::deque<Task> pendingTasks;
+    std::map<std::string, Progress> progress;
+    std::set<std::string> loadingModels;
+    size_t submittedCount = 0;
+    size_t finishedCount = 0;
+    size_t runningWorkersCount = 0;
+
+    std::vector<std::thread> workers;
+};
+
+}  // namespace ovms
@@ -18,10 +18,14 @@
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -29,27 +33,51 @@
 #include <rapidjson/document.h>
 #include <rapidjson/istreamwrapper.h>
 #include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <sys/stat.h>
 
 #include "azurefilesystem.hpp"
+#include "cloudlistingcache.hpp"
 #include "config.hpp"
+#include "containerlimits.hpp"
 #include "customloaders.hpp"
 #include "filesystem.hpp"
+#include "filesystemfactory.hpp"
 #include "gcsfilesystem.hpp"
 #include "localfilesystem.hpp"
+#include "lazymodelsbudget.hpp"
 #include "logging.hpp"
+#include "modelcache.hpp"
+#include "modelloadingpool.hpp"
+#include "modelsmemorybudget.hpp"
 #include "pipeline.hpp"
 #include "pipeline_factory.hpp"
 #include "s3filesystem.hpp"
 #include "schema.hpp"
+#include "streamsbudget.hpp"
 
 namespace ovms {
 
 static bool watcherStarted = false;
 
+// tag of config file directory in inotify watcher, model names are never empty
+static const std::string CONFIG_FILE_WATCH_TAG = "";
+static const std::chrono::milliseconds FILE_SYSTEM_EVENTS_QUIET_PERIOD{200};
+// shared prefix is listed instead of each model while it takes at most as many pages as checking each model does
+static const size_t CLOUD_LISTING_KEYS_PER_MODEL = 2000;
+// smaller configurations are parsed faster than threads are started
+static const size_t PARALLEL_CONFIG_PARSING_MIN_MODELS = 64;
+
 Status ModelManager::start() {
     auto& config = ovms::Config::instance();
     watcherIntervalSec = config.filesystemPollWaitSeconds();
+    modelLoadingParallelism = config.modelLoadingParallelism();
+    fileSystemEventsEnabled = config.fileSystemWatchMode() == "inotify";
+    pipelineModelsFusionEnabled = config.fusePipelineModels();
+    ModelsMemoryBudget::instance().setLimit(config.modelsMemoryBudgetMb() * 1024 * 1024);
+    LazyModelsBudget::instance().setLimit(config.lazyModelsMemoryBudgetMb() * 1024 * 1024);
+    ModelCache::instance().configure(config.cloudModelCacheDir(), config.cloudModelCacheSizeMb() * 1024 * 1024);
     Status status;
     if (config.configPath() != "") {
         status = startFromFile(config.configPath());
@@ -119,11 +147,15 @@ Status ModelManager::startFromConfig() {
         modelConfig.setBatchSize(0);
     }
 
+    updateLoadPriorities();
     return reloadModelWithVersions(modelConfig);
 }
 
 Status ModelManager::startFromFile(const std::string& jsonFilename) {
+    // without watcher there is no thread which could load the rest of models later
+    deferNonCoreModels = watcherIntervalSec > 0;
     Status status = loadConfig(jsonFilename);
+    deferNonCoreModels = false;
     if (!status.ok()) {
         return status;
     }
@@ -177,7 +209,58 @@ void processNodeOutputs(const rapidjson::Value::ConstMemberIterator& nodeOutputs
     }
 }
 
-void processPipelineConfig(rapidjson::Document& configJson, const rapidjson::Value& pipelineConfig, std::set<std::string>& pipelinesInConfigFile, PipelineFactory& factory, ModelManager& manager) {
+static std::string serializeConfigEntry(const rapidjson::Value& entry) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    entry.Accept(writer);
+    return buffer.GetString();
+}
+
+static std::set<std::string> getPipelineModelNames(const rapidjson::Value& pipelineConfig) {
+    std::set<std::string> modelNames;
+    for (const auto& nodeConfig : pipelineConfig["nodes"].GetArray()) {
+        if (nodeConfig.HasMember("model_name")) {
+            modelNames.insert(nodeConfig["model_name"].GetString());
+        }
+        if (nodeConfig.HasMember("demultiplexed_nodes")) {
+            for (const auto& demultiplexedConfig : nodeConfig["demultiplexed_nodes"].GetArray()) {
+                modelNames.insert(demultiplexedConfig["model_name"].GetString());
+            }
+        }
+    }
+    return modelNames;
+}
+
+/**
+ * @brief Waits for loading of models used by the new configuration of the pipeline and by its served definition
+ *
+ * Validation subscribes the pipeline to its models and drops subscriptions of models no longer used, which must not
+ * happen while these models are notifying their subscribers.
+ */
+static void waitForUsedModels(const std::string& pipelineName, const std::vector<NodeInfo>& info, PipelineFactory& factory, ModelLoadingPool& loadingPool) {
+    std::set<std::string> usedModels;
+    const auto insertModelNames = [&usedModels](const std::vector<NodeInfo>& nodeInfos) {
+        for (const auto& nodeInfo : nodeInfos) {
+            if (isModelNodeKind(nodeInfo.kind)) {
+                usedModels.insert(nodeInfo.modelName);
+            }
+            for (const auto& demultiplexedInfo : nodeInfo.demultiplexedNodes) {
+                usedModels.insert(demultiplexedInfo.modelName);
+            }
+        }
+    };
+    insertModelNames(info);
+    auto definition = factory.findDefinitionByName(pipelineName);
+    auto generation = definition ? definition->getServedGeneration() : nullptr;
+    if (generation) {
+        insertModelNames(generation->nodeInfos);
+    }
+    for (const auto& modelName : usedModels) {
+        loadingPool.wait(modelName);
+    }
+}
+
+void processPipelineConfig(rapidjson::Document& configJson, const rapidjson::Value& pipelineConfig, std::unordered_set<std::string>& pipelinesInConfigFile, PipelineFactory& factory, ModelManager& manager, ModelLoadingPool& loadingPool) {
     const std::string pipelineName = pipelineConfig["name"].GetString();
     SPDLOG_LOGGER_INFO(modelmanager_logger, "Reading pipeline: {} configuration", pipelineName);
     auto itr2 = pipelineConfig.FindMember("nodes");
@@ -191,7 +274,9 @@ void processPipelineConfig(rapidjson::Document& configJson, const rapidjson::Val
         nodeName = nodeConfig["name"].GetString();
 
         std::string modelName;
-        modelName = nodeConfig["model_name"].GetString();
+        if (nodeConfig.HasMember("model_name")) {
+            modelName = nodeConfig["model_name"].GetString();
+        }
 
         const std::string nodeKindStr = nodeConfig["type"].GetString();
         auto nodeOutputsItr = nodeConfig.FindMember("outputs");
@@ -213,19 +298,97 @@ void processPipelineConfig(rapidjson::Document& configJson, const rapidjson::Val
             SPDLOG_LOGGER_WARN(modelmanager_logger, "Parsing node kind failed: {}", nodeKindStr);
             return;
         }
+        NodeLibrary library;
+        parameters_t parameters;
+        if (nodeKind == NodeKind::CUSTOM) {
+            const std::string libraryName = nodeConfig.HasMember("library_name") ? nodeConfig["library_name"].GetString() : "";
+            // missing library is reported by pipeline validation
+            if (!manager.getCustomNodeLibraryManager().getLibrary(libraryName, library).ok()) {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} node: {} refers to not loaded custom node library: {}", pipelineName, nodeName, libraryName);
+            }
+            if (nodeConfig.HasMember("params")) {
+                for (const auto& param : nodeConfig["params"].GetObject()) {
+                    parameters[param.name.GetString()] = param.value.GetString();
+                }
+            }
+        }
+        GateCondition condition;
+        if (nodeKind == NodeKind::GATE) {
+            auto conditionItr = nodeConfig.FindMember("condition");
+            if (conditionItr == nodeConfig.MemberEnd()) {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} gate node: {} does not have condition configured", pipelineName, nodeName);
+                return;
+            }
+            const auto& conditionConfig = conditionItr->value;
+            condition.input = conditionConfig["input"].GetString();
+            condition.value = conditionConfig["value"].GetDouble();
+            if (conditionConfig.HasMember("reduction") && !parseGateReduction(conditionConfig["reduction"].GetString(), condition.reduction)) {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} gate node: {} has unsupported condition reduction", pipelineName, nodeName);
+                return;
+            }
+            if (conditionConfig.HasMember("operator") && !parseGateComparison(conditionConfig["operator"].GetString(), condition.comparison)) {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} gate node: {} has unsupported condition operator", pipelineName, nodeName);
+                return;
+            }
+        }
+        size_t resultCacheSize = 0;
+        if (nodeConfig.HasMember("cacheable") && nodeConfig["cacheable"].GetBool()) {
+            if (nodeKind == NodeKind::DL) {
+                resultCacheSize = nodeConfig.HasMember("cache_size") ? nodeConfig["cache_size"].GetUint64() : DEFAULT_NODE_RESULT_CACHE_SIZE;
+            } else {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} node: {} of type: {} cannot be cacheable, results will not be cached", pipelineName, nodeName, nodeKindStr);
+            }
+        }
         SPDLOG_DEBUG("Creating node: {} type: {} model_name: {} modelVersion: {}",
             nodeName, nodeKindStr, modelName, modelVersion.value_or(0));
-        info.emplace_back(std::move(NodeInfo{nodeKind, nodeName, modelName, modelVersion, nodeOutputNameAlias}));
+        info.emplace_back(std::move(NodeInfo{nodeKind, nodeName, modelName, modelVersion, nodeOutputNameAlias, library, parameters}));
+        info.back().resultCacheSize = resultCacheSize;
+        info.back().condition = condition;
+        auto demultiplexedNodesItr = nodeConfig.FindMember("demultiplexed_nodes");
+        if (demultiplexedNodesItr != nodeConfig.MemberEnd()) {
+            if (nodeKind != NodeKind::DEMULTIPLEXER) {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} node: {} of type: {} cannot have demultiplexed nodes, they are ignored", pipelineName, nodeName, nodeKindStr);
+            } else {
+                for (const auto& demultiplexedConfig : demultiplexedNodesItr->value.GetArray()) {
+                    const std::string demultiplexedNodeName = demultiplexedConfig["name"].GetString();
+                    const std::string demultiplexedModelName = demultiplexedConfig["model_name"].GetString();
+                    std::unordered_map<std::string, std::string> demultiplexedOutputNameAlias;
+                    processNodeOutputs(demultiplexedConfig.FindMember("outputs"), demultiplexedNodeName, demultiplexedModelName, demultiplexedOutputNameAlias);
+                    std::optional<model_version_t> demultiplexedModelVersion;
+                    if (demultiplexedConfig.HasMember("version")) {
+                        demultiplexedModelVersion = demultiplexedConfig["version"].GetUint64();
+                    }
+                    SPDLOG_DEBUG("Creating demultiplexed node: {} of node: {} model_name: {} modelVersion: {}",
+                        demultiplexedNodeName, nodeName, demultiplexedModelName, demultiplexedModelVersion.value_or(0));
+                    info.back().demultiplexedNodes.emplace_back(NodeKind::DL, demultiplexedNodeName, demultiplexedModelName, demultiplexedModelVersion, demultiplexedOutputNameAlias);
+                    processNodeInputs(demultiplexedNodeName, demultiplexedConfig.FindMember("inputs"), info.back().demultiplexedConnections);
+                }
+            }
+        }
         auto nodeInputItr = nodeConfig.FindMember("inputs");
         processNodeInputs(nodeName, nodeInputItr, connections);
     }
+    std::optional<size_t> maxConcurrency;
+    auto maxConcurrencyItr = pipelineConfig.FindMember("max_concurrency");
+    if (maxConcurrencyItr != pipelineConfig.MemberEnd()) {
+        if (maxConcurrencyItr->value.IsString()) {
+            if (std::string(maxConcurrencyItr->value.GetString()) == "auto") {
+                maxConcurrency = PIPELINE_MAX_CONCURRENCY_AUTO;
+            } else {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} has invalid max_concurrency: {}, concurrency is not limited", pipelineName, maxConcurrencyItr->value.GetString());
+            }
+        } else {
+            maxConcurrency = maxConcurrencyItr->value.GetUint64();
+        }
+    }
     const auto iteratorOutputs = pipelineConfig.FindMember("outputs");
     // pipeline outputs are node exit inputs
     processNodeInputs(EXIT_NODE_NAME, iteratorOutputs, connections);
     info.emplace_back(std::move(NodeInfo(NodeKind::EXIT, EXIT_NODE_NAME, "", std::nullopt, {})));
+    waitForUsedModels(pipelineName, info, factory, loadingPool);
     if (!factory.definitionExists(pipelineName)) {
         SPDLOG_DEBUG("Pipeline:{} was not loaded so far. Triggering load", pipelineName);
-        auto status = factory.createDefinition(pipelineName, info, connections, manager);
+        auto status = factory.createDefinition(pipelineName, info, connections, manager, maxConcurrency);
         pipelinesInConfigFile.insert(pipelineName);
         return;
     }
@@ -233,25 +396,59 @@ void processPipelineConfig(rapidjson::Document& configJson, const rapidjson::Val
     auto status = factory.reloadDefinition(pipelineName,
         std::move(info),
         std::move(connections),
-        manager);
+        manager,
+        maxConcurrency);
     pipelinesInConfigFile.insert(pipelineName);
 }
 
-Status ModelManager::loadPipelinesConfig(rapidjson::Document& configJson) {
+Status ModelManager::loadPipelinesConfig(rapidjson::Document& configJson, ModelLoadingPool& loadingPool, const std::unordered_set<std::string>& changedModels) {
     const auto itrp = configJson.FindMember("pipeline_config_list");
     if (itrp == configJson.MemberEnd() || !itrp->value.IsArray()) {
         SPDLOG_LOGGER_INFO(modelmanager_logger, "Configuration file doesn't have pipelines property.");
+        // retired pipelines unsubscribe from models, which must not be notifying them anymore
+        loadingPool.waitAll();
         pipelineFactory.retireOtherThan({}, *this);
+        servedPipelineConfigEntries.clear();
         return StatusCode::OK;
     }
-    std::set<std::string> pipelinesInConfigFile;
+    const auto librariesItr = configJson.FindMember("custom_node_library_config_list");
+    const std::string librariesEntry = librariesItr != configJson.MemberEnd() ? serializeConfigEntry(librariesItr->value) : "";
+    const bool librariesChanged = librariesEntry != servedCustomNodeLibrariesEntry;
+    std::unordered_set<std::string> pipelinesInConfigFile;
+    std::unordered_map<std::string, std::string> pipelineConfigEntries;
+    size_t unchangedCount = 0;
     for (const auto& pipelineConfig : itrp->value.GetArray()) {
-        processPipelineConfig(configJson, pipelineConfig, pipelinesInConfigFile, pipelineFactory, *this);
+        const std::string pipelineName = pipelineConfig["name"].GetString();
+        auto entry = serializeConfigEntry(pipelineConfig);
+        if (!librariesChanged && isPipelineConfigUnchanged(pipelineName, entry, getPipelineModelNames(pipelineConfig), changedModels)) {
+            SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Pipeline: {} configuration did not change", pipelineName);
+            pipelinesInConfigFile.insert(pipelineName);
+            pipelineConfigEntries.emplace(pipelineName, std::move(entry));
+            ++unchangedCount;
+            continue;
+        }
+        processPipelineConfig(configJson, pipelineConfig, pipelinesInConfigFile, pipelineFactory, *this, loadingPool);
+        pipelineConfigEntries.emplace(pipelineName, std::move(entry));
     }
+    loadingPool.waitAll();
+    SPDLOG_LOGGER_INFO(modelmanager_logger, "Applied configuration of {} pipelines, {} unchanged pipelines were kept",
+        pipelinesInConfigFile.size() - unchangedCount, unchangedCount);
     pipelineFactory.retireOtherThan(std::move(pipelinesInConfigFile), *this);
+    servedPipelineConfigEntries = std::move(pipelineConfigEntries);
+    servedCustomNodeLibrariesEntry = librariesEntry;
     return ovms::StatusCode::OK;
 }
 
+bool ModelManager::isPipelineConfigUnchanged(const std::string& pipelineName, const std::string& entry, const std::set<std::string>& usedModels, const std::unordered_set<std::string>& changedModels) const {
+    auto it = servedPipelineConfigEntries.find(pipelineName);
+    if (it == servedPipelineConfigEntries.end() || it->second != entry || !pipelineFactory.definitionExists(pipelineName)) {
+        return false;
+    }
+    return std::none_of(usedModels.begin(), usedModels.end(), [&changedModels](const std::string& modelName) {
+        return changedModels.count(modelName) > 0;
+    });
+}
+
 Status ModelManager::createCustomLoader(CustomLoaderConfig& loaderConfig) {
     auto& customloaders = ovms::CustomLoaders::instance();
     std::string loaderName = loaderConfig.getLoaderName();
@@ -275,6 +472,15 @@ Status ModelManager::createCustomLoader(CustomLoaderConfig& loaderConfig) {
         std::shared_ptr<CustomLoaderInterface> customLoaderIfPtr{customObj()};
         try {
             customLoaderIfPtr->loaderInit(loaderConfig.getLoaderConfigFile());
+            const CustomLoaderInterface* loader = customLoaderIfPtr.get();
+            auto registered = customLoaderIfPtr->registerEventCallback([this, loader](CustomLoaderEvent event, const std::string& modelName, int version) {
+                CustomLoaders::instance().handleEvent(loader, event, modelName, version);
+                notifyModelChangedByLoader(modelName);
+            });
+            if (registered == CustomLoaderStatus::OK) {
+                SPDLOG_LOGGER_INFO(modelmanager_logger, "Custom loader {} pushes blacklist and change events, its blacklist is not polled", loaderName);
+                customloaders.setPushingEvents(loader);
+            }
         } catch (std::exception& e) {
             SPDLOG_LOGGER_ERROR(modelmanager_logger, "Cannot create or initialize the custom loader. Failed with error {}", e.what());
             return StatusCode::CUSTOM_LOADER_INIT_FAILED;
@@ -321,22 +527,82 @@ Status ModelManager::loadCustomLoadersConfig(rapidjson::Document& configJson) {
     return ovms::StatusCode::OK;
 }
 
-Status ModelManager::loadModelsConfig(rapidjson::Document& configJson, std::vector<ModelConfig>& gatedModelConfigs) {
+Status ModelManager::loadCustomNodeLibrariesConfig(rapidjson::Document& configJson) {
+    const auto itr = configJson.FindMember("custom_node_library_config_list");
+    if (itr == configJson.MemberEnd() || !itr->value.IsArray()) {
+        return StatusCode::OK;
+    }
+    for (const auto& libraryConfig : itr->value.GetArray()) {
+        const std::string name = libraryConfig["name"].GetString();
+        const std::string basePath = libraryConfig["base_path"].GetString();
+        auto status = customNodeLibraryManager.loadLibrary(name, basePath);
+        if (!status.ok() && status != StatusCode::NODE_LIBRARY_ALREADY_LOADED) {
+            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Loading custom node library: {} failed", name);
+        }
+    }
+    return StatusCode::OK;
+}
+
+Status ModelManager::parseModelsConfig(rapidjson::Document& configJson, std::vector<ModelConfig>& modelConfigs, std::unordered_map<std::string, std::string>& modelConfigEntries) {
     const auto itr = configJson.FindMember("model_config_list");
     if (itr == configJson.MemberEnd() || !itr->value.IsArray()) {
         SPDLOG_LOGGER_ERROR(modelmanager_logger, "Configuration file doesn't have models property.");
         return StatusCode::JSON_INVALID;
     }
-    std::set<std::string> modelsInConfigFile;
-    std::unordered_map<std::string, ModelConfig> newModelConfigs;
-    for (const auto& configs : itr->value.GetArray()) {
-        ModelConfig modelConfig;
-        auto status = modelConfig.parseNode(configs["config"]);
-        const auto modelName = modelConfig.getName();
-        if (!status.ok()) {
-            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Parsing model: {} config failed", modelName);
-            continue;
+    const rapidjson::Value& configList = itr->value;
+    const size_t count = configList.Size();
+    std::vector<ModelConfig> parsedConfigs(count);
+    std::vector<std::string> parsedEntries(count);
+    std::vector<Status> statuses(count, StatusCode::OK);
+    // each range stops on its first invalid entry, entries after it are not reported since parsing fails anyway
+    auto parseRange = [&configList, &parsedConfigs, &parsedEntries, &statuses](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const rapidjson::Value& config = configList[static_cast<rapidjson::SizeType>(i)]["config"];
+            statuses[i] = parsedConfigs[i].parseNode(config);
+            if (!statuses[i].ok()) {
+                return;
+            }
+            parsedEntries[i] = serializeConfigEntry(config);
         }
+    };
+    const size_t threadsCount = count < PARALLEL_CONFIG_PARSING_MIN_MODELS ? 1 : getEffectiveCpuCount();
+    if (threadsCount == 1) {
+        parseRange(0, count);
+    } else {
+        const size_t rangeSize = (count + threadsCount - 1) / threadsCount;
+        std::vector<std::future<void>> parsing;
+        for (size_t begin = 0; begin < count; begin += rangeSize) {
+            parsing.push_back(std::async(std::launch::async, parseRange, begin, std::min(count, begin + rangeSize)));
+        }
+        for (auto& range : parsing) {
+            range.get();
+        }
+    }
+    modelConfigs.reserve(count);
+    modelConfigEntries.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!statuses[i].ok()) {
+            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Parsing model: {} config failed, configuration is not applied", parsedConfigs[i].getName());
+            return statuses[i];
+        }
+        // only the first of duplicated definitions is compared with served configuration
+        modelConfigEntries.emplace(parsedConfigs[i].getName(), std::move(parsedEntries[i]));
+        modelConfigs.emplace_back(std::move(parsedConfigs[i]));
+    }
+    return StatusCode::OK;
+}
+
+Status ModelManager::loadModelsConfig(std::vector<ModelConfig>& modelConfigs, const std::unordered_map<std::string, std::string>& modelConfigEntries, ModelLoadingPool& loadingPool, std::map<std::string, ModelConfig>& loadingModelConfigs, std::unordered_set<std::string>& changedModels) {
+    // pool loads models in order of submission
+    std::stable_sort(modelConfigs.begin(), modelConfigs.end(), [](const ModelConfig& lhs, const ModelConfig& rhs) {
+        return lhs.getLoadPriority() > rhs.getLoadPriority();
+    });
+    const bool deferring = deferNonCoreModels &&
+                           std::any_of(modelConfigs.begin(), modelConfigs.end(), [](const ModelConfig& config) { return config.isCoreModel(); });
+    std::unordered_set<std::string> modelsInConfigFile;
+    modelsInConfigFile.reserve(modelConfigs.size());
+    for (auto& modelConfig : modelConfigs) {
+        const auto modelName = modelConfig.getName();
         if (pipelineDefinitionExists(modelName)) {
             SPDLOG_LOGGER_ERROR(modelmanager_logger, "Model name: {} is already occupied by pipeline definition.", modelName);
             continue;
@@ -345,15 +611,47 @@ Status ModelManager::loadModelsConfig(rapidjson::Document& configJson, std::vect
             SPDLOG_LOGGER_WARN(modelmanager_logger, "Duplicated model names: {} defined in config file. Only first definition will be loaded.", modelName);
             continue;
         }
-        status = reloadModelWithVersions(modelConfig);
         modelsInConfigFile.emplace(modelName);
+        auto servedIt = servedModelConfigs.find(modelName);
+        auto servedEntryIt = servedModelConfigEntries.find(modelName);
+        if (servedIt != servedModelConfigs.end() && servedEntryIt != servedModelConfigEntries.end() &&
+            servedEntryIt->second == modelConfigEntries.at(modelName) && findModelByName(modelName)) {
+            // new versions of unchanged models are picked up by the watcher cycle
+            SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Model: {} configuration did not change", modelName);
+            loadingModelConfigs.emplace(modelName, servedIt->second);
+            continue;
+        }
+        changedModels.insert(modelName);
+        if (deferring && !modelConfig.isCoreModel()) {
+            SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Model: {} will be loaded in the background after core models", modelName);
+            deferredModels.push_back(modelName);
+            loadingModelConfigs.emplace(modelName, std::move(modelConfig));
+            continue;
+        }
+        // created up front, so that loading threads do not modify models map
+        getModelIfExistCreateElse(modelName);
+        auto& loadingModelConfig = loadingModelConfigs.emplace(modelName, std::move(modelConfig)).first->second;
+        loadingPool.submit(modelName, [this, &loadingModelConfig]() { return reloadModelWithVersions(loadingModelConfig); });
+    }
+    SPDLOG_LOGGER_INFO(modelmanager_logger, "Applying configuration of {} models, {} unchanged models are kept",
+        changedModels.size(), modelsInConfigFile.size() - changedModels.size());
+    retireModelsRemovedFromConfigFile(modelsInConfigFile);
+    return ovms::StatusCode::OK;
+}
 
+void ModelManager::finishModelsConfigLoading(ModelLoadingPool& loadingPool, std::map<std::string, ModelConfig>& loadingModelConfigs, std::unordered_map<std::string, std::string>& modelConfigEntries, std::vector<ModelConfig>& gatedModelConfigs) {
+    std::unordered_map<std::string, ModelConfig> newModelConfigs;
+    std::unordered_map<std::string, std::string> newModelConfigEntries;
+    for (auto& [modelName, modelConfig] : loadingModelConfigs) {
+        auto status = loadingPool.wait(modelName);
         if (!status.ok()) {
             SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Cannot reload model: {} with versions due to error: {}", modelName, status.string());
         }
         if (status != StatusCode::REQUESTED_DYNAMIC_PARAMETERS_ON_SUBSCRIBED_MODEL) {
             newModelConfigs.emplace(modelName, std::move(modelConfig));
+            newModelConfigEntries.emplace(modelName, std::move(modelConfigEntries.at(modelName)));
         } else {
+            // entry is not recorded, so that the model is compared as changed by the next configuration reload
             SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Will retry to reload model({}) after pipelines are revalidated", modelName);
             auto it = this->servedModelConfigs.find(modelName);
             if (it == this->servedModelConfigs.end()) {
@@ -365,8 +663,55 @@ Status ModelManager::loadModelsConfig(rapidjson::Document& configJson, std::vect
         }
     }
     this->servedModelConfigs = std::move(newModelConfigs);
-    retireModelsRemovedFromConfigFile(modelsInConfigFile);
-    return ovms::StatusCode::OK;
+    this->servedModelConfigEntries = std::move(newModelConfigEntries);
+    updateLoadPriorities();
+}
+
+void ModelManager::updateLoadPriorities() {
+    std::unordered_map<std::string, int32_t> priorities;
+    for (const auto& [name, config] : servedModelConfigs) {
+        priorities.emplace(name, config.getLoadPriority());
+    }
+    std::unique_lock lock(loadPrioritiesMtx);
+    loadPriorities = std::move(priorities);
+}
+
+ModelsReadiness ModelManager::getModelsReadiness() const {
+    ModelsReadiness readiness;
+    std::shared_lock lock(loadPrioritiesMtx);
+    for (const auto& [name, priority] : loadPriorities) {
+        auto model = findModelByName(name);
+        auto instance = model ? model->getDefaultModelInstance() : nullptr;
+        if (instance && instance->getStatus().getState() == ModelVersionState::AVAILABLE) {
+            continue;
+        }
+        readiness.notReadyModels.push_back(name);
+        if (priority > 0) {
+            readiness.coreModelsReady = false;
+        }
+    }
+    std::sort(readiness.notReadyModels.begin(), readiness.notReadyModels.end());
+    return readiness;
+}
+
+void ModelManager::loadDeferredModels() {
+    if (deferredModels.empty()) {
+        return;
+    }
+    SPDLOG_LOGGER_INFO(modelmanager_logger, "Core models are loaded, loading remaining {} models in the background", deferredModels.size());
+    {
+        ModelLoadingPool loadingPool(modelLoadingParallelism);
+        for (const auto& name : deferredModels) {
+            auto it = servedModelConfigs.find(name);
+            if (it == servedModelConfigs.end()) {
+                continue;
+            }
+            loadingPool.submit(name, [this, &config = it->second]() { return reloadModelWithVersions(config); });
+        }
+    }
+    deferredModels.clear();
+    // pipelines using deferred models were created before the models were loaded
+    pipelineFactory.revalidatePipelines(*this);
 }
 
 Status ModelManager::tryReloadGatedModelConfigs(std::vector<ModelConfig>& gatedModelConfigs) {
@@ -404,50 +749,225 @@ Status ModelManager::loadConfig(const std::string& jsonFilename) {
         SPDLOG_LOGGER_ERROR(modelmanager_logger, "Configuration file is not in valid configuration format");
         return StatusCode::JSON_INVALID;
     }
+    // all models are parsed before any of them is applied, so that an invalid entry does not leave configuration partially updated
+    std::vector<ModelConfig> modelConfigs;
+    std::unordered_map<std::string, std::string> modelConfigEntries;
+    auto status = parseModelsConfig(configJson, modelConfigs, modelConfigEntries);
+    if (!status.ok()) {
+        return status;
+    }
     configFilename = jsonFilename;
-    Status status;
+    const auto loadersItr = configJson.FindMember("custom_loader_config_list");
+    const std::string loadersEntry = loadersItr != configJson.MemberEnd() ? serializeConfigEntry(loadersItr->value) : "";
+    if (loadersEntry != servedCustomLoadersEntry) {
+        // models using custom loaders are not known up front, all of them are compared as changed
+        servedModelConfigEntries.clear();
+        servedCustomLoadersEntry = loadersEntry;
+    }
     // load the custom loader config, if available
     status = loadCustomLoadersConfig(configJson);
     if (status != StatusCode::OK) {
         return status;
     }
-    std::vector<ModelConfig> gatedModelConfigs;
-    status = loadModelsConfig(configJson, gatedModelConfigs);
+    status = loadCustomNodeLibrariesConfig(configJson);
     if (status != StatusCode::OK) {
         return status;
     }
-    status = loadPipelinesConfig(configJson);
+    // declared before the pool, so that configs outlive loads still running when pool is destroyed
+    std::map<std::string, ModelConfig> loadingModelConfigs;
+    ModelLoadingPool loadingPool(modelLoadingParallelism);
+    std::unordered_set<std::string> changedModels;
+    status = loadModelsConfig(modelConfigs, modelConfigEntries, loadingPool, loadingModelConfigs, changedModels);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    status = loadPipelinesConfig(configJson, loadingPool, changedModels);
+    std::vector<ModelConfig> gatedModelConfigs;
+    finishModelsConfigLoading(loadingPool, loadingModelConfigs, modelConfigEntries, gatedModelConfigs);
     tryReloadGatedModelConfigs(gatedModelConfigs);
     return StatusCode::OK;
 }
 
-void ModelManager::retireModelsRemovedFromConfigFile(const std::set<std::string>& modelsExistingInConfigFile) {
-    std::set<std::string> modelsCurrentlyLoaded;
-    for (auto& nameModelPair : getModels()) {
-        modelsCurrentlyLoaded.insert(nameModelPair.first);
-    }
-    std::vector<std::string> modelsToUnloadAllVersions(getModels().size());
-    auto it = std::set_difference(
-        modelsCurrentlyLoaded.begin(), modelsCurrentlyLoaded.end(),
-        modelsExistingInConfigFile.begin(), modelsExistingInConfigFile.end(),
-        modelsToUnloadAllVersions.begin());
-    modelsToUnloadAllVersions.resize(it - modelsToUnloadAllVersions.begin());
-    for (auto& modelName : modelsToUnloadAllVersions) {
-        SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Retiring all versions of model: {}", modelName);
-        try {
-            models.at(modelName)->retireAllVersions();
-        } catch (const std::out_of_range& e) {
-            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Unknown error occurred when tried to retire all versions of model: {}", modelName);
+void ModelManager::retireModelsRemovedFromConfigFile(const std::unordered_set<std::string>& modelsExistingInConfigFile) {
+    for (const auto& [modelName, model] : *getModelsSnapshot()) {
+        if (modelsExistingInConfigFile.count(modelName)) {
+            continue;
         }
+        SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Retiring all versions of model: {}", modelName);
+        model->retireAllVersions();
     }
 }
 
 void ModelManager::updateConfigurationWithoutConfigFile() {
     SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Checking if something changed with model versions");
-    for (auto& [name, config] : servedModelConfigs) {
-        reloadModelWithVersions(config);
+    std::vector<std::string> basePaths;
+    for (const auto& [name, config] : servedModelConfigs) {
+        basePaths.push_back(config.getBasePath());
+    }
+    prefetchCloudListings(basePaths);
+    {
+        ModelLoadingPool loadingPool(modelLoadingParallelism);
+        for (auto& [name, config] : servedModelConfigs) {
+            loadingPool.submit(name, [this, &config = config]() { return reloadModelWithVersions(config); });
+        }
+    }
+    CloudListingCache::instance().clear();
+    pipelineFactory.revalidatePipelines(*this);
+}
+
+void ModelManager::deactivateIdleModels() {
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& instance : getModelInstances()) {
+        const auto& config = instance->getModelConfig();
+        if (config.isStateful()) {
+            instance->removeIdleSequences();
+        }
+        if (!config.isLazyLoadingEnabled() || config.getIdleUnloadTimeoutSeconds() == 0) {
+            continue;
+        }
+        instance->deactivateIfIdle(now - std::chrono::seconds(config.getIdleUnloadTimeoutSeconds()));
+    }
+}
+
+void ModelManager::autoscaleInferRequests() {
+    for (auto& instance : getModelInstances()) {
+        instance->autoscaleInferRequests();
+    }
+}
+
+void ModelManager::persistShapeProfiles() {
+    for (auto& instance : getModelInstances()) {
+        instance->persistShapeProfile();
+    }
+}
+
+void ModelManager::rebalanceStreams() {
+    auto& budget = StreamsBudget::instance();
+    if (!budget.isEnabled()) {
+        return;
+    }
+    // versions are measured again once compilations started by the previous cycle finish
+    if (rebalancingStreams.load()) {
+        return;
+    }
+    if (streamsRebalancer.joinable()) {
+        streamsRebalancer.join();
+    }
+    std::vector<std::shared_ptr<ModelInstance>> instances;
+    std::vector<ModelStreamsLoad> loads;
+    for (auto& instance : getModelInstances()) {
+        ModelStreamsLoad load;
+        if (instance->getStreamsLoad(load)) {
+            instances.push_back(instance);
+            loads.push_back(std::move(load));
+        }
+    }
+    const auto streams = budget.rebalance(loads);
+    bool changed = false;
+    for (size_t i = 0; i < instances.size(); ++i) {
+        changed = changed || streams[i] != loads[i].streams;
+    }
+    if (!changed) {
+        return;
+    }
+    // watcher keeps serving config changes while networks are compiled
+    rebalancingStreams = true;
+    streamsRebalancer = std::thread([this, instances = std::move(instances), loads = std::move(loads), streams]() {
+        auto& budget = StreamsBudget::instance();
+        // shrinking versions give their cores back before growing versions take them
+        for (bool shrinking : {true, false}) {
+            ModelLoadingPool compilingPool(modelLoadingParallelism);
+            for (size_t i = 0; i < instances.size(); ++i) {
+                if ((shrinking && streams[i] < loads[i].streams) || (!shrinking && streams[i] > loads[i].streams)) {
+                    SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Rebalancing streams of model: {} version: {}", loads[i].name, loads[i].version);
+                    compilingPool.submit(loads[i].name, [&budget, instance = instances[i], streams = streams[i]]() {
+                        auto status = instance->rebalanceStreams(streams);
+                        if (status.ok()) {
+                            budget.recordRebalance();
+                        }
+                        return status;
+                    });
+                }
+            }
+        }
+        rebalancingStreams = false;
+    });
+}
+
+void ModelManager::watchModelsDirectories() {
+    for (const auto& tag : inotifyWatcher->getTags()) {
+        if (tag != CONFIG_FILE_WATCH_TAG && servedModelConfigs.find(tag) == servedModelConfigs.end()) {
+            inotifyWatcher->unwatch(tag);
+        }
+    }
+    for (const auto& [name, config] : servedModelConfigs) {
+        if (!inotifyWatcher->watchTree(config.getBasePath(), name)) {
+            SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Repository of model: {} cannot be watched, it is polled for changes", name);
+        }
     }
+    if (!configFilename.empty()) {
+        // editors replace config file by renaming, so its directory is watched
+        inotifyWatcher->watchDirectory(std::filesystem::path(configFilename).parent_path().string(), CONFIG_FILE_WATCH_TAG);
+    }
+}
+
+void ModelManager::updateConfigurationOfChangedModels(const std::set<std::string>& changedModels) {
+    const auto watchedModels = inotifyWatcher->getTags();
+    std::vector<std::string> modelsToUpdate;
+    for (const auto& [name, config] : servedModelConfigs) {
+        if (changedModels.count(name) || !watchedModels.count(name)) {
+            modelsToUpdate.push_back(name);
+        }
+    }
+    if (modelsToUpdate.empty()) {
+        return;
+    }
+    SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Checking if something changed with versions of {} models", modelsToUpdate.size());
+    std::vector<std::string> basePaths;
+    for (const auto& name : modelsToUpdate) {
+        basePaths.push_back(servedModelConfigs.at(name).getBasePath());
+    }
+    prefetchCloudListings(basePaths);
+    {
+        ModelLoadingPool loadingPool(modelLoadingParallelism);
+        for (const auto& name : modelsToUpdate) {
+            loadingPool.submit(name, [this, &config = servedModelConfigs.at(name)]() { return reloadModelWithVersions(config); });
+        }
+    }
+    CloudListingCache::instance().clear();
     pipelineFactory.revalidatePipelines(*this);
+    // new version directories have to be watched for their files being written
+    for (const auto& name : modelsToUpdate) {
+        inotifyWatcher->watchTree(servedModelConfigs.at(name).getBasePath(), name);
+    }
+}
+
+void ModelManager::prefetchCloudListings(const std::vector<std::string>& basePaths) {
+    std::map<std::string, size_t> modelsPerPrefix;
+    for (auto path : basePaths) {
+        while (!path.empty() && path.back() == '/') {
+            path.pop_back();
+        }
+        const size_t schemeEnd = path.find("://");
+        const size_t parentEnd = path.rfind('/');
+        // local repositories and ones stored directly in bucket root
+        if (schemeEnd == std::string::npos || parentEnd <= schemeEnd + 2) {
+            continue;
+        }
+        modelsPerPrefix[path.substr(0, parentEnd)]++;
+    }
+    for (const auto& [prefix, modelsCount] : modelsPerPrefix) {
+        if (modelsCount < 2) {
+            continue;
+        }
+        auto fs = getFilesystem(prefix);
+        std::vector<std::string> keys;
+        if (fs->listObjectKeys(prefix, &keys, modelsCount * CLOUD_LISTING_KEYS_PER_MODEL) != StatusCode::OK) {
+            continue;
+        }
+        SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Listed {} objects of {} model repositories under {}", keys.size(), modelsCount, prefix);
+        CloudListingCache::instance().store(prefix, std::move(keys));
+    }
 }
 
 void ModelManager::watcher(std::future<void> exit) {
@@ -456,20 +976,74 @@ void ModelManager::watcher(std::future<void> exit) {
     struct stat statTime;
     stat(configFilename.c_str(), &statTime);
     lastTime = statTime.st_ctime;
+    if (fileSystemEventsEnabled) {
+        auto watcher = std::make_unique<InotifyWatcher>();
+        if (watcher->isValid()) {
+            {
+                // custom loader events wake the watcher from their threads
+                std::lock_guard<std::mutex> lock(loaderEventsMtx);
+                inotifyWatcher = std::move(watcher);
+            }
+            watchModelsDirectories();
+        } else {
+            SPDLOG_LOGGER_WARN(modelmanager_logger, "Changes of model repositories and config file will be polled since inotify is not available");
+        }
+    }
+    loadDeferredModels();
     while (exit.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout) {
-        std::this_thread::sleep_for(std::chrono::seconds(watcherIntervalSec));
+        std::set<std::string> changedModels;
+        if (inotifyWatcher) {
+            changedModels = inotifyWatcher->waitForChanges(std::chrono::seconds(watcherIntervalSec), FILE_SYSTEM_EVENTS_QUIET_PERIOD);
+        } else {
+            waitForWatcherInterval();
+        }
+        const auto modelsChangedByLoaders = takeModelsChangedByLoaders();
+        changedModels.insert(modelsChangedByLoaders.begin(), modelsChangedByLoaders.end());
         SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Watcher thread check cycle begin");
         stat(configFilename.c_str(), &statTime);
         if (lastTime != statTime.st_ctime) {
             lastTime = statTime.st_ctime;
             loadConfig(configFilename);
+            if (inotifyWatcher) {
+                // models kept unchanged by config reload still have their file system events handled
+                watchModelsDirectories();
+            }
+        }
+        if (inotifyWatcher) {
+            updateConfigurationOfChangedModels(changedModels);
+        } else {
+            updateConfigurationWithoutConfigFile();
         }
-        updateConfigurationWithoutConfigFile();
+        deactivateIdleModels();
+        rebalanceStreams();
+        autoscaleInferRequests();
+        persistShapeProfiles();
         SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Watcher thread check cycle end");
     }
     SPDLOG_LOGGER_ERROR(modelmanager_logger, "Exited config watcher thread");
 }
 
+void ModelManager::notifyModelChangedByLoader(const std::string& modelName) {
+    {
+        std::lock_guard<std::mutex> lock(loaderEventsMtx);
+        modelsChangedByLoaders.insert(modelName);
+        if (inotifyWatcher) {
+            inotifyWatcher->wake();
+        }
+    }
+    loaderEventsCondition.notify_all();
+}
+
+void ModelManager::waitForWatcherInterval() {
+    std::unique_lock<std::mutex> lock(loaderEventsMtx);
+    loaderEventsCondition.wait_for(lock, std::chrono::seconds(watcherIntervalSec), [this]() { return !modelsChangedByLoaders.empty(); });
+}
+
+std::set<std::string> ModelManager::takeModelsChangedByLoaders() {
+    std::lock_guard<std::mutex> lock(loaderEventsMtx);
+    return std::exchange(modelsChangedByLoaders, {});
+}
+
 void ModelManager::join() {
     if (watcherStarted) {
         exit.set_value();
@@ -478,6 +1052,9 @@ void ModelManager::join() {
             watcherStarted = false;
         }
     }
+    if (streamsRebalancer.joinable()) {
+        streamsRebalancer.join();
+    }
 }
 
 void ModelManager::getVersionsToChange(
@@ -548,26 +1125,13 @@ std::shared_ptr<ovms::Model> ModelManager::getModelIfExistCreateElse(const std::
     auto modelIt = models.find(modelName);
     if (models.end() == modelIt) {
         models.insert({modelName, modelFactory(modelName)});
+        std::atomic_store(&modelsSnapshot, std::make_shared<const models_snapshot_t>(models.begin(), models.end()));
     }
     return models[modelName];
 }
 
 std::shared_ptr<FileSystem> ModelManager::getFilesystem(const std::string& basePath) {
-    if (basePath.rfind(S3FileSystem::S3_URL_PREFIX, 0) == 0) {
-        Aws::SDKOptions options;
-        Aws::InitAPI(options);
-        return std::make_shared<S3FileSystem>(options, basePath);
-    }
-    if (basePath.rfind(GCSFileSystem::GCS_URL_PREFIX, 0) == 0) {
-        return std::make_shared<ovms::GCSFileSystem>();
-    }
-    if (basePath.rfind(AzureFileSystem::AZURE_URL_FILE_PREFIX, 0) == 0) {
-        return std::make_shared<ovms::AzureFileSystem>();
-    }
-    if (basePath.rfind(AzureFileSystem::AZURE_URL_BLOB_PREFIX, 0) == 0) {
-        return std::make_shared<ovms::AzureFileSystem>();
-    }
-    return std::make_shared<LocalFileSystem>();
+    return createFilesystem(basePath);
 }
 
 Status ModelManager::readAvailableVersions(std::shared_ptr<FileSystem>& fs, const std::string& base, model_versions_t& versions) {
@@ -673,6 +1237,7 @@ Status ModelManager::reloadModelWithVersions(ModelConfig& config) {
     std::shared_ptr<model_versions_t> versionsFailed = std::make_shared<model_versions_t>();
     // first reset custom loader name to empty string so that any changes to name can be captured
     model->resetCustomLoaderName();
+    std::set<int> versionsChangedByLoader;
 
     if (config.isCustomLoaderRequiredToLoadModel()) {
         custom_loader_options_config_t customLoaderOptionsConfig = config.getCustomLoaderOptionsConfigMap();
@@ -683,11 +1248,18 @@ Status ModelManager::reloadModelWithVersions(ModelConfig& config) {
         if (loaderPtr != nullptr) {
             SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Custom Loader to be used : {}", loaderName);
             model->setCustomLoaderName(loaderName);
+            versionsChangedByLoader = customloaders.takeChangedVersions(loaderPtr.get(), config.getName());
 
             // check existing version for blacklist
             for (const auto& [version, versionInstance] : model->getModelVersions()) {
                 SPDLOG_LOGGER_DEBUG(modelmanager_logger, "The model {} checking for blacklist", versionInstance->getName());
-                CustomLoaderStatus bres = loaderPtr->getModelBlacklistStatus(versionInstance->getName(), version);
+                CustomLoaderStatus bres = [&]() {
+                    if (customloaders.isPushingEvents(loaderPtr.get())) {
+                        return customloaders.isBlacklisted(loaderPtr.get(), versionInstance->getName(), version) ? CustomLoaderStatus::MODEL_BLACKLISTED : CustomLoaderStatus::OK;
+                    }
+                    auto callLock = customloaders.lockForCall(loaderPtr);
+                    return loaderPtr->getModelBlacklistStatus(versionInstance->getName(), version);
+                }();
                 if (bres != CustomLoaderStatus::OK) {
                     SPDLOG_LOGGER_INFO(modelmanager_logger, "The model {} is blacklisted", versionInstance->getName());
                     requestedVersions.erase(std::remove(requestedVersions.begin(), requestedVersions.end(), version), requestedVersions.end());
@@ -719,6 +1291,14 @@ Status ModelManager::reloadModelWithVersions(ModelConfig& config) {
         }
     }
 
+    for (const auto version : versionsChangedByLoader) {
+        // loader reported new content of a served version, which has to be read again
+        if (model->getModelVersions().count(version) &&
+            std::find(requestedVersions.begin(), requestedVersions.end(), version) != requestedVersions.end() &&
+            std::find(versionsToReload->begin(), versionsToReload->end(), version) == versionsToReload->end()) {
+            versionsToReload->push_back(version);
+        }
+    }
     if (versionsToReload->size() > 0) {
         reloadModelVersions(model, fs, config, versionsToReload, versionsFailed);
     }
@@ -744,9 +1324,19 @@ Status ModelManager::reloadModelWithVersions(ModelConfig& config) {
 }
 
 const std::shared_ptr<Model> ModelManager::findModelByName(const std::string& name) const {
+    auto snapshot = getModelsSnapshot();
+    auto it = snapshot->find(name);
+    return it != snapshot->end() ? it->second : nullptr;
+}
+
+std::vector<std::shared_ptr<ModelInstance>> ModelManager::getModelInstances() const {
     std::shared_lock lock(modelsMtx);
-    auto it = models.find(name);
-    return it != models.end() ? it->second : nullptr;
+    std::vector<std::shared_ptr<ModelInstance>> instances;
+    for (const auto& [name, model] : models) {
+        auto modelInstances = model->getModelInstances();
+        instances.insert(instances.end(), modelInstances.begin(), modelInstances.end());
+    }
+    return instances;
 }
 
 }  // namespace ovms
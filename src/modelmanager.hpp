@@ -15,27 +15,46 @@
 //*****************************************************************************
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <shared_mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <rapidjson/document.h>
 #include <spdlog/spdlog.h>
 
 #include "customloaders.hpp"
+#include "customnodelibrarymanager.hpp"
 #include "filesystem.hpp"
+#include "inotifywatcher.hpp"
 #include "model.hpp"
+#include "modelloadingpool.hpp"
 #include "pipeline.hpp"
 #include "pipeline_factory.hpp"
 
 namespace ovms {
 class IVersionReader;
+
+using models_snapshot_t = std::unordered_map<std::string, std::shared_ptr<Model>>;
+
+/**
+ * @brief Readiness of served models, reported by readiness API
+ */
+struct ModelsReadiness {
+    // false if any model with load priority above 0 has no available version
+    bool coreModelsReady = true;
+    std::vector<std::string> notReadyModels;
+};
+
 /**
  * @brief Model manager is managing the list of model topologies enabled for serving and their versions.
  */
@@ -54,8 +73,21 @@ protected:
      */
     std::map<std::string, std::shared_ptr<Model>> models;
 
+    /**
+     * @brief Copy of models published with each added model, read without locking modelsMtx on the predict path.
+     * std::atomic_load of shared_ptr is not lock-free, standard library guards it with a short internal spinlock
+     */
+    std::shared_ptr<const models_snapshot_t> modelsSnapshot = std::make_shared<const models_snapshot_t>();
+
     PipelineFactory pipelineFactory;
 
+    CustomNodeLibraryManager customNodeLibraryManager;
+
+    /**
+     * @brief Chains of pipeline models are fused into single networks, set from --fuse_pipeline_models on start
+     */
+    bool pipelineModelsFusionEnabled = false;
+
 private:
     /**
      * @brief Private copying constructor
@@ -65,10 +97,35 @@ private:
     Status cleanupModelTmpFiles(ModelConfig& config);
     Status reloadModelVersions(std::shared_ptr<ovms::Model>& model, std::shared_ptr<FileSystem>& fs, ModelConfig& config, std::shared_ptr<model_versions_t>& versionsToReload, std::shared_ptr<model_versions_t> versionsFailed);
     Status addModelVersions(std::shared_ptr<ovms::Model>& model, std::shared_ptr<FileSystem>& fs, ModelConfig& config, std::shared_ptr<model_versions_t>& versionsToStart, std::shared_ptr<model_versions_t> versionsFailed);
-    Status loadModelsConfig(rapidjson::Document& configJson, std::vector<ModelConfig>& gatedModelConfigs);
+    /**
+     * @brief Parses all models of configuration, fails if any of them is invalid. Large configurations are parsed on multiple threads.
+     *
+     * Loading of the configuration is aborted on the first invalid entry: its status is returned, only this entry is reported
+     * and none of the models is applied, including the valid ones.
+     *
+     * @param modelConfigEntries filled with serialized config of each model, used to find models which did not change
+     */
+    Status parseModelsConfig(rapidjson::Document& configJson, std::vector<ModelConfig>& modelConfigs, std::unordered_map<std::string, std::string>& modelConfigEntries);
+    /**
+     * @brief Submits changed models for loading, unchanged models keep their served config, models removed from configuration are retired
+     *
+     * @param changedModels filled with names of submitted models
+     */
+    Status loadModelsConfig(std::vector<ModelConfig>& modelConfigs, const std::unordered_map<std::string, std::string>& modelConfigEntries, ModelLoadingPool& loadingPool, std::map<std::string, ModelConfig>& loadingModelConfigs, std::unordered_set<std::string>& changedModels);
+    /**
+     * @brief Waits for submitted models and makes their configs served, models gated by pipelines are left for retry
+     */
+    void finishModelsConfigLoading(ModelLoadingPool& loadingPool, std::map<std::string, ModelConfig>& loadingModelConfigs, std::unordered_map<std::string, std::string>& modelConfigEntries, std::vector<ModelConfig>& gatedModelConfigs);
     Status tryReloadGatedModelConfigs(std::vector<ModelConfig>& gatedModelConfigs);
-    Status loadPipelinesConfig(rapidjson::Document& configJson);
+    /**
+     * @brief Creates or reloads changed pipelines once models they use are loaded, pipelines removed from configuration are retired
+     *
+     * @param changedModels pipelines using any of them are reloaded even if their config did not change
+     */
+    Status loadPipelinesConfig(rapidjson::Document& configJson, ModelLoadingPool& loadingPool, const std::unordered_set<std::string>& changedModels);
+    bool isPipelineConfigUnchanged(const std::string& pipelineName, const std::string& entry, const std::set<std::string>& usedModels, const std::unordered_set<std::string>& changedModels) const;
     Status loadCustomLoadersConfig(rapidjson::Document& configJson);
+    Status loadCustomNodeLibrariesConfig(rapidjson::Document& configJson);
 
     /**
      * @brief creates customloader from the loader configuration
@@ -94,18 +151,46 @@ private:
      */
     std::promise<void> exit;
 
+    /**
+     * @brief Thread recompiling versions whose streams changed, watcher starts the next one only after it finishes
+     */
+    std::thread streamsRebalancer;
+    std::atomic<bool> rebalancingStreams{false};
+
     /**
      * @brief A current configurations of models
      * 
      */
     std::unordered_map<std::string, ModelConfig> servedModelConfigs;
 
+    /**
+     * @brief Serialized config file entries of served models, pipelines and custom node libraries
+     */
+    std::unordered_map<std::string, std::string> servedModelConfigEntries;
+    std::unordered_map<std::string, std::string> servedPipelineConfigEntries;
+    std::string servedCustomLoadersEntry;
+
+    /**
+     * @brief Load priorities of served models, read by readiness requests
+     */
+    std::unordered_map<std::string, int32_t> loadPriorities;
+    mutable std::shared_mutex loadPrioritiesMtx;
+    void updateLoadPriorities();
+
+    /**
+     * @brief Set while loading config at startup, then only core models are loaded and the rest is loaded by watcher thread
+     */
+    bool deferNonCoreModels = false;
+    std::vector<std::string> deferredModels;
+    void loadDeferredModels();
+    std::string servedCustomNodeLibrariesEntry;
+
     /**
      * @brief Retires models non existing in config file
      *
      * @param modelsExistingInConfigFile
      */
-    void retireModelsRemovedFromConfigFile(const std::set<std::string>& modelsExistingInConfigFile);
+    void retireModelsRemovedFromConfigFile(const std::unordered_set<std::string>& modelsExistingInConfigFile);
 
     /**
      * @brief Mutex for blocking concurrent add & find of model
@@ -117,6 +202,59 @@ private:
      */
     uint watcherIntervalSec = 1;
 
+    /**
+     * Maximum number of models loaded at once
+     */
+    uint modelLoadingParallelism = 1;
+
+    /**
+     * Detect changes of local model repositories and config file with inotify instead of polling
+     */
+    bool fileSystemEventsEnabled = false;
+
+    /**
+     * @brief Reports changes of local model repositories and config file directory, null when polling is used
+     */
+    std::unique_ptr<InotifyWatcher> inotifyWatcher;
+
+    /**
+     * @brief Models reported as changed by custom loader events, checked in the next watcher cycle which starts right away
+     */
+    std::mutex loaderEventsMtx;
+    std::condition_variable loaderEventsCondition;
+    std::set<std::string> modelsChangedByLoaders;
+
+    /**
+     * @brief Waits for the watcher interval or until a custom loader pushes an event
+     */
+    void waitForWatcherInterval();
+
+    /**
+     * @brief Gives models reported by custom loader events since the previous call
+     */
+    std::set<std::string> takeModelsChangedByLoaders();
+
+    /**
+     * @brief Watches repositories of served models and config file directory, models which cannot be watched
+     * are polled in each watcher cycle
+     */
+    void watchModelsDirectories();
+
+    /**
+     * @brief Checks for new model versions only in changed repositories and repositories which are not watched
+     *
+     * @param changedModels names of models with changed repositories
+     */
+    void updateConfigurationOfChangedModels(const std::set<std::string>& changedModels);
+
+    /**
+     * @brief Lists cloud storage prefixes shared by repositories of several models once, so that checking versions
+     * of each of them in this cycle does not list the storage again. Listings are dropped once the cycle is over.
+     *
+     * @param basePaths repositories which versions are about to be checked
+     */
+    void prefetchCloudListings(const std::vector<std::string>& basePaths);
+
 public:
     /**
      * @brief Gets the instance of ModelManager
@@ -161,6 +299,10 @@ public:
         return pipelineFactory;
     }
 
+    const CustomNodeLibraryManager& getCustomNodeLibraryManager() const {
+        return customNodeLibraryManager;
+    }
+
     /**
      * @brief Finds model with specific name
      *
@@ -170,6 +312,28 @@ public:
      */
     const std::shared_ptr<Model> findModelByName(const std::string& name) const;
 
+    /**
+     * @brief Checks which of the served models have no available default version, e.g. are still loading
+     */
+    ModelsReadiness getModelsReadiness() const;
+
+    /**
+     * @brief Gets instances of all versions of all models, safe to use while config is reloaded
+     *
+     * @return model instances
+     */
+    std::vector<std::shared_ptr<ModelInstance>> getModelInstances() const;
+
+    /**
+     * @brief Gets immutable snapshot of served models without taking locks used by config reload,
+     * the atomic load only briefly takes the standard library lock guarding the shared_ptr
+     *
+     * @return models at the time the last model was added
+     */
+    std::shared_ptr<const models_snapshot_t> getModelsSnapshot() const {
+        return std::atomic_load(&modelsSnapshot);
+    }
+
     const bool modelExists(const std::string& name) const {
         if (findModelByName(name) == nullptr)
             return false;
@@ -292,6 +456,17 @@ public:
 
     static std::shared_ptr<FileSystem> getFilesystem(const std::string& basePath);
 
+    /**
+     * @brief Wakes the watcher to check the model, called for events pushed by custom loaders from their threads
+     *
+     * @param modelName
+     */
+    void notifyModelChangedByLoader(const std::string& modelName);
+
+    bool isPipelineModelsFusionEnabled() const {
+        return pipelineModelsFusionEnabled;
+    }
+
 protected:
     /**
      * @brief Reads models from configuration file
@@ -305,6 +480,28 @@ protected:
      * @brief Updates OVMS configuration with cached configuration file. Will check for newly added model versions
      */
     void updateConfigurationWithoutConfigFile();
+
+    /**
+     * @brief Deactivates lazily loaded model versions which were not used for their idle unload timeout
+     * and drops sequences of stateful models which exceeded their sequence timeout
+     */
+    void deactivateIdleModels();
+
+    /**
+     * @brief Splits streams budget again by load of model versions and recompiles versions whose streams changed
+     * in background, up to model loading parallelism at once. Skipped while compilations of the previous split run.
+     */
+    void rebalanceStreams();
+
+    /**
+     * @brief Resizes infer requests queues of model versions with nireq autoscaling by their wait times
+     */
+    void autoscaleInferRequests();
+
+    /**
+     * @brief Stores shape histograms of model versions, so restarted or scaled out servers precompile the observed shapes
+     */
+    void persistShapeProfiles();
 };
 
 }  // namespace ovms
@@ -0,0 +1,89 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "modelmetrics.hpp"
+
+#include <sched.h>
+
+#include <functional>
+#include <thread>
+
+namespace ovms {
+
+const char* toString(ModelStage stage) {
+    switch (stage) {
+    case ModelStage::STREAM_WAIT:
+        return "stream_wait";
+    case ModelStage::DESERIALIZATION:
+        return "deserialization";
+    case ModelStage::INFERENCE:
+        return "inference";
+    case ModelStage::SERIALIZATION:
+        return "serialization";
+    }
+    return "unknown";
+}
+
+uint64_t ShardedCounter::get() const {
+    uint64_t sum = 0;
+    for (const auto& shard : shards) {
+        sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+size_t ShardedCounter::getShardIndex() {
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return static_cast<size_t>(cpu) % SHARDS_COUNT;
+    }
+    static thread_local const size_t threadShard = std::hash<std::thread::id>()(std::this_thread::get_id()) % SHARDS_COUNT;
+    return threadShard;
+}
+
+void RateMeter::record(int64_t second) {
+    auto& bucket = buckets[second % buckets.size()];
+    int64_t bucketSecond = bucket.second.load(std::memory_order_relaxed);
+    if (bucketSecond != second) {
+        if (bucketSecond < second && bucket.second.compare_exchange_strong(bucketSecond, second, std::memory_order_relaxed)) {
+            bucket.count.store(0, std::memory_order_relaxed);
+        } else if (bucket.second.load(std::memory_order_relaxed) != second) {
+            // bucket belongs to a newer second already
+            return;
+        }
+    }
+    bucket.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+double RateMeter::getRate(int64_t second) const {
+    uint64_t sum = 0;
+    for (const auto& bucket : buckets) {
+        const int64_t bucketSecond = bucket.second.load(std::memory_order_relaxed);
+        if (bucketSecond < second && bucketSecond >= second - WINDOW_SECONDS) {
+            sum += bucket.count.load(std::memory_order_relaxed);
+        }
+    }
+    return static_cast<double>(sum) / WINDOW_SECONDS;
+}
+
+size_t ModelMetrics::getBatchSizeBucketIndex(size_t batchSize) {
+    size_t index = 0;
+    while (index + 1 < BATCH_SIZE_BUCKETS_COUNT && getBatchSizeBucketUpperBound(index) < batchSize) {
+        ++index;
+    }
+    return index;
+}
+
+}  // namespace ovms
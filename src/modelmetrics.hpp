@@ -0,0 +1,176 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "latencyhistogram.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Phases of model version inference measured separately
+ */
+enum class ModelStage {
+    STREAM_WAIT,
+    DESERIALIZATION,
+    INFERENCE,
+    SERIALIZATION
+};
+
+constexpr size_t MODEL_STAGES_COUNT = 4;
+
+const char* toString(ModelStage stage);
+
+/**
+ * @brief Counter incremented from many threads, split into cache line sized shards picked by current CPU
+ * so concurrent increments do not contend on a single cache line
+ */
+class ShardedCounter {
+public:
+    static constexpr size_t SHARDS_COUNT = 32;
+
+    void increment() {
+        shards[getShardIndex()].value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const;
+
+    static size_t getShardIndex();
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, SHARDS_COUNT> shards;
+};
+
+/**
+ * @brief Number of events in each of the last seconds, kept in a ring of per second buckets
+ *
+ * Bucket is reused when its second comes around again. Events recorded concurrently with the reuse may be lost,
+ * which is acceptable for a rate estimate.
+ */
+class RateMeter {
+public:
+    static constexpr int64_t WINDOW_SECONDS = 10;
+
+    void record() {
+        record(nowSeconds());
+    }
+
+    void record(int64_t second);
+
+    /**
+     * @brief Gives average rate over the last WINDOW_SECONDS completed seconds
+     */
+    double getRate() const {
+        return getRate(nowSeconds());
+    }
+
+    double getRate(int64_t second) const;
+
+    static int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct Bucket {
+        std::atomic<int64_t> second{-1};
+        std::atomic<uint64_t> count{0};
+    };
+    std::array<Bucket, WINDOW_SECONDS + 1> buckets;
+};
+
+/**
+ * @brief Live throughput and latency statistics of a model version, kept across its reloads
+ *
+ * Recording costs a few relaxed atomic operations so it is always enabled.
+ */
+class ModelMetrics {
+public:
+    /**
+     * @brief Bucket i counts inferences with batch size in range (2^(i-1), 2^i], last bucket counts all larger ones
+     */
+    static constexpr size_t BATCH_SIZE_BUCKETS_COUNT = 16;
+
+    ModelMetrics() = default;
+    ModelMetrics(const ModelMetrics&) = delete;
+    ModelMetrics& operator=(const ModelMetrics&) = delete;
+
+    void recordRequest(bool succeeded) {
+        requests.increment();
+        if (!succeeded) {
+            errors.increment();
+        }
+        requestsRate.record();
+    }
+
+    void recordStage(ModelStage stage, uint64_t microseconds) {
+        stages[static_cast<size_t>(stage)].record(microseconds);
+    }
+
+    uint64_t recordStageSince(ModelStage stage, std::chrono::steady_clock::time_point start) {
+        return stages[static_cast<size_t>(stage)].recordSince(start);
+    }
+
+    void recordLoadSince(std::chrono::steady_clock::time_point start) {
+        loads.recordSince(start);
+    }
+
+    void recordReloadSince(std::chrono::steady_clock::time_point start) {
+        reloads.recordSince(start);
+    }
+
+    void recordBatchSize(size_t batchSize) {
+        batchSizes[getBatchSizeBucketIndex(batchSize)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t getRequests() const { return requests.get(); }
+    uint64_t getErrors() const { return errors.get(); }
+    double getRequestsPerSecond() const { return requestsRate.getRate(); }
+
+    const LatencyHistogram& get(ModelStage stage) const {
+        return stages[static_cast<size_t>(stage)];
+    }
+
+    const LatencyHistogram& getLoads() const { return loads; }
+    const LatencyHistogram& getReloads() const { return reloads; }
+
+    uint64_t getBatchSizeCount(size_t bucketIndex) const {
+        return batchSizes[bucketIndex].load(std::memory_order_relaxed);
+    }
+
+    static size_t getBatchSizeBucketIndex(size_t batchSize);
+
+    static size_t getBatchSizeBucketUpperBound(size_t bucketIndex) {
+        return size_t(1) << bucketIndex;
+    }
+
+private:
+    ShardedCounter requests;
+    ShardedCounter errors;
+    RateMeter requestsRate;
+    std::array<LatencyHistogram, MODEL_STAGES_COUNT> stages;
+    LatencyHistogram loads;
+    LatencyHistogram reloads;
+    std::array<std::atomic<uint64_t>, BATCH_SIZE_BUCKETS_COUNT> batchSizes{};
+};
+
+}  // namespace ovms
@@ -0,0 +1,73 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "modelsmemorybudget.hpp"
+
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include "logging.hpp"
+
+namespace ovms {
+
+void ModelsMemoryBudget::setLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = bytes;
+}
+
+size_t ModelsMemoryBudget::getLimit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return limit;
+}
+
+size_t ModelsMemoryBudget::getUsed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+Status ModelsMemoryBudget::reserve(const std::string& modelName, model_version_t modelVersion, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (limit > 0 && used + bytes > limit) {
+        SPDLOG_LOGGER_WARN(modelmanager_logger, "Loading model: {} version: {} refused, it needs about {} MB while {} MB of models memory budget: {} MB is used",
+            modelName, modelVersion, bytes / (1024 * 1024), used / (1024 * 1024), limit / (1024 * 1024));
+        return StatusCode::MODELS_MEMORY_BUDGET_EXCEEDED;
+    }
+    used += bytes;
+    return StatusCode::OK;
+}
+
+void ModelsMemoryBudget::update(size_t reservedBytes, size_t measuredBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    used = used - reservedBytes + measuredBytes;
+}
+
+void ModelsMemoryBudget::release(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    used -= bytes;
+}
+
+size_t ModelsMemoryBudget::getResidentMemory() {
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * sysconf(_SC_PAGESIZE);
+}
+
+}  // namespace ovms
@@ -0,0 +1,109 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include "model_version_policy.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Memory attributed to a loaded model version, in bytes
+ */
+struct ModelMemoryUsage {
+    /**
+     * @brief Weights and topology read from model files
+     */
+    size_t network = 0;
+
+    /**
+     * @brief Growth of process resident memory while networks were compiled for target devices
+     */
+    size_t executableNetwork = 0;
+
+    /**
+     * @brief Input and output blobs of infer requests of all replicas
+     */
+    size_t inferRequests = 0;
+
+    /**
+     * @brief Responses currently stored in response cache
+     */
+    size_t responseCache = 0;
+
+    size_t total() const {
+        return network + executableNetwork + inferRequests + responseCache;
+    }
+};
+
+/**
+ * @brief Memory budget of all loaded model versions. Loading a version is refused when its estimated usage does not fit,
+ * already loaded versions are never unloaded to make room for it.
+ */
+class ModelsMemoryBudget {
+public:
+    static ModelsMemoryBudget& instance() {
+        static ModelsMemoryBudget instance;
+        return instance;
+    }
+
+    /**
+     * @brief Sets memory limit of loaded model versions
+     *
+     * @param bytes 0 means no limit
+     */
+    void setLimit(size_t bytes);
+
+    size_t getLimit() const;
+
+    /**
+     * @brief Gets memory reserved by loaded model versions
+     */
+    size_t getUsed() const;
+
+    /**
+     * @brief Reserves memory for model version about to be loaded
+     *
+     * @return MODELS_MEMORY_BUDGET_EXCEEDED if reservation does not fit the limit
+     */
+    Status reserve(const std::string& modelName, model_version_t modelVersion, size_t bytes);
+
+    /**
+     * @brief Replaces reservation with memory measured after loading, which is accepted even if it exceeds the limit
+     */
+    void update(size_t reservedBytes, size_t measuredBytes);
+
+    void release(size_t bytes);
+
+    /**
+     * @brief Gets resident memory of the process
+     *
+     * @return bytes, 0 if it cannot be read
+     */
+    static size_t getResidentMemory();
+
+private:
+    ModelsMemoryBudget() = default;
+
+    mutable std::mutex mutex;
+    size_t limit = 0;
+    size_t used = 0;
+};
+
+}  // namespace ovms
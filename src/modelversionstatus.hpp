@@ -15,6 +15,7 @@
 //*****************************************************************************
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -76,11 +77,23 @@ inline const std::string& ModelVersionStatusErrorCodeToString(ModelVersionStatus
     return errors.at(code);
 }
 
-class ModelVersionStatus {
-    std::string modelName;
-    model_version_t version;
+/**
+ * @brief Immutable state of model version, published as a whole on each state transition
+ */
+struct ModelVersionStatusSnapshot {
     ModelVersionState state;
     ModelVersionStatusErrorCode errorCode;
+};
+
+class ModelVersionStatus {
+    std::string modelName;
+    model_version_t version = 0;
+
+    /**
+     * @brief Status readers, e.g. GetModelStatus, load it without locking while model version is being loaded
+     */
+    std::atomic<ModelVersionStatusSnapshot> snapshot{ModelVersionStatusSnapshot{ModelVersionState::START, ModelVersionStatusErrorCode::OK}};
+    static_assert(std::atomic<ModelVersionStatusSnapshot>::is_always_lock_free);
 
 public:
     ModelVersionStatus() = default;
@@ -88,25 +101,43 @@ public:
     ModelVersionStatus(const std::string& model_name, model_version_t version, ModelVersionState state = ModelVersionState::START) :
         modelName(model_name),
         version(version),
-        state(state),
-        errorCode(ModelVersionStatusErrorCode::OK) {
+        snapshot(ModelVersionStatusSnapshot{state, ModelVersionStatusErrorCode::OK}) {
         logStatus();
     }
 
+    ModelVersionStatus(const ModelVersionStatus& rhs) :
+        modelName(rhs.modelName),
+        version(rhs.version),
+        snapshot(rhs.getSnapshot()) {}
+
+    ModelVersionStatus& operator=(const ModelVersionStatus& rhs) {
+        this->modelName = rhs.modelName;
+        this->version = rhs.version;
+        this->snapshot.store(rhs.getSnapshot(), std::memory_order_release);
+        return *this;
+    }
+
+    /**
+     * @brief Gets consistent state and error code of model version
+     */
+    ModelVersionStatusSnapshot getSnapshot() const {
+        return this->snapshot.load(std::memory_order_acquire);
+    }
+
     ModelVersionState getState() const {
-        return this->state;
+        return getSnapshot().state;
     }
 
     const std::string& getStateString() const {
-        return ModelVersionStateToString(this->state);
+        return ModelVersionStateToString(getState());
     }
 
     ModelVersionStatusErrorCode getErrorCode() const {
-        return this->errorCode;
+        return getSnapshot().errorCode;
     }
 
     const std::string& getErrorMsg() const {
-        return ModelVersionStatusErrorCodeToString(this->errorCode);
+        return ModelVersionStatusErrorCodeToString(getErrorCode());
     }
 
     /**
@@ -115,44 +146,42 @@ public:
      * @return
      */
     bool willEndUnloaded() const {
-        return ovms::ModelVersionState::UNLOADING <= this->state;
+        return ovms::ModelVersionState::UNLOADING <= getState();
     }
 
     void setLoading(ModelVersionStatusErrorCode error_code = ModelVersionStatusErrorCode::OK) {
-        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(this->state), ModelVersionStatusErrorCodeToString(error_code));
-        state = ModelVersionState::LOADING;
-        errorCode = error_code;
-        logStatus();
+        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(getState()), ModelVersionStatusErrorCodeToString(error_code));
+        setSnapshot(ModelVersionState::LOADING, error_code);
     }
 
     void setAvailable(ModelVersionStatusErrorCode error_code = ModelVersionStatusErrorCode::OK) {
-        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(this->state), ModelVersionStatusErrorCodeToString(error_code));
-        state = ModelVersionState::AVAILABLE;
-        errorCode = error_code;
-        logStatus();
+        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(getState()), ModelVersionStatusErrorCodeToString(error_code));
+        setSnapshot(ModelVersionState::AVAILABLE, error_code);
     }
 
     void setUnloading(ModelVersionStatusErrorCode error_code = ModelVersionStatusErrorCode::OK) {
-        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(this->state), ModelVersionStatusErrorCodeToString(error_code));
-        state = ModelVersionState::UNLOADING;
-        errorCode = error_code;
-        logStatus();
+        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(getState()), ModelVersionStatusErrorCodeToString(error_code));
+        setSnapshot(ModelVersionState::UNLOADING, error_code);
     }
 
     void setEnd(ModelVersionStatusErrorCode error_code = ModelVersionStatusErrorCode::OK) {
-        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(this->state), ModelVersionStatusErrorCodeToString(error_code));
-        state = ModelVersionState::END;
-        errorCode = error_code;
-        logStatus();
+        SPDLOG_DEBUG("{}: {} - {} (previous state: {}) -> error: {}", __func__, this->modelName, this->version, ModelVersionStateToString(getState()), ModelVersionStatusErrorCodeToString(error_code));
+        setSnapshot(ModelVersionState::END, error_code);
     }
 
 private:
+    void setSnapshot(ModelVersionState state, ModelVersionStatusErrorCode errorCode) {
+        this->snapshot.store(ModelVersionStatusSnapshot{state, errorCode}, std::memory_order_release);
+        logStatus();
+    }
+
     void logStatus() {
+        const auto current = getSnapshot();
         SPDLOG_INFO("STATUS CHANGE: Version {} of model {} status change. New status: ( \"state\": \"{}\", \"error_code\": \"{}\" )",
             this->version,
             this->modelName,
-            ModelVersionStateToString(state),
-            ModelVersionStatusErrorCodeToString(errorCode));
+            ModelVersionStateToString(current.state),
+            ModelVersionStatusErrorCodeToString(current.errorCode));
     }
 };
 
@@ -0,0 +1,188 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ovms {
+
+/**
+ * @brief Lock-free queue with many pushing threads and a single pulling thread at a time
+ *
+ * Pushes link a new cell with one atomic exchange, so inference completion callbacks of many pipelines
+ * do not contend on a mutex with executor threads. Pulling thread sleeps on a futex, which is woken by
+ * pushes only when the consumer is waiting. Pulls have to be serialized by the consumer, e.g. executor
+ * thread of the pipeline or the single task processing its messages.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() :
+        head(new Cell),
+        tail(head.load(std::memory_order_relaxed)) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Waits for pushes still in progress, consumer may destroy the queue as soon as it gets the element
+     */
+    ~MpscQueue() {
+        while (activePushersCount.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        while (tail != nullptr) {
+            Cell* next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+
+    void push(const T& element) {
+        emplace(new Cell(element));
+    }
+
+    void push(T&& element) {
+        emplace(new Cell(std::move(element)));
+    }
+
+    /**
+     * @brief Sets function called after each push, used to process elements without a thread blocked on pull
+     *
+     * Has to be set before any element is pushed. Consumer has to keep the queue alive until listener of the element
+     * it pulled was called.
+     */
+    void setPushListener(std::function<void()> listener) {
+        pushListener = std::move(listener);
+    }
+
+    std::optional<T> tryPull(const uint waitDurationMicroseconds) {
+        return tryPullUntil(std::chrono::steady_clock::now() + std::chrono::microseconds(waitDurationMicroseconds));
+    }
+
+    /**
+     * @brief Blocks until there is an element in the queue
+     */
+    T pull() {
+        while (true) {
+            auto element = pop();
+            if (element) {
+                return std::move(element.value());
+            }
+            wait(nullptr);
+        }
+    }
+
+    /**
+     * @brief Waits for an element until given point in time
+     */
+    template <typename Clock, typename Duration>
+    std::optional<T> tryPullUntil(const std::chrono::time_point<Clock, Duration>& timePoint) {
+        while (true) {
+            auto element = pop();
+            if (element) {
+                return element;
+            }
+            const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint - Clock::now());
+            if (remaining.count() <= 0) {
+                return std::nullopt;
+            }
+            struct timespec timeout;
+            timeout.tv_sec = remaining.count() / 1'000'000'000;
+            timeout.tv_nsec = remaining.count() % 1'000'000'000;
+            wait(&timeout);
+        }
+    }
+
+    size_t size() {
+        return elementsCount.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Cell {
+        Cell() = default;
+        template <typename U>
+        explicit Cell(U&& element) :
+            value(std::forward<U>(element)) {}
+        std::atomic<Cell*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    void emplace(Cell* cell) {
+        activePushersCount.fetch_add(1, std::memory_order_acq_rel);
+        Cell* previous = head.exchange(cell, std::memory_order_acq_rel);
+        previous->next.store(cell, std::memory_order_release);
+        elementsCount.fetch_add(1, std::memory_order_release);
+        // consumer registers as waiter before reading pushes count, so either it sees this push or it is woken
+        pushesCount.fetch_add(1, std::memory_order_seq_cst);
+        if (waitersCount.load(std::memory_order_seq_cst) != 0) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&pushesCount), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+        const bool hasPushListener = static_cast<bool>(pushListener);
+        // queue is not accessed by the pusher anymore, except for the listener which consumer keeps alive
+        activePushersCount.fetch_sub(1, std::memory_order_acq_rel);
+        if (hasPushListener) {
+            pushListener();
+        }
+    }
+
+    /**
+     * @brief Takes the oldest element, empty also when its pusher has not linked it yet, such pusher wakes the consumer afterwards
+     */
+    std::optional<T> pop() {
+        Cell* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return std::nullopt;
+        }
+        std::optional<T> element(std::in_place, std::move(*next->value));
+        next->value.reset();
+        delete tail;
+        tail = next;
+        elementsCount.fetch_sub(1, std::memory_order_release);
+        return element;
+    }
+
+    void wait(const struct timespec* timeout) {
+        waitersCount.fetch_add(1, std::memory_order_seq_cst);
+        const uint32_t observedPushesCount = pushesCount.load(std::memory_order_seq_cst);
+        if (tail->next.load(std::memory_order_acquire) == nullptr) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&pushesCount), FUTEX_WAIT_PRIVATE, observedPushesCount, timeout, nullptr, 0);
+        }
+        waitersCount.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // producers link new cells after head, consumer owns tail which is the dummy cell before the oldest element
+    std::atomic<Cell*> head;
+    Cell* tail;
+    std::atomic<size_t> elementsCount{0};
+    std::atomic<uint32_t> pushesCount{0};
+    std::atomic<uint32_t> waitersCount{0};
+    std::atomic<uint32_t> activePushersCount{0};
+    std::function<void()> pushListener;
+};
+}  // namespace ovms
@@ -0,0 +1,700 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "narrowing.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OVMS_X86_NARROWING
+#endif
+
+namespace ovms {
+
+namespace {
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+uint16_t fp32ToFp16(float value) {
+    uint32_t bits = floatBits(value);
+    const uint16_t sign = (bits >> 16) & 0x8000;
+    bits &= 0x7FFFFFFF;
+    if (bits >= 0x7F800000) {
+        // infinity stays infinity, NaN is quieted keeping upper bits of the payload
+        return sign | 0x7C00 | (bits > 0x7F800000 ? (0x0200 | ((bits >> 13) & 0x03FF)) : 0);
+    }
+    if (bits >= 0x477FF000) {
+        // rounds above the largest half value 65504
+        return sign | 0x7C00;
+    }
+    if (bits < 0x38800000) {
+        // half subnormal range, below 2^-14
+        if (bits <= 0x33000000) {
+            return sign;
+        }
+        const uint32_t exponent = bits >> 23;
+        const uint32_t mantissa = (bits & 0x007FFFFF) | 0x00800000;
+        const uint32_t shift = 126 - exponent;
+        uint32_t result = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (result & 1))) {
+            result++;
+        }
+        return sign | result;
+    }
+    bits += ((bits >> 13) & 1) + 0x0FFF;
+    return sign | ((bits - 0x38000000) >> 13);
+}
+
+float fp16ToFp32(uint16_t value) {
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x03FF;
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        // infinity stays infinity, NaN is quieted as by vcvtph2ps
+        bits = sign | 0x7F800000 | (mantissa << 13) | (mantissa ? 0x00400000 : 0);
+    } else if (exponent == 0 && mantissa == 0) {
+        bits = sign;
+    } else if (exponent == 0) {
+        // half subnormal is normalized in FP32
+        exponent = 113;
+        while (!(mantissa & 0x0400)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x03FF) << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+uint16_t fp32ToBf16(float value) {
+    const uint32_t bits = floatBits(value);
+    if (std::isnan(value)) {
+        return (bits >> 16) | 0x0040;
+    }
+    return (bits + 0x7FFF + ((bits >> 16) & 1)) >> 16;
+}
+
+template <typename T>
+T fp32ToInteger(float value, float lowest, float highest) {
+    // comparisons are ordered as vectorized max/min so NaN ends up as lowest
+    value = value > lowest ? value : lowest;
+    value = value < highest ? value : highest;
+    return static_cast<T>(std::nearbyint(value));
+}
+}  // namespace
+
+void narrowToUint16Scalar(const int32_t* source, uint16_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = static_cast<uint16_t>(source[i]);
+    }
+}
+
+void narrowToUint8Scalar(const int32_t* source, uint8_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = static_cast<uint8_t>(source[i]);
+    }
+}
+
+void narrowFp32ToFp16Scalar(const float* source, uint16_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = fp32ToFp16(source[i]);
+    }
+}
+
+void widenFp16ToFp32Scalar(const uint16_t* source, float* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = fp16ToFp32(source[i]);
+    }
+}
+
+void narrowFp32ToBf16Scalar(const float* source, uint16_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = fp32ToBf16(source[i]);
+    }
+}
+
+void narrowFp32ToU8Scalar(const float* source, uint8_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = fp32ToInteger<uint8_t>(source[i], 0.0f, 255.0f);
+    }
+}
+
+void narrowFp32ToI8Scalar(const float* source, int8_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = fp32ToInteger<int8_t>(source[i], -128.0f, 127.0f);
+    }
+}
+
+void narrowI64ToI32Scalar(const int64_t* source, int32_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = static_cast<int32_t>(source[i]);
+    }
+}
+
+void widenBf16ToFp32Scalar(const uint16_t* source, float* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits = static_cast<uint32_t>(source[i]) << 16;
+        std::memcpy(destination + i, &bits, sizeof(bits));
+    }
+}
+
+void minMaxFp32Scalar(const float* source, size_t count, float& lowest, float& highest) {
+    lowest = std::numeric_limits<float>::infinity();
+    highest = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < count; i++) {
+        // NaN fails both comparisons
+        lowest = source[i] < lowest ? source[i] : lowest;
+        highest = source[i] > highest ? source[i] : highest;
+    }
+}
+
+void quantizeFp32ToI8Scalar(const float* source, int8_t* destination, size_t count, float scale, int32_t zeroPoint) {
+    const float inverseScale = 1.0f / scale;
+    const float offset = static_cast<float>(zeroPoint);
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = fp32ToInteger<int8_t>(source[i] * inverseScale + offset, -128.0f, 127.0f);
+    }
+}
+
+#ifdef OVMS_X86_NARROWING
+// unmasked AVX-512 intrinsics pass undefined vectors as merge source, which GCC reports as maybe uninitialized,
+// zero masked forms with all lanes selected are used instead
+namespace {
+__attribute__((target("sse4.1"))) void narrowToUint16Sse41(const int32_t* source, uint16_t* destination, size_t count) {
+    // Values are masked before packing since packus saturates instead of truncating
+    const __m128i mask = _mm_set1_epi32(0xFFFF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i low = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)), mask);
+        __m128i high = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 4)), mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi32(low, high));
+    }
+    narrowToUint16Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void narrowToUint16Avx2(const int32_t* source, uint16_t* destination, size_t count) {
+    const __m256i mask = _mm256_set1_epi32(0xFFFF);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i low = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)), mask);
+        __m256i high = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 8)), mask);
+        // packus works within 128 bit lanes, restore the order of 64 bit quarters afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), packed);
+    }
+    narrowToUint16Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void narrowToUint16Avx512(const int32_t* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i values = _mm512_loadu_si512(source + i);
+        _mm512_mask_cvtepi32_storeu_epi16(destination + i, 0xFFFF, values);
+    }
+    narrowToUint16Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("sse4.1"))) void narrowToUint8Sse41(const int32_t* source, uint8_t* destination, size_t count) {
+    // Masked values fit into bytes, so both saturating packs keep them unchanged
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i* in = reinterpret_cast<const __m128i*>(source + i);
+        __m128i first = _mm_packus_epi32(_mm_and_si128(_mm_loadu_si128(in), mask), _mm_and_si128(_mm_loadu_si128(in + 1), mask));
+        __m128i second = _mm_packus_epi32(_mm_and_si128(_mm_loadu_si128(in + 2), mask), _mm_and_si128(_mm_loadu_si128(in + 3), mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(first, second));
+    }
+    narrowToUint8Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void narrowToUint8Avx2(const int32_t* source, uint8_t* destination, size_t count) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    // packs work within 128 bit lanes, gather 32 bit groups of 4 values back into source order
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i* in = reinterpret_cast<const __m256i*>(source + i);
+        __m256i first = _mm256_packus_epi32(_mm256_and_si256(_mm256_loadu_si256(in), mask), _mm256_and_si256(_mm256_loadu_si256(in + 1), mask));
+        __m256i second = _mm256_packus_epi32(_mm256_and_si256(_mm256_loadu_si256(in + 2), mask), _mm256_and_si256(_mm256_loadu_si256(in + 3), mask));
+        __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(first, second), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), packed);
+    }
+    narrowToUint8Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void narrowToUint8Avx512(const int32_t* source, uint8_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_mask_cvtepi32_storeu_epi8(destination + i, 0xFFFF, _mm512_loadu_si512(source + i));
+    }
+    narrowToUint8Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx,f16c"))) void narrowFp32ToFp16F16c(const float* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i converted = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), converted);
+    }
+    narrowFp32ToFp16Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void narrowFp32ToFp16Avx512(const float* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i converted = _mm512_maskz_cvtps_ph(0xFFFF, _mm512_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), converted);
+    }
+    narrowFp32ToFp16Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx,f16c"))) void widenFp16ToFp32F16c(const uint16_t* source, float* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm256_storeu_ps(destination + i, _mm256_cvtph_ps(values));
+    }
+    widenFp16ToFp32Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void widenFp16ToFp32Avx512(const uint16_t* source, float* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm512_storeu_ps(destination + i, _mm512_maskz_cvtph_ps(0xFFFF, values));
+    }
+    widenFp16ToFp32Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) __m256i fp32ToBf16Avx2(__m256 values) {
+    const __m256i bits = _mm256_castps_si256(values);
+    const __m256i upper = _mm256_srli_epi32(bits, 16);
+    const __m256i bias = _mm256_add_epi32(_mm256_set1_epi32(0x7FFF), _mm256_and_si256(upper, _mm256_set1_epi32(1)));
+    const __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, bias), 16);
+    const __m256i quietNan = _mm256_or_si256(upper, _mm256_set1_epi32(0x0040));
+    const __m256i isNan = _mm256_castps_si256(_mm256_cmp_ps(values, values, _CMP_UNORD_Q));
+    return _mm256_blendv_epi8(rounded, quietNan, isNan);
+}
+
+__attribute__((target("avx2"))) void narrowFp32ToBf16Avx2(const float* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i low = fp32ToBf16Avx2(_mm256_loadu_ps(source + i));
+        __m256i high = fp32ToBf16Avx2(_mm256_loadu_ps(source + i + 8));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), packed);
+    }
+    narrowFp32ToBf16Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void narrowFp32ToBf16Avx512(const float* source, uint16_t* destination, size_t count) {
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i roundingBias = _mm512_set1_epi32(0x7FFF);
+    const __m512i quietBit = _mm512_set1_epi32(0x0040);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512 values = _mm512_loadu_ps(source + i);
+        const __m512i bits = _mm512_castps_si512(values);
+        const __m512i upper = _mm512_maskz_srli_epi32(0xFFFF, bits, 16);
+        const __m512i bias = _mm512_add_epi32(roundingBias, _mm512_and_si512(upper, one));
+        __m512i result = _mm512_maskz_srli_epi32(0xFFFF, _mm512_add_epi32(bits, bias), 16);
+        const __mmask16 isNan = _mm512_cmp_ps_mask(values, values, _CMP_UNORD_Q);
+        result = _mm512_mask_blend_epi32(isNan, result, _mm512_or_si512(upper, quietBit));
+        _mm512_mask_cvtepi32_storeu_epi16(destination + i, 0xFFFF, result);
+    }
+    narrowFp32ToBf16Scalar(source + i, destination + i, count - i);
+}
+
+/**
+ * @brief Rounds 16 values clamped to [lowest, highest] into 16 bit integers in source order
+ */
+__attribute__((target("avx2"))) __m128i fp32ToInt16Avx2(__m256 low, __m256 high, __m256 lowest, __m256 highest, bool isUnsigned) {
+    low = _mm256_min_ps(_mm256_max_ps(low, lowest), highest);
+    high = _mm256_min_ps(_mm256_max_ps(high, lowest), highest);
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_cvtps_epi32(low), _mm256_cvtps_epi32(high)), 0xD8);
+    __m128i first = _mm256_castsi256_si128(packed);
+    __m128i second = _mm256_extracti128_si256(packed, 1);
+    return isUnsigned ? _mm_packus_epi16(first, second) : _mm_packs_epi16(first, second);
+}
+
+__attribute__((target("avx2"))) void narrowFp32ToU8Avx2(const float* source, uint8_t* destination, size_t count) {
+    const __m256 lowest = _mm256_set1_ps(0.0f);
+    const __m256 highest = _mm256_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), fp32ToInt16Avx2(_mm256_loadu_ps(source + i), _mm256_loadu_ps(source + i + 8), lowest, highest, true));
+    }
+    narrowFp32ToU8Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void narrowFp32ToI8Avx2(const float* source, int8_t* destination, size_t count) {
+    const __m256 lowest = _mm256_set1_ps(-128.0f);
+    const __m256 highest = _mm256_set1_ps(127.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), fp32ToInt16Avx2(_mm256_loadu_ps(source + i), _mm256_loadu_ps(source + i + 8), lowest, highest, false));
+    }
+    narrowFp32ToI8Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void narrowFp32ToU8Avx512(const float* source, uint8_t* destination, size_t count) {
+    const __m512 lowest = _mm512_set1_ps(0.0f);
+    const __m512 highest = _mm512_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 values = _mm512_maskz_min_ps(0xFFFF, _mm512_maskz_max_ps(0xFFFF, _mm512_loadu_ps(source + i), lowest), highest);
+        _mm512_mask_cvtepi32_storeu_epi8(destination + i, 0xFFFF, _mm512_maskz_cvtps_epi32(0xFFFF, values));
+    }
+    narrowFp32ToU8Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void narrowFp32ToI8Avx512(const float* source, int8_t* destination, size_t count) {
+    const __m512 lowest = _mm512_set1_ps(-128.0f);
+    const __m512 highest = _mm512_set1_ps(127.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 values = _mm512_maskz_min_ps(0xFFFF, _mm512_maskz_max_ps(0xFFFF, _mm512_loadu_ps(source + i), lowest), highest);
+        _mm512_mask_cvtepi32_storeu_epi8(destination + i, 0xFFFF, _mm512_maskz_cvtps_epi32(0xFFFF, values));
+    }
+    narrowFp32ToI8Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void widenBf16ToFp32Avx2(const uint16_t* source, float* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i widened = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        _mm256_storeu_ps(destination + i, _mm256_castsi256_ps(_mm256_slli_epi32(widened, 16)));
+    }
+    widenBf16ToFp32Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void widenBf16ToFp32Avx512(const uint16_t* source, float* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i widened = _mm512_maskz_cvtepu16_epi32(0xFFFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+        _mm512_storeu_ps(destination + i, _mm512_castsi512_ps(_mm512_maskz_slli_epi32(0xFFFF, widened, 16)));
+    }
+    widenBf16ToFp32Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void minMaxFp32Avx2(const float* source, size_t count, float& lowest, float& highest) {
+    // min and max return the second operand when any of them is NaN, so accumulators skip NaN values
+    __m256 low = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    __m256 high = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 values = _mm256_loadu_ps(source + i);
+        low = _mm256_min_ps(values, low);
+        high = _mm256_max_ps(values, high);
+    }
+    float lows[8], highs[8];
+    _mm256_storeu_ps(lows, low);
+    _mm256_storeu_ps(highs, high);
+    minMaxFp32Scalar(source + i, count - i, lowest, highest);
+    for (size_t j = 0; j < 8; j++) {
+        lowest = lows[j] < lowest ? lows[j] : lowest;
+        highest = highs[j] > highest ? highs[j] : highest;
+    }
+}
+
+__attribute__((target("avx512f"))) void minMaxFp32Avx512(const float* source, size_t count, float& lowest, float& highest) {
+    __m512 low = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+    __m512 high = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 values = _mm512_loadu_ps(source + i);
+        low = _mm512_maskz_min_ps(0xFFFF, values, low);
+        high = _mm512_maskz_max_ps(0xFFFF, values, high);
+    }
+    float lows[16], highs[16];
+    _mm512_storeu_ps(lows, low);
+    _mm512_storeu_ps(highs, high);
+    minMaxFp32Scalar(source + i, count - i, lowest, highest);
+    for (size_t j = 0; j < 16; j++) {
+        lowest = lows[j] < lowest ? lows[j] : lowest;
+        highest = highs[j] > highest ? highs[j] : highest;
+    }
+}
+
+__attribute__((target("avx2"))) void quantizeFp32ToI8Avx2(const float* source, int8_t* destination, size_t count, float scale, int32_t zeroPoint) {
+    const __m256 lowest = _mm256_set1_ps(-128.0f);
+    const __m256 highest = _mm256_set1_ps(127.0f);
+    const __m256 inverseScale = _mm256_set1_ps(1.0f / scale);
+    const __m256 offset = _mm256_set1_ps(static_cast<float>(zeroPoint));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 low = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(source + i), inverseScale), offset);
+        __m256 high = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(source + i + 8), inverseScale), offset);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), fp32ToInt16Avx2(low, high, lowest, highest, false));
+    }
+    quantizeFp32ToI8Scalar(source + i, destination + i, count - i, scale, zeroPoint);
+}
+
+__attribute__((target("avx512f"))) void quantizeFp32ToI8Avx512(const float* source, int8_t* destination, size_t count, float scale, int32_t zeroPoint) {
+    const __m512 lowest = _mm512_set1_ps(-128.0f);
+    const __m512 highest = _mm512_set1_ps(127.0f);
+    const __m512 inverseScale = _mm512_set1_ps(1.0f / scale);
+    const __m512 offset = _mm512_set1_ps(static_cast<float>(zeroPoint));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 values = _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(source + i), inverseScale), offset);
+        values = _mm512_maskz_min_ps(0xFFFF, _mm512_maskz_max_ps(0xFFFF, values, lowest), highest);
+        _mm512_mask_cvtepi32_storeu_epi8(destination + i, 0xFFFF, _mm512_maskz_cvtps_epi32(0xFFFF, values));
+    }
+    quantizeFp32ToI8Scalar(source + i, destination + i, count - i, scale, zeroPoint);
+}
+
+__attribute__((target("sse4.1"))) void narrowI64ToI32Sse41(const int64_t* source, int32_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // take lower 32 bit halves of both vectors
+        __m128 low = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        __m128 high = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 2)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0))));
+    }
+    narrowI64ToI32Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void narrowI64ToI32Avx2(const int64_t* source, int32_t* destination, size_t count) {
+    const __m256i lowerHalves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i low = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)), lowerHalves);
+        __m256i high = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 4)), lowerHalves);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permute2x128_si256(low, high, 0x20));
+    }
+    narrowI64ToI32Scalar(source + i, destination + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void narrowI64ToI32Avx512(const int64_t* source, int32_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm512_mask_cvtepi64_storeu_epi32(destination + i, 0xFF, _mm512_loadu_si512(source + i));
+    }
+    narrowI64ToI32Scalar(source + i, destination + i, count - i);
+}
+
+enum class VectorExtension {
+    NONE,
+    SSE41,
+    AVX2,
+    F16C,
+    AVX512,
+};
+
+VectorExtension getWidestVectorExtension() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return VectorExtension::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        // every CPU with AVX2 supports F16C
+        return VectorExtension::AVX2;
+    }
+    if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c")) {
+        return VectorExtension::F16C;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return VectorExtension::SSE41;
+    }
+    return VectorExtension::NONE;
+}
+
+const VectorExtension& widestVectorExtension() {
+    static const VectorExtension extension = getWidestVectorExtension();
+    return extension;
+}
+}  // namespace
+#endif
+
+void narrowToUint16(const int32_t* source, uint16_t* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return narrowToUint16Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+        return narrowToUint16Avx2(source, destination, count);
+    case VectorExtension::F16C:
+    case VectorExtension::SSE41:
+        return narrowToUint16Sse41(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    narrowToUint16Scalar(source, destination, count);
+}
+
+void narrowToUint8(const int32_t* source, uint8_t* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return narrowToUint8Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+        return narrowToUint8Avx2(source, destination, count);
+    case VectorExtension::F16C:
+    case VectorExtension::SSE41:
+        return narrowToUint8Sse41(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    narrowToUint8Scalar(source, destination, count);
+}
+
+void narrowFp32ToFp16(const float* source, uint16_t* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return narrowFp32ToFp16Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+    case VectorExtension::F16C:
+        return narrowFp32ToFp16F16c(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    narrowFp32ToFp16Scalar(source, destination, count);
+}
+
+void widenFp16ToFp32(const uint16_t* source, float* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return widenFp16ToFp32Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+    case VectorExtension::F16C:
+        return widenFp16ToFp32F16c(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    widenFp16ToFp32Scalar(source, destination, count);
+}
+
+void narrowFp32ToBf16(const float* source, uint16_t* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return narrowFp32ToBf16Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+        return narrowFp32ToBf16Avx2(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    narrowFp32ToBf16Scalar(source, destination, count);
+}
+
+void narrowFp32ToU8(const float* source, uint8_t* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return narrowFp32ToU8Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+        return narrowFp32ToU8Avx2(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    narrowFp32ToU8Scalar(source, destination, count);
+}
+
+void narrowFp32ToI8(const float* source, int8_t* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return narrowFp32ToI8Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+        return narrowFp32ToI8Avx2(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    narrowFp32ToI8Scalar(source, destination, count);
+}
+
+void narrowI64ToI32(const int64_t* source, int32_t* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return narrowI64ToI32Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+        return narrowI64ToI32Avx2(source, destination, count);
+    case VectorExtension::F16C:
+    case VectorExtension::SSE41:
+        return narrowI64ToI32Sse41(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    narrowI64ToI32Scalar(source, destination, count);
+}
+
+void widenBf16ToFp32(const uint16_t* source, float* destination, size_t count) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return widenBf16ToFp32Avx512(source, destination, count);
+    case VectorExtension::AVX2:
+        return widenBf16ToFp32Avx2(source, destination, count);
+    default:
+        break;
+    }
+#endif
+    widenBf16ToFp32Scalar(source, destination, count);
+}
+
+void minMaxFp32(const float* source, size_t count, float& lowest, float& highest) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return minMaxFp32Avx512(source, count, lowest, highest);
+    case VectorExtension::AVX2:
+        return minMaxFp32Avx2(source, count, lowest, highest);
+    default:
+        break;
+    }
+#endif
+    minMaxFp32Scalar(source, count, lowest, highest);
+}
+
+void quantizeFp32ToI8(const float* source, int8_t* destination, size_t count, float scale, int32_t zeroPoint) {
+#ifdef OVMS_X86_NARROWING
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return quantizeFp32ToI8Avx512(source, destination, count, scale, zeroPoint);
+    case VectorExtension::AVX2:
+        return quantizeFp32ToI8Avx2(source, destination, count, scale, zeroPoint);
+    default:
+        break;
+    }
+#endif
+    quantizeFp32ToI8Scalar(source, destination, count, scale, zeroPoint);
+}
+
+}  // namespace ovms
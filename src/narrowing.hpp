@@ -0,0 +1,103 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ovms {
+
+/**
+ * @brief Writes lower 16 bits of each value into destination, as assignment of int32_t to uint16_t does.
+ * Uses the widest vector instructions supported by the CPU, detected once on first use.
+ *
+ * @param source values padded to 32 bits, e.g. half_val or int_val of tensor proto
+ * @param destination buffer for count values
+ * @param count
+ */
+void narrowToUint16(const int32_t* source, uint16_t* destination, size_t count);
+
+/**
+ * @brief Writes lower 8 bits of each value into destination, as assignment of int32_t to uint8_t does
+ *
+ * @param source values padded to 32 bits, e.g. int_val of tensor proto with U8 or I8 values
+ * @param destination buffer for count values
+ * @param count
+ */
+void narrowToUint8(const int32_t* source, uint8_t* destination, size_t count);
+
+/**
+ * @brief Converts FP32 values to IEEE half precision bit patterns, rounding to nearest even
+ */
+void narrowFp32ToFp16(const float* source, uint16_t* destination, size_t count);
+
+/**
+ * @brief Converts IEEE half precision bit patterns to FP32 values. Conversion is exact, NaN is quieted.
+ */
+void widenFp16ToFp32(const uint16_t* source, float* destination, size_t count);
+
+/**
+ * @brief Converts FP32 values to bfloat16 bit patterns, rounding to nearest even
+ */
+void narrowFp32ToBf16(const float* source, uint16_t* destination, size_t count);
+
+/**
+ * @brief Converts FP32 values to U8, rounding to nearest even and saturating to [0, 255]. NaN is converted to 0.
+ */
+void narrowFp32ToU8(const float* source, uint8_t* destination, size_t count);
+
+/**
+ * @brief Converts FP32 values to I8, rounding to nearest even and saturating to [-128, 127]. NaN is converted to -128.
+ */
+void narrowFp32ToI8(const float* source, int8_t* destination, size_t count);
+
+/**
+ * @brief Writes lower 32 bits of each value into destination, as assignment of int64_t to int32_t does
+ */
+void narrowI64ToI32(const int64_t* source, int32_t* destination, size_t count);
+
+/**
+ * @brief Converts bfloat16 bit patterns to FP32 values. Conversion is exact.
+ */
+void widenBf16ToFp32(const uint16_t* source, float* destination, size_t count);
+
+/**
+ * @brief Finds the lowest and the highest of FP32 values skipping NaN, +inf and -inf are returned when there are no other values
+ */
+void minMaxFp32(const float* source, size_t count, float& lowest, float& highest);
+
+/**
+ * @brief Quantizes FP32 values to I8 as value * (1 / scale) + zeroPoint, rounding to nearest even and saturating to [-128, 127].
+ * NaN is converted to -128.
+ */
+void quantizeFp32ToI8(const float* source, int8_t* destination, size_t count, float scale, int32_t zeroPoint);
+
+/**
+ * @brief Scalar versions of the conversions, used for the tail of vectorized loops
+ */
+void narrowToUint16Scalar(const int32_t* source, uint16_t* destination, size_t count);
+void narrowToUint8Scalar(const int32_t* source, uint8_t* destination, size_t count);
+void narrowFp32ToFp16Scalar(const float* source, uint16_t* destination, size_t count);
+void widenFp16ToFp32Scalar(const uint16_t* source, float* destination, size_t count);
+void narrowFp32ToBf16Scalar(const float* source, uint16_t* destination, size_t count);
+void narrowFp32ToU8Scalar(const float* source, uint8_t* destination, size_t count);
+void narrowFp32ToI8Scalar(const float* source, int8_t* destination, size_t count);
+void narrowI64ToI32Scalar(const int64_t* source, int32_t* destination, size_t count);
+void widenBf16ToFp32Scalar(const uint16_t* source, float* destination, size_t count);
+void minMaxFp32Scalar(const float* source, size_t count, float& lowest, float& highest);
+void quantizeFp32ToI8Scalar(const float* source, int8_t* destination, size_t count, float scale, int32_t zeroPoint);
+
+}  // namespace ovms
@@ -20,6 +20,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include "logging.hpp"
 #include "status.hpp"
 
 namespace ovms {
@@ -30,12 +31,20 @@ void Node::printNodeConnections(const std::string& nodeName, const std::string&
     for (auto& pair : pairs) {
         ss << "\t" << nodeName << "[" << pair.second << "]=" << sourceNode << "[" << pair.first << "]\n";
     }
-    SPDLOG_DEBUG(ss.str());
+    OVMS_HOT_PATH_DEBUG(ss.str());
 }
 
 Status Node::setInputs(const Node& dependency, BlobMap& inputs) {
     // mapping for dependency - keeps mapping between dependency output name and this node input name
     const auto& mapping_for_dependency = this->getMappingByDependency(dependency);
+    if (this->inputBlobs.empty()) {
+        // blobs of all dependencies are inserted without rehashing
+        size_t inputsCount = 0;
+        for (const auto& mapping : this->blobNamesMapping) {
+            inputsCount += mapping.size();
+        }
+        this->inputBlobs.reserve(inputsCount);
+    }
 
     // assign all input blobs from inputs that are required by this node for future inference
     for (const auto& pair : mapping_for_dependency) {
@@ -51,7 +60,7 @@ Status Node::setInputs(const Node& dependency, BlobMap& inputs) {
                 dependency_output_name);
             return StatusCode::INVALID_MISSING_INPUT;
         }
-        SPDLOG_DEBUG("Node::setInputs: setting required input for (Node name {}) from (Node name {}), input name: {}, dependency output name: {}",
+        OVMS_HOT_PATH_DEBUG("Node::setInputs: setting required input for (Node name {}) from (Node name {}), input name: {}, dependency output name: {}",
             getName(),
             dependency.getName(),
             current_node_input_name,
@@ -15,6 +15,9 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -22,8 +25,10 @@
 
 #include <inference_engine.hpp>
 
+#include "deadline.hpp"
+#include "mpscqueue.hpp"
+#include "pipelinemetrics.hpp"
 #include "status.hpp"
-#include "threadsafequeue.hpp"
 
 namespace ovms {
 
@@ -35,6 +40,18 @@ class Node {
 protected:
     std::string nodeName;
 
+    // Position of the node in pipeline, used to track execution state without name lookups
+    size_t id = 0;
+
+    // Remaining critical path of the node in microseconds, nodes with higher priority get inference streams first
+    uint64_t priority = 0;
+
+    // Deadline of the pipeline, nodes waiting for inference streams or slots give up once it passes
+    deadline_t deadline = NO_DEADLINE;
+
+    // Latency histograms shared by all executions of the node, not measured when empty
+    std::shared_ptr<NodeMetrics> metrics;
+
     std::vector<std::reference_wrapper<Node>> previous;
     std::vector<std::reference_wrapper<Node>> next;
 
@@ -43,8 +60,8 @@ protected:
     // Blobs ready and waiting for execution
     BlobMap inputBlobs;
 
-    // Input/Output name mapping and list of required inputs from previous nodes
-    std::unordered_map<std::string, InputPairs> blobNamesMapping;
+    // Input/Output name mapping and list of required inputs from previous nodes, in order of previous
+    std::vector<InputPairs> blobNamesMapping;
 
 public:
     Node(const std::string& nodeName) :
@@ -55,29 +72,67 @@ public:
 
     const std::string& getName() const { return this->nodeName; }
 
-    virtual Status execute(ThreadSafeQueue<std::reference_wrapper<Node>>& notifyEndQueue) = 0;
+    size_t getId() const { return this->id; }
+    void setId(size_t id) { this->id = id; }
+
+    uint64_t getPriority() const { return this->priority; }
+    void setPriority(uint64_t priority) { this->priority = priority; }
+
+    const deadline_t& getDeadline() const { return this->deadline; }
+    void setDeadline(const deadline_t& deadline) { this->deadline = deadline; }
+
+    void setMetrics(std::shared_ptr<NodeMetrics> metrics) { this->metrics = std::move(metrics); }
+
+    virtual Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) = 0;
     virtual Status fetchResults(BlobMap& outputs) = 0;
 
     Status setInputs(const Node& dependency, BlobMap& inputs);
 
     virtual void addDependency(Node& node, const InputPairs& blobNamesMapping) {
         this->previous.emplace_back(node);
-        this->blobNamesMapping[node.getName()] = blobNamesMapping;
+        this->blobNamesMapping.emplace_back(blobNamesMapping);
     }
 
     virtual void addDependant(Node& node) { this->next.emplace_back(node); }
 
-    const InputPairs& getMappingByDependency(const Node& dependency) {
-        return blobNamesMapping.at(dependency.getName());
+    const InputPairs& getMappingByDependency(const Node& dependency) const {
+        // nodes have just a few dependencies, scanning them is cheaper than hashing the name
+        for (size_t i = 0; i < previous.size(); ++i) {
+            if (&previous[i].get() == &dependency) {
+                return blobNamesMapping[i];
+            }
+        }
+        throw std::out_of_range("node " + dependency.getName() + " is not a dependency of " + getName());
     }
     bool isReady() const {
         return finishedDependenciesCount == previous.size();
     }
+
+    /**
+     * @brief Counts skipped dependency as finished without receiving its outputs
+     */
+    void skipDependency() {
+        this->finishedDependenciesCount++;
+    }
+
+    /**
+     * @brief Tells if finished node requires all its dependants to be skipped, checked after fetching results
+     */
+    virtual bool isSkippingDependants() const {
+        return false;
+    }
     const std::vector<std::reference_wrapper<Node>>& getNextNodes() {
         return next;
     }
     virtual void release() {}
-    virtual bool tryDisarmStreamIdGuard(const uint microseconds = 1) { return true; }
+
+    /**
+     * @brief Drops state of finished execution so that node can be reused by next pipeline of the same definition
+     */
+    virtual void reset() {
+        this->inputBlobs.clear();
+        this->finishedDependenciesCount = 0;
+    }
 
     static void printNodeConnections(const std::string& nodeName, const std::string& sourceNode, const InputPairs& pairs);
 };
@@ -15,53 +15,125 @@
 //*****************************************************************************
 #pragma once
 
-#include <future>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <utility>
 
 #include <spdlog/spdlog.h>
 
+#include "deadline.hpp"
 #include "ovinferrequestsqueue.hpp"
 
 namespace ovms {
+/**
+ * @brief Holds stream id of a pipeline node
+ *
+ * When there is no idle stream at construction time guard registers as a waiter of infer requests queue.
+ * Stream id is then assigned by the thread returning a stream and onStreamIdReady is called right after,
+ * so the waiting pipeline is woken up instead of polling for it. Waiting guards with higher priority get stream first.
+ * When the deadline passes while waiting the guard expires and onStreamIdReady is called as well.
+ */
 struct NodeStreamIdGuard {
-    NodeStreamIdGuard(ovms::OVInferRequestsQueue& inferRequestsQueue) :
+    NodeStreamIdGuard(ovms::OVInferRequestsQueue& inferRequestsQueue, std::function<void()> onStreamIdReady = []() {}, uint64_t priority = 0, const deadline_t& deadline = NO_DEADLINE) :
         inferRequestsQueue_(inferRequestsQueue),
-        futureStreamId(inferRequestsQueue_.getIdleStream()) {}
+        state(std::make_shared<State>()) {
+        state->streamId = inferRequestsQueue_.tryGetIdleStream();
+        // register as a waiter only when there is no idle stream at the moment
+        if (!state->streamId) {
+            deferred = true;
+            state->onStreamIdReady = std::move(onStreamIdReady);
+            auto onStreamIdAssigned = [&inferRequestsQueue = inferRequestsQueue_, state = this->state](int streamId) {
+                std::unique_lock<std::mutex> lock(state->mtx);
+                if (streamId == EXPIRED_STREAM_ID) {
+                    // queue does not hand out the stream after deadline, there is nothing to return
+                    state->expired = true;
+                    if (!state->disarmed) {
+                        state->onStreamIdReady();
+                    }
+                    return;
+                }
+                if (state->disarmed) {
+                    // guard gave up waiting, stream is not needed anymore
+                    lock.unlock();
+                    SPDLOG_DEBUG("Returning streamId: {} assigned after guard was disarmed", streamId);
+                    inferRequestsQueue.returnStream(streamId);
+                    return;
+                }
+                state->streamId = streamId;
+                // called under the lock so that guard cannot be disarmed meanwhile
+                state->onStreamIdReady();
+            };
+            inferRequestsQueue_.getIdleStream(std::move(onStreamIdAssigned), deadline, priority);
+        }
+    }
 
     ~NodeStreamIdGuard() {
-        if (!disarmed) {
-            if (!streamId) {
-                SPDLOG_DEBUG("Trying to disarm stream Id that is not needed anymore...");
-                streamId = futureStreamId.get();
-            }
-            SPDLOG_DEBUG("Returning streamId: {}", streamId.value());
-            inferRequestsQueue_.returnStream(streamId.value());
-        }
+        tryDisarm();
     }
 
-    std::optional<int> tryGetId(const uint microseconds = 1) {
-        if (!streamId) {
-            if (std::future_status::ready == futureStreamId.wait_for(std::chrono::microseconds(microseconds))) {
-                streamId = futureStreamId.get();
-            }
-        }
-        return streamId;
+    /**
+     * @brief Tells if guard had to wait for stream id, onStreamIdReady is called only in that case
+     */
+    bool isDeferred() const {
+        return deferred;
+    }
+
+    std::optional<int> tryGetId() {
+        std::unique_lock<std::mutex> lock(state->mtx);
+        return state->streamId;
     }
 
-    bool tryDisarm(const uint microseconds = 1) {
-        if (std::future_status::ready == futureStreamId.wait_for(std::chrono::microseconds(microseconds))) {
-            streamId = futureStreamId.get();
-            SPDLOG_DEBUG("Returning streamId:", streamId.value());
-            inferRequestsQueue_.returnStream(streamId.value());
-            disarmed = true;
+    /**
+     * @brief Tells if deadline passed before stream id was assigned
+     */
+    bool isExpired() {
+        std::unique_lock<std::mutex> lock(state->mtx);
+        return state->expired;
+    }
+
+    /**
+     * @brief Returns the stream or stops waiting for it, stream assigned later is returned right away
+     *
+     * @return always true, guard does not need to wait for the stream to be disarmed
+     */
+    bool tryDisarm() {
+        std::unique_lock<std::mutex> lock(state->mtx);
+        if (state->disarmed) {
+            return true;
+        }
+        state->disarmed = true;
+        if (state->streamId) {
+            SPDLOG_DEBUG("Returning streamId: {}", state->streamId.value());
+            const int streamId = state->streamId.value();
+            lock.unlock();
+            inferRequestsQueue_.returnStream(streamId);
+        } else {
+            SPDLOG_DEBUG("Disarming stream Id guard which is still waiting for a stream");
         }
-        return disarmed;
+        return true;
+    }
+
+    ovms::OVInferRequestsQueue& getInferRequestsQueue() {
+        return inferRequestsQueue_;
     }
 
 private:
+    /**
+     * @brief Shared with the callback registered in infer requests queue, which can outlive the guard
+     */
+    struct State {
+        std::mutex mtx;
+        std::optional<int> streamId = std::nullopt;
+        bool disarmed = false;
+        bool expired = false;
+        std::function<void()> onStreamIdReady;
+    };
+
     ovms::OVInferRequestsQueue& inferRequestsQueue_;
-    std::future<int> futureStreamId;
-    std::optional<int> streamId = std::nullopt;
-    bool disarmed = false;
+    std::shared_ptr<State> state;
+    bool deferred = false;
 };
 }  // namespace ovms
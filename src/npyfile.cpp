@@ -0,0 +1,266 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "npyfile.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace ovms {
+
+namespace {
+
+const char NPY_MAGIC[] = "\x93NUMPY";
+const size_t NPY_MAGIC_SIZE = 6;
+
+const std::pair<const char*, tensorflow::DataType> NPY_DTYPES[] = {
+    {"f4", tensorflow::DataType::DT_FLOAT},
+    {"f2", tensorflow::DataType::DT_HALF},
+    {"f8", tensorflow::DataType::DT_DOUBLE},
+    {"u1", tensorflow::DataType::DT_UINT8},
+    {"i1", tensorflow::DataType::DT_INT8},
+    {"u2", tensorflow::DataType::DT_UINT16},
+    {"i2", tensorflow::DataType::DT_INT16},
+    {"u4", tensorflow::DataType::DT_UINT32},
+    {"i4", tensorflow::DataType::DT_INT32},
+    {"u8", tensorflow::DataType::DT_UINT64},
+    {"i8", tensorflow::DataType::DT_INT64},
+    {"b1", tensorflow::DataType::DT_BOOL},
+};
+
+/**
+ * @brief Finds value following 'key': in python dict literal of the header
+ */
+bool findHeaderValue(const std::string& header, const std::string& key, size_t& position) {
+    for (const char quote : {'\'', '"'}) {
+        const std::string quotedKey = quote + key + quote;
+        auto keyPosition = header.find(quotedKey);
+        if (keyPosition == std::string::npos) {
+            continue;
+        }
+        position = header.find(':', keyPosition + quotedKey.size());
+        if (position == std::string::npos) {
+            return false;
+        }
+        position = header.find_first_not_of(' ', position + 1);
+        return position != std::string::npos;
+    }
+    return false;
+}
+
+Status parseDescr(const std::string& header, tensorflow::DataType& dtype) {
+    size_t position;
+    if (!findHeaderValue(header, "descr", position) || (header[position] != '\'' && header[position] != '"')) {
+        return Status(StatusCode::FILE_INVALID, "npy header lacks descr");
+    }
+    auto end = header.find(header[position], position + 1);
+    if (end == std::string::npos || end - position < 3) {
+        return Status(StatusCode::FILE_INVALID, "npy header has invalid descr");
+    }
+    const std::string descr = header.substr(position + 1, end - position - 1);
+    const std::string type = descr.substr(1);
+    for (const auto& [name, candidate] : NPY_DTYPES) {
+        if (type != name) {
+            continue;
+        }
+        // byte order of single byte types is '|'
+        const bool singleByte = type.back() == '1';
+        if (descr[0] == '<' || (singleByte && descr[0] == '|') || descr[0] == '=') {
+            dtype = candidate;
+            return StatusCode::OK;
+        }
+    }
+    return Status(StatusCode::FILE_INVALID, "npy dtype: " + descr + " is not supported");
+}
+
+Status parseShape(const std::string& header, std::vector<int64_t>& shape) {
+    size_t position;
+    if (!findHeaderValue(header, "shape", position) || header[position] != '(') {
+        return Status(StatusCode::FILE_INVALID, "npy header lacks shape");
+    }
+    auto end = header.find(')', position);
+    if (end == std::string::npos) {
+        return Status(StatusCode::FILE_INVALID, "npy header has invalid shape");
+    }
+    std::stringstream dims(header.substr(position + 1, end - position - 1));
+    std::string dim;
+    while (std::getline(dims, dim, ',')) {
+        auto first = dim.find_first_not_of(' ');
+        if (first == std::string::npos) {
+            continue;
+        }
+        try {
+            size_t parsed = 0;
+            auto value = std::stoll(dim.substr(first), &parsed);
+            if (value < 0 || dim.find_first_not_of(' ', first + parsed) != std::string::npos) {
+                return Status(StatusCode::FILE_INVALID, "npy header has invalid shape");
+            }
+            shape.push_back(value);
+        } catch (const std::exception&) {
+            return Status(StatusCode::FILE_INVALID, "npy header has invalid shape");
+        }
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace
+
+Status parseNpy(const std::string& content, tensorflow::TensorProto& proto) {
+    if (content.size() < NPY_MAGIC_SIZE + 4 || content.compare(0, NPY_MAGIC_SIZE, NPY_MAGIC, NPY_MAGIC_SIZE) != 0) {
+        return Status(StatusCode::FILE_INVALID, "not a npy file");
+    }
+    const uint8_t majorVersion = static_cast<uint8_t>(content[NPY_MAGIC_SIZE]);
+    size_t headerStart = NPY_MAGIC_SIZE + 2;
+    size_t headerSize = 0;
+    auto byteAt = [&content](size_t index) { return static_cast<size_t>(static_cast<uint8_t>(content[index])); };
+    if (majorVersion == 1) {
+        headerSize = byteAt(headerStart) | byteAt(headerStart + 1) << 8;
+        headerStart += 2;
+    } else if (majorVersion == 2 || majorVersion == 3) {
+        if (content.size() < headerStart + 4) {
+            return Status(StatusCode::FILE_INVALID, "npy file is truncated");
+        }
+        headerSize = byteAt(headerStart) | byteAt(headerStart + 1) << 8 | byteAt(headerStart + 2) << 16 | byteAt(headerStart + 3) << 24;
+        headerStart += 4;
+    } else {
+        return Status(StatusCode::FILE_INVALID, "npy format version: " + std::to_string(majorVersion) + " is not supported");
+    }
+    if (content.size() < headerStart + headerSize) {
+        return Status(StatusCode::FILE_INVALID, "npy file is truncated");
+    }
+    const std::string header = content.substr(headerStart, headerSize);
+
+    size_t position;
+    if (findHeaderValue(header, "fortran_order", position) && header.compare(position, 4, "True") == 0) {
+        return Status(StatusCode::FILE_INVALID, "npy arrays in fortran order are not supported");
+    }
+    tensorflow::DataType dtype;
+    auto status = parseDescr(header, dtype);
+    if (!status.ok()) {
+        return status;
+    }
+    std::vector<int64_t> shape;
+    status = parseShape(header, shape);
+    if (!status.ok()) {
+        return status;
+    }
+
+    size_t valuesCount = 1;
+    for (auto dim : shape) {
+        valuesCount *= dim;
+    }
+    const size_t dataStart = headerStart + headerSize;
+    const size_t dataSize = valuesCount * tensorflow::DataTypeSize(dtype);
+    if (content.size() - dataStart != dataSize) {
+        return Status(StatusCode::FILE_INVALID, "npy data size: " + std::to_string(content.size() - dataStart) +
+                                                    " does not match shape, expected: " + std::to_string(dataSize));
+    }
+
+    proto.Clear();
+    proto.set_dtype(dtype);
+    for (auto dim : shape) {
+        proto.mutable_tensor_shape()->add_dim()->set_size(dim);
+    }
+    proto.mutable_tensor_content()->assign(content, dataStart, dataSize);
+    return StatusCode::OK;
+}
+
+Status loadNpyFile(const std::string& path, tensorflow::TensorProto& proto) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return Status(StatusCode::FILE_INVALID, path);
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    auto status = parseNpy(content.str(), proto);
+    if (!status.ok()) {
+        return Status(status.getCode(), path + ": " + status.string());
+    }
+    return StatusCode::OK;
+}
+
+Status serializeNpyHeader(tensorflow::DataType dtype, const tensorflow::TensorShapeProto& shape, std::string& content) {
+    const char* type = nullptr;
+    for (const auto& [name, candidate] : NPY_DTYPES) {
+        if (candidate == dtype) {
+            type = name;
+            break;
+        }
+    }
+    if (type == nullptr) {
+        return Status(StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION, "dtype: " + tensorflow::DataType_Name(dtype) + " cannot be stored in npy");
+    }
+    std::stringstream header;
+    header << "{'descr': '" << (type[1] == '1' ? '|' : '<') << type << "', 'fortran_order': False, 'shape': (";
+    for (int i = 0; i < shape.dim_size(); i++) {
+        header << shape.dim(i).size() << (shape.dim_size() == 1 || i + 1 < shape.dim_size() ? "," : "");
+        if (i + 1 < shape.dim_size()) {
+            header << " ";
+        }
+    }
+    header << "), }";
+    std::string headerText = header.str();
+    // data starts aligned to 64 bytes, header ends with new line
+    const size_t prefixSize = NPY_MAGIC_SIZE + 4;
+    headerText.append(63 - (prefixSize + headerText.size()) % 64, ' ');
+    headerText.push_back('\n');
+    content.assign(NPY_MAGIC, NPY_MAGIC_SIZE);
+    content.push_back('\x01');
+    content.push_back('\x00');
+    content.push_back(static_cast<char>(headerText.size() & 0xFF));
+    content.push_back(static_cast<char>((headerText.size() >> 8) & 0xFF));
+    content.append(headerText);
+    return StatusCode::OK;
+}
+
+Status serializeNpy(const tensorflow::TensorProto& proto, std::string& content) {
+    size_t valuesCount = 1;
+    for (int i = 0; i < proto.tensor_shape().dim_size(); i++) {
+        valuesCount *= proto.tensor_shape().dim(i).size();
+    }
+    if (proto.tensor_content().size() != valuesCount * tensorflow::DataTypeSize(proto.dtype())) {
+        return Status(StatusCode::INVALID_CONTENT_SIZE, "tensor_content size does not match shape");
+    }
+    auto status = serializeNpyHeader(proto.dtype(), proto.tensor_shape(), content);
+    if (!status.ok()) {
+        return status;
+    }
+    content.append(proto.tensor_content());
+    return StatusCode::OK;
+}
+
+Status sliceBatch(const tensorflow::TensorProto& source, size_t first, size_t batchSize, tensorflow::TensorProto& batch) {
+    if (source.tensor_shape().dim_size() < 1 || source.tensor_shape().dim(0).size() <= 0 || batchSize == 0) {
+        return Status(StatusCode::INVALID_BATCH_SIZE, "cannot slice tensor without entries along 0th dimension");
+    }
+    const size_t entries = source.tensor_shape().dim(0).size();
+    const size_t entrySize = source.tensor_content().size() / entries;
+    batch.Clear();
+    batch.set_dtype(source.dtype());
+    *batch.mutable_tensor_shape() = source.tensor_shape();
+    batch.mutable_tensor_shape()->mutable_dim(0)->set_size(batchSize);
+    auto& content = *batch.mutable_tensor_content();
+    content.reserve(batchSize * entrySize);
+    for (size_t i = 0; i < batchSize; i++) {
+        content.append(source.tensor_content(), ((first + i) % entries) * entrySize, entrySize);
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
@@ -0,0 +1,79 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <string>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow/core/framework/tensor.h"
+#pragma GCC diagnostic pop
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Parses numpy .npy file content into tensor proto with values in tensor_content
+ *
+ * Supported are format versions 1 to 3 with little endian or single byte numeric and bool dtypes in C order.
+ *
+ * @param content whole file content
+ * @param proto filled with dtype, shape and values
+ *
+ * @return Status
+ */
+Status parseNpy(const std::string& content, tensorflow::TensorProto& proto);
+
+/**
+ * @brief Reads and parses .npy file
+ */
+Status loadNpyFile(const std::string& path, tensorflow::TensorProto& proto);
+
+/**
+ * @brief Serializes numpy .npy format version 1 header, values of the shape in C order can be appended to it
+ *
+ * @param dtype one of the dtypes supported by parseNpy
+ * @param shape
+ * @param content replaced with the header
+ *
+ * @return Status
+ */
+Status serializeNpyHeader(tensorflow::DataType dtype, const tensorflow::TensorShapeProto& shape, std::string& content);
+
+/**
+ * @brief Serializes tensor proto with values in tensor_content into numpy .npy format version 1
+ *
+ * @param proto tensor of one of the dtypes supported by parseNpy
+ * @param content whole file content
+ *
+ * @return Status
+ */
+Status serializeNpy(const tensorflow::TensorProto& proto, std::string& content);
+
+/**
+ * @brief Copies batchSize consecutive entries along 0th dimension of source, wrapping around its end
+ *
+ * @param source tensor with at least one dimension
+ * @param first index of the first copied entry
+ * @param batchSize number of copied entries, has to be positive
+ * @param batch filled with the copied entries
+ *
+ * @return Status
+ */
+Status sliceBatch(const tensorflow::TensorProto& source, size_t first, size_t batchSize, tensorflow::TensorProto& batch);
+
+}  // namespace ovms
@@ -0,0 +1,190 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "numa.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+
+#include "stringutils.hpp"
+
+namespace ovms {
+
+static const char* NUMA_NODES_SYSFS_PATH = "/sys/devices/system/node";
+
+bool parseCpuList(const std::string& cpuList, cpu_list_t& cpus) {
+    cpus.clear();
+    std::string trimmed = cpuList;
+    trim(trimmed);
+    if (trimmed.empty()) {
+        return true;
+    }
+    for (const auto& range : tokenize(trimmed, ',')) {
+        auto bounds = tokenize(range, '-');
+        if (bounds.size() < 1 || bounds.size() > 2) {
+            return false;
+        }
+        int first, last;
+        try {
+            first = std::stoi(bounds[0]);
+            last = bounds.size() == 2 ? std::stoi(bounds[1]) : first;
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (first < 0 || last < first) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return true;
+}
+
+std::string formatCpuList(const cpu_list_t& cpus) {
+    std::string cpuList;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        size_t last = i;
+        while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) {
+            last++;
+        }
+        if (!cpuList.empty()) {
+            cpuList += ',';
+        }
+        cpuList += std::to_string(cpus[i]);
+        if (last > i) {
+            cpuList += '-' + std::to_string(cpus[last]);
+        }
+        i = last;
+    }
+    return cpuList;
+}
+
+std::vector<cpu_list_t> splitCpuList(const cpu_list_t& cpus, size_t groupsCount) {
+    std::vector<cpu_list_t> groups;
+    groupsCount = std::min(groupsCount, cpus.size());
+    auto begin = cpus.begin();
+    for (size_t i = 0; i < groupsCount; i++) {
+        const size_t groupSize = cpus.size() / groupsCount + (i < cpus.size() % groupsCount ? 1 : 0);
+        groups.emplace_back(begin, begin + groupSize);
+        begin += groupSize;
+    }
+    return groups;
+}
+
+std::map<int, cpu_list_t> getNumaNodesCpus() {
+    std::map<int, cpu_list_t> nodes;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(NUMA_NODES_SYSFS_PATH, ec)) {
+        const std::string dirName = entry.path().filename().string();
+        if (dirName.rfind("node", 0) != 0) {
+            continue;
+        }
+        int nodeId;
+        try {
+            nodeId = std::stoi(dirName.substr(4));
+        } catch (const std::exception&) {
+            continue;
+        }
+        std::ifstream cpuListFile(entry.path() / "cpulist");
+        std::string cpuList;
+        if (!std::getline(cpuListFile, cpuList)) {
+            continue;
+        }
+        cpu_list_t cpus;
+        if (!parseCpuList(cpuList, cpus)) {
+            SPDLOG_WARN("Could not parse cpu list: {} of NUMA node: {}", cpuList, nodeId);
+            continue;
+        }
+        if (!cpus.empty()) {
+            nodes[nodeId] = std::move(cpus);
+        }
+    }
+    return nodes;
+}
+
+int getCurrentNumaNode() {
+    static const std::vector<int> cpuToNode = []() {
+        std::vector<int> mapping;
+        for (const auto& [nodeId, cpus] : getNumaNodesCpus()) {
+            for (int cpu : cpus) {
+                if (cpu >= static_cast<int>(mapping.size())) {
+                    mapping.resize(cpu + 1, -1);
+                }
+                mapping[cpu] = nodeId;
+            }
+        }
+        return mapping;
+    }();
+    int cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= static_cast<int>(cpuToNode.size())) {
+        return -1;
+    }
+    return cpuToNode[cpu];
+}
+
+cpu_list_t getAllowedCpus() {
+    cpu_list_t cpus;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuSet) != 0) {
+        return cpus;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &cpuSet)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+bool pinCurrentThread(const cpu_list_t& cpus) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &cpuSet);
+    }
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+    if (result != 0) {
+        SPDLOG_WARN("Could not set thread affinity, error: {}", result);
+        return false;
+    }
+    return true;
+}
+
+void runPinnedToCpus(const cpu_list_t& cpus, const std::function<void()>& function) {
+    std::exception_ptr exception;
+    std::thread pinnedThread([&cpus, &function, &exception]() {
+        pinCurrentThread(cpus);
+        try {
+            function();
+        } catch (...) {
+            exception = std::current_exception();
+        }
+    });
+    pinnedThread.join();
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+}  // namespace ovms
@@ -0,0 +1,95 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ovms {
+
+using cpu_list_t = std::vector<int>;
+
+/**
+ * @brief Parses cpu list in sysfs format, e.g. "0-3,8,10-11"
+ *
+ * @param cpuList
+ * @param cpus parsed cpu ids
+ *
+ * @return false if cpu list is malformed
+ */
+bool parseCpuList(const std::string& cpuList, cpu_list_t& cpus);
+
+/**
+ * @brief Formats cpu list in sysfs format, consecutive cpus are joined into ranges
+ *
+ * @param cpus
+ *
+ * @return cpu list, e.g. "0-3,8,10-11"
+ */
+std::string formatCpuList(const cpu_list_t& cpus);
+
+/**
+ * @brief Splits cpus into consecutive groups of nearly equal size, earlier groups get the remainder
+ *
+ * @param cpus
+ * @param groupsCount limited to the number of cpus
+ *
+ * @return non empty groups
+ */
+std::vector<cpu_list_t> splitCpuList(const cpu_list_t& cpus, size_t groupsCount);
+
+/**
+ * @brief Reads NUMA topology of the host. Nodes without cpus are skipped.
+ *
+ * @return cpus of each NUMA node, empty if topology is not available
+ */
+std::map<int, cpu_list_t> getNumaNodesCpus();
+
+/**
+ * @brief Gets NUMA node of the cpu calling thread is currently running on
+ *
+ * @return NUMA node id or -1 if it cannot be determined
+ */
+int getCurrentNumaNode();
+
+/**
+ * @brief Gets cpus the process is allowed to run on
+ *
+ * @return cpu ids in ascending order, empty if affinity cannot be read
+ */
+cpu_list_t getAllowedCpus();
+
+/**
+ * @brief Pins calling thread to cpus
+ *
+ * @param cpus
+ *
+ * @return false if affinity could not be set
+ */
+bool pinCurrentThread(const cpu_list_t& cpus);
+
+/**
+ * @brief Executes function in a new thread pinned to cpus and waits for it to finish.
+ * Threads created by the function inherit the affinity. Exceptions are rethrown in calling thread.
+ *
+ * @param cpus
+ * @param function
+ */
+void runPinnedToCpus(const cpu_list_t& cpus, const std::function<void()>& function);
+
+}  // namespace ovms
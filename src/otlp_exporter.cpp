@@ -0,0 +1,68 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "otlp_exporter.hpp"
+
+#include <chrono>
+#include <exception>
+
+#include <spdlog/spdlog.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#pragma GCC diagnostic ignored "-Wreorder"
+#pragma GCC diagnostic ignored "-Wunused-value"
+#include <cpprest/http_client.h>
+#pragma GCC diagnostic pop
+
+namespace ovms {
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+OtlpHttpExporter::OtlpHttpExporter(const std::string& endpoint) {
+    std::string base = endpoint;
+    path = TRACES_PATH;
+    if (endsWith(base, TRACES_PATH)) {
+        base.resize(base.size() - path.size());
+    }
+    while (!base.empty() && base.back() == '/') {
+        base.pop_back();
+    }
+    web::http::client::http_client_config config;
+    config.set_timeout(std::chrono::seconds(EXPORT_TIMEOUT_SECONDS));
+    client = std::make_shared<web::http::client::http_client>(utility::conversions::to_string_t(base), config);
+}
+
+bool OtlpHttpExporter::operator()(const std::string& body) const {
+    try {
+        web::http::http_request request(web::http::methods::POST);
+        request.set_request_uri(utility::conversions::to_string_t(path));
+        request.set_body(body, "application/json");
+        auto response = client->request(request).get();
+        if (response.status_code() / 100 != 2) {
+            SPDLOG_DEBUG("Trace collector rejected spans with HTTP status: {}", response.status_code());
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        SPDLOG_DEBUG("Exporting spans to trace collector failed: {}", e.what());
+        return false;
+    }
+}
+
+}  // namespace ovms
@@ -0,0 +1,56 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace web {
+namespace http {
+namespace client {
+class http_client;
+}  // namespace client
+}  // namespace http
+}  // namespace web
+
+namespace ovms {
+
+/**
+ * @brief Posts OTLP/HTTP JSON trace export requests to the collector, used as exporter of Tracer
+ */
+class OtlpHttpExporter {
+public:
+    static constexpr const char* TRACES_PATH = "/v1/traces";
+    static constexpr int EXPORT_TIMEOUT_SECONDS = 10;
+
+    /**
+     * @param endpoint collector address, e.g. http://collector:4318, TRACES_PATH is appended unless endpoint already ends with it
+     */
+    OtlpHttpExporter(const std::string& endpoint);
+
+    /**
+     * @brief Sends the request synchronously, called from tracer export thread
+     *
+     * @return false when collector could not be reached or rejected the request
+     */
+    bool operator()(const std::string& body) const;
+
+private:
+    std::shared_ptr<web::http::client::http_client> client;
+    std::string path;
+};
+
+}  // namespace ovms
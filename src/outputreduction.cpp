@@ -0,0 +1,270 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "outputreduction.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OVMS_X86_REDUCTION
+#endif
+
+namespace ovms {
+
+namespace {
+/**
+ * @brief Keeps k highest values offered so far sorted in descending order
+ */
+class TopKSelection {
+public:
+    TopKSelection(size_t k, float threshold, float* values, int64_t* indices) :
+        k(k),
+        threshold(threshold),
+        values(values),
+        indices(indices) {}
+
+    /**
+     * @brief Values not greater than minimum are not selected
+     */
+    float getMinimum() const {
+        return count < k ? threshold : values[k - 1];
+    }
+
+    void offer(float value, int64_t index) {
+        if (!(value > getMinimum())) {
+            return;
+        }
+        size_t position = count < k ? count++ : k - 1;
+        for (; position > 0 && value > values[position - 1]; --position) {
+            values[position] = values[position - 1];
+            indices[position] = indices[position - 1];
+        }
+        values[position] = value;
+        indices[position] = index;
+    }
+
+    size_t finish() {
+        for (size_t i = count; i < k; ++i) {
+            values[i] = 0;
+            indices[i] = -1;
+        }
+        return count;
+    }
+
+private:
+    const size_t k;
+    const float threshold;
+    float* values;
+    int64_t* indices;
+    size_t count = 0;
+};
+
+int64_t findFirstEqualScalar(const float* values, size_t begin, size_t count, float value) {
+    for (size_t i = begin; i < count; ++i) {
+        if (values[i] == value) {
+            return i;
+        }
+    }
+    return -1;
+}
+}  // namespace
+
+bool parseOutputReductionType(const std::string& name, OutputReductionType& type) {
+    if (name == "argmax") {
+        type = OutputReductionType::ARGMAX;
+    } else if (name == "top_k") {
+        type = OutputReductionType::TOP_K;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int64_t argmaxFp32Scalar(const float* values, size_t count, float threshold) {
+    int64_t index = -1;
+    float maximum = threshold;
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] > maximum) {
+            maximum = values[i];
+            index = i;
+        }
+    }
+    return index;
+}
+
+size_t topKFp32Scalar(const float* values, size_t count, size_t k, float threshold, float* topValues, int64_t* topIndices) {
+    if (k == 0) {
+        return 0;
+    }
+    TopKSelection selection(k, threshold, topValues, topIndices);
+    for (size_t i = 0; i < count; ++i) {
+        selection.offer(values[i], i);
+    }
+    return selection.finish();
+}
+
+#ifdef OVMS_X86_REDUCTION
+namespace {
+// maximum is the second operand, so lanes of NaN values keep the previous maximum
+__attribute__((target("avx2"))) int64_t argmaxFp32Avx2(const float* values, size_t count, float threshold) {
+    __m256 maximumLanes = _mm256_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        maximumLanes = _mm256_max_ps(_mm256_loadu_ps(values + i), maximumLanes);
+    }
+    __m128 maximumHalf = _mm_max_ps(_mm256_castps256_ps128(maximumLanes), _mm256_extractf128_ps(maximumLanes, 1));
+    maximumHalf = _mm_max_ps(maximumHalf, _mm_movehl_ps(maximumHalf, maximumHalf));
+    maximumHalf = _mm_max_ss(maximumHalf, _mm_shuffle_ps(maximumHalf, maximumHalf, 1));
+    float maximum = _mm_cvtss_f32(maximumHalf);
+    for (; i < count; ++i) {
+        if (values[i] > maximum) {
+            maximum = values[i];
+        }
+    }
+    if (!(maximum > threshold)) {
+        return -1;
+    }
+    const __m256 searched = _mm256_set1_ps(maximum);
+    for (i = 0; i + 8 <= count; i += 8) {
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + i), searched, _CMP_EQ_OQ));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return findFirstEqualScalar(values, i, count, maximum);
+}
+
+__attribute__((target("avx512f"))) int64_t argmaxFp32Avx512(const float* values, size_t count, float threshold) {
+    __m512 maximumLanes = _mm512_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // unmasked forms merge into undefined vectors which warn as uninitialized, so all lanes are selected by zero mask
+        maximumLanes = _mm512_maskz_max_ps(0xFFFF, _mm512_loadu_ps(values + i), maximumLanes);
+    }
+    // lanes are reduced through memory, _mm512_reduce_max_ps would merge into undefined vectors as well
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, maximumLanes);
+    float maximum = threshold;
+    for (float lane : lanes) {
+        if (lane > maximum) {
+            maximum = lane;
+        }
+    }
+    for (; i < count; ++i) {
+        if (values[i] > maximum) {
+            maximum = values[i];
+        }
+    }
+    if (!(maximum > threshold)) {
+        return -1;
+    }
+    const __m512 searched = _mm512_set1_ps(maximum);
+    for (i = 0; i + 16 <= count; i += 16) {
+        const __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(values + i), searched, _CMP_EQ_OQ);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return findFirstEqualScalar(values, i, count, maximum);
+}
+
+// blocks are compared against the current minimum of selection, so only candidates are inserted one by one
+__attribute__((target("avx2"))) size_t topKFp32Avx2(const float* values, size_t count, size_t k, float threshold, float* topValues, int64_t* topIndices) {
+    TopKSelection selection(k, threshold, topValues, topIndices);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + i), _mm256_set1_ps(selection.getMinimum()), _CMP_GT_OQ));
+        for (; mask; mask &= mask - 1) {
+            const size_t index = i + __builtin_ctz(mask);
+            selection.offer(values[index], index);
+        }
+    }
+    for (; i < count; ++i) {
+        selection.offer(values[i], i);
+    }
+    return selection.finish();
+}
+
+__attribute__((target("avx512f"))) size_t topKFp32Avx512(const float* values, size_t count, size_t k, float threshold, float* topValues, int64_t* topIndices) {
+    TopKSelection selection(k, threshold, topValues, topIndices);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        unsigned mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(values + i), _mm512_set1_ps(selection.getMinimum()), _CMP_GT_OQ);
+        for (; mask; mask &= mask - 1) {
+            const size_t index = i + __builtin_ctz(mask);
+            selection.offer(values[index], index);
+        }
+    }
+    for (; i < count; ++i) {
+        selection.offer(values[i], i);
+    }
+    return selection.finish();
+}
+
+enum class VectorExtension {
+    NONE,
+    AVX2,
+    AVX512,
+};
+
+VectorExtension getWidestVectorExtension() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return VectorExtension::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return VectorExtension::AVX2;
+    }
+    return VectorExtension::NONE;
+}
+
+const VectorExtension& widestVectorExtension() {
+    static const VectorExtension extension = getWidestVectorExtension();
+    return extension;
+}
+}  // namespace
+#endif
+
+int64_t argmaxFp32(const float* values, size_t count, float threshold) {
+#ifdef OVMS_X86_REDUCTION
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return argmaxFp32Avx512(values, count, threshold);
+    case VectorExtension::AVX2:
+        return argmaxFp32Avx2(values, count, threshold);
+    default:
+        break;
+    }
+#endif
+    return argmaxFp32Scalar(values, count, threshold);
+}
+
+size_t topKFp32(const float* values, size_t count, size_t k, float threshold, float* topValues, int64_t* topIndices) {
+    if (k == 0) {
+        return 0;
+    }
+#ifdef OVMS_X86_REDUCTION
+    switch (widestVectorExtension()) {
+    case VectorExtension::AVX512:
+        return topKFp32Avx512(values, count, k, threshold, topValues, topIndices);
+    case VectorExtension::AVX2:
+        return topKFp32Avx2(values, count, k, threshold, topValues, topIndices);
+    default:
+        break;
+    }
+#endif
+    return topKFp32Scalar(values, count, k, threshold, topValues, topIndices);
+}
+
+}  // namespace ovms
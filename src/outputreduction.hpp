@@ -0,0 +1,90 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+namespace ovms {
+
+enum class OutputReductionType {
+    NONE,
+    ARGMAX,
+    TOP_K,
+};
+
+/**
+ * @brief Reduction of model output along its last dimension applied before the output is sent in predict response
+ */
+struct OutputReduction {
+    OutputReductionType type = OutputReductionType::NONE;
+    /**
+     * @brief Number of the highest values kept by TOP_K
+     */
+    size_t k = 1;
+    /**
+     * @brief Only values greater than threshold are selected
+     */
+    float threshold = -std::numeric_limits<float>::infinity();
+
+    bool operator==(const OutputReduction& rhs) const {
+        return type == rhs.type && k == rhs.k && threshold == rhs.threshold;
+    }
+    bool operator!=(const OutputReduction& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * @brief Map of network output names to their reductions
+ */
+using output_reductions_map_t = std::unordered_map<std::string, OutputReduction>;
+
+/**
+ * @brief Parses reduction type name used in model config
+ *
+ * @return false when name is not argmax or top_k
+ */
+bool parseOutputReductionType(const std::string& name, OutputReductionType& type);
+
+/**
+ * @brief Finds the first index of the highest value. NaN values are skipped.
+ * Uses the widest vector instructions supported by the CPU, detected once on first use.
+ *
+ * @return index of the highest value or -1 if no value is greater than threshold
+ */
+int64_t argmaxFp32(const float* values, size_t count, float threshold);
+
+/**
+ * @brief Selects k highest values in descending order, equal values are ordered by index. NaN values are skipped.
+ *
+ * @param topValues buffer for k values, positions not selected are set to 0
+ * @param topIndices buffer for k indices, positions not selected are set to -1
+ *
+ * @return number of values greater than threshold selected, at most k
+ */
+size_t topKFp32(const float* values, size_t count, size_t k, float threshold, float* topValues, int64_t* topIndices);
+
+/**
+ * @brief Scalar versions of the reductions
+ */
+int64_t argmaxFp32Scalar(const float* values, size_t count, float threshold);
+size_t topKFp32Scalar(const float* values, size_t count, size_t k, float threshold, float* topValues, int64_t* topIndices);
+
+}  // namespace ovms
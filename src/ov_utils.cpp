@@ -16,37 +16,79 @@
 
 #include "ov_utils.hpp"
 
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <numeric>
+#include <string>
 
 #include <spdlog/spdlog.h>
 
 namespace ovms {
 
+namespace {
+// Blob does not own its memory, the string is kept by deleter of the shared pointer and found with std::get_deleter
+struct StringBlobDeleter {
+    std::shared_ptr<std::string> storage;
+
+    void operator()(InferenceEngine::Blob* blob) const {
+        delete blob;
+    }
+};
+
+template <typename T>
+InferenceEngine::Blob::Ptr makeStringBlob(const InferenceEngine::TensorDesc& tensorDesc) {
+    const auto& dims = tensorDesc.getDims();
+    const size_t size = std::accumulate(dims.begin(), dims.end(), size_t(1), std::multiplies<size_t>());
+    auto storage = std::make_shared<std::string>(size * sizeof(T), '\0');
+    auto data = reinterpret_cast<T*>(&(*storage)[0]);
+    return InferenceEngine::Blob::Ptr(new InferenceEngine::TBlob<T>(tensorDesc, data, size), StringBlobDeleter{std::move(storage)});
+}
+}  // namespace
+
+InferenceEngine::Blob::Ptr allocateStringBlob(const InferenceEngine::TensorDesc& tensorDesc) {
+    switch (tensorDesc.getPrecision()) {
+    case InferenceEngine::Precision::FP32:
+        return makeStringBlob<float>(tensorDesc);
+    case InferenceEngine::Precision::FP16:
+    case InferenceEngine::Precision::BF16:
+    case InferenceEngine::Precision::U16:
+        return makeStringBlob<uint16_t>(tensorDesc);
+    case InferenceEngine::Precision::U8:
+    case InferenceEngine::Precision::BOOL:
+        return makeStringBlob<uint8_t>(tensorDesc);
+    case InferenceEngine::Precision::I8:
+        return makeStringBlob<int8_t>(tensorDesc);
+    case InferenceEngine::Precision::I16:
+        return makeStringBlob<int16_t>(tensorDesc);
+    case InferenceEngine::Precision::I32:
+        return makeStringBlob<int32_t>(tensorDesc);
+    case InferenceEngine::Precision::I64:
+        return makeStringBlob<int64_t>(tensorDesc);
+    default:
+        return nullptr;
+    }
+}
+
+bool takeStringBlobStorage(InferenceEngine::Blob::Ptr& blob, std::string& storage) {
+    auto deleter = std::get_deleter<StringBlobDeleter>(blob);
+    if (deleter == nullptr || blob.use_count() != 1) {
+        return false;
+    }
+    storage.swap(*deleter->storage);
+    blob.reset();
+    return true;
+}
+
 Status blobClone(InferenceEngine::Blob::Ptr& destinationBlob, const InferenceEngine::Blob::Ptr sourceBlob) {
     auto& description = sourceBlob->getTensorDesc();
 
     try {
-        switch (description.getPrecision()) {
-        case InferenceEngine::Precision::FP32:
-            destinationBlob = InferenceEngine::make_shared_blob<float>(description);
-            break;
-        case InferenceEngine::Precision::U8:
-            destinationBlob = InferenceEngine::make_shared_blob<uint8_t>(description);
-            break;
-        case InferenceEngine::Precision::I8:
-            destinationBlob = InferenceEngine::make_shared_blob<int8_t>(description);
-            break;
-        case InferenceEngine::Precision::I16:
-            destinationBlob = InferenceEngine::make_shared_blob<int16_t>(description);
-            break;
-        case InferenceEngine::Precision::I32:
-            destinationBlob = InferenceEngine::make_shared_blob<int32_t>(description);
-            break;
-        default: {
+        destinationBlob = allocateStringBlob(description);
+        if (!destinationBlob) {
             SPDLOG_ERROR("Blob clone failed, unsupported precision");
             return StatusCode::INVALID_PRECISION;
         }
-        }
     } catch (const InferenceEngine::details::InferenceEngineException& e) {
         SPDLOG_DEBUG("Blob clone failed; exception message: {}", e.what());
         return StatusCode::OV_CLONE_BLOB_ERROR;
@@ -55,7 +97,6 @@ Status blobClone(InferenceEngine::Blob::Ptr& destinationBlob, const InferenceEng
         return StatusCode::OV_CLONE_BLOB_ERROR;
     }
 
-    destinationBlob->allocate();
     if (destinationBlob->byteSize() != sourceBlob->byteSize()) {
         destinationBlob = nullptr;
         return StatusCode::OV_CLONE_BLOB_ERROR;
@@ -15,12 +15,31 @@
 //*****************************************************************************
 #pragma once
 
+#include <string>
+
 #include <inference_engine.hpp>
 
 #include "status.hpp"
 
 namespace ovms {
 
+/**
+ * @brief Copies blob into one allocated with allocateStringBlob
+ */
 Status blobClone(InferenceEngine::Blob::Ptr& destinationBlob, const InferenceEngine::Blob::Ptr sourceBlob);
 
+/**
+ * @brief Allocates blob keeping its memory in std::string, so that it can become tensor_content of the response without copying
+ *
+ * @return blob or nullptr if precision is not supported
+ */
+InferenceEngine::Blob::Ptr allocateStringBlob(const InferenceEngine::TensorDesc& tensorDesc);
+
+/**
+ * @brief Swaps memory of blob allocated with allocateStringBlob into storage and drops the blob
+ *
+ * @return false when blob has different memory or is still referenced elsewhere, blob is left untouched then
+ */
+bool takeStringBlobStorage(InferenceEngine::Blob::Ptr& blob, std::string& storage);
+
 }  // namespace ovms
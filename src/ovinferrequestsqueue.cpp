@@ -13,46 +13,414 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
-
 #include "ovinferrequestsqueue.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
 #include <utility>
+#include <vector>
+
+#include "deserialization.hpp"
 
 namespace ovms {
+
+static int64_t nowMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+OVInferRequestsQueue::OVInferRequestsQueue(InferenceEngine::ExecutableNetwork& network, int streamsLength, int maxStreamsLength) :
+    front_idx{0},
+    back_idx{0},
+    network(network) {
+    const int streams = std::max(streamsLength, 1);
+    capacity = static_cast<std::size_t>(std::max(maxStreamsLength, streams));
+    const std::size_t ringCapacity = roundUpToPowerOfTwo(capacity);
+    cells = std::make_unique<Cell[]>(ringCapacity);
+    mask = ringCapacity - 1;
+    for (std::size_t i = 0; i < ringCapacity; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    streamAcquireTimes = std::make_unique<std::atomic<int64_t>[]>(capacity);
+    // infer requests are not moved by resizing, so they can be used while other streams are created or retired
+    inferRequests = std::make_unique<InferenceEngine::InferRequest[]>(capacity);
+    preallocatedInputBlobs.resize(capacity);
+    chunkInputBlobs.resize(capacity);
+    liveStreams.resize(capacity, false);
+    for (int i = 0; i < streamsLength; ++i) {
+        createInferRequest(i);
+        push(i);
+    }
+    activeStreams.store(streamsLength, std::memory_order_relaxed);
+    // each infer request can have its outputs taken at the same time
+    outputBlobPool = std::make_shared<BlobPool>(capacity);
+    try {
+        remoteContext = network.GetContext();
+    } catch (...) {
+        // plugin keeps no device memory visible to the application
+    }
+    if (remoteContext) {
+        deviceOutputBlobPool = std::make_shared<BlobPool>(capacity, remoteContext);
+    }
+}
+
+OVInferRequestsQueue::~OVInferRequestsQueue() {
+    std::vector<DeadlineTimer::timer_id_t> timers;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        for (const auto& [order, waiter] : idleStreamCallbacks) {
+            timers.push_back(waiter.timer);
+        }
+    }
+    // waits for expiration running meanwhile
+    for (auto timer : timers) {
+        DeadlineTimer::instance().cancel(timer);
+    }
+}
+
+void OVInferRequestsQueue::createInferRequest(int streamID) {
+    inferRequests[streamID] = network.CreateInferRequest();
+    for (const auto& [name, tensorDesc] : preallocatedInputDescs) {
+        // only 16 bit precisions, converted and transposed requests are written element by element
+        auto blob = allocateConvertedBlob(tensorDesc);
+        if (!blob) {
+            break;
+        }
+        inferRequests[streamID].SetBlob(name, blob);
+        preallocatedInputBlobs[streamID][name] = blob;
+    }
+    for (const auto& [name, tensorDesc] : preallocatedOutputDescs) {
+        auto blob = allocateConvertedBlob(tensorDesc);
+        if (!blob) {
+            break;
+        }
+        try {
+            inferRequests[streamID].SetBlob(name, blob);
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            // plugin keeps its own output memory
+            SPDLOG_DEBUG("Cannot set preallocated output blob: {}; exception message: {}", name, e.what());
+            break;
+        }
+    }
+    liveStreams[streamID] = true;
+    liveStreamsCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OVInferRequestsQueue::preallocateInputBlob(const std::string& name, const InferenceEngine::TensorDesc& tensorDesc) {
+    std::lock_guard<std::mutex> lock(resizeMutex);
+    preallocatedInputDescs.emplace_back(name, tensorDesc);
+    for (size_t i = 0; i < capacity; ++i) {
+        if (!liveStreams[i]) {
+            continue;
+        }
+        // only 16 bit precisions, converted and transposed requests are written element by element
+        auto blob = allocateConvertedBlob(tensorDesc);
+        if (!blob) {
+            return;
+        }
+        inferRequests[i].SetBlob(name, blob);
+        preallocatedInputBlobs[i][name] = blob;
+    }
+}
+
+void OVInferRequestsQueue::preallocateOutputBlob(const std::string& name, const InferenceEngine::TensorDesc& tensorDesc) {
+    std::lock_guard<std::mutex> lock(resizeMutex);
+    preallocatedOutputDescs.emplace_back(name, tensorDesc);
+    for (size_t i = 0; i < capacity; ++i) {
+        if (!liveStreams[i]) {
+            continue;
+        }
+        auto blob = allocateConvertedBlob(tensorDesc);
+        if (!blob) {
+            return;
+        }
+        try {
+            inferRequests[i].SetBlob(name, blob);
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            // plugin keeps its own output memory
+            SPDLOG_DEBUG("Cannot set preallocated output blob: {}; exception message: {}", name, e.what());
+            preallocatedOutputDescs.pop_back();
+            return;
+        }
+    }
+}
+
+bool OVInferRequestsQueue::resize(size_t streamsLength) {
+    if (streamsLength == 0 || streamsLength > capacity) {
+        return false;
+    }
+    std::vector<int> created;
+    size_t previousStreams;
+    {
+        std::lock_guard<std::mutex> lock(resizeMutex);
+        previousStreams = activeStreams.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < streamsLength; ++i) {
+            // streams above previous limit which are not retired yet are in use again as they are
+            if (liveStreams[i]) {
+                continue;
+            }
+            try {
+                createInferRequest(i);
+            } catch (const std::exception& e) {
+                SPDLOG_WARN("Cannot create infer request, queue grows to {} streams only; exception message: {}", i, e.what());
+                streamsLength = i;
+                break;
+            }
+            created.push_back(i);
+        }
+        if (streamsLength == 0) {
+            return false;
+        }
+        activeStreams.store(streamsLength, std::memory_order_seq_cst);
+    }
+    for (int streamID : created) {
+        releaseStream(streamID);
+    }
+    if (streamsLength < previousStreams) {
+        // idle streams above the limit are retired by pop, the rest is put back
+        std::vector<int> idle;
+        int streamID;
+        while (idle.size() < capacity && pop(streamID)) {
+            idle.push_back(streamID);
+        }
+        for (int id : idle) {
+            releaseStream(id);
+        }
+    }
+    SPDLOG_DEBUG("Infer requests queue resized from {} to {} streams", previousStreams, streamsLength);
+    return true;
+}
+
+bool OVInferRequestsQueue::retireStream(int streamID) {
+    std::lock_guard<std::mutex> lock(resizeMutex);
+    if (static_cast<size_t>(streamID) < activeStreams.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    // stream is neither in the ring nor held by anyone, its infer request is not used concurrently
+    inferRequests[streamID] = InferenceEngine::InferRequest();
+    preallocatedInputBlobs[streamID].clear();
+    chunkInputBlobs[streamID].clear();
+    liveStreams[streamID] = false;
+    liveStreamsCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool OVInferRequestsQueue::push(int streamID) {
+    Cell* cell;
+    std::size_t position = back_idx.load(std::memory_order_relaxed);
+    while (true) {
+        cell = &cells[position & mask];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+        if (difference == 0) {
+            if (back_idx.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // ring is never full since there are never more stream ids than cells,
+            // cell is still being released by pop which took it one lap earlier, wait for it
+            std::this_thread::yield();
+            position = back_idx.load(std::memory_order_relaxed);
+        } else {
+            position = back_idx.load(std::memory_order_relaxed);
+        }
+    }
+    cell->streamId = streamID;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool OVInferRequestsQueue::pop(int& streamID) {
+    while (popRing(streamID)) {
+        if (static_cast<size_t>(streamID) >= activeStreams.load(std::memory_order_seq_cst) && retireStream(streamID)) {
+            continue;
+        }
+        // every stream handed out is taken from the ring
+        streamAcquireTimes[streamID].store(nowMicroseconds(), std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool OVInferRequestsQueue::popRing(int& streamID) {
+    Cell* cell;
+    std::size_t position = front_idx.load(std::memory_order_relaxed);
+    while (true) {
+        cell = &cells[position & mask];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+        if (difference == 0) {
+            if (front_idx.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // ring is empty
+            return false;
+        } else {
+            position = front_idx.load(std::memory_order_relaxed);
+        }
+    }
+    streamID = cell->streamId;
+    cell->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+}
+
+std::optional<int> OVInferRequestsQueue::tryGetIdleStream() {
+    int streamID;
+    if (!pop(streamID)) {
+        return std::nullopt;
+    }
+    if (schedulerClient && !schedulerClient->getScheduler().tryAcquire(*schedulerClient)) {
+        releaseStream(streamID);
+        return std::nullopt;
+    }
+    return streamID;
+}
+
 std::future<int> OVInferRequestsQueue::getIdleStream() {
-    int value;
-    std::promise<int> idleStreamPromise;
-    std::future<int> idleStreamFuture = idleStreamPromise.get_future();
-    std::unique_lock<std::mutex> lk(front_mut);
-    if (streams[front_idx] < 0) {  // we need to wait for any idle stream to be returned
-        std::unique_lock<std::mutex> queueLock(queue_mutex);
-        promises.push(std::move(idleStreamPromise));
-    } else {  // we can give idle stream right away
-        value = streams[front_idx];
-        streams[front_idx] = -1;  // negative value indicate consumed vector index
-        front_idx = (front_idx + 1) % streams.size();
-        lk.unlock();
-        idleStreamPromise.set_value(value);
-    }
-    return std::move(idleStreamFuture);
+    int streamID;
+    if (!schedulerClient && pop(streamID)) {  // we can give idle stream right away
+        std::promise<int> idleStreamPromise;
+        idleStreamPromise.set_value(streamID);
+        return idleStreamPromise.get_future();
+    }
+    auto idleStreamPromise = std::make_shared<std::promise<int>>();
+    std::future<int> idleStreamFuture = idleStreamPromise->get_future();
+    getIdleStream([idleStreamPromise](int streamID) { idleStreamPromise->set_value(streamID); });
+    return idleStreamFuture;
+}
+
+void OVInferRequestsQueue::getIdleStream(std::function<void(int)> callback, const deadline_t& deadline, uint64_t priority) {
+    if (schedulerClient) {
+        callback = [this, callback = std::move(callback), deadline](int streamID) {
+            if (streamID == EXPIRED_STREAM_ID) {
+                callback(streamID);
+                return;
+            }
+            acquireSlot(streamID, callback, deadline);
+        };
+    }
+    int streamID;
+    if (pop(streamID)) {
+        callback(streamID);
+        return;
+    }
+    std::unique_lock<std::mutex> queueLock(queue_mutex);
+    // Register as a waiter before checking the ring again, returnStream checks waiters after pushing.
+    // One of both sides is guaranteed to see the other so no stream is left idle while somebody waits.
+    waitersCount.fetch_add(1, std::memory_order_seq_cst);
+    if (pop(streamID)) {
+        waitersCount.fetch_sub(1, std::memory_order_relaxed);
+        queueLock.unlock();
+        callback(streamID);
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const WaiterOrder order{deadline, now - std::chrono::microseconds(priority), nextWaiterSequence++};
+    // scheduled under the lock, so that expiration finds the waiter registered
+    auto timer = DeadlineTimer::instance().schedule(deadline, [this, order]() { expireWaiter(order); });
+    idleStreamCallbacks.emplace(order, Waiter{std::move(callback), now, timer});
+}
+
+void OVInferRequestsQueue::expireWaiter(const WaiterOrder& order) {
+    std::function<void(int)> callback;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        auto it = idleStreamCallbacks.find(order);
+        if (it == idleStreamCallbacks.end()) {
+            // served or dropped by serveWaiters meanwhile
+            return;
+        }
+        callback = std::move(it->second.callback);
+        idleStreamCallbacks.erase(it);
+        waitersCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    callback(EXPIRED_STREAM_ID);
 }
 
 void OVInferRequestsQueue::returnStream(int streamID) {
-    std::unique_lock<std::mutex> lk(queue_mutex);
-    if (promises.size()) {
-        std::promise<int> promise = std::move(promises.front());
-        promises.pop();
-        lk.unlock();
-        promise.set_value(streamID);
+    const auto held = static_cast<uint64_t>(std::max<int64_t>(nowMicroseconds() - streamAcquireTimes[streamID].load(std::memory_order_relaxed), 0));
+    const auto average = averageStreamHoldMicroseconds.load(std::memory_order_relaxed);
+    // concurrent returns may overwrite each other, the average only needs to follow the trend
+    averageStreamHoldMicroseconds.store(average == 0 ? held : average - average / 8 + held / 8, std::memory_order_relaxed);
+    totalStreamHoldMicroseconds.fetch_add(held, std::memory_order_relaxed);
+    releaseStream(streamID);
+    // waiters of this model take the stream first and then compete with other models for the slot
+    if (schedulerClient) {
+        schedulerClient->getScheduler().release(*schedulerClient);
+    }
+}
+
+void OVInferRequestsQueue::releaseStream(int streamID) {
+    if (static_cast<size_t>(streamID) >= activeStreams.load(std::memory_order_seq_cst) && retireStream(streamID)) {
         return;
     }
-    std::uint32_t old_back = back_idx.load();
-    while (!back_idx.compare_exchange_weak(
-        old_back,
-        (old_back + 1) % streams.size(),
-        std::memory_order_relaxed)) {
+    push(streamID);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waitersCount.load(std::memory_order_seq_cst) > 0) {
+        serveWaiters();
+    }
+}
+
+void OVInferRequestsQueue::acquireSlot(int streamID, std::function<void(int)> callback, const deadline_t& deadline) {
+    schedulerClient->getScheduler().acquire(
+        *schedulerClient,
+        [this, streamID, callback = std::move(callback)](bool granted) {
+            if (!granted) {
+                releaseStream(streamID);
+                callback(EXPIRED_STREAM_ID);
+                return;
+            }
+            // hold time is measured from the slot grant, waiting for the slot is not inference
+            streamAcquireTimes[streamID].store(nowMicroseconds(), std::memory_order_relaxed);
+            callback(streamID);
+        },
+        deadline);
+}
+
+void OVInferRequestsQueue::serveWaiters() {
+    std::unique_lock<std::mutex> queueLock(queue_mutex);
+    while (idleStreamCallbacks.size()) {
+        auto earliest = idleStreamCallbacks.begin();
+        if (isDeadlineExceeded(earliest->first.deadline)) {
+            // expired waiter is dropped without taking the stream
+            auto callback = std::move(earliest->second.callback);
+            const auto timer = earliest->second.timer;
+            idleStreamCallbacks.erase(earliest);
+            waitersCount.fetch_sub(1, std::memory_order_relaxed);
+            queueLock.unlock();
+            // waits for expiration running meanwhile, which does not find the waiter anymore
+            DeadlineTimer::instance().cancel(timer);
+            callback(EXPIRED_STREAM_ID);
+            queueLock.lock();
+            continue;
+        }
+        int streamID;
+        if (!pop(streamID)) {
+            return;
+        }
+        auto callback = std::move(earliest->second.callback);
+        const auto timer = earliest->second.timer;
+        const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - earliest->second.enqueueTime).count();
+        idleStreamCallbacks.erase(earliest);
+        waitersCount.fetch_sub(1, std::memory_order_relaxed);
+        totalWaitMicroseconds.fetch_add(waited, std::memory_order_relaxed);
+        waitsCount.fetch_add(1, std::memory_order_relaxed);
+        // waiter may start the inference right away, do not hold the lock meanwhile
+        queueLock.unlock();
+        DeadlineTimer::instance().cancel(timer);
+        callback(streamID);
+        queueLock.lock();
     }
-    streams[old_back] = streamID;
 }
 
 }  // namespace ovms
@@ -16,19 +16,49 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <future>
+#include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include <inference_engine.hpp>
 #include <spdlog/spdlog.h>
 
+#include "blobpool.hpp"
+#include "deadline.hpp"
+#include "deadlinetimer.hpp"
+#include "inferencescheduler.hpp"
+
 namespace ovms {
+
+using blob_map_t = std::map<std::string, InferenceEngine::Blob::Ptr>;
+
 /**
-* @brief Class representing circular buffer for managing IE streams
+* @brief Passed to idle stream callback instead of stream id when caller deadline passed while waiting
+*/
+const int EXPIRED_STREAM_ID = -1;
+
+/**
+* @brief Class representing pool of idle IE streams
+*
+* Idle stream ids are kept in a bounded lock-free MPMC ring. When no stream is idle
+* callers fall back to a waiting list which is served by returnStream earliest deadline first.
+* Among waiters with equal deadline priority counts as microseconds of waiting time, so higher priority waiter
+* overtakes only waiters which did not wait longer than the difference of priorities and nobody waits forever.
+* Waiters whose deadline passes are dropped by DeadlineTimer even when no stream is returned meanwhile.
+* With inference scheduler client set, a stream is handed out only together with a slot of the scheduler.
+* Number of streams can be changed up to the capacity given at construction; streams above a decreased limit
+* are retired when they are returned or found idle, so in-flight inferences are not interrupted.
 */
 class OVInferRequestsQueue {
 public:
@@ -37,6 +67,25 @@ public:
     */
     std::future<int> getIdleStream();
 
+    /**
+    * @brief Allocating idle stream for execution without waiting and without locking
+    *
+    * @return stream id or std::nullopt if there is no idle stream at the moment
+    */
+    std::optional<int> tryGetIdleStream();
+
+    /**
+    * @brief Allocating idle stream for execution without blocking the caller
+    *
+    * @param callback called with stream id right away if there is an idle stream,
+    * otherwise it is called from returnStream of the thread releasing the stream
+    * @param deadline waiters with earlier deadline are served first, waiters whose deadline passes
+    * are called with EXPIRED_STREAM_ID, from DeadlineTimer thread when they are waiting at that time
+    * @param priority among waiters with equal deadline higher priority is served first,
+    * unless the other waiter is waiting longer than the difference of priorities in microseconds
+    */
+    void getIdleStream(std::function<void(int)> callback, const deadline_t& deadline = NO_DEADLINE, uint64_t priority = 0);
+
     /**
     * @brief Release stream after execution
     */
@@ -44,15 +93,37 @@ public:
 
     /**
     * @brief Constructor with initialization
+    *
+    * @param network
+    * @param streamsLength number of infer requests created right away
+    * @param maxStreamsLength number of infer requests the queue can be resized to, 0 or less than streamsLength means streamsLength
     */
-    OVInferRequestsQueue(InferenceEngine::ExecutableNetwork& network, int streamsLength) :
-        streams(streamsLength),
-        front_idx{0},
-        back_idx{0} {
-        for (int i = 0; i < streamsLength; ++i) {
-            streams[i] = i;
-            inferRequests.push_back(network.CreateInferRequest());
-        }
+    OVInferRequestsQueue(InferenceEngine::ExecutableNetwork& network, int streamsLength, int maxStreamsLength = 0);
+
+    /**
+    * @brief Cancels deadlines of waiters, their callbacks are not called anymore
+    */
+    ~OVInferRequestsQueue();
+
+    OVInferRequestsQueue(const OVInferRequestsQueue&) = delete;
+    OVInferRequestsQueue& operator=(const OVInferRequestsQueue&) = delete;
+
+    /**
+    * @brief Changes number of streams handed out. New infer requests are created right away,
+    * streams above the new limit are retired once they are not in use. Concurrent resizes are serialized.
+    *
+    * @param streamsLength between 1 and capacity
+    *
+    * @return false if streamsLength is out of range, the limit is not changed then
+    */
+    bool resize(size_t streamsLength);
+
+    /**
+     * @brief Makes streams wait for an inference slot of the client scheduler before they are handed out,
+     * has to be set before any stream is taken
+     */
+    void setSchedulerClient(std::shared_ptr<InferenceScheduler::Client> client) {
+        schedulerClient = std::move(client);
     }
 
     /**
@@ -62,31 +133,274 @@ public:
         return inferRequests[streamID];
     }
 
+    /**
+     * @brief Give number of InferRequests in the pool, including ones above the limit which are not retired yet
+     */
+    size_t getInferRequestsCount() const {
+        return liveStreamsCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Give number of streams handed out at once
+     */
+    size_t getStreamsLimit() const {
+        return activeStreams.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Give number of streams the queue can be resized to
+     */
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    /**
+     * @brief Give approximate number of idle streams, without locking
+     */
+    size_t getIdleStreamsCount() const {
+        const auto front = front_idx.load(std::memory_order_relaxed);
+        const auto back = back_idx.load(std::memory_order_relaxed);
+        return back > front ? back - front : 0;
+    }
+
+    /**
+     * @brief Give number of callers waiting for idle stream, without locking
+     */
+    size_t getWaitersCount() const {
+        return waitersCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Give moving average of time between taking stream and returning it, 0 until a stream is returned
+     */
+    uint64_t getAverageStreamHoldMicroseconds() const {
+        return averageStreamHoldMicroseconds.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Give total time between taking streams and returning them since the queue was created
+     */
+    uint64_t getTotalStreamHoldMicroseconds() const {
+        return totalStreamHoldMicroseconds.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Give total time callers waited in the waiting list for idle stream since the queue was created
+     */
+    uint64_t getTotalWaitMicroseconds() const {
+        return totalWaitMicroseconds.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Give number of callers which had to wait for idle stream since the queue was created
+     */
+    uint64_t getWaitsCount() const {
+        return waitsCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Allocates FP16 or U16 input blob for each infer request and sets it once, deserialization converts values into it afterwards
+     *
+     * @param name network input name
+     * @param tensorDesc
+     */
+    void preallocateInputBlob(const std::string& name, const InferenceEngine::TensorDesc& tensorDesc);
+
+    /**
+     * @brief Replaces output blob allocated by the plugin in each infer request with one allocated by allocateConvertedBlob
+     *
+     * @param name network output name
+     * @param tensorDesc
+     */
+    void preallocateOutputBlob(const std::string& name, const InferenceEngine::TensorDesc& tensorDesc);
+
+    /**
+     * @brief Give input blobs preallocated for InferRequest, keyed by network input name
+     */
+    const blob_map_t& getPreallocatedInputBlobs(int streamID) const {
+        return preallocatedInputBlobs[streamID];
+    }
+
+    /**
+     * @brief Give input blobs kept for chunks of split batches inferred on InferRequest, keyed by network input name.
+     * Only the holder of the stream uses them, so they are allocated once per stream and reused by following chunks.
+     */
+    blob_map_t& getChunkInputBlobs(int streamID) {
+        return chunkInputBlobs[streamID];
+    }
+
+    /**
+     * @brief Give pool of spare output blobs, used to take results away from InferRequests without copying
+     */
+    BlobPool& getOutputBlobPool() {
+        return *outputBlobPool;
+    }
+
+    /**
+     * @brief Give context of device memory of the network, nullptr for plugins without remote blobs, e.g. CPU
+     */
+    const InferenceEngine::RemoteContext::Ptr& getRemoteContext() const {
+        return remoteContext;
+    }
+
+    /**
+     * @brief Give pool of output blobs allocated in device memory, nullptr without remote context
+     */
+    BlobPool* getDeviceOutputBlobPool() {
+        return deviceOutputBlobPool.get();
+    }
+
 protected:
     /**
-    * @brief Vector representing circular buffer for infer queue
+    * @brief Cell of the ring buffer, sequence number tells if cell is ready for push or pop
+    */
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        int streamId;
+    };
+
+    /**
+    * @brief Pushes idle stream id into the ring
+    */
+    bool push(int streamID);
+
+    /**
+    * @brief Pops idle stream id from the ring, streams above the limit are retired instead of handed out
+    */
+    bool pop(int& streamID);
+
+    /**
+    * @brief Pops any stream id from the ring
+    */
+    bool popRing(int& streamID);
+
+    /**
+    * @brief Releases infer request of stream which is above the limit
+    *
+    * @return false if stream is within the limit again and has to be kept
+    */
+    bool retireStream(int streamID);
+
+    /**
+    * @brief Creates infer request of stream with preallocated blobs, has to be called with resize lock held
+    */
+    void createInferRequest(int streamID);
+
+    /**
+    * @brief Hands idle streams from the ring to registered waiters
+    */
+    void serveWaiters();
+
+    struct WaiterOrder {
+        deadline_t deadline;
+        // enqueue time moved back by priority
+        std::chrono::steady_clock::time_point rank;
+        // keeps waiters of equal rank in order of arrival
+        uint64_t sequence;
+        bool operator<(const WaiterOrder& other) const {
+            return std::tie(deadline, rank, sequence) < std::tie(other.deadline, other.rank, other.sequence);
+        }
+    };
+
+    /**
+    * @brief Drops waiter whose deadline passed while it was waiting, called by DeadlineTimer
     */
-    std::vector<int> streams;
+    void expireWaiter(const WaiterOrder& order);
+
+    /**
+    * @brief Puts stream back into the ring and serves waiters, without releasing the scheduler slot
+    */
+    void releaseStream(int streamID);
+
+    /**
+    * @brief Waits for scheduler slot for already taken stream, stream is released if deadline passes first
+    */
+    void acquireSlot(int streamID, std::function<void(int)> callback, const deadline_t& deadline);
+
+    /**
+    * @brief Ring buffer with capacity rounded up to power of 2
+    */
+    std::unique_ptr<Cell[]> cells;
+
+    /**
+    * @brief Mask used for ring indexing
+    */
+    std::size_t mask;
 
     /**
     * @brief Index of the front of the idle streams list
     */
-    std::uint32_t front_idx;
+    alignas(64) std::atomic<std::size_t> front_idx;
 
     /**
     * @brief Index of the back of the idle streams list
     */
-    std::atomic<std::uint32_t> back_idx;
+    alignas(64) std::atomic<std::size_t> back_idx;
 
     /**
-    * @brief Vector representing OV streams and used for notification about completed inference operations
+    * @brief Number of callers waiting for idle stream
+    */
+    alignas(64) std::atomic<std::size_t> waitersCount{0};
+
+    /**
+    * @brief Protects waiting list of callbacks
     */
-    std::mutex front_mut;
     std::mutex queue_mutex;
+
+    /**
+    * @brief Time each stream was taken at, in microseconds of steady clock
+    */
+    std::unique_ptr<std::atomic<int64_t>[]> streamAcquireTimes;
+
+    /**
+    * @brief Stream hold time averaged with weight 1/8 of the latest one, updated without locking
+    */
+    std::atomic<uint64_t> averageStreamHoldMicroseconds{0};
+    std::atomic<uint64_t> totalStreamHoldMicroseconds{0};
+
+    std::atomic<uint64_t> totalWaitMicroseconds{0};
+    std::atomic<uint64_t> waitsCount{0};
+
+    /**
+    * @brief Number of streams ids the ring and infer requests are allocated for
+    */
+    std::size_t capacity;
+
+    /**
+    * @brief Streams with lower ids are handed out, the rest are retired
+    */
+    std::atomic<std::size_t> activeStreams{0};
+
+    /**
+    * @brief Number of streams with infer request created and not retired yet
+    */
+    std::atomic<std::size_t> liveStreamsCount{0};
+
+    /**
+    * @brief Serializes creation and retirement of infer requests
+    */
+    std::mutex resizeMutex;
+    std::vector<bool> liveStreams;
+    InferenceEngine::ExecutableNetwork network;
+    std::vector<std::pair<std::string, InferenceEngine::TensorDesc>> preallocatedInputDescs;
+    std::vector<std::pair<std::string, InferenceEngine::TensorDesc>> preallocatedOutputDescs;
+
     /**
-     * 
+     * @brief Infer requests of capacity streams, retired ones are empty
      */
-    std::vector<InferenceEngine::InferRequest> inferRequests;
-    std::queue<std::promise<int>> promises;
+    std::unique_ptr<InferenceEngine::InferRequest[]> inferRequests;
+    std::vector<blob_map_t> preallocatedInputBlobs;
+    std::vector<blob_map_t> chunkInputBlobs;
+    std::shared_ptr<BlobPool> outputBlobPool;
+    InferenceEngine::RemoteContext::Ptr remoteContext;
+    std::shared_ptr<BlobPool> deviceOutputBlobPool;
+    std::shared_ptr<InferenceScheduler::Client> schedulerClient;
+    struct Waiter {
+        std::function<void(int)> callback;
+        std::chrono::steady_clock::time_point enqueueTime;
+        DeadlineTimer::timer_id_t timer = DeadlineTimer::NO_TIMER;
+    };
+    std::map<WaiterOrder, Waiter> idleStreamCallbacks;
+    uint64_t nextWaiterSequence = 0;
 };
 }  // namespace ovms
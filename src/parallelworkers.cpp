@@ -0,0 +1,108 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "parallelworkers.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include "containerlimits.hpp"
+
+namespace ovms {
+
+struct ParallelWorkers::Job {
+    Job(size_t tasksCount, const task_function_t& task) :
+        tasksCount(tasksCount),
+        task(task) {}
+
+    // claims and executes remaining tasks, job can be picked by workers after the requesting thread returned
+    void execute() {
+        for (size_t i = nextTask++; i < tasksCount; i = nextTask++) {
+            task(i);
+            if (++finishedCount == tasksCount) {
+                std::lock_guard<std::mutex> lock(mtx);
+                finishedCondition.notify_all();
+            }
+        }
+    }
+
+    const size_t tasksCount;
+    const task_function_t& task;
+    std::atomic<size_t> nextTask{0};
+    std::atomic<size_t> finishedCount{0};
+    std::mutex mtx;
+    std::condition_variable finishedCondition;
+};
+
+ParallelWorkers& ParallelWorkers::instance() {
+    static ParallelWorkers instance(std::max<size_t>(getEffectiveCpuCount(), 1) - 1);
+    return instance;
+}
+
+ParallelWorkers::ParallelWorkers(size_t workersCount) {
+    workers.reserve(workersCount);
+    for (size_t i = 0; i < workersCount; ++i) {
+        workers.emplace_back(&ParallelWorkers::work, this);
+    }
+}
+
+ParallelWorkers::~ParallelWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    jobsCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ParallelWorkers::run(size_t tasksCount, size_t parallelism, const task_function_t& task) {
+    if (tasksCount == 0) {
+        return;
+    }
+    auto job = std::make_shared<Job>(tasksCount, task);
+    const size_t helpersCount = std::min({tasksCount, std::max<size_t>(parallelism, 1), workers.size() + 1}) - 1;
+    if (helpersCount > 0) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (size_t i = 0; i < helpersCount; ++i) {
+                jobs.push_back(job);
+            }
+        }
+        jobsCondition.notify_all();
+    }
+    job->execute();
+    std::unique_lock<std::mutex> lock(job->mtx);
+    job->finishedCondition.wait(lock, [&job]() { return job->finishedCount == job->tasksCount; });
+}
+
+void ParallelWorkers::work() {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            jobsCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job->execute();
+    }
+}
+
+}  // namespace ovms
@@ -0,0 +1,80 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Process wide threads splitting CPU bound parts of a single request, such as parsing or image decoding
+ *
+ * Threads are started once, so requests do not pay for creating and joining threads.
+ * The requesting thread executes tasks as well, so a request progresses even when all threads are busy with other requests.
+ */
+class ParallelWorkers {
+public:
+    using task_function_t = std::function<void(size_t)>;
+
+    /**
+     * @brief Returns workers shared by all requests, sized to the effective CPU count
+     */
+    static ParallelWorkers& instance();
+
+    /**
+     * @param workersCount number of threads helping requesting threads
+     */
+    ParallelWorkers(size_t workersCount);
+
+    /**
+     * @brief Stops threads after finishing already queued tasks
+     */
+    ~ParallelWorkers();
+
+    ParallelWorkers(const ParallelWorkers&) = delete;
+    ParallelWorkers& operator=(const ParallelWorkers&) = delete;
+
+    /**
+     * @brief Executes task for each index from 0 to tasksCount - 1 and blocks until all of them finish
+     *
+     * @param tasksCount number of task executions
+     * @param parallelism maximum number of task executions running at once, including the requesting thread
+     * @param task function which must not throw, called with the index of execution
+     */
+    void run(size_t tasksCount, size_t parallelism, const task_function_t& task);
+
+    size_t getWorkersCount() const { return workers.size(); }
+
+private:
+    struct Job;
+
+    void work();
+
+    std::mutex mtx;
+    std::condition_variable jobsCondition;
+    std::deque<std::shared_ptr<Job>> jobs;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+};
+
+}  // namespace ovms
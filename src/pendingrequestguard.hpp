@@ -0,0 +1,36 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+namespace ovms {
+class ModelInstance;
+
+/**
+ * @brief Counts request as pending in model instance for its lifetime if it was admitted
+ */
+class PendingRequestGuard {
+public:
+    PendingRequestGuard() = delete;
+    PendingRequestGuard(ModelInstance& modelInstance);
+    ~PendingRequestGuard();
+
+    bool isAdmitted() const { return admitted; }
+
+private:
+    ModelInstance& modelInstance;
+    const bool admitted;
+};
+}  // namespace ovms
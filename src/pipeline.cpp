@@ -16,12 +16,16 @@
 #include "pipeline.hpp"
 
 #include <algorithm>
-#include <map>
+#include <optional>
 #include <string>
 #include <utility>
 
+#include "allocationprofile.hpp"
+#include "hotpathtimings.hpp"
 #include "logging.hpp"
-#include "threadsafequeue.hpp"
+#include "mpscqueue.hpp"
+#include "pipelinescheduler.hpp"
+#include "samplingprofiler.hpp"
 
 namespace ovms {
 
@@ -34,15 +38,100 @@ void printNodeConnections(const std::string& nodeName, const std::string& source
     for (auto& pair : pairs) {
         ss << "\t" << nodeName << "[" << pair.second << "]=" << sourceNode << "[" << pair.first << "]\n";
     }
-    SPDLOG_LOGGER_DEBUG(dag_executor_logger, ss.str());
+    OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, ss.str());
 }
 
-std::map<const std::string, bool> Pipeline::prepareStatusMap() const {
-    std::map<const std::string, bool> nameFlagMap;
-    for (const auto& node : nodes) {
-        nameFlagMap.emplace(std::make_pair(node->getName(), false));
+Pipeline::~Pipeline() {
+    if (!nodesRecycler) {
+        return;
+    }
+    for (auto& node : nodes) {
+        node->reset();
+    }
+    nodesRecycler(std::move(nodes));
+}
+
+void Pipeline::markStarted(const Node& node) {
+    if (!startedExecute[node.getId()]) {
+        startedExecute[node.getId()] = true;
+        startedNodesCount++;
+        if (pipelineSpan.isRecording()) {
+            nodeStartTimes[node.getId()] = std::chrono::system_clock::now();
+        }
+    }
+}
+
+void Pipeline::markFinished(const Node& node) {
+    if (!finishedExecute[node.getId()]) {
+        finishedExecute[node.getId()] = true;
+        finishedNodesCount++;
+        if (pipelineSpan.isRecording()) {
+            // node span is complete once started, it ends right away
+            Span(node.getName(), &pipelineSpan.getContext(), nodeStartTimes[node.getId()]).end();
+        }
+    }
+}
+
+void Pipeline::markWaitingForIdleInferenceStreamId(const Node& node) {
+    waitingForIdleInferenceStreamId[node.getId()] = true;
+    nodesWaitingForIdleInferenceStreamIdCount++;
+}
+
+void Pipeline::markExecuteStarted(const Node& node) {
+    if (criticalPath) {
+        executeStartTimes[node.getId()] = std::chrono::steady_clock::now();
+    }
+}
+
+void Pipeline::recordLatency(const Node& node) {
+    if (criticalPath) {
+        // deferred node is measured since it got stream id, so that waiting for it does not raise its priority
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - executeStartTimes[node.getId()]);
+        criticalPath->recordLatency(node.getId(), latency.count());
+    }
+}
+
+void Pipeline::recordFinished(const Status& status) {
+    // pipelines rejected before start are not executed
+    if (startTime != std::chrono::steady_clock::time_point()) {
+        HotPathTimings::recordSince<HotPathStage::PIPELINE_EXECUTION>(startTime);
+    }
+    if (metrics) {
+        metrics->recordEndToEndSince(startTime);
+        if (!status.ok()) {
+            metrics->recordError();
+        }
+    }
+    if (!status.ok()) {
+        pipelineSpan.setError(status.string());
+    }
+    pipelineSpan.end();
+    if (admitted) {
+        admitted = false;
+        admission->release();
+    }
+}
+
+void Pipeline::skip(Node& node) {
+    if (&node == &exit) {
+        exit.skipDependency();
+        if (exit.isReady()) {
+            readyNodes.push_back(exit);
+        }
+        return;
+    }
+    if (skippedExecute[node.getId()]) {
+        return;
+    }
+    OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Skipping pipeline: {} node: {}", getName(), node.getName());
+    skippedExecute[node.getId()] = true;
+    startedExecute[node.getId()] = true;
+    finishedExecute[node.getId()] = true;
+    startedNodesCount++;
+    finishedNodesCount++;
+    for (auto& nextNode : node.getNextNodes()) {
+        skip(nextNode.get());
     }
-    return std::move(nameFlagMap);
 }
 
 void setFailIfNotFailEarlier(ovms::Status& earlierStatusCode, ovms::Status& newFailStatus) {
@@ -51,13 +140,9 @@ void setFailIfNotFailEarlier(ovms::Status& earlierStatusCode, ovms::Status& newF
     }
 }
 
-#define IF_ERROR_OCCURRED_EARLIER_THEN_BREAK_IF_ALL_STARTED_FINISHED_CONTINUE_OTHERWISE \
-    if (!firstErrorStatus.ok()) {                                                       \
-        if (finishedExecute == startedExecute) {                                        \
-            break;                                                                      \
-        } else {                                                                        \
-            continue;                                                                   \
-        }                                                                               \
+#define IF_ERROR_OCCURRED_EARLIER_THEN_RETURN_IF_ALL_STARTED_FINISHED \
+    if (!firstErrorStatus.ok()) {                                       \
+        return allStartedFinished();                                    \
     }
 
 #define CHECK_AND_LOG_ERROR(NODE)                                                                  \
@@ -67,121 +152,285 @@ void setFailIfNotFailEarlier(ovms::Status& earlierStatusCode, ovms::Status& newF
             getName(), NODE.getName(), status.string());                                           \
     }
 
-Status Pipeline::execute() {
-    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Started execution of pipeline: {}", getName());
-    ThreadSafeQueue<std::reference_wrapper<Node>> finishedNodeQueue;
-    ovms::Status firstErrorStatus{ovms::StatusCode::OK};
-    auto startedExecute{prepareStatusMap()};
-    auto finishedExecute{prepareStatusMap()};
-    startedExecute.at(entry.getName()) = true;
+Status Pipeline::start() {
+    OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Started execution of pipeline: {}", getName());
+    startTime = std::chrono::steady_clock::now();
+    if (traceContext.sampled) {
+        pipelineSpan = Span("pipeline", &traceContext);
+        pipelineSpan.setAttribute("ovms.pipeline_name", getName());
+        nodeStartTimes.resize(nodes.size());
+    }
+    startedExecute.assign(nodes.size(), false);
+    finishedExecute.assign(nodes.size(), false);
+    skippedExecute.assign(nodes.size(), false);
+    waitingForIdleInferenceStreamId.assign(nodes.size(), false);
+    for (auto& node : nodes) {
+        node->setDeadline(deadline);
+    }
+    if (criticalPath) {
+        if (criticalPath->getNodesCount() != nodes.size()) {
+            SPDLOG_LOGGER_WARN(dag_executor_logger, "Pipeline: {} critical path estimator does not match the graph, nodes are not prioritized", getName());
+            criticalPath.reset();
+        } else {
+            executeStartTimes.resize(nodes.size());
+        }
+    }
+    markStarted(entry);
+    markExecuteStarted(entry);
     ovms::Status status = entry.execute(finishedNodeQueue);  // first node will triger first message
     if (!status.ok()) {
         SPDLOG_LOGGER_WARN(dag_executor_logger, "Executing pipeline: {} node: {} failed with: {}",
             getName(), entry.getName(), status.string());
-        return status;
     }
-    std::vector<std::reference_wrapper<Node>> nodesWaitingForIdleInferenceStreamId;  // consider replacing with std::vector
-    // even though we can remove with random sequence it is probable that we will remove those in sequence
-    const uint WAIT_FOR_FINISHED_NODE_TIMEOUT_MICROSECONDS = 5000;
-    const uint WAIT_FOR_DEFERRED_NODE_DISARM_TIMEOUT_MICROSECONDS = 500;
-    // process finished nodes and if no one is finished check if any node with deferred execution
-    // has necessary resources already
-    while (true) {
-        spdlog::trace("Pipeline: {} waiting for message that node finished.", getName());
-        auto optionallyFinishedNode = finishedNodeQueue.tryPull(WAIT_FOR_FINISHED_NODE_TIMEOUT_MICROSECONDS);
-        if (optionallyFinishedNode) {
-            Node& finishedNode = optionallyFinishedNode.value().get();
-            SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Pipeline: {} got message that node: {} finished.", getName(), finishedNode.getName());
-            finishedExecute.at(finishedNode.getName()) = true;
-            if (!firstErrorStatus.ok()) {
-                finishedNode.release();
+    return status;
+}
+
+bool Pipeline::prepareNextStep() {
+    if (firstErrorStatus.ok() && isDeadlineExceeded(deadline)) {
+        // remaining nodes are not started, deferred ones give up waiting for stream
+        Status status = StatusCode::DEADLINE_EXCEEDED;
+        setFailIfNotFailEarlier(firstErrorStatus, status);
+        SPDLOG_LOGGER_WARN(dag_executor_logger, "Executing pipeline: {} failed with: {}", getName(), status.string());
+    }
+    if (!firstErrorStatus.ok() && nodesWaitingForIdleInferenceStreamIdCount > 0) {
+        // If error occurred earlier, disarm stream id guards of all deferred nodes, stream ids assigned later are returned right away
+        OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Disarming stream id guards of all {} deferred nodes due to previous error in pipeline", nodesWaitingForIdleInferenceStreamIdCount);
+        for (auto& node : nodes) {
+            if (waitingForIdleInferenceStreamId[node->getId()]) {
+                waitingForIdleInferenceStreamId[node->getId()] = false;
+                node->release();
+                markFinished(*node);
             }
-            IF_ERROR_OCCURRED_EARLIER_THEN_BREAK_IF_ALL_STARTED_FINISHED_CONTINUE_OTHERWISE
-            BlobMap finishedNodeOutputBlobMap;
-            SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Fetching results of pipeline: {} node: {}", getName(), finishedNode.getName());
-            status = finishedNode.fetchResults(finishedNodeOutputBlobMap);
-            CHECK_AND_LOG_ERROR(finishedNode)
-            IF_ERROR_OCCURRED_EARLIER_THEN_BREAK_IF_ALL_STARTED_FINISHED_CONTINUE_OTHERWISE
-            if (std::all_of(finishedExecute.begin(), finishedExecute.end(), [](auto pair) { return pair.second; })) {
-                break;
+        }
+        nodesWaitingForIdleInferenceStreamIdCount = 0;
+    }
+    return !firstErrorStatus.ok() && allStartedFinished();
+}
+
+bool Pipeline::processMessage(Node& finishedNode) {
+    if (&finishedNode == &entry && finishedExecute[entry.getId()]) {
+        // entry node finishes only once, repeated message is a wake-up from deadline timer handled by prepareNextStep
+        return false;
+    }
+    Status status;
+    if (waitingForIdleInferenceStreamId[finishedNode.getId()]) {
+        waitingForIdleInferenceStreamId[finishedNode.getId()] = false;
+        nodesWaitingForIdleInferenceStreamIdCount--;
+        if (!firstErrorStatus.ok()) {
+            finishedNode.release();
+            markFinished(finishedNode);
+            return allStartedFinished();
+        }
+        OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Pipeline: {} deferred node: {} got stream id, triggering execution", getName(), finishedNode.getName());
+        markExecuteStarted(finishedNode);
+        status = finishedNode.execute(finishedNodeQueue);
+        if (status == StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET) {
+            OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Node: {} not ready for execution yet", finishedNode.getName());
+            markWaitingForIdleInferenceStreamId(finishedNode);
+            status = StatusCode::OK;
+        }
+        CHECK_AND_LOG_ERROR(finishedNode)
+        return false;
+    }
+    OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Pipeline: {} got message that node: {} finished.", getName(), finishedNode.getName());
+    markFinished(finishedNode);
+    if (!firstErrorStatus.ok()) {
+        finishedNode.release();
+    }
+    IF_ERROR_OCCURRED_EARLIER_THEN_RETURN_IF_ALL_STARTED_FINISHED
+    recordLatency(finishedNode);
+    BlobMap finishedNodeOutputBlobMap;
+    OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Fetching results of pipeline: {} node: {}", getName(), finishedNode.getName());
+    status = finishedNode.fetchResults(finishedNodeOutputBlobMap);
+    CHECK_AND_LOG_ERROR(finishedNode)
+    IF_ERROR_OCCURRED_EARLIER_THEN_RETURN_IF_ALL_STARTED_FINISHED
+    if (finishedNodesCount == nodes.size()) {
+        return true;
+    }
+    auto& nextNodesFromFinished = finishedNode.getNextNodes();
+    readyNodes.clear();
+    if (finishedNode.isSkippingDependants()) {
+        for (auto& nextNode : nextNodesFromFinished) {
+            skip(nextNode.get());
+        }
+    } else {
+        for (auto& nextNode : nextNodesFromFinished) {
+            if (skippedExecute[nextNode.get().getId()]) {
+                // skipped by failed gate earlier, outputs of its other dependencies are not needed
+                continue;
             }
-            auto& nextNodesFromFinished = finishedNode.getNextNodes();
-            for (auto& nextNode : nextNodesFromFinished) {
-                SPDLOG_LOGGER_DEBUG(dag_executor_logger, "setting pipeline: {} node: {} outputs as inputs for node: {}",
-                    getName(), finishedNode.getName(), nextNode.get().getName());
-                status = nextNode.get().setInputs(finishedNode, finishedNodeOutputBlobMap);
-                CHECK_AND_LOG_ERROR(nextNode.get())
-                if (!firstErrorStatus.ok()) {
-                    break;
-                }
+            OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "setting pipeline: {} node: {} outputs as inputs for node: {}",
+                getName(), finishedNode.getName(), nextNode.get().getName());
+            status = nextNode.get().setInputs(finishedNode, finishedNodeOutputBlobMap);
+            CHECK_AND_LOG_ERROR(nextNode.get())
+            if (!firstErrorStatus.ok()) {
+                break;
             }
-            finishedNodeOutputBlobMap.clear();
-            for (auto& nextNode : nextNodesFromFinished) {
-                if (nextNode.get().isReady()) {
-                    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Started execution of pipeline: {} node: {}", getName(), nextNode.get().getName());
-                    startedExecute.at(nextNode.get().getName()) = true;
-                    status = nextNode.get().execute(finishedNodeQueue);
-                    if (status == StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET) {
-                        SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Node: {} not ready for execution yet", nextNode.get().getName());
-                        nodesWaitingForIdleInferenceStreamId.push_back(nextNode.get());
-                        status = StatusCode::OK;
-                    }
-                    CHECK_AND_LOG_ERROR(nextNode.get())
-                    if (!firstErrorStatus.ok()) {
-                        break;
-                    }
-                }
+        }
+    }
+    finishedNodeOutputBlobMap.clear();
+    for (auto& nextNode : nextNodesFromFinished) {
+        if (skippedExecute[nextNode.get().getId()]) {
+            continue;
+        }
+        // exit node might have been already added when its last remaining dependency got skipped
+        if (nextNode.get().isReady() && std::find_if(readyNodes.begin(), readyNodes.end(), [&nextNode](const Node& node) { return &node == &nextNode.get(); }) == readyNodes.end()) {
+            if (criticalPath) {
+                nextNode.get().setPriority(criticalPath->getPriority(nextNode.get().getId()));
             }
+            readyNodes.push_back(nextNode);
+        }
+    }
+    // nodes on the longest remaining path are started first, so they are the first to take idle streams
+    std::stable_sort(readyNodes.begin(), readyNodes.end(), [](const Node& lhs, const Node& rhs) {
+        return lhs.getPriority() > rhs.getPriority();
+    });
+    for (auto& readyNode : readyNodes) {
+        OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Started execution of pipeline: {} node: {}", getName(), readyNode.get().getName());
+        markStarted(readyNode.get());
+        markExecuteStarted(readyNode.get());
+        status = readyNode.get().execute(finishedNodeQueue);
+        if (status == StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET) {
+            OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Node: {} not ready for execution yet", readyNode.get().getName());
+            markWaitingForIdleInferenceStreamId(readyNode.get());
+            status = StatusCode::OK;
+        }
+        CHECK_AND_LOG_ERROR(readyNode.get())
+        if (!firstErrorStatus.ok()) {
+            break;
+        }
+    }
+    return false;
+}
+
+Status Pipeline::execute() {
+    AllocationPhaseGuard allocationPhase(AllocationPhase::PIPELINE_ORCHESTRATION);
+    ProfilerTag profilerTag("pipeline_execution");
+    if (auto current = TraceScope::current()) {
+        traceContext = *current;
+    }
+    if (admission) {
+        auto status = admission->acquire(deadline);
+        if (!status.ok()) {
+            OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Pipeline: {} was not admitted before deadline", getName());
+            recordFinished(status);
+            return status;
+        }
+        admitted = true;
+    }
+    auto status = start();
+    if (!status.ok()) {
+        recordFinished(status);
+        return status;
+    }
+    // process finished nodes and start deferred ones as soon as they get stream id,
+    // executor thread sleeps until any of those events happens or deadline passes
+    while (!prepareNextStep()) {
+        OVMS_HOT_PATH_TRACE("Pipeline: {} waiting for message that node finished.", getName());
+        std::optional<std::reference_wrapper<Node>> optionallyFinishedNode;
+        if (!firstErrorStatus.ok() || deadline == NO_DEADLINE) {
+            // only nodes with inference in flight are left after error, those always notify
+            optionallyFinishedNode = finishedNodeQueue.pull();
         } else {
-            // If error occurred earlier, disarm stream id guards of all deferred nodes and exit
-            if (!firstErrorStatus.ok()) {
-                SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Will try to disarm all stream id guards of all {} deferred nodes due to previous error in pipeline", nodesWaitingForIdleInferenceStreamId.size());
-                // Check if there are deferred nodes in queue to free
-                if (nodesWaitingForIdleInferenceStreamId.size() > 0) {
-                    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Trying to disarm {} remaining deferred nodes...", nodesWaitingForIdleInferenceStreamId.size());
-                    for (auto it = nodesWaitingForIdleInferenceStreamId.begin(); it != nodesWaitingForIdleInferenceStreamId.end();) {
-                        auto& node = (*it).get();
-                        if (node.tryDisarmStreamIdGuard(WAIT_FOR_DEFERRED_NODE_DISARM_TIMEOUT_MICROSECONDS)) {
-                            SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Stream id guard disarm of node {} has succeeded", node.getName());
-                            finishedExecute.at(node.getName()) = true;
-                            it = nodesWaitingForIdleInferenceStreamId.erase(it);
-                        } else {
-                            SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Cannot disarm stream id guard of node {} yet, will try again later", node.getName());
-                            it++;
-                        }
-                    }
-                    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Disarming iteration completed, remaining deferred nodes count: {}", nodesWaitingForIdleInferenceStreamId.size());
-                }
-                // Check for deferred node queue size again to indicate if all nodes got freed
-                if (nodesWaitingForIdleInferenceStreamId.size() > 0) {
-                    continue;
-                } else {
-                    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Disarming all stream id guards of deferred nodes completed, pipeline will shut down");
-                    IF_ERROR_OCCURRED_EARLIER_THEN_BREAK_IF_ALL_STARTED_FINISHED_CONTINUE_OTHERWISE
-                }
+            optionallyFinishedNode = finishedNodeQueue.tryPullUntil(deadline);
+        }
+        if (optionallyFinishedNode && processMessage(optionallyFinishedNode.value().get())) {
+            break;
+        }
+    }
+    recordFinished(firstErrorStatus);
+    return firstErrorStatus;
+}
+
+void Pipeline::executeAsync(PipelineScheduler& scheduler, std::function<void(Status)> onFinished) {
+    this->onFinished = std::move(onFinished);
+    // scheduled tasks run on executor threads, context of the request is taken from the calling thread
+    if (auto current = TraceScope::current()) {
+        traceContext = *current;
+    }
+    // starting the pipeline is counted as a message, so that messages pushed meanwhile are left for the scheduled task
+    pendingMessagesCount = 1;
+    finishedNodeQueue.setPushListener([this, &scheduler]() {
+        // only one task processes messages of the pipeline at a time
+        if (pendingMessagesCount.fetch_add(1) == 0) {
+            scheduler.schedule([this]() { processPendingMessages(); });
+        }
+    });
+    auto scheduleStart = [this, &scheduler]() {
+        scheduler.schedule([this]() {
+            auto status = start();
+            if (!status.ok()) {
+                finishAsync(status);
+                return;
             }
+            // no message may come while all nodes wait for streams, timer wakes the pipeline up to fail on time
+            deadlineTimerId = DeadlineTimer::instance().schedule(deadline, [this]() {
+                finishedNodeQueue.push(std::reference_wrapper<Node>(entry));
+            });
+            processPendingMessages(1);
+        });
+    };
+    if (!admission) {
+        scheduleStart();
+        return;
+    }
+    // pipeline waiting for admission holds neither scheduler worker nor infer requests,
+    // it is started by the thread releasing the slot or fails on time once its deadline passes
+    admission->acquireAsync([this, scheduleStart, &scheduler](Status status) {
+        if (!status.ok()) {
+            OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Pipeline: {} was not admitted before deadline", getName());
+            // finished on executor thread instead of the timer one
+            scheduler.schedule([this, status]() { finishAsync(status); });
+            return;
+        }
+        admitted = true;
+        scheduleStart();
+    },
+        deadline);
+}
 
-            // else scope could be executed always however it seems most reasonable at the time to
-            // free blocked inferRequests from exeuction first rather than free models for reloading
-            for (auto it = nodesWaitingForIdleInferenceStreamId.begin(); it != nodesWaitingForIdleInferenceStreamId.end();) {
-                auto& node = (*it).get();
-                SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Trying to trigger node: {} execution", node.getName());
-                status = node.execute(finishedNodeQueue);
-                if (status.ok()) {
-                    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Node: {} ready yet:", node.getName());
-                    it = nodesWaitingForIdleInferenceStreamId.erase(it);
-                    continue;
-                }
-                it++;
-                if (status == StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET) {
-                    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Node: {} not ready for execution yet", node.getName());
-                    status = StatusCode::OK;
-                } else {
-                    CHECK_AND_LOG_ERROR(node)
-                }
+void Pipeline::processPendingMessages(size_t messagesNotInQueueCount) {
+    auto observedMessagesCount = pendingMessagesCount.load();
+    // Only messages already counted by push listener are pulled. Pipeline may be destroyed once it is finished,
+    // so it must not process a message whose pusher did not return from the listener yet.
+    auto messagesToPullCount = observedMessagesCount - messagesNotInQueueCount;
+    while (true) {
+        while (true) {
+            if (prepareNextStep()) {
+                finishAsync(firstErrorStatus);
+                return;
+            }
+            if (messagesToPullCount == 0) {
+                break;
+            }
+            auto optionallyFinishedNode = finishedNodeQueue.tryPull(0);
+            if (!optionallyFinishedNode) {
+                break;
+            }
+            messagesToPullCount--;
+            if (processMessage(optionallyFinishedNode.value().get())) {
+                finishAsync(firstErrorStatus);
+                return;
             }
         }
+        // messages pushed while processing schedule nothing, check for those before giving up processing
+        const auto previousMessagesCount = pendingMessagesCount.fetch_sub(observedMessagesCount);
+        if (previousMessagesCount == observedMessagesCount) {
+            return;
+        }
+        observedMessagesCount = previousMessagesCount - observedMessagesCount;
+        messagesToPullCount = observedMessagesCount;
     }
-    return firstErrorStatus;
+}
+
+void Pipeline::finishAsync(Status status) {
+    OVMS_HOT_PATH_LOGGER_DEBUG(dag_executor_logger, "Finished asynchronous execution of pipeline: {} with: {}", getName(), status.string());
+    recordFinished(status);
+    // waits for timer callback which could be pushing the wake-up meanwhile
+    DeadlineTimer::instance().cancel(deadlineTimerId);
+    deadlineTimerId = DeadlineTimer::NO_TIMER;
+    // callback may destroy the pipeline, nothing can be accessed afterwards
+    auto callback = std::move(onFinished);
+    callback(std::move(status));
 }
 }  // namespace ovms
@@ -15,26 +15,76 @@
 //*****************************************************************************
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "criticalpathestimator.hpp"
+#include "deadline.hpp"
+#include "deadlinetimer.hpp"
 #include "dl_node.hpp"
 #include "entry_node.hpp"
 #include "exit_node.hpp"
+#include "mpscqueue.hpp"
+#include "pipelineadmission.hpp"
+#include "pipelinegraphpool.hpp"
+#include "pipelinemetrics.hpp"
 #include "status.hpp"
+#include "tracing.hpp"
 
 namespace ovms {
 
+class PipelineScheduler;
+
 void printNodeConnections(const std::string& nodeName, const std::string& sourceNode, const InputPairs& pairs);
 
 class Pipeline {
-    std::vector<std::unique_ptr<Node>> nodes;
+    pipeline_nodes_t nodes;
+    // returns nodes to the pool of pipeline definition when pipeline is destroyed
+    PipelineGraphPool::recycler_t nodesRecycler;
     const std::string name;
     EntryNode& entry;
     ExitNode& exit;
+    deadline_t deadline = NO_DEADLINE;
+
+    MpscQueue<std::reference_wrapper<Node>> finishedNodeQueue;
+    Status firstErrorStatus{StatusCode::OK};
+    // Execution state indexed by node id
+    std::vector<bool> startedExecute;
+    std::vector<bool> finishedExecute;
+    // Nodes depending on failed gate condition, counted as started and finished without execution
+    std::vector<bool> skippedExecute;
+    size_t startedNodesCount = 0;
+    size_t finishedNodesCount = 0;
+    // Nodes waiting for idle inference stream id. Such node is pushed to finishedNodeQueue once stream id
+    // is assigned to it, so message from a deferred node means it can be executed, not that it finished.
+    std::vector<bool> waitingForIdleInferenceStreamId;
+    size_t nodesWaitingForIdleInferenceStreamIdCount = 0;
+
+    // Measures node latencies and orders nodes which became ready together, longest remaining path first
+    std::shared_ptr<CriticalPathEstimator> criticalPath;
+    std::vector<std::chrono::steady_clock::time_point> executeStartTimes;
+    std::vector<std::reference_wrapper<Node>> readyNodes;
+
+    std::shared_ptr<PipelineMetrics> metrics;
+    std::chrono::steady_clock::time_point startTime;
+
+    // Context of the request which executes the pipeline, nodes are traced only when it is sampled
+    TraceContext traceContext;
+    Span pipelineSpan;
+    std::vector<std::chrono::system_clock::time_point> nodeStartTimes;
+
+    // Limits concurrent pipelines of the definition, slot is held from start until pipeline finishes
+    std::shared_ptr<PipelineAdmission> admission;
+    bool admitted = false;
+
+    std::function<void(Status)> onFinished;
+    std::atomic<size_t> pendingMessagesCount{0};
+    DeadlineTimer::timer_id_t deadlineTimerId = DeadlineTimer::NO_TIMER;
 
 public:
     Pipeline(EntryNode& entry, ExitNode& exit, const std::string& name = "default_name") :
@@ -42,10 +92,56 @@ public:
         entry(entry),
         exit(exit) {}
 
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * @brief Takes ownership of the node and assigns it an id, nodes are expected to be pushed in topological order
+     */
     void push(std::unique_ptr<Node> node) {
+        node->setId(nodes.size());
         nodes.emplace_back(std::move(node));
     }
 
+    /**
+     * @brief Nodes are reset and passed to recycler when pipeline is destroyed, instead of being destroyed with it
+     */
+    void setNodesRecycler(PipelineGraphPool::recycler_t recycler) {
+        this->nodesRecycler = std::move(recycler);
+    }
+
+    /**
+     * @brief Nodes are prioritized by the estimator, which is updated with latencies measured by this pipeline
+     *
+     * Estimator has to be built for the same node ids as nodes pushed to the pipeline.
+     */
+    void setCriticalPathEstimator(std::shared_ptr<CriticalPathEstimator> criticalPath) {
+        this->criticalPath = std::move(criticalPath);
+    }
+
+    /**
+     * @brief End-to-end latency of the pipeline is recorded in metrics once it finishes
+     */
+    void setMetrics(std::shared_ptr<PipelineMetrics> metrics) {
+        this->metrics = std::move(metrics);
+    }
+
+    /**
+     * @brief Pipeline is started once admitted, waiting for admission counts into deadline
+     */
+    void setAdmission(std::shared_ptr<PipelineAdmission> admission) {
+        this->admission = std::move(admission);
+    }
+
+    /**
+     * @brief Reserves space for nodes of a pipeline with known size
+     */
+    void reserve(size_t nodesCount) {
+        nodes.reserve(nodesCount);
+    }
+
     EntryNode& getEntry() const { return this->entry; }
     ExitNode& getExit() const { return this->exit; }
 
@@ -56,13 +152,76 @@ public:
         to.addDependency(from, blobNamesMapping);
     }
 
+    /**
+     * @brief Nodes not started until deadline are not executed and pipeline fails with DEADLINE_EXCEEDED
+     */
+    void setDeadline(const deadline_t& deadline) {
+        this->deadline = deadline;
+    }
+
+    /**
+     * @brief Executes pipeline blocking the calling thread until all started nodes finish
+     */
     Status execute();
+
+    /**
+     * @brief Executes pipeline without blocking the caller, node transitions are driven by scheduler workers
+     *
+     * Pipeline has to be kept alive until onFinished is called. It is called once, from a scheduler worker,
+     * as the last use of the pipeline so it may destroy it. Deadline is checked whenever any node makes progress
+     * and once it passes, also when all nodes are waiting for streams or the pipeline waits for admission.
+     * Pipeline can be executed only once, either with execute or executeAsync.
+     *
+     * @param scheduler
+     * @param onFinished called with the pipeline execution status
+     */
+    void executeAsync(PipelineScheduler& scheduler, std::function<void(Status)> onFinished);
+
     const std::string& getName() const {
         return name;
     }
 
 private:
-    std::map<const std::string, bool> prepareStatusMap() const;
+    void markStarted(const Node& node);
+    void markFinished(const Node& node);
+    void markWaitingForIdleInferenceStreamId(const Node& node);
+    void markExecuteStarted(const Node& node);
+    void recordLatency(const Node& node);
+    void recordFinished(const Status& status);
+    /**
+     * @brief Skips the node together with all its dependants, exit node only counts skipped dependency
+     *
+     * Exit node which becomes ready this way is added to readyNodes.
+     */
+    void skip(Node& node);
+    bool allStartedFinished() const {
+        return finishedNodesCount == startedNodesCount;
+    }
+
+    Status start();
+
+    /**
+     * @brief Handles deadline and disarms deferred nodes after error
+     *
+     * @return true when pipeline execution is over
+     */
+    bool prepareNextStep();
+
+    /**
+     * @brief Handles message that node finished or deferred node got stream id
+     *
+     * @return true when pipeline execution is over
+     */
+    bool processMessage(Node& finishedNode);
+
+    /**
+     * @brief Processes messages counted in pendingMessagesCount
+     *
+     * @param messagesNotInQueueCount counted messages without element in finishedNodeQueue
+     */
+    void processPendingMessages(size_t messagesNotInQueueCount = 0);
+
+    void finishAsync(Status status);
 };
 
 }  // namespace ovms
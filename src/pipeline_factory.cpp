@@ -23,12 +23,14 @@ namespace ovms {
 Status PipelineFactory::createDefinition(const std::string& pipelineName,
     const std::vector<NodeInfo>& nodeInfos,
     const pipeline_connections_t& connections,
-    ModelManager& manager) {
+    ModelManager& manager,
+    std::optional<size_t> maxConcurrency) {
     if (definitionExists(pipelineName)) {
         SPDLOG_LOGGER_WARN(modelmanager_logger, "Two pipelines with the same name: {} defined in config file. Ignoring the second definition", pipelineName);
         return StatusCode::PIPELINE_DEFINITION_ALREADY_EXIST;
     }
     std::unique_ptr<PipelineDefinition> pipelineDefinition = std::make_unique<PipelineDefinition>(pipelineName, nodeInfos, connections);
+    pipelineDefinition->setMaxConcurrency(maxConcurrency);
 
     pipelineDefinition->makeSubscriptions(manager);
     Status validationResult = pipelineDefinition->validate(manager);
@@ -63,13 +65,14 @@ Status PipelineFactory::create(std::unique_ptr<Pipeline>& pipeline,
 Status PipelineFactory::reloadDefinition(const std::string& pipelineName,
     const std::vector<NodeInfo>&& nodeInfos,
     const pipeline_connections_t&& connections,
-    ModelManager& manager) {
+    ModelManager& manager,
+    std::optional<size_t> maxConcurrency) {
     auto pd = findDefinitionByName(pipelineName);
     if (pd == nullptr) {
         SPDLOG_LOGGER_ERROR(modelmanager_logger, "Requested to reload pipeline definition but it does not exist: {}", pipelineName);
         return StatusCode::UNKNOWN_ERROR;
     }
-    return pd->reload(manager, std::move(nodeInfos), std::move(connections));
+    return pd->reload(manager, std::move(nodeInfos), std::move(connections), maxConcurrency);
 }
 
 void PipelineFactory::revalidatePipelines(ModelManager& manager) {
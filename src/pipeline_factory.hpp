@@ -15,12 +15,15 @@
 //*****************************************************************************
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -45,7 +48,8 @@ public:
     Status createDefinition(const std::string& pipelineName,
         const std::vector<NodeInfo>& nodeInfos,
         const pipeline_connections_t& connections,
-        ModelManager& manager);
+        ModelManager& manager,
+        std::optional<size_t> maxConcurrency = std::nullopt);
 
     bool definitionExists(const std::string& name) const {
         std::shared_lock lock(definitionsMtx);
@@ -67,12 +71,23 @@ public:
             return it->second.get();
         }
     }
+    /**
+     * @brief Visits all definitions under shared lock, visitor must not create or reload definitions
+     */
+    void forEachDefinition(const std::function<void(const PipelineDefinition&)>& visitor) const {
+        std::shared_lock lock(definitionsMtx);
+        for (const auto& [name, definition] : definitions) {
+            visitor(*definition);
+        }
+    }
+
     Status reloadDefinition(const std::string& pipelineName,
         const std::vector<NodeInfo>&& nodeInfos,
         const pipeline_connections_t&& connections,
-        ModelManager& manager);
+        ModelManager& manager,
+        std::optional<size_t> maxConcurrency = std::nullopt);
 
-    void retireOtherThan(std::set<std::string>&& pipelinesInConfigFile, ModelManager& manager) {
+    void retireOtherThan(std::unordered_set<std::string>&& pipelinesInConfigFile, ModelManager& manager) {
         std::for_each(definitions.begin(),
             definitions.end(),
             [&pipelinesInConfigFile, &manager](auto& nameDefinitionPair) {
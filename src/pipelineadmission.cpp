@@ -0,0 +1,158 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "pipelineadmission.hpp"
+
+#include <utility>
+
+namespace ovms {
+
+PipelineAdmission::~PipelineAdmission() {
+    std::vector<DeadlineTimer::timer_id_t> timers;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& waiter : waiters) {
+            timers.push_back(waiter->timer);
+        }
+    }
+    // waits for expiration running meanwhile
+    for (auto timer : timers) {
+        DeadlineTimer::instance().cancel(timer);
+    }
+}
+
+void PipelineAdmission::setLimit(size_t limit) {
+    std::vector<std::shared_ptr<Waiter>> admitted;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        this->limit = limit;
+        admitted = admitWaiting();
+    }
+    notifyAdmitted(admitted);
+}
+
+size_t PipelineAdmission::getLimit() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return limit;
+}
+
+Status PipelineAdmission::acquire(const deadline_t& deadline) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (waiters.empty() && hasFreeSlot()) {
+        admittedCount++;
+        return StatusCode::OK;
+    }
+    auto waiter = std::make_shared<Waiter>();
+    waiters.push_back(waiter);
+    const auto isAdmitted = [&waiter]() { return waiter->admitted; };
+    if (deadline == NO_DEADLINE) {
+        admittedCondition.wait(lock, isAdmitted);
+    } else if (!admittedCondition.wait_until(lock, deadline, isAdmitted)) {
+        // left in the queue, skipped when its turn comes
+        waiter->cancelled = true;
+        return StatusCode::DEADLINE_EXCEEDED;
+    }
+    return StatusCode::OK;
+}
+
+void PipelineAdmission::acquireAsync(std::function<void(Status)> onAdmitted, const deadline_t& deadline) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!waiters.empty() || !hasFreeSlot()) {
+            auto waiter = std::make_shared<Waiter>();
+            waiter->onAdmitted = std::move(onAdmitted);
+            // scheduled under the lock, so that expiration sees the timer id set
+            waiter->timer = DeadlineTimer::instance().schedule(deadline, [this, waiter]() { expire(waiter); });
+            waiters.push_back(std::move(waiter));
+            return;
+        }
+        admittedCount++;
+    }
+    onAdmitted(StatusCode::OK);
+}
+
+void PipelineAdmission::expire(const std::shared_ptr<Waiter>& waiter) {
+    std::function<void(Status)> onAdmitted;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (waiter->admitted || waiter->cancelled) {
+            return;
+        }
+        // left in the queue, skipped when its turn comes
+        waiter->cancelled = true;
+        onAdmitted = std::move(waiter->onAdmitted);
+    }
+    onAdmitted(StatusCode::DEADLINE_EXCEEDED);
+}
+
+void PipelineAdmission::release() {
+    std::vector<std::shared_ptr<Waiter>> admitted;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        admittedCount--;
+        admitted = admitWaiting();
+    }
+    notifyAdmitted(admitted);
+}
+
+void PipelineAdmission::notifyAdmitted(std::vector<std::shared_ptr<Waiter>>& admitted) {
+    for (auto& waiter : admitted) {
+        // waits for expiration running meanwhile, which finds the waiter admitted
+        DeadlineTimer::instance().cancel(waiter->timer);
+        auto onAdmitted = std::move(waiter->onAdmitted);
+        onAdmitted(StatusCode::OK);
+    }
+}
+
+std::vector<std::shared_ptr<PipelineAdmission::Waiter>> PipelineAdmission::admitWaiting() {
+    std::vector<std::shared_ptr<Waiter>> admitted;
+    bool notify = false;
+    while (!waiters.empty() && hasFreeSlot()) {
+        auto waiter = std::move(waiters.front());
+        waiters.pop_front();
+        if (waiter->cancelled) {
+            continue;
+        }
+        admittedCount++;
+        waiter->admitted = true;
+        if (waiter->onAdmitted) {
+            admitted.push_back(std::move(waiter));
+        } else {
+            notify = true;
+        }
+    }
+    if (notify) {
+        admittedCondition.notify_all();
+    }
+    return admitted;
+}
+
+size_t PipelineAdmission::getAdmittedCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return admittedCount;
+}
+
+size_t PipelineAdmission::getWaitingCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t count = 0;
+    for (const auto& waiter : waiters) {
+        if (!waiter->cancelled) {
+            count++;
+        }
+    }
+    return count;
+}
+
+}  // namespace ovms
@@ -0,0 +1,121 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "deadline.hpp"
+#include "deadlinetimer.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Limits number of concurrently executed pipelines of one definition
+ *
+ * Pipelines over the limit wait in FIFO order before their entry node is executed, so admitted pipelines
+ * do not compete for infer requests with pipelines which would only hold part of the streams they need.
+ * Slot of finished pipeline is handed over to the first waiting one.
+ */
+class PipelineAdmission {
+public:
+    PipelineAdmission() = default;
+
+    /**
+     * @brief Cancels deadlines of waiting pipelines, their callbacks are not called anymore
+     */
+    ~PipelineAdmission();
+
+    PipelineAdmission(const PipelineAdmission&) = delete;
+    PipelineAdmission& operator=(const PipelineAdmission&) = delete;
+
+    /**
+     * @brief Sets maximum number of admitted pipelines, 0 means unlimited
+     *
+     * Raised limit admits waiting pipelines right away, lowered one lets admitted pipelines finish.
+     */
+    void setLimit(size_t limit);
+
+    size_t getLimit() const;
+
+    /**
+     * @brief Blocks calling thread until pipeline is admitted
+     *
+     * @param deadline waiting is given up once it passes
+     *
+     * @return Status DEADLINE_EXCEEDED when pipeline was not admitted before deadline
+     */
+    Status acquire(const deadline_t& deadline = NO_DEADLINE);
+
+    /**
+     * @brief Admits pipeline without blocking
+     *
+     * @param onAdmitted called with OK right away when slot is free or by the thread releasing slot for this pipeline,
+     * called with DEADLINE_EXCEEDED on DeadlineTimer thread when deadline passes first
+     * @param deadline waiting is given up once it passes
+     */
+    void acquireAsync(std::function<void(Status)> onAdmitted, const deadline_t& deadline = NO_DEADLINE);
+
+    /**
+     * @brief Returns slot of finished pipeline
+     */
+    void release();
+
+    size_t getAdmittedCount() const;
+
+    size_t getWaitingCount() const;
+
+private:
+    struct Waiter {
+        // empty for waiters blocked in acquire
+        std::function<void(Status)> onAdmitted;
+        DeadlineTimer::timer_id_t timer = DeadlineTimer::NO_TIMER;
+        bool admitted = false;
+        bool cancelled = false;
+    };
+
+    /**
+     * @brief Hands free slots to waiters, admitted asynchronous waiters are returned to be called without holding the lock
+     */
+    std::vector<std::shared_ptr<Waiter>> admitWaiting();
+
+    /**
+     * @brief Cancels deadlines of admitted waiters and calls them
+     */
+    static void notifyAdmitted(std::vector<std::shared_ptr<Waiter>>& admitted);
+
+    /**
+     * @brief Gives up waiting of asynchronous waiter which was not admitted yet, called by DeadlineTimer
+     */
+    void expire(const std::shared_ptr<Waiter>& waiter);
+
+    bool hasFreeSlot() const {
+        return limit == 0 || admittedCount < limit;
+    }
+
+    mutable std::mutex mtx;
+    std::condition_variable admittedCondition;
+    std::deque<std::shared_ptr<Waiter>> waiters;
+    size_t limit = 0;
+    size_t admittedCount = 0;
+};
+
+}  // namespace ovms
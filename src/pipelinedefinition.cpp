@@ -15,10 +15,19 @@
 //*****************************************************************************
 #include "pipelinedefinition.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <map>
 #include <set>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "demultiplexer_node.hpp"
+#include "fused_node.hpp"
 #include "logging.hpp"
 #include "pipelinedefinitionunloadguard.hpp"
 #include "prediction_service_utils.hpp"
@@ -30,10 +39,47 @@ Status toNodeKind(const std::string& str, NodeKind& nodeKind) {
         nodeKind = NodeKind::DL;
         return StatusCode::OK;
     }
+    if (str == DEMULTIPLEXER_NODE_CONFIG_TYPE) {
+        nodeKind = NodeKind::DEMULTIPLEXER;
+        return StatusCode::OK;
+    }
+    if (str == CUSTOM_NODE_CONFIG_TYPE) {
+        nodeKind = NodeKind::CUSTOM;
+        return StatusCode::OK;
+    }
+    if (str == GATE_NODE_CONFIG_TYPE) {
+        nodeKind = NodeKind::GATE;
+        return StatusCode::OK;
+    }
     SPDLOG_LOGGER_ERROR(modelmanager_logger, "Unsupported node type: {}", str);
     return StatusCode::PIPELINE_NODE_WRONG_KIND_CONFIGURATION;
 }
 
+bool NodeInfo::operator==(const NodeInfo& other) const {
+    return kind == other.kind &&
+           nodeName == other.nodeName &&
+           modelName == other.modelName &&
+           modelVersion == other.modelVersion &&
+           outputNameAliases == other.outputNameAliases &&
+           library.execute == other.library.execute &&
+           library.release == other.library.release &&
+           parameters == other.parameters &&
+           condition == other.condition &&
+           resultCacheSize == other.resultCacheSize &&
+           demultiplexedNodes == other.demultiplexedNodes &&
+           demultiplexedConnections == other.demultiplexedConnections;
+}
+
+NodeInfo NodeInfo::getGatheredOutputsInfo() const {
+    if (demultiplexedNodes.empty()) {
+        return *this;
+    }
+    NodeInfo gathered = demultiplexedNodes.back();
+    gathered.kind = kind;
+    gathered.nodeName = nodeName;
+    return gathered;
+}
+
 Status PipelineDefinition::validate(ModelManager& manager) {
     SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Started validation of pipeline: {}", getName());
     ValidationResultNotifier notifier(status, loadedNotify);
@@ -52,18 +98,278 @@ Status PipelineDefinition::validate(ModelManager& manager) {
     if (!validationResult.ok()) {
         return validationResult;
     }
+    compileExecutionPlan();
+    if (manager.isPipelineModelsFusionEnabled()) {
+        fuseModelChains(manager);
+    } else {
+        fusedNetworks.clear();
+    }
+    markDeviceResidentOutputs(manager);
+    updateAdmissionLimit(manager);
+    publishGeneration();
     notifier.passed = true;
     SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Finished validation of pipeline: {}", getName());
     return validationResult;
 }
 
-Status PipelineDefinition::reload(ModelManager& manager, const std::vector<NodeInfo>&& nodeInfos, const pipeline_connections_t&& connections) {
+bool PipelineDefinition::isUpToDate(const ModelManager& manager, const std::vector<NodeInfo>& nodeInfos, const pipeline_connections_t& connections) const {
+    if (status.getStateCode() != PipelineDefinitionStateCode::AVAILABLE) {
+        return false;
+    }
+    if (this->nodeInfos != nodeInfos || this->connections != connections) {
+        return false;
+    }
+    for (const auto& info : this->nodeInfos) {
+        if (!isModelNodeKind(info.kind)) {
+            continue;
+        }
+        auto instance = manager.findModelInstance(info.modelName, info.modelVersion.value_or(0));
+        if (!instance || instance->getStatus().getState() != ModelVersionState::AVAILABLE) {
+            return false;
+        }
+        for (const auto& demultiplexedInfo : info.demultiplexedNodes) {
+            auto demultiplexedInstance = manager.findModelInstance(demultiplexedInfo.modelName, demultiplexedInfo.modelVersion.value_or(0));
+            if (!demultiplexedInstance || demultiplexedInstance->getStatus().getState() != ModelVersionState::AVAILABLE) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void PipelineDefinition::updateAdmissionLimit(ModelManager& manager) {
+    if (!maxConcurrency) {
+        admission->setLimit(0);
+        return;
+    }
+    size_t limit = maxConcurrency.value();
+    if (limit == PIPELINE_MAX_CONCURRENCY_AUTO) {
+        std::map<std::pair<std::string, model_version_t>, size_t> modelNodesCount;
+        for (const auto& step : executionPlan.steps) {
+            const auto& info = nodeInfos[step.nodeInfoIndex];
+            if (!isModelNodeKind(info.kind)) {
+                continue;
+            }
+            // fused chain holds one infer request of its own network instead of requests of its models
+            if (step.fusedNetwork) {
+                const size_t fusedLimit = std::max<size_t>(1, step.fusedNetwork->getInferRequestsQueue().getInferRequestsCount());
+                limit = limit == 0 ? fusedLimit : std::min(limit, fusedLimit);
+                continue;
+            }
+            modelNodesCount[{info.modelName, info.modelVersion.value_or(0)}]++;
+            for (const auto& demultiplexedInfo : info.demultiplexedNodes) {
+                modelNodesCount[{demultiplexedInfo.modelName, demultiplexedInfo.modelVersion.value_or(0)}]++;
+            }
+        }
+        for (const auto& [model, nodesCount] : modelNodesCount) {
+            std::shared_ptr<ModelInstance> instance;
+            std::unique_ptr<ModelInstanceUnloadGuard> unloadGuard;
+            if (!getModelInstance(manager, model.first, model.second, instance, unloadGuard).ok()) {
+                continue;
+            }
+            const size_t modelLimit = std::max<size_t>(1, instance->getInferRequestsQueue().getInferRequestsCount() / nodesCount);
+            limit = limit == 0 ? modelLimit : std::min(limit, modelLimit);
+        }
+    }
+    SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Pipeline: {} admits {} concurrent executions", getName(), limit == 0 ? "unlimited" : std::to_string(limit));
+    admission->setLimit(limit);
+}
+
+void PipelineDefinition::markDeviceResidentOutputs(ModelManager& manager) {
+    auto& steps = executionPlan.steps;
+    // empty device marks nodes which cannot take or give device blobs
+    std::vector<std::string> devices(steps.size());
+    for (size_t nodeId = 0; nodeId < steps.size(); ++nodeId) {
+        const auto& info = nodeInfos[steps[nodeId].nodeInfoIndex];
+        // cached results and dynamically batched requests are read on the host, as are results of fused networks
+        if (info.kind != NodeKind::DL || info.resultCacheSize > 0 || steps[nodeId].fusedNetwork) {
+            continue;
+        }
+        std::shared_ptr<ModelInstance> instance;
+        std::unique_ptr<ModelInstanceUnloadGuard> unloadGuard;
+        if (!getModelInstance(manager, info.modelName, info.modelVersion.value_or(0), instance, unloadGuard).ok()) {
+            continue;
+        }
+        if (instance->getTargetDevice().rfind("GPU", 0) == 0 && instance->getDynamicBatcher() == nullptr &&
+            instance->getInferRequestsQueue().getDeviceOutputBlobPool() != nullptr) {
+            devices[nodeId] = instance->getTargetDevice();
+        }
+    }
+    // model output of each node mapped to whether all of its readers are on the same device
+    std::vector<std::map<std::string, bool>> residentOutputs(steps.size());
+    for (size_t nodeId = 0; nodeId < steps.size(); ++nodeId) {
+        for (const auto& dependency : steps[nodeId].dependencies) {
+            const auto& producerInfo = nodeInfos[steps[dependency.nodeId].nodeInfoIndex];
+            const bool sameDevice = !devices[dependency.nodeId].empty() && devices[dependency.nodeId] == devices[nodeId];
+            for (const auto& [alias, inputName] : dependency.mapping) {
+                auto aliasIt = producerInfo.outputNameAliases.find(alias);
+                const auto& modelOutputName = aliasIt == producerInfo.outputNameAliases.end() ? alias : aliasIt->second;
+                auto it = residentOutputs[dependency.nodeId].emplace(modelOutputName, sameDevice).first;
+                it->second = it->second && sameDevice;
+            }
+        }
+    }
+    for (size_t nodeId = 0; nodeId < steps.size(); ++nodeId) {
+        steps[nodeId].deviceResidentOutputs.clear();
+        for (const auto& [modelOutputName, resident] : residentOutputs[nodeId]) {
+            if (resident) {
+                steps[nodeId].deviceResidentOutputs.insert(modelOutputName);
+                SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Pipeline: {}; node: {}; output: {} is passed in {} memory",
+                    getName(), nodeInfos[steps[nodeId].nodeInfoIndex].nodeName, modelOutputName, devices[nodeId]);
+            }
+        }
+    }
+}
+
+void PipelineDefinition::fuseModelChains(ModelManager& manager) {
+    auto& steps = executionPlan.steps;
+    std::vector<std::shared_ptr<ModelInstance>> models(steps.size());
+    std::vector<std::unique_ptr<ModelInstanceUnloadGuard>> unloadGuards(steps.size());
+    std::vector<std::vector<size_t>> dependantIds(steps.size());
+    for (size_t nodeId = 0; nodeId < steps.size(); ++nodeId) {
+        for (const auto& dependency : steps[nodeId].dependencies) {
+            dependantIds[dependency.nodeId].push_back(nodeId);
+        }
+        const auto& info = nodeInfos[steps[nodeId].nodeInfoIndex];
+        // cached nodes skip inference of their model, they are kept separate
+        if (info.kind != NodeKind::DL || info.resultCacheSize > 0) {
+            continue;
+        }
+        if (!getModelInstance(manager, info.modelName, info.modelVersion.value_or(0), models[nodeId], unloadGuards[nodeId]).ok() ||
+            !FusedNetwork::isFusible(*models[nodeId])) {
+            models[nodeId].reset();
+            unloadGuards[nodeId].reset();
+        }
+    }
+    auto continuesChain = [&](size_t producer, size_t& consumer) {
+        if (dependantIds[producer].size() != 1) {
+            return false;
+        }
+        consumer = dependantIds[producer][0];
+        return models[consumer] != nullptr && steps[consumer].dependencies.size() == 1 &&
+               models[producer]->getTargetDevice() == models[consumer]->getTargetDevice() &&
+               models[producer]->getModelConfig().getPluginConfig() == models[consumer]->getModelConfig().getPluginConfig();
+    };
+    std::vector<bool> visited(steps.size(), false);
+    // chain head is removed from the plan together with all other members but the tail, which infers fused network
+    std::vector<bool> fusedAway(steps.size(), false);
+    std::map<size_t, std::pair<size_t, std::shared_ptr<FusedNetwork>>> fusedTails;
+    std::vector<std::shared_ptr<FusedNetwork>> validatedNetworks;
+    for (size_t head = 0; head < steps.size(); ++head) {
+        if (!models[head] || visited[head]) {
+            continue;
+        }
+        std::vector<size_t> chain{head};
+        size_t next = 0;
+        while (continuesChain(chain.back(), next)) {
+            chain.push_back(next);
+        }
+        std::vector<FusedNetwork::Stage> stages;
+        for (size_t i = 0; i < chain.size(); ++i) {
+            visited[chain[i]] = true;
+            const auto& info = nodeInfos[steps[chain[i]].nodeInfoIndex];
+            stages.push_back({info.nodeName, models[chain[i]], info.outputNameAliases, i == 0 ? InputPairs{} : steps[chain[i]].dependencies[0].mapping});
+        }
+        if (chain.size() < 2) {
+            continue;
+        }
+        auto reused = std::find_if(fusedNetworks.begin(), fusedNetworks.end(), [&stages](const auto& network) { return network->isCompiledFrom(stages); });
+        std::shared_ptr<FusedNetwork> fused;
+        if (reused != fusedNetworks.end()) {
+            fused = *reused;
+            SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Pipeline: {} reuses fused network: {}", getName(), fused->getName());
+        } else {
+            auto status = createFusedNetwork(stages, fused);
+            if (!status.ok()) {
+                SPDLOG_LOGGER_WARN(modelmanager_logger, "Pipeline: {} nodes starting at: {} are inferred separately, fusing failed: {}",
+                    getName(), stages.front().nodeName, status.string());
+                continue;
+            }
+        }
+        validatedNetworks.push_back(fused);
+        for (size_t i = 0; i + 1 < chain.size(); ++i) {
+            fusedAway[chain[i]] = true;
+        }
+        fusedTails.emplace(chain.back(), std::make_pair(head, std::move(fused)));
+    }
+    // networks of chains which changed are released once pipelines of the previous generation are destroyed
+    fusedNetworks = std::move(validatedNetworks);
+    if (fusedTails.empty()) {
+        return;
+    }
+    // tail keeps its position, dependencies of the head precede it in topological order
+    std::vector<size_t> newIds(steps.size());
+    std::vector<PipelineExecutionPlan::Step> fusedSteps;
+    for (size_t nodeId = 0; nodeId < steps.size(); ++nodeId) {
+        if (fusedAway[nodeId]) {
+            continue;
+        }
+        newIds[nodeId] = fusedSteps.size();
+        auto step = std::move(steps[nodeId]);
+        auto it = fusedTails.find(nodeId);
+        if (it != fusedTails.end()) {
+            step.dependencies = steps[it->second.first].dependencies;
+            step.fusedNetwork = it->second.second;
+        }
+        fusedSteps.push_back(std::move(step));
+    }
+    for (auto& step : fusedSteps) {
+        for (auto& dependency : step.dependencies) {
+            dependency.nodeId = newIds[dependency.nodeId];
+        }
+    }
+    steps = std::move(fusedSteps);
+    executionPlan.entryNodeId = newIds[executionPlan.entryNodeId];
+    executionPlan.exitNodeId = newIds[executionPlan.exitNodeId];
+    std::vector<std::vector<size_t>> fusedDependantIds(steps.size());
+    for (size_t nodeId = 0; nodeId < steps.size(); ++nodeId) {
+        for (const auto& dependency : steps[nodeId].dependencies) {
+            fusedDependantIds[dependency.nodeId].push_back(nodeId);
+        }
+    }
+    executionPlan.criticalPath = std::make_shared<CriticalPathEstimator>(std::move(fusedDependantIds));
+    SPDLOG_LOGGER_INFO(modelmanager_logger, "Pipeline: {} infers {} fused networks, {} nodes left", getName(), fusedTails.size(), steps.size());
+}
+
+void PipelineDefinition::publishGeneration() {
+    // node ids change, graphs built by previous generation are dropped together with it
+    auto generation = std::make_shared<PipelineDefinitionGeneration>();
+    generation->nodeInfos = nodeInfos;
+    generation->connections = connections;
+    generation->executionPlan = executionPlan;
+    generation->graphPool = std::make_shared<PipelineGraphPool>(MAX_IDLE_PIPELINE_GRAPHS_COUNT);
+    std::atomic_store(&servedGeneration, std::shared_ptr<const PipelineDefinitionGeneration>(std::move(generation)));
+    metadataCache.invalidate();
+}
+
+Status PipelineDefinition::reload(ModelManager& manager, const std::vector<NodeInfo>&& nodeInfos, const pipeline_connections_t&& connections,
+    std::optional<size_t> maxConcurrency) {
+    this->maxConcurrency = maxConcurrency;
+    if (isUpToDate(manager, nodeInfos, connections)) {
+        updateAdmissionLimit(manager);
+        // validation result is kept, so are compiled execution plan, idle graphs and cached results
+        SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Pipeline: {} definition and used models did not change, skipping revalidation", getName());
+        return StatusCode::OK;
+    }
+    if (status.isAvailable()) {
+        // Available definition keeps serving requests with its current generation while the new one is validated.
+        // Requests are blocked only if validation fails.
+        this->status.handle(UsedModelChangedEvent("definition reload"));
+        resetSubscriptions(manager);
+        metadataCache.invalidate();
+        this->nodeInfos = std::move(nodeInfos);
+        this->connections = std::move(connections);
+        makeSubscriptions(manager);
+        auto validationResult = validate(manager);
+        // requests started before are drained, so that reload returns once previous definition is not used anymore
+        waitForPreviousRequestsHandlesReleased();
+        return validationResult;
+    }
     // block creating new unloadGuards
     this->status.handle(ReloadEvent());
     resetSubscriptions(manager);
-    while (requestsHandlesCounter > 0) {
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
-    }
+    metadataCache.invalidate();
+    waitForRequestsHandlesReleased();
 
     this->nodeInfos = std::move(nodeInfos);
     this->connections = std::move(connections);
@@ -72,14 +378,33 @@ Status PipelineDefinition::reload(ModelManager& manager, const std::vector<NodeI
     return validate(manager);
 }
 
+void PipelineDefinition::waitForRequestsHandlesReleased() {
+    std::unique_lock<std::mutex> lock(requestsFinishedMutex);
+    ++requestsFinishedWaiters;
+    requestsFinishedNotify.wait(lock, [this]() { return requestsHandlesCounter == 0; });
+    --requestsFinishedWaiters;
+}
+
+void PipelineDefinition::waitForPreviousRequestsHandlesReleased() {
+    std::unique_lock<std::mutex> lock(requestsFinishedMutex);
+    // handles taken after the switch see the generation published by validation
+    const size_t previousPeriod = requestsHandlesPeriod.load();
+    requestsHandlesPeriod.store(1 - previousPeriod);
+    ++requestsFinishedWaiters;
+    requestsFinishedNotify.wait(lock, [this, previousPeriod]() { return requestsHandlesPeriodCounters[previousPeriod] == 0; });
+    --requestsFinishedWaiters;
+}
+
 void PipelineDefinition::retire(ModelManager& manager) {
     resetSubscriptions(manager);
+    metadataCache.invalidate();
     this->status.handle(RetireEvent());
-    while (requestsHandlesCounter > 0) {
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
-    }
+    waitForRequestsHandlesReleased();
     this->nodeInfos.clear();
     this->connections.clear();
+    this->executionPlan.steps.clear();
+    this->executionPlan.criticalPath.reset();
+    std::atomic_store(&servedGeneration, std::shared_ptr<const PipelineDefinitionGeneration>());
 }
 
 Status PipelineDefinition::waitForLoaded(std::unique_ptr<PipelineDefinitionUnloadGuard>& unloadGuard, const uint waitForLoadedTimeoutMicroseconds) {
@@ -132,53 +457,138 @@ Status PipelineDefinition::create(std::unique_ptr<Pipeline>& pipeline,
     const tensorflow::serving::PredictRequest* request,
     tensorflow::serving::PredictResponse* response,
     ModelManager& manager) {
-    std::unique_ptr<PipelineDefinitionUnloadGuard> unloadGuard;
-    Status status = waitForLoaded(unloadGuard);
-    if (!status.ok()) {
-        return status;
-    }
+    return create(
+        pipeline,
+        [request](EntryNode& entry) { entry.bind(request); },
+        [request, response](ExitNode& exit) { exit.bind(response, &request->output_filter()); },
+        manager);
+}
+
+Status PipelineDefinition::create(std::unique_ptr<Pipeline>& pipeline,
+    const BlobMap* inputBlobs,
+    BlobMap* outputBlobs,
+    ModelManager& manager) {
+    return create(
+        pipeline,
+        [inputBlobs](EntryNode& entry) { entry.bind(inputBlobs); },
+        [outputBlobs](ExitNode& exit) { exit.bind(outputBlobs); },
+        manager);
+}
 
-    std::unordered_map<std::string, std::unique_ptr<Node>> nodes;
-    EntryNode* entry = nullptr;
-    ExitNode* exit = nullptr;
-    for (const auto& info : nodeInfos) {
+void PipelineDefinition::buildGraph(const PipelineDefinitionGeneration& generation, pipeline_nodes_t& nodes, ModelManager& manager) const {
+    const auto& executionPlan = generation.executionPlan;
+    nodes.reserve(executionPlan.steps.size());
+    for (const auto& step : executionPlan.steps) {
+        const auto& info = generation.nodeInfos[step.nodeInfoIndex];
         SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Creating pipeline: {}. Adding nodeName: {}, modelName: {}",
             getName(), info.nodeName, info.modelName);
         switch (info.kind) {
-        case NodeKind::ENTRY: {
-            auto node = std::make_unique<EntryNode>(request);
-            entry = node.get();
-            nodes.insert(std::make_pair(info.nodeName, std::move(node)));
+        case NodeKind::ENTRY:
+            nodes.emplace_back(std::make_unique<EntryNode>());
             break;
-        }
-        case NodeKind::DL:
-            nodes.insert(std::make_pair(info.nodeName, std::move(std::make_unique<DLNode>(info.nodeName,
-                                                           info.modelName,
-                                                           info.modelVersion,
-                                                           manager,
-                                                           info.outputNameAliases))));
+        case NodeKind::DL: {
+            if (step.fusedNetwork) {
+                nodes.emplace_back(std::make_unique<FusedNode>(info.nodeName, step.fusedNetwork, info.outputNameAliases));
+                break;
+            }
+            auto node = std::make_unique<DLNode>(info.nodeName,
+                info.modelName,
+                info.modelVersion,
+                manager,
+                info.outputNameAliases);
+            node->setResultCache(step.resultCache);
+            node->setDeviceResidentOutputs(step.deviceResidentOutputs);
+            node->setInferRequestsPool(getName());
+            nodes.emplace_back(std::move(node));
             break;
-        case NodeKind::EXIT: {
-            auto node = std::make_unique<ExitNode>(response);
-            exit = node.get();
-            nodes.insert(std::make_pair(info.nodeName, std::move(node)));
+        }
+        case NodeKind::DEMULTIPLEXER: {
+            std::vector<DemultiplexedStep> steps;
+            steps.reserve(info.demultiplexedNodes.size());
+            for (const auto& demultiplexedInfo : info.demultiplexedNodes) {
+                DemultiplexedStep step{demultiplexedInfo.nodeName, demultiplexedInfo.modelName, demultiplexedInfo.modelVersion, demultiplexedInfo.outputNameAliases, {}};
+                auto it = info.demultiplexedConnections.find(demultiplexedInfo.nodeName);
+                if (it != info.demultiplexedConnections.end()) {
+                    step.dependencies.assign(it->second.begin(), it->second.end());
+                }
+                steps.push_back(std::move(step));
+            }
+            nodes.emplace_back(std::make_unique<DemultiplexerNode>(info.nodeName,
+                info.modelName,
+                info.modelVersion,
+                manager,
+                info.outputNameAliases,
+                std::move(steps)));
             break;
         }
+        case NodeKind::CUSTOM:
+            nodes.emplace_back(std::make_unique<CustomNode>(info.nodeName,
+                info.library,
+                info.parameters,
+                info.outputNameAliases));
+            break;
+        case NodeKind::GATE:
+            nodes.emplace_back(std::make_unique<GateNode>(info.nodeName,
+                info.condition,
+                info.outputNameAliases));
+            break;
+        case NodeKind::EXIT:
+            nodes.emplace_back(std::make_unique<ExitNode>());
+            break;
         default:
             throw std::invalid_argument("unknown node kind");
         }
+        nodes.back()->setMetrics(step.metrics);
     }
-    for (const auto& kv : connections) {
-        const auto& dependantNode = nodes.at(kv.first);
-        for (const auto& pair : kv.second) {
-            const auto& dependencyNode = nodes.at(pair.first);
-            SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Connecting pipeline: {}, from: {}, to: {}", getName(), dependencyNode->getName(), dependantNode->getName());
-            Pipeline::connect(*dependencyNode, *dependantNode, pair.second);
+    for (size_t nodeId = 0; nodeId < executionPlan.steps.size(); ++nodeId) {
+        auto& dependantNode = *nodes[nodeId];
+        for (const auto& dependency : executionPlan.steps[nodeId].dependencies) {
+            auto& dependencyNode = *nodes[dependency.nodeId];
+            SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Connecting pipeline: {}, from: {}, to: {}", getName(), dependencyNode.getName(), dependantNode.getName());
+            Pipeline::connect(dependencyNode, dependantNode, dependency.mapping);
         }
     }
-    pipeline = std::make_unique<Pipeline>(*entry, *exit, pipelineName);
-    for (auto& kv : nodes) {
-        pipeline->push(std::move(kv.second));
+}
+
+Status PipelineDefinition::create(std::unique_ptr<Pipeline>& pipeline,
+    const std::function<void(EntryNode&)>& bindEntry,
+    const std::function<void(ExitNode&)>& bindExit,
+    ModelManager& manager) {
+    std::unique_ptr<PipelineDefinitionUnloadGuard> unloadGuard;
+    Status status = waitForLoaded(unloadGuard);
+    if (!status.ok()) {
+        return status;
+    }
+
+    // pipeline is built from the generation taken here, even if reload publishes a new one meanwhile
+    auto generation = getServedGeneration();
+    if (!generation) {
+        SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Pipeline: {} was not validated yet", getName());
+        return StatusCode::PIPELINE_DEFINITION_NOT_LOADED_YET;
+    }
+    const auto& executionPlan = generation->executionPlan;
+    auto recycler = generation->graphPool->getRecycler();
+    pipeline_nodes_t nodes;
+    if (generation->graphPool->tryAcquire(nodes)) {
+        SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Creating pipeline: {}. Reusing nodes of finished pipeline", getName());
+    } else {
+        buildGraph(*generation, nodes, manager);
+    }
+    // nodes are kept in execution plan order, so entry and exit are found by id
+    auto& entry = static_cast<EntryNode&>(*nodes[executionPlan.entryNodeId]);
+    auto& exit = static_cast<ExitNode&>(*nodes[executionPlan.exitNodeId]);
+    bindEntry(entry);
+    bindExit(exit);
+    pipeline = std::make_unique<Pipeline>(entry, exit, pipelineName);
+    pipeline->reserve(nodes.size());
+    for (auto& node : nodes) {
+        pipeline->push(std::move(node));
+    }
+    pipeline->setNodesRecycler(std::move(recycler));
+    pipeline->setCriticalPathEstimator(executionPlan.criticalPath);
+    pipeline->setMetrics(metrics);
+    if (admission->getLimit() > 0) {
+        pipeline->setAdmission(admission);
     }
     return status;
 }
@@ -208,9 +618,18 @@ static std::string createSubscriptionErrorMessage(const std::string& pipelineNam
     return ss.str();
 }
 
+static bool areShapesEqualExceptDim0(const shape_t& lhs, const shape_t& rhs) {
+    return lhs.size() == rhs.size() && (lhs.empty() || std::equal(lhs.begin() + 1, lhs.end(), rhs.begin() + 1));
+}
+
 void PipelineDefinition::makeSubscriptions(ModelManager& manager) {
-    for (auto& node : nodeInfos) {
-        if (node.kind == NodeKind::DL) {
+    std::vector<std::reference_wrapper<const NodeInfo>> modelNodes;
+    for (const auto& node : nodeInfos) {
+        modelNodes.emplace_back(node);
+        modelNodes.insert(modelNodes.end(), node.demultiplexedNodes.begin(), node.demultiplexedNodes.end());
+    }
+    for (const NodeInfo& node : modelNodes) {
+        if (isModelNodeKind(node.kind)) {
             if (subscriptions.find({node.modelName, node.modelVersion.value_or(0)}) != subscriptions.end()) {
                 continue;
             }
@@ -312,6 +731,14 @@ public:
                 dependantNodeInfo.modelName);
             return StatusCode::FORBIDDEN_MODEL_DYNAMIC_PARAMETER;
         }
+        // pipeline requests do not carry sequence inputs, memory states of streams would be shared between them
+        if (config.isStateful()) {
+            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Validation of pipeline({}) definition failed. Node name {} used stateful model name {} which is forbidden.",
+                pipelineName,
+                dependantNodeInfo.nodeName,
+                dependantNodeInfo.modelName);
+            return StatusCode::FORBIDDEN_MODEL_DYNAMIC_PARAMETER;
+        }
         return StatusCode::OK;
     }
 
@@ -327,7 +754,7 @@ public:
         }
 
         // If dependency node is of type DL model, make sure there is underlying model output present.
-        if (dependencyNodeInfo.kind == NodeKind::DL) {
+        if (isModelNodeKind(dependencyNodeInfo.kind)) {
             // Check whether underlying model contains required output.
             const auto& modelOutputName = dependencyNodeInfo.outputNameAliases.at(dataSource);
             if (dependencyModelInstance->getOutputsInfo().count(modelOutputName) == 0) {
@@ -349,14 +776,20 @@ public:
         // check if both input/output exist and its metadata (shape, precision) matches.
         const auto& tensorInput = dependantModelInstance->getInputsInfo().at(modelInputName);
         const auto& tensorOutput = dependencyModelInstance->getOutputsInfo().at(modelOutputName);
-        if (tensorInput->getShape() != tensorOutput->getShape()) {
+        // Inputs transposed by the server expect NHWC data from dependency
+        const auto& inputShape = tensorInput->getRequestShape();
+        const auto& outputShape = tensorOutput->getShape();
+        // Demultiplexer splits and gathers data along 0th dimension, only remaining dimensions have to match
+        const bool isDemultiplexed = dependantNodeInfo.kind == NodeKind::DEMULTIPLEXER || dependencyNodeInfo.kind == NodeKind::DEMULTIPLEXER;
+        const bool shapesMatch = isDemultiplexed ? areShapesEqualExceptDim0(inputShape, outputShape) : inputShape == outputShape;
+        if (!shapesMatch) {
             SPDLOG_LOGGER_ERROR(modelmanager_logger, "Validation of pipeline({}) definition failed. Shape mismatch between: dependant node:{}; model:{}; version:{}; input:{}; shape:{} vs dependency node:{}; model:{}; version:{}; output:{}; shape:{}",
                 pipelineName,
                 dependantNodeInfo.nodeName,
                 dependantNodeInfo.modelName,
                 dependantNodeInfo.modelVersion.value_or(0),
                 modelInputName,
-                TensorInfo::shapeToString(tensorInput->getShape()),
+                TensorInfo::shapeToString(tensorInput->getRequestShape()),
                 dependencyNodeInfo.nodeName,
                 dependencyNodeInfo.modelName,
                 dependencyNodeInfo.modelVersion.value_or(0),
@@ -439,11 +872,11 @@ public:
     }
 
     Status validateConnection(const NodeInfo& dependencyNodeInfo, const InputPairs& mapping) {
-        // At this point dependency node can only be either DL model node or entry node.
+        // At this point dependency node can only be either model node, custom node or entry node.
         // Take care when adding new node types.
         std::unique_ptr<ModelInstanceUnloadGuard> dependencyModelUnloadGuard;
         std::shared_ptr<ModelInstance> dependencyModelInstance;
-        if (dependencyNodeInfo.kind == NodeKind::DL) {
+        if (isModelNodeKind(dependencyNodeInfo.kind)) {
             if (!getModelInstance(
                     manager,
                     dependencyNodeInfo.modelName,
@@ -460,7 +893,7 @@ public:
         }
 
         for (const auto& [alias, realName] : mapping) {
-            if (dependantNodeInfo.kind == NodeKind::DL) {
+            if (isModelNodeKind(dependantNodeInfo.kind)) {
                 auto result = markModelInputAsConnected(realName);
                 if (!result.ok()) {
                     return result;
@@ -472,7 +905,7 @@ public:
                 return result;
             }
 
-            if (dependantNodeInfo.kind == NodeKind::DL && dependencyNodeInfo.kind == NodeKind::DL) {
+            if (isModelNodeKind(dependantNodeInfo.kind) && isModelNodeKind(dependencyNodeInfo.kind)) {
                 result = checkConnectionMetadataCorrectness(dependencyNodeInfo, dependencyModelInstance, realName, dependencyNodeInfo.outputNameAliases.at(alias));
                 if (!result.ok()) {
                     return result;
@@ -483,8 +916,48 @@ public:
         return StatusCode::OK;
     }
 
+    Status checkGateInputsConnected() {
+        // Gate evaluates and passes through only its own inputs
+        std::set<std::string> connectedInputs;
+        if (connections.count(dependantNodeInfo.nodeName) > 0) {
+            for (const auto& [dependencyNodeName, mapping] : connections.at(dependantNodeInfo.nodeName)) {
+                for (const auto& [alias, realName] : mapping) {
+                    connectedInputs.insert(realName);
+                }
+            }
+        }
+        std::vector<std::string> requiredInputs{dependantNodeInfo.condition.input};
+        for (const auto& [alias, realName] : dependantNodeInfo.outputNameAliases) {
+            requiredInputs.push_back(realName);
+        }
+        for (const auto& input : requiredInputs) {
+            if (connectedInputs.count(input) == 0) {
+                SPDLOG_LOGGER_ERROR(modelmanager_logger, "Validation of pipeline({}) definition failed. Gate node: {} refers to not connected input: {}",
+                    pipelineName,
+                    dependantNodeInfo.nodeName,
+                    input);
+                return StatusCode::PIPELINE_GATE_REFERING_TO_MISSING_INPUT;
+            }
+        }
+        return StatusCode::OK;
+    }
+
     Status validate() {
-        if (dependantNodeInfo.kind == NodeKind::DL) {
+        if (dependantNodeInfo.kind == NodeKind::GATE) {
+            auto result = checkGateInputsConnected();
+            if (!result.ok()) {
+                return result;
+            }
+        }
+
+        if (dependantNodeInfo.kind == NodeKind::CUSTOM && !dependantNodeInfo.library.isValid()) {
+            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Validation of pipeline({}) definition failed. Custom node: {} refers to library which is not loaded",
+                pipelineName,
+                dependantNodeInfo.nodeName);
+            return StatusCode::PIPELINE_DEFINITION_INVALID_NODE_LIBRARY;
+        }
+
+        if (isModelNodeKind(dependantNodeInfo.kind)) {
             auto result = fetchUnderlyingModelInstance();
             if (!result.ok()) {
                 return result;
@@ -510,7 +983,8 @@ public:
                     return result;
                 }
 
-                result = validateConnection(*dependencyNodeInfo, mapping);
+                // dependants of demultiplexer node receive gathered outputs of its last demultiplexed node
+                result = validateConnection(dependencyNodeInfo->getGatheredOutputsInfo(), mapping);
                 if (!result.ok()) {
                     return result;
                 }
@@ -521,9 +995,115 @@ public:
     }
 };
 
+/**
+ * @brief Validates model nodes inferred for each element of demultiplexer node. Each of them is validated as a model node
+ * of a graph consisting of the demultiplexer node inferring single element and preceding demultiplexed nodes.
+ */
+static Status validateDemultiplexedNodes(const std::string& pipelineName, ModelManager& manager, const NodeInfo& demultiplexerInfo) {
+    std::vector<NodeInfo> elementNodeInfos;
+    elementNodeInfos.reserve(demultiplexerInfo.demultiplexedNodes.size() + 1);
+    elementNodeInfos.push_back(NodeInfo(NodeKind::DL, demultiplexerInfo.nodeName, demultiplexerInfo.modelName, demultiplexerInfo.modelVersion, demultiplexerInfo.outputNameAliases));
+    for (const auto& demultiplexedInfo : demultiplexerInfo.demultiplexedNodes) {
+        const auto sameName = [&demultiplexedInfo](const NodeInfo& info) { return info.nodeName == demultiplexedInfo.nodeName; };
+        if (std::any_of(elementNodeInfos.begin(), elementNodeInfos.end(), sameName)) {
+            SPDLOG_LOGGER_ERROR(modelmanager_logger, "Validation of pipeline({}) definition failed. Demultiplexer node: {} has multiple nodes with name: {}",
+                pipelineName, demultiplexerInfo.nodeName, demultiplexedInfo.nodeName);
+            return StatusCode::PIPELINE_NODE_NAME_DUPLICATE;
+        }
+        elementNodeInfos.push_back(demultiplexedInfo);
+        // following demultiplexed nodes are not visible yet, so each of them depends only on the preceding ones
+        NodeValidator validator(pipelineName, manager, elementNodeInfos.back(), demultiplexerInfo.demultiplexedConnections, elementNodeInfos);
+        auto status = validator.validate();
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return StatusCode::OK;
+}
+
 Status PipelineDefinition::validateNode(ModelManager& manager, const NodeInfo& dependantNodeInfo) {
     NodeValidator validator(this->pipelineName, manager, dependantNodeInfo, connections, nodeInfos);
-    return validator.validate();
+    auto status = validator.validate();
+    if (!status.ok() || dependantNodeInfo.demultiplexedNodes.empty()) {
+        return status;
+    }
+    return validateDemultiplexedNodes(this->pipelineName, manager, dependantNodeInfo);
+}
+
+void PipelineDefinition::compileExecutionPlan() {
+    executionPlan.steps.clear();
+    executionPlan.steps.reserve(nodeInfos.size());
+    std::unordered_map<std::string, size_t> nodeInfoIndexes;
+    for (size_t i = 0; i < nodeInfos.size(); ++i) {
+        nodeInfoIndexes.emplace(nodeInfos[i].nodeName, i);
+    }
+    std::vector<size_t> remainingDependenciesCount(nodeInfos.size(), 0);
+    std::vector<std::vector<size_t>> dependants(nodeInfos.size());
+    for (const auto& [dependantName, dependencies] : connections) {
+        auto dependantIt = nodeInfoIndexes.find(dependantName);
+        if (dependantIt == nodeInfoIndexes.end()) {
+            continue;
+        }
+        const auto dependantIndex = dependantIt->second;
+        for (const auto& [dependencyName, mapping] : dependencies) {
+            remainingDependenciesCount[dependantIndex]++;
+            dependants[nodeInfoIndexes.at(dependencyName)].push_back(dependantIndex);
+        }
+    }
+    // Kahn's algorithm, validation already ensured there are no cycles
+    std::vector<size_t> order;
+    order.reserve(nodeInfos.size());
+    for (size_t i = 0; i < nodeInfos.size(); ++i) {
+        if (remainingDependenciesCount[i] == 0) {
+            order.push_back(i);
+        }
+    }
+    for (size_t next = 0; next < order.size(); ++next) {
+        for (auto dependantIndex : dependants[order[next]]) {
+            if (--remainingDependenciesCount[dependantIndex] == 0) {
+                order.push_back(dependantIndex);
+            }
+        }
+    }
+    std::set<std::string> measuredNodeNames;
+    std::vector<size_t> nodeIds(nodeInfos.size());
+    for (size_t nodeId = 0; nodeId < order.size(); ++nodeId) {
+        nodeIds[order[nodeId]] = nodeId;
+    }
+    for (auto nodeInfoIndex : order) {
+        if (nodeInfos[nodeInfoIndex].kind == NodeKind::ENTRY) {
+            executionPlan.entryNodeId = executionPlan.steps.size();
+        } else if (nodeInfos[nodeInfoIndex].kind == NodeKind::EXIT) {
+            executionPlan.exitNodeId = executionPlan.steps.size();
+        }
+        PipelineExecutionPlan::Step step{nodeInfoIndex, {}, nullptr};
+        const auto& info = nodeInfos[nodeInfoIndex];
+        if (info.kind == NodeKind::DL && info.resultCacheSize > 0) {
+            // model might have been reloaded, previously cached results are dropped
+            step.resultCache = std::make_shared<node_result_cache_t>(info.resultCacheSize);
+        }
+        if (info.kind != NodeKind::ENTRY && info.kind != NodeKind::EXIT) {
+            step.metrics = metrics->getNodeMetrics(info.nodeName);
+            measuredNodeNames.insert(info.nodeName);
+        }
+        auto it = connections.find(info.nodeName);
+        if (it != connections.end()) {
+            for (const auto& [dependencyName, mapping] : it->second) {
+                step.dependencies.push_back({nodeIds[nodeInfoIndexes.at(dependencyName)], mapping});
+            }
+        }
+        executionPlan.steps.push_back(std::move(step));
+    }
+    std::vector<std::vector<size_t>> dependantIds(executionPlan.steps.size());
+    for (size_t nodeId = 0; nodeId < executionPlan.steps.size(); ++nodeId) {
+        for (const auto& dependency : executionPlan.steps[nodeId].dependencies) {
+            dependantIds[dependency.nodeId].push_back(nodeId);
+        }
+    }
+    // latencies of previous plan might not apply to reloaded models, those are measured again
+    executionPlan.criticalPath = std::make_shared<CriticalPathEstimator>(std::move(dependantIds));
+    metrics->retainNodes(measuredNodeNames);
+    SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Compiled execution plan of pipeline: {} with {} nodes", getName(), executionPlan.steps.size());
 }
 
 // Because of the way how pipeline_connections is implemented, this function is using
@@ -648,6 +1228,10 @@ Status PipelineDefinition::validateNodes(ModelManager& manager) {
 Status PipelineDefinition::getInputsInfo(tensor_map_t& inputsInfo, const ModelManager& manager) const {
     // Assumptions: this can only be called on available pipeline definition.
     // Add check if available when pipeline status will be implemented.
+    // served generation describes pipelines created for requests, definition not validated yet is described as configured
+    auto generation = getServedGeneration();
+    const auto& nodeInfos = generation ? generation->nodeInfos : this->nodeInfos;
+    const auto& connections = generation ? generation->connections : this->connections;
 
     static const auto byName = [](const std::string& name) {
         return [name](const NodeInfo& nodeInfo) {
@@ -663,13 +1247,16 @@ Status PipelineDefinition::getInputsInfo(tensor_map_t& inputsInfo, const ModelMa
             }
 
             switch (dependantNodeInfo->kind) {
-            case NodeKind::EXIT: {
+            case NodeKind::EXIT:
+            case NodeKind::CUSTOM:
+            case NodeKind::GATE: {
                 for (const auto& [alias, realName] : specificDependencyMapping) {
                     inputsInfo.insert({alias, TensorInfo::getUnspecifiedTensorInfo()});
                 }
                 break;
             }
-            case NodeKind::DL: {
+            case NodeKind::DL:
+            case NodeKind::DEMULTIPLEXER: {
                 auto instance = manager.findModelInstance(dependantNodeInfo->modelName, dependantNodeInfo->modelVersion.value_or(0));
                 if (!instance) {
                     SPDLOG_DEBUG("Model: {} was unavailable during pipeline: {} inputs info fetching", dependantNodeInfo->modelName, this->getName());
@@ -701,6 +1288,9 @@ Status PipelineDefinition::getInputsInfo(tensor_map_t& inputsInfo, const ModelMa
 Status PipelineDefinition::getOutputsInfo(tensor_map_t& outputsInfo, const ModelManager& manager) const {
     // Assumptions: this can only be called on available pipeline definition.
     // Add check if available when pipeline status will be implemented.
+    auto generation = getServedGeneration();
+    const auto& nodeInfos = generation ? generation->nodeInfos : this->nodeInfos;
+    const auto& connections = generation ? generation->connections : this->connections;
 
     static const auto byName = [](const std::string& name) {
         return [name](const NodeInfo& nodeInfo) {
@@ -717,16 +1307,20 @@ Status PipelineDefinition::getOutputsInfo(tensor_map_t& outputsInfo, const Model
             const auto& dependencyNodeInfo = std::find_if(std::begin(nodeInfos), std::end(nodeInfos), byName(dependencyNodeName));
 
             switch (dependencyNodeInfo->kind) {
-            case NodeKind::ENTRY: {
+            case NodeKind::ENTRY:
+            case NodeKind::CUSTOM:
+            case NodeKind::GATE: {
                 for (const auto& [alias, realName] : specificDependencyMapping) {
                     outputsInfo.insert({realName, TensorInfo::getUnspecifiedTensorInfo()});
                 }
                 break;
             }
-            case NodeKind::DL: {
-                auto instance = manager.findModelInstance(dependencyNodeInfo->modelName, dependencyNodeInfo->modelVersion.value_or(0));
+            case NodeKind::DL:
+            case NodeKind::DEMULTIPLEXER: {
+                const auto outputsNodeInfo = dependencyNodeInfo->getGatheredOutputsInfo();
+                auto instance = manager.findModelInstance(outputsNodeInfo.modelName, outputsNodeInfo.modelVersion.value_or(0));
                 if (!instance) {
-                    SPDLOG_DEBUG("Model: {} was unavailable during pipeline: {} outputs info fetching", dependencyNodeInfo->modelName, this->getName());
+                    SPDLOG_DEBUG("Model: {} was unavailable during pipeline: {} outputs info fetching", outputsNodeInfo.modelName, this->getName());
                     return StatusCode::MODEL_MISSING;
                 }
                 std::unique_ptr<ModelInstanceUnloadGuard> unloadGuard;
@@ -737,7 +1331,7 @@ Status PipelineDefinition::getOutputsInfo(tensor_map_t& outputsInfo, const Model
                 }
 
                 for (const auto& [alias, realName] : specificDependencyMapping) {
-                    const auto& finalName = dependencyNodeInfo->outputNameAliases.count(alias) > 0 ? dependencyNodeInfo->outputNameAliases.at(alias) : alias;
+                    const auto& finalName = outputsNodeInfo.outputNameAliases.count(alias) > 0 ? outputsNodeInfo.outputNameAliases.at(alias) : alias;
                     outputsInfo[realName] = instance->getOutputsInfo().at(finalName);
                 }
                 break;
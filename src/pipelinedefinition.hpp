@@ -17,7 +17,10 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <shared_mutex>
 #include <string>
@@ -30,11 +33,20 @@
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #pragma GCC diagnostic pop
 
+#include "criticalpathestimator.hpp"
+#include "custom_node.hpp"
+#include "dl_node.hpp"
+#include "fusednetwork.hpp"
+#include "gate_node.hpp"
+#include "metadatacache.hpp"
 #include "model_version_policy.hpp"
 #include "node.hpp"
 #include "pipeline.hpp"
+#include "pipelineadmission.hpp"
 #include "pipelinedefinitionstatus.hpp"
 #include "pipelinedefinitionunloadguard.hpp"
+#include "pipelinegraphpool.hpp"
+#include "pipelinemetrics.hpp"
 #include "status.hpp"
 
 namespace ovms {
@@ -46,10 +58,28 @@ using pipeline_connections_t = std::unordered_map<std::string, std::unordered_ma
 enum class NodeKind {
     ENTRY,
     DL,
+    DEMULTIPLEXER,
+    CUSTOM,
+    GATE,
     EXIT
 };
 
 const std::string DL_NODE_CONFIG_TYPE = "DL model";
+const std::string DEMULTIPLEXER_NODE_CONFIG_TYPE = "Demultiplexer";
+const std::string CUSTOM_NODE_CONFIG_TYPE = "custom";
+const std::string GATE_NODE_CONFIG_TYPE = "Gate";
+
+const size_t DEFAULT_NODE_RESULT_CACHE_SIZE = 64;
+
+// Concurrency limit of pipeline derived from infer requests of its models
+const size_t PIPELINE_MAX_CONCURRENCY_AUTO = 0;
+
+/**
+ * @brief Tells if node infers a model, demultiplexer node runs its model for each element of inputs
+ */
+inline bool isModelNodeKind(NodeKind kind) {
+    return kind == NodeKind::DL || kind == NodeKind::DEMULTIPLEXER;
+}
 
 Status toNodeKind(const std::string& str, NodeKind& nodeKind);
 
@@ -59,17 +89,84 @@ struct NodeInfo {
     std::string modelName;
     std::optional<model_version_t> modelVersion;
     std::unordered_map<std::string, std::string> outputNameAliases;
+    // Set for custom nodes only
+    NodeLibrary library;
+    parameters_t parameters;
+    // Set for gate nodes only
+    GateCondition condition;
+    // Number of memoized results of DL model node, 0 when node is not cacheable
+    size_t resultCacheSize = 0;
+    // Set for demultiplexer nodes only, model nodes inferred for each element after the node model, in order.
+    // Their connections refer to the demultiplexer node or to preceding demultiplexed nodes.
+    std::vector<NodeInfo> demultiplexedNodes;
+    pipeline_connections_t demultiplexedConnections;
 
     NodeInfo(NodeKind kind,
         const std::string& nodeName,
         const std::string& modelName = "",
         std::optional<model_version_t> modelVersion = std::nullopt,
-        std::unordered_map<std::string, std::string> outputNameAliases = {}) :
+        std::unordered_map<std::string, std::string> outputNameAliases = {},
+        const NodeLibrary& library = {},
+        const parameters_t& parameters = {}) :
         kind(kind),
         nodeName(nodeName),
         modelName(modelName),
         modelVersion(modelVersion),
-        outputNameAliases(outputNameAliases) {}
+        outputNameAliases(outputNameAliases),
+        library(library),
+        parameters(parameters) {}
+
+    bool operator==(const NodeInfo& other) const;
+    bool operator!=(const NodeInfo& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * @brief Describes outputs of the node as seen by its dependants. For demultiplexer node with demultiplexed nodes
+     * those are gathered outputs of the last demultiplexed node.
+     */
+    NodeInfo getGatheredOutputsInfo() const;
+};
+
+/**
+ * @brief Pipeline structure compiled at validation, so that creating pipeline for a request needs no name lookups
+ */
+struct PipelineExecutionPlan {
+    struct Dependency {
+        size_t nodeId;
+        InputPairs mapping;
+    };
+    struct Step {
+        size_t nodeInfoIndex;
+        std::vector<Dependency> dependencies;
+        // Shared by all pipelines built from this plan, so that results are reused between requests
+        std::shared_ptr<node_result_cache_t> resultCache;
+        // Latency histograms of the node, kept by pipeline definition across reloads
+        std::shared_ptr<NodeMetrics> metrics;
+        // Model outputs left in device memory, every node reading them infers on the same GPU
+        std::set<std::string> deviceResidentOutputs;
+        // Set when the step infers a chain of models fused into one network, the step takes dependencies of the chain head
+        std::shared_ptr<FusedNetwork> fusedNetwork;
+    };
+    // Nodes in topological order, position of the step is the node id
+    std::vector<Step> steps;
+    size_t entryNodeId = 0;
+    size_t exitNodeId = 0;
+    // Latencies measured by pipelines of this plan, used to start nodes on the longest remaining path first
+    std::shared_ptr<CriticalPathEstimator> criticalPath;
+};
+
+/**
+ * @brief Validated definition which pipelines are created from, replaced as a whole once reloaded definition passes validation
+ *
+ * Pipelines being created keep the generation they started with, so requests are not blocked by reload.
+ */
+struct PipelineDefinitionGeneration {
+    std::vector<NodeInfo> nodeInfos;
+    pipeline_connections_t connections;
+    PipelineExecutionPlan executionPlan;
+    // Graphs of finished pipelines of this generation reused by following requests
+    std::shared_ptr<PipelineGraphPool> graphPool;
 };
 
 class PipelineDefinition {
@@ -93,10 +190,26 @@ class PipelineDefinition {
     };
 
     const std::string pipelineName;
+    // Definition being validated, modified only by configuration reload
     std::vector<NodeInfo> nodeInfos;
     pipeline_connections_t connections;
+    PipelineExecutionPlan executionPlan;
+    // Last definition which passed validation, accessed atomically
+    std::shared_ptr<const PipelineDefinitionGeneration> servedGeneration;
+    std::shared_ptr<PipelineMetrics> metrics;
+    // Unlimited when not set
+    std::optional<size_t> maxConcurrency;
+    std::shared_ptr<PipelineAdmission> admission;
 
     std::atomic<uint64_t> requestsHandlesCounter = 0;
+    // Request handles counted by period they were taken in, reload of available definition starts a new period
+    // and waits only for handles of the previous one, so requests taken meanwhile are not blocked
+    std::atomic<uint64_t> requestsHandlesPeriodCounters[2] = {0, 0};
+    std::atomic<size_t> requestsHandlesPeriod = 0;
+    // notified when the last request handle is released while retire or reload waits for it
+    std::condition_variable requestsFinishedNotify;
+    std::mutex requestsFinishedMutex;
+    std::atomic<uint32_t> requestsFinishedWaiters = 0;
     std::shared_mutex loadMtx;
 
     std::condition_variable loadedNotify;
@@ -107,26 +220,120 @@ class PipelineDefinition {
 protected:
     PipelineDefinitionStatus status;
 
+    /**
+     * @brief Networks fused by the last validation, reused by the next one for chains whose models are unchanged
+     */
+    std::vector<std::shared_ptr<FusedNetwork>> fusedNetworks;
+
+    /**
+     * @brief Compiles network fused from models of the chain, on failure the chain is inferred node by node
+     */
+    virtual Status createFusedNetwork(const std::vector<FusedNetwork::Stage>& stages, std::shared_ptr<FusedNetwork>& fused) {
+        return FusedNetwork::create(stages, fused);
+    }
+
 private:
     std::set<std::pair<const std::string, model_version_t>> subscriptions;
 
+    MetadataCache metadataCache;
+
     Status validateNode(ModelManager& manager, const NodeInfo& node);
 
+    /**
+     * @brief Orders validated nodes topologically and resolves connections to node ids
+     */
+    void compileExecutionPlan();
+
+    /**
+     * @brief Finds outputs of GPU model nodes read only by model nodes on the same device, those are passed on
+     * in device memory instead of being downloaded to the host and uploaded again
+     */
+    void markDeviceResidentOutputs(ModelManager& manager);
+
+    /**
+     * @brief Replaces chains of model nodes, each read only by the next one on the same device, with nodes inferring
+     * networks fused from models of the chain. Networks of the previous validation are reused when their models did not change.
+     */
+    void fuseModelChains(ModelManager& manager);
+
+    /**
+     * @brief Makes validated definition the one which following pipelines are created from
+     */
+    void publishGeneration();
+
+    /**
+     * @brief Applies configured concurrency limit, automatic one lets each model node of the pipeline hold an infer request
+     * of its model, so that admitted pipelines do not starve each other
+     */
+    void updateAdmissionLimit(ModelManager& manager);
+
+    std::shared_ptr<const PipelineDefinitionGeneration> getServedGeneration() const {
+        return std::atomic_load(&servedGeneration);
+    }
+
+    /**
+     * @brief Tells if reload with the same nodes and connections can keep current validation result
+     *
+     * Changes of used models are tracked with subscriptions, which mark definition as requiring revalidation.
+     * Models are checked to be still available as well, in case they were retired in the meantime.
+     */
+    bool isUpToDate(const ModelManager& manager, const std::vector<NodeInfo>& nodeInfos, const pipeline_connections_t& connections) const;
+
+    Status create(std::unique_ptr<Pipeline>& pipeline,
+        const std::function<void(EntryNode&)>& bindEntry,
+        const std::function<void(ExitNode&)>& bindExit,
+        ModelManager& manager);
+
+    /**
+     * @brief Waits until all request handles are released, new handles have to be blocked by the definition state
+     */
+    void waitForRequestsHandlesReleased();
+
+    /**
+     * @brief Starts new period of request handles and waits until handles taken before are released,
+     * handles taken afterwards are not waited for
+     */
+    void waitForPreviousRequestsHandlesReleased();
+
+    void buildGraph(const PipelineDefinitionGeneration& generation, pipeline_nodes_t& nodes, ModelManager& manager) const;
+
 public:
     static constexpr uint64_t WAIT_FOR_LOADED_DEFAULT_TIMEOUT_MICROSECONDS = 10000;
+    static constexpr size_t MAX_IDLE_PIPELINE_GRAPHS_COUNT = 64;
     PipelineDefinition(const std::string& pipelineName,
         const std::vector<NodeInfo>& nodeInfos,
         const pipeline_connections_t& connections) :
         pipelineName(pipelineName),
         nodeInfos(nodeInfos),
         connections(connections),
+        metrics(std::make_shared<PipelineMetrics>()),
+        admission(std::make_shared<PipelineAdmission>()),
         status(this->pipelineName) {}
 
     Status create(std::unique_ptr<Pipeline>& pipeline,
         const tensorflow::serving::PredictRequest* request,
         tensorflow::serving::PredictResponse* response,
         ModelManager& manager);
-    Status reload(ModelManager& manager, const std::vector<NodeInfo>&& nodeInfos, const pipeline_connections_t&& connections);
+    /**
+     * @brief Creates pipeline reading blobs of in-process request and writing output blobs, which have to outlive the pipeline
+     */
+    Status create(std::unique_ptr<Pipeline>& pipeline,
+        const BlobMap* inputBlobs,
+        BlobMap* outputBlobs,
+        ModelManager& manager);
+    Status reload(ModelManager& manager, const std::vector<NodeInfo>&& nodeInfos, const pipeline_connections_t&& connections,
+        std::optional<size_t> maxConcurrency = std::nullopt);
+
+    /**
+     * @brief Sets limit of concurrently executed pipelines applied on validation
+     *
+     * @param maxConcurrency PIPELINE_MAX_CONCURRENCY_AUTO to derive it from infer requests of used models, unlimited when not set
+     */
+    void setMaxConcurrency(std::optional<size_t> maxConcurrency) {
+        this->maxConcurrency = maxConcurrency;
+    }
+
+    const PipelineAdmission& getAdmission() const { return *admission; }
     void retire(ModelManager& manager);
     Status validate(ModelManager& manager);
     Status validateNodes(ModelManager& manager);
@@ -134,11 +341,22 @@ public:
     const std::string& getName() const { return pipelineName; }
     const PipelineDefinitionStateCode getStateCode() const { return status.getStateCode(); }
     const model_version_t getVersion() const { return VERSION; }
+    const PipelineExecutionPlan& getExecutionPlan() const { return executionPlan; }
+    size_t getIdlePipelineGraphsCount() const {
+        auto generation = getServedGeneration();
+        return generation ? generation->graphPool->getIdleGraphsCount() : 0;
+    }
+    const PipelineMetrics& getMetrics() const { return *metrics; }
 
     void notifyUsedModelChanged(const std::string& ownerDetails) {
+        this->metadataCache.invalidate();
         this->status.handle(UsedModelChangedEvent(ownerDetails));
     }
 
+    MetadataCache& getMetadataCache() {
+        return this->metadataCache;
+    }
+
     const PipelineDefinitionStatus& getStatus() const {
         return this->status;
     }
@@ -149,12 +367,22 @@ public:
     virtual Status getInputsInfo(tensor_map_t& inputsInfo, const ModelManager& manager) const;
     virtual Status getOutputsInfo(tensor_map_t& outputsInfo, const ModelManager& manager) const;
 
-    void increaseRequestsHandlesCount() {
+    /**
+     * @return period the handle is counted in, has to be passed back to decreaseRequestsHandlesCount
+     */
+    size_t increaseRequestsHandlesCount() {
         ++requestsHandlesCounter;
+        const size_t period = requestsHandlesPeriod.load();
+        ++requestsHandlesPeriodCounters[period];
+        return period;
     }
 
-    void decreaseRequestsHandlesCount() {
-        --requestsHandlesCounter;
+    void decreaseRequestsHandlesCount(size_t period) {
+        const bool periodFinished = --requestsHandlesPeriodCounters[period] == 0;
+        if ((--requestsHandlesCounter == 0 || periodFinished) && requestsFinishedWaiters > 0) {
+            std::lock_guard<std::mutex> lock(requestsFinishedMutex);
+            requestsFinishedNotify.notify_all();
+        }
     }
 
     Status waitForLoaded(std::unique_ptr<PipelineDefinitionUnloadGuard>& unloadGuard, const uint waitForLoadedTimeoutMicroseconds = WAIT_FOR_LOADED_DEFAULT_TIMEOUT_MICROSECONDS);
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <exception>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -62,8 +63,12 @@ class MachineState {
 public:
     MachineState(const std::string& name) :
         name(name) {}
+    /**
+     * @brief Events are handled one at a time, models loaded concurrently may notify the same pipeline
+     */
     template <typename Event>
     void handle(const Event& event) {
+        std::lock_guard<std::mutex> lock(handleMtx);
         SPDLOG_LOGGER_DEBUG(modelmanager_logger, "Pipeline: {} state: {} handling: {}: {}",
             name, pipelineDefinitionStateCodeToString(getStateCode()), event.name, event.getDetails());
         try {
@@ -95,6 +100,7 @@ public:
 
 private:
     const std::string& name;
+    std::mutex handleMtx;
     std::tuple<States...> allPossibleStates;
     std::variant<States*...> currentState{&std::get<0>(allPossibleStates)};
 };
@@ -19,11 +19,11 @@
 
 namespace ovms {
 PipelineDefinitionUnloadGuard::PipelineDefinitionUnloadGuard(PipelineDefinition& pipelineDefinition) :
-    pipelineDefinition(pipelineDefinition) {
-    pipelineDefinition.increaseRequestsHandlesCount();
+    pipelineDefinition(pipelineDefinition),
+    requestsHandlesPeriod(pipelineDefinition.increaseRequestsHandlesCount()) {
 }
 
 PipelineDefinitionUnloadGuard::~PipelineDefinitionUnloadGuard() {
-    pipelineDefinition.decreaseRequestsHandlesCount();
+    pipelineDefinition.decreaseRequestsHandlesCount(requestsHandlesPeriod);
 }
 }  // namespace ovms
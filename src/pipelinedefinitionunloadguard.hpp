@@ -15,6 +15,8 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstddef>
+
 namespace ovms {
 class PipelineDefinition;
 
@@ -26,5 +28,6 @@ public:
 
 private:
     PipelineDefinition& pipelineDefinition;
+    const size_t requestsHandlesPeriod;
 };
 }  // namespace ovms
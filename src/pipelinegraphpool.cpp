@@ -0,0 +1,64 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "pipelinegraphpool.hpp"
+
+#include <utility>
+
+namespace ovms {
+
+bool PipelineGraphPool::tryAcquire(pipeline_nodes_t& nodes) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (idleGraphs.empty()) {
+        return false;
+    }
+    nodes = std::move(idleGraphs.back());
+    idleGraphs.pop_back();
+    return true;
+}
+
+PipelineGraphPool::recycler_t PipelineGraphPool::getRecycler() {
+    std::unique_lock<std::mutex> lock(mtx);
+    std::weak_ptr<PipelineGraphPool> pool = shared_from_this();
+    return [pool, generation = this->generation](pipeline_nodes_t&& nodes) {
+        if (auto existingPool = pool.lock()) {
+            existingPool->release(std::move(nodes), generation);
+        }
+    };
+}
+
+void PipelineGraphPool::invalidate() {
+    std::vector<pipeline_nodes_t> droppedGraphs;
+    std::unique_lock<std::mutex> lock(mtx);
+    generation++;
+    droppedGraphs.swap(idleGraphs);
+    lock.unlock();
+}
+
+void PipelineGraphPool::release(pipeline_nodes_t&& nodes, uint64_t generation) {
+    // nodes which are not kept are destroyed outside of the lock
+    pipeline_nodes_t returnedNodes = std::move(nodes);
+    std::unique_lock<std::mutex> lock(mtx);
+    if (generation == this->generation && idleGraphs.size() < maxIdleGraphsCount) {
+        idleGraphs.emplace_back(std::move(returnedNodes));
+    }
+}
+
+size_t PipelineGraphPool::getIdleGraphsCount() {
+    std::unique_lock<std::mutex> lock(mtx);
+    return idleGraphs.size();
+}
+
+}  // namespace ovms
@@ -0,0 +1,78 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "node.hpp"
+
+namespace ovms {
+
+using pipeline_nodes_t = std::vector<std::unique_ptr<Node>>;
+
+/**
+ * @brief Keeps connected nodes of finished pipelines, so that following requests to the same definition
+ * reuse them instead of building the graph again
+ *
+ * Graphs built before invalidate() are dropped when they are returned.
+ */
+class PipelineGraphPool : public std::enable_shared_from_this<PipelineGraphPool> {
+public:
+    using recycler_t = std::function<void(pipeline_nodes_t&&)>;
+
+    /**
+     * @brief Constructor
+     *
+     * @param maxIdleGraphsCount graphs returned above this count are destroyed
+     */
+    PipelineGraphPool(size_t maxIdleGraphsCount) :
+        maxIdleGraphsCount(maxIdleGraphsCount) {}
+
+    /**
+     * @brief Takes idle graph out of the pool
+     *
+     * @param nodes filled with nodes in the order they were returned
+     *
+     * @return false when there is no idle graph
+     */
+    bool tryAcquire(pipeline_nodes_t& nodes);
+
+    /**
+     * @brief Gives function returning graph built now to the pool, it can be called after the pool is destroyed
+     */
+    recycler_t getRecycler();
+
+    /**
+     * @brief Drops idle graphs, graphs in use are dropped when returned
+     */
+    void invalidate();
+
+    size_t getIdleGraphsCount();
+
+private:
+    void release(pipeline_nodes_t&& nodes, uint64_t generation);
+
+    const size_t maxIdleGraphsCount;
+    std::mutex mtx;
+    std::vector<pipeline_nodes_t> idleGraphs;
+    uint64_t generation = 0;
+};
+
+}  // namespace ovms
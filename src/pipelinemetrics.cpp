@@ -0,0 +1,64 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "pipelinemetrics.hpp"
+
+namespace ovms {
+
+const char* toString(NodeStage stage) {
+    switch (stage) {
+    case NodeStage::STREAM_WAIT:
+        return "stream_wait";
+    case NodeStage::INPUT_SETUP:
+        return "input_setup";
+    case NodeStage::INFERENCE:
+        return "inference";
+    case NodeStage::FETCH_RESULTS:
+        return "fetch_results";
+    }
+    return "unknown";
+}
+
+std::shared_ptr<NodeMetrics> PipelineMetrics::getNodeMetrics(const std::string& nodeName) {
+    std::unique_lock<std::mutex> lock(nodesMtx);
+    auto& metrics = nodes[nodeName];
+    if (metrics == nullptr) {
+        metrics = std::make_shared<NodeMetrics>();
+    }
+    return metrics;
+}
+
+void PipelineMetrics::retainNodes(const std::set<std::string>& nodeNames) {
+    std::unique_lock<std::mutex> lock(nodesMtx);
+    for (auto it = nodes.begin(); it != nodes.end();) {
+        if (nodeNames.count(it->first) == 0) {
+            it = nodes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<const NodeMetrics>>> PipelineMetrics::getNodes() const {
+    std::unique_lock<std::mutex> lock(nodesMtx);
+    std::vector<std::pair<std::string, std::shared_ptr<const NodeMetrics>>> result;
+    result.reserve(nodes.size());
+    for (const auto& [name, metrics] : nodes) {
+        result.emplace_back(name, metrics);
+    }
+    return result;
+}
+
+}  // namespace ovms
@@ -0,0 +1,132 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "latencyhistogram.hpp"
+#include "modelmetrics.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Phases of node execution measured separately
+ */
+enum class NodeStage {
+    STREAM_WAIT,
+    INPUT_SETUP,
+    INFERENCE,
+    FETCH_RESULTS
+};
+
+constexpr size_t NODE_STAGES_COUNT = 4;
+
+const char* toString(NodeStage stage);
+
+/**
+ * @brief Latency histograms of one pipeline node, shared by all its executions
+ */
+class NodeMetrics {
+    std::array<LatencyHistogram, NODE_STAGES_COUNT> stages;
+
+public:
+    void recordSince(NodeStage stage, std::chrono::steady_clock::time_point start) {
+        stages[static_cast<size_t>(stage)].recordSince(start);
+    }
+
+    const LatencyHistogram& get(NodeStage stage) const {
+        return stages[static_cast<size_t>(stage)];
+    }
+};
+
+/**
+ * @brief Records time elapsed until the end of the scope, does nothing when node is not measured
+ */
+class StageTimer {
+    NodeMetrics* metrics;
+    NodeStage stage;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    StageTimer(const std::shared_ptr<NodeMetrics>& metrics, NodeStage stage) :
+        metrics(metrics.get()),
+        stage(stage) {
+        if (this->metrics != nullptr) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~StageTimer() {
+        if (metrics != nullptr) {
+            metrics->recordSince(stage, start);
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+};
+
+/**
+ * @brief Latency histograms of a pipeline and its nodes, kept by pipeline definition across reloads
+ */
+class PipelineMetrics {
+    LatencyHistogram endToEnd;
+    ShardedCounter errors;
+    mutable std::mutex nodesMtx;
+    std::map<std::string, std::shared_ptr<NodeMetrics>> nodes;
+
+public:
+    void recordEndToEndSince(std::chrono::steady_clock::time_point start) {
+        endToEnd.recordSince(start);
+    }
+
+    const LatencyHistogram& getEndToEnd() const {
+        return endToEnd;
+    }
+
+    void recordError() {
+        errors.increment();
+    }
+
+    uint64_t getErrors() const {
+        return errors.get();
+    }
+
+    /**
+     * @brief Gives histograms of the node, creating them when node is measured for the first time
+     */
+    std::shared_ptr<NodeMetrics> getNodeMetrics(const std::string& nodeName);
+
+    /**
+     * @brief Drops histograms of nodes removed from the pipeline
+     */
+    void retainNodes(const std::set<std::string>& nodeNames);
+
+    /**
+     * @brief Gives measured nodes ordered by name
+     */
+    std::vector<std::pair<std::string, std::shared_ptr<const NodeMetrics>>> getNodes() const;
+};
+
+}  // namespace ovms
@@ -0,0 +1,130 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "pipelinescheduler.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "logging.hpp"
+#include "samplingprofiler.hpp"
+
+namespace ovms {
+
+namespace {
+/**
+ * @brief Scheduler and index of the worker running on the current thread
+ */
+thread_local const PipelineScheduler* currentScheduler = nullptr;
+thread_local size_t currentWorkerIndex = 0;
+}  // namespace
+
+PipelineScheduler::PipelineScheduler(size_t workersCount) {
+    workersCount = std::max<size_t>(workersCount, 1);
+    SPDLOG_LOGGER_DEBUG(dag_executor_logger, "Starting pipeline scheduler with {} workers", workersCount);
+    queues.reserve(workersCount);
+    for (size_t i = 0; i < workersCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers.reserve(workersCount);
+    for (size_t i = 0; i < workersCount; ++i) {
+        workers.emplace_back(&PipelineScheduler::run, this, i);
+    }
+}
+
+PipelineScheduler::~PipelineScheduler() {
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        stopRequested = true;
+    }
+    sleepCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void PipelineScheduler::schedule(task_t task) {
+    size_t queueIndex;
+    if (currentScheduler == this) {
+        queueIndex = currentWorkerIndex;
+    } else {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopRequested) {
+            lock.unlock();
+            task();
+            return;
+        }
+        queueIndex = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+    // counted before the task is visible so that count never drops below the number of queued tasks
+    pendingTasksCount.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(queues[queueIndex]->mtx);
+        queues[queueIndex]->tasks.push_back(std::move(task));
+    }
+    {
+        // worker checks pending tasks under the same lock before going to sleep, so notification is not lost
+        std::unique_lock<std::mutex> lock(sleepMutex);
+    }
+    sleepCondition.notify_one();
+}
+
+bool PipelineScheduler::tryPop(size_t workerIndex, task_t& task) {
+    auto& queue = *queues[workerIndex];
+    std::unique_lock<std::mutex> lock(queue.mtx);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool PipelineScheduler::trySteal(size_t workerIndex, task_t& task) {
+    for (size_t i = 1; i < queues.size(); ++i) {
+        auto& queue = *queues[(workerIndex + i) % queues.size()];
+        std::unique_lock<std::mutex> lock(queue.mtx);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void PipelineScheduler::run(size_t workerIndex) {
+    setCurrentThreadName("ovms_dag_" + std::to_string(workerIndex));
+    currentScheduler = this;
+    currentWorkerIndex = workerIndex;
+    task_t task;
+    while (true) {
+        if (tryPop(workerIndex, task) || trySteal(workerIndex, task)) {
+            pendingTasksCount.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this]() { return stopRequested || pendingTasksCount.load(std::memory_order_seq_cst) > 0; });
+        if (stopRequested && pendingTasksCount.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+    }
+}
+
+}  // namespace ovms
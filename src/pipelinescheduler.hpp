@@ -0,0 +1,88 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Small pool of threads driving node transitions of many pipelines at once
+ *
+ * Each worker has its own task queue. Tasks scheduled from a worker go to its own queue and are executed
+ * in LIFO order to stay in cache, other tasks are spread round robin. Idle workers steal from the oldest end
+ * of other queues before going to sleep.
+ */
+class PipelineScheduler {
+public:
+    using task_t = std::function<void()>;
+
+    /**
+     * @brief Starts workers
+     *
+     * @param workersCount number of worker threads, at least one is started
+     */
+    PipelineScheduler(size_t workersCount);
+
+    /**
+     * @brief Executes all tasks scheduled so far and stops workers
+     */
+    ~PipelineScheduler();
+
+    PipelineScheduler(const PipelineScheduler&) = delete;
+    PipelineScheduler& operator=(const PipelineScheduler&) = delete;
+
+    /**
+     * @brief Schedules task for execution on one of the workers, never blocks on running tasks
+     *
+     * Task scheduled after the scheduler was stopped is executed right away by the caller.
+     */
+    void schedule(task_t task);
+
+    size_t getWorkersCount() const {
+        return workers.size();
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mtx;
+        std::deque<task_t> tasks;
+    };
+
+    void run(size_t workerIndex);
+
+    bool tryPop(size_t workerIndex, task_t& task);
+
+    bool trySteal(size_t workerIndex, task_t& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> pendingTasksCount{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool stopRequested = false;
+};
+
+}  // namespace ovms
@@ -17,6 +17,7 @@
 
 #include <condition_variable>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -28,15 +29,21 @@
 #include "tensorflow/core/framework/tensor.h"
 #pragma GCC diagnostic pop
 
+#include "compression.hpp"
+#include "deadline.hpp"
 #include "get_model_metadata_impl.hpp"
+#include "hotpathtimings.hpp"
+#include "logging.hpp"
 #include "modelinstanceunloadguard.hpp"
 #include "modelmanager.hpp"
 #include "ovinferrequestsqueue.hpp"
 #include "prediction_service_utils.hpp"
+#include "requesttimings.hpp"
+#include "samplingprofiler.hpp"
+#include "saturation.hpp"
 #include "status.hpp"
-
-#define DEBUG
-#include "timer.hpp"
+#include "tracing.hpp"
+#include "trafficcapture.hpp"
 
 using grpc::ServerContext;
 
@@ -68,12 +75,35 @@ grpc::Status ovms::PredictionServiceImpl::Predict(
     ServerContext* context,
     const PredictRequest* request,
     PredictResponse* response) {
-    Timer timer;
-    timer.start("total");
-    using std::chrono::microseconds;
-    SPDLOG_DEBUG("Processing gRPC request for model: {}; version: {}",
+    HotPathTimer<HotPathStage::GRPC_PREDICT> timer;
+    ProfilerTag profilerTag("grpc_predict");
+    OVMS_HOT_PATH_DEBUG("Processing gRPC request for model: {}; version: {}",
         request->model_spec().name(),
         request->model_spec().version().value());
+    if (SaturationMonitor::instance().shouldShedRequest()) {
+        OVMS_HOT_PATH_DEBUG("Shedding gRPC request, server is saturated");
+        return Status(StatusCode::SERVER_SATURATED).grpc();
+    }
+    NetworkRequestGuard networkRequest;
+    const auto traceContext = Tracer::instance().startRequest(getTraceparent(*context));
+    Span requestSpan("Predict", &traceContext, true);
+    if (requestSpan.isRecording()) {
+        requestSpan.setAttribute("rpc.system", "grpc");
+        requestSpan.setAttribute("rpc.method", "Predict");
+        requestSpan.setAttribute("ovms.model_name", request->model_spec().name());
+    }
+    TraceScope traceScope(requestSpan.getContext());
+    std::optional<RequestTimings> timings;
+    if (isServerTimingRequested(*context)) {
+        timings.emplace();
+    }
+    RequestTimingsScope timingsScope(timings ? &*timings : nullptr);
+    // sent together with the status, also for failed requests
+    auto addServerTiming = [&timings, context]() {
+        if (timings) {
+            context->AddTrailingMetadata(SERVER_TIMING_TRAILING_METADATA, timings->toServerTiming());
+        }
+    };
 
     std::shared_ptr<ovms::ModelInstance> modelInstance;
     std::unique_ptr<ovms::Pipeline> pipelinePtr;
@@ -87,21 +117,31 @@ grpc::Status ovms::PredictionServiceImpl::Predict(
     }
     if (!status.ok()) {
         SPDLOG_INFO("Getting modelInstance or pipeline failed. {}", status.string());
+        requestSpan.setError(status.string());
+        addServerTiming();
         return status.grpc();
     }
+    TrafficCapture::instance().capture(*request, pipelinePtr ? CapturedTarget::PIPELINE : CapturedTarget::MODEL);
 
+    const deadline_t deadline = deadlineFromSystemClock(context->deadline());
     if (pipelinePtr) {
+        pipelinePtr->setDeadline(deadline);
         status = pipelinePtr->execute();
     } else {
-        status = inference(*modelInstance, request, response, modelInstanceUnloadGuard);
+        status = inference(*modelInstance, request, response, modelInstanceUnloadGuard, deadline);
     }
 
+    addServerTiming();
     if (!status.ok()) {
+        requestSpan.setError(status.string());
         return status.grpc();
     }
+    if (modelInstance) {
+        setGrpcResponseCompression(*context, response->ByteSizeLong(), modelInstance->getModelConfig().getGrpcCompressionThreshold());
+    }
 
-    timer.stop("total");
-    SPDLOG_DEBUG("Total gRPC request processing time: {} ms", timer.elapsed<microseconds>("total") / 1000);
+    const uint64_t processingMicroseconds = timer.stop();
+    OVMS_HOT_PATH_DEBUG("Total gRPC request processing time: {:.3f} ms", processingMicroseconds / 1000.0);
     return grpc::Status::OK;
 }
 
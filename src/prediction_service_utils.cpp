@@ -15,23 +15,54 @@
 //*****************************************************************************
 #include "prediction_service_utils.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <string>
+#include <utility>
 
+#include "allocationprofile.hpp"
+#include "batchsplitter.hpp"
+#include "deadlinetimer.hpp"
 #include "deserialization.hpp"
 #include "executinstreamidguard.hpp"
+#include "hotpathtimings.hpp"
+#include "imagedecoder.hpp"
+#include "logging.hpp"
 #include "modelinstance.hpp"
 #include "modelinstanceunloadguard.hpp"
 #include "modelmanager.hpp"
+#include "modelmetrics.hpp"
+#include "pendingrequestguard.hpp"
+#include "requesttimings.hpp"
+#include "responsecache.hpp"
+#include "samplingprofiler.hpp"
+#include "sequencemanager.hpp"
 #include "serialization.hpp"
-
-#define DEBUG
-#include "timer.hpp"
+#include "singleflight.hpp"
+#include "tracing.hpp"
+#include "transposition.hpp"
 
 using tensorflow::serving::PredictRequest;
 using tensorflow::serving::PredictResponse;
 
 namespace ovms {
 
+std::string_view getTraceparent(const grpc::ServerContext& context) {
+    const auto& metadata = context.client_metadata();
+    auto it = metadata.find(TRACEPARENT_HEADER);
+    if (it == metadata.end()) {
+        return {};
+    }
+    return std::string_view(it->second.data(), it->second.size());
+}
+
+bool isServerTimingRequested(const grpc::ServerContext& context) {
+    const auto& metadata = context.client_metadata();
+    auto it = metadata.find(SERVER_TIMING_REQUEST_HEADER);
+    return it != metadata.end() && isServerTimingRequested(std::string_view(it->second.data(), it->second.size()));
+}
+
 size_t getRequestBatchSize(const tensorflow::serving::PredictRequest* request) {
     auto requestInputItr = request->inputs().begin();
     if (requestInputItr == request->inputs().end()) {
@@ -42,7 +73,7 @@ size_t getRequestBatchSize(const tensorflow::serving::PredictRequest* request) {
     return static_cast<size_t>(requestInput.tensor_shape().dim(0).size());
 }
 
-std::map<std::string, shape_t> getRequestShapes(const tensorflow::serving::PredictRequest* request) {
+std::map<std::string, shape_t> getRequestShapes(const tensorflow::serving::PredictRequest* request, const tensor_map_t& inputsInfo) {
     std::map<std::string, shape_t> requestShapes;
     for (auto& it : request->inputs()) {
         shape_t requestShape;
@@ -51,6 +82,14 @@ std::map<std::string, shape_t> getRequestShapes(const tensorflow::serving::Predi
         for (int i = 0; i < requestInput.tensor_shape().dim_size(); i++) {
             requestShape.push_back(requestInput.tensor_shape().dim(i).size());
         }
+        auto inputInfoItr = inputsInfo.find(name);
+        if (inputInfoItr != inputsInfo.end() && isImageInputRequested(requestInput, *inputInfoItr->second)) {
+            // encoded images are resized to the current network input shape
+            continue;
+        }
+        if (inputInfoItr != inputsInfo.end() && inputInfoItr->second->isLayoutTransposed()) {
+            requestShape = nhwcToNchwShape(requestShape);
+        }
         requestShapes[name] = std::move(requestShape);
     }
     return requestShapes;
@@ -61,7 +100,7 @@ Status getModelInstance(ovms::ModelManager& manager,
     ovms::model_version_t modelVersionId,
     std::shared_ptr<ovms::ModelInstance>& modelInstance,
     std::unique_ptr<ModelInstanceUnloadGuard>& modelInstanceUnloadGuardPtr) {
-    SPDLOG_DEBUG("Requesting model: {}; version: {}.", modelName, modelVersionId);
+    OVMS_HOT_PATH_DEBUG("Requesting model: {}; version: {}.", modelName, modelVersionId);
 
     auto model = manager.findModelByName(modelName);
     if (model == nullptr) {
@@ -72,14 +111,21 @@ Status getModelInstance(ovms::ModelManager& manager,
         if (modelInstance == nullptr) {
             return StatusCode::MODEL_VERSION_MISSING;
         }
-    } else {
+        return modelInstance->waitForLoaded(WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, modelInstanceUnloadGuardPtr);
+    }
+
+    while (true) {
         modelInstance = model->getDefaultModelInstance();
         if (modelInstance == nullptr) {
             return StatusCode::MODEL_VERSION_MISSING;
         }
+        auto status = modelInstance->waitForLoaded(WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, modelInstanceUnloadGuardPtr);
+        // default version could be switched and the previous one retired after it was chosen, the request is served by the new one
+        if (status != StatusCode::MODEL_VERSION_NOT_LOADED_ANYMORE || model->getDefaultModelInstance() == modelInstance) {
+            return status;
+        }
+        OVMS_HOT_PATH_DEBUG("Default version of model: {} switched from: {} while acquiring it, retrying", modelName, modelInstance->getVersion());
     }
-
-    return modelInstance->waitForLoaded(WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, modelInstanceUnloadGuardPtr);
 }
 
 Status getPipeline(ovms::ModelManager& manager,
@@ -87,7 +133,7 @@ Status getPipeline(ovms::ModelManager& manager,
     const tensorflow::serving::PredictRequest* request,
     tensorflow::serving::PredictResponse* response) {
 
-    SPDLOG_DEBUG("Requesting pipeline: {};", request->model_spec().name());
+    OVMS_HOT_PATH_DEBUG("Requesting pipeline: {};", request->model_spec().name());
     auto status = manager.createPipeline(pipelinePtr, request->model_spec().name(), request, response);
     return status;
 }
@@ -109,54 +155,618 @@ Status performInference(ovms::OVInferRequestsQueue& inferRequestsQueue, const in
     return StatusCode::OK;
 }
 
-Status inference(
+/**
+ * @brief Gets response cache and single flight of model instance if response of request can be shared with other requests
+ */
+static void getRequestDeduplication(ModelInstance& modelVersion, const PredictRequest& requestProto, std::string& requestKey,
+    ResponseCache*& responseCache, SingleFlight*& singleFlight) {
+    responseCache = modelVersion.getResponseCache();
+    singleFlight = modelVersion.getSingleFlight();
+    if ((responseCache || singleFlight) && !ResponseCache::createKey(requestProto, requestKey)) {
+        responseCache = nullptr;
+        singleFlight = nullptr;
+    }
+}
+
+/**
+ * @brief Runs inference of validated request on a stream of model instance, or with its dynamic batcher
+ *
+ * When sequence is set, its memory states are loaded into the stream before and stored back after the inference
+ */
+static Status inferenceOnStream(
     ModelInstance& modelVersion,
     const PredictRequest* requestProto,
     PredictResponse* responseProto,
-    std::unique_ptr<ModelInstanceUnloadGuard>& modelUnloadGuardPtr) {
-    Timer timer;
-    using std::chrono::microseconds;
+    const deadline_t& deadline,
+    Sequence* sequence = nullptr) {
+    Status status;
 
-    auto status = modelVersion.validate(requestProto);
-    status = reloadModelIfRequired(status, modelVersion, requestProto, modelUnloadGuardPtr);
-    if (!status.ok())
+    PendingRequestGuard pendingRequestGuard(modelVersion);
+    if (!pendingRequestGuard.isAdmitted()) {
+        OVMS_HOT_PATH_DEBUG("Rejecting request to model {}, version {}; pending requests limit: {} reached",
+            requestProto->model_spec().name(), modelVersion.getVersion(), modelVersion.getModelConfig().getMaxPendingRequests());
+        return StatusCode::TOO_MANY_PENDING_REQUESTS;
+    }
+
+    const size_t requestBatchSize = getRequestBatchSize(requestProto);
+    if (modelVersion.isBatchSplitRequired(requestBatchSize) || modelVersion.isBatchPaddingRequired(requestBatchSize)) {
+        const auto splitInferenceStart = std::chrono::steady_clock::now();
+        Span splitInferenceSpan("split_batch_inference");
+        status = inferSplitBatch(modelVersion.getSplitBatchInferRequestsQueues(DIRECT_INFER_REQUESTS_POOL), modelVersion.getModelConfig().getReplicaRouting(),
+            modelVersion.getInputsInfo(), modelVersion.getOutputsInfo(), modelVersion.getBatchSize(), requestProto, responseProto, deadline);
+        splitInferenceSpan.end();
+        RequestTimings::recordCurrentSince(RequestTimingStage::INFERENCE, splitInferenceStart);
+        OVMS_HOT_PATH_DEBUG("Split batch inference duration in model {}, version {}: {:.3f} ms",
+            requestProto->model_spec().name(), modelVersion.getVersion(),
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - splitInferenceStart).count());
         return status;
+    }
 
-    timer.start("get infer request");
-    ovms::OVInferRequestsQueue& inferRequestsQueue = modelVersion.getInferRequestsQueue();
-    ExecutingStreamIdGuard executingStreamIdGuard(inferRequestsQueue);
+    auto dynamicBatcher = modelVersion.getDynamicBatcher();
+    if (dynamicBatcher) {
+        const auto batchedInferenceStart = std::chrono::steady_clock::now();
+        Span batchedInferenceSpan("batched_inference");
+        status = dynamicBatcher->infer(requestProto, responseProto, deadline);
+        batchedInferenceSpan.end();
+        RequestTimings::recordCurrentSince(RequestTimingStage::INFERENCE, batchedInferenceStart);
+        OVMS_HOT_PATH_DEBUG("Batched inference duration in model {}, version {}: {:.3f} ms",
+            requestProto->model_spec().name(), modelVersion.getVersion(),
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchedInferenceStart).count());
+        return status;
+    }
+
+    auto stageStart = std::chrono::steady_clock::now();
+    Span streamAcquisitionSpan("stream_acquisition");
+    ovms::OVInferRequestsQueue& inferRequestsQueue = modelVersion.getInferRequestsQueue(DIRECT_INFER_REQUESTS_POOL);
+    ExecutingStreamIdGuard executingStreamIdGuard(inferRequestsQueue, deadline);
     int executingInferId = executingStreamIdGuard.getId();
+    if (executingInferId == EXPIRED_STREAM_ID || isDeadlineExceeded(deadline)) {
+        OVMS_HOT_PATH_DEBUG("Dropping request to model {}, version {}; deadline exceeded while waiting for infer request",
+            requestProto->model_spec().name(), modelVersion.getVersion());
+        return StatusCode::DEADLINE_EXCEEDED;
+    }
     InferenceEngine::InferRequest& inferRequest = inferRequestsQueue.getInferRequest(executingInferId);
-    timer.stop("get infer request");
-    SPDLOG_DEBUG("Getting infer req duration in model {}, version {}, nireq {}: {:.3f} ms",
-        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, timer.elapsed<microseconds>("get infer request") / 1000);
+    streamAcquisitionSpan.end();
+    ModelMetrics& metrics = *modelVersion.getMetrics();
+    auto stageMicroseconds = metrics.recordStageSince(ModelStage::STREAM_WAIT, stageStart);
+    RequestTimings::recordCurrent(RequestTimingStage::STREAM_WAIT, stageMicroseconds);
+    metrics.recordBatchSize(getRequestBatchSize(requestProto));
+    OVMS_HOT_PATH_DEBUG("Getting infer req duration in model {}, version {}, nireq {}: {:.3f} ms",
+        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, stageMicroseconds / 1000.0);
 
-    timer.start("deserialize");
-    status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(*requestProto, modelVersion.getInputsInfo(), inferRequest);
-    timer.stop("deserialize");
+    stageStart = std::chrono::steady_clock::now();
+    Span deserializeSpan("deserialize");
+    {
+        AllocationPhaseGuard allocationPhase(AllocationPhase::DESERIALIZE);
+        status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(*requestProto, modelVersion.getInputsInfo(), inferRequest,
+            &inferRequestsQueue.getPreallocatedInputBlobs(executingInferId));
+    }
+    deserializeSpan.end();
+    stageMicroseconds = metrics.recordStageSince(ModelStage::DESERIALIZATION, stageStart);
+    RequestTimings::recordCurrent(RequestTimingStage::DESERIALIZATION, stageMicroseconds);
+    if (!status.ok())
+        return status;
+    OVMS_HOT_PATH_DEBUG("Deserialization duration in model {}, version {}, nireq {}: {:.3f} ms",
+        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, stageMicroseconds / 1000.0);
+    // has to be released before the stream is returned
+    ResponseOutputBlobsGuard responseOutputBlobs(inferRequest);
+    status = responseOutputBlobs.prepare(modelVersion.getOutputsInfo(), responseProto, &requestProto->output_filter());
     if (!status.ok())
         return status;
-    SPDLOG_DEBUG("Deserialization duration in model {}, version {}, nireq {}: {:.3f} ms",
-        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, timer.elapsed<microseconds>("deserialize") / 1000);
-    timer.start("prediction");
-    status = performInference(inferRequestsQueue, executingInferId, inferRequest);
-    timer.stop("prediction");
+    if (sequence) {
+        status = restoreMemoryState(inferRequest, *sequence);
+        if (!status.ok())
+            return status;
+    }
+    stageStart = std::chrono::steady_clock::now();
+    Span inferSpan("infer");
+    {
+        AllocationPhaseGuard allocationPhase(AllocationPhase::INFER);
+        status = performInference(inferRequestsQueue, executingInferId, inferRequest);
+    }
+    inferSpan.end();
+    stageMicroseconds = metrics.recordStageSince(ModelStage::INFERENCE, stageStart);
+    RequestTimings::recordCurrent(RequestTimingStage::INFERENCE, stageMicroseconds);
     if (!status.ok())
         return status;
-    SPDLOG_DEBUG("Prediction duration in model {}, version {}, nireq {}: {:.3f} ms",
-        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, timer.elapsed<microseconds>("prediction") / 1000);
+    if (sequence) {
+        status = storeMemoryState(inferRequest, *sequence);
+        if (!status.ok())
+            return status;
+    }
+    OVMS_HOT_PATH_DEBUG("Prediction duration in model {}, version {}, nireq {}: {:.3f} ms",
+        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, stageMicroseconds / 1000.0);
 
-    timer.start("serialize");
-    status = serializePredictResponse(inferRequest, modelVersion.getOutputsInfo(), responseProto);
-    timer.stop("serialize");
+    stageStart = std::chrono::steady_clock::now();
+    Span serializeSpan("serialize");
+    {
+        AllocationPhaseGuard allocationPhase(AllocationPhase::SERIALIZE);
+        status = serializePredictResponse(inferRequest, modelVersion.getOutputsInfo(), responseProto, &responseOutputBlobs, &requestProto->output_filter());
+    }
+    serializeSpan.end();
+    stageMicroseconds = metrics.recordStageSince(ModelStage::SERIALIZATION, stageStart);
+    RequestTimings::recordCurrent(RequestTimingStage::SERIALIZATION, stageMicroseconds);
     if (!status.ok())
         return status;
-    SPDLOG_DEBUG("Serialization duration in model {}, version {}, nireq {}: {:.3f} ms",
-        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, timer.elapsed<microseconds>("serialize") / 1000);
+    OVMS_HOT_PATH_DEBUG("Serialization duration in model {}, version {}, nireq {}: {:.3f} ms",
+        requestProto->model_spec().name(), modelVersion.getVersion(), executingInferId, stageMicroseconds / 1000.0);
 
     return StatusCode::OK;
 }
 
+/**
+ * @brief Runs inference of request to stateful model with memory states of sequence selected by special inputs
+ *
+ * Requests of one sequence are executed one after another, each of them on any of the streams.
+ */
+static Status inferenceOnSequence(
+    ModelInstance& modelVersion,
+    const PredictRequest* requestProto,
+    PredictResponse* responseProto,
+    const deadline_t& deadline) {
+    SequenceProcessingSpec spec;
+    auto status = extractSequenceProcessingSpec(*requestProto, spec);
+    if (!status.ok()) {
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", requestProto->model_spec().name(), modelVersion.getVersion(), status.string());
+        return status;
+    }
+    SequenceManager& sequenceManager = *modelVersion.getSequenceManager();
+    std::shared_ptr<Sequence> sequence;
+    status = sequenceManager.getSequence(spec, sequence);
+    if (!status.ok()) {
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] {}", requestProto->model_spec().name(), modelVersion.getVersion(), status.string());
+        return status;
+    }
+    std::unique_lock<std::timed_mutex> sequenceLock(sequence->getMutex(), std::defer_lock);
+    if (deadline == NO_DEADLINE) {
+        sequenceLock.lock();
+    } else if (!sequenceLock.try_lock_until(deadline)) {
+        OVMS_HOT_PATH_DEBUG("[Model: {} version: {}] Deadline passed while waiting for previous request of sequence: {}",
+            requestProto->model_spec().name(), modelVersion.getVersion(), sequence->getId());
+        return StatusCode::DEADLINE_EXCEEDED;
+    }
+    // sequence could be ended or timed out while waiting for the previous request
+    if (sequence->isTerminated()) {
+        return Status::withDetails(StatusCode::SEQUENCE_MISSING, "Sequence id: ", sequence->getId());
+    }
+    status = inferenceOnStream(modelVersion, requestProto, responseProto, deadline, sequence.get());
+    sequence->touch();
+    if (status.ok()) {
+        addSequenceIdOutput(sequence->getId(), *responseProto);
+    }
+    // sequence which failed to start can be started again with the same id
+    if (spec.control == SEQUENCE_END || (!status.ok() && spec.control == SEQUENCE_START)) {
+        sequenceManager.removeSequence(sequence->getId());
+    }
+    return status;
+}
+
+/**
+ * @brief Runs inference of request on model version or on its shape variant
+ */
+static Status inferenceOnModelVersion(
+    ModelInstance& modelVersion,
+    const PredictRequest* requestProto,
+    PredictResponse* responseProto,
+    std::unique_ptr<ModelInstanceUnloadGuard>& modelUnloadGuardPtr,
+    const deadline_t& deadline) {
+    const auto validationStart = std::chrono::steady_clock::now();
+    Span validationSpan("validation");
+    Status status;
+    {
+        AllocationPhaseGuard allocationPhase(AllocationPhase::VALIDATE);
+        status = modelVersion.validate(requestProto);
+    }
+    validationSpan.end();
+    RequestTimings::recordCurrentSince(RequestTimingStage::VALIDATION, validationStart);
+    if (modelVersion.isShapeVariantRequired(status)) {
+        // model unload guard is kept so the model version is not unloaded while its variant is used
+        std::shared_ptr<ModelInstance> shapeVariant;
+        std::unique_ptr<ModelInstanceUnloadGuard> shapeVariantUnloadGuardPtr;
+        const auto variantStart = std::chrono::steady_clock::now();
+        status = getShapeVariant(status, modelVersion, requestProto, shapeVariant, shapeVariantUnloadGuardPtr);
+        RequestTimings::recordCurrentSince(RequestTimingStage::RELOAD_WAIT, variantStart);
+        if (!status.ok())
+            return status;
+        return inferenceOnModelVersion(*shapeVariant, requestProto, responseProto, shapeVariantUnloadGuardPtr, deadline);
+    }
+    const bool reloadRequired = status.batchSizeChangeRequired() || status.reshapeRequired();
+    const auto reloadStart = std::chrono::steady_clock::now();
+    status = reloadModelIfRequired(status, modelVersion, requestProto, modelUnloadGuardPtr);
+    if (reloadRequired) {
+        RequestTimings::recordCurrentSince(RequestTimingStage::RELOAD_WAIT, reloadStart);
+    }
+    if (!status.ok())
+        return status;
+
+    if (isDeadlineExceeded(deadline)) {
+        OVMS_HOT_PATH_DEBUG("Dropping request to model {}, version {}; deadline exceeded", requestProto->model_spec().name(), modelVersion.getVersion());
+        return StatusCode::DEADLINE_EXCEEDED;
+    }
+
+    if (modelVersion.getSequenceManager()) {
+        return inferenceOnSequence(modelVersion, requestProto, responseProto, deadline);
+    }
+
+    std::string requestKey;
+    ResponseCache* responseCache = nullptr;
+    SingleFlight* singleFlight = nullptr;
+    getRequestDeduplication(modelVersion, *requestProto, requestKey, responseCache, singleFlight);
+    if (responseCache && responseCache->get(requestKey, responseProto)) {
+        OVMS_HOT_PATH_DEBUG("Response of model {}, version {} found in cache", requestProto->model_spec().name(), modelVersion.getVersion());
+        return StatusCode::OK;
+    }
+    if (singleFlight) {
+        SingleFlightWaiter waiter(responseProto);
+        if (!singleFlight->join(requestKey, waiter.createFollower())) {
+            OVMS_HOT_PATH_DEBUG("Waiting for identical request to model {}, version {} in flight", requestProto->model_spec().name(), modelVersion.getVersion());
+            return waiter.wait(deadline);
+        }
+    }
+
+    status = inferenceOnStream(modelVersion, requestProto, responseProto, deadline);
+    if (singleFlight) {
+        singleFlight->complete(requestKey, status, *responseProto);
+    }
+    if (status.ok() && responseCache) {
+        responseCache->put(std::move(requestKey), *responseProto);
+    }
+    return status;
+}
+
+Status inference(
+    ModelInstance& modelVersion,
+    const PredictRequest* requestProto,
+    PredictResponse* responseProto,
+    std::unique_ptr<ModelInstanceUnloadGuard>& modelUnloadGuardPtr,
+    const deadline_t& deadline) {
+    HotPathTimer<HotPathStage::INFERENCE> timer;
+    ProfilerTag profilerTag("inference");
+    // model version may be switched to a reloaded one, keep statistics alive until the request is counted
+    auto metrics = modelVersion.getMetrics();
+    auto status = inferenceOnModelVersion(modelVersion, requestProto, responseProto, modelUnloadGuardPtr, deadline);
+    metrics->recordRequest(status.ok());
+    return status;
+}
+
+namespace {
+/**
+ * @brief Asynchronous request waiting for identical request in flight until its deadline
+ */
+struct AsyncFollower {
+    std::atomic<bool> called{false};
+    // NO_TIMER until scheduled, timer left by a leader completing meanwhile finds the follower called
+    std::atomic<DeadlineTimer::timer_id_t> timer{DeadlineTimer::NO_TIMER};
+};
+
+struct AsyncInferenceContext {
+    std::shared_ptr<ModelInstance> modelVersion;
+    const PredictRequest* requestProto;
+    PredictResponse* responseProto;
+    std::unique_ptr<ModelInstanceUnloadGuard> modelUnloadGuardPtr;
+    std::unique_ptr<PendingRequestGuard> pendingRequestGuard;
+    std::unique_ptr<ResponseOutputBlobsGuard> responseOutputBlobs;
+    inference_callback_t callback;
+    deadline_t deadline;
+    ResponseCache* responseCache = nullptr;
+    SingleFlight* singleFlight = nullptr;
+    std::string requestKey;
+    std::chrono::steady_clock::time_point stageStart;
+    // stages run on threads returning streams and in completion callbacks, outside of the caller trace scope
+    TraceContext traceContext;
+    Span stageSpan;
+    // owned by the caller and valid until callback is called, nullptr when the client did not ask for timings
+    RequestTimings* timings = nullptr;
+
+    void recordTiming(RequestTimingStage stage, uint64_t microseconds) {
+        if (timings != nullptr) {
+            timings->record(stage, microseconds);
+        }
+    }
+};
+
+/**
+ * @brief Records split or batched inference started at stage start, queueing included
+ */
+void recordInferenceTiming(AsyncInferenceContext& context) {
+    context.recordTiming(RequestTimingStage::INFERENCE,
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - context.stageStart).count());
+}
+
+void finishAsyncInference(std::shared_ptr<AsyncInferenceContext> context, const Status& status) {
+    context->stageSpan.end();
+    if (context->singleFlight) {
+        context->singleFlight->complete(context->requestKey, status, *context->responseProto);
+    }
+    if (status.ok() && context->responseCache) {
+        context->responseCache->put(std::move(context->requestKey), *context->responseProto);
+    }
+    // Model instance may be unloaded as soon as the guard is released, nothing from it can be used afterwards
+    context->pendingRequestGuard.reset();
+    context->modelUnloadGuardPtr.reset();
+    context->modelVersion.reset();
+    context->callback(status);
+}
+
+void startAsyncInference(std::shared_ptr<AsyncInferenceContext> context, ovms::OVInferRequestsQueue& inferRequestsQueue, int executingInferId) {
+    if (executingInferId == EXPIRED_STREAM_ID) {
+        finishAsyncInference(std::move(context), StatusCode::DEADLINE_EXCEEDED);
+        return;
+    }
+    if (isDeadlineExceeded(context->deadline)) {
+        inferRequestsQueue.returnStream(executingInferId);
+        finishAsyncInference(std::move(context), StatusCode::DEADLINE_EXCEEDED);
+        return;
+    }
+    context->stageSpan.end();
+    ModelInstance& modelVersion = *context->modelVersion;
+    ModelMetrics& metrics = *modelVersion.getMetrics();
+    context->recordTiming(RequestTimingStage::STREAM_WAIT, metrics.recordStageSince(ModelStage::STREAM_WAIT, context->stageStart));
+    metrics.recordBatchSize(getRequestBatchSize(context->requestProto));
+    InferenceEngine::InferRequest& inferRequest = inferRequestsQueue.getInferRequest(executingInferId);
+
+    Span deserializeSpan("deserialize", &context->traceContext);
+    const auto deserializeStart = std::chrono::steady_clock::now();
+    Status status;
+    {
+        AllocationPhaseGuard allocationPhase(AllocationPhase::DESERIALIZE);
+        status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(*context->requestProto, modelVersion.getInputsInfo(), inferRequest,
+            &inferRequestsQueue.getPreallocatedInputBlobs(executingInferId));
+    }
+    context->recordTiming(RequestTimingStage::DESERIALIZATION, metrics.recordStageSince(ModelStage::DESERIALIZATION, deserializeStart));
+    deserializeSpan.end();
+    if (status.ok()) {
+        context->responseOutputBlobs = std::make_unique<ResponseOutputBlobsGuard>(inferRequest);
+        status = context->responseOutputBlobs->prepare(modelVersion.getOutputsInfo(), context->responseProto, &context->requestProto->output_filter());
+    }
+    if (!status.ok()) {
+        context->responseOutputBlobs.reset();
+        inferRequestsQueue.returnStream(executingInferId);
+        finishAsyncInference(std::move(context), status);
+        return;
+    }
+
+    try {
+        inferRequest.SetCompletionCallback(std::function<void(InferenceEngine::InferRequest, InferenceEngine::StatusCode)>(
+            [context, executingInferId, &inferRequest, &inferRequestsQueue](InferenceEngine::InferRequest, InferenceEngine::StatusCode code) {
+                // Resetting the completion callback below destroys this lambda together with its captures,
+                // so everything needed afterwards is copied into locals first
+                auto finishedContext = context;
+                const int finishedInferId = executingInferId;
+                auto& finishedInferRequest = inferRequest;
+                auto& finishedInferRequestsQueue = inferRequestsQueue;
+                finishedContext->stageSpan.end();
+                ModelMetrics& finishedMetrics = *finishedContext->modelVersion->getMetrics();
+                finishedContext->recordTiming(RequestTimingStage::INFERENCE, finishedMetrics.recordStageSince(ModelStage::INFERENCE, finishedContext->stageStart));
+                Status status = StatusCode::OK;
+                if (code != InferenceEngine::StatusCode::OK) {
+                    status = StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+                    SPDLOG_ERROR("Async infer failed {}: {}", status.string(), code);
+                } else {
+                    Span serializeSpan("serialize", &finishedContext->traceContext);
+                    const auto serializeStart = std::chrono::steady_clock::now();
+                    AllocationPhaseGuard allocationPhase(AllocationPhase::SERIALIZE);
+                    status = serializePredictResponse(finishedInferRequest, finishedContext->modelVersion->getOutputsInfo(), finishedContext->responseProto,
+                        finishedContext->responseOutputBlobs.get(), &finishedContext->requestProto->output_filter());
+                    finishedContext->recordTiming(RequestTimingStage::SERIALIZATION, finishedMetrics.recordStageSince(ModelStage::SERIALIZATION, serializeStart));
+                }
+                finishedContext->responseOutputBlobs.reset();
+                finishedInferRequest.SetCompletionCallback([]() {});  // reset callback on infer request
+                finishedInferRequestsQueue.returnStream(finishedInferId);
+                finishAsyncInference(std::move(finishedContext), status);
+            }));
+        context->stageSpan = Span("infer", &context->traceContext);
+        context->stageStart = std::chrono::steady_clock::now();
+        AllocationPhaseGuard allocationPhase(AllocationPhase::INFER);
+        inferRequest.StartAsync();
+    } catch (const InferenceEngine::details::InferenceEngineException& e) {
+        status = StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+        SPDLOG_ERROR("Async caught an exception {}: {}", status.string(), e.what());
+        inferRequest.SetCompletionCallback([]() {});
+        context->responseOutputBlobs.reset();
+        inferRequestsQueue.returnStream(executingInferId);
+        finishAsyncInference(std::move(context), status);
+    }
+}
+}  // namespace
+
+/**
+ * @brief Starts inference of request on model version or on its shape variant
+ */
+static void inferenceAsyncOnModelVersion(
+    std::shared_ptr<ModelInstance> modelVersion,
+    const PredictRequest* requestProto,
+    PredictResponse* responseProto,
+    std::unique_ptr<ModelInstanceUnloadGuard> modelUnloadGuardPtr,
+    inference_callback_t callback,
+    const deadline_t& deadline) {
+    const auto validationStart = std::chrono::steady_clock::now();
+    Span validationSpan("validation");
+    auto status = modelVersion->validate(requestProto);
+    validationSpan.end();
+    RequestTimings::recordCurrentSince(RequestTimingStage::VALIDATION, validationStart);
+    if (modelVersion->isShapeVariantRequired(status)) {
+        std::shared_ptr<ModelInstance> shapeVariant;
+        std::unique_ptr<ModelInstanceUnloadGuard> shapeVariantUnloadGuardPtr;
+        const auto variantStart = std::chrono::steady_clock::now();
+        status = getShapeVariant(status, *modelVersion, requestProto, shapeVariant, shapeVariantUnloadGuardPtr);
+        RequestTimings::recordCurrentSince(RequestTimingStage::RELOAD_WAIT, variantStart);
+        if (!status.ok()) {
+            callback(status);
+            return;
+        }
+        // model unload guard is kept until variant inference is finished
+        std::shared_ptr<ModelInstanceUnloadGuard> sharedUnloadGuardPtr = std::move(modelUnloadGuardPtr);
+        inferenceAsyncOnModelVersion(std::move(shapeVariant), requestProto, responseProto, std::move(shapeVariantUnloadGuardPtr),
+            [sharedUnloadGuardPtr, callback = std::move(callback)](Status status) mutable {
+                sharedUnloadGuardPtr.reset();
+                callback(status);
+            },
+            deadline);
+        return;
+    }
+    const bool reloadRequired = status.batchSizeChangeRequired() || status.reshapeRequired();
+    const auto reloadStart = std::chrono::steady_clock::now();
+    status = reloadModelIfRequired(status, *modelVersion, requestProto, modelUnloadGuardPtr);
+    if (reloadRequired) {
+        RequestTimings::recordCurrentSince(RequestTimingStage::RELOAD_WAIT, reloadStart);
+    }
+    if (!status.ok()) {
+        callback(status);
+        return;
+    }
+    if (isDeadlineExceeded(deadline)) {
+        callback(StatusCode::DEADLINE_EXCEEDED);
+        return;
+    }
+    if (modelVersion->getSequenceManager()) {
+        // sequence is locked for the whole inference, requests to stateful models are executed in the calling thread
+        status = inferenceOnSequence(*modelVersion, requestProto, responseProto, deadline);
+        modelUnloadGuardPtr.reset();
+        modelVersion.reset();
+        callback(status);
+        return;
+    }
+    std::string requestKey;
+    ResponseCache* responseCache = nullptr;
+    SingleFlight* singleFlight = nullptr;
+    getRequestDeduplication(*modelVersion, *requestProto, requestKey, responseCache, singleFlight);
+    if (responseCache && responseCache->get(requestKey, responseProto)) {
+        OVMS_HOT_PATH_DEBUG("Response of model {}, version {} found in cache", requestProto->model_spec().name(), modelVersion->getVersion());
+        modelUnloadGuardPtr.reset();
+        modelVersion.reset();
+        callback(StatusCode::OK);
+        return;
+    }
+    if (singleFlight) {
+        // follower keeps the model version loaded until it is called by the leading request
+        std::shared_ptr<ModelInstanceUnloadGuard> followerUnloadGuardPtr = std::move(modelUnloadGuardPtr);
+        // whichever of the leading request and the deadline comes first calls the callback
+        auto follower = std::make_shared<AsyncFollower>();
+        const bool leader = singleFlight->join(requestKey,
+            [followerUnloadGuardPtr, responseProto, callback, follower](const Status& status, const PredictResponse& response) mutable {
+                if (follower->called.exchange(true)) {
+                    followerUnloadGuardPtr.reset();
+                    return;
+                }
+                DeadlineTimer::instance().cancel(follower->timer);
+                if (status.ok()) {
+                    responseProto->CopyFrom(response);
+                }
+                followerUnloadGuardPtr.reset();
+                callback(status);
+            });
+        if (!leader) {
+            OVMS_HOT_PATH_DEBUG("Waiting for identical request to model {}, version {} in flight", requestProto->model_spec().name(), modelVersion->getVersion());
+            follower->timer = DeadlineTimer::instance().schedule(deadline, [callback, follower]() {
+                if (!follower->called.exchange(true)) {
+                    callback(StatusCode::DEADLINE_EXCEEDED);
+                }
+            });
+            return;
+        }
+        modelUnloadGuardPtr = std::make_unique<ModelInstanceUnloadGuard>(*modelVersion);
+    }
+    auto pendingRequestGuard = std::make_unique<PendingRequestGuard>(*modelVersion);
+    if (!pendingRequestGuard->isAdmitted()) {
+        OVMS_HOT_PATH_DEBUG("Rejecting request to model {}, version {}; pending requests limit: {} reached",
+            requestProto->model_spec().name(), modelVersion->getVersion(), modelVersion->getModelConfig().getMaxPendingRequests());
+        pendingRequestGuard.reset();
+        if (singleFlight) {
+            singleFlight->complete(requestKey, StatusCode::TOO_MANY_PENDING_REQUESTS, *responseProto);
+        }
+        callback(StatusCode::TOO_MANY_PENDING_REQUESTS);
+        return;
+    }
+
+    auto context = std::make_shared<AsyncInferenceContext>();
+    context->modelVersion = std::move(modelVersion);
+    context->requestProto = requestProto;
+    context->responseProto = responseProto;
+    context->modelUnloadGuardPtr = std::move(modelUnloadGuardPtr);
+    context->pendingRequestGuard = std::move(pendingRequestGuard);
+    context->callback = std::move(callback);
+    context->deadline = deadline;
+    context->responseCache = responseCache;
+    context->singleFlight = singleFlight;
+    context->requestKey = std::move(requestKey);
+    if (TraceScope::current() != nullptr) {
+        context->traceContext = *TraceScope::current();
+    }
+    context->timings = RequestTimings::current();
+
+    const size_t requestBatchSize = getRequestBatchSize(requestProto);
+    if (context->modelVersion->isBatchSplitRequired(requestBatchSize) || context->modelVersion->isBatchPaddingRequired(requestBatchSize)) {
+        auto& splitModelVersion = *context->modelVersion;
+        context->stageSpan = Span("split_batch_inference", &context->traceContext);
+        context->stageStart = std::chrono::steady_clock::now();
+        inferSplitBatchAsync(
+            splitModelVersion.getSplitBatchInferRequestsQueues(DIRECT_INFER_REQUESTS_POOL), splitModelVersion.getModelConfig().getReplicaRouting(),
+            splitModelVersion.getInputsInfo(), splitModelVersion.getOutputsInfo(), splitModelVersion.getBatchSize(),
+            requestProto, responseProto, [context](Status status) {
+                recordInferenceTiming(*context);
+                finishAsyncInference(context, status);
+            },
+            deadline);
+        return;
+    }
+    auto dynamicBatcher = context->modelVersion->getDynamicBatcher();
+    if (dynamicBatcher) {
+        context->stageSpan = Span("batched_inference", &context->traceContext);
+        context->stageStart = std::chrono::steady_clock::now();
+        dynamicBatcher->inferAsync(
+            requestProto, responseProto, [context](Status status) {
+                recordInferenceTiming(*context);
+                finishAsyncInference(context, status);
+            },
+            deadline);
+        return;
+    }
+    // Callback may run in a thread returning the stream on another NUMA node, keep the queue it is taken from
+    ovms::OVInferRequestsQueue& inferRequestsQueue = context->modelVersion->getInferRequestsQueue(DIRECT_INFER_REQUESTS_POOL);
+    // callback may be called right away, span is ended by it
+    context->stageSpan = Span("stream_acquisition", &context->traceContext);
+    context->stageStart = std::chrono::steady_clock::now();
+    inferRequestsQueue.getIdleStream(
+        [context, &inferRequestsQueue](int executingInferId) { startAsyncInference(context, inferRequestsQueue, executingInferId); },
+        deadline);
+}
+
+void inferenceAsync(
+    std::shared_ptr<ModelInstance> modelVersion,
+    const PredictRequest* requestProto,
+    PredictResponse* responseProto,
+    std::unique_ptr<ModelInstanceUnloadGuard> modelUnloadGuardPtr,
+    inference_callback_t callback,
+    const deadline_t& deadline) {
+    // statistics outlive the model version which may be unloaded before the callback is called
+    auto metrics = modelVersion->getMetrics();
+    const auto start = std::chrono::steady_clock::now();
+    inferenceAsyncOnModelVersion(std::move(modelVersion), requestProto, responseProto, std::move(modelUnloadGuardPtr),
+        [metrics = std::move(metrics), callback = std::move(callback), start](Status status) {
+            HotPathTimings::recordSince<HotPathStage::INFERENCE>(start);
+            metrics->recordRequest(status.ok());
+            callback(status);
+        },
+        deadline);
+}
+
+Status getShapeVariant(
+    Status validationStatus,
+    ModelInstance& modelInstance,
+    const PredictRequest* requestProto,
+    std::shared_ptr<ModelInstance>& shapeVariant,
+    std::unique_ptr<ModelInstanceUnloadGuard>& shapeVariantUnloadGuardPtr) {
+    auto status = modelInstance.getShapeVariant(requestProto, validationStatus, shapeVariant);
+    if (!status.ok()) {
+        if (status != StatusCode::RESHAPE_ERROR) {
+            SPDLOG_ERROR("Compiling model instance for request shape failed. Status Code: {}, Error: {}", status.getCode(), status.string());
+        }
+        return status;
+    }
+    return shapeVariant->waitForLoaded(WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, shapeVariantUnloadGuardPtr);
+}
+
 Status reloadModelIfRequired(
     Status validationStatus,
     ModelInstance& modelInstance,
@@ -164,12 +774,14 @@ Status reloadModelIfRequired(
     std::unique_ptr<ModelInstanceUnloadGuard>& modelUnloadGuardPtr) {
     Status status = validationStatus;
     if (status.batchSizeChangeRequired()) {
-        status = modelInstance.reloadModel(getRequestBatchSize(requestProto), {}, modelUnloadGuardPtr);
+        status = modelInstance.reloadModelInBackground(requestProto, status, DynamicModelParameter(getRequestBatchSize(requestProto)),
+            WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, modelUnloadGuardPtr);
         if (!status.ok()) {
             SPDLOG_ERROR("Model instance reload (batch size change) failed. Status Code: {}, Error {}", status.getCode(), status.string());
         }
     } else if (status.reshapeRequired()) {
-        status = modelInstance.reloadModel(0, getRequestShapes(requestProto), modelUnloadGuardPtr);
+        status = modelInstance.reloadModelInBackground(requestProto, status, DynamicModelParameter(getRequestShapes(requestProto, modelInstance.getInputsInfo())),
+            WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, modelUnloadGuardPtr);
         if (!status.ok() && status != StatusCode::RESHAPE_ERROR) {
             SPDLOG_ERROR("Model instance reload (reshape) failed. Status Code: {}, Error: {}", status.getCode(), status.string());
         }
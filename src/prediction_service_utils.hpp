@@ -14,9 +14,11 @@
 // limitations under the License.
 //*****************************************************************************
 #pragma once
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #pragma GCC diagnostic push
@@ -24,6 +26,7 @@
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #pragma GCC diagnostic pop
 
+#include "deadline.hpp"
 #include "modelinstance.hpp"
 #include "modelmanager.hpp"
 
@@ -31,8 +34,18 @@ namespace ovms {
 
 const uint WAIT_FOR_MODEL_LOADED_TIMEOUT_MS = 10000;
 
+/**
+ * @brief Gives W3C traceparent sent by gRPC client in call metadata, empty when there is none
+ */
+std::string_view getTraceparent(const grpc::ServerContext& context);
+
+/**
+ * @brief Checks if gRPC client asked for timings of its request in call metadata
+ */
+bool isServerTimingRequested(const grpc::ServerContext& context);
+
 size_t getRequestBatchSize(const tensorflow::serving::PredictRequest* request);
-std::map<std::string, shape_t> getRequestShapes(const tensorflow::serving::PredictRequest* request);
+std::map<std::string, shape_t> getRequestShapes(const tensorflow::serving::PredictRequest* request, const tensor_map_t& inputsInfo);
 
 Status getModelInstance(ModelManager& manager,
     const std::string& modelName,
@@ -47,11 +60,65 @@ Status getPipeline(ModelManager& manager,
 
 Status performInference(ovms::OVInferRequestsQueue& inferRequestsQueue, const int executingInferId, InferenceEngine::InferRequest& inferRequest);
 
+/**
+ * @brief Performs inference on model instance
+ *
+ * @param modelVersion
+ * @param requestProto
+ * @param responseProto
+ * @param modelUnloadGuardPtr
+ * @param deadline request is dropped with DEADLINE_EXCEEDED if it passes before inference is started
+ *
+ * @return Status
+ */
 Status inference(
     ModelInstance& modelVersion,
     const tensorflow::serving::PredictRequest* requestProto,
     tensorflow::serving::PredictResponse* responseProto,
-    std::unique_ptr<ModelInstanceUnloadGuard>& modelUnloadGuardPtr);
+    std::unique_ptr<ModelInstanceUnloadGuard>& modelUnloadGuardPtr,
+    const deadline_t& deadline = NO_DEADLINE);
+
+using inference_callback_t = std::function<void(Status)>;
+
+/**
+ * @brief Starts inference without blocking the calling thread until the result is ready
+ *
+ * Infer request is acquired, filled and started from whichever thread releases a stream.
+ * Response is serialized and callback is called from OpenVINO completion callback.
+ * Request and response have to stay valid until callback is called.
+ *
+ * @param modelVersion
+ * @param requestProto
+ * @param responseProto
+ * @param modelUnloadGuardPtr released before callback is called
+ * @param callback called exactly once with the inference status
+ * @param deadline request is dropped with DEADLINE_EXCEEDED if it passes before inference is started
+ */
+void inferenceAsync(
+    std::shared_ptr<ModelInstance> modelVersion,
+    const tensorflow::serving::PredictRequest* requestProto,
+    tensorflow::serving::PredictResponse* responseProto,
+    std::unique_ptr<ModelInstanceUnloadGuard> modelUnloadGuardPtr,
+    inference_callback_t callback,
+    const deadline_t& deadline = NO_DEADLINE);
+
+/**
+ * @brief Gets loaded model instance compiled for request shapes, cached in model instance
+ *
+ * @param validationStatus
+ * @param modelInstance
+ * @param requestProto
+ * @param shapeVariant
+ * @param shapeVariantUnloadGuardPtr
+ *
+ * @return Status
+ */
+Status getShapeVariant(
+    Status validationStatus,
+    ModelInstance& modelInstance,
+    const tensorflow::serving::PredictRequest* requestProto,
+    std::shared_ptr<ModelInstance>& shapeVariant,
+    std::unique_ptr<ModelInstanceUnloadGuard>& shapeVariantUnloadGuardPtr);
 
 Status reloadModelIfRequired(
     Status validationStatus,
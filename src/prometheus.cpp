@@ -0,0 +1,129 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "prometheus.hpp"
+
+#include <cstdio>
+
+namespace ovms {
+
+const std::vector<uint64_t>& PrometheusWriter::getBucketBounds() {
+    static const std::vector<uint64_t> bounds = {
+        100, 250, 500,
+        1000, 2500, 5000,
+        10000, 25000, 50000,
+        100000, 250000, 500000,
+        1000000, 2500000, 5000000,
+        10000000, 30000000, 60000000, 300000000};
+    return bounds;
+}
+
+static std::string formatDouble(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+static std::string formatSeconds(uint64_t microseconds) {
+    return formatDouble(static_cast<double>(microseconds) / 1000000);
+}
+
+std::string PrometheusWriter::escapeLabelValue(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        default:
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void PrometheusWriter::writeFamily(const std::string& name, const char* type, const std::string& help) {
+    if (!writtenFamilies.insert(name).second) {
+        return;
+    }
+    text += "# HELP " + name + " " + help + "\n";
+    text += "# TYPE " + name + " " + type + "\n";
+}
+
+void PrometheusWriter::writeSample(const std::string& name, const labels_t& labels, const std::string& value,
+    const std::pair<std::string, std::string>* extraLabel) {
+    text += name;
+    if (!labels.empty() || extraLabel != nullptr) {
+        text += "{";
+        bool first = true;
+        auto writeLabel = [this, &first](const std::pair<std::string, std::string>& label) {
+            if (!first) {
+                text += ",";
+            }
+            first = false;
+            text += label.first + "=\"" + escapeLabelValue(label.second) + "\"";
+        };
+        for (const auto& label : labels) {
+            writeLabel(label);
+        }
+        if (extraLabel != nullptr) {
+            writeLabel(*extraLabel);
+        }
+        text += "}";
+    }
+    text += " " + value + "\n";
+}
+
+void PrometheusWriter::counter(const std::string& name, const std::string& help, const labels_t& labels, uint64_t value) {
+    writeFamily(name, "counter", help);
+    writeSample(name, labels, std::to_string(value));
+}
+
+void PrometheusWriter::gauge(const std::string& name, const std::string& help, const labels_t& labels, double value) {
+    writeFamily(name, "gauge", help);
+    writeSample(name, labels, formatDouble(value));
+}
+
+void PrometheusWriter::histogram(const std::string& name, const std::string& help, const labels_t& labels, const LatencyHistogram& histogram) {
+    writeFamily(name, "histogram", help);
+    const auto& bounds = getBucketBounds();
+    // single pass over buckets, total is their sum so that +Inf bucket and count match even while values are recorded
+    uint64_t cumulative = 0;
+    size_t index = 0;
+    for (uint64_t bound : bounds) {
+        while (index < LatencyHistogram::BUCKETS_COUNT && LatencyHistogram::getBucketUpperBound(index) <= bound) {
+            cumulative += histogram.getBucketCount(index);
+            ++index;
+        }
+        const std::pair<std::string, std::string> le{"le", formatSeconds(bound)};
+        writeSample(name + "_bucket", labels, std::to_string(cumulative), &le);
+    }
+    for (; index < LatencyHistogram::BUCKETS_COUNT; ++index) {
+        cumulative += histogram.getBucketCount(index);
+    }
+    const std::pair<std::string, std::string> le{"le", "+Inf"};
+    writeSample(name + "_bucket", labels, std::to_string(cumulative), &le);
+    writeSample(name + "_sum", labels, formatSeconds(histogram.getSum()));
+    writeSample(name + "_count", labels, std::to_string(cumulative));
+}
+
+}  // namespace ovms
@@ -0,0 +1,67 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "latencyhistogram.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Builds metrics in Prometheus text exposition format
+ *
+ * Samples of one metric family have to be written one after another, family header is written before its first sample.
+ * Latency histograms are reported in seconds with fixed bucket bounds. Count of a bound is taken from histogram buckets
+ * ending below it, so it is within histogram precision of the exact one.
+ */
+class PrometheusWriter {
+public:
+    using labels_t = std::vector<std::pair<std::string, std::string>>;
+
+    static constexpr const char* CONTENT_TYPE = "text/plain; version=0.0.4";
+
+    /**
+     * @brief Bucket bounds of reported latency histograms in microseconds
+     */
+    static const std::vector<uint64_t>& getBucketBounds();
+
+    void counter(const std::string& name, const std::string& help, const labels_t& labels, uint64_t value);
+
+    void gauge(const std::string& name, const std::string& help, const labels_t& labels, double value);
+
+    void histogram(const std::string& name, const std::string& help, const labels_t& labels, const LatencyHistogram& histogram);
+
+    const std::string& getText() const {
+        return text;
+    }
+
+    static std::string escapeLabelValue(const std::string& value);
+
+private:
+    void writeFamily(const std::string& name, const char* type, const std::string& help);
+
+    void writeSample(const std::string& name, const labels_t& labels, const std::string& value,
+        const std::pair<std::string, std::string>* extraLabel = nullptr);
+
+    std::string text;
+    std::set<std::string> writtenFamilies;
+};
+
+}  // namespace ovms
@@ -0,0 +1,62 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "protoarena.hpp"
+
+#include <vector>
+
+namespace ovms {
+
+namespace {
+// Holds messages of small tensor requests, larger ones spill over into blocks allocated on demand
+const size_t THREAD_ARENA_INITIAL_BLOCK_SIZE = 64 * 1024;
+
+struct ThreadArena {
+    ThreadArena() :
+        initialBlock(THREAD_ARENA_INITIAL_BLOCK_SIZE) {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = initialBlock.data();
+        options.initial_block_size = initialBlock.size();
+        arena = std::make_unique<google::protobuf::Arena>(options);
+    }
+
+    std::vector<char> initialBlock;
+    std::unique_ptr<google::protobuf::Arena> arena;
+    bool inUse = false;
+};
+
+thread_local ThreadArena threadArena;
+}  // namespace
+
+ThreadLocalArenaGuard::ThreadLocalArenaGuard() {
+    if (threadArena.inUse) {
+        nestedArena = std::make_unique<google::protobuf::Arena>();
+        arena = nestedArena.get();
+        return;
+    }
+    threadArena.inUse = true;
+    arena = threadArena.arena.get();
+}
+
+ThreadLocalArenaGuard::~ThreadLocalArenaGuard() {
+    if (nestedArena) {
+        return;
+    }
+    // destroys messages and frees spilled blocks, initial block is kept for the next request
+    arena->Reset();
+    threadArena.inUse = false;
+}
+
+}  // namespace ovms
@@ -0,0 +1,99 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <memory>
+
+#include <google/protobuf/arena.h>
+
+namespace ovms {
+
+/**
+ * @brief Lends protobuf arena of the current thread for messages of a single request. Arena is reset when the guard
+ * is destroyed and its initial block is reused by the next request handled by the thread. Guard created while
+ * another one is alive on the same thread gets its own arena.
+ */
+class ThreadLocalArenaGuard {
+public:
+    ThreadLocalArenaGuard();
+
+    ~ThreadLocalArenaGuard();
+
+    ThreadLocalArenaGuard(const ThreadLocalArenaGuard&) = delete;
+    ThreadLocalArenaGuard& operator=(const ThreadLocalArenaGuard&) = delete;
+
+    google::protobuf::Arena* get() const {
+        return arena;
+    }
+
+    /**
+     * @brief Creates message owned by the arena, it is valid until the guard is destroyed
+     */
+    template <typename T>
+    T* create() {
+        return google::protobuf::Arena::CreateMessage<T>(arena);
+    }
+
+private:
+    google::protobuf::Arena* arena;
+    std::unique_ptr<google::protobuf::Arena> nestedArena;
+};
+
+/**
+ * @brief Owns message created on given arena, or on the heap when arena is not given. Copies are created on the same arena.
+ */
+template <typename T>
+class ArenaMessagePtr {
+public:
+    explicit ArenaMessagePtr(google::protobuf::Arena* arena = nullptr) :
+        message(google::protobuf::Arena::CreateMessage<T>(arena)) {}
+
+    ArenaMessagePtr(const ArenaMessagePtr& other) :
+        ArenaMessagePtr(other.message->GetArena()) {
+        message->CopyFrom(*other.message);
+    }
+
+    ArenaMessagePtr& operator=(const ArenaMessagePtr& other) {
+        if (this != &other) {
+            message->CopyFrom(*other.message);
+        }
+        return *this;
+    }
+
+    ~ArenaMessagePtr() {
+        // messages on arena are destroyed together with the arena
+        if (message->GetArena() == nullptr) {
+            delete message;
+        }
+    }
+
+    T& operator*() const {
+        return *message;
+    }
+
+    T* operator->() const {
+        return message;
+    }
+
+    T* get() const {
+        return message;
+    }
+
+private:
+    T* message;
+};
+
+}  // namespace ovms
@@ -0,0 +1,84 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "replicarouting.hpp"
+
+#include <algorithm>
+
+#include "ovinferrequestsqueue.hpp"
+
+namespace ovms {
+
+bool parseReplicaRouting(const std::string& name, ReplicaRouting& routing) {
+    if (name == "least_queued") {
+        routing = ReplicaRouting::LEAST_QUEUED;
+        return true;
+    }
+    if (name == "latency_weighted") {
+        routing = ReplicaRouting::LATENCY_WEIGHTED;
+        return true;
+    }
+    if (name == "overflow") {
+        routing = ReplicaRouting::ORDERED_OVERFLOW;
+        return true;
+    }
+    return false;
+}
+
+const char* toString(ReplicaRouting routing) {
+    switch (routing) {
+    case ReplicaRouting::LEAST_QUEUED:
+        return "least_queued";
+    case ReplicaRouting::LATENCY_WEIGHTED:
+        return "latency_weighted";
+    case ReplicaRouting::ORDERED_OVERFLOW:
+        return "overflow";
+    }
+    return "unknown";
+}
+
+double getReplicaLoad(const OVInferRequestsQueue& queue, ReplicaRouting routing) {
+    const size_t streams = std::max<size_t>(queue.getInferRequestsCount(), 1);
+    // idle count is read without locking and may be momentarily above streams count
+    const size_t busyStreams = streams - std::min(queue.getIdleStreamsCount(), streams);
+    const double load = static_cast<double>(busyStreams + queue.getWaitersCount() + 1) / streams;
+    if (routing == ReplicaRouting::LEAST_QUEUED) {
+        return load;
+    }
+    // queue not measured yet counts as the fastest one, so that it gets measured
+    return load * std::max<uint64_t>(queue.getAverageStreamHoldMicroseconds(), 1);
+}
+
+size_t selectReplica(const std::vector<const OVInferRequestsQueue*>& queues, ReplicaRouting routing) {
+    if (routing == ReplicaRouting::ORDERED_OVERFLOW) {
+        for (size_t i = 0; i < queues.size(); ++i) {
+            if (queues[i]->getIdleStreamsCount() > 0 && queues[i]->getWaitersCount() == 0) {
+                return i;
+            }
+        }
+    }
+    size_t selected = 0;
+    double selectedLoad = 0;
+    for (size_t i = 0; i < queues.size(); ++i) {
+        const double load = getReplicaLoad(*queues[i], routing);
+        if (i == 0 || load < selectedLoad) {
+            selected = i;
+            selectedLoad = load;
+        }
+    }
+    return selected;
+}
+
+}  // namespace ovms
@@ -0,0 +1,62 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ovms {
+
+class OVInferRequestsQueue;
+
+/**
+ * @brief Policy choosing which device replica of a model serves the request
+ */
+enum class ReplicaRouting {
+    LEAST_QUEUED,
+    LATENCY_WEIGHTED,
+    // first queue in order of preference with an idle stream, latency weighted one when all of them are saturated
+    ORDERED_OVERFLOW
+};
+
+/**
+ * @brief Parses routing policy name used in model config
+ *
+ * @return false if name is not known
+ */
+bool parseReplicaRouting(const std::string& name, ReplicaRouting& routing);
+
+const char* toString(ReplicaRouting routing);
+
+/**
+ * @brief Estimates how long a new request would wait for and run inference on the queue, comparable between queues of one model
+ *
+ * Least queued counts busy streams and waiters per stream. Latency weighted and overflow multiply it by average time streams
+ * of the queue are held by requests, so slower device gets proportionally less load.
+ */
+double getReplicaLoad(const OVInferRequestsQueue& queue, ReplicaRouting routing);
+
+/**
+ * @brief Chooses least loaded of the queues
+ *
+ * With overflow routing queues are ordered by preference, e.g. target device first, and later queues are used
+ * only when the earlier ones have no idle stream.
+ *
+ * @return index of the queue, earlier queue wins on equal load
+ */
+size_t selectReplica(const std::vector<const OVInferRequestsQueue*>& queues, ReplicaRouting routing);
+
+}  // namespace ovms
@@ -0,0 +1,84 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "requesttimings.hpp"
+
+#include <cstdio>
+
+namespace ovms {
+
+namespace {
+thread_local RequestTimings* currentTimings = nullptr;
+
+void appendEntry(std::string& header, const char* name, uint64_t microseconds) {
+    if (!header.empty()) {
+        header += ", ";
+    }
+    char duration[32];
+    std::snprintf(duration, sizeof(duration), "%.3f", microseconds / 1000.0);
+    header += name;
+    header += ";dur=";
+    header += duration;
+}
+}  // namespace
+
+const char* toString(RequestTimingStage stage) {
+    switch (stage) {
+    case RequestTimingStage::VALIDATION:
+        return "validation";
+    case RequestTimingStage::RELOAD_WAIT:
+        return "reload_wait";
+    case RequestTimingStage::STREAM_WAIT:
+        return "stream_wait";
+    case RequestTimingStage::DESERIALIZATION:
+        return "deserialization";
+    case RequestTimingStage::INFERENCE:
+        return "inference";
+    case RequestTimingStage::SERIALIZATION:
+        return "serialization";
+    default:
+        return "unknown";
+    }
+}
+
+bool isServerTimingRequested(std::string_view headerValue) {
+    return headerValue == "1" || headerValue == "true";
+}
+
+std::string RequestTimings::toServerTiming() const {
+    std::string header;
+    for (size_t stage = 0; stage < REQUEST_TIMING_STAGES_COUNT; ++stage) {
+        if (isRecorded(static_cast<RequestTimingStage>(stage))) {
+            appendEntry(header, toString(static_cast<RequestTimingStage>(stage)), get(static_cast<RequestTimingStage>(stage)));
+        }
+    }
+    appendEntry(header, "total", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    return header;
+}
+
+RequestTimings* RequestTimings::current() {
+    return currentTimings;
+}
+
+RequestTimingsScope::RequestTimingsScope(RequestTimings* timings) :
+    previous(currentTimings) {
+    currentTimings = timings;
+}
+
+RequestTimingsScope::~RequestTimingsScope() {
+    currentTimings = previous;
+}
+
+}  // namespace ovms
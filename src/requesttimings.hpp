@@ -0,0 +1,140 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ovms {
+
+/**
+ * @brief gRPC metadata key or HTTP header with which clients ask for timings of their request, values "1" and "true" enable it
+ */
+const char SERVER_TIMING_REQUEST_HEADER[] = "ovms-server-timing";
+
+/**
+ * @brief HTTP response header and gRPC trailing metadata key carrying the timings
+ */
+const char SERVER_TIMING_RESPONSE_HEADER[] = "Server-Timing";
+const char SERVER_TIMING_TRAILING_METADATA[] = "server-timing";
+
+enum class RequestTimingStage {
+    VALIDATION,
+    RELOAD_WAIT,
+    STREAM_WAIT,
+    DESERIALIZATION,
+    INFERENCE,
+    SERIALIZATION,
+    COUNT
+};
+
+constexpr size_t REQUEST_TIMING_STAGES_COUNT = static_cast<size_t>(RequestTimingStage::COUNT);
+
+const char* toString(RequestTimingStage stage);
+
+/**
+ * @brief Checks value of SERVER_TIMING_REQUEST_HEADER sent by client
+ */
+bool isServerTimingRequested(std::string_view headerValue);
+
+/**
+ * @brief Durations of request handling stages of a single request, reported back to the client which asked for them
+ *
+ * Stages are recorded into timings made current in the handling thread with RequestTimingsScope. Asynchronous inference
+ * takes current timings when it is started and records later stages from the threads completing it.
+ * Stages entered several times, e.g. validation of a shape variant, are summed.
+ */
+class RequestTimings {
+public:
+    RequestTimings() :
+        start(std::chrono::steady_clock::now()) {}
+
+    void record(RequestTimingStage stage, uint64_t microseconds) {
+        auto& entry = stages[static_cast<size_t>(stage)];
+        entry.microseconds.fetch_add(microseconds, std::memory_order_relaxed);
+        entry.recorded.store(true, std::memory_order_relaxed);
+    }
+
+    uint64_t get(RequestTimingStage stage) const {
+        return stages[static_cast<size_t>(stage)].microseconds.load(std::memory_order_relaxed);
+    }
+
+    bool isRecorded(RequestTimingStage stage) const {
+        return stages[static_cast<size_t>(stage)].recorded.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Formats recorded stages and total time since the timings were created as Server-Timing header value,
+     * e.g. "validation;dur=0.012, inference;dur=1.250, total;dur=1.400" with durations in milliseconds
+     */
+    std::string toServerTiming() const;
+
+    /**
+     * @brief Records stage into timings current in calling thread, does nothing if client did not ask for them
+     */
+    static void recordCurrent(RequestTimingStage stage, uint64_t microseconds) {
+        auto* timings = current();
+        if (timings != nullptr) {
+            timings->record(stage, microseconds);
+        }
+    }
+
+    static void recordCurrentSince(RequestTimingStage stage, std::chrono::steady_clock::time_point stageStart) {
+        auto* timings = current();
+        if (timings != nullptr) {
+            timings->record(stage, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - stageStart).count());
+        }
+    }
+
+    /**
+     * @brief Timings of the request handled by calling thread, nullptr when they were not requested
+     */
+    static RequestTimings* current();
+
+private:
+    friend class RequestTimingsScope;
+
+    struct Stage {
+        std::atomic<uint64_t> microseconds{0};
+        std::atomic<bool> recorded{false};
+    };
+
+    const std::chrono::steady_clock::time_point start;
+    std::array<Stage, REQUEST_TIMING_STAGES_COUNT> stages;
+};
+
+/**
+ * @brief Makes timings current in the thread for the lifetime of the scope, nullptr leaves no timings current
+ */
+class RequestTimingsScope {
+public:
+    explicit RequestTimingsScope(RequestTimings* timings);
+
+    ~RequestTimingsScope();
+
+    RequestTimingsScope(const RequestTimingsScope&) = delete;
+    RequestTimingsScope& operator=(const RequestTimingsScope&) = delete;
+
+private:
+    RequestTimings* previous;
+};
+
+}  // namespace ovms
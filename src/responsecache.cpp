@@ -0,0 +1,124 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "responsecache.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "sharedmemory.hpp"
+
+namespace ovms {
+
+bool ResponseCache::createKey(const tensorflow::serving::PredictRequest& request, std::string& key) {
+    // inputs map has no stable order
+    std::vector<const google::protobuf::MapPair<std::string, tensorflow::TensorProto>*> inputs;
+    inputs.reserve(request.inputs_size());
+    for (const auto& input : request.inputs()) {
+        if (isSharedMemoryReference(input.second)) {
+            return false;
+        }
+        inputs.push_back(&input);
+    }
+    std::sort(inputs.begin(), inputs.end(), [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+    key.clear();
+    for (const auto* input : inputs) {
+        key.append(input->first);
+        key.push_back('\0');
+        key.append(std::to_string(input->second.ByteSizeLong()));
+        key.push_back('\0');
+        // TensorProto has no map fields, its serialization is deterministic
+        input->second.AppendToString(&key);
+    }
+    std::vector<std::string_view> outputFilter(request.output_filter().begin(), request.output_filter().end());
+    std::sort(outputFilter.begin(), outputFilter.end());
+    for (const auto& output : outputFilter) {
+        if (output.find(OUTPUT_DESTINATION_SEPARATOR) != std::string_view::npos) {
+            return false;
+        }
+        key.append(output);
+        key.push_back('\0');
+    }
+    return true;
+}
+
+bool ResponseCache::get(const std::string& key, tensorflow::serving::PredictResponse* response) {
+    const uint64_t hash = std::hash<std::string>()(key);
+    std::shared_ptr<const tensorflow::serving::PredictResponse> cached;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(hash);
+        if (it != index.end() && it->second->key == key) {
+            entries.splice(entries.begin(), entries, it->second);
+            cached = it->second->response;
+        }
+    }
+    if (!cached) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // copied without the lock, entry may be evicted in the meantime
+    response->CopyFrom(*cached);
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ResponseCache::put(std::string&& key, const tensorflow::serving::PredictResponse& response) {
+    const uint64_t hash = std::hash<std::string>()(key);
+    const size_t entrySize = key.size() + response.ByteSizeLong();
+    if (entrySize > capacityBytes) {
+        return;
+    }
+    auto cached = std::make_shared<const tensorflow::serving::PredictResponse>(response);
+    std::list<Entry> evicted;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = index.find(hash);
+    if (it != index.end()) {
+        // already inserted by concurrent request or colliding key, the newer one is kept
+        sizeBytes -= it->second->sizeBytes;
+        evicted.splice(evicted.end(), entries, it->second);
+        index.erase(it);
+    }
+    entries.push_front(Entry{hash, std::move(key), std::move(cached), entrySize});
+    index[hash] = entries.begin();
+    sizeBytes += entrySize;
+    evict(evicted);
+}
+
+void ResponseCache::reset(size_t newCapacityBytes) {
+    std::list<Entry> removed;
+    std::lock_guard<std::mutex> lock(mtx);
+    removed.swap(entries);
+    index.clear();
+    sizeBytes = 0;
+    capacityBytes = newCapacityBytes;
+    enabled = newCapacityBytes > 0;
+    hits = 0;
+    misses = 0;
+}
+
+void ResponseCache::evict(std::list<Entry>& evicted) {
+    while (sizeBytes > capacityBytes) {
+        sizeBytes -= entries.back().sizeBytes;
+        index.erase(entries.back().hash);
+        evicted.splice(evicted.end(), entries, std::prev(entries.end()));
+    }
+}
+
+}  // namespace ovms
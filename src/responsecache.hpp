@@ -0,0 +1,122 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+namespace ovms {
+
+/**
+ * @brief Thread safe cache of predict responses of a single model instance, keyed by content of request inputs.
+ * Size of cached requests and responses is bounded, least recently used entry is evicted first.
+ *
+ * Entries are indexed by 64 bit hash of the request key, whole key is compared on lookup so colliding requests are never mixed up.
+ */
+class ResponseCache {
+public:
+    ResponseCache(size_t capacityBytes = 0) :
+        capacityBytes(capacityBytes),
+        enabled(capacityBytes > 0) {}
+
+    /**
+     * @brief Creates cache key from request inputs and output filter
+     *
+     * @param request
+     * @param key filled with serialized inputs sorted by name and output filter
+     *
+     * @return false if response of request cannot be cached, e.g. it refers to shared memory
+     */
+    static bool createKey(const tensorflow::serving::PredictRequest& request, std::string& key);
+
+    /**
+     * @brief Copies cached response into response if there is one and marks it as most recently used
+     *
+     * @param key
+     * @param response
+     *
+     * @return true on cache hit
+     */
+    bool get(const std::string& key, tensorflow::serving::PredictResponse* response);
+
+    /**
+     * @brief Inserts response, evicting least recently used entries above the capacity.
+     * Responses bigger than the whole capacity are not cached.
+     *
+     * @param key
+     * @param response
+     */
+    void put(std::string&& key, const tensorflow::serving::PredictResponse& response);
+
+    /**
+     * @brief Removes all entries and sets new capacity, 0 disables the cache. Counters are reset.
+     *
+     * @param newCapacityBytes
+     */
+    void reset(size_t newCapacityBytes);
+
+    bool isEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getHits() const {
+        return hits.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getMisses() const {
+        return misses.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets size of cached keys and responses in bytes
+     */
+    size_t getSizeBytes() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return sizeBytes;
+    }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::string key;
+        std::shared_ptr<const tensorflow::serving::PredictResponse> response;
+        size_t sizeBytes;
+    };
+
+    void evict(std::list<Entry>& evicted);
+
+    mutable std::mutex mtx;
+    std::atomic<size_t> capacityBytes;
+    size_t sizeBytes = 0;
+    std::list<Entry> entries;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+}  // namespace ovms
@@ -15,17 +15,57 @@
 //*****************************************************************************
 #include "rest_parser.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <set>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/reader.h>
+
+#include "absl/strings/escaping.h"
+#include "containerlimits.hpp"
+#include "parallelworkers.hpp"
+#include "rest_utils.hpp"
 
 namespace ovms {
 
-RestParser::RestParser(const tensor_map_t& tensors) {
+RestParser::RestParser(const tensor_map_t& tensors, google::protobuf::Arena* arena) :
+    requestProto(arena) {
+    reset(tensors);
+}
+
+void RestParser::reset(const tensor_map_t& tensors) {
+    auto& inputs = (*requestProto->mutable_inputs());
+    auto it = inputs.begin();
+    while (it != inputs.end()) {
+        if (tensors.count(it->first)) {
+            it++;
+        } else {
+            it = inputs.erase(it);
+        }
+    }
+    auto precisionIt = tensorPrecisionMap.begin();
+    while (precisionIt != tensorPrecisionMap.end()) {
+        if (tensors.count(precisionIt->first)) {
+            precisionIt++;
+        } else {
+            precisionIt = tensorPrecisionMap.erase(precisionIt);
+        }
+    }
+    requestProto->clear_output_filter();
+    requestProto->mutable_model_spec()->Clear();
+    order = Order::UNKNOWN;
+    format = Format::UNKNOWN;
     for (const auto& kv : tensors) {
         const auto& name = kv.first;
         const auto& tensor = kv.second;
         tensorPrecisionMap[name] = tensor->getPrecision();
-        auto& input = (*requestProto.mutable_inputs())[name];
+        auto& input = inputs[name];
+        clearTensor(input);
         input.set_dtype(tensor->getPrecisionAsDataType());
         input.mutable_tensor_content()->reserve(std::accumulate(
                                                     tensor->getShape().begin(),
@@ -36,8 +76,26 @@ RestParser::RestParser(const tensor_map_t& tensors) {
     }
 }
 
+void RestParser::clearTensor(tensorflow::TensorProto& proto) {
+    size_t reservedSize = proto.tensor_content().capacity() +
+                          (proto.half_val().Capacity() + proto.int_val().Capacity()) * sizeof(int);
+    for (const auto& value : proto.string_val()) {
+        reservedSize += value.capacity();
+    }
+    if (reservedSize > MAX_REUSED_TENSOR_SIZE) {
+        tensorflow::TensorProto empty;
+        proto.Swap(&empty);
+        return;
+    }
+    proto.mutable_tensor_shape()->clear_dim();
+    proto.mutable_tensor_content()->clear();
+    proto.clear_half_val();
+    proto.clear_int_val();
+    proto.clear_string_val();
+}
+
 void RestParser::removeUnusedInputs() {
-    auto& inputs = (*requestProto.mutable_inputs());
+    auto& inputs = (*requestProto->mutable_inputs());
     auto it = inputs.begin();
     while (it != inputs.end()) {
         if (!it->second.tensor_shape().dim_size()) {
@@ -66,6 +124,13 @@ bool RestParser::parseArray(rapidjson::Value& doc, int dim, tensorflow::TensorPr
             }
         }
         return true;
+    } else if (isBinaryValue(doc.GetArray()[0])) {
+        for (auto& value : doc.GetArray()) {
+            if (!addBinaryValue(proto, value)) {
+                return false;
+            }
+        }
+        return true;
     } else {
         if (!setPrecisionIfNotSet(doc.GetArray()[0], proto, tensorName))
             return false;
@@ -85,8 +150,14 @@ bool RestParser::parseInstance(rapidjson::Value& doc) {
     }
     for (auto& itr : doc.GetObject()) {
         std::string tensorName = itr.name.GetString();
-        auto& proto = (*requestProto.mutable_inputs())[tensorName];
+        auto& proto = (*requestProto->mutable_inputs())[tensorName];
         increaseBatchSize(proto);
+        if (isBinaryValue(itr.value)) {
+            if (!addBinaryValue(proto, itr.value)) {
+                return false;
+            }
+            continue;
+        }
         if (!parseArray(itr.value, 1, proto, tensorName)) {
             return false;
         }
@@ -96,7 +167,7 @@ bool RestParser::parseInstance(rapidjson::Value& doc) {
 
 bool RestParser::isBatchSizeEqualForAllInputs() const {
     int64_t size = 0;
-    for (const auto& kv : requestProto.inputs()) {
+    for (const auto& kv : requestProto->inputs()) {
         if (size == 0) {
             size = kv.second.tensor_shape().dim(0).size();
         } else if (kv.second.tensor_shape().dim(0).size() != size) {
@@ -106,6 +177,80 @@ bool RestParser::isBatchSizeEqualForAllInputs() const {
     return true;
 }
 
+Status RestParser::parseNamedInstances(rapidjson::Value& node, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        auto& instance = node.GetArray()[i];
+        if (!instance.IsObject()) {
+            return StatusCode::REST_NAMED_INSTANCE_NOT_AN_OBJECT;
+        }
+        if (!this->parseInstance(instance)) {
+            return StatusCode::REST_COULD_NOT_PARSE_INSTANCE;
+        }
+    }
+    return StatusCode::OK;
+}
+
+Status RestParser::parseNamedInstancesInParallel(rapidjson::Value& node, size_t threadsCount) {
+    auto status = parseNamedInstances(node, 0, 1);
+    if (!status.ok()) {
+        return status;
+    }
+    const size_t remainingCount = node.GetArray().Size() - 1;
+    std::vector<RestParser> ranges(threadsCount);
+    std::vector<Status> statuses(threadsCount);
+    auto worker = [&](size_t range) {
+        const size_t begin = 1 + remainingCount * range / threadsCount;
+        const size_t end = 1 + remainingCount * (range + 1) / threadsCount;
+        auto& parser = ranges[range];
+        parser.tensorPrecisionMap = tensorPrecisionMap;
+        // shapes of the first instance are validated by setDimOrValidate as in serial parsing
+        for (const auto& kv : requestProto->inputs()) {
+            if (!kv.second.tensor_shape().dim_size()) {
+                continue;
+            }
+            auto& proto = (*parser.requestProto->mutable_inputs())[kv.first];
+            proto.set_dtype(kv.second.dtype());
+            *proto.mutable_tensor_shape() = kv.second.tensor_shape();
+            proto.mutable_tensor_shape()->mutable_dim(0)->set_size(0);
+            proto.mutable_tensor_content()->reserve(kv.second.tensor_content().size() * (end - begin));
+        }
+        statuses[range] = parser.parseNamedInstances(node, begin, end);
+    };
+    ParallelWorkers::instance().run(threadsCount, threadsCount, worker);
+    for (const auto& status : statuses) {
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    auto& inputs = (*requestProto->mutable_inputs());
+    for (auto& parser : ranges) {
+        for (auto& kv : *parser.requestProto->mutable_inputs()) {
+            auto it = inputs.find(kv.first);
+            if (it == inputs.end() || !it->second.tensor_shape().dim_size()) {
+                // input missing in the first instance
+                return StatusCode::REST_INSTANCES_BATCH_SIZE_DIFFER;
+            }
+            if (it->second.dtype() != kv.second.dtype()) {
+                // binary and numeric values mixed in one input
+                return StatusCode::REST_COULD_NOT_PARSE_INSTANCE;
+            }
+            appendBatch(it->second, kv.second);
+        }
+    }
+    return StatusCode::OK;
+}
+
+void RestParser::appendBatch(tensorflow::TensorProto& proto, tensorflow::TensorProto& batch) {
+    auto& dim = *proto.mutable_tensor_shape()->mutable_dim(0);
+    dim.set_size(dim.size() + batch.tensor_shape().dim(0).size());
+    proto.mutable_tensor_content()->append(batch.tensor_content());
+    proto.mutable_half_val()->MergeFrom(batch.half_val());
+    proto.mutable_int_val()->MergeFrom(batch.int_val());
+    for (auto& value : *batch.mutable_string_val()) {
+        proto.add_string_val(std::move(value));
+    }
+}
+
 Status RestParser::parseRowFormat(rapidjson::Value& node) {
     order = Order::ROW;
     if (!node.IsArray()) {
@@ -114,23 +259,22 @@ Status RestParser::parseRowFormat(rapidjson::Value& node) {
     if (node.GetArray().Size() == 0) {
         return StatusCode::REST_NO_INSTANCES_FOUND;
     }
-    if (node.GetArray()[0].IsObject()) {
+    if (node.GetArray()[0].IsObject() && !isBinaryValue(node.GetArray()[0])) {
         // named format
-        for (auto& instance : node.GetArray()) {
-            if (!instance.IsObject()) {
-                return StatusCode::REST_NAMED_INSTANCE_NOT_AN_OBJECT;
-            }
-            if (!this->parseInstance(instance)) {
-                return StatusCode::REST_COULD_NOT_PARSE_INSTANCE;
-            }
+        const size_t instancesCount = node.GetArray().Size();
+        const size_t threadsCount = std::min({instancesCount / ROW_PARSING_INSTANCES_PER_THREAD, MAX_ROW_PARSING_THREADS,
+            static_cast<size_t>(getEffectiveCpuCount())});
+        auto status = threadsCount <= 1 ? parseNamedInstances(node, 0, instancesCount) : parseNamedInstancesInParallel(node, threadsCount);
+        if (!status.ok()) {
+            return status;
         }
-    } else if (node.GetArray()[0].IsArray() || node.GetArray()[0].IsNumber()) {
+    } else if (node.GetArray()[0].IsArray() || node.GetArray()[0].IsNumber() || node.GetArray()[0].IsBool() || isBinaryValue(node.GetArray()[0])) {
         // no named format
-        if (requestProto.inputs_size() != 1) {
+        if (requestProto->inputs_size() != 1) {
             return StatusCode::REST_INPUT_NOT_PREALLOCATED;
         }
-        auto inputsIterator = requestProto.mutable_inputs()->begin();
-        if (inputsIterator == requestProto.mutable_inputs()->end()) {
+        auto inputsIterator = requestProto->mutable_inputs()->begin();
+        if (inputsIterator == requestProto->mutable_inputs()->end()) {
             const std::string details = "Failed to parse row formatted request.";
             SPDLOG_ERROR("Internal error occured: {}", details);
             return Status(StatusCode::INTERNAL_ERROR, details);
@@ -156,11 +300,11 @@ Status RestParser::parseColumnFormat(rapidjson::Value& node) {
     order = Order::COLUMN;
     // no named format
     if (node.IsArray()) {
-        if (requestProto.inputs_size() != 1) {
+        if (requestProto->inputs_size() != 1) {
             return StatusCode::REST_INPUT_NOT_PREALLOCATED;
         }
-        auto inputsIterator = requestProto.mutable_inputs()->begin();
-        if (inputsIterator == requestProto.mutable_inputs()->end()) {
+        auto inputsIterator = requestProto->mutable_inputs()->begin();
+        if (inputsIterator == requestProto->mutable_inputs()->end()) {
             const std::string details = "Failed to parse column formatted request.";
             SPDLOG_ERROR("Internal error occured: {}", details);
             return Status(StatusCode::INTERNAL_ERROR, details);
@@ -180,7 +324,7 @@ Status RestParser::parseColumnFormat(rapidjson::Value& node) {
     }
     for (auto& kv : node.GetObject()) {
         std::string tensorName = kv.name.GetString();
-        auto& proto = (*requestProto.mutable_inputs())[tensorName];
+        auto& proto = (*requestProto->mutable_inputs())[tensorName];
         if (!parseArray(kv.value, 0, proto, tensorName)) {
             return StatusCode::REST_COULD_NOT_PARSE_INPUT;
         }
@@ -190,28 +334,474 @@ Status RestParser::parseColumnFormat(rapidjson::Value& node) {
     return StatusCode::OK;
 }
 
+/**
+ * @brief Follows the same rules as document tree walk in parseRowFormat, parseColumnFormat and parseArray.
+ * Since array sizes are known only when arrays end, shape dimensions are set in post-order and dimensions
+ * left with size 0 are treated as not set yet.
+ */
+struct RestParser::StreamHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, RestParser::StreamHandler> {
+    enum class Context {
+        BODY,
+        INSTANCES,
+        NAMED_INSTANCES,
+        INSTANCE,
+        INPUTS,
+        TENSOR,
+        SKIPPED
+    };
+
+    enum class Member {
+        INSTANCES,
+        INPUTS,
+        OTHER
+    };
+
+    enum class Nesting {
+        UNKNOWN,
+        ARRAYS,
+        VALUES
+    };
+
+    struct Frame {
+        Context context;
+        int dim = 0;
+        Nesting nesting = Nesting::UNKNOWN;
+        size_t skippedDepth = 0;
+    };
+
+    RestParser& parser;
+    std::vector<Frame> frames;
+    Member member = Member::OTHER;
+    bool orderFound = false;
+    tensorflow::TensorProto* tensor = nullptr;
+    std::string tensorName;
+
+    explicit StreamHandler(RestParser& parser) :
+        parser(parser) {}
+
+    bool beginNonamedTensor() {
+        if (parser.requestProto->inputs_size() != 1) {
+            return false;
+        }
+        auto inputsIterator = parser.requestProto->mutable_inputs()->begin();
+        tensorName = inputsIterator->first;
+        tensor = &inputsIterator->second;
+        parser.format = Format::NONAMED;
+        return true;
+    }
+
+    bool beginNamedTensor(const char* name, rapidjson::SizeType length) {
+        tensorName.assign(name, length);
+        tensor = &(*parser.requestProto->mutable_inputs())[tensorName];
+        if (frames.back().context == Context::INSTANCE) {
+            increaseBatchSize(*tensor);
+        }
+        return true;
+    }
+
+    bool beginOrder(Order order) {
+        if (orderFound) {
+            return false;
+        }
+        orderFound = true;
+        parser.order = order;
+        return true;
+    }
+
+    bool setDim(int dim, rapidjson::SizeType size) {
+        auto& shape = *tensor->mutable_tensor_shape();
+        if (shape.dim_size() > dim && shape.dim(dim).size() == 0) {
+            shape.mutable_dim(dim)->set_size(size);
+            return true;
+        }
+        return setDimOrValidate(*tensor, dim, size);
+    }
+
+    bool scalar(const rapidjson::Value& value) {
+        if (frames.empty()) {
+            return false;
+        }
+        auto& frame = frames.back();
+        switch (frame.context) {
+        case Context::SKIPPED:
+            return true;
+        case Context::BODY:
+            return member == Member::OTHER;
+        case Context::INSTANCES:
+            if (!value.IsNumber() && !value.IsBool()) {
+                return false;
+            }
+            if (!beginNonamedTensor()) {
+                return false;
+            }
+            frame.context = Context::TENSOR;
+            frame.dim = 0;
+            break;
+        case Context::TENSOR:
+            break;
+        default:
+            return false;
+        }
+        if (frame.nesting == Nesting::ARRAYS) {
+            return false;
+        }
+        if (frame.nesting == Nesting::UNKNOWN) {
+            if (!parser.setPrecisionIfNotSet(value, *tensor, tensorName)) {
+                return false;
+            }
+            frame.nesting = Nesting::VALUES;
+        }
+        return addValue(*tensor, value);
+    }
+
+    bool Null() { return scalar(rapidjson::Value()); }
+    bool Bool(bool b) { return scalar(rapidjson::Value(b)); }
+    bool Int(int i) { return scalar(rapidjson::Value(i)); }
+    bool Uint(unsigned u) { return scalar(rapidjson::Value(u)); }
+    bool Int64(int64_t i) { return scalar(rapidjson::Value(i)); }
+    bool Uint64(uint64_t u) { return scalar(rapidjson::Value(u)); }
+    bool Double(double d) { return scalar(rapidjson::Value(d)); }
+
+    bool String(const char*, rapidjson::SizeType, bool) {
+        return scalar(rapidjson::Value(rapidjson::kStringType));
+    }
+
+    bool StartObject() {
+        if (frames.empty()) {
+            frames.push_back({Context::BODY});
+            return true;
+        }
+        auto& frame = frames.back();
+        switch (frame.context) {
+        case Context::SKIPPED:
+            frame.skippedDepth++;
+            return true;
+        case Context::BODY:
+            if (member == Member::INPUTS) {
+                if (!beginOrder(Order::COLUMN)) {
+                    return false;
+                }
+                parser.format = Format::NAMED;
+                frames.push_back({Context::INPUTS});
+                return true;
+            }
+            if (member == Member::OTHER) {
+                frames.push_back({Context::SKIPPED, 0, Nesting::UNKNOWN, 1});
+                return true;
+            }
+            return false;
+        case Context::INSTANCES:
+            frame.context = Context::NAMED_INSTANCES;
+            parser.format = Format::NAMED;
+            [[fallthrough]];
+        case Context::NAMED_INSTANCES:
+            frames.push_back({Context::INSTANCE});
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Key(const char* name, rapidjson::SizeType length, bool) {
+        auto& frame = frames.back();
+        switch (frame.context) {
+        case Context::BODY:
+            if (std::string_view(name, length) == "instances") {
+                member = Member::INSTANCES;
+            } else if (std::string_view(name, length) == "inputs") {
+                member = Member::INPUTS;
+            } else {
+                member = Member::OTHER;
+            }
+            return true;
+        case Context::INSTANCE:
+        case Context::INPUTS:
+            return beginNamedTensor(name, length);
+        default:
+            return true;
+        }
+    }
+
+    bool EndObject(rapidjson::SizeType memberCount) {
+        auto& frame = frames.back();
+        switch (frame.context) {
+        case Context::SKIPPED:
+            if (--frame.skippedDepth == 0) {
+                frames.pop_back();
+            }
+            return true;
+        case Context::INSTANCE:
+        case Context::INPUTS:
+            if (memberCount == 0) {
+                return false;
+            }
+            frames.pop_back();
+            return true;
+        default:
+            frames.pop_back();
+            return true;
+        }
+    }
+
+    bool StartArray() {
+        if (frames.empty()) {
+            return false;
+        }
+        auto& frame = frames.back();
+        switch (frame.context) {
+        case Context::SKIPPED:
+            frame.skippedDepth++;
+            return true;
+        case Context::BODY:
+            if (member == Member::INSTANCES) {
+                if (!beginOrder(Order::ROW)) {
+                    return false;
+                }
+                frames.push_back({Context::INSTANCES});
+                return true;
+            }
+            if (member == Member::INPUTS) {
+                if (!beginOrder(Order::COLUMN) || !beginNonamedTensor()) {
+                    return false;
+                }
+                frames.push_back({Context::TENSOR, 0});
+                return true;
+            }
+            frames.push_back({Context::SKIPPED, 0, Nesting::UNKNOWN, 1});
+            return true;
+        case Context::INSTANCES:
+            if (!beginNonamedTensor()) {
+                return false;
+            }
+            frame.context = Context::TENSOR;
+            frame.dim = 0;
+            [[fallthrough]];
+        case Context::TENSOR:
+            if (frame.nesting == Nesting::VALUES) {
+                return false;
+            }
+            frame.nesting = Nesting::ARRAYS;
+            frames.push_back({Context::TENSOR, frame.dim + 1});
+            return true;
+        case Context::INSTANCE:
+            frames.push_back({Context::TENSOR, 1});
+            return true;
+        case Context::INPUTS:
+            frames.push_back({Context::TENSOR, 0});
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool EndArray(rapidjson::SizeType elementCount) {
+        auto& frame = frames.back();
+        switch (frame.context) {
+        case Context::SKIPPED:
+            if (--frame.skippedDepth == 0) {
+                frames.pop_back();
+            }
+            return true;
+        case Context::NAMED_INSTANCES:
+            frames.pop_back();
+            return true;
+        case Context::TENSOR:
+            if (elementCount == 0 || !setDim(frame.dim, elementCount)) {
+                return false;
+            }
+            frames.pop_back();
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+
+Status RestParser::parseStream(const char* json) {
+    StreamHandler handler(*this);
+    rapidjson::Reader reader;
+    rapidjson::StringStream stream(json);
+    auto result = reader.Parse(stream, handler);
+    if (result.IsError()) {
+        if (result.Code() == rapidjson::kParseErrorTermination) {
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+        return StatusCode::JSON_INVALID;
+    }
+    if (!handler.orderFound) {
+        return StatusCode::REST_MALFORMED_REQUEST;
+    }
+    if (format == Format::NAMED) {
+        removeUnusedInputs();
+        if (order == Order::ROW && !isBatchSizeEqualForAllInputs()) {
+            return StatusCode::REST_MALFORMED_REQUEST;
+        }
+    }
+    return StatusCode::OK;
+}
+
+void RestParser::resetInputs(const std::map<std::string, InferenceEngine::Precision>& precisions) {
+    auto& inputs = (*requestProto->mutable_inputs());
+    auto it = inputs.begin();
+    while (it != inputs.end()) {
+        if (precisions.count(it->first)) {
+            clearTensor(it->second);
+            it++;
+        } else {
+            it = inputs.erase(it);
+        }
+    }
+    for (const auto& kv : precisions) {
+        inputs[kv.first].set_dtype(TensorInfo::getPrecisionAsDataType(kv.second));
+    }
+    tensorPrecisionMap = precisions;
+    order = Order::UNKNOWN;
+    format = Format::UNKNOWN;
+}
+
 Status RestParser::parse(const char* json) {
+    const auto precisions = tensorPrecisionMap;
+    auto status = parseStream(json);
+    if (status.ok() || status == StatusCode::JSON_INVALID) {
+        return status;
+    }
+    SPDLOG_DEBUG("Streaming parse of request body failed, parsing document tree");
+    resetInputs(precisions);
+    return parseDocument(json);
+}
+
+Status RestParser::parseDocument(const char* json) {
     rapidjson::Document doc;
     if (doc.Parse(json).HasParseError()) {
         return StatusCode::JSON_INVALID;
     }
-    if (!doc.IsObject()) {
+    return parse(doc);
+}
+
+Status RestParser::parse(rapidjson::Value& request) {
+    if (!request.IsObject()) {
         return StatusCode::REST_BODY_IS_NOT_AN_OBJECT;
     }
-    auto instancesItr = doc.FindMember("instances");
-    auto inputsItr = doc.FindMember("inputs");
-    if (instancesItr != doc.MemberEnd() && inputsItr != doc.MemberEnd()) {
+    auto instancesItr = request.FindMember("instances");
+    auto inputsItr = request.FindMember("inputs");
+    if (instancesItr != request.MemberEnd() && inputsItr != request.MemberEnd()) {
         return StatusCode::REST_PREDICT_UNKNOWN_ORDER;
     }
-    if (instancesItr != doc.MemberEnd()) {
+    if (instancesItr != request.MemberEnd()) {
         return parseRowFormat(instancesItr->value);
     }
-    if (inputsItr != doc.MemberEnd()) {
+    if (inputsItr != request.MemberEnd()) {
         return parseColumnFormat(inputsItr->value);
     }
     return StatusCode::REST_PREDICT_UNKNOWN_ORDER;
 }
 
+Status RestParser::parseBinary(const std::string& body, size_t headerLength) {
+    if (headerLength > body.size()) {
+        SPDLOG_DEBUG("Binary request header length {} exceeds body size {}", headerLength, body.size());
+        return StatusCode::REST_BINARY_HEADER_INVALID;
+    }
+    rapidjson::Document doc;
+    if (doc.Parse(body.data(), headerLength).HasParseError()) {
+        return StatusCode::JSON_INVALID;
+    }
+    if (!doc.IsObject()) {
+        return StatusCode::REST_BODY_IS_NOT_AN_OBJECT;
+    }
+    auto inputsItr = doc.FindMember("inputs");
+    if (inputsItr == doc.MemberEnd() || !inputsItr->value.IsArray()) {
+        return StatusCode::REST_BINARY_HEADER_INVALID;
+    }
+    if (inputsItr->value.GetArray().Size() == 0) {
+        return StatusCode::REST_NO_INPUTS_FOUND;
+    }
+    size_t offset = headerLength;
+    std::set<std::string> parsedInputs;
+    for (const auto& input : inputsItr->value.GetArray()) {
+        if (!input.IsObject()) {
+            return StatusCode::REST_BINARY_HEADER_INVALID;
+        }
+        auto nameItr = input.FindMember("name");
+        auto datatypeItr = input.FindMember("datatype");
+        auto shapeItr = input.FindMember("shape");
+        auto parametersItr = input.FindMember("parameters");
+        if (nameItr == input.MemberEnd() || !nameItr->value.IsString() ||
+            datatypeItr == input.MemberEnd() || !datatypeItr->value.IsString() ||
+            shapeItr == input.MemberEnd() || !shapeItr->value.IsArray() ||
+            parametersItr == input.MemberEnd() || !parametersItr->value.IsObject()) {
+            return StatusCode::REST_BINARY_HEADER_INVALID;
+        }
+        auto sizeItr = parametersItr->value.FindMember("binary_data_size");
+        if (sizeItr == parametersItr->value.MemberEnd() || !sizeItr->value.IsUint64()) {
+            return StatusCode::REST_BINARY_HEADER_INVALID;
+        }
+        const std::string tensorName = nameItr->value.GetString();
+        auto dtype = getBinaryDatatype(std::string_view(datatypeItr->value.GetString(), datatypeItr->value.GetStringLength()));
+        if (!dtype.has_value()) {
+            SPDLOG_DEBUG("Binary request input {} has unsupported datatype {}", tensorName, datatypeItr->value.GetString());
+            return StatusCode::REST_UNSUPPORTED_PRECISION;
+        }
+        if (!parsedInputs.insert(tensorName).second) {
+            SPDLOG_DEBUG("Binary request input {} is given more than once", tensorName);
+            return StatusCode::REST_BINARY_HEADER_INVALID;
+        }
+        auto& proto = (*requestProto->mutable_inputs())[tensorName];
+        proto.set_dtype(dtype.value());
+        uint64_t expectedSize = DataTypeSize(dtype.value());
+        for (const auto& dim : shapeItr->value.GetArray()) {
+            if (!dim.IsInt64() || dim.GetInt64() < 0) {
+                return StatusCode::REST_BINARY_HEADER_INVALID;
+            }
+            const uint64_t dimSize = dim.GetInt64();
+            if (dimSize != 0 && expectedSize > std::numeric_limits<uint64_t>::max() / dimSize) {
+                SPDLOG_DEBUG("Binary request input {} shape describes more than {} bytes of data", tensorName, std::numeric_limits<uint64_t>::max());
+                return StatusCode::REST_BINARY_DATA_SIZE_MISMATCH;
+            }
+            proto.mutable_tensor_shape()->add_dim()->set_size(dimSize);
+            expectedSize *= dimSize;
+        }
+        const uint64_t size = sizeItr->value.GetUint64();
+        if (size != expectedSize || size > body.size() - offset) {
+            SPDLOG_DEBUG("Binary request input {} has {} bytes of data while header describes {} bytes", tensorName, size, expectedSize);
+            return StatusCode::REST_BINARY_DATA_SIZE_MISMATCH;
+        }
+        proto.mutable_tensor_content()->assign(body.data() + offset, size);
+        offset += size;
+    }
+    if (offset != body.size()) {
+        SPDLOG_DEBUG("Binary request has {} bytes of data not described in header", body.size() - offset);
+        return StatusCode::REST_BINARY_DATA_SIZE_MISMATCH;
+    }
+    auto outputsItr = doc.FindMember("outputs");
+    if (outputsItr != doc.MemberEnd()) {
+        if (!outputsItr->value.IsArray()) {
+            return StatusCode::REST_BINARY_HEADER_INVALID;
+        }
+        for (const auto& output : outputsItr->value.GetArray()) {
+            if (!output.IsObject()) {
+                return StatusCode::REST_BINARY_HEADER_INVALID;
+            }
+            auto nameItr = output.FindMember("name");
+            if (nameItr == output.MemberEnd() || !nameItr->value.IsString()) {
+                return StatusCode::REST_BINARY_HEADER_INVALID;
+            }
+            requestProto->add_output_filter(nameItr->value.GetString(), nameItr->value.GetStringLength());
+        }
+    }
+    // preallocated inputs not given in the request
+    auto& inputs = (*requestProto->mutable_inputs());
+    auto it = inputs.begin();
+    while (it != inputs.end()) {
+        if (parsedInputs.count(it->first) == 0) {
+            it = inputs.erase(it);
+        } else {
+            it++;
+        }
+    }
+    format = Format::NAMED;
+    return StatusCode::OK;
+}
+
 void RestParser::increaseBatchSize(tensorflow::TensorProto& proto) {
     if (proto.tensor_shape().dim_size() < 1) {
         proto.mutable_tensor_shape()->add_dim()->set_size(0);
@@ -309,6 +899,11 @@ bool addToIntVal(tensorflow::TensorProto& proto, const rapidjson::Value& value)
 }
 
 bool RestParser::addValue(tensorflow::TensorProto& proto, const rapidjson::Value& value) {
+    if (proto.dtype() == tensorflow::DataType::DT_BOOL) {
+        if (!value.IsBool())
+            return false;
+        return addToTensorContent<bool>(proto, value.GetBool());
+    }
     if (!value.IsNumber())
         return false;
 
@@ -340,6 +935,30 @@ bool RestParser::addValue(tensorflow::TensorProto& proto, const rapidjson::Value
     }
 }
 
+bool RestParser::isBinaryValue(const rapidjson::Value& value) {
+    if (!value.IsObject() || value.MemberCount() != 1) {
+        return false;
+    }
+    auto b64Itr = value.FindMember("b64");
+    return b64Itr != value.MemberEnd() && b64Itr->value.IsString();
+}
+
+bool RestParser::addBinaryValue(tensorflow::TensorProto& proto, const rapidjson::Value& value) {
+    if (!isBinaryValue(value)) {
+        return false;
+    }
+    if (proto.tensor_content().size() || proto.half_val_size() || proto.int_val_size()) {
+        return false;
+    }
+    proto.set_dtype(tensorflow::DataType::DT_STRING);
+    const auto& encoded = value["b64"];
+    if (!absl::Base64Unescape(absl::string_view(encoded.GetString(), encoded.GetStringLength()), proto.add_string_val())) {
+        SPDLOG_DEBUG("Failed to decode base64 value");
+        return false;
+    }
+    return true;
+}
+
 bool RestParser::setPrecisionIfNotSet(const rapidjson::Value& value, tensorflow::TensorProto& proto, const std::string& tensorName) {
     if (tensorPrecisionMap.count(tensorName))
         return true;
@@ -348,6 +967,8 @@ bool RestParser::setPrecisionIfNotSet(const rapidjson::Value& value, tensorflow:
         tensorPrecisionMap[tensorName] = InferenceEngine::Precision::I32;
     else if (value.IsDouble())
         tensorPrecisionMap[tensorName] = InferenceEngine::Precision::FP32;
+    else if (value.IsBool())
+        tensorPrecisionMap[tensorName] = InferenceEngine::Precision::BOOL;
     else
         return false;
 
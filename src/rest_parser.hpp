@@ -26,11 +26,27 @@
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #pragma GCC diagnostic pop
 
+#include "protoarena.hpp"
 #include "status.hpp"
 #include "tensorinfo.hpp"
 
 namespace ovms {
 
+/**
+ * @brief Upper limit of tensor memory kept by reset parser for the next request
+ */
+const size_t MAX_REUSED_TENSOR_SIZE = 16 * 1024 * 1024;
+
+/**
+ * @brief Minimum number of row format instances parsed by each thread, smaller requests are parsed by a single thread
+ */
+const size_t ROW_PARSING_INSTANCES_PER_THREAD = 64;
+
+/**
+ * @brief Upper limit of threads parsing instances of a single row format request
+ */
+const size_t MAX_ROW_PARSING_THREADS = 8;
+
 /**
  * @brief Request order types
  */
@@ -66,7 +82,7 @@ class RestParser {
     /**
      * @brief Request proto
      */
-    tensorflow::serving::PredictRequest requestProto;
+    ArenaMessagePtr<tensorflow::serving::PredictRequest> requestProto;
 
     /**
      * @brief Request content precision
@@ -75,6 +91,11 @@ class RestParser {
 
     void removeUnusedInputs();
 
+    /**
+     * @brief Clears tensor shape and values. Their memory is kept unless it exceeds MAX_REUSED_TENSOR_SIZE.
+     */
+    static void clearTensor(tensorflow::TensorProto& proto);
+
     /**
      * @brief Increases batch size (0th-dimension) of tensor
      */
@@ -92,6 +113,18 @@ class RestParser {
      */
     static bool addValue(tensorflow::TensorProto& proto, const rapidjson::Value& value);
 
+    /**
+     * @brief Checks if rapidjson value is binary data object: {"b64": "base64 encoded data"}
+     */
+    static bool isBinaryValue(const rapidjson::Value& value);
+
+    /**
+     * @brief Decodes binary data object and adds it to string_val of tensor proto, switching it to DT_STRING
+     * 
+     * @return false if value is not a binary data object, could not be decoded or tensor already has numeric values
+     */
+    static bool addBinaryValue(tensorflow::TensorProto& proto, const rapidjson::Value& value);
+
     /**
      * @brief Parses rapidjson Node for arrays or numeric values on certain level of nesting.
      * 
@@ -107,6 +140,8 @@ class RestParser {
      *     [...],
      *     ...
      * ]
+     * or array of binary data objects:
+     * [{"b64": "..."}, {"b64": "..."}, ...]
      */
     bool parseArray(rapidjson::Value& doc, int dim, tensorflow::TensorProto& proto, const std::string& tensorName);
 
@@ -126,6 +161,32 @@ class RestParser {
      */
     bool parseInstance(rapidjson::Value& doc);
 
+    /**
+     * @brief Parses named format instances from begin to end, one after another
+     * 
+     * @param node rapidjson Node with array of instances
+     * 
+     * @return Status indicating if processing succeeded, error code otherwise
+     */
+    Status parseNamedInstances(rapidjson::Value& node, size_t begin, size_t end);
+
+    /**
+     * @brief Parses named format instances on ParallelWorkers shared by all requests. First instance is parsed up front to set
+     * precisions and shapes, remaining instances are split into ranges, each parsed into tensors of its own
+     * parser. Tensors of the ranges are appended to request proto in the order of instances afterwards.
+     * 
+     * @param node rapidjson Node with array of instances
+     * @param threadsCount number of ranges parsed at once, at least 2
+     * 
+     * @return Status indicating if processing succeeded, error code of the first failing range otherwise
+     */
+    Status parseNamedInstancesInParallel(rapidjson::Value& node, size_t threadsCount);
+
+    /**
+     * @brief Appends values of tensor parsed from further instances, increasing batch size (0th-dimension)
+     */
+    static void appendBatch(tensorflow::TensorProto& proto, tensorflow::TensorProto& batch);
+
     /**
      * @brief Checks whether all inputs have equal batch size, 0th-dimension
      * 
@@ -136,6 +197,7 @@ class RestParser {
     /**
      * @brief Parses row format: list of objects, each object corresponding to one batch with one or multiple inputs.
      *        When no named format is detected, instance is treated as array of single input batches with no name.
+     *        Named instances are parsed in parallel when there are at least 2 * ROW_PARSING_INSTANCES_PER_THREAD of them.
      * 
      * @param node rapidjson Node
      * 
@@ -165,21 +227,68 @@ class RestParser {
 
     bool setPrecisionIfNotSet(const rapidjson::Value& value, tensorflow::TensorProto& proto, const std::string& tensorName);
 
+    /**
+     * @brief SAX handler writing values into request proto while the body is being read
+     */
+    struct StreamHandler;
+
+    /**
+     * @brief Parses http request body string with rapidjson SAX reader, without building the document tree
+     * 
+     * @param json request string
+     * 
+     * @return Status OK when request was parsed, JSON_INVALID on syntax error, REST_MALFORMED_REQUEST when
+     *         request content could not be handled and the body has to be parsed with document tree
+     */
+    Status parseStream(const char* json);
+
+    /**
+     * @brief Parses http request body string by building rapidjson document tree and walking it
+     * 
+     * @param json request string
+     * 
+     * @return Status indicating error code or success
+     */
+    Status parseDocument(const char* json);
+
+    /**
+     * @brief Restores request proto to the state right after construction
+     * 
+     * @param precisions tensor precisions known before parsing
+     */
+    void resetInputs(const std::map<std::string, InferenceEngine::Precision>& precisions);
+
 public:
-    RestParser() = default;
+    /**
+     * @brief Constructor for requests without known inputs, e.g. of pipelines
+     * 
+     * @param arena Arena for request proto, heap is used when not given
+     */
+    explicit RestParser(google::protobuf::Arena* arena = nullptr) :
+        requestProto(arena) {}
+
     /**
      * @brief Constructor for preallocating memory for inputs beforehand. Size is calculated from tensor shape required by backend.
      * 
      * @param tensors Tensor map with model input parameters
+     * @param arena Arena for request proto, heap is used when not given
      */
-    RestParser(const tensor_map_t& tensors);
+    RestParser(const tensor_map_t& tensors, google::protobuf::Arena* arena = nullptr);
+
+    /**
+     * @brief Restores parser to the state right after construction with given tensors, so it can parse
+     * the next request. Memory of request proto is reused.
+     * 
+     * @param tensors Tensor map with model input parameters
+     */
+    void reset(const tensor_map_t& tensors);
 
     /**
      * @brief Gets parsed request proto
      * 
      * @return proto
      */
-    tensorflow::serving::PredictRequest& getProto() { return requestProto; }
+    tensorflow::serving::PredictRequest& getProto() { return *requestProto; }
 
     /**
      * @brief Gets request order
@@ -198,6 +307,9 @@ public:
     /**
      * @brief Parses http request body string
      * 
+     * Values are written into request proto while the body is being read. Document tree is built only when
+     * streaming parse failed, to report exact error of malformed requests.
+     * 
      * @param json request string
      * 
      * @return Status indicating error code or success
@@ -211,6 +323,36 @@ public:
      * }
      */
     Status parse(const char* json);
+
+    /**
+     * @brief Parses request already parsed into rapidjson document tree, e.g. one of the entries of batch request
+     * 
+     * @param request rapidjson Node in the structure of http request body
+     * 
+     * @return Status indicating error code or success
+     */
+    Status parse(rapidjson::Value& request);
+
+    /**
+     * @brief Parses http request body in binary tensor format. Tensor data is copied into tensor_content
+     * without any conversion, the data has to be in the precision given in the header.
+     * 
+     * @param body request body, JSON header followed by tensors data
+     * @param headerLength size of JSON header at the beginning of the body
+     * 
+     * @return Status indicating error code or success
+     * 
+     * JSON header expected to be passed in following structure:
+     * {
+     *     "inputs": [
+     *         {"name": "input1", "datatype": "FP32", "shape": [1, 3], "parameters": {"binary_data_size": 12}},
+     *         ...
+     *     ],
+     *     "outputs": [{"name": "output1"}, ...]
+     * }
+     * Optional outputs list limits response to named outputs.
+     */
+    Status parseBinary(const std::string& body, size_t headerLength);
 };
 
 }  // namespace ovms
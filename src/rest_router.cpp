@@ -0,0 +1,198 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "rest_router.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+static bool consumePrefix(std::string_view& path, std::string_view prefix) {
+    if (path.substr(0, prefix.size()) != prefix) {
+        return false;
+    }
+    path.remove_prefix(prefix.size());
+    return true;
+}
+
+/**
+ * @brief Consumes leading characters accepted by predicate, returns them
+ */
+template <typename Predicate>
+static std::string_view consumeWhile(std::string_view& path, Predicate predicate) {
+    size_t length = 0;
+    while (length < path.size() && predicate(path[length])) {
+        length++;
+    }
+    auto consumed = path.substr(0, length);
+    path.remove_prefix(length);
+    return consumed;
+}
+
+static bool isNameCharacter(char c) {
+    return c != '/' && c != ':';
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isWordCharacter(char c) {
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static Status routeModelRequest(std::string_view method, std::string_view path, RestRoute& route) {
+    route.name = consumeWhile(path, isNameCharacter);
+    if (route.name.empty()) {
+        return StatusCode::REST_INVALID_URL;
+    }
+    if (consumePrefix(path, "/versions/")) {
+        auto version = consumeWhile(path, isDigit);
+        if (version.empty()) {
+            return StatusCode::REST_INVALID_URL;
+        }
+        int64_t value = 0;
+        auto result = std::from_chars(version.data(), version.data() + version.size(), value);
+        if (result.ec != std::errc()) {
+            SPDLOG_ERROR("Couldn't parse model version {}", version);
+            return StatusCode::REST_COULD_NOT_PARSE_VERSION;
+        }
+        route.version = value;
+    } else if (consumePrefix(path, "/labels/")) {
+        auto label = consumeWhile(path, isWordCharacter);
+        if (label.empty()) {
+            return StatusCode::REST_INVALID_URL;
+        }
+        route.label = label;
+    }
+    if (consumePrefix(path, ":")) {
+        if (path == "resize") {
+            route.resource = RestResource::INFER_REQUESTS;
+            route.operation = path;
+            return method == "POST" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+        }
+        if (path != "classify" && path != "regress" && path != "predict") {
+            return StatusCode::REST_INVALID_URL;
+        }
+        route.resource = RestResource::PREDICT;
+        route.operation = path;
+        return method == "POST" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    if (path.empty()) {
+        route.resource = RestResource::MODEL_STATUS;
+    } else if (path == "/metadata") {
+        route.resource = RestResource::MODEL_METADATA;
+    } else {
+        return StatusCode::REST_INVALID_URL;
+    }
+    return method == "GET" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+}
+
+static Status routeSharedMemoryRequest(std::string_view method, std::string_view path, RestRoute& route) {
+    route.name = consumeWhile(path, isNameCharacter);
+    if (route.name.empty() || !consumePrefix(path, ":") || (path != "register" && path != "unregister")) {
+        return StatusCode::REST_INVALID_URL;
+    }
+    route.resource = RestResource::SHARED_MEMORY;
+    route.operation = path;
+    return method == "POST" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+}
+
+static Status routeBulkJobsRequest(std::string_view method, std::string_view path, RestRoute& route) {
+    route.resource = RestResource::BULK_JOBS;
+    if (path.empty()) {
+        route.operation = method == "POST" ? "submit" : "list";
+        return StatusCode::OK;
+    }
+    if (!consumePrefix(path, "/")) {
+        return StatusCode::REST_INVALID_URL;
+    }
+    route.name = consumeWhile(path, isDigit);
+    if (route.name.empty()) {
+        return StatusCode::REST_INVALID_URL;
+    }
+    if (path.empty()) {
+        route.operation = "status";
+        return method == "GET" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    if (path != ":cancel") {
+        return StatusCode::REST_INVALID_URL;
+    }
+    route.operation = "cancel";
+    return method == "POST" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+}
+
+Status routeRestRequest(std::string_view method, std::string_view path, RestRoute& route) {
+    if (method != "POST" && method != "GET") {
+        return StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    if (path.find("../") != std::string_view::npos || path.find("/..") != std::string_view::npos) {
+        SPDLOG_ERROR("Path {} escape with .. is forbidden.", path);
+        return StatusCode::PATH_INVALID;
+    }
+    route = RestRoute();
+    if (path == "/metrics") {
+        // Prometheus scrapes the conventional path outside of the API prefix
+        route.resource = RestResource::PROMETHEUS_METRICS;
+        return method == "GET" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    if (!consumePrefix(path, "/v1/")) {
+        // single character before API prefix is tolerated, e.g. doubled slash
+        path = path.substr(std::min<size_t>(1, path.size()));
+        if (!consumePrefix(path, "/v1/")) {
+            return StatusCode::REST_INVALID_URL;
+        }
+    }
+    if (consumePrefix(path, "models/")) {
+        return routeModelRequest(method, path, route);
+    }
+    if (consumePrefix(path, "shm/")) {
+        return routeSharedMemoryRequest(method, path, route);
+    }
+    if (consumePrefix(path, "jobs")) {
+        return routeBulkJobsRequest(method, path, route);
+    }
+    if (path == "batch:predict") {
+        route.resource = RestResource::BATCH_PREDICT;
+        return method == "POST" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    if (path == "ready") {
+        route.resource = RestResource::READINESS;
+        return method == "GET" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    if (path == "metrics") {
+        route.resource = RestResource::METRICS;
+        return method == "GET" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    if (path == "admin/profile") {
+        route.resource = RestResource::PROFILE;
+        return method == "POST" ? StatusCode::OK : StatusCode::REST_UNSUPPORTED_METHOD;
+    }
+    return StatusCode::REST_INVALID_URL;
+}
+
+bool isInferenceRequest(std::string_view method, std::string_view path) {
+    RestRoute route;
+    if (!routeRestRequest(method, path, route).ok()) {
+        return false;
+    }
+    return (route.resource == RestResource::PREDICT && route.operation == "predict") ||
+           route.resource == RestResource::BATCH_PREDICT;
+}
+
+}  // namespace ovms
@@ -0,0 +1,88 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Resources of REST API
+ */
+enum class RestResource {
+    PREDICT,
+    MODEL_STATUS,
+    MODEL_METADATA,
+    SHARED_MEMORY,
+    BATCH_PREDICT,
+    READINESS,
+    METRICS,
+    PROMETHEUS_METRICS,
+    INFER_REQUESTS,
+    BULK_JOBS,
+    PROFILE
+};
+
+/**
+ * @brief Components of REST request path. Views refer to the routed path.
+ */
+struct RestRoute {
+    RestResource resource = RestResource::MODEL_STATUS;
+    std::string_view name;
+    std::optional<int64_t> version;
+    std::optional<std::string_view> label;
+    /**
+     * @brief classify, regress or predict for PREDICT, register or unregister for SHARED_MEMORY, resize for INFER_REQUESTS,
+     * submit, list, status or cancel for BULK_JOBS
+     */
+    std::string_view operation;
+};
+
+/**
+ * @brief Matches REST request path without regular expressions or allocations
+ *
+ * Recognized paths:
+ * POST /v1/models/{name}[/versions/{version}|/labels/{label}]:(classify|regress|predict)
+ * POST /v1/models/{name}[/versions/{version}|/labels/{label}]:resize
+ * GET  /v1/models/{name}[/versions/{version}|/labels/{label}][/metadata]
+ * POST /v1/shm/{name}:(register|unregister)
+ * POST /v1/batch:predict
+ * POST /v1/jobs, GET /v1/jobs
+ * GET  /v1/jobs/{id}, POST /v1/jobs/{id}:cancel
+ * GET  /v1/ready
+ * GET  /v1/metrics
+ * POST /v1/admin/profile
+ *
+ * @param method http method
+ * @param path request path
+ * @param route recognized path components
+ *
+ * @return Status REST_UNSUPPORTED_METHOD when path is used with other method, REST_INVALID_URL when it is not
+ * recognized, PATH_INVALID when it contains .. segments
+ */
+Status routeRestRequest(std::string_view method, std::string_view path, RestRoute& route);
+
+/**
+ * @brief Tells if request runs inference, i.e. it is a predict or batch predict request.
+ * Only such requests are shed by saturated server, so that status, metadata, metrics and admin requests are still served.
+ */
+bool isInferenceRequest(std::string_view method, std::string_view path);
+
+}  // namespace ovms
@@ -15,116 +15,443 @@
 //*****************************************************************************
 #include "rest_utils.hpp"
 
-#include <spdlog/spdlog.h>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wall"
-#include "tensorflow_serving/util/json_tensor.h"
-#pragma GCC diagnostic pop
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/writer.h>
+#include <spdlog/spdlog.h>
 
-#define DEBUG
-#include "timer.hpp"
+#include "floatformatting.hpp"
+#include "logging.hpp"
+#include "narrowing.hpp"
 
 using tensorflow::DataType;
 using tensorflow::DataTypeSize;
-using tensorflow::serving::JsonPredictRequestFormat;
-using tensorflow::serving::MakeJsonFromTensors;
 using tensorflow::serving::PredictResponse;
 
 namespace ovms {
+
+namespace {
+
+/**
+ * @brief rapidjson output stream appending directly to response string
+ */
+class StringOutputStream {
+public:
+    using Ch = char;
+
+    explicit StringOutputStream(std::string& output) :
+        output(output) {}
+
+    void Put(Ch c) { output.push_back(c); }
+    void Flush() {}
+
+private:
+    std::string& output;
+};
+
+using JsonWriter = rapidjson::PrettyWriter<StringOutputStream>;
+
+const std::pair<const char*, DataType> BINARY_DATATYPES[] = {
+    {"BOOL", DataType::DT_BOOL},
+    {"UINT8", DataType::DT_UINT8},
+    {"UINT16", DataType::DT_UINT16},
+    {"UINT32", DataType::DT_UINT32},
+    {"UINT64", DataType::DT_UINT64},
+    {"INT8", DataType::DT_INT8},
+    {"INT16", DataType::DT_INT16},
+    {"INT32", DataType::DT_INT32},
+    {"INT64", DataType::DT_INT64},
+    {"FP16", DataType::DT_HALF},
+    {"BF16", DataType::DT_BFLOAT16},
+    {"FP32", DataType::DT_FLOAT},
+    {"FP64", DataType::DT_DOUBLE},
+};
+
+/**
+ * @brief Output tensor prepared for writing. FP16 and BF16 values are widened to FP32 beforehand.
+ */
+struct OutputTensor {
+    const std::string* name;
+    const tensorflow::TensorProto* proto;
+    DataType dtype;
+    const char* data;
+    std::vector<float> widened;
+};
+
+/**
+ * @brief Typical number of characters of a single value, used to reserve response string
+ */
+size_t getEstimatedValueLength(DataType dtype) {
+    switch (dtype) {
+    case DataType::DT_FLOAT:
+    case DataType::DT_HALF:
+    case DataType::DT_BFLOAT16:
+        return 12;
+    case DataType::DT_DOUBLE:
+        return 20;
+    case DataType::DT_INT8:
+    case DataType::DT_UINT8:
+    case DataType::DT_BOOL:
+        return 4;
+    case DataType::DT_INT16:
+        return 6;
+    case DataType::DT_INT32:
+    case DataType::DT_UINT32:
+        return 11;
+    default:
+        return 20;
+    }
+}
+
+inline bool writeValue(JsonWriter& writer, float value) {
+    char buffer[FORMATTED_NUMBER_BUFFER_SIZE];
+    return writer.RawValue(buffer, formatFloat(value, buffer), rapidjson::kNumberType);
+}
+
+inline bool writeValue(JsonWriter& writer, double value) {
+    char buffer[FORMATTED_NUMBER_BUFFER_SIZE];
+    return writer.RawValue(buffer, formatDouble(value, buffer), rapidjson::kNumberType);
+}
+
+inline bool writeValue(JsonWriter& writer, int32_t value) { return writer.Int(value); }
+inline bool writeValue(JsonWriter& writer, int16_t value) { return writer.Int(value); }
+inline bool writeValue(JsonWriter& writer, int8_t value) { return writer.Int(value); }
+inline bool writeValue(JsonWriter& writer, uint8_t value) { return writer.Uint(value); }
+inline bool writeValue(JsonWriter& writer, int64_t value) { return writer.Int64(value); }
+inline bool writeValue(JsonWriter& writer, uint32_t value) { return writer.Uint(value); }
+inline bool writeValue(JsonWriter& writer, uint64_t value) { return writer.Uint64(value); }
+inline bool writeValue(JsonWriter& writer, bool value) { return writer.Bool(value); }
+
+/**
+ * @brief Writes values of tensor starting from given dimension as nested arrays, advances data pointer past written values
+ */
+template <typename T>
+bool writeArray(JsonWriter& writer, const tensorflow::TensorShapeProto& shape, int dim, const T*& data) {
+    if (dim == shape.dim_size()) {
+        return writeValue(writer, *data++);
+    }
+    writer.StartArray();
+    if (dim + 1 == shape.dim_size()) {
+        for (int64_t i = 0; i < shape.dim(dim).size(); i++) {
+            if (!writeValue(writer, *data++)) {
+                return false;
+            }
+        }
+    } else {
+        for (int64_t i = 0; i < shape.dim(dim).size(); i++) {
+            if (!writeArray(writer, shape, dim + 1, data)) {
+                return false;
+            }
+        }
+    }
+    return writer.EndArray();
+}
+
+template <typename T>
+bool writeArray(JsonWriter& writer, const OutputTensor& output, int dim, size_t offset) {
+    const T* data = reinterpret_cast<const T*>(output.data) + offset;
+    return writeArray<T>(writer, output.proto->tensor_shape(), dim, data);
+}
+
+/**
+ * @brief Writes part of output tensor starting from given dimension and value offset
+ */
+bool writeArray(JsonWriter& writer, const OutputTensor& output, int dim, size_t offset) {
+    switch (output.dtype) {
+    case DataType::DT_FLOAT:
+        return writeArray<float>(writer, output, dim, offset);
+    case DataType::DT_DOUBLE:
+        return writeArray<double>(writer, output, dim, offset);
+    case DataType::DT_INT32:
+        return writeArray<int32_t>(writer, output, dim, offset);
+    case DataType::DT_INT16:
+        return writeArray<int16_t>(writer, output, dim, offset);
+    case DataType::DT_INT8:
+        return writeArray<int8_t>(writer, output, dim, offset);
+    case DataType::DT_UINT8:
+        return writeArray<uint8_t>(writer, output, dim, offset);
+    case DataType::DT_INT64:
+        return writeArray<int64_t>(writer, output, dim, offset);
+    case DataType::DT_UINT32:
+        return writeArray<uint32_t>(writer, output, dim, offset);
+    case DataType::DT_UINT64:
+        return writeArray<uint64_t>(writer, output, dim, offset);
+    case DataType::DT_BOOL:
+        return writeArray<bool>(writer, output, dim, offset);
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Checks whether all outputs have the same, non zero batch size
+ */
+Status getBatchSize(const std::vector<OutputTensor>& outputs, int64_t& batchSize) {
+    batchSize = 0;
+    for (const auto& output : outputs) {
+        const auto& shape = output.proto->tensor_shape();
+        if (shape.dim_size() == 0) {
+            SPDLOG_ERROR("Creating json from tensors failed: tensor name: {} has no shape information", *output.name);
+            return StatusCode::REST_PROTO_TO_STRING_ERROR;
+        }
+        if (shape.dim(0).size() < 1) {
+            SPDLOG_ERROR("Creating json from tensors failed: tensor name: {} has invalid batch size: {}", *output.name, shape.dim(0).size());
+            return StatusCode::REST_PROTO_TO_STRING_ERROR;
+        }
+        if (batchSize != 0 && batchSize != shape.dim(0).size()) {
+            SPDLOG_ERROR("Creating json from tensors failed: batch size of tensor: {} is {} and does not match batch size of other tensors",
+                *output.name, shape.dim(0).size());
+            return StatusCode::REST_PROTO_TO_STRING_ERROR;
+        }
+        batchSize = shape.dim(0).size();
+    }
+    return StatusCode::OK;
+}
+
+/**
+ * @brief Writes predictions array of row format, each batch as an object of outputs or output values when there is only one output.
+ * Values of each batch are written in single lines.
+ */
+bool writeRowFormat(JsonWriter& writer, const std::vector<OutputTensor>& outputs, int64_t batchSize) {
+    std::vector<size_t> batchValuesCount;
+    batchValuesCount.reserve(outputs.size());
+    for (const auto& output : outputs) {
+        const auto& shape = output.proto->tensor_shape();
+        size_t count = 1;
+        for (int i = 1; i < shape.dim_size(); i++) {
+            count *= shape.dim(i).size();
+        }
+        batchValuesCount.push_back(count);
+    }
+    const bool named = outputs.size() > 1;
+    writer.StartArray();
+    for (int64_t batch = 0; batch < batchSize; batch++) {
+        if (named) {
+            writer.StartObject();
+        }
+        for (size_t i = 0; i < outputs.size(); i++) {
+            if (named) {
+                writer.Key(outputs[i].name->c_str(), outputs[i].name->size());
+            }
+            writer.SetFormatOptions(rapidjson::kFormatSingleLineArray);
+            if (!writeArray(writer, outputs[i], 1, batch * batchValuesCount[i])) {
+                return false;
+            }
+            writer.SetFormatOptions(rapidjson::kFormatDefault);
+        }
+        if (named) {
+            writer.EndObject();
+        }
+    }
+    return writer.EndArray();
+}
+
+/**
+ * @brief Writes outputs object of column format, or output values when there is only one output
+ */
+bool writeColumnFormat(JsonWriter& writer, const std::vector<OutputTensor>& outputs) {
+    if (outputs.size() == 1) {
+        return writeArray(writer, outputs[0], 0, 0);
+    }
+    writer.StartObject();
+    for (const auto& output : outputs) {
+        writer.Key(output.name->c_str(), output.name->size());
+        if (!writeArray(writer, output, 0, 0)) {
+            return false;
+        }
+    }
+    return writer.EndObject();
+}
+
+/**
+ * @brief Checks whether tensor_content size matches tensor shape and data type
+ */
+bool isTensorContentSizeValid(const tensorflow::TensorProto& tensor) {
+    size_t expected_content_size = DataTypeSize(tensor.dtype());
+    for (int i = 0; i < tensor.tensor_shape().dim_size(); i++) {
+        expected_content_size *= tensor.tensor_shape().dim(i).size();
+    }
+    return tensor.tensor_content().size() == expected_content_size;
+}
+
+}  // namespace
+
+std::optional<DataType> getBinaryDatatype(std::string_view name) {
+    for (const auto& [datatypeName, dtype] : BINARY_DATATYPES) {
+        if (name == datatypeName) {
+            return dtype;
+        }
+    }
+    return std::nullopt;
+}
+
+const char* getBinaryDatatypeName(DataType dtype) {
+    for (const auto& [datatypeName, datatype] : BINARY_DATATYPES) {
+        if (dtype == datatype) {
+            return datatypeName;
+        }
+    }
+    return nullptr;
+}
+
 Status makeJsonFromPredictResponse(
-    PredictResponse& response_proto,
+    const PredictResponse& response_proto,
     std::string* response_json,
     Order order) {
     if (order == Order::UNKNOWN) {
         return StatusCode::REST_PREDICT_UNKNOWN_ORDER;
     }
 
-    Timer timer;
-    using std::chrono::microseconds;
-
-    timer.start("convert");
+    const auto serializeStart = std::chrono::steady_clock::now();
 
-    for (auto& kv : *response_proto.mutable_outputs()) {
-        auto& tensor = kv.second;
-
-        size_t expected_content_size = DataTypeSize(tensor.dtype());
-        for (int i = 0; i < tensor.tensor_shape().dim_size(); i++) {
-            expected_content_size *= tensor.tensor_shape().dim(i).size();
-        }
+    std::vector<OutputTensor> outputs;
+    outputs.reserve(response_proto.outputs().size());
+    size_t estimatedSize = 0;
+    for (const auto& kv : response_proto.outputs()) {
+        const auto& tensor = kv.second;
 
-        if (tensor.tensor_content().size() != expected_content_size) {
+        if (!isTensorContentSizeValid(tensor)) {
             return StatusCode::REST_SERIALIZE_TENSOR_CONTENT_INVALID_SIZE;
         }
+        size_t values_count = 1;
+        for (int i = 0; i < tensor.tensor_shape().dim_size(); i++) {
+            values_count *= tensor.tensor_shape().dim(i).size();
+        }
 
+        OutputTensor output{&kv.first, &tensor, tensor.dtype(), tensor.tensor_content().data(), {}};
         switch (tensor.dtype()) {
-        case DataType::DT_FLOAT:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(float)) {
-                tensor.add_float_val(*reinterpret_cast<float*>(tensor.mutable_tensor_content()->data() + i));
-            }
+        case DataType::DT_HALF:
+            output.widened.resize(values_count);
+            widenFp16ToFp32(reinterpret_cast<const uint16_t*>(tensor.tensor_content().data()), output.widened.data(), values_count);
+            output.dtype = DataType::DT_FLOAT;
+            output.data = reinterpret_cast<const char*>(output.widened.data());
             break;
-        case DataType::DT_DOUBLE:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(double)) {
-                tensor.add_double_val(*reinterpret_cast<double*>(tensor.mutable_tensor_content()->data() + i));
-            }
+        case DataType::DT_BFLOAT16:
+            output.widened.resize(values_count);
+            widenBf16ToFp32(reinterpret_cast<const uint16_t*>(tensor.tensor_content().data()), output.widened.data(), values_count);
+            output.dtype = DataType::DT_FLOAT;
+            output.data = reinterpret_cast<const char*>(output.widened.data());
             break;
+        case DataType::DT_FLOAT:
+        case DataType::DT_DOUBLE:
         case DataType::DT_INT32:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(int32_t)) {
-                tensor.add_int_val(*reinterpret_cast<int32_t*>(tensor.mutable_tensor_content()->data() + i));
-            }
-            break;
         case DataType::DT_INT16:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(int16_t)) {
-                tensor.add_int_val(*reinterpret_cast<int16_t*>(tensor.mutable_tensor_content()->data() + i));
-            }
-            break;
         case DataType::DT_INT8:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(int8_t)) {
-                tensor.add_int_val(*reinterpret_cast<int8_t*>(tensor.mutable_tensor_content()->data() + i));
-            }
-            break;
         case DataType::DT_UINT8:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(uint8_t)) {
-                tensor.add_int_val(*reinterpret_cast<uint8_t*>(tensor.mutable_tensor_content()->data() + i));
-            }
-            break;
         case DataType::DT_INT64:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(int64_t)) {
-                tensor.add_int64_val(*reinterpret_cast<int64_t*>(tensor.mutable_tensor_content()->data() + i));
-            }
-            break;
         case DataType::DT_UINT32:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(uint32_t)) {
-                tensor.add_uint32_val(*reinterpret_cast<uint32_t*>(tensor.mutable_tensor_content()->data() + i));
-            }
-            break;
         case DataType::DT_UINT64:
-            for (size_t i = 0; i < tensor.tensor_content().size(); i += sizeof(uint64_t)) {
-                tensor.add_uint64_val(*reinterpret_cast<uint64_t*>(tensor.mutable_tensor_content()->data() + i));
-            }
+        case DataType::DT_BOOL:
             break;
         default:
             return StatusCode::REST_UNSUPPORTED_PRECISION;
         }
+        // value, separator and indentation of column format
+        estimatedSize += values_count * (getEstimatedValueLength(tensor.dtype()) + 2 +
+                                            (order == Order::COLUMN ? 4 * (tensor.tensor_shape().dim_size() + 2) + 1 : 0));
+        outputs.push_back(std::move(output));
+    }
+
+    if (outputs.empty()) {
+        SPDLOG_ERROR("Creating json from tensors failed: cannot convert empty tensor map to JSON");
+        return StatusCode::REST_PROTO_TO_STRING_ERROR;
+    }
+
+    int64_t batchSize = 0;
+    if (order == Order::ROW) {
+        auto status = getBatchSize(outputs, batchSize);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+
+    response_json->clear();
+    response_json->reserve(estimatedSize);
+    StringOutputStream stream(*response_json);
+    JsonWriter writer(stream);
+    writer.StartObject();
+    bool written;
+    if (order == Order::ROW) {
+        writer.Key("predictions");
+        written = writeRowFormat(writer, outputs, batchSize);
+    } else {
+        writer.Key("outputs");
+        written = writeColumnFormat(writer, outputs);
     }
+    written = written && writer.EndObject();
 
-    timer.stop("convert");
-    timer.start("MakeJsonFromTensors");
+    OVMS_HOT_PATH_DEBUG("Writing json from tensor_content: {:.3f} ms",
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - serializeStart).count());
 
-    const auto& tf_status = MakeJsonFromTensors(
-        response_proto.outputs(),
-        order == Order::ROW ? JsonPredictRequestFormat::kRow : JsonPredictRequestFormat::kColumnar,
-        response_json);
+    if (!written) {
+        SPDLOG_ERROR("Creating json from tensors failed");
+        return StatusCode::REST_PROTO_TO_STRING_ERROR;
+    }
 
-    timer.stop("MakeJsonFromTensors");
-    SPDLOG_DEBUG("tensor_content to *_val container conversion: {:.3f} ms", timer.elapsed<microseconds>("convert") / 1000);
-    SPDLOG_DEBUG("MakeJsonFromTensors call: {:.3f} ms", timer.elapsed<microseconds>("MakeJsonFromTensors") / 1000);
+    return StatusCode::OK;
+}
 
-    if (!tf_status.ok()) {
-        SPDLOG_ERROR("Creating json from tensors failed: {}", tf_status.error_message());
+Status makeBinaryPredictResponse(
+    const PredictResponse& response_proto,
+    const std::string& model_name,
+    std::string* response_body,
+    size_t* header_length) {
+    if (response_proto.outputs().empty()) {
+        SPDLOG_ERROR("Creating binary response failed: no outputs");
         return StatusCode::REST_PROTO_TO_STRING_ERROR;
     }
+    size_t data_size = 0;
+    for (const auto& kv : response_proto.outputs()) {
+        if (!isTensorContentSizeValid(kv.second)) {
+            return StatusCode::REST_SERIALIZE_TENSOR_CONTENT_INVALID_SIZE;
+        }
+        if (getBinaryDatatypeName(kv.second.dtype()) == nullptr) {
+            return StatusCode::REST_UNSUPPORTED_PRECISION;
+        }
+        data_size += kv.second.tensor_content().size();
+    }
 
+    response_body->clear();
+    // header takes about a hundred bytes per output
+    response_body->reserve(data_size + 128 * (response_proto.outputs().size() + 1));
+    StringOutputStream stream(*response_body);
+    rapidjson::Writer<StringOutputStream> writer(stream);
+    writer.StartObject();
+    writer.Key("model_name");
+    writer.String(model_name.c_str(), model_name.size());
+    writer.Key("outputs");
+    writer.StartArray();
+    for (const auto& kv : response_proto.outputs()) {
+        const auto& tensor = kv.second;
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(kv.first.c_str(), kv.first.size());
+        writer.Key("datatype");
+        writer.String(getBinaryDatatypeName(tensor.dtype()));
+        writer.Key("shape");
+        writer.StartArray();
+        for (const auto& dim : tensor.tensor_shape().dim()) {
+            writer.Int64(dim.size());
+        }
+        writer.EndArray();
+        writer.Key("parameters");
+        writer.StartObject();
+        writer.Key("binary_data_size");
+        writer.Uint64(tensor.tensor_content().size());
+        writer.EndObject();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    *header_length = response_body->size();
+    for (const auto& kv : response_proto.outputs()) {
+        response_body->append(kv.second.tensor_content());
+    }
     return StatusCode::OK;
 }
 }  // namespace ovms
@@ -15,7 +15,9 @@
 //*****************************************************************************
 #pragma once
 
+#include <optional>
 #include <string>
+#include <string_view>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wall"
@@ -26,8 +28,55 @@
 #include "status.hpp"
 
 namespace ovms {
+/**
+ * @brief HTTP header with size of JSON part of binary tensor request or response body, the rest of the body holds tensor data
+ */
+const char INFERENCE_HEADER_CONTENT_LENGTH_HEADER[] = "Inference-Header-Content-Length";
+
+/**
+ * @brief Converts binary tensor extension datatype name, e.g. FP32, to tensor data type
+ *
+ * @return data type or std::nullopt for unsupported names
+ */
+std::optional<tensorflow::DataType> getBinaryDatatype(std::string_view name);
+
+/**
+ * @brief Converts tensor data type to binary tensor extension datatype name
+ *
+ * @return datatype name or nullptr for unsupported data types
+ */
+const char* getBinaryDatatypeName(tensorflow::DataType dtype);
+
+/**
+ * @brief Writes outputs of predict response as JSON in TensorFlow Serving REST API layout
+ *
+ * Values are formatted directly from tensor_content of the outputs into the response string.
+ *
+ * @param response_proto predict response with outputs in tensor_content
+ * @param response_json destination string
+ * @param order ROW writes "predictions" list of batches, COLUMN writes "outputs" object of tensors
+ *
+ * @return Status
+ */
 Status makeJsonFromPredictResponse(
-    tensorflow::serving::PredictResponse& response_proto,
+    const tensorflow::serving::PredictResponse& response_proto,
     std::string* response_json,
     Order order);
+
+/**
+ * @brief Writes outputs of predict response in binary tensor format: JSON header describing outputs followed by
+ * raw tensor_content of each output in the order of the header
+ *
+ * @param response_proto predict response with outputs in tensor_content
+ * @param model_name written in the header
+ * @param response_body destination string
+ * @param header_length size of the JSON header at the beginning of response body
+ *
+ * @return Status
+ */
+Status makeBinaryPredictResponse(
+    const tensorflow::serving::PredictResponse& response_proto,
+    const std::string& model_name,
+    std::string* response_body,
+    size_t* header_length);
 }  // namespace ovms
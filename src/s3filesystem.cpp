@@ -25,20 +25,32 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "s3filesystem.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <aws/core/Aws.h>
 #include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/core/client/DefaultRetryStrategy.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/model/GetObjectRequest.h>
 #include <aws/s3/model/HeadBucketRequest.h>
 #include <aws/s3/model/HeadObjectRequest.h>
 #include <aws/s3/model/ListObjectsRequest.h>
+#include <aws/s3/model/PutObjectRequest.h>
 
+#include "cloudlistingcache.hpp"
+#include "fetchedobjects.hpp"
+#include "filesystemmetrics.hpp"
 #include "logging.hpp"
 #include "stringutils.hpp"
 
@@ -82,8 +94,59 @@ StatusCode S3FileSystem::parsePath(const std::string& path, std::string* bucket,
     return StatusCode::OK;
 }
 
-S3FileSystem::S3FileSystem(const Aws::SDKOptions& options, const std::string& s3_path) :
-    options_(options),
+namespace {
+/**
+ * @brief Default retries of the SDK, which are counted in storage metrics
+ */
+class CountingRetryStrategy : public Aws::Client::DefaultRetryStrategy {
+public:
+    bool ShouldRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& error, long attemptedRetries) const override {  // NOLINT(runtime/int)
+        const bool retry = Aws::Client::DefaultRetryStrategy::ShouldRetry(error, attemptedRetries);
+        if (retry) {
+            FileSystemMetrics::instance().recordRetry("s3");
+        }
+        return retry;
+    }
+};
+}  // namespace
+
+namespace {
+struct AwsSdkState {
+    std::mutex mutex;
+    size_t users = 0;
+    Aws::SDKOptions options;
+};
+
+AwsSdkState& awsSdkState() {
+    // never destroyed, file systems held by other static objects may release the SDK during static destruction
+    static AwsSdkState* state = new AwsSdkState();
+    return *state;
+}
+}  // namespace
+
+AwsSdkGuard::AwsSdkGuard() {
+    auto& state = awsSdkState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.users++ == 0) {
+        Aws::InitAPI(state.options);
+    }
+}
+
+AwsSdkGuard::~AwsSdkGuard() {
+    auto& state = awsSdkState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (--state.users == 0) {
+        Aws::ShutdownAPI(state.options);
+    }
+}
+
+size_t AwsSdkGuard::getUsersCount() {
+    auto& state = awsSdkState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.users;
+}
+
+S3FileSystem::S3FileSystem(const std::string& s3_path) :
     s3_regex_(S3_URL_PREFIX + "([0-9a-zA-Z-.]+):([0-9]+)/([0-9a-z.-]+)(((/"
                               "[0-9a-zA-Z.-_]+)*)?)"),
     proxy_regex_("^(https?)://(([^:]{1,128}):([^@]{1,256})@)?([^:/]{1,255})(:([0-9]{1,5}))?/?") {
@@ -111,6 +174,11 @@ S3FileSystem::S3FileSystem(const Aws::SDKOptions& options, const std::string& s3
         config = Aws::Client::ClientConfiguration("default");
     }
 
+    downloadPartSize_ = getDownloadSetting("S3_DOWNLOAD_PART_SIZE_MB", DEFAULT_DOWNLOAD_PART_SIZE_MB) * 1024 * 1024;
+    downloadConnections_ = getDownloadSetting("S3_DOWNLOAD_CONNECTIONS", DEFAULT_DOWNLOAD_CONNECTIONS);
+    config.maxConnections = std::max<unsigned>(config.maxConnections, downloadConnections_);
+    config.retryStrategy = std::make_shared<CountingRetryStrategy>();
+
     std::string host_name, host_port, bucket, object;
     std::smatch sm;
     if (std::regex_match(s3_path, sm, s3_regex_)) {
@@ -161,8 +229,34 @@ S3FileSystem::S3FileSystem(const Aws::SDKOptions& options, const std::string& s3
     }
 }
 
-S3FileSystem::~S3FileSystem() {
-    Aws::ShutdownAPI(options_);
+S3FileSystem::~S3FileSystem() {}
+
+namespace {
+std::string getEnvOrEmpty(const char* name) {
+    const char* value = std::getenv(name);
+    return value != nullptr ? value : "";
+}
+}  // namespace
+
+std::shared_ptr<S3FileSystem> S3FileSystem::getShared(const std::string& s3_path) {
+    // each file system keeps the SDK initialized, so it does not matter which static object releases the last one
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<S3FileSystem>> filesystems;
+    static const std::regex endpoint_regex(S3_URL_PREFIX + "([0-9a-zA-Z-.]+:[0-9]+)/.*");
+    std::smatch sm;
+    std::string key = std::regex_match(s3_path, sm, endpoint_regex) ? sm[1].str() : "";
+    // client configuration is read from environment in the constructor
+    for (const char* name : {"AWS_ACCESS_KEY_ID", "AWS_SECRET_ACCESS_KEY", "AWS_REGION", "AWS_PROFILE", "S3_ENDPOINT",
+             "http_proxy", "HTTP_PROXY", "https_proxy", "HTTPS_PROXY"}) {
+        key += '\n' + getEnvOrEmpty(name);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& filesystem = filesystems[key];
+    if (!filesystem) {
+        SPDLOG_LOGGER_DEBUG(s3_logger, "Creating S3 client for {}", s3_path);
+        filesystem = std::make_shared<S3FileSystem>(s3_path);
+    }
+    return filesystem;
 }
 
 StatusCode S3FileSystem::fileExists(const std::string& path, bool* exists) {
@@ -213,6 +307,11 @@ StatusCode S3FileSystem::isDirectory(const std::string& path, bool* is_dir) {
         return StatusCode::S3_METADATA_FAIL;
     }
 
+    // answered from listing of a prefix shared with other models in this watcher cycle
+    if (CloudListingCache::instance().isDirectory(S3_URL_PREFIX + bucket + "/" + object_path, is_dir)) {
+        return StatusCode::OK;
+    }
+
     // Root case - bucket exists and object path is empty
     if (object_path.empty()) {
         *is_dir = true;
@@ -286,23 +385,40 @@ StatusCode S3FileSystem::getDirectorySubdirs(const std::string& path, std::set<s
         return status;
     }
     std::string true_path = S3_URL_PREFIX + bucket + '/' + dir_path;
-    status = getDirectoryContents(true_path, subdirs);
-    if (status != StatusCode::OK) {
-        return status;
+    if (CloudListingCache::instance().getDirectorySubdirs(true_path, subdirs)) {
+        return StatusCode::OK;
     }
 
-    // Erase non-directory entries...
-    for (auto iter = subdirs->begin(); iter != subdirs->end();) {
-        bool is_dir;
-        status = isDirectory(joinPath({true_path, *iter}), &is_dir);
-        if (status != StatusCode::OK) {
-            return status;
+    // with delimiter subdirectories are returned as common prefixes, without listing their contents
+    const std::string full_dir = appendSlash(dir_path);
+    Aws::String marker;
+    bool truncated = true;
+    while (truncated) {
+        s3::Model::ListObjectsRequest objects_request;
+        objects_request.SetBucket(bucket.c_str());
+        objects_request.SetPrefix(full_dir.c_str());
+        objects_request.SetDelimiter("/");
+        if (!marker.empty()) {
+            objects_request.SetMarker(marker);
         }
-        if (!is_dir) {
-            iter = subdirs->erase(iter);
-        } else {
-            ++iter;
+        auto list_objects_outcome = client_.ListObjects(objects_request);
+        if (!list_objects_outcome.IsSuccess()) {
+            SPDLOG_LOGGER_ERROR(s3_logger, "Could not list subdirectories of directory {}", true_path);
+            return StatusCode::S3_INVALID_ACCESS;
+        }
+        const auto& result = list_objects_outcome.GetResult();
+        for (const auto& common_prefix : result.GetCommonPrefixes()) {
+            std::string name(common_prefix.GetPrefix().c_str());
+            name = name.substr(full_dir.size());
+            if (!name.empty() && name.back() == '/') {
+                name.pop_back();
+            }
+            if (!name.empty()) {
+                subdirs->insert(name);
+            }
         }
+        marker = result.GetNextMarker();
+        truncated = result.GetIsTruncated() && !marker.empty();
     }
 
     return StatusCode::OK;
@@ -381,6 +497,89 @@ StatusCode S3FileSystem::readTextFile(const std::string& path, std::string* cont
     return StatusCode::OK;
 }
 
+StatusCode S3FileSystem::writeFile(const std::string& path, const std::string& contents) {
+    std::string bucket, object;
+    auto status = parsePath(path, &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    s3::Model::PutObjectRequest put_request;
+    put_request.SetBucket(bucket.c_str());
+    put_request.SetKey(object.c_str());
+    auto body = Aws::MakeShared<Aws::StringStream>("ovms");
+    body->write(contents.data(), contents.size());
+    put_request.SetBody(body);
+    auto put_object_outcome = client_.PutObject(put_request);
+    if (!put_object_outcome.IsSuccess()) {
+        SPDLOG_LOGGER_ERROR(s3_logger, "Failed to put object at {}: {}", path, put_object_outcome.GetError().GetMessage());
+        return StatusCode::FILESYSTEM_ERROR;
+    }
+    return StatusCode::OK;
+}
+
+StatusCode S3FileSystem::readFileToMemory(const std::string& path, std::string* contents) {
+    std::string bucket, object;
+    auto status = parsePath(path, &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    s3::Model::HeadObjectRequest head_request;
+    head_request.SetBucket(bucket.c_str());
+    head_request.SetKey(object.c_str());
+    auto head_object_outcome = client_.HeadObject(head_request);
+    if (!head_object_outcome.IsSuccess()) {
+        SPDLOG_LOGGER_ERROR(s3_logger, "Failed to get object at {}", path);
+        return StatusCode::S3_FILE_NOT_FOUND;
+    }
+    const uint64_t size = head_object_outcome.GetResult().GetContentLength();
+    // parts are read in place, buffer gets its final size up front
+    contents->assign(size, '\0');
+    if (size == 0) {
+        // an empty object has no byte range that could be requested
+        return StatusCode::OK;
+    }
+    const auto parts = splitIntoParts({size}, downloadPartSize_);
+    std::atomic<size_t> nextPart{0};
+    std::atomic<bool> failed{false};
+    auto readParts = [&]() {
+        for (size_t part = nextPart++; part < parts.size() && !failed; part = nextPart++) {
+            const uint64_t offset = parts[part].second;
+            const uint64_t length = std::min(downloadPartSize_, size - offset);
+            s3::Model::GetObjectRequest object_request;
+            object_request.SetBucket(bucket.c_str());
+            object_request.SetKey(object.c_str());
+            object_request.SetRange(("bytes=" + std::to_string(offset) + "-" + std::to_string(offset + length - 1)).c_str());
+            auto get_object_outcome = client_.GetObject(object_request);
+            if (!get_object_outcome.IsSuccess()) {
+                SPDLOG_LOGGER_ERROR(s3_logger, "Failed to get object at {} range from {} to {}", path, offset, offset + length - 1);
+                failed = true;
+                return;
+            }
+            auto& retrieved_part = get_object_outcome.GetResultWithOwnership().GetBody();
+            retrieved_part.read(contents->data() + offset, length);
+            if (static_cast<uint64_t>(retrieved_part.gcount()) != length) {
+                SPDLOG_LOGGER_ERROR(s3_logger, "Object at {} range from {} to {} is incomplete", path, offset, offset + length - 1);
+                failed = true;
+                return;
+            }
+        }
+    };
+    const size_t connections = std::min(downloadConnections_, parts.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < connections; ++i) {
+        workers.emplace_back(readParts);
+    }
+    readParts();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return StatusCode::S3_FAILED_GET_OBJECT;
+    }
+    SPDLOG_LOGGER_TRACE(s3_logger, "Object {} has been read into memory (bytes={})", path, size);
+    return StatusCode::OK;
+}
+
 StatusCode S3FileSystem::downloadFileFolder(const std::string& path, const std::string& local_path) {
     bool exists;
     auto status = fileExists(path, &exists);
@@ -447,60 +646,106 @@ StatusCode S3FileSystem::downloadFileFolder(const std::string& path, const std::
             }
         }
 
+        std::vector<std::pair<std::string, std::string>> objects;
         for (auto iter = files.begin(); iter != files.end(); ++iter) {
             if (std::any_of(acceptedFiles.begin(), acceptedFiles.end(), [&iter](const std::string& x) {
                     return iter->size() > 0 && endsWith(*iter, x);
                 })) {
-                std::string bucket, object;
-                status = parsePath(*iter, &bucket, &object);
-                if (status != StatusCode::OK) {
-                    return status;
-                }
-
-                // Send a request for the objects metadata
-                s3::Model::GetObjectRequest object_request;
-                object_request.SetBucket(bucket.c_str());
-                object_request.SetKey(object.c_str());
-
-                auto get_object_outcome = client_.GetObject(object_request);
-                if (get_object_outcome.IsSuccess()) {
-                    auto& retrieved_file =
-                        get_object_outcome.GetResultWithOwnership().GetBody();
-                    std::string s3_removed_path = (*iter).substr(effective_path.size());
-                    std::string local_file_path = joinPath({local_path, s3_removed_path});
-                    std::ofstream output_file(local_file_path.c_str(), std::ios::binary);
-                    output_file << retrieved_file.rdbuf();
-                    output_file.close();
-                } else {
-                    SPDLOG_LOGGER_ERROR(s3_logger, "Failed to get object at {}", *iter);
-                    return StatusCode::S3_FAILED_GET_OBJECT;
-                }
+                std::string s3_removed_path = (*iter).substr(effective_path.size());
+                objects.emplace_back(*iter, joinPath({local_path, s3_removed_path}));
             }
         }
-    } else {
-        std::string bucket, object;
-        auto s = parsePath(effective_path, &bucket, &object);
-        if (s != StatusCode::OK) {
-            return s;
-        }
-
-        // Send a request for the objects metadata
-        s3::Model::GetObjectRequest object_request;
-        object_request.SetBucket(bucket.c_str());
-        object_request.SetKey(object.c_str());
+        return downloadObjects(objects);
+    }
+    return downloadObjects({{effective_path, local_path}});
+}
 
-        auto get_object_outcome = client_.GetObject(object_request);
-        if (get_object_outcome.IsSuccess()) {
-            auto& retrieved_file = get_object_outcome.GetResultWithOwnership().GetBody();
-            std::ofstream output_file(local_path.c_str(), std::ios::binary);
-            output_file << retrieved_file.rdbuf();
-            output_file.close();
-        } else {
-            SPDLOG_LOGGER_ERROR(s3_logger, "Failed to get object at {}", effective_path);
+StatusCode S3FileSystem::downloadObjects(const std::vector<std::pair<std::string, std::string>>& objects) {
+    struct ObjectLocation {
+        std::string bucket;
+        std::string key;
+    };
+    std::vector<ObjectLocation> locations(objects.size());
+    std::vector<uint64_t> sizes(objects.size());
+    std::vector<std::string> etags(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const auto& [s3Path, localFilePath] = objects[i];
+        auto status = parsePath(s3Path, &locations[i].bucket, &locations[i].key);
+        if (status != StatusCode::OK) {
+            return status;
+        }
+        s3::Model::HeadObjectRequest head_request;
+        head_request.SetBucket(locations[i].bucket.c_str());
+        head_request.SetKey(locations[i].key.c_str());
+        auto head_object_outcome = client_.HeadObject(head_request);
+        if (!head_object_outcome.IsSuccess()) {
+            SPDLOG_LOGGER_ERROR(s3_logger, "Failed to get object at {}", s3Path);
             return StatusCode::S3_FAILED_GET_OBJECT;
         }
+        sizes[i] = head_object_outcome.GetResult().GetContentLength();
+        etags[i] = head_object_outcome.GetResult().GetETag().c_str();
+        if (FetchedObjects::instance().reuse(etags[i], sizes[i], localFilePath)) {
+            // unchanged object of another version, nothing to request
+            etags[i].clear();
+            sizes[i] = 0;
+            continue;
+        }
+        // parts are written in place, file gets its final size up front
+        std::ofstream output_file(localFilePath.c_str(), std::ios::binary);
+        output_file.close();
+        std::error_code error;
+        fs::resize_file(localFilePath, sizes[i], error);
+        if (error) {
+            SPDLOG_LOGGER_ERROR(s3_logger, "Failed to create local file: {} {}", localFilePath, error.message());
+            return StatusCode::PATH_INVALID;
+        }
     }
 
+    const auto parts = splitIntoParts(sizes, downloadPartSize_);
+    std::atomic<size_t> nextPart{0};
+    std::atomic<bool> failed{false};
+    auto downloadParts = [&]() {
+        for (size_t part = nextPart++; part < parts.size() && !failed; part = nextPart++) {
+            const auto [objectIndex, offset] = parts[part];
+            const uint64_t end = std::min(offset + downloadPartSize_, sizes[objectIndex]) - 1;
+            s3::Model::GetObjectRequest object_request;
+            object_request.SetBucket(locations[objectIndex].bucket.c_str());
+            object_request.SetKey(locations[objectIndex].key.c_str());
+            object_request.SetRange(("bytes=" + std::to_string(offset) + "-" + std::to_string(end)).c_str());
+            auto get_object_outcome = client_.GetObject(object_request);
+            if (!get_object_outcome.IsSuccess()) {
+                SPDLOG_LOGGER_ERROR(s3_logger, "Failed to get object at {} range from {} to {}", objects[objectIndex].first, offset, end);
+                failed = true;
+                return;
+            }
+            auto& retrieved_part = get_object_outcome.GetResultWithOwnership().GetBody();
+            std::fstream output_file(objects[objectIndex].second.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+            output_file.seekp(offset);
+            output_file << retrieved_part.rdbuf();
+            output_file.close();
+            if (output_file.fail()) {
+                SPDLOG_LOGGER_ERROR(s3_logger, "Failed to write local file: {}", objects[objectIndex].second);
+                failed = true;
+                return;
+            }
+        }
+    };
+    const size_t connections = std::min(downloadConnections_, parts.size());
+    SPDLOG_LOGGER_DEBUG(s3_logger, "Downloading {} objects in {} parts with {} connections", objects.size(), parts.size(), connections);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < connections; ++i) {
+        workers.emplace_back(downloadParts);
+    }
+    downloadParts();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return StatusCode::S3_FAILED_GET_OBJECT;
+    }
+    for (size_t i = 0; i < objects.size(); ++i) {
+        FetchedObjects::instance().add(etags[i], sizes[i], objects[i].second);
+    }
     return StatusCode::OK;
 }
 
@@ -536,6 +781,73 @@ StatusCode S3FileSystem::downloadModelVersions(const std::string& path,
     return result;
 }
 
+StatusCode S3FileSystem::getVersionFingerprint(const std::string& path, model_version_t version, std::string* fingerprint) {
+    std::string bucket, object;
+    auto status = parsePath(joinPath({path, std::to_string(version)}), &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    std::stringstream description;
+    bool found = false;
+    status = listAllObjects(bucket, appendSlash(object), [&description, &found](const s3::Model::Object& s3_object) {
+        description << s3_object.GetKey() << ":" << s3_object.GetETag() << ":" << s3_object.GetSize() << "\n";
+        found = true;
+        return true;
+    });
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    if (!found) {
+        return StatusCode::S3_FILE_NOT_FOUND;
+    }
+    *fingerprint = description.str();
+    return StatusCode::OK;
+}
+
+StatusCode S3FileSystem::listObjectKeys(const std::string& path, std::vector<std::string>* keys, size_t maxKeys) {
+    std::string bucket, object;
+    auto status = parsePath(path, &bucket, &object);
+    if (status != StatusCode::OK) {
+        return status;
+    }
+    status = listAllObjects(bucket, appendSlash(object), [&](const s3::Model::Object& s3_object) {
+        keys->push_back(S3_URL_PREFIX + bucket + "/" + s3_object.GetKey().c_str());
+        return keys->size() <= maxKeys;
+    });
+    if (status == StatusCode::OK && keys->size() > maxKeys) {
+        SPDLOG_LOGGER_DEBUG(s3_logger, "More than {} objects under {}, listing is abandoned", maxKeys, path);
+        return StatusCode::S3_FAILED_LIST_OBJECTS;
+    }
+    return status;
+}
+
+StatusCode S3FileSystem::listAllObjects(const std::string& bucket, const std::string& prefix, const std::function<bool(const s3::Model::Object&)>& visit) {
+    Aws::String marker;
+    bool truncated = true;
+    while (truncated) {
+        s3::Model::ListObjectsRequest list_objects_request;
+        list_objects_request.SetBucket(bucket.c_str());
+        list_objects_request.SetPrefix(prefix.c_str());
+        if (!marker.empty()) {
+            list_objects_request.SetMarker(marker);
+        }
+        auto list_objects_outcome = client_.ListObjects(list_objects_request);
+        if (!list_objects_outcome.IsSuccess()) {
+            SPDLOG_LOGGER_ERROR(s3_logger, "Failed to list objects with prefix {}", prefix);
+            return StatusCode::S3_FAILED_LIST_OBJECTS;
+        }
+        const auto& result = list_objects_outcome.GetResult();
+        for (const auto& s3_object : result.GetContents()) {
+            if (!visit(s3_object)) {
+                return StatusCode::OK;
+            }
+            marker = s3_object.GetKey();
+        }
+        truncated = result.GetIsTruncated() && !result.GetContents().empty();
+    }
+    return StatusCode::OK;
+}
+
 StatusCode S3FileSystem::deleteFileFolder(const std::string& path) {
     remove(path.c_str());
     return StatusCode::OK;
@@ -15,34 +15,64 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <regex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <aws/core/Aws.h>
 #include <aws/s3/S3Client.h>
+#include <aws/s3/model/Object.h>
 
 #include "filesystem.hpp"
 #include "status.hpp"
 
 namespace ovms {
 
+/**
+ * @brief Keeps AWS SDK initialized while any guard exists. SDK is initialized by the first guard and shut down
+ * by the last one destroyed, so clients owning a guard never outlive the SDK, also at process exit.
+ */
+class AwsSdkGuard {
+public:
+    AwsSdkGuard();
+    ~AwsSdkGuard();
+    AwsSdkGuard(const AwsSdkGuard&) = delete;
+    AwsSdkGuard& operator=(const AwsSdkGuard&) = delete;
+
+    /**
+     * @brief Number of guards keeping the SDK initialized
+     */
+    static size_t getUsersCount();
+};
+
 class S3FileSystem : public FileSystem {
 public:
     /**
-     * @brief Construct a new S3FileSystem object
+     * @brief Construct a new S3FileSystem object, AWS SDK is initialized if no other instance keeps it
      * 
-     * @param options 
      * @param s3_path 
      */
-    S3FileSystem(const Aws::SDKOptions& options, const std::string& s3_path);
+    explicit S3FileSystem(const std::string& s3_path);
 
     /**
-     * @brief Destroy the S3FileSystem object
+     * @brief Destroy the S3FileSystem object, AWS SDK is shut down after the client if no other instance keeps it
      * 
      */
     ~S3FileSystem();
 
+    /**
+     * @brief Get the file system shared by all paths with the same endpoint and credentials, so TLS connections
+     * and credential lookups of the client are reused.
+     * 
+     * @param s3_path 
+     * @return std::shared_ptr<S3FileSystem> 
+     */
+    static std::shared_ptr<S3FileSystem> getShared(const std::string& s3_path);
+
     /**
      * @brief Check if given path or file exists
      * 
@@ -97,6 +127,24 @@ public:
      */
     StatusCode readTextFile(const std::string& path, std::string* contents) override;
 
+    /**
+     * @brief Read the content of the given object into memory with parallel ranged requests
+     * 
+     * @param path 
+     * @param contents 
+     * @return StatusCode 
+     */
+    StatusCode readFileToMemory(const std::string& path, std::string* contents) override;
+
+    /**
+     * @brief Upload the content of the given object with a single request
+     * 
+     * @param path 
+     * @param contents 
+     * @return StatusCode 
+     */
+    StatusCode writeFile(const std::string& path, const std::string& contents) override;
+
     /**
      * @brief Download a remote directory
      * 
@@ -116,6 +164,26 @@ public:
      */
     StatusCode downloadModelVersions(const std::string& path, std::string* local_path, const std::vector<model_version_t>& versions) override;
 
+    /**
+     * @brief Lists names, ETags and sizes of objects of model version
+     *
+     * @param path
+     * @param version
+     * @param fingerprint
+     * @return StatusCode
+     */
+    StatusCode getVersionFingerprint(const std::string& path, model_version_t version, std::string* fingerprint) override;
+
+    /**
+     * @brief Lists urls of all objects under the prefix
+     *
+     * @param path
+     * @param keys
+     * @param maxKeys
+     * @return StatusCode
+     */
+    StatusCode listObjectKeys(const std::string& path, std::vector<std::string>* keys, size_t maxKeys) override;
+
     /**
      * @brief Delete a folder
      * 
@@ -124,9 +192,34 @@ public:
      */
     StatusCode deleteFileFolder(const std::string& path) override;
 
+    const char* getBackendName() const override {
+        return "s3";
+    }
+
     static const std::string S3_URL_PREFIX;
 
+    static constexpr size_t DEFAULT_DOWNLOAD_PART_SIZE_MB = 16;
+    static constexpr size_t DEFAULT_DOWNLOAD_CONNECTIONS = 8;
+
 private:
+    /**
+     * @brief Lists objects under prefix page by page
+     *
+     * @param bucket
+     * @param prefix
+     * @param visit called for each object, listing stops when it returns false
+     * @return StatusCode
+     */
+    StatusCode listAllObjects(const std::string& bucket, const std::string& prefix, const std::function<bool(const Aws::S3::Model::Object&)>& visit);
+
+    /**
+     * @brief Downloads objects with ranged GETs spread over a pool of connections, so big files and many files are fetched in parallel
+     *
+     * @param objects pairs of s3 path and local file path
+     * @return StatusCode
+     */
+    StatusCode downloadObjects(const std::vector<std::pair<std::string, std::string>>& objects);
+
     /**
      * @brief 
      * 
@@ -138,16 +231,26 @@ private:
     StatusCode parsePath(const std::string& path, std::string* bucket, std::string* object);
 
     /**
-     * @brief 
-     * 
+     * @brief Declared before client_, so that the SDK is shut down only after the client is destroyed
      */
-    Aws::SDKOptions options_;
+    AwsSdkGuard sdk_;
 
     /**
      * @brief 
      * 
      */
     Aws::S3::S3Client client_;
+
+    /**
+     * @brief Size of ranges fetched with one GET, set with S3_DOWNLOAD_PART_SIZE_MB environment variable
+     */
+    uint64_t downloadPartSize_ = DEFAULT_DOWNLOAD_PART_SIZE_MB * 1024 * 1024;
+
+    /**
+     * @brief Number of parallel GETs of one download, set with S3_DOWNLOAD_CONNECTIONS environment variable
+     */
+    size_t downloadConnections_ = DEFAULT_DOWNLOAD_CONNECTIONS;
+
     std::regex s3_regex_;
     std::regex proxy_regex_;
 };
@@ -0,0 +1,539 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "samplingprofiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "compression.hpp"
+
+namespace ovms {
+
+namespace {
+constexpr std::chrono::milliseconds DRAIN_PERIOD{10};
+// frame records of callers are above the interrupted stack pointer, within the largest thread stack
+constexpr uintptr_t MAX_STACK_SPAN = 64 * 1024 * 1024;
+constexpr uintptr_t PAGE_MASK = ~static_cast<uintptr_t>(4096 - 1);
+// threads with a tag claim a slot at its first change, probing from their thread id
+constexpr size_t THREAD_TAG_SLOTS_COUNT = 4096;
+constexpr size_t THREAD_TAG_PROBES_COUNT = 64;
+
+enum SlotState : uint32_t {
+    SLOT_FREE,
+    SLOT_WRITING,
+    SLOT_READY
+};
+
+struct SampleSlot {
+    std::atomic<uint32_t> state{SLOT_FREE};
+    int tid = 0;
+    const char* tag = nullptr;
+    int depth = 0;
+    uintptr_t frames[SamplingProfiler::MAX_STACK_DEPTH];
+};
+
+struct ThreadTagSlot {
+    std::atomic<int> tid{0};
+    std::atomic<const char*> tag{nullptr};
+};
+
+// allocated once and never released, a handler may still run shortly after sampling is stopped
+SampleSlot* sampleSlots = nullptr;
+std::atomic<bool> sampling{false};
+std::atomic<uint64_t> nextSlot{0};
+std::atomic<uint64_t> droppedSamples{0};
+
+// read by the signal handler, which must not touch thread_local storage that may be allocated lazily
+ThreadTagSlot threadTagSlots[THREAD_TAG_SLOTS_COUNT];
+
+/**
+ * @brief Releases the tag slot of a thread when it exits
+ */
+struct ThreadTagSlotOwner {
+    ThreadTagSlot* slot = nullptr;
+    bool claimAttempted = false;
+
+    ~ThreadTagSlotOwner() {
+        if (slot != nullptr) {
+            slot->tag.store(nullptr, std::memory_order_relaxed);
+            slot->tid.store(0, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadTagSlotOwner threadTagSlotOwner;
+
+const char* findThreadTag(int tid) {
+    for (size_t probe = 0; probe < THREAD_TAG_PROBES_COUNT; ++probe) {
+        auto& slot = threadTagSlots[(static_cast<size_t>(tid) + probe) % THREAD_TAG_SLOTS_COUNT];
+        if (slot.tid.load(std::memory_order_acquire) == tid) {
+            return slot.tag.load(std::memory_order_relaxed);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Checks that 8 bytes at address can be read without faulting
+ *
+ * Kernel copies the signal set before validating the operation, so unreadable memory fails with EFAULT
+ * and readable with EINVAL. Both a system call and its errno are async-signal-safe.
+ */
+bool isReadable(uintptr_t address) {
+    const long result = syscall(SYS_rt_sigprocmask, ~0, reinterpret_cast<void*>(address), nullptr, sizeof(uint64_t));
+    return result != 0 && errno != EFAULT;
+}
+
+/**
+ * @brief Walks frame records of the interrupted thread, saved frame pointer followed by return address
+ *
+ * Unlike backtrace, it neither loads the unwinder nor takes its locks, so it is safe in a signal handler.
+ * Functions built without frame pointers end or skip part of the stack.
+ */
+int walkFrames(const ucontext_t& context, uintptr_t* frames, int maxDepth) {
+    uintptr_t pc = 0;
+    uintptr_t fp = 0;
+    uintptr_t sp = 0;
+#if defined(__x86_64__)
+    pc = static_cast<uintptr_t>(context.uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<uintptr_t>(context.uc_mcontext.gregs[REG_RBP]);
+    sp = static_cast<uintptr_t>(context.uc_mcontext.gregs[REG_RSP]);
+#elif defined(__aarch64__)
+    pc = static_cast<uintptr_t>(context.uc_mcontext.pc);
+    fp = static_cast<uintptr_t>(context.uc_mcontext.regs[29]);
+    sp = static_cast<uintptr_t>(context.uc_mcontext.sp);
+#endif
+    if (pc == 0) {
+        return 0;
+    }
+    int depth = 0;
+    frames[depth++] = pc;
+    uintptr_t readablePage = 0;
+    while (depth < maxDepth && fp % sizeof(uintptr_t) == 0 && fp >= sp && fp - sp < MAX_STACK_SPAN) {
+        for (uintptr_t word : {fp, fp + sizeof(uintptr_t)}) {
+            if ((word & PAGE_MASK) != readablePage) {
+                if (!isReadable(word)) {
+                    return depth;
+                }
+                readablePage = word & PAGE_MASK;
+            }
+        }
+        const auto* record = reinterpret_cast<const uintptr_t*>(fp);
+        if (record[1] == 0) {
+            break;
+        }
+        frames[depth++] = record[1];
+        // callers are higher on the stack
+        if (record[0] <= fp) {
+            break;
+        }
+        sp = fp;
+        fp = record[0];
+    }
+    return depth;
+}
+
+void onProfilingSignal(int, siginfo_t*, void* context) {
+    if (!sampling.load(std::memory_order_acquire)) {
+        return;
+    }
+    const int savedErrno = errno;
+    auto& slot = sampleSlots[nextSlot.fetch_add(1, std::memory_order_relaxed) % SamplingProfiler::SAMPLE_SLOTS_COUNT];
+    uint32_t expected = SLOT_FREE;
+    if (!slot.state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acquire)) {
+        // profiling thread did not drain the ring in time
+        droppedSamples.fetch_add(1, std::memory_order_relaxed);
+        errno = savedErrno;
+        return;
+    }
+    slot.tid = static_cast<int>(syscall(SYS_gettid));
+    slot.tag = findThreadTag(slot.tid);
+    slot.depth = walkFrames(*static_cast<const ucontext_t*>(context), slot.frames, SamplingProfiler::MAX_STACK_DEPTH);
+    slot.state.store(SLOT_READY, std::memory_order_release);
+    errno = savedErrno;
+}
+
+bool installSignalHandler() {
+    sampleSlots = new SampleSlot[SamplingProfiler::SAMPLE_SLOTS_COUNT];
+    struct sigaction action = {};
+    action.sa_sigaction = onProfilingSignal;
+    sigemptyset(&action.sa_mask);
+    // handler stays installed, a pending signal after the timer is stopped must not terminate the process
+    action.sa_flags = SA_RESTART | SA_SIGINFO;
+    return sigaction(SIGPROF, &action, nullptr) == 0;
+}
+
+bool setProfilingTimer(uint32_t frequency) {
+    struct itimerval timer = {};
+    if (frequency > 0) {
+        const long periodMicroseconds = 1'000'000 / static_cast<long>(frequency);
+        timer.it_interval.tv_sec = periodMicroseconds / 1'000'000;
+        timer.it_interval.tv_usec = periodMicroseconds % 1'000'000;
+        timer.it_value = timer.it_interval;
+    }
+    return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+std::string readThreadName(int tid) {
+    std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+    std::string name;
+    if (!std::getline(comm, name) || name.empty()) {
+        return "thread_" + std::to_string(tid);
+    }
+    return name;
+}
+
+/**
+ * @brief Strips parameters and qualifiers after them from demangled function name, templates are kept
+ */
+std::string stripParameters(std::string name) {
+    const auto close = name.rfind(')');
+    if (close == std::string::npos) {
+        return name;
+    }
+    int depth = 0;
+    for (size_t i = close + 1; i-- > 0;) {
+        if (name[i] == ')') {
+            ++depth;
+        } else if (name[i] == '(' && --depth == 0) {
+            // "operator()" keeps its own parentheses
+            if (i > 0) {
+                name.resize(i);
+            }
+            return name;
+        }
+    }
+    return name;
+}
+
+std::string toHex(uintptr_t value) {
+    char buffer[2 + 2 * sizeof(uintptr_t) + 1];
+    snprintf(buffer, sizeof(buffer), "0x%lx", static_cast<unsigned long>(value));
+    return buffer;
+}
+
+std::string sanitizeFrame(std::string frame) {
+    for (auto& c : frame) {
+        if (c == ';' || c == '\n') {
+            c = ':';
+        }
+    }
+    return frame;
+}
+
+/**
+ * @brief Return addresses point after the call, the calling instruction is symbolized instead
+ */
+uintptr_t callerAddress(const std::vector<uintptr_t>& frames, size_t index) {
+    return index == 0 ? frames[index] : frames[index] - 1;
+}
+
+/**
+ * @brief Serializes protocol buffers wire format of pprof profile messages
+ */
+class ProtoWriter {
+public:
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<char>(value));
+    }
+
+    void uint64Field(uint32_t field, uint64_t value) {
+        varint(static_cast<uint64_t>(field) << 3);
+        varint(value);
+    }
+
+    void bytesField(uint32_t field, const std::string& value) {
+        varint((static_cast<uint64_t>(field) << 3) | 2);
+        varint(value.size());
+        bytes.append(value);
+    }
+
+    void packedField(uint32_t field, const std::vector<uint64_t>& values) {
+        ProtoWriter packed;
+        for (auto value : values) {
+            packed.varint(value);
+        }
+        bytesField(field, packed.bytes);
+    }
+
+    std::string bytes;
+};
+}  // namespace
+
+void setCurrentThreadName(const std::string& name) {
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+}
+
+const char* setCurrentProfilerTag(const char* tag) {
+    auto& owner = threadTagSlotOwner;
+    if (owner.slot == nullptr && !owner.claimAttempted) {
+        owner.claimAttempted = true;
+        const int tid = static_cast<int>(syscall(SYS_gettid));
+        for (size_t probe = 0; probe < THREAD_TAG_PROBES_COUNT && owner.slot == nullptr; ++probe) {
+            auto& slot = threadTagSlots[(static_cast<size_t>(tid) + probe) % THREAD_TAG_SLOTS_COUNT];
+            int expected = 0;
+            if (slot.tid.compare_exchange_strong(expected, tid, std::memory_order_acq_rel)) {
+                owner.slot = &slot;
+            }
+        }
+    }
+    // samples of threads which found no free slot are not tagged
+    if (owner.slot == nullptr) {
+        return nullptr;
+    }
+    return owner.slot->tag.exchange(tag, std::memory_order_relaxed);
+}
+
+std::string symbolizeAddress(uintptr_t address) {
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(address), &info) == 0) {
+        return toHex(address);
+    }
+    if (info.dli_sname != nullptr) {
+        int status = 0;
+        std::unique_ptr<char, decltype(&std::free)> demangled(abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+        return status == 0 && demangled ? stripParameters(demangled.get()) : std::string(info.dli_sname);
+    }
+    if (info.dli_fname != nullptr) {
+        std::string library(info.dli_fname);
+        library = library.substr(library.rfind('/') + 1);
+        return library + "+" + toHex(address - reinterpret_cast<uintptr_t>(info.dli_fbase));
+    }
+    return toHex(address);
+}
+
+void Profile::add(const std::string& thread, const char* tag, const uintptr_t* frames, size_t depth, uint64_t count) {
+    stacks[key_t(thread, tag != nullptr ? tag : "", std::vector<uintptr_t>(frames, frames + depth))] += count;
+    samplesCount += count;
+}
+
+std::string Profile::toFolded(const symbolizer_t& symbolizer) const {
+    std::unordered_map<uintptr_t, std::string> symbols;
+    // different addresses within the same functions give the same folded stack
+    std::map<std::string, uint64_t> foldedStacks;
+    for (const auto& [key, count] : stacks) {
+        const auto& [thread, tag, frames] = key;
+        std::string stack = sanitizeFrame(thread);
+        if (!tag.empty()) {
+            stack += ";[" + tag + "]";
+        }
+        for (size_t i = frames.size(); i-- > 0;) {
+            const auto address = callerAddress(frames, i);
+            auto symbol = symbols.find(address);
+            if (symbol == symbols.end()) {
+                symbol = symbols.emplace(address, sanitizeFrame(symbolizer(address))).first;
+            }
+            stack += ";" + symbol->second;
+        }
+        foldedStacks[stack] += count;
+    }
+    std::string folded;
+    for (const auto& [stack, count] : foldedStacks) {
+        folded += stack + " " + std::to_string(count) + "\n";
+    }
+    return folded;
+}
+
+std::string Profile::toPprof(const symbolizer_t& symbolizer) const {
+    std::vector<std::string> strings{""};
+    std::unordered_map<std::string, uint64_t> stringIds{{"", 0}};
+    auto stringId = [&strings, &stringIds](const std::string& value) {
+        auto [it, inserted] = stringIds.emplace(value, strings.size());
+        if (inserted) {
+            strings.push_back(value);
+        }
+        return it->second;
+    };
+    auto valueType = [&stringId](const std::string& type, const std::string& unit) {
+        ProtoWriter message;
+        message.uint64Field(1, stringId(type));
+        message.uint64Field(2, stringId(unit));
+        return message.bytes;
+    };
+
+    ProtoWriter profile;
+    profile.bytesField(1, valueType("samples", "count"));
+    profile.bytesField(1, valueType("cpu", "nanoseconds"));
+
+    std::unordered_map<uintptr_t, uint64_t> locationIds;
+    std::unordered_map<std::string, uint64_t> functionIds;
+    ProtoWriter locations;
+    ProtoWriter functions;
+    const uint64_t threadKey = stringId("thread");
+    const uint64_t tagKey = stringId("tag");
+    for (const auto& [key, count] : stacks) {
+        const auto& [thread, tag, frames] = key;
+        std::vector<uint64_t> stackLocations;
+        stackLocations.reserve(frames.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const auto address = callerAddress(frames, i);
+            auto location = locationIds.find(address);
+            if (location == locationIds.end()) {
+                const auto name = symbolizer(address);
+                auto [function, inserted] = functionIds.emplace(name, functionIds.size() + 1);
+                if (inserted) {
+                    ProtoWriter message;
+                    message.uint64Field(1, function->second);
+                    message.uint64Field(2, stringId(name));
+                    message.uint64Field(3, stringId(name));
+                    functions.bytesField(5, message.bytes);
+                }
+                location = locationIds.emplace(address, locationIds.size() + 1).first;
+                ProtoWriter line;
+                line.uint64Field(1, function->second);
+                ProtoWriter message;
+                message.uint64Field(1, location->second);
+                message.uint64Field(3, address);
+                message.bytesField(4, line.bytes);
+                locations.bytesField(4, message.bytes);
+            }
+            stackLocations.push_back(location->second);
+        }
+        ProtoWriter sample;
+        sample.packedField(1, stackLocations);
+        sample.packedField(2, {count, count * static_cast<uint64_t>(periodNanoseconds)});
+        ProtoWriter threadLabel;
+        threadLabel.uint64Field(1, threadKey);
+        threadLabel.uint64Field(2, stringId(thread));
+        sample.bytesField(3, threadLabel.bytes);
+        if (!tag.empty()) {
+            ProtoWriter tagLabel;
+            tagLabel.uint64Field(1, tagKey);
+            tagLabel.uint64Field(2, stringId(tag));
+            sample.bytesField(3, tagLabel.bytes);
+        }
+        profile.bytesField(2, sample.bytes);
+    }
+    profile.bytes.append(locations.bytes);
+    profile.bytes.append(functions.bytes);
+    for (const auto& value : strings) {
+        profile.bytesField(6, value);
+    }
+    profile.uint64Field(10, static_cast<uint64_t>(durationNanoseconds));
+    profile.bytesField(11, valueType("cpu", "nanoseconds"));
+    profile.uint64Field(12, static_cast<uint64_t>(periodNanoseconds));
+    return profile.bytes;
+}
+
+SamplingProfiler& SamplingProfiler::instance() {
+    static SamplingProfiler instance;
+    return instance;
+}
+
+Status SamplingProfiler::profile(const ProfileOptions& options, std::string& output) {
+    Profile collected;
+    auto status = collect(options.duration, options.frequency, collected);
+    if (!status.ok()) {
+        return status;
+    }
+    SPDLOG_INFO("Collected CPU profile of {} ms: {} samples, {} dropped", options.duration.count(), collected.getSamplesCount(), collected.getDroppedSamples());
+    if (options.format == ProfileFormat::FOLDED) {
+        output = collected.toFolded();
+        return StatusCode::OK;
+    }
+    return compressGzip(collected.toPprof(), &output);
+}
+
+Status SamplingProfiler::collect(std::chrono::milliseconds duration, uint32_t frequency, Profile& profile) {
+    if (duration.count() <= 0 || duration > MAX_PROFILE_DURATION || frequency == 0 || frequency > MAX_PROFILE_FREQUENCY) {
+        return StatusCode::PROFILE_OPTIONS_INVALID;
+    }
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return StatusCode::PROFILER_BUSY;
+    }
+    static const bool installed = installSignalHandler();
+    if (!installed) {
+        SPDLOG_ERROR("Installing SIGPROF handler failed: {}", std::strerror(errno));
+        return StatusCode::PROFILER_START_FAILED;
+    }
+    for (size_t i = 0; i < SAMPLE_SLOTS_COUNT; ++i) {
+        sampleSlots[i].state.store(SLOT_FREE, std::memory_order_relaxed);
+    }
+    droppedSamples.store(0, std::memory_order_relaxed);
+    profile.setPeriod(std::chrono::nanoseconds(1'000'000'000 / frequency));
+    sampling.store(true, std::memory_order_release);
+    if (!setProfilingTimer(frequency)) {
+        sampling.store(false, std::memory_order_release);
+        SPDLOG_ERROR("Starting profiling timer failed: {}", std::strerror(errno));
+        return StatusCode::PROFILER_START_FAILED;
+    }
+    SPDLOG_INFO("Started CPU profile for {} ms at {} Hz", duration.count(), frequency);
+    std::map<int, std::string> threadNames;
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + duration;
+    for (auto now = start; now < end; now = std::chrono::steady_clock::now()) {
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(DRAIN_PERIOD, end - now));
+        drain(profile, threadNames);
+    }
+    setProfilingTimer(0);
+    sampling.store(false, std::memory_order_release);
+    drain(profile, threadNames);
+    profile.setDuration(std::chrono::steady_clock::now() - start);
+    profile.setDroppedSamples(droppedSamples.load(std::memory_order_relaxed));
+    return StatusCode::OK;
+}
+
+bool SamplingProfiler::isSampling() const {
+    return sampling.load(std::memory_order_acquire);
+}
+
+void SamplingProfiler::drain(Profile& profile, std::map<int, std::string>& threadNames) {
+    uintptr_t frames[MAX_STACK_DEPTH];
+    for (size_t i = 0; i < SAMPLE_SLOTS_COUNT; ++i) {
+        auto& slot = sampleSlots[i];
+        if (slot.state.load(std::memory_order_acquire) != SLOT_READY) {
+            continue;
+        }
+        const int depth = slot.depth;
+        if (depth > 0) {
+            std::copy(slot.frames, slot.frames + depth, frames);
+            auto name = threadNames.find(slot.tid);
+            if (name == threadNames.end()) {
+                // threads are named once they start, so the name read at their first sample is kept
+                name = threadNames.emplace(slot.tid, readThreadName(slot.tid)).first;
+            }
+            profile.add(name->second, slot.tag, frames, static_cast<size_t>(depth));
+        }
+        slot.state.store(SLOT_FREE, std::memory_order_release);
+    }
+}
+
+}  // namespace ovms
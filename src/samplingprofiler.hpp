@@ -0,0 +1,190 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Names calling thread, the name is shown in profiles and by system tools. Names longer than 15 characters are truncated.
+ */
+void setCurrentThreadName(const std::string& name);
+
+/**
+ * @brief Replaces subsystem tag of samples taken on the calling thread
+ *
+ * @param tag static string, nullptr clears the tag
+ *
+ * @return previous tag
+ */
+const char* setCurrentProfilerTag(const char* tag);
+
+/**
+ * @brief Tags samples of the calling thread for its lifetime, e.g. "rest_parsing", restoring the previous tag afterwards
+ */
+class ProfilerTag {
+public:
+    explicit ProfilerTag(const char* tag) :
+        previous(setCurrentProfilerTag(tag)) {}
+
+    ~ProfilerTag() {
+        setCurrentProfilerTag(previous);
+    }
+
+    ProfilerTag(const ProfilerTag&) = delete;
+    ProfilerTag& operator=(const ProfilerTag&) = delete;
+
+private:
+    const char* const previous;
+};
+
+enum class ProfileFormat {
+    FOLDED,
+    PPROF
+};
+
+struct ProfileOptions {
+    std::chrono::milliseconds duration{10'000};
+    /**
+     * @brief Samples per second of CPU time
+     */
+    uint32_t frequency = 99;
+    ProfileFormat format = ProfileFormat::FOLDED;
+};
+
+const std::chrono::seconds MAX_PROFILE_DURATION{60};
+const uint32_t MAX_PROFILE_FREQUENCY = 1000;
+
+/**
+ * @brief Gives printable name of code address
+ */
+using symbolizer_t = std::function<std::string(uintptr_t)>;
+
+/**
+ * @brief Demangled function name of the address without its parameters, library and offset when there is no symbol, or hex address
+ */
+std::string symbolizeAddress(uintptr_t address);
+
+/**
+ * @brief Sampled call stacks aggregated by thread name, tag and frames
+ */
+class Profile {
+public:
+    /**
+     * @param frames return addresses, innermost first
+     */
+    void add(const std::string& thread, const char* tag, const uintptr_t* frames, size_t depth, uint64_t count = 1);
+
+    /**
+     * @brief Sets CPU time represented by one sample
+     */
+    void setPeriod(std::chrono::nanoseconds period) {
+        periodNanoseconds = period.count();
+    }
+
+    void setDuration(std::chrono::nanoseconds duration) {
+        durationNanoseconds = duration.count();
+    }
+
+    void setDroppedSamples(uint64_t dropped) {
+        droppedSamples = dropped;
+    }
+
+    uint64_t getSamplesCount() const {
+        return samplesCount;
+    }
+
+    uint64_t getDroppedSamples() const {
+        return droppedSamples;
+    }
+
+    /**
+     * @brief Folded stacks, one "thread;[tag];outermost;...;innermost count" line per distinct stack, readable by flamegraph.pl
+     */
+    std::string toFolded(const symbolizer_t& symbolizer = symbolizeAddress) const;
+
+    /**
+     * @brief Uncompressed profile.proto message of pprof, thread and tag are sample labels
+     */
+    std::string toPprof(const symbolizer_t& symbolizer = symbolizeAddress) const;
+
+private:
+    using key_t = std::tuple<std::string, std::string, std::vector<uintptr_t>>;
+
+    int64_t periodNanoseconds = 0;
+    int64_t durationNanoseconds = 0;
+    uint64_t samplesCount = 0;
+    uint64_t droppedSamples = 0;
+    std::map<key_t, uint64_t> stacks;
+};
+
+/**
+ * @brief CPU profiler sampling stacks of all server threads, started on demand for a limited time
+ *
+ * SIGPROF timer fires per consumed CPU time and the signal is delivered to the running thread, so only threads doing work
+ * are sampled, with overhead proportional to frequency. Signal handler walks frame pointers of the interrupted thread
+ * into a preallocated slot, which is aggregated by the profiling thread, so it neither allocates nor takes locks.
+ * Only one profile runs at a time.
+ */
+class SamplingProfiler {
+public:
+    static constexpr size_t MAX_STACK_DEPTH = 64;
+    static constexpr size_t SAMPLE_SLOTS_COUNT = 4096;
+
+    static SamplingProfiler& instance();
+
+    /**
+     * @brief Profiles the process for options duration, blocking the calling thread
+     *
+     * @param options
+     * @param output folded stacks or gzip compressed pprof profile
+     *
+     * @return Status PROFILER_BUSY when another profile is running
+     */
+    Status profile(const ProfileOptions& options, std::string& output);
+
+    /**
+     * @brief Collects samples into profile without formatting it
+     */
+    Status collect(std::chrono::milliseconds duration, uint32_t frequency, Profile& profile);
+
+    /**
+     * @brief Checks if a profile is being collected, it is busy until its samples are drained
+     */
+    bool isSampling() const;
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+private:
+    SamplingProfiler() = default;
+
+    void drain(Profile& profile, std::map<int, std::string>& threadNames);
+
+    std::mutex mutex;
+};
+
+}  // namespace ovms
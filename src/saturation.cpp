@@ -0,0 +1,69 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "saturation.hpp"
+
+#include <algorithm>
+
+#include "modelinstance.hpp"
+#include "modelmanager.hpp"
+
+namespace ovms {
+
+SaturationReport SaturationMonitor::measure(ModelManager& manager) const {
+    SaturationReport report;
+    for (const auto& instance : manager.getModelInstances()) {
+        ModelSaturation modelSaturation;
+        if (instance->getSaturation(modelSaturation)) {
+            report.models.push_back(std::move(modelSaturation));
+        }
+    }
+    report.networkRequests = networkRequests.load(std::memory_order_relaxed);
+    report.restQueuedRequests = restQueuedRequests.load(std::memory_order_relaxed);
+    report.saturation = computeSaturation(report.models, report.networkRequests);
+    return report;
+}
+
+double SaturationMonitor::computeSaturation(const std::vector<ModelSaturation>& models, size_t networkRequests) {
+    double saturation = 0.0;
+    size_t streams = 0;
+    for (const auto& model : models) {
+        saturation = std::max(saturation, model.saturation());
+        streams += model.streams;
+    }
+    // requests not reaching models yet, e.g. waiting for gRPC or REST threads, show up only in network requests
+    if (streams > 0) {
+        saturation = std::max(saturation, static_cast<double>(networkRequests) / streams);
+    }
+    return saturation;
+}
+
+bool SaturationMonitor::isSaturated() {
+    if (threshold <= 0.0) {
+        return false;
+    }
+    const int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+    int64_t last = lastMeasurement.load(std::memory_order_relaxed);
+    const int64_t interval = std::chrono::duration_cast<std::chrono::microseconds>(SATURATION_MEASUREMENT_INTERVAL).count();
+    // only one thread measures, others use the previous result
+    if (now - last >= interval && lastMeasurement.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        saturated = measure(ModelManager::getInstance()).saturation > threshold;
+    }
+    return saturated;
+}
+
+}  // namespace ovms
@@ -0,0 +1,174 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model_version_policy.hpp"
+
+namespace ovms {
+
+class ModelManager;
+
+/**
+ * @brief Load of streams of a single loaded model version
+ */
+struct ModelSaturation {
+    std::string name;
+    model_version_t version = 0;
+    /**
+     * @brief Predict requests holding the model instance, either waiting for a stream or running inference
+     */
+    uint64_t inFlightRequests = 0;
+    size_t streams = 0;
+    size_t idleStreams = 0;
+    /**
+     * @brief Requests waiting for an idle stream
+     */
+    size_t waitingRequests = 0;
+    uint64_t responseCacheHits = 0;
+    uint64_t responseCacheMisses = 0;
+
+    /**
+     * @brief In-flight requests per stream, above 1 requests are queued
+     */
+    double saturation() const {
+        return streams > 0 ? static_cast<double>(inFlightRequests) / streams : 0.0;
+    }
+};
+
+/**
+ * @brief Saturation signal of the whole server together with its components
+ */
+struct SaturationReport {
+    std::vector<ModelSaturation> models;
+    /**
+     * @brief gRPC and REST requests received and not answered yet
+     */
+    size_t networkRequests = 0;
+    /**
+     * @brief REST requests parsed and waiting for REST inference worker
+     */
+    size_t restQueuedRequests = 0;
+    /**
+     * @brief Highest saturation of models and of network requests per stream of all models
+     */
+    double saturation = 0.0;
+};
+
+/**
+ * @brief Combines per-model in-flight requests, idle streams and network queues into a single saturation signal.
+ * Above the threshold the server reports not ready and optionally sheds new predict requests, so load balancers
+ * route around it before latency goes up.
+ */
+class SaturationMonitor {
+public:
+    static SaturationMonitor& instance() {
+        static SaturationMonitor instance;
+        return instance;
+    }
+
+    /**
+     * @param threshold saturation above which server is not ready, 0 disables saturation checks
+     * @param shedRequests rejects new predict requests while saturated
+     */
+    void configure(double threshold, bool shedRequests) {
+        this->threshold = threshold;
+        this->shedRequests = shedRequests;
+        saturated = false;
+    }
+
+    double getThreshold() const {
+        return threshold;
+    }
+
+    /**
+     * @brief Collects load of all available model versions and network queues
+     */
+    SaturationReport measure(ModelManager& manager) const;
+
+    /**
+     * @brief Highest of model saturations and network requests per stream of all models
+     */
+    static double computeSaturation(const std::vector<ModelSaturation>& models, size_t networkRequests);
+
+    /**
+     * @brief Checks if saturation is above the threshold. Result is cached and measured
+     * at most once per SATURATION_MEASUREMENT_INTERVAL, so it can be called for every request.
+     */
+    bool isSaturated();
+
+    /**
+     * @brief Checks if new predict request should be rejected
+     */
+    bool shouldShedRequest() {
+        return shedRequests && isSaturated();
+    }
+
+    void increaseNetworkRequests() {
+        networkRequests.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void decreaseNetworkRequests() {
+        networkRequests.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void increaseRestQueuedRequests() {
+        restQueuedRequests.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void decreaseRestQueuedRequests() {
+        restQueuedRequests.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    SaturationMonitor() = default;
+
+    double threshold = 0.0;
+    bool shedRequests = false;
+
+    std::atomic<size_t> networkRequests{0};
+    std::atomic<size_t> restQueuedRequests{0};
+
+    std::atomic<bool> saturated{false};
+    std::atomic<int64_t> lastMeasurement{0};
+};
+
+/**
+ * @brief Interval of saturation measurements used by isSaturated
+ */
+const std::chrono::milliseconds SATURATION_MEASUREMENT_INTERVAL{10};
+
+/**
+ * @brief Counts gRPC or REST request as received and not answered yet for its lifetime
+ */
+class NetworkRequestGuard {
+public:
+    NetworkRequestGuard() {
+        SaturationMonitor::instance().increaseNetworkRequests();
+    }
+    ~NetworkRequestGuard() {
+        SaturationMonitor::instance().decreaseNetworkRequests();
+    }
+    NetworkRequestGuard(const NetworkRequestGuard&) = delete;
+    NetworkRequestGuard& operator=(const NetworkRequestGuard&) = delete;
+};
+
+}  // namespace ovms
@@ -16,8 +16,12 @@
 
 #include "schema.hpp"
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
+#include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
 #include <rapidjson/error/error.h>
 #include <rapidjson/schema.h>
@@ -50,6 +54,19 @@ const char* MODELS_CONFIG_SCHEMA = R"({
 				"additionalProperties": false
 			}
 		},
+		"custom_node_library_config": {
+			"type": "object",
+			"required": ["name", "base_path"],
+			"properties": {
+				"name": {
+					"type": "string"
+				},
+				"base_path": {
+					"type": "string"
+				}
+			},
+			"additionalProperties": false
+		},
 		"model_config": {
 			"type": "object",
 			"required": ["config"],
@@ -77,6 +94,227 @@ const char* MODELS_CONFIG_SCHEMA = R"({
 						"nireq": {
 							"type": "integer"
 						},
+						"max_nireq": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"nireq_autoscaling_wait_ms": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"dynamic_batching": {
+							"type": "object",
+							"required": ["max_batch_size"],
+							"properties": {
+								"max_batch_size": {
+									"type": "integer",
+									"minimum": 1
+								},
+								"max_queue_delay_microseconds": {
+									"type": "integer",
+									"minimum": 0
+								},
+								"latency_slo_microseconds": {
+									"type": "integer",
+									"minimum": 0
+								}
+							},
+							"additionalProperties": false
+						},
+						"input_conversion": {
+							"type": "object",
+							"additionalProperties": {
+								"type": "string",
+								"enum": ["FP32", "I64"]
+							}
+						},
+						"output_precision": {
+							"type": "object",
+							"additionalProperties": {
+								"type": "string",
+								"enum": ["FP16", "FP32", "BF16", "I8"]
+							}
+						},
+						"output_reduction": {
+							"type": "object",
+							"additionalProperties": {
+								"type": "object",
+								"required": ["type"],
+								"properties": {
+									"type": {
+										"type": "string",
+										"enum": ["argmax", "top_k"]
+									},
+									"k": {
+										"type": "integer",
+										"minimum": 1
+									},
+									"threshold": {
+										"type": "number"
+									}
+								},
+								"additionalProperties": false
+							}
+						},
+						"image_inputs": {
+							"type": "object",
+							"additionalProperties": {
+								"type": "string",
+								"enum": ["RGB", "BGR"]
+							}
+						},
+						"preprocessing": {
+							"type": "object",
+							"additionalProperties": {
+								"type": "object",
+								"properties": {
+									"resize": {
+										"type": "string",
+										"enum": ["BILINEAR", "AREA"]
+									},
+									"mean": {
+										"type": "array",
+										"items": {"type": "number"},
+										"minItems": 1
+									},
+									"scale": {
+										"type": "array",
+										"items": {"type": "number", "minimum": 0, "exclusiveMinimum": true},
+										"minItems": 1
+									},
+									"color_format": {
+										"type": "string",
+										"enum": ["RGB", "BGR"]
+									},
+									"u8_input": {
+										"type": "boolean"
+									}
+								},
+								"additionalProperties": false
+							}
+						},
+						"shape_cache_size": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"max_pending_requests": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"grpc_compression_threshold": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"response_cache_size_mb": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"single_flight": {
+							"type": "boolean"
+						},
+						"batch_split": {
+							"type": "boolean"
+						},
+						"batch_padding": {
+							"type": "boolean"
+						},
+						"scheduling_weight": {
+							"type": "integer",
+							"minimum": 1
+						},
+						"scheduling_priority": {
+							"type": "string",
+							"enum": ["low", "normal", "high"]
+						},
+						"lazy_loading": {
+							"type": "boolean"
+						},
+						"idle_unload_timeout_seconds": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"idle_hibernation": {
+							"type": "boolean"
+						},
+						"stateful": {
+							"type": "boolean"
+						},
+						"max_sequence_number": {
+							"type": "integer",
+							"minimum": 1
+						},
+						"sequence_timeout_seconds": {
+							"type": "integer",
+							"minimum": 0
+						},
+						"numa_replicas": {
+							"type": "boolean"
+						},
+						"cpus": {
+							"type": "string"
+						},
+						"replica_devices": {
+							"type": "array",
+							"items": {
+								"type": "string"
+							}
+						},
+						"replica_routing": {
+							"type": "string",
+							"enum": ["least_queued", "latency_weighted", "overflow"]
+						},
+						"replicas": {
+							"type": "integer",
+							"minimum": 1
+						},
+						"load_priority": {
+							"type": "integer"
+						},
+						"warmup": {
+							"type": "object",
+							"properties": {
+								"iterations": {
+									"type": "integer",
+									"minimum": 0
+								},
+								"data_path": {
+									"type": "string"
+								}
+							},
+							"additionalProperties": false
+						},
+						"auto_tune": {
+							"type": "object",
+							"properties": {
+								"latency_target_ms": {
+									"type": "integer",
+									"minimum": 0
+								}
+							},
+							"additionalProperties": false
+						},
+						"infer_request_pools": {
+							"type": "object",
+							"additionalProperties": {
+								"type": "object",
+								"properties": {
+									"nireq": {
+										"type": "integer",
+										"minimum": 1
+									},
+									"share": {
+										"type": "number",
+										"minimum": 0,
+										"exclusiveMinimum": true,
+										"maximum": 1,
+										"exclusiveMaximum": true
+									}
+								},
+								"additionalProperties": false,
+								"minProperties": 1,
+								"maxProperties": 1
+							}
+						},
 						"target_device": {
 							"type": "string"
 						},
@@ -133,7 +371,7 @@ const char* MODELS_CONFIG_SCHEMA = R"({
 			},
 			"additionalProperties": false
 		},
-		"node_config": {
+		"demultiplexed_node_config": {
 			"type": "object",
 			"required": ["name", "model_name", "inputs", "outputs"],
 			"properties": {
@@ -143,9 +381,81 @@ const char* MODELS_CONFIG_SCHEMA = R"({
 				"model_name": {
 					"type": "string"
 				},
+				"version": {
+					"type": "integer",
+					"minimum": 1
+				},
+				"inputs": {
+					"type": "array",
+					"items": {
+						"$ref": "#/definitions/source_node"
+					}
+				},
+				"outputs": {
+					"type": "array",
+					"items": {
+						"$ref": "#/definitions/output_alias"
+					}
+				}
+			},
+			"additionalProperties": false
+		},
+		"node_config": {
+			"type": "object",
+			"required": ["name", "type", "inputs", "outputs"],
+			"properties": {
+				"name": {
+					"type": "string"
+				},
+				"model_name": {
+					"type": "string"
+				},
+				"library_name": {
+					"type": "string"
+				},
 				"type": {
 					"type": "string",
-					"enum": ["DL model", "Demultiplexer", "Batch dispatcher"]
+					"enum": ["DL model", "Demultiplexer", "Batch dispatcher", "custom", "Gate"]
+				},
+				"condition": {
+					"type": "object",
+					"required": ["input", "value"],
+					"properties": {
+						"input": {
+							"type": "string"
+						},
+						"reduction": {
+							"type": "string",
+							"enum": ["max", "min", "sum", "size"]
+						},
+						"operator": {
+							"type": "string",
+							"enum": [">", ">=", "<", "<=", "==", "!="]
+						},
+						"value": {
+							"type": "number"
+						}
+					},
+					"additionalProperties": false
+				},
+				"params": {
+					"type": "object",
+					"additionalProperties": {
+						"type": "string"
+					}
+				},
+				"cacheable": {
+					"type": "boolean"
+				},
+				"cache_size": {
+					"type": "integer",
+					"minimum": 1
+				},
+				"demultiplexed_nodes": {
+					"type": "array",
+					"items": {
+						"$ref": "#/definitions/demultiplexed_node_config"
+					}
 				},
 				"version": {
 					"type": "integer",
@@ -173,6 +483,10 @@ const char* MODELS_CONFIG_SCHEMA = R"({
 				"name": {
 					"type": "string"
 				},
+				"max_concurrency": {
+					"type": ["integer", "string"],
+					"minimum": 1
+				},
 				"nodes": {
 					"type": "array",
 					"items": {
@@ -204,6 +518,12 @@ const char* MODELS_CONFIG_SCHEMA = R"({
 				"$ref": "#/definitions/custom_loader_config"
 			}
 		},
+		"custom_node_library_config_list": {
+			"type": "array",
+			"items": {
+				"$ref": "#/definitions/custom_node_library_config"
+			}
+		},
 		"model_config_list": {
 			"type": "array",
 			"items": {
@@ -252,15 +572,38 @@ const char* MODELS_MAPPING_OUTPUTS_SCHEMA = R"({
 	"additionalProperties": false
     })";
 
-StatusCode validateJsonAgainstSchema(rapidjson::Document& json, const char* schema) {
-    rapidjson::Document schemaJson;
-    rapidjson::ParseResult parsingSucceeded = schemaJson.Parse(schema);
+namespace {
+struct CompiledSchema {
+    rapidjson::Document json;
+    std::unique_ptr<rapidjson::SchemaDocument> document;
+};
+}  // namespace
+
+const rapidjson::SchemaDocument* getCompiledSchema(const char* schema) {
+    // schemas are string constants, so they are compiled once and looked up by address
+    static std::mutex compiledSchemasMtx;
+    static std::unordered_map<const char*, std::unique_ptr<CompiledSchema>> compiledSchemas;
+    std::lock_guard lock(compiledSchemasMtx);
+    auto it = compiledSchemas.find(schema);
+    if (it != compiledSchemas.end()) {
+        return it->second->document.get();
+    }
+    auto compiled = std::make_unique<CompiledSchema>();
+    rapidjson::ParseResult parsingSucceeded = compiled->json.Parse(schema);
     if (!parsingSucceeded) {
         SPDLOG_ERROR("JSON schema parse error: {}, at: {}", rapidjson::GetParseError_En(parsingSucceeded.Code()), parsingSucceeded.Offset());
+        return nullptr;
+    }
+    compiled->document = std::make_unique<rapidjson::SchemaDocument>(compiled->json);
+    return compiledSchemas.emplace(schema, std::move(compiled)).first->second->document.get();
+}
+
+StatusCode validateJsonAgainstSchema(rapidjson::Document& json, const char* schema) {
+    const auto parsedSchema = getCompiledSchema(schema);
+    if (parsedSchema == nullptr) {
         return StatusCode::JSON_INVALID;
     }
-    rapidjson::SchemaDocument parsedSchema(schemaJson);
-    rapidjson::SchemaValidator validator(parsedSchema);
+    rapidjson::SchemaValidator validator(*parsedSchema);
     if (!json.Accept(validator)) {
         rapidjson::StringBuffer sb;
         validator.GetInvalidSchemaPointer().StringifyUriFragment(sb);
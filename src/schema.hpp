@@ -24,5 +24,12 @@ extern const char* MODELS_CONFIG_SCHEMA;
 extern const char* MODELS_MAPPING_INPUTS_SCHEMA;
 extern const char* MODELS_MAPPING_OUTPUTS_SCHEMA;
 
+/**
+ * @brief Gets schema compiled on first use, schema has to be a string constant since it is cached by address
+ *
+ * @return compiled schema or nullptr if schema is not valid JSON
+ */
+const rapidjson::SchemaDocument* getCompiledSchema(const char* schema);
+
 StatusCode validateJsonAgainstSchema(rapidjson::Document& json, const char* schema);
 }  // namespace ovms
@@ -0,0 +1,224 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "sequencemanager.hpp"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "logging.hpp"
+#include "ov_utils.hpp"
+
+namespace ovms {
+
+namespace {
+template <typename T, typename Values>
+bool readSingleValue(const tensorflow::TensorProto& proto, const Values& values, uint64_t& value) {
+    T read;
+    if (!proto.tensor_content().empty()) {
+        if (proto.tensor_content().size() != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&read, proto.tensor_content().data(), sizeof(T));
+    } else {
+        if (values.size() != 1) {
+            return false;
+        }
+        read = static_cast<T>(values.Get(0));
+    }
+    if constexpr (std::is_signed<T>::value) {
+        if (read < 0) {
+            return false;
+        }
+    }
+    value = static_cast<uint64_t>(read);
+    return true;
+}
+
+// REST requests carry integers as int32, gRPC clients are expected to use uint64 and uint32
+bool readSingleInteger(const tensorflow::TensorProto& proto, uint64_t& value) {
+    switch (proto.dtype()) {
+    case tensorflow::DataType::DT_UINT64:
+        return readSingleValue<uint64_t>(proto, proto.uint64_val(), value);
+    case tensorflow::DataType::DT_INT64:
+        return readSingleValue<int64_t>(proto, proto.int64_val(), value);
+    case tensorflow::DataType::DT_UINT32:
+        return readSingleValue<uint32_t>(proto, proto.uint32_val(), value);
+    case tensorflow::DataType::DT_INT32:
+        return readSingleValue<int32_t>(proto, proto.int_val(), value);
+    default:
+        return false;
+    }
+}
+}  // namespace
+
+Status extractSequenceProcessingSpec(const tensorflow::serving::PredictRequest& request, SequenceProcessingSpec& spec) {
+    spec = SequenceProcessingSpec();
+    auto it = request.inputs().find(SEQUENCE_ID_INPUT);
+    if (it != request.inputs().end() && !readSingleInteger(it->second, spec.sequenceId)) {
+        return Status::withDetails(StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT, "Input: ", SEQUENCE_ID_INPUT);
+    }
+    it = request.inputs().find(SEQUENCE_CONTROL_INPUT);
+    if (it != request.inputs().end()) {
+        uint64_t control = 0;
+        if (!readSingleInteger(it->second, control)) {
+            return Status::withDetails(StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT, "Input: ", SEQUENCE_CONTROL_INPUT);
+        }
+        if (control > SEQUENCE_END) {
+            return Status::withDetails(StatusCode::INVALID_SEQUENCE_CONTROL_INPUT, "Expected: 0, 1 or 2; Actual: ", control);
+        }
+        spec.control = static_cast<uint32_t>(control);
+    }
+    return StatusCode::OK;
+}
+
+size_t countSequenceSpecialInputs(const tensorflow::serving::PredictRequest& request) {
+    return request.inputs().count(SEQUENCE_ID_INPUT) + request.inputs().count(SEQUENCE_CONTROL_INPUT);
+}
+
+void addSequenceIdOutput(uint64_t sequenceId, tensorflow::serving::PredictResponse& response) {
+    auto& output = (*response.mutable_outputs())[SEQUENCE_ID_INPUT];
+    output.Clear();
+    output.set_dtype(tensorflow::DataType::DT_UINT64);
+    output.mutable_tensor_shape()->add_dim()->set_size(1);
+    output.mutable_tensor_content()->assign(reinterpret_cast<const char*>(&sequenceId), sizeof(sequenceId));
+}
+
+Status SequenceManager::getSequence(const SequenceProcessingSpec& spec, std::shared_ptr<Sequence>& sequence) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mtx);
+    if (spec.control == SEQUENCE_START) {
+        uint64_t sequenceId = spec.sequenceId;
+        if (sequenceId != 0 && sequences.count(sequenceId)) {
+            return Status::withDetails(StatusCode::SEQUENCE_ALREADY_EXISTS, "Sequence id: ", sequenceId);
+        }
+        if (sequences.size() >= maxSequenceNumber) {
+            removeIdleSequencesLocked(now);
+            if (sequences.size() >= maxSequenceNumber) {
+                return Status::withDetails(StatusCode::MAX_SEQUENCE_NUMBER_REACHED, "Max sequence number: ", maxSequenceNumber);
+            }
+        }
+        while (sequenceId == 0 || sequences.count(sequenceId)) {
+            sequenceId = ++lastGeneratedId;
+        }
+        sequence = std::make_shared<Sequence>(sequenceId);
+        sequences.emplace(sequenceId, sequence);
+        OVMS_HOT_PATH_DEBUG("Started sequence: {} of model: {}", sequenceId, modelName);
+        return StatusCode::OK;
+    }
+    if (spec.sequenceId == 0) {
+        return StatusCode::SEQUENCE_ID_NOT_PROVIDED;
+    }
+    auto it = sequences.find(spec.sequenceId);
+    // timed out sequence fails even if it was not removed yet
+    if (it == sequences.end() || (timeout.count() > 0 && it->second->getLastActivity() + timeout < now)) {
+        return Status::withDetails(StatusCode::SEQUENCE_MISSING, "Sequence id: ", spec.sequenceId);
+    }
+    sequence = it->second;
+    sequence->touch();
+    return StatusCode::OK;
+}
+
+void SequenceManager::removeSequence(uint64_t sequenceId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = sequences.find(sequenceId);
+    if (it == sequences.end()) {
+        return;
+    }
+    it->second->terminate();
+    sequences.erase(it);
+    OVMS_HOT_PATH_DEBUG("Ended sequence: {} of model: {}", sequenceId, modelName);
+}
+
+size_t SequenceManager::removeIdleSequences(std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return removeIdleSequencesLocked(now);
+}
+
+size_t SequenceManager::removeIdleSequencesLocked(std::chrono::steady_clock::time_point now) {
+    if (timeout.count() == 0) {
+        return 0;
+    }
+    size_t removed = 0;
+    for (auto it = sequences.begin(); it != sequences.end();) {
+        if (it->second->getLastActivity() + timeout < now) {
+            it->second->terminate();
+            it = sequences.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    if (removed > 0) {
+        SPDLOG_DEBUG("Removed {} idle sequences of model: {}", removed, modelName);
+    }
+    return removed;
+}
+
+void SequenceManager::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& [sequenceId, sequence] : sequences) {
+        sequence->terminate();
+    }
+    sequences.clear();
+}
+
+size_t SequenceManager::getSequencesCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return sequences.size();
+}
+
+Status restoreMemoryState(InferenceEngine::InferRequest& inferRequest, Sequence& sequence) {
+    try {
+        for (auto&& state : inferRequest.QueryState()) {
+            auto it = sequence.getMemoryState().find(state.GetName());
+            if (it == sequence.getMemoryState().end()) {
+                state.Reset();
+                continue;
+            }
+            // plugin may keep the blob, so the sequence never shares its own with the infer request
+            InferenceEngine::Blob::Ptr copy;
+            auto status = blobClone(copy, it->second);
+            if (!status.ok()) {
+                return status;
+            }
+            state.SetState(copy);
+        }
+    } catch (const InferenceEngine::details::InferenceEngineException& e) {
+        SPDLOG_ERROR("Setting memory state of sequence: {} failed: {}", sequence.getId(), e.what());
+        return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+    }
+    return StatusCode::OK;
+}
+
+Status storeMemoryState(InferenceEngine::InferRequest& inferRequest, Sequence& sequence) {
+    try {
+        for (auto&& state : inferRequest.QueryState()) {
+            InferenceEngine::Blob::Ptr copy;
+            auto status = blobClone(copy, std::const_pointer_cast<InferenceEngine::Blob>(state.GetState()));
+            if (!status.ok()) {
+                return status;
+            }
+            sequence.getMemoryState()[state.GetName()] = std::move(copy);
+        }
+    } catch (const InferenceEngine::details::InferenceEngineException& e) {
+        SPDLOG_ERROR("Reading memory state of sequence: {} failed: {}", sequence.getId(), e.what());
+        return StatusCode::OV_INTERNAL_INFERENCE_ERROR;
+    }
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
@@ -0,0 +1,198 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <inference_engine.hpp>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Request input and response output identifying sequence of stateful model
+ */
+const std::string SEQUENCE_ID_INPUT = "sequence_id";
+
+/**
+ * @brief Request input starting or ending sequence of stateful model
+ */
+const std::string SEQUENCE_CONTROL_INPUT = "sequence_control_input";
+
+enum SequenceControl : uint32_t {
+    NO_CONTROL_INPUT = 0,
+    SEQUENCE_START = 1,
+    SEQUENCE_END = 2
+};
+
+struct SequenceProcessingSpec {
+    uint32_t control = NO_CONTROL_INPUT;
+    // 0 when not provided, sequence started without id gets one generated by the server
+    uint64_t sequenceId = 0;
+};
+
+/**
+ * @brief Reads sequence id and sequence control input of request to stateful model
+ *
+ * Both are optional single integers of any integral tensor precision, in typed values or in tensor_content.
+ */
+Status extractSequenceProcessingSpec(const tensorflow::serving::PredictRequest& request, SequenceProcessingSpec& spec);
+
+/**
+ * @brief Counts sequence id and control inputs of the request, those are not inputs of the network
+ */
+size_t countSequenceSpecialInputs(const tensorflow::serving::PredictRequest& request);
+
+/**
+ * @brief Adds sequence id output as a single DT_UINT64 value in tensor_content, like other outputs,
+ * so clients continuing a sequence started without id learn it
+ */
+void addSequenceIdOutput(uint64_t sequenceId, tensorflow::serving::PredictResponse& response);
+
+using memory_state_t = std::map<std::string, InferenceEngine::Blob::Ptr>;
+
+/**
+ * @brief Memory states of the network kept between requests of one sequence
+ *
+ * States are copied into the infer request before inference and out of it afterwards, so any stream can serve
+ * any sequence. Requests of the same sequence are serialized with its mutex.
+ */
+class Sequence {
+public:
+    explicit Sequence(uint64_t id) :
+        id(id) {
+        touch();
+    }
+
+    uint64_t getId() const {
+        return id;
+    }
+
+    /**
+     * @brief Has to be held while the sequence is inferred, memory state is accessed only under it.
+     * Requests waiting for the previous request of the sequence stop waiting at their deadline.
+     */
+    std::timed_mutex& getMutex() {
+        return mtx;
+    }
+
+    /**
+     * @brief Empty until the first inference of the sequence, infer request states are reset then
+     */
+    memory_state_t& getMemoryState() {
+        return memoryState;
+    }
+
+    /**
+     * @brief Set once the sequence is ended or dropped, requests which waited for its mutex fail then
+     */
+    bool isTerminated() const {
+        return terminated.load(std::memory_order_acquire);
+    }
+
+    void terminate() {
+        terminated.store(true, std::memory_order_release);
+    }
+
+    void touch() {
+        lastActivity.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    std::chrono::steady_clock::time_point getLastActivity() const {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(lastActivity.load(std::memory_order_relaxed)));
+    }
+
+private:
+    const uint64_t id;
+    std::timed_mutex mtx;
+    memory_state_t memoryState;
+    std::atomic<bool> terminated{false};
+    std::atomic<std::chrono::steady_clock::rep> lastActivity{0};
+};
+
+/**
+ * @brief Sequences of a stateful model version, with limit of concurrent sequences and idle sequence timeout
+ */
+class SequenceManager {
+public:
+    /**
+     * @param maxSequenceNumber sequences started and not ended at once
+     * @param timeout sequence is dropped when it gets no requests for that long, 0 keeps idle sequences
+     */
+    SequenceManager(const std::string& modelName, uint32_t maxSequenceNumber, std::chrono::seconds timeout) :
+        modelName(modelName),
+        maxSequenceNumber(maxSequenceNumber),
+        timeout(timeout) {}
+
+    /**
+     * @brief Starts sequence or finds the one continued or ended by the request
+     *
+     * Idle sequences are dropped before the limit of sequences is checked.
+     */
+    Status getSequence(const SequenceProcessingSpec& spec, std::shared_ptr<Sequence>& sequence);
+
+    void removeSequence(uint64_t sequenceId);
+
+    /**
+     * @brief Drops sequences which got no requests within timeout
+     *
+     * @return number of dropped sequences
+     */
+    size_t removeIdleSequences(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    /**
+     * @brief Drops all sequences, memory states do not match network loaded again
+     */
+    void clear();
+
+    size_t getSequencesCount() const;
+
+private:
+    size_t removeIdleSequencesLocked(std::chrono::steady_clock::time_point now);
+
+    const std::string modelName;
+    const uint32_t maxSequenceNumber;
+    const std::chrono::seconds timeout;
+
+    mutable std::mutex mtx;
+    std::unordered_map<uint64_t, std::shared_ptr<Sequence>> sequences;
+    uint64_t lastGeneratedId = 0;
+};
+
+/**
+ * @brief Sets memory states of the infer request to copies of sequence states, or resets them for a new sequence
+ */
+Status restoreMemoryState(InferenceEngine::InferRequest& inferRequest, Sequence& sequence);
+
+/**
+ * @brief Copies memory states of the infer request into the sequence after its inference
+ */
+Status storeMemoryState(InferenceEngine::InferRequest& inferRequest, Sequence& sequence);
+
+}  // namespace ovms
@@ -15,16 +15,38 @@
 //*****************************************************************************
 #include "serialization.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include "narrowing.hpp"
+#include "outputreduction.hpp"
+
 namespace ovms {
 
-Status serializeBlobToTensorProto(
+static bool isWidenedToFp32(const std::shared_ptr<TensorInfo>& networkOutput) {
+    return networkOutput->getPrecision() == InferenceEngine::Precision::FP16 && !networkOutput->isHalfPrecisionResponse();
+}
+
+static Status setTensorProtoDtype(
     tensorflow::TensorProto& responseOutput,
-    const std::shared_ptr<TensorInfo>& networkOutput,
-    InferenceEngine::Blob::Ptr blob) {
-    responseOutput.Clear();
+    const std::shared_ptr<TensorInfo>& networkOutput) {
     switch (networkOutput->getPrecision()) {
     case InferenceEngine::Precision::FP32:
-        responseOutput.set_dtype(tensorflow::DataTypeToEnum<float>::value);
+        switch (networkOutput->getOutputEncoding()) {
+        case OutputEncoding::FP16:
+            responseOutput.set_dtype(tensorflow::DataType::DT_HALF);
+            break;
+        case OutputEncoding::BF16:
+            responseOutput.set_dtype(tensorflow::DataType::DT_BFLOAT16);
+            break;
+        case OutputEncoding::I8:
+            responseOutput.set_dtype(tensorflow::DataType::DT_INT8);
+            break;
+        default:
+            responseOutput.set_dtype(tensorflow::DataTypeToEnum<float>::value);
+        }
         break;
     case InferenceEngine::Precision::I32:
         responseOutput.set_dtype(tensorflow::DataTypeToEnum<int>::value);
@@ -44,16 +66,18 @@ Status serializeBlobToTensorProto(
         responseOutput.set_dtype(tensorflow::DataTypeToEnum<uint32_t>::value);
         break;
     case InferenceEngine::Precision::FP16:
-        responseOutput.set_dtype(tensorflow::DataTypeToEnum<float>::value);
+        responseOutput.set_dtype(isWidenedToFp32(networkOutput) ? tensorflow::DataType::DT_FLOAT : tensorflow::DataType::DT_HALF);
         break;
 
     case InferenceEngine::Precision::I64:
         responseOutput.set_dtype(tensorflow::DataTypeToEnum<int32_t>::value);
         break;
+    case InferenceEngine::Precision::BOOL:
+        responseOutput.set_dtype(tensorflow::DataTypeToEnum<bool>::value);
+        break;
 
     case InferenceEngine::Precision::Q78:
     case InferenceEngine::Precision::BIN:
-    case InferenceEngine::Precision::BOOL:
     case InferenceEngine::Precision::MIXED:
     case InferenceEngine::Precision::CUSTOM:
     default: {
@@ -62,21 +86,340 @@ Status serializeBlobToTensorProto(
         return status;
     }
     }
+    return StatusCode::OK;
+}
+
+static bool isEncoded(const std::shared_ptr<TensorInfo>& networkOutput) {
+    return networkOutput->getPrecision() == InferenceEngine::Precision::FP32 && networkOutput->getOutputEncoding() != OutputEncoding::NONE;
+}
+
+/**
+ * @brief Maps [lowest, highest] range extended with zero onto [-128, 127]. Zero is represented exactly, infinite values saturate.
+ */
+static void computeI8Quantization(float lowest, float highest, float& scale, int32_t& zeroPoint) {
+    lowest = std::min(lowest, 0.0f);
+    highest = std::max(highest, 0.0f);
+    scale = (highest - lowest) / 255.0f;
+    if (!std::isfinite(scale) || scale == 0.0f) {
+        scale = 1.0f;
+    }
+    float offset = std::nearbyint(-128.0f - lowest / scale);
+    zeroPoint = static_cast<int32_t>(std::min(std::max(offset, -128.0f), 127.0f));
+}
+
+static void setEncodedTensorProtoContent(
+    tensorflow::TensorProto& responseOutput,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    const float* data,
+    size_t count,
+    OutputQuantization* quantization) {
+    auto& content = *responseOutput.mutable_tensor_content();
+    switch (networkOutput->getOutputEncoding()) {
+    case OutputEncoding::FP16:
+        content.resize(count * sizeof(uint16_t));
+        narrowFp32ToFp16(data, reinterpret_cast<uint16_t*>(&content[0]), count);
+        return;
+    case OutputEncoding::BF16:
+        content.resize(count * sizeof(uint16_t));
+        narrowFp32ToBf16(data, reinterpret_cast<uint16_t*>(&content[0]), count);
+        return;
+    default:
+        break;
+    }
+    // I8 values are quantized separately for each entry of 0th dimension, so batches split by the server do not depend on each other
+    content.resize(count);
+    const size_t rows = responseOutput.tensor_shape().dim_size() > 0 ? responseOutput.tensor_shape().dim(0).size() : 1;
+    const size_t rowSize = rows > 0 ? count / rows : 0;
+    if (quantization) {
+        quantization->scales.resize(rows);
+        quantization->zeroPoints.resize(rows);
+    }
+    for (size_t row = 0; row < rows; ++row) {
+        const float* rowData = data + row * rowSize;
+        float lowest, highest, scale;
+        int32_t zeroPoint;
+        minMaxFp32(rowData, rowSize, lowest, highest);
+        computeI8Quantization(lowest, highest, scale, zeroPoint);
+        quantizeFp32ToI8(rowData, reinterpret_cast<int8_t*>(&content[row * rowSize]), rowSize, scale, zeroPoint);
+        if (quantization) {
+            quantization->scales[row] = scale;
+            quantization->zeroPoints[row] = zeroPoint;
+        }
+    }
+}
+
+static void setTensorProtoContent(
+    tensorflow::TensorProto& responseOutput,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    const char* data,
+    size_t byteSize,
+    OutputQuantization* quantization) {
+    if (isEncoded(networkOutput)) {
+        setEncodedTensorProtoContent(responseOutput, networkOutput, reinterpret_cast<const float*>(data), byteSize / sizeof(float), quantization);
+        return;
+    }
+    if (isWidenedToFp32(networkOutput)) {
+        const size_t count = byteSize / sizeof(uint16_t);
+        responseOutput.mutable_tensor_content()->resize(count * sizeof(float));
+        widenFp16ToFp32(reinterpret_cast<const uint16_t*>(data), reinterpret_cast<float*>(&(*responseOutput.mutable_tensor_content())[0]), count);
+        return;
+    }
+    responseOutput.mutable_tensor_content()->assign(data, byteSize);
+}
+
+Status serializeBlobToTensorProto(
+    tensorflow::TensorProto& responseOutput,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    InferenceEngine::Blob::Ptr blob,
+    OutputQuantization* quantization) {
+    responseOutput.Clear();
+    auto status = setTensorProtoDtype(responseOutput, networkOutput);
+    if (!status.ok()) {
+        return status;
+    }
     responseOutput.mutable_tensor_shape()->Clear();
     for (auto dim : networkOutput->getShape()) {
         responseOutput.mutable_tensor_shape()->add_dim()->set_size(dim);
     }
-    responseOutput.mutable_tensor_content()->assign((char*)blob->buffer(), blob->byteSize());
+    setTensorProtoContent(responseOutput, networkOutput, (char*)blob->buffer(), blob->byteSize(), quantization);
+    return StatusCode::OK;
+}
+
+Status serializeBlobBatchToTensorProto(
+    tensorflow::TensorProto& responseOutput,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    InferenceEngine::Blob::Ptr blob,
+    size_t batchOffset,
+    size_t batchSize,
+    OutputQuantization* quantization) {
+    responseOutput.Clear();
+    const auto& shape = networkOutput->getShape();
+    if (shape.size() == 0 || shape[0] == 0 || batchOffset + batchSize > shape[0]) {
+        Status status = StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+        SPDLOG_ERROR("{}: cannot serialize batch range [{}, {}) of output with shape {}",
+            status.string(), batchOffset, batchOffset + batchSize, TensorInfo::shapeToString(shape));
+        return status;
+    }
+    auto status = setTensorProtoDtype(responseOutput, networkOutput);
+    if (!status.ok()) {
+        return status;
+    }
+    responseOutput.mutable_tensor_shape()->Clear();
+    responseOutput.mutable_tensor_shape()->add_dim()->set_size(batchSize);
+    for (size_t i = 1; i < shape.size(); i++) {
+        responseOutput.mutable_tensor_shape()->add_dim()->set_size(shape[i]);
+    }
+    const size_t batchByteSize = blob->byteSize() / shape[0];
+    setTensorProtoContent(responseOutput, networkOutput, (char*)blob->buffer() + batchOffset * batchByteSize, batchSize * batchByteSize, quantization);
+    return StatusCode::OK;
+}
+
+Status serializeBatchToTensorProto(
+    tensorflow::TensorProto& responseOutput,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    const char* data,
+    size_t batchSize,
+    OutputQuantization* quantization) {
+    responseOutput.Clear();
+    const auto& shape = networkOutput->getShape();
+    if (shape.size() == 0) {
+        Status status = StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+        SPDLOG_ERROR("{}: cannot serialize batch of output without dimensions", status.string());
+        return status;
+    }
+    auto status = setTensorProtoDtype(responseOutput, networkOutput);
+    if (!status.ok()) {
+        return status;
+    }
+    responseOutput.mutable_tensor_shape()->Clear();
+    responseOutput.mutable_tensor_shape()->add_dim()->set_size(batchSize);
+    size_t byteSize = batchSize * networkOutput->getPrecision().size();
+    for (size_t i = 1; i < shape.size(); i++) {
+        responseOutput.mutable_tensor_shape()->add_dim()->set_size(shape[i]);
+        byteSize *= shape[i];
+    }
+    setTensorProtoContent(responseOutput, networkOutput, data, byteSize, quantization);
+    return StatusCode::OK;
+}
+
+void serializeOutputQuantization(
+    tensorflow::serving::PredictResponse& response,
+    const std::string& outputName,
+    const OutputQuantization& quantization) {
+    auto& scales = (*response.mutable_outputs())[outputName + "_scale"];
+    scales.Clear();
+    scales.set_dtype(tensorflow::DataType::DT_FLOAT);
+    scales.mutable_tensor_shape()->add_dim()->set_size(quantization.scales.size());
+    scales.mutable_tensor_content()->assign(reinterpret_cast<const char*>(quantization.scales.data()), quantization.scales.size() * sizeof(float));
+    auto& zeroPoints = (*response.mutable_outputs())[outputName + "_zero_point"];
+    zeroPoints.Clear();
+    zeroPoints.set_dtype(tensorflow::DataType::DT_INT32);
+    zeroPoints.mutable_tensor_shape()->add_dim()->set_size(quantization.zeroPoints.size());
+    zeroPoints.mutable_tensor_content()->assign(reinterpret_cast<const char*>(quantization.zeroPoints.data()), quantization.zeroPoints.size() * sizeof(int32_t));
+}
+
+// Below that size setting blobs costs more than copying the output
+const size_t MIN_OUTPUT_BYTE_SIZE_SERIALIZED_IN_PLACE = 256 * 1024;
+
+template <typename T>
+static InferenceEngine::Blob::Ptr makeBlobOverMemory(const std::shared_ptr<TensorInfo>& networkOutput, char* data, size_t byteSize) {
+    return InferenceEngine::make_shared_blob<T>(networkOutput->getTensorDesc(), reinterpret_cast<T*>(data), byteSize / sizeof(T));
+}
+
+static InferenceEngine::Blob::Ptr makeBlobOverMemory(const std::shared_ptr<TensorInfo>& networkOutput, char* data, size_t byteSize) {
+    switch (networkOutput->getPrecision()) {
+    case InferenceEngine::Precision::FP32:
+        return makeBlobOverMemory<float>(networkOutput, data, byteSize);
+    case InferenceEngine::Precision::I32:
+        return makeBlobOverMemory<int32_t>(networkOutput, data, byteSize);
+    case InferenceEngine::Precision::I16:
+        return makeBlobOverMemory<int16_t>(networkOutput, data, byteSize);
+    case InferenceEngine::Precision::U8:
+    case InferenceEngine::Precision::BOOL:
+        return makeBlobOverMemory<uint8_t>(networkOutput, data, byteSize);
+    case InferenceEngine::Precision::I8:
+        return makeBlobOverMemory<int8_t>(networkOutput, data, byteSize);
+    case InferenceEngine::Precision::U16:
+    case InferenceEngine::Precision::FP16:
+        return makeBlobOverMemory<uint16_t>(networkOutput, data, byteSize);
+    case InferenceEngine::Precision::I64:
+        return makeBlobOverMemory<int64_t>(networkOutput, data, byteSize);
+    default:
+        return nullptr;
+    }
+}
+
+Status serializeReducedOutput(
+    tensorflow::serving::PredictResponse& response,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    const char* data,
+    const shape_t& shape) {
+    const auto& reduction = networkOutput->getOutputReduction();
+    const bool halfPrecision = networkOutput->getPrecision() == InferenceEngine::Precision::FP16;
+    if (shape.empty() || (!halfPrecision && networkOutput->getPrecision() != InferenceEngine::Precision::FP32)) {
+        return StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION;
+    }
+    const size_t classes = shape.back();
+    size_t rows = 1;
+    for (size_t i = 0; i + 1 < shape.size(); ++i) {
+        rows *= shape[i];
+    }
+    std::vector<float> widened(halfPrecision ? classes : 0);
+    auto getRow = [&](size_t row) -> const float* {
+        if (!halfPrecision) {
+            return reinterpret_cast<const float*>(data) + row * classes;
+        }
+        widenFp16ToFp32(reinterpret_cast<const uint16_t*>(data) + row * classes, widened.data(), classes);
+        return widened.data();
+    };
+    const auto& name = networkOutput->getMappedName();
+    auto& outputs = *response.mutable_outputs();
+    if (reduction.type == OutputReductionType::ARGMAX) {
+        auto& indicesProto = outputs[name];
+        indicesProto.Clear();
+        indicesProto.set_dtype(tensorflow::DataType::DT_INT64);
+        for (size_t i = 0; i + 1 < shape.size(); ++i) {
+            indicesProto.mutable_tensor_shape()->add_dim()->set_size(shape[i]);
+        }
+        indicesProto.mutable_tensor_content()->resize(rows * sizeof(int64_t));
+        auto indices = reinterpret_cast<int64_t*>(&(*indicesProto.mutable_tensor_content())[0]);
+        for (size_t row = 0; row < rows; ++row) {
+            indices[row] = argmaxFp32(getRow(row), classes, reduction.threshold);
+        }
+        return StatusCode::OK;
+    }
+    const size_t k = std::min(reduction.k, classes);
+    // both entries are inserted before references are taken
+    outputs[name];
+    outputs[name + "_indices"];
+    auto& valuesProto = outputs.at(name);
+    auto& indicesProto = outputs.at(name + "_indices");
+    valuesProto.Clear();
+    valuesProto.set_dtype(tensorflow::DataType::DT_FLOAT);
+    for (size_t i = 0; i + 1 < shape.size(); ++i) {
+        valuesProto.mutable_tensor_shape()->add_dim()->set_size(shape[i]);
+    }
+    valuesProto.mutable_tensor_shape()->add_dim()->set_size(k);
+    indicesProto.Clear();
+    indicesProto.set_dtype(tensorflow::DataType::DT_INT64);
+    *indicesProto.mutable_tensor_shape() = valuesProto.tensor_shape();
+    valuesProto.mutable_tensor_content()->resize(rows * k * sizeof(float));
+    indicesProto.mutable_tensor_content()->resize(rows * k * sizeof(int64_t));
+    auto values = reinterpret_cast<float*>(&(*valuesProto.mutable_tensor_content())[0]);
+    auto indices = reinterpret_cast<int64_t*>(&(*indicesProto.mutable_tensor_content())[0]);
+    for (size_t row = 0; row < rows; ++row) {
+        topKFp32(getRow(row), classes, k, reduction.threshold, values + row * k, indices + row * k);
+    }
     return StatusCode::OK;
 }
 
+Status ResponseOutputBlobsGuard::prepare(const tensor_map_t& outputMap, tensorflow::serving::PredictResponse* response, const output_filter_t* outputFilter) {
+    for (const auto& [mappedName, networkOutput] : outputMap) {
+        if (!isOutputRequested(outputFilter, mappedName)) {
+            continue;
+        }
+        size_t byteSize = networkOutput->getPrecision().size();
+        for (auto dim : networkOutput->getShape()) {
+            byteSize *= dim;
+        }
+        // widened FP16 and encoded FP32 values do not fit the blob layout, reduced outputs are read from the blob
+        if (byteSize < MIN_OUTPUT_BYTE_SIZE_SERIALIZED_IN_PLACE || isWidenedToFp32(networkOutput) || isEncoded(networkOutput) || networkOutput->isReduced()) {
+            continue;
+        }
+        auto& tensorProto = (*response->mutable_outputs())[mappedName];
+        tensorProto.Clear();
+        auto status = setTensorProtoDtype(tensorProto, networkOutput);
+        if (!status.ok()) {
+            return status;
+        }
+        for (auto dim : networkOutput->getShape()) {
+            tensorProto.mutable_tensor_shape()->add_dim()->set_size(dim);
+        }
+        tensorProto.mutable_tensor_content()->resize(byteSize);
+        auto blob = makeBlobOverMemory(networkOutput, &(*tensorProto.mutable_tensor_content())[0], byteSize);
+        if (blob == nullptr) {
+            return StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION;
+        }
+        try {
+            auto originalBlob = inferRequest.GetBlob(networkOutput->getName());
+            inferRequest.SetBlob(networkOutput->getName(), blob);
+            originalBlobs.emplace(networkOutput->getName(), std::move(originalBlob));
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            Status status = StatusCode::OV_INTERNAL_SERIALIZATION_ERROR;
+            SPDLOG_ERROR("{}: {}", status.string(), e.what());
+            return status;
+        }
+    }
+    return StatusCode::OK;
+}
+
+void ResponseOutputBlobsGuard::restore() {
+    for (const auto& [name, blob] : originalBlobs) {
+        try {
+            inferRequest.SetBlob(name, blob);
+        } catch (const InferenceEngine::details::InferenceEngineException& e) {
+            SPDLOG_ERROR("Failed to restore output blob: {}; {}", name, e.what());
+        }
+    }
+    originalBlobs.clear();
+}
+
 Status serializePredictResponse(
     InferenceEngine::InferRequest& inferRequest,
     const tensor_map_t& outputMap,
-    tensorflow::serving::PredictResponse* response) {
+    tensorflow::serving::PredictResponse* response,
+    const ResponseOutputBlobsGuard* responseOutputBlobs,
+    const output_filter_t* outputFilter) {
 
     for (const auto& pair : outputMap) {
         auto networkOutput = pair.second;
+        if (!isOutputRequested(outputFilter, networkOutput->getMappedName())) {
+            continue;
+        }
+        if (responseOutputBlobs && responseOutputBlobs->isInPlace(networkOutput->getName())) {
+            // inference already wrote results into response
+            continue;
+        }
         InferenceEngine::Blob::Ptr blob;
         try {
             blob = inferRequest.GetBlob(networkOutput->getName());
@@ -85,13 +428,49 @@ Status serializePredictResponse(
             SPDLOG_ERROR("{}: {}", status.string(), e.what());
             return status;
         }
+        if (networkOutput->isReduced()) {
+            auto status = serializeReducedOutput(*response, networkOutput, blob->cbuffer().as<const char*>(), networkOutput->getShape());
+            if (!status.ok()) {
+                return status;
+            }
+            continue;
+        }
         auto& tensorProto = (*response->mutable_outputs())[networkOutput->getMappedName()];
-        auto status = serializeBlobToTensorProto(tensorProto, networkOutput, blob);
+        OutputQuantization quantization;
+        auto status = serializeBlobToTensorProto(tensorProto, networkOutput, blob, &quantization);
         if (!status.ok()) {
             return status;
         }
+        if (networkOutput->isQuantized()) {
+            serializeOutputQuantization(*response, networkOutput->getMappedName(), quantization);
+        }
     }
 
+    return writeOutputsToSharedMemory(response, outputFilter);
+}
+
+Status writeOutputsToSharedMemory(tensorflow::serving::PredictResponse* response, const output_filter_t* outputFilter) {
+    if (outputFilter == nullptr) {
+        return StatusCode::OK;
+    }
+    for (const auto& entry : *outputFilter) {
+        std::optional<SharedMemoryReference> destination;
+        auto status = getOutputFilterEntryDestination(entry, destination);
+        if (!status.ok()) {
+            return status;
+        }
+        if (!destination) {
+            continue;
+        }
+        auto it = response->mutable_outputs()->find(std::string(getOutputFilterEntryName(entry)));
+        if (it == response->mutable_outputs()->end()) {
+            continue;
+        }
+        status = moveTensorContentToSharedMemory(it->second, destination.value());
+        if (!status.ok()) {
+            return status;
+        }
+    }
     return StatusCode::OK;
 }
 
@@ -15,8 +15,11 @@
 //*****************************************************************************
 #pragma once
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <inference_engine.hpp>
 #include <spdlog/spdlog.h>
@@ -27,19 +30,148 @@
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #pragma GCC diagnostic pop
 
+#include "sharedmemory.hpp"
 #include "status.hpp"
 #include "tensorinfo.hpp"
 
 namespace ovms {
 
+using output_filter_t = google::protobuf::RepeatedPtrField<std::string>;
+
+/**
+ * @brief Checks if output is listed in output_filter of predict request. Empty or missing filter requests all outputs.
+ */
+inline bool isOutputRequested(const output_filter_t* outputFilter, const std::string& outputName) {
+    return outputFilter == nullptr || outputFilter->empty() ||
+           std::any_of(outputFilter->begin(), outputFilter->end(), [&outputName](const std::string& entry) {
+               return getOutputFilterEntryName(entry) == outputName;
+           });
+}
+
+/**
+ * @brief Moves serialized outputs with shared memory destination in output_filter into client regions.
+ * Response tensors keep dtype and shape, their content is replaced with reference to written memory.
+ */
+Status writeOutputsToSharedMemory(tensorflow::serving::PredictResponse* response, const output_filter_t* outputFilter);
+
+/**
+ * @brief Quantization parameters of I8 encoded output, one entry per 0th dimension entry of serialized tensor.
+ * Values are decoded as scale * (value - zeroPoint).
+ */
+struct OutputQuantization {
+    std::vector<float> scales;
+    std::vector<int32_t> zeroPoints;
+};
+
+/**
+ * @brief Serializes output blob into tensor proto. FP32 output values are encoded as set in network output.
+ *
+ * @param quantization filled with quantization parameters of I8 encoded output when set
+ */
 Status serializeBlobToTensorProto(
     tensorflow::TensorProto& responseOutput,
     const std::shared_ptr<TensorInfo>& networkOutput,
-    InferenceEngine::Blob::Ptr blob);
+    InferenceEngine::Blob::Ptr blob,
+    OutputQuantization* quantization = nullptr);
+
+/**
+ * @brief Serializes part of the blob along 0th dimension. Used to split outputs of server side gathered batch.
+ */
+Status serializeBlobBatchToTensorProto(
+    tensorflow::TensorProto& responseOutput,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    InferenceEngine::Blob::Ptr blob,
+    size_t batchOffset,
+    size_t batchSize,
+    OutputQuantization* quantization = nullptr);
+
+/**
+ * @brief Serializes reduction of FP32 or FP16 output along its last dimension into response. ARGMAX output is sent as
+ * DT_INT64 indices without the last dimension, TOP_K output as DT_FLOAT values with the last dimension of k and
+ * DT_INT64 indices in additional output with "_indices" suffix.
+ *
+ * @param data output values in network precision
+ * @param shape of data, e.g. network shape with batch size of the response
+ */
+Status serializeReducedOutput(
+    tensorflow::serving::PredictResponse& response,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    const char* data,
+    const shape_t& shape);
+
+/**
+ * @brief Serializes output data in network output precision and layout, with batch size other than the network one.
+ * Used to concatenate outputs of request split into several inferences.
+ */
+Status serializeBatchToTensorProto(
+    tensorflow::TensorProto& responseOutput,
+    const std::shared_ptr<TensorInfo>& networkOutput,
+    const char* data,
+    size_t batchSize,
+    OutputQuantization* quantization = nullptr);
+
+/**
+ * @brief Adds quantization parameters of I8 encoded output into response, as DT_FLOAT scales in additional output
+ * with "_scale" suffix and DT_INT32 zero points in additional output with "_zero_point" suffix.
+ * Models with outputs named like these additional outputs fail to load, so no model output is overwritten.
+ *
+ * @param outputName mapped name of encoded output
+ */
+void serializeOutputQuantization(
+    tensorflow::serving::PredictResponse& response,
+    const std::string& outputName,
+    const OutputQuantization& quantization);
+
+/**
+ * @brief Points large output blobs of infer request into response tensor content, so inference writes results
+ * in place and serialization does not copy them. Original blobs are set back on restore or destruction,
+ * which has to happen before infer request is used by anyone else.
+ */
+class ResponseOutputBlobsGuard {
+public:
+    ResponseOutputBlobsGuard(InferenceEngine::InferRequest& inferRequest) :
+        inferRequest(inferRequest) {}
+
+    ~ResponseOutputBlobsGuard() {
+        restore();
+    }
+
+    ResponseOutputBlobsGuard(const ResponseOutputBlobsGuard&) = delete;
+    ResponseOutputBlobsGuard& operator=(const ResponseOutputBlobsGuard&) = delete;
+
+    /**
+     * @brief Prepares response tensors and sets output blobs over their content. Outputs smaller than threshold are left untouched.
+     *
+     * @param outputMap
+     * @param response
+     * @param outputFilter outputs not listed in non empty filter are skipped
+     *
+     * @return Status
+     */
+    Status prepare(const tensor_map_t& outputMap, tensorflow::serving::PredictResponse* response, const output_filter_t* outputFilter = nullptr);
+
+    /**
+     * @brief Sets original output blobs back on infer request
+     */
+    void restore();
+
+    bool isInPlace(const std::string& outputName) const {
+        return originalBlobs.count(outputName) > 0;
+    }
+
+private:
+    InferenceEngine::InferRequest& inferRequest;
+    std::map<std::string, InferenceEngine::Blob::Ptr> originalBlobs;
+};
 
+/**
+ * @brief Serializes outputs of infer request into response. Outputs not listed in non empty output filter are not fetched from infer request.
+ */
 Status serializePredictResponse(
     InferenceEngine::InferRequest& inferRequest,
     const tensor_map_t& outputMap,
-    tensorflow::serving::PredictResponse* response);
+    tensorflow::serving::PredictResponse* response,
+    const ResponseOutputBlobsGuard* responseOutputBlobs = nullptr,
+    const output_filter_t* outputFilter = nullptr);
 
 }  // namespace ovms
@@ -17,6 +17,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <grpcpp/security/server_credentials.h>
@@ -29,13 +30,27 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include "adminauthorization.hpp"
+#include "async_prediction_service.hpp"
+#include "bulkinferencejobs.hpp"
 #include "config.hpp"
+#include "containerlimits.hpp"
+#include "cpupartitioning.hpp"
 #include "http_server.hpp"
+#include "inferencescheduler.hpp"
 #include "logging.hpp"
 #include "model_service.hpp"
 #include "modelmanager.hpp"
+#include "numa.hpp"
+#include "otlp_exporter.hpp"
 #include "prediction_service.hpp"
+#include "saturation.hpp"
+#include "streamsbudget.hpp"
+#include "streaming_prediction_service.hpp"
 #include "stringutils.hpp"
+#include "tensorarena.hpp"
+#include "tracing.hpp"
+#include "trafficcapture.hpp"
 
 using grpc::Server;
 using grpc::ServerBuilder;
@@ -58,6 +73,16 @@ uint getGRPCServersCount() {
     return std::max<uint>(1, ovms::Config::instance().grpcWorkers());
 }
 
+/**
+ * @brief Completion queues of asynchronous server, one per cpu unless gRPC workers count is given
+ */
+uint getCompletionQueuesCount(const cpu_list_t& cpus) {
+    if (std::getenv("GRPC_SERVERS") || ovms::Config::instance().grpcWorkersSet() || cpus.empty()) {
+        return getGRPCServersCount();
+    }
+    return std::min<size_t>(cpus.size(), getEffectiveCpuCount());
+}
+
 bool isPortAvailable(uint64_t port) {
     struct sockaddr_in addr;
     int s = socket(AF_INET, SOCK_STREAM, 0);
@@ -100,6 +125,17 @@ Status parseGrpcChannelArgs(const std::string& channel_arguments_str, std::vecto
     return StatusCode::OK;
 }
 
+void logContainerLimits(Config& config) {
+    const auto& limits = getContainerLimits();
+    SPDLOG_INFO("Available CPUs: {}; host CPUs: {}; cpuset CPUs: {}; cgroup {} {}; CPU quota: {}; memory limit: {}",
+        getEffectiveCpuCount(), std::thread::hardware_concurrency(), limits.cpusetCpus, limits.cgroupV2 ? "v2" : "v1",
+        limits.cgroupPath.empty() ? "not found" : limits.cgroupPath,
+        limits.cpuQuota > 0 ? std::to_string(limits.cpuQuota) : "none",
+        limits.memoryLimitBytes > 0 ? std::to_string(limits.memoryLimitBytes >> 20) + " MB" : "none");
+    SPDLOG_INFO("Derived from available CPUs - REST workers: {}; model loading parallelism: {}; gRPC completion queues and CPU nireq limit: {}",
+        config.restWorkers(), config.modelLoadingParallelism(), getEffectiveCpuCount());
+}
+
 void logConfig(Config& config) {
     SPDLOG_DEBUG("CLI parameters passed to ovms server");
     if (config.configPath().empty()) {
@@ -116,9 +152,25 @@ void logConfig(Config& config) {
     }
     SPDLOG_DEBUG("gRPC port: {}", config.port());
     SPDLOG_DEBUG("REST port: {}", config.restPort());
+    SPDLOG_DEBUG("gRPC unix socket: {}", config.grpcUnixSocket());
+    SPDLOG_DEBUG("REST unix socket: {}", config.restUnixSocket());
     SPDLOG_DEBUG("REST workers: {}", config.restWorkers());
+    SPDLOG_DEBUG("REST inference workers: {}", config.restInferenceWorkers());
+    SPDLOG_DEBUG("REST inference queue size: {}", config.restInferenceQueueSize());
+    SPDLOG_DEBUG("REST compression threshold: {}", config.restCompressionThreshold());
     SPDLOG_DEBUG("gRPC workers: {}", config.grpcWorkers());
+    SPDLOG_DEBUG("gRPC async predict: {}", config.grpcAsyncPredict());
+    SPDLOG_DEBUG("gRPC zero copy inputs: {}", config.grpcZeroCopyInputs());
     SPDLOG_DEBUG("gRPC channel arguments: {}", config.grpcChannelArguments());
+    SPDLOG_DEBUG("network cpus: {}", config.networkCpus());
+    SPDLOG_DEBUG("background cpus: {}", config.backgroundCpus());
+    SPDLOG_DEBUG("saturation threshold: {}", config.saturationThreshold());
+    SPDLOG_DEBUG("saturation shed requests: {}", config.saturationShedRequests());
+    SPDLOG_DEBUG("trace endpoint: {}", config.traceEndpoint());
+    SPDLOG_DEBUG("trace sampling ratio: {}", config.traceSamplingRatio());
+    SPDLOG_DEBUG("tensor arena MB: {}", config.tensorArenaMb());
+    SPDLOG_DEBUG("inference slots: {}", config.inferenceSlots());
+    SPDLOG_DEBUG("CPU streams budget: {}", config.cpuStreamsBudget());
     SPDLOG_DEBUG("log level: {}", config.logLevel());
     SPDLOG_DEBUG("log path: {}", config.logPath());
 }
@@ -157,7 +209,9 @@ void installSignalHandlers() {
 
 std::vector<std::unique_ptr<Server>> startGRPCServer(
     PredictionServiceImpl& predict_service,
-    ModelServiceImpl& model_service) {
+    ModelServiceImpl& model_service,
+    StreamingPredictionServiceImpl& streaming_service,
+    std::unique_ptr<AsyncPredictionHandler>& asyncPredictHandler) {
     const int GIGABYTE = 1024 * 1024 * 1024;
 
     std::vector<GrpcChannelArgument> channel_arguments;
@@ -169,8 +223,39 @@ std::vector<std::unique_ptr<Server>> startGRPCServer(
     }
 
     logConfig(config);
+    logContainerLimits(config);
+    auto& cpuPartitioning = CpuPartitioning::instance();
+    status = cpuPartitioning.configure(config.networkCpus(), config.backgroundCpus());
+    if (!status.ok()) {
+        SPDLOG_ERROR("network_cpus: {} or background_cpus: {} passed in wrong format", config.networkCpus(), config.backgroundCpus());
+        exit(1);
+    }
+    cpuPartitioning.logLayout();
+    SaturationMonitor::instance().configure(config.saturationThreshold(), config.saturationShedRequests());
+    // before models are loaded, their infer requests take output blobs from the arena
+    TensorArena::instance().configure(config.tensorArenaMb() * 1024 * 1024);
+    // model versions register in the scheduler when loaded
+    InferenceScheduler::instance().configure(config.inferenceSlots());
+    StreamsBudget::instance().configure(config.cpuStreamsBudget());
+    if (!config.adminTokenFile().empty() && !AdminAuthorization::instance().loadTokenFile(config.adminTokenFile()).ok()) {
+        exit(1);
+    }
+    if (!BulkInferenceJobs::instance().configure(config.bulkJobs(), config.bulkJobsRoot()).ok()) {
+        exit(1);
+    }
+    if (!config.traceEndpoint().empty()) {
+        Tracer::instance().configure(OtlpHttpExporter(config.traceEndpoint()), config.traceSamplingRatio());
+    }
+    if (!config.trafficCapturePath().empty()) {
+        status = TrafficCapture::instance().configure(config.trafficCapturePath(), config.trafficCaptureRatio(),
+            static_cast<uint64_t>(config.trafficCaptureMaxMb()) * 1024 * 1024);
+        if (!status.ok()) {
+            exit(1);
+        }
+    }
     auto& manager = ModelManager::getInstance();
-    status = manager.start();
+    // watcher thread started by the manager inherits background cpus, models are loaded with inference cpus
+    cpuPartitioning.runOnBackgroundCpus([&manager, &status]() { status = manager.start(); });
     if (!status.ok()) {
         SPDLOG_ERROR("ovms::ModelManager::Start() Error: {}", status.string());
         exit(1);
@@ -179,9 +264,26 @@ std::vector<std::unique_ptr<Server>> startGRPCServer(
     ServerBuilder builder;
     builder.SetMaxReceiveMessageSize(GIGABYTE);
     builder.SetMaxSendMessageSize(GIGABYTE);
-    builder.AddListeningPort(config.grpcBindAddress() + ":" + std::to_string(config.port()), grpc::InsecureServerCredentials());
-    builder.RegisterService(&predict_service);
-    builder.RegisterService(&model_service);
+    // port 0 together with unix socket disables listening on TCP
+    const bool listenOnPort = config.port() != 0 || config.grpcUnixSocket().empty();
+    if (listenOnPort) {
+        builder.AddListeningPort(config.grpcBindAddress() + ":" + std::to_string(config.port()), grpc::InsecureServerCredentials());
+    }
+    if (!config.grpcUnixSocket().empty()) {
+        if (!removeStaleUnixSocket(config.grpcUnixSocket())) {
+            throw std::runtime_error("Failed to start GRPC server at unix socket " + config.grpcUnixSocket());
+        }
+        builder.AddListeningPort("unix:" + config.grpcUnixSocket(), grpc::InsecureServerCredentials());
+    }
+    if (config.grpcAsyncPredict()) {
+        // completion queues replace multiple servers, each one is polled by its own thread pinned to a cpu
+        const auto cpus = cpuPartitioning.getNetworkCpus().empty() ? getAllowedCpus() : cpuPartitioning.getNetworkCpus();
+        asyncPredictHandler = std::make_unique<AsyncPredictionHandler>(builder, getCompletionQueuesCount(cpus), cpus, config.grpcZeroCopyInputs());
+    } else {
+        builder.RegisterService(&predict_service);
+        builder.RegisterService(&model_service);
+    }
+    builder.RegisterService(&streaming_service);
     for (const GrpcChannelArgument& channel_argument : channel_arguments) {
         // gRPC accept arguments of two types, int and string. We will attempt to
         // parse each arg as int and pass it on as such if successful. Otherwise we
@@ -198,21 +300,32 @@ std::vector<std::unique_ptr<Server>> startGRPCServer(
     }
 
     std::vector<std::unique_ptr<Server>> servers;
-    uint grpcServersCount = getGRPCServersCount();
+    uint grpcServersCount = asyncPredictHandler ? 1 : getGRPCServersCount();
     servers.reserve(grpcServersCount);
     SPDLOG_DEBUG("Starting grpc servers: {}", grpcServersCount);
 
-    if (!isPortAvailable(config.port())) {
+    if (listenOnPort && !isPortAvailable(config.port())) {
         throw std::runtime_error("Failed to start GRPC server at " + config.grpcBindAddress() + ":" + std::to_string(config.port()));
     }
-    for (uint i = 0; i < grpcServersCount; ++i) {
-        std::unique_ptr<Server> server = builder.BuildAndStart();
-        if (server == nullptr) {
-            throw std::runtime_error("Failed to start GRPC server at " + std::to_string(config.port()));
+    // server threads inherit network cpus
+    cpuPartitioning.runOnNetworkCpus([&]() {
+        for (uint i = 0; i < grpcServersCount; ++i) {
+            std::unique_ptr<Server> server = builder.BuildAndStart();
+            if (server == nullptr) {
+                throw std::runtime_error("Failed to start GRPC server at " + std::to_string(config.port()));
+            }
+            servers.push_back(std::move(server));
+        }
+        if (asyncPredictHandler) {
+            asyncPredictHandler->start();
         }
-        servers.push_back(std::move(server));
+    });
+    if (listenOnPort) {
+        SPDLOG_INFO("Server started on port {}", config.port());
+    }
+    if (!config.grpcUnixSocket().empty()) {
+        SPDLOG_INFO("Server started on unix socket {}", config.grpcUnixSocket());
     }
-    SPDLOG_INFO("Server started on port {}", config.port());
 
     return servers;
 }
@@ -227,7 +340,11 @@ std::unique_ptr<ovms::http_server> startRESTServer() {
         int workers = config.restWorkers() ? config.restWorkers() : 10;
         SPDLOG_INFO("Will start {} REST workers", workers);
 
-        std::unique_ptr<ovms::http_server> restServer = ovms::createAndStartHttpServer(config.restBindAddress(), config.restPort(), workers, REST_TIMEOUT);
+        std::unique_ptr<ovms::http_server> restServer;
+        ovms::CpuPartitioning::instance().runOnNetworkCpus([&]() {
+            restServer = ovms::createAndStartHttpServer(config.restBindAddress(), config.restPort(), workers, REST_TIMEOUT, config.restCompressionThreshold(),
+                config.restInferenceWorkers(), config.restInferenceQueueSize(), config.restUnixSocket());
+        });
         if (restServer != nullptr) {
             SPDLOG_INFO("Started REST server at {}", server_address);
         } else {
@@ -244,12 +361,17 @@ int server_main(int argc, char** argv) {
     installSignalHandlers();
     try {
         auto& config = ovms::Config::instance().parse(argc, argv);
-        configure_logger(config.logLevel(), config.logPath());
+        configure_logger(config.logLevel(), config.logPath(), config.logQueueSize(), config.logQueueOverflow() == "drop");
 
         PredictionServiceImpl predict_service;
         ModelServiceImpl model_service;
+        StreamingPredictionServiceImpl streaming_service(static_cast<size_t>(config.grpcChunkedRequestMaxMb()) * 1024 * 1024,
+            static_cast<size_t>(config.grpcChunkedRequestsBudgetMb()) * 1024 * 1024,
+            std::chrono::seconds(config.grpcChunkedRequestReadTimeoutS()));
+
+        std::unique_ptr<AsyncPredictionHandler> asyncPredictHandler;
 
-        auto grpc = startGRPCServer(predict_service, model_service);
+        auto grpc = startGRPCServer(predict_service, model_service, streaming_service, asyncPredictHandler);
         auto rest = startRESTServer();
 
         while (!shutdown_request) {
@@ -262,12 +384,18 @@ int server_main(int argc, char** argv) {
         for (const auto& g : grpc) {
             g->Shutdown();
         }
+        if (asyncPredictHandler) {
+            asyncPredictHandler->shutdown();
+        }
 
         if (rest != nullptr) {
             rest->Terminate();
         }
 
         ModelManager::getInstance().join();
+        // spans of requests finished during shutdown are exported before exit
+        Tracer::instance().shutdown();
+        TrafficCapture::instance().shutdown();
     } catch (std::exception& e) {
         SPDLOG_ERROR("Exception catch: {} - will now terminate.", e.what());
         return EXIT_FAILURE;
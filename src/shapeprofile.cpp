@@ -0,0 +1,270 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "shapeprofile.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include "samplingprofiler.hpp"
+
+namespace ovms {
+
+namespace {
+const char SHAPE_PROFILE_HEADER[] = "ovms_shape_profile 1";
+const char BATCH_SIZE_SIGNATURE_PREFIX[] = "batch_size:";
+
+bool parseSize(const std::string& text, size_t& value) {
+    if (text.empty() || !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return false;
+    }
+    std::istringstream stream(text);
+    return static_cast<bool>(stream >> value);
+}
+}  // namespace
+
+void ShapeHistogram::record(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = counts.find(key);
+    if (it != counts.end()) {
+        ++it->second;
+    } else if (counts.size() < MAX_SHAPE_HISTOGRAM_KEYS) {
+        counts.emplace(key, 1);
+    } else {
+        return;
+    }
+    changed = true;
+}
+
+void ShapeHistogram::merge(const std::map<std::string, uint64_t>& other, double weight) {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& [key, count] : other) {
+        const auto scaled = static_cast<uint64_t>(static_cast<double>(count) * weight);
+        if (scaled == 0 || (counts.size() >= MAX_SHAPE_HISTOGRAM_KEYS && counts.find(key) == counts.end())) {
+            continue;
+        }
+        counts[key] += scaled;
+        changed = true;
+    }
+}
+
+std::vector<std::string> ShapeHistogram::getTopKeys(size_t count) const {
+    std::vector<std::pair<std::string, uint64_t>> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        sorted.assign(counts.begin(), counts.end());
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+    });
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < std::min(count, sorted.size()); ++i) {
+        keys.push_back(std::move(sorted[i].first));
+    }
+    return keys;
+}
+
+std::map<std::string, uint64_t> ShapeHistogram::getCounts() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return std::map<std::string, uint64_t>(counts.begin(), counts.end());
+}
+
+bool ShapeHistogram::takeChanged() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return std::exchange(changed, false);
+}
+
+bool parseShapeSignature(const std::string& key, size_t& batchSize, std::map<std::string, std::vector<size_t>>& shapes) {
+    batchSize = 0;
+    shapes.clear();
+    const std::string batchPrefix(BATCH_SIZE_SIGNATURE_PREFIX);
+    if (key.compare(0, batchPrefix.size(), batchPrefix) == 0) {
+        return parseSize(key.substr(batchPrefix.size()), batchSize) && batchSize > 0;
+    }
+    size_t position = 0;
+    while (position < key.size()) {
+        // input names may contain ':', the shape starts at the last ":(" of the entry
+        const auto end = key.find(");", position);
+        if (end == std::string::npos) {
+            return false;
+        }
+        const auto open = key.rfind(":(", end);
+        if (open == std::string::npos || open <= position) {
+            return false;
+        }
+        std::vector<size_t> shape;
+        std::istringstream dims(key.substr(open + 2, end - open - 2));
+        std::string dim;
+        while (std::getline(dims, dim, ',')) {
+            size_t value = 0;
+            if (!parseSize(dim, value)) {
+                return false;
+            }
+            shape.push_back(value);
+        }
+        shapes[key.substr(position, open - position)] = std::move(shape);
+        position = end + 2;
+    }
+    return !shapes.empty();
+}
+
+std::string ShapeProfileStore::getModelDirectory(const std::string& modelName) const {
+    std::string sanitized = modelName;
+    for (auto& c : sanitized) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') {
+            c = '_';
+        }
+    }
+    return (std::filesystem::path(directory) / "shape_profiles" / sanitized).string();
+}
+
+std::string ShapeProfileStore::getProfilePath(const std::string& modelName, int64_t version) const {
+    return (std::filesystem::path(getModelDirectory(modelName)) / (std::to_string(version) + ".shapes")).string();
+}
+
+bool ShapeProfileStore::load(const std::string& modelName, int64_t version, std::map<std::string, uint64_t>& counts) const {
+    auto path = getProfilePath(modelName, version);
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        // rolled out version starts from traffic of the closest older one
+        int64_t closest = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(getModelDirectory(modelName), error)) {
+            int64_t candidate = 0;
+            std::istringstream stem(entry.path().stem().string());
+            if (entry.path().extension() == ".shapes" && (stem >> candidate) && stem.eof() && candidate < version && candidate > closest) {
+                closest = candidate;
+            }
+        }
+        if (closest == 0) {
+            SPDLOG_DEBUG("Shape profile miss: {}", path);
+            return false;
+        }
+        path = getProfilePath(modelName, closest);
+    }
+    std::ifstream file(path);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line) || line != SHAPE_PROFILE_HEADER) {
+        SPDLOG_WARN("Invalid shape profile: {}; shapes will be compiled on first request", path);
+        return false;
+    }
+    std::map<std::string, uint64_t> loaded;
+    while (std::getline(file, line)) {
+        // "count signature", signatures do not contain spaces
+        const auto space = line.find(' ');
+        size_t count = 0;
+        if (space == std::string::npos || !parseSize(line.substr(0, space), count) || space + 1 == line.size()) {
+            SPDLOG_WARN("Invalid shape profile: {}; shapes will be compiled on first request", path);
+            return false;
+        }
+        loaded[line.substr(space + 1)] = count;
+    }
+    SPDLOG_DEBUG("Loaded shape profile: {} with {} shapes", path, loaded.size());
+    counts = std::move(loaded);
+    return true;
+}
+
+void ShapeProfileStore::store(const std::string& modelName, int64_t version, const std::map<std::string, uint64_t>& counts) const {
+    const auto path = getProfilePath(modelName, version);
+    std::stringstream tmpSuffix;
+    tmpSuffix << ".tmp." << getpid() << "." << std::this_thread::get_id();
+    const auto tmpPath = path + tmpSuffix.str();
+    std::error_code error;
+    std::filesystem::create_directories(getModelDirectory(modelName), error);
+    if (error) {
+        SPDLOG_WARN("Cannot create shape profiles directory: {}; error: {}", getModelDirectory(modelName), error.message());
+        return;
+    }
+    {
+        std::ofstream file(tmpPath);
+        file << SHAPE_PROFILE_HEADER << "\n";
+        for (const auto& [key, count] : counts) {
+            file << count << " " << key << "\n";
+        }
+        if (!file) {
+            SPDLOG_WARN("Cannot write shape profile: {}", tmpPath);
+            std::filesystem::remove(tmpPath, error);
+            return;
+        }
+    }
+    std::filesystem::rename(tmpPath, path, error);
+    if (error) {
+        SPDLOG_WARN("Cannot store shape profile: {}; error: {}", path, error.message());
+        std::filesystem::remove(tmpPath, error);
+    }
+}
+
+ShapePrecompilationQueue& ShapePrecompilationQueue::instance() {
+    static ShapePrecompilationQueue instance;
+    return instance;
+}
+
+ShapePrecompilationQueue::~ShapePrecompilationQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopRequested = true;
+        tasks.clear();
+    }
+    condition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void ShapePrecompilationQueue::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopRequested) {
+            return;
+        }
+        tasks.push_back(std::move(task));
+        if (!worker.joinable()) {
+            worker = std::thread(&ShapePrecompilationQueue::run, this);
+        }
+    }
+    condition.notify_all();
+}
+
+void ShapePrecompilationQueue::waitIdle() {
+    std::unique_lock<std::mutex> lock(mtx);
+    condition.wait(lock, [this]() { return stopRequested || (tasks.empty() && !running); });
+}
+
+void ShapePrecompilationQueue::run() {
+    setCurrentThreadName("ovms_precompile");
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        condition.wait(lock, [this]() { return stopRequested || !tasks.empty(); });
+        if (stopRequested) {
+            return;
+        }
+        auto task = std::move(tasks.front());
+        tasks.pop_front();
+        running = true;
+        lock.unlock();
+        task();
+        lock.lock();
+        running = false;
+        condition.notify_all();
+    }
+}
+
+}  // namespace ovms
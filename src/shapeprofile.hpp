@@ -0,0 +1,155 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Limit of distinct shape signatures counted per model version, new signatures are ignored above it
+ */
+const size_t MAX_SHAPE_HISTOGRAM_KEYS = 1024;
+
+/**
+ * @brief Weight of persisted request counts merged into histogram of a new instance, so recent traffic outweighs old one
+ */
+const double SHAPE_HISTORY_WEIGHT = 0.5;
+
+/**
+ * @brief Counts predict requests of a model version by signature of their shape or batch size, as used by key of shape variants
+ */
+class ShapeHistogram {
+public:
+    void record(const std::string& key);
+
+    /**
+     * @brief Adds counts scaled by weight, counts rounded down to 0 are dropped
+     */
+    void merge(const std::map<std::string, uint64_t>& counts, double weight = 1.0);
+
+    /**
+     * @brief Most frequent signatures first, ties are ordered by signature
+     */
+    std::vector<std::string> getTopKeys(size_t count) const;
+
+    std::map<std::string, uint64_t> getCounts() const;
+
+    /**
+     * @brief Checks if anything was recorded since the previous call
+     */
+    bool takeChanged();
+
+private:
+    mutable std::mutex mtx;
+    std::unordered_map<std::string, uint64_t> counts;
+    bool changed = false;
+};
+
+/**
+ * @brief Parses shape variant signature, either "batch_size:N" or "input:(d0,d1,...);" per input
+ *
+ * @param batchSize set for batch size signature, 0 otherwise
+ * @param shapes network layout shapes by mapped input name for shape signature
+ *
+ * @return false when the signature is malformed
+ */
+bool parseShapeSignature(const std::string& key, size_t& batchSize, std::map<std::string, std::vector<size_t>>& shapes);
+
+/**
+ * @brief Shape histograms kept in the compiled network cache directory, so new instances of the server precompile
+ * networks for shapes observed by previous ones. Histograms are keyed by model name and version, a new version
+ * without its own histogram starts from the histogram of the closest older version.
+ */
+class ShapeProfileStore {
+public:
+    /**
+     * @param directory store is disabled when empty
+     */
+    ShapeProfileStore(const std::string& directory) :
+        directory(directory) {}
+
+    bool isEnabled() const {
+        return !directory.empty();
+    }
+
+    std::string getProfilePath(const std::string& modelName, int64_t version) const;
+
+    /**
+     * @return true if histogram of the version or of an older version was found
+     */
+    bool load(const std::string& modelName, int64_t version, std::map<std::string, uint64_t>& counts) const;
+
+    /**
+     * @brief Stores histogram, failures are logged and only cause shapes to be compiled on first request next time
+     */
+    void store(const std::string& modelName, int64_t version, const std::map<std::string, uint64_t>& counts) const;
+
+private:
+    std::string getModelDirectory(const std::string& modelName) const;
+
+    const std::string directory;
+};
+
+/**
+ * @brief Compiles networks for shapes learned from traffic history one at a time on a background thread,
+ * so precompilation neither delays model loading nor competes with it for cores
+ */
+class ShapePrecompilationQueue {
+public:
+    static ShapePrecompilationQueue& instance();
+
+    ShapePrecompilationQueue() = default;
+
+    /**
+     * @brief Drops tasks which were not started and waits for the running one
+     */
+    ~ShapePrecompilationQueue();
+
+    ShapePrecompilationQueue(const ShapePrecompilationQueue&) = delete;
+    ShapePrecompilationQueue& operator=(const ShapePrecompilationQueue&) = delete;
+
+    /**
+     * @brief Queues the task, worker thread is started with the first one
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until queued tasks are finished
+     */
+    void waitIdle();
+
+private:
+    void run();
+
+    std::mutex mtx;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> tasks;
+    bool running = false;
+    bool stopRequested = false;
+    std::thread worker;
+};
+
+}  // namespace ovms
@@ -0,0 +1,44 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "shardedcounter.hpp"
+
+namespace ovms {
+
+size_t ShardedCounter::getThreadShard() {
+    // threads are spread over shards in order of their first use, shared by all counters
+    static std::atomic<size_t> nextShard = 0;
+    thread_local const size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS_COUNT;
+    return shard;
+}
+
+uint64_t ShardedCounter::get() const {
+    uint64_t sum = 0;
+    for (const auto& shard : shards) {
+        sum += shard.value.load();
+    }
+    return sum;
+}
+
+bool ShardedCounter::isZero() const {
+    for (const auto& shard : shards) {
+        if (shard.value.load() != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace ovms
@@ -0,0 +1,74 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ovms {
+
+/**
+ * @brief Counter of in-flight operations split into shards placed on separate cache lines, so that threads
+ * on different cores do not contend on one atomic
+ *
+ * Each thread increments its own shard and the matching decrement has to be done on the same shard, even if it
+ * runs on other thread. Shards are never negative then, so the sum read by isZero() or get() is zero only if
+ * no operation started before the read is still in progress.
+ */
+class ShardedCounter {
+public:
+    static constexpr size_t SHARDS_COUNT = 64;
+
+    /**
+     * @brief Increments shard of calling thread
+     *
+     * @return shard to pass to decrement
+     */
+    size_t increment() {
+        const size_t shard = getThreadShard();
+        shards[shard].value.fetch_add(1);
+        return shard;
+    }
+
+    /**
+     * @brief Decrements shard incremented before
+     *
+     * @param shard returned by increment
+     */
+    void decrement(size_t shard) {
+        shards[shard].value.fetch_sub(1);
+    }
+
+    /**
+     * @brief Sums all shards
+     */
+    uint64_t get() const;
+
+    bool isZero() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value = 0;
+    };
+
+    static size_t getThreadShard();
+
+    std::array<Shard, SHARDS_COUNT> shards;
+};
+
+}  // namespace ovms
@@ -0,0 +1,368 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "sharedmemory.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+Status SharedMemoryRegion::open(const std::string& key, size_t byteSize, std::shared_ptr<SharedMemoryRegion>& region) {
+    if (byteSize == 0) {
+        SPDLOG_DEBUG("Cannot map empty shared memory region: {}", key);
+        return StatusCode::SHM_REGION_MAPPING_FAILED;
+    }
+    int fd = shm_open(key.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+        SPDLOG_DEBUG("Failed to open shared memory object: {}; {}", key, std::strerror(errno));
+        return StatusCode::SHM_REGION_MAPPING_FAILED;
+    }
+    struct stat objectStat;
+    if (fstat(fd, &objectStat) == -1 || static_cast<size_t>(objectStat.st_size) < byteSize) {
+        SPDLOG_DEBUG("Shared memory object: {} is smaller than requested size: {}", key, byteSize);
+        close(fd);
+        return StatusCode::SHM_REGION_MAPPING_FAILED;
+    }
+    void* data = mmap(nullptr, byteSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // mapping stays valid after descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        SPDLOG_DEBUG("Failed to map shared memory object: {}; {}", key, std::strerror(errno));
+        return StatusCode::SHM_REGION_MAPPING_FAILED;
+    }
+    region.reset(new SharedMemoryRegion(key, static_cast<char*>(data), byteSize));
+    return StatusCode::OK;
+}
+
+std::shared_ptr<SharedMemoryRegion> SharedMemoryRegion::wrap(const std::string& key, char* data, size_t byteSize, std::shared_ptr<const void> owner) {
+    return std::shared_ptr<SharedMemoryRegion>(new SharedMemoryRegion(key, data, byteSize, std::move(owner)));
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    if (owner == nullptr) {
+        munmap(data, byteSize);
+    }
+}
+
+Status SharedMemoryRegistry::registerRegion(const std::string& name, const std::string& key, size_t byteSize) {
+    if (name == MESSAGE_TENSOR_REGION_NAME) {
+        SPDLOG_DEBUG("Shared memory region name: {} is reserved", name);
+        return StatusCode::SHM_REGION_NAME_RESERVED;
+    }
+    std::shared_ptr<SharedMemoryRegion> region;
+    auto status = SharedMemoryRegion::open(key, byteSize, region);
+    if (!status.ok()) {
+        return status;
+    }
+    std::unique_lock lock(regionsMtx);
+    if (!regions.emplace(name, std::move(region)).second) {
+        SPDLOG_DEBUG("Shared memory region: {} is already registered", name);
+        return StatusCode::SHM_REGION_ALREADY_REGISTERED;
+    }
+    SPDLOG_INFO("Registered shared memory region: {}; key: {}; size: {}", name, key, byteSize);
+    return StatusCode::OK;
+}
+
+Status SharedMemoryRegistry::unregisterRegion(const std::string& name) {
+    std::unique_lock lock(regionsMtx);
+    if (regions.erase(name) == 0) {
+        SPDLOG_DEBUG("Shared memory region: {} is not registered", name);
+        return StatusCode::SHM_REGION_NOT_REGISTERED;
+    }
+    SPDLOG_INFO("Unregistered shared memory region: {}", name);
+    return StatusCode::OK;
+}
+
+std::shared_ptr<SharedMemoryRegion> SharedMemoryRegistry::findRegion(const std::string& name) const {
+    std::shared_lock lock(regionsMtx);
+    auto it = regions.find(name);
+    if (it == regions.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+Status SharedMemoryRegistry::resolve(const SharedMemoryReference& reference, std::shared_ptr<SharedMemoryRegion>& region, char*& data) const {
+    region = findRegion(reference.regionName);
+    if (region == nullptr) {
+        std::stringstream ss;
+        ss << "Region: " << reference.regionName << " is not registered";
+        const std::string details = ss.str();
+        SPDLOG_DEBUG("Invalid shared memory reference - {}", details);
+        return Status(StatusCode::INVALID_SHARED_MEMORY_REFERENCE, details);
+    }
+    if (reference.offset > region->getByteSize() || reference.byteSize > region->getByteSize() - reference.offset) {
+        std::stringstream ss;
+        ss << "Range: [" << reference.offset << ", " << reference.offset + reference.byteSize
+           << ") exceeds region: " << reference.regionName << " of size: " << region->getByteSize();
+        const std::string details = ss.str();
+        SPDLOG_DEBUG("Invalid shared memory reference - {}", details);
+        return Status(StatusCode::INVALID_SHARED_MEMORY_REFERENCE, details);
+    }
+    data = region->getData() + reference.offset;
+    return StatusCode::OK;
+}
+
+void MessageTensorRegistry::registerTensor(const tensorflow::TensorProto* proto, std::shared_ptr<SharedMemoryRegion> region) {
+    std::unique_lock lock(tensorsMtx);
+    tensors[proto] = std::move(region);
+}
+
+void MessageTensorRegistry::unregisterTensor(const tensorflow::TensorProto* proto) {
+    std::unique_lock lock(tensorsMtx);
+    tensors.erase(proto);
+}
+
+std::shared_ptr<SharedMemoryRegion> MessageTensorRegistry::findRegion(const tensorflow::TensorProto* proto) const {
+    std::shared_lock lock(tensorsMtx);
+    auto it = tensors.find(proto);
+    if (it == tensors.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+size_t MessageTensorRegistry::getTensorsCount() const {
+    std::shared_lock lock(tensorsMtx);
+    return tensors.size();
+}
+
+static bool parseSize(const std::string_view text, size_t& value) {
+    if (text.empty() || text.size() > std::numeric_limits<size_t>::digits10) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<size_t>(c - '0');
+    }
+    return true;
+}
+
+Status parseSharedMemoryReference(const std::string_view text, SharedMemoryReference& reference) {
+    std::vector<std::string_view> parts;
+    if (text.compare(0, SHARED_MEMORY_REFERENCE_PREFIX.size(), SHARED_MEMORY_REFERENCE_PREFIX) == 0) {
+        std::string_view remaining = text.substr(SHARED_MEMORY_REFERENCE_PREFIX.size());
+        size_t separator;
+        while ((separator = remaining.find(':')) != std::string_view::npos) {
+            parts.push_back(remaining.substr(0, separator));
+            remaining.remove_prefix(separator + 1);
+        }
+        parts.push_back(remaining);
+    }
+    if (parts.size() != 3 || parts[0].empty() ||
+        !parseSize(parts[1], reference.offset) || !parseSize(parts[2], reference.byteSize)) {
+        std::stringstream ss;
+        ss << "Expected: " << SHARED_MEMORY_REFERENCE_PREFIX << "<region>:<offset>:<byte size>; Actual: " << text;
+        const std::string details = ss.str();
+        SPDLOG_DEBUG("Invalid shared memory reference - {}", details);
+        return Status(StatusCode::INVALID_SHARED_MEMORY_REFERENCE, details);
+    }
+    reference.regionName = std::string(parts[0]);
+    return StatusCode::OK;
+}
+
+std::string sharedMemoryReferenceToString(const SharedMemoryReference& reference) {
+    std::stringstream ss;
+    ss << SHARED_MEMORY_REFERENCE_PREFIX << reference.regionName << ":" << reference.offset << ":" << reference.byteSize;
+    return ss.str();
+}
+
+Status getOutputFilterEntryDestination(const std::string& entry, std::optional<SharedMemoryReference>& destination) {
+    destination.reset();
+    const auto separator = entry.find(OUTPUT_DESTINATION_SEPARATOR);
+    if (separator == std::string::npos) {
+        return StatusCode::OK;
+    }
+    SharedMemoryReference reference;
+    auto status = parseSharedMemoryReference(std::string_view(entry).substr(separator + 1), reference);
+    if (!status.ok()) {
+        return status;
+    }
+    destination = std::move(reference);
+    return StatusCode::OK;
+}
+
+static Status resolveTensorReference(const tensorflow::TensorProto& proto, SharedMemoryReference& reference,
+    std::shared_ptr<SharedMemoryRegion>& region, char*& data) {
+    auto status = parseSharedMemoryReference(proto.string_val(0), reference);
+    if (!status.ok()) {
+        return status;
+    }
+    if (reference.regionName != MESSAGE_TENSOR_REGION_NAME) {
+        return SharedMemoryRegistry::getInstance().resolve(reference, region, data);
+    }
+    region = MessageTensorRegistry::getInstance().findRegion(&proto);
+    if (region == nullptr || reference.offset != 0 || reference.byteSize > region->getByteSize()) {
+        SPDLOG_DEBUG("Invalid shared memory reference - tensor does not reference received message");
+        return Status(StatusCode::INVALID_SHARED_MEMORY_REFERENCE, "Tensor does not reference received message");
+    }
+    data = region->getData();
+    return StatusCode::OK;
+}
+
+static Status checkReferenceByteSize(const SharedMemoryReference& reference, size_t expectedByteSize) {
+    if (reference.byteSize != expectedByteSize) {
+        std::stringstream ss;
+        ss << "Expected: " << expectedByteSize << " bytes; Actual: " << reference.byteSize << " bytes";
+        const std::string details = ss.str();
+        SPDLOG_DEBUG("Invalid shared memory reference - {}", details);
+        return Status(StatusCode::INVALID_SHARED_MEMORY_REFERENCE, details);
+    }
+    return StatusCode::OK;
+}
+
+Status validateSharedMemoryReference(const tensorflow::TensorProto& requestInput, size_t expectedByteSize) {
+    SharedMemoryReference reference;
+    std::shared_ptr<SharedMemoryRegion> region;
+    char* data = nullptr;
+    auto status = resolveTensorReference(requestInput, reference, region, data);
+    if (!status.ok()) {
+        return status;
+    }
+    return checkReferenceByteSize(reference, expectedByteSize);
+}
+
+namespace {
+/**
+ * @brief Lends region memory to a single blob instead of allocating it. Region stays mapped until the blob is released.
+ */
+class SharedMemoryAllocator : public InferenceEngine::IAllocator {
+public:
+    SharedMemoryAllocator(std::shared_ptr<SharedMemoryRegion> region, char* data) :
+        region(std::move(region)),
+        data(data) {}
+
+    void* lock(void* handle, InferenceEngine::LockOp) noexcept override {
+        return handle;
+    }
+
+    void unlock(void*) noexcept override {}
+
+    void* alloc(size_t) noexcept override {
+        return data;
+    }
+
+    bool free(void*) noexcept override {
+        return true;
+    }
+
+    void Release() noexcept override {
+        delete this;
+    }
+
+private:
+    std::shared_ptr<SharedMemoryRegion> region;
+    char* data;
+};
+
+template <typename T>
+InferenceEngine::Blob::Ptr makeSharedMemoryBlob(const InferenceEngine::TensorDesc& tensorDesc, const std::shared_ptr<InferenceEngine::IAllocator>& allocator) {
+    auto blob = InferenceEngine::make_shared_blob<T>(tensorDesc, allocator);
+    blob->allocate();
+    return blob;
+}
+
+InferenceEngine::Blob::Ptr makeSharedMemoryBlob(const InferenceEngine::TensorDesc& tensorDesc, const std::shared_ptr<InferenceEngine::IAllocator>& allocator) {
+    switch (tensorDesc.getPrecision()) {
+    case InferenceEngine::Precision::FP32:
+        return makeSharedMemoryBlob<float>(tensorDesc, allocator);
+    case InferenceEngine::Precision::I32:
+        return makeSharedMemoryBlob<int32_t>(tensorDesc, allocator);
+    case InferenceEngine::Precision::I16:
+        return makeSharedMemoryBlob<int16_t>(tensorDesc, allocator);
+    case InferenceEngine::Precision::U8:
+    case InferenceEngine::Precision::BOOL:
+        return makeSharedMemoryBlob<uint8_t>(tensorDesc, allocator);
+    case InferenceEngine::Precision::I8:
+        return makeSharedMemoryBlob<int8_t>(tensorDesc, allocator);
+    case InferenceEngine::Precision::U16:
+    case InferenceEngine::Precision::FP16:
+        return makeSharedMemoryBlob<uint16_t>(tensorDesc, allocator);
+    case InferenceEngine::Precision::I64:
+        return makeSharedMemoryBlob<int64_t>(tensorDesc, allocator);
+    default:
+        return nullptr;
+    }
+}
+}  // namespace
+
+Status deserializeSharedMemoryReference(const tensorflow::TensorProto& requestInput,
+    const InferenceEngine::TensorDesc& tensorDesc,
+    InferenceEngine::Blob::Ptr& blob) {
+    SharedMemoryReference reference;
+    std::shared_ptr<SharedMemoryRegion> region;
+    char* data = nullptr;
+    auto status = resolveTensorReference(requestInput, reference, region, data);
+    if (!status.ok()) {
+        return status;
+    }
+    blob = makeSharedMemoryBlob(tensorDesc, std::make_shared<SharedMemoryAllocator>(std::move(region), data));
+    if (blob == nullptr) {
+        return StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION;
+    }
+    return checkReferenceByteSize(reference, blob->byteSize());
+}
+
+Status copySharedMemoryReference(const tensorflow::TensorProto& requestInput, char* destination, size_t byteSize) {
+    SharedMemoryReference reference;
+    std::shared_ptr<SharedMemoryRegion> region;
+    char* data = nullptr;
+    auto status = resolveTensorReference(requestInput, reference, region, data);
+    if (!status.ok()) {
+        return status;
+    }
+    status = checkReferenceByteSize(reference, byteSize);
+    if (!status.ok()) {
+        return status;
+    }
+    std::memcpy(destination, data, byteSize);
+    return StatusCode::OK;
+}
+
+Status moveTensorContentToSharedMemory(tensorflow::TensorProto& proto, const SharedMemoryReference& destination) {
+    std::shared_ptr<SharedMemoryRegion> region;
+    char* data = nullptr;
+    auto status = SharedMemoryRegistry::getInstance().resolve(destination, region, data);
+    if (!status.ok()) {
+        return status;
+    }
+    status = checkReferenceByteSize(destination, proto.tensor_content().size());
+    if (!status.ok()) {
+        return status;
+    }
+    std::memcpy(data, proto.tensor_content().data(), destination.byteSize);
+    proto.clear_tensor_content();
+    proto.clear_string_val();
+    proto.add_string_val(sharedMemoryReferenceToString(destination));
+    return StatusCode::OK;
+}
+
+}  // namespace ovms
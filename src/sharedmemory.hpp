@@ -0,0 +1,235 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <inference_engine.hpp>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow/core/framework/tensor.h"
+#pragma GCC diagnostic pop
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Prefix of tensor references to shared memory, "shm:<region>:<offset>:<byte size>"
+ */
+const std::string SHARED_MEMORY_REFERENCE_PREFIX = "shm:";
+
+/**
+ * @brief Separates output name from shared memory destination in output_filter entry, "<output>@shm:<region>:<offset>:<byte size>"
+ */
+const char OUTPUT_DESTINATION_SEPARATOR = '@';
+
+/**
+ * @brief Region name of tensor references to bytes of the received gRPC message, "shm:@message:0:<byte size>".
+ * It is resolved by tensor address in MessageTensorRegistry, so clients cannot reference other requests memory.
+ */
+const std::string MESSAGE_TENSOR_REGION_NAME = "@message";
+
+struct SharedMemoryReference {
+    std::string regionName;
+    size_t offset = 0;
+    size_t byteSize = 0;
+};
+
+/**
+ * @brief POSIX shared memory object created by a client and mapped into the server address space.
+ * Memory is unmapped when the last blob or request using the region releases it.
+ */
+class SharedMemoryRegion {
+public:
+    /**
+     * @brief Maps existing shared memory object
+     *
+     * @param key name of the object passed to shm_open
+     * @param byteSize mapped size, the object has to be at least that large
+     * @param region
+     *
+     * @return Status
+     */
+    static Status open(const std::string& key, size_t byteSize, std::shared_ptr<SharedMemoryRegion>& region);
+
+    /**
+     * @brief Wraps memory which is not mapped by the server, e.g. a slice of received message
+     *
+     * @param key used for logging
+     * @param data
+     * @param byteSize
+     * @param owner keeps the memory valid as long as the region is in use
+     *
+     * @return std::shared_ptr<SharedMemoryRegion>
+     */
+    static std::shared_ptr<SharedMemoryRegion> wrap(const std::string& key, char* data, size_t byteSize, std::shared_ptr<const void> owner);
+
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    const std::string& getKey() const {
+        return key;
+    }
+
+    char* getData() const {
+        return data;
+    }
+
+    size_t getByteSize() const {
+        return byteSize;
+    }
+
+private:
+    SharedMemoryRegion(const std::string& key, char* data, size_t byteSize, std::shared_ptr<const void> owner = nullptr) :
+        key(key),
+        data(data),
+        byteSize(byteSize),
+        owner(std::move(owner)) {}
+
+    const std::string key;
+    char* const data;
+    const size_t byteSize;
+    // set for wrapped memory, which is not unmapped
+    const std::shared_ptr<const void> owner;
+};
+
+/**
+ * @brief Named shared memory regions registered by clients co-located with the server
+ */
+class SharedMemoryRegistry {
+public:
+    static SharedMemoryRegistry& getInstance() {
+        static SharedMemoryRegistry instance;
+        return instance;
+    }
+
+    Status registerRegion(const std::string& name, const std::string& key, size_t byteSize);
+
+    /**
+     * @brief Removes region from registry. Requests already using the region keep it mapped until they finish.
+     */
+    Status unregisterRegion(const std::string& name);
+
+    std::shared_ptr<SharedMemoryRegion> findRegion(const std::string& name) const;
+
+    /**
+     * @brief Finds memory referenced by the request, checking that it fits into the region
+     *
+     * @param reference
+     * @param region keeps the memory mapped while it is in use
+     * @param data beginning of referenced memory
+     *
+     * @return Status
+     */
+    Status resolve(const SharedMemoryReference& reference, std::shared_ptr<SharedMemoryRegion>& region, char*& data) const;
+
+private:
+    SharedMemoryRegistry() = default;
+
+    mutable std::shared_mutex regionsMtx;
+    std::map<std::string, std::shared_ptr<SharedMemoryRegion>> regions;
+};
+
+/**
+ * @brief Tensors of received gRPC messages which reference message bytes in place instead of copying them
+ * into tensor_content. Tensors are registered only for the time their request is processed.
+ */
+class MessageTensorRegistry {
+public:
+    static MessageTensorRegistry& getInstance() {
+        static MessageTensorRegistry instance;
+        return instance;
+    }
+
+    void registerTensor(const tensorflow::TensorProto* proto, std::shared_ptr<SharedMemoryRegion> region);
+
+    void unregisterTensor(const tensorflow::TensorProto* proto);
+
+    std::shared_ptr<SharedMemoryRegion> findRegion(const tensorflow::TensorProto* proto) const;
+
+    size_t getTensorsCount() const;
+
+private:
+    MessageTensorRegistry() = default;
+
+    mutable std::shared_mutex tensorsMtx;
+    std::unordered_map<const tensorflow::TensorProto*, std::shared_ptr<SharedMemoryRegion>> tensors;
+};
+
+/**
+ * @brief Checks if request tensor keeps its data in shared memory region instead of the message
+ */
+inline bool isSharedMemoryReference(const tensorflow::TensorProto& proto) {
+    return proto.dtype() != tensorflow::DataType::DT_STRING &&
+           proto.tensor_content().empty() &&
+           proto.string_val_size() == 1 &&
+           proto.string_val(0).compare(0, SHARED_MEMORY_REFERENCE_PREFIX.size(), SHARED_MEMORY_REFERENCE_PREFIX) == 0;
+}
+
+Status parseSharedMemoryReference(const std::string_view text, SharedMemoryReference& reference);
+
+std::string sharedMemoryReferenceToString(const SharedMemoryReference& reference);
+
+/**
+ * @brief Gets output name of output_filter entry, stripping shared memory destination if there is one
+ */
+inline std::string_view getOutputFilterEntryName(const std::string& entry) {
+    return std::string_view(entry).substr(0, entry.find(OUTPUT_DESTINATION_SEPARATOR));
+}
+
+/**
+ * @brief Parses shared memory destination of output_filter entry
+ *
+ * @param entry
+ * @param destination left empty when output is returned in response message
+ *
+ * @return Status
+ */
+Status getOutputFilterEntryDestination(const std::string& entry, std::optional<SharedMemoryReference>& destination);
+
+/**
+ * @brief Checks that request tensor references registered region memory of expected size
+ */
+Status validateSharedMemoryReference(const tensorflow::TensorProto& requestInput, size_t expectedByteSize);
+
+/**
+ * @brief Wraps shared memory referenced by request tensor into blob without copying it. Blob keeps the region mapped.
+ */
+Status deserializeSharedMemoryReference(const tensorflow::TensorProto& requestInput,
+    const InferenceEngine::TensorDesc& tensorDesc,
+    InferenceEngine::Blob::Ptr& blob);
+
+/**
+ * @brief Copies shared memory referenced by request tensor into already allocated memory of given size
+ */
+Status copySharedMemoryReference(const tensorflow::TensorProto& requestInput, char* destination, size_t byteSize);
+
+/**
+ * @brief Writes serialized tensor content into client region and replaces it with reference to written memory
+ */
+Status moveTensorContentToSharedMemory(tensorflow::TensorProto& proto, const SharedMemoryReference& destination);
+
+}  // namespace ovms
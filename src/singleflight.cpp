@@ -0,0 +1,86 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "singleflight.hpp"
+
+#include <utility>
+
+namespace ovms {
+
+bool SingleFlight::join(const std::string& key, follower_callback_t follower) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = inFlight.find(key);
+    if (it == inFlight.end()) {
+        inFlight.emplace(key, std::vector<follower_callback_t>());
+        return true;
+    }
+    it->second.push_back(std::move(follower));
+    return false;
+}
+
+void SingleFlight::complete(const std::string& key, const Status& status, const tensorflow::serving::PredictResponse& response) {
+    std::vector<follower_callback_t> followers;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = inFlight.find(key);
+        if (it == inFlight.end()) {
+            return;
+        }
+        followers = std::move(it->second);
+        inFlight.erase(it);
+    }
+    coalesced.fetch_add(followers.size(), std::memory_order_relaxed);
+    for (auto& follower : followers) {
+        follower(status, response);
+    }
+}
+
+SingleFlightWaiter::SingleFlightWaiter(tensorflow::serving::PredictResponse* response) :
+    state(std::make_shared<State>()) {
+    state->response = response;
+}
+
+SingleFlightWaiter::~SingleFlightWaiter() {
+    std::lock_guard<std::mutex> lock(state->mtx);
+    state->response = nullptr;
+}
+
+SingleFlight::follower_callback_t SingleFlightWaiter::createFollower() {
+    return [state = this->state](const Status& status, const tensorflow::serving::PredictResponse& response) {
+        std::lock_guard<std::mutex> lock(state->mtx);
+        if (state->response == nullptr) {
+            return;
+        }
+        if (status.ok()) {
+            state->response->CopyFrom(response);
+        }
+        state->status = status;
+        state->completed = true;
+        state->completedCondition.notify_all();
+    };
+}
+
+Status SingleFlightWaiter::wait(const deadline_t& deadline) {
+    std::unique_lock<std::mutex> lock(state->mtx);
+    if (deadline == NO_DEADLINE) {
+        state->completedCondition.wait(lock, [this]() { return state->completed; });
+    } else if (!state->completedCondition.wait_until(lock, deadline, [this]() { return state->completed; })) {
+        state->response = nullptr;
+        return StatusCode::DEADLINE_EXCEEDED;
+    }
+    return state->status;
+}
+
+}  // namespace ovms
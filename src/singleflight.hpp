@@ -0,0 +1,123 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "deadline.hpp"
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Coalesces concurrent identical requests of a single model instance. The first request runs the inference,
+ * requests with the same key arriving before it is finished wait for it and share its response.
+ */
+class SingleFlight {
+public:
+    /**
+     * @brief Called with status of the leading request and its response, which is valid only for the time of the call
+     */
+    using follower_callback_t = std::function<void(const Status&, const tensorflow::serving::PredictResponse&)>;
+
+    /**
+     * @brief Registers request with given key
+     *
+     * @param key request key created by ResponseCache::createKey
+     * @param follower called when the leading request with the same key completes
+     *
+     * @return true if there is no request with the same key in flight, caller leads it and has to call complete.
+     * Otherwise follower is registered and will be called.
+     */
+    bool join(const std::string& key, follower_callback_t follower);
+
+    /**
+     * @brief Completes leading request, calls its followers in the calling thread
+     *
+     * @param key
+     * @param status
+     * @param response
+     */
+    void complete(const std::string& key, const Status& status, const tensorflow::serving::PredictResponse& response);
+
+    /**
+     * @brief Gets number of requests served by responses of other requests
+     */
+    uint64_t getCoalescedCount() const {
+        return coalesced.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::mutex mtx;
+    std::unordered_map<std::string, std::vector<follower_callback_t>> inFlight;
+    std::atomic<uint64_t> coalesced{0};
+};
+
+/**
+ * @brief Follower of SingleFlight waiting for the leading request in the calling thread until its deadline.
+ * Follower which gave up waiting is not touched by the leading request anymore, its response is left as it was.
+ */
+class SingleFlightWaiter {
+public:
+    /**
+     * @param response filled with response of the leading request, must be valid until wait returns
+     */
+    SingleFlightWaiter(tensorflow::serving::PredictResponse* response);
+
+    ~SingleFlightWaiter();
+
+    SingleFlightWaiter(const SingleFlightWaiter&) = delete;
+    SingleFlightWaiter& operator=(const SingleFlightWaiter&) = delete;
+
+    /**
+     * @brief Creates follower for SingleFlight::join, it may outlive the waiter
+     */
+    SingleFlight::follower_callback_t createFollower();
+
+    /**
+     * @brief Blocks until the leading request completes or deadline passes
+     *
+     * @return Status of the leading request, DEADLINE_EXCEEDED if it did not complete before deadline
+     */
+    Status wait(const deadline_t& deadline);
+
+private:
+    struct State {
+        std::mutex mtx;
+        std::condition_variable completedCondition;
+        bool completed = false;
+        Status status;
+        // reset once the waiter gives up
+        tensorflow::serving::PredictResponse* response;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+}  // namespace ovms
@@ -0,0 +1,89 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/util/threadpool_executor.h"
+#pragma GCC diagnostic pop
+
+#include "samplingprofiler.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Thread pool of a REST request processing stage. Counts tasks waiting for a thread and rejects new ones
+ * when the queue size limit is reached.
+ */
+class StageExecutor {
+public:
+    /**
+     * @param name used for thread names and logging, names longer than 15 characters are truncated
+     * @param num_threads
+     * @param max_queue_size maximum number of tasks waiting for a thread, 0 means no limit
+     */
+    StageExecutor(const std::string& name, int num_threads, size_t max_queue_size = 0) :
+        name_(name),
+        max_queue_size_(max_queue_size),
+        executor_(tensorflow::Env::Default(), name, num_threads) {}
+
+    /**
+     * @brief Schedules task for execution
+     *
+     * @return false if the queue size limit is reached and the task is dropped
+     */
+    bool Schedule(std::function<void()> fn) {
+        const size_t depth = ++queue_depth_;
+        if (max_queue_size_ > 0 && depth > max_queue_size_) {
+            --queue_depth_;
+            SPDLOG_DEBUG("REST {} queue is full: {} tasks", name_, max_queue_size_);
+            return false;
+        }
+        SPDLOG_DEBUG("REST {} queue depth: {}", name_, depth);
+        executor_.Schedule([this, fn = std::move(fn)]() {
+            // pool threads are named after the stage so profiles map back to it
+            static thread_local bool named = false;
+            if (!named) {
+                setCurrentThreadName(name_);
+                named = true;
+            }
+            --queue_depth_;
+            fn();
+        });
+        return true;
+    }
+
+    /**
+     * @brief Number of tasks waiting for a thread
+     */
+    size_t queue_depth() const { return queue_depth_.load(std::memory_order_relaxed); }
+
+private:
+    const std::string name_;
+    const size_t max_queue_size_;
+    std::atomic<size_t> queue_depth_{0};
+    // destroyed first, joins threads still running tasks
+    tensorflow::serving::ThreadPoolExecutor executor_;
+};
+
+}  // namespace ovms
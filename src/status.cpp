@@ -16,6 +16,12 @@
 
 #include "status.hpp"
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
 namespace ovms {
 
 const std::map<const StatusCode, const std::string> Status::statusMessageMap = {
@@ -25,10 +31,12 @@ const std::map<const StatusCode, const std::string> Status::statusMessageMap = {
     {StatusCode::FILE_INVALID, "File not found or cannot open"},
     {StatusCode::NO_MODEL_VERSION_AVAILABLE, "Not a single model version directory has valid numeric name"},
     {StatusCode::NETWORK_NOT_LOADED, "Error while loading a network"},
+    {StatusCode::MODELS_MEMORY_BUDGET_EXCEEDED, "Loading model version would exceed memory budget of models"},
     {StatusCode::JSON_INVALID, "The file is not valid json"},
     {StatusCode::MODELINSTANCE_NOT_FOUND, "ModelInstance not found"},
     {StatusCode::SHAPE_WRONG_FORMAT, "The provided shape is in wrong format"},
     {StatusCode::PLUGIN_CONFIG_WRONG_FORMAT, "Plugin config is in wrong format"},
+    {StatusCode::CPU_LIST_WRONG_FORMAT, "CPU list is in wrong format or contains unavailable CPUs"},
     {StatusCode::MODEL_VERSION_POLICY_WRONG_FORMAT, "Model version policy is in wrong format"},
     {StatusCode::MODEL_VERSION_POLICY_UNSUPPORTED_KEY, "Model version policy contains unsupported key"},
     {StatusCode::RESHAPE_ERROR, "Model could not be reshaped with requested shape"},
@@ -44,26 +52,66 @@ const std::map<const StatusCode, const std::string> Status::statusMessageMap = {
     {StatusCode::MODEL_SPEC_MISSING, "model_spec missing in request"},
     {StatusCode::INVALID_SIGNATURE_DEF, "Invalid signature name"},
     {StatusCode::CONFIG_SHAPE_IS_NOT_IN_NETWORK, "Shape from config not found in network"},
+    {StatusCode::OUTPUT_REDUCTION_NAME_COLLISION, "Indices output of top_k reduction has the name of another model output"},
+    {StatusCode::OUTPUT_QUANTIZATION_NAME_COLLISION, "Scale or zero point output of I8 encoded output has the name of another model output"},
     {StatusCode::INVALID_NIREQ, "Nireq parameter too high"},
+    {StatusCode::NIREQ_RESIZE_NOT_SUPPORTED, "Infer requests of the model cannot be resized"},
     {StatusCode::REQUESTED_DYNAMIC_PARAMETERS_ON_SUBSCRIBED_MODEL, "Requested dynamic parameters but model is subscribed to pipeline"},
     {StatusCode::PIPELINE_STREAM_ID_NOT_READY_YET, "Node is not ready for execution"},
 
     // Predict request validation
     {StatusCode::INVALID_NO_OF_INPUTS, "Invalid number of inputs"},
     {StatusCode::INVALID_MISSING_INPUT, "Missing input with specific name"},
+    {StatusCode::INVALID_MISSING_OUTPUT, "Missing output with specific name"},
     {StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS, "Invalid number of shape dimensions"},
     {StatusCode::INVALID_BATCH_SIZE, "Invalid input batch size"},
     {StatusCode::INVALID_SHAPE, "Invalid input shape"},
     {StatusCode::INVALID_PRECISION, "Invalid input precision"},
     {StatusCode::INVALID_VALUE_COUNT, "Invalid number of values in tensor proto container"},
     {StatusCode::INVALID_CONTENT_SIZE, "Invalid content size of tensor proto"},
+    {StatusCode::INVALID_SHARED_MEMORY_REFERENCE, "Invalid shared memory region reference"},
 
     // Deserialization
     {StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION, "Unsupported deserialization precision"},
     {StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR, "Internal deserialization error"},
+    {StatusCode::MALFORMED_REQUEST_MESSAGE, "Malformed request message"},
+    {StatusCode::CHUNKED_REQUEST_TOO_LARGE, "Chunked request inputs exceed the size limit"},
+    {StatusCode::IMAGE_DECODING_FAILED, "Image decoding failed"},
 
     // Inference
     {StatusCode::OV_INTERNAL_INFERENCE_ERROR, "Internal inference error"},
+    {StatusCode::DEADLINE_EXCEEDED, "Request deadline exceeded before inference was started"},
+    {StatusCode::TOO_MANY_PENDING_REQUESTS, "Model pending requests limit reached"},
+    {StatusCode::SERVER_SATURATED, "Server is saturated"},
+    {StatusCode::CORE_MODELS_NOT_READY, "Core models are not ready"},
+
+    // Shared memory
+    {StatusCode::SHM_REGION_ALREADY_REGISTERED, "Shared memory region with the same name is already registered"},
+    {StatusCode::SHM_REGION_NAME_RESERVED, "Shared memory region name is reserved"},
+    {StatusCode::SHM_REGION_NOT_REGISTERED, "Shared memory region with requested name is not registered"},
+    {StatusCode::SHM_REGION_MAPPING_FAILED, "Failed to map shared memory region"},
+
+    // Bulk inference jobs
+    {StatusCode::BULK_JOBS_DISABLED, "Bulk inference jobs are not enabled"},
+    {StatusCode::BULK_JOB_NOT_FOUND, "Bulk inference job with requested id does not exist"},
+    {StatusCode::BULK_JOB_FINISHED, "Bulk inference job is already finished"},
+    {StatusCode::BULK_JOB_NO_SHARDS, "Input directory of bulk inference job has no .npy shards"},
+    {StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT, "Input or output of bulk inference job is outside of bulk jobs root"},
+
+    // Admin API
+    {StatusCode::ADMIN_API_DISABLED, "Admin API is not enabled"},
+    {StatusCode::ADMIN_UNAUTHORIZED, "Missing or invalid admin token"},
+    {StatusCode::PROFILE_OPTIONS_INVALID, "Profile duration or frequency is out of range"},
+    {StatusCode::PROFILER_BUSY, "Another profile is already running"},
+    {StatusCode::PROFILER_START_FAILED, "Failed to start CPU profiler"},
+
+    // Sequences of stateful models
+    {StatusCode::SEQUENCE_ID_NOT_PROVIDED, "Sequence id has not been provided in request inputs"},
+    {StatusCode::SEQUENCE_MISSING, "Sequence with provided id does not exist"},
+    {StatusCode::SEQUENCE_ALREADY_EXISTS, "Sequence with provided id already exists"},
+    {StatusCode::MAX_SEQUENCE_NUMBER_REACHED, "Max sequence number has been reached"},
+    {StatusCode::INVALID_SEQUENCE_CONTROL_INPUT, "Unexpected value of sequence control input"},
+    {StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT, "Sequence id and sequence control input have to be single non-negative integers"},
 
     // Serialization
     {StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION, "Unsupported serialization precision"},
@@ -75,6 +123,7 @@ const std::map<const StatusCode, const std::string> Status::statusMessageMap = {
     // Rest handler failure
     {StatusCode::REST_INVALID_URL, "Invalid request URL"},
     {StatusCode::REST_UNSUPPORTED_METHOD, "Unsupported method"},
+    {StatusCode::REST_MALFORMED_REQUEST, "Malformed request"},
 
     // Rest parser failure
     {StatusCode::REST_BODY_IS_NOT_AN_OBJECT, "Request body should be JSON object"},
@@ -92,6 +141,11 @@ const std::map<const StatusCode, const std::string> Status::statusMessageMap = {
     {StatusCode::REST_PROTO_TO_STRING_ERROR, "Response parsing to JSON error"},
     {StatusCode::REST_UNSUPPORTED_PRECISION, "Could not parse input content. Unsupported data precision detected"},
     {StatusCode::REST_SERIALIZE_TENSOR_CONTENT_INVALID_SIZE, "Tensor serialization error"},
+    {StatusCode::REST_BINARY_HEADER_INVALID, "Invalid binary tensor request header"},
+    {StatusCode::REST_BINARY_DATA_SIZE_MISMATCH, "Binary tensor data size does not match request header"},
+    {StatusCode::RESPONSE_COMPRESSION_FAILED, "Failed to compress response"},
+    {StatusCode::REST_INFERENCE_QUEUE_FULL, "REST inference queue is full"},
+    {StatusCode::REST_BATCH_REQUEST_INVALID, "Invalid batch predict request"},
 
     // Pipeline validation errors
     {StatusCode::PIPELINE_DEFINITION_ALREADY_EXIST, "Pipeline definition with the same name already exists"},
@@ -112,6 +166,8 @@ const std::map<const StatusCode, const std::string> Status::statusMessageMap = {
     {StatusCode::PIPELINE_MODEL_INPUT_CONNECTED_TO_MULTIPLE_DATA_SOURCES, "Pipeline definition has multiple connections to the same input of underlying model"},
     {StatusCode::PIPELINE_EXIT_USED_AS_NODE_DEPENDENCY, "Pipeline definition has response node used as dependency node"},
     {StatusCode::PIPELINE_NAME_OCCUPIED, "Pipeline has the same name as model"},
+    {StatusCode::PIPELINE_DEFINITION_INVALID_NODE_LIBRARY, "Pipeline refers to incorrect custom node library"},
+    {StatusCode::PIPELINE_GATE_REFERING_TO_MISSING_INPUT, "Pipeline definition has gate node referring to not connected input"},
 
     // Storage errors
     // S3
@@ -155,6 +211,16 @@ const std::map<const StatusCode, const std::string> Status::statusMessageMap = {
     {StatusCode::CUSTOM_LOADER_NOT_PRESENT, "The custom loader is not present in loaders list"},
     {StatusCode::CUSTOM_LOADER_INIT_FAILED, "Custom Loader LoadInit failed"},
     {StatusCode::CUSTOM_LOADER_ERROR, "Custom Loader Generic / Unknown Error"},
+
+    // Custom Node
+    {StatusCode::NODE_LIBRARY_ALREADY_LOADED, "Custom node library is already loaded"},
+    {StatusCode::NODE_LIBRARY_LOAD_FAILED_OPEN, "Custom node library failed to open"},
+    {StatusCode::NODE_LIBRARY_LOAD_FAILED_SYM, "Custom node library failed to load symbol"},
+    {StatusCode::NODE_LIBRARY_MISSING, "Custom node library is not loaded"},
+    {StatusCode::NODE_LIBRARY_EXECUTION_FAILED, "Custom node library execution failed"},
+    {StatusCode::NODE_LIBRARY_OUTPUTS_CORRUPTED, "Custom node library returned corrupted outputs"},
+    {StatusCode::NODE_LIBRARY_INVALID_PRECISION, "Custom node library returned output with invalid precision"},
+    {StatusCode::NODE_LIBRARY_MISSING_OUTPUT, "Custom node library did not return required output"},
 };
 
 const std::map<const StatusCode, grpc::StatusCode> Status::grpcStatusMap = {
@@ -164,10 +230,12 @@ const std::map<const StatusCode, grpc::StatusCode> Status::grpcStatusMap = {
     {StatusCode::FILE_INVALID, grpc::StatusCode::INTERNAL},
     {StatusCode::NO_MODEL_VERSION_AVAILABLE, grpc::StatusCode::INTERNAL},
     {StatusCode::NETWORK_NOT_LOADED, grpc::StatusCode::INTERNAL},
+    {StatusCode::MODELS_MEMORY_BUDGET_EXCEEDED, grpc::StatusCode::RESOURCE_EXHAUSTED},
     {StatusCode::JSON_INVALID, grpc::StatusCode::INTERNAL},
     {StatusCode::MODELINSTANCE_NOT_FOUND, grpc::StatusCode::INTERNAL},
     {StatusCode::SHAPE_WRONG_FORMAT, grpc::StatusCode::INTERNAL},
     {StatusCode::PLUGIN_CONFIG_WRONG_FORMAT, grpc::StatusCode::INTERNAL},
+    {StatusCode::CPU_LIST_WRONG_FORMAT, grpc::StatusCode::INTERNAL},
     {StatusCode::MODEL_VERSION_POLICY_WRONG_FORMAT, grpc::StatusCode::INTERNAL},
     {StatusCode::MODEL_VERSION_POLICY_UNSUPPORTED_KEY, grpc::StatusCode::INTERNAL},
     {StatusCode::RESHAPE_ERROR, grpc::StatusCode::FAILED_PRECONDITION},
@@ -177,6 +245,8 @@ const std::map<const StatusCode, grpc::StatusCode> Status::grpcStatusMap = {
     {StatusCode::MODEL_VERSION_MISSING, grpc::StatusCode::NOT_FOUND},
     {StatusCode::MODEL_VERSION_NOT_LOADED_ANYMORE, grpc::StatusCode::NOT_FOUND},
     {StatusCode::MODEL_VERSION_NOT_LOADED_YET, grpc::StatusCode::NOT_FOUND},
+    {StatusCode::INVALID_NIREQ, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::NIREQ_RESIZE_NOT_SUPPORTED, grpc::StatusCode::FAILED_PRECONDITION},
     {StatusCode::PIPELINE_DEFINITION_NOT_LOADED_ANYMORE, grpc::StatusCode::NOT_FOUND},
     {StatusCode::PIPELINE_DEFINITION_NOT_LOADED_YET, grpc::StatusCode::NOT_FOUND},
     {StatusCode::MODEL_SPEC_MISSING, grpc::StatusCode::INVALID_ARGUMENT},
@@ -185,21 +255,58 @@ const std::map<const StatusCode, grpc::StatusCode> Status::grpcStatusMap = {
     // Predict request validation
     {StatusCode::INVALID_NO_OF_INPUTS, grpc::StatusCode::INVALID_ARGUMENT},
     {StatusCode::INVALID_MISSING_INPUT, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::INVALID_MISSING_OUTPUT, grpc::StatusCode::INVALID_ARGUMENT},
     {StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS, grpc::StatusCode::INVALID_ARGUMENT},
     {StatusCode::INVALID_BATCH_SIZE, grpc::StatusCode::INVALID_ARGUMENT},
     {StatusCode::INVALID_SHAPE, grpc::StatusCode::INVALID_ARGUMENT},
     {StatusCode::INVALID_PRECISION, grpc::StatusCode::INVALID_ARGUMENT},
     {StatusCode::INVALID_VALUE_COUNT, grpc::StatusCode::INVALID_ARGUMENT},
     {StatusCode::INVALID_CONTENT_SIZE, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::INVALID_SHARED_MEMORY_REFERENCE, grpc::StatusCode::INVALID_ARGUMENT},
 
     // Deserialization
 
     // Should never occur - ModelInstance::validate takes care of that
     {StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION, grpc::StatusCode::INTERNAL},
     {StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR, grpc::StatusCode::INTERNAL},
+    {StatusCode::MALFORMED_REQUEST_MESSAGE, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::CHUNKED_REQUEST_TOO_LARGE, grpc::StatusCode::RESOURCE_EXHAUSTED},
+    {StatusCode::IMAGE_DECODING_FAILED, grpc::StatusCode::INVALID_ARGUMENT},
 
     // Inference
     {StatusCode::OV_INTERNAL_INFERENCE_ERROR, grpc::StatusCode::INTERNAL},
+    {StatusCode::DEADLINE_EXCEEDED, grpc::StatusCode::DEADLINE_EXCEEDED},
+    {StatusCode::TOO_MANY_PENDING_REQUESTS, grpc::StatusCode::RESOURCE_EXHAUSTED},
+    {StatusCode::SERVER_SATURATED, grpc::StatusCode::UNAVAILABLE},
+    {StatusCode::CORE_MODELS_NOT_READY, grpc::StatusCode::UNAVAILABLE},
+
+    // Shared memory
+    {StatusCode::SHM_REGION_ALREADY_REGISTERED, grpc::StatusCode::ALREADY_EXISTS},
+    {StatusCode::SHM_REGION_NAME_RESERVED, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::SHM_REGION_NOT_REGISTERED, grpc::StatusCode::NOT_FOUND},
+    {StatusCode::SHM_REGION_MAPPING_FAILED, grpc::StatusCode::FAILED_PRECONDITION},
+
+    // Bulk inference jobs
+    {StatusCode::BULK_JOBS_DISABLED, grpc::StatusCode::FAILED_PRECONDITION},
+    {StatusCode::BULK_JOB_NOT_FOUND, grpc::StatusCode::NOT_FOUND},
+    {StatusCode::BULK_JOB_FINISHED, grpc::StatusCode::FAILED_PRECONDITION},
+    {StatusCode::BULK_JOB_NO_SHARDS, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT, grpc::StatusCode::PERMISSION_DENIED},
+
+    // Admin API
+    {StatusCode::ADMIN_API_DISABLED, grpc::StatusCode::FAILED_PRECONDITION},
+    {StatusCode::ADMIN_UNAUTHORIZED, grpc::StatusCode::UNAUTHENTICATED},
+    {StatusCode::PROFILE_OPTIONS_INVALID, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::PROFILER_BUSY, grpc::StatusCode::UNAVAILABLE},
+    {StatusCode::PROFILER_START_FAILED, grpc::StatusCode::INTERNAL},
+
+    // Sequences of stateful models
+    {StatusCode::SEQUENCE_ID_NOT_PROVIDED, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::SEQUENCE_MISSING, grpc::StatusCode::NOT_FOUND},
+    {StatusCode::SEQUENCE_ALREADY_EXISTS, grpc::StatusCode::ALREADY_EXISTS},
+    {StatusCode::MAX_SEQUENCE_NUMBER_REACHED, grpc::StatusCode::UNAVAILABLE},
+    {StatusCode::INVALID_SEQUENCE_CONTROL_INPUT, grpc::StatusCode::INVALID_ARGUMENT},
+    {StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT, grpc::StatusCode::INVALID_ARGUMENT},
 
     // Serialization
 
@@ -209,6 +316,12 @@ const std::map<const StatusCode, grpc::StatusCode> Status::grpcStatusMap = {
 
     // GetModelStatus
     {StatusCode::INTERNAL_ERROR, grpc::StatusCode::INTERNAL},
+
+    // Custom Node
+    {StatusCode::NODE_LIBRARY_EXECUTION_FAILED, grpc::StatusCode::INTERNAL},
+    {StatusCode::NODE_LIBRARY_OUTPUTS_CORRUPTED, grpc::StatusCode::INTERNAL},
+    {StatusCode::NODE_LIBRARY_INVALID_PRECISION, grpc::StatusCode::INTERNAL},
+    {StatusCode::NODE_LIBRARY_MISSING_OUTPUT, grpc::StatusCode::INTERNAL},
 };
 
 const std::map<const StatusCode, net_http::HTTPStatusCode> Status::httpStatusMap = {
@@ -217,6 +330,7 @@ const std::map<const StatusCode, net_http::HTTPStatusCode> Status::httpStatusMap
     // REST handler failure
     {StatusCode::REST_INVALID_URL, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::REST_UNSUPPORTED_METHOD, net_http::HTTPStatusCode::NONE_ACC},
+    {StatusCode::REST_MALFORMED_REQUEST, net_http::HTTPStatusCode::BAD_REQUEST},
 
     // REST parser failure
     {StatusCode::REST_BODY_IS_NOT_AN_OBJECT, net_http::HTTPStatusCode::BAD_REQUEST},
@@ -234,15 +348,22 @@ const std::map<const StatusCode, net_http::HTTPStatusCode> Status::httpStatusMap
     {StatusCode::REST_PROTO_TO_STRING_ERROR, net_http::HTTPStatusCode::ERROR},
     {StatusCode::REST_UNSUPPORTED_PRECISION, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::REST_SERIALIZE_TENSOR_CONTENT_INVALID_SIZE, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::REST_BINARY_HEADER_INVALID, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::REST_BINARY_DATA_SIZE_MISMATCH, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::RESPONSE_COMPRESSION_FAILED, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::REST_INFERENCE_QUEUE_FULL, net_http::HTTPStatusCode::TOO_MANY_REQUESTS},
+    {StatusCode::REST_BATCH_REQUEST_INVALID, net_http::HTTPStatusCode::BAD_REQUEST},
 
     {StatusCode::PATH_INVALID, net_http::HTTPStatusCode::ERROR},
     {StatusCode::FILE_INVALID, net_http::HTTPStatusCode::ERROR},
     {StatusCode::NO_MODEL_VERSION_AVAILABLE, net_http::HTTPStatusCode::ERROR},
     {StatusCode::NETWORK_NOT_LOADED, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::MODELS_MEMORY_BUDGET_EXCEEDED, net_http::HTTPStatusCode::SERVICE_UNAV},
     {StatusCode::JSON_INVALID, net_http::HTTPStatusCode::ERROR},
     {StatusCode::MODELINSTANCE_NOT_FOUND, net_http::HTTPStatusCode::ERROR},
     {StatusCode::SHAPE_WRONG_FORMAT, net_http::HTTPStatusCode::ERROR},
     {StatusCode::PLUGIN_CONFIG_WRONG_FORMAT, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::CPU_LIST_WRONG_FORMAT, net_http::HTTPStatusCode::ERROR},
     {StatusCode::MODEL_VERSION_POLICY_WRONG_FORMAT, net_http::HTTPStatusCode::ERROR},
     {StatusCode::MODEL_VERSION_POLICY_UNSUPPORTED_KEY, net_http::HTTPStatusCode::ERROR},
     {StatusCode::RESHAPE_ERROR, net_http::HTTPStatusCode::PRECOND_FAILED},
@@ -252,6 +373,8 @@ const std::map<const StatusCode, net_http::HTTPStatusCode> Status::httpStatusMap
     {StatusCode::MODEL_VERSION_MISSING, net_http::HTTPStatusCode::NOT_FOUND},
     {StatusCode::MODEL_VERSION_NOT_LOADED_ANYMORE, net_http::HTTPStatusCode::NOT_FOUND},
     {StatusCode::MODEL_VERSION_NOT_LOADED_YET, net_http::HTTPStatusCode::NOT_FOUND},
+    {StatusCode::INVALID_NIREQ, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::NIREQ_RESIZE_NOT_SUPPORTED, net_http::HTTPStatusCode::PRECOND_FAILED},
     {StatusCode::PIPELINE_DEFINITION_NOT_LOADED_YET, net_http::HTTPStatusCode::NOT_FOUND},
     {StatusCode::PIPELINE_DEFINITION_NOT_LOADED_ANYMORE, net_http::HTTPStatusCode::NOT_FOUND},
     {StatusCode::MODEL_SPEC_MISSING, net_http::HTTPStatusCode::BAD_REQUEST},
@@ -260,21 +383,58 @@ const std::map<const StatusCode, net_http::HTTPStatusCode> Status::httpStatusMap
     // Predict request validation
     {StatusCode::INVALID_NO_OF_INPUTS, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::INVALID_MISSING_INPUT, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::INVALID_MISSING_OUTPUT, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::INVALID_NO_OF_SHAPE_DIMENSIONS, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::INVALID_BATCH_SIZE, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::INVALID_SHAPE, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::INVALID_PRECISION, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::INVALID_VALUE_COUNT, net_http::HTTPStatusCode::BAD_REQUEST},
     {StatusCode::INVALID_CONTENT_SIZE, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::INVALID_SHARED_MEMORY_REFERENCE, net_http::HTTPStatusCode::BAD_REQUEST},
 
     // Deserialization
 
     // Should never occur - ModelInstance::validate takes care of that
     {StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION, net_http::HTTPStatusCode::ERROR},
     {StatusCode::OV_INTERNAL_DESERIALIZATION_ERROR, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::MALFORMED_REQUEST_MESSAGE, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::CHUNKED_REQUEST_TOO_LARGE, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::IMAGE_DECODING_FAILED, net_http::HTTPStatusCode::BAD_REQUEST},
 
     // Inference
     {StatusCode::OV_INTERNAL_INFERENCE_ERROR, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::DEADLINE_EXCEEDED, net_http::HTTPStatusCode::REQUEST_TO},
+    {StatusCode::TOO_MANY_PENDING_REQUESTS, net_http::HTTPStatusCode::TOO_MANY_REQUESTS},
+    {StatusCode::SERVER_SATURATED, net_http::HTTPStatusCode::SERVICE_UNAV},
+    {StatusCode::CORE_MODELS_NOT_READY, net_http::HTTPStatusCode::SERVICE_UNAV},
+
+    // Shared memory
+    {StatusCode::SHM_REGION_ALREADY_REGISTERED, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::SHM_REGION_NAME_RESERVED, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::SHM_REGION_NOT_REGISTERED, net_http::HTTPStatusCode::NOT_FOUND},
+    {StatusCode::SHM_REGION_MAPPING_FAILED, net_http::HTTPStatusCode::PRECOND_FAILED},
+
+    // Bulk inference jobs
+    {StatusCode::BULK_JOBS_DISABLED, net_http::HTTPStatusCode::PRECOND_FAILED},
+    {StatusCode::BULK_JOB_NOT_FOUND, net_http::HTTPStatusCode::NOT_FOUND},
+    {StatusCode::BULK_JOB_FINISHED, net_http::HTTPStatusCode::PRECOND_FAILED},
+    {StatusCode::BULK_JOB_NO_SHARDS, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT, net_http::HTTPStatusCode::FORBIDDEN},
+
+    // Admin API
+    {StatusCode::ADMIN_API_DISABLED, net_http::HTTPStatusCode::NOT_FOUND},
+    {StatusCode::ADMIN_UNAUTHORIZED, net_http::HTTPStatusCode::UNAUTHORIZED},
+    {StatusCode::PROFILE_OPTIONS_INVALID, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::PROFILER_BUSY, net_http::HTTPStatusCode::CONFLICT},
+    {StatusCode::PROFILER_START_FAILED, net_http::HTTPStatusCode::ERROR},
+
+    // Sequences of stateful models
+    {StatusCode::SEQUENCE_ID_NOT_PROVIDED, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::SEQUENCE_MISSING, net_http::HTTPStatusCode::NOT_FOUND},
+    {StatusCode::SEQUENCE_ALREADY_EXISTS, net_http::HTTPStatusCode::CONFLICT},
+    {StatusCode::MAX_SEQUENCE_NUMBER_REACHED, net_http::HTTPStatusCode::SERVICE_UNAV},
+    {StatusCode::INVALID_SEQUENCE_CONTROL_INPUT, net_http::HTTPStatusCode::BAD_REQUEST},
+    {StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT, net_http::HTTPStatusCode::BAD_REQUEST},
 
     // Serialization
 
@@ -284,6 +444,109 @@ const std::map<const StatusCode, net_http::HTTPStatusCode> Status::httpStatusMap
 
     // GetModelStatus
     {StatusCode::INTERNAL_ERROR, net_http::HTTPStatusCode::ERROR},
+
+    // Custom Node
+    {StatusCode::NODE_LIBRARY_EXECUTION_FAILED, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::NODE_LIBRARY_OUTPUTS_CORRUPTED, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::NODE_LIBRARY_INVALID_PRECISION, net_http::HTTPStatusCode::ERROR},
+    {StatusCode::NODE_LIBRARY_MISSING_OUTPUT, net_http::HTTPStatusCode::ERROR},
 };
 
+namespace {
+
+const std::string unknownErrorMessage = "Unknown error";
+
+// Interned messages are never released so that statuses can point to them, sharding keeps concurrent rejections from contending
+class InternedMessages {
+    static constexpr size_t SHARDS_COUNT = 16;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<std::string> messages;
+    };
+
+    std::array<Shard, SHARDS_COUNT> shards;
+    std::atomic<size_t> count{0};
+
+public:
+    const std::string* intern(const std::string& message, size_t limit) {
+        auto& shard = shards[std::hash<std::string>()(message) % SHARDS_COUNT];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.messages.find(message);
+        if (it != shard.messages.end()) {
+            return &*it;
+        }
+        if (count.load(std::memory_order_relaxed) >= limit) {
+            return nullptr;
+        }
+        count.fetch_add(1, std::memory_order_relaxed);
+        return &*shard.messages.insert(message).first;
+    }
+
+    size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+};
+
+InternedMessages& internedMessages() {
+    // never destroyed, statuses may be used during static destruction
+    static InternedMessages* messages = new InternedMessages();
+    return *messages;
+}
+
+}  // namespace
+
+const std::string& Status::codeMessage(StatusCode code) {
+    auto it = statusMessageMap.find(code);
+    if (it != statusMessageMap.end())
+        return it->second;
+    return unknownErrorMessage;
+}
+
+const std::string* Status::internMessage(StatusCode code, const std::string& details) {
+    thread_local std::string message;
+    message = codeMessage(code);
+    message += " - ";
+    message += details;
+    return internedMessages().intern(message, MAX_INTERNED_MESSAGES);
+}
+
+void Status::appendDetailsText(std::string& details, const char* text, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (text[i] != VALUE_PLACEHOLDER) {
+            details += text[i];
+        }
+    }
+}
+
+std::string Status::formatMessage() const {
+    std::string formatted;
+    formatted.reserve(message->size() + valuesCount * 20);
+    size_t value = 0;
+    for (char c : *message) {
+        if (c != VALUE_PLACEHOLDER || value == valuesCount) {
+            formatted += c;
+            continue;
+        }
+        char buffer[24];
+        if (signedValues & (1 << value)) {
+            std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(static_cast<int64_t>(values[value])));
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(values[value]));
+        }
+        formatted += buffer;
+        value++;
+    }
+    return formatted;
+}
+
+std::string& Status::detailsBuffer() {
+    thread_local std::string details;
+    return details;
+}
+
+size_t Status::internedMessagesCount() {
+    return internedMessages().size();
+}
+
 }  // namespace ovms
@@ -15,8 +15,11 @@
 //*****************************************************************************
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
 #include <map>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include <grpcpp/server_context.h>
@@ -37,11 +40,13 @@ enum class StatusCode {
     FILE_INVALID,     /*!< File not found or cannot open */
     FILESYSTEM_ERROR, /*!< Underlaying filesystem error */
     NETWORK_NOT_LOADED,
+    MODELS_MEMORY_BUDGET_EXCEEDED, /*!< Loading model version would exceed memory budget of models */
     JSON_INVALID,             /*!< The file/content is not valid json */
     JSON_SERIALIZATION_ERROR, /*!< Data serialization to json format failed */
     MODELINSTANCE_NOT_FOUND,
     SHAPE_WRONG_FORMAT,                   /*!< The provided shape param is in wrong format */
     PLUGIN_CONFIG_WRONG_FORMAT,           /*!< Plugin config is in wrong format */
+    CPU_LIST_WRONG_FORMAT,                /*!< CPU list is in wrong format or contains CPUs not available to the process */
     MODEL_VERSION_POLICY_WRONG_FORMAT,    /*!< Model version policy is in wrong format */
     MODEL_VERSION_POLICY_UNSUPPORTED_KEY, /*!< Model version policy contains invalid key */
     GRPC_CHANNEL_ARG_WRONG_FORMAT,
@@ -52,6 +57,8 @@ enum class StatusCode {
     FORBIDDEN_MODEL_DYNAMIC_PARAMETER,      /*!< Value of the provided param is forbidden */
     ANONYMOUS_FIXED_SHAPE_NOT_ALLOWED,      /*!< Anonymous fixed shape is invalid for models with multiple inputs */
     CONFIG_SHAPE_IS_NOT_IN_NETWORK,         /*!< Invalid shape dimension number or dimension value */
+    OUTPUT_REDUCTION_NAME_COLLISION,        /*!< Indices output of top_k reduction has the name of another model output */
+    OUTPUT_QUANTIZATION_NAME_COLLISION,     /*!< Scale or zero point output of I8 encoded output has the name of another model output */
     CANNOT_LOAD_NETWORK_INTO_TARGET_DEVICE, /*!< Cannot load network into target device */
     REQUESTED_DYNAMIC_PARAMETERS_ON_SUBSCRIBED_MODEL,
 
@@ -62,24 +69,61 @@ enum class StatusCode {
     MODEL_VERSION_NOT_LOADED_ANYMORE, /*!< Model with requested version is retired */
     MODEL_VERSION_NOT_LOADED_YET,     /*!< Model with requested version is not loaded yet */
     INVALID_NIREQ,                    /*!< Invalid NIREQ requested */
+    NIREQ_RESIZE_NOT_SUPPORTED,       /*!< Infer requests of the model cannot be resized at runtime */
 
     // Predict request validation
-    INVALID_NO_OF_INPUTS,           /*!< Invalid number of inputs */
-    INVALID_MISSING_INPUT,          /*!< Missing one or more of inputs */
-    INVALID_MISSING_OUTPUT,         /*!< Missing one or more of outputs */
-    INVALID_NO_OF_SHAPE_DIMENSIONS, /*!< Invalid number of shape dimensions */
-    INVALID_BATCH_SIZE,             /*!< Input batch size other than required */
-    INVALID_SHAPE,                  /*!< Invalid shape dimension number or dimension value */
-    INVALID_PRECISION,              /*!< Invalid precision */
-    INVALID_VALUE_COUNT,            /*!< Invalid value count error status for uint16 and half float data types */
-    INVALID_CONTENT_SIZE,           /*!< Invalid content size error status for types using tensor_content() */
+    INVALID_NO_OF_INPUTS,            /*!< Invalid number of inputs */
+    INVALID_MISSING_INPUT,           /*!< Missing one or more of inputs */
+    INVALID_MISSING_OUTPUT,          /*!< Missing one or more of outputs */
+    INVALID_NO_OF_SHAPE_DIMENSIONS,  /*!< Invalid number of shape dimensions */
+    INVALID_BATCH_SIZE,              /*!< Input batch size other than required */
+    INVALID_SHAPE,                   /*!< Invalid shape dimension number or dimension value */
+    INVALID_PRECISION,               /*!< Invalid precision */
+    INVALID_VALUE_COUNT,             /*!< Invalid value count error status for uint16 and half float data types */
+    INVALID_CONTENT_SIZE,            /*!< Invalid content size error status for types using tensor_content() */
+    INVALID_SHARED_MEMORY_REFERENCE, /*!< Malformed, unknown or out of bounds shared memory region reference */
 
     // Deserialization
     OV_UNSUPPORTED_DESERIALIZATION_PRECISION, /*!< Unsupported deserialization precision, theoretically should never be returned since ModelInstance::validation checks against network precision */
     OV_INTERNAL_DESERIALIZATION_ERROR,        /*!< Error occured during deserialization */
+    MALFORMED_REQUEST_MESSAGE,                /*!< Received request is not a valid protocol buffers message */
+    CHUNKED_REQUEST_TOO_LARGE,                /*!< Streamed inputs of chunked request exceed the size limit */
+    IMAGE_DECODING_FAILED,                    /*!< Encoded image of image input is not a valid JPEG or PNG image */
 
     // Inference
     OV_INTERNAL_INFERENCE_ERROR, /*!< Error occured during inference */
+    DEADLINE_EXCEEDED,           /*!< Request deadline passed before inference was started */
+    TOO_MANY_PENDING_REQUESTS,   /*!< Model pending requests limit reached */
+    SERVER_SATURATED,            /*!< Server saturation is above the threshold, new requests are shed */
+    CORE_MODELS_NOT_READY,       /*!< Some of the models with load priority above 0 have no available version */
+
+    // Shared memory
+    SHM_REGION_ALREADY_REGISTERED, /*!< Shared memory region with the same name is already registered */
+    SHM_REGION_NAME_RESERVED,      /*!< Shared memory region name is reserved for the server */
+    SHM_REGION_NOT_REGISTERED,     /*!< Shared memory region with requested name is not registered */
+    SHM_REGION_MAPPING_FAILED,     /*!< Shared memory object could not be opened or mapped */
+
+    // Bulk inference jobs
+    BULK_JOBS_DISABLED,  /*!< Bulk inference jobs are not enabled on the server */
+    BULK_JOB_NOT_FOUND,  /*!< Bulk inference job with requested id does not exist */
+    BULK_JOB_FINISHED,   /*!< Bulk inference job is already finished */
+    BULK_JOB_NO_SHARDS,  /*!< Input directory of bulk inference job has no .npy shards */
+    BULK_JOB_PATH_OUTSIDE_ROOT,  /*!< Input or output of bulk inference job is outside of bulk jobs root */
+
+    // Admin API
+    ADMIN_API_DISABLED,       /*!< Admin token file is not configured on the server */
+    ADMIN_UNAUTHORIZED,       /*!< Request does not carry a valid admin bearer token */
+    PROFILE_OPTIONS_INVALID,  /*!< Profile duration or frequency is out of the allowed range */
+    PROFILER_BUSY,            /*!< Another CPU profile is already being collected */
+    PROFILER_START_FAILED,    /*!< Profiling signal handler or timer could not be set up */
+
+    // Sequences of stateful models
+    SEQUENCE_ID_NOT_PROVIDED,        /*!< Request to stateful model continues a sequence without giving its id */
+    SEQUENCE_MISSING,                /*!< Sequence with requested id does not exist or has timed out */
+    SEQUENCE_ALREADY_EXISTS,         /*!< Sequence with requested id is already started */
+    MAX_SEQUENCE_NUMBER_REACHED,     /*!< Limit of concurrent sequences of the model version reached */
+    INVALID_SEQUENCE_CONTROL_INPUT,  /*!< Sequence control input value is not one of the supported ones */
+    INVALID_SEQUENCE_SPECIAL_INPUT,  /*!< Sequence id or control input is not a single non-negative integer */
 
     // Serialization
     OV_UNSUPPORTED_SERIALIZATION_PRECISION, /*!< Unsupported serializaton precision */
@@ -155,6 +199,11 @@ enum class StatusCode {
     REST_PROTO_TO_STRING_ERROR,          /*!< Error while parsing ResponseProto to JSON string */
     REST_UNSUPPORTED_PRECISION,          /*!< Unsupported conversion from tensor_content to _val container */
     REST_SERIALIZE_TENSOR_CONTENT_INVALID_SIZE,
+    REST_BINARY_HEADER_INVALID,          /*!< JSON header of binary tensor request is malformed */
+    REST_BINARY_DATA_SIZE_MISMATCH,      /*!< Binary data does not match tensors described in JSON header */
+    RESPONSE_COMPRESSION_FAILED,         /*!< Response body could not be compressed, it is sent uncompressed */
+    REST_INFERENCE_QUEUE_FULL,           /*!< Queue of requests waiting for REST inference worker is full */
+    REST_BATCH_REQUEST_INVALID,          /*!< Batch predict request is not a list of predict requests */
 
     // Pipeline validation errors
     PIPELINE_DEFINITION_ALREADY_EXIST,
@@ -178,6 +227,8 @@ enum class StatusCode {
     PIPELINE_MODEL_INPUT_CONNECTED_TO_MULTIPLE_DATA_SOURCES,
     PIPELINE_EXIT_USED_AS_NODE_DEPENDENCY,
     PIPELINE_NAME_OCCUPIED,
+    PIPELINE_DEFINITION_INVALID_NODE_LIBRARY,
+    PIPELINE_GATE_REFERING_TO_MISSING_INPUT,
 
     // Custom Loader
     CUSTOM_LOADER_LIBRARY_INVALID,
@@ -187,36 +238,116 @@ enum class StatusCode {
     CUSTOM_LOADER_INIT_FAILED,
     CUSTOM_LOADER_ERROR,
 
+    // Custom Node
+    NODE_LIBRARY_ALREADY_LOADED,
+    NODE_LIBRARY_LOAD_FAILED_OPEN,
+    NODE_LIBRARY_LOAD_FAILED_SYM,
+    NODE_LIBRARY_MISSING,
+    NODE_LIBRARY_EXECUTION_FAILED,
+    NODE_LIBRARY_OUTPUTS_CORRUPTED,
+    NODE_LIBRARY_INVALID_PRECISION,
+    NODE_LIBRARY_MISSING_OUTPUT,
+
     STATUS_CODE_END
 };
 
+/**
+ * @brief Result of an operation, a code and a message which can be returned to the client.
+ *
+ * Status is trivially copyable and constructing it from a code neither allocates nor looks up the message,
+ * which is resolved only when requested. Fixed format of details is interned: each distinct format is built
+ * and stored once, so repeatedly rejecting requests for the same reason does not allocate. Integers of details,
+ * such as request batch sizes or sequence ids, are kept in the status and are formatted into the message only
+ * when string() is called, so they do not make formats distinct. When MAX_INTERNED_MESSAGES distinct formats
+ * are stored, details of new ones are dropped and only the code message is reported.
+ */
 class Status {
+public:
+    static constexpr size_t MAX_INTERNED_MESSAGES = 16384;
+    static constexpr size_t MAX_DETAILS_VALUES = 4;
+
+    /**
+     * @brief Stands for an integer of details in interned format, removed from strings of details
+     */
+    static constexpr char VALUE_PLACEHOLDER = '\x1f';
+
+private:
     StatusCode code;
-    std::string message;
+    uint8_t valuesCount = 0;
+    uint8_t signedValues = 0;  // bit of each value which is signed
+    const std::string* message;  // interned message or format with placeholders of values, nullptr when there are no details
+    uint64_t values[MAX_DETAILS_VALUES] = {};
 
     static const std::map<const StatusCode, const std::string> statusMessageMap;
     static const std::map<const StatusCode, grpc::StatusCode> grpcStatusMap;
     static const std::map<const StatusCode, net_http::HTTPStatusCode> httpStatusMap;
 
-    void appendDetails(const std::string& details) {
-        this->message += " - " + details;
+    static const std::string& codeMessage(StatusCode code);
+
+    static const std::string* internMessage(StatusCode code, const std::string& details);
+
+    static std::string& detailsBuffer();
+
+    static void appendDetailsText(std::string& details, const char* text, size_t size);
+
+    std::string formatMessage() const;
+
+    template <typename... Parts>
+    static constexpr size_t countValues() {
+        return (size_t(0) + ... + (std::is_integral<Parts>::value ? 1 : 0));
+    }
+
+    void appendDetailsPart(std::string& details, const std::string& part) {
+        appendDetailsText(details, part.data(), part.size());
+    }
+
+    void appendDetailsPart(std::string& details, const char* part) {
+        appendDetailsText(details, part, std::char_traits<char>::length(part));
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_integral<T>::value> appendDetailsPart(std::string& details, T part) {
+        if (std::is_signed<T>::value) {
+            signedValues |= 1 << valuesCount;
+        }
+        values[valuesCount++] = static_cast<uint64_t>(part);
+        details += VALUE_PLACEHOLDER;
     }
 
 public:
     Status(StatusCode code = StatusCode::OK) :
-        code(code) {
-        auto it = statusMessageMap.find(code);
-        if (it != statusMessageMap.end())
-            this->message = it->second;
-        else
-            this->message = "Unknown error";
-    }
+        code(code),
+        message(nullptr) {}
 
     Status(StatusCode code, const std::string& details) :
-        Status(code) {
-        appendDetails(details);
+        code(code),
+        message(internMessage(code, details)) {}
+
+    /**
+     * @brief Creates status with details concatenated from strings and integers
+     *
+     * Format of details is built in a thread local buffer, no memory is allocated when it was already interned.
+     * Integers are formatted only when the message is requested.
+     */
+    template <typename... Parts>
+    static Status withDetails(StatusCode code, const Parts&... parts) {
+        static_assert(countValues<Parts...>() <= MAX_DETAILS_VALUES, "Too many integers in status details");
+        Status status(code);
+        std::string& details = detailsBuffer();
+        details.clear();
+        (status.appendDetailsPart(details, parts), ...);
+        status.message = internMessage(code, details);
+        if (!status.message) {
+            status.valuesCount = 0;
+        }
+        return status;
     }
 
+    /**
+     * @brief Number of distinct messages and formats of details stored so far
+     */
+    static size_t internedMessagesCount();
+
     bool ok() const {
         return code == StatusCode::OK;
     }
@@ -244,7 +375,7 @@ public:
     const grpc::Status grpc() const {
         auto it = grpcStatusMap.find(code);
         if (it != grpcStatusMap.end()) {
-            return grpc::Status(it->second, this->message);
+            return grpc::Status(it->second, this->string());
         } else {
             return grpc::Status(grpc::StatusCode::UNKNOWN, "Unknown error");
         }
@@ -254,11 +385,17 @@ public:
         return this->grpc();
     }
 
-    const std::string& string() const {
-        return this->message;
+    /**
+     * @brief Builds the message, code message followed by details if there are any
+     */
+    std::string string() const {
+        if (!this->message) {
+            return codeMessage(this->code);
+        }
+        return this->valuesCount == 0 ? *this->message : formatMessage();
     }
 
-    operator const std::string&() const {
+    operator std::string() const {
         return this->string();
     }
 
@@ -272,4 +409,6 @@ public:
     }
 };
 
+static_assert(std::is_trivially_copyable<Status>::value, "Status has to stay cheap to copy");
+
 }  // namespace ovms
@@ -0,0 +1,274 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "streaming_prediction_service.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "deadline.hpp"
+#include "deadlinetimer.hpp"
+#include "model.hpp"
+#include "modelinstance.hpp"
+#include "modelinstanceunloadguard.hpp"
+#include "modelmanager.hpp"
+#include "prediction_service_utils.hpp"
+#include "status.hpp"
+
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+namespace ovms {
+
+namespace {
+/**
+ * @brief State of a single PredictStream call, owned by the thread serving it
+ */
+class PredictStreamCall {
+public:
+    PredictStreamCall(grpc::ServerContext& context, grpc::ServerReaderWriter<PredictStreamResponse, PredictRequest>& stream) :
+        stream(stream),
+        deadline(deadlineFromSystemClock(context.deadline())) {}
+
+    /**
+     * @brief Reads and starts requests until the client closes its side of the stream, then waits for the remaining responses
+     */
+    void run() {
+        std::thread writer(&PredictStreamCall::writeResponses, this);
+        readRequests();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            readingFinished = true;
+        }
+        condition.notify_all();
+        writer.join();
+    }
+
+private:
+    struct Request {
+        PredictRequest request;
+        PredictStreamResponse response;
+        Status status;
+        bool done = false;
+    };
+
+    void readRequests() {
+        ModelManager& manager = ModelManager::getInstance();
+        while (true) {
+            auto request = std::make_unique<Request>();
+            if (!stream.Read(&request->request)) {
+                return;
+            }
+            Request* current = request.get();
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return requests.size() < MAX_PREDICT_STREAM_REQUESTS_IN_FLIGHT || writeFailed; });
+                if (writeFailed) {
+                    return;
+                }
+                requests.push_back(std::move(request));
+            }
+            std::unique_ptr<ModelInstanceUnloadGuard> modelInstanceUnloadGuard;
+            auto status = acquireModelInstance(manager, current->request, modelInstanceUnloadGuard);
+            if (status == StatusCode::MODEL_NAME_MISSING) {
+                SPDLOG_DEBUG("Requested model: {} does not exist. Searching for pipeline with that name...", current->request.model_spec().name());
+                std::unique_ptr<Pipeline> pipelinePtr;
+                status = getPipeline(manager, pipelinePtr, &current->request, current->response.mutable_response());
+                if (status.ok()) {
+                    pipelinePtr->setDeadline(deadline);
+                    status = pipelinePtr->execute();
+                }
+            }
+            if (!status.ok() || !modelInstance) {
+                finishRequest(*current, status);
+                continue;
+            }
+            inferenceAsync(
+                modelInstance, &current->request, current->response.mutable_response(), std::move(modelInstanceUnloadGuard),
+                [this, current](Status status) { finishRequest(*current, status); },
+                deadline);
+        }
+    }
+
+    /**
+     * @brief Reuses model instance of the previous request when model spec did not change and the instance is still available.
+     * Unload guard is taken for each request, so idle stream does not block model reload. Requests for the default version
+     * reuse the instance only while it stays the default one.
+     */
+    Status acquireModelInstance(ModelManager& manager, const PredictRequest& request, std::unique_ptr<ModelInstanceUnloadGuard>& modelInstanceUnloadGuard) {
+        const auto& spec = request.model_spec();
+        if (modelInstance && spec.name() == modelName && spec.version().value() == modelVersion &&
+            (modelVersion != 0 || (model && model->getDefaultVersion() == modelInstance->getVersion()))) {
+            modelInstanceUnloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*modelInstance);
+            if (modelInstance->getStatus().getState() == ModelVersionState::AVAILABLE) {
+                return StatusCode::OK;
+            }
+            modelInstanceUnloadGuard.reset();
+        }
+        modelInstance.reset();
+        modelName = spec.name();
+        modelVersion = spec.version().value();
+        SPDLOG_DEBUG("Resolving model for gRPC stream: {}; version: {}", modelName, modelVersion);
+        model = manager.findModelByName(modelName);
+        auto status = getModelInstance(manager, modelName, modelVersion, modelInstance, modelInstanceUnloadGuard);
+        if (!status.ok()) {
+            modelInstance.reset();
+        }
+        return status;
+    }
+
+    /**
+     * @brief Called from inference callbacks. Notifies under the lock, since the call can be destroyed as soon as
+     * the writer sees the last request done.
+     */
+    void finishRequest(Request& request, const Status& status) {
+        std::lock_guard<std::mutex> lock(mutex);
+        request.status = status;
+        request.done = true;
+        condition.notify_all();
+    }
+
+    void writeResponses() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this] { return (!requests.empty() && requests.front()->done) || (readingFinished && requests.empty()); });
+            if (requests.empty()) {
+                return;
+            }
+            auto request = std::move(requests.front());
+            requests.pop_front();
+            const bool skip = writeFailed;
+            lock.unlock();
+            condition.notify_all();
+            bool written = skip;
+            if (!skip) {
+                if (!request->status.ok()) {
+                    SPDLOG_DEBUG("gRPC stream request failed: {}", request->status.string());
+                    request->response.Clear();
+                    request->response.set_error_message(request->status.string());
+                }
+                written = stream.Write(request->response);
+            }
+            lock.lock();
+            if (!written) {
+                SPDLOG_DEBUG("Writing gRPC stream response failed, client disconnected");
+                writeFailed = true;
+                condition.notify_all();
+            }
+        }
+    }
+
+    grpc::ServerReaderWriter<PredictStreamResponse, PredictRequest>& stream;
+    const deadline_t deadline;
+
+    std::shared_ptr<Model> model;
+    std::shared_ptr<ModelInstance> modelInstance;
+    std::string modelName;
+    model_version_t modelVersion = 0;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    // requests in the order they were read, inference callbacks mark them done
+    std::deque<std::unique_ptr<Request>> requests;
+    bool readingFinished = false;
+    bool writeFailed = false;
+};
+}  // namespace
+
+grpc::Status StreamingPredictionServiceImpl::PredictStream(
+    grpc::ServerContext* context,
+    grpc::ServerReaderWriter<PredictStreamResponse, PredictRequest>* stream) {
+    SPDLOG_DEBUG("gRPC predict stream opened");
+    PredictStreamCall(*context, *stream).run();
+    SPDLOG_DEBUG("gRPC predict stream closed");
+    return grpc::Status::OK;
+}
+
+grpc::Status StreamingPredictionServiceImpl::PredictChunked(
+    grpc::ServerContext* context,
+    grpc::ServerReader<PredictChunk>* reader,
+    PredictResponse* response) {
+    ChunkedPredictRequest chunkedRequest(maxChunkedRequestByteSize, chunkedRequestsBudget);
+    const deadline_t deadline = deadlineFromSystemClock(context->deadline());
+    const deadline_t readDeadline = std::min(deadline, deadlineAfter(chunkedRequestReadTimeout));
+    // blocked Read returns once the call is cancelled
+    std::atomic<bool> readTimedOut{false};
+    DeadlineTimer::timer_id_t readTimer = DeadlineTimer::instance().schedule(readDeadline, [context, &readTimedOut]() {
+        readTimedOut = true;
+        context->TryCancel();
+    });
+    PredictChunk chunk;
+    while (reader->Read(&chunk)) {
+        Status status = StatusCode::OK;
+        if (chunk.has_request()) {
+            status = chunkedRequest.start(std::move(*chunk.mutable_request()));
+        } else if (!chunkedRequest.isStarted()) {
+            status = StatusCode::MALFORMED_REQUEST_MESSAGE;
+        }
+        if (status.ok() && !chunk.data().empty()) {
+            status = chunkedRequest.append(chunk.input_name(), chunk.data());
+        }
+        if (!status.ok()) {
+            DeadlineTimer::instance().cancel(readTimer);
+            SPDLOG_DEBUG("gRPC chunked request rejected: {}", status.string());
+            return status.grpc();
+        }
+        chunk.Clear();
+    }
+    DeadlineTimer::instance().cancel(readTimer);
+    if (readTimedOut) {
+        SPDLOG_DEBUG("gRPC chunked request not received within {} ms", chunkedRequestReadTimeout.count());
+        return Status(StatusCode::DEADLINE_EXCEEDED).grpc();
+    }
+    auto status = chunkedRequest.finish();
+    if (!status.ok()) {
+        return status.grpc();
+    }
+    const auto& request = chunkedRequest.getRequest();
+    SPDLOG_DEBUG("Received gRPC chunked request for model: {}; version: {}; streamed bytes: {}",
+        request.model_spec().name(), request.model_spec().version().value(), chunkedRequest.getStreamedByteSize());
+
+    ModelManager& manager = ModelManager::getInstance();
+    std::shared_ptr<ModelInstance> modelInstance;
+    std::unique_ptr<ModelInstanceUnloadGuard> modelInstanceUnloadGuard;
+    std::unique_ptr<Pipeline> pipelinePtr;
+    status = getModelInstance(manager, request.model_spec().name(), request.model_spec().version().value(), modelInstance, modelInstanceUnloadGuard);
+    if (status == StatusCode::MODEL_NAME_MISSING) {
+        SPDLOG_DEBUG("Requested model: {} does not exist. Searching for pipeline with that name...", request.model_spec().name());
+        status = getPipeline(manager, pipelinePtr, &request, response);
+    }
+    if (!status.ok()) {
+        return status.grpc();
+    }
+    if (pipelinePtr) {
+        pipelinePtr->setDeadline(deadline);
+        status = pipelinePtr->execute();
+    } else {
+        chunkedRequest.copyConvertedInputs(modelInstance->getInputsInfo());
+        status = inference(*modelInstance, &request, response, modelInstanceUnloadGuard, deadline);
+    }
+    return status.grpc();
+}
+
+}  // namespace ovms
@@ -0,0 +1,80 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <grpcpp/server_context.h>
+
+#include "chunkedpredictrequest.hpp"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "src/streaming_prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+namespace ovms {
+
+/**
+ * @brief Maximum number of requests of a single stream inferred at once, further requests are read when the oldest one is responded
+ */
+const size_t MAX_PREDICT_STREAM_REQUESTS_IN_FLIGHT = 32;
+
+/**
+ * @brief Serves Predict requests sent over a bidirectional stream, e.g. consecutive video frames, and requests with inputs sent in chunks
+ *
+ * Model instance is resolved once and reused by next requests with the same model spec, as long as it stays available
+ * and, for requests without version, stays the default version.
+ * Requests are inferred concurrently as they are read and responses are written in the order of requests by a separate thread.
+ * Failed request is responded with error message and does not close the stream.
+ */
+class StreamingPredictionServiceImpl final : public StreamingPredictionService::Service {
+public:
+    /**
+     * @param maxChunkedRequestByteSize limit of summed size of streamed inputs of PredictChunked request
+     * @param chunkedRequestsBudgetByteSize limit of memory of streamed inputs of all PredictChunked requests received at once
+     * @param chunkedRequestReadTimeout time to receive all chunks of PredictChunked request
+     */
+    explicit StreamingPredictionServiceImpl(size_t maxChunkedRequestByteSize = DEFAULT_CHUNKED_REQUEST_MAX_MB * 1024 * 1024,
+        size_t chunkedRequestsBudgetByteSize = DEFAULT_CHUNKED_REQUESTS_BUDGET_MB * 1024 * 1024,
+        std::chrono::milliseconds chunkedRequestReadTimeout = DEFAULT_CHUNKED_REQUEST_READ_TIMEOUT) :
+        maxChunkedRequestByteSize(maxChunkedRequestByteSize),
+        chunkedRequestsBudget(std::make_shared<ChunkedRequestsBudget>(chunkedRequestsBudgetByteSize)),
+        chunkedRequestReadTimeout(chunkedRequestReadTimeout) {}
+
+    grpc::Status PredictStream(
+        grpc::ServerContext* context,
+        grpc::ServerReaderWriter<PredictStreamResponse, tensorflow::serving::PredictRequest>* stream) override;
+
+    /**
+     * @brief Copies chunks into inputs allocated from the request of the first chunk and infers the request once the client closes the stream
+     *
+     * Call is cancelled when the chunks are not received within the read timeout or the client deadline, whichever is earlier.
+     */
+    grpc::Status PredictChunked(
+        grpc::ServerContext* context,
+        grpc::ServerReader<PredictChunk>* reader,
+        tensorflow::serving::PredictResponse* response) override;
+
+    const ChunkedRequestsBudget& getChunkedRequestsBudget() const {
+        return *chunkedRequestsBudget;
+    }
+
+private:
+    const size_t maxChunkedRequestByteSize;
+    const std::shared_ptr<ChunkedRequestsBudget> chunkedRequestsBudget;
+    const std::chrono::milliseconds chunkedRequestReadTimeout;
+};
+
+}  // namespace ovms
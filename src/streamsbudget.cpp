@@ -0,0 +1,162 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "streamsbudget.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+// versions using most of their streams are treated as saturated even without waiting requests
+const double SATURATED_STREAMS_RATIO = 0.9;
+
+StreamsBudget& StreamsBudget::instance() {
+    static StreamsBudget instance;
+    return instance;
+}
+
+void StreamsBudget::configure(uint32_t streams) {
+    std::lock_guard<std::mutex> lock(mtx);
+    this->streams = streams;
+    lastRebalance.reset();
+    lastStreamHoldMicroseconds.clear();
+    assignments.clear();
+    if (streams > 0) {
+        SPDLOG_INFO("CPU streams of models are rebalanced within budget of {} streams", streams);
+    }
+}
+
+bool StreamsBudget::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return streams > 0;
+}
+
+uint32_t StreamsBudget::getStreamsCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return streams;
+}
+
+std::vector<uint32_t> StreamsBudget::distribute(uint32_t budget, const std::vector<double>& demands) {
+    std::vector<uint32_t> result(demands.size(), 1);
+    if (budget <= demands.size()) {
+        return result;
+    }
+    const double totalDemand = std::accumulate(demands.begin(), demands.end(), 0.0);
+    if (totalDemand <= 0.0) {
+        return result;
+    }
+    // largest remainder split of streams left after one stream per model
+    const uint32_t spare = budget - static_cast<uint32_t>(demands.size());
+    uint32_t assigned = 0;
+    std::vector<std::pair<double, size_t>> remainders;
+    for (size_t i = 0; i < demands.size(); ++i) {
+        const double share = spare * std::max(demands[i], 0.0) / totalDemand;
+        const auto whole = static_cast<uint32_t>(std::floor(share));
+        result[i] += whole;
+        assigned += whole;
+        remainders.emplace_back(share - whole, i);
+    }
+    std::stable_sort(remainders.begin(), remainders.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+    for (size_t i = 0; assigned < spare && i < remainders.size(); ++i, ++assigned) {
+        result[remainders[i].second]++;
+    }
+    return result;
+}
+
+bool StreamsBudget::isSignificantChange(uint32_t current, uint32_t target) {
+    // at least by half, so alternating between neighbouring values does not recompile networks every cycle
+    return target != current && (2 * static_cast<uint64_t>(target) >= 3 * static_cast<uint64_t>(current) || 3 * static_cast<uint64_t>(target) <= 2 * static_cast<uint64_t>(current));
+}
+
+std::vector<uint32_t> StreamsBudget::rebalance(const std::vector<ModelStreamsLoad>& models, std::chrono::steady_clock::time_point now) {
+    std::vector<uint32_t> result;
+    for (const auto& model : models) {
+        result.push_back(model.streams);
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    const bool measured = lastRebalance.has_value() && now > lastRebalance.value();
+    const double elapsedMicroseconds = measured ? std::chrono::duration<double, std::micro>(now - lastRebalance.value()).count() : 0.0;
+    std::map<std::pair<std::string, model_version_t>, uint64_t> streamHoldMicroseconds;
+    std::vector<double> busyStreams(models.size(), 0.0);
+    std::vector<double> demands(models.size(), 0.0);
+    for (size_t i = 0; i < models.size(); ++i) {
+        const auto& model = models[i];
+        const auto key = std::make_pair(model.name, model.version);
+        streamHoldMicroseconds[key] = model.streamHoldMicroseconds;
+        auto last = lastStreamHoldMicroseconds.find(key);
+        if (!measured || last == lastStreamHoldMicroseconds.end()) {
+            // versions loaded since the previous cycle keep their streams until their load is known
+            demands[i] = model.streams;
+            continue;
+        }
+        // queue recreated by reload counts from zero again
+        const uint64_t held = model.streamHoldMicroseconds >= last->second ? model.streamHoldMicroseconds - last->second : model.streamHoldMicroseconds;
+        busyStreams[i] = held / elapsedMicroseconds;
+        const bool saturated = model.waitingRequests > 0 || busyStreams[i] >= SATURATED_STREAMS_RATIO * model.streams;
+        // load of saturated version is limited by its streams, it is given room to show its real demand
+        demands[i] = saturated ? 2 * std::max(busyStreams[i], static_cast<double>(model.streams)) : busyStreams[i];
+    }
+    lastStreamHoldMicroseconds = std::move(streamHoldMicroseconds);
+    lastRebalance = now;
+    if (measured && streams > 0) {
+        const auto targets = distribute(streams, demands);
+        uint64_t total = 0;
+        for (size_t i = 0; i < models.size(); ++i) {
+            if (isSignificantChange(result[i], targets[i])) {
+                result[i] = targets[i];
+            }
+            total += result[i];
+        }
+        // skipped shrinks leave less room for growing versions, their growth is trimmed to the budget
+        for (size_t i = 0; i < models.size() && total > streams; ++i) {
+            while (total > streams && result[i] > models[i].streams) {
+                result[i]--;
+                total--;
+            }
+        }
+        for (size_t i = 0; i < models.size() && total > streams; ++i) {
+            while (total > streams && result[i] > targets[i]) {
+                result[i]--;
+                total--;
+            }
+        }
+    }
+    assignments.clear();
+    for (size_t i = 0; i < models.size(); ++i) {
+        assignments.push_back(ModelStreamsAssignment{models[i].name, models[i].version, result[i], busyStreams[i]});
+    }
+    return result;
+}
+
+std::vector<ModelStreamsAssignment> StreamsBudget::getAssignments() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return assignments;
+}
+
+uint64_t StreamsBudget::getRebalancesCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return rebalances;
+}
+
+void StreamsBudget::recordRebalance() {
+    std::lock_guard<std::mutex> lock(mtx);
+    rebalances++;
+}
+
+}  // namespace ovms
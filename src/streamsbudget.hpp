@@ -0,0 +1,119 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "model_version_policy.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Load of model version with rebalanced CPU streams, measured on its infer requests queue
+ */
+struct ModelStreamsLoad {
+    std::string name;
+    model_version_t version = 0;
+    uint32_t streams = 0;
+    // total time streams of the current queue were held by inferences
+    uint64_t streamHoldMicroseconds = 0;
+    size_t waitingRequests = 0;
+};
+
+/**
+ * @brief Streams assigned to model version by the latest rebalance
+ */
+struct ModelStreamsAssignment {
+    std::string name;
+    model_version_t version = 0;
+    uint32_t streams = 0;
+    // average number of streams busy since the previous rebalance
+    double busyStreams = 0.0;
+};
+
+/**
+ * @brief Number of CPU streams shared by all model versions loaded without fixed streams and nireq.
+ *
+ * Each watcher cycle the budget is split again by the stream time used by each version since the previous cycle.
+ * Idle versions shrink to a single stream and versions with waiting requests are given room to grow,
+ * changes too small to be worth recompiling the network are skipped.
+ */
+class StreamsBudget {
+public:
+    static StreamsBudget& instance();
+
+    StreamsBudget() = default;
+
+    /**
+     * @brief Sets number of streams of all model versions
+     *
+     * @param streams 0 disables rebalancing, versions are compiled with streams chosen by the plugin
+     */
+    void configure(uint32_t streams);
+
+    bool isEnabled() const;
+
+    uint32_t getStreamsCount() const;
+
+    /**
+     * @brief Computes streams of each model version from its load since the previous call
+     *
+     * @param models versions with rebalanced streams
+     * @param now
+     *
+     * @return std::vector<uint32_t> streams in order of models, the current ones when change is not needed
+     */
+    std::vector<uint32_t> rebalance(const std::vector<ModelStreamsLoad>& models, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    /**
+     * @brief Splits budget proportionally to demands, every model gets at least one stream
+     */
+    static std::vector<uint32_t> distribute(uint32_t budget, const std::vector<double>& demands);
+
+    /**
+     * @brief Checks if change of streams is big enough to recompile the network
+     */
+    static bool isSignificantChange(uint32_t current, uint32_t target);
+
+    std::vector<ModelStreamsAssignment> getAssignments() const;
+
+    /**
+     * @brief Gets number of streams changes of model versions
+     */
+    uint64_t getRebalancesCount() const;
+
+    /**
+     * @brief Counts applied change of streams of model version
+     */
+    void recordRebalance();
+
+private:
+    mutable std::mutex mtx;
+    uint32_t streams = 0;
+    std::optional<std::chrono::steady_clock::time_point> lastRebalance;
+    std::map<std::pair<std::string, model_version_t>, uint64_t> lastStreamHoldMicroseconds;
+    std::vector<ModelStreamsAssignment> assignments;
+    uint64_t rebalances = 0;
+};
+
+}  // namespace ovms
@@ -0,0 +1,295 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "tensorarena.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+
+#include "numa.hpp"
+
+namespace ovms {
+
+namespace {
+constexpr size_t MIN_BLOCK_SIZE = 4096;
+
+/**
+ * @brief Placed in front of every buffer, takes ALIGNMENT bytes so the buffer stays aligned
+ */
+struct BlockHeader {
+    // nullptr for heap allocations
+    void* node;
+    size_t blockSize;
+};
+static_assert(sizeof(BlockHeader) <= TensorArena::ALIGNMENT, "block header has to fit in alignment");
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief Rounds block size up to one of four classes per power of two, blocks of huge page size and above are whole huge pages
+ */
+size_t getSizeClass(size_t size) {
+    if (size <= MIN_BLOCK_SIZE) {
+        return MIN_BLOCK_SIZE;
+    }
+    size_t power = MIN_BLOCK_SIZE;
+    while (power * 2 <= size) {
+        power *= 2;
+    }
+    const size_t sizeClass = roundUp(size, power / 4);
+    return sizeClass >= TensorArena::HUGE_PAGE_SIZE ? roundUp(sizeClass, TensorArena::HUGE_PAGE_SIZE) : sizeClass;
+}
+
+/**
+ * @brief Maps memory aligned to huge page size, size has to be a multiple of it
+ */
+char* mapHugePages(size_t size, bool& hugeTlb) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+        hugeTlb = true;
+        return static_cast<char*>(memory);
+    }
+    hugeTlb = false;
+    // over-allocate to align the mapping, transparent huge pages are used only for aligned ranges
+    memory = mmap(nullptr, size + TensorArena::HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    char* begin = static_cast<char*>(memory);
+    char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(begin), TensorArena::HUGE_PAGE_SIZE));
+    if (aligned > begin) {
+        munmap(begin, aligned - begin);
+    }
+    const size_t tailSize = begin + size + TensorArena::HUGE_PAGE_SIZE - (aligned + size);
+    if (tailSize > 0) {
+        munmap(aligned + size, tailSize);
+    }
+    madvise(aligned, size, MADV_HUGEPAGE);
+    return aligned;
+}
+
+class TensorArenaBlobAllocator : public InferenceEngine::IAllocator {
+public:
+    explicit TensorArenaBlobAllocator(TensorArena& arena) :
+        arena(arena) {}
+
+    void* lock(void* handle, InferenceEngine::LockOp = InferenceEngine::LOCK_FOR_WRITE) noexcept override {
+        return handle;
+    }
+
+    void unlock(void*) noexcept override {}
+
+    void* alloc(size_t size) noexcept override {
+        return arena.allocate(size);
+    }
+
+    bool free(void* handle) noexcept override {
+        arena.deallocate(handle);
+        return true;
+    }
+
+    void Release() noexcept override {}
+
+private:
+    TensorArena& arena;
+};
+}  // namespace
+
+TensorArena& TensorArena::instance() {
+    // never destroyed, blobs released during static destruction still return their buffers to it
+    static TensorArena* instance = new TensorArena();
+    return *instance;
+}
+
+TensorArena::TensorArena() :
+    blobAllocator(std::make_shared<TensorArenaBlobAllocator>(*this)) {
+    for (const auto& [nodeId, cpus] : getNumaNodesCpus()) {
+        nodes.push_back(std::make_unique<Node>());
+        nodes.back()->id = nodeId;
+        nodes.back()->cpus = cpus;
+        nodes.back()->statistics.numaNode = nodeId;
+        nodesById[nodeId] = nodes.back().get();
+    }
+    if (nodes.empty()) {
+        nodes.push_back(std::make_unique<Node>());
+        nodes.back()->id = 0;
+        nodesById[0] = nodes.back().get();
+    }
+}
+
+TensorArena::~TensorArena() {
+    for (auto& node : nodes) {
+        for (const auto& [memory, size] : node->mappings) {
+            munmap(memory, size);
+        }
+    }
+}
+
+void TensorArena::configure(size_t maxReservedBytes) {
+    std::lock_guard<std::mutex> lock(configureMtx);
+    this->maxReservedBytes.store(maxReservedBytes, std::memory_order_relaxed);
+    if (maxReservedBytes == 0) {
+        return;
+    }
+    const size_t pages = maxReservedBytes > reservedBytes ? (maxReservedBytes - reservedBytes) / HUGE_PAGE_SIZE : 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        // earlier nodes get the remainder
+        const size_t nodePages = pages / nodes.size() + (i < pages % nodes.size() ? 1 : 0);
+        if (nodePages == 0) {
+            continue;
+        }
+        Node& node = *nodes[i];
+        auto reserveNodeMemory = [this, &node, nodePages]() { reserve(node, nodePages * HUGE_PAGE_SIZE); };
+        if (node.cpus.empty()) {
+            reserveNodeMemory();
+        } else {
+            runPinnedToCpus(node.cpus, reserveNodeMemory);
+        }
+    }
+    SPDLOG_INFO("Tensor arena enabled with {} bytes reserved on {} NUMA nodes", reservedBytes, nodes.size());
+}
+
+TensorArena::Node& TensorArena::getLocalNode() {
+    if (nodes.size() > 1) {
+        auto it = nodesById.find(getCurrentNumaNode());
+        if (it != nodesById.end()) {
+            return *it->second;
+        }
+    }
+    return *nodes.front();
+}
+
+void TensorArena::reserve(Node& node, size_t size) {
+    bool hugeTlb;
+    char* memory = mapHugePages(size, hugeTlb);
+    if (memory == nullptr) {
+        SPDLOG_WARN("Could not map {} bytes for tensor arena on NUMA node: {}", size, node.id);
+        return;
+    }
+    // faulting pages in from a thread pinned to the node places them on it
+    std::memset(memory, 0, size);
+    reservedBytes += size;
+    std::lock_guard<std::mutex> lock(node.mtx);
+    node.mappings.emplace_back(memory, size);
+    node.regions.emplace_back(memory, size);
+    node.statistics.reservedBytes += size;
+    if (hugeTlb) {
+        node.statistics.hugeTlbBytes += size;
+    }
+}
+
+char* TensorArena::takeFromRegions(Node& node, size_t size) {
+    for (auto it = node.regions.begin(); it != node.regions.end(); ++it) {
+        if (it->second < size) {
+            continue;
+        }
+        char* memory = it->first;
+        it->first += size;
+        it->second -= size;
+        if (it->second == 0) {
+            node.regions.erase(it);
+        }
+        return memory;
+    }
+    return nullptr;
+}
+
+char* TensorArena::allocateBlock(Node& node, size_t blockSize) {
+    std::lock_guard<std::mutex> lock(node.mtx);
+    auto& freeBlocks = node.freeBlocks[blockSize];
+    if (!freeBlocks.empty()) {
+        char* block = freeBlocks.back();
+        freeBlocks.pop_back();
+        node.statistics.allocations++;
+        node.statistics.reusedAllocations++;
+        node.statistics.usedBytes += blockSize;
+        return block;
+    }
+    if (blockSize < HUGE_PAGE_SIZE && node.slabRemaining >= blockSize) {
+        char* block = node.slabCursor;
+        node.slabCursor += blockSize;
+        node.slabRemaining -= blockSize;
+        node.statistics.allocations++;
+        node.statistics.usedBytes += blockSize;
+        return block;
+    }
+    const size_t regionSize = blockSize < HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : blockSize;
+    char* memory = takeFromRegions(node, regionSize);
+    if (memory == nullptr) {
+        return nullptr;
+    }
+    if (blockSize < HUGE_PAGE_SIZE) {
+        // remaining part of the previous slab is too small for this block and is left unused
+        node.slabCursor = memory + blockSize;
+        node.slabRemaining = HUGE_PAGE_SIZE - blockSize;
+    }
+    node.statistics.allocations++;
+    node.statistics.usedBytes += blockSize;
+    return memory;
+}
+
+void* TensorArena::allocate(size_t size) {
+    const size_t blockSize = getSizeClass(size + ALIGNMENT);
+    Node* node = nullptr;
+    char* block = nullptr;
+    if (isEnabled()) {
+        node = &getLocalNode();
+        block = allocateBlock(*node, blockSize);
+    }
+    if (block == nullptr) {
+        node = nullptr;
+        block = static_cast<char*>(std::aligned_alloc(ALIGNMENT, roundUp(size + ALIGNMENT, ALIGNMENT)));
+        if (block == nullptr) {
+            return nullptr;
+        }
+        heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto header = reinterpret_cast<BlockHeader*>(block);
+    header->node = node;
+    header->blockSize = blockSize;
+    return block + ALIGNMENT;
+}
+
+void TensorArena::deallocate(void* buffer) {
+    if (buffer == nullptr) {
+        return;
+    }
+    char* block = static_cast<char*>(buffer) - ALIGNMENT;
+    auto header = reinterpret_cast<BlockHeader*>(block);
+    if (header->node == nullptr) {
+        std::free(block);
+        return;
+    }
+    auto& node = *static_cast<Node*>(header->node);
+    std::lock_guard<std::mutex> lock(node.mtx);
+    node.freeBlocks[header->blockSize].push_back(block);
+    node.statistics.usedBytes -= header->blockSize;
+}
+
+std::vector<TensorArenaStatistics> TensorArena::getStatistics() const {
+    std::vector<TensorArenaStatistics> statistics;
+    for (const auto& node : nodes) {
+        std::lock_guard<std::mutex> lock(node->mtx);
+        statistics.push_back(node->statistics);
+    }
+    return statistics;
+}
+
+}  // namespace ovms
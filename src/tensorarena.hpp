@@ -0,0 +1,158 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+namespace ovms {
+
+/**
+ * @brief Usage of tensor arena memory of a single NUMA node
+ */
+struct TensorArenaStatistics {
+    int numaNode = 0;
+    /**
+     * @brief Memory mapped by the arena, it is kept for reuse after buffers are freed
+     */
+    uint64_t reservedBytes = 0;
+    /**
+     * @brief Part of reserved memory backed by explicitly reserved huge pages, the rest relies on transparent huge pages
+     */
+    uint64_t hugeTlbBytes = 0;
+    /**
+     * @brief Memory of buffers currently in use, rounded up to their size classes
+     */
+    uint64_t usedBytes = 0;
+    uint64_t allocations = 0;
+    /**
+     * @brief Allocations served with buffers freed earlier, without reserving memory
+     */
+    uint64_t reusedAllocations = 0;
+};
+
+/**
+ * @brief Allocates 64 byte aligned tensor buffers from memory mapped in huge pages, separately for each NUMA node.
+ *
+ * Buffers are taken from the node of the cpu the allocating thread runs on. Memory of all nodes is reserved when the arena
+ * is configured, mapped with MAP_HUGETLB when huge pages are reserved on the host, otherwise transparent huge pages are
+ * requested. It is touched by a thread pinned to cpus of its node, so the kernel places it on that node and requests
+ * neither page fault on it nor pay for touching it. Freed buffers are kept in free lists of their size classes and reused,
+ * reserved memory is never returned to the system. When the arena is disabled or memory reserved for the local node
+ * is used up buffers are allocated on the heap with the same alignment.
+ */
+class TensorArena {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+     * @brief Arena shared by blobs of all models, disabled until configured
+     */
+    static TensorArena& instance();
+
+    /**
+     * @brief Creates disabled arena with memory of nodes in NUMA topology of the host, or a single node if topology is not available
+     */
+    TensorArena();
+
+    ~TensorArena();
+
+    TensorArena(const TensorArena&) = delete;
+    TensorArena& operator=(const TensorArena&) = delete;
+
+    /**
+     * @brief Reserves memory of all nodes up to the limit, split evenly between nodes in whole huge pages.
+     * Memory reserved earlier is kept and buffers allocated earlier stay valid. Blocks until memory is touched,
+     * so it is meant to be called at startup.
+     *
+     * @param maxReservedBytes 0 disables the arena
+     */
+    void configure(size_t maxReservedBytes);
+
+    bool isEnabled() const {
+        return maxReservedBytes.load(std::memory_order_relaxed) > 0;
+    }
+
+    /**
+     * @brief Allocates buffer aligned to ALIGNMENT, from the heap when arena cannot serve it
+     *
+     * @return nullptr only if heap allocation fails
+     */
+    void* allocate(size_t size);
+
+    /**
+     * @brief Returns buffer allocated by this arena to its free list or to the heap
+     */
+    void deallocate(void* buffer);
+
+    std::vector<TensorArenaStatistics> getStatistics() const;
+
+    /**
+     * @brief Allocations served from the heap because the arena was disabled or its limit was reached
+     */
+    uint64_t getHeapAllocations() const {
+        return heapAllocations.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Allocator for InferenceEngine blobs, valid as long as the arena
+     */
+    const std::shared_ptr<InferenceEngine::IAllocator>& getBlobAllocator() const {
+        return blobAllocator;
+    }
+
+private:
+    struct Node {
+        int id;
+        std::vector<int> cpus;
+        mutable std::mutex mtx;
+        std::unordered_map<size_t, std::vector<char*>> freeBlocks;
+        char* slabCursor = nullptr;
+        size_t slabRemaining = 0;
+        // reserved ranges not yet carved into blocks, each huge page aligned
+        std::vector<std::pair<char*, size_t>> regions;
+        std::vector<std::pair<void*, size_t>> mappings;
+        TensorArenaStatistics statistics;
+    };
+
+    Node& getLocalNode();
+
+    void reserve(Node& node, size_t size);
+
+    char* takeFromRegions(Node& node, size_t size);
+
+    char* allocateBlock(Node& node, size_t blockSize);
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::map<int, Node*> nodesById;
+    std::mutex configureMtx;
+    std::atomic<size_t> maxReservedBytes{0};
+    size_t reservedBytes = 0;
+    std::atomic<uint64_t> heapAllocations{0};
+    std::shared_ptr<InferenceEngine::IAllocator> blobAllocator;
+};
+
+}  // namespace ovms
@@ -27,9 +27,31 @@
 #pragma GCC diagnostic pop
 
 #include "modelconfig.hpp"
+#include "outputreduction.hpp"
+#include "transposition.hpp"
 
 namespace ovms {
 
+/**
+ * @brief Channel order of images decoded into image input, NONE if input does not accept encoded images
+ */
+enum class ImageColorOrder {
+    NONE,
+    RGB,
+    BGR
+};
+
+/**
+ * @brief Encoding of FP32 output values sent in responses. I8 values are quantized per 0th dimension entry,
+ * with the scale and zero point sent in additional outputs.
+ */
+enum class OutputEncoding {
+    NONE,
+    FP16,
+    BF16,
+    I8
+};
+
 /**
      * @brief Class containing information about the tensor
      */
@@ -60,6 +82,36 @@ protected:
          */
     InferenceEngine::Layout layout;
 
+    /**
+         * @brief Request data is sent in NHWC layout and transposed by the server into NCHW tensor
+         */
+    bool layoutTransposed = false;
+
+    /**
+         * @brief Channel order of encoded images accepted by the input and decoded by the server
+         */
+    ImageColorOrder imageColorOrder = ImageColorOrder::NONE;
+
+    /**
+         * @brief Request data of any height and width is resized by the plugin to the tensor shape
+         */
+    bool resized = false;
+
+    /**
+         * @brief FP16 output is sent as DT_HALF packed in tensor_content instead of being widened to FP32
+         */
+    bool halfPrecisionResponse = false;
+
+    /**
+         * @brief Reduction applied to output before it is sent in predict response
+         */
+    OutputReduction outputReduction;
+
+    /**
+         * @brief Encoding of FP32 output values sent in predict response
+         */
+    OutputEncoding outputEncoding = OutputEncoding::NONE;
+
     /**
          * @brief TensorDesc
          */
@@ -214,6 +266,8 @@ public:
             return "FP32";
         case InferenceEngine::Precision::FP16:
             return "FP16";
+        case InferenceEngine::Precision::BF16:
+            return "BF16";
             // case InferenceEngine::Precision::Q78:   return tensorflow::DataType::
         case InferenceEngine::Precision::I16:
             return "I16";
@@ -357,6 +411,145 @@ public:
         return layout;
     }
 
+    /**
+         * @brief Set if request data in NHWC layout is transposed into NCHW tensor
+         * 
+         * @param transposed
+         */
+    void setLayoutTransposed(bool transposed) {
+        layoutTransposed = transposed;
+    }
+
+    /**
+         * @brief Check if request data in NHWC layout is transposed into NCHW tensor
+         * 
+         * @return bool
+         */
+    bool isLayoutTransposed() const {
+        return layoutTransposed;
+    }
+
+    /**
+         * @brief Set channel order of images decoded from encoded request data
+         * 
+         * @param colorOrder
+         */
+    void setImageColorOrder(ImageColorOrder colorOrder) {
+        imageColorOrder = colorOrder;
+    }
+
+    /**
+         * @brief Get channel order of images decoded from encoded request data
+         * 
+         * @return ImageColorOrder
+         */
+    ImageColorOrder getImageColorOrder() const {
+        return imageColorOrder;
+    }
+
+    /**
+         * @brief Check if input accepts JPEG or PNG encoded images sent as DT_STRING values
+         * 
+         * @return bool
+         */
+    bool isImageInput() const {
+        return imageColorOrder != ImageColorOrder::NONE;
+    }
+
+    /**
+         * @brief Set if request data is resized by the plugin to the tensor shape
+         * 
+         * @param resized
+         */
+    void setResized(bool resized) {
+        this->resized = resized;
+    }
+
+    /**
+         * @brief Check if request data is resized by the plugin to the tensor shape
+         * 
+         * @return bool
+         */
+    bool isResized() const {
+        return resized;
+    }
+
+    /**
+         * @brief Check if request dimension may differ from the tensor shape since it is resized by the plugin
+         * 
+         * @param dimension index in request shape
+         * @return bool
+         */
+    bool isResizedDimension(size_t dimension) const {
+        // dimensions are in NCHW order regardless of the memory layout
+        return resized && (dimension == 2 || dimension == 3);
+    }
+
+    /**
+         * @brief Set if FP16 output is sent as packed half precision values
+         * 
+         * @param halfPrecision
+         */
+    void setHalfPrecisionResponse(bool halfPrecision) {
+        halfPrecisionResponse = halfPrecision;
+    }
+
+    /**
+         * @brief Check if FP16 output is sent as packed half precision values instead of FP32
+         * 
+         * @return bool
+         */
+    bool isHalfPrecisionResponse() const {
+        return halfPrecisionResponse;
+    }
+
+    /**
+         * @brief Set reduction applied to output before it is sent in predict response
+         * 
+         * @param reduction
+         */
+    void setOutputReduction(const OutputReduction& reduction) {
+        outputReduction = reduction;
+    }
+
+    /**
+         * @brief Gets reduction applied to output before it is sent in predict response
+         * 
+         * @return reduction, of NONE type for outputs sent as they are
+         */
+    const OutputReduction& getOutputReduction() const {
+        return outputReduction;
+    }
+
+    bool isReduced() const {
+        return outputReduction.type != OutputReductionType::NONE;
+    }
+
+    /**
+         * @brief Set encoding of FP32 output values sent in predict response
+         * 
+         * @param encoding
+         */
+    void setOutputEncoding(OutputEncoding encoding) {
+        outputEncoding = encoding;
+    }
+
+    /**
+         * @brief Gets encoding of FP32 output values sent in predict response
+         * 
+         * @return encoding, NONE for values sent in network precision
+         */
+    OutputEncoding getOutputEncoding() const {
+        return outputEncoding;
+    }
+
+    /**
+         * @brief Checks if output values are sent quantized to I8 along with their quantization parameters
+         */
+    bool isQuantized() const {
+        return precision == InferenceEngine::Precision::FP32 && outputEncoding == OutputEncoding::I8;
+    }
+
     /**
          * @brief Gets input shape
          *
@@ -366,6 +559,15 @@ public:
         return shape;
     }
 
+    /**
+         * @brief Gets shape expected in requests, in NHWC order if request data is transposed
+         *
+         * @return shape
+         */
+    shape_t getRequestShape() const {
+        return layoutTransposed ? nchwToNhwcShape(shape) : shape;
+    }
+
     /**
          * @brief Get the Tensor Desc object
          * 
@@ -0,0 +1,108 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../adaptivebatchingcontroller.hpp"
+
+using namespace std::chrono_literals;
+
+using ovms::AdaptiveBatchingController;
+
+namespace {
+// arrivals of single sample requests spaced by gap
+void recordArrivals(AdaptiveBatchingController& controller, size_t count, std::chrono::microseconds gap) {
+    auto arrival = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        controller.recordArrival(1, arrival);
+        arrival += gap;
+    }
+}
+
+// batches with inference latency of fixedCost + perSample * batch size, requests observe latency
+void recordBatches(AdaptiveBatchingController& controller, size_t count, uint64_t fixedCost, uint64_t perSample, uint64_t latency) {
+    for (size_t i = 0; i < count; ++i) {
+        const size_t batchSize = 1 + i % 4;
+        controller.recordBatch(batchSize, fixedCost + perSample * batchSize, std::vector<uint64_t>(batchSize, latency));
+    }
+}
+}  // namespace
+
+TEST(AdaptiveBatchingController, NoBatchingBeforeObservations) {
+    AdaptiveBatchingController controller(16, 0us, 10'000us);
+    const auto decision = controller.getDecision();
+    EXPECT_EQ(decision.targetBatchSize, 1);
+    EXPECT_EQ(decision.queueDelay.count(), 0);
+    EXPECT_EQ(decision.headroom, 1.0);
+}
+
+TEST(AdaptiveBatchingController, InferenceLatencyIsFittedLinearly) {
+    AdaptiveBatchingController controller(16, 0us, 10'000us);
+    recordBatches(controller, 20, 1000, 100, 1000);
+    EXPECT_NEAR(controller.predictInferenceMicroseconds(1), 1100, 1);
+    EXPECT_NEAR(controller.predictInferenceMicroseconds(8), 1800, 1);
+}
+
+TEST(AdaptiveBatchingController, SingleBatchSizeIsScaledProportionally) {
+    AdaptiveBatchingController controller(16, 0us, 10'000us);
+    controller.recordBatch(2, 1000, {500, 500});
+    EXPECT_NEAR(controller.predictInferenceMicroseconds(4), 2000, 1);
+}
+
+TEST(AdaptiveBatchingController, HighArrivalRateGrowsBatches) {
+    AdaptiveBatchingController slow(16, 0us, 10'000us);
+    recordArrivals(slow, 100, 2000us);
+    recordBatches(slow, 20, 1000, 100, 1000);
+    AdaptiveBatchingController fast(16, 0us, 10'000us);
+    recordArrivals(fast, 100, 100us);
+    recordBatches(fast, 20, 1000, 100, 1000);
+
+    const auto slowDecision = slow.getDecision();
+    const auto fastDecision = fast.getDecision();
+    EXPECT_NEAR(fastDecision.arrivalRate, 10'000, 100);
+    EXPECT_GT(fastDecision.targetBatchSize, slowDecision.targetBatchSize);
+    EXPECT_EQ(fastDecision.targetBatchSize, 16);
+    // predicted latency of the target batch fits in the SLO
+    EXPECT_LE(fastDecision.queueDelay.count() + 2 * fast.predictInferenceMicroseconds(fastDecision.targetBatchSize), 10'000);
+    EXPECT_EQ(fastDecision.queueDelay.count(), 15 * 100);
+}
+
+TEST(AdaptiveBatchingController, QueueDelayIsBoundedByMaxQueueDelay) {
+    AdaptiveBatchingController controller(16, 500us, 100'000us);
+    recordArrivals(controller, 100, 100us);
+    recordBatches(controller, 20, 1000, 100, 1000);
+    const auto decision = controller.getDecision();
+    EXPECT_EQ(decision.targetBatchSize, 6);
+    EXPECT_LE(decision.queueDelay.count(), 500);
+}
+
+TEST(AdaptiveBatchingController, ExceededSloReducesHeadroomAndBatchSize) {
+    AdaptiveBatchingController controller(16, 0us, 10'000us);
+    recordArrivals(controller, 100, 100us);
+    recordBatches(controller, 20, 1000, 100, 1000);
+    const auto relaxed = controller.getDecision();
+    recordBatches(controller, 200, 1000, 100, 20'000);
+    const auto tight = controller.getDecision();
+    EXPECT_EQ(tight.observedP99Microseconds, 20'000);
+    EXPECT_LT(tight.headroom, relaxed.headroom);
+    EXPECT_LT(tight.targetBatchSize, relaxed.targetBatchSize);
+
+    // headroom recovers once latency is well below the SLO
+    recordBatches(controller, 2000, 1000, 100, 1000);
+    EXPECT_EQ(controller.getDecision().headroom, 1.0);
+}
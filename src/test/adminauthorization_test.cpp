@@ -0,0 +1,55 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../adminauthorization.hpp"
+#include "test_utils.hpp"
+
+using ovms::AdminAuthorization;
+using ovms::StatusCode;
+
+class AdminAuthorizationTest : public TestWithTempDir {};
+
+TEST_F(AdminAuthorizationTest, DisabledWithoutToken) {
+    AdminAuthorization authorization;
+    EXPECT_FALSE(authorization.isEnabled());
+    EXPECT_EQ(authorization.authorize("Bearer "), StatusCode::ADMIN_API_DISABLED);
+}
+
+TEST_F(AdminAuthorizationTest, TokenIsTrimmedAndCompared) {
+    const std::string path = directoryPath + "/token";
+    std::ofstream(path) << "  s3cret\n";
+    AdminAuthorization authorization;
+    ASSERT_EQ(authorization.loadTokenFile(path), StatusCode::OK);
+    EXPECT_TRUE(authorization.isEnabled());
+    EXPECT_EQ(authorization.authorize("Bearer s3cret"), StatusCode::OK);
+    EXPECT_EQ(authorization.authorize("Bearer s3cre"), StatusCode::ADMIN_UNAUTHORIZED);
+    EXPECT_EQ(authorization.authorize("Bearer s3cretx"), StatusCode::ADMIN_UNAUTHORIZED);
+    EXPECT_EQ(authorization.authorize("s3cret"), StatusCode::ADMIN_UNAUTHORIZED);
+    EXPECT_EQ(authorization.authorize(""), StatusCode::ADMIN_UNAUTHORIZED);
+}
+
+TEST_F(AdminAuthorizationTest, MissingOrEmptyTokenFileIsInvalid) {
+    AdminAuthorization authorization;
+    EXPECT_EQ(authorization.loadTokenFile(directoryPath + "/missing"), StatusCode::FILE_INVALID);
+    const std::string path = directoryPath + "/token";
+    std::ofstream(path) << " \n";
+    EXPECT_EQ(authorization.loadTokenFile(path), StatusCode::FILE_INVALID);
+    EXPECT_FALSE(authorization.isEnabled());
+}
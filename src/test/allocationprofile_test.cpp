@@ -0,0 +1,100 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../allocationprofile.hpp"
+
+using ovms::AllocationPhase;
+using ovms::AllocationPhaseGuard;
+using ovms::AllocationProfile;
+
+namespace {
+// keeps the allocation from being optimized away
+void allocate(size_t size) {
+    auto buffer = std::make_unique<std::vector<char>>(size);
+    volatile char* data = buffer->data();
+    data[0] = 1;
+}
+}  // namespace
+
+TEST(AllocationProfile, CountsAllocationsOfCurrentPhase) {
+    const auto before = AllocationProfile::get(AllocationPhase::DESERIALIZE);
+    {
+        AllocationPhaseGuard guard(AllocationPhase::DESERIALIZE);
+        allocate(1000);
+    }
+    const auto after = AllocationProfile::get(AllocationPhase::DESERIALIZE);
+    if (!AllocationProfile::ENABLED) {
+        EXPECT_EQ(after.entries, 0);
+        EXPECT_EQ(after.allocations, 0);
+        return;
+    }
+    EXPECT_EQ(after.entries - before.entries, 1);
+    EXPECT_EQ(after.allocations - before.allocations, 2);
+    EXPECT_GE(after.bytes - before.bytes, 1000);
+}
+
+TEST(AllocationProfile, NestedGuardRestoresOuterPhase) {
+    if (!AllocationProfile::ENABLED) {
+        GTEST_SKIP() << "Built without OVMS_ALLOCATION_PROFILING";
+    }
+    const auto orchestrationBefore = AllocationProfile::get(AllocationPhase::PIPELINE_ORCHESTRATION);
+    const auto validateBefore = AllocationProfile::get(AllocationPhase::VALIDATE);
+    {
+        AllocationPhaseGuard pipelineGuard(AllocationPhase::PIPELINE_ORCHESTRATION);
+        {
+            AllocationPhaseGuard validateGuard(AllocationPhase::VALIDATE);
+            allocate(10);
+            // reentering the same phase is not another entry
+            AllocationPhaseGuard sameGuard(AllocationPhase::VALIDATE);
+        }
+        allocate(10);
+    }
+    const auto orchestrationAfter = AllocationProfile::get(AllocationPhase::PIPELINE_ORCHESTRATION);
+    const auto validateAfter = AllocationProfile::get(AllocationPhase::VALIDATE);
+    EXPECT_EQ(orchestrationAfter.entries - orchestrationBefore.entries, 1);
+    EXPECT_EQ(orchestrationAfter.allocations - orchestrationBefore.allocations, 2);
+    EXPECT_EQ(validateAfter.entries - validateBefore.entries, 1);
+    EXPECT_EQ(validateAfter.allocations - validateBefore.allocations, 2);
+}
+
+TEST(AllocationProfile, SumsCountersOfAllThreads) {
+    if (!AllocationProfile::ENABLED) {
+        GTEST_SKIP() << "Built without OVMS_ALLOCATION_PROFILING";
+    }
+    const auto before = AllocationProfile::get(AllocationPhase::SERIALIZE);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([]() {
+            for (int j = 0; j < 100; ++j) {
+                AllocationPhaseGuard guard(AllocationPhase::SERIALIZE);
+                allocate(100);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto after = AllocationProfile::get(AllocationPhase::SERIALIZE);
+    EXPECT_EQ(after.entries - before.entries, 800);
+    EXPECT_EQ(after.allocations - before.allocations, 1600);
+    EXPECT_EQ(after.bytes - before.bytes, 800 * (100 + sizeof(std::vector<char>)));
+}
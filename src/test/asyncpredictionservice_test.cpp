@@ -0,0 +1,239 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/create_channel.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+#include <gtest/gtest.h>
+
+#include "../async_prediction_service.hpp"
+#include "../inplacerequestparser.hpp"
+#include "../modelmanager.hpp"
+#include "../sharedmemory.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+using tensorflow::serving::PredictionService;
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+// input of the dummy model is reshaped to the size referenced in received messages
+const size_t ZERO_COPY_INPUT_SIZE = MIN_IN_PLACE_TENSOR_BYTE_SIZE / sizeof(float);
+
+static const char* zeroCopyInputsConfig = R"(
+{
+    "model_config_list": [
+        {
+            "config": {
+                "name": "dummy",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 2,
+                "shape": {"b": "(1,16384)"}
+            }
+        }
+    ]
+})";
+
+class AsyncPredictionServiceZeroCopyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(ModelManager::getInstance().startFromFile(createConfigFileWithContent(zeroCopyInputsConfig)), StatusCode::OK);
+        grpc::ServerBuilder builder;
+        handler = std::make_unique<AsyncPredictionHandler>(builder, 1, cpu_list_t{}, true);
+        server = builder.BuildAndStart();
+        ASSERT_NE(server, nullptr);
+        handler->start();
+        stub = PredictionService::NewStub(server->InProcessChannel(grpc::ChannelArguments()));
+    }
+
+    void TearDown() override {
+        if (server) {
+            server->Shutdown();
+        }
+        if (handler) {
+            handler->shutdown();
+        }
+    }
+
+    static PredictRequest prepareRequest(tensorflow::DataType dtype, size_t elementSize) {
+        PredictRequest request;
+        request.mutable_model_spec()->set_name("dummy");
+        auto& input = (*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME];
+        input.set_dtype(dtype);
+        input.mutable_tensor_shape()->add_dim()->set_size(1);
+        input.mutable_tensor_shape()->add_dim()->set_size(ZERO_COPY_INPUT_SIZE);
+        input.mutable_tensor_content()->resize(ZERO_COPY_INPUT_SIZE * elementSize);
+        return request;
+    }
+
+    std::unique_ptr<AsyncPredictionHandler> handler;
+    std::unique_ptr<grpc::Server> server;
+    std::unique_ptr<PredictionService::Stub> stub;
+};
+
+TEST_F(AsyncPredictionServiceZeroCopyTest, LargeInputIsInferredFromReceivedMessage) {
+    auto request = prepareRequest(tensorflow::DataType::DT_FLOAT, sizeof(float));
+    std::vector<float> data(ZERO_COPY_INPUT_SIZE);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<float>(i % 100);
+    }
+    (*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME].mutable_tensor_content()->assign(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    grpc::ClientContext context;
+    PredictResponse response;
+    const auto status = stub->Predict(&context, request, &response);
+    ASSERT_TRUE(status.ok()) << status.error_message();
+    ASSERT_EQ(response.outputs().count(DUMMY_MODEL_OUTPUT_NAME), 1);
+    const auto& content = response.outputs().at(DUMMY_MODEL_OUTPUT_NAME).tensor_content();
+    ASSERT_EQ(content.size(), data.size() * sizeof(float));
+    const float* output = reinterpret_cast<const float*>(content.data());
+    for (size_t i = 0; i < data.size(); i++) {
+        ASSERT_EQ(output[i], data[i] + 1) << i;
+    }
+    EXPECT_EQ(MessageTensorRegistry::getInstance().getTensorsCount(), 0);
+}
+
+TEST_F(AsyncPredictionServiceZeroCopyTest, LargeInputInOtherPrecisionIsValidatedAsCopiedContent) {
+    auto request = prepareRequest(tensorflow::DataType::DT_HALF, sizeof(uint16_t));
+    grpc::ClientContext context;
+    PredictResponse response;
+    const auto status = stub->Predict(&context, request, &response);
+    // same error as without the zero copy, not the one of invalid shared memory reference
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+    EXPECT_NE(status.error_message().find(Status(StatusCode::INVALID_PRECISION).string()), std::string::npos) << status.error_message();
+    EXPECT_EQ(MessageTensorRegistry::getInstance().getTensorsCount(), 0);
+}
+
+static const char* unaryCallsConfig = R"(
+{
+    "model_config_list": [
+        {
+            "config": {
+                "name": "dummy",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 1
+            }
+        }
+    ]
+})";
+
+class AsyncPredictionServiceUnaryCallsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(ModelManager::getInstance().startFromFile(createConfigFileWithContent(unaryCallsConfig)), StatusCode::OK);
+        grpc::ServerBuilder builder;
+        handler = std::make_unique<AsyncPredictionHandler>(builder, 2, cpu_list_t{}, false);
+        server = builder.BuildAndStart();
+        ASSERT_NE(server, nullptr);
+        handler->start();
+        auto channel = server->InProcessChannel(grpc::ChannelArguments());
+        predictionStub = PredictionService::NewStub(channel);
+        modelStub = tensorflow::serving::ModelService::NewStub(channel);
+    }
+
+    void TearDown() override {
+        if (server) {
+            server->Shutdown();
+        }
+        if (handler) {
+            handler->shutdown();
+        }
+    }
+
+    grpc::Status getModelMetadata(const std::string& name, tensorflow::serving::GetModelMetadataResponse& response) {
+        tensorflow::serving::GetModelMetadataRequest request;
+        request.mutable_model_spec()->set_name(name);
+        request.add_metadata_field("signature_def");
+        grpc::ClientContext context;
+        return predictionStub->GetModelMetadata(&context, request, &response);
+    }
+
+    grpc::Status getModelStatus(const std::string& name, tensorflow::serving::GetModelStatusResponse& response) {
+        tensorflow::serving::GetModelStatusRequest request;
+        request.mutable_model_spec()->set_name(name);
+        grpc::ClientContext context;
+        return modelStub->GetModelStatus(&context, request, &response);
+    }
+
+    std::unique_ptr<AsyncPredictionHandler> handler;
+    std::unique_ptr<grpc::Server> server;
+    std::unique_ptr<PredictionService::Stub> predictionStub;
+    std::unique_ptr<tensorflow::serving::ModelService::Stub> modelStub;
+};
+
+TEST_F(AsyncPredictionServiceUnaryCallsTest, ConsecutiveMetadataCallsAreAnswered) {
+    // each answered call requests the next one on its completion queue
+    for (int i = 0; i < 5; ++i) {
+        tensorflow::serving::GetModelMetadataResponse response;
+        const auto status = getModelMetadata("dummy", response);
+        ASSERT_TRUE(status.ok()) << status.error_message();
+        EXPECT_EQ(response.model_spec().name(), "dummy");
+        EXPECT_EQ(response.metadata().count("signature_def"), 1);
+    }
+}
+
+TEST_F(AsyncPredictionServiceUnaryCallsTest, ConsecutiveStatusCallsAreAnswered) {
+    for (int i = 0; i < 5; ++i) {
+        tensorflow::serving::GetModelStatusResponse response;
+        const auto status = getModelStatus("dummy", response);
+        ASSERT_TRUE(status.ok()) << status.error_message();
+        ASSERT_EQ(response.model_version_status_size(), 1);
+        EXPECT_EQ(response.model_version_status(0).state(), tensorflow::serving::ModelVersionStatus_State_AVAILABLE);
+    }
+}
+
+TEST_F(AsyncPredictionServiceUnaryCallsTest, ErrorsOfUnaryCallsAreReturned) {
+    const auto expected = Status(StatusCode::MODEL_NAME_MISSING).grpc();
+    tensorflow::serving::GetModelMetadataResponse metadataResponse;
+    auto status = getModelMetadata("unknown", metadataResponse);
+    EXPECT_EQ(status.error_code(), expected.error_code());
+    EXPECT_EQ(status.error_message(), expected.error_message());
+    tensorflow::serving::GetModelStatusResponse statusResponse;
+    status = getModelStatus("unknown", statusResponse);
+    EXPECT_EQ(status.error_code(), expected.error_code());
+    EXPECT_EQ(status.error_message(), expected.error_message());
+    // failed call does not stop serving the following ones
+    EXPECT_TRUE(getModelStatus("dummy", statusResponse).ok());
+}
+
+TEST_F(AsyncPredictionServiceUnaryCallsTest, ConcurrentCallsAreAnswered) {
+    std::vector<std::thread> clients;
+    std::atomic<int> answered{0};
+    for (int i = 0; i < 8; ++i) {
+        clients.emplace_back([this, i, &answered]() {
+            for (int j = 0; j < 10; ++j) {
+                if (i % 2) {
+                    tensorflow::serving::GetModelStatusResponse response;
+                    answered += getModelStatus("dummy", response).ok();
+                } else {
+                    tensorflow::serving::GetModelMetadataResponse response;
+                    answered += getModelMetadata("dummy", response).ok();
+                }
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    EXPECT_EQ(answered, 80);
+}
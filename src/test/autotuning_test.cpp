@@ -0,0 +1,76 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../autotuning.hpp"
+#include "test_utils.hpp"
+
+using ovms::TuningCandidate;
+using ovms::TuningMeasurement;
+
+TEST(AutoTuning, CandidatesArePowersOf2StreamsUpToCpus) {
+    auto candidates = ovms::getTuningCandidates(6);
+    EXPECT_EQ(candidates, std::vector<TuningCandidate>({{1, 1}, {1, 2}, {2, 2}, {2, 4}, {4, 4}, {4, 8}}));
+    EXPECT_EQ(ovms::getTuningCandidates(0), std::vector<TuningCandidate>({{1, 1}, {1, 2}}));
+}
+
+TEST(AutoTuning, HighestThroughputWithinLatencyTargetIsSelected) {
+    std::vector<TuningMeasurement> measurements{
+        {{1, 1}, 100, 5},
+        {{2, 2}, 180, 8},
+        {{4, 8}, 300, 25}};
+    TuningCandidate selected;
+    ASSERT_TRUE(ovms::selectTuningCandidate(measurements, 10, selected));
+    EXPECT_EQ(selected, TuningCandidate({2, 2}));
+    ASSERT_TRUE(ovms::selectTuningCandidate(measurements, 0, selected));
+    EXPECT_EQ(selected, TuningCandidate({4, 8}));
+}
+
+TEST(AutoTuning, LowestLatencyIsSelectedWhenTargetIsNotMet) {
+    std::vector<TuningMeasurement> measurements{
+        {{2, 2}, 180, 8},
+        {{1, 1}, 100, 5}};
+    TuningCandidate selected;
+    ASSERT_TRUE(ovms::selectTuningCandidate(measurements, 2, selected));
+    EXPECT_EQ(selected, TuningCandidate({1, 1}));
+    EXPECT_FALSE(ovms::selectTuningCandidate({}, 2, selected));
+}
+
+class TuningResultsStoreTest : public TestWithTempDir {};
+
+TEST_F(TuningResultsStoreTest, StoredResultIsLoaded) {
+    ovms::TuningResultsStore store(directoryPath);
+    ASSERT_TRUE(store.isEnabled());
+    TuningCandidate loaded;
+    EXPECT_FALSE(store.load("key", loaded));
+    store.store("key", {4, 8});
+    ASSERT_TRUE(store.load("key", loaded));
+    EXPECT_EQ(loaded, TuningCandidate({4, 8}));
+    EXPECT_FALSE(store.load("other", loaded));
+}
+
+TEST_F(TuningResultsStoreTest, InvalidResultIsIgnored) {
+    ovms::TuningResultsStore store(directoryPath);
+    std::ofstream(store.getResultPath("key")) << "0 abc";
+    TuningCandidate loaded{1, 1};
+    EXPECT_FALSE(store.load("key", loaded));
+    EXPECT_EQ(loaded, TuningCandidate({1, 1}));
+    EXPECT_FALSE(ovms::TuningResultsStore("").isEnabled());
+}
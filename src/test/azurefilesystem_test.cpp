@@ -14,12 +14,24 @@
 // limitations under the License.
 //*****************************************************************************
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "spdlog/spdlog.h"
 
 #include "../azurefilesystem.hpp"
+#include "../azurestorage.hpp"
 #include "gtest/gtest.h"
+#include "test_utils.hpp"
 
 using namespace ovms;
 
@@ -155,3 +167,157 @@ TEST(DISABLED_AzureFileSystem, file_details) {
     check_dir_access(getPrivateDirPath(), fs.get());
 }
 #pragma GCC diagnostic pop
+
+namespace {
+
+// serves ranges of in memory file contents and records which ranges were requested
+class MockAzureStorageServingRanges : public ovms::AzureStorageAdapter {
+public:
+    MockAzureStorageServingRanges(const std::string& contents, const std::string& failingOffsets = "") :
+        contents(contents) {
+        std::stringstream offsets(failingOffsets);
+        uint64_t offset;
+        while (offsets >> offset) {
+            failing.push_back(offset);
+        }
+    }
+
+    ovms::StatusCode downloadFileRange(const std::string& local_path, uint64_t offset, uint64_t length) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ranges.emplace_back(offset, length);
+            running++;
+            maxRunning = std::max(maxRunning, running);
+        }
+        ovms::StatusCode status = ovms::StatusCode::AS_FILE_INVALID;
+        if (std::find(failing.begin(), failing.end(), offset) == failing.end()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            const std::string part = contents.substr(offset, length);
+            status = writeFileRange(local_path, offset, std::vector<uint8_t>(part.begin(), part.end()));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        running--;
+        return status;
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> getRanges() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::sort(ranges.begin(), ranges.end());
+        return ranges;
+    }
+
+    size_t getMaxRunning() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return maxRunning;
+    }
+
+    ovms::StatusCode fileExists(bool* exists) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode isDirectory(bool* is_directory) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode fileModificationTime(int64_t* mtime_ns) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode getDirectoryContents(ovms::files_list_t* contents) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode getDirectorySubdirs(ovms::files_list_t* subdirs) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode getDirectoryFiles(ovms::files_list_t* files) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode readTextFile(std::string* contents) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode downloadFileFolder(const std::string& local_path) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode deleteFileFolder() override { return ovms::StatusCode::OK; }
+    ovms::StatusCode downloadFile(const std::string& local_path) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode downloadFileFolderTo(const std::string& local_path) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode checkPath(const std::string& path) override { return ovms::StatusCode::OK; }
+    ovms::StatusCode getFileProperties(uint64_t* size, std::string* contentMd5) override {
+        *size = contents.size();
+        contentMd5->clear();
+        return ovms::StatusCode::OK;
+    }
+    ovms::StatusCode listFolderFiles(const std::string& local_path, std::vector<std::shared_ptr<ovms::AzureStorageAdapter>>& storages,
+        std::vector<RemoteFile>& files) override {
+        return ovms::StatusCode::OK;
+    }
+
+private:
+    ovms::StatusCode parseFilePath(const std::string& path) override { return ovms::StatusCode::OK; }
+
+    const std::string contents;
+    std::vector<uint64_t> failing;
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    size_t running = 0;
+    size_t maxRunning = 0;
+};
+
+std::string readLocalFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+class AzureStorageDownloadFiles : public TestWithTempDir {
+protected:
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        setenv("AZURE_DOWNLOAD_PART_SIZE_MB", "1", 1);
+    }
+
+    void TearDown() override {
+        unsetenv("AZURE_DOWNLOAD_PART_SIZE_MB");
+        unsetenv("AZURE_DOWNLOAD_CONNECTIONS");
+        TestWithTempDir::TearDown();
+    }
+
+    const uint64_t MB = 1024 * 1024;
+};
+
+}  // namespace
+
+TEST_F(AzureStorageDownloadFiles, FilesAreSplitIntoRangesOfPartSize) {
+    const std::string large(2 * MB + MB / 2, 'l');
+    const std::string small(10, 's');
+    MockAzureStorageServingRanges largeStorage(large);
+    MockAzureStorageServingRanges smallStorage(small);
+    const std::string largePath = directoryPath + "/large.bin";
+    const std::string smallPath = directoryPath + "/small.bin";
+
+    ASSERT_EQ(largeStorage.downloadFiles({{&largeStorage, largePath, large.size(), ""}, {&smallStorage, smallPath, small.size(), ""}}), ovms::StatusCode::OK);
+
+    std::vector<std::pair<uint64_t, uint64_t>> expectedLarge{{0, MB}, {MB, MB}, {2 * MB, MB / 2}};
+    EXPECT_EQ(largeStorage.getRanges(), expectedLarge);
+    std::vector<std::pair<uint64_t, uint64_t>> expectedSmall{{0, small.size()}};
+    EXPECT_EQ(smallStorage.getRanges(), expectedSmall);
+    EXPECT_EQ(readLocalFile(largePath), large);
+    EXPECT_EQ(readLocalFile(smallPath), small);
+}
+
+TEST_F(AzureStorageDownloadFiles, RangesAreDownloadedWithAtMostConfiguredConnections) {
+    std::string contents;
+    for (size_t i = 0; i < 8; ++i) {
+        contents += std::string(MB, 'a' + i);
+    }
+    const std::string path = directoryPath + "/file.bin";
+
+    setenv("AZURE_DOWNLOAD_CONNECTIONS", "1", 1);
+    MockAzureStorageServingRanges serialStorage(contents);
+    ASSERT_EQ(serialStorage.downloadFiles({{&serialStorage, path, contents.size(), ""}}), ovms::StatusCode::OK);
+    EXPECT_EQ(serialStorage.getRanges().size(), 8);
+    EXPECT_EQ(serialStorage.getMaxRunning(), 1);
+    EXPECT_EQ(readLocalFile(path), contents);
+
+    setenv("AZURE_DOWNLOAD_CONNECTIONS", "4", 1);
+    MockAzureStorageServingRanges parallelStorage(contents);
+    ASSERT_EQ(parallelStorage.downloadFiles({{&parallelStorage, path, contents.size(), ""}}), ovms::StatusCode::OK);
+    EXPECT_EQ(parallelStorage.getRanges().size(), 8);
+    EXPECT_LE(parallelStorage.getMaxRunning(), 4);
+    EXPECT_EQ(readLocalFile(path), contents);
+}
+
+TEST_F(AzureStorageDownloadFiles, FailedRangeFailsDownload) {
+    const std::string contents(3 * MB, 'x');
+    MockAzureStorageServingRanges storage(contents, std::to_string(MB));
+    ASSERT_EQ(storage.downloadFiles({{&storage, directoryPath + "/file.bin", contents.size(), ""}}), ovms::StatusCode::AS_FILE_INVALID);
+}
+
+TEST_F(AzureStorageDownloadFiles, EmptyFileIsCreatedWithoutRanges) {
+    MockAzureStorageServingRanges storage("");
+    const std::string path = directoryPath + "/empty.bin";
+    ASSERT_EQ(storage.downloadFiles({{&storage, path, 0, ""}}), ovms::StatusCode::OK);
+    EXPECT_TRUE(storage.getRanges().empty());
+    EXPECT_TRUE(std::filesystem::exists(path));
+    EXPECT_EQ(std::filesystem::file_size(path), 0);
+}
@@ -0,0 +1,198 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../modelinstance.hpp"
+#include "../modelinstanceunloadguard.hpp"
+#include "../numa.hpp"
+#include "../prediction_service_utils.hpp"
+#include "test_utils.hpp"
+
+class BatchSplitTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config = DUMMY_MODEL_CONFIG;
+        config.setBatchingParams("2");
+        config.setBatchSplit(true);
+        config.setNireq(2);
+    }
+
+    // every batch is filled with its index
+    tensorflow::serving::PredictRequest prepareRequest(size_t batchSize) {
+        tensorflow::serving::PredictRequest request;
+        auto& input = (*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME];
+        input.set_dtype(tensorflow::DataType::DT_FLOAT);
+        input.mutable_tensor_shape()->add_dim()->set_size(batchSize);
+        input.mutable_tensor_shape()->add_dim()->set_size(DUMMY_MODEL_INPUT_SIZE);
+        std::vector<float> data;
+        for (size_t i = 0; i < batchSize; i++) {
+            data.insert(data.end(), DUMMY_MODEL_INPUT_SIZE, static_cast<float>(i));
+        }
+        input.mutable_tensor_content()->assign(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+        return request;
+    }
+
+    void checkResponse(const tensorflow::serving::PredictResponse& response, size_t batchSize) {
+        ASSERT_EQ(response.outputs().count(DUMMY_MODEL_OUTPUT_NAME), 1);
+        const auto& output = response.outputs().at(DUMMY_MODEL_OUTPUT_NAME);
+        ASSERT_EQ(output.tensor_shape().dim_size(), 2);
+        EXPECT_EQ(output.tensor_shape().dim(0).size(), batchSize);
+        EXPECT_EQ(output.tensor_shape().dim(1).size(), DUMMY_MODEL_OUTPUT_SIZE);
+        auto values = asVector<float>(output.tensor_content());
+        ASSERT_EQ(values.size(), batchSize * DUMMY_MODEL_OUTPUT_SIZE);
+        for (size_t i = 0; i < batchSize; i++) {
+            EXPECT_EQ(values[i * DUMMY_MODEL_OUTPUT_SIZE], static_cast<float>(i) + 1) << "batch: " << i;
+            EXPECT_EQ(values[(i + 1) * DUMMY_MODEL_OUTPUT_SIZE - 1], static_cast<float>(i) + 1) << "batch: " << i;
+        }
+    }
+
+    ovms::ModelConfig config;
+};
+
+TEST_F(BatchSplitTest, ValidationAcceptsBiggerBatches) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto request = prepareRequest(2);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::OK);
+    EXPECT_FALSE(modelInstance.isBatchSplitRequired(2));
+    request = prepareRequest(5);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::OK);
+    EXPECT_TRUE(modelInstance.isBatchSplitRequired(5));
+    request = prepareRequest(1);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_BATCH_SIZE);
+}
+
+TEST_F(BatchSplitTest, DisabledWithoutConfig) {
+    config.setBatchSplit(false);
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto request = prepareRequest(5);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_BATCH_SIZE);
+    EXPECT_FALSE(modelInstance.isBatchSplitRequired(5));
+}
+
+TEST_F(BatchSplitTest, OutputsOfChunksAreConcatenated) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    // last of the chunks is padded
+    for (size_t batchSize : {4, 5, 7}) {
+        auto request = prepareRequest(batchSize);
+        tensorflow::serving::PredictResponse response;
+        auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance);
+        auto status = ovms::inference(modelInstance, &request, &response, unloadGuard);
+        ASSERT_EQ(status, ovms::StatusCode::OK) << status.string();
+        checkResponse(response, batchSize);
+    }
+}
+
+TEST_F(BatchSplitTest, AsyncInference) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto request = prepareRequest(5);
+    tensorflow::serving::PredictResponse response;
+    std::promise<ovms::Status> finished;
+    ovms::inferenceAsync(std::shared_ptr<ovms::ModelInstance>(&modelInstance, [](ovms::ModelInstance*) {}), &request, &response,
+        std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance), [&finished](ovms::Status status) { finished.set_value(status); });
+    auto status = finished.get_future().get();
+    ASSERT_EQ(status, ovms::StatusCode::OK) << status.string();
+    checkResponse(response, 5);
+}
+
+TEST_F(BatchSplitTest, ChunkInputBlobsAreReused) {
+    config.setNireq(1);
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto& inferRequestsQueue = modelInstance.getInferRequestsQueue();
+    InferenceEngine::Blob::Ptr chunkBlob;
+    for (int i = 0; i < 2; i++) {
+        auto request = prepareRequest(5);
+        tensorflow::serving::PredictResponse response;
+        auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance);
+        auto status = ovms::inference(modelInstance, &request, &response, unloadGuard);
+        ASSERT_EQ(status, ovms::StatusCode::OK) << status.string();
+        checkResponse(response, 5);
+        const auto& chunkBlobs = inferRequestsQueue.getChunkInputBlobs(0);
+        ASSERT_EQ(chunkBlobs.count(DUMMY_MODEL_INPUT_NAME), 1);
+        if (i == 0) {
+            chunkBlob = chunkBlobs.at(DUMMY_MODEL_INPUT_NAME);
+        } else {
+            EXPECT_EQ(chunkBlobs.at(DUMMY_MODEL_INPUT_NAME), chunkBlob);
+        }
+    }
+}
+
+TEST_F(BatchSplitTest, ChunksAreSpreadOverReplicas) {
+    if (ovms::getAllowedCpus().size() < 2) {
+        GTEST_SKIP() << "Replicas on CPU require at least 2 cpus";
+    }
+    config.setNireq(1);
+    config.setReplicasCount(2);
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    const auto inferRequestsQueues = modelInstance.getSplitBatchInferRequestsQueues(ovms::DIRECT_INFER_REQUESTS_POOL);
+    ASSERT_EQ(inferRequestsQueues.size(), 2);
+    auto request = prepareRequest(8);
+    tensorflow::serving::PredictResponse response;
+    auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance);
+    auto status = ovms::inference(modelInstance, &request, &response, unloadGuard);
+    ASSERT_EQ(status, ovms::StatusCode::OK) << status.string();
+    checkResponse(response, 8);
+    // chunk input blob is kept by stream of each queue which inferred a chunk
+    for (auto* inferRequestsQueue : inferRequestsQueues) {
+        EXPECT_EQ(inferRequestsQueue->getChunkInputBlobs(0).count(DUMMY_MODEL_INPUT_NAME), 1);
+    }
+}
+
+TEST_F(BatchSplitTest, SmallerBatchesArePadded) {
+    config.setBatchSplit(false);
+    config.setBatchPadding(true);
+    config.setBatchingParams("4");
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    for (size_t batchSize : {1, 3}) {
+        auto request = prepareRequest(batchSize);
+        EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::OK);
+        EXPECT_TRUE(modelInstance.isBatchPaddingRequired(batchSize));
+        tensorflow::serving::PredictResponse response;
+        auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance);
+        auto status = ovms::inference(modelInstance, &request, &response, unloadGuard);
+        ASSERT_EQ(status, ovms::StatusCode::OK) << status.string();
+        checkResponse(response, batchSize);
+    }
+    auto request = prepareRequest(5);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_BATCH_SIZE);
+}
+
+TEST_F(BatchSplitTest, PaddingWithAutoBatchSizeReloadsOnlyForBiggerBatches) {
+    config.setBatchSplit(false);
+    config.setBatchPadding(true);
+    config.setBatchingParams("auto");
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    const size_t biggerBatchSize = modelInstance.getBatchSize() + 2;
+    auto request = prepareRequest(biggerBatchSize);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::BATCHSIZE_CHANGE_REQUIRED);
+    ASSERT_EQ(modelInstance.reloadModel(config, ovms::DynamicModelParameter(biggerBatchSize)), ovms::StatusCode::OK);
+    ASSERT_EQ(modelInstance.getBatchSize(), biggerBatchSize);
+    request = prepareRequest(1);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::OK);
+    EXPECT_TRUE(modelInstance.isBatchPaddingRequired(1));
+}
@@ -0,0 +1,100 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "../blobpool.hpp"
+#include "fakeremotecontext.hpp"
+
+using ovms::BlobPool;
+
+namespace {
+const InferenceEngine::TensorDesc DESC{InferenceEngine::Precision::FP32, {1, 10}, InferenceEngine::Layout::NC};
+}
+
+TEST(BlobPool, AllocatesBlobWhenPoolIsEmpty) {
+    auto pool = std::make_shared<BlobPool>(2);
+    auto blob = pool->acquire("output", DESC);
+    ASSERT_NE(blob, nullptr);
+    EXPECT_EQ(blob->getTensorDesc(), DESC);
+    EXPECT_EQ(pool->getIdleBlobsCount("output"), 0);
+}
+
+TEST(BlobPool, WrappedBlobIsReturnedOnRelease) {
+    auto pool = std::make_shared<BlobPool>(2);
+    auto original = pool->acquire("output", DESC);
+    auto originalBuffer = original->buffer().as<void*>();
+    auto wrapped = pool->wrap("output", std::move(original));
+    EXPECT_EQ(wrapped->buffer().as<void*>(), originalBuffer);
+    auto sharedByNextNode = wrapped;
+    wrapped.reset();
+    EXPECT_EQ(pool->getIdleBlobsCount("output"), 0);
+    sharedByNextNode.reset();
+    ASSERT_EQ(pool->getIdleBlobsCount("output"), 1);
+    auto reused = pool->acquire("output", DESC);
+    EXPECT_EQ(reused->buffer().as<void*>(), originalBuffer);
+    EXPECT_EQ(pool->getIdleBlobsCount("output"), 0);
+}
+
+TEST(BlobPool, IdleBlobsAreLimited) {
+    auto pool = std::make_shared<BlobPool>(1);
+    pool->wrap("output", pool->acquire("output", DESC)).reset();
+    pool->wrap("output", pool->acquire("output", DESC)).reset();
+    EXPECT_EQ(pool->getIdleBlobsCount("output"), 1);
+}
+
+TEST(BlobPool, BlobsOfOtherShapeAreNotReused) {
+    auto pool = std::make_shared<BlobPool>(2);
+    pool->wrap("output", pool->acquire("output", DESC)).reset();
+    const InferenceEngine::TensorDesc reshaped{InferenceEngine::Precision::FP32, {2, 10}, InferenceEngine::Layout::NC};
+    auto blob = pool->acquire("output", reshaped);
+    EXPECT_EQ(blob->getTensorDesc(), reshaped);
+    EXPECT_EQ(pool->getIdleBlobsCount("output"), 0);
+}
+
+TEST(BlobPool, BlobOutlivesPool) {
+    auto pool = std::make_shared<BlobPool>(2);
+    auto wrapped = pool->wrap("output", pool->acquire("output", DESC));
+    pool.reset();
+    wrapped->buffer().as<float*>()[0] = 1.0;
+    wrapped.reset();
+}
+
+TEST(BlobPool, BlobsAreAllocatedThroughRemoteContext) {
+    auto context = std::make_shared<FakeRemoteContext>();
+    auto pool = std::make_shared<BlobPool>(2, context);
+    auto blob = pool->acquire("output", DESC);
+    ASSERT_NE(blob, nullptr);
+    auto* remoteBlob = blob->as<InferenceEngine::RemoteBlob>();
+    ASSERT_NE(remoteBlob, nullptr);
+    EXPECT_EQ(remoteBlob->getContext(), context);
+    EXPECT_EQ(blob->getTensorDesc(), DESC);
+    EXPECT_EQ(context->createdBlobs, 1);
+    pool->wrap("output", std::move(blob)).reset();
+    ASSERT_EQ(pool->getIdleBlobsCount("output"), 1);
+    auto reused = pool->acquire("output", DESC);
+    EXPECT_NE(reused->as<InferenceEngine::RemoteBlob>(), nullptr);
+    EXPECT_EQ(context->createdBlobs, 1);
+}
+
+TEST(BlobPool, NoBlobIsGivenWhenRemoteContextCannotAllocate) {
+    auto context = std::make_shared<FakeRemoteContext>();
+    context->failing = true;
+    auto pool = std::make_shared<BlobPool>(2, context);
+    EXPECT_EQ(pool->acquire("output", DESC), nullptr);
+    EXPECT_EQ(context->createdBlobs, 0);
+}
@@ -0,0 +1,189 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../bulkinferencejobs.hpp"
+#include "../localfilesystem.hpp"
+#include "../npyfile.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+namespace {
+const std::chrono::milliseconds JOB_TIMEOUT{10000};
+
+class BulkInferenceJobsTest : public TestWithTempDir {
+protected:
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        auto config = DUMMY_MODEL_CONFIG;
+        ASSERT_EQ(manager.reloadModelWithVersions(config), StatusCode::OK);
+        ASSERT_EQ(jobs.configure(true, directoryPath), StatusCode::OK);
+    }
+
+    /**
+     * @brief Writes shard of dummy model input with records filled with their indexes
+     */
+    void writeShard(const std::string& name, size_t records) {
+        tensorflow::TensorProto proto;
+        proto.set_dtype(tensorflow::DataType::DT_FLOAT);
+        proto.mutable_tensor_shape()->add_dim()->set_size(records);
+        proto.mutable_tensor_shape()->add_dim()->set_size(DUMMY_MODEL_INPUT_SIZE);
+        std::vector<float> values;
+        for (size_t i = 0; i < records; ++i) {
+            values.insert(values.end(), DUMMY_MODEL_INPUT_SIZE, static_cast<float>(i));
+        }
+        proto.set_tensor_content(std::string(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float)));
+        std::string content;
+        ASSERT_EQ(serializeNpy(proto, content), StatusCode::OK);
+        ASSERT_EQ(LocalFileSystem().writeFile(directoryPath + "/input/" + name, content), StatusCode::OK);
+    }
+
+    BulkJobSpec createSpec() {
+        BulkJobSpec spec;
+        spec.servableName = "dummy";
+        spec.inputs[DUMMY_MODEL_INPUT_NAME] = directoryPath + "/input";
+        spec.outputPath = directoryPath + "/output";
+        return spec;
+    }
+
+    ConstructorEnabledModelManager manager;
+    BulkInferenceJobs jobs{manager};
+};
+}  // namespace
+
+TEST_F(BulkInferenceJobsTest, ShardsAreInferredAndStored) {
+    writeShard("part-0.npy", 3);
+    writeShard("part-1.npy", 2);
+    uint64_t id = 0;
+    ASSERT_EQ(jobs.submit(createSpec(), id), StatusCode::OK);
+    ASSERT_TRUE(jobs.wait(id, JOB_TIMEOUT));
+    BulkJobStatus status;
+    ASSERT_EQ(jobs.getStatus(id, status), StatusCode::OK);
+    EXPECT_EQ(status.state, BulkJobState::SUCCEEDED) << status.error;
+    EXPECT_EQ(status.shardsTotal, 2u);
+    EXPECT_EQ(status.shardsDone, 2u);
+    EXPECT_EQ(status.recordsDone, 5u);
+    // dummy model has batch size 1
+    EXPECT_EQ(status.batchesDone, 5u);
+
+    tensorflow::TensorProto output;
+    ASSERT_EQ(loadNpyFile(directoryPath + "/output/" + DUMMY_MODEL_OUTPUT_NAME + "/part-0.npy", output), StatusCode::OK);
+    ASSERT_EQ(output.tensor_shape().dim_size(), 2);
+    EXPECT_EQ(output.tensor_shape().dim(0).size(), 3);
+    const auto values = asVector<float>(output.tensor_content());
+    ASSERT_EQ(values.size(), 3u * DUMMY_MODEL_OUTPUT_SIZE);
+    // dummy adds 1 to every value, records keep their order
+    EXPECT_EQ(values.front(), 1.0f);
+    EXPECT_EQ(values.back(), 3.0f);
+    EXPECT_TRUE(std::filesystem::exists(directoryPath + "/output/" + DUMMY_MODEL_OUTPUT_NAME + "/part-1.npy"));
+}
+
+TEST_F(BulkInferenceJobsTest, BatchesInferredInParallelAreWrittenInOrder) {
+    const size_t records = 25;
+    writeShard("part-0.npy", records);
+    auto spec = createSpec();
+    spec.parallelism = 4;
+    uint64_t id = 0;
+    ASSERT_EQ(jobs.submit(spec, id), StatusCode::OK);
+    ASSERT_TRUE(jobs.wait(id, JOB_TIMEOUT));
+    BulkJobStatus status;
+    ASSERT_EQ(jobs.getStatus(id, status), StatusCode::OK);
+    EXPECT_EQ(status.state, BulkJobState::SUCCEEDED) << status.error;
+
+    tensorflow::TensorProto output;
+    ASSERT_EQ(loadNpyFile(directoryPath + "/output/" + DUMMY_MODEL_OUTPUT_NAME + "/part-0.npy", output), StatusCode::OK);
+    ASSERT_EQ(output.tensor_shape().dim_size(), 2);
+    EXPECT_EQ(output.tensor_shape().dim(0).size(), static_cast<int64_t>(records));
+    const auto values = asVector<float>(output.tensor_content());
+    ASSERT_EQ(values.size(), records * DUMMY_MODEL_OUTPUT_SIZE);
+    for (size_t i = 0; i < records; ++i) {
+        EXPECT_EQ(values[i * DUMMY_MODEL_OUTPUT_SIZE], static_cast<float>(i + 1)) << "record: " << i;
+    }
+}
+
+TEST_F(BulkInferenceJobsTest, ShardsWrittenBeforeFailureAreKept) {
+    writeShard("part-0.npy", 3);
+    // shard with other number of columns fails at its first batch, after outputs of part-0 are written
+    tensorflow::TensorProto proto;
+    proto.set_dtype(tensorflow::DataType::DT_FLOAT);
+    proto.mutable_tensor_shape()->add_dim()->set_size(1);
+    proto.mutable_tensor_shape()->add_dim()->set_size(DUMMY_MODEL_INPUT_SIZE + 1);
+    proto.mutable_tensor_content()->assign((DUMMY_MODEL_INPUT_SIZE + 1) * sizeof(float), '\0');
+    std::string content;
+    ASSERT_EQ(serializeNpy(proto, content), StatusCode::OK);
+    ASSERT_EQ(LocalFileSystem().writeFile(directoryPath + "/input/part-1.npy", content), StatusCode::OK);
+    uint64_t id = 0;
+    ASSERT_EQ(jobs.submit(createSpec(), id), StatusCode::OK);
+    ASSERT_TRUE(jobs.wait(id, JOB_TIMEOUT));
+    BulkJobStatus status;
+    ASSERT_EQ(jobs.getStatus(id, status), StatusCode::OK);
+    EXPECT_EQ(status.state, BulkJobState::FAILED);
+    EXPECT_EQ(status.shardsDone, 1u);
+    EXPECT_TRUE(std::filesystem::exists(directoryPath + "/output/" + DUMMY_MODEL_OUTPUT_NAME + "/part-0.npy"));
+    EXPECT_FALSE(std::filesystem::exists(directoryPath + "/output/" + DUMMY_MODEL_OUTPUT_NAME + "/part-1.npy"));
+}
+
+TEST_F(BulkInferenceJobsTest, JobFailsWithoutShardsOrModel) {
+    std::filesystem::create_directories(directoryPath + "/input");
+    uint64_t id = 0;
+    ASSERT_EQ(jobs.submit(createSpec(), id), StatusCode::OK);
+    ASSERT_TRUE(jobs.wait(id, JOB_TIMEOUT));
+    BulkJobStatus status;
+    ASSERT_EQ(jobs.getStatus(id, status), StatusCode::OK);
+    EXPECT_EQ(status.state, BulkJobState::FAILED);
+    EXPECT_FALSE(status.error.empty());
+
+    writeShard("part-0.npy", 1);
+    auto spec = createSpec();
+    spec.servableName = "unknown";
+    ASSERT_EQ(jobs.submit(spec, id), StatusCode::OK);
+    ASSERT_TRUE(jobs.wait(id, JOB_TIMEOUT));
+    ASSERT_EQ(jobs.getStatus(id, status), StatusCode::OK);
+    EXPECT_EQ(status.state, BulkJobState::FAILED);
+    EXPECT_EQ(jobs.cancel(id), StatusCode::BULK_JOB_FINISHED);
+    EXPECT_EQ(jobs.list().size(), 2u);
+}
+
+TEST_F(BulkInferenceJobsTest, SubmissionIsValidated) {
+    uint64_t id = 0;
+    auto spec = createSpec();
+    spec.outputPath = directoryPath + "/../escaped";
+    EXPECT_EQ(jobs.submit(spec, id), StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT);
+    spec.outputPath = "/tmp";
+    EXPECT_EQ(jobs.submit(spec, id), StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT);
+    spec.outputPath = "s3://bucket/output";
+    EXPECT_EQ(jobs.submit(spec, id), StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT);
+    // prefix of the root which is not its subdirectory
+    spec.outputPath = directoryPath + "-sibling";
+    EXPECT_EQ(jobs.submit(spec, id), StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT);
+    std::filesystem::create_directory_symlink("/tmp", directoryPath + "/link");
+    spec = createSpec();
+    spec.inputs[DUMMY_MODEL_INPUT_NAME] = directoryPath + "/link/input";
+    EXPECT_EQ(jobs.submit(spec, id), StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT);
+    spec = createSpec();
+    spec.inputs.clear();
+    EXPECT_EQ(jobs.submit(spec, id), StatusCode::INVALID_NO_OF_INPUTS);
+    EXPECT_EQ(jobs.cancel(12345), StatusCode::BULK_JOB_NOT_FOUND);
+    EXPECT_EQ(jobs.configure(true, ""), StatusCode::PATH_INVALID);
+    ASSERT_EQ(jobs.configure(false, ""), StatusCode::OK);
+    EXPECT_EQ(jobs.submit(createSpec(), id), StatusCode::BULK_JOBS_DISABLED);
+}
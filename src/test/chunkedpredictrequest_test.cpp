@@ -0,0 +1,119 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "../chunkedpredictrequest.hpp"
+#include "../sharedmemory.hpp"
+
+using ovms::ChunkedPredictRequest;
+using ovms::MessageTensorRegistry;
+using ovms::StatusCode;
+using tensorflow::serving::PredictRequest;
+
+namespace {
+const size_t MAX_BYTE_SIZE = 1024;
+
+PredictRequest createHeader(int64_t streamedElements = 32) {
+    PredictRequest request;
+    request.mutable_model_spec()->set_name("dummy");
+    auto& streamed = (*request.mutable_inputs())["streamed"];
+    streamed.set_dtype(tensorflow::DataType::DT_FLOAT);
+    streamed.mutable_tensor_shape()->add_dim()->set_size(1);
+    streamed.mutable_tensor_shape()->add_dim()->set_size(streamedElements);
+    auto& inlined = (*request.mutable_inputs())["inlined"];
+    inlined.set_dtype(tensorflow::DataType::DT_FLOAT);
+    inlined.mutable_tensor_shape()->add_dim()->set_size(2);
+    inlined.set_tensor_content(std::string(2 * sizeof(float), '\x01'));
+    return request;
+}
+}  // namespace
+
+TEST(ChunkedPredictRequest, ChunksAreCopiedIntoStreamedInput) {
+    std::string expected(32 * sizeof(float), '\0');
+    for (size_t i = 0; i < expected.size(); ++i) {
+        expected[i] = static_cast<char>(i);
+    }
+    const tensorflow::TensorProto* streamedProto = nullptr;
+    {
+        ChunkedPredictRequest chunked(MAX_BYTE_SIZE);
+        ASSERT_EQ(chunked.start(createHeader()), StatusCode::OK);
+        EXPECT_EQ(chunked.getStreamedByteSize(), expected.size());
+        EXPECT_EQ(chunked.finish(), StatusCode::INVALID_CONTENT_SIZE);
+        ASSERT_EQ(chunked.append("streamed", expected.substr(0, 50)), StatusCode::OK);
+        ASSERT_EQ(chunked.append("streamed", expected.substr(50)), StatusCode::OK);
+        ASSERT_EQ(chunked.finish(), StatusCode::OK);
+
+        const auto& request = chunked.getRequest();
+        EXPECT_EQ(request.model_spec().name(), "dummy");
+        EXPECT_EQ(request.inputs().at("inlined").tensor_content().size(), 2 * sizeof(float));
+        streamedProto = &request.inputs().at("streamed");
+        ASSERT_TRUE(ovms::isSharedMemoryReference(*streamedProto));
+        EXPECT_EQ(streamedProto->string_val(0), "shm:@message:0:128");
+        std::string copied(expected.size(), '\0');
+        ASSERT_EQ(ovms::copySharedMemoryReference(*streamedProto, copied.data(), copied.size()), StatusCode::OK);
+        EXPECT_EQ(copied, expected);
+        EXPECT_NE(MessageTensorRegistry::getInstance().findRegion(streamedProto), nullptr);
+    }
+    EXPECT_EQ(MessageTensorRegistry::getInstance().findRegion(streamedProto), nullptr);
+}
+
+TEST(ChunkedPredictRequest, InvalidChunksAreRejected) {
+    ChunkedPredictRequest chunked(MAX_BYTE_SIZE);
+    EXPECT_EQ(chunked.finish(), StatusCode::MALFORMED_REQUEST_MESSAGE);
+    ASSERT_EQ(chunked.start(createHeader()), StatusCode::OK);
+    EXPECT_EQ(chunked.start(createHeader()), StatusCode::MALFORMED_REQUEST_MESSAGE);
+    EXPECT_EQ(chunked.append("inlined", "data"), StatusCode::INVALID_MISSING_INPUT);
+    EXPECT_EQ(chunked.append("unknown", "data"), StatusCode::INVALID_MISSING_INPUT);
+    EXPECT_EQ(chunked.append("streamed", std::string(32 * sizeof(float) + 1, '\0')), StatusCode::INVALID_CONTENT_SIZE);
+}
+
+TEST(ChunkedPredictRequest, SizeLimitIsApplied) {
+    ChunkedPredictRequest chunked(MAX_BYTE_SIZE);
+    EXPECT_EQ(chunked.start(createHeader(MAX_BYTE_SIZE / sizeof(float) + 1)), StatusCode::CHUNKED_REQUEST_TOO_LARGE);
+
+    ChunkedPredictRequest overflowing(MAX_BYTE_SIZE);
+    auto header = createHeader();
+    (*header.mutable_inputs())["streamed"].mutable_tensor_shape()->add_dim()->set_size(std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(overflowing.start(std::move(header)), StatusCode::CHUNKED_REQUEST_TOO_LARGE);
+}
+
+TEST(ChunkedPredictRequest, BudgetIsTakenAtFirstChunkAndReleasedWithMemory) {
+    const size_t streamedByteSize = 32 * sizeof(float);
+    auto budget = std::make_shared<ovms::ChunkedRequestsBudget>(streamedByteSize + streamedByteSize / 2);
+    {
+        ChunkedPredictRequest first(MAX_BYTE_SIZE, budget);
+        ASSERT_EQ(first.start(createHeader()), StatusCode::OK);
+        EXPECT_EQ(budget->getReservedByteSize(), 0u);
+        ASSERT_EQ(first.append("streamed", std::string(4, '\0')), StatusCode::OK);
+        EXPECT_EQ(budget->getReservedByteSize(), streamedByteSize);
+
+        ChunkedPredictRequest second(MAX_BYTE_SIZE, budget);
+        ASSERT_EQ(second.start(createHeader()), StatusCode::OK);
+        EXPECT_EQ(second.append("streamed", std::string(4, '\0')), StatusCode::CHUNKED_REQUEST_TOO_LARGE);
+        EXPECT_EQ(budget->getReservedByteSize(), streamedByteSize);
+    }
+    EXPECT_EQ(budget->getReservedByteSize(), 0u);
+}
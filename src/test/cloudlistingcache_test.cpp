@@ -0,0 +1,70 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <set>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../cloudlistingcache.hpp"
+
+using ovms::CloudListingCache;
+
+class CloudListingCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CloudListingCache::instance().store("s3://bucket/models",
+            {"s3://bucket/models/resnet/2/model.bin",
+                "s3://bucket/models/resnet/1/model.xml",
+                "s3://bucket/models/resnet/1/model.bin",
+                "s3://bucket/models/resnet/README",
+                "s3://bucket/models/resnet-int8/1/model.bin"});
+    }
+    void TearDown() override {
+        CloudListingCache::instance().clear();
+    }
+};
+
+TEST_F(CloudListingCacheTest, SubdirsOfModelsUnderListedPrefix) {
+    std::set<std::string> subdirs;
+    ASSERT_TRUE(CloudListingCache::instance().getDirectorySubdirs("s3://bucket/models/resnet", &subdirs));
+    EXPECT_EQ(subdirs, (std::set<std::string>{"1", "2"}));
+    subdirs.clear();
+    ASSERT_TRUE(CloudListingCache::instance().getDirectorySubdirs("s3://bucket/models/resnet-int8/", &subdirs));
+    EXPECT_EQ(subdirs, (std::set<std::string>{"1"}));
+    subdirs.clear();
+    ASSERT_TRUE(CloudListingCache::instance().getDirectorySubdirs("s3://bucket/models/missing", &subdirs));
+    EXPECT_TRUE(subdirs.empty());
+}
+
+TEST_F(CloudListingCacheTest, DirectoriesUnderListedPrefix) {
+    bool isDirectory = false;
+    ASSERT_TRUE(CloudListingCache::instance().isDirectory("s3://bucket/models/resnet", &isDirectory));
+    EXPECT_TRUE(isDirectory);
+    ASSERT_TRUE(CloudListingCache::instance().isDirectory("s3://bucket/models/res", &isDirectory));
+    EXPECT_FALSE(isDirectory);
+    ASSERT_TRUE(CloudListingCache::instance().isDirectory("s3://bucket/models/resnet/README", &isDirectory));
+    EXPECT_FALSE(isDirectory);
+}
+
+TEST_F(CloudListingCacheTest, PathsOutsideOfListingsAreNotAnswered) {
+    bool isDirectory = false;
+    std::set<std::string> subdirs;
+    EXPECT_FALSE(CloudListingCache::instance().isDirectory("s3://bucket/other/resnet", &isDirectory));
+    EXPECT_FALSE(CloudListingCache::instance().getDirectorySubdirs("s3://other/models/resnet", &subdirs));
+    CloudListingCache::instance().clear();
+    EXPECT_FALSE(CloudListingCache::instance().getDirectorySubdirs("s3://bucket/models/resnet", &subdirs));
+    EXPECT_EQ(CloudListingCache::instance().getListingsCount(), 0);
+}
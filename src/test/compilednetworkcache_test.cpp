@@ -0,0 +1,100 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../compilednetworkcache.hpp"
+#include "test_utils.hpp"
+
+using ovms::CompiledNetworkCache;
+
+class CompiledNetworkCacheTest : public TestWithTempDir {
+protected:
+    std::string writeFile(const std::string& name, const std::string& content) {
+        const std::string path = directoryPath + "/" + name;
+        std::ofstream(path, std::ios::binary) << content;
+        return path;
+    }
+};
+
+TEST_F(CompiledNetworkCacheTest, FilesHashDependsOnContent) {
+    auto xml = writeFile("model.xml", "<net/>");
+    auto bin = writeFile("model.bin", "weights");
+    const auto hash = CompiledNetworkCache::hashFiles({xml, bin});
+    ASSERT_EQ(hash.size(), 64);
+    EXPECT_EQ(CompiledNetworkCache::hashFiles({xml, bin}), hash);
+    writeFile("model.bin", "other weights");
+    EXPECT_NE(CompiledNetworkCache::hashFiles({xml, bin}), hash);
+}
+
+TEST_F(CompiledNetworkCacheTest, FilesHashOfMissingFileIsEmpty) {
+    auto xml = writeFile("model.xml", "<net/>");
+    EXPECT_EQ(CompiledNetworkCache::hashFiles({xml, directoryPath + "/missing.bin"}), "");
+}
+
+TEST_F(CompiledNetworkCacheTest, ContentsHashEqualsFilesHash) {
+    const std::string model = "<net/>";
+    const std::string weights = "weights";
+    auto xml = writeFile("model.xml", model);
+    auto bin = writeFile("model.bin", weights);
+    EXPECT_EQ(CompiledNetworkCache::hashContents({&model, &weights}), CompiledNetworkCache::hashFiles({xml, bin}));
+}
+
+TEST_F(CompiledNetworkCacheTest, KeyChangesWithEveryCompilationInput) {
+    const std::string filesHash = "hash";
+    const ovms::plugin_config_t pluginConfig{{"CPU_THROUGHPUT_STREAMS", "2"}};
+    const auto key = CompiledNetworkCache::computeKey(filesHash, "CPU", pluginConfig, "batch:1");
+    EXPECT_EQ(CompiledNetworkCache::computeKey(filesHash, "CPU", pluginConfig, "batch:1"), key);
+    EXPECT_NE(CompiledNetworkCache::computeKey("other", "CPU", pluginConfig, "batch:1"), key);
+    EXPECT_NE(CompiledNetworkCache::computeKey(filesHash, "GPU", pluginConfig, "batch:1"), key);
+    EXPECT_NE(CompiledNetworkCache::computeKey(filesHash, "CPU", {{"CPU_THROUGHPUT_STREAMS", "4"}}, "batch:1"), key);
+    EXPECT_NE(CompiledNetworkCache::computeKey(filesHash, "CPU", pluginConfig, "batch:2"), key);
+    // fields are not simply concatenated
+    EXPECT_NE(CompiledNetworkCache::computeKey(filesHash, "CP", pluginConfig, "Ubatch:1"), key);
+}
+
+TEST_F(CompiledNetworkCacheTest, ConvertedNetworkKeyDependsOnFilesHash) {
+    const auto key = CompiledNetworkCache::computeConvertedNetworkKey("abc");
+    EXPECT_EQ(CompiledNetworkCache::computeConvertedNetworkKey("abc"), key);
+    EXPECT_NE(CompiledNetworkCache::computeConvertedNetworkKey("abd"), key);
+    EXPECT_NE(CompiledNetworkCache::computeKey("abc", "", {}, ""), key);
+}
+
+TEST_F(CompiledNetworkCacheTest, ConvertedNetworkIsCachedOnlyWithBothFiles) {
+    CompiledNetworkCache cache(directoryPath);
+    std::string xmlPath, binPath;
+    cache.getConvertedNetworkPaths("abc", xmlPath, binPath);
+    EXPECT_EQ(xmlPath, directoryPath + "/abc.xml");
+    EXPECT_EQ(binPath, directoryPath + "/abc.bin");
+    EXPECT_FALSE(cache.hasConvertedNetwork("abc"));
+    std::ofstream(binPath) << "weights";
+    EXPECT_FALSE(cache.hasConvertedNetwork("abc"));
+    std::ofstream(xmlPath) << "<net/>";
+    EXPECT_TRUE(cache.hasConvertedNetwork("abc"));
+    cache.removeConvertedNetwork("abc");
+    EXPECT_FALSE(std::filesystem::exists(xmlPath));
+    EXPECT_FALSE(std::filesystem::exists(binPath));
+}
+
+TEST_F(CompiledNetworkCacheTest, DisabledWithoutDirectory) {
+    EXPECT_FALSE(CompiledNetworkCache("").isEnabled());
+    CompiledNetworkCache cache(directoryPath);
+    EXPECT_TRUE(cache.isEnabled());
+    EXPECT_EQ(cache.getNetworkPath("abc"), directoryPath + "/abc.blob");
+}
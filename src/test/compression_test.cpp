@@ -0,0 +1,92 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <string>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include "../compression.hpp"
+
+using ovms::ContentEncoding;
+using ovms::negotiateContentEncoding;
+
+namespace {
+
+std::string decompressGzip(const std::string& compressed, size_t expectedSize) {
+    z_stream stream{};
+    // 15 bits window with 16 added accepts gzip format only
+    EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+    std::string output(expectedSize, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+    EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    output.resize(stream.total_out);
+    inflateEnd(&stream);
+    return output;
+}
+
+}  // namespace
+
+TEST(Compression, NegotiateContentEncoding) {
+    EXPECT_EQ(negotiateContentEncoding(""), ContentEncoding::IDENTITY);
+    EXPECT_EQ(negotiateContentEncoding("identity"), ContentEncoding::IDENTITY);
+    EXPECT_EQ(negotiateContentEncoding("gzip"), ContentEncoding::GZIP);
+    EXPECT_EQ(negotiateContentEncoding("GZip"), ContentEncoding::GZIP);
+    EXPECT_EQ(negotiateContentEncoding("x-gzip"), ContentEncoding::GZIP);
+    EXPECT_EQ(negotiateContentEncoding("deflate, gzip;q=0.5, br"), ContentEncoding::GZIP);
+    EXPECT_EQ(negotiateContentEncoding(" deflate ,  gzip ; q=1.0"), ContentEncoding::GZIP);
+    EXPECT_EQ(negotiateContentEncoding("deflate, br"), ContentEncoding::IDENTITY);
+    EXPECT_EQ(negotiateContentEncoding("gzipped"), ContentEncoding::IDENTITY);
+}
+
+TEST(Compression, NegotiateRejectedContentEncoding) {
+    EXPECT_EQ(negotiateContentEncoding("gzip;q=0"), ContentEncoding::IDENTITY);
+    EXPECT_EQ(negotiateContentEncoding("gzip; Q=0.000"), ContentEncoding::IDENTITY);
+    EXPECT_EQ(negotiateContentEncoding("gzip;q=0.001"), ContentEncoding::GZIP);
+    EXPECT_EQ(negotiateContentEncoding("*"), ContentEncoding::GZIP);
+    EXPECT_EQ(negotiateContentEncoding("*;q=0"), ContentEncoding::IDENTITY);
+    EXPECT_EQ(negotiateContentEncoding("*, gzip;q=0"), ContentEncoding::IDENTITY);
+    EXPECT_EQ(negotiateContentEncoding("*;q=0, gzip"), ContentEncoding::GZIP);
+}
+
+TEST(Compression, IsCompressionRequired) {
+    EXPECT_FALSE(ovms::isCompressionRequired(1000000, 0));
+    EXPECT_FALSE(ovms::isCompressionRequired(1023, 1024));
+    EXPECT_TRUE(ovms::isCompressionRequired(1024, 1024));
+}
+
+TEST(Compression, GzipRoundTrip) {
+    std::string input;
+    for (int i = 0; i < 10000; ++i) {
+        input += "[0.125, 1.5, " + std::to_string(i) + "], ";
+    }
+    std::string compressed;
+    ASSERT_EQ(ovms::compressGzip(input, &compressed), ovms::StatusCode::OK);
+    ASSERT_GE(compressed.size(), 2);
+    EXPECT_EQ(static_cast<unsigned char>(compressed[0]), 0x1f);
+    EXPECT_EQ(static_cast<unsigned char>(compressed[1]), 0x8b);
+    EXPECT_LT(compressed.size(), input.size() / 4);
+    EXPECT_EQ(decompressGzip(compressed, input.size()), input);
+}
+
+TEST(Compression, GzipEmptyInput) {
+    std::string compressed;
+    ASSERT_EQ(ovms::compressGzip("", &compressed), ovms::StatusCode::OK);
+    EXPECT_FALSE(compressed.empty());
+    EXPECT_EQ(decompressGzip(compressed, 0), "");
+}
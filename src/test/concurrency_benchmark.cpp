@@ -0,0 +1,254 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+// Microbenchmarks of contended concurrency primitives, run with: bazel run -c opt //src:ovms_concurrency_benchmark
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+
+#include "../executinstreamidguard.hpp"
+#include "../modelinstance.hpp"
+#include "../modelinstanceunloadguard.hpp"
+#include "../modelmanager.hpp"
+#include "../nodestreamidguard.hpp"
+#include "../ovinferrequestsqueue.hpp"
+#include "../prediction_service_utils.hpp"
+#include "../threadsafequeue.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+namespace {
+const size_t MAX_RECORDED_SAMPLES = 1 << 22;
+
+/**
+ * @brief Acquire latencies of one benchmark thread. Samples of all threads are merged and their percentiles
+ * are reported by the first thread, averaging percentiles of threads would hide the tail of the slowest ones.
+ */
+class LatencyRecorder {
+    std::vector<uint64_t> samples;
+
+    static std::mutex mergedMutex;
+    static std::condition_variable mergedCondition;
+    static std::vector<uint64_t> mergedSamples;
+    static int mergedThreads;
+
+public:
+    explicit LatencyRecorder(const benchmark::State& state) {
+        samples.reserve(std::min<size_t>(state.max_iterations, MAX_RECORDED_SAMPLES));
+    }
+
+    void record(std::chrono::steady_clock::time_point start) {
+        if (samples.size() < MAX_RECORDED_SAMPLES) {
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    void report(benchmark::State& state) {
+        state.SetItemsProcessed(state.iterations());
+        std::unique_lock<std::mutex> lock(mergedMutex);
+        mergedSamples.insert(mergedSamples.end(), samples.begin(), samples.end());
+        mergedThreads++;
+        mergedCondition.notify_all();
+        if (state.thread_index != 0) {
+            return;
+        }
+        mergedCondition.wait(lock, [&state]() { return mergedThreads == state.threads; });
+        std::vector<uint64_t> all;
+        all.swap(mergedSamples);
+        mergedThreads = 0;
+        lock.unlock();
+        if (all.empty()) {
+            return;
+        }
+        std::sort(all.begin(), all.end());
+        auto percentile = [&all](double fraction) {
+            return static_cast<double>(all[std::min(all.size() - 1, static_cast<size_t>(fraction * all.size()))]);
+        };
+        // counters of threads are summed, only the first thread sets them
+        state.counters["acquire_p50_ns"] = percentile(0.5);
+        state.counters["acquire_p90_ns"] = percentile(0.9);
+        state.counters["acquire_p99_ns"] = percentile(0.99);
+        state.counters["acquire_max_ns"] = static_cast<double>(all.back());
+    }
+};
+
+std::mutex LatencyRecorder::mergedMutex;
+std::condition_variable LatencyRecorder::mergedCondition;
+std::vector<uint64_t> LatencyRecorder::mergedSamples;
+int LatencyRecorder::mergedThreads = 0;
+
+/**
+ * @brief Model manager with dummy model of given nireq, shared by benchmark threads
+ *
+ * Infer requests of the dummy model are only acquired and returned, nothing is inferred,
+ * so what is measured is synchronization of the queue and guards.
+ */
+class DummyModelEnvironment {
+public:
+    ConstructorEnabledModelManager manager;
+    std::shared_ptr<ModelInstance> instance;
+
+    explicit DummyModelEnvironment(size_t nireq) {
+        ModelConfig config = DUMMY_MODEL_CONFIG;
+        config.setNireq(nireq);
+        if (!manager.reloadModelWithVersions(config).ok()) {
+            throw std::runtime_error("failed to load dummy model");
+        }
+        instance = manager.findModelInstance(config.getName());
+        if (!instance) {
+            throw std::runtime_error("failed to find dummy model");
+        }
+    }
+
+    OVInferRequestsQueue& getQueue() {
+        return instance->getInferRequestsQueue();
+    }
+
+    static DummyModelEnvironment& get(size_t nireq) {
+        static std::mutex mutex;
+        static std::map<size_t, std::unique_ptr<DummyModelEnvironment>> environments;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& environment = environments[nireq];
+        if (!environment) {
+            environment = std::make_unique<DummyModelEnvironment>(nireq);
+        }
+        return *environment;
+    }
+};
+
+// args: nireq of dummy model
+void nireqs(benchmark::internal::Benchmark* benchmark) {
+    for (int64_t nireq : {1, 8, 128}) {
+        benchmark->Arg(nireq);
+    }
+    benchmark->ArgNames({"nireq"});
+}
+}  // namespace
+
+// Future based acquisition used by synchronous predict paths
+static void BM_InferRequestsQueueGetIdleStream(benchmark::State& state) {
+    auto& queue = DummyModelEnvironment::get(state.range(0)).getQueue();
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        int streamId = queue.getIdleStream().get();
+        latencies.record(start);
+        queue.returnStream(streamId);
+    }
+    latencies.report(state);
+}
+BENCHMARK(BM_InferRequestsQueueGetIdleStream)->Apply(nireqs)->ThreadRange(1, 128)->UseRealTime();
+
+static void BM_ExecutingStreamIdGuard(benchmark::State& state) {
+    auto& queue = DummyModelEnvironment::get(state.range(0)).getQueue();
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        ExecutingStreamIdGuard guard(queue);
+        latencies.record(start);
+        benchmark::DoNotOptimize(guard.getId());
+    }
+    latencies.report(state);
+}
+BENCHMARK(BM_ExecutingStreamIdGuard)->Apply(nireqs)->ThreadRange(1, 128)->UseRealTime();
+
+// Callback based acquisition of pipeline nodes, deferred guard is woken up by the thread returning a stream
+static void BM_NodeStreamIdGuard(benchmark::State& state) {
+    auto& queue = DummyModelEnvironment::get(state.range(0)).getQueue();
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        std::promise<void> assigned;
+        NodeStreamIdGuard guard(queue, [&assigned]() { assigned.set_value(); });
+        if (guard.isDeferred()) {
+            assigned.get_future().wait();
+        }
+        latencies.record(start);
+        benchmark::DoNotOptimize(guard.tryGetId());
+    }
+    latencies.report(state);
+}
+BENCHMARK(BM_NodeStreamIdGuard)->Apply(nireqs)->ThreadRange(1, 128)->UseRealTime();
+
+// Every thread pushes before pulling, so pull never waits for a missing element, only for the lock
+static void BM_ThreadSafeQueuePushPull(benchmark::State& state) {
+    static ThreadSafeQueue<int> queue;
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        queue.push(state.thread_index);
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(queue.pull());
+        latencies.record(start);
+    }
+    latencies.report(state);
+}
+BENCHMARK(BM_ThreadSafeQueuePushPull)->ThreadRange(1, 128)->UseRealTime();
+
+// Name and version lookup taken by every request before the model instance is used
+static void BM_ModelManagerFindModelInstance(benchmark::State& state) {
+    auto& environment = DummyModelEnvironment::get(1);
+    const std::string name = environment.instance->getName();
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        auto instance = environment.manager.findModelInstance(name);
+        latencies.record(start);
+        benchmark::DoNotOptimize(instance);
+    }
+    latencies.report(state);
+}
+BENCHMARK(BM_ModelManagerFindModelInstance)->ThreadRange(1, 128)->UseRealTime();
+
+// Lookup of the model and its default version together with the unload guard, as taken by predict requests
+static void BM_GetModelInstanceWithUnloadGuard(benchmark::State& state) {
+    auto& environment = DummyModelEnvironment::get(1);
+    const std::string name = environment.instance->getName();
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        std::shared_ptr<ModelInstance> instance;
+        std::unique_ptr<ModelInstanceUnloadGuard> unloadGuard;
+        const auto start = std::chrono::steady_clock::now();
+        auto status = getModelInstance(environment.manager, name, 0, instance, unloadGuard);
+        latencies.record(start);
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+    }
+    latencies.report(state);
+}
+BENCHMARK(BM_GetModelInstanceWithUnloadGuard)->ThreadRange(1, 128)->UseRealTime();
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::err);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,144 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../containerlimits.hpp"
+
+using ovms::ContainerLimits;
+
+class ContainerLimitsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root);
+    }
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+    }
+    void writeFile(const std::string& relativePath, const std::string& content) {
+        const std::string path = root + "/" + relativePath;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+        std::ofstream(path) << content;
+    }
+
+    const std::string root = "/tmp/ovms_test_cgroup";
+};
+
+TEST_F(ContainerLimitsTest, CgroupV2QuotaAndMemory) {
+    writeFile("cgroup.controllers", "cpuset cpu io memory pids\n");
+    writeFile("cpu.max", "250000 100000\n");
+    writeFile("memory.max", "4294967296\n");
+    auto limits = ovms::readContainerLimits(root, ovms::CgroupPaths());
+    EXPECT_TRUE(limits.cgroupV2);
+    EXPECT_DOUBLE_EQ(limits.cpuQuota, 2.5);
+    EXPECT_EQ(limits.memoryLimitBytes, 4294967296ull);
+}
+
+TEST_F(ContainerLimitsTest, CgroupV2Unlimited) {
+    writeFile("cgroup.controllers", "cpu memory\n");
+    writeFile("cpu.max", "max 100000\n");
+    writeFile("memory.max", "max\n");
+    auto limits = ovms::readContainerLimits(root, ovms::CgroupPaths());
+    EXPECT_TRUE(limits.cgroupV2);
+    EXPECT_EQ(limits.cpuQuota, 0.0);
+    EXPECT_EQ(limits.memoryLimitBytes, 0u);
+}
+
+TEST_F(ContainerLimitsTest, CgroupV1QuotaAndMemory) {
+    writeFile("cpu,cpuacct/cpu.cfs_quota_us", "400000\n");
+    writeFile("cpu,cpuacct/cpu.cfs_period_us", "100000\n");
+    writeFile("memory/memory.limit_in_bytes", "1073741824\n");
+    auto limits = ovms::readContainerLimits(root, ovms::CgroupPaths());
+    EXPECT_FALSE(limits.cgroupV2);
+    EXPECT_DOUBLE_EQ(limits.cpuQuota, 4.0);
+    EXPECT_EQ(limits.memoryLimitBytes, 1073741824ull);
+}
+
+TEST_F(ContainerLimitsTest, CgroupV1Unlimited) {
+    writeFile("cpu/cpu.cfs_quota_us", "-1\n");
+    writeFile("cpu/cpu.cfs_period_us", "100000\n");
+    writeFile("memory/memory.limit_in_bytes", "9223372036854771712\n");
+    auto limits = ovms::readContainerLimits(root, ovms::CgroupPaths());
+    EXPECT_EQ(limits.cpuQuota, 0.0);
+    EXPECT_EQ(limits.memoryLimitBytes, 0u);
+}
+
+TEST_F(ContainerLimitsTest, MalformedFilesAreIgnored) {
+    writeFile("cgroup.controllers", "cpu memory\n");
+    writeFile("cpu.max", "a lot\n");
+    writeFile("memory.max", "12GB\n");
+    auto limits = ovms::readContainerLimits(root, ovms::CgroupPaths());
+    EXPECT_EQ(limits.cpuQuota, 0.0);
+    EXPECT_EQ(limits.memoryLimitBytes, 0u);
+}
+
+TEST_F(ContainerLimitsTest, CgroupPathsAreReadFromProcCgroupEntries) {
+    writeFile("cgroup", "12:memory:/docker/abc\n4:cpu,cpuacct:/docker/abc/cpu\n1:name=systemd:/docker/abc\n0::/kubepods/pod1\n");
+    auto paths = ovms::readCgroupPaths(root + "/cgroup");
+    EXPECT_EQ(paths.unified, "/kubepods/pod1");
+    EXPECT_EQ(paths.cpu, "/docker/abc/cpu");
+    EXPECT_EQ(paths.memory, "/docker/abc");
+    paths = ovms::readCgroupPaths(root + "/missing");
+    EXPECT_TRUE(paths.unified.empty());
+    EXPECT_TRUE(paths.cpu.empty());
+}
+
+TEST_F(ContainerLimitsTest, CgroupV2LimitsOfProcessCgroupAndAncestorsApply) {
+    writeFile("cgroup.controllers", "cpu memory\n");
+    writeFile("kubepods/cpu.max", "max 100000\n");
+    writeFile("kubepods/memory.max", "2147483648\n");
+    writeFile("kubepods/pod1/cpu.max", "150000 100000\n");
+    writeFile("kubepods/pod1/memory.max", "max\n");
+    ovms::CgroupPaths paths;
+    paths.unified = "/kubepods/pod1";
+    auto limits = ovms::readContainerLimits(root, paths);
+    EXPECT_DOUBLE_EQ(limits.cpuQuota, 1.5);
+    EXPECT_EQ(limits.memoryLimitBytes, 2147483648ull);
+    EXPECT_EQ(limits.cgroupPath, root + "/kubepods/pod1");
+}
+
+TEST_F(ContainerLimitsTest, CgroupPathMissingUnderMountPointFallsBackToRoot) {
+    writeFile("cpu/cpu.cfs_quota_us", "200000\n");
+    writeFile("cpu/cpu.cfs_period_us", "100000\n");
+    ovms::CgroupPaths paths;
+    paths.cpu = "/docker/abc";
+    auto limits = ovms::readContainerLimits(root, paths);
+    EXPECT_FALSE(limits.cgroupV2);
+    EXPECT_DOUBLE_EQ(limits.cpuQuota, 2.0);
+    EXPECT_EQ(limits.cgroupPath, root + "/cpu");
+}
+
+TEST(ContainerLimits, EffectiveCpuCountIsSmallestLimit) {
+    ContainerLimits limits;
+    EXPECT_EQ(ovms::computeEffectiveCpuCount(limits, 96), 96u);
+    limits.cpusetCpus = 16;
+    EXPECT_EQ(ovms::computeEffectiveCpuCount(limits, 96), 16u);
+    limits.cpuQuota = 3.2;
+    EXPECT_EQ(ovms::computeEffectiveCpuCount(limits, 96), 4u);
+    limits.cpuQuota = 0.5;
+    EXPECT_EQ(ovms::computeEffectiveCpuCount(limits, 96), 1u);
+    limits.cpuQuota = 32;
+    EXPECT_EQ(ovms::computeEffectiveCpuCount(limits, 96), 16u);
+}
+
+TEST(ContainerLimits, EffectiveCpuCountIsAtLeastOne) {
+    EXPECT_EQ(ovms::computeEffectiveCpuCount(ContainerLimits(), 0), 1u);
+    EXPECT_GE(ovms::getEffectiveCpuCount(), 1u);
+}
@@ -0,0 +1,71 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <string>
+
+#include <gtest/gtest.h>
+#include <sched.h>
+
+#include "../cpupartitioning.hpp"
+
+using ovms::cpu_list_t;
+using ovms::CpuPartitioning;
+using ovms::StatusCode;
+
+class CpuPartitioningTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        CpuPartitioning::instance().configure("", "");
+    }
+};
+
+TEST_F(CpuPartitioningTest, NotUsedByDefault) {
+    auto& partitioning = CpuPartitioning::instance();
+    ASSERT_EQ(partitioning.configure("", ""), StatusCode::OK);
+    EXPECT_TRUE(partitioning.getNetworkCpus().empty());
+    EXPECT_TRUE(partitioning.getBackgroundCpus().empty());
+    EXPECT_TRUE(partitioning.getInferenceCpus().empty());
+}
+
+TEST_F(CpuPartitioningTest, InferenceUsesRemainingCpus) {
+    const auto allowedCpus = ovms::getAllowedCpus();
+    ASSERT_FALSE(allowedCpus.empty());
+    auto& partitioning = CpuPartitioning::instance();
+    ASSERT_EQ(partitioning.configure(std::to_string(allowedCpus.front()), ""), StatusCode::OK);
+    EXPECT_EQ(partitioning.getNetworkCpus(), cpu_list_t({allowedCpus.front()}));
+    EXPECT_TRUE(partitioning.getBackgroundCpus().empty());
+    if (allowedCpus.size() == 1) {
+        EXPECT_EQ(partitioning.getInferenceCpus(), allowedCpus);
+        return;
+    }
+    EXPECT_EQ(partitioning.getInferenceCpus(), cpu_list_t(allowedCpus.begin() + 1, allowedCpus.end()));
+}
+
+TEST_F(CpuPartitioningTest, RejectsInvalidCpuLists) {
+    auto& partitioning = CpuPartitioning::instance();
+    EXPECT_EQ(partitioning.configure("a-b", ""), StatusCode::CPU_LIST_WRONG_FORMAT);
+    EXPECT_EQ(partitioning.configure("", "3-1"), StatusCode::CPU_LIST_WRONG_FORMAT);
+    EXPECT_EQ(partitioning.configure(std::to_string(CPU_SETSIZE), ""), StatusCode::CPU_LIST_WRONG_FORMAT);
+}
+
+TEST_F(CpuPartitioningTest, RunsOnNetworkCpus) {
+    const auto allowedCpus = ovms::getAllowedCpus();
+    ASSERT_FALSE(allowedCpus.empty());
+    auto& partitioning = CpuPartitioning::instance();
+    ASSERT_EQ(partitioning.configure(std::to_string(allowedCpus.back()), ""), StatusCode::OK);
+    int executedOnCpu = -1;
+    partitioning.runOnNetworkCpus([&executedOnCpu]() { executedOnCpu = sched_getcpu(); });
+    EXPECT_EQ(executedOnCpu, allowedCpus.back());
+}
@@ -0,0 +1,67 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../criticalpathestimator.hpp"
+
+using ovms::CriticalPathEstimator;
+
+namespace {
+// entry(0) -> long_a(1) -> long_b(2) -> exit(4)
+// entry(0) -> short(3) -> exit(4)
+std::vector<std::vector<size_t>> createDiamondDependants() {
+    return {{1, 3}, {2}, {4}, {4}, {}};
+}
+}  // namespace
+
+TEST(CriticalPathEstimator, UnmeasuredNodesArePrioritizedByDownstreamPathLength) {
+    CriticalPathEstimator estimator(createDiamondDependants());
+    const auto unit = CriticalPathEstimator::DEFAULT_NODE_LATENCY_MICROSECONDS;
+    EXPECT_EQ(estimator.getPriority(4), unit);
+    EXPECT_EQ(estimator.getPriority(3), 2 * unit);
+    EXPECT_EQ(estimator.getPriority(2), 2 * unit);
+    EXPECT_EQ(estimator.getPriority(1), 3 * unit);
+    EXPECT_EQ(estimator.getPriority(0), 4 * unit);
+    EXPECT_GT(estimator.getPriority(1), estimator.getPriority(3));
+}
+
+TEST(CriticalPathEstimator, MeasuredLatencyChangesCriticalPath) {
+    CriticalPathEstimator estimator(createDiamondDependants());
+    estimator.recordLatency(1, 100);
+    estimator.recordLatency(2, 100);
+    estimator.recordLatency(3, 1000);
+    estimator.recordLatency(4, 10);
+    EXPECT_EQ(estimator.getPriority(4), 10);
+    EXPECT_EQ(estimator.getPriority(1), 210);
+    EXPECT_EQ(estimator.getPriority(3), 1010);
+    EXPECT_EQ(estimator.getPriority(0), 1010 + CriticalPathEstimator::DEFAULT_NODE_LATENCY_MICROSECONDS);
+}
+
+TEST(CriticalPathEstimator, LatencyIsSmoothed) {
+    CriticalPathEstimator estimator(std::vector<std::vector<size_t>>(1));
+    estimator.recordLatency(0, 800);
+    EXPECT_EQ(estimator.getPriority(0), 800);
+    estimator.recordLatency(0, 1600);
+    EXPECT_EQ(estimator.getPriority(0), (800 * 7 + 1600) / 8);
+}
+
+TEST(CriticalPathEstimator, LatencyOfUnknownNodeIsIgnored) {
+    CriticalPathEstimator estimator(std::vector<std::vector<size_t>>(1));
+    estimator.recordLatency(1, 800);
+    EXPECT_EQ(estimator.getPriority(0), CriticalPathEstimator::DEFAULT_NODE_LATENCY_MICROSECONDS);
+}
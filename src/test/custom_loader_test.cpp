@@ -13,11 +13,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <future>
+#include <mutex>
+#include <sstream>
 #include <thread>
 
 #include <gmock/gmock.h>
@@ -1010,4 +1015,327 @@ TEST_F(TestCustomLoader, CustomLoaderMultipleLoaderWithSameLoaderName) {
     performPredict("dummy", 1, request);
 }
 
+class PrecompiledBlobCustomLoader : public CustomLoaderInterface {
+public:
+    explicit PrecompiledBlobCustomLoader(std::vector<uint8_t> blob) :
+        blob(std::move(blob)) {}
+    CustomLoaderStatus loaderInit(const std::string& loaderConfigFile) override {
+        return CustomLoaderStatus::OK;
+    }
+    CustomLoaderStatus loadModel(const std::string& modelName, const std::string& basePath, const int version,
+        const std::string& loaderOptions, std::vector<uint8_t>& modelBuffer, std::vector<uint8_t>& weights) override {
+        ++loads;
+        modelBuffer = blob;
+        return CustomLoaderStatus::MODEL_TYPE_BLOB;
+    }
+    CustomLoaderStatus unloadModel(const std::string& modelName, const int version) override {
+        return CustomLoaderStatus::OK;
+    }
+    CustomLoaderStatus retireModel(const std::string& modelName) override {
+        return CustomLoaderStatus::OK;
+    }
+    CustomLoaderStatus loaderDeInit() override {
+        return CustomLoaderStatus::OK;
+    }
+
+    const std::vector<uint8_t> blob;
+    int loads = 0;
+};
+
+TEST_F(TestCustomLoader, CustomLoaderImportsPrecompiledBlob) {
+    InferenceEngine::Core engine;
+    auto compiled = engine.LoadNetwork(engine.ReadNetwork(dummy_model_location + "/1/dummy.xml"), "CPU");
+    std::stringstream exported;
+    compiled.Export(exported);
+    const std::string blob = exported.str();
+    auto loader = std::make_shared<PrecompiledBlobCustomLoader>(std::vector<uint8_t>(blob.begin(), blob.end()));
+    auto& customloaders = CustomLoaders::instance();
+    ASSERT_EQ(customloaders.add("blob-loader", loader, nullptr), StatusCode::OK);
+    customloaders.finalize();
+
+    ovms::ModelConfig blobConfig = DUMMY_MODEL_CONFIG;
+    rapidjson::Document options;
+    options.Parse(R"({"loader_name": "blob-loader"})");
+    ASSERT_EQ(blobConfig.parseCustomLoaderOptionsConfig(options), StatusCode::OK);
+    ovms::ModelInstance modelInstance("dummy", 1);
+    ASSERT_EQ(modelInstance.loadModel(blobConfig), StatusCode::OK);
+    EXPECT_EQ(loader->loads, 1);
+    EXPECT_EQ(modelInstance.getBatchSize(), 1);
+    ASSERT_EQ(modelInstance.getInputsInfo().count(DUMMY_MODEL_INPUT_NAME), 1);
+    EXPECT_EQ(modelInstance.getInputsInfo().at(DUMMY_MODEL_INPUT_NAME)->getShape(), (ovms::shape_t{1, 10}));
+    ASSERT_EQ(modelInstance.getOutputsInfo().count(DUMMY_MODEL_OUTPUT_NAME), 1);
+
+    tensorflow::serving::PredictRequest request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+    tensorflow::serving::PredictResponse response;
+    auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance);
+    EXPECT_EQ(ovms::inference(modelInstance, &request, &response, unloadGuard), StatusCode::OK);
+    unloadGuard.reset();
+
+    // shapes are compiled into the blob
+    EXPECT_EQ(modelInstance.reloadModel(2, {}, unloadGuard), StatusCode::RESHAPE_ERROR);
+    EXPECT_EQ(modelInstance.getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+    modelInstance.unloadModel();
+    customloaders.finalize();
+}
+
+class TestCustomLoaderEvents : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(CustomLoaders::instance().add("events-loader", loaderPtr, nullptr), StatusCode::OK);
+        CustomLoaders::instance().finalize();
+    }
+    void TearDown() override {
+        // loader which is not added again is deinitialized and its pushed events are dropped
+        CustomLoaders::instance().finalize();
+    }
+
+    std::shared_ptr<PrecompiledBlobCustomLoader> loaderPtr = std::make_shared<PrecompiledBlobCustomLoader>(std::vector<uint8_t>{});
+    const CustomLoaderInterface* loader = loaderPtr.get();
+};
+
+TEST_F(TestCustomLoaderEvents, PushedBlacklistAndChangesAreRecorded) {
+    auto& customloaders = CustomLoaders::instance();
+    // events are recorded only for loaders which registered the callback, loader itself is not called
+    customloaders.handleEvent(loader, CustomLoaderEvent::BLACKLISTED, "dummy", 1);
+    EXPECT_FALSE(customloaders.isPushingEvents(loader));
+    EXPECT_FALSE(customloaders.isBlacklisted(loader, "dummy", 1));
+
+    customloaders.setPushingEvents(loader);
+    EXPECT_TRUE(customloaders.isPushingEvents(loader));
+    customloaders.handleEvent(loader, CustomLoaderEvent::BLACKLISTED, "dummy", 1);
+    EXPECT_TRUE(customloaders.isBlacklisted(loader, "dummy", 1));
+    EXPECT_FALSE(customloaders.isBlacklisted(loader, "dummy", 2));
+    customloaders.handleEvent(loader, CustomLoaderEvent::UNBLACKLISTED, "dummy", 1);
+    EXPECT_FALSE(customloaders.isBlacklisted(loader, "dummy", 1));
+
+    customloaders.handleEvent(loader, CustomLoaderEvent::MODEL_CHANGED, "dummy", 2);
+    customloaders.handleEvent(loader, CustomLoaderEvent::MODEL_CHANGED, "other", 1);
+    EXPECT_EQ(customloaders.takeChangedVersions(loader, "dummy"), std::set<int>{2});
+    EXPECT_TRUE(customloaders.takeChangedVersions(loader, "dummy").empty());
+    EXPECT_EQ(customloaders.takeChangedVersions(loader, "other"), std::set<int>{1});
+}
+
+TEST_F(TestCustomLoaderEvents, EventsOfRemovedLoaderAreDropped) {
+    auto& customloaders = CustomLoaders::instance();
+    customloaders.setPushingEvents(loader);
+    customloaders.handleEvent(loader, CustomLoaderEvent::BLACKLISTED, "dummy", 1);
+    ASSERT_TRUE(customloaders.isBlacklisted(loader, "dummy", 1));
+    customloaders.finalize();
+    EXPECT_FALSE(customloaders.isPushingEvents(loader));
+    EXPECT_FALSE(customloaders.isBlacklisted(loader, "dummy", 1));
+}
+
 #pragma GCC diagnostic pop
+
+class AsyncBlobCustomLoader : public PrecompiledBlobCustomLoader {
+public:
+    using PrecompiledBlobCustomLoader::PrecompiledBlobCustomLoader;
+    int getInterfaceVersion() const override {
+        return CUSTOM_LOADER_INTERFACE_VERSION_2;
+    }
+    CustomLoaderStatus loadModelBuffersAsync(const std::string& modelName, const std::string& basePath, const int version,
+        const std::string& loaderOptions, custom_loader_callback_t callback) override {
+        std::unique_lock<std::mutex> lock(mtx);
+        pendingCallback = std::move(callback);
+        started.notify_all();
+        return CustomLoaderStatus::OK;
+    }
+
+    // completes the started load with the blob, release of the buffer is counted
+    void complete() {
+        custom_loader_callback_t callback;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            started.wait(lock, [this]() { return pendingCallback != nullptr; });
+            callback = std::move(pendingCallback);
+            pendingCallback = nullptr;
+        }
+        CustomLoaderBuffer model;
+        model.data = blob.data();
+        model.size = blob.size();
+        model.release = [this]() { ++releases; };
+        callback(CustomLoaderStatus::MODEL_TYPE_BLOB, std::move(model), CustomLoaderBuffer());
+    }
+
+    std::mutex mtx;
+    std::condition_variable started;
+    custom_loader_callback_t pendingCallback;
+    std::atomic<int> releases{0};
+};
+
+class TestAsyncCustomLoader : public TestCustomLoader {
+protected:
+    void SetUp() override {
+        TestCustomLoader::SetUp();
+        InferenceEngine::Core engine;
+        auto compiled = engine.LoadNetwork(engine.ReadNetwork(dummy_model_location + "/1/dummy.xml"), "CPU");
+        std::stringstream exported;
+        compiled.Export(exported);
+        const std::string blob = exported.str();
+        loader = std::make_shared<AsyncBlobCustomLoader>(std::vector<uint8_t>(blob.begin(), blob.end()));
+        ASSERT_EQ(CustomLoaders::instance().add(loaderName, loader, nullptr), StatusCode::OK);
+        CustomLoaders::instance().finalize();
+    }
+    void TearDown() override {
+        // loaders not added again are deinitialized and removed
+        CustomLoaders::instance().finalize();
+        TestCustomLoader::TearDown();
+    }
+    ovms::ModelConfig createConfig(const std::string& options) {
+        ovms::ModelConfig asyncConfig = DUMMY_MODEL_CONFIG;
+        rapidjson::Document document;
+        document.Parse(options.c_str());
+        EXPECT_EQ(asyncConfig.parseCustomLoaderOptionsConfig(document), StatusCode::OK);
+        return asyncConfig;
+    }
+
+    const std::string loaderName = "async-blob-loader";
+    std::shared_ptr<AsyncBlobCustomLoader> loader;
+};
+
+TEST_F(TestAsyncCustomLoader, ModelIsLoadedFromBuffersGivenToCallback) {
+    auto asyncConfig = createConfig(R"({"loader_name": "async-blob-loader"})");
+    std::thread completing([this]() { loader->complete(); });
+    ovms::ModelInstance modelInstance("dummy", 1);
+    EXPECT_EQ(modelInstance.loadModel(asyncConfig), StatusCode::OK);
+    completing.join();
+    EXPECT_EQ(modelInstance.getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+    // blob is released once imported
+    EXPECT_EQ(loader->releases, 1);
+    modelInstance.unloadModel();
+}
+
+TEST_F(TestAsyncCustomLoader, LoadFailsWhenCallbackIsNotCalledWithinTimeoutAndLateBuffersAreReleased) {
+    auto asyncConfig = createConfig(R"({"loader_name": "async-blob-loader", "load_timeout_ms": "100"})");
+    ovms::ModelInstance modelInstance("dummy", 1);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_NE(modelInstance.loadModel(asyncConfig), StatusCode::OK);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+    EXPECT_NE(modelInstance.getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+    // loader calls back after the loading thread gave up waiting
+    loader->complete();
+    EXPECT_EQ(loader->releases, 1);
+}
+
+class BufferCustomLoader : public CustomLoaderInterface {
+public:
+    BufferCustomLoader() {
+        ovms::LocalFileSystem fs;
+        fs.readTextFile(dummy_model_location + "/1/dummy.xml", &xml);
+        fs.readTextFile(dummy_model_location + "/1/dummy.bin", &bin);
+    }
+    int getInterfaceVersion() const override {
+        return CUSTOM_LOADER_INTERFACE_VERSION_2;
+    }
+    CustomLoaderStatus loaderInit(const std::string& loaderConfigFile) override {
+        return CustomLoaderStatus::OK;
+    }
+    CustomLoaderStatus loadModelBuffers(const std::string& modelName, const std::string& basePath, const int version,
+        const std::string& loaderOptions, CustomLoaderBuffer& model, CustomLoaderBuffer& weights) override {
+        ++bufferLoads;
+        if (bufferLoadStatus == CustomLoaderStatus::NOT_IMPLEMENTED) {
+            return bufferLoadStatus;
+        }
+        model.data = reinterpret_cast<const uint8_t*>(xml.data());
+        model.size = xml.size();
+        model.release = [this]() { ++modelReleases; };
+        weights.data = reinterpret_cast<const uint8_t*>(bin.data());
+        weights.size = bin.size();
+        weights.release = [this]() { ++weightsReleases; };
+        return bufferLoadStatus;
+    }
+    CustomLoaderStatus loadModel(const std::string& modelName, const std::string& basePath, const int version,
+        const std::string& loaderOptions, std::vector<uint8_t>& modelBuffer, std::vector<uint8_t>& weights) override {
+        ++loads;
+        modelBuffer.assign(xml.begin(), xml.end());
+        weights.assign(bin.begin(), bin.end());
+        return CustomLoaderStatus::MODEL_TYPE_IR;
+    }
+    CustomLoaderStatus unloadModel(const std::string& modelName, const int version) override {
+        return CustomLoaderStatus::OK;
+    }
+    CustomLoaderStatus retireModel(const std::string& modelName) override {
+        return CustomLoaderStatus::OK;
+    }
+    CustomLoaderStatus loaderDeInit() override {
+        return CustomLoaderStatus::OK;
+    }
+
+    std::string xml;
+    std::string bin;
+    CustomLoaderStatus bufferLoadStatus = CustomLoaderStatus::MODEL_TYPE_IR;
+    int bufferLoads = 0;
+    int loads = 0;
+    std::atomic<int> modelReleases{0};
+    std::atomic<int> weightsReleases{0};
+};
+
+class TestBufferCustomLoader : public TestCustomLoader {
+protected:
+    void SetUp() override {
+        TestCustomLoader::SetUp();
+        loader = std::make_shared<BufferCustomLoader>();
+        ASSERT_FALSE(loader->xml.empty());
+        ASSERT_FALSE(loader->bin.empty());
+        ASSERT_EQ(CustomLoaders::instance().add("buffer-loader", loader, nullptr), StatusCode::OK);
+        CustomLoaders::instance().finalize();
+        rapidjson::Document document;
+        document.Parse(R"({"loader_name": "buffer-loader"})");
+        ASSERT_EQ(bufferConfig.parseCustomLoaderOptionsConfig(document), StatusCode::OK);
+    }
+    void TearDown() override {
+        // loaders not added again are deinitialized and removed
+        CustomLoaders::instance().finalize();
+        TestCustomLoader::TearDown();
+    }
+
+    std::shared_ptr<BufferCustomLoader> loader;
+    ovms::ModelConfig bufferConfig = DUMMY_MODEL_CONFIG;
+};
+
+TEST_F(TestBufferCustomLoader, ModelIsReadFromLoaderBuffersAndWeightsAreKeptUntilUnload) {
+    auto modelInstance = std::make_shared<ovms::ModelInstance>("dummy", 1);
+    ASSERT_EQ(modelInstance->loadModel(bufferConfig), StatusCode::OK);
+    EXPECT_EQ(loader->bufferLoads, 1);
+    EXPECT_EQ(loader->loads, 0);
+    // model buffer is released once the network is read, weights blob points into the loader buffer
+    EXPECT_EQ(loader->modelReleases, 1);
+    EXPECT_EQ(loader->weightsReleases, 0);
+
+    tensorflow::serving::PredictRequest request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+    tensorflow::serving::PredictResponse response;
+    auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(*modelInstance);
+    EXPECT_EQ(ovms::inference(*modelInstance, &request, &response, unloadGuard), StatusCode::OK);
+    unloadGuard.reset();
+
+    modelInstance->unloadModel();
+    modelInstance.reset();
+    EXPECT_EQ(loader->modelReleases, 1);
+    EXPECT_EQ(loader->weightsReleases, 1);
+}
+
+TEST_F(TestBufferCustomLoader, BuffersAreReleasedWhenLoaderReportsError) {
+    loader->bufferLoadStatus = CustomLoaderStatus::MODEL_LOAD_ERROR;
+    ovms::ModelInstance modelInstance("dummy", 1);
+    EXPECT_EQ(modelInstance.loadModel(bufferConfig), StatusCode::INTERNAL_ERROR);
+    EXPECT_NE(modelInstance.getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+    EXPECT_EQ(loader->loads, 0);
+    EXPECT_EQ(loader->modelReleases, 1);
+    EXPECT_EQ(loader->weightsReleases, 1);
+}
+
+TEST_F(TestBufferCustomLoader, LoadModelIsCalledWhenBuffersAreNotImplemented) {
+    loader->bufferLoadStatus = CustomLoaderStatus::NOT_IMPLEMENTED;
+    ovms::ModelInstance modelInstance("dummy", 1);
+    ASSERT_EQ(modelInstance.loadModel(bufferConfig), StatusCode::OK);
+    EXPECT_EQ(modelInstance.getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+    EXPECT_EQ(loader->bufferLoads, 1);
+    EXPECT_EQ(loader->loads, 1);
+    EXPECT_EQ(loader->modelReleases, 0);
+    EXPECT_EQ(loader->weightsReleases, 0);
+    modelInstance.unloadModel();
+}
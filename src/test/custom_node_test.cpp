@@ -0,0 +1,238 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../custom_node.hpp"
+#include "../customnodelibrarymanager.hpp"
+#include "../dl_node.hpp"
+#include "../entry_node.hpp"
+#include "../exit_node.hpp"
+#include "../pipeline.hpp"
+#include "../pipelinedefinition.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+using namespace tensorflow;
+using namespace tensorflow::serving;
+
+namespace {
+
+std::atomic<int> allocatedBuffersCount{0};
+// Makes library return output with data size not matching its shape
+bool corruptOutputs = false;
+
+void* allocateBuffer(size_t size) {
+    allocatedBuffersCount++;
+    return std::malloc(size);
+}
+
+int releaseBuffer(void* ptr) {
+    allocatedBuffersCount--;
+    std::free(ptr);
+    return 0;
+}
+
+// Adds "added_value" parameter to each FP32 value of the input
+int executeAddValue(const struct CustomNodeTensor* inputs, int inputsCount, struct CustomNodeTensor** outputs, int* outputsCount, const struct CustomNodeParam* params, int paramsCount) {
+    if (inputsCount != 1 || inputs[0].precision != FP32) {
+        return 1;
+    }
+    float addedValue = 1.0f;
+    for (int i = 0; i < paramsCount; ++i) {
+        if (std::string(params[i].key) == "added_value") {
+            addedValue = std::stof(params[i].value);
+        }
+    }
+    const auto& input = inputs[0];
+    auto* output = static_cast<struct CustomNodeTensor*>(allocateBuffer(sizeof(struct CustomNodeTensor)));
+    const std::string outputName = "output_numbers";
+    auto* name = static_cast<char*>(allocateBuffer(outputName.size() + 1));
+    std::strcpy(name, outputName.c_str());
+    output->name = name;
+    output->dataBytes = input.dataBytes;
+    output->data = static_cast<uint8_t*>(allocateBuffer(input.dataBytes));
+    const auto* inputValues = reinterpret_cast<const float*>(input.data);
+    auto* outputValues = reinterpret_cast<float*>(output->data);
+    for (size_t i = 0; i < input.dataBytes / sizeof(float); ++i) {
+        outputValues[i] = inputValues[i] + addedValue;
+    }
+    output->dimsCount = input.dimsCount;
+    output->dims = static_cast<uint64_t*>(allocateBuffer(input.dimsCount * sizeof(uint64_t)));
+    std::memcpy(output->dims, input.dims, input.dimsCount * sizeof(uint64_t));
+    if (corruptOutputs) {
+        output->dims[0]++;
+    }
+    output->precision = FP32;
+    *outputs = output;
+    *outputsCount = 1;
+    return 0;
+}
+
+int executeFailing(const struct CustomNodeTensor*, int, struct CustomNodeTensor**, int*, const struct CustomNodeParam*, int) {
+    return 1;
+}
+
+}  // namespace
+
+class CustomNodeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        allocatedBuffersCount = 0;
+        corruptOutputs = false;
+        library.execute = executeAddValue;
+        library.release = releaseBuffer;
+
+        tensorflow::TensorProto& proto = (*request.mutable_inputs())[pipelineInputName];
+        proto.set_dtype(tensorflow::DataType::DT_FLOAT);
+        proto.mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
+        proto.mutable_tensor_shape()->add_dim()->set_size(1);
+        proto.mutable_tensor_shape()->add_dim()->set_size(DUMMY_MODEL_INPUT_SIZE);
+    }
+
+    Status executeCustomNodePipeline(const parameters_t& parameters) {
+        auto input_node = std::make_unique<EntryNode>(&request);
+        auto custom_node = std::make_unique<CustomNode>("custom_node", library, parameters);
+        auto output_node = std::make_unique<ExitNode>(&response);
+
+        Pipeline pipeline(*input_node, *output_node);
+        pipeline.connect(*input_node, *custom_node, {{pipelineInputName, "input_numbers"}});
+        pipeline.connect(*custom_node, *output_node, {{"output_numbers", pipelineOutputName}});
+
+        pipeline.push(std::move(input_node));
+        pipeline.push(std::move(custom_node));
+        pipeline.push(std::move(output_node));
+        return pipeline.execute();
+    }
+
+    void checkResponse(float addedValue) {
+        ASSERT_EQ(response.outputs().count(pipelineOutputName), 1);
+        const auto& proto = response.outputs().at(pipelineOutputName);
+        ASSERT_EQ(proto.tensor_content().size(), requestData.size() * sizeof(float));
+        const float* actual = reinterpret_cast<const float*>(proto.tensor_content().data());
+        for (size_t i = 0; i < requestData.size(); ++i) {
+            EXPECT_EQ(actual[i], requestData[i] + addedValue) << "at place: " << i;
+        }
+    }
+
+    NodeLibrary library;
+    PredictRequest request;
+    PredictResponse response;
+    const std::string pipelineInputName = "pipeline_input";
+    const std::string pipelineOutputName = "pipeline_output";
+    const std::vector<float> requestData{-5.0, 3.0, 0.0, -12.0, 9.0, -100.0, 102.0, 92.0, -1.0, 12.0};
+};
+
+TEST_F(CustomNodeTest, OutputsOfLibraryArePassedToResponse) {
+    ASSERT_EQ(executeCustomNodePipeline({{"added_value", "3.5"}}), StatusCode::OK);
+    checkResponse(3.5);
+    // output data buffer is shared with blob and released when pipeline is destroyed
+    EXPECT_EQ(allocatedBuffersCount, 0);
+}
+
+TEST_F(CustomNodeTest, LibraryOutputsAreConsumedByModelNode) {
+    // input   custom(+1)   dummy(+1)   output
+    //  O--------->O----------->O---------->O
+    ConstructorEnabledModelManager manager;
+    auto config = DUMMY_MODEL_CONFIG;
+    manager.reloadModelWithVersions(config);
+    {
+        auto input_node = std::make_unique<EntryNode>(&request);
+        auto custom_node = std::make_unique<CustomNode>("custom_node", library, parameters_t{});
+        auto model_node = std::make_unique<DLNode>("dummy_node", "dummy", std::nullopt, manager);
+        auto output_node = std::make_unique<ExitNode>(&response);
+
+        Pipeline pipeline(*input_node, *output_node);
+        pipeline.connect(*input_node, *custom_node, {{pipelineInputName, "input_numbers"}});
+        pipeline.connect(*custom_node, *model_node, {{"output_numbers", DUMMY_MODEL_INPUT_NAME}});
+        pipeline.connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, pipelineOutputName}});
+
+        pipeline.push(std::move(input_node));
+        pipeline.push(std::move(custom_node));
+        pipeline.push(std::move(model_node));
+        pipeline.push(std::move(output_node));
+        ASSERT_EQ(pipeline.execute(), StatusCode::OK);
+    }
+    checkResponse(2.0);
+    EXPECT_EQ(allocatedBuffersCount, 0);
+}
+
+TEST_F(CustomNodeTest, FailedLibraryExecutionIsReported) {
+    library.execute = executeFailing;
+    EXPECT_EQ(executeCustomNodePipeline({}), StatusCode::NODE_LIBRARY_EXECUTION_FAILED);
+}
+
+TEST_F(CustomNodeTest, CorruptedOutputsAreReleased) {
+    corruptOutputs = true;
+    EXPECT_EQ(executeCustomNodePipeline({}), StatusCode::NODE_LIBRARY_OUTPUTS_CORRUPTED);
+    EXPECT_EQ(allocatedBuffersCount, 0);
+}
+
+TEST_F(CustomNodeTest, MissingLibraryOutputIsReported) {
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto custom_node = std::make_unique<CustomNode>("custom_node", library, parameters_t{});
+    auto output_node = std::make_unique<ExitNode>(&response);
+
+    Pipeline pipeline(*input_node, *output_node);
+    pipeline.connect(*input_node, *custom_node, {{pipelineInputName, "input_numbers"}});
+    pipeline.connect(*custom_node, *output_node, {{"not_existing_output", pipelineOutputName}});
+
+    pipeline.push(std::move(input_node));
+    pipeline.push(std::move(custom_node));
+    pipeline.push(std::move(output_node));
+    EXPECT_EQ(pipeline.execute(), StatusCode::NODE_LIBRARY_MISSING_OUTPUT);
+}
+
+TEST_F(CustomNodeTest, PipelineDefinitionWithNotLoadedLibraryIsInvalid) {
+    ConstructorEnabledModelManager manager;
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{pipelineInputName, pipelineInputName}}},
+        {NodeKind::CUSTOM, "custom_node", "", std::nullopt, {{"output_numbers", "output_numbers"}}, NodeLibrary{}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["custom_node"] = {
+        {ENTRY_NODE_NAME, {{pipelineInputName, "input_numbers"}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"custom_node", {{"output_numbers", pipelineOutputName}}}};
+
+    PipelineDefinition invalid("custom_pipeline", info, connections);
+    EXPECT_EQ(invalid.validate(manager), StatusCode::PIPELINE_DEFINITION_INVALID_NODE_LIBRARY);
+
+    info[1].library = library;
+    info[1].parameters = {{"added_value", "2"}};
+    PipelineDefinition valid("custom_pipeline", info, connections);
+    ASSERT_EQ(valid.validate(manager), StatusCode::OK);
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(valid.create(pipeline, &request, &response, manager), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkResponse(2.0);
+}
+
+TEST(CustomNodeLibraryManagerTest, NotExistingLibraryFailsToLoad) {
+    CustomNodeLibraryManager manager;
+    EXPECT_EQ(manager.loadLibrary("not_existing", "/not/existing/libcustom_node.so"), StatusCode::NODE_LIBRARY_LOAD_FAILED_OPEN);
+    NodeLibrary library;
+    EXPECT_EQ(manager.getLibrary("not_existing", library), StatusCode::NODE_LIBRARY_MISSING);
+    EXPECT_FALSE(library.isValid());
+}
@@ -0,0 +1,106 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../deadlinetimer.hpp"
+
+using ovms::DeadlineTimer;
+using ovms::deadlineAfter;
+
+TEST(DeadlineTimer, CallsCallbacksInOrderOfDeadlines) {
+    DeadlineTimer timer;
+    std::mutex mtx;
+    std::vector<int> order;
+    std::promise<void> allCalled;
+    auto record = [&](int value) {
+        std::unique_lock<std::mutex> lock(mtx);
+        order.push_back(value);
+        if (order.size() == 3) {
+            allCalled.set_value();
+        }
+    };
+    timer.schedule(deadlineAfter(std::chrono::milliseconds(60)), [&record]() { record(3); });
+    timer.schedule(deadlineAfter(std::chrono::milliseconds(20)), [&record]() { record(1); });
+    timer.schedule(deadlineAfter(std::chrono::milliseconds(40)), [&record]() { record(2); });
+    ASSERT_EQ(allCalled.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(timer.getScheduledCount(), 0);
+}
+
+TEST(DeadlineTimer, NoDeadlineIsNotScheduled) {
+    DeadlineTimer timer;
+    EXPECT_EQ(timer.schedule(ovms::NO_DEADLINE, []() {}), DeadlineTimer::NO_TIMER);
+    EXPECT_EQ(timer.getScheduledCount(), 0);
+    EXPECT_FALSE(timer.cancel(DeadlineTimer::NO_TIMER));
+}
+
+TEST(DeadlineTimer, CancelledCallbackIsNotCalled) {
+    std::atomic<bool> called{false};
+    {
+        DeadlineTimer timer;
+        auto id = timer.schedule(deadlineAfter(std::chrono::milliseconds(50)), [&called]() { called = true; });
+        EXPECT_TRUE(timer.cancel(id));
+        EXPECT_FALSE(timer.cancel(id));
+        std::promise<void> later;
+        timer.schedule(deadlineAfter(std::chrono::milliseconds(100)), [&later]() { later.set_value(); });
+        ASSERT_EQ(later.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    }
+    EXPECT_FALSE(called);
+}
+
+TEST(DeadlineTimer, CancelWaitsForRunningCallback) {
+    DeadlineTimer timer;
+    std::promise<void> started;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future();
+    std::atomic<bool> returned{false};
+    auto id = timer.schedule(deadlineAfter(std::chrono::milliseconds(0)), [&]() {
+        started.set_value();
+        releaseFuture.wait();
+        returned = true;
+    });
+    started.get_future().wait();
+    std::thread releaser([&release]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release.set_value();
+    });
+    EXPECT_FALSE(timer.cancel(id));
+    EXPECT_TRUE(returned);
+    releaser.join();
+}
+
+TEST(DeadlineTimer, CallbackCanCancelItself) {
+    DeadlineTimer timer;
+    std::promise<bool> cancelled;
+    DeadlineTimer::timer_id_t id = DeadlineTimer::NO_TIMER;
+    std::promise<void> scheduled;
+    auto scheduledFuture = scheduled.get_future();
+    id = timer.schedule(deadlineAfter(std::chrono::milliseconds(10)), [&]() {
+        scheduledFuture.wait();
+        cancelled.set_value(timer.cancel(id));
+    });
+    scheduled.set_value();
+    auto cancelledFuture = cancelled.get_future();
+    ASSERT_EQ(cancelledFuture.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_FALSE(cancelledFuture.get());
+}
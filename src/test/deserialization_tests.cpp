@@ -60,9 +60,9 @@ const std::vector<Precision> SUPPORTED_INPUT_PRECISIONS{
     Precision::I8,
     Precision::U16,
     Precision::I32,
-    // Precision::I64,
+    Precision::I64,
     // Precision::BIN,
-    // Precision::BOOL
+    Precision::BOOL
     // //Precision::CUSTOM)
 };
 
@@ -77,9 +77,9 @@ const std::vector<Precision> UNSUPPORTED_INPUT_PRECISIONS{
     // Precision::I8,
     // Precision::U16,
     // Precision::I32,
-    Precision::I64,
+    // Precision::I64,
     Precision::BIN,
-    Precision::BOOL
+    // Precision::BOOL
     // Precision::CUSTOM)
 };
 
@@ -204,6 +204,281 @@ TEST_P(GRPCPredictRequest, ShouldSuccessForSupportedPrecision) {
     EXPECT_TRUE(status.ok());
 }
 
+TEST_F(GRPCPredictRequest, ShouldConvertIntoPreallocatedBlobWithoutSetBlob) {
+    tensorMap[tensorName]->setPrecision(Precision::FP16);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    requestInput.set_dtype(tensorflow::DataType::DT_HALF);
+    requestInput.clear_tensor_content();
+    for (int i = 0; i < 3; i++) {
+        requestInput.add_half_val(i + 1);
+    }
+    auto preallocatedBlob = InferenceEngine::make_shared_blob<uint16_t>(tensorMap[tensorName]->getTensorDesc());
+    preallocatedBlob->allocate();
+    blob_map_t preallocatedBlobs{{tensorName, preallocatedBlob}};
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(0);
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest, &preallocatedBlobs);
+    ASSERT_TRUE(status.ok());
+    const uint16_t* values = preallocatedBlob->buffer().as<const uint16_t*>();
+    EXPECT_EQ(values[0], 1);
+    EXPECT_EQ(values[1], 2);
+    EXPECT_EQ(values[2], 3);
+}
+
+TEST_F(GRPCPredictRequest, ShouldCopyPackedHalfTensorContentIntoPreallocatedBlob) {
+    tensorMap[tensorName]->setPrecision(Precision::FP16);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    requestInput.set_dtype(tensorflow::DataType::DT_HALF);
+    const std::vector<uint16_t> data{0x3C00, 0x4000, 0x4200};
+    *requestInput.mutable_tensor_content() = std::string(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(uint16_t));
+    auto preallocatedBlob = InferenceEngine::make_shared_blob<uint16_t>(tensorMap[tensorName]->getTensorDesc());
+    preallocatedBlob->allocate();
+    blob_map_t preallocatedBlobs{{tensorName, preallocatedBlob}};
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(0);
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest, &preallocatedBlobs);
+    ASSERT_TRUE(status.ok());
+    const uint16_t* values = preallocatedBlob->buffer().as<const uint16_t*>();
+    EXPECT_EQ(values[0], 0x3C00);
+    EXPECT_EQ(values[1], 0x4000);
+    EXPECT_EQ(values[2], 0x4200);
+}
+
+TEST_F(GRPCPredictRequest, ShouldConvertFp32IntoPreallocatedFp16Blob) {
+    tensorMap[tensorName]->setPrecision(Precision::FP16);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    const std::vector<float> data{1.0f, -2.0f, 0.5f};
+    *requestInput.mutable_tensor_content() = std::string(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    auto preallocatedBlob = InferenceEngine::make_shared_blob<uint16_t>(tensorMap[tensorName]->getTensorDesc());
+    preallocatedBlob->allocate();
+    blob_map_t preallocatedBlobs{{tensorName, preallocatedBlob}};
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(0);
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest, &preallocatedBlobs);
+    ASSERT_TRUE(status.ok());
+    const uint16_t* values = preallocatedBlob->buffer().as<const uint16_t*>();
+    EXPECT_EQ(values[0], 0x3C00);
+    EXPECT_EQ(values[1], 0xC000);
+    EXPECT_EQ(values[2], 0x3800);
+}
+
+TEST_F(GRPCPredictRequest, ShouldConvertFp32IntoPreallocatedU8BlobAndSetIt) {
+    tensorMap[tensorName]->setPrecision(Precision::U8);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    const std::vector<float> data{1.4f, 300.0f, -1.0f};
+    *requestInput.mutable_tensor_content() = std::string(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    auto preallocatedBlob = InferenceEngine::make_shared_blob<uint8_t>(tensorMap[tensorName]->getTensorDesc());
+    preallocatedBlob->allocate();
+    blob_map_t preallocatedBlobs{{tensorName, preallocatedBlob}};
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    // U8 requests without conversion may have replaced the preallocated blob
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(1);
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest, &preallocatedBlobs);
+    ASSERT_TRUE(status.ok());
+    const uint8_t* values = preallocatedBlob->buffer().as<const uint8_t*>();
+    EXPECT_EQ(values[0], 1);
+    EXPECT_EQ(values[1], 255);
+    EXPECT_EQ(values[2], 0);
+}
+
+TEST_F(GRPCPredictRequest, ShouldSetBlobWithRequestShapeForResizedInput) {
+    tensorMap[tensorName]->setPrecision(Precision::U8);
+    tensorMap[tensorName]->setResized(true);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    requestInput.set_dtype(tensorflow::DataType::DT_UINT8);
+    requestInput.mutable_tensor_shape()->mutable_dim(2)->set_size(4);
+    requestInput.mutable_tensor_shape()->mutable_dim(3)->set_size(5);
+    *requestInput.mutable_tensor_content() = std::string(1 * 3 * 4 * 5, '1');
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    InferenceEngine::Blob::Ptr blob;
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).WillOnce(::testing::DoAll(::testing::SaveArg<1>(&blob), ::testing::Return(InferenceEngine::StatusCode::OK)));
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest);
+    ASSERT_TRUE(status.ok());
+    ASSERT_NE(blob, nullptr);
+    EXPECT_EQ(blob->getTensorDesc().getDims(), InferenceEngine::SizeVector({1, 3, 4, 5}));
+    // request memory is used in place, plugin resizes it during inference
+    EXPECT_EQ(blob->buffer().as<const char*>(), requestInput.tensor_content().data());
+}
+
+TEST_F(GRPCPredictRequest, ShouldRejectConversionOfResizedInput) {
+    tensorMap[tensorName]->setPrecision(Precision::U8);
+    tensorMap[tensorName]->setResized(true);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    requestInput.set_dtype(tensorflow::DataType::DT_FLOAT);
+    *requestInput.mutable_tensor_content() = std::string(1 * 3 * 1 * 1 * sizeof(float), '1');
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(0);
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest);
+    EXPECT_EQ(status, ovms::StatusCode::OV_UNSUPPORTED_DESERIALIZATION_PRECISION);
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldConvertFp32IntoAllocatedI8Blob) {
+    tensorMap[tensorName]->setPrecision(Precision::I8);
+    const std::vector<float> data{1.6f, -300.0f, 100.0f};
+    *tensorProto.mutable_tensor_content() = std::string(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    const int8_t* values = blobPtr->buffer().as<const int8_t*>();
+    EXPECT_NE(reinterpret_cast<const char*>(values), tensorProto.tensor_content().data());
+    EXPECT_EQ(values[0], 2);
+    EXPECT_EQ(values[1], -128);
+    EXPECT_EQ(values[2], 100);
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldUseI64ValuesInPlace) {
+    tensorMap[tensorName]->setPrecision(Precision::I64);
+    tensorProto.set_dtype(tensorflow::DataType::DT_INT64);
+    tensorProto.clear_tensor_content();
+    for (int64_t value : {1, -2, 3}) {
+        tensorProto.add_int64_val(value);
+    }
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    EXPECT_EQ(blobPtr->buffer().as<const int64_t*>(), tensorProto.int64_val().data());
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldUseBoolValuesInPlace) {
+    tensorMap[tensorName]->setPrecision(Precision::BOOL);
+    tensorProto.set_dtype(tensorflow::DataType::DT_BOOL);
+    tensorProto.clear_tensor_content();
+    for (bool value : {true, false, true}) {
+        tensorProto.add_bool_val(value);
+    }
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    const uint8_t* values = blobPtr->buffer().as<const uint8_t*>();
+    EXPECT_EQ(reinterpret_cast<const void*>(values), reinterpret_cast<const void*>(tensorProto.bool_val().data()));
+    EXPECT_EQ(values[0], 1);
+    EXPECT_EQ(values[1], 0);
+    EXPECT_EQ(values[2], 1);
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldNarrowI64ValuesIntoAllocatedI32Blob) {
+    tensorMap[tensorName]->setPrecision(Precision::I32);
+    tensorProto.set_dtype(tensorflow::DataType::DT_INT64);
+    tensorProto.clear_tensor_content();
+    for (int64_t value : {int64_t(7), int64_t(-7), int64_t(0x100000005)}) {
+        tensorProto.add_int64_val(value);
+    }
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    const int32_t* values = blobPtr->buffer().as<const int32_t*>();
+    EXPECT_EQ(values[0], 7);
+    EXPECT_EQ(values[1], -7);
+    EXPECT_EQ(values[2], 5);
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldUseFloatValuesInPlace) {
+    tensorMap[tensorName]->setPrecision(Precision::FP32);
+    tensorProto.set_dtype(tensorflow::DataType::DT_FLOAT);
+    tensorProto.clear_tensor_content();
+    for (float value : {1.5f, -2.0f, 3.25f}) {
+        tensorProto.add_float_val(value);
+    }
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    EXPECT_EQ(blobPtr->buffer().as<const float*>(), tensorProto.float_val().data());
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldNarrowIntValuesIntoAllocatedU8Blob) {
+    tensorMap[tensorName]->setPrecision(Precision::U8);
+    tensorProto.set_dtype(tensorflow::DataType::DT_UINT8);
+    tensorProto.clear_tensor_content();
+    for (int value : {0, 127, 255}) {
+        tensorProto.add_int_val(value);
+    }
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    const uint8_t* values = blobPtr->buffer().as<const uint8_t*>();
+    EXPECT_EQ(values[0], 0);
+    EXPECT_EQ(values[1], 127);
+    EXPECT_EQ(values[2], 255);
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldConvertFloatValuesIntoAllocatedFp16Blob) {
+    tensorMap[tensorName]->setPrecision(Precision::FP16);
+    tensorProto.set_dtype(tensorflow::DataType::DT_FLOAT);
+    tensorProto.clear_tensor_content();
+    for (float value : {1.0f, -2.0f, 0.5f}) {
+        tensorProto.add_float_val(value);
+    }
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    const uint16_t* values = blobPtr->buffer().as<const uint16_t*>();
+    EXPECT_EQ(values[0], 0x3C00);
+    EXPECT_EQ(values[1], 0xC000);
+    EXPECT_EQ(values[2], 0x3800);
+}
+
+TEST_F(GRPCPredictRequest, ShouldNarrowI64TensorContentIntoPreallocatedI32BlobAndSetIt) {
+    tensorMap[tensorName]->setPrecision(Precision::I32);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    requestInput.set_dtype(tensorflow::DataType::DT_INT64);
+    const std::vector<int64_t> data{1, -1, 1000000};
+    *requestInput.mutable_tensor_content() = std::string(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(int64_t));
+    auto preallocatedBlob = InferenceEngine::make_shared_blob<int32_t>(tensorMap[tensorName]->getTensorDesc());
+    preallocatedBlob->allocate();
+    blob_map_t preallocatedBlobs{{tensorName, preallocatedBlob}};
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    // I32 requests without conversion may have replaced the preallocated blob
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(1);
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest, &preallocatedBlobs);
+    ASSERT_TRUE(status.ok());
+    const int32_t* values = preallocatedBlob->buffer().as<const int32_t*>();
+    EXPECT_EQ(values[0], 1);
+    EXPECT_EQ(values[1], -1);
+    EXPECT_EQ(values[2], 1000000);
+}
+
+TEST_F(TensorflowGRPCPredict, ShouldTransposeNhwcTensorContentIntoAllocatedBlob) {
+    tensorMap[tensorName] = std::make_shared<ovms::TensorInfo>(tensorName, Precision::FP32, ovms::shape_t{1, 3, 1, 2}, InferenceEngine::Layout::NCHW);
+    tensorMap[tensorName]->setLayoutTransposed(true);
+    // pixels of RGB values
+    const std::vector<float> data{1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+    tensorProto.set_dtype(tensorflow::DataType::DT_FLOAT);
+    *tensorProto.mutable_tensor_content() = std::string(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    InferenceEngine::Blob::Ptr blobPtr = deserializeTensorProto<ConcreteTensorProtoDeserializator>(tensorProto, tensorMap[tensorName]);
+    ASSERT_NE(nullptr, blobPtr);
+    const float* values = blobPtr->buffer().as<const float*>();
+    EXPECT_EQ(std::vector<float>(values, values + data.size()), (std::vector<float>{1.0f, 4.0f, 2.0f, 5.0f, 3.0f, 6.0f}));
+}
+
+TEST_F(GRPCPredictRequest, ShouldTransposeNhwcHalfValuesIntoPreallocatedBlobWithoutSetBlob) {
+    tensorMap[tensorName] = std::make_shared<ovms::TensorInfo>(tensorName, Precision::FP16, ovms::shape_t{1, 3, 1, 2}, InferenceEngine::Layout::NCHW);
+    tensorMap[tensorName]->setLayoutTransposed(true);
+    auto& requestInput = (*request.mutable_inputs())[tensorName];
+    requestInput.set_dtype(tensorflow::DataType::DT_HALF);
+    requestInput.clear_tensor_content();
+    for (int value : {1, 2, 3, 4, 5, 6}) {
+        requestInput.add_half_val(value);
+    }
+    auto preallocatedBlob = InferenceEngine::make_shared_blob<uint16_t>(tensorMap[tensorName]->getTensorDesc());
+    preallocatedBlob->allocate();
+    blob_map_t preallocatedBlobs{{tensorName, preallocatedBlob}};
+
+    std::shared_ptr<MockIInferRequest> mInferRequestPtr = std::make_shared<MockIInferRequest>();
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(0);
+    auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, tensorMap, inferRequest, &preallocatedBlobs);
+    ASSERT_TRUE(status.ok());
+    const uint16_t* values = preallocatedBlob->buffer().as<const uint16_t*>();
+    EXPECT_EQ(std::vector<uint16_t>(values, values + 6), (std::vector<uint16_t>{1, 4, 2, 5, 3, 6}));
+}
+
 TEST_P(DeserializeTFTensorProtoNegative, ShouldReturnNullptrForPrecision) {
     Precision testedPrecision = GetParam();
     tensorMap[tensorName]->setPrecision(testedPrecision);
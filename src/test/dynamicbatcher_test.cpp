@@ -0,0 +1,235 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../modelinstance.hpp"
+#include "../modelinstanceunloadguard.hpp"
+#include "../numa.hpp"
+#include "../prediction_service_utils.hpp"
+#include "test_utils.hpp"
+
+using testing::Each;
+using testing::Eq;
+
+class DynamicBatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config = DUMMY_MODEL_CONFIG;
+        config.setBatchingParams("0");
+        config.setDynamicBatchingMaxBatchSize(4);
+        config.setDynamicBatchingMaxQueueDelayMicroseconds(100'000);
+        config.setNireq(1);
+    }
+
+    tensorflow::serving::PredictRequest prepareRequest(size_t batchSize, float value) {
+        tensorflow::serving::PredictRequest request;
+        auto& input = (*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME];
+        input.set_dtype(tensorflow::DataType::DT_FLOAT);
+        input.mutable_tensor_shape()->add_dim()->set_size(batchSize);
+        input.mutable_tensor_shape()->add_dim()->set_size(DUMMY_MODEL_INPUT_SIZE);
+        std::vector<float> data(batchSize * DUMMY_MODEL_INPUT_SIZE, value);
+        input.mutable_tensor_content()->assign(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+        return request;
+    }
+
+    ovms::ModelConfig config;
+};
+
+TEST_F(DynamicBatcherTest, NetworkBatchSizeIsSetToMaxBatchSize) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    ASSERT_NE(modelInstance.getDynamicBatcher(), nullptr);
+    EXPECT_EQ(modelInstance.getBatchSize(), 4);
+}
+
+TEST_F(DynamicBatcherTest, ValidationAcceptsBatchSizeUpToMax) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto request = prepareRequest(1, 1.0);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::OK);
+    request = prepareRequest(4, 1.0);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::OK);
+    request = prepareRequest(5, 1.0);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_BATCH_SIZE);
+}
+
+TEST_F(DynamicBatcherTest, ConcurrentRequestsAreSplitBackIntoResponses) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+
+    const size_t numberOfRequests = 6;
+    std::vector<tensorflow::serving::PredictResponse> responses(numberOfRequests);
+    std::vector<ovms::Status> statuses(numberOfRequests);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numberOfRequests; i++) {
+        threads.emplace_back([this, i, &modelInstance, &responses, &statuses]() {
+            auto request = prepareRequest(1 + i % 2, static_cast<float>(i));
+            auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance);
+            statuses[i] = ovms::inference(modelInstance, &request, &responses[i], unloadGuard);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < numberOfRequests; i++) {
+        ASSERT_EQ(statuses[i], ovms::StatusCode::OK) << statuses[i].string();
+        const auto& output = responses[i].outputs().at(DUMMY_MODEL_OUTPUT_NAME);
+        ASSERT_EQ(output.tensor_shape().dim_size(), 2);
+        EXPECT_EQ(output.tensor_shape().dim(0).size(), 1 + i % 2);
+        EXPECT_EQ(output.tensor_shape().dim(1).size(), DUMMY_MODEL_OUTPUT_SIZE);
+        auto values = asVector<float>(output.tensor_content());
+        EXPECT_EQ(values.size(), (1 + i % 2) * DUMMY_MODEL_OUTPUT_SIZE);
+        EXPECT_THAT(values, Each(Eq(static_cast<float>(i) + 1)));
+    }
+}
+
+TEST_F(DynamicBatcherTest, NodeBlobsAreBatchedWithPredictRequests) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto dynamicBatcher = modelInstance.getDynamicBatcher();
+    ASSERT_NE(dynamicBatcher, nullptr);
+
+    std::vector<float> data(2 * DUMMY_MODEL_INPUT_SIZE, 3.0);
+    ovms::BlobMap inputs;
+    inputs[DUMMY_MODEL_INPUT_NAME] = InferenceEngine::make_shared_blob<float>(
+        {InferenceEngine::Precision::FP32, {2, DUMMY_MODEL_INPUT_SIZE}, InferenceEngine::Layout::NC}, data.data());
+    ovms::BlobMap outputs;
+    std::promise<ovms::Status> nodeFinished;
+    dynamicBatcher->inferAsync(&inputs, &outputs, {DUMMY_MODEL_OUTPUT_NAME}, [&nodeFinished](ovms::Status status) { nodeFinished.set_value(status); });
+
+    auto request = prepareRequest(1, 5.0);
+    tensorflow::serving::PredictResponse response;
+    EXPECT_EQ(dynamicBatcher->infer(&request, &response), ovms::StatusCode::OK);
+    ASSERT_EQ(nodeFinished.get_future().get(), ovms::StatusCode::OK);
+
+    ASSERT_EQ(outputs.count(DUMMY_MODEL_OUTPUT_NAME), 1);
+    const auto& blob = outputs.at(DUMMY_MODEL_OUTPUT_NAME);
+    EXPECT_EQ(blob->getTensorDesc().getDims(), (InferenceEngine::SizeVector{2, DUMMY_MODEL_OUTPUT_SIZE}));
+    const float* values = blob->cbuffer().as<const float*>();
+    EXPECT_THAT(std::vector<float>(values, values + 2 * DUMMY_MODEL_OUTPUT_SIZE), Each(Eq(4.0)));
+    auto responseValues = asVector<float>(response.outputs().at(DUMMY_MODEL_OUTPUT_NAME).tensor_content());
+    EXPECT_THAT(responseValues, Each(Eq(6.0)));
+}
+
+TEST_F(DynamicBatcherTest, NodeBlobsWithPassedDeadlineAreDropped) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto dynamicBatcher = modelInstance.getDynamicBatcher();
+    ASSERT_NE(dynamicBatcher, nullptr);
+
+    std::vector<float> data(DUMMY_MODEL_INPUT_SIZE, 3.0);
+    ovms::BlobMap inputs;
+    inputs[DUMMY_MODEL_INPUT_NAME] = InferenceEngine::make_shared_blob<float>(
+        {InferenceEngine::Precision::FP32, {1, DUMMY_MODEL_INPUT_SIZE}, InferenceEngine::Layout::NC}, data.data());
+    ovms::BlobMap outputs;
+    std::promise<ovms::Status> nodeFinished;
+    dynamicBatcher->inferAsync(
+        &inputs, &outputs, {DUMMY_MODEL_OUTPUT_NAME}, [&nodeFinished](ovms::Status status) { nodeFinished.set_value(status); },
+        std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+    EXPECT_EQ(nodeFinished.get_future().get(), ovms::StatusCode::DEADLINE_EXCEEDED);
+    EXPECT_EQ(outputs.count(DUMMY_MODEL_OUTPUT_NAME), 0);
+}
+
+TEST_F(DynamicBatcherTest, LatencySloEnablesAdaptiveController) {
+    config.setDynamicBatchingLatencySloMicroseconds(50'000);
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    auto dynamicBatcher = modelInstance.getDynamicBatcher();
+    ASSERT_NE(dynamicBatcher, nullptr);
+    ASSERT_NE(dynamicBatcher->getAdaptiveController(), nullptr);
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto request = prepareRequest(1, 1.0);
+        tensorflow::serving::PredictResponse response;
+        ASSERT_EQ(dynamicBatcher->infer(&request, &response), ovms::StatusCode::OK);
+        EXPECT_THAT(asVector<float>(response.outputs().at(DUMMY_MODEL_OUTPUT_NAME).tensor_content()), Each(Eq(2.0)));
+    }
+    EXPECT_GT(dynamicBatcher->getAdaptiveController()->predictInferenceMicroseconds(1), 0.0);
+}
+
+TEST_F(DynamicBatcherTest, EveryReplicaHasAdaptiveController) {
+    if (ovms::getAllowedCpus().size() < 2) {
+        GTEST_SKIP() << "Replicas on CPU require at least 2 cpus";
+    }
+    config.setDynamicBatchingLatencySloMicroseconds(50'000);
+    config.setReplicasCount(2);
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    const auto batchers = modelInstance.getDynamicBatchers();
+    ASSERT_EQ(batchers.size(), 2);
+    EXPECT_NE(batchers[0], batchers[1]);
+    for (const auto* batcher : batchers) {
+        EXPECT_NE(batcher->getAdaptiveController(), nullptr);
+    }
+}
+
+TEST_F(DynamicBatcherTest, FixedQueueDelayWithoutLatencySlo) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    ASSERT_NE(modelInstance.getDynamicBatcher(), nullptr);
+    EXPECT_EQ(modelInstance.getDynamicBatcher()->getAdaptiveController(), nullptr);
+}
+
+TEST_F(DynamicBatcherTest, ReducedOutputsAreSplitBackIntoResponses) {
+    ovms::OutputReduction reduction;
+    reduction.type = ovms::OutputReductionType::ARGMAX;
+    config.setOutputReductions({{DUMMY_MODEL_OUTPUT_NAME, reduction}});
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+
+    const size_t numberOfRequests = 6;
+    std::vector<tensorflow::serving::PredictResponse> responses(numberOfRequests);
+    std::vector<ovms::Status> statuses(numberOfRequests);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numberOfRequests; i++) {
+        threads.emplace_back([this, i, &modelInstance, &responses, &statuses]() {
+            // highest value of each row is at index of the request
+            auto request = prepareRequest(1 + i % 2, 0.0);
+            auto& content = *(*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME].mutable_tensor_content();
+            auto data = reinterpret_cast<float*>(&content[0]);
+            for (size_t row = 0; row < 1 + i % 2; row++) {
+                data[row * DUMMY_MODEL_INPUT_SIZE + i] = 5.0f;
+            }
+            auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(modelInstance);
+            statuses[i] = ovms::inference(modelInstance, &request, &responses[i], unloadGuard);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < numberOfRequests; i++) {
+        ASSERT_EQ(statuses[i], ovms::StatusCode::OK) << statuses[i].string();
+        const auto& output = responses[i].outputs().at(DUMMY_MODEL_OUTPUT_NAME);
+        EXPECT_EQ(output.dtype(), tensorflow::DataType::DT_INT64);
+        ASSERT_EQ(output.tensor_shape().dim_size(), 1);
+        EXPECT_EQ(output.tensor_shape().dim(0).size(), 1 + i % 2);
+        EXPECT_THAT(asVector<int64_t>(output.tensor_content()), Each(Eq(static_cast<int64_t>(i))));
+    }
+}
+
+TEST_F(DynamicBatcherTest, UnloadStopsBatcher) {
+    ovms::ModelInstance modelInstance("dummy", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    modelInstance.unloadModel();
+    EXPECT_EQ(modelInstance.getDynamicBatcher(), nullptr);
+}
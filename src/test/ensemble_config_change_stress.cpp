@@ -14,10 +14,21 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "../get_model_metadata_impl.hpp"
+#include "../latencyhistogram.hpp"
 #include "../localfilesystem.hpp"
 #include "../logging.hpp"
 #include "../modelconfig.hpp"
@@ -815,3 +826,229 @@ TEST_F(StressPipelineConfigChanges, RetireSpecificVersionUsedDuringGetMetadataLo
         requiredLoadResults,
         allowedLoadResults);
 }
+
+/**
+ * @brief Measures the cost of config changes for steady predict and pipeline load.
+ *
+ * Direct model predicts and pipeline executions run continuously while model versions are added and retired,
+ * model is reshaped and pipeline is reloaded. Latency percentiles, the longest stall between successful
+ * responses and failed requests are reported per event type a request was started in.
+ * Disabled by default, run with:
+ * bazel test --test_arg=--gtest_also_run_disabled_tests --test_filter='ConfigReloadLatencyBenchmark.*' //src:ovms_test
+ */
+class ConfigReloadLatencyBenchmark : public TestWithTempDir {
+protected:
+    enum Event {
+        STEADY,
+        VERSION_ADD,
+        VERSION_RETIRE,
+        RESHAPE,
+        PIPELINE_RELOAD,
+        EVENTS_COUNT
+    };
+    static constexpr std::array<const char*, EVENTS_COUNT> EVENT_NAMES{"steady", "version add", "version retire", "reshape", "pipeline reload"};
+    // reshape and pipeline reload alternate between changed and original config
+    const std::vector<Event> eventsCycle{VERSION_ADD, VERSION_RETIRE, RESHAPE, RESHAPE, PIPELINE_RELOAD, PIPELINE_RELOAD};
+
+    const uint predictThreadCount = 10;
+    const uint pipelineThreadCount = 10;
+    const uint cyclesCount = 5;
+    const std::chrono::milliseconds steadyLoadTime{200};
+    // requests started shortly after config change finished are still affected by it
+    const std::chrono::milliseconds settleTime{100};
+
+    struct EventStatistics {
+        LatencyHistogram latency;
+        std::atomic<uint64_t> maxStallMicroseconds{0};
+        std::mutex failuresMutex;
+        std::map<StatusCode, uint64_t> failures;
+    };
+
+    struct LoadStatistics {
+        std::array<EventStatistics, EVENTS_COUNT> events;
+        // nanoseconds since steady clock epoch when the last successful response was received
+        std::atomic<int64_t> lastSuccess{0};
+    };
+
+    std::string configFilePath;
+    std::string modelPath;
+    std::atomic<int> currentEvent{STEADY};
+    std::atomic<bool> stopLoad{false};
+    LoadStatistics predictStatistics;
+    LoadStatistics pipelineStatistics;
+    std::array<LatencyHistogram, EVENTS_COUNT> applyTimes;
+    bool reshaped = false;
+    bool pipelineChanged = false;
+
+    const std::vector<float> requestData{1., 2., 3., 7., 5., 6., 4., 9., 10., 8.};
+
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        modelPath = directoryPath + "/dummy/";
+        configFilePath = directoryPath + "/ovms_config.json";
+        std::filesystem::copy("/ovms/src/test/dummy", modelPath, std::filesystem::copy_options::recursive);
+    }
+
+    void writeConfig(const char* configContent) {
+        std::string config = configContent;
+        const std::string modelPathToReplace{"/ovms/src/test/dummy"};
+        config.replace(config.find(modelPathToReplace), modelPathToReplace.size(), modelPath);
+        createConfigFileWithContent(config, configFilePath);
+    }
+
+    void applyEvent(Event event, ModelManager& manager) {
+        switch (event) {
+        case VERSION_ADD:
+            std::filesystem::copy("/ovms/src/test/dummy/1", modelPath + "/2", std::filesystem::copy_options::recursive);
+            manager.updateConfigurationWithoutConfigFile();
+            break;
+        case VERSION_RETIRE:
+            std::filesystem::remove_all(modelPath + "/2");
+            manager.updateConfigurationWithoutConfigFile();
+            break;
+        case RESHAPE:
+            reshaped = !reshaped;
+            writeConfig(reshaped ? stressTestPipelineOneDummyConfigChangedToAuto : stressTestPipelineOneDummyConfig);
+            manager.loadConfig(configFilePath);
+            break;
+        case PIPELINE_RELOAD:
+            pipelineChanged = !pipelineChanged;
+            writeConfig(pipelineChanged ? stressTestPipelineOneDummyConfigChangeConnectionName : stressTestPipelineOneDummyConfig);
+            manager.loadConfig(configFilePath);
+            break;
+        default:
+            break;
+        }
+    }
+
+    static void updateMax(std::atomic<uint64_t>& max, uint64_t value) {
+        uint64_t current = max.load(std::memory_order_relaxed);
+        while (current < value && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void record(LoadStatistics& statistics, int event, std::chrono::steady_clock::time_point start, const Status& status) {
+        auto& eventStatistics = statistics.events[event];
+        if (!status.ok()) {
+            std::lock_guard<std::mutex> lock(eventStatistics.failuresMutex);
+            eventStatistics.failures[status.getCode()]++;
+            return;
+        }
+        const auto end = std::chrono::steady_clock::now();
+        eventStatistics.latency.record(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+        const int64_t endNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()).count();
+        const int64_t previous = statistics.lastSuccess.exchange(endNanoseconds, std::memory_order_relaxed);
+        if (previous > 0 && endNanoseconds > previous) {
+            updateMax(eventStatistics.maxStallMicroseconds, (endNanoseconds - previous) / 1000);
+        }
+    }
+
+    tensorflow::serving::PredictRequest prepareRequest(const std::string& inputName) {
+        tensorflow::serving::PredictRequest request = preparePredictRequest(
+            {{inputName,
+                std::tuple<ovms::shape_t, tensorflow::DataType>{{1, DUMMY_MODEL_INPUT_SIZE}, tensorflow::DataType::DT_FLOAT}}});
+        auto& input = (*request.mutable_inputs())[inputName];
+        input.mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
+        return request;
+    }
+
+    void predictInALoop(ModelManager& manager) {
+        const auto request = prepareRequest(DUMMY_MODEL_INPUT_NAME);
+        while (!stopLoad.load(std::memory_order_relaxed)) {
+            const int event = currentEvent.load(std::memory_order_relaxed);
+            const auto start = std::chrono::steady_clock::now();
+            tensorflow::serving::PredictResponse response;
+            std::shared_ptr<ModelInstance> modelInstance;
+            std::unique_ptr<ModelInstanceUnloadGuard> modelInstanceUnloadGuard;
+            auto status = getModelInstance(manager, "dummy", 0, modelInstance, modelInstanceUnloadGuard);
+            if (status.ok()) {
+                status = inference(*modelInstance, &request, &response, modelInstanceUnloadGuard);
+            }
+            record(predictStatistics, event, start, status);
+        }
+    }
+
+    void executePipelineInALoop(ModelManager& manager) {
+        const auto request = prepareRequest("custom_dummy_input");
+        while (!stopLoad.load(std::memory_order_relaxed)) {
+            const int event = currentEvent.load(std::memory_order_relaxed);
+            const auto start = std::chrono::steady_clock::now();
+            tensorflow::serving::PredictResponse response;
+            std::unique_ptr<Pipeline> pipeline;
+            auto status = manager.createPipeline(pipeline, PIPELINE_1_DUMMY_NAME, &request, &response);
+            if (status.ok()) {
+                status = pipeline->execute();
+            }
+            record(pipelineStatistics, event, start, status);
+        }
+    }
+
+    static std::string milliseconds(uint64_t microseconds) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2f", microseconds / 1000.0);
+        return buffer;
+    }
+
+    void report(const std::string& loadName, LoadStatistics& statistics) {
+        std::cout << loadName << " load" << std::endl;
+        for (int event = 0; event < EVENTS_COUNT; event++) {
+            auto& eventStatistics = statistics.events[event];
+            std::lock_guard<std::mutex> lock(eventStatistics.failuresMutex);
+            uint64_t failed = 0;
+            for (const auto& [code, count] : eventStatistics.failures) {
+                failed += count;
+            }
+            std::cout << "  " << EVENT_NAMES[event]
+                      << ": succeeded: " << eventStatistics.latency.getCount()
+                      << " failed: " << failed
+                      << " latency ms p50: " << milliseconds(eventStatistics.latency.getPercentile(50))
+                      << " p99: " << milliseconds(eventStatistics.latency.getPercentile(99))
+                      << " max: " << milliseconds(eventStatistics.latency.getMax())
+                      << " max stall ms: " << milliseconds(eventStatistics.maxStallMicroseconds.load())
+                      << std::endl;
+            for (const auto& [code, count] : eventStatistics.failures) {
+                std::cout << "    " << Status(code).string() << ": " << count << std::endl;
+            }
+        }
+    }
+};
+
+TEST_F(ConfigReloadLatencyBenchmark, DISABLED_LatencyUnderConfigChanges) {
+    ConstructorEnabledModelManager manager;
+    writeConfig(stressTestPipelineOneDummyConfig);
+    ASSERT_EQ(manager.loadConfig(configFilePath), StatusCode::OK);
+
+    std::vector<std::thread> workers;
+    for (uint i = 0; i < predictThreadCount; i++) {
+        workers.emplace_back([this, &manager]() { predictInALoop(manager); });
+    }
+    for (uint i = 0; i < pipelineThreadCount; i++) {
+        workers.emplace_back([this, &manager]() { executePipelineInALoop(manager); });
+    }
+    std::this_thread::sleep_for(steadyLoadTime);
+    for (uint cycle = 0; cycle < cyclesCount; cycle++) {
+        for (auto event : eventsCycle) {
+            currentEvent = event;
+            const auto start = std::chrono::steady_clock::now();
+            applyEvent(event, manager);
+            const auto applyTime = applyTimes[event].recordSince(start);
+            SPDLOG_INFO("Config change: {} applied in {} ms", EVENT_NAMES[event], milliseconds(applyTime));
+            std::this_thread::sleep_for(settleTime);
+            currentEvent = STEADY;
+            std::this_thread::sleep_for(steadyLoadTime);
+        }
+    }
+    stopLoad = true;
+    std::for_each(workers.begin(), workers.end(), [](auto& worker) { worker.join(); });
+
+    for (int event = VERSION_ADD; event < EVENTS_COUNT; event++) {
+        std::cout << "Config change: " << EVENT_NAMES[event]
+                  << " count: " << applyTimes[event].getCount()
+                  << " apply time ms mean: " << milliseconds(static_cast<uint64_t>(applyTimes[event].getMean()))
+                  << " max: " << milliseconds(applyTimes[event].getMax()) << std::endl;
+    }
+    report("Predict", predictStatistics);
+    report("Pipeline", pipelineStatistics);
+    EXPECT_GT(predictStatistics.events[STEADY].latency.getCount(), 0);
+    EXPECT_GT(pipelineStatistics.events[STEADY].latency.getCount(), 0);
+}
@@ -13,25 +13,37 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
 #include <sstream>
+#include <thread>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "../demultiplexer_node.hpp"
+#include "../executinstreamidguard.hpp"
+#include "../fused_node.hpp"
+#include "../gate_node.hpp"
 #include "../modelconfig.hpp"
 #include "../pipeline.hpp"
 #include "../pipeline_factory.hpp"
+#include "../pipelinescheduler.hpp"
 #define DEBUG
 #include <cstdio>
 
 #include <stdlib.h>
 
+#include "../blobpool.hpp"
 #include "../localfilesystem.hpp"
 #include "../logging.hpp"
 #include "../modelinstance.hpp"
 #include "../prediction_service_utils.hpp"
 #include "../status.hpp"
 #include "../timer.hpp"
+#include "fakeremotecontext.hpp"
 #include "test_utils.hpp"
 
 using namespace ovms;
@@ -133,6 +145,287 @@ TEST_F(EnsembleFlowTest, DummyModel) {
     checkDummyResponse(dummySeriallyConnectedCount);
 }
 
+namespace {
+class OVInferRequestsQueueWithRemoteContext : public ovms::OVInferRequestsQueue {
+public:
+    OVInferRequestsQueueWithRemoteContext(InferenceEngine::ExecutableNetwork& network, int streamsLength, int maxStreamsLength, InferenceEngine::RemoteContext::Ptr context) :
+        OVInferRequestsQueue(network, streamsLength, maxStreamsLength) {
+        remoteContext = std::move(context);
+        deviceOutputBlobPool = std::make_shared<ovms::BlobPool>(getCapacity(), remoteContext);
+    }
+};
+
+class ModelInstanceWithRemoteContext : public ovms::ModelInstance {
+public:
+    ModelInstanceWithRemoteContext(const std::string& name, ovms::model_version_t version, InferenceEngine::RemoteContext::Ptr context) :
+        ModelInstance(name, version),
+        context(std::move(context)) {}
+
+protected:
+    std::unique_ptr<ovms::OVInferRequestsQueue> createInferRequestsQueue(InferenceEngine::ExecutableNetwork& network, uint32_t nireq, uint32_t maxNireq) override {
+        return std::make_unique<OVInferRequestsQueueWithRemoteContext>(network, nireq, maxNireq, context);
+    }
+
+private:
+    const InferenceEngine::RemoteContext::Ptr context;
+};
+
+class ModelWithRemoteContext : public ovms::Model {
+public:
+    ModelWithRemoteContext(const std::string& name, InferenceEngine::RemoteContext::Ptr context) :
+        Model(name),
+        context(std::move(context)) {}
+
+protected:
+    std::shared_ptr<ovms::ModelInstance> modelInstanceFactory(const std::string& modelName, const ovms::model_version_t version) override {
+        return std::make_shared<ModelInstanceWithRemoteContext>(modelName, version, context);
+    }
+
+private:
+    const InferenceEngine::RemoteContext::Ptr context;
+};
+
+class ModelManagerWithRemoteContext : public ConstructorEnabledModelManager {
+public:
+    ModelManagerWithRemoteContext(const std::string& deviceModelName, InferenceEngine::RemoteContext::Ptr context) :
+        deviceModelName(deviceModelName),
+        context(std::move(context)) {}
+
+    std::shared_ptr<ovms::Model> modelFactory(const std::string& name) override {
+        if (name == deviceModelName) {
+            return std::make_shared<ModelWithRemoteContext>(name, context);
+        }
+        return ConstructorEnabledModelManager::modelFactory(name);
+    }
+
+private:
+    const std::string deviceModelName;
+    const InferenceEngine::RemoteContext::Ptr context;
+};
+}  // namespace
+
+class EnsembleFlowDeviceResidentOutputsTest : public EnsembleFlowTest {
+protected:
+    // input   dummy(device outputs)   second   output
+    //  O------------->O------------------>O------->O
+    void executeChain(ModelManager& manager, const std::string& secondModelName) {
+        auto input_node = std::make_unique<EntryNode>(&request);
+        auto first_node = std::make_unique<DLNode>("dummy_node_1", dummyModelName, requestedModelVersion, manager);
+        first_node->setDeviceResidentOutputs({DUMMY_MODEL_OUTPUT_NAME});
+        auto second_node = std::make_unique<DLNode>("dummy_node_2", secondModelName, requestedModelVersion, manager);
+        auto output_node = std::make_unique<ExitNode>(&response);
+
+        Pipeline pipeline(*input_node, *output_node);
+        pipeline.connect(*input_node, *first_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+        pipeline.connect(*first_node, *second_node, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_INPUT_NAME}});
+        pipeline.connect(*second_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+
+        pipeline.push(std::move(input_node));
+        pipeline.push(std::move(first_node));
+        pipeline.push(std::move(second_node));
+        pipeline.push(std::move(output_node));
+
+        ASSERT_EQ(pipeline.execute(), StatusCode::OK);
+    }
+
+    void expectHostOutputsOnInferRequests(ModelManager& manager) {
+        auto instance = manager.findModelInstance(dummyModelName);
+        ASSERT_NE(instance, nullptr);
+        auto& queue = instance->getInferRequestsQueue();
+        for (size_t streamId = 0; streamId < queue.getInferRequestsCount(); ++streamId) {
+            auto blob = queue.getInferRequest(streamId).GetBlob(DUMMY_MODEL_OUTPUT_NAME);
+            EXPECT_EQ(blob->as<InferenceEngine::RemoteBlob>(), nullptr) << "stream: " << streamId;
+        }
+    }
+
+    std::shared_ptr<FakeRemoteContext> context = std::make_shared<FakeRemoteContext>();
+};
+
+TEST_F(EnsembleFlowDeviceResidentOutputsTest, OutputIsPassedInDeviceMemoryAndHostBlobIsRestored) {
+    ModelManagerWithRemoteContext manager(dummyModelName, context);
+    manager.reloadModelWithVersions(config);
+    auto instance = manager.findModelInstance(dummyModelName);
+    ASSERT_NE(instance, nullptr);
+    ASSERT_NE(instance->getInferRequestsQueue().getDeviceOutputBlobPool(), nullptr);
+
+    executeChain(manager, dummyModelName);
+    checkDummyResponse(2);
+    EXPECT_EQ(context->createdBlobs, 1);
+    expectHostOutputsOnInferRequests(manager);
+    // device blob is back in the pool once the second node released its input
+    EXPECT_EQ(instance->getInferRequestsQueue().getDeviceOutputBlobPool()->getIdleBlobsCount(DUMMY_MODEL_OUTPUT_NAME), 1);
+
+    response.Clear();
+    executeChain(manager, dummyModelName);
+    checkDummyResponse(2);
+    EXPECT_EQ(context->createdBlobs, 1);
+}
+
+TEST_F(EnsembleFlowDeviceResidentOutputsTest, OutputInMemoryOfOtherDeviceIsDownloadedBeforeUse) {
+    ModelManagerWithRemoteContext manager(dummyModelName, context);
+    manager.reloadModelWithVersions(config);
+    const std::string hostModelName = "dummy_host";
+    ModelConfig hostConfig = config;
+    hostConfig.setName(hostModelName);
+    manager.reloadModelWithVersions(hostConfig);
+    auto hostInstance = manager.findModelInstance(hostModelName);
+    ASSERT_NE(hostInstance, nullptr);
+    ASSERT_EQ(hostInstance->getInferRequestsQueue().getRemoteContext(), nullptr);
+
+    executeChain(manager, hostModelName);
+    checkDummyResponse(2);
+    EXPECT_EQ(context->createdBlobs, 1);
+    expectHostOutputsOnInferRequests(manager);
+}
+
+TEST_F(EnsembleFlowDeviceResidentOutputsTest, OutputStaysOnHostWhenDeviceBlobCannotBeAllocated) {
+    ModelManagerWithRemoteContext manager(dummyModelName, context);
+    manager.reloadModelWithVersions(config);
+    context->failing = true;
+
+    executeChain(manager, dummyModelName);
+    checkDummyResponse(2);
+    EXPECT_EQ(context->createdBlobs, 0);
+    expectHostOutputsOnInferRequests(manager);
+    auto instance = manager.findModelInstance(dummyModelName);
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(instance->getInferRequestsQueue().getDeviceOutputBlobPool()->getIdleBlobsCount(DUMMY_MODEL_OUTPUT_NAME), 0);
+}
+
+TEST_F(EnsembleFlowTest, DummyModelExecutedAsynchronouslyByScheduler) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    config.setNireq(1);
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    // two dummy nodes in parallel with nireq=1, the second one is deferred until the first one returns its stream
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto dummy_node_1 = std::make_unique<DLNode>("dummy_node_1", dummyModelName, requestedModelVersion, managerWithDummyModel);
+    auto dummy_node_2 = std::make_unique<DLNode>("dummy_node_2", dummyModelName, requestedModelVersion, managerWithDummyModel);
+    auto output_node = std::make_unique<ExitNode>(&response);
+
+    auto pipeline = std::make_unique<Pipeline>(*input_node, *output_node);
+    pipeline->connect(*input_node, *dummy_node_1, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline->connect(*input_node, *dummy_node_2, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline->connect(*dummy_node_1, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+    pipeline->connect(*dummy_node_2, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, "other_output"}});
+
+    pipeline->push(std::move(input_node));
+    pipeline->push(std::move(dummy_node_1));
+    pipeline->push(std::move(dummy_node_2));
+    pipeline->push(std::move(output_node));
+
+    ovms::PipelineScheduler scheduler(2);
+    std::promise<ovms::Status> finished;
+    pipeline->executeAsync(scheduler, [&finished, &pipeline](ovms::Status status) {
+        // pipeline can be destroyed from its completion callback
+        pipeline.reset();
+        finished.set_value(status);
+    });
+    auto finishedFuture = finished.get_future();
+    ASSERT_EQ(finishedFuture.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    ASSERT_EQ(finishedFuture.get(), ovms::StatusCode::OK);
+    EXPECT_EQ(pipeline, nullptr);
+    EXPECT_EQ(response.outputs().count("other_output"), 1);
+    const int dummySeriallyConnectedCount = 1;
+    checkDummyResponse(dummySeriallyConnectedCount);
+}
+
+TEST_F(EnsembleFlowTest, DummyModelExecutedAsynchronouslyFailsOnDeadlineWhileWaitingForStream) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    config.setNireq(1);
+    managerWithDummyModel.reloadModelWithVersions(config);
+    auto instance = managerWithDummyModel.findModelInstance(dummyModelName);
+    ASSERT_NE(instance, nullptr);
+    // the only stream is taken, so the node is deferred and no node sends a message until the deadline
+    auto takenStream = std::make_unique<ovms::ExecutingStreamIdGuard>(instance->getInferRequestsQueue());
+
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto model_node = std::make_unique<DLNode>("dummy_node", dummyModelName, requestedModelVersion, managerWithDummyModel);
+    auto output_node = std::make_unique<ExitNode>(&response);
+    auto pipeline = std::make_unique<Pipeline>(*input_node, *output_node);
+    pipeline->connect(*input_node, *model_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline->connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+    pipeline->push(std::move(input_node));
+    pipeline->push(std::move(model_node));
+    pipeline->push(std::move(output_node));
+    pipeline->setDeadline(ovms::deadlineAfter(std::chrono::milliseconds(50)));
+
+    ovms::PipelineScheduler scheduler(1);
+    std::promise<ovms::Status> finished;
+    pipeline->executeAsync(scheduler, [&finished, &pipeline](ovms::Status status) {
+        pipeline.reset();
+        finished.set_value(status);
+    });
+    auto finishedFuture = finished.get_future();
+    const auto waitStatus = finishedFuture.wait_for(std::chrono::seconds(10));
+    // stream is returned only after the pipeline gave up waiting for it
+    takenStream.reset();
+    ASSERT_EQ(waitStatus, std::future_status::ready);
+    EXPECT_EQ(finishedFuture.get(), ovms::StatusCode::DEADLINE_EXCEEDED);
+    auto streamId = instance->getInferRequestsQueue().tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    instance->getInferRequestsQueue().returnStream(streamId.value());
+}
+
+TEST_F(EnsembleFlowTest, DummyModelNodesOfConcurrentPipelinesAreBatched) {
+    config.setBatchingParams("0");
+    config.setDynamicBatchingMaxBatchSize(4);
+    config.setDynamicBatchingMaxQueueDelayMicroseconds(100'000);
+    config.setNireq(1);
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    const size_t numberOfPipelines = 4;
+    std::vector<PredictResponse> responses(numberOfPipelines);
+    std::vector<ovms::Status> statuses(numberOfPipelines);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numberOfPipelines; i++) {
+        threads.emplace_back([this, i, &managerWithDummyModel, &responses, &statuses]() {
+            auto input_node = std::make_unique<EntryNode>(&request);
+            auto model_node = std::make_unique<DLNode>("dummy_node", dummyModelName, requestedModelVersion, managerWithDummyModel);
+            auto output_node = std::make_unique<ExitNode>(&responses[i]);
+
+            Pipeline pipeline(*input_node, *output_node);
+            pipeline.connect(*input_node, *model_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+            pipeline.connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+
+            pipeline.push(std::move(input_node));
+            pipeline.push(std::move(model_node));
+            pipeline.push(std::move(output_node));
+            statuses[i] = pipeline.execute();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < numberOfPipelines; i++) {
+        ASSERT_EQ(statuses[i], ovms::StatusCode::OK) << statuses[i].string();
+        const int dummySeriallyConnectedCount = 1;
+        ::checkDummyResponse(customPipelineOutputName, requestData, request, responses[i], dummySeriallyConnectedCount);
+    }
+}
+
+TEST_F(EnsembleFlowTest, ExitNodeSkipsOutputsNotInOutputFilter) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    request.add_output_filter("other_output");
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto model_node = std::make_unique<DLNode>("dummy_node", dummyModelName, requestedModelVersion, managerWithDummyModel);
+    auto output_node = std::make_unique<ExitNode>(&response, &request.output_filter());
+
+    Pipeline pipeline(*input_node, *output_node);
+    pipeline.connect(*input_node, *model_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline.connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+
+    pipeline.push(std::move(input_node));
+    pipeline.push(std::move(model_node));
+    pipeline.push(std::move(output_node));
+
+    ASSERT_EQ(pipeline.execute(), ovms::StatusCode::OK);
+    EXPECT_EQ(response.outputs().count(customPipelineOutputName), 0);
+}
+
 TEST_F(EnsembleFlowTest, DummyModelDirectAndPipelineInference) {
     ConstructorEnabledModelManager managerWithDummyModel;
     config.setNireq(1);
@@ -252,48 +545,509 @@ TEST_F(EnsembleFlowTest, SeriesOfDummyModels) {
     std::cout << "compare results: " << timer.elapsed<std::chrono::microseconds>("compare results") / 1000 << "ms\n";
 }
 
-TEST_F(EnsembleFlowTest, ExecutePipelineWithDynamicBatchSize) {
-    // Scenario
+TEST_F(EnsembleFlowTest, ExecutePipelineWithDynamicBatchSize) {
+    // Scenario
+
+    // input(3x10)   dummy(1x10), change batch size    output(3x10)
+    //  O-------------------------->O----------------------->O
+
+    // input 3x10
+    // dummy is 1x10, perform model batch size change to 3x10
+    // process dummy
+    // check if output is 3x10
+
+    tensorflow::TensorProto& proto = (*request.mutable_inputs())[customPipelineInputName];
+    const int batchSize = 3;
+    proto.mutable_tensor_shape()->mutable_dim(0)->set_size(batchSize);
+    requestData = {
+        -5, -4, -3, -2, -1, 1, 2, 3, 4, 5,            // batch 1
+        -15, -14, -13, -12, -11, 11, 12, 13, 14, 15,  // batch 2
+        -25, -24, -23, -22, -21, 21, 22, 23, 24, 25,  // batch 3
+    };
+    proto.mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
+
+    config.setBatchingParams("auto");
+    ConstructorEnabledModelManager managerWithDynamicBatchDummyModel;
+    managerWithDynamicBatchDummyModel.reloadModelWithVersions(config);
+
+    // Configure pipeline
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto model_node = std::make_unique<DLNode>("dummy_node", dummyModelName, requestedModelVersion, managerWithDynamicBatchDummyModel);
+    auto output_node = std::make_unique<ExitNode>(&response);
+
+    Pipeline pipeline(*input_node, *output_node);
+
+    pipeline.connect(*input_node, *model_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline.connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+
+    pipeline.push(std::move(input_node));
+    pipeline.push(std::move(model_node));
+    pipeline.push(std::move(output_node));
+
+    pipeline.execute();
+    const int seriallyConnectedDummyModels = 1;
+    checkDummyResponse(seriallyConnectedDummyModels, batchSize);
+}
+
+TEST_F(EnsembleFlowTest, ExecutePipelineWithDemultiplexerNodes) {
+    // Scenario
+
+    // input(3x10)   demultiplexer dummy(1x10)   demultiplexer dummy(1x10)   output(3x10)
+    //  O------------------>O--------------------------->O---------------------->O
+
+    // each element of the batch is inferred separately, there are more elements than infer requests
+    tensorflow::TensorProto& proto = (*request.mutable_inputs())[customPipelineInputName];
+    const int batchSize = 3;
+    proto.mutable_tensor_shape()->mutable_dim(0)->set_size(batchSize);
+    requestData = {
+        -5, -4, -3, -2, -1, 1, 2, 3, 4, 5,            // batch 1
+        -15, -14, -13, -12, -11, 11, 12, 13, 14, 15,  // batch 2
+        -25, -24, -23, -22, -21, 21, 22, 23, 24, 25,  // batch 3
+    };
+    proto.mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
+
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto first_node = std::make_unique<DemultiplexerNode>("first_node", dummyModelName, requestedModelVersion, managerWithDummyModel);
+    auto second_node = std::make_unique<DemultiplexerNode>("second_node", dummyModelName, requestedModelVersion, managerWithDummyModel);
+    auto output_node = std::make_unique<ExitNode>(&response);
+
+    Pipeline pipeline(*input_node, *output_node);
+
+    pipeline.connect(*input_node, *first_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline.connect(*first_node, *second_node, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_INPUT_NAME}});
+    pipeline.connect(*second_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+
+    pipeline.push(std::move(input_node));
+    pipeline.push(std::move(first_node));
+    pipeline.push(std::move(second_node));
+    pipeline.push(std::move(output_node));
+
+    ASSERT_EQ(pipeline.execute(), StatusCode::OK);
+    const int seriallyConnectedDummyModels = 2;
+    checkDummyResponse(seriallyConnectedDummyModels, batchSize);
+}
+
+TEST_F(EnsembleFlowTest, ExecutePipelineWithDemultiplexedSteps) {
+    // Scenario
+
+    // input(3x10)   demultiplexer dummy(1x10) -> dummy(1x10) -> dummy(1x10) per element   output(3x10)
+    //  O------------------------------------------>O------------------------------------------>O
+
+    // each element is inferred by all steps independently of other elements, only the last step outputs are gathered
+    tensorflow::TensorProto& proto = (*request.mutable_inputs())[customPipelineInputName];
+    const int batchSize = 3;
+    proto.mutable_tensor_shape()->mutable_dim(0)->set_size(batchSize);
+    requestData = {
+        -5, -4, -3, -2, -1, 1, 2, 3, 4, 5,            // batch 1
+        -15, -14, -13, -12, -11, 11, 12, 13, 14, 15,  // batch 2
+        -25, -24, -23, -22, -21, 21, 22, 23, 24, 25,  // batch 3
+    };
+    proto.mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
+
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<DemultiplexedStep> steps{
+        {"second_step", dummyModelName, requestedModelVersion, {{"second_output", DUMMY_MODEL_OUTPUT_NAME}},
+            {{"per_element_node", {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_INPUT_NAME}}}}},
+        {"third_step", dummyModelName, requestedModelVersion, {},
+            {{"second_step", {{"second_output", DUMMY_MODEL_INPUT_NAME}}}}},
+    };
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto demultiplexer_node = std::make_unique<DemultiplexerNode>("per_element_node", dummyModelName, requestedModelVersion, managerWithDummyModel,
+        std::unordered_map<std::string, std::string>{}, std::move(steps));
+    auto output_node = std::make_unique<ExitNode>(&response);
+
+    Pipeline pipeline(*input_node, *output_node);
+
+    pipeline.connect(*input_node, *demultiplexer_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline.connect(*demultiplexer_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+
+    pipeline.push(std::move(input_node));
+    pipeline.push(std::move(demultiplexer_node));
+    pipeline.push(std::move(output_node));
+
+    ASSERT_EQ(pipeline.execute(), StatusCode::OK);
+    const int seriallyConnectedDummyModels = 3;
+    checkDummyResponse(seriallyConnectedDummyModels, batchSize);
+}
+
+TEST_F(EnsembleFlowTest, ExecutePipelineWithFusedModels) {
+    // Scenario
+
+    // input(1x10)   dummy(1x10) + dummy(1x10) fused into one network   output(1x10)
+    //  O---------------------------------->O--------------------------------->O
+
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+    auto model = managerWithDummyModel.findModelInstance(dummyModelName);
+    ASSERT_NE(model, nullptr);
+    ASSERT_TRUE(FusedNetwork::isFusible(*model));
+
+    std::vector<FusedNetwork::Stage> stages{
+        {"first_node", model, {}, {}},
+        {"second_node", model, {}, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_INPUT_NAME}}},
+    };
+    std::shared_ptr<FusedNetwork> fused;
+    ASSERT_EQ(FusedNetwork::create(stages, fused), StatusCode::OK);
+    ASSERT_NE(fused, nullptr);
+    EXPECT_EQ(fused->getName(), "first_node+second_node");
+
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto fused_node = std::make_unique<FusedNode>("second_node", fused);
+    auto output_node = std::make_unique<ExitNode>(&response);
+
+    Pipeline pipeline(*input_node, *output_node);
+    pipeline.connect(*input_node, *fused_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline.connect(*fused_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+    pipeline.push(std::move(input_node));
+    pipeline.push(std::move(fused_node));
+    pipeline.push(std::move(output_node));
+
+    ASSERT_EQ(pipeline.execute(), StatusCode::OK);
+    const int seriallyConnectedDummyModels = 2;
+    checkDummyResponse(seriallyConnectedDummyModels);
+}
+
+TEST_F(EnsembleFlowTest, ModelsWithMismatchedConnectionAreNotFused) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+    auto model = managerWithDummyModel.findModelInstance(dummyModelName);
+    ASSERT_NE(model, nullptr);
+
+    // second stage reads output which the first model does not have
+    std::vector<FusedNetwork::Stage> stages{
+        {"first_node", model, {}, {}},
+        {"second_node", model, {}, {{"missing_output", DUMMY_MODEL_INPUT_NAME}}},
+    };
+    std::shared_ptr<FusedNetwork> fused;
+    EXPECT_FALSE(FusedNetwork::create(stages, fused).ok());
+    EXPECT_EQ(fused, nullptr);
+}
+
+class PipelineDefinitionFusingModels : public PipelineDefinition {
+public:
+    PipelineDefinitionFusingModels(const std::string& pipelineName,
+        const std::vector<NodeInfo>& nodeInfos,
+        const pipeline_connections_t& connections) :
+        PipelineDefinition(pipelineName, nodeInfos, connections) {}
+
+    size_t getFusedNetworksCount() const {
+        return fusedNetworks.size();
+    }
+
+    size_t createdNetworksCount = 0;
+    bool failCreation = false;
+
+protected:
+    Status createFusedNetwork(const std::vector<FusedNetwork::Stage>& stages, std::shared_ptr<FusedNetwork>& fused) override {
+        ++createdNetworksCount;
+        if (failCreation) {
+            return Status(StatusCode::INTERNAL_ERROR, "fusing disabled by test");
+        }
+        return PipelineDefinition::createFusedNetwork(stages, fused);
+    }
+};
+
+class EnsembleFlowFusionTest : public EnsembleFlowTest {
+protected:
+    void SetUp() override {
+        EnsembleFlowTest::SetUp();
+        manager.setPipelineModelsFusionEnabled(true);
+        manager.reloadModelWithVersions(config);
+    }
+
+    // entry -> first_node -> second_node -> exit, optionally first_node -> exit as well
+    std::unique_ptr<PipelineDefinitionFusingModels> createChainDefinition(bool firstNodeReadByExit = false) {
+        std::vector<NodeInfo> info{
+            {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+            {NodeKind::DL, "first_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+            {NodeKind::DL, "second_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+            {NodeKind::EXIT, EXIT_NODE_NAME},
+        };
+        pipeline_connections_t connections;
+        connections["first_node"] = {
+            {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+        connections["second_node"] = {
+            {"first_node", {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_INPUT_NAME}}}};
+        connections[EXIT_NODE_NAME] = {
+            {"second_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+        if (firstNodeReadByExit) {
+            connections[EXIT_NODE_NAME]["first_node"] = {{DUMMY_MODEL_OUTPUT_NAME, "first_output"}};
+        }
+        return std::make_unique<PipelineDefinitionFusingModels>("fused", info, connections);
+    }
+
+    void executeAndCheckChain(PipelineDefinition& pd) {
+        response.Clear();
+        std::unique_ptr<Pipeline> pipeline;
+        ASSERT_EQ(pd.create(pipeline, &request, &response, manager), StatusCode::OK);
+        ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+        const int seriallyConnectedDummyModels = 2;
+        checkDummyResponse(seriallyConnectedDummyModels);
+    }
+
+    ConstructorEnabledModelManager manager;
+};
+
+TEST_F(EnsembleFlowFusionTest, ChainOfModelsIsInferredByFusedNetworkReusedOnRevalidation) {
+    auto pd = createChainDefinition();
+    ASSERT_EQ(pd->validate(manager), StatusCode::OK);
+    EXPECT_EQ(pd->createdNetworksCount, 1);
+    ASSERT_EQ(pd->getFusedNetworksCount(), 1);
+    // entry, fused node and exit
+    const auto& steps = pd->getExecutionPlan().steps;
+    ASSERT_EQ(steps.size(), 3);
+    EXPECT_EQ(std::count_if(steps.begin(), steps.end(), [](const auto& step) { return step.fusedNetwork != nullptr; }), 1);
+    executeAndCheckChain(*pd);
+
+    // models did not change, network is not compiled again
+    ASSERT_EQ(pd->validate(manager), StatusCode::OK);
+    EXPECT_EQ(pd->createdNetworksCount, 1);
+    EXPECT_EQ(pd->getFusedNetworksCount(), 1);
+    executeAndCheckChain(*pd);
+}
+
+TEST_F(EnsembleFlowFusionTest, NodeWithTwoDependantsIsNotFused) {
+    auto pd = createChainDefinition(true);
+    ASSERT_EQ(pd->validate(manager), StatusCode::OK);
+    EXPECT_EQ(pd->createdNetworksCount, 0);
+    EXPECT_EQ(pd->getFusedNetworksCount(), 0);
+    EXPECT_EQ(pd->getExecutionPlan().steps.size(), 4);
+    executeAndCheckChain(*pd);
+    ASSERT_EQ(response.outputs().count("first_output"), 1);
+}
+
+TEST_F(EnsembleFlowFusionTest, ChainIsInferredNodeByNodeWhenFusingFails) {
+    auto pd = createChainDefinition();
+    pd->failCreation = true;
+    ASSERT_EQ(pd->validate(manager), StatusCode::OK);
+    EXPECT_EQ(pd->createdNetworksCount, 1);
+    EXPECT_EQ(pd->getFusedNetworksCount(), 0);
+    const auto& steps = pd->getExecutionPlan().steps;
+    ASSERT_EQ(steps.size(), 4);
+    EXPECT_TRUE(std::none_of(steps.begin(), steps.end(), [](const auto& step) { return step.fusedNetwork != nullptr; }));
+    executeAndCheckChain(*pd);
+}
+
+TEST_F(EnsembleFlowTest, CachedResultsOfNodeAreReturnedWithoutInference) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    // results are memoized for model version and content of inputs as received from entry node
+    InferenceEngine::TensorDesc inputDesc{InferenceEngine::Precision::FP32, {1, DUMMY_MODEL_INPUT_SIZE}, InferenceEngine::Layout::NC};
+    BlobMap inputs{{DUMMY_MODEL_INPUT_NAME, InferenceEngine::make_shared_blob<float>(inputDesc, requestData.data())}};
+    std::vector<float> cachedData(DUMMY_MODEL_OUTPUT_SIZE, 42.0);
+    auto cachedOutputs = std::make_shared<BlobMap>();
+    cachedOutputs->emplace(DUMMY_MODEL_OUTPUT_NAME, InferenceEngine::make_shared_blob<float>(inputDesc, cachedData.data()));
+    auto resultCache = std::make_shared<node_result_cache_t>(1);
+    resultCache->put(DLNode::createResultCacheKey(1, inputs), cachedOutputs);
+
+    auto input_node = std::make_unique<EntryNode>(&request);
+    auto model_node = std::make_unique<DLNode>("dummy_node", dummyModelName, requestedModelVersion, managerWithDummyModel);
+    model_node->setResultCache(resultCache);
+    auto output_node = std::make_unique<ExitNode>(&response);
+
+    Pipeline pipeline(*input_node, *output_node);
+    pipeline.connect(*input_node, *model_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
+    pipeline.connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+    pipeline.push(std::move(input_node));
+    pipeline.push(std::move(model_node));
+    pipeline.push(std::move(output_node));
+    ASSERT_EQ(pipeline.execute(), StatusCode::OK);
+
+    const auto& output_proto = response.outputs().at(customPipelineOutputName);
+    ASSERT_EQ(output_proto.tensor_content().size(), DUMMY_MODEL_OUTPUT_SIZE * sizeof(float));
+    EXPECT_EQ(std::memcmp(output_proto.tensor_content().data(), cachedData.data(), output_proto.tensor_content().size()), 0);
+}
+
+TEST(DLNodeI64Conversion, I64BlobIsNarrowedIntoI32BlobOfTheSameShape) {
+    std::vector<int64_t> data{1, -1, 0x100000007LL, 5, 6, 7};
+    InferenceEngine::TensorDesc description{InferenceEngine::Precision::I64, {2, 3}, InferenceEngine::Layout::NC};
+    InferenceEngine::Blob::Ptr blob = InferenceEngine::make_shared_blob<int64_t>(description, data.data());
+    DLNode::narrowI64Blob(blob);
+    ASSERT_EQ(blob->getTensorDesc().getPrecision(), InferenceEngine::Precision::I32);
+    EXPECT_EQ(blob->getTensorDesc().getDims(), (InferenceEngine::SizeVector{2, 3}));
+    const int32_t* narrowed = blob->cbuffer().as<const int32_t*>();
+    EXPECT_EQ(std::vector<int32_t>(narrowed, narrowed + data.size()), (std::vector<int32_t>{1, -1, 7, 5, 6, 7}));
+}
+
+TEST_F(EnsembleFlowTest, CacheableNodeMemoizesResultsOfDistinctInputs) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    info[1].resultCacheSize = 2;
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("cacheable", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+    const auto& resultCache = pd.getExecutionPlan().steps[1].resultCache;
+    ASSERT_NE(resultCache, nullptr);
+
+    for (int i = 0; i < 2; ++i) {
+        response.Clear();
+        std::unique_ptr<Pipeline> pipeline;
+        ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+        ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+        checkDummyResponse(1);
+        EXPECT_EQ(resultCache->size(), 1);
+    }
+
+    requestData[0] += 1.0;
+    (*request.mutable_inputs())[customPipelineInputName].mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
+    response.Clear();
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(1);
+    EXPECT_EQ(resultCache->size(), 2);
+}
+
+TEST_F(EnsembleFlowTest, PipelineDefinitionRecordsLatencyHistograms) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("measured", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+
+    const int requestsCount = 3;
+    for (int i = 0; i < requestsCount; ++i) {
+        response.Clear();
+        std::unique_ptr<Pipeline> pipeline;
+        ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+        ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+        checkDummyResponse(1);
+    }
+
+    const auto& metrics = pd.getMetrics();
+    EXPECT_EQ(metrics.getEndToEnd().getCount(), requestsCount);
+    // entry and exit nodes are not measured
+    auto nodes = metrics.getNodes();
+    ASSERT_EQ(nodes.size(), 1);
+    EXPECT_EQ(nodes[0].first, "dummy_node");
+    for (auto stage : {NodeStage::STREAM_WAIT, NodeStage::INPUT_SETUP, NodeStage::INFERENCE, NodeStage::FETCH_RESULTS}) {
+        EXPECT_EQ(nodes[0].second->get(stage).getCount(), requestsCount) << toString(stage);
+    }
+    EXPECT_LE(nodes[0].second->get(NodeStage::INFERENCE).getMax(), metrics.getEndToEnd().getMax());
+}
+
+TEST_F(EnsembleFlowTest, DemultiplexerNodeIsCreatedFromPipelineDefinition) {
+    NodeKind kind;
+    ASSERT_EQ(toNodeKind("Demultiplexer", kind), StatusCode::OK);
+    ASSERT_EQ(kind, NodeKind::DEMULTIPLEXER);
+
+    tensorflow::TensorProto& proto = (*request.mutable_inputs())[customPipelineInputName];
+    const int batchSize = 2;
+    proto.mutable_tensor_shape()->mutable_dim(0)->set_size(batchSize);
+    requestData = {
+        -5, -4, -3, -2, -1, 1, 2, 3, 4, 5,
+        -15, -14, -13, -12, -11, 11, 12, 13, 14, 15};
+    proto.mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
+
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    // demultiplexed node output is gathered into batch of elements, shapes are validated without 0th dimension
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::DEMULTIPLEXER, "per_element_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections["per_element_node"] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"per_element_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("demultiplexed", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
 
-    // input(3x10)   dummy(1x10), change batch size    output(3x10)
-    //  O-------------------------->O----------------------->O
+    // batch of the first model does not match, only the demultiplexer accepts any number of elements
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    EXPECT_EQ(pipeline->execute(), StatusCode::INVALID_BATCH_SIZE);
 
-    // input 3x10
-    // dummy is 1x10, perform model batch size change to 3x10
-    // process dummy
-    // check if output is 3x10
+    connections["per_element_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"per_element_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    info.erase(info.begin() + 1);
+    connections.erase("dummy_node");
+    PipelineDefinition demultiplexedOnly("demultiplexed_only", info, connections);
+    ASSERT_EQ(demultiplexedOnly.validate(managerWithDummyModel), StatusCode::OK);
+    response.Clear();
+    ASSERT_EQ(demultiplexedOnly.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(1, batchSize);
+}
 
+TEST_F(EnsembleFlowTest, DemultiplexedNodesAreCreatedFromPipelineDefinition) {
     tensorflow::TensorProto& proto = (*request.mutable_inputs())[customPipelineInputName];
-    const int batchSize = 3;
+    const int batchSize = 2;
     proto.mutable_tensor_shape()->mutable_dim(0)->set_size(batchSize);
     requestData = {
-        -5, -4, -3, -2, -1, 1, 2, 3, 4, 5,            // batch 1
-        -15, -14, -13, -12, -11, 11, 12, 13, 14, 15,  // batch 2
-        -25, -24, -23, -22, -21, 21, 22, 23, 24, 25,  // batch 3
-    };
+        -5, -4, -3, -2, -1, 1, 2, 3, 4, 5,
+        -15, -14, -13, -12, -11, 11, 12, 13, 14, 15};
     proto.mutable_tensor_content()->assign((char*)requestData.data(), requestData.size() * sizeof(float));
 
-    config.setBatchingParams("auto");
-    ConstructorEnabledModelManager managerWithDynamicBatchDummyModel;
-    managerWithDynamicBatchDummyModel.reloadModelWithVersions(config);
-
-    // Configure pipeline
-    auto input_node = std::make_unique<EntryNode>(&request);
-    auto model_node = std::make_unique<DLNode>("dummy_node", dummyModelName, requestedModelVersion, managerWithDynamicBatchDummyModel);
-    auto output_node = std::make_unique<ExitNode>(&response);
-
-    Pipeline pipeline(*input_node, *output_node);
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
 
-    pipeline.connect(*input_node, *model_node, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}});
-    pipeline.connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+    NodeInfo demultiplexerInfo{NodeKind::DEMULTIPLEXER, "per_element_node", "dummy", std::nullopt, {{"first_output", DUMMY_MODEL_OUTPUT_NAME}}};
+    demultiplexerInfo.demultiplexedNodes.emplace_back(NodeKind::DL, "step_node", "dummy", std::nullopt, std::unordered_map<std::string, std::string>{{"step_output", DUMMY_MODEL_OUTPUT_NAME}});
+    demultiplexerInfo.demultiplexedConnections["step_node"] = {
+        {"per_element_node", {{"first_output", DUMMY_MODEL_INPUT_NAME}}}};
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        demultiplexerInfo,
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["per_element_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    // following nodes see aliases of the last demultiplexed node
+    connections[EXIT_NODE_NAME] = {
+        {"per_element_node", {{"first_output", customPipelineOutputName}}}};
+    PipelineDefinition notGathered("not_gathered", info, connections);
+    EXPECT_EQ(notGathered.validate(managerWithDummyModel), StatusCode::PIPELINE_NODE_REFERING_TO_MISSING_DATA_SOURCE);
 
-    pipeline.push(std::move(input_node));
-    pipeline.push(std::move(model_node));
-    pipeline.push(std::move(output_node));
+    connections[EXIT_NODE_NAME] = {
+        {"per_element_node", {{"step_output", customPipelineOutputName}}}};
+    PipelineDefinition pd("demultiplexed_steps", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(2, batchSize);
 
-    pipeline.execute();
-    const int seriallyConnectedDummyModels = 1;
-    checkDummyResponse(seriallyConnectedDummyModels, batchSize);
+    // demultiplexed nodes cannot refer to nodes outside of the demultiplexer node
+    info[1].demultiplexedConnections["step_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    PipelineDefinition outsideDependency("outside_dependency", info, connections);
+    EXPECT_EQ(outsideDependency.validate(managerWithDummyModel), StatusCode::PIPELINE_NODE_REFERING_TO_MISSING_NODE);
 }
 
 TEST_F(EnsembleFlowTest, ExecutePipelineWithDynamicShape) {
@@ -585,6 +1339,122 @@ TEST_F(EnsembleFlowTest, FailInDLNodeExecuteInputsMissingInput) {
     EXPECT_EQ(pipeline.execute(), ovms::StatusCode::INVALID_MISSING_INPUT);
 }
 
+TEST_F(EnsembleFlowTest, EntryNodeSharesInputBlobsBetweenNodes) {
+    // input shared by both nodes is deserialized once, large padded inputs are converted in parallel
+    const size_t largeInputSize = PARALLEL_DESERIALIZATION_MIN_BYTES;
+    for (const char* name : {"large_a", "large_b"}) {
+        tensorflow::TensorProto& proto = (*request.mutable_inputs())[name];
+        proto.set_dtype(tensorflow::DataType::DT_UINT8);
+        proto.mutable_tensor_shape()->add_dim()->set_size(largeInputSize);
+        for (size_t i = 0; i < largeInputSize; ++i) {
+            proto.add_int_val(i % 256);
+        }
+    }
+    EntryNode entry(&request);
+    PredictResponse firstResponse, secondResponse;
+    ExitNode first(&firstResponse), second(&secondResponse);
+    entry.addDependant(first);
+    entry.addDependant(second);
+    first.addDependency(entry, {{customPipelineInputName, "a"}, {"large_a", "b"}});
+    second.addDependency(entry, {{customPipelineInputName, "a"}, {"large_b", "b"}});
+
+    BlobMap outputs;
+    ASSERT_EQ(entry.fetchResults(outputs), StatusCode::OK);
+    ASSERT_EQ(outputs.size(), 3);
+    const auto& tensorContent = request.inputs().at(customPipelineInputName).tensor_content();
+    EXPECT_EQ(outputs[customPipelineInputName]->buffer().as<const char*>(), tensorContent.data());
+    for (const char* name : {"large_a", "large_b"}) {
+        ASSERT_EQ(outputs[name]->byteSize(), largeInputSize);
+        const auto* data = outputs[name]->buffer().as<const uint8_t*>();
+        EXPECT_EQ(data[1], 1);
+        EXPECT_EQ(data[largeInputSize - 1], (largeInputSize - 1) % 256);
+    }
+}
+
+TEST_F(EnsembleFlowTest, EntryNodeFailsOnMissingInput) {
+    EntryNode entry(&request);
+    ExitNode exit(&response);
+    entry.addDependant(exit);
+    exit.addDependency(entry, {{customPipelineInputName, "a"}, {"NON_EXISTING_INPUT", "b"}});
+    BlobMap outputs;
+    EXPECT_EQ(entry.fetchResults(outputs), StatusCode::INVALID_MISSING_INPUT);
+}
+
+class GatedDummyPipelineTest : public EnsembleFlowTest {
+protected:
+    // input   gate    dummy    output
+    //  O------->O------->O------->O
+    //  |                          ^
+    //  +--------------------------+ passthrough
+    Status executeGatedPipeline(ModelManager& manager, double threshold) {
+        GateCondition condition;
+        condition.input = "gated";
+        condition.reduction = GateReduction::MAX;
+        condition.comparison = GateComparison::GREATER;
+        condition.value = threshold;
+        auto input_node = std::make_unique<EntryNode>(&request);
+        auto gate_node = std::make_unique<GateNode>("gate_node", condition, std::unordered_map<std::string, std::string>{{"gated", "gated"}});
+        auto model_node = std::make_unique<DLNode>("dummy_node", dummyModelName, requestedModelVersion, manager);
+        auto output_node = std::make_unique<ExitNode>(&response);
+
+        Pipeline pipeline(*input_node, *output_node);
+        pipeline.connect(*input_node, *gate_node, {{customPipelineInputName, "gated"}});
+        pipeline.connect(*gate_node, *model_node, {{"gated", DUMMY_MODEL_INPUT_NAME}});
+        pipeline.connect(*model_node, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}});
+        pipeline.connect(*input_node, *output_node, {{customPipelineInputName, passthroughOutputName}});
+
+        pipeline.push(std::move(input_node));
+        pipeline.push(std::move(gate_node));
+        pipeline.push(std::move(model_node));
+        pipeline.push(std::move(output_node));
+        return pipeline.execute();
+    }
+
+    const std::string passthroughOutputName = "passthrough";
+};
+
+TEST_F(GatedDummyPipelineTest, PassedGateExecutesDependants) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+    auto status = executeGatedPipeline(managerWithDummyModel, *std::min_element(requestData.begin(), requestData.end()));
+    ASSERT_EQ(status, StatusCode::OK) << status.string();
+    checkDummyResponse(1);
+    EXPECT_EQ(response.outputs().count(passthroughOutputName), 1);
+}
+
+TEST_F(GatedDummyPipelineTest, FailedGateSkipsDependants) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+    auto status = executeGatedPipeline(managerWithDummyModel, *std::max_element(requestData.begin(), requestData.end()));
+    ASSERT_EQ(status, StatusCode::OK) << status.string();
+    EXPECT_EQ(response.outputs().count(customPipelineOutputName), 0);
+    ASSERT_EQ(response.outputs().count(passthroughOutputName), 1);
+    const auto& proto = response.outputs().at(passthroughOutputName);
+    ASSERT_EQ(proto.tensor_content().size(), requestData.size() * sizeof(float));
+    EXPECT_EQ(std::memcmp(proto.tensor_content().data(), requestData.data(), proto.tensor_content().size()), 0);
+}
+
+TEST_F(GatedDummyPipelineTest, GateReferringToNotConnectedInputIsRejected) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::GATE, "gate_node", "", std::nullopt, {{"gated", "gated"}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    info[1].condition.input = "not_connected";
+
+    pipeline_connections_t connections;
+    connections["gate_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, "gated"}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"gate_node", {{"gated", customPipelineOutputName}}}};
+
+    auto pipelineDefinition = std::make_unique<PipelineDefinition>("gated_pipeline", info, connections);
+    EXPECT_EQ(pipelineDefinition->validateNodes(managerWithDummyModel), StatusCode::PIPELINE_GATE_REFERING_TO_MISSING_INPUT);
+}
+
 class DLNodeFailInFetch : public DLNode {
 public:
     DLNodeFailInFetch(const std::string& nodeName, const std::string& modelName, std::optional<model_version_t> modelVersion, ModelManager& modelManager = ModelManager::getInstance()) :
@@ -1512,6 +2382,82 @@ TEST_F(EnsembleFlowTest, PipelineFactoryCreationWithInputOutputsMappings) {
     managerWithDummyModel.join();
 }
 
+static const char* pipelineOneDummyWithInferRequestPoolsConfig = R"(
+{
+    "model_config_list": [
+        {
+            "config": {
+                "name": "dummy",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 3,
+                "infer_request_pools": {"direct": {"nireq": 1}, "pipeline1Dummy": {"nireq": 1}}
+            }
+        }
+    ],
+    "pipeline_config_list": [
+        {
+            "name": "pipeline1Dummy",
+            "inputs": ["custom_dummy_input"],
+            "nodes": [
+                {
+                    "name": "dummyNode",
+                    "model_name": "dummy",
+                    "type": "DL model",
+                    "inputs": [
+                        {"b": {"node_name": "request",
+                               "data_item": "custom_dummy_input"}}
+                    ],
+                    "outputs": [
+                        {"data_item": "a",
+                         "alias": "new_dummy_output"}
+                    ]
+                }
+            ],
+            "outputs": [
+                {"custom_dummy_output": {"node_name": "dummyNode",
+                                         "data_item": "new_dummy_output"}
+                }
+            ]
+        }
+    ]
+})";
+
+TEST_F(EnsembleFlowTest, PipelineAndDirectTrafficUseTheirInferRequestPools) {
+    std::string fileToReload = directoryPath + "/ovms_config_file.json";
+    createConfigFileWithContent(pipelineOneDummyWithInferRequestPoolsConfig, fileToReload);
+    ConstructorEnabledModelManager managerWithDummyModel;
+    ASSERT_EQ(managerWithDummyModel.startFromFile(fileToReload), StatusCode::OK);
+    auto instance = managerWithDummyModel.findModelInstance("dummy");
+    ASSERT_NE(instance, nullptr);
+    // pools are idle, so each traffic class is given its own queue
+    auto& shared = instance->getInferRequestsQueue();
+    auto& directPool = instance->getInferRequestsQueue(ovms::DIRECT_INFER_REQUESTS_POOL);
+    auto& pipelinePool = instance->getInferRequestsQueue(PIPELINE_1_DUMMY_NAME);
+    ASSERT_NE(&directPool, &shared);
+    ASSERT_NE(&pipelinePool, &shared);
+    ASSERT_NE(&directPool, &pipelinePool);
+    EXPECT_EQ(shared.getStreamsLimit(), 1);
+
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(managerWithDummyModel.createPipeline(pipeline, PIPELINE_1_DUMMY_NAME, &request, &response), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(1);
+    EXPECT_GT(pipelinePool.getTotalStreamHoldMicroseconds(), 0);
+    EXPECT_EQ(directPool.getTotalStreamHoldMicroseconds(), 0);
+    EXPECT_EQ(shared.getTotalStreamHoldMicroseconds(), 0);
+
+    PredictRequest directRequest;
+    prepareRequest(bs1requestData, directRequest, DUMMY_MODEL_INPUT_NAME);
+    directRequest.mutable_model_spec()->set_name("dummy");
+    PredictResponse directResponse;
+    auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(*instance);
+    ASSERT_EQ(ovms::inference(*instance, &directRequest, &directResponse, unloadGuard), StatusCode::OK);
+    EXPECT_GT(directPool.getTotalStreamHoldMicroseconds(), 0);
+    EXPECT_EQ(shared.getTotalStreamHoldMicroseconds(), 0);
+    managerWithDummyModel.join();
+}
+
 static const char* pipelineOneDummyConfig2ParallelDummy = R"(
 {
     "model_config_list": [
@@ -1931,7 +2877,7 @@ TEST_F(EnsembleFlowTest, ErrorHandlingSkipsDeferredNodesExecutionIfExecutionFail
 
     Pipeline pipeline(*input_node, *output_node);
     pipeline.connect(*input_node, *dummy_node_1, {{"proto_input_1x10", DUMMY_MODEL_INPUT_NAME}});  // this node will start execution, reserve stream id
-    pipeline.connect(*input_node, *dummy_node_2, {{"proto_input_1x10", DUMMY_MODEL_INPUT_NAME}});  // this node will start execution, get future object for stream id, defer to queue
+    pipeline.connect(*input_node, *dummy_node_2, {{"proto_input_1x10", DUMMY_MODEL_INPUT_NAME}});  // this node will start execution, register as stream id waiter, defer to queue
     pipeline.connect(*input_node, *dummy_node_3, {{"proto_input_1x5", DUMMY_MODEL_INPUT_NAME}});   // this node will fail at validation time
     pipeline.connect(*dummy_node_1, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, "proto_output_1x10_A"}});
     pipeline.connect(*dummy_node_2, *output_node, {{DUMMY_MODEL_OUTPUT_NAME, "proto_output_1x10_B"}});
@@ -2052,6 +2998,47 @@ TEST_F(EnsembleFlowTest, ReloadPipelineDefinitionWithAllModelVersionsRetiredShou
     EXPECT_EQ(status, ovms::StatusCode::PIPELINE_NODE_REFERING_TO_MISSING_MODEL) << status.string();
 }
 
+TEST_F(EnsembleFlowTest, ReloadUnchangedPipelineDefinitionSkipsRevalidation) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("originalName", info, connections);
+    auto status = pd.validate(managerWithDummyModel);
+    ASSERT_TRUE(status.ok()) << status.string();
+    // kept alive, so that recompiled plan cannot reuse its address
+    auto compiledCriticalPath = pd.getExecutionPlan().criticalPath;
+
+    // execution plan is compiled again only by validation
+    auto infoCopy = info;
+    auto connectionsCopy = connections;
+    status = pd.reload(managerWithDummyModel, std::move(infoCopy), std::move(connectionsCopy));
+    ASSERT_TRUE(status.ok()) << status.string();
+    EXPECT_EQ(pd.getExecutionPlan().criticalPath, compiledCriticalPath);
+
+    pd.notifyUsedModelChanged(notifierDetails);
+    infoCopy = info;
+    connectionsCopy = connections;
+    status = pd.reload(managerWithDummyModel, std::move(infoCopy), std::move(connectionsCopy));
+    ASSERT_TRUE(status.ok()) << status.string();
+    EXPECT_NE(pd.getExecutionPlan().criticalPath, compiledCriticalPath);
+    compiledCriticalPath = pd.getExecutionPlan().criticalPath;
+
+    info[1].resultCacheSize = DEFAULT_NODE_RESULT_CACHE_SIZE;
+    status = pd.reload(managerWithDummyModel, std::move(info), std::move(connections));
+    ASSERT_TRUE(status.ok()) << status.string();
+    EXPECT_NE(pd.getExecutionPlan().criticalPath, compiledCriticalPath);
+}
+
 TEST_F(EnsembleFlowTest, RevalidatePipelineDefinitionWhen1ModelVersionBecomesAvailableShouldPass) {
     ConstructorEnabledModelManager managerWithDummyModel;
     managerWithDummyModel.reloadModelWithVersions(config);
@@ -2133,6 +3120,190 @@ TEST_F(EnsembleFlowTest, ExecuteOnPipelineCreatedBeforeRetireShouldPass) {
     checkDummyResponse(dummySeriallyConnectedCount);
 }
 
+TEST_F(EnsembleFlowTest, RetireWaitsUntilRequestHandleIsReleased) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("originalName", info, connections);
+    ASSERT_TRUE(pd.validate(managerWithDummyModel).ok());
+    auto requestHandle = std::make_unique<PipelineDefinitionUnloadGuard>(pd);
+    std::atomic<bool> retired{false};
+    std::thread retire([&pd, &managerWithDummyModel, &retired]() {
+        pd.retire(managerWithDummyModel);
+        retired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(retired);
+    requestHandle.reset();
+    retire.join();
+    EXPECT_TRUE(retired);
+}
+
+TEST_F(EnsembleFlowTest, ExecutionPlanOrdersNodesTopologically) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    // nodes listed in reverse order of execution
+    std::vector<NodeInfo> info{
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+        {NodeKind::DL, "dummy_node_2", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::DL, "dummy_node_1", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node_1"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections["dummy_node_2"] = {
+        {"dummy_node_1", {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node_2", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("reversed", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+
+    const auto& steps = pd.getExecutionPlan().steps;
+    ASSERT_EQ(steps.size(), info.size());
+    std::vector<std::string> order;
+    for (size_t nodeId = 0; nodeId < steps.size(); ++nodeId) {
+        order.push_back(info[steps[nodeId].nodeInfoIndex].nodeName);
+        for (const auto& dependency : steps[nodeId].dependencies) {
+            EXPECT_LT(dependency.nodeId, nodeId);
+        }
+    }
+    EXPECT_EQ(order, (std::vector<std::string>{ENTRY_NODE_NAME, "dummy_node_1", "dummy_node_2", EXIT_NODE_NAME}));
+
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(2);
+}
+
+TEST_F(EnsembleFlowTest, NodesOfFinishedPipelineAreReusedByNextOne) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("reused", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    const Node* entry = &pipeline->getEntry();
+    pipeline.reset();
+    ASSERT_EQ(pd.getIdlePipelineGraphsCount(), 1);
+
+    response.Clear();
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    EXPECT_EQ(&pipeline->getEntry(), entry);
+    EXPECT_EQ(pd.getIdlePipelineGraphsCount(), 0);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(1);
+    pipeline.reset();
+
+    // revalidation compiles new execution plan, graphs of previous one are dropped
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+    EXPECT_EQ(pd.getIdlePipelineGraphsCount(), 0);
+}
+
+TEST_F(EnsembleFlowTest, PipelineCreatedBeforeReloadUsesPreviousDefinition) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("reloaded", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+
+    // reload does not wait for pipelines created from previous definition
+    auto infoNew = info;
+    infoNew[1].resultCacheSize = DEFAULT_NODE_RESULT_CACHE_SIZE;
+    auto connectionsNew = connections;
+    ASSERT_EQ(pd.reload(managerWithDummyModel, std::move(infoNew), std::move(connectionsNew)), StatusCode::OK);
+    EXPECT_EQ(pd.getStateCode(), PipelineDefinitionStateCode::AVAILABLE);
+
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(1);
+    pipeline.reset();
+    // graph of previous definition is not reused by pipelines of the new one
+    EXPECT_EQ(pd.getIdlePipelineGraphsCount(), 0);
+
+    response.Clear();
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(1);
+}
+
+TEST_F(EnsembleFlowTest, ReloadWaitsForRequestsStartedBeforeButNotForFollowingOnes) {
+    ConstructorEnabledModelManager managerWithDummyModel;
+    managerWithDummyModel.reloadModelWithVersions(config);
+
+    std::vector<NodeInfo> info{
+        {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{customPipelineInputName, customPipelineInputName}}},
+        {NodeKind::DL, "dummy_node", "dummy", std::nullopt, {{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}}},
+        {NodeKind::EXIT, EXIT_NODE_NAME},
+    };
+    pipeline_connections_t connections;
+    connections["dummy_node"] = {
+        {ENTRY_NODE_NAME, {{customPipelineInputName, DUMMY_MODEL_INPUT_NAME}}}};
+    connections[EXIT_NODE_NAME] = {
+        {"dummy_node", {{DUMMY_MODEL_OUTPUT_NAME, customPipelineOutputName}}}};
+    PipelineDefinition pd("reloaded", info, connections);
+    ASSERT_EQ(pd.validate(managerWithDummyModel), StatusCode::OK);
+
+    std::unique_ptr<PipelineDefinitionUnloadGuard> previousRequest;
+    ASSERT_EQ(pd.waitForLoaded(previousRequest), StatusCode::OK);
+    auto infoNew = info;
+    infoNew[1].resultCacheSize = DEFAULT_NODE_RESULT_CACHE_SIZE;
+    auto connectionsNew = connections;
+    auto reload = std::async(std::launch::async, [&]() {
+        return pd.reload(managerWithDummyModel, std::move(infoNew), std::move(connectionsNew));
+    });
+    EXPECT_EQ(reload.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+    // new requests are served while reload waits
+    std::unique_ptr<Pipeline> pipeline;
+    ASSERT_EQ(pd.create(pipeline, &request, &response, managerWithDummyModel), StatusCode::OK);
+    ASSERT_EQ(pipeline->execute(), StatusCode::OK);
+    checkDummyResponse(1);
+    std::unique_ptr<PipelineDefinitionUnloadGuard> followingRequest;
+    ASSERT_EQ(pd.waitForLoaded(followingRequest), StatusCode::OK);
+
+    previousRequest.reset();
+    ASSERT_EQ(reload.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(reload.get(), StatusCode::OK);
+    EXPECT_EQ(pd.getStateCode(), PipelineDefinitionStateCode::AVAILABLE);
+}
+
 class MockedPipelineDefinitionWithHandlingStatus : public PipelineDefinition {
 public:
     MockedPipelineDefinitionWithHandlingStatus(const std::string& pipelineName,
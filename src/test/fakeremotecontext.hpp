@@ -0,0 +1,86 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+/**
+ * @brief Blob of device memory emulated with host memory, so that plugins without remote blobs can read and write it
+ */
+class FakeRemoteBlob : public InferenceEngine::RemoteBlob {
+public:
+    FakeRemoteBlob(const InferenceEngine::TensorDesc& tensorDesc, std::shared_ptr<InferenceEngine::RemoteContext> context) :
+        InferenceEngine::RemoteBlob(tensorDesc),
+        context(std::move(context)),
+        data(tensorDesc.getPrecision().size() * std::accumulate(tensorDesc.getDims().begin(), tensorDesc.getDims().end(), size_t(1), std::multiplies<size_t>())) {
+        allocator = InferenceEngine::details::make_pre_allocator(data.data(), data.size());
+    }
+
+    void allocate() noexcept override {}
+    bool deallocate() noexcept override { return false; }
+    InferenceEngine::LockedMemory<void> buffer() noexcept override {
+        return InferenceEngine::LockedMemory<void>(allocator.get(), data.data(), 0);
+    }
+    InferenceEngine::LockedMemory<const void> cbuffer() const noexcept override {
+        return InferenceEngine::LockedMemory<const void>(allocator.get(), const_cast<char*>(data.data()), 0);
+    }
+    InferenceEngine::LockedMemory<void> rwmap() noexcept override { return buffer(); }
+    InferenceEngine::LockedMemory<const void> rmap() const noexcept override { return cbuffer(); }
+    InferenceEngine::LockedMemory<void> wmap() noexcept override { return buffer(); }
+
+    InferenceEngine::ParamMap getParams() const override { return {}; }
+    std::string getDeviceName() const noexcept override { return context->getDeviceName(); }
+    std::shared_ptr<InferenceEngine::RemoteContext> getContext() const noexcept override { return context; }
+
+protected:
+    const std::shared_ptr<InferenceEngine::IAllocator>& getAllocator() const noexcept override { return allocator; }
+    void* getHandle() const noexcept override { return const_cast<char*>(data.data()); }
+
+private:
+    const std::shared_ptr<InferenceEngine::RemoteContext> context;
+    std::vector<char> data;
+    std::shared_ptr<InferenceEngine::IAllocator> allocator;
+};
+
+/**
+ * @brief Context of device memory counting allocated blobs, allocation fails once it is set failing
+ */
+class FakeRemoteContext : public InferenceEngine::RemoteContext {
+public:
+    std::string getDeviceName() const noexcept override { return "GPU"; }
+
+    InferenceEngine::RemoteBlob::Ptr CreateBlob(const InferenceEngine::TensorDesc& tensorDesc, const InferenceEngine::ParamMap& params = {}) override {
+        if (failing) {
+            throw std::runtime_error("out of device memory");
+        }
+        ++createdBlobs;
+        return std::make_shared<FakeRemoteBlob>(tensorDesc, shared_from_this());
+    }
+
+    InferenceEngine::ParamMap getParams() const override { return {}; }
+
+    std::atomic<size_t> createdBlobs{0};
+    std::atomic<bool> failing{false};
+};
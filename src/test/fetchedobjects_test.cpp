@@ -0,0 +1,86 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../fetchedobjects.hpp"
+#include "test_utils.hpp"
+
+using ovms::FetchedObjects;
+
+class FetchedObjectsTest : public TestWithTempDir {
+protected:
+    std::string writeFile(const std::string& name, const std::string& content) {
+        const std::string path = directoryPath + "/" + name;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+        return path;
+    }
+
+    std::string readFile(const std::string& path) {
+        std::stringstream content;
+        content << std::ifstream(path, std::ios::binary).rdbuf();
+        return content.str();
+    }
+};
+
+TEST_F(FetchedObjectsTest, SameObjectIsReusedFromEarlierDownload) {
+    auto& objects = FetchedObjects::instance();
+    const auto downloaded = writeFile("1/model.bin", "weights");
+    objects.add("\"etag-1\"", 7, downloaded);
+    const std::string target = directoryPath + "/2/model.bin";
+    std::filesystem::create_directories(directoryPath + "/2");
+    ASSERT_TRUE(objects.reuse("\"etag-1\"", 7, target));
+    EXPECT_EQ(readFile(target), "weights");
+    EXPECT_FALSE(objects.reuse("\"etag-2\"", 7, directoryPath + "/2/other.bin"));
+    EXPECT_FALSE(objects.reuse("\"etag-1\"", 8, directoryPath + "/2/other.bin"));
+    EXPECT_FALSE(std::filesystem::exists(directoryPath + "/2/other.bin"));
+}
+
+TEST_F(FetchedObjectsTest, ObjectsWithoutContentIdAreNotReused) {
+    auto& objects = FetchedObjects::instance();
+    const auto downloaded = writeFile("1/model.bin", "weights");
+    objects.add("", 7, downloaded);
+    EXPECT_FALSE(objects.reuse("", 7, directoryPath + "/2.bin"));
+}
+
+TEST_F(FetchedObjectsTest, RemovedOrChangedCopiesAreForgotten) {
+    auto& objects = FetchedObjects::instance();
+    const auto removed = writeFile("1/removed.bin", "weights");
+    objects.add("removed", 7, removed);
+    std::filesystem::remove(removed);
+    EXPECT_FALSE(objects.reuse("removed", 7, directoryPath + "/target.bin"));
+
+    const auto changed = writeFile("1/changed.bin", "weights");
+    objects.add("changed", 7, changed);
+    std::filesystem::last_write_time(changed, std::filesystem::last_write_time(changed) - std::chrono::hours(1));
+    EXPECT_FALSE(objects.reuse("changed", 7, directoryPath + "/target.bin"));
+}
+
+TEST_F(FetchedObjectsTest, CopiesMovedWithTheirDirectoryAreReused) {
+    auto& objects = FetchedObjects::instance();
+    const auto downloaded = writeFile("download/1/model.bin", "weights");
+    objects.add("moved", 7, downloaded);
+    std::filesystem::rename(directoryPath + "/download/1", directoryPath + "/cache");
+    objects.relocate(directoryPath + "/download/1", directoryPath + "/cache");
+    ASSERT_TRUE(objects.reuse("moved", 7, directoryPath + "/target.bin"));
+    EXPECT_EQ(readFile(directoryPath + "/target.bin"), "weights");
+}
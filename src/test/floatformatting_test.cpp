@@ -0,0 +1,106 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../floatformatting.hpp"
+
+namespace {
+
+std::string toString(float value) {
+    char buffer[ovms::FORMATTED_NUMBER_BUFFER_SIZE];
+    return std::string(buffer, ovms::formatFloat(value, buffer));
+}
+
+std::string toString(double value) {
+    char buffer[ovms::FORMATTED_NUMBER_BUFFER_SIZE];
+    return std::string(buffer, ovms::formatDouble(value, buffer));
+}
+
+}  // namespace
+
+TEST(FloatFormatting, WritesShortestFloatRepresentation) {
+    EXPECT_EQ(toString(5.0f), "5.0");
+    EXPECT_EQ(toString(92.5f), "92.5");
+    EXPECT_EQ(toString(-0.5f), "-0.5");
+    EXPECT_EQ(toString(0.1f), "0.1");
+    EXPECT_EQ(toString(1.0000001f), "1.0000001");
+    EXPECT_EQ(toString(0.001f), "0.001");
+    EXPECT_EQ(toString(1e-7f), "1e-7");
+    EXPECT_EQ(toString(1.5e-7f), "1.5e-7");
+    EXPECT_EQ(toString(123456789.0f), "123456790.0");
+    EXPECT_EQ(toString(1e30f), "1e30");
+    EXPECT_EQ(toString(std::numeric_limits<float>::max()), "3.4028235e38");
+    EXPECT_EQ(toString(std::numeric_limits<float>::min()), "1.1754944e-38");
+    EXPECT_EQ(toString(std::numeric_limits<float>::denorm_min()), "1e-45");
+}
+
+TEST(FloatFormatting, WritesDoubleRepresentation) {
+    EXPECT_EQ(toString(15.99), "15.99");
+    EXPECT_EQ(toString(5.0), "5.0");
+    EXPECT_EQ(toString(-2.5), "-2.5");
+    EXPECT_EQ(toString(1.0 / 3), "0.3333333333333333");
+    EXPECT_EQ(toString(1e300), "1e300");
+    EXPECT_EQ(toString(1e-7), "1e-7");
+}
+
+TEST(FloatFormatting, WritesSpecialValues) {
+    EXPECT_EQ(toString(0.0f), "0.0");
+    EXPECT_EQ(toString(-0.0f), "-0.0");
+    EXPECT_EQ(toString(std::numeric_limits<float>::quiet_NaN()), "NaN");
+    EXPECT_EQ(toString(std::numeric_limits<float>::infinity()), "Infinity");
+    EXPECT_EQ(toString(-std::numeric_limits<float>::infinity()), "-Infinity");
+    EXPECT_EQ(toString(0.0), "0.0");
+    EXPECT_EQ(toString(std::numeric_limits<double>::quiet_NaN()), "NaN");
+    EXPECT_EQ(toString(-std::numeric_limits<double>::infinity()), "-Infinity");
+}
+
+TEST(FloatFormatting, FloatValuesParseBackToTheSameValue) {
+    // every 4099th bit pattern covers all exponents, subnormals and both signs
+    for (uint64_t pattern = 0; pattern <= std::numeric_limits<uint32_t>::max(); pattern += 4099) {
+        const uint32_t bits = static_cast<uint32_t>(pattern);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value)) {
+            continue;
+        }
+        const std::string text = toString(value);
+        ASSERT_EQ(std::strtof(text.c_str(), nullptr), value) << text;
+    }
+}
+
+TEST(FloatFormatting, DoubleValuesParseBackToTheSameValue) {
+    uint64_t bits = 0x123456789ABCDEFull;
+    for (size_t i = 0; i < 100000; i++) {
+        // xorshift generator
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value)) {
+            continue;
+        }
+        const std::string text = toString(value);
+        ASSERT_EQ(std::strtod(text.c_str(), nullptr), value) << text;
+    }
+}
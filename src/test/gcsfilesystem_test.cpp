@@ -14,7 +14,9 @@
 // limitations under the License.
 //*****************************************************************************
 
+#include <cstdlib>
 #include <fstream>
+#include <string>
 
 #include "spdlog/spdlog.h"
 
@@ -121,6 +123,31 @@ void check_dir_access(const std::string& path, ovms::FileSystem* fs) {
 
 }  // namespace
 
+TEST(GCSFileSystem, SharedInstanceIsKeptPerCredentials) {
+    unsetenv("GOOGLE_APPLICATION_CREDENTIALS");
+    auto anonymous = ovms::GCSFileSystem::getShared();
+    ASSERT_NE(anonymous, nullptr);
+    EXPECT_EQ(ovms::GCSFileSystem::getShared(), anonymous);
+
+    // authorized user credentials are read from the file without reaching the network
+    const std::string firstCredentials = "/tmp/ovms_test_gcs_shared_first.json";
+    const std::string secondCredentials = "/tmp/ovms_test_gcs_shared_second.json";
+    for (const auto& path : {firstCredentials, secondCredentials}) {
+        std::ofstream f(path);
+        f << R"({"type": "authorized_user", "client_id": "ovms_test", "client_secret": "ovms_test", "refresh_token": ")" << path << R"("})";
+    }
+    ::setenv("GOOGLE_APPLICATION_CREDENTIALS", firstCredentials.c_str(), 1);
+    auto first = ovms::GCSFileSystem::getShared();
+    EXPECT_NE(first, anonymous);
+    EXPECT_EQ(ovms::GCSFileSystem::getShared(), first);
+    ::setenv("GOOGLE_APPLICATION_CREDENTIALS", secondCredentials.c_str(), 1);
+    auto second = ovms::GCSFileSystem::getShared();
+    EXPECT_NE(second, first);
+    EXPECT_NE(second, anonymous);
+    unsetenv("GOOGLE_APPLICATION_CREDENTIALS");
+    EXPECT_EQ(ovms::GCSFileSystem::getShared(), anonymous);
+}
+
 TEST(DISABLED_GCSFileSystem, file_details) {
     spdlog::set_level(spdlog::level::trace);  // uncomment me for debugging.
 
@@ -261,6 +261,24 @@ TEST_F(GetModelMetadataResponse, ModelVersionNotLoadedYet) {
     EXPECT_EQ(ovms::GetModelMetadataImpl::buildResponse(instance, &response), ovms::StatusCode::MODEL_VERSION_NOT_LOADED_YET);
 }
 
+TEST_F(GetModelMetadataResponse, MetadataIsBuiltOncePerModelVersion) {
+    EXPECT_CALL(*instance, getInputsInfo()).Times(1);
+    EXPECT_CALL(*instance, getOutputsInfo()).Times(1);
+    ASSERT_EQ(ovms::GetModelMetadataImpl::buildResponse(instance, &response), ovms::StatusCode::OK);
+    response.Clear();
+    ASSERT_EQ(ovms::GetModelMetadataImpl::buildResponse(instance, &response), ovms::StatusCode::OK);
+    EXPECT_EQ(response.model_spec().name(), modelName);
+    EXPECT_EQ(response.model_spec().version().value(), modelVersion);
+}
+
+TEST_F(GetModelMetadataResponse, MetadataIsRebuiltAfterInvalidation) {
+    EXPECT_CALL(*instance, getInputsInfo()).Times(2);
+    EXPECT_CALL(*instance, getOutputsInfo()).Times(2);
+    ASSERT_EQ(ovms::GetModelMetadataImpl::buildResponse(instance, &response), ovms::StatusCode::OK);
+    instance->getMetadataCache().invalidate();
+    ASSERT_EQ(ovms::GetModelMetadataImpl::buildResponse(instance, &response), ovms::StatusCode::OK);
+}
+
 TEST_F(GetModelMetadataResponseBuild, serialize2Json) {
     std::string json_output;
     const tensorflow::serving::GetModelMetadataResponse* response_p = &response;
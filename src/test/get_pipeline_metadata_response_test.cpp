@@ -266,6 +266,19 @@ TEST_F(GetPipelineMetadataResponse, PipelineAvailableOrAvailableRequiringRevalid
     EXPECT_EQ(ovms::GetModelMetadataImpl::buildResponse(pipelineDefinition, &response, manager), ovms::StatusCode::OK);
 }
 
+TEST_F(GetPipelineMetadataResponseBuild, MetadataIsRebuiltWhenUsedModelChanged) {
+    pipelineDefinition.mockMetadata({}, {});
+    ASSERT_EQ(ovms::GetModelMetadataImpl::buildResponse(pipelineDefinition, &response, manager), ovms::StatusCode::OK);
+    tensorflow::serving::SignatureDefMap def;
+    response.metadata().at("signature_def").UnpackTo(&def);
+    EXPECT_EQ(def.signature_def().at("serving_default").inputs().size(), 3);
+
+    pipelineDefinition.notifyUsedModelChanged("model: dummy version: 1");
+    ASSERT_EQ(ovms::GetModelMetadataImpl::buildResponse(pipelineDefinition, &response, manager), ovms::StatusCode::OK);
+    response.metadata().at("signature_def").UnpackTo(&def);
+    EXPECT_EQ(def.signature_def().at("serving_default").inputs().size(), 0);
+}
+
 TEST_F(GetPipelineMetadataResponseBuild, serialize2Json) {
     std::string json_output;
     const tensorflow::serving::GetModelMetadataResponse* response_p = &response;
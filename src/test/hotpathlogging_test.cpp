@@ -0,0 +1,59 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+// Checks the stripped variant of OVMS_HOT_PATH_* macros regardless of the build configuration
+#ifndef OVMS_STRIP_HOT_PATH_DEBUG_LOGS
+#define OVMS_STRIP_HOT_PATH_DEBUG_LOGS
+#endif
+
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../hotpathtimings.hpp"
+#include "../latencyhistogram.hpp"
+#include "../logging.hpp"
+
+using ovms::HotPathStage;
+using ovms::HotPathTimer;
+using ovms::HotPathTimings;
+using ovms::LatencyHistogram;
+
+TEST(HotPathLogging, StrippedLogsDoNotEvaluateArguments) {
+    int evaluated = 0;
+    auto evaluate = [&evaluated]() { return ++evaluated; };
+    OVMS_HOT_PATH_DEBUG("{}", evaluate());
+    OVMS_HOT_PATH_TRACE("{}", evaluate());
+    OVMS_HOT_PATH_LOGGER_DEBUG(ovms::dag_executor_logger, "{}", evaluate());
+    OVMS_HOT_PATH_LOGGER_TRACE(ovms::dag_executor_logger, "{}", evaluate());
+    EXPECT_EQ(evaluated, 0);
+}
+
+TEST(HotPathLogging, TimerStoppedOutsideOfStrippedLogRecordsAtStop) {
+    const auto sleep = std::chrono::milliseconds(200);
+    LatencyHistogram before;
+    HotPathTimings::instance().collect(HotPathStage::REST_PARSING, before);
+    {
+        HotPathTimer<HotPathStage::REST_PARSING> timer;
+        const uint64_t parsingMicroseconds = timer.stop();
+        OVMS_HOT_PATH_DEBUG("JSON request parsing time: {:.3f} ms", parsingMicroseconds / 1000.0);
+        std::this_thread::sleep_for(sleep);
+    }
+    LatencyHistogram after;
+    HotPathTimings::instance().collect(HotPathStage::REST_PARSING, after);
+    ASSERT_EQ(after.getCount() - before.getCount(), 1);
+    EXPECT_LT(after.getMax(), std::chrono::duration_cast<std::chrono::microseconds>(sleep).count());
+}
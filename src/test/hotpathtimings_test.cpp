@@ -0,0 +1,84 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../hotpathtimings.hpp"
+#include "../latencyhistogram.hpp"
+
+using ovms::HotPathStage;
+using ovms::HotPathTimer;
+using ovms::HotPathTimings;
+using ovms::LatencyHistogram;
+
+namespace {
+uint64_t collectedCount(HotPathStage stage) {
+    LatencyHistogram histogram;
+    HotPathTimings::instance().collect(stage, histogram);
+    return histogram.getCount();
+}
+}  // namespace
+
+TEST(HotPathTimings, RecordsOfExitedThreadsAreKept) {
+    const auto countBefore = collectedCount(HotPathStage::PIPELINE_EXECUTION);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([]() {
+            for (int j = 0; j < 100; ++j) {
+                HotPathTimings::record<HotPathStage::PIPELINE_EXECUTION>(j);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(collectedCount(HotPathStage::PIPELINE_EXECUTION) - countBefore, 800);
+}
+
+TEST(HotPathTimings, RecordsOfRunningThreadAreCollected) {
+    const auto countBefore = collectedCount(HotPathStage::REST_PARSING);
+    HotPathTimings::record<HotPathStage::REST_PARSING>(5);
+    HotPathTimings::record<HotPathStage::REST_PARSING>(7);
+    LatencyHistogram histogram;
+    HotPathTimings::instance().collect(HotPathStage::REST_PARSING, histogram);
+    EXPECT_EQ(histogram.getCount() - countBefore, 2);
+    EXPECT_GE(histogram.getMax(), 7);
+}
+
+TEST(HotPathTimings, TimerRecordsOnce) {
+    const auto countBefore = collectedCount(HotPathStage::REST_SERIALIZATION);
+    {
+        HotPathTimer<HotPathStage::REST_SERIALIZATION> timer;
+        timer.stop();
+        timer.stop();
+    }
+    EXPECT_EQ(collectedCount(HotPathStage::REST_SERIALIZATION) - countBefore, 1);
+}
+
+TEST(LatencyHistogram, AddMergesRecordedValues) {
+    LatencyHistogram first;
+    LatencyHistogram second;
+    first.recordExclusive(3);
+    second.record(10);
+    second.record(1000);
+    first.add(second);
+    EXPECT_EQ(first.getCount(), 3);
+    EXPECT_EQ(first.getSum(), 1013);
+    EXPECT_EQ(first.getMax(), 1000);
+    EXPECT_EQ(first.getPercentile(50), 10);
+}
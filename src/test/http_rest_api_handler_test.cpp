@@ -0,0 +1,463 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <rapidjson/document.h>
+
+#include "../adminauthorization.hpp"
+#include "../bulkinferencejobs.hpp"
+#include "../http_rest_api_handler.hpp"
+#include "../modelmanager.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+namespace {
+const std::chrono::milliseconds JOB_TIMEOUT{10000};
+const std::string ADMIN_TOKEN = "secret";
+const std::string AUTHORIZATION = "Bearer " + ADMIN_TOKEN;
+
+class HttpRestApiHandlerBulkJobsTest : public TestWithTempDir {
+protected:
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        AdminAuthorization::instance().configure(ADMIN_TOKEN);
+        ASSERT_EQ(BulkInferenceJobs::instance().configure(true, directoryPath), StatusCode::OK);
+    }
+
+    void TearDown() override {
+        BulkInferenceJobs::instance().configure(false, "");
+        AdminAuthorization::instance().configure("");
+        TestWithTempDir::TearDown();
+    }
+
+    Status process(const std::string& method, const std::string& path, const std::string& body = "", const std::string& authorization = AUTHORIZATION) {
+        response.clear();
+        return handler.processRequest(method, path, body, &headers, &response, NO_DEADLINE, {}, nullptr, authorization);
+    }
+
+    std::string createJob(const std::string& outputPath) {
+        return "{\"model_name\": \"unknown\", \"inputs\": {\"b\": \"" + directoryPath + "/input\"}, \"output_path\": \"" + outputPath + "\"}";
+    }
+
+    HttpRestApiHandler handler{5000};
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string response;
+};
+}  // namespace
+
+TEST_F(HttpRestApiHandlerBulkJobsTest, JobsRequireAdminToken) {
+    EXPECT_EQ(process("GET", "/v1/jobs", "", ""), StatusCode::ADMIN_UNAUTHORIZED);
+    EXPECT_EQ(process("GET", "/v1/jobs", "", "Bearer wrong"), StatusCode::ADMIN_UNAUTHORIZED);
+    EXPECT_EQ(process("POST", "/v1/jobs", createJob(directoryPath + "/output"), ""), StatusCode::ADMIN_UNAUTHORIZED);
+    EXPECT_EQ(process("GET", "/v1/jobs"), StatusCode::OK);
+    AdminAuthorization::instance().configure("");
+    EXPECT_EQ(process("GET", "/v1/jobs"), StatusCode::ADMIN_API_DISABLED);
+    BulkInferenceJobs::instance().configure(false, "");
+    EXPECT_EQ(process("GET", "/v1/jobs"), StatusCode::BULK_JOBS_DISABLED);
+}
+
+TEST_F(HttpRestApiHandlerBulkJobsTest, SubmissionIsValidated) {
+    EXPECT_EQ(process("POST", "/v1/jobs", "[]"), StatusCode::REST_BODY_IS_NOT_AN_OBJECT);
+    EXPECT_EQ(process("POST", "/v1/jobs", "{\"model_name\": \"unknown\"}"), StatusCode::REST_MALFORMED_REQUEST);
+    EXPECT_EQ(process("POST", "/v1/jobs", createJob("/etc")), StatusCode::BULK_JOB_PATH_OUTSIDE_ROOT);
+    EXPECT_EQ(process("GET", "/v1/jobs/abc"), StatusCode::BULK_JOB_NOT_FOUND);
+    EXPECT_EQ(process("POST", "/v1/jobs/12345:cancel"), StatusCode::BULK_JOB_NOT_FOUND);
+}
+
+TEST_F(HttpRestApiHandlerBulkJobsTest, SubmittedJobIsReported) {
+    ASSERT_EQ(process("POST", "/v1/jobs", createJob(directoryPath + "/output")), StatusCode::OK);
+    rapidjson::Document doc;
+    ASSERT_FALSE(doc.Parse(response.c_str()).HasParseError()) << response;
+    ASSERT_TRUE(doc.HasMember("id"));
+    const uint64_t id = doc["id"].GetUint64();
+    EXPECT_STREQ(doc["model_name"].GetString(), "unknown");
+    EXPECT_STREQ(doc["output_path"].GetString(), (directoryPath + "/output").c_str());
+
+    // servable is resolved when the job starts
+    ASSERT_TRUE(BulkInferenceJobs::instance().wait(id, JOB_TIMEOUT));
+    ASSERT_EQ(process("GET", "/v1/jobs/" + std::to_string(id)), StatusCode::OK);
+    ASSERT_FALSE(doc.Parse(response.c_str()).HasParseError()) << response;
+    EXPECT_EQ(doc["id"].GetUint64(), id);
+    EXPECT_STREQ(doc["state"].GetString(), "FAILED");
+    EXPECT_TRUE(doc.HasMember("error"));
+
+    ASSERT_EQ(process("GET", "/v1/jobs"), StatusCode::OK);
+    ASSERT_FALSE(doc.Parse(response.c_str()).HasParseError()) << response;
+    ASSERT_TRUE(doc["jobs"].IsArray());
+    bool listed = false;
+    for (const auto& job : doc["jobs"].GetArray()) {
+        listed = listed || job["id"].GetUint64() == id;
+    }
+    EXPECT_TRUE(listed);
+    EXPECT_EQ(process("POST", "/v1/jobs/" + std::to_string(id) + ":cancel"), StatusCode::BULK_JOB_FINISHED);
+}
+
+TEST(HttpRestApiHandlerAdmin, InferRequestsResizeRequiresAdminToken) {
+    HttpRestApiHandler handler(5000);
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string response;
+    const std::string path = "/v1/models/not_loaded:resize";
+    const std::string body = "{\"nireq\": 2}";
+    EXPECT_EQ(handler.processRequest("POST", path, body, &headers, &response), StatusCode::ADMIN_API_DISABLED);
+    AdminAuthorization::instance().configure(ADMIN_TOKEN);
+    EXPECT_EQ(handler.processRequest("POST", path, body, &headers, &response, NO_DEADLINE, {}, nullptr, "Bearer wrong"), StatusCode::ADMIN_UNAUTHORIZED);
+    // authorized request reaches the model lookup
+    EXPECT_EQ(handler.processRequest("POST", path, body, &headers, &response, NO_DEADLINE, {}, nullptr, AUTHORIZATION), StatusCode::MODEL_MISSING);
+    AdminAuthorization::instance().configure("");
+}
+
+namespace {
+const char* resizableModelsConfig = R"(
+{
+    "model_config_list": [
+        {
+            "config": {
+                "name": "dummy",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 2,
+                "max_nireq": 4
+            }
+        },
+        {
+            "config": {
+                "name": "dummy_stateful",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 2,
+                "stateful": true
+            }
+        }
+    ]
+})";
+
+class HttpRestApiHandlerInferRequestsResizeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(ModelManager::getInstance().startFromFile(createConfigFileWithContent(resizableModelsConfig)), StatusCode::OK);
+        AdminAuthorization::instance().configure(ADMIN_TOKEN);
+        // unchanged config does not reload the version, so resize of a previous test is undone here
+        auto instance = ModelManager::getInstance().findModelInstance("dummy");
+        ASSERT_NE(instance, nullptr);
+        uint32_t appliedNireq = 0;
+        ASSERT_EQ(instance->resizeInferRequests(2, appliedNireq), StatusCode::OK);
+    }
+
+    void TearDown() override {
+        AdminAuthorization::instance().configure("");
+    }
+
+    Status resize(const std::string& path, const std::string& body) {
+        response.clear();
+        return handler.processRequest("POST", path, body, &headers, &response, NO_DEADLINE, {}, nullptr, AUTHORIZATION);
+    }
+
+    HttpRestApiHandler handler{5000};
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string response;
+};
+}  // namespace
+
+TEST_F(HttpRestApiHandlerInferRequestsResizeTest, ResponseReportsAppliedNireq) {
+    ASSERT_EQ(resize("/v1/models/dummy:resize", "{\"nireq\": 4}"), StatusCode::OK);
+    rapidjson::Document doc;
+    ASSERT_FALSE(doc.Parse(response.c_str()).HasParseError());
+    ASSERT_TRUE(doc.HasMember("nireq"));
+    auto instance = ModelManager::getInstance().findModelInstance("dummy");
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(doc["nireq"].GetUint(), instance->getInferRequestsQueue().getStreamsLimit());
+    EXPECT_EQ(doc["nireq"].GetUint(), 4);
+
+    ASSERT_EQ(resize("/v1/models/dummy/versions/1:resize", "{\"nireq\": 1}"), StatusCode::OK);
+    EXPECT_EQ(instance->getInferRequestsQueue().getStreamsLimit(), 1);
+}
+
+TEST_F(HttpRestApiHandlerInferRequestsResizeTest, InvalidNireqIsRejected) {
+    EXPECT_EQ(resize("/v1/models/dummy:resize", "{\"nireq\": 0}"), StatusCode::INVALID_NIREQ);
+    EXPECT_EQ(resize("/v1/models/dummy:resize", "{\"nireq\": 5}"), StatusCode::INVALID_NIREQ);
+    EXPECT_EQ(resize("/v1/models/dummy:resize", "{\"nireq\": \"2\"}"), StatusCode::REST_MALFORMED_REQUEST);
+    EXPECT_EQ(Status(StatusCode::INVALID_NIREQ).http(), net_http::HTTPStatusCode::BAD_REQUEST);
+    auto instance = ModelManager::getInstance().findModelInstance("dummy");
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(instance->getInferRequestsQueue().getStreamsLimit(), 2);
+}
+
+TEST_F(HttpRestApiHandlerInferRequestsResizeTest, StatefulModelIsNotResized) {
+    EXPECT_EQ(resize("/v1/models/dummy_stateful:resize", "{\"nireq\": 1}"), StatusCode::NIREQ_RESIZE_NOT_SUPPORTED);
+    auto instance = ModelManager::getInstance().findModelInstance("dummy_stateful");
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(instance->getInferRequestsQueue().getStreamsLimit(), 2);
+}
+
+TEST_F(HttpRestApiHandlerInferRequestsResizeTest, VersionLabelIsRejected) {
+    EXPECT_EQ(resize("/v1/models/dummy/labels/stable:resize", "{\"nireq\": 1}"), StatusCode::REST_INVALID_URL);
+    auto instance = ModelManager::getInstance().findModelInstance("dummy");
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(instance->getInferRequestsQueue().getStreamsLimit(), 2);
+}
+
+namespace {
+const std::string DUMMY_BATCH_ENTRY = R"({"model_name": "dummy", "instances": [[1, 2, 3, 4, 5, 6, 7, 8, 9, 10]]})";
+const std::string UNKNOWN_MODEL_BATCH_ENTRY = R"({"model_name": "unknown", "instances": [[1, 2, 3, 4, 5, 6, 7, 8, 9, 10]]})";
+
+class HttpRestApiHandlerBatchPredictTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(ModelManager::getInstance().startFromFile(createConfigFileWithContent(resizableModelsConfig)), StatusCode::OK);
+    }
+
+    Status process(const std::string& body, std::unique_ptr<RestPredictCall>* deferredPredict = nullptr) {
+        response.clear();
+        return handler.processRequest("POST", "/v1/batch:predict", body, &headers, &response, NO_DEADLINE, {}, deferredPredict);
+    }
+
+    std::string getContentType() const {
+        for (const auto& [name, value] : headers) {
+            if (name == "Content-Type") {
+                return value;
+            }
+        }
+        return "";
+    }
+
+    static std::vector<std::string> splitLines(const std::string& text) {
+        std::vector<std::string> lines;
+        size_t begin = 0;
+        for (size_t end = text.find('\n'); end != std::string::npos; begin = end + 1, end = text.find('\n', begin)) {
+            lines.push_back(text.substr(begin, end - begin));
+        }
+        return lines;
+    }
+
+    HttpRestApiHandler handler{5000};
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string response;
+};
+}  // namespace
+
+TEST_F(HttpRestApiHandlerBatchPredictTest, JsonLinesEntriesAreAnsweredInOrder) {
+    ASSERT_EQ(process(DUMMY_BATCH_ENTRY + "\n" + UNKNOWN_MODEL_BATCH_ENTRY + "\n" + DUMMY_BATCH_ENTRY + "\n"), StatusCode::OK);
+    EXPECT_EQ(getContentType(), "application/x-ndjson");
+    const auto lines = splitLines(response);
+    ASSERT_EQ(lines.size(), 3);
+    for (size_t i : {0, 2}) {
+        rapidjson::Document doc;
+        ASSERT_FALSE(doc.Parse(lines[i].c_str()).HasParseError()) << lines[i];
+        EXPECT_TRUE(doc.HasMember("predictions")) << lines[i];
+    }
+    rapidjson::Document error;
+    ASSERT_FALSE(error.Parse(lines[1].c_str()).HasParseError()) << lines[1];
+    EXPECT_TRUE(error.HasMember("error")) << lines[1];
+}
+
+TEST_F(HttpRestApiHandlerBatchPredictTest, ArrayEntriesAreAnsweredWithArray) {
+    ASSERT_EQ(process("[" + DUMMY_BATCH_ENTRY + ", " + UNKNOWN_MODEL_BATCH_ENTRY + "]"), StatusCode::OK);
+    EXPECT_EQ(getContentType(), "application/json");
+    rapidjson::Document doc;
+    ASSERT_FALSE(doc.Parse(response.c_str()).HasParseError()) << response;
+    ASSERT_TRUE(doc.IsArray());
+    ASSERT_EQ(doc.Size(), 2);
+    EXPECT_TRUE(doc[0].HasMember("predictions"));
+    EXPECT_TRUE(doc[1].HasMember("error"));
+}
+
+TEST_F(HttpRestApiHandlerBatchPredictTest, InvalidBatchIsRejected) {
+    EXPECT_EQ(process(""), StatusCode::REST_BATCH_REQUEST_INVALID);
+    EXPECT_EQ(process("[]"), StatusCode::REST_BATCH_REQUEST_INVALID);
+    EXPECT_EQ(process("[" + DUMMY_BATCH_ENTRY), StatusCode::JSON_INVALID);
+    ASSERT_EQ(process(R"([{"instances": [[1]]}, 1])"), StatusCode::OK);
+    rapidjson::Document doc;
+    ASSERT_FALSE(doc.Parse(response.c_str()).HasParseError()) << response;
+    ASSERT_EQ(doc.Size(), 2);
+    EXPECT_TRUE(doc[0].HasMember("error"));
+    EXPECT_TRUE(doc[1].HasMember("error"));
+}
+
+TEST_F(HttpRestApiHandlerBatchPredictTest, BatchIsDeferredToInferenceWorkers) {
+    const std::string body = DUMMY_BATCH_ENTRY + "\n" + DUMMY_BATCH_ENTRY + "\n";
+    std::unique_ptr<RestPredictCall> call;
+    ASSERT_EQ(process(body, &call), StatusCode::OK);
+    ASSERT_NE(call, nullptr);
+    // nothing is inferred by the thread which read the request
+    EXPECT_TRUE(response.empty());
+    EXPECT_EQ(call->batchRequest, &body);
+
+    std::string output;
+    ASSERT_EQ(handler.executePredictRequest(*call, &output, &headers), StatusCode::OK);
+    EXPECT_EQ(getContentType(), "application/x-ndjson");
+    const auto lines = splitLines(output);
+    ASSERT_EQ(lines.size(), 2);
+    for (const auto& line : lines) {
+        rapidjson::Document doc;
+        ASSERT_FALSE(doc.Parse(line.c_str()).HasParseError()) << line;
+        EXPECT_TRUE(doc.HasMember("predictions")) << line;
+    }
+}
+
+namespace {
+const char* metricsConfig = R"(
+{
+    "model_config_list": [
+        {
+            "config": {
+                "name": "dummy",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 2
+            }
+        }
+    ],
+    "pipeline_config_list": [
+        {
+            "name": "metricsPipeline",
+            "inputs": ["custom_dummy_input"],
+            "nodes": [
+                {
+                    "name": "dummyNode",
+                    "model_name": "dummy",
+                    "type": "DL model",
+                    "inputs": [
+                        {"b": {"node_name": "request",
+                               "data_item": "custom_dummy_input"}}
+                    ],
+                    "outputs": [
+                        {"data_item": "a",
+                         "alias": "new_dummy_output"}
+                    ]
+                }
+            ],
+            "outputs": [
+                {"custom_dummy_output": {"node_name": "dummyNode",
+                                         "data_item": "new_dummy_output"}
+                }
+            ]
+        }
+    ]
+})";
+
+class HttpRestApiHandlerMetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(ModelManager::getInstance().startFromFile(createConfigFileWithContent(metricsConfig)), StatusCode::OK);
+    }
+
+    Status process(const std::string& method, const std::string& path, const std::string& body = "") {
+        response.clear();
+        return handler.processRequest(method, path, body, &headers, &response, NO_DEADLINE);
+    }
+
+    void getMetrics(rapidjson::Document& doc) {
+        ASSERT_EQ(process("GET", "/v1/metrics"), StatusCode::OK);
+        ASSERT_FALSE(doc.Parse(response.c_str()).HasParseError()) << response;
+        ASSERT_TRUE(doc.IsObject());
+        ASSERT_TRUE(doc.HasMember("pipelines") && doc["pipelines"].IsArray());
+        ASSERT_TRUE(doc.HasMember("models") && doc["models"].IsArray());
+    }
+
+    static const rapidjson::Value* findByName(const rapidjson::Value& array, const std::string& name) {
+        for (const auto& entry : array.GetArray()) {
+            if (entry.HasMember("name") && name == entry["name"].GetString()) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    static void expectHistogram(const rapidjson::Value& histogram) {
+        ASSERT_TRUE(histogram.IsObject());
+        for (const char* key : {"count", "mean_us", "p50_us", "p90_us", "p99_us", "max_us"}) {
+            EXPECT_TRUE(histogram.HasMember(key)) << key;
+        }
+        EXPECT_LE(histogram["p50_us"].GetUint64(), histogram["p90_us"].GetUint64());
+        EXPECT_LE(histogram["p90_us"].GetUint64(), histogram["p99_us"].GetUint64());
+    }
+
+    HttpRestApiHandler handler{5000};
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string response;
+};
+}  // namespace
+
+TEST_F(HttpRestApiHandlerMetricsTest, PipelineAndNodeLatenciesAreReported) {
+    rapidjson::Document before;
+    getMetrics(before);
+    const auto* pipelineBefore = findByName(before["pipelines"], "metricsPipeline");
+    ASSERT_NE(pipelineBefore, nullptr);
+    const uint64_t countBefore = (*pipelineBefore)["end_to_end"]["count"].GetUint64();
+
+    ASSERT_EQ(process("POST", "/v1/models/metricsPipeline:predict", R"({"inputs": {"custom_dummy_input": [[1, 2, 3, 4, 5, 6, 7, 8, 9, 10]]}})"), StatusCode::OK);
+
+    rapidjson::Document after;
+    getMetrics(after);
+    const auto* pipeline = findByName(after["pipelines"], "metricsPipeline");
+    ASSERT_NE(pipeline, nullptr);
+    expectHistogram((*pipeline)["end_to_end"]);
+    EXPECT_EQ((*pipeline)["end_to_end"]["count"].GetUint64(), countBefore + 1);
+    EXPECT_GT((*pipeline)["end_to_end"]["max_us"].GetUint64(), 0);
+    ASSERT_TRUE((*pipeline)["nodes"].IsArray());
+    const auto* node = findByName((*pipeline)["nodes"], "dummyNode");
+    ASSERT_NE(node, nullptr);
+    for (const char* stage : {"stream_wait", "input_setup", "inference", "fetch_results"}) {
+        ASSERT_TRUE(node->HasMember(stage)) << stage;
+        expectHistogram((*node)[stage]);
+    }
+    EXPECT_GE((*node)["inference"]["count"].GetUint64(), 1);
+    // entry and exit nodes are covered by end to end latency
+    EXPECT_EQ((*pipeline)["nodes"].Size(), 1);
+}
+
+TEST_F(HttpRestApiHandlerMetricsTest, ModelMemoryAndStatisticsAreReported) {
+    rapidjson::Document before;
+    getMetrics(before);
+    const auto* modelBefore = findByName(before["models"], "dummy");
+    ASSERT_NE(modelBefore, nullptr);
+    const uint64_t requestsBefore = (*modelBefore)["statistics"]["requests"].GetUint64();
+
+    ASSERT_EQ(process("POST", "/v1/models/dummy:predict", R"({"instances": [[1, 2, 3, 4, 5, 6, 7, 8, 9, 10]]})"), StatusCode::OK);
+
+    rapidjson::Document after;
+    getMetrics(after);
+    const auto* model = findByName(after["models"], "dummy");
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ((*model)["version"].GetInt64(), 1);
+    const auto& memory = (*model)["memory"];
+    ASSERT_TRUE(memory.IsObject());
+    EXPECT_EQ(memory["total_bytes"].GetUint64(),
+        memory["network_bytes"].GetUint64() + memory["executable_network_bytes"].GetUint64() +
+            memory["infer_requests_bytes"].GetUint64() + memory["response_cache_bytes"].GetUint64());
+    EXPECT_GT(memory["infer_requests_bytes"].GetUint64(), 0);
+    ASSERT_TRUE(model->HasMember("load_profile"));
+    EXPECT_TRUE((*model)["load_profile"].HasMember("total_us"));
+    const auto& statistics = (*model)["statistics"];
+    EXPECT_EQ(statistics["requests"].GetUint64(), requestsBefore + 1);
+    for (const char* stage : {"stream_wait", "deserialization", "inference", "serialization"}) {
+        ASSERT_TRUE(statistics.HasMember(stage)) << stage;
+        expectHistogram(statistics[stage]);
+    }
+    ASSERT_TRUE(statistics["batch_sizes"].IsArray());
+    EXPECT_FALSE(statistics["batch_sizes"].Empty());
+    // no dynamic batching is configured
+    EXPECT_FALSE(model->HasMember("adaptive_batching"));
+    ASSERT_TRUE(after.HasMember("models_memory"));
+    EXPECT_TRUE(after["models_memory"].HasMember("used_bytes"));
+    ASSERT_TRUE(after.HasMember("hot_path"));
+}
@@ -0,0 +1,66 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../http_server.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+class RemoveStaleUnixSocketTest : public TestWithTempDir {};
+
+TEST_F(RemoveStaleUnixSocketTest, MissingPathIsAccepted) {
+    EXPECT_TRUE(removeStaleUnixSocket(directoryPath + "/missing.sock"));
+}
+
+TEST_F(RemoveStaleUnixSocketTest, SocketIsRemoved) {
+    const std::string path = directoryPath + "/stale.sock";
+    int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_NE(s, -1);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    ASSERT_EQ(bind(s, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    close(s);
+    ASSERT_TRUE(std::filesystem::exists(path));
+
+    EXPECT_TRUE(removeStaleUnixSocket(path));
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST_F(RemoveStaleUnixSocketTest, OtherFilesAreNotRemoved) {
+    const std::string filePath = directoryPath + "/config.json";
+    std::ofstream(filePath) << "{}";
+    EXPECT_FALSE(removeStaleUnixSocket(filePath));
+    EXPECT_TRUE(std::filesystem::exists(filePath));
+
+    const std::string directory = directoryPath + "/models";
+    std::filesystem::create_directory(directory);
+    EXPECT_FALSE(removeStaleUnixSocket(directory));
+    EXPECT_TRUE(std::filesystem::exists(directory));
+
+    const std::string link = directoryPath + "/link.sock";
+    std::filesystem::create_symlink(filePath, link);
+    EXPECT_FALSE(removeStaleUnixSocket(link));
+    EXPECT_TRUE(std::filesystem::is_symlink(link));
+}
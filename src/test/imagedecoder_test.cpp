@@ -0,0 +1,241 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <jpeglib.h>
+#include <png.h>
+
+#include "../imagedecoder.hpp"
+
+using ovms::DecodedImage;
+using ovms::ImageColorOrder;
+using ovms::StatusCode;
+using ovms::TensorInfo;
+
+namespace {
+
+std::string encodePng(const std::vector<uint8_t>& pixels, size_t height, size_t width, size_t channels) {
+    png_image png{};
+    png.version = PNG_IMAGE_VERSION;
+    png.width = static_cast<png_uint_32>(width);
+    png.height = static_cast<png_uint_32>(height);
+    png.format = channels == 1 ? PNG_FORMAT_GRAY : PNG_FORMAT_RGB;
+    png_alloc_size_t size = 0;
+    EXPECT_TRUE(png_image_write_to_memory(&png, nullptr, &size, 0, pixels.data(), 0, nullptr));
+    std::string encoded(size, '\0');
+    EXPECT_TRUE(png_image_write_to_memory(&png, encoded.data(), &size, 0, pixels.data(), 0, nullptr));
+    encoded.resize(size);
+    return encoded;
+}
+
+std::string encodeJpeg(const std::vector<uint8_t>& pixels, size_t height, size_t width) {
+    jpeg_compress_struct info;
+    jpeg_error_mgr error;
+    info.err = jpeg_std_error(&error);
+    jpeg_create_compress(&info);
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    jpeg_mem_dest(&info, &buffer, &size);
+    info.image_width = static_cast<JDIMENSION>(width);
+    info.image_height = static_cast<JDIMENSION>(height);
+    info.input_components = 3;
+    info.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&info);
+    jpeg_set_quality(&info, 100, TRUE);
+    jpeg_start_compress(&info, TRUE);
+    while (info.next_scanline < info.image_height) {
+        JSAMPROW row = const_cast<uint8_t*>(pixels.data()) + info.next_scanline * width * 3;
+        jpeg_write_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_compress(&info);
+    jpeg_destroy_compress(&info);
+    std::string encoded(reinterpret_cast<char*>(buffer), size);
+    std::free(buffer);
+    return encoded;
+}
+
+std::vector<uint8_t> solidImage(size_t height, size_t width, std::vector<uint8_t> color) {
+    std::vector<uint8_t> pixels;
+    for (size_t i = 0; i < height * width; ++i) {
+        pixels.insert(pixels.end(), color.begin(), color.end());
+    }
+    return pixels;
+}
+
+}  // namespace
+
+TEST(ImageDecoder, DecodePngInRequestedColorOrder) {
+    const std::vector<uint8_t> pixels{10, 20, 30, 40, 50, 60};
+    const auto encoded = encodePng(pixels, 1, 2, 3);
+
+    DecodedImage image;
+    ASSERT_EQ(ovms::decodeImage(encoded, 3, ImageColorOrder::RGB, 1, 2, image), StatusCode::OK);
+    EXPECT_EQ(image.height, 1);
+    EXPECT_EQ(image.width, 2);
+    EXPECT_EQ(image.channels, 3);
+    EXPECT_EQ(image.pixels, pixels);
+
+    ASSERT_EQ(ovms::decodeImage(encoded, 3, ImageColorOrder::BGR, 1, 2, image), StatusCode::OK);
+    EXPECT_EQ(image.pixels, (std::vector<uint8_t>{30, 20, 10, 60, 50, 40}));
+}
+
+TEST(ImageDecoder, DecodeGrayPngIntoColorImage) {
+    const auto encoded = encodePng({0, 255}, 2, 1, 1);
+
+    DecodedImage image;
+    ASSERT_EQ(ovms::decodeImage(encoded, 3, ImageColorOrder::RGB, 2, 1, image), StatusCode::OK);
+    EXPECT_EQ(image.pixels, (std::vector<uint8_t>{0, 0, 0, 255, 255, 255}));
+
+    ASSERT_EQ(ovms::decodeImage(encoded, 1, ImageColorOrder::RGB, 2, 1, image), StatusCode::OK);
+    EXPECT_EQ(image.channels, 1);
+    EXPECT_EQ(image.pixels, (std::vector<uint8_t>{0, 255}));
+}
+
+TEST(ImageDecoder, DecodeJpeg) {
+    const auto encoded = encodeJpeg(solidImage(16, 16, {200, 100, 50}), 16, 16);
+
+    DecodedImage image;
+    ASSERT_EQ(ovms::decodeImage(encoded, 3, ImageColorOrder::BGR, 16, 16, image), StatusCode::OK);
+    ASSERT_EQ(image.height, 16);
+    ASSERT_EQ(image.width, 16);
+    ASSERT_EQ(image.pixels.size(), 16 * 16 * 3);
+    for (size_t i = 0; i < image.pixels.size(); i += 3) {
+        EXPECT_NEAR(image.pixels[i], 50, 3);
+        EXPECT_NEAR(image.pixels[i + 1], 100, 3);
+        EXPECT_NEAR(image.pixels[i + 2], 200, 3);
+    }
+}
+
+TEST(ImageDecoder, ScaleDownJpegDuringDecoding) {
+    const auto encoded = encodeJpeg(solidImage(64, 48, {0, 128, 255}), 64, 48);
+
+    DecodedImage image;
+    ASSERT_EQ(ovms::decodeImage(encoded, 3, ImageColorOrder::RGB, 10, 10, image), StatusCode::OK);
+    // 2/8 scale is the smallest one keeping both dimensions at least 10
+    EXPECT_EQ(image.height, 16);
+    EXPECT_EQ(image.width, 12);
+
+    ASSERT_EQ(ovms::decodeImage(encoded, 3, ImageColorOrder::RGB, 100, 10, image), StatusCode::OK);
+    EXPECT_EQ(image.height, 64);
+    EXPECT_EQ(image.width, 48);
+}
+
+TEST(ImageDecoder, RejectInvalidImages) {
+    DecodedImage image;
+    EXPECT_EQ(ovms::decodeImage("", 3, ImageColorOrder::RGB, 1, 1, image), StatusCode::IMAGE_DECODING_FAILED);
+    EXPECT_EQ(ovms::decodeImage("GIF89a", 3, ImageColorOrder::RGB, 1, 1, image), StatusCode::IMAGE_DECODING_FAILED);
+    EXPECT_EQ(ovms::decodeImage("\xFF\xD8\xFF\x00garbage", 3, ImageColorOrder::RGB, 1, 1, image), StatusCode::IMAGE_DECODING_FAILED);
+    auto png = encodePng({1, 2, 3}, 1, 1, 3);
+    png.resize(png.size() / 2);
+    EXPECT_EQ(ovms::decodeImage(png, 3, ImageColorOrder::RGB, 1, 1, image), StatusCode::IMAGE_DECODING_FAILED);
+}
+
+TEST(ImageDecoder, ResizeBilinear) {
+    DecodedImage image;
+    image.pixels = {0, 100};
+    image.height = 1;
+    image.width = 2;
+    image.channels = 1;
+
+    std::vector<uint8_t> u8(4);
+    ovms::resizeImage(image, 1, 4, true, InferenceEngine::Precision::U8, u8.data());
+    EXPECT_EQ(u8, (std::vector<uint8_t>{0, 25, 75, 100}));
+
+    std::vector<float> fp32(8);
+    ovms::resizeImage(image, 2, 4, true, InferenceEngine::Precision::FP32, fp32.data());
+    EXPECT_EQ(fp32, (std::vector<float>{0, 25, 75, 100, 0, 25, 75, 100}));
+}
+
+TEST(ImageDecoder, ResizeIntoPlanarAndInterleavedLayout) {
+    DecodedImage image;
+    image.pixels = {1, 2, 3, 4, 5, 6};
+    image.height = 1;
+    image.width = 2;
+    image.channels = 3;
+
+    std::vector<uint8_t> planar(6);
+    ovms::resizeImage(image, 1, 2, true, InferenceEngine::Precision::U8, planar.data());
+    EXPECT_EQ(planar, (std::vector<uint8_t>{1, 4, 2, 5, 3, 6}));
+
+    std::vector<uint8_t> interleaved(6);
+    ovms::resizeImage(image, 1, 2, false, InferenceEngine::Precision::U8, interleaved.data());
+    EXPECT_EQ(interleaved, image.pixels);
+
+    std::vector<uint16_t> half(6);
+    ovms::resizeImage(image, 1, 2, true, InferenceEngine::Precision::FP16, half.data());
+    // 1.0 and 6.0 in half precision
+    EXPECT_EQ(half[0], 0x3C00);
+    EXPECT_EQ(half[5], 0x4600);
+}
+
+TEST(ImageDecoder, IsImageInputSupported) {
+    EXPECT_TRUE(ovms::isImageInputSupported(TensorInfo("a", InferenceEngine::Precision::U8, {1, 3, 224, 224}, InferenceEngine::Layout::NCHW)));
+    EXPECT_TRUE(ovms::isImageInputSupported(TensorInfo("a", InferenceEngine::Precision::FP32, {1, 1, 28, 28}, InferenceEngine::Layout::NHWC)));
+    EXPECT_TRUE(ovms::isImageInputSupported(TensorInfo("a", InferenceEngine::Precision::FP16, {1, 3, 8, 8}, InferenceEngine::Layout::NCHW)));
+    EXPECT_FALSE(ovms::isImageInputSupported(TensorInfo("a", InferenceEngine::Precision::I32, {1, 3, 8, 8}, InferenceEngine::Layout::NCHW)));
+    EXPECT_FALSE(ovms::isImageInputSupported(TensorInfo("a", InferenceEngine::Precision::U8, {1, 4, 8, 8}, InferenceEngine::Layout::NCHW)));
+    EXPECT_FALSE(ovms::isImageInputSupported(TensorInfo("a", InferenceEngine::Precision::U8, {1, 224, 224}, InferenceEngine::Layout::CHW)));
+}
+
+TEST(ImageDecoder, DecodeImagesIntoBatches) {
+    TensorInfo networkInput("image", InferenceEngine::Precision::U8, {3, 3, 2, 2}, InferenceEngine::Layout::NCHW);
+    networkInput.setImageColorOrder(ImageColorOrder::BGR);
+    tensorflow::TensorProto requestInput;
+    requestInput.set_dtype(tensorflow::DataType::DT_STRING);
+    for (uint8_t i = 0; i < 3; ++i) {
+        // images of other size are resized to network input
+        requestInput.add_string_val(encodePng(solidImage(1 + i, 3, {i, 10, 20}), 1 + i, 3, 3));
+    }
+
+    std::vector<uint8_t> blob(3 * 3 * 2 * 2);
+    ASSERT_EQ(ovms::decodeImages(requestInput, networkInput, blob.data(), 3), StatusCode::OK);
+    for (uint8_t i = 0; i < 3; ++i) {
+        const std::vector<uint8_t> batch(blob.begin() + i * 12, blob.begin() + (i + 1) * 12);
+        EXPECT_EQ(batch, (std::vector<uint8_t>{20, 20, 20, 20, 10, 10, 10, 10, i, i, i, i})) << "batch: " << int(i);
+    }
+
+    EXPECT_EQ(ovms::decodeImages(requestInput, networkInput, blob.data(), 2), StatusCode::INVALID_VALUE_COUNT);
+    requestInput.set_string_val(1, "not an image");
+    EXPECT_EQ(ovms::decodeImages(requestInput, networkInput, blob.data(), 3), StatusCode::IMAGE_DECODING_FAILED);
+}
+
+TEST(ImageDecoder, ConcurrentRequestsDecodeImagesOnSharedWorkers) {
+    TensorInfo networkInput("image", InferenceEngine::Precision::U8, {16, 1, 2, 2}, InferenceEngine::Layout::NCHW);
+    std::vector<std::thread> requests;
+    for (uint8_t request = 0; request < 4; ++request) {
+        requests.emplace_back([&networkInput, request]() {
+            tensorflow::TensorProto requestInput;
+            requestInput.set_dtype(tensorflow::DataType::DT_STRING);
+            for (uint8_t i = 0; i < 16; ++i) {
+                requestInput.add_string_val(encodePng(solidImage(2, 2, {uint8_t(request * 16 + i)}), 2, 2, 1));
+            }
+            std::vector<uint8_t> blob(16 * 2 * 2);
+            ASSERT_EQ(ovms::decodeImages(requestInput, networkInput, blob.data(), 16), StatusCode::OK);
+            for (uint8_t i = 0; i < 16; ++i) {
+                const std::vector<uint8_t> batch(blob.begin() + i * 4, blob.begin() + (i + 1) * 4);
+                EXPECT_EQ(batch, std::vector<uint8_t>(4, request * 16 + i)) << "request: " << int(request) << " batch: " << int(i);
+            }
+        });
+    }
+    for (auto& request : requests) {
+        request.join();
+    }
+}
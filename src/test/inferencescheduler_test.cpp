@@ -0,0 +1,170 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../inferencescheduler.hpp"
+
+using ovms::InferenceScheduler;
+using ovms::SchedulingPriority;
+
+TEST(InferenceScheduler, SlotsAreGrantedUpToLimit) {
+    InferenceScheduler scheduler;
+    scheduler.configure(2);
+    auto client = scheduler.registerClient("model", 1, SchedulingPriority::NORMAL);
+    EXPECT_TRUE(scheduler.tryAcquire(*client));
+    EXPECT_TRUE(scheduler.tryAcquire(*client));
+    EXPECT_FALSE(scheduler.tryAcquire(*client));
+    EXPECT_EQ(scheduler.getUsedSlotsCount(), 2);
+    scheduler.release(*client);
+    EXPECT_TRUE(scheduler.tryAcquire(*client));
+    scheduler.release(*client);
+    scheduler.release(*client);
+    EXPECT_EQ(scheduler.getUsedSlotsCount(), 0);
+}
+
+TEST(InferenceScheduler, DisabledSchedulerGrantsRightAway) {
+    InferenceScheduler scheduler;
+    EXPECT_FALSE(scheduler.isEnabled());
+    auto client = scheduler.registerClient("model", 1, SchedulingPriority::NORMAL);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(scheduler.tryAcquire(*client));
+    }
+    bool granted = false;
+    scheduler.acquire(*client, [&granted](bool result) { granted = result; });
+    EXPECT_TRUE(granted);
+    auto statistics = scheduler.getStatistics();
+    ASSERT_EQ(statistics.size(), 1);
+    EXPECT_EQ(statistics[0].grants, 11);
+    EXPECT_EQ(statistics[0].delayedGrants, 0);
+}
+
+TEST(InferenceScheduler, HigherPriorityIsServedFirst) {
+    InferenceScheduler scheduler;
+    scheduler.configure(1);
+    auto low = scheduler.registerClient("low", 1, SchedulingPriority::LOW);
+    auto high = scheduler.registerClient("high", 1, SchedulingPriority::HIGH);
+    ASSERT_TRUE(scheduler.tryAcquire(*low));
+    std::vector<std::string> order;
+    scheduler.acquire(*low, [&order](bool granted) { order.push_back(granted ? "low" : "expired"); });
+    scheduler.acquire(*high, [&order](bool granted) { order.push_back(granted ? "high" : "expired"); });
+    EXPECT_FALSE(scheduler.tryAcquire(*high));
+    EXPECT_TRUE(order.empty());
+    scheduler.release(*low);
+    ASSERT_EQ(order.size(), 1);
+    EXPECT_EQ(order[0], "high");
+    scheduler.release(*high);
+    ASSERT_EQ(order.size(), 2);
+    EXPECT_EQ(order[1], "low");
+    scheduler.release(*low);
+    EXPECT_EQ(scheduler.getUsedSlotsCount(), 0);
+}
+
+TEST(InferenceScheduler, ClientChargedLessByWeightIsServedFirst) {
+    InferenceScheduler scheduler;
+    scheduler.configure(1);
+    auto heavy = scheduler.registerClient("heavy", 100, SchedulingPriority::NORMAL);
+    auto light = scheduler.registerClient("light", 1, SchedulingPriority::NORMAL);
+    // both hold the slot for a while, light one is charged the full time, heavy one a hundredth of it
+    ASSERT_TRUE(scheduler.tryAcquire(*light));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    scheduler.release(*light);
+    ASSERT_TRUE(scheduler.tryAcquire(*heavy));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    ASSERT_FALSE(scheduler.tryAcquire(*light));
+    std::vector<std::string> order;
+    scheduler.acquire(*light, [&order](bool) { order.push_back("light"); });
+    scheduler.acquire(*heavy, [&order](bool) { order.push_back("heavy"); });
+    scheduler.release(*heavy);
+    ASSERT_EQ(order.size(), 1);
+    EXPECT_EQ(order[0], "heavy");
+    scheduler.release(*heavy);
+    ASSERT_EQ(order.size(), 2);
+    EXPECT_EQ(order[1], "light");
+    scheduler.release(*light);
+    for (const auto& client : scheduler.getStatistics()) {
+        EXPECT_EQ(client.delayedGrants, 1) << client.name;
+        EXPECT_EQ(client.waiting, 0) << client.name;
+    }
+}
+
+TEST(InferenceScheduler, ExpiredWaiterIsRejected) {
+    InferenceScheduler scheduler;
+    scheduler.configure(1);
+    auto client = scheduler.registerClient("model", 1, SchedulingPriority::NORMAL);
+    ASSERT_TRUE(scheduler.tryAcquire(*client));
+    int rejected = 0;
+    int granted = 0;
+    scheduler.acquire(
+        *client, [&](bool result) { result ? granted++ : rejected++; }, std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+    scheduler.acquire(*client, [&](bool result) { result ? granted++ : rejected++; });
+    scheduler.release(*client);
+    EXPECT_EQ(rejected, 1);
+    EXPECT_EQ(granted, 1);
+    scheduler.release(*client);
+    EXPECT_EQ(scheduler.getUsedSlotsCount(), 0);
+}
+
+TEST(InferenceScheduler, UnregisteredClientsAreRemovedFromStatistics) {
+    InferenceScheduler scheduler;
+    scheduler.configure(1);
+    {
+        auto client = scheduler.registerClient("model", 1, SchedulingPriority::NORMAL);
+        EXPECT_EQ(scheduler.getStatistics().size(), 1);
+    }
+    EXPECT_TRUE(scheduler.getStatistics().empty());
+}
+
+TEST(InferenceScheduler, WaiterExpiresAtDeadlineWithoutRelease) {
+    InferenceScheduler scheduler;
+    scheduler.configure(1);
+    auto client = scheduler.registerClient("model", 1, SchedulingPriority::NORMAL);
+    ASSERT_TRUE(scheduler.tryAcquire(*client));
+    std::promise<bool> result;
+    auto resultFuture = result.get_future();
+    const auto start = std::chrono::steady_clock::now();
+    scheduler.acquire(
+        *client, [&result](bool granted) { result.set_value(granted); }, start + std::chrono::milliseconds(20));
+    // nobody releases the slot, waiter is expired by the deadline timer
+    ASSERT_EQ(resultFuture.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_FALSE(resultFuture.get());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(scheduler.getStatistics()[0].waiting, 0);
+    scheduler.release(*client);
+    EXPECT_EQ(scheduler.getUsedSlotsCount(), 0);
+}
+
+TEST(InferenceScheduler, WaiterServedBeforeDeadlineIsNotExpired) {
+    InferenceScheduler scheduler;
+    scheduler.configure(1);
+    auto client = scheduler.registerClient("model", 1, SchedulingPriority::NORMAL);
+    ASSERT_TRUE(scheduler.tryAcquire(*client));
+    std::atomic<int> granted{0};
+    std::atomic<int> rejected{0};
+    scheduler.acquire(
+        *client, [&](bool result) { result ? granted++ : rejected++; }, std::chrono::steady_clock::now() + std::chrono::milliseconds(50));
+    scheduler.release(*client);
+    EXPECT_EQ(granted, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(rejected, 0);
+    scheduler.release(*client);
+}
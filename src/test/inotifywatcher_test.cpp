@@ -0,0 +1,103 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../inotifywatcher.hpp"
+#include "test_utils.hpp"
+
+using ovms::InotifyWatcher;
+
+const std::chrono::milliseconds WAIT_FOR_CHANGES_TIMEOUT{1000};
+const std::chrono::milliseconds QUIET_PERIOD{50};
+
+class InotifyWatcherTest : public TestWithTempDir {
+protected:
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        std::filesystem::create_directories(directoryPath + "/first/1");
+        std::filesystem::create_directories(directoryPath + "/second/1");
+        ASSERT_TRUE(watcher.isValid());
+        ASSERT_TRUE(watcher.watchTree(directoryPath + "/first", "first"));
+        ASSERT_TRUE(watcher.watchTree(directoryPath + "/second", "second"));
+    }
+    InotifyWatcher watcher;
+};
+
+TEST_F(InotifyWatcherTest, NoChangesReportedOnTimeout) {
+    EXPECT_TRUE(watcher.waitForChanges(std::chrono::milliseconds(10), QUIET_PERIOD).empty());
+}
+
+TEST_F(InotifyWatcherTest, WakeEndsWaitingWithoutChanges) {
+    std::thread waker([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        watcher.wake();
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(watcher.waitForChanges(std::chrono::seconds(10), QUIET_PERIOD).empty());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    waker.join();
+}
+
+TEST_F(InotifyWatcherTest, NewVersionDirectoryReportedForItsModelOnly) {
+    std::filesystem::create_directories(directoryPath + "/first/2");
+    EXPECT_EQ(watcher.waitForChanges(WAIT_FOR_CHANGES_TIMEOUT, QUIET_PERIOD), std::set<std::string>{"first"});
+}
+
+TEST_F(InotifyWatcherTest, FileWrittenInVersionDirectoryReported) {
+    std::ofstream(directoryPath + "/second/1/model.xml") << "<net/>";
+    EXPECT_EQ(watcher.waitForChanges(WAIT_FOR_CHANGES_TIMEOUT, QUIET_PERIOD), std::set<std::string>{"second"});
+}
+
+TEST_F(InotifyWatcherTest, BurstOfChangesReportedOnce) {
+    std::filesystem::create_directories(directoryPath + "/first/2");
+    std::filesystem::remove_all(directoryPath + "/second/1");
+    EXPECT_EQ(watcher.waitForChanges(WAIT_FOR_CHANGES_TIMEOUT, QUIET_PERIOD), (std::set<std::string>{"first", "second"}));
+    EXPECT_TRUE(watcher.waitForChanges(std::chrono::milliseconds(10), QUIET_PERIOD).empty());
+}
+
+TEST_F(InotifyWatcherTest, UnwatchedTagNotReported) {
+    watcher.unwatch("first");
+    EXPECT_EQ(watcher.getTags(), std::set<std::string>{"second"});
+    std::filesystem::create_directories(directoryPath + "/first/2");
+    EXPECT_TRUE(watcher.waitForChanges(std::chrono::milliseconds(100), QUIET_PERIOD).empty());
+}
+
+TEST_F(InotifyWatcherTest, MissingDirectoryNotWatched) {
+    EXPECT_FALSE(watcher.watchTree(directoryPath + "/missing", "missing"));
+    EXPECT_FALSE(watcher.watchTree("s3://bucket/model", "cloud"));
+}
+
+TEST_F(InotifyWatcherTest, FileWrittenInNewVersionDirectoryReported) {
+    std::filesystem::create_directories(directoryPath + "/first/2");
+    ASSERT_EQ(watcher.waitForChanges(WAIT_FOR_CHANGES_TIMEOUT, QUIET_PERIOD), std::set<std::string>{"first"});
+    std::ofstream(directoryPath + "/first/2/model.xml") << "<net/>";
+    EXPECT_EQ(watcher.waitForChanges(WAIT_FOR_CHANGES_TIMEOUT, QUIET_PERIOD), std::set<std::string>{"first"});
+}
+
+TEST_F(InotifyWatcherTest, NewVersionDirectoryOfUnwatchedTagNotWatched) {
+    std::filesystem::create_directories(directoryPath + "/first/2");
+    ASSERT_EQ(watcher.waitForChanges(WAIT_FOR_CHANGES_TIMEOUT, QUIET_PERIOD), std::set<std::string>{"first"});
+    watcher.unwatch("first");
+    std::ofstream(directoryPath + "/first/2/model.xml") << "<net/>";
+    EXPECT_TRUE(watcher.waitForChanges(std::chrono::milliseconds(100), QUIET_PERIOD).empty());
+}
@@ -0,0 +1,191 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <grpcpp/support/byte_buffer.h>
+#include <grpcpp/support/slice.h>
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "../inplacerequestparser.hpp"
+#include "../sharedmemory.hpp"
+#include "../tensorinfo.hpp"
+
+using ovms::InPlaceRequestTensors;
+using ovms::MessageTensorRegistry;
+using ovms::StatusCode;
+using tensorflow::serving::PredictRequest;
+
+namespace {
+const size_t MIN_BYTE_SIZE = 64;
+
+PredictRequest createRequest() {
+    PredictRequest request;
+    request.mutable_model_spec()->set_name("dummy");
+    request.mutable_model_spec()->mutable_version()->set_value(3);
+    request.add_output_filter("output");
+    auto& large = (*request.mutable_inputs())["large"];
+    large.set_dtype(tensorflow::DataType::DT_FLOAT);
+    large.mutable_tensor_shape()->add_dim()->set_size(1);
+    large.mutable_tensor_shape()->add_dim()->set_size(32);
+    std::string content(32 * sizeof(float), '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i);
+    }
+    large.set_tensor_content(content);
+    auto& small = (*request.mutable_inputs())["small"];
+    small.set_dtype(tensorflow::DataType::DT_FLOAT);
+    small.mutable_tensor_shape()->add_dim()->set_size(2);
+    small.set_tensor_content(std::string(2 * sizeof(float), '\x01'));
+    return request;
+}
+
+/**
+ * @brief Splits serialized message into slices at given offsets, as if it was received in several chunks
+ */
+grpc::ByteBuffer toByteBuffer(const std::string& serialized, const std::vector<size_t>& splits = {}) {
+    std::vector<grpc::Slice> slices;
+    size_t begin = 0;
+    for (size_t split : splits) {
+        slices.emplace_back(serialized.data() + begin, split - begin);
+        begin = split;
+    }
+    slices.emplace_back(serialized.data() + begin, serialized.size() - begin);
+    return grpc::ByteBuffer(slices.data(), slices.size());
+}
+}  // namespace
+
+TEST(InPlaceRequestParser, ShouldReferenceLargeTensorContentInMessage) {
+    const auto expected = createRequest();
+    auto buffer = toByteBuffer(expected.SerializeAsString());
+    PredictRequest request;
+    {
+        InPlaceRequestTensors tensors;
+        ASSERT_EQ(ovms::parsePredictRequestInPlace(buffer, request, tensors, MIN_BYTE_SIZE), StatusCode::OK);
+        EXPECT_EQ(tensors.size(), 1u);
+        EXPECT_EQ(request.model_spec().name(), "dummy");
+        EXPECT_EQ(request.model_spec().version().value(), 3);
+        ASSERT_EQ(request.output_filter_size(), 1);
+        EXPECT_EQ(request.inputs().at("small").tensor_content(), expected.inputs().at("small").tensor_content());
+
+        const auto& large = request.inputs().at("large");
+        ASSERT_TRUE(ovms::isSharedMemoryReference(large));
+        EXPECT_EQ(large.string_val(0), "shm:@message:0:128");
+        EXPECT_EQ(large.tensor_shape().dim(1).size(), 32);
+        std::string copied(128, '\0');
+        ASSERT_EQ(ovms::copySharedMemoryReference(large, copied.data(), copied.size()), StatusCode::OK);
+        EXPECT_EQ(copied, expected.inputs().at("large").tensor_content());
+        EXPECT_NE(MessageTensorRegistry::getInstance().findRegion(&large), nullptr);
+    }
+    EXPECT_EQ(MessageTensorRegistry::getInstance().findRegion(&request.inputs().at("large")), nullptr);
+}
+
+TEST(InPlaceRequestParser, ShouldCopyTensorContentSpanningSlices) {
+    const auto expected = createRequest();
+    const auto serialized = expected.SerializeAsString();
+    const auto contentOffset = serialized.find(expected.inputs().at("large").tensor_content());
+    ASSERT_NE(contentOffset, std::string::npos);
+    auto buffer = toByteBuffer(serialized, {contentOffset + 10});
+    PredictRequest request;
+    InPlaceRequestTensors tensors;
+    ASSERT_EQ(ovms::parsePredictRequestInPlace(buffer, request, tensors, MIN_BYTE_SIZE), StatusCode::OK);
+    EXPECT_EQ(tensors.size(), 0u);
+    EXPECT_FALSE(ovms::isSharedMemoryReference(request.inputs().at("large")));
+    EXPECT_EQ(request.inputs().at("large").tensor_content(), expected.inputs().at("large").tensor_content());
+    EXPECT_EQ(request.inputs().at("small").tensor_content(), expected.inputs().at("small").tensor_content());
+}
+
+TEST(InPlaceRequestParser, ShouldParseMessageSplitBetweenFields) {
+    const auto expected = createRequest();
+    const auto serialized = expected.SerializeAsString();
+    // tags and lengths are split between slices as well
+    std::vector<size_t> splits;
+    for (size_t offset = 1; offset < serialized.size(); offset += 3) {
+        splits.push_back(offset);
+    }
+    auto buffer = toByteBuffer(serialized, splits);
+    PredictRequest request;
+    InPlaceRequestTensors tensors;
+    ASSERT_EQ(ovms::parsePredictRequestInPlace(buffer, request, tensors, MIN_BYTE_SIZE), StatusCode::OK);
+    EXPECT_EQ(tensors.size(), 0u);
+    EXPECT_EQ(request.inputs().size(), 2u);
+    EXPECT_EQ(request.inputs().at("large").tensor_content(), expected.inputs().at("large").tensor_content());
+    EXPECT_EQ(request.model_spec().name(), "dummy");
+}
+
+TEST(InPlaceRequestParser, ShouldCopyStringTensors) {
+    auto expected = createRequest();
+    (*expected.mutable_inputs())["large"].set_dtype(tensorflow::DataType::DT_STRING);
+    auto buffer = toByteBuffer(expected.SerializeAsString());
+    PredictRequest request;
+    InPlaceRequestTensors tensors;
+    ASSERT_EQ(ovms::parsePredictRequestInPlace(buffer, request, tensors, MIN_BYTE_SIZE), StatusCode::OK);
+    EXPECT_EQ(tensors.size(), 0u);
+    EXPECT_FALSE(ovms::isSharedMemoryReference(request.inputs().at("large")));
+    EXPECT_EQ(request.inputs().at("large").tensor_content(), expected.inputs().at("large").tensor_content());
+}
+
+TEST(InPlaceRequestParser, ShouldRejectMalformedMessage) {
+    const auto serialized = createRequest().SerializeAsString();
+    PredictRequest request;
+    InPlaceRequestTensors tensors;
+    auto truncated = toByteBuffer(serialized.substr(0, serialized.size() - 5));
+    EXPECT_EQ(ovms::parsePredictRequestInPlace(truncated, request, tensors, MIN_BYTE_SIZE), StatusCode::MALFORMED_REQUEST_MESSAGE);
+    // start group wire type
+    auto group = toByteBuffer(std::string("\x13", 1) + serialized);
+    EXPECT_EQ(ovms::parsePredictRequestInPlace(group, request, tensors, MIN_BYTE_SIZE), StatusCode::MALFORMED_REQUEST_MESSAGE);
+}
+
+TEST(InPlaceRequestParser, ClientsShouldNotReferenceMessageRegionDirectly) {
+    tensorflow::TensorProto proto;
+    proto.set_dtype(tensorflow::DataType::DT_FLOAT);
+    proto.add_string_val("shm:@message:0:16");
+    char destination[16];
+    EXPECT_EQ(ovms::copySharedMemoryReference(proto, destination, sizeof(destination)), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+    EXPECT_EQ(ovms::SharedMemoryRegistry::getInstance().registerRegion(ovms::MESSAGE_TENSOR_REGION_NAME, "/ovms_test_missing_object", 16),
+        StatusCode::SHM_REGION_NAME_RESERVED);
+}
+
+TEST(InPlaceRequestParser, ShouldCopyContentOfInputsConvertedByModel) {
+    const auto expected = createRequest();
+    auto buffer = toByteBuffer(expected.SerializeAsString());
+    PredictRequest request;
+    InPlaceRequestTensors tensors;
+    ASSERT_EQ(ovms::parsePredictRequestInPlace(buffer, request, tensors, MIN_BYTE_SIZE), StatusCode::OK);
+    ASSERT_EQ(tensors.size(), 1u);
+    ovms::tensor_map_t inputsInfo;
+    inputsInfo["large"] = std::make_shared<ovms::TensorInfo>("large", InferenceEngine::Precision::FP32, ovms::shape_t{1, 32});
+    tensors.copyConvertedInputs(request, inputsInfo);
+    // network precision matches, the reference is kept
+    EXPECT_EQ(tensors.size(), 1u);
+    EXPECT_TRUE(ovms::isSharedMemoryReference(request.inputs().at("large")));
+
+    inputsInfo["large"] = std::make_shared<ovms::TensorInfo>("large", InferenceEngine::Precision::FP16, ovms::shape_t{1, 32});
+    tensors.copyConvertedInputs(request, inputsInfo);
+    EXPECT_EQ(tensors.size(), 0u);
+    const auto& large = request.inputs().at("large");
+    EXPECT_FALSE(ovms::isSharedMemoryReference(large));
+    EXPECT_EQ(large.string_val_size(), 0);
+    EXPECT_EQ(large.tensor_content(), expected.inputs().at("large").tensor_content());
+    EXPECT_EQ(MessageTensorRegistry::getInstance().findRegion(&large), nullptr);
+}
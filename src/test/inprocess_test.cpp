@@ -0,0 +1,178 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../inferrequestpools.hpp"
+#include "../inprocess.hpp"
+#include "../modelinstance.hpp"
+#include "../modelmanager.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+static const char* inProcessPipelineConfig = R"(
+{
+    "model_config_list": [
+        {
+            "config": {
+                "name": "dummy",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 1
+            }
+        }
+    ],
+    "pipeline_config_list": [
+        {
+            "name": "pipeline1Dummy",
+            "inputs": ["custom_dummy_input"],
+            "nodes": [
+                {
+                    "name": "dummyNode",
+                    "model_name": "dummy",
+                    "type": "DL model",
+                    "inputs": [
+                        {"b": {"node_name": "request",
+                               "data_item": "custom_dummy_input"}}
+                    ],
+                    "outputs": [
+                        {"data_item": "a",
+                         "alias": "new_dummy_output"}
+                    ]
+                }
+            ],
+            "outputs": [
+                {"custom_dummy_output": {"node_name": "dummyNode",
+                                         "data_item": "new_dummy_output"}
+                }
+            ]
+        }
+    ]
+})";
+
+class InProcessServerTest : public TestWithTempDir {
+protected:
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        manager.reloadModelWithVersions(config);
+    }
+
+    InferenceEngine::Blob::Ptr wrap(std::vector<float>& data, const shape_t& shape = {1, DUMMY_MODEL_INPUT_SIZE}) {
+        return InProcessServer::wrapBuffer(InferenceEngine::TensorDesc(InferenceEngine::Precision::FP32, shape, InferenceEngine::Layout::ANY), data.data());
+    }
+
+    static std::vector<float> incremented(const std::vector<float>& data) {
+        std::vector<float> result(data);
+        for (auto& value : result) {
+            value += 1.0;
+        }
+        return result;
+    }
+
+    static std::vector<float> values(const InferenceEngine::Blob::Ptr& blob) {
+        const float* data = blob->cbuffer().as<const float*>();
+        return std::vector<float>(data, data + blob->size());
+    }
+
+    ModelConfig config = DUMMY_MODEL_CONFIG;
+    ConstructorEnabledModelManager manager;
+    std::vector<float> data{-5.0, 3.0, 0.0, -12.0, 9.0, -100.0, 102.0, 92.0, -1.0, 12.0};
+};
+
+TEST_F(InProcessServerTest, ModelInference) {
+    BlobMap inputs{{DUMMY_MODEL_INPUT_NAME, wrap(data)}};
+    BlobMap outputs;
+    auto status = InProcessServer::infer(manager, "dummy", 0, inputs, outputs);
+    ASSERT_EQ(status, StatusCode::OK) << status.string();
+    ASSERT_EQ(outputs.count(DUMMY_MODEL_OUTPUT_NAME), 1);
+    EXPECT_EQ(outputs.at(DUMMY_MODEL_OUTPUT_NAME)->getTensorDesc().getDims(), (shape_t{1, DUMMY_MODEL_OUTPUT_SIZE}));
+    EXPECT_EQ(values(outputs.at(DUMMY_MODEL_OUTPUT_NAME)), incremented(data));
+}
+
+TEST_F(InProcessServerTest, OutputsAreNotOverwrittenByFollowingInference) {
+    BlobMap inputs{{DUMMY_MODEL_INPUT_NAME, wrap(data)}};
+    BlobMap firstOutputs;
+    ASSERT_EQ(InProcessServer::infer(manager, "dummy", 1, inputs, firstOutputs), StatusCode::OK);
+
+    std::vector<float> otherData(DUMMY_MODEL_INPUT_SIZE, 7.0);
+    inputs[DUMMY_MODEL_INPUT_NAME] = wrap(otherData);
+    BlobMap secondOutputs;
+    ASSERT_EQ(InProcessServer::infer(manager, "dummy", 1, inputs, secondOutputs), StatusCode::OK);
+
+    EXPECT_EQ(values(firstOutputs.at(DUMMY_MODEL_OUTPUT_NAME)), incremented(data));
+    EXPECT_EQ(values(secondOutputs.at(DUMMY_MODEL_OUTPUT_NAME)), incremented(otherData));
+}
+
+TEST_F(InProcessServerTest, CallerBlobsAreNotLeftOnInferRequest) {
+    BlobMap inputs{{DUMMY_MODEL_INPUT_NAME, wrap(data)}};
+    BlobMap outputs;
+    ASSERT_EQ(InProcessServer::infer(manager, "dummy", 1, inputs, outputs), StatusCode::OK);
+
+    // infer request must not keep pointers into memory the caller can free
+    auto instance = manager.findModelInstance("dummy");
+    ASSERT_NE(instance, nullptr);
+    auto& queue = instance->getInferRequestsQueue(DIRECT_INFER_REQUESTS_POOL);
+    for (size_t i = 0; i < queue.getInferRequestsCount(); ++i) {
+        auto& inferRequest = queue.getInferRequest(i);
+        EXPECT_NE(inferRequest.GetBlob(DUMMY_MODEL_INPUT_NAME)->cbuffer().as<const void*>(), static_cast<const void*>(data.data()));
+        EXPECT_NE(inferRequest.GetBlob(DUMMY_MODEL_OUTPUT_NAME), outputs.at(DUMMY_MODEL_OUTPUT_NAME));
+    }
+}
+
+TEST_F(InProcessServerTest, InvalidInputs) {
+    BlobMap outputs;
+    BlobMap inputs;
+    EXPECT_EQ(InProcessServer::infer(manager, "dummy", 0, inputs, outputs), StatusCode::INVALID_NO_OF_INPUTS);
+
+    inputs = {{"unknown", wrap(data)}};
+    EXPECT_EQ(InProcessServer::infer(manager, "dummy", 0, inputs, outputs), StatusCode::INVALID_MISSING_INPUT);
+
+    inputs = {{DUMMY_MODEL_INPUT_NAME, wrap(data, {2, DUMMY_MODEL_INPUT_SIZE / 2})}};
+    EXPECT_EQ(InProcessServer::infer(manager, "dummy", 0, inputs, outputs), StatusCode::INVALID_SHAPE);
+
+    std::vector<int32_t> intData(DUMMY_MODEL_INPUT_SIZE);
+    inputs = {{DUMMY_MODEL_INPUT_NAME, InProcessServer::wrapBuffer(
+                                           InferenceEngine::TensorDesc(InferenceEngine::Precision::I32, {1, DUMMY_MODEL_INPUT_SIZE}, InferenceEngine::Layout::ANY),
+                                           intData.data())}};
+    EXPECT_EQ(InProcessServer::infer(manager, "dummy", 0, inputs, outputs), StatusCode::INVALID_PRECISION);
+    EXPECT_TRUE(outputs.empty());
+}
+
+TEST_F(InProcessServerTest, MissingModel) {
+    BlobMap inputs{{DUMMY_MODEL_INPUT_NAME, wrap(data)}};
+    BlobMap outputs;
+    EXPECT_EQ(InProcessServer::infer(manager, "missing", 0, inputs, outputs), StatusCode::MODEL_NAME_MISSING);
+    EXPECT_EQ(InProcessServer::infer(manager, "dummy", 5, inputs, outputs), StatusCode::MODEL_VERSION_MISSING);
+}
+
+TEST_F(InProcessServerTest, PipelineInference) {
+    std::string fileToReload = directoryPath + "/ovms_config_file.json";
+    createConfigFileWithContent(inProcessPipelineConfig, fileToReload);
+    ConstructorEnabledModelManager managerWithPipeline;
+    ASSERT_EQ(managerWithPipeline.startFromFile(fileToReload), StatusCode::OK);
+
+    BlobMap inputs{{"custom_dummy_input", wrap(data)}};
+    BlobMap outputs;
+    auto status = InProcessServer::infer(managerWithPipeline, "pipeline1Dummy", 0, inputs, outputs);
+    ASSERT_EQ(status, StatusCode::OK) << status.string();
+    ASSERT_EQ(outputs.count("custom_dummy_output"), 1);
+    EXPECT_EQ(values(outputs.at("custom_dummy_output")), incremented(data));
+    managerWithPipeline.join();
+}
@@ -0,0 +1,116 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../filesystemmetrics.hpp"
+#include "../instrumentedfilesystem.hpp"
+#include "../localfilesystem.hpp"
+#include "test_utils.hpp"
+
+using ovms::FileSystemMetrics;
+using ovms::FileSystemOperation;
+using ovms::InstrumentedFileSystem;
+
+class InstrumentedFileSystemTest : public TestWithTempDir {
+protected:
+    // metrics are kept for the whole process, tests compare them before and after the calls
+    const FileSystemMetrics::Operation& getOperation(FileSystemOperation operation) {
+        for (const auto& [backend, metrics] : FileSystemMetrics::instance().getBackends()) {
+            if (backend == "local") {
+                return metrics->operations[static_cast<size_t>(operation)];
+            }
+        }
+        throw std::logic_error("local backend was not used");
+    }
+
+    InstrumentedFileSystem fs{std::make_shared<ovms::LocalFileSystem>()};
+};
+
+TEST_F(InstrumentedFileSystemTest, ReadTextFileRecordsCallAndBytes) {
+    const std::string path = directoryPath + "/config.json";
+    std::ofstream(path) << "{\"model_config_list\": []}";
+    std::string contents;
+    ASSERT_EQ(fs.readTextFile(path, &contents), ovms::StatusCode::OK);
+    const auto& operation = getOperation(FileSystemOperation::READ_TEXT_FILE);
+    const auto calls = operation.calls.getCount();
+    const auto bytes = operation.bytes.load();
+    const auto errors = operation.errors.load();
+    ASSERT_EQ(fs.readTextFile(path, &contents), ovms::StatusCode::OK);
+    EXPECT_EQ(operation.calls.getCount(), calls + 1);
+    EXPECT_EQ(operation.bytes.load(), bytes + contents.size());
+    EXPECT_EQ(operation.errors.load(), errors);
+}
+
+TEST_F(InstrumentedFileSystemTest, FailedCallIsCountedAsError) {
+    bool exists = false;
+    ASSERT_EQ(fs.fileExists(directoryPath, &exists), ovms::StatusCode::OK);
+    std::string contents;
+    const auto& operation = getOperation(FileSystemOperation::READ_TEXT_FILE);
+    const auto errors = operation.errors.load();
+    EXPECT_NE(fs.readTextFile(directoryPath + "/missing.json", &contents), ovms::StatusCode::OK);
+    EXPECT_EQ(operation.errors.load(), errors + 1);
+}
+
+TEST_F(InstrumentedFileSystemTest, LocalDirectorySizeSumsFilesOfSubdirectories) {
+    std::filesystem::create_directories(directoryPath + "/1");
+    std::ofstream(directoryPath + "/1/model.xml") << "<net/>";
+    std::ofstream(directoryPath + "/1/model.bin") << "weights";
+    EXPECT_EQ(InstrumentedFileSystem::getLocalDirectorySize(directoryPath), 13);
+    EXPECT_EQ(InstrumentedFileSystem::getLocalDirectorySize(directoryPath + "/missing"), 0);
+}
+
+TEST_F(InstrumentedFileSystemTest, ForwardsBackendName) {
+    EXPECT_STREQ(fs.getBackendName(), "local");
+}
+
+TEST_F(InstrumentedFileSystemTest, ListingOfSubdirectoriesIsRecorded) {
+    std::filesystem::create_directories(directoryPath + "/1");
+    std::filesystem::create_directories(directoryPath + "/2");
+    ovms::files_list_t subdirs;
+    ASSERT_EQ(fs.getDirectorySubdirs(directoryPath, &subdirs), ovms::StatusCode::OK);
+    const auto& operation = getOperation(FileSystemOperation::GET_DIRECTORY_SUBDIRS);
+    const auto calls = operation.calls.getCount();
+    subdirs.clear();
+    ASSERT_EQ(fs.getDirectorySubdirs(directoryPath, &subdirs), ovms::StatusCode::OK);
+    EXPECT_EQ(subdirs.size(), 2);
+    EXPECT_EQ(operation.calls.getCount(), calls + 1);
+}
+
+TEST_F(InstrumentedFileSystemTest, WrittenAndDeletedFilesAreRecorded) {
+    const std::string path = directoryPath + "/written/written.txt";
+    const std::string contents = "written";
+    ASSERT_EQ(fs.writeFile(path, contents), ovms::StatusCode::OK);
+    const auto& writes = getOperation(FileSystemOperation::WRITE_FILE);
+    const auto& deletes = getOperation(FileSystemOperation::DELETE_FILE_FOLDER);
+    const auto writtenBytes = writes.bytes.load();
+    const auto deleteCalls = deletes.calls.getCount();
+    ASSERT_EQ(fs.writeFile(path, contents), ovms::StatusCode::OK);
+    EXPECT_EQ(writes.bytes.load(), writtenBytes + contents.size());
+    ASSERT_EQ(fs.deleteFileFolder(path), ovms::StatusCode::OK);
+    EXPECT_EQ(deletes.calls.getCount(), deleteCalls + 1);
+}
+
+TEST(FileSystemOperation, EveryOperationHasMetricLabel) {
+    for (size_t i = 0; i < static_cast<size_t>(FileSystemOperation::COUNT); ++i) {
+        EXPECT_STRNE(ovms::toString(static_cast<FileSystemOperation>(i)), "unknown") << i;
+    }
+}
@@ -0,0 +1,127 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../latencyhistogram.hpp"
+#include "../pipelinemetrics.hpp"
+
+using ovms::LatencyHistogram;
+using ovms::NodeStage;
+using ovms::PipelineMetrics;
+
+TEST(LatencyHistogram, EmptyHistogramReportsZeros) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.getCount(), 0);
+    EXPECT_EQ(histogram.getMax(), 0);
+    EXPECT_EQ(histogram.getMean(), 0);
+    EXPECT_EQ(histogram.getPercentile(99), 0);
+}
+
+TEST(LatencyHistogram, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 10; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.getCount(), 10);
+    EXPECT_EQ(histogram.getMax(), 10);
+    EXPECT_DOUBLE_EQ(histogram.getMean(), 5.5);
+    EXPECT_EQ(histogram.getPercentile(50), 5);
+    EXPECT_EQ(histogram.getPercentile(90), 9);
+    EXPECT_EQ(histogram.getPercentile(100), 10);
+}
+
+TEST(LatencyHistogram, PercentilesAreWithinBucketPrecision) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        histogram.record(value);
+    }
+    const double precision = 1.0 / LatencyHistogram::SUB_BUCKETS_COUNT;
+    for (double percentile : {50.0, 90.0, 99.0}) {
+        const double expected = percentile * 1000;
+        const auto reported = histogram.getPercentile(percentile);
+        EXPECT_GE(reported, expected);
+        EXPECT_LE(reported, expected * (1 + precision)) << percentile;
+    }
+    EXPECT_EQ(histogram.getPercentile(100), 100000);
+}
+
+TEST(LatencyHistogram, BucketsCoverWholeRange) {
+    for (uint64_t value : {0ul, 15ul, 16ul, 17ul, 1000ul, 123456789ul, LatencyHistogram::MAX_TRACKED_MICROSECONDS}) {
+        const auto index = LatencyHistogram::getBucketIndex(value);
+        ASSERT_LT(index, LatencyHistogram::BUCKETS_COUNT);
+        EXPECT_GE(LatencyHistogram::getBucketUpperBound(index), value);
+        if (index > 0) {
+            EXPECT_LT(LatencyHistogram::getBucketUpperBound(index - 1), value);
+        }
+    }
+    EXPECT_EQ(LatencyHistogram::getBucketIndex(LatencyHistogram::MAX_TRACKED_MICROSECONDS + 1), LatencyHistogram::BUCKETS_COUNT - 1);
+}
+
+TEST(LatencyHistogram, ConcurrentRecordsAreCounted) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&histogram, i]() {
+            for (int j = 0; j < 10000; ++j) {
+                histogram.record(i * 100 + 1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(histogram.getCount(), 40000);
+    EXPECT_EQ(histogram.getMax(), 301);
+}
+
+TEST(PipelineMetrics, NodeMetricsAreKeptByName) {
+    PipelineMetrics metrics;
+    auto first = metrics.getNodeMetrics("first");
+    first->recordSince(NodeStage::INFERENCE, std::chrono::steady_clock::now());
+    EXPECT_EQ(metrics.getNodeMetrics("first"), first);
+    metrics.getNodeMetrics("second");
+    auto nodes = metrics.getNodes();
+    ASSERT_EQ(nodes.size(), 2);
+    EXPECT_EQ(nodes[0].first, "first");
+    EXPECT_EQ(nodes[0].second->get(NodeStage::INFERENCE).getCount(), 1);
+    EXPECT_EQ(nodes[0].second->get(NodeStage::STREAM_WAIT).getCount(), 0);
+    EXPECT_EQ(nodes[1].first, "second");
+}
+
+TEST(PipelineMetrics, RemovedNodesAreDropped) {
+    PipelineMetrics metrics;
+    metrics.getNodeMetrics("kept");
+    metrics.getNodeMetrics("removed");
+    metrics.retainNodes({"kept"});
+    auto nodes = metrics.getNodes();
+    ASSERT_EQ(nodes.size(), 1);
+    EXPECT_EQ(nodes[0].first, "kept");
+}
+
+TEST(PipelineMetrics, StageTimerRecordsOnlyMeasuredNodes) {
+    auto nodeMetrics = std::make_shared<ovms::NodeMetrics>();
+    {
+        ovms::StageTimer timer(nodeMetrics, NodeStage::FETCH_RESULTS);
+    }
+    {
+        ovms::StageTimer timer(nullptr, NodeStage::FETCH_RESULTS);
+    }
+    EXPECT_EQ(nodeMetrics->get(NodeStage::FETCH_RESULTS).getCount(), 1);
+}
@@ -0,0 +1,244 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../loadgenerator.hpp"
+#include "../trafficcapture.hpp"
+
+using namespace ovms;
+
+TEST(LoadGenerator, ConstantArrivalsAreEquallySpaced) {
+    const auto start = std::chrono::steady_clock::now();
+    ArrivalSchedule schedule(1000, ArrivalSchedule::Distribution::CONSTANT, start);
+    EXPECT_EQ(schedule.next(), start);
+    for (int i = 1; i <= 10; i++) {
+        auto offset = std::chrono::duration_cast<std::chrono::microseconds>(schedule.next() - start).count();
+        EXPECT_NEAR(offset, i * 1000, 1);
+    }
+}
+
+TEST(LoadGenerator, PoissonArrivalsKeepRate) {
+    const auto start = std::chrono::steady_clock::now();
+    ArrivalSchedule schedule(1000, ArrivalSchedule::Distribution::POISSON, start, 7);
+    std::chrono::steady_clock::time_point last;
+    for (int i = 0; i < 10000; i++) {
+        auto next = schedule.next();
+        EXPECT_GE(next, last);
+        last = next;
+    }
+    // 10000 requests at 1000 per second take about 10 seconds
+    EXPECT_NEAR(std::chrono::duration<double>(last - start).count(), 10.0, 0.5);
+}
+
+TEST(LoadGenerator, StatisticsCountSuccessesAndErrors) {
+    LoadStatistics statistics;
+    statistics.recordSuccess(1000, 800);
+    statistics.recordSuccess(3000, 2000);
+    statistics.recordError("HTTP 503");
+    statistics.recordError("HTTP 503");
+    EXPECT_EQ(statistics.getSucceeded(), 2);
+    EXPECT_EQ(statistics.getFailed(), 2);
+    EXPECT_EQ(statistics.getLatency().getCount(), 2);
+    EXPECT_EQ(statistics.getErrors().at("HTTP 503"), 2);
+    auto report = statistics.report(1.0, 4.0);
+    EXPECT_NE(report.find("error rate: 50.000%"), std::string::npos) << report;
+    EXPECT_NE(report.find("Throughput: 2.00 requests/s offered: 4.00 requests/s"), std::string::npos) << report;
+}
+
+TEST(LoadGenerator, ParsesResponseHead) {
+    HttpConnection::ResponseHead head;
+    ASSERT_TRUE(HttpConnection::parseResponseHead("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 12\r\n", head));
+    EXPECT_EQ(head.status, 200);
+    ASSERT_TRUE(head.contentLength.has_value());
+    EXPECT_EQ(head.contentLength.value(), 12);
+    EXPECT_FALSE(head.chunked);
+    EXPECT_FALSE(head.close);
+
+    HttpConnection::ResponseHead chunked;
+    ASSERT_TRUE(HttpConnection::parseResponseHead("HTTP/1.1 404 Not Found\r\ntransfer-encoding: chunked\r\nConnection: close\r\n", chunked));
+    EXPECT_EQ(chunked.status, 404);
+    EXPECT_FALSE(chunked.contentLength.has_value());
+    EXPECT_TRUE(chunked.chunked);
+    EXPECT_TRUE(chunked.close);
+
+    HttpConnection::ResponseHead invalid;
+    EXPECT_FALSE(HttpConnection::parseResponseHead("garbage\r\n", invalid));
+}
+
+TEST(LoadGenerator, HttpConnectionReadsResponsesOnKeptAliveConnection) {
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(server, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    socklen_t length = sizeof(address);
+    ASSERT_EQ(getsockname(server, reinterpret_cast<sockaddr*>(&address), &length), 0);
+    ASSERT_EQ(listen(server, 1), 0);
+
+    const std::vector<std::string> responses = {
+        "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello",
+        "HTTP/1.1 400 Bad Request\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n",
+    };
+    std::thread serverThread([server, &responses]() {
+        int client = accept(server, nullptr, nullptr);
+        char request[1024];
+        for (const auto& response : responses) {
+            std::string received;
+            while (received.find("\r\n\r\nbody") == std::string::npos) {
+                auto count = recv(client, request, sizeof(request), 0);
+                if (count <= 0) {
+                    break;
+                }
+                received.append(request, count);
+            }
+            send(client, response.data(), response.size(), 0);
+        }
+        close(client);
+    });
+
+    HttpConnection connection("127.0.0.1", ntohs(address.sin_port), std::chrono::seconds(5));
+    const std::string request = "POST /v1/models/dummy:predict HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+    int httpStatus = 0;
+    std::string error;
+    ASSERT_TRUE(connection.send(request, httpStatus, error)) << error;
+    EXPECT_EQ(httpStatus, 200);
+    ASSERT_TRUE(connection.send(request, httpStatus, error)) << error;
+    EXPECT_EQ(httpStatus, 400);
+    serverThread.join();
+    close(server);
+}
+
+namespace {
+void appendLittleEndian(std::string& destination, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        destination.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+ * @brief Writes traffic log in the format of TrafficCapture with given arrivals in microseconds
+ */
+void writeTrafficLog(const std::string& path, const std::vector<uint64_t>& arrivals) {
+    std::string log(TrafficCapture::TRAFFIC_LOG_MAGIC, sizeof(TrafficCapture::TRAFFIC_LOG_MAGIC));
+    appendLittleEndian(log, TrafficCapture::TRAFFIC_LOG_VERSION, sizeof(uint32_t));
+    appendLittleEndian(log, 1'600'000'000'000'000, sizeof(uint64_t));
+    for (size_t i = 0; i < arrivals.size(); i++) {
+        tensorflow::serving::PredictRequest request;
+        request.mutable_model_spec()->set_name("model_" + std::to_string(i));
+        std::string serialized;
+        request.SerializeToString(&serialized);
+        appendLittleEndian(log, arrivals[i], sizeof(uint64_t));
+        appendLittleEndian(log, static_cast<uint8_t>(CapturedTarget::MODEL), sizeof(uint8_t));
+        appendLittleEndian(log, serialized.size(), sizeof(uint32_t));
+        log += serialized;
+    }
+    std::ofstream(path, std::ios::binary) << log;
+}
+
+const char REPLAY_LOG_PATH[] = "/tmp/ovms_test_load_generator_replay.bin";
+}  // namespace
+
+TEST(LoadGenerator, PrepareReplayScalesArrivalsFromTheFirstOne) {
+    writeTrafficLog(REPLAY_LOG_PATH, {5000, 7000, 11000, 10000});
+    LoadGeneratorOptions options;
+    std::vector<tensorflow::serving::PredictRequest> payloads;
+    ASSERT_EQ(prepareReplay(REPLAY_LOG_PATH, 2.0, options, payloads), StatusCode::OK);
+    std::remove(REPLAY_LOG_PATH);
+    ASSERT_EQ(payloads.size(), 4);
+    EXPECT_EQ(payloads[2].model_spec().name(), "model_2");
+    // last record was captured after an earlier arrival, it is not sent before the previous one
+    EXPECT_EQ(options.replayArrivals, (std::vector<std::chrono::microseconds>{
+                                          std::chrono::microseconds(0),
+                                          std::chrono::microseconds(1000),
+                                          std::chrono::microseconds(3000),
+                                          std::chrono::microseconds(3000)}));
+}
+
+TEST(LoadGenerator, PrepareReplayRejectsEmptyAndMissingLogs) {
+    LoadGeneratorOptions options;
+    std::vector<tensorflow::serving::PredictRequest> payloads;
+    EXPECT_EQ(prepareReplay("/tmp/ovms_test_not_existing_replay.bin", 1.0, options, payloads), StatusCode::FILE_INVALID);
+    writeTrafficLog(REPLAY_LOG_PATH, {});
+    EXPECT_EQ(prepareReplay(REPLAY_LOG_PATH, 1.0, options, payloads), StatusCode::FILE_INVALID);
+    std::remove(REPLAY_LOG_PATH);
+    EXPECT_TRUE(options.replayArrivals.empty());
+}
+
+TEST(LoadGenerator, RestLoadSendsReplayedArrivalsWithinDuration) {
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(server, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    socklen_t length = sizeof(address);
+    ASSERT_EQ(getsockname(server, reinterpret_cast<sockaddr*>(&address), &length), 0);
+    ASSERT_EQ(listen(server, 1), 0);
+
+    const std::string request = "POST /v1/models/dummy:predict HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n{}";
+    std::vector<std::chrono::steady_clock::time_point> received;
+    std::thread serverThread([server, &request, &response, &received]() {
+        int client = accept(server, nullptr, nullptr);
+        std::string buffer;
+        char chunk[1024];
+        for (;;) {
+            auto count = recv(client, chunk, sizeof(chunk), 0);
+            if (count <= 0) {
+                break;
+            }
+            buffer.append(chunk, count);
+            for (auto end = buffer.find(request); end != std::string::npos; end = buffer.find(request)) {
+                buffer.erase(0, end + request.size());
+                received.push_back(std::chrono::steady_clock::now());
+                send(client, response.data(), response.size(), 0);
+            }
+        }
+        close(client);
+    });
+
+    LoadGeneratorOptions options;
+    options.address = "127.0.0.1";
+    options.port = ntohs(address.sin_port);
+    options.warmup = std::chrono::milliseconds(0);
+    options.duration = std::chrono::milliseconds(1000);
+    options.reportInterval = std::chrono::milliseconds(0);
+    // the last arrival is after the end of the load and is not sent
+    options.replayArrivals = {std::chrono::microseconds(0), std::chrono::microseconds(100'000), std::chrono::microseconds(200'000), std::chrono::seconds(10)};
+    LoadStatistics statistics;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(runRestLoad(options, {request}, statistics), StatusCode::OK);
+    serverThread.join();
+    close(server);
+    EXPECT_EQ(statistics.getSucceeded(), 3);
+    EXPECT_EQ(statistics.getFailed(), 0);
+    ASSERT_EQ(received.size(), 3);
+    // requests are not sent before their replayed arrivals
+    EXPECT_GE(received[1] - start, std::chrono::milliseconds(100));
+    EXPECT_GE(received[2] - start, std::chrono::milliseconds(200));
+}
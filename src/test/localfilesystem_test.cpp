@@ -17,6 +17,8 @@
 #include <filesystem>
 #include <fstream>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -158,3 +160,25 @@ TEST(FileSystem, CreateTempFolder) {
     EXPECT_TRUE((p & fs::perms::others_read) == fs::perms::none);
     EXPECT_TRUE((p & fs::perms::owner_read) != fs::perms::none);
 }
+
+TEST(FileSystem, ObjectsAreSplitIntoRangesOfPartSize) {
+    const std::vector<uint64_t> sizes{10, 0, 4, 5};
+    const auto parts = ovms::FileSystem::splitIntoParts(sizes, 4);
+    const std::vector<std::pair<size_t, uint64_t>> expected{{0, 0}, {0, 4}, {0, 8}, {2, 0}, {3, 0}, {3, 4}};
+    EXPECT_EQ(parts, expected);
+    EXPECT_TRUE(ovms::FileSystem::splitIntoParts({0, 0}, 16).empty());
+    EXPECT_TRUE(ovms::FileSystem::splitIntoParts({}, 16).empty());
+}
+
+TEST(FileSystem, DownloadSettingFallsBackToDefault) {
+    const char* name = "OVMS_TEST_DOWNLOAD_SETTING";
+    unsetenv(name);
+    EXPECT_EQ(ovms::FileSystem::getDownloadSetting(name, 8), 8);
+    setenv(name, "3", 1);
+    EXPECT_EQ(ovms::FileSystem::getDownloadSetting(name, 8), 3);
+    setenv(name, "0", 1);
+    EXPECT_EQ(ovms::FileSystem::getDownloadSetting(name, 8), 8);
+    setenv(name, "many", 1);
+    EXPECT_EQ(ovms::FileSystem::getDownloadSetting(name, 8), 8);
+    unsetenv(name);
+}
@@ -0,0 +1,98 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../lrucache.hpp"
+
+using ovms::LRUCache;
+
+TEST(LRUCache, FactoryCalledOnlyOnMiss) {
+    LRUCache<std::string, std::shared_ptr<int>> cache(2);
+    int factoryCalls = 0;
+    auto factory = [&factoryCalls]() { return std::make_shared<int>(++factoryCalls); };
+    bool inserted = false;
+    auto first = cache.getOrInsert("a", factory, inserted);
+    EXPECT_TRUE(inserted);
+    auto second = cache.getOrInsert("a", factory, inserted);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(factoryCalls, 1);
+}
+
+TEST(LRUCache, LeastRecentlyUsedIsEvicted) {
+    LRUCache<std::string, std::shared_ptr<int>> cache(2);
+    bool inserted = false;
+    auto a = cache.getOrInsert("a", []() { return std::make_shared<int>(1); }, inserted);
+    auto b = cache.getOrInsert("b", []() { return std::make_shared<int>(2); }, inserted);
+    // touch "a" so "b" becomes the least recently used
+    cache.getOrInsert("a", []() { return std::make_shared<int>(0); }, inserted);
+    EXPECT_FALSE(inserted);
+    cache.getOrInsert("c", []() { return std::make_shared<int>(3); }, inserted);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(cache.size(), 2);
+
+    cache.getOrInsert("a", []() { return std::make_shared<int>(0); }, inserted);
+    EXPECT_FALSE(inserted);
+    auto newB = cache.getOrInsert("b", []() { return std::make_shared<int>(4); }, inserted);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(*newB, 4);
+    // evicted value is still valid for its users
+    EXPECT_EQ(*b, 2);
+}
+
+TEST(LRUCache, RemoveOnlyMatchingValue) {
+    LRUCache<std::string, std::shared_ptr<int>> cache(2);
+    bool inserted = false;
+    auto a = cache.getOrInsert("a", []() { return std::make_shared<int>(1); }, inserted);
+    EXPECT_FALSE(cache.remove("a", std::make_shared<int>(1)));
+    EXPECT_TRUE(cache.remove("a", a));
+    EXPECT_FALSE(cache.remove("a", a));
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(LRUCache, ResetRemovesAllAndChangesCapacity) {
+    LRUCache<std::string, std::shared_ptr<int>> cache(2);
+    bool inserted = false;
+    cache.getOrInsert("a", []() { return std::make_shared<int>(1); }, inserted);
+    cache.getOrInsert("b", []() { return std::make_shared<int>(2); }, inserted);
+    cache.reset(1);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.getCapacity(), 1);
+    cache.getOrInsert("a", []() { return std::make_shared<int>(1); }, inserted);
+    cache.getOrInsert("b", []() { return std::make_shared<int>(2); }, inserted);
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LRUCache, PutReplacesAndGetMarksAsRecentlyUsed) {
+    LRUCache<std::string, std::shared_ptr<int>> cache(2);
+    std::shared_ptr<int> value;
+    EXPECT_FALSE(cache.get("a", value));
+    cache.put("a", std::make_shared<int>(1));
+    cache.put("a", std::make_shared<int>(2));
+    ASSERT_TRUE(cache.get("a", value));
+    EXPECT_EQ(*value, 2);
+    cache.put("b", std::make_shared<int>(3));
+    // "a" is the least recently used until it is read
+    ASSERT_TRUE(cache.get("a", value));
+    cache.put("c", std::make_shared<int>(4));
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_TRUE(cache.get("a", value));
+    EXPECT_FALSE(cache.get("b", value));
+    EXPECT_TRUE(cache.get("c", value));
+}
@@ -0,0 +1,58 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../mappedfile.hpp"
+#include "test_utils.hpp"
+
+using ovms::MappedFile;
+
+class MappedFileTest : public TestWithTempDir {};
+
+TEST_F(MappedFileTest, MappedContentMatchesFile) {
+    const std::string path = directoryPath + "/weights.bin";
+    const std::string content = "model weights content";
+    std::ofstream(path, std::ios::binary) << content;
+    std::shared_ptr<MappedFile> mapped;
+    ASSERT_EQ(MappedFile::map(path, mapped), ovms::StatusCode::OK);
+    ASSERT_NE(mapped, nullptr);
+    ASSERT_EQ(mapped->size(), content.size());
+    EXPECT_EQ(std::memcmp(mapped->data(), content.data(), content.size()), 0);
+}
+
+TEST_F(MappedFileTest, MappingOutlivesRemovedFile) {
+    const std::string path = directoryPath + "/weights.bin";
+    std::ofstream(path, std::ios::binary) << "abc";
+    std::shared_ptr<MappedFile> mapped;
+    ASSERT_EQ(MappedFile::map(path, mapped), ovms::StatusCode::OK);
+    std::filesystem::remove(path);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(mapped->data()), mapped->size()), "abc");
+}
+
+TEST_F(MappedFileTest, MissingOrEmptyFileIsInvalid) {
+    std::shared_ptr<MappedFile> mapped;
+    EXPECT_EQ(MappedFile::map(directoryPath + "/missing.bin", mapped), ovms::StatusCode::FILE_INVALID);
+    const std::string path = directoryPath + "/empty.bin";
+    std::ofstream(path, std::ios::binary).close();
+    EXPECT_EQ(MappedFile::map(path, mapped), ovms::StatusCode::FILE_INVALID);
+    EXPECT_EQ(mapped, nullptr);
+}
@@ -13,19 +13,135 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
+#include <chrono>
 #include <deque>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "../filesystem.hpp"
+#include "../localfilesystem.hpp"
 #include "../model.hpp"
+#include "../modelcache.hpp"
 #include "../modelmanager.hpp"
 #include "mockmodelinstancechangingstates.hpp"
 #include "test_utils.hpp"
 
 class ModelDefaultVersions : public ::testing::Test {};
 
+namespace {
+class MockModelInstanceWaitingForInferencesOnUnload : public MockModelInstanceChangingStates {
+public:
+    using MockModelInstanceChangingStates::MockModelInstanceChangingStates;
+    void unloadModel(bool isPermanent = true) override {
+        ovms::ModelInstance::unloadModel(isPermanent);
+    }
+};
+
+class MockModelWithInstancesWaitingForInferencesOnUnload : public ovms::Model {
+public:
+    MockModelWithInstancesWaitingForInferencesOnUnload() :
+        Model("UNUSED_NAME") {}
+
+protected:
+    std::shared_ptr<ovms::ModelInstance> modelInstanceFactory(const std::string& modelName, const ovms::model_version_t version) override {
+        return std::make_shared<MockModelInstanceWaitingForInferencesOnUnload>(modelName, version);
+    }
+};
+
+class MockCloudFileSystemRecordingDownloads : public ovms::LocalFileSystem {
+public:
+    const char* getBackendName() const override {
+        return "s3";
+    }
+    ovms::StatusCode downloadModelVersions(const std::string& path, std::string* local_path, const std::vector<ovms::model_version_t>& versions) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        downloads.insert(downloads.end(), versions.begin(), versions.end());
+        *local_path = path;
+        return ovms::StatusCode::OK;
+    }
+    std::vector<ovms::model_version_t> getDownloads() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return downloads;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<ovms::model_version_t> downloads;
+};
+
+// copies versions of the dummy model into a new temporary directory on every download
+class MockCloudFileSystemWithFingerprints : public MockCloudFileSystemRecordingDownloads {
+public:
+    ovms::StatusCode downloadModelVersions(const std::string& path, std::string* local_path, const std::vector<ovms::model_version_t>& versions) override {
+        MockCloudFileSystemRecordingDownloads::downloadModelVersions(path, local_path, versions);
+        auto status = createTempPath(local_path);
+        if (status != ovms::StatusCode::OK) {
+            return status;
+        }
+        for (const auto version : versions) {
+            std::filesystem::copy(dummy_model_location + "/1", *local_path + "/" + std::to_string(version), std::filesystem::copy_options::recursive);
+        }
+        return ovms::StatusCode::OK;
+    }
+    ovms::StatusCode getVersionFingerprint(const std::string& path, ovms::model_version_t version, std::string* fingerprint) override {
+        *fingerprint = "unchanged";
+        return ovms::StatusCode::OK;
+    }
+};
+
+class MockModelInstanceKeepingConfig : public MockModelInstanceChangingStates {
+public:
+    using MockModelInstanceChangingStates::MockModelInstanceChangingStates;
+    ovms::Status loadModel(const ovms::ModelConfig& config) override {
+        this->config = config;
+        return MockModelInstanceChangingStates::loadModel(config);
+    }
+    ovms::Status reloadModel(const ovms::ModelConfig& config, const ovms::DynamicModelParameter& parameter = ovms::DynamicModelParameter()) override {
+        this->config = config;
+        return MockModelInstanceChangingStates::reloadModel(config, parameter);
+    }
+};
+
+class MockModelKeepingConfigs : public ovms::Model {
+public:
+    MockModelKeepingConfigs() :
+        Model("UNUSED_NAME") {}
+
+protected:
+    std::shared_ptr<ovms::ModelInstance> modelInstanceFactory(const std::string& modelName, const ovms::model_version_t version) override {
+        return std::make_shared<MockModelInstanceKeepingConfig>(modelName, version);
+    }
+};
+
+class MockModelInstanceThrowingOnLoad : public MockModelInstanceChangingStates {
+public:
+    using MockModelInstanceChangingStates::MockModelInstanceChangingStates;
+    ovms::Status loadModel(const ovms::ModelConfig& config) override {
+        if (config.getVersion() == 2) {
+            throw std::runtime_error("compilation failed");
+        }
+        return MockModelInstanceChangingStates::loadModel(config);
+    }
+};
+
+class MockModelThrowingOnSecondVersion : public ovms::Model {
+public:
+    MockModelThrowingOnSecondVersion() :
+        Model("UNUSED_NAME") {}
+
+protected:
+    std::shared_ptr<ovms::ModelInstance> modelInstanceFactory(const std::string& modelName, const ovms::model_version_t version) override {
+        return std::make_shared<MockModelInstanceThrowingOnLoad>(modelName, version);
+    }
+};
+}  // namespace
+
 TEST_F(ModelDefaultVersions, DefaultVersionNullWhenNoVersionAdded) {
     MockModelWithInstancesJustChangingStates mockModel;
     std::shared_ptr<ovms::ModelInstance> defaultInstance;
@@ -107,6 +223,38 @@ TEST_F(ModelDefaultVersions, DefaultVersionShouldReturnHighestNonRetired) {
     EXPECT_EQ(1, defaultInstance->getVersion());
 }
 
+TEST_F(ModelDefaultVersions, DefaultVersionSwitchedBeforePreviousOneIsUnloaded) {
+    MockModelWithInstancesWaitingForInferencesOnUnload mockModel;
+    std::shared_ptr<ovms::model_versions_t> versionsToChange = std::make_shared<ovms::model_versions_t>();
+    std::shared_ptr<ovms::model_versions_t> versionsFailed = std::make_shared<ovms::model_versions_t>();
+    versionsToChange->push_back(1);
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+    auto fs = ovms::ModelManager::getFilesystem(config.getBasePath());
+    ASSERT_EQ(mockModel.addVersions(versionsToChange, config, fs, versionsFailed), ovms::StatusCode::OK);
+    auto previousInstance = mockModel.getDefaultModelInstance();
+    ASSERT_NE(nullptr, previousInstance);
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> inferenceInProgress;
+    ASSERT_EQ(previousInstance->waitForLoaded(0, inferenceInProgress), ovms::StatusCode::OK);
+
+    versionsToChange->clear();
+    versionsToChange->push_back(2);
+    config.setVersion(2);
+    ASSERT_EQ(mockModel.addVersions(versionsToChange, config, fs, versionsFailed), ovms::StatusCode::OK);
+    EXPECT_EQ(2, mockModel.getDefaultModelInstance()->getVersion());
+
+    auto versionsToRetire = std::make_shared<ovms::model_versions_t>(ovms::model_versions_t{1});
+    std::thread retire([&mockModel, versionsToRetire]() { mockModel.retireVersions(versionsToRetire); });
+    while (previousInstance->getStatus().getState() != ovms::ModelVersionState::UNLOADING) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(ovms::ModelVersionState::UNLOADING, previousInstance->getStatus().getState()) << "unload has to wait for inference in progress";
+    EXPECT_EQ(2, mockModel.getDefaultModelInstance()->getVersion());
+    inferenceInProgress.reset();
+    retire.join();
+    EXPECT_EQ(ovms::ModelVersionState::END, previousInstance->getStatus().getState());
+}
+
 TEST_F(ModelDefaultVersions, DefaultVersionShouldReturnHighestWhenVersionReloaded) {
     MockModelWithInstancesJustChangingStates mockModel;
     std::shared_ptr<ovms::model_versions_t> versionsToChange = std::make_shared<ovms::model_versions_t>();
@@ -136,3 +284,96 @@ TEST_F(ModelDefaultVersions, DefaultVersionShouldReturnHighestWhenVersionReloade
     EXPECT_TRUE(nullptr != defaultInstance);
     EXPECT_EQ(2, defaultInstance->getVersion());
 }
+
+TEST_F(ModelDefaultVersions, VersionLookupsUsePublishedSnapshot) {
+    MockModelWithInstancesJustChangingStates mockModel;
+    std::shared_ptr<ovms::model_versions_t> versionsToChange = std::make_shared<ovms::model_versions_t>();
+    std::shared_ptr<ovms::model_versions_t> versionsFailed = std::make_shared<ovms::model_versions_t>();
+    versionsToChange->push_back(1);
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+    auto fs = ovms::ModelManager::getFilesystem(config.getBasePath());
+    ASSERT_EQ(mockModel.addVersions(versionsToChange, config, fs, versionsFailed), ovms::StatusCode::OK);
+    auto previousSnapshot = mockModel.getModelVersionsSnapshot();
+    EXPECT_EQ(nullptr, mockModel.getModelInstanceByVersion(2));
+
+    versionsToChange->clear();
+    versionsToChange->push_back(2);
+    config.setVersion(2);
+    ASSERT_EQ(mockModel.addVersions(versionsToChange, config, fs, versionsFailed), ovms::StatusCode::OK);
+
+    EXPECT_EQ(1, previousSnapshot->size()) << "published snapshot has to stay immutable";
+    EXPECT_EQ(2, mockModel.getModelVersionsSnapshot()->size());
+    ASSERT_NE(nullptr, mockModel.getModelInstanceByVersion(2));
+    EXPECT_EQ(2, mockModel.getModelInstanceByVersion(2)->getVersion());
+    EXPECT_EQ(2, mockModel.getDefaultModelInstance()->getVersion());
+}
+
+TEST(ModelPipelinedDownload, VersionsFromCloudAreDownloadedOneByOneAndAdded) {
+    MockModelWithInstancesJustChangingStates mockModel;
+    auto versionsToChange = std::make_shared<ovms::model_versions_t>(ovms::model_versions_t{1, 2, 3});
+    auto versionsFailed = std::make_shared<ovms::model_versions_t>();
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+    auto cloudFs = std::make_shared<MockCloudFileSystemRecordingDownloads>();
+    std::shared_ptr<ovms::FileSystem> fs = cloudFs;
+
+    ASSERT_EQ(mockModel.addVersions(versionsToChange, config, fs, versionsFailed), ovms::StatusCode::OK);
+
+    EXPECT_EQ(cloudFs->getDownloads(), (std::vector<ovms::model_version_t>{1, 2, 3}));
+    EXPECT_TRUE(versionsFailed->empty());
+    EXPECT_EQ(3, mockModel.getModelVersionsSnapshot()->size());
+    ASSERT_NE(nullptr, mockModel.getDefaultModelInstance());
+    EXPECT_EQ(3, mockModel.getDefaultModelInstance()->getVersion());
+}
+
+TEST(ModelPipelinedDownload, DownloaderIsStoppedAndJoinedWhenCompilationThrows) {
+    MockModelThrowingOnSecondVersion mockModel;
+    auto versionsToChange = std::make_shared<ovms::model_versions_t>(ovms::model_versions_t{1, 2, 3, 4});
+    auto versionsFailed = std::make_shared<ovms::model_versions_t>();
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+    auto cloudFs = std::make_shared<MockCloudFileSystemRecordingDownloads>();
+    std::shared_ptr<ovms::FileSystem> fs = cloudFs;
+
+    EXPECT_THROW(mockModel.addVersions(versionsToChange, config, fs, versionsFailed), std::runtime_error);
+
+    // downloader runs at most one version ahead of the compilation and does not continue after it threw
+    auto downloads = cloudFs->getDownloads();
+    EXPECT_LE(downloads.size(), 3);
+    EXPECT_EQ(1, mockModel.getModelVersionsSnapshot()->size());
+    EXPECT_NE(nullptr, mockModel.getModelInstanceByVersion(1));
+}
+
+class ModelCloudCacheTest : public TestWithTempDir {
+protected:
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        // every entry is above the quota, so it is evicted as soon as it is not pinned
+        ovms::ModelCache::instance().configure(directoryPath + "/cache", 1);
+    }
+
+    void TearDown() override {
+        ovms::ModelCache::instance().configure("", 0);
+        TestWithTempDir::TearDown();
+    }
+};
+
+TEST_F(ModelCloudCacheTest, ReloadFromNewBasePathReleasesPreviousEntry) {
+    MockModelKeepingConfigs model;
+    auto versions = std::make_shared<ovms::model_versions_t>(ovms::model_versions_t{1});
+    auto versionsFailed = std::make_shared<ovms::model_versions_t>();
+    std::shared_ptr<ovms::FileSystem> fs = std::make_shared<MockCloudFileSystemWithFingerprints>();
+    auto& cache = ovms::ModelCache::instance();
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+    config.setBasePath("s3://bucket/first");
+    ASSERT_EQ(model.addVersions(versions, config, fs, versionsFailed), ovms::StatusCode::OK);
+    const auto firstEntry = cache.getEntryPath(ovms::ModelCache::computeKey("s3://bucket/first", 1, "unchanged"));
+    ASSERT_TRUE(std::filesystem::exists(firstEntry));
+
+    config.setBasePath("s3://bucket/second");
+    ASSERT_EQ(model.reloadVersions(versions, config, fs, versionsFailed), ovms::StatusCode::OK);
+    const auto secondEntry = cache.getEntryPath(ovms::ModelCache::computeKey("s3://bucket/second", 1, "unchanged"));
+    EXPECT_TRUE(std::filesystem::exists(secondEntry));
+    EXPECT_FALSE(std::filesystem::exists(firstEntry)) << "entry of the replaced copy has to be unpinned";
+
+    model.retireVersions(versions);
+    EXPECT_FALSE(std::filesystem::exists(secondEntry));
+}
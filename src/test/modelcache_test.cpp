@@ -0,0 +1,120 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../modelcache.hpp"
+#include "test_utils.hpp"
+
+using ovms::ModelCache;
+
+class ModelCacheTest : public TestWithTempDir {
+protected:
+    void SetUp() override {
+        TestWithTempDir::SetUp();
+        cacheDirectory = directoryPath + "/cache";
+        ModelCache::instance().configure(cacheDirectory, 0);
+    }
+
+    void TearDown() override {
+        ModelCache::instance().configure("", 0);
+        TestWithTempDir::TearDown();
+    }
+
+    std::string createVersion(const std::string& name, size_t bytes) {
+        const std::string path = directoryPath + "/" + name;
+        std::filesystem::create_directories(path);
+        std::ofstream(path + "/model.bin", std::ios::binary) << std::string(bytes, 'x');
+        return path;
+    }
+
+    std::string cacheDirectory;
+};
+
+TEST_F(ModelCacheTest, KeyChangesWithFingerprint) {
+    const auto key = ModelCache::computeKey("s3://bucket/model", 1, "1/model.bin:etag1:100");
+    EXPECT_EQ(key.size(), 64);
+    EXPECT_EQ(key, ModelCache::computeKey("s3://bucket/model", 1, "1/model.bin:etag1:100"));
+    EXPECT_NE(key, ModelCache::computeKey("s3://bucket/model", 1, "1/model.bin:etag2:100"));
+    EXPECT_NE(key, ModelCache::computeKey("s3://bucket/model", 2, "1/model.bin:etag1:100"));
+    EXPECT_NE(key, ModelCache::computeKey("s3://bucket/other", 1, "1/model.bin:etag1:100"));
+}
+
+TEST_F(ModelCacheTest, InsertedVersionIsReusedAfterRestart) {
+    auto& cache = ModelCache::instance();
+    const auto key = ModelCache::computeKey("gs://bucket/model", 1, "fingerprint");
+    EXPECT_FALSE(cache.acquire(key));
+    const auto versionPath = createVersion("download/1", 100);
+    ASSERT_TRUE(cache.insert(key, versionPath));
+    EXPECT_FALSE(std::filesystem::exists(versionPath));
+    EXPECT_TRUE(std::filesystem::exists(cache.getEntryPath(key) + "/model.bin"));
+    EXPECT_EQ(cache.getUsed(), 100);
+
+    cache.configure(cacheDirectory, 0);
+    EXPECT_EQ(cache.getUsed(), 100);
+    EXPECT_TRUE(cache.acquire(key));
+}
+
+TEST_F(ModelCacheTest, UnfinishedEntriesAreRemovedOnStart) {
+    const std::string partialPath = cacheDirectory + "/" + ModelCache::computeKey("s3://bucket/model", 1, "") + ".partial.1.2";
+    std::filesystem::create_directories(partialPath);
+    ModelCache::instance().configure(cacheDirectory, 0);
+    EXPECT_FALSE(std::filesystem::exists(partialPath));
+    EXPECT_EQ(ModelCache::instance().getUsed(), 0);
+}
+
+TEST_F(ModelCacheTest, LeastRecentlyUsedUnpinnedEntriesAreEvictedAboveQuota) {
+    auto& cache = ModelCache::instance();
+    cache.configure(cacheDirectory, 250);
+    const auto first = ModelCache::computeKey("s3://bucket/model", 1, "");
+    const auto second = ModelCache::computeKey("s3://bucket/model", 2, "");
+    const auto third = ModelCache::computeKey("s3://bucket/model", 3, "");
+    ASSERT_TRUE(cache.insert(first, createVersion("download/1", 100)));
+    ASSERT_TRUE(cache.insert(second, createVersion("download/2", 100)));
+    cache.release(cache.getEntryPath(first));
+    cache.release(cache.getEntryPath(second));
+    ASSERT_TRUE(cache.acquire(first));
+    cache.release(cache.getEntryPath(first));
+
+    ASSERT_TRUE(cache.insert(third, createVersion("download/3", 100)));
+    EXPECT_EQ(cache.getUsed(), 200);
+    EXPECT_TRUE(std::filesystem::exists(cache.getEntryPath(first)));
+    EXPECT_FALSE(std::filesystem::exists(cache.getEntryPath(second)));
+    EXPECT_FALSE(cache.acquire(second));
+}
+
+TEST_F(ModelCacheTest, PinnedEntriesAreNotEvicted) {
+    auto& cache = ModelCache::instance();
+    cache.configure(cacheDirectory, 50);
+    const auto key = ModelCache::computeKey("s3://bucket/model", 1, "");
+    ASSERT_TRUE(cache.insert(key, createVersion("download/1", 100)));
+    EXPECT_TRUE(std::filesystem::exists(cache.getEntryPath(key)));
+    cache.release(cache.getEntryPath(key));
+    EXPECT_FALSE(std::filesystem::exists(cache.getEntryPath(key)));
+    EXPECT_EQ(cache.getUsed(), 0);
+}
+
+TEST_F(ModelCacheTest, ReleaseIgnoresPathsOutsideOfCache) {
+    auto& cache = ModelCache::instance();
+    cache.configure(cacheDirectory, 50);
+    const auto key = ModelCache::computeKey("s3://bucket/model", 1, "");
+    ASSERT_TRUE(cache.insert(key, createVersion("download/1", 100)));
+    cache.release(directoryPath + "/" + key);
+    EXPECT_TRUE(std::filesystem::exists(cache.getEntryPath(key)));
+}
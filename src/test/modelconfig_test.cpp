@@ -16,6 +16,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -475,3 +478,749 @@ TEST(ModelConfig, ConfigParseNodeWithForbiddenShapeName) {
     ASSERT_EQ(status, ovms::StatusCode::OK);
     EXPECT_EQ(modelConfig.getShapes().size(), 0);
 }
+
+TEST(ModelConfig, ConfigParseNodeWithDynamicBatching) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "dynamic_batching": {"max_batch_size": 8, "max_queue_delay_microseconds": 500}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_TRUE(modelConfig.isDynamicBatchingEnabled());
+    EXPECT_EQ(modelConfig.getDynamicBatchingMaxBatchSize(), 8);
+    EXPECT_EQ(modelConfig.getDynamicBatchingMaxQueueDelayMicroseconds(), 500);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setDynamicBatchingMaxQueueDelayMicroseconds(1000);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithDynamicBatchingLatencySlo) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "dynamic_batching": {"max_batch_size": 8, "max_queue_delay_microseconds": 500, "latency_slo_microseconds": 20000}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_TRUE(modelConfig.isDynamicBatchingEnabled());
+    EXPECT_EQ(modelConfig.getDynamicBatchingLatencySloMicroseconds(), 20000);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setDynamicBatchingLatencySloMicroseconds(10'000);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithGrpcCompressionThreshold) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "grpc_compression_threshold": 65536
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getGrpcCompressionThreshold(), 65536);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setGrpcCompressionThreshold(0);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithResponseCacheSize) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "response_cache_size_mb": 64
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getResponseCacheSizeMb(), 64);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setResponseCacheSizeMb(0);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithSingleFlight) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "single_flight": true
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_TRUE(modelConfig.isSingleFlightEnabled());
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setSingleFlight(false);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithImageInputs) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "image_inputs": {"data": "BGR"}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    ASSERT_EQ(modelConfig.getImageInputs().size(), 1);
+    EXPECT_EQ(modelConfig.getImageInputs().at("data"), "BGR");
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setImageInputs({{"data", "RGB"}});
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithPreprocessing) {
+    rapidjson::Document configJson;
+    const std::string config = R"({"name": "alpha", "base_path": "/tmp/models/dummy1",
+        "dynamic_batching": {"max_batch_size": 8},
+        "preprocessing": {"data": {"resize": "AREA", "mean": [123.7, 116.3, 103.5], "scale": [58.4, 57.1, 57.4], "color_format": "RGB", "u8_input": true}}})";
+    ASSERT_FALSE(configJson.Parse(config.c_str()).HasParseError());
+    ovms::ModelConfig modelConfig;
+    ASSERT_EQ(modelConfig.parseNode(configJson), ovms::StatusCode::OK);
+    ASSERT_EQ(modelConfig.getPreprocessing().count("data"), 1);
+    const auto& preprocessing = modelConfig.getPreprocessing().at("data");
+    EXPECT_EQ(preprocessing.resizeAlgorithm, "AREA");
+    EXPECT_EQ(preprocessing.mean, std::vector<float>({123.7f, 116.3f, 103.5f}));
+    EXPECT_EQ(preprocessing.scale, std::vector<float>({58.4f, 57.1f, 57.4f}));
+    EXPECT_EQ(preprocessing.colorFormat, "RGB");
+    EXPECT_TRUE(preprocessing.u8Input);
+    EXPECT_TRUE(modelConfig.anyInputResized());
+    // requests of resized inputs have different shapes and are not batched together
+    EXPECT_FALSE(modelConfig.isDynamicBatchingEnabled());
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    auto changed = modelConfig.getPreprocessing();
+    changed["data"].resizeAlgorithm = "";
+    otherConfig.setPreprocessing(changed);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+    EXPECT_FALSE(otherConfig.anyInputResized());
+}
+
+TEST(ModelConfig, ConfigParseNodeWithCpus) {
+    const ovms::cpu_list_t allowedCpus = ovms::getAllowedCpus();
+    ASSERT_FALSE(allowedCpus.empty());
+    const int first = allowedCpus.front();
+    const int last = allowedCpus.back();
+    for (const auto& [cpus, expectedStatus, expectedCpus] : std::vector<std::tuple<std::string, ovms::StatusCode, ovms::cpu_list_t>>{
+             {std::to_string(last) + "," + std::to_string(first) + "," + std::to_string(last), ovms::StatusCode::OK,
+                 first == last ? ovms::cpu_list_t{first} : ovms::cpu_list_t{first, last}},
+             {"3-1", ovms::StatusCode::CPU_LIST_WRONG_FORMAT, {}},
+             {"-1", ovms::StatusCode::CPU_LIST_WRONG_FORMAT, {}},
+             {"0,x", ovms::StatusCode::CPU_LIST_WRONG_FORMAT, {}},
+             // cpu the process cannot run on
+             {std::to_string(last + 1), ovms::StatusCode::CPU_LIST_WRONG_FORMAT, {}}}) {
+        rapidjson::Document configJson;
+        const std::string config = R"({"name": "alpha", "base_path": "/tmp/models/dummy1", "cpus": ")" + cpus + R"("})";
+        ASSERT_FALSE(configJson.Parse(config.c_str()).HasParseError());
+        ovms::ModelConfig modelConfig;
+        ASSERT_EQ(modelConfig.parseNode(configJson), expectedStatus) << cpus;
+        EXPECT_EQ(modelConfig.getCpus(), expectedCpus) << cpus;
+    }
+    ovms::ModelConfig modelConfig;
+    ovms::ModelConfig otherConfig = modelConfig;
+    otherConfig.setCpus({0, 1});
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithDynamicBatchingAndAutoBatchSize) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "batch_size": "auto",
+                    "dynamic_batching": {"max_batch_size": 8}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_FALSE(modelConfig.isDynamicBatchingEnabled());
+}
+
+TEST(ModelConfig, ConfigParseNodeWithShapeCacheSize) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "batch_size": "auto",
+                    "shape_cache_size": 4
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getShapeCacheSize(), 4);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setShapeCacheSize(2);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithNumaReplicas) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "numa_replicas": true
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_TRUE(modelConfig.isNumaReplicasEnabled());
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setNumaReplicas(false);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithReplicaDevices) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "target_device": "CPU",
+                    "replica_devices": ["GPU"],
+                    "replica_routing": "latency_weighted"
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getReplicaDevices(), std::vector<std::string>{"GPU"});
+    EXPECT_EQ(modelConfig.getReplicaRouting(), ovms::ReplicaRouting::LATENCY_WEIGHTED);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setReplicaRouting(ovms::ReplicaRouting::LEAST_QUEUED);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig = modelConfig;
+    otherConfig.setReplicaDevices({});
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithAutoTuning) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "auto_tune": {"latency_target_ms": 20}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_TRUE(modelConfig.isAutoTuningEnabled());
+    EXPECT_EQ(modelConfig.getAutoTuningLatencyTargetMs(), 20);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setAutoTuningLatencyTargetMs(0);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig = modelConfig;
+    otherConfig.setAutoTuning(false);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithInferRequestPools) {
+    std::string config = R"#(
+    {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "nireq": 8,
+                    "infer_request_pools": {"direct": {"nireq": 2}, "ocr_pipeline": {"share": 0.25}}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    const auto& pools = modelConfig.getInferRequestsPools();
+    ASSERT_EQ(pools.size(), 2);
+    EXPECT_EQ(pools.at(ovms::DIRECT_INFER_REQUESTS_POOL).nireq, 2);
+    EXPECT_DOUBLE_EQ(pools.at("ocr_pipeline").share, 0.25);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setInferRequestsPools({});
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, InferRequestPoolsAreDisabledForStatefulAndDynamicBatchingModels) {
+    for (const std::string option : {R"("stateful": true)", R"("dynamic_batching": {"max_batch_size": 4, "max_queue_delay_microseconds": 100})"}) {
+        std::string config = R"({
+            "name": "alpha",
+            "base_path": "/tmp/models/dummy1",
+            "nireq": 8,
+            "infer_request_pools": {"direct": {"nireq": 2}},
+            )" + option + "}";
+        rapidjson::Document configJson;
+        ASSERT_FALSE(configJson.Parse(config.c_str()).HasParseError()) << config;
+        ovms::ModelConfig modelConfig;
+        ASSERT_EQ(modelConfig.parseNode(configJson), ovms::StatusCode::OK) << option;
+        EXPECT_TRUE(modelConfig.getInferRequestsPools().empty()) << option;
+    }
+}
+
+TEST(ModelConfig, InferRequestPoolsAreCarvedOutOfNireq) {
+    std::map<std::string, uint32_t> sizes;
+    ASSERT_TRUE(ovms::computeInferRequestsPoolSizes({{"direct", {2, 0}}, {"ocr_pipeline", {0, 0.25}}}, 8, sizes));
+    EXPECT_EQ(sizes.at("direct"), 2);
+    EXPECT_EQ(sizes.at("ocr_pipeline"), 2);
+    // every pool gets at least one infer request
+    ASSERT_TRUE(ovms::computeInferRequestsPoolSizes({{"ocr_pipeline", {0, 0.01}}}, 4, sizes));
+    EXPECT_EQ(sizes.at("ocr_pipeline"), 1);
+    // shared queue needs at least one infer request
+    EXPECT_FALSE(ovms::computeInferRequestsPoolSizes({{"direct", {2, 0}}, {"ocr_pipeline", {0, 0.5}}}, 4, sizes));
+    EXPECT_TRUE(sizes.empty());
+}
+
+TEST(ModelConfig, ConfigParseNodeWithReplicasCount) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "replicas": 3
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getReplicasCount(), 3);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setReplicasCount(1);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithLoadPriority) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "load_priority": 10
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getLoadPriority(), 10);
+    EXPECT_TRUE(modelConfig.isCoreModel());
+
+    // priority does not change loaded network
+    ovms::ModelConfig otherConfig = modelConfig;
+    otherConfig.setLoadPriority(0);
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    EXPECT_FALSE(otherConfig.isCoreModel());
+}
+
+TEST(ModelConfig, ConfigParseNodeWithInputConversion) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "input_conversion": {"data": "FP32"}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_TRUE(modelConfig.isInputConversionEnabled("data", "FP32"));
+    EXPECT_FALSE(modelConfig.isInputConversionEnabled("other", "FP32"));
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setInputConversions({});
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithOutputPrecision) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "output_precision": {"prob": "FP16", "other": "FP32"}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_TRUE(modelConfig.isHalfPrecisionOutput("prob"));
+    EXPECT_FALSE(modelConfig.isHalfPrecisionOutput("other"));
+    EXPECT_FALSE(modelConfig.isHalfPrecisionOutput("missing"));
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setOutputPrecisions({});
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithMaxPendingRequests) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "max_pending_requests": 16
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 1);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getMaxPendingRequests(), 16);
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setMaxPendingRequests(0);
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
+
+TEST(ModelConfig, ConfigParseNodeWithWarmup) {
+    std::string config = R"#(
+        {
+        "model_config_list": [
+            {
+                "config": {
+                    "name": "alpha",
+                    "base_path": "/tmp/models/dummy1",
+                    "warmup": {"iterations": 3, "data_path": "/tmp/warmup"}
+                }
+            },
+            {
+                "config": {
+                    "name": "beta",
+                    "base_path": "/tmp/models/dummy2",
+                    "warmup": {}
+                }
+            }
+        ]
+    }
+    )#";
+
+    rapidjson::Document configJson;
+    rapidjson::ParseResult parsingSucceeded = configJson.Parse(config.c_str());
+    ASSERT_EQ(parsingSucceeded, true);
+
+    const auto modelConfigList = configJson.FindMember("model_config_list");
+    ASSERT_NE(modelConfigList, configJson.MemberEnd());
+    const auto& configs = modelConfigList->value.GetArray();
+    ASSERT_EQ(configs.Size(), 2);
+    ovms::ModelConfig modelConfig;
+    auto status = modelConfig.parseNode(configs[0]["config"]);
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(modelConfig.getWarmupIterations(), 3);
+    EXPECT_EQ(modelConfig.getWarmupDataPath(), "/tmp/warmup");
+
+    ovms::ModelConfig defaultIterationsConfig;
+    status = defaultIterationsConfig.parseNode(configs[1]["config"]);
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_EQ(defaultIterationsConfig.getWarmupIterations(), 1);
+    EXPECT_EQ(defaultIterationsConfig.getWarmupDataPath(), "");
+
+    ovms::ModelConfig otherConfig = modelConfig;
+    EXPECT_FALSE(modelConfig.isReloadRequired(otherConfig));
+    otherConfig.setWarmupDataPath("");
+    EXPECT_TRUE(modelConfig.isReloadRequired(otherConfig));
+}
@@ -13,16 +13,31 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <stdlib.h>
 
+#include "../executinstreamidguard.hpp"
 #include "../get_model_metadata_impl.hpp"
+#include "../inferencescheduler.hpp"
+#include "../lazymodelsbudget.hpp"
+#include "../localfilesystem.hpp"
+#include "../modelsmemorybudget.hpp"
 #include "../modelinstance.hpp"
+#include "../numa.hpp"
+#include "../prediction_service_utils.hpp"
+#include "../streamsbudget.hpp"
+#include "../stringutils.hpp"
+#include "../weightsregistry.hpp"
 #include "test_utils.hpp"
 
 using testing::Return;
@@ -46,6 +61,51 @@ public:
     }
 };
 
+class ModelInstanceExposingEngine : public ovms::ModelInstance {
+public:
+    ModelInstanceExposingEngine() :
+        ModelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION) {}
+    const InferenceEngine::Core* getEngine() const {
+        return engine.get();
+    }
+};
+
+class ModelInstanceReadingSharedWeights : public ovms::ModelInstance {
+public:
+    ModelInstanceReadingSharedWeights() :
+        ModelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION) {}
+    ovms::Status readNetwork(const std::string& directory) {
+        loadOVEngine();
+        return loadOVCNNNetworkWithSharedWeights(directory + "/dummy.xml", directory + "/dummy.bin");
+    }
+    const void* getWeights() const {
+        return mappedWeights.get();
+    }
+    const InferenceEngine::CNNNetwork* getNetwork() const {
+        return network.get();
+    }
+};
+
+class ModelInstancePrecompilingShapes : public ovms::ModelInstance {
+public:
+    ModelInstancePrecompilingShapes() :
+        ModelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION) {}
+    uint64_t getPrecompilationGeneration() {
+        std::lock_guard<std::mutex> lock(precompilationMutex);
+        return precompilationGeneration;
+    }
+    bool isPrecompilationRunning() {
+        std::lock_guard<std::mutex> lock(precompilationMutex);
+        return precompilationRunning;
+    }
+    void precompile(const std::vector<std::string>& keys, uint64_t generation) {
+        precompileShapeVariants(keys, generation);
+    }
+    size_t getShapeVariantsCount() const {
+        return shapeVariants.size();
+    }
+};
+
 class MockModelInstance : public ovms::ModelInstance {
 public:
     MockModelInstance() :
@@ -79,8 +139,7 @@ TEST_F(TestUnloadModel, CanUnloadModelNotHoldingModelInstanceAtPredictPath) {
     ovms::Status status = modelInstance.loadModel(DUMMY_MODEL_CONFIG);
     ASSERT_EQ(status, ovms::StatusCode::OK);
     ASSERT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
-    modelInstance.increasePredictRequestsHandlesCount();
-    modelInstance.decreasePredictRequestsHandlesCount();
+    modelInstance.decreasePredictRequestsHandlesCount(modelInstance.increasePredictRequestsHandlesCount());
     EXPECT_TRUE(modelInstance.canUnloadInstance());
 }
 
@@ -259,6 +318,84 @@ TEST_F(TestLoadModel, SuccessfulLoad) {
     EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
 }
 
+TEST_F(TestLoadModel, LoadPhasesAreProfiled) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    EXPECT_EQ(modelInstance.getLoadProfile().totalMicroseconds, 0);
+    auto config = DUMMY_MODEL_CONFIG;
+    config.setDownloadMicroseconds(1000);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    const auto profile = modelInstance.getLoadProfile();
+    EXPECT_EQ(profile.get(ovms::LoadPhase::DOWNLOAD), 1000);
+    EXPECT_EQ(profile.get(ovms::LoadPhase::CUSTOM_LOADER), 0);
+    EXPECT_EQ(profile.get(ovms::LoadPhase::AUTOTUNE), 0);
+    EXPECT_GT(profile.get(ovms::LoadPhase::READ_NETWORK), 0);
+    EXPECT_GT(profile.get(ovms::LoadPhase::LOAD_NETWORK), 0);
+    uint64_t phasesSum = 0;
+    for (size_t phase = 0; phase < ovms::LOAD_PHASES_COUNT; ++phase) {
+        phasesSum += profile.get(static_cast<ovms::LoadPhase>(phase));
+    }
+    EXPECT_GE(profile.totalMicroseconds, phasesSum);
+    // kept config does not report the download again
+    EXPECT_EQ(modelInstance.getModelConfig().getDownloadMicroseconds(), 0);
+}
+
+TEST_F(TestLoadModel, ReplicasOnTargetDeviceAreLoadBalanced) {
+    if (ovms::getAllowedCpus().size() < 2) {
+        GTEST_SKIP() << "Replicas on CPU require at least 2 cpus";
+    }
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    auto config = DUMMY_MODEL_CONFIG;
+    config.setNireq(2);
+    config.setReplicasCount(2);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    ovms::ModelSaturation saturation;
+    ASSERT_TRUE(modelInstance.getSaturation(saturation));
+    EXPECT_EQ(saturation.streams, 4);
+
+    auto& firstQueue = modelInstance.getInferRequestsQueue();
+    ovms::ExecutingStreamIdGuard busyStream(firstQueue);
+    EXPECT_NE(&modelInstance.getInferRequestsQueue(), &firstQueue);
+}
+
+TEST_F(TestLoadModel, EngineSharedByModelInstances) {
+    ModelInstanceExposingEngine first;
+    ModelInstanceExposingEngine second;
+    ASSERT_EQ(first.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+    ASSERT_EQ(second.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+    ASSERT_NE(first.getEngine(), nullptr);
+    EXPECT_EQ(first.getEngine(), second.getEngine());
+    first.unloadModel();
+    EXPECT_EQ(first.getEngine(), nullptr);
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    EXPECT_EQ(second.waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    unloadGuard.reset();
+    ASSERT_EQ(first.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+    EXPECT_EQ(first.getEngine(), second.getEngine());
+}
+
+TEST_F(TestLoadModel, LoadedModelValidatesRequests) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+    auto request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, DUMMY_MODEL_INPUT_SIZE}, tensorflow::DataType::DT_FLOAT}}});
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::OK);
+
+    auto& input = (*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME];
+    input.mutable_tensor_shape()->mutable_dim(1)->set_size(DUMMY_MODEL_INPUT_SIZE + 1);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_SHAPE);
+    input.mutable_tensor_shape()->mutable_dim(1)->set_size(DUMMY_MODEL_INPUT_SIZE);
+
+    input.mutable_tensor_content()->append("1");
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_CONTENT_SIZE);
+
+    input.set_dtype(tensorflow::DataType::DT_UINT8);
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_PRECISION);
+
+    (*request.mutable_inputs())["unknown"] = input;
+    EXPECT_EQ(modelInstance.validate(&request), ovms::StatusCode::INVALID_NO_OF_INPUTS);
+}
+
 TEST_F(TestLoadModel, UnSuccessfulLoadWhenNireqTooHigh) {
     ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
     auto config = DUMMY_MODEL_CONFIG;
@@ -267,6 +404,90 @@ TEST_F(TestLoadModel, UnSuccessfulLoadWhenNireqTooHigh) {
     EXPECT_EQ(ovms::ModelVersionState::LOADING, modelInstance.getStatus().getState()) << modelInstance.getStatus().getStateString();
 }
 
+TEST_F(TestLoadModel, SuccessfulLoadWithWarmup) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    auto config = DUMMY_MODEL_CONFIG;
+    config.setNireq(2);
+    config.setWarmupIterations(2);
+    EXPECT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
+}
+
+TEST_F(TestLoadModel, SuccessfulLoadWithAutoTuning) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    auto config = DUMMY_MODEL_CONFIG;
+    config.setAutoTuning(true);
+    config.setAutoTuningLatencyTargetMs(1000);
+    EXPECT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
+    ovms::ModelSaturation saturation;
+    ASSERT_TRUE(modelInstance.getSaturation(saturation));
+    EXPECT_GE(saturation.streams, 1);
+}
+
+TEST_F(TestLoadModel, AutoTuningOfModelPinnedToSingleCpuChoosesSingleStream) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    auto config = DUMMY_MODEL_CONFIG;
+    config.setAutoTuning(true);
+    config.setAutoTuningLatencyTargetMs(1000);
+    config.setCpus({ovms::getAllowedCpus().front()});
+    EXPECT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    ovms::ModelSaturation saturation;
+    ASSERT_TRUE(modelInstance.getSaturation(saturation));
+    EXPECT_EQ(saturation.streams, 1);
+}
+
+TEST_F(TestLoadModel, WarmupWithSampleData) {
+    const std::string warmupDataPath = "/tmp/test_warmup_data";
+    std::filesystem::create_directories(warmupDataPath);
+    auto config = DUMMY_MODEL_CONFIG;
+    config.setWarmupIterations(1);
+    config.setWarmupDataPath(warmupDataPath);
+    {
+        std::vector<float> data(DUMMY_MODEL_INPUT_SIZE, 1.0);
+        std::ofstream file(warmupDataPath + "/" + DUMMY_MODEL_INPUT_NAME + ".bin", std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    }
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    EXPECT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
+    modelInstance.unloadModel();
+
+    {
+        std::ofstream file(warmupDataPath + "/" + DUMMY_MODEL_INPUT_NAME + ".bin", std::ios::binary | std::ios::trunc);
+        file.write("123", 3);
+    }
+    ovms::ModelInstance invalidDataModelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    EXPECT_EQ(invalidDataModelInstance.loadModel(config), ovms::StatusCode::INVALID_CONTENT_SIZE);
+    EXPECT_EQ(ovms::ModelVersionState::LOADING, invalidDataModelInstance.getStatus().getState());
+    std::filesystem::remove_all(warmupDataPath);
+}
+
+class TestLoadModelWithSharedWeights : public TestWithTempDir {};
+
+TEST_F(TestLoadModelWithSharedWeights, NetworksReadFromIdenticalFilesShareWeightsBuffer) {
+    const std::string dummyDirectory = dummy_model_location + "/1";
+    std::filesystem::copy_file(dummyDirectory + "/dummy.xml", directoryPath + "/dummy.xml");
+    std::filesystem::copy_file(dummyDirectory + "/dummy.bin", directoryPath + "/dummy.bin");
+    auto& registry = ovms::WeightsRegistry::instance();
+    const size_t reusedBefore = registry.getReusedCount();
+
+    ModelInstanceReadingSharedWeights first;
+    ModelInstanceReadingSharedWeights second;
+    ASSERT_EQ(first.readNetwork(dummyDirectory), ovms::StatusCode::OK);
+    ASSERT_EQ(second.readNetwork(directoryPath), ovms::StatusCode::OK);
+    ASSERT_NE(first.getNetwork(), nullptr);
+    ASSERT_NE(second.getNetwork(), nullptr);
+    EXPECT_EQ(second.getNetwork()->getOutputsInfo().count(DUMMY_MODEL_OUTPUT_NAME), 1);
+    ASSERT_NE(first.getWeights(), nullptr);
+    EXPECT_EQ(first.getWeights(), second.getWeights()) << "copy of weights file has to be read into the same buffer";
+    EXPECT_EQ(registry.getReusedCount(), reusedBefore + 1);
+
+    std::shared_ptr<const ovms::WeightsBuffer> registered;
+    ASSERT_EQ(registry.acquire(directoryPath + "/dummy.bin", false, registered), ovms::StatusCode::OK);
+    EXPECT_EQ(static_cast<const void*>(registered.get()), first.getWeights());
+}
+
 class TestReloadModel : public ::testing::Test {};
 
 TEST_F(TestReloadModel, SuccessfulReloadFromAlreadyLoaded) {
@@ -321,6 +542,23 @@ TEST_F(TestReloadModel, SuccessfulReloadFromAlreadyLoadedWithNewBatchSize) {
     EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
 }
 
+class TestReloadModelFromTempDir : public TestWithTempDir {};
+
+TEST_F(TestReloadModelFromTempDir, NewBatchSizeDoesNotReadModelFilesAgain) {
+    std::filesystem::copy(dummy_model_location, directoryPath, std::filesystem::copy_options::recursive);
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+    config.setBasePath(directoryPath);
+    config.setLocalPath(directoryPath);
+    config.setBatchSize(1);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    std::filesystem::remove_all(config.getPath());
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    EXPECT_EQ(modelInstance.reloadModel(2, {}, unloadGuard), ovms::StatusCode::OK);
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
+    EXPECT_EQ(modelInstance.getBatchSize(), 2);
+}
+
 TEST_F(TestReloadModel, SuccessfulReloadFromAlreadyLoadedWithNewShape) {
     ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
     ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
@@ -390,3 +628,391 @@ TEST(CpuThroughputStreamsNotSpecified, NotSetForNonCpuDevices) {
     pluginConfig = ovms::ModelInstance::prepareDefaultPluginConfig(config);
     EXPECT_EQ(pluginConfig.count("CPU_THROUGHPUT_STREAMS"), 0);
 }
+
+class TestLazyLoadModel : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config = DUMMY_MODEL_CONFIG;
+        config.setLazyLoading(true);
+    }
+    void TearDown() override {
+        ovms::LazyModelsBudget::instance().setLimit(0);
+    }
+    ovms::ModelConfig config;
+};
+
+TEST_F(TestLazyLoadModel, RegisteredWithoutCompilingNetwork) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
+    EXPECT_FALSE(modelInstance.isActivated());
+    EXPECT_EQ(modelInstance.getInputsInfo().size(), 0);
+}
+
+TEST_F(TestLazyLoadModel, ActivatedOnFirstUse) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    ASSERT_EQ(modelInstance.waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    EXPECT_NE(unloadGuard, nullptr);
+    EXPECT_TRUE(modelInstance.isActivated());
+    EXPECT_EQ(modelInstance.getInputsInfo().size(), 1);
+}
+
+TEST_F(TestLazyLoadModel, DeactivatedWhenIdleAndActivatedAgain) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    ASSERT_EQ(modelInstance.waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    EXPECT_FALSE(modelInstance.deactivateIfIdle(std::chrono::steady_clock::now())) << "in use by request";
+    unloadGuard.reset();
+    EXPECT_FALSE(modelInstance.deactivateIfIdle(modelInstance.getLastUsed())) << "used after idle timeout";
+    ASSERT_TRUE(modelInstance.deactivateIfIdle(std::chrono::steady_clock::now()));
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
+    EXPECT_FALSE(modelInstance.isActivated());
+    ASSERT_EQ(modelInstance.waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    EXPECT_TRUE(modelInstance.isActivated());
+}
+
+TEST_F(TestLazyLoadModel, HibernatedWhenIdleAndActivatedWithoutModelFiles) {
+    const std::string localPath = "/tmp/HibernatedWhenIdleAndActivatedWithoutModelFiles";
+    std::filesystem::remove_all(localPath);
+    std::filesystem::copy(dummy_model_location, localPath, std::filesystem::copy_options::recursive);
+    config.setLocalPath(localPath);
+    config.setIdleHibernation(true);
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    ASSERT_EQ(modelInstance.waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    unloadGuard.reset();
+    ASSERT_TRUE(modelInstance.deactivateIfIdle(std::chrono::steady_clock::now()));
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, modelInstance.getStatus().getState());
+    EXPECT_FALSE(modelInstance.isActivated());
+    EXPECT_TRUE(modelInstance.isHibernated());
+
+    // activation only compiles the network kept in memory
+    std::filesystem::remove_all(localPath);
+    ASSERT_EQ(modelInstance.waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    EXPECT_TRUE(modelInstance.isActivated());
+    EXPECT_FALSE(modelInstance.isHibernated());
+    EXPECT_EQ(modelInstance.getInputsInfo().size(), 1);
+}
+
+TEST_F(TestLazyLoadModel, NotDeactivatedWithoutLazyLoading) {
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+    EXPECT_TRUE(modelInstance.isActivated());
+    EXPECT_FALSE(modelInstance.deactivateIfIdle(std::chrono::steady_clock::now()));
+}
+
+TEST_F(TestLazyLoadModel, LeastRecentlyUsedDeactivatedToFitMemoryBudget) {
+    auto& budget = ovms::LazyModelsBudget::instance();
+    auto first = std::make_shared<ovms::ModelInstance>("first", UNUSED_MODEL_VERSION);
+    auto second = std::make_shared<ovms::ModelInstance>("second", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(first->loadModel(config), ovms::StatusCode::OK);
+    ASSERT_EQ(second->loadModel(config), ovms::StatusCode::OK);
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    ASSERT_EQ(first->waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    unloadGuard.reset();
+    const size_t firstUsage = budget.getUsed();
+    ASSERT_GT(firstUsage, 0);
+    // fits only one of the models
+    budget.setLimit(firstUsage + firstUsage / 2);
+    ASSERT_EQ(second->waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    unloadGuard.reset();
+    EXPECT_FALSE(first->isActivated());
+    EXPECT_TRUE(second->isActivated());
+    EXPECT_EQ(budget.getUsed(), firstUsage);
+    second->unloadModel();
+    EXPECT_EQ(budget.getUsed(), 0);
+}
+
+class TestModelMemoryUsage : public ::testing::Test {
+protected:
+    void TearDown() override {
+        ovms::ModelsMemoryBudget::instance().setLimit(0);
+    }
+};
+
+TEST_F(TestModelMemoryUsage, MeasuredOnLoadAndReleasedOnUnload) {
+    auto& budget = ovms::ModelsMemoryBudget::instance();
+    const size_t usedBefore = budget.getUsed();
+    ovms::ModelInstance modelInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(modelInstance.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+    const auto usage = modelInstance.getMemoryUsage();
+    EXPECT_GT(usage.network, 0);
+    // dummy model has one input and one output of 10 floats in each infer request
+    EXPECT_GT(usage.inferRequests, 0);
+    EXPECT_EQ(usage.inferRequests % (2 * 10 * sizeof(float)), 0);
+    EXPECT_EQ(usage.responseCache, 0);
+    EXPECT_EQ(budget.getUsed() - usedBefore, usage.total());
+    modelInstance.unloadModel();
+    EXPECT_EQ(modelInstance.getMemoryUsage().total(), 0);
+    EXPECT_EQ(budget.getUsed(), usedBefore);
+}
+
+TEST_F(TestModelMemoryUsage, LoadRefusedWhenBudgetExceeded) {
+    auto& budget = ovms::ModelsMemoryBudget::instance();
+    ovms::ModelInstance servingInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    ASSERT_EQ(servingInstance.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+    budget.setLimit(budget.getUsed() + 1);
+    ovms::ModelInstance refusedInstance("UNUSED_NAME", UNUSED_MODEL_VERSION);
+    EXPECT_EQ(refusedInstance.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::MODELS_MEMORY_BUDGET_EXCEEDED);
+    EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, servingInstance.getStatus().getState());
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    EXPECT_EQ(servingInstance.waitForLoaded(0, unloadGuard), ovms::StatusCode::OK);
+    unloadGuard.reset();
+    servingInstance.unloadModel();
+    EXPECT_EQ(refusedInstance.loadModel(DUMMY_MODEL_CONFIG), ovms::StatusCode::OK);
+}
+
+class TestShapePrecompilation : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config = DUMMY_MODEL_CONFIG;
+        config.parseShapeParameter("auto");
+        config.setShapeCacheSize(SHAPES_COUNT);
+        for (size_t i = 0; i < SHAPES_COUNT; ++i) {
+            keys.push_back("b:(1," + std::to_string(11 + i) + ");");
+        }
+    }
+
+    static const size_t SHAPES_COUNT = 8;
+    ovms::ModelConfig config;
+    std::vector<std::string> keys;
+};
+
+TEST_F(TestShapePrecompilation, ShapesFromHistoryAreCompiledIntoShapeVariants) {
+    ModelInstancePrecompilingShapes modelInstance;
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    modelInstance.precompile({keys[0], keys[1], "c:(1,10);"}, modelInstance.getPrecompilationGeneration());
+    // signature of unknown input is skipped
+    EXPECT_EQ(modelInstance.getShapeVariantsCount(), 2);
+    EXPECT_FALSE(modelInstance.isPrecompilationRunning());
+}
+
+TEST_F(TestShapePrecompilation, TaskScheduledBeforeReloadIsDropped) {
+    ModelInstancePrecompilingShapes modelInstance;
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    const auto generation = modelInstance.getPrecompilationGeneration();
+    ASSERT_EQ(modelInstance.reloadModel(config), ovms::StatusCode::OK);
+    EXPECT_GT(modelInstance.getPrecompilationGeneration(), generation);
+    modelInstance.precompile(keys, generation);
+    EXPECT_EQ(modelInstance.getShapeVariantsCount(), 0);
+}
+
+TEST_F(TestShapePrecompilation, ReloadWaitsForRunningPrecompilation) {
+    ModelInstancePrecompilingShapes modelInstance;
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    std::thread task([&modelInstance, generation = modelInstance.getPrecompilationGeneration(), this]() {
+        modelInstance.precompile(keys, generation);
+    });
+    while (!modelInstance.isPrecompilationRunning() && modelInstance.getShapeVariantsCount() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto status = modelInstance.reloadModel(config);
+    // reload replaces config and shape variants only after the task stopped
+    const bool runningAfterReload = modelInstance.isPrecompilationRunning();
+    const size_t variantsAfterReload = modelInstance.getShapeVariantsCount();
+    task.join();
+    EXPECT_EQ(status, ovms::StatusCode::OK);
+    EXPECT_FALSE(runningAfterReload);
+    EXPECT_EQ(variantsAfterReload, 0);
+    EXPECT_EQ(modelInstance.getShapeVariantsCount(), 0);
+    EXPECT_EQ(modelInstance.getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+}
+
+TEST_F(TestShapePrecompilation, UnloadStopsPrecompilation) {
+    ModelInstancePrecompilingShapes modelInstance;
+    ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+    const auto generation = modelInstance.getPrecompilationGeneration();
+    modelInstance.unloadModel();
+    modelInstance.precompile(keys, generation);
+    EXPECT_EQ(modelInstance.getShapeVariantsCount(), 0);
+    EXPECT_FALSE(modelInstance.isPrecompilationRunning());
+}
+
+TEST(ModelInstanceSchedulerClient, ReloadKeepsVersionRegisteredOnce) {
+    ovms::InferenceScheduler::instance().configure(2);
+    auto countClients = []() {
+        auto statistics = ovms::InferenceScheduler::instance().getStatistics();
+        return std::count_if(statistics.begin(), statistics.end(), [](const auto& client) { return client.name == "dummy:1"; });
+    };
+    {
+        ovms::ModelInstance modelInstance("dummy", 1);
+        ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+        ASSERT_EQ(modelInstance.loadModel(config), ovms::StatusCode::OK);
+        EXPECT_EQ(countClients(), 1);
+        config.setNireq(2);
+        ASSERT_EQ(modelInstance.reloadModel(config), ovms::StatusCode::OK);
+        EXPECT_EQ(countClients(), 1);
+        // client is registered again only when its weight or priority changes
+        config.setSchedulingWeight(3);
+        ASSERT_EQ(modelInstance.reloadModel(config), ovms::StatusCode::OK);
+        auto statistics = ovms::InferenceScheduler::instance().getStatistics();
+        auto client = std::find_if(statistics.begin(), statistics.end(), [](const auto& client) { return client.name == "dummy:1"; });
+        ASSERT_NE(client, statistics.end());
+        EXPECT_EQ(client->weight, 3);
+        EXPECT_EQ(countClients(), 1);
+    }
+    EXPECT_EQ(countClients(), 0);
+    ovms::InferenceScheduler::instance().configure(0);
+}
+
+class TestStreamsRebalancing : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ovms::StreamsBudget::instance().configure(4);
+        // streams are rebalanced only for models which do not fix nireq
+        config.setNireq(0);
+    }
+    void TearDown() override {
+        ovms::StreamsBudget::instance().configure(0);
+    }
+    std::string getCompiledStreams(ovms::ModelInstance& modelInstance) {
+        return modelInstance.getExecutableNetwork()->GetConfig("CPU_THROUGHPUT_STREAMS").as<std::string>();
+    }
+
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+};
+
+TEST_F(TestStreamsRebalancing, NetworkCompiledWithAssignedStreamsIsTakenOverByReload) {
+    auto modelInstance = std::make_shared<ovms::ModelInstance>("dummy", 1);
+    ASSERT_EQ(modelInstance->loadModel(config), ovms::StatusCode::OK);
+    ovms::ModelStreamsLoad load;
+    ASSERT_TRUE(modelInstance->getStreamsLoad(load));
+    EXPECT_EQ(load.streams, 1);
+    EXPECT_EQ(getCompiledStreams(*modelInstance), "1");
+
+    ASSERT_EQ(modelInstance->rebalanceStreams(2), ovms::StatusCode::OK);
+    EXPECT_EQ(modelInstance->getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+    ASSERT_TRUE(modelInstance->getStreamsLoad(load));
+    EXPECT_EQ(load.streams, 2);
+    EXPECT_EQ(getCompiledStreams(*modelInstance), "2");
+    EXPECT_EQ(modelInstance->getInferRequestsQueue().getInferRequestsCount(), 2);
+
+    auto request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+    tensorflow::serving::PredictResponse response;
+    auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(*modelInstance);
+    EXPECT_EQ(ovms::inference(*modelInstance, &request, &response, unloadGuard), ovms::StatusCode::OK);
+}
+
+TEST_F(TestStreamsRebalancing, ReloadAfterRebalanceCompilesItsOwnNetwork) {
+    auto modelInstance = std::make_shared<ovms::ModelInstance>("dummy", 1);
+    ASSERT_EQ(modelInstance->loadModel(config), ovms::StatusCode::OK);
+    ASSERT_EQ(modelInstance->rebalanceStreams(2), ovms::StatusCode::OK);
+    auto rebalancedNetwork = modelInstance->getExecutableNetwork();
+
+    // config fixing nireq takes the version out of the budget, staged network must not be reused
+    ovms::ModelConfig fixedConfig = config;
+    fixedConfig.setNireq(3);
+    ASSERT_EQ(modelInstance->reloadModel(fixedConfig), ovms::StatusCode::OK);
+    EXPECT_NE(modelInstance->getExecutableNetwork(), rebalancedNetwork);
+    ovms::ModelStreamsLoad load;
+    EXPECT_FALSE(modelInstance->getStreamsLoad(load));
+    EXPECT_EQ(modelInstance->getInferRequestsQueue().getInferRequestsCount(), 3);
+}
+
+TEST_F(TestStreamsRebalancing, BackgroundReshapeKeepsRebalancedStreams) {
+    config.setBatchingParams("auto");
+    auto modelInstance = std::make_shared<ovms::ModelInstance>("dummy", 1);
+    ASSERT_EQ(modelInstance->loadModel(config), ovms::StatusCode::OK);
+    ASSERT_EQ(modelInstance->rebalanceStreams(2), ovms::StatusCode::OK);
+    auto rebalancedNetwork = modelInstance->getExecutableNetwork();
+
+    auto request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{3, 10}, tensorflow::DataType::DT_FLOAT}}});
+    auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(*modelInstance);
+    ASSERT_EQ(modelInstance->reloadModelInBackground(&request, ovms::StatusCode::BATCHSIZE_CHANGE_REQUIRED, ovms::DynamicModelParameter(3),
+                  WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, unloadGuard),
+        ovms::StatusCode::OK);
+    unloadGuard.reset();
+    EXPECT_EQ(modelInstance->getBatchSize(), 3);
+    // network staged for the new shape is taken over, it is compiled with the assigned streams
+    EXPECT_NE(modelInstance->getExecutableNetwork(), rebalancedNetwork);
+    EXPECT_EQ(getCompiledStreams(*modelInstance), "2");
+    ovms::ModelStreamsLoad load;
+    ASSERT_TRUE(modelInstance->getStreamsLoad(load));
+    EXPECT_EQ(load.streams, 2);
+}
+
+namespace {
+const std::string STREAMED_DUMMY_LOCATION = "s3://bucket/dummy";
+
+class LocalFileSystemStreamingTestModels : public ovms::LocalFileSystem {
+public:
+    std::vector<std::string> readFiles;
+    std::string failingFile;
+
+    ovms::StatusCode getDirectoryFiles(const std::string& path, ovms::files_list_t* files) override {
+        return LocalFileSystem::getDirectoryFiles(toLocalPath(path), files);
+    }
+
+    ovms::StatusCode readFileToMemory(const std::string& path, std::string* contents) override {
+        readFiles.push_back(path);
+        if (!failingFile.empty() && ovms::endsWith(path, failingFile)) {
+            return ovms::StatusCode::S3_FAILED_GET_OBJECT;
+        }
+        return LocalFileSystem::readFileToMemory(toLocalPath(path), contents);
+    }
+
+    const char* getBackendName() const override {
+        return "s3";
+    }
+
+private:
+    static std::string toLocalPath(const std::string& path) {
+        return dummy_model_location + path.substr(STREAMED_DUMMY_LOCATION.size());
+    }
+};
+
+class ModelInstanceStreamedFromCloud : public ovms::ModelInstance {
+public:
+    ModelInstanceStreamedFromCloud() :
+        ModelInstance("dummy", 1) {}
+    std::shared_ptr<LocalFileSystemStreamingTestModels> fs = std::make_shared<LocalFileSystemStreamingTestModels>();
+
+protected:
+    std::shared_ptr<ovms::FileSystem> createModelFilesystem() const override {
+        return fs;
+    }
+};
+}  // namespace
+
+class TestModelStreamedFromCloud : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config.setLocalPath(STREAMED_DUMMY_LOCATION);
+        ASSERT_TRUE(config.isStreamedFromCloud());
+    }
+
+    ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+};
+
+TEST_F(TestModelStreamedFromCloud, ModelFilesAreReadIntoMemory) {
+    auto modelInstance = std::make_shared<ModelInstanceStreamedFromCloud>();
+    ASSERT_EQ(modelInstance->loadModel(config), ovms::StatusCode::OK);
+    EXPECT_EQ(modelInstance->getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+    EXPECT_THAT(modelInstance->fs->readFiles, ::testing::UnorderedElementsAre(
+                                                  STREAMED_DUMMY_LOCATION + "/1/dummy.xml",
+                                                  STREAMED_DUMMY_LOCATION + "/1/dummy.bin"));
+    EXPECT_EQ(modelInstance->getModelFilesSize(),
+        std::filesystem::file_size(dummy_model_location + "/1/dummy.xml") + std::filesystem::file_size(dummy_model_location + "/1/dummy.bin"));
+
+    auto request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+    tensorflow::serving::PredictResponse response;
+    auto unloadGuard = std::make_unique<ovms::ModelInstanceUnloadGuard>(*modelInstance);
+    EXPECT_EQ(ovms::inference(*modelInstance, &request, &response, unloadGuard), ovms::StatusCode::OK);
+}
+
+TEST_F(TestModelStreamedFromCloud, FailedReadOfModelFileFailsLoading) {
+    auto modelInstance = std::make_shared<ModelInstanceStreamedFromCloud>();
+    modelInstance->fs->failingFile = "dummy.bin";
+    EXPECT_EQ(modelInstance->loadModel(config), ovms::StatusCode::S3_FAILED_GET_OBJECT);
+    EXPECT_NE(modelInstance->getStatus().getState(), ovms::ModelVersionState::AVAILABLE);
+}
@@ -0,0 +1,97 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../modelloadingpool.hpp"
+
+using ovms::ModelLoadingPool;
+using ovms::Status;
+using ovms::StatusCode;
+
+TEST(ModelLoadingPool, ModelsAreLoadedConcurrentlyUpToParallelism) {
+    ModelLoadingPool pool(2);
+    std::atomic<int> loading{0};
+    std::atomic<int> maxLoading{0};
+    auto load = [&loading, &maxLoading]() -> Status {
+        int current = ++loading;
+        int expected = maxLoading.load();
+        while (current > expected && !maxLoading.compare_exchange_weak(expected, current)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --loading;
+        return StatusCode::OK;
+    };
+    for (int i = 0; i < 6; ++i) {
+        pool.submit("model_" + std::to_string(i), load);
+    }
+    pool.waitAll();
+    EXPECT_EQ(maxLoading.load(), 2);
+    EXPECT_EQ(pool.getFinishedCount(), 6);
+    EXPECT_EQ(pool.getSubmittedCount(), 6);
+}
+
+TEST(ModelLoadingPool, WaitReturnsOnceAwaitedModelIsLoaded) {
+    ModelLoadingPool pool(2);
+    std::promise<void> releaseSlow;
+    auto slowReleased = releaseSlow.get_future().share();
+    pool.submit("slow", [slowReleased]() -> Status {
+        slowReleased.wait();
+        return StatusCode::OK;
+    });
+    pool.submit("fast", []() -> Status { return StatusCode::MODEL_MISSING; });
+    EXPECT_EQ(pool.wait("fast"), StatusCode::MODEL_MISSING);
+    EXPECT_EQ(pool.getFinishedCount(), 1);
+    releaseSlow.set_value();
+    EXPECT_EQ(pool.wait("slow"), StatusCode::OK);
+}
+
+TEST(ModelLoadingPool, WaitForNotSubmittedModelReturnsRightAway) {
+    ModelLoadingPool pool(1);
+    EXPECT_EQ(pool.wait("unknown"), StatusCode::OK);
+}
+
+TEST(ModelLoadingPool, LoadsOfTheSameModelAreSerialized) {
+    ModelLoadingPool pool(4);
+    std::atomic<int> loading{0};
+    std::atomic<bool> overlapped{false};
+    auto load = [&loading, &overlapped]() -> Status {
+        if (++loading > 1) {
+            overlapped = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        --loading;
+        return StatusCode::OK;
+    };
+    for (int i = 0; i < 4; ++i) {
+        pool.submit("model", load);
+    }
+    EXPECT_EQ(pool.wait("model"), StatusCode::OK);
+    EXPECT_EQ(pool.getFinishedCount(), 4);
+    EXPECT_FALSE(overlapped.load());
+}
+
+TEST(ModelLoadingPool, ExceptionThrownByLoadIsReported) {
+    ModelLoadingPool pool(1);
+    pool.submit("model", []() -> Status { throw std::runtime_error("load failed"); });
+    EXPECT_EQ(pool.wait("model"), StatusCode::UNKNOWN_ERROR);
+}
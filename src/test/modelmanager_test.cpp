@@ -15,6 +15,9 @@
 //*****************************************************************************
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -526,6 +529,174 @@ TEST(ModelManager, ConfigReloadingShouldRetireModelInstancesOfModelRemovedFromJs
     manager.join();
 }
 
+class MockModelManagerCountingModelReloads : public MockModelManagerWithModelInstancesJustChangingStates {
+public:
+    ovms::Status readAvailableVersions(
+        std::shared_ptr<ovms::FileSystem>& fs,
+        const std::string& base,
+        ovms::model_versions_t& versions) override {
+        reloadsCount[base]++;
+        return MockModelManagerWithModelInstancesJustChangingStates::readAvailableVersions(fs, base, versions);
+    }
+    ovms::Status loadConfig(const std::string& jsonFilename) {
+        return ModelManager::loadConfig(jsonFilename);
+    }
+    std::map<std::string, size_t> reloadsCount;
+};
+
+const char* config_2_models_alpha_changed = R"({
+   "model_config_list": [
+    {
+      "config": {
+        "name": "resnet",
+        "base_path": "/tmp/models/dummy1",
+        "target_device": "CPU",
+        "model_version_policy": {"all": {}}
+      }
+    },
+    {
+      "config": {
+        "name": "alpha",
+        "base_path": "/tmp/models/dummy2",
+        "target_device": "CPU",
+        "nireq": 2,
+        "model_version_policy": {"all": {}}
+      }
+    }]
+})";
+
+const char* config_2_models_alpha_invalid = R"({
+   "model_config_list": [
+    {
+      "config": {
+        "name": "resnet",
+        "base_path": "/tmp/models/dummy1",
+        "target_device": "CPU",
+        "nireq": 2,
+        "model_version_policy": {"all": {}}
+      }
+    },
+    {
+      "config": {
+        "name": "alpha",
+        "base_path": "/tmp/models/dummy2",
+        "target_device": "CPU",
+        "cpus": "not_a_cpu_list",
+        "model_version_policy": {"all": {}}
+      }
+    }]
+})";
+
+TEST(ModelManager, ConfigReloadingAppliesOnlyChangedModels) {
+    std::string fileToReload = "/tmp/ovms_config_file2.json";
+    createConfigFileWithContent(config_2_models, fileToReload);
+    MockModelManagerCountingModelReloads manager;
+    manager.registerVersionToLoad(1);
+    ASSERT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::OK);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy1"], 1);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy2"], 1);
+
+    createConfigFileWithContent(config_2_models_alpha_changed, fileToReload);
+    ASSERT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::OK);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy1"], 1);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy2"], 2);
+
+    ASSERT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::OK);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy1"], 1);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy2"], 2);
+}
+
+TEST(ModelManager, ConfigReloadingWithInvalidModelIsNotAppliedAtAll) {
+    std::string fileToReload = "/tmp/ovms_config_file2.json";
+    createConfigFileWithContent(config_2_models, fileToReload);
+    MockModelManagerCountingModelReloads manager;
+    manager.registerVersionToLoad(1);
+    ASSERT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::OK);
+
+    // valid change of resnet is not applied either, since alpha entry is invalid
+    createConfigFileWithContent(config_2_models_alpha_invalid, fileToReload);
+    EXPECT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::CPU_LIST_WRONG_FORMAT);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy1"], 1);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy2"], 1);
+    for (auto& nameModel : manager.getModels()) {
+        for (auto& versionModelInstance : nameModel.second->getModelVersions()) {
+            EXPECT_EQ(ovms::ModelVersionState::AVAILABLE, versionModelInstance.second->getStatus().getState());
+        }
+    }
+}
+
+static std::string createManyModelsConfig(size_t modelsCount, size_t invalidModelIndex = std::numeric_limits<size_t>::max()) {
+    std::stringstream config;
+    config << R"({"model_config_list": [)";
+    for (size_t i = 0; i < modelsCount; ++i) {
+        config << (i ? "," : "") << R"({"config": {"name": "model)" << i << R"(", "base_path": "/tmp/models/dummy)" << i << R"(")"
+               << (i == invalidModelIndex ? R"(, "cpus": "not_a_cpu_list")" : "") << "}}";
+    }
+    config << "]}";
+    return config.str();
+}
+
+TEST(ModelManager, ConfigReloadingOfManyModelsAppliesOnlyChangesAndRejectsInvalidEntry) {
+    const size_t modelsCount = 200;
+    std::string fileToReload = "/tmp/ovms_config_file_many_models.json";
+    createConfigFileWithContent(createManyModelsConfig(modelsCount), fileToReload);
+    MockModelManagerCountingModelReloads manager;
+    manager.registerVersionToLoad(1);
+    ASSERT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::OK);
+    ASSERT_EQ(manager.getModels().size(), modelsCount);
+
+    createConfigFileWithContent(createManyModelsConfig(modelsCount, 150), fileToReload);
+    EXPECT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::CPU_LIST_WRONG_FORMAT);
+
+    createConfigFileWithContent(createManyModelsConfig(modelsCount / 2), fileToReload);
+    ASSERT_EQ(manager.loadConfig(fileToReload), ovms::StatusCode::OK);
+    for (size_t i = 0; i < modelsCount; ++i) {
+        EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy" + std::to_string(i)], 1) << "unchanged and removed models are not reloaded";
+        auto instance = manager.findModelInstance("model" + std::to_string(i), 1);
+        ASSERT_NE(nullptr, instance);
+        EXPECT_EQ(i < modelsCount / 2 ? ovms::ModelVersionState::AVAILABLE : ovms::ModelVersionState::END, instance->getStatus().getState());
+    }
+}
+
+TEST(ModelManager, StartupLoadsCoreModelsAndLeavesTheRestToWatcher) {
+    const char* configWithCoreModel = R"({
+   "model_config_list": [
+    {
+      "config": {
+        "name": "alpha",
+        "base_path": "/tmp/models/dummy2",
+        "target_device": "CPU"
+      }
+    },
+    {
+      "config": {
+        "name": "resnet",
+        "base_path": "/tmp/models/dummy1",
+        "target_device": "CPU",
+        "load_priority": 1
+      }
+    }]
+})";
+    std::string fileToReload = "/tmp/ovms_config_file2.json";
+    createConfigFileWithContent(configWithCoreModel, fileToReload);
+    MockModelManagerCountingModelReloads manager;
+    manager.registerVersionToLoad(1);
+    ASSERT_EQ(manager.startFromFile(fileToReload), ovms::StatusCode::OK);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy1"], 1);
+    EXPECT_EQ(manager.reloadsCount["/tmp/models/dummy2"], 0);
+    auto readiness = manager.getModelsReadiness();
+    EXPECT_TRUE(readiness.coreModelsReady);
+    EXPECT_THAT(readiness.notReadyModels, ContainerEq(std::vector<std::string>{SECOND_MODEL_NAME}));
+
+    manager.startWatcher();
+    waitForOVMSConfigReload(manager);
+    manager.join();
+    EXPECT_GE(manager.reloadsCount["/tmp/models/dummy2"], 1);
+    readiness = manager.getModelsReadiness();
+    EXPECT_TRUE(readiness.coreModelsReady);
+    EXPECT_TRUE(readiness.notReadyModels.empty());
+}
+
 class MockModelInstanceInStateWithConfig : public ovms::ModelInstance {
     static const ovms::model_version_t UNUSED_VERSION = 987789;
 
@@ -0,0 +1,110 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../modelmetrics.hpp"
+
+using ovms::ModelMetrics;
+using ovms::ModelStage;
+using ovms::RateMeter;
+using ovms::ShardedCounter;
+
+TEST(ShardedCounter, SumsIncrementsFromManyThreads) {
+    ShardedCounter counter;
+    const size_t threadsCount = 8;
+    const size_t incrementsCount = 10000;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadsCount; ++i) {
+        threads.emplace_back([&counter]() {
+            for (size_t j = 0; j < incrementsCount; ++j) {
+                counter.increment();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.get(), threadsCount * incrementsCount);
+}
+
+TEST(RateMeter, AveragesCompletedSecondsOfWindow) {
+    RateMeter meter;
+    const int64_t start = 1000;
+    for (int64_t second = start; second < start + RateMeter::WINDOW_SECONDS; ++second) {
+        for (int i = 0; i < 5; ++i) {
+            meter.record(second);
+        }
+    }
+    // current second is not complete yet and is not counted
+    meter.record(start + RateMeter::WINDOW_SECONDS);
+    EXPECT_DOUBLE_EQ(meter.getRate(start + RateMeter::WINDOW_SECONDS), 5.0);
+    // seconds older than window are dropped
+    EXPECT_DOUBLE_EQ(meter.getRate(start + 2 * RateMeter::WINDOW_SECONDS), 0.1);
+    EXPECT_DOUBLE_EQ(meter.getRate(start + 3 * RateMeter::WINDOW_SECONDS), 0.0);
+}
+
+TEST(RateMeter, ReusedBucketStartsFromZero) {
+    RateMeter meter;
+    meter.record(5);
+    meter.record(5);
+    meter.record(5 + RateMeter::WINDOW_SECONDS + 1);
+    EXPECT_DOUBLE_EQ(meter.getRate(5 + RateMeter::WINDOW_SECONDS + 2), 0.1);
+    // late event of the old second does not go into the reused bucket
+    meter.record(5);
+    EXPECT_DOUBLE_EQ(meter.getRate(5 + RateMeter::WINDOW_SECONDS + 2), 0.1);
+}
+
+TEST(ModelMetrics, CountsRequestsAndErrors) {
+    ModelMetrics metrics;
+    metrics.recordRequest(true);
+    metrics.recordRequest(false);
+    metrics.recordRequest(true);
+    EXPECT_EQ(metrics.getRequests(), 3);
+    EXPECT_EQ(metrics.getErrors(), 1);
+}
+
+TEST(ModelMetrics, RecordsStagesSeparately) {
+    ModelMetrics metrics;
+    metrics.recordStage(ModelStage::INFERENCE, 100);
+    metrics.recordStage(ModelStage::INFERENCE, 300);
+    metrics.recordStage(ModelStage::SERIALIZATION, 7);
+    EXPECT_EQ(metrics.get(ModelStage::INFERENCE).getCount(), 2);
+    EXPECT_EQ(metrics.get(ModelStage::INFERENCE).getMax(), 300);
+    EXPECT_EQ(metrics.get(ModelStage::SERIALIZATION).getCount(), 1);
+    EXPECT_EQ(metrics.get(ModelStage::STREAM_WAIT).getCount(), 0);
+    EXPECT_EQ(metrics.get(ModelStage::DESERIALIZATION).getCount(), 0);
+}
+
+TEST(ModelMetrics, BatchSizesGoToPowerOfTwoBuckets) {
+    EXPECT_EQ(ModelMetrics::getBatchSizeBucketIndex(0), 0);
+    EXPECT_EQ(ModelMetrics::getBatchSizeBucketIndex(1), 0);
+    EXPECT_EQ(ModelMetrics::getBatchSizeBucketIndex(2), 1);
+    EXPECT_EQ(ModelMetrics::getBatchSizeBucketIndex(3), 2);
+    EXPECT_EQ(ModelMetrics::getBatchSizeBucketIndex(4), 2);
+    EXPECT_EQ(ModelMetrics::getBatchSizeBucketIndex(5), 3);
+    EXPECT_EQ(ModelMetrics::getBatchSizeBucketIndex(1000000), ModelMetrics::BATCH_SIZE_BUCKETS_COUNT - 1);
+
+    ModelMetrics metrics;
+    metrics.recordBatchSize(1);
+    metrics.recordBatchSize(8);
+    metrics.recordBatchSize(7);
+    EXPECT_EQ(metrics.getBatchSizeCount(0), 1);
+    EXPECT_EQ(metrics.getBatchSizeCount(3), 2);
+    EXPECT_EQ(metrics.getBatchSizeBucketUpperBound(3), 8);
+}
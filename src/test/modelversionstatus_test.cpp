@@ -107,3 +107,22 @@ TEST(ModelVersionStatus, loading_fault_test_flow) {
 
     // others are not implemented in python version.
 }
+
+TEST(ModelVersionStatus, snapshot_holds_state_with_error_code) {
+    ModelVersionStatus mvs("SampleModelName", 15);
+    mvs.setLoading(ModelVersionStatusErrorCode::UNKNOWN);
+    auto snapshot = mvs.getSnapshot();
+    EXPECT_EQ(snapshot.state, ovms::ModelVersionState::LOADING);
+    EXPECT_EQ(snapshot.errorCode, ModelVersionStatusErrorCode::UNKNOWN);
+
+    mvs.setAvailable();
+    EXPECT_EQ(snapshot.state, ovms::ModelVersionState::LOADING);
+    snapshot = mvs.getSnapshot();
+    EXPECT_EQ(snapshot.state, ovms::ModelVersionState::AVAILABLE);
+    EXPECT_EQ(snapshot.errorCode, ModelVersionStatusErrorCode::OK);
+
+    ModelVersionStatus copy = mvs;
+    EXPECT_EQ(copy.getState(), ovms::ModelVersionState::AVAILABLE);
+    mvs.setUnloading();
+    EXPECT_EQ(copy.getState(), ovms::ModelVersionState::AVAILABLE);
+}
@@ -0,0 +1,120 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../mpscqueue.hpp"
+
+using ovms::MpscQueue;
+
+TEST(TestMpscQueue, SeveralElementsInFIFOOrder) {
+    const std::vector<int> elements = {1, 2, 3, 4, 5, 6};
+    MpscQueue<int> queue;
+    for (auto& e : elements) {
+        queue.push(e);
+    }
+    EXPECT_EQ(queue.size(), elements.size());
+    for (auto& e : elements) {
+        EXPECT_EQ(queue.tryPull(1), e);
+    }
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(TestMpscQueue, MovesNonCopyableElements) {
+    MpscQueue<std::unique_ptr<int>> queue;
+    queue.push(std::make_unique<int>(3));
+    auto element = queue.pull();
+    ASSERT_NE(element, nullptr);
+    EXPECT_EQ(*element, 3);
+}
+
+TEST(TestMpscQueue, TryPullUntilTimesOut) {
+    MpscQueue<int> queue;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(queue.tryPullUntil(start + std::chrono::milliseconds(20)), std::nullopt);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(queue.tryPull(0), std::nullopt);
+}
+
+TEST(TestMpscQueue, PullWaitsForElement) {
+    MpscQueue<int> queue;
+    std::thread producer([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.push(7);
+    });
+    EXPECT_EQ(queue.pull(), 7);
+    producer.join();
+}
+
+TEST(TestMpscQueue, PushListenerIsCalledAfterEachPush) {
+    MpscQueue<int> queue;
+    int listenerCalls = 0;
+    queue.setPushListener([&queue, &listenerCalls]() {
+        listenerCalls++;
+        EXPECT_EQ(queue.size(), listenerCalls);
+    });
+    queue.push(1);
+    queue.push(2);
+    EXPECT_EQ(listenerCalls, 2);
+}
+
+TEST(TestMpscQueue, QueueDestroyedRightAfterPull) {
+    // consumer destroys the queue once it gets the last element, pushing thread may still be returning from push
+    for (int i = 0; i < 1000; ++i) {
+        auto queue = std::make_unique<MpscQueue<int>>();
+        std::thread producer([&queue]() { queue->push(1); });
+        EXPECT_EQ(queue->pull(), 1);
+        auto destroyed = std::async(std::launch::async, [&queue]() { queue.reset(); });
+        destroyed.get();
+        producer.join();
+    }
+}
+
+TEST(TestMpscQueue, SeveralProducersAllElementsPresent) {
+    const uint producersCount = 80;
+    const uint elementsToPush = 500;
+    MpscQueue<int> queue;
+    std::promise<void> startSignal;
+    std::shared_future<void> started = startSignal.get_future().share();
+    std::vector<std::thread> producers;
+    for (uint i = 0; i < producersCount; ++i) {
+        producers.emplace_back([&queue, started]() {
+            started.wait();
+            for (uint counter = 0; counter < elementsToPush; ++counter) {
+                queue.push(counter);
+            }
+        });
+    }
+    startSignal.set_value();
+    std::map<int, uint> counts;
+    for (uint i = 0; i < producersCount * elementsToPush; ++i) {
+        counts[queue.tryPull(10'000'000).value()]++;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(counts.size(), elementsToPush);
+    for (auto [element, count] : counts) {
+        EXPECT_EQ(count, producersCount) << element;
+    }
+    EXPECT_EQ(queue.tryPull(0), std::nullopt);
+}
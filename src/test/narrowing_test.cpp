@@ -0,0 +1,238 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../narrowing.hpp"
+
+TEST(Narrowing, MatchesScalarConversionForAllTailLengths) {
+    for (size_t count = 0; count < 100; count++) {
+        std::vector<int32_t> source(count);
+        for (size_t i = 0; i < count; i++) {
+            // values with upper bits set and negative ones are truncated to the lower 16 bits
+            source[i] = static_cast<int32_t>(i * 2654435761u);
+        }
+        std::vector<uint16_t> expected(count);
+        std::vector<uint16_t> actual(count, 0);
+        ovms::narrowToUint16Scalar(source.data(), expected.data(), count);
+        ovms::narrowToUint16(source.data(), actual.data(), count);
+        EXPECT_EQ(actual, expected) << "count: " << count;
+    }
+}
+
+TEST(Narrowing, KeepsLowerHalfOfValues) {
+    const std::vector<int32_t> source{0, 1, 0xFFFF, 0x10000, -1, 0x3C00, 0x7FFFFFFF, 0x12345678};
+    std::vector<uint16_t> destination(source.size());
+    ovms::narrowToUint16(source.data(), destination.data(), source.size());
+    EXPECT_EQ(destination, (std::vector<uint16_t>{0, 1, 0xFFFF, 0, 0xFFFF, 0x3C00, 0xFFFF, 0x5678}));
+}
+
+TEST(Narrowing, DoesNotWritePastCount) {
+    std::vector<int32_t> source(40, 5);
+    std::vector<uint16_t> destination(40, 7);
+    ovms::narrowToUint16(source.data(), destination.data(), 33);
+    for (size_t i = 0; i < 33; i++) {
+        EXPECT_EQ(destination[i], 5);
+    }
+    for (size_t i = 33; i < 40; i++) {
+        EXPECT_EQ(destination[i], 7);
+    }
+}
+
+namespace {
+std::vector<float> prepareFp32Values() {
+    std::vector<float> values{0.0f, -0.0f, 0.5f, 1.5f, 2.5f, -0.5f, -1.5f, 127.5f, 254.5f, 255.5f, -128.5f,
+        65504.0f, 65519.0f, 65520.0f, 1e-8f, 3e-8f, 6e-5f, 1e20f, -1e20f,
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min()};
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(static_cast<float>(i) * 0.37f - 200.0f);
+    }
+    return values;
+}
+}  // namespace
+
+TEST(Narrowing, Fp32ConversionsMatchScalarConversionForAllTailLengths) {
+    const auto values = prepareFp32Values();
+    for (size_t offset = 0; offset < 40; offset++) {
+        const float* source = values.data() + offset;
+        const size_t count = values.size() - offset;
+        std::vector<uint16_t> expected16(count), actual16(count);
+        ovms::narrowFp32ToFp16Scalar(source, expected16.data(), count);
+        ovms::narrowFp32ToFp16(source, actual16.data(), count);
+        EXPECT_EQ(actual16, expected16) << "FP16 offset: " << offset;
+        ovms::narrowFp32ToBf16Scalar(source, expected16.data(), count);
+        ovms::narrowFp32ToBf16(source, actual16.data(), count);
+        EXPECT_EQ(actual16, expected16) << "BF16 offset: " << offset;
+        std::vector<uint8_t> expectedU8(count), actualU8(count);
+        ovms::narrowFp32ToU8Scalar(source, expectedU8.data(), count);
+        ovms::narrowFp32ToU8(source, actualU8.data(), count);
+        EXPECT_EQ(actualU8, expectedU8) << "U8 offset: " << offset;
+        std::vector<int8_t> expectedI8(count), actualI8(count);
+        ovms::narrowFp32ToI8Scalar(source, expectedI8.data(), count);
+        ovms::narrowFp32ToI8(source, actualI8.data(), count);
+        EXPECT_EQ(actualI8, expectedI8) << "I8 offset: " << offset;
+    }
+}
+
+TEST(Narrowing, Fp32ToFp16) {
+    const std::vector<float> source{1.0f, -2.0f, 0.5f, 65504.0f, 65520.0f, 1e-8f, std::numeric_limits<float>::infinity()};
+    std::vector<uint16_t> destination(source.size());
+    ovms::narrowFp32ToFp16(source.data(), destination.data(), source.size());
+    EXPECT_EQ(destination, (std::vector<uint16_t>{0x3C00, 0xC000, 0x3800, 0x7BFF, 0x7C00, 0x0000, 0x7C00}));
+}
+
+TEST(Narrowing, Fp16ToFp32MatchesScalarConversionForAllValues) {
+    std::vector<uint16_t> source(0x10000);
+    for (size_t i = 0; i < source.size(); i++) {
+        source[i] = static_cast<uint16_t>(i);
+    }
+    for (size_t offset : {0, 1, 7, 15, 17}) {
+        const size_t count = source.size() - offset;
+        std::vector<float> expected(count), actual(count);
+        ovms::widenFp16ToFp32Scalar(source.data() + offset, expected.data(), count);
+        ovms::widenFp16ToFp32(source.data() + offset, actual.data(), count);
+        // compares bit patterns so NaN values are checked as well
+        EXPECT_EQ(std::memcmp(actual.data(), expected.data(), count * sizeof(float)), 0) << "offset: " << offset;
+    }
+}
+
+TEST(Narrowing, Fp16ToFp32) {
+    const std::vector<uint16_t> source{0x3C00, 0xC000, 0x3800, 0x7BFF, 0x0001, 0x8000, 0x7C00};
+    std::vector<float> destination(source.size());
+    ovms::widenFp16ToFp32(source.data(), destination.data(), source.size());
+    EXPECT_EQ(destination, (std::vector<float>{1.0f, -2.0f, 0.5f, 65504.0f, 5.9604645e-8f, -0.0f, std::numeric_limits<float>::infinity()}));
+    EXPECT_TRUE(std::signbit(destination[5]));
+    std::vector<uint16_t> roundTrip(source.size());
+    ovms::narrowFp32ToFp16(destination.data(), roundTrip.data(), destination.size());
+    EXPECT_EQ(roundTrip, source);
+}
+
+TEST(Narrowing, Fp32ToBf16) {
+    const std::vector<float> source{1.0f, -2.0f, 3.14159265f, 1.00390625f, 1.01171875f};
+    std::vector<uint16_t> destination(source.size());
+    ovms::narrowFp32ToBf16(source.data(), destination.data(), source.size());
+    // ties are rounded to even
+    EXPECT_EQ(destination, (std::vector<uint16_t>{0x3F80, 0xC000, 0x4049, 0x3F80, 0x3F82}));
+}
+
+TEST(Narrowing, Fp32ToIntegersRoundAndSaturate) {
+    const std::vector<float> source{-3.0f, 0.5f, 1.5f, 2.4f, 127.6f, 300.0f, std::numeric_limits<float>::quiet_NaN()};
+    std::vector<uint8_t> unsignedValues(source.size());
+    ovms::narrowFp32ToU8(source.data(), unsignedValues.data(), source.size());
+    EXPECT_EQ(unsignedValues, (std::vector<uint8_t>{0, 0, 2, 2, 128, 255, 0}));
+    std::vector<int8_t> signedValues(source.size());
+    ovms::narrowFp32ToI8(source.data(), signedValues.data(), source.size());
+    EXPECT_EQ(signedValues, (std::vector<int8_t>{-3, 0, 2, 2, 127, 127, -128}));
+}
+
+TEST(Narrowing, Bf16ToFp32) {
+    const std::vector<float> source{1.0f, -2.0f, 3.140625f, -0.0f, std::numeric_limits<float>::infinity()};
+    std::vector<uint16_t> narrowed(source.size());
+    ovms::narrowFp32ToBf16(source.data(), narrowed.data(), source.size());
+    std::vector<float> destination(source.size());
+    ovms::widenBf16ToFp32(narrowed.data(), destination.data(), narrowed.size());
+    EXPECT_EQ(destination, source);
+    EXPECT_TRUE(std::signbit(destination[3]));
+}
+
+TEST(Narrowing, MinMaxAndQuantizationMatchScalarForAllTailLengths) {
+    const auto values = prepareFp32Values();
+    for (size_t offset = 0; offset < 40; offset++) {
+        const float* source = values.data() + offset;
+        const size_t count = values.size() - offset;
+        float expectedLowest, expectedHighest, lowest, highest;
+        ovms::minMaxFp32Scalar(source, count, expectedLowest, expectedHighest);
+        ovms::minMaxFp32(source, count, lowest, highest);
+        EXPECT_EQ(lowest, expectedLowest) << "offset: " << offset;
+        EXPECT_EQ(highest, expectedHighest) << "offset: " << offset;
+        // power of two scale keeps multiplication exact, so fused and separate operations give the same values
+        std::vector<int8_t> expected(count), actual(count);
+        ovms::quantizeFp32ToI8Scalar(source, expected.data(), count, 0.5f, -3);
+        ovms::quantizeFp32ToI8(source, actual.data(), count, 0.5f, -3);
+        EXPECT_EQ(actual, expected) << "offset: " << offset;
+    }
+}
+
+TEST(Narrowing, MinMaxSkipsNaN) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> source(33, nan);
+    source[5] = -4.0f;
+    source[20] = 7.5f;
+    float lowest, highest;
+    ovms::minMaxFp32(source.data(), source.size(), lowest, highest);
+    EXPECT_EQ(lowest, -4.0f);
+    EXPECT_EQ(highest, 7.5f);
+    ovms::minMaxFp32(source.data(), 2, lowest, highest);
+    EXPECT_EQ(lowest, std::numeric_limits<float>::infinity());
+    EXPECT_EQ(highest, -std::numeric_limits<float>::infinity());
+}
+
+TEST(Narrowing, QuantizeFp32ToI8) {
+    const std::vector<float> source{-1.0f, 0.0f, 0.26f, 1.0f, 40.0f, std::numeric_limits<float>::quiet_NaN()};
+    std::vector<int8_t> destination(source.size());
+    ovms::quantizeFp32ToI8(source.data(), destination.data(), source.size(), 0.25f, 10);
+    EXPECT_EQ(destination, (std::vector<int8_t>{6, 10, 11, 14, 127, -128}));
+}
+
+TEST(Narrowing, I64ToI32MatchesScalarConversionForAllTailLengths) {
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < 1000; i++) {
+        values.push_back((i - 500) * 0x10000001LL);
+    }
+    for (size_t offset = 0; offset < 40; offset++) {
+        const int64_t* source = values.data() + offset;
+        const size_t count = values.size() - offset;
+        std::vector<int32_t> expected(count), actual(count);
+        ovms::narrowI64ToI32Scalar(source, expected.data(), count);
+        ovms::narrowI64ToI32(source, actual.data(), count);
+        EXPECT_EQ(actual, expected) << "offset: " << offset;
+    }
+}
+
+TEST(Narrowing, I64ToI32KeepsLowerBits) {
+    const std::vector<int64_t> source{0, 1, -1, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min(), 0x100000002LL, -0x100000002LL};
+    std::vector<int32_t> destination(source.size());
+    ovms::narrowI64ToI32(source.data(), destination.data(), source.size());
+    EXPECT_EQ(destination, (std::vector<int32_t>{0, 1, -1, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min(), 2, -2}));
+}
+
+TEST(Narrowing, ToUint8MatchesScalarConversionForAllTailLengths) {
+    std::vector<int32_t> values;
+    for (int32_t i = 0; i < 1000; i++) {
+        values.push_back(static_cast<int32_t>(i * 2654435761u));
+    }
+    for (size_t offset = 0; offset < 70; offset++) {
+        const int32_t* source = values.data() + offset;
+        const size_t count = values.size() - offset;
+        std::vector<uint8_t> expected(count), actual(count);
+        ovms::narrowToUint8Scalar(source, expected.data(), count);
+        ovms::narrowToUint8(source, actual.data(), count);
+        EXPECT_EQ(actual, expected) << "offset: " << offset;
+    }
+}
+
+TEST(Narrowing, ToUint8KeepsLowerBits) {
+    const std::vector<int32_t> source{0, 1, 255, 256, -1, -128, 127, 0x12345678};
+    std::vector<uint8_t> destination(source.size());
+    ovms::narrowToUint8(source.data(), destination.data(), source.size());
+    EXPECT_EQ(destination, (std::vector<uint8_t>{0, 1, 255, 0, 255, 128, 127, 0x78}));
+}
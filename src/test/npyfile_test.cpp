@@ -0,0 +1,113 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../npyfile.hpp"
+
+using namespace ovms;
+
+namespace {
+std::string makeNpy(const std::string& header, const std::string& data, uint8_t majorVersion = 1) {
+    std::string content("\x93NUMPY", 6);
+    content += static_cast<char>(majorVersion);
+    content += '\0';
+    const size_t size = header.size();
+    content += static_cast<char>(size & 0xFF);
+    content += static_cast<char>((size >> 8) & 0xFF);
+    if (majorVersion > 1) {
+        content += static_cast<char>((size >> 16) & 0xFF);
+        content += static_cast<char>((size >> 24) & 0xFF);
+    }
+    return content + header + data;
+}
+
+std::string floats(const std::vector<float>& values) {
+    return std::string(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+}
+}  // namespace
+
+TEST(NpyFile, ParsesFloatArray) {
+    const std::string data = floats({1, 2, 3, 4, 5, 6});
+    tensorflow::TensorProto proto;
+    auto status = parseNpy(makeNpy("{'descr': '<f4', 'fortran_order': False, 'shape': (2, 3), }\n", data), proto);
+    ASSERT_TRUE(status.ok()) << status.string();
+    EXPECT_EQ(proto.dtype(), tensorflow::DataType::DT_FLOAT);
+    ASSERT_EQ(proto.tensor_shape().dim_size(), 2);
+    EXPECT_EQ(proto.tensor_shape().dim(0).size(), 2);
+    EXPECT_EQ(proto.tensor_shape().dim(1).size(), 3);
+    EXPECT_EQ(proto.tensor_content(), data);
+}
+
+TEST(NpyFile, ParsesVersion2HeaderAndSingleDimension) {
+    const std::string data = "\x01\x02\x03";
+    tensorflow::TensorProto proto;
+    auto status = parseNpy(makeNpy("{'descr': '|u1', 'fortran_order': False, 'shape': (3,), }\n", data, 2), proto);
+    ASSERT_TRUE(status.ok()) << status.string();
+    EXPECT_EQ(proto.dtype(), tensorflow::DataType::DT_UINT8);
+    ASSERT_EQ(proto.tensor_shape().dim_size(), 1);
+    EXPECT_EQ(proto.tensor_shape().dim(0).size(), 3);
+    EXPECT_EQ(proto.tensor_content(), data);
+}
+
+TEST(NpyFile, RejectsUnsupportedContent) {
+    tensorflow::TensorProto proto;
+    EXPECT_EQ(parseNpy("not a npy file", proto), StatusCode::FILE_INVALID);
+    EXPECT_EQ(parseNpy(makeNpy("{'descr': '<f4', 'fortran_order': True, 'shape': (1, 2), }\n", floats({1, 2})), proto), StatusCode::FILE_INVALID);
+    EXPECT_EQ(parseNpy(makeNpy("{'descr': '>f4', 'fortran_order': False, 'shape': (1, 2), }\n", floats({1, 2})), proto), StatusCode::FILE_INVALID);
+    EXPECT_EQ(parseNpy(makeNpy("{'descr': '<U4', 'fortran_order': False, 'shape': (1,), }\n", "abcd"), proto), StatusCode::FILE_INVALID);
+    EXPECT_EQ(parseNpy(makeNpy("{'descr': '<f4', 'fortran_order': False, 'shape': (1, 3), }\n", floats({1, 2})), proto), StatusCode::FILE_INVALID);
+}
+
+TEST(NpyFile, SliceBatchWrapsAroundEntries) {
+    tensorflow::TensorProto source;
+    ASSERT_TRUE(parseNpy(makeNpy("{'descr': '<f4', 'fortran_order': False, 'shape': (3, 2), }\n", floats({1, 2, 3, 4, 5, 6})), source).ok());
+    tensorflow::TensorProto batch;
+    ASSERT_TRUE(sliceBatch(source, 2, 2, batch).ok());
+    EXPECT_EQ(batch.dtype(), tensorflow::DataType::DT_FLOAT);
+    ASSERT_EQ(batch.tensor_shape().dim_size(), 2);
+    EXPECT_EQ(batch.tensor_shape().dim(0).size(), 2);
+    EXPECT_EQ(batch.tensor_shape().dim(1).size(), 2);
+    EXPECT_EQ(batch.tensor_content(), floats({5, 6, 1, 2}));
+    EXPECT_EQ(sliceBatch(source, 0, 0, batch), StatusCode::INVALID_BATCH_SIZE);
+}
+
+TEST(NpyFile, SerializedArrayIsParsedBack) {
+    tensorflow::TensorProto source;
+    ASSERT_TRUE(parseNpy(makeNpy("{'descr': '<f4', 'fortran_order': False, 'shape': (3, 2), }\n", floats({1, 2, 3, 4, 5, 6})), source).ok());
+    std::string content;
+    ASSERT_EQ(serializeNpy(source, content), StatusCode::OK);
+    EXPECT_EQ((content.size() - source.tensor_content().size()) % 64, 0u);
+    EXPECT_NE(content.find("'shape': (3, 2)"), std::string::npos);
+    tensorflow::TensorProto parsed;
+    ASSERT_TRUE(parseNpy(content, parsed).ok());
+    EXPECT_EQ(parsed.SerializeAsString(), source.SerializeAsString());
+
+    tensorflow::TensorProto vector;
+    vector.set_dtype(tensorflow::DataType::DT_UINT8);
+    vector.mutable_tensor_shape()->add_dim()->set_size(3);
+    vector.set_tensor_content("\x01\x02\x03");
+    ASSERT_EQ(serializeNpy(vector, content), StatusCode::OK);
+    EXPECT_NE(content.find("'descr': '|u1'"), std::string::npos);
+    EXPECT_NE(content.find("'shape': (3,)"), std::string::npos);
+
+    vector.set_dtype(tensorflow::DataType::DT_STRING);
+    EXPECT_EQ(serializeNpy(vector, content), StatusCode::OV_UNSUPPORTED_SERIALIZATION_PRECISION);
+}
@@ -0,0 +1,107 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sched.h>
+
+#include "../numa.hpp"
+
+using ovms::cpu_list_t;
+
+TEST(Numa, ParseCpuList) {
+    cpu_list_t cpus;
+    EXPECT_TRUE(ovms::parseCpuList("0-3,8,10-11\n", cpus));
+    EXPECT_EQ(cpus, cpu_list_t({0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(ovms::parseCpuList("5", cpus));
+    EXPECT_EQ(cpus, cpu_list_t({5}));
+    EXPECT_TRUE(ovms::parseCpuList("", cpus));
+    EXPECT_TRUE(cpus.empty());
+}
+
+TEST(Numa, ParseMalformedCpuListFails) {
+    cpu_list_t cpus;
+    EXPECT_FALSE(ovms::parseCpuList("3-1", cpus));
+    EXPECT_FALSE(ovms::parseCpuList("a-b", cpus));
+    EXPECT_FALSE(ovms::parseCpuList("1-2-3", cpus));
+}
+
+TEST(Numa, CurrentNodeIsOneOfHostNodes) {
+    auto nodes = ovms::getNumaNodesCpus();
+    if (nodes.empty()) {
+        EXPECT_EQ(ovms::getCurrentNumaNode(), -1);
+        return;
+    }
+    EXPECT_EQ(nodes.count(ovms::getCurrentNumaNode()), 1);
+}
+
+TEST(Numa, RunPinnedToCpus) {
+    cpu_set_t cpuSet;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &cpuSet), 0);
+    int allowedCpu = 0;
+    while (!CPU_ISSET(allowedCpu, &cpuSet)) {
+        allowedCpu++;
+    }
+    int executedOnCpu = -1;
+    ovms::runPinnedToCpus({allowedCpu}, [&executedOnCpu]() { executedOnCpu = sched_getcpu(); });
+    EXPECT_EQ(executedOnCpu, allowedCpu);
+}
+
+TEST(Numa, RunPinnedToCpusRethrowsException) {
+    EXPECT_THROW(ovms::runPinnedToCpus({0}, []() { throw std::runtime_error("failure"); }), std::runtime_error);
+}
+
+TEST(Numa, AllowedCpusMatchAffinity) {
+    cpu_set_t cpuSet;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &cpuSet), 0);
+    auto cpus = ovms::getAllowedCpus();
+    EXPECT_EQ(cpus.size(), static_cast<size_t>(CPU_COUNT(&cpuSet)));
+    for (int cpu : cpus) {
+        EXPECT_TRUE(CPU_ISSET(cpu, &cpuSet)) << cpu;
+    }
+}
+
+TEST(Numa, PinCurrentThread) {
+    auto cpus = ovms::getAllowedCpus();
+    ASSERT_FALSE(cpus.empty());
+    int executedOnCpu = -1;
+    std::thread thread([&cpus, &executedOnCpu]() {
+        if (ovms::pinCurrentThread({cpus.back()})) {
+            executedOnCpu = sched_getcpu();
+        }
+    });
+    thread.join();
+    EXPECT_EQ(executedOnCpu, cpus.back());
+}
+
+TEST(Numa, FormatCpuList) {
+    EXPECT_EQ(ovms::formatCpuList({0, 1, 2, 3, 8, 10, 11}), "0-3,8,10-11");
+    EXPECT_EQ(ovms::formatCpuList({5}), "5");
+    EXPECT_EQ(ovms::formatCpuList({}), "");
+    cpu_list_t cpus;
+    EXPECT_TRUE(ovms::parseCpuList(ovms::formatCpuList({1, 3, 4, 5, 7}), cpus));
+    EXPECT_EQ(cpus, cpu_list_t({1, 3, 4, 5, 7}));
+}
+
+TEST(Numa, SplitCpuList) {
+    EXPECT_EQ(ovms::splitCpuList({0, 1, 2, 3, 4, 5, 6}, 3), std::vector<cpu_list_t>({{0, 1, 2}, {3, 4}, {5, 6}}));
+    EXPECT_EQ(ovms::splitCpuList({0, 2, 4, 6}, 2), std::vector<cpu_list_t>({{0, 2}, {4, 6}}));
+    EXPECT_EQ(ovms::splitCpuList({0, 1}, 4), std::vector<cpu_list_t>({{0}, {1}}));
+    EXPECT_TRUE(ovms::splitCpuList({}, 2).empty());
+}
@@ -0,0 +1,110 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../outputreduction.hpp"
+
+namespace {
+std::vector<float> createValues(size_t count) {
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; i++) {
+        // repeated values check that equal values are ordered by index
+        values[i] = static_cast<float>((i * 2654435761u) % 97) / 97.0f;
+    }
+    return values;
+}
+
+const float NO_THRESHOLD = -std::numeric_limits<float>::infinity();
+}  // namespace
+
+TEST(OutputReduction, ArgmaxMatchesScalarForAllTailLengths) {
+    for (size_t count = 0; count < 100; count++) {
+        auto values = createValues(count);
+        EXPECT_EQ(ovms::argmaxFp32(values.data(), count, NO_THRESHOLD), ovms::argmaxFp32Scalar(values.data(), count, NO_THRESHOLD)) << "count: " << count;
+        EXPECT_EQ(ovms::argmaxFp32(values.data(), count, 0.5f), ovms::argmaxFp32Scalar(values.data(), count, 0.5f)) << "count: " << count;
+    }
+}
+
+TEST(OutputReduction, ArgmaxReturnsFirstHighestValue) {
+    std::vector<float> values(40, 0.1f);
+    values[33] = 0.9f;
+    values[37] = 0.9f;
+    EXPECT_EQ(ovms::argmaxFp32(values.data(), values.size(), NO_THRESHOLD), 33);
+    EXPECT_EQ(ovms::argmaxFp32(values.data(), values.size(), 0.9f), -1) << "only values greater than threshold are selected";
+    EXPECT_EQ(ovms::argmaxFp32(values.data(), 0, NO_THRESHOLD), -1);
+}
+
+TEST(OutputReduction, ArgmaxSkipsNaN) {
+    std::vector<float> values(40, 0.1f);
+    values[0] = std::numeric_limits<float>::quiet_NaN();
+    values[20] = std::numeric_limits<float>::quiet_NaN();
+    values[25] = 0.5f;
+    EXPECT_EQ(ovms::argmaxFp32(values.data(), values.size(), NO_THRESHOLD), 25);
+    EXPECT_EQ(ovms::argmaxFp32Scalar(values.data(), values.size(), NO_THRESHOLD), 25);
+}
+
+TEST(OutputReduction, TopKMatchesScalarForAllTailLengths) {
+    for (size_t count = 0; count < 100; count++) {
+        auto values = createValues(count);
+        for (size_t k : {1, 5, 120}) {
+            std::vector<float> expectedValues(k), actualValues(k);
+            std::vector<int64_t> expectedIndices(k), actualIndices(k);
+            auto expectedCount = ovms::topKFp32Scalar(values.data(), count, k, 0.2f, expectedValues.data(), expectedIndices.data());
+            auto actualCount = ovms::topKFp32(values.data(), count, k, 0.2f, actualValues.data(), actualIndices.data());
+            EXPECT_EQ(actualCount, expectedCount) << "count: " << count << " k: " << k;
+            EXPECT_EQ(actualValues, expectedValues) << "count: " << count << " k: " << k;
+            EXPECT_EQ(actualIndices, expectedIndices) << "count: " << count << " k: " << k;
+        }
+    }
+}
+
+TEST(OutputReduction, TopKSelectsHighestValuesInDescendingOrder) {
+    std::vector<float> values(1000, 0.0f);
+    values[999] = 0.5f;
+    values[10] = 0.9f;
+    values[500] = 0.7f;
+    values[501] = 0.7f;
+    std::vector<float> topValues(3);
+    std::vector<int64_t> topIndices(3);
+    ASSERT_EQ(ovms::topKFp32(values.data(), values.size(), 3, NO_THRESHOLD, topValues.data(), topIndices.data()), 3);
+    EXPECT_EQ(topValues, (std::vector<float>{0.9f, 0.7f, 0.7f}));
+    EXPECT_EQ(topIndices, (std::vector<int64_t>{10, 500, 501}));
+}
+
+TEST(OutputReduction, TopKPadsValuesNotGreaterThanThreshold) {
+    std::vector<float> values(30, 0.01f);
+    values[3] = 0.6f;
+    values[17] = 0.3f;
+    std::vector<float> topValues(4);
+    std::vector<int64_t> topIndices(4);
+    ASSERT_EQ(ovms::topKFp32(values.data(), values.size(), 4, 0.05f, topValues.data(), topIndices.data()), 2);
+    EXPECT_EQ(topValues, (std::vector<float>{0.6f, 0.3f, 0.0f, 0.0f}));
+    EXPECT_EQ(topIndices, (std::vector<int64_t>{3, 17, -1, -1}));
+}
+
+TEST(OutputReduction, ParsesTypeNames) {
+    ovms::OutputReductionType type;
+    ASSERT_TRUE(ovms::parseOutputReductionType("argmax", type));
+    EXPECT_EQ(type, ovms::OutputReductionType::ARGMAX);
+    ASSERT_TRUE(ovms::parseOutputReductionType("top_k", type));
+    EXPECT_EQ(type, ovms::OutputReductionType::TOP_K);
+    EXPECT_FALSE(ovms::parseOutputReductionType("softmax", type));
+}
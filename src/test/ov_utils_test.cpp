@@ -14,6 +14,8 @@
 // limitations under the License.
 //*****************************************************************************
 #include <algorithm>
+#include <numeric>
+#include <string>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -63,3 +65,32 @@ TEST(OVUtils, CopyBlob) {
     // Expect memory addresses to differ since cloning should allocate new memory space for the cloned blob
     EXPECT_NE((float*)copyBlob->buffer(), (float*)originalBlob->buffer());
 }
+
+TEST(OVUtils, StringBlobStorageIsTakenByLastOwner) {
+    const InferenceEngine::TensorDesc desc{InferenceEngine::Precision::I32, {2, 3}, InferenceEngine::Layout::NC};
+    auto blob = ovms::allocateStringBlob(desc);
+    ASSERT_NE(blob, nullptr);
+    ASSERT_EQ(blob->byteSize(), 6 * sizeof(int32_t));
+    std::iota(blob->buffer().as<int32_t*>(), blob->buffer().as<int32_t*>() + 6, 0);
+    const void* data = blob->cbuffer().as<const void*>();
+
+    auto copy = blob;
+    std::string storage;
+    EXPECT_FALSE(ovms::takeStringBlobStorage(blob, storage));
+    ASSERT_NE(blob, nullptr);
+    copy.reset();
+
+    ASSERT_TRUE(ovms::takeStringBlobStorage(blob, storage));
+    EXPECT_EQ(blob, nullptr);
+    EXPECT_EQ(static_cast<const void*>(storage.data()), data);
+    EXPECT_EQ(reinterpret_cast<const int32_t*>(storage.data())[5], 5);
+}
+
+TEST(OVUtils, StorageOfOtherBlobsIsNotTaken) {
+    std::vector<float> data(4);
+    InferenceEngine::Blob::Ptr blob = InferenceEngine::make_shared_blob<float>({InferenceEngine::Precision::FP32, {4}, InferenceEngine::Layout::C}, data.data());
+    std::string storage;
+    EXPECT_FALSE(ovms::takeStringBlobStorage(blob, storage));
+    EXPECT_NE(blob, nullptr);
+    EXPECT_TRUE(storage.empty());
+}
@@ -14,16 +14,23 @@
 // limitations under the License.
 //*****************************************************************************
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
+#include <future>
+#include <memory>
 #include <random>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "../inferrequestpools.hpp"
+#include "../nodestreamidguard.hpp"
 #include "../ovinferrequestsqueue.hpp"
+#include "../replicarouting.hpp"
 #define DEBUG
 #include "../timer.hpp"
 
@@ -48,6 +55,19 @@ TEST(OVInferRequestQueue, ShortQueue) {
     EXPECT_EQ(reqid, 0);
 }
 
+TEST(OVInferRequestQueue, IdleStreamsCount) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 3);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 3);
+    int reqid = inferRequestsQueue.getIdleStream().get();
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 2);
+    inferRequestsQueue.returnStream(reqid);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 3);
+    EXPECT_EQ(inferRequestsQueue.getWaitersCount(), 0);
+}
+
 void releaseStream(ovms::OVInferRequestsQueue& requestsQueue) {
     std::this_thread::sleep_for(std::chrono::seconds(1));
     requestsQueue.returnStream(3);
@@ -127,3 +147,342 @@ TEST(OVInferRequestQueue, AsyncGetInferRequest) {
     const int secondStreamId = secondStreamRequest.get();
     EXPECT_EQ(firstStreamId, secondStreamId);
 }
+
+TEST(OVInferRequestQueue, TryGetIdleStream) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 2);
+
+    auto firstStreamId = inferRequestsQueue.tryGetIdleStream();
+    auto secondStreamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(firstStreamId.has_value());
+    ASSERT_TRUE(secondStreamId.has_value());
+    EXPECT_NE(firstStreamId.value(), secondStreamId.value());
+    EXPECT_FALSE(inferRequestsQueue.tryGetIdleStream().has_value());
+
+    std::future<int> waitingStreamRequest = inferRequestsQueue.getIdleStream();
+    EXPECT_EQ(std::future_status::timeout, waitingStreamRequest.wait_for(std::chrono::milliseconds(1)));
+    inferRequestsQueue.returnStream(secondStreamId.value());
+    ASSERT_EQ(std::future_status::ready, waitingStreamRequest.wait_for(std::chrono::milliseconds(100)));
+    EXPECT_EQ(waitingStreamRequest.get(), secondStreamId.value());
+
+    inferRequestsQueue.returnStream(firstStreamId.value());
+    auto returnedStreamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(returnedStreamId.has_value());
+    EXPECT_EQ(returnedStreamId.value(), firstStreamId.value());
+}
+
+void inferenceSimulateWithTryGet(ovms::OVInferRequestsQueue& ms, std::vector<std::atomic<int>>& usage) {
+    for (int i = 0; i < 1000; i++) {
+        auto streamId = ms.tryGetIdleStream();
+        int st = streamId ? streamId.value() : ms.getIdleStream().get();
+        EXPECT_EQ(usage[st].fetch_add(1), 0);
+        std::this_thread::yield();
+        EXPECT_EQ(usage[st].fetch_sub(1), 1);
+        ms.returnStream(st);
+    }
+}
+
+TEST(OVInferRequestQueue, MultiThreadMixedFastAndWaitingPath) {
+    int nireq = 3;
+    int number_clients = 32;
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, nireq);
+
+    std::vector<std::atomic<int>> usage(nireq);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < number_clients; ++i) {
+        clients.emplace_back(inferenceSimulateWithTryGet, std::ref(inferRequestsQueue), std::ref(usage));
+    }
+    for (auto& t : clients) {
+        t.join();
+    }
+    for (int i = 0; i < nireq; ++i) {
+        EXPECT_TRUE(inferRequestsQueue.tryGetIdleStream().has_value());
+    }
+    EXPECT_FALSE(inferRequestsQueue.tryGetIdleStream().has_value());
+}
+
+TEST(OVInferRequestQueue, WaitersServedEarliestDeadlineFirst) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+
+    auto streamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    std::vector<std::string> servedOrder;
+    auto registerWaiter = [&inferRequestsQueue, &servedOrder](const std::string& name, const ovms::deadline_t& deadline) {
+        inferRequestsQueue.getIdleStream([&servedOrder, name](int streamId) { servedOrder.push_back(name); }, deadline);
+    };
+    const auto now = std::chrono::steady_clock::now();
+    registerWaiter("no_deadline", ovms::NO_DEADLINE);
+    registerWaiter("late", now + std::chrono::seconds(20));
+    registerWaiter("early", now + std::chrono::seconds(10));
+    for (int i = 0; i < 3; i++) {
+        inferRequestsQueue.returnStream(streamId.value());
+    }
+    EXPECT_THAT(servedOrder, ElementsAre("early", "late", "no_deadline"));
+}
+
+TEST(OVInferRequestQueue, WaitersWithEqualDeadlineServedByDescendingPriority) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+
+    auto streamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    std::vector<std::string> servedOrder;
+    auto registerWaiter = [&inferRequestsQueue, &servedOrder](const std::string& name, uint64_t priority) {
+        inferRequestsQueue.getIdleStream([&servedOrder, name](int streamId) { servedOrder.push_back(name); }, ovms::NO_DEADLINE, priority);
+    };
+    // priority overtakes waiters which are waiting shorter than the priority difference in microseconds
+    registerWaiter("low", 1);
+    registerWaiter("high", 1000000);
+    registerWaiter("low_later", 1);
+    for (int i = 0; i < 3; i++) {
+        inferRequestsQueue.returnStream(streamId.value());
+    }
+    EXPECT_THAT(servedOrder, ElementsAre("high", "low", "low_later"));
+}
+
+TEST(OVInferRequestQueue, WaiterWithoutPriorityIsNotStarvedByHigherPriorityWaiters) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+
+    auto streamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    std::future<int> directRequest = inferRequestsQueue.getIdleStream();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    // pipeline node arriving later is ahead by its priority only, which is less than the direct request waits already
+    std::atomic<int> prioritizedStreamId{0};
+    inferRequestsQueue.getIdleStream([&prioritizedStreamId](int streamId) { prioritizedStreamId = streamId; }, ovms::NO_DEADLINE, 1000);
+    inferRequestsQueue.returnStream(streamId.value());
+    ASSERT_EQ(std::future_status::ready, directRequest.wait_for(std::chrono::milliseconds(100)));
+    EXPECT_EQ(directRequest.get(), streamId.value());
+    EXPECT_EQ(prioritizedStreamId, 0);
+    EXPECT_EQ(inferRequestsQueue.getWaitersCount(), 1);
+    inferRequestsQueue.returnStream(streamId.value());
+    EXPECT_EQ(prioritizedStreamId, streamId.value());
+}
+
+TEST(OVInferRequestQueue, ExpiredWaiterIsDroppedWithoutTakingStream) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+
+    auto streamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    // expired by DeadlineTimer thread
+    std::atomic<int> expiredWaiterStreamId{0};
+    inferRequestsQueue.getIdleStream([&expiredWaiterStreamId](int streamId) { expiredWaiterStreamId = streamId; },
+        ovms::deadlineAfter(std::chrono::milliseconds(1)));
+    std::future<int> waitingStreamRequest = inferRequestsQueue.getIdleStream();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    inferRequestsQueue.returnStream(streamId.value());
+    EXPECT_EQ(expiredWaiterStreamId, ovms::EXPIRED_STREAM_ID);
+    ASSERT_EQ(std::future_status::ready, waitingStreamRequest.wait_for(std::chrono::milliseconds(100)));
+    EXPECT_EQ(waitingStreamRequest.get(), streamId.value());
+}
+
+TEST(OVInferRequestQueue, WaiterExpiresAtDeadlineWhenNoStreamIsReturned) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+
+    auto streamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    auto expired = std::make_shared<std::promise<int>>();
+    auto expiredFuture = expired->get_future();
+    inferRequestsQueue.getIdleStream([expired](int streamId) { expired->set_value(streamId); },
+        ovms::deadlineAfter(std::chrono::milliseconds(10)));
+    EXPECT_EQ(inferRequestsQueue.getWaitersCount(), 1);
+    ASSERT_EQ(std::future_status::ready, expiredFuture.wait_for(std::chrono::seconds(1)));
+    EXPECT_EQ(expiredFuture.get(), ovms::EXPIRED_STREAM_ID);
+    EXPECT_EQ(inferRequestsQueue.getWaitersCount(), 0);
+    // returned stream stays idle for following callers
+    inferRequestsQueue.returnStream(streamId.value());
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 1);
+}
+
+TEST(OVInferRequestQueue, DeferredNodeStreamIdGuardIsNotifiedWhenStreamIsReturned) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+
+    auto streamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    int notificationsCount = 0;
+    {
+        ovms::NodeStreamIdGuard guard(inferRequestsQueue, [&notificationsCount]() { notificationsCount++; });
+        EXPECT_TRUE(guard.isDeferred());
+        EXPECT_FALSE(guard.tryGetId().has_value());
+        EXPECT_EQ(notificationsCount, 0);
+        inferRequestsQueue.returnStream(streamId.value());
+        EXPECT_EQ(notificationsCount, 1);
+        EXPECT_EQ(guard.tryGetId(), streamId);
+        EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 0);
+    }
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 1);
+    ovms::NodeStreamIdGuard guard(inferRequestsQueue, [&notificationsCount]() { notificationsCount++; });
+    EXPECT_FALSE(guard.isDeferred());
+    EXPECT_EQ(guard.tryGetId(), streamId);
+    EXPECT_EQ(notificationsCount, 1);
+}
+
+TEST(OVInferRequestQueue, DisarmedNodeStreamIdGuardReturnsStreamAssignedLater) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+
+    auto streamId = inferRequestsQueue.tryGetIdleStream();
+    ASSERT_TRUE(streamId.has_value());
+    bool notified = false;
+    {
+        ovms::NodeStreamIdGuard guard(inferRequestsQueue, [&notified]() { notified = true; });
+        EXPECT_TRUE(guard.tryDisarm());
+    }
+    inferRequestsQueue.returnStream(streamId.value());
+    EXPECT_FALSE(notified);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 1);
+    EXPECT_EQ(inferRequestsQueue.getWaitersCount(), 0);
+}
+
+TEST(OVInferRequestQueue, AverageStreamHoldTimeIsMeasured) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1);
+    EXPECT_EQ(inferRequestsQueue.getAverageStreamHoldMicroseconds(), 0);
+    int reqid = inferRequestsQueue.getIdleStream().get();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    inferRequestsQueue.returnStream(reqid);
+    EXPECT_GE(inferRequestsQueue.getAverageStreamHoldMicroseconds(), 10000);
+}
+
+TEST(OVInferRequestQueue, ReplicaWithLessBusyStreamsIsSelected) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue first(execNetwork, 2);
+    ovms::OVInferRequestsQueue second(execNetwork, 2);
+    std::vector<const ovms::OVInferRequestsQueue*> queues{&first, &second};
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::LEAST_QUEUED), 0);
+    int reqid = first.getIdleStream().get();
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::LEAST_QUEUED), 1);
+    first.returnStream(reqid);
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::LEAST_QUEUED), 0);
+
+    // first queue holds streams longer, with equal number of busy streams the second one is faster
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    reqid = second.getIdleStream().get();
+    second.returnStream(reqid);
+    reqid = first.getIdleStream().get();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    first.returnStream(reqid);
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::LATENCY_WEIGHTED), 1);
+}
+
+TEST(OVInferRequestQueue, ReplicaOverflowsOnlyWhenPreferredOneIsSaturated) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue preferred(execNetwork, 2);
+    ovms::OVInferRequestsQueue overflow(execNetwork, 2);
+    std::vector<const ovms::OVInferRequestsQueue*> queues{&preferred, &overflow};
+    // unlike least queued, preferred queue keeps requests while it has an idle stream
+    int firstReqid = preferred.getIdleStream().get();
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::LEAST_QUEUED), 1);
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::ORDERED_OVERFLOW), 0);
+    int secondReqid = preferred.getIdleStream().get();
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::ORDERED_OVERFLOW), 1);
+    preferred.returnStream(secondReqid);
+    EXPECT_EQ(ovms::selectReplica(queues, ovms::ReplicaRouting::ORDERED_OVERFLOW), 0);
+    preferred.returnStream(firstReqid);
+}
+
+TEST(OVInferRequestQueue, PoolBorrowsSharedStreamsOnlyWhenItsOwnAreBusy) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue pool(execNetwork, 1);
+    ovms::OVInferRequestsQueue shared(execNetwork, 1);
+    EXPECT_EQ(&ovms::selectInferRequestsPoolQueue(pool, shared), &pool);
+    int poolReqid = pool.getIdleStream().get();
+    EXPECT_EQ(&ovms::selectInferRequestsPoolQueue(pool, shared), &shared);
+    // pool waits for its own stream once the shared one is busy too
+    int sharedReqid = shared.getIdleStream().get();
+    EXPECT_EQ(&ovms::selectInferRequestsPoolQueue(pool, shared), &pool);
+    shared.returnStream(sharedReqid);
+    pool.returnStream(poolReqid);
+}
+
+TEST(OVInferRequestQueue, GrowingHandsNewStreamsToWaiters) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 1, 3);
+    EXPECT_EQ(inferRequestsQueue.getCapacity(), 3);
+    int first = inferRequestsQueue.getIdleStream().get();
+    EXPECT_EQ(first, 0);
+    std::atomic<int> waiterStream{-2};
+    inferRequestsQueue.getIdleStream([&waiterStream](int streamID) { waiterStream = streamID; });
+    EXPECT_EQ(waiterStream, -2);
+    ASSERT_TRUE(inferRequestsQueue.resize(3));
+    EXPECT_EQ(inferRequestsQueue.getInferRequestsCount(), 3);
+    EXPECT_EQ(inferRequestsQueue.getStreamsLimit(), 3);
+    EXPECT_EQ(waiterStream, 1);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 1);
+    EXPECT_EQ(inferRequestsQueue.getWaitsCount(), 1);
+    EXPECT_FALSE(inferRequestsQueue.resize(4));
+    EXPECT_FALSE(inferRequestsQueue.resize(0));
+    inferRequestsQueue.returnStream(first);
+    inferRequestsQueue.returnStream(waiterStream);
+}
+
+TEST(OVInferRequestQueue, ShrinkingRetiresStreamsWhenReturned) {
+    InferenceEngine::Core engine;
+    InferenceEngine::CNNNetwork network = engine.ReadNetwork(DUMMY_MODEL_PATH);
+    InferenceEngine::ExecutableNetwork execNetwork = engine.LoadNetwork(network, "CPU");
+    ovms::OVInferRequestsQueue inferRequestsQueue(execNetwork, 3);
+    std::vector<int> streams;
+    for (int i = 0; i < 2; ++i) {
+        streams.push_back(inferRequestsQueue.getIdleStream().get());
+    }
+    // stream 2 is idle and retired right away, stream 1 is in use and keeps its infer request until returned
+    ASSERT_TRUE(inferRequestsQueue.resize(1));
+    EXPECT_EQ(inferRequestsQueue.getInferRequestsCount(), 2);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 0);
+    inferRequestsQueue.getInferRequest(streams[1]).Infer();
+    inferRequestsQueue.returnStream(streams[1]);
+    EXPECT_EQ(inferRequestsQueue.getInferRequestsCount(), 1);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 0);
+    inferRequestsQueue.returnStream(streams[0]);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 1);
+    EXPECT_EQ(inferRequestsQueue.getIdleStream().get(), 0);
+    inferRequestsQueue.returnStream(0);
+
+    // retired streams get new infer requests when the queue grows again
+    ASSERT_TRUE(inferRequestsQueue.resize(3));
+    EXPECT_EQ(inferRequestsQueue.getInferRequestsCount(), 3);
+    EXPECT_EQ(inferRequestsQueue.getIdleStreamsCount(), 3);
+    for (int i = 0; i < 3; ++i) {
+        int streamID = inferRequestsQueue.getIdleStream().get();
+        inferRequestsQueue.getInferRequest(streamID).Infer();
+        streams.push_back(streamID);
+    }
+    for (size_t i = 2; i < streams.size(); ++i) {
+        inferRequestsQueue.returnStream(streams[i]);
+    }
+}
@@ -176,6 +176,18 @@ TEST_F(DISABLED_OvmsConfigTest, negativeUint64Max) {
     EXPECT_EXIT(ovms::Config::instance().parse(arg_count, n_argv), ::testing::ExitedWithCode(EX_USAGE), "rest_port number out of range from 0 to 65535");
 }
 
+TEST_F(DISABLED_OvmsConfigTest, negativeRestUnixSocketWithoutRestPort) {
+    char* n_argv[] = {"ovms", "--config_path", "/path1", "--rest_unix_socket", "/tmp/ovms_rest.sock"};
+    int arg_count = 5;
+    EXPECT_EXIT(ovms::Config::instance().parse(arg_count, n_argv), ::testing::ExitedWithCode(EX_USAGE), "rest_unix_socket is set but rest_port is not set");
+}
+
+TEST_F(DISABLED_OvmsConfigTest, negativeSameUnixSockets) {
+    char* n_argv[] = {"ovms", "--config_path", "/path1", "--rest_port", "8080", "--grpc_unix_socket", "/tmp/ovms.sock", "--rest_unix_socket", "/tmp/ovms.sock"};
+    int arg_count = 9;
+    EXPECT_EXIT(ovms::Config::instance().parse(arg_count, n_argv), ::testing::ExitedWithCode(EX_USAGE), "grpc_unix_socket and rest_unix_socket cannot");
+}
+
 class OvmsParamsTest : public ::testing::Test {
 };
 
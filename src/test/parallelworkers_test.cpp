@@ -0,0 +1,94 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../parallelworkers.hpp"
+
+using ovms::ParallelWorkers;
+
+TEST(ParallelWorkers, EachTaskIsExecutedOnce) {
+    ParallelWorkers workers(3);
+    std::vector<std::atomic<int>> executions(100);
+    workers.run(executions.size(), 4, [&executions](size_t index) { ++executions[index]; });
+    for (const auto& count : executions) {
+        EXPECT_EQ(count, 1);
+    }
+}
+
+TEST(ParallelWorkers, TasksRunOnStartedThreadsUpToParallelism) {
+    ParallelWorkers workers(3);
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    auto task = [&running, &maxRunning](size_t) {
+        int current = ++running;
+        int expected = maxRunning.load();
+        while (current > expected && !maxRunning.compare_exchange_weak(expected, current)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --running;
+    };
+    workers.run(8, 2, task);
+    EXPECT_EQ(maxRunning, 2);
+    // threads are reused by consecutive requests
+    std::set<std::thread::id> threadIds;
+    std::mutex mtx;
+    for (int i = 0; i < 3; ++i) {
+        workers.run(8, 4, [&threadIds, &mtx](size_t) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            std::lock_guard<std::mutex> lock(mtx);
+            threadIds.insert(std::this_thread::get_id());
+        });
+    }
+    EXPECT_LE(threadIds.size(), 4);
+}
+
+TEST(ParallelWorkers, RequestingThreadProgressesWithoutWorkers) {
+    ParallelWorkers workers(0);
+    const auto requestingThread = std::this_thread::get_id();
+    size_t executed = 0;
+    workers.run(5, 4, [&executed, requestingThread](size_t) {
+        EXPECT_EQ(std::this_thread::get_id(), requestingThread);
+        ++executed;
+    });
+    EXPECT_EQ(executed, 5);
+}
+
+TEST(ParallelWorkers, ConcurrentRequestsShareWorkers) {
+    ParallelWorkers workers(2);
+    std::atomic<size_t> executed{0};
+    std::vector<std::thread> requests;
+    for (int i = 0; i < 4; ++i) {
+        requests.emplace_back([&workers, &executed]() {
+            std::atomic<size_t> requestExecuted{0};
+            workers.run(50, 3, [&executed, &requestExecuted](size_t) {
+                ++executed;
+                ++requestExecuted;
+            });
+            EXPECT_EQ(requestExecuted, 50);
+        });
+    }
+    for (auto& request : requests) {
+        request.join();
+    }
+    EXPECT_EQ(executed, 200);
+}
@@ -0,0 +1,242 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+// Microbenchmarks of the DAG executor, run with: bazel run -c opt //src:ovms_benchmark
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <inference_engine.hpp>
+#include <spdlog/spdlog.h>
+
+#include "../entry_node.hpp"
+#include "../exit_node.hpp"
+#include "../pipeline.hpp"
+#include "../pipeline_factory.hpp"
+#include "../pipelinedefinition.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+using namespace tensorflow::serving;
+
+namespace {
+const std::string BLOB_NAME = "blob";
+
+// Forwards its inputs without any work, what remains is orchestration cost of the pipeline
+class PassthroughNode : public Node {
+public:
+    PassthroughNode(const std::string& name) :
+        Node(name) {}
+    Status execute(MpscQueue<std::reference_wrapper<Node>>& notifyEndQueue) override {
+        notifyEndQueue.push(*this);
+        return StatusCode::OK;
+    }
+    Status fetchResults(BlobMap& outputs) override {
+        outputs = this->inputBlobs;
+        return StatusCode::OK;
+    }
+};
+
+InferenceEngine::Blob::Ptr createBlob() {
+    InferenceEngine::TensorDesc desc{InferenceEngine::Precision::FP32, {1, DUMMY_MODEL_INPUT_SIZE}, InferenceEngine::Layout::NC};
+    auto blob = InferenceEngine::make_shared_blob<float>(desc);
+    blob->allocate();
+    return blob;
+}
+
+/**
+ * @brief Builds entry -> width x (depth x passthrough) -> exit graph the way pipeline definition does
+ */
+std::unique_ptr<Pipeline> createPassthroughPipeline(const BlobMap* inputs, BlobMap* outputs, size_t depth, size_t width) {
+    auto entry = std::make_unique<EntryNode>(inputs);
+    auto exit = std::make_unique<ExitNode>(outputs);
+    auto pipeline = std::make_unique<Pipeline>(*entry, *exit);
+    pipeline->reserve(depth * width + 2);
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (size_t branch = 0; branch < width; ++branch) {
+        Node* previous = entry.get();
+        for (size_t level = 0; level < depth; ++level) {
+            auto node = std::make_unique<PassthroughNode>("node_" + std::to_string(branch) + "_" + std::to_string(level));
+            Pipeline::connect(*previous, *node, {{level == 0 ? BLOB_NAME : BLOB_NAME + std::to_string(branch), BLOB_NAME + std::to_string(branch)}});
+            previous = node.get();
+            nodes.emplace_back(std::move(node));
+        }
+        Pipeline::connect(*previous, *exit, {{BLOB_NAME + std::to_string(branch), BLOB_NAME + std::to_string(branch)}});
+    }
+    pipeline->push(std::move(entry));
+    for (auto& node : nodes) {
+        pipeline->push(std::move(node));
+    }
+    pipeline->push(std::move(exit));
+    return pipeline;
+}
+
+void setPerNodeCounter(benchmark::State& state, size_t nodesCount) {
+    state.counters["per_node"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * nodesCount),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+/**
+ * @brief Model manager with dummy model and a definition of dummy models chain, shared by benchmark threads
+ */
+class DummyPipelineEnvironment {
+public:
+    ConstructorEnabledModelManager manager;
+    PipelineFactory factory;
+    const std::string pipelineName = "dummy_chain";
+
+    DummyPipelineEnvironment(size_t nireq, size_t depth) {
+        ModelConfig config = DUMMY_MODEL_CONFIG;
+        config.setNireq(nireq);
+        if (!manager.reloadModelWithVersions(config).ok()) {
+            throw std::runtime_error("failed to load dummy model");
+        }
+        std::vector<NodeInfo> info{
+            {NodeKind::ENTRY, ENTRY_NODE_NAME, "", std::nullopt, {{BLOB_NAME, BLOB_NAME}}},
+            {NodeKind::EXIT, EXIT_NODE_NAME},
+        };
+        pipeline_connections_t connections;
+        std::string previous = ENTRY_NODE_NAME;
+        std::string previousOutput = BLOB_NAME;
+        for (size_t i = 0; i < depth; ++i) {
+            std::string nodeName = "dummy_node_" + std::to_string(i);
+            info.emplace_back(NodeKind::DL, nodeName, "dummy", std::nullopt, std::unordered_map<std::string, std::string>{{DUMMY_MODEL_OUTPUT_NAME, DUMMY_MODEL_OUTPUT_NAME}});
+            connections[nodeName] = {{previous, {{previousOutput, DUMMY_MODEL_INPUT_NAME}}}};
+            previous = nodeName;
+            previousOutput = DUMMY_MODEL_OUTPUT_NAME;
+        }
+        connections[EXIT_NODE_NAME] = {{previous, {{previousOutput, BLOB_NAME}}}};
+        if (!factory.createDefinition(pipelineName, info, connections, manager).ok()) {
+            throw std::runtime_error("failed to create dummy pipeline definition");
+        }
+    }
+
+    static DummyPipelineEnvironment& get(size_t nireq, size_t depth) {
+        static std::mutex mutex;
+        static std::map<std::pair<size_t, size_t>, std::unique_ptr<DummyPipelineEnvironment>> environments;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& environment = environments[{nireq, depth}];
+        if (!environment) {
+            environment = std::make_unique<DummyPipelineEnvironment>(nireq, depth);
+        }
+        return *environment;
+    }
+};
+
+PredictRequest prepareDummyRequest() {
+    return preparePredictRequest({{BLOB_NAME, {{1, DUMMY_MODEL_INPUT_SIZE}, tensorflow::DataType::DT_FLOAT}}});
+}
+}  // namespace
+
+// Graph built per request, args: chain depth, number of parallel branches
+static void BM_PassthroughPipelineBuildAndExecute(benchmark::State& state) {
+    const size_t depth = state.range(0);
+    const size_t width = state.range(1);
+    BlobMap inputs{{BLOB_NAME, createBlob()}};
+    for (auto _ : state) {
+        BlobMap outputs;
+        auto pipeline = createPassthroughPipeline(&inputs, &outputs, depth, width);
+        auto status = pipeline->execute();
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(outputs);
+    }
+    setPerNodeCounter(state, depth * width + 2);
+}
+BENCHMARK(BM_PassthroughPipelineBuildAndExecute)->Args({1, 1})->Args({8, 1})->Args({32, 1})->Args({128, 1})->Args({1, 8})->Args({1, 32})->Args({4, 8});
+
+// Same graphs with construction excluded, isolates Pipeline::execute orchestration
+static void BM_PassthroughPipelineExecute(benchmark::State& state) {
+    const size_t depth = state.range(0);
+    const size_t width = state.range(1);
+    BlobMap inputs{{BLOB_NAME, createBlob()}};
+    for (auto _ : state) {
+        state.PauseTiming();
+        BlobMap outputs;
+        auto pipeline = createPassthroughPipeline(&inputs, &outputs, depth, width);
+        state.ResumeTiming();
+        auto status = pipeline->execute();
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+        state.PauseTiming();
+        pipeline.reset();
+        state.ResumeTiming();
+    }
+    setPerNodeCounter(state, depth * width + 2);
+}
+BENCHMARK(BM_PassthroughPipelineExecute)->Args({8, 1})->Args({128, 1})->Args({1, 32})->Args({4, 8});
+
+// PipelineDefinition::create with graph pool, without executing, arg: number of dummy model nodes
+static void BM_PipelineDefinitionCreate(benchmark::State& state) {
+    auto& environment = DummyPipelineEnvironment::get(1, state.range(0));
+    auto definition = environment.factory.findDefinitionByName(environment.pipelineName);
+    PredictRequest request = prepareDummyRequest();
+    PredictResponse response;
+    for (auto _ : state) {
+        std::unique_ptr<Pipeline> pipeline;
+        auto status = definition->create(pipeline, &request, &response, environment.manager);
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(pipeline);
+    }
+}
+BENCHMARK(BM_PipelineDefinitionCreate)->Arg(1)->Arg(8)->Arg(32);
+
+// Requests executed concurrently by benchmark threads, args: nireq of dummy model, number of dummy model nodes
+static void BM_DummyPipelineConcurrentExecute(benchmark::State& state) {
+    auto& environment = DummyPipelineEnvironment::get(state.range(0), state.range(1));
+    PredictRequest request = prepareDummyRequest();
+    for (auto _ : state) {
+        PredictResponse response;
+        std::unique_ptr<Pipeline> pipeline;
+        auto status = environment.factory.create(pipeline, environment.pipelineName, &request, &response, environment.manager);
+        if (status.ok()) {
+            status = pipeline->execute();
+        }
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DummyPipelineConcurrentExecute)
+    ->Args({1, 4})
+    ->Args({4, 4})
+    ->Args({16, 4})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::err);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,141 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../pipelineadmission.hpp"
+
+using ovms::deadlineAfter;
+using ovms::PipelineAdmission;
+using ovms::Status;
+using ovms::StatusCode;
+
+TEST(PipelineAdmission, UnlimitedAdmitsEveryPipeline) {
+    PipelineAdmission admission;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(admission.acquire(), StatusCode::OK);
+    }
+    EXPECT_EQ(admission.getAdmittedCount(), 10);
+    EXPECT_EQ(admission.getWaitingCount(), 0);
+}
+
+TEST(PipelineAdmission, PipelineOverLimitWaitsForReleasedSlot) {
+    PipelineAdmission admission;
+    admission.setLimit(1);
+    ASSERT_EQ(admission.acquire(), StatusCode::OK);
+    bool admitted = false;
+    admission.acquireAsync([&admitted](Status) { admitted = true; });
+    EXPECT_FALSE(admitted);
+    EXPECT_EQ(admission.getWaitingCount(), 1);
+    admission.release();
+    EXPECT_TRUE(admitted);
+    EXPECT_EQ(admission.getAdmittedCount(), 1);
+    EXPECT_EQ(admission.getWaitingCount(), 0);
+}
+
+TEST(PipelineAdmission, BlockedWaiterGivesUpAtDeadline) {
+    PipelineAdmission admission;
+    admission.setLimit(1);
+    ASSERT_EQ(admission.acquire(), StatusCode::OK);
+    EXPECT_EQ(admission.acquire(deadlineAfter(std::chrono::milliseconds(10))), StatusCode::DEADLINE_EXCEEDED);
+    EXPECT_EQ(admission.getWaitingCount(), 0);
+    // slot is not handed over to the waiter which gave up
+    bool admitted = false;
+    admission.acquireAsync([&admitted](Status) { admitted = true; });
+    admission.release();
+    EXPECT_TRUE(admitted);
+    EXPECT_EQ(admission.getAdmittedCount(), 1);
+}
+
+TEST(PipelineAdmission, BlockedWaiterIsAdmittedByOtherThread) {
+    PipelineAdmission admission;
+    admission.setLimit(1);
+    ASSERT_EQ(admission.acquire(), StatusCode::OK);
+    std::thread releaser([&admission]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        admission.release();
+    });
+    EXPECT_EQ(admission.acquire(), StatusCode::OK);
+    releaser.join();
+    EXPECT_EQ(admission.getAdmittedCount(), 1);
+}
+
+TEST(PipelineAdmission, RaisedLimitAdmitsWaiters) {
+    PipelineAdmission admission;
+    admission.setLimit(1);
+    ASSERT_EQ(admission.acquire(), StatusCode::OK);
+    int admittedCount = 0;
+    admission.acquireAsync([&admittedCount](Status) { admittedCount++; });
+    admission.acquireAsync([&admittedCount](Status) { admittedCount++; });
+    EXPECT_EQ(admittedCount, 0);
+    admission.setLimit(2);
+    EXPECT_EQ(admittedCount, 1);
+    admission.setLimit(0);
+    EXPECT_EQ(admittedCount, 2);
+    EXPECT_EQ(admission.getAdmittedCount(), 3);
+}
+
+TEST(PipelineAdmission, AsyncWaiterFailsAtDeadline) {
+    PipelineAdmission admission;
+    admission.setLimit(1);
+    ASSERT_EQ(admission.acquire(), StatusCode::OK);
+    std::promise<Status> expired;
+    const auto start = std::chrono::steady_clock::now();
+    admission.acquireAsync([&expired](Status status) { expired.set_value(status); }, deadlineAfter(std::chrono::milliseconds(20)));
+    auto future = expired.get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(future.get(), StatusCode::DEADLINE_EXCEEDED);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(admission.getWaitingCount(), 0);
+    // slot is not handed over to the waiter which gave up
+    Status admittedStatus = StatusCode::DEADLINE_EXCEEDED;
+    admission.acquireAsync([&admittedStatus](Status status) { admittedStatus = status; }, deadlineAfter(std::chrono::seconds(5)));
+    admission.release();
+    EXPECT_EQ(admittedStatus, StatusCode::OK);
+    EXPECT_EQ(admission.getAdmittedCount(), 1);
+}
+
+TEST(PipelineAdmission, AdmittedAsyncWaiterIsCalledOnce) {
+    PipelineAdmission admission;
+    admission.setLimit(1);
+    ASSERT_EQ(admission.acquire(), StatusCode::OK);
+    std::atomic<int> calls{0};
+    admission.acquireAsync([&calls](Status status) {
+        EXPECT_EQ(status, StatusCode::OK);
+        calls++;
+    },
+        deadlineAfter(std::chrono::milliseconds(10)));
+    admission.release();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(admission.getAdmittedCount(), 1);
+}
+
+TEST(PipelineAdmission, DestroyedAdmissionDropsWaiterDeadlines) {
+    std::atomic<int> calls{0};
+    {
+        PipelineAdmission admission;
+        admission.setLimit(1);
+        ASSERT_EQ(admission.acquire(), StatusCode::OK);
+        admission.acquireAsync([&calls](Status) { calls++; }, deadlineAfter(std::chrono::milliseconds(10)));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(calls, 0);
+}
@@ -0,0 +1,91 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <memory>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "../pipelinegraphpool.hpp"
+
+using ovms::BlobMap;
+using ovms::Node;
+using ovms::pipeline_nodes_t;
+using ovms::PipelineGraphPool;
+using ovms::MpscQueue;
+using ovms::Status;
+using ovms::StatusCode;
+
+namespace {
+class DummyNode : public Node {
+public:
+    DummyNode() :
+        Node("dummy") {}
+    Status execute(MpscQueue<std::reference_wrapper<Node>>&) override { return StatusCode::OK; }
+    Status fetchResults(BlobMap&) override { return StatusCode::OK; }
+};
+
+pipeline_nodes_t createGraph() {
+    pipeline_nodes_t nodes;
+    nodes.emplace_back(std::make_unique<DummyNode>());
+    return nodes;
+}
+}  // namespace
+
+TEST(PipelineGraphPool, EmptyPoolGivesNoGraph) {
+    auto pool = std::make_shared<PipelineGraphPool>(2);
+    pipeline_nodes_t nodes;
+    EXPECT_FALSE(pool->tryAcquire(nodes));
+    EXPECT_TRUE(nodes.empty());
+}
+
+TEST(PipelineGraphPool, RecycledGraphIsReused) {
+    auto pool = std::make_shared<PipelineGraphPool>(2);
+    auto nodes = createGraph();
+    auto node = nodes[0].get();
+    pool->getRecycler()(std::move(nodes));
+    ASSERT_EQ(pool->getIdleGraphsCount(), 1);
+    pipeline_nodes_t reused;
+    ASSERT_TRUE(pool->tryAcquire(reused));
+    ASSERT_EQ(reused.size(), 1);
+    EXPECT_EQ(reused[0].get(), node);
+    EXPECT_EQ(pool->getIdleGraphsCount(), 0);
+}
+
+TEST(PipelineGraphPool, IdleGraphsAreLimited) {
+    auto pool = std::make_shared<PipelineGraphPool>(1);
+    pool->getRecycler()(createGraph());
+    pool->getRecycler()(createGraph());
+    EXPECT_EQ(pool->getIdleGraphsCount(), 1);
+}
+
+TEST(PipelineGraphPool, GraphsBuiltBeforeInvalidationAreDropped) {
+    auto pool = std::make_shared<PipelineGraphPool>(2);
+    pool->getRecycler()(createGraph());
+    auto outdatedRecycler = pool->getRecycler();
+    pool->invalidate();
+    EXPECT_EQ(pool->getIdleGraphsCount(), 0);
+    outdatedRecycler(createGraph());
+    EXPECT_EQ(pool->getIdleGraphsCount(), 0);
+    pool->getRecycler()(createGraph());
+    EXPECT_EQ(pool->getIdleGraphsCount(), 1);
+}
+
+TEST(PipelineGraphPool, GraphCanBeReturnedAfterPoolIsDestroyed) {
+    auto pool = std::make_shared<PipelineGraphPool>(2);
+    auto recycler = pool->getRecycler();
+    pool.reset();
+    recycler(createGraph());
+}
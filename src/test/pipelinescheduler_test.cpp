@@ -0,0 +1,80 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../pipelinescheduler.hpp"
+
+using ovms::PipelineScheduler;
+
+TEST(PipelineScheduler, ExecutesScheduledTasks) {
+    std::atomic<int> executedCount{0};
+    {
+        PipelineScheduler scheduler(2);
+        EXPECT_EQ(scheduler.getWorkersCount(), 2);
+        for (int i = 0; i < 100; i++) {
+            scheduler.schedule([&executedCount]() { executedCount++; });
+        }
+    }
+    EXPECT_EQ(executedCount, 100);
+}
+
+TEST(PipelineScheduler, AtLeastOneWorkerIsStarted) {
+    PipelineScheduler scheduler(0);
+    EXPECT_EQ(scheduler.getWorkersCount(), 1);
+    std::promise<void> executed;
+    scheduler.schedule([&executed]() { executed.set_value(); });
+    EXPECT_EQ(executed.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+TEST(PipelineScheduler, TasksScheduledFromWorkerAreExecuted) {
+    std::atomic<int> executedCount{0};
+    {
+        PipelineScheduler scheduler(4);
+        std::function<void(int)> spawn = [&](int depth) {
+            executedCount++;
+            if (depth == 0) {
+                return;
+            }
+            scheduler.schedule([&spawn, depth]() { spawn(depth - 1); });
+            scheduler.schedule([&spawn, depth]() { spawn(depth - 1); });
+        };
+        scheduler.schedule([&spawn]() { spawn(10); });
+        while (executedCount < (1 << 11) - 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    EXPECT_EQ(executedCount, (1 << 11) - 1);
+}
+
+TEST(PipelineScheduler, IdleWorkersStealBlockedWorkerTasks) {
+    PipelineScheduler scheduler(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> stolenExecuted;
+    scheduler.schedule([&scheduler, released, &stolenExecuted]() {
+        // scheduled to the queue of the current worker, which is blocked until the task is done elsewhere
+        scheduler.schedule([&stolenExecuted]() { stolenExecuted.set_value(); });
+        released.wait();
+    });
+    EXPECT_EQ(stolenExecuted.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    release.set_value();
+}
@@ -425,6 +425,129 @@ TEST_F(PredictValidation, RequestIncorrectValueCountShapeAuto) {
     EXPECT_EQ(status, ovms::StatusCode::INVALID_VALUE_COUNT);
 }
 
+TEST_F(PredictValidation, RequestPackedU16TensorContent) {
+    auto& input = (*request.mutable_inputs())["Input_U16_1_2_8_4_NCHW"];
+    input.mutable_int_val()->Clear();
+    *input.mutable_tensor_content() = std::string(1 * 2 * 8 * 4 * sizeof(uint16_t), '1');
+
+    auto status = instance.validate(&request);
+    EXPECT_TRUE(status.ok());
+}
+
+TEST_F(PredictValidation, RequestIncorrectPackedU16ContentSize) {
+    auto& input = (*request.mutable_inputs())["Input_U16_1_2_8_4_NCHW"];
+    input.mutable_int_val()->Clear();
+    *input.mutable_tensor_content() = std::string(1 * 2 * 8 * 4, '1');
+
+    auto status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_CONTENT_SIZE);
+}
+
+TEST_F(PredictValidation, RequestFp32ForU8InputWithConversionEnabled) {
+    modelConfig.setInputConversions({{"Input_U8_1_3_62_62_NCHW", "FP32"}});
+    auto& input = (*request.mutable_inputs())["Input_U8_1_3_62_62_NCHW"];
+    input.set_dtype(tensorflow::DataType::DT_FLOAT);
+    *input.mutable_tensor_content() = std::string(1 * 3 * 62 * 62 * sizeof(float), '1');
+
+    auto status = instance.validate(&request);
+    EXPECT_TRUE(status.ok());
+
+    *input.mutable_tensor_content() = std::string(1 * 3 * 62 * 62, '1');
+    status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_CONTENT_SIZE);
+}
+
+TEST_F(PredictValidation, RequestFp32ForU8InputWithConversionDisabled) {
+    auto& input = (*request.mutable_inputs())["Input_U8_1_3_62_62_NCHW"];
+    input.set_dtype(tensorflow::DataType::DT_FLOAT);
+    *input.mutable_tensor_content() = std::string(1 * 3 * 62 * 62 * sizeof(float), '1');
+
+    auto status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_PRECISION);
+}
+
+TEST_F(PredictValidation, RequestI64Values) {
+    auto& input = (*request.mutable_inputs())["Input_I64_1_6_128_128_16_NCDHW"];
+    input.clear_tensor_content();
+    input.mutable_int64_val()->Resize(1 * 6 * 128 * 128 * 16, 1);
+
+    auto status = instance.validate(&request);
+    EXPECT_TRUE(status.ok());
+
+    input.mutable_int64_val()->Resize(2, 1);
+    status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_VALUE_COUNT);
+}
+
+TEST_F(PredictValidation, RequestOutputFilterWithUnknownOutput) {
+    request.add_output_filter("unknown_output");
+    auto status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_MISSING_OUTPUT);
+}
+
+TEST_F(PredictValidation, RequestSharedMemoryInputInUnknownRegion) {
+    auto& input = (*request.mutable_inputs())["Input_U8_1_3_62_62_NCHW"];
+    input.clear_tensor_content();
+    input.add_string_val("shm:unknown_region:0:11532");
+    auto status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+}
+
+TEST_F(PredictValidation, RequestFloatValues) {
+    auto& input = (*request.mutable_inputs())["Input_FP32_1_3_224_224_NHWC"];
+    input.clear_tensor_content();
+    input.mutable_float_val()->Resize(1 * 3 * 224 * 224, 1.0f);
+
+    auto status = instance.validate(&request);
+    EXPECT_TRUE(status.ok());
+
+    input.mutable_float_val()->Resize(2, 1.0f);
+    status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_VALUE_COUNT);
+}
+
+TEST_F(PredictValidation, RequestIntValuesForU8Input) {
+    auto& input = (*request.mutable_inputs())["Input_U8_1_3_62_62_NCHW"];
+    input.clear_tensor_content();
+    input.mutable_int_val()->Resize(1 * 3 * 62 * 62, 1);
+
+    auto status = instance.validate(&request);
+    EXPECT_TRUE(status.ok());
+
+    input.mutable_int_val()->Resize(3, 1);
+    status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_VALUE_COUNT);
+}
+
+TEST_F(PredictValidation, RequestI64ForI32InputWithConversionEnabled) {
+    networkInputs["Input_I64_1_6_128_128_16_NCDHW"]->setPrecision(InferenceEngine::Precision::I32);
+    auto& input = (*request.mutable_inputs())["Input_I64_1_6_128_128_16_NCDHW"];
+
+    auto status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_PRECISION);
+
+    modelConfig.setInputConversions({{"Input_I64_1_6_128_128_16_NCDHW", "I64"}});
+    status = instance.validate(&request);
+    EXPECT_TRUE(status.ok());
+
+    *input.mutable_tensor_content() = std::string(1 * 6 * 128 * 128 * 16 * sizeof(int32_t), '1');
+    status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_CONTENT_SIZE);
+}
+
+TEST_F(PredictValidation, RequestNhwcShapeForTransposedInput) {
+    networkInputs["Input_FP32_1_3_224_224_NHWC"]->setLayoutTransposed(true);
+    auto& input = (*request.mutable_inputs())["Input_FP32_1_3_224_224_NHWC"];
+
+    auto status = instance.validate(&request);
+    EXPECT_EQ(status, ovms::StatusCode::INVALID_SHAPE);
+
+    input.mutable_tensor_shape()->mutable_dim(1)->set_size(224);
+    input.mutable_tensor_shape()->mutable_dim(3)->set_size(3);
+    status = instance.validate(&request);
+    EXPECT_TRUE(status.ok());
+}
+
 TEST_F(PredictValidation, RequestWrongPrecision) {
     auto& input = (*request.mutable_inputs())["Input_FP32_1_3_224_224_NHWC"];
     input.set_dtype(tensorflow::DataType::DT_UINT8);
@@ -13,12 +13,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <future>
+#include <memory>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -27,7 +32,9 @@
 
 #include "../executinstreamidguard.hpp"
 #include "../modelinstance.hpp"
+#include "../pendingrequestguard.hpp"
 #include "../prediction_service_utils.hpp"
+#include "../requesttimings.hpp"
 #include "test_utils.hpp"
 
 using testing::Each;
@@ -479,4 +486,276 @@ TEST_F(TestPredict, ChangeBatchSizeViaRequestAndConfigChange) {
     ASSERT_EQ(performInferenceWithBatchSize(response, 3), StatusCode::OK);
     checkOutputShape(response, {3, 10});
 }
+
+TEST_F(TestPredict, SuccesfullAsyncInferenceOnDummyModel) {
+    config.setNireq(2);
+    ASSERT_EQ(manager.reloadModelWithVersions(config), ovms::StatusCode::OK);
+
+    const int requestsCount = 10;
+    std::vector<tensorflow::serving::PredictRequest> requests(requestsCount);
+    std::vector<tensorflow::serving::PredictResponse> responses(requestsCount);
+    std::vector<std::promise<ovms::Status>> results(requestsCount);
+    for (int i = 0; i < requestsCount; ++i) {
+        requests[i] = preparePredictRequest(
+            {{DUMMY_MODEL_INPUT_NAME,
+                std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+        std::shared_ptr<ovms::ModelInstance> modelInstance;
+        std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+        ASSERT_EQ(ovms::getModelInstance(manager, config.getName(), 0, modelInstance, unloadGuard), ovms::StatusCode::OK);
+        // more requests than infer requests, some of them have to wait for idle stream without blocking
+        ovms::inferenceAsync(modelInstance, &requests[i], &responses[i], std::move(unloadGuard),
+            [&results, i](ovms::Status status) { results[i].set_value(status); });
+    }
+    for (int i = 0; i < requestsCount; ++i) {
+        EXPECT_EQ(results[i].get_future().get(), ovms::StatusCode::OK);
+        checkOutputShape(responses[i], {1, 10});
+    }
+}
+
+TEST_F(TestPredict, AsyncInferenceReportsValidationError) {
+    ASSERT_EQ(manager.reloadModelWithVersions(config), ovms::StatusCode::OK);
+
+    tensorflow::serving::PredictRequest request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_INT32}}});
+    tensorflow::serving::PredictResponse response;
+    std::shared_ptr<ovms::ModelInstance> modelInstance;
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    ASSERT_EQ(ovms::getModelInstance(manager, config.getName(), 0, modelInstance, unloadGuard), ovms::StatusCode::OK);
+    std::promise<ovms::Status> result;
+    ovms::inferenceAsync(modelInstance, &request, &response, std::move(unloadGuard),
+        [&result](ovms::Status status) { result.set_value(status); });
+    EXPECT_EQ(result.get_future().get(), ovms::StatusCode::INVALID_PRECISION);
+}
+
+TEST_F(TestPredict, InferenceStagesAreRecordedIntoRequestTimings) {
+    ASSERT_EQ(manager.reloadModelWithVersions(config), ovms::StatusCode::OK);
+
+    tensorflow::serving::PredictRequest request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+    for (bool async : {false, true}) {
+        tensorflow::serving::PredictResponse response;
+        std::shared_ptr<ovms::ModelInstance> modelInstance;
+        std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+        ASSERT_EQ(ovms::getModelInstance(manager, config.getName(), 0, modelInstance, unloadGuard), ovms::StatusCode::OK);
+        ovms::RequestTimings timings;
+        {
+            ovms::RequestTimingsScope timingsScope(&timings);
+            if (async) {
+                std::promise<ovms::Status> result;
+                ovms::inferenceAsync(modelInstance, &request, &response, std::move(unloadGuard),
+                    [&result](ovms::Status status) { result.set_value(status); });
+                ASSERT_EQ(result.get_future().get(), ovms::StatusCode::OK);
+            } else {
+                ASSERT_EQ(ovms::inference(*modelInstance, &request, &response, unloadGuard), ovms::StatusCode::OK);
+            }
+        }
+        for (auto stage : {ovms::RequestTimingStage::VALIDATION, ovms::RequestTimingStage::STREAM_WAIT, ovms::RequestTimingStage::DESERIALIZATION,
+                 ovms::RequestTimingStage::INFERENCE, ovms::RequestTimingStage::SERIALIZATION}) {
+            EXPECT_TRUE(timings.isRecorded(stage)) << ovms::toString(stage) << " async: " << async;
+        }
+        EXPECT_FALSE(timings.isRecorded(ovms::RequestTimingStage::RELOAD_WAIT));
+        EXPECT_GT(timings.get(ovms::RequestTimingStage::INFERENCE), 0);
+    }
+}
+
+TEST_F(TestPredict, ExpiredRequestIsDroppedBeforeInference) {
+    ASSERT_EQ(manager.reloadModelWithVersions(config), ovms::StatusCode::OK);
+
+    tensorflow::serving::PredictRequest request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+    tensorflow::serving::PredictResponse response;
+    std::shared_ptr<ovms::ModelInstance> modelInstance;
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    ASSERT_EQ(ovms::getModelInstance(manager, config.getName(), 0, modelInstance, unloadGuard), ovms::StatusCode::OK);
+    const ovms::deadline_t passedDeadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+    EXPECT_EQ(ovms::inference(*modelInstance, &request, &response, unloadGuard, passedDeadline), ovms::StatusCode::DEADLINE_EXCEEDED);
+    EXPECT_EQ(response.outputs_size(), 0);
+
+    std::promise<ovms::Status> result;
+    ovms::inferenceAsync(
+        modelInstance, &request, &response, std::move(unloadGuard),
+        [&result](ovms::Status status) { result.set_value(status); }, passedDeadline);
+    EXPECT_EQ(result.get_future().get(), ovms::StatusCode::DEADLINE_EXCEEDED);
+}
+
+TEST_F(TestPredict, RequestsAbovePendingLimitAreRejected) {
+    config.setMaxPendingRequests(1);
+    ASSERT_EQ(manager.reloadModelWithVersions(config), ovms::StatusCode::OK);
+
+    tensorflow::serving::PredictRequest request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<ovms::shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+    tensorflow::serving::PredictResponse response;
+    std::shared_ptr<ovms::ModelInstance> modelInstance;
+    std::unique_ptr<ovms::ModelInstanceUnloadGuard> unloadGuard;
+    ASSERT_EQ(ovms::getModelInstance(manager, config.getName(), 0, modelInstance, unloadGuard), ovms::StatusCode::OK);
+    {
+        // occupy the only pending request slot
+        ovms::PendingRequestGuard pendingRequestGuard(*modelInstance);
+        ASSERT_TRUE(pendingRequestGuard.isAdmitted());
+        EXPECT_EQ(modelInstance->getPendingRequestsCount(), 1);
+        EXPECT_EQ(ovms::inference(*modelInstance, &request, &response, unloadGuard), ovms::StatusCode::TOO_MANY_PENDING_REQUESTS);
+        EXPECT_EQ(modelInstance->getPendingRequestsCount(), 1);
+
+        std::promise<ovms::Status> result;
+        std::unique_ptr<ovms::ModelInstanceUnloadGuard> asyncUnloadGuard;
+        ASSERT_EQ(ovms::getModelInstance(manager, config.getName(), 0, modelInstance, asyncUnloadGuard), ovms::StatusCode::OK);
+        ovms::inferenceAsync(
+            modelInstance, &request, &response, std::move(asyncUnloadGuard),
+            [&result](ovms::Status status) { result.set_value(status); });
+        EXPECT_EQ(result.get_future().get(), ovms::StatusCode::TOO_MANY_PENDING_REQUESTS);
+    }
+    EXPECT_EQ(modelInstance->getPendingRequestsCount(), 0);
+    EXPECT_EQ(ovms::inference(*modelInstance, &request, &response, unloadGuard), ovms::StatusCode::OK);
+    EXPECT_EQ(modelInstance->getPendingRequestsCount(), 0);
+}
+
+TEST_F(TestPredict, ShapeCacheServesOtherBatchSizesWithoutReload) {
+    using namespace ovms;
+    ModelConfig config = DUMMY_MODEL_CONFIG;
+    config.setBatchingParams("auto");
+    config.setShapeCacheSize(1);
+    ASSERT_EQ(manager.reloadModelWithVersions(config), StatusCode::OK);
+    auto modelInstance = manager.findModelByName("dummy")->getDefaultModelInstance();
+    ASSERT_EQ(modelInstance->getBatchSize(), 1);
+
+    tensorflow::serving::PredictResponse response;
+    ASSERT_EQ(performInferenceWithBatchSize(response, 3), StatusCode::OK);
+    checkOutputShape(response, {3, 10});
+    // loaded network is not reloaded, batch size 3 is served by cached network
+    EXPECT_EQ(modelInstance->getBatchSize(), 1);
+
+    ASSERT_EQ(performInferenceWithBatchSize(response, 1), StatusCode::OK);
+    checkOutputShape(response, {1, 10});
+
+    // evicts batch size 3 variant
+    ASSERT_EQ(performInferenceWithBatchSize(response, 5), StatusCode::OK);
+    checkOutputShape(response, {5, 10});
+    ASSERT_EQ(performInferenceWithBatchSize(response, 3), StatusCode::OK);
+    checkOutputShape(response, {3, 10});
+    EXPECT_EQ(modelInstance->getBatchSize(), 1);
+}
+
+TEST_F(TestPredict, ShapeCacheServesOtherShapesWithoutReload) {
+    using namespace ovms;
+    ModelConfig config = DUMMY_MODEL_CONFIG;
+    config.parseShapeParameter("auto");
+    config.setShapeCacheSize(2);
+    ASSERT_EQ(manager.reloadModelWithVersions(config), StatusCode::OK);
+    auto modelInstance = manager.findModelByName("dummy")->getDefaultModelInstance();
+
+    tensorflow::serving::PredictResponse response;
+    ASSERT_EQ(performInferenceWithShape(response, {1, 8}), StatusCode::OK);
+    checkOutputShape(response, {1, 8});
+    ASSERT_EQ(performInferenceWithShape(response, {2, 4}), StatusCode::OK);
+    checkOutputShape(response, {2, 4});
+    EXPECT_EQ(modelInstance->getInputsInfo().at(DUMMY_MODEL_INPUT_NAME)->getShape(), shape_t({1, 10}));
+}
+
+TEST_F(TestPredict, BatchSizeChangeDoesNotReloadTwiceForTheSameBatchSize) {
+    using namespace ovms;
+    ModelConfig config = DUMMY_MODEL_CONFIG;
+    config.setBatchingParams("auto");
+    ASSERT_EQ(manager.reloadModelWithVersions(config), StatusCode::OK);
+    auto modelInstance = manager.findModelByName("dummy")->getDefaultModelInstance();
+
+    tensorflow::serving::PredictResponse response;
+    ASSERT_EQ(performInferenceWithBatchSize(response, 3), StatusCode::OK);
+    checkOutputShape(response, {3, 10});
+    ASSERT_EQ(modelInstance->getBatchSize(), 3);
+
+    // request which was waiting for network compiled by another one finds the model already reloaded
+    auto request = preparePredictRequest(
+        {{DUMMY_MODEL_INPUT_NAME,
+            std::tuple<shape_t, tensorflow::DataType>{{3, 10}, tensorflow::DataType::DT_FLOAT}}});
+    auto& inferRequestsQueue = modelInstance->getInferRequestsQueue();
+    std::unique_ptr<ModelInstanceUnloadGuard> unloadGuard = std::make_unique<ModelInstanceUnloadGuard>(*modelInstance);
+    EXPECT_EQ(modelInstance->reloadModelInBackground(&request, StatusCode::BATCHSIZE_CHANGE_REQUIRED, DynamicModelParameter(3),
+                  WAIT_FOR_MODEL_LOADED_TIMEOUT_MS, unloadGuard),
+        StatusCode::OK);
+    EXPECT_NE(unloadGuard, nullptr);
+    EXPECT_EQ(&modelInstance->getInferRequestsQueue(), &inferRequestsQueue);
+}
+
+class CompileBlockingModelInstance : public ovms::ModelInstance {
+public:
+    CompileBlockingModelInstance(const std::string& name, ovms::model_version_t version, std::shared_future<void> compileAllowed, std::promise<void>* compileStarted) :
+        ModelInstance(name, version),
+        compileAllowed(std::move(compileAllowed)),
+        compileStarted(compileStarted) {}
+
+protected:
+    void loadExecutableNetworkPtr(const ovms::plugin_config_t& pluginConfig) override {
+        if (!started) {
+            started = true;
+            compileStarted->set_value();
+        }
+        compileAllowed.wait();
+        ModelInstance::loadExecutableNetworkPtr(pluginConfig);
+    }
+
+private:
+    std::shared_future<void> compileAllowed;
+    std::promise<void>* compileStarted;
+    bool started = false;
+};
+
+class StagingModelInstance : public ovms::ModelInstance {
+public:
+    StagingModelInstance(std::shared_future<void> compileAllowed, std::promise<void>* compileStarted) :
+        ModelInstance("dummy", 1),
+        compileAllowed(std::move(compileAllowed)),
+        compileStarted(compileStarted) {}
+
+protected:
+    std::shared_ptr<ovms::ModelInstance> createShapeVariant() const override {
+        return std::make_shared<CompileBlockingModelInstance>(getName(), getVersion(), compileAllowed, compileStarted);
+    }
+
+private:
+    std::shared_future<void> compileAllowed;
+    std::promise<void>* compileStarted;
+};
+
+TEST_F(TestPredict, CurrentBatchSizeIsServedWhileNewOneIsCompiled) {
+    using namespace ovms;
+    ModelConfig config = DUMMY_MODEL_CONFIG;
+    config.setBatchingParams("auto");
+    std::promise<void> compileAllowed;
+    std::promise<void> compileStarted;
+    StagingModelInstance modelInstance(compileAllowed.get_future().share(), &compileStarted);
+    ASSERT_EQ(modelInstance.loadModel(config), StatusCode::OK);
+
+    tensorflow::serving::PredictResponse reloadedResponse;
+    Status reloadedStatus;
+    std::thread reloadingThread([&modelInstance, &reloadedResponse, &reloadedStatus]() {
+        auto request = preparePredictRequest(
+            {{DUMMY_MODEL_INPUT_NAME, std::tuple<shape_t, tensorflow::DataType>{{4, 10}, tensorflow::DataType::DT_FLOAT}}});
+        auto unloadGuard = std::make_unique<ModelInstanceUnloadGuard>(modelInstance);
+        reloadedStatus = inference(modelInstance, &request, &reloadedResponse, unloadGuard);
+    });
+    // request for the current batch size is inferred while compilation for the new one is held
+    const bool compiling = compileStarted.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+    tensorflow::serving::PredictResponse servedResponse;
+    Status servedStatus = StatusCode::UNKNOWN_ERROR;
+    if (compiling) {
+        auto request = preparePredictRequest(
+            {{DUMMY_MODEL_INPUT_NAME, std::tuple<shape_t, tensorflow::DataType>{{1, 10}, tensorflow::DataType::DT_FLOAT}}});
+        auto unloadGuard = std::make_unique<ModelInstanceUnloadGuard>(modelInstance);
+        servedStatus = inference(modelInstance, &request, &servedResponse, unloadGuard);
+    }
+    compileAllowed.set_value();
+    reloadingThread.join();
+
+    ASSERT_TRUE(compiling);
+    EXPECT_EQ(servedStatus, StatusCode::OK);
+    checkOutputShape(servedResponse, {1, 10});
+    EXPECT_EQ(reloadedStatus, StatusCode::OK);
+    checkOutputShape(reloadedResponse, {4, 10});
+    EXPECT_EQ(modelInstance.getBatchSize(), 4);
+}
+
 #pragma GCC diagnostic pop
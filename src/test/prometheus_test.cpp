@@ -0,0 +1,62 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../latencyhistogram.hpp"
+#include "../prometheus.hpp"
+
+using ovms::LatencyHistogram;
+using ovms::PrometheusWriter;
+
+TEST(PrometheusWriter, FamilyHeaderIsWrittenOnce) {
+    PrometheusWriter writer;
+    writer.counter("ovms_requests_total", "Requests", {{"name", "a"}, {"version", "1"}}, 3);
+    writer.counter("ovms_requests_total", "Requests", {{"name", "b"}, {"version", "2"}}, 0);
+    writer.gauge("ovms_streams", "Streams", {}, 4);
+    EXPECT_EQ(writer.getText(),
+        "# HELP ovms_requests_total Requests\n"
+        "# TYPE ovms_requests_total counter\n"
+        "ovms_requests_total{name=\"a\",version=\"1\"} 3\n"
+        "ovms_requests_total{name=\"b\",version=\"2\"} 0\n"
+        "# HELP ovms_streams Streams\n"
+        "# TYPE ovms_streams gauge\n"
+        "ovms_streams 4\n");
+}
+
+TEST(PrometheusWriter, LabelValuesAreEscaped) {
+    EXPECT_EQ(PrometheusWriter::escapeLabelValue("a\"b\\c\nd"), "a\\\"b\\\\c\\nd");
+}
+
+TEST(PrometheusWriter, HistogramBucketsAreCumulativeInSeconds) {
+    LatencyHistogram histogram;
+    histogram.record(50);
+    histogram.record(200);
+    histogram.record(2000);
+    histogram.record(uint64_t(1) << 38);
+    PrometheusWriter writer;
+    writer.histogram("ovms_duration_seconds", "Duration", {{"name", "a"}}, histogram);
+    const auto& text = writer.getText();
+    EXPECT_NE(text.find("# TYPE ovms_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("ovms_duration_seconds_bucket{name=\"a\",le=\"0.0001\"} 1\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("ovms_duration_seconds_bucket{name=\"a\",le=\"0.00025\"} 2\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("ovms_duration_seconds_bucket{name=\"a\",le=\"0.0025\"} 3\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("ovms_duration_seconds_bucket{name=\"a\",le=\"300\"} 3\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("ovms_duration_seconds_bucket{name=\"a\",le=\"+Inf\"} 4\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("ovms_duration_seconds_count{name=\"a\"} 4\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("ovms_duration_seconds_sum{name=\"a\"} 274877.909\n"), std::string::npos) << text;
+}
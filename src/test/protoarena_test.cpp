@@ -0,0 +1,82 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "../protoarena.hpp"
+
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+TEST(ThreadLocalArenaGuard, ShouldReuseThreadArenaBetweenGuards) {
+    google::protobuf::Arena* first = nullptr;
+    {
+        ovms::ThreadLocalArenaGuard guard;
+        auto* response = guard.create<PredictResponse>();
+        EXPECT_EQ(response->GetArena(), guard.get());
+        (*response->mutable_outputs())["output"].mutable_tensor_content()->assign(1024, 'a');
+        first = guard.get();
+    }
+    ovms::ThreadLocalArenaGuard guard;
+    EXPECT_EQ(guard.get(), first);
+    EXPECT_EQ(guard.get()->SpaceUsed(), 0u);
+}
+
+TEST(ThreadLocalArenaGuard, NestedGuardShouldGetOwnArena) {
+    ovms::ThreadLocalArenaGuard outer;
+    auto* request = outer.create<PredictRequest>();
+    request->mutable_model_spec()->set_name("dummy");
+    {
+        ovms::ThreadLocalArenaGuard nested;
+        EXPECT_NE(nested.get(), outer.get());
+    }
+    // nested guard does not reset messages of the outer one
+    EXPECT_EQ(request->model_spec().name(), "dummy");
+}
+
+TEST(ThreadLocalArenaGuard, ThreadsShouldGetSeparateArenas) {
+    ovms::ThreadLocalArenaGuard guard;
+    google::protobuf::Arena* other = nullptr;
+    std::thread([&other]() {
+        ovms::ThreadLocalArenaGuard otherGuard;
+        other = otherGuard.get();
+    }).join();
+    EXPECT_NE(other, guard.get());
+}
+
+TEST(ArenaMessagePtr, ShouldCreateMessageOnArenaOrHeap) {
+    google::protobuf::Arena arena;
+    ovms::ArenaMessagePtr<PredictRequest> onArena(&arena);
+    EXPECT_EQ(onArena->GetArena(), &arena);
+    ovms::ArenaMessagePtr<PredictRequest> onHeap;
+    EXPECT_EQ(onHeap->GetArena(), nullptr);
+}
+
+TEST(ArenaMessagePtr, CopyShouldBeCreatedOnTheSameArena) {
+    google::protobuf::Arena arena;
+    ovms::ArenaMessagePtr<PredictRequest> original(&arena);
+    original->mutable_model_spec()->set_name("dummy");
+    ovms::ArenaMessagePtr<PredictRequest> copy(original);
+    EXPECT_EQ(copy->GetArena(), &arena);
+    EXPECT_NE(copy.get(), original.get());
+    EXPECT_EQ(copy->model_spec().name(), "dummy");
+}
@@ -0,0 +1,69 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../requesttimings.hpp"
+
+using ovms::RequestTimings;
+using ovms::RequestTimingsScope;
+using ovms::RequestTimingStage;
+
+TEST(RequestTimings, OnlyRecordedStagesAreFormatted) {
+    RequestTimings timings;
+    timings.record(RequestTimingStage::VALIDATION, 12);
+    timings.record(RequestTimingStage::INFERENCE, 1000);
+    timings.record(RequestTimingStage::INFERENCE, 250);
+    EXPECT_EQ(timings.get(RequestTimingStage::INFERENCE), 1250);
+    EXPECT_FALSE(timings.isRecorded(RequestTimingStage::RELOAD_WAIT));
+    const std::string header = timings.toServerTiming();
+    EXPECT_EQ(header.rfind("validation;dur=0.012, inference;dur=1.250, total;dur=", 0), 0) << header;
+}
+
+TEST(RequestTimings, ZeroDurationStageIsFormatted) {
+    RequestTimings timings;
+    timings.record(RequestTimingStage::STREAM_WAIT, 0);
+    EXPECT_EQ(timings.toServerTiming().rfind("stream_wait;dur=0.000, total;dur=", 0), 0);
+}
+
+TEST(RequestTimings, RecordsIntoCurrentScopeOnly) {
+    RequestTimings outer;
+    RequestTimings::recordCurrent(RequestTimingStage::SERIALIZATION, 5);
+    {
+        RequestTimingsScope outerScope(&outer);
+        RequestTimings::recordCurrent(RequestTimingStage::SERIALIZATION, 5);
+        {
+            RequestTimingsScope noTimings(nullptr);
+            RequestTimings::recordCurrent(RequestTimingStage::SERIALIZATION, 100);
+        }
+        EXPECT_EQ(RequestTimings::current(), &outer);
+        std::thread([]() {
+            EXPECT_EQ(RequestTimings::current(), nullptr);
+        }).join();
+    }
+    EXPECT_EQ(RequestTimings::current(), nullptr);
+    EXPECT_EQ(outer.get(RequestTimingStage::SERIALIZATION), 5);
+}
+
+TEST(RequestTimings, RequestHeaderValues) {
+    EXPECT_TRUE(ovms::isServerTimingRequested("1"));
+    EXPECT_TRUE(ovms::isServerTimingRequested("true"));
+    EXPECT_FALSE(ovms::isServerTimingRequested(""));
+    EXPECT_FALSE(ovms::isServerTimingRequested("0"));
+    EXPECT_FALSE(ovms::isServerTimingRequested("false"));
+}
@@ -0,0 +1,135 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../responsecache.hpp"
+#include "../sharedmemory.hpp"
+
+using namespace ovms;
+
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+static PredictRequest createRequest(const std::string& content) {
+    PredictRequest request;
+    request.mutable_model_spec()->set_name("dummy");
+    auto& input = (*request.mutable_inputs())["b"];
+    input.set_dtype(tensorflow::DataType::DT_FLOAT);
+    input.mutable_tensor_shape()->add_dim()->set_size(1);
+    input.set_tensor_content(content);
+    return request;
+}
+
+static PredictResponse createResponse(const std::string& content) {
+    PredictResponse response;
+    (*response.mutable_outputs())["a"].set_tensor_content(content);
+    return response;
+}
+
+TEST(ResponseCache, KeyDependsOnInputsAndOutputFilter) {
+    std::string first, second;
+    ASSERT_TRUE(ResponseCache::createKey(createRequest("abcd"), first));
+    ASSERT_TRUE(ResponseCache::createKey(createRequest("abcd"), second));
+    EXPECT_EQ(first, second);
+
+    ASSERT_TRUE(ResponseCache::createKey(createRequest("abce"), second));
+    EXPECT_NE(first, second);
+
+    auto filtered = createRequest("abcd");
+    filtered.add_output_filter("a");
+    ASSERT_TRUE(ResponseCache::createKey(filtered, second));
+    EXPECT_NE(first, second);
+}
+
+TEST(ResponseCache, KeyDoesNotDependOnModelSpec) {
+    std::string first, second;
+    auto request = createRequest("abcd");
+    ASSERT_TRUE(ResponseCache::createKey(request, first));
+    request.mutable_model_spec()->mutable_version()->set_value(1);
+    ASSERT_TRUE(ResponseCache::createKey(request, second));
+    EXPECT_EQ(first, second);
+}
+
+TEST(ResponseCache, SharedMemoryIsNotCached) {
+    std::string key;
+    auto request = createRequest("");
+    (*request.mutable_inputs())["b"].add_string_val(SHARED_MEMORY_REFERENCE_PREFIX + "region:0:4");
+    EXPECT_FALSE(ResponseCache::createKey(request, key));
+
+    request = createRequest("abcd");
+    request.add_output_filter(std::string("a") + OUTPUT_DESTINATION_SEPARATOR + SHARED_MEMORY_REFERENCE_PREFIX + "region:0:4");
+    EXPECT_FALSE(ResponseCache::createKey(request, key));
+}
+
+TEST(ResponseCache, HitAndMiss) {
+    ResponseCache cache(1024);
+    std::string key;
+    ASSERT_TRUE(ResponseCache::createKey(createRequest("abcd"), key));
+    PredictResponse response;
+    EXPECT_FALSE(cache.get(key, &response));
+    cache.put(std::string(key), createResponse("1234"));
+    ASSERT_TRUE(cache.get(key, &response));
+    EXPECT_EQ(response.outputs().at("a").tensor_content(), "1234");
+    EXPECT_EQ(cache.getHits(), 1);
+    EXPECT_EQ(cache.getMisses(), 1);
+}
+
+TEST(ResponseCache, LeastRecentlyUsedIsEvicted) {
+    std::string first, second, third;
+    ASSERT_TRUE(ResponseCache::createKey(createRequest(std::string(100, 'a')), first));
+    ASSERT_TRUE(ResponseCache::createKey(createRequest(std::string(100, 'b')), second));
+    ASSERT_TRUE(ResponseCache::createKey(createRequest(std::string(100, 'c')), third));
+    const auto response = createResponse(std::string(100, 'x'));
+    const size_t entrySize = first.size() + response.ByteSizeLong();
+    ResponseCache cache(2 * entrySize);
+
+    PredictResponse result;
+    cache.put(std::string(first), response);
+    cache.put(std::string(second), response);
+    ASSERT_TRUE(cache.get(first, &result));
+    cache.put(std::string(third), response);
+    EXPECT_TRUE(cache.get(first, &result));
+    EXPECT_FALSE(cache.get(second, &result));
+    EXPECT_TRUE(cache.get(third, &result));
+    EXPECT_EQ(cache.getSizeBytes(), 2 * entrySize);
+}
+
+TEST(ResponseCache, TooBigResponseIsNotCached) {
+    ResponseCache cache(64);
+    std::string key;
+    ASSERT_TRUE(ResponseCache::createKey(createRequest("abcd"), key));
+    cache.put(std::string(key), createResponse(std::string(1024, 'x')));
+    PredictResponse response;
+    EXPECT_FALSE(cache.get(key, &response));
+    EXPECT_EQ(cache.getSizeBytes(), 0);
+}
+
+TEST(ResponseCache, Reset) {
+    ResponseCache cache(1024);
+    EXPECT_TRUE(cache.isEnabled());
+    std::string key;
+    ASSERT_TRUE(ResponseCache::createKey(createRequest("abcd"), key));
+    cache.put(std::string(key), createResponse("1234"));
+    PredictResponse response;
+    ASSERT_TRUE(cache.get(key, &response));
+    cache.reset(0);
+    EXPECT_FALSE(cache.isEnabled());
+    EXPECT_EQ(cache.getHits(), 0);
+    EXPECT_FALSE(cache.get(key, &response));
+    EXPECT_EQ(cache.getSizeBytes(), 0);
+}
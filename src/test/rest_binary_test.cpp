@@ -0,0 +1,178 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../rest_parser.hpp"
+#include "../rest_utils.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+using namespace testing;
+using ::testing::ElementsAre;
+
+using tensorflow::DataType;
+
+namespace {
+
+std::string makeBinaryBody(const std::string& header, const std::vector<float>& data, size_t& headerLength) {
+    headerLength = header.size();
+    return header + std::string(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+}
+
+}  // namespace
+
+TEST(RestParserBinary, ParseValidRequest) {
+    std::vector<RestParser> parsers{RestParser(), RestParser(prepareTensors({{"a", {1, 2}}, {"b", {1, 3}}, {"c", {1}}}))};
+    for (RestParser& parser : parsers) {
+        size_t headerLength;
+        const std::string body = makeBinaryBody(R"({"inputs":[
+            {"name":"a","datatype":"FP32","shape":[1,2],"parameters":{"binary_data_size":8}},
+            {"name":"b","datatype":"FP32","shape":[1,3],"parameters":{"binary_data_size":12}}
+        ],"outputs":[{"name":"out","parameters":{"binary_data":true}}]})",
+            {1.0, 2.0, 3.0, 4.0, 5.0}, headerLength);
+        ASSERT_EQ(parser.parseBinary(body, headerLength), StatusCode::OK);
+        EXPECT_EQ(parser.getFormat(), Format::NAMED);
+        const auto& proto = parser.getProto();
+        ASSERT_EQ(proto.inputs_size(), 2);
+        ASSERT_EQ(proto.inputs().count("a"), 1);
+        ASSERT_EQ(proto.inputs().count("b"), 1);
+        EXPECT_EQ(proto.inputs().at("a").dtype(), DataType::DT_FLOAT);
+        EXPECT_THAT(asVector(proto.inputs().at("a").tensor_shape()), ElementsAre(1, 2));
+        EXPECT_THAT(asVector<float>(proto.inputs().at("a").tensor_content()), ElementsAre(1.0, 2.0));
+        EXPECT_THAT(asVector(proto.inputs().at("b").tensor_shape()), ElementsAre(1, 3));
+        EXPECT_THAT(asVector<float>(proto.inputs().at("b").tensor_content()), ElementsAre(3.0, 4.0, 5.0));
+        ASSERT_EQ(proto.output_filter_size(), 1);
+        EXPECT_EQ(proto.output_filter(0), "out");
+    }
+}
+
+TEST(RestParserBinary, ParseHalfPrecisionAndScalar) {
+    RestParser parser;
+    const std::string header = R"({"inputs":[
+        {"name":"h","datatype":"FP16","shape":[2],"parameters":{"binary_data_size":4}},
+        {"name":"s","datatype":"INT64","shape":[],"parameters":{"binary_data_size":8}}
+    ]})";
+    const uint16_t half[2] = {0x3C00, 0xC000};
+    const int64_t scalar = -7;
+    const std::string body = header + std::string(reinterpret_cast<const char*>(half), sizeof(half)) +
+                             std::string(reinterpret_cast<const char*>(&scalar), sizeof(scalar));
+    ASSERT_EQ(parser.parseBinary(body, header.size()), StatusCode::OK);
+    const auto& proto = parser.getProto();
+    ASSERT_EQ(proto.inputs_size(), 2);
+    EXPECT_EQ(proto.inputs().at("h").dtype(), DataType::DT_HALF);
+    EXPECT_THAT(asVector<uint16_t>(proto.inputs().at("h").tensor_content()), ElementsAre(0x3C00, 0xC000));
+    EXPECT_EQ(proto.inputs().at("s").dtype(), DataType::DT_INT64);
+    EXPECT_EQ(proto.inputs().at("s").tensor_shape().dim_size(), 0);
+    EXPECT_THAT(asVector<int64_t>(proto.inputs().at("s").tensor_content()), ElementsAre(-7));
+}
+
+TEST(RestParserBinary, RejectInvalidHeader) {
+    size_t headerLength;
+    std::string body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[1],"parameters":{"binary_data_size":4}}]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, body.size() + 1), StatusCode::REST_BINARY_HEADER_INVALID);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength - 1), StatusCode::JSON_INVALID);
+
+    body = makeBinaryBody(R"([])", {}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BODY_IS_NOT_AN_OBJECT);
+    body = makeBinaryBody(R"({"inputs":{}})", {}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_HEADER_INVALID);
+    body = makeBinaryBody(R"({"inputs":[]})", {}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_NO_INPUTS_FOUND);
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[1]}]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_HEADER_INVALID);
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[-1],"parameters":{"binary_data_size":4}}]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_HEADER_INVALID);
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"BYTES","shape":[1],"parameters":{"binary_data_size":4}}]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_UNSUPPORTED_PRECISION);
+    body = makeBinaryBody(R"({"inputs":[
+        {"name":"a","datatype":"FP32","shape":[1],"parameters":{"binary_data_size":4}},
+        {"name":"a","datatype":"FP32","shape":[1],"parameters":{"binary_data_size":4}}]})",
+        {1.0, 2.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_HEADER_INVALID);
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[1],"parameters":{"binary_data_size":4}}],"outputs":["o"]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_HEADER_INVALID);
+}
+
+TEST(RestParserBinary, RejectDataSizeMismatch) {
+    size_t headerLength;
+    // size not matching shape
+    std::string body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[2],"parameters":{"binary_data_size":4}}]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_DATA_SIZE_MISMATCH);
+    // missing data
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[2],"parameters":{"binary_data_size":8}}]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_DATA_SIZE_MISMATCH);
+    // data not described in header
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[1],"parameters":{"binary_data_size":4}}]})", {1.0, 2.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_DATA_SIZE_MISMATCH);
+    // shapes whose size in bytes wraps around to the given data size, 4 * 2^62 * 2^62 to 0 and 4 * (2^62 + 1) to 4
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[4611686018427387904,4611686018427387904],"parameters":{"binary_data_size":0}}]})", {}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_DATA_SIZE_MISMATCH);
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[4611686018427387905],"parameters":{"binary_data_size":4}}]})", {1.0}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::REST_BINARY_DATA_SIZE_MISMATCH);
+    // zero sized dimension after a large one
+    body = makeBinaryBody(R"({"inputs":[{"name":"a","datatype":"FP32","shape":[4611686018427387904,0],"parameters":{"binary_data_size":0}}]})", {}, headerLength);
+    EXPECT_EQ(RestParser().parseBinary(body, headerLength), StatusCode::OK);
+}
+
+TEST(RestUtilsBinary, MakeBinaryPredictResponse) {
+    tensorflow::serving::PredictResponse proto;
+    auto& output = (*proto.mutable_outputs())["out"];
+    output.set_dtype(DataType::DT_FLOAT);
+    output.mutable_tensor_shape()->add_dim()->set_size(1);
+    output.mutable_tensor_shape()->add_dim()->set_size(2);
+    const float data[2] = {1.5, -2.0};
+    output.mutable_tensor_content()->assign(reinterpret_cast<const char*>(data), sizeof(data));
+
+    std::string body;
+    size_t headerLength = 0;
+    ASSERT_EQ(makeBinaryPredictResponse(proto, "dummy", &body, &headerLength), StatusCode::OK);
+    const std::string expectedHeader = R"({"model_name":"dummy","outputs":[{"name":"out","datatype":"FP32","shape":[1,2],"parameters":{"binary_data_size":8}}]})";
+    ASSERT_EQ(headerLength, expectedHeader.size());
+    EXPECT_EQ(body.substr(0, headerLength), expectedHeader);
+    EXPECT_THAT(asVector<float>(body.substr(headerLength)), ElementsAre(1.5, -2.0));
+}
+
+TEST(RestUtilsBinary, MakeBinaryPredictResponseErrors) {
+    tensorflow::serving::PredictResponse proto;
+    std::string body;
+    size_t headerLength = 0;
+    EXPECT_EQ(makeBinaryPredictResponse(proto, "dummy", &body, &headerLength), StatusCode::REST_PROTO_TO_STRING_ERROR);
+
+    auto& output = (*proto.mutable_outputs())["out"];
+    output.set_dtype(DataType::DT_FLOAT);
+    output.mutable_tensor_shape()->add_dim()->set_size(2);
+    output.mutable_tensor_content()->assign(4, '\0');
+    EXPECT_EQ(makeBinaryPredictResponse(proto, "dummy", &body, &headerLength), StatusCode::REST_SERIALIZE_TENSOR_CONTENT_INVALID_SIZE);
+
+    output.set_dtype(DataType::DT_STRING);
+    output.mutable_tensor_content()->clear();
+    EXPECT_EQ(makeBinaryPredictResponse(proto, "dummy", &body, &headerLength), StatusCode::REST_UNSUPPORTED_PRECISION);
+}
+
+TEST(RestUtilsBinary, DatatypeNames) {
+    EXPECT_EQ(getBinaryDatatype("FP32"), DataType::DT_FLOAT);
+    EXPECT_EQ(getBinaryDatatype("FP16"), DataType::DT_HALF);
+    EXPECT_EQ(getBinaryDatatype("UINT8"), DataType::DT_UINT8);
+    EXPECT_EQ(getBinaryDatatype("BYTES"), std::nullopt);
+    EXPECT_STREQ(getBinaryDatatypeName(DataType::DT_INT64), "INT64");
+    EXPECT_EQ(getBinaryDatatypeName(DataType::DT_STRING), nullptr);
+}
@@ -641,3 +641,52 @@ TEST(RestParserColumn, RemoveUnnecessaryInputs) {
         ASSERT_EQ(parser.getProto().inputs().count("l"), 1);
     }
 }
+
+TEST(RestParserColumn, InconsistentNestingDepth) {
+    std::vector<RestParser> parsers{RestParser(), RestParser(prepareTensors({{"i", {2, 2, 1}}}))};
+    for (RestParser& parser : parsers) {
+        // second row is one level deeper, shape is validated per dimension only
+        ASSERT_EQ(parser.parse(R"({"inputs":{"i":[[1, 2], [[3], [4]]]}})"), StatusCode::OK);
+        EXPECT_EQ(parser.getOrder(), Order::COLUMN);
+        EXPECT_EQ(parser.getFormat(), Format::NAMED);
+        ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+        EXPECT_THAT(asVector(parser.getProto().inputs().at("i").tensor_shape()), ElementsAre(2, 2, 1));
+        EXPECT_EQ(parser.getProto().inputs().at("i").tensor_content().size(), 4 * sizeof(float));
+    }
+}
+
+TEST(RestParserColumn, FallbackRestoresPreallocatedInputs) {
+    RestParser parser(prepareTensors({{"i", {1, 2}}, {"j", {1, 2}}}));
+    ASSERT_EQ(parser.parse(R"({"inputs":{"i":[[1.0, 2.0]]},"inputs":[]})"), StatusCode::OK);
+    EXPECT_EQ(parser.getOrder(), Order::COLUMN);
+    EXPECT_EQ(parser.getFormat(), Format::NAMED);
+    ASSERT_EQ(parser.getProto().inputs().size(), 1);
+    ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+    EXPECT_EQ(parser.getProto().inputs().at("i").dtype(), DataType::DT_FLOAT);
+    EXPECT_THAT(asVector(parser.getProto().inputs().at("i").tensor_shape()), ElementsAre(1, 2));
+    EXPECT_THAT(asVector<float>(parser.getProto().inputs().at("i").tensor_content()), ElementsAre(1.0, 2.0));
+}
+
+TEST(RestParserColumn, ParseBinaryValues) {
+    std::vector<RestParser> parsers{RestParser(), RestParser(prepareTensors({{"i", {2, 3, 4, 4}}}, InferenceEngine::Precision::U8))};
+    for (RestParser& parser : parsers) {
+        ASSERT_EQ(parser.parse(R"({"inputs":{"i":[{"b64":"aGVsbG8="},{"b64":"d29ybGQ="}]}})"), StatusCode::OK);
+        EXPECT_EQ(parser.getOrder(), Order::COLUMN);
+        EXPECT_EQ(parser.getFormat(), Format::NAMED);
+        ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+        const auto& input = parser.getProto().inputs().at("i");
+        EXPECT_EQ(input.dtype(), DataType::DT_STRING);
+        EXPECT_THAT(asVector(input.tensor_shape()), ElementsAre(2));
+        EXPECT_THAT(input.string_val(), ElementsAre("hello", "world"));
+    }
+}
+
+TEST(RestParserColumn, ParseBinaryValuesNonamed) {
+    RestParser parser(prepareTensors({{"i", {1, 3, 4, 4}}}, InferenceEngine::Precision::U8));
+    ASSERT_EQ(parser.parse(R"({"inputs":[{"b64":"aGVsbG8="}]})"), StatusCode::OK);
+    EXPECT_EQ(parser.getOrder(), Order::COLUMN);
+    EXPECT_EQ(parser.getFormat(), Format::NONAMED);
+    ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+    EXPECT_EQ(parser.getProto().inputs().at("i").dtype(), DataType::DT_STRING);
+    EXPECT_THAT(parser.getProto().inputs().at("i").string_val(), ElementsAre("hello"));
+}
@@ -663,3 +663,133 @@ TEST(RestParserRow, RemoveUnnecessaryInputs) {
         ASSERT_EQ(parser.getProto().inputs().count("l"), 1);
     }
 }
+
+TEST(RestParserRow, SkipUnknownMembers) {
+    std::vector<RestParser> parsers{RestParser(), RestParser(prepareTensors({{"i", {1, 2}}}))};
+    for (RestParser& parser : parsers) {
+        ASSERT_EQ(parser.parse(R"({"signature_name":"","meta":{"a":[1,[2,{}]],"b":null},"instances":[
+            {"i":[1.0, 2.0]}
+        ],"other":[[{"instances":[]}]]})"),
+            StatusCode::OK);
+        EXPECT_EQ(parser.getOrder(), Order::ROW);
+        EXPECT_EQ(parser.getFormat(), Format::NAMED);
+        ASSERT_EQ(parser.getProto().inputs().size(), 1);
+        ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+        EXPECT_THAT(asVector(parser.getProto().inputs().at("i").tensor_shape()), ElementsAre(1, 2));
+        EXPECT_THAT(asVector<float>(parser.getProto().inputs().at("i").tensor_content()), ElementsAre(1.0, 2.0));
+    }
+}
+
+TEST(RestParserRow, DuplicatedInstancesUseFirstOccurrence) {
+    std::vector<RestParser> parsers{RestParser(), RestParser(prepareTensors({{"i", {1, 2}}, {"j", {1, 2}}}))};
+    for (RestParser& parser : parsers) {
+        ASSERT_EQ(parser.parse(R"({"instances":[{"i":[1.0, 2.0]}],"instances":[{"i":[3.0, 4.0]}]})"), StatusCode::OK);
+        EXPECT_EQ(parser.getOrder(), Order::ROW);
+        EXPECT_EQ(parser.getFormat(), Format::NAMED);
+        ASSERT_EQ(parser.getProto().inputs().size(), 1);
+        ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+        EXPECT_THAT(asVector(parser.getProto().inputs().at("i").tensor_shape()), ElementsAre(1, 2));
+        EXPECT_THAT(asVector<float>(parser.getProto().inputs().at("i").tensor_content()), ElementsAre(1.0, 2.0));
+    }
+}
+
+TEST(RestParserRow, InstancesBatchSizeDifferAfterStreaming) {
+    RestParser parser(prepareTensors({{"i", {1, 1}}, {"j", {1, 1}}}));
+    EXPECT_EQ(parser.parse(R"({"instances":[{"i":[1.0],"j":[1.0]},{"i":[2.0]}]})"), StatusCode::REST_INSTANCES_BATCH_SIZE_DIFFER);
+}
+
+TEST(RestParserRow, ParseInvalidJsonWithoutDocument) {
+    RestParser parser(prepareTensors({{"i", {1, 2}}}));
+    EXPECT_EQ(parser.parse(R"({"instances":[{"i":[1.0, 2.0]}]}, )"), StatusCode::JSON_INVALID);
+    EXPECT_EQ(parser.parse(R"({"instances":[{"i":[1.0, 2.0)"), StatusCode::JSON_INVALID);
+}
+
+TEST(RestParserRow, ParseBinaryValues) {
+    std::vector<RestParser> parsers{RestParser(), RestParser(prepareTensors({{"i", {2, 3, 4, 4}}}, InferenceEngine::Precision::U8))};
+    for (RestParser& parser : parsers) {
+        ASSERT_EQ(parser.parse(R"({"instances":[{"i":{"b64":"aGVsbG8="}},{"i":{"b64":"d29ybGQ="}}]})"), StatusCode::OK);
+        EXPECT_EQ(parser.getOrder(), Order::ROW);
+        EXPECT_EQ(parser.getFormat(), Format::NAMED);
+        ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+        const auto& input = parser.getProto().inputs().at("i");
+        EXPECT_EQ(input.dtype(), DataType::DT_STRING);
+        EXPECT_THAT(asVector(input.tensor_shape()), ElementsAre(2));
+        EXPECT_THAT(input.string_val(), ElementsAre("hello", "world"));
+        EXPECT_EQ(input.tensor_content().size(), 0);
+    }
+}
+
+TEST(RestParserRow, ParseBinaryValuesNonamed) {
+    RestParser parser(prepareTensors({{"i", {2, 3, 4, 4}}}, InferenceEngine::Precision::U8));
+    ASSERT_EQ(parser.parse(R"({"instances":[{"b64":"aGVsbG8="},{"b64":"d29ybGQ="}]})"), StatusCode::OK);
+    EXPECT_EQ(parser.getOrder(), Order::ROW);
+    EXPECT_EQ(parser.getFormat(), Format::NONAMED);
+    ASSERT_EQ(parser.getProto().inputs().count("i"), 1);
+    const auto& input = parser.getProto().inputs().at("i");
+    EXPECT_EQ(input.dtype(), DataType::DT_STRING);
+    EXPECT_THAT(asVector(input.tensor_shape()), ElementsAre(2));
+    EXPECT_THAT(input.string_val(), ElementsAre("hello", "world"));
+}
+
+TEST(RestParserRow, ParseInvalidBinaryValues) {
+    for (const char* json : {
+             R"({"instances":[{"i":{"b64":"not base64!"}}]})",
+             R"({"instances":[{"i":[1.0, 2.0]},{"i":{"b64":"aGVsbG8="}}]})",
+             R"({"instances":[{"i":{"b64":"aGVsbG8=","other":1}}]})"}) {
+        RestParser parser(prepareTensors({{"i", {1, 2}}}));
+        EXPECT_EQ(parser.parse(json), StatusCode::REST_COULD_NOT_PARSE_INSTANCE) << json;
+    }
+}
+
+static std::string createRowNamedRequest(size_t instancesCount) {
+    std::string json = R"({"instances":[)";
+    for (size_t i = 0; i < instancesCount; ++i) {
+        json += (i ? "," : "") + std::string(R"({"inputA":[[)") + std::to_string(i) + ".0," + std::to_string(i) + R"(.5]],"inputB":[)" +
+                std::to_string(i) + R"(],"inputC":{"b64":"aGVsbG8="}})";
+    }
+    return json + "]}";
+}
+
+TEST(RestParserRow, ParseManyInstancesDocument) {
+    const int64_t instancesCount = MAX_ROW_PARSING_THREADS * ROW_PARSING_INSTANCES_PER_THREAD + 3;
+    std::vector<RestParser> parsers{RestParser(), RestParser(prepareTensors({{"inputA", {static_cast<size_t>(instancesCount), 1, 2}}, {"inputB", {static_cast<size_t>(instancesCount), 1}}}))};
+    for (RestParser& parser : parsers) {
+        rapidjson::Document doc;
+        ASSERT_FALSE(doc.Parse(createRowNamedRequest(instancesCount).c_str()).HasParseError());
+        ASSERT_EQ(parser.parse(doc), StatusCode::OK);
+        EXPECT_EQ(parser.getOrder(), Order::ROW);
+        EXPECT_EQ(parser.getFormat(), Format::NAMED);
+        ASSERT_EQ(parser.getProto().inputs_size(), 3);
+        const auto& inputA = parser.getProto().inputs().at("inputA");
+        const auto& inputB = parser.getProto().inputs().at("inputB");
+        const auto& inputC = parser.getProto().inputs().at("inputC");
+        EXPECT_THAT(asVector(inputA.tensor_shape()), ElementsAre(instancesCount, 1, 2));
+        EXPECT_THAT(asVector(inputB.tensor_shape()), ElementsAre(instancesCount, 1));
+        EXPECT_THAT(asVector(inputC.tensor_shape()), ElementsAre(instancesCount));
+        ASSERT_EQ(inputA.tensor_content().size(), static_cast<size_t>(instancesCount) * 2 * sizeof(float));
+        ASSERT_EQ(inputC.string_val_size(), instancesCount);
+        for (int64_t i = 0; i < instancesCount; ++i) {
+            EXPECT_EQ(reinterpret_cast<const float*>(inputA.tensor_content().data())[2 * i], static_cast<float>(i));
+            EXPECT_EQ(reinterpret_cast<const float*>(inputA.tensor_content().data())[2 * i + 1], i + 0.5f);
+            EXPECT_EQ(inputC.string_val(i), "hello");
+        }
+        EXPECT_EQ(parser.parse(createRowNamedRequest(instancesCount).c_str()), StatusCode::OK);
+    }
+}
+
+TEST(RestParserRow, ParseManyInstancesDocumentInvalid) {
+    const size_t instancesCount = MAX_ROW_PARSING_THREADS * ROW_PARSING_INSTANCES_PER_THREAD;
+    const std::string json = createRowNamedRequest(instancesCount);
+    for (const auto& [invalidInstance, expectedStatus] : std::vector<std::pair<std::string, StatusCode>>{
+             {R"({"inputA":[[1.0,1.5,2.0]],"inputB":[1],"inputC":{"b64":"aGVsbG8="}}]})", StatusCode::REST_COULD_NOT_PARSE_INSTANCE},
+             {R"({"inputA":[[1.0,1.5]],"inputB":[1],"inputC":[1.0]}]})", StatusCode::REST_COULD_NOT_PARSE_INSTANCE},
+             {R"({"inputA":[[1.0,1.5]],"inputC":{"b64":"aGVsbG8="}}]})", StatusCode::REST_INSTANCES_BATCH_SIZE_DIFFER},
+             {R"({"inputA":[[1.0,1.5]],"inputB":[1],"inputC":{"b64":"aGVsbG8="},"inputD":[1]}]})", StatusCode::REST_INSTANCES_BATCH_SIZE_DIFFER},
+             {R"(1]})", StatusCode::REST_NAMED_INSTANCE_NOT_AN_OBJECT}}) {
+        RestParser parser;
+        rapidjson::Document doc;
+        const std::string request = json.substr(0, json.rfind(R"({"inputA")")) + invalidInstance;
+        ASSERT_FALSE(doc.Parse(request.c_str()).HasParseError()) << invalidInstance;
+        EXPECT_EQ(parser.parse(doc), expectedStatus) << invalidInstance;
+    }
+}
@@ -0,0 +1,206 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <gtest/gtest.h>
+
+#include "../rest_router.hpp"
+
+using namespace ovms;
+
+TEST(RestRouter, Predict) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/models/resnet:predict", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::PREDICT);
+    EXPECT_EQ(route.name, "resnet");
+    EXPECT_FALSE(route.version.has_value());
+    EXPECT_FALSE(route.label.has_value());
+    EXPECT_EQ(route.operation, "predict");
+}
+
+TEST(RestRouter, PredictWithVersion) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/models/resnet/versions/12:predict", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::PREDICT);
+    EXPECT_EQ(route.name, "resnet");
+    ASSERT_TRUE(route.version.has_value());
+    EXPECT_EQ(route.version.value(), 12);
+    EXPECT_EQ(route.operation, "predict");
+}
+
+TEST(RestRouter, PredictWithLabel) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/models/resnet/labels/stable_1:classify", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::PREDICT);
+    ASSERT_TRUE(route.label.has_value());
+    EXPECT_EQ(route.label.value(), "stable_1");
+    EXPECT_EQ(route.operation, "classify");
+}
+
+TEST(RestRouter, ModelStatusAndMetadata) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("GET", "/v1/models/resnet", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::MODEL_STATUS);
+    EXPECT_EQ(route.name, "resnet");
+
+    ASSERT_EQ(routeRestRequest("GET", "/v1/models/resnet/versions/3/metadata", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::MODEL_METADATA);
+    EXPECT_EQ(route.name, "resnet");
+    ASSERT_TRUE(route.version.has_value());
+    EXPECT_EQ(route.version.value(), 3);
+
+    // version of previous route is not kept
+    ASSERT_EQ(routeRestRequest("GET", "/v1/models/resnet/metadata", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::MODEL_METADATA);
+    EXPECT_FALSE(route.version.has_value());
+}
+
+TEST(RestRouter, SharedMemory) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/shm/region:register", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::SHARED_MEMORY);
+    EXPECT_EQ(route.name, "region");
+    EXPECT_EQ(route.operation, "register");
+    ASSERT_EQ(routeRestRequest("POST", "/v1/shm/region:unregister", route), StatusCode::OK);
+    EXPECT_EQ(route.operation, "unregister");
+}
+
+TEST(RestRouter, InferRequestsResize) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/models/resnet/versions/2:resize", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::INFER_REQUESTS);
+    EXPECT_EQ(route.name, "resnet");
+    ASSERT_TRUE(route.version.has_value());
+    EXPECT_EQ(route.version.value(), 2);
+    EXPECT_EQ(route.operation, "resize");
+    EXPECT_EQ(routeRestRequest("GET", "/v1/models/resnet:resize", route), StatusCode::REST_UNSUPPORTED_METHOD);
+}
+
+TEST(RestRouter, BatchPredict) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/batch:predict", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::BATCH_PREDICT);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/batch:predict", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("POST", "/v1/batch:classify", route), StatusCode::REST_INVALID_URL);
+}
+
+TEST(RestRouter, IsInferenceRequest) {
+    EXPECT_TRUE(isInferenceRequest("POST", "/v1/models/resnet:predict"));
+    EXPECT_TRUE(isInferenceRequest("POST", "/v1/models/resnet/versions/2:predict"));
+    EXPECT_TRUE(isInferenceRequest("POST", "/v1/batch:predict"));
+    EXPECT_FALSE(isInferenceRequest("POST", "/v1/models/resnet:classify"));
+    EXPECT_FALSE(isInferenceRequest("POST", "/v1/models/resnet:resize"));
+    EXPECT_FALSE(isInferenceRequest("POST", "/v1/shm/region:register"));
+    EXPECT_FALSE(isInferenceRequest("POST", "/v1/jobs"));
+    EXPECT_FALSE(isInferenceRequest("POST", "/v1/admin/profile"));
+    EXPECT_FALSE(isInferenceRequest("GET", "/v1/ready"));
+    EXPECT_FALSE(isInferenceRequest("GET", "/v1/models/resnet/metadata"));
+    EXPECT_FALSE(isInferenceRequest("GET", "/v1/models/resnet:predict"));
+    EXPECT_FALSE(isInferenceRequest("POST", "/v2/unknown"));
+}
+
+TEST(RestRouter, BulkJobs) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/jobs", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::BULK_JOBS);
+    EXPECT_EQ(route.operation, "submit");
+    ASSERT_EQ(routeRestRequest("GET", "/v1/jobs", route), StatusCode::OK);
+    EXPECT_EQ(route.operation, "list");
+    ASSERT_EQ(routeRestRequest("GET", "/v1/jobs/12", route), StatusCode::OK);
+    EXPECT_EQ(route.operation, "status");
+    EXPECT_EQ(route.name, "12");
+    ASSERT_EQ(routeRestRequest("POST", "/v1/jobs/12:cancel", route), StatusCode::OK);
+    EXPECT_EQ(route.operation, "cancel");
+    EXPECT_EQ(routeRestRequest("POST", "/v1/jobs/12", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/jobs/abc", route), StatusCode::REST_INVALID_URL);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/jobsx", route), StatusCode::REST_INVALID_URL);
+}
+
+TEST(RestRouter, Profile) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("POST", "/v1/admin/profile", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::PROFILE);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/admin/profile", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("POST", "/v1/admin", route), StatusCode::REST_INVALID_URL);
+}
+
+TEST(RestRouter, Readiness) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("GET", "/v1/ready", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::READINESS);
+    EXPECT_EQ(routeRestRequest("POST", "/v1/ready", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/ready/models", route), StatusCode::REST_INVALID_URL);
+}
+
+TEST(RestRouter, Metrics) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("GET", "/v1/metrics", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::METRICS);
+    EXPECT_EQ(routeRestRequest("POST", "/v1/metrics", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/metrics/pipelines", route), StatusCode::REST_INVALID_URL);
+}
+
+TEST(RestRouter, PrometheusMetrics) {
+    RestRoute route;
+    ASSERT_EQ(routeRestRequest("GET", "/metrics", route), StatusCode::OK);
+    EXPECT_EQ(route.resource, RestResource::PROMETHEUS_METRICS);
+    EXPECT_EQ(routeRestRequest("POST", "/metrics", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("GET", "/metrics/models", route), StatusCode::REST_INVALID_URL);
+}
+
+TEST(RestRouter, UnsupportedMethod) {
+    RestRoute route;
+    EXPECT_EQ(routeRestRequest("PUT", "/v1/models/resnet:predict", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/models/resnet:predict", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/shm/region:register", route), StatusCode::REST_UNSUPPORTED_METHOD);
+    EXPECT_EQ(routeRestRequest("POST", "/v1/models/resnet/metadata", route), StatusCode::REST_UNSUPPORTED_METHOD);
+}
+
+TEST(RestRouter, InvalidUrl) {
+    RestRoute route;
+    for (const char* path : {
+             "",
+             "/v1",
+             "/v1/models",
+             "/v1/models/",
+             "/v2/models/resnet",
+             "/v1/models/resnet/",
+             "/v1/models/resnet:",
+             "/v1/models/resnet:infer",
+             "/v1/models/resnet:predict/",
+             "/v1/models/resnet/versions/:predict",
+             "/v1/models/resnet/versions/1a:predict",
+             "/v1/models/resnet/versions/-1",
+             "/v1/models/resnet/labels/a-b",
+             "/v1/models/resnet/metadata/",
+             "/v1/models/resnet/status",
+             "/v1/shm/region",
+             "/v1/shm/:register",
+             "/v1/shm/region:open",
+             "/v1/other/resnet"}) {
+        EXPECT_EQ(routeRestRequest("GET", path, route), StatusCode::REST_INVALID_URL) << path;
+        EXPECT_EQ(routeRestRequest("POST", path, route), StatusCode::REST_INVALID_URL) << path;
+    }
+}
+
+TEST(RestRouter, VersionOutOfRange) {
+    RestRoute route;
+    EXPECT_EQ(routeRestRequest("GET", "/v1/models/resnet/versions/99999999999999999999", route), StatusCode::REST_COULD_NOT_PARSE_VERSION);
+}
+
+TEST(RestRouter, EscapedPath) {
+    RestRoute route;
+    EXPECT_EQ(routeRestRequest("GET", "/v1/models/../resnet", route), StatusCode::PATH_INVALID);
+    EXPECT_EQ(routeRestRequest("GET", "/v1/models/resnet/..", route), StatusCode::PATH_INVALID);
+}
@@ -13,6 +13,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //*****************************************************************************
+#include <limits>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -406,3 +408,68 @@ TEST_F(RestUtilsPrecisionTest, MakeJsonFromPredictResponse_Uint64) {
     ]
 })");
 }
+
+TEST_F(RestUtilsPrecisionTest, MakeJsonFromPredictResponse_Half) {
+    uint16_t data = 0xC100;  // -2.5 in half precision
+    output->set_dtype(tensorflow::DataType::DT_HALF);
+    output->mutable_tensor_content()->assign(reinterpret_cast<const char*>(&data), sizeof(uint16_t));
+    ASSERT_EQ(makeJsonFromPredictResponse(proto, &json, Order::ROW), StatusCode::OK);
+    EXPECT_EQ(json, R"({
+    "predictions": [[-2.5]
+    ]
+})");
+}
+
+TEST_F(RestUtilsPrecisionTest, MakeJsonFromPredictResponse_Bfloat16) {
+    uint16_t data = 0xC020;  // -2.5 in bfloat16
+    output->set_dtype(tensorflow::DataType::DT_BFLOAT16);
+    output->mutable_tensor_content()->assign(reinterpret_cast<const char*>(&data), sizeof(uint16_t));
+    ASSERT_EQ(makeJsonFromPredictResponse(proto, &json, Order::ROW), StatusCode::OK);
+    EXPECT_EQ(json, R"({
+    "predictions": [[-2.5]
+    ]
+})");
+}
+
+TEST_F(RestUtilsPrecisionTest, MakeJsonFromPredictResponse_Bool) {
+    bool data[2] = {true, false};
+    output->set_dtype(tensorflow::DataType::DT_BOOL);
+    output->mutable_tensor_shape()->mutable_dim(1)->set_size(2);
+    output->mutable_tensor_content()->assign(reinterpret_cast<const char*>(data), 2 * sizeof(bool));
+    ASSERT_EQ(makeJsonFromPredictResponse(proto, &json, Order::ROW), StatusCode::OK);
+    EXPECT_EQ(json, R"({
+    "predictions": [[true, false]
+    ]
+})");
+}
+
+TEST_F(RestUtilsPrecisionTest, MakeJsonFromPredictResponse_FloatShortestRepresentation) {
+    float data[4] = {1.0000001f, 0.1f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()};
+    output->set_dtype(tensorflow::DataType::DT_FLOAT);
+    output->mutable_tensor_shape()->mutable_dim(1)->set_size(4);
+    output->mutable_tensor_content()->assign(reinterpret_cast<const char*>(data), 4 * sizeof(float));
+    ASSERT_EQ(makeJsonFromPredictResponse(proto, &json, Order::ROW), StatusCode::OK);
+    EXPECT_EQ(json, R"({
+    "predictions": [[1.0000001, 0.1, Infinity, NaN]
+    ]
+})");
+}
+
+TEST_F(RestUtilsPrecisionTest, MakeJsonFromPredictResponse_ScalarColumnOrder) {
+    int32_t data = 7;
+    output->set_dtype(tensorflow::DataType::DT_INT32);
+    output->mutable_tensor_shape()->clear_dim();
+    output->mutable_tensor_content()->assign(reinterpret_cast<const char*>(&data), sizeof(int32_t));
+    ASSERT_EQ(makeJsonFromPredictResponse(proto, &json, Order::COLUMN), StatusCode::OK);
+    EXPECT_EQ(json, R"({
+    "outputs": 7
+})");
+    EXPECT_EQ(makeJsonFromPredictResponse(proto, &json, Order::ROW), StatusCode::REST_PROTO_TO_STRING_ERROR);
+}
+
+TEST_F(RestUtilsTest, MakeJsonFromPredictResponse_RowOrderBatchSizeDiffer) {
+    output2->mutable_tensor_shape()->mutable_dim(0)->set_size(1);
+    output2->mutable_tensor_shape()->mutable_dim(1)->set_size(10);
+    EXPECT_EQ(makeJsonFromPredictResponse(proto, &json, Order::ROW), StatusCode::REST_PROTO_TO_STRING_ERROR);
+    EXPECT_EQ(makeJsonFromPredictResponse(proto, &json, Order::COLUMN), StatusCode::OK);
+}
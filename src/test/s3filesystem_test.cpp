@@ -0,0 +1,77 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "../s3filesystem.hpp"
+#include "gtest/gtest.h"
+
+using namespace ovms;
+
+namespace {
+class S3FileSystemShared : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // client is created without reaching any endpoint or instance metadata
+        setenv("AWS_ACCESS_KEY_ID", "ovms_test_key_id", 1);
+        setenv("AWS_SECRET_ACCESS_KEY", "ovms_test_secret", 1);
+        setenv("AWS_REGION", "us-east-1", 1);
+        setenv("AWS_EC2_METADATA_DISABLED", "true", 1);
+        unsetenv("S3_ENDPOINT");
+    }
+
+    void TearDown() override {
+        for (const char* name : {"AWS_ACCESS_KEY_ID", "AWS_SECRET_ACCESS_KEY", "AWS_REGION", "AWS_EC2_METADATA_DISABLED", "S3_ENDPOINT"}) {
+            unsetenv(name);
+        }
+    }
+};
+}  // namespace
+
+TEST_F(S3FileSystemShared, SameEndpointAndCredentialsShareInstance) {
+    auto first = S3FileSystem::getShared("s3://localhost:9000/bucket/model/1");
+    auto second = S3FileSystem::getShared("s3://localhost:9000/other_bucket/model");
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first, second);
+}
+
+TEST_F(S3FileSystemShared, DifferentEndpointOrCredentialsGetOtherInstance) {
+    auto first = S3FileSystem::getShared("s3://localhost:9000/bucket/model");
+    EXPECT_NE(S3FileSystem::getShared("s3://localhost:9001/bucket/model"), first);
+
+    setenv("S3_ENDPOINT", "http://localhost:9002", 1);
+    auto withEndpoint = S3FileSystem::getShared("s3://localhost:9000/bucket/model");
+    EXPECT_NE(withEndpoint, first);
+    EXPECT_EQ(S3FileSystem::getShared("s3://localhost:9000/bucket/model"), withEndpoint);
+    unsetenv("S3_ENDPOINT");
+
+    setenv("AWS_ACCESS_KEY_ID", "ovms_test_other_key_id", 1);
+    EXPECT_NE(S3FileSystem::getShared("s3://localhost:9000/bucket/model"), first);
+    setenv("AWS_ACCESS_KEY_ID", "ovms_test_key_id", 1);
+    EXPECT_EQ(S3FileSystem::getShared("s3://localhost:9000/bucket/model"), first);
+}
+
+TEST_F(S3FileSystemShared, FileSystemKeepsSdkInitialized) {
+    auto shared = S3FileSystem::getShared("s3://localhost:9000/bucket/model");
+    const size_t users = AwsSdkGuard::getUsersCount();
+    EXPECT_GT(users, 0);
+    {
+        S3FileSystem own("s3://localhost:9003/bucket/model");
+        EXPECT_EQ(AwsSdkGuard::getUsersCount(), users + 1);
+    }
+    EXPECT_EQ(AwsSdkGuard::getUsersCount(), users);
+}
@@ -0,0 +1,129 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../samplingprofiler.hpp"
+
+using ovms::Profile;
+using ovms::ProfilerTag;
+using ovms::SamplingProfiler;
+using ovms::StatusCode;
+
+namespace {
+std::string fakeSymbolizer(uintptr_t address) {
+    return "f" + std::to_string(address);
+}
+
+volatile uint64_t spinResult = 0;
+
+void __attribute__((noinline)) spin(const std::atomic<bool>& stop) {
+    uint64_t value = 1;
+    while (!stop.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 1000; ++i) {
+            value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        spinResult = value;
+    }
+}
+}  // namespace
+
+TEST(Profile, FoldedStacksAreOutermostFirstAndAggregated) {
+    Profile profile;
+    // return addresses of callers are symbolized at the calling instruction
+    const uintptr_t frames[] = {10, 21, 31};
+    profile.add("ovms_rest", "rest_parsing", frames, 3);
+    profile.add("ovms_rest", "rest_parsing", frames, 3, 2);
+    profile.add("ovms_dag", nullptr, frames, 1);
+    EXPECT_EQ(profile.getSamplesCount(), 4);
+    EXPECT_EQ(profile.toFolded(fakeSymbolizer),
+        "ovms_dag;f10 1\n"
+        "ovms_rest;[rest_parsing];f30;f20;f10 3\n");
+}
+
+TEST(Profile, FrameSeparatorsInNamesAreReplaced) {
+    Profile profile;
+    const uintptr_t frames[] = {1};
+    profile.add("a;b", nullptr, frames, 1);
+    EXPECT_EQ(profile.toFolded([](uintptr_t) { return std::string("x;y"); }), "a:b;x:y 1\n");
+}
+
+TEST(Profile, PprofContainsSampleTypesAndLabels) {
+    Profile profile;
+    profile.setPeriod(std::chrono::milliseconds(10));
+    const uintptr_t frames[] = {10, 21};
+    profile.add("ovms_grpc_cq", "pipeline_execution", frames, 2);
+    auto pprof = profile.toPprof(fakeSymbolizer);
+    ASSERT_FALSE(pprof.empty());
+    // first field is sample_type value type message
+    EXPECT_EQ(pprof[0], '\x0a');
+    for (const auto* expected : {"samples", "count", "cpu", "nanoseconds", "thread", "tag", "ovms_grpc_cq", "pipeline_execution", "f10", "f20"}) {
+        EXPECT_NE(pprof.find(expected), std::string::npos) << expected;
+    }
+}
+
+TEST(SamplingProfiler, InvalidOptionsAreRejected) {
+    Profile profile;
+    EXPECT_EQ(SamplingProfiler::instance().collect(std::chrono::milliseconds(0), 99, profile), StatusCode::PROFILE_OPTIONS_INVALID);
+    EXPECT_EQ(SamplingProfiler::instance().collect(std::chrono::milliseconds(100), 0, profile), StatusCode::PROFILE_OPTIONS_INVALID);
+    EXPECT_EQ(SamplingProfiler::instance().collect(std::chrono::minutes(2), 99, profile), StatusCode::PROFILE_OPTIONS_INVALID);
+    EXPECT_EQ(SamplingProfiler::instance().collect(std::chrono::milliseconds(100), ovms::MAX_PROFILE_FREQUENCY + 1, profile), StatusCode::PROFILE_OPTIONS_INVALID);
+}
+
+TEST(SamplingProfiler, BusyNamedThreadIsSampledWithItsTag) {
+    std::atomic<bool> stop{false};
+    std::thread worker([&stop]() {
+        ovms::setCurrentThreadName("ovms_test_busy");
+        ProfilerTag tag("busy_loop");
+        spin(stop);
+    });
+    Profile profile;
+    auto status = SamplingProfiler::instance().collect(std::chrono::milliseconds(500), 500, profile);
+    stop = true;
+    worker.join();
+    ASSERT_EQ(status, StatusCode::OK);
+    EXPECT_GT(profile.getSamplesCount(), 0);
+    const auto folded = profile.toFolded();
+    const auto stack = folded.find("ovms_test_busy;[busy_loop];");
+    ASSERT_NE(stack, std::string::npos);
+    // frame pointers are walked up to the thread entry, not only the interrupted function
+    const auto line = folded.substr(stack, folded.find('\n', stack) - stack);
+    EXPECT_GE(std::count(line.begin(), line.end(), ';'), 3) << line;
+}
+
+TEST(SamplingProfiler, ConcurrentProfileIsRejected) {
+    std::thread first([]() {
+        Profile profile;
+        SamplingProfiler::instance().collect(std::chrono::milliseconds(1000), 99, profile);
+    });
+    const auto waitEnd = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!SamplingProfiler::instance().isSampling() && std::chrono::steady_clock::now() < waitEnd) {
+        std::this_thread::yield();
+    }
+    // first profile holds the profiler until its duration is over, long after it started sampling
+    const bool started = SamplingProfiler::instance().isSampling();
+    if (started) {
+        Profile profile;
+        EXPECT_EQ(SamplingProfiler::instance().collect(std::chrono::milliseconds(100), 99, profile), StatusCode::PROFILER_BUSY);
+    }
+    first.join();
+    EXPECT_TRUE(started) << "first profile did not start";
+}
@@ -0,0 +1,60 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../saturation.hpp"
+
+using namespace ovms;
+
+static ModelSaturation createModelSaturation(uint64_t inFlightRequests, size_t streams) {
+    ModelSaturation saturation;
+    saturation.name = "dummy";
+    saturation.version = 1;
+    saturation.inFlightRequests = inFlightRequests;
+    saturation.streams = streams;
+    return saturation;
+}
+
+TEST(Saturation, ModelSaturation) {
+    EXPECT_DOUBLE_EQ(createModelSaturation(0, 4).saturation(), 0.0);
+    EXPECT_DOUBLE_EQ(createModelSaturation(2, 4).saturation(), 0.5);
+    EXPECT_DOUBLE_EQ(createModelSaturation(8, 4).saturation(), 2.0);
+    EXPECT_DOUBLE_EQ(createModelSaturation(3, 0).saturation(), 0.0);
+}
+
+TEST(Saturation, BusiestModelWins) {
+    std::vector<ModelSaturation> models{createModelSaturation(1, 4), createModelSaturation(6, 2)};
+    EXPECT_DOUBLE_EQ(SaturationMonitor::computeSaturation(models, 7), 3.0);
+}
+
+TEST(Saturation, NetworkRequestsPerStream) {
+    // requests waiting for network threads are not visible in models yet
+    std::vector<ModelSaturation> models{createModelSaturation(1, 4), createModelSaturation(1, 4)};
+    EXPECT_DOUBLE_EQ(SaturationMonitor::computeSaturation(models, 12), 1.5);
+}
+
+TEST(Saturation, NoModels) {
+    EXPECT_DOUBLE_EQ(SaturationMonitor::computeSaturation({}, 5), 0.0);
+}
+
+TEST(Saturation, DisabledByDefault) {
+    auto& monitor = SaturationMonitor::instance();
+    monitor.configure(0.0, true);
+    EXPECT_FALSE(monitor.isSaturated());
+    EXPECT_FALSE(monitor.shouldShedRequest());
+}
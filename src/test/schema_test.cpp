@@ -606,6 +606,98 @@ TEST(SchemaTest, PipelineConfigNodesInputsInvalid) {
     EXPECT_EQ(result, ovms::StatusCode::JSON_INVALID);
 }
 
+TEST(SchemaTest, PipelineConfigWithCustomNodeMatchingSchema) {
+    const char* pipelineConfigWithCustomNode = R"(
+    {
+        "model_config_list": [],
+        "custom_node_library_config_list": [
+            {"name": "lib_add_one", "base_path": "/ovms/lib/libadd_one.so"}
+        ],
+        "pipeline_config_list": [
+            {
+                "name": "pipeline1Custom",
+                "inputs": ["custom_input"],
+                "nodes": [
+                    {
+                        "name": "customNode",
+                        "library_name": "lib_add_one",
+                        "type": "custom",
+                        "params": {"added_value": "1"},
+                        "inputs": [
+                            {"input_numbers": {"node_name": "request",
+                                "data_item": "custom_input"}}
+                        ],
+                        "outputs": [
+                            {"data_item": "output_numbers",
+                            "alias": "custom_node_output"}
+                        ]
+                    }
+                ],
+                "outputs": [
+                    {"custom_output": {"node_name": "customNode",
+                                        "data_item": "custom_node_output"}
+                    }
+                ]
+            }
+        ]
+    })";
+
+    rapidjson::Document pipelineConfigWithCustomNodeParsed;
+    pipelineConfigWithCustomNodeParsed.Parse(pipelineConfigWithCustomNode);
+    auto result = ovms::validateJsonAgainstSchema(pipelineConfigWithCustomNodeParsed, ovms::MODELS_CONFIG_SCHEMA);
+    EXPECT_EQ(result, ovms::StatusCode::OK);
+}
+
+TEST(SchemaTest, PipelineConfigCustomNodeParamsInvalidType) {
+    const char* pipelineConfigCustomNodeParamsInvalidType = R"(
+    {
+        "model_config_list": [],
+        "custom_node_library_config_list": [
+            {"name": "lib_add_one", "base_path": "/ovms/lib/libadd_one.so"}
+        ],
+        "pipeline_config_list": [
+            {
+                "name": "pipeline1Custom",
+                "inputs": ["custom_input"],
+                "nodes": [
+                    {
+                        "name": "customNode",
+                        "library_name": "lib_add_one",
+                        "type": "custom",
+                        "params": {"added_value": 1},
+                        "inputs": [
+                            {"input_numbers": {"node_name": "request",
+                                "data_item": "custom_input"}}
+                        ],
+                        "outputs": [
+                            {"data_item": "output_numbers",
+                            "alias": "custom_node_output"}
+                        ]
+                    }
+                ],
+                "outputs": [
+                    {"custom_output": {"node_name": "customNode",
+                                        "data_item": "custom_node_output"}
+                    }
+                ]
+            }
+        ]
+    })";
+
+    rapidjson::Document pipelineConfigCustomNodeParamsInvalidTypeParsed;
+    pipelineConfigCustomNodeParamsInvalidTypeParsed.Parse(pipelineConfigCustomNodeParamsInvalidType);
+    auto result = ovms::validateJsonAgainstSchema(pipelineConfigCustomNodeParamsInvalidTypeParsed, ovms::MODELS_CONFIG_SCHEMA);
+    EXPECT_EQ(result, ovms::StatusCode::JSON_INVALID);
+}
+
+TEST(SchemaTest, SchemaIsCompiledOnce) {
+    auto compiled = ovms::getCompiledSchema(ovms::MODELS_CONFIG_SCHEMA);
+    ASSERT_NE(nullptr, compiled);
+    EXPECT_EQ(compiled, ovms::getCompiledSchema(ovms::MODELS_CONFIG_SCHEMA));
+    EXPECT_NE(compiled, ovms::getCompiledSchema(ovms::MODELS_MAPPING_INPUTS_SCHEMA));
+    EXPECT_EQ(nullptr, ovms::getCompiledSchema("{not a json"));
+}
+
 TEST(SchemaTest, parseModelMappingWhenJsonMatchSchema) {
     const char* mappingConfigMatchSchema = R"({
        "inputs":{
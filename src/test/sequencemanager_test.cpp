@@ -0,0 +1,316 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../modelinstance.hpp"
+#include "../modelinstanceunloadguard.hpp"
+#include "../prediction_service_utils.hpp"
+#include "../sequencemanager.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+namespace {
+void addUint64Input(PredictRequest& request, const std::string& name, uint64_t value) {
+    auto& proto = (*request.mutable_inputs())[name];
+    proto.set_dtype(tensorflow::DataType::DT_UINT64);
+    proto.mutable_tensor_shape()->add_dim()->set_size(1);
+    proto.add_uint64_val(value);
+}
+
+SequenceProcessingSpec spec(uint32_t control, uint64_t sequenceId) {
+    SequenceProcessingSpec spec;
+    spec.control = control;
+    spec.sequenceId = sequenceId;
+    return spec;
+}
+}  // namespace
+
+TEST(SequenceManager, StartGeneratesIdWhenNotProvided) {
+    SequenceManager manager("model", 10, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> first, second;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), first), StatusCode::OK);
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), second), StatusCode::OK);
+    EXPECT_NE(first->getId(), 0);
+    EXPECT_NE(first->getId(), second->getId());
+    EXPECT_EQ(manager.getSequencesCount(), 2);
+}
+
+TEST(SequenceManager, StartWithExistingIdFails) {
+    SequenceManager manager("model", 10, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> sequence;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 42), sequence), StatusCode::OK);
+    EXPECT_EQ(sequence->getId(), 42);
+    EXPECT_EQ(manager.getSequence(spec(SEQUENCE_START, 42), sequence), StatusCode::SEQUENCE_ALREADY_EXISTS);
+}
+
+TEST(SequenceManager, GeneratedIdSkipsUsedOnes) {
+    SequenceManager manager("model", 10, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> sequence;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 1), sequence), StatusCode::OK);
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), sequence), StatusCode::OK);
+    EXPECT_EQ(sequence->getId(), 2);
+}
+
+TEST(SequenceManager, ContinuedSequenceIsFound) {
+    SequenceManager manager("model", 10, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> started, continued;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 7), started), StatusCode::OK);
+    ASSERT_EQ(manager.getSequence(spec(NO_CONTROL_INPUT, 7), continued), StatusCode::OK);
+    EXPECT_EQ(started, continued);
+}
+
+TEST(SequenceManager, MissingSequenceIdFails) {
+    SequenceManager manager("model", 10, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> sequence;
+    EXPECT_EQ(manager.getSequence(spec(NO_CONTROL_INPUT, 0), sequence), StatusCode::SEQUENCE_ID_NOT_PROVIDED);
+    EXPECT_EQ(manager.getSequence(spec(SEQUENCE_END, 0), sequence), StatusCode::SEQUENCE_ID_NOT_PROVIDED);
+    EXPECT_EQ(manager.getSequence(spec(NO_CONTROL_INPUT, 3), sequence), StatusCode::SEQUENCE_MISSING);
+}
+
+TEST(SequenceManager, RemovedSequenceIsTerminated) {
+    SequenceManager manager("model", 10, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> sequence;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 5), sequence), StatusCode::OK);
+    manager.removeSequence(5);
+    EXPECT_TRUE(sequence->isTerminated());
+    EXPECT_EQ(manager.getSequencesCount(), 0);
+    std::shared_ptr<Sequence> removed;
+    EXPECT_EQ(manager.getSequence(spec(NO_CONTROL_INPUT, 5), removed), StatusCode::SEQUENCE_MISSING);
+    // removed id can be started again
+    EXPECT_EQ(manager.getSequence(spec(SEQUENCE_START, 5), removed), StatusCode::OK);
+}
+
+TEST(SequenceManager, MaxSequenceNumberIsEnforced) {
+    SequenceManager manager("model", 2, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> sequence;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), sequence), StatusCode::OK);
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), sequence), StatusCode::OK);
+    EXPECT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), sequence), StatusCode::MAX_SEQUENCE_NUMBER_REACHED);
+    manager.removeSequence(sequence->getId());
+    EXPECT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), sequence), StatusCode::OK);
+}
+
+TEST(SequenceManager, IdleSequencesAreRemoved) {
+    SequenceManager manager("model", 10, std::chrono::seconds(1));
+    std::shared_ptr<Sequence> sequence;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 9), sequence), StatusCode::OK);
+    EXPECT_EQ(manager.removeIdleSequences(std::chrono::steady_clock::now()), 0);
+    EXPECT_EQ(manager.removeIdleSequences(std::chrono::steady_clock::now() + std::chrono::seconds(2)), 1);
+    EXPECT_TRUE(sequence->isTerminated());
+    EXPECT_EQ(manager.getSequencesCount(), 0);
+}
+
+TEST(SequenceManager, ZeroTimeoutKeepsIdleSequences) {
+    SequenceManager manager("model", 10, std::chrono::seconds(0));
+    std::shared_ptr<Sequence> sequence;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 9), sequence), StatusCode::OK);
+    EXPECT_EQ(manager.removeIdleSequences(std::chrono::steady_clock::now() + std::chrono::hours(24)), 0);
+    EXPECT_EQ(manager.getSequencesCount(), 1);
+}
+
+TEST(SequenceManager, ClearTerminatesAllSequences) {
+    SequenceManager manager("model", 10, std::chrono::seconds(60));
+    std::shared_ptr<Sequence> first, second;
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), first), StatusCode::OK);
+    ASSERT_EQ(manager.getSequence(spec(SEQUENCE_START, 0), second), StatusCode::OK);
+    manager.clear();
+    EXPECT_TRUE(first->isTerminated());
+    EXPECT_TRUE(second->isTerminated());
+    EXPECT_EQ(manager.getSequencesCount(), 0);
+}
+
+TEST(SequenceProcessingSpec, NoSpecialInputs) {
+    PredictRequest request;
+    SequenceProcessingSpec result;
+    ASSERT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::OK);
+    EXPECT_EQ(result.control, NO_CONTROL_INPUT);
+    EXPECT_EQ(result.sequenceId, 0);
+    EXPECT_EQ(countSequenceSpecialInputs(request), 0);
+}
+
+TEST(SequenceProcessingSpec, Uint64Inputs) {
+    PredictRequest request;
+    addUint64Input(request, SEQUENCE_ID_INPUT, 12345678901234ull);
+    addUint64Input(request, SEQUENCE_CONTROL_INPUT, SEQUENCE_END);
+    (*request.mutable_inputs())["b"];
+    SequenceProcessingSpec result;
+    ASSERT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::OK);
+    EXPECT_EQ(result.sequenceId, 12345678901234ull);
+    EXPECT_EQ(result.control, SEQUENCE_END);
+    EXPECT_EQ(countSequenceSpecialInputs(request), 2);
+}
+
+TEST(SequenceProcessingSpec, Int32InputsOfRestRequests) {
+    PredictRequest request;
+    auto& id = (*request.mutable_inputs())[SEQUENCE_ID_INPUT];
+    id.set_dtype(tensorflow::DataType::DT_INT32);
+    id.add_int_val(17);
+    auto& control = (*request.mutable_inputs())[SEQUENCE_CONTROL_INPUT];
+    control.set_dtype(tensorflow::DataType::DT_INT32);
+    control.add_int_val(SEQUENCE_START);
+    SequenceProcessingSpec result;
+    ASSERT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::OK);
+    EXPECT_EQ(result.sequenceId, 17);
+    EXPECT_EQ(result.control, SEQUENCE_START);
+}
+
+TEST(SequenceProcessingSpec, TensorContent) {
+    PredictRequest request;
+    auto& id = (*request.mutable_inputs())[SEQUENCE_ID_INPUT];
+    id.set_dtype(tensorflow::DataType::DT_UINT64);
+    const uint64_t value = 99;
+    id.mutable_tensor_content()->assign(reinterpret_cast<const char*>(&value), sizeof(value));
+    SequenceProcessingSpec result;
+    ASSERT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::OK);
+    EXPECT_EQ(result.sequenceId, 99);
+}
+
+TEST(SequenceProcessingSpec, InvalidInputs) {
+    SequenceProcessingSpec result;
+    {
+        PredictRequest request;
+        auto& id = (*request.mutable_inputs())[SEQUENCE_ID_INPUT];
+        id.set_dtype(tensorflow::DataType::DT_INT64);
+        id.add_int64_val(-1);
+        EXPECT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT);
+    }
+    {
+        PredictRequest request;
+        auto& id = (*request.mutable_inputs())[SEQUENCE_ID_INPUT];
+        id.set_dtype(tensorflow::DataType::DT_FLOAT);
+        id.add_float_val(1);
+        EXPECT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT);
+    }
+    {
+        PredictRequest request;
+        auto& id = (*request.mutable_inputs())[SEQUENCE_ID_INPUT];
+        id.set_dtype(tensorflow::DataType::DT_UINT64);
+        id.add_uint64_val(1);
+        id.add_uint64_val(2);
+        EXPECT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::INVALID_SEQUENCE_SPECIAL_INPUT);
+    }
+    {
+        PredictRequest request;
+        addUint64Input(request, SEQUENCE_CONTROL_INPUT, 3);
+        EXPECT_EQ(extractSequenceProcessingSpec(request, result), StatusCode::INVALID_SEQUENCE_CONTROL_INPUT);
+    }
+}
+
+TEST(SequenceProcessingSpec, SequenceIdOutput) {
+    PredictResponse response;
+    addSequenceIdOutput(12345678901234ull, response);
+    ASSERT_EQ(response.outputs().count(SEQUENCE_ID_INPUT), 1);
+    const auto& output = response.outputs().at(SEQUENCE_ID_INPUT);
+    EXPECT_EQ(output.dtype(), tensorflow::DataType::DT_UINT64);
+    ASSERT_EQ(output.tensor_shape().dim_size(), 1);
+    EXPECT_EQ(output.tensor_shape().dim(0).size(), 1);
+    ASSERT_EQ(output.tensor_content().size(), sizeof(uint64_t));
+    uint64_t value = 0;
+    std::memcpy(&value, output.tensor_content().data(), sizeof(value));
+    EXPECT_EQ(value, 12345678901234ull);
+}
+
+class StatefulModelInference : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ovms::ModelConfig config = DUMMY_MODEL_CONFIG;
+        config.setStateful(true);
+        ASSERT_EQ(modelInstance.loadModel(config), StatusCode::OK);
+    }
+
+    static PredictRequest prepareRequest(uint32_t control, uint64_t sequenceId) {
+        PredictRequest request;
+        request.mutable_model_spec()->set_name("dummy");
+        auto& input = (*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME];
+        std::vector<float> data(DUMMY_MODEL_INPUT_SIZE, 1.0);
+        input.set_dtype(tensorflow::DataType::DT_FLOAT);
+        input.mutable_tensor_shape()->add_dim()->set_size(1);
+        input.mutable_tensor_shape()->add_dim()->set_size(DUMMY_MODEL_INPUT_SIZE);
+        input.mutable_tensor_content()->assign(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+        if (control != NO_CONTROL_INPUT) {
+            addUint64Input(request, SEQUENCE_CONTROL_INPUT, control);
+        }
+        if (sequenceId != 0) {
+            addUint64Input(request, SEQUENCE_ID_INPUT, sequenceId);
+        }
+        return request;
+    }
+
+    Status infer(const PredictRequest& request, PredictResponse& response, const deadline_t& deadline = NO_DEADLINE) {
+        auto unloadGuard = std::make_unique<ModelInstanceUnloadGuard>(modelInstance);
+        return ovms::inference(modelInstance, &request, &response, unloadGuard, deadline);
+    }
+
+    static uint64_t getSequenceId(const PredictResponse& response) {
+        const auto& output = response.outputs().at(SEQUENCE_ID_INPUT);
+        EXPECT_EQ(output.dtype(), tensorflow::DataType::DT_UINT64);
+        uint64_t sequenceId = 0;
+        EXPECT_EQ(output.tensor_content().size(), sizeof(sequenceId));
+        std::memcpy(&sequenceId, output.tensor_content().data(), sizeof(sequenceId));
+        return sequenceId;
+    }
+
+    ModelInstance modelInstance{"dummy", 1};
+};
+
+TEST_F(StatefulModelInference, SequenceIsStartedContinuedAndEnded) {
+    PredictResponse response;
+    ASSERT_EQ(infer(prepareRequest(SEQUENCE_START, 0), response), StatusCode::OK);
+    const uint64_t sequenceId = getSequenceId(response);
+    ASSERT_NE(sequenceId, 0);
+    ASSERT_EQ(response.outputs().count(DUMMY_MODEL_OUTPUT_NAME), 1);
+    EXPECT_EQ(modelInstance.getSequenceManager()->getSequencesCount(), 1);
+
+    response.Clear();
+    ASSERT_EQ(infer(prepareRequest(NO_CONTROL_INPUT, sequenceId), response), StatusCode::OK);
+    EXPECT_EQ(getSequenceId(response), sequenceId);
+
+    response.Clear();
+    ASSERT_EQ(infer(prepareRequest(SEQUENCE_END, sequenceId), response), StatusCode::OK);
+    EXPECT_EQ(getSequenceId(response), sequenceId);
+    EXPECT_EQ(modelInstance.getSequenceManager()->getSequencesCount(), 0);
+
+    response.Clear();
+    EXPECT_EQ(infer(prepareRequest(NO_CONTROL_INPUT, sequenceId), response), StatusCode::SEQUENCE_MISSING);
+}
+
+TEST_F(StatefulModelInference, WaitForPreviousRequestOfSequenceStopsAtDeadline) {
+    PredictResponse response;
+    ASSERT_EQ(infer(prepareRequest(SEQUENCE_START, 7), response), StatusCode::OK);
+    std::shared_ptr<Sequence> sequence;
+    ASSERT_EQ(modelInstance.getSequenceManager()->getSequence(spec(NO_CONTROL_INPUT, 7), sequence), StatusCode::OK);
+    {
+        // previous request of the sequence is still being inferred
+        std::lock_guard<std::timed_mutex> previousRequest(sequence->getMutex());
+        response.Clear();
+        const auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(infer(prepareRequest(NO_CONTROL_INPUT, 7), response, start + std::chrono::milliseconds(20)), StatusCode::DEADLINE_EXCEEDED);
+        EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    }
+    response.Clear();
+    EXPECT_EQ(infer(prepareRequest(NO_CONTROL_INPUT, 7), response), StatusCode::OK);
+}
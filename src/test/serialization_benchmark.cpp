@@ -0,0 +1,296 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+// Microbenchmarks of request and response conversions, run with: bazel run -c opt //src:ovms_serialization_benchmark
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <inference_engine.hpp>
+#include <spdlog/spdlog.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "../deserialization.hpp"
+#include "../rest_parser.hpp"
+#include "../rest_utils.hpp"
+#include "../serialization.hpp"
+#include "../tensorinfo.hpp"
+
+using namespace ovms;
+using namespace tensorflow::serving;
+
+using InferenceEngine::Precision;
+
+namespace {
+const std::string TENSOR_NAME = "tensor";
+
+/**
+ * @brief Infer request keeping blobs set on it, stands in for the network so that only conversions are measured
+ */
+class BlobStorageInferRequest : public InferenceEngine::IInferRequest {
+    std::map<std::string, InferenceEngine::Blob::Ptr> blobs;
+
+public:
+    InferenceEngine::StatusCode SetBlob(const char* name, const InferenceEngine::Blob::Ptr& data, InferenceEngine::ResponseDesc*) noexcept override {
+        blobs[name] = data;
+        return InferenceEngine::StatusCode::OK;
+    }
+    InferenceEngine::StatusCode SetBlob(const char* name, const InferenceEngine::Blob::Ptr& data, const InferenceEngine::PreProcessInfo&, InferenceEngine::ResponseDesc*) noexcept override {
+        blobs[name] = data;
+        return InferenceEngine::StatusCode::OK;
+    }
+    InferenceEngine::StatusCode GetBlob(const char* name, InferenceEngine::Blob::Ptr& data, InferenceEngine::ResponseDesc*) noexcept override {
+        auto it = blobs.find(name);
+        if (it == blobs.end()) {
+            return InferenceEngine::StatusCode::NOT_FOUND;
+        }
+        data = it->second;
+        return InferenceEngine::StatusCode::OK;
+    }
+    InferenceEngine::StatusCode GetPreProcess(const char*, const InferenceEngine::PreProcessInfo**, InferenceEngine::ResponseDesc*) const noexcept override {
+        return InferenceEngine::StatusCode::NOT_IMPLEMENTED;
+    }
+    InferenceEngine::StatusCode Infer(InferenceEngine::ResponseDesc*) noexcept override { return InferenceEngine::StatusCode::OK; }
+    InferenceEngine::StatusCode StartAsync(InferenceEngine::ResponseDesc*) noexcept override { return InferenceEngine::StatusCode::OK; }
+    InferenceEngine::StatusCode Wait(int64_t, InferenceEngine::ResponseDesc*) noexcept override { return InferenceEngine::StatusCode::OK; }
+    InferenceEngine::StatusCode GetUserData(void**, InferenceEngine::ResponseDesc*) noexcept override { return InferenceEngine::StatusCode::NOT_IMPLEMENTED; }
+    InferenceEngine::StatusCode SetUserData(void*, InferenceEngine::ResponseDesc*) noexcept override { return InferenceEngine::StatusCode::NOT_IMPLEMENTED; }
+    InferenceEngine::StatusCode SetCompletionCallback(IInferRequest::CompletionCallback) noexcept override { return InferenceEngine::StatusCode::NOT_IMPLEMENTED; }
+    InferenceEngine::StatusCode SetBatch(int, InferenceEngine::ResponseDesc*) noexcept override { return InferenceEngine::StatusCode::NOT_IMPLEMENTED; }
+    InferenceEngine::StatusCode GetPerformanceCounts(std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>&, InferenceEngine::ResponseDesc*) const noexcept override {
+        return InferenceEngine::StatusCode::NOT_IMPLEMENTED;
+    }
+    InferenceEngine::StatusCode QueryState(InferenceEngine::IVariableState::Ptr&, size_t, InferenceEngine::ResponseDesc*) noexcept override {
+        return InferenceEngine::StatusCode::NOT_IMPLEMENTED;
+    }
+    void Release() noexcept override {}
+};
+
+/**
+ * @brief Tensor of given precision with 2 dimensions: batch and the rest of bytes
+ */
+struct TensorFixture {
+    tensor_map_t tensors;
+    std::shared_ptr<TensorInfo> info;
+    size_t batchSize;
+    size_t valuesCount;
+    size_t bytes;
+
+    TensorFixture(Precision precision, size_t bytes, size_t batchSize) :
+        batchSize(batchSize) {
+        valuesCount = bytes / precision.size() / batchSize * batchSize;
+        this->bytes = valuesCount * precision.size();
+        info = std::make_shared<TensorInfo>(TENSOR_NAME, precision, shape_t{batchSize, valuesCount / batchSize}, InferenceEngine::Layout::NC);
+        tensors[TENSOR_NAME] = info;
+    }
+
+    /**
+     * @brief Values which stay exact after conversions and are valid numbers in every precision
+     */
+    std::string makeContent() const {
+        std::string content(bytes, '\0');
+        char* data = content.data();
+        for (size_t i = 0; i < valuesCount; i++) {
+            switch (info->getPrecision()) {
+            case Precision::FP32: {
+                float value = static_cast<float>(i % 100) * 0.25f;
+                std::memcpy(data + i * sizeof(value), &value, sizeof(value));
+                break;
+            }
+            case Precision::FP16: {
+                uint16_t one = 0x3C00;
+                std::memcpy(data + i * sizeof(one), &one, sizeof(one));
+                break;
+            }
+            case Precision::U8:
+                data[i] = static_cast<char>(i % 256);
+                break;
+            case Precision::I32: {
+                int32_t value = static_cast<int32_t>(i % 1000) - 500;
+                std::memcpy(data + i * sizeof(value), &value, sizeof(value));
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        return content;
+    }
+
+    void fillTensorProto(tensorflow::TensorProto& proto) const {
+        proto.set_dtype(info->getPrecisionAsDataType());
+        auto shape = proto.mutable_tensor_shape();
+        shape->Clear();
+        for (auto dim : info->getShape()) {
+            shape->add_dim()->set_size(dim);
+        }
+        *proto.mutable_tensor_content() = makeContent();
+    }
+
+    InferenceEngine::Blob::Ptr makeBlob() const {
+        auto blob = allocateConvertedBlob(info->getTensorDesc());
+        auto content = makeContent();
+        std::memcpy(blob->buffer().as<char*>(), content.data(), content.size());
+        return blob;
+    }
+
+    /**
+     * @brief Request JSON in given order, written the same way as responses and renamed to what parser expects
+     */
+    std::string makeRequestJson(Order order) const {
+        PredictResponse response;
+        fillTensorProto((*response.mutable_outputs())[TENSOR_NAME]);
+        std::string json;
+        if (!makeJsonFromPredictResponse(response, &json, order).ok()) {
+            throw std::runtime_error("failed to write request json");
+        }
+        const std::string from = order == Order::ROW ? "\"predictions\"" : "\"outputs\"";
+        const std::string to = order == Order::ROW ? "\"instances\"" : "\"inputs\"";
+        json.replace(json.find(from), from.size(), to);
+        return json;
+    }
+};
+
+Precision getPrecision(int64_t arg) {
+    return static_cast<Precision::ePrecision>(arg);
+}
+
+// args: precision, tensor bytes, batch size
+void tensorSizes(benchmark::internal::Benchmark* benchmark) {
+    for (auto precision : {Precision::FP32, Precision::FP16, Precision::U8, Precision::I32}) {
+        for (int64_t bytes : {1 << 10, 16 << 10, 256 << 10, 4 << 20, 64 << 20}) {
+            for (int64_t batchSize : {1, 8}) {
+                benchmark->Args({static_cast<int64_t>(precision), bytes, batchSize});
+            }
+        }
+    }
+    benchmark->ArgNames({"precision", "bytes", "batch"});
+}
+
+void setBytesProcessed(benchmark::State& state, const TensorFixture& fixture) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * fixture.bytes));
+    state.SetLabel(getPrecision(state.range(0)).name());
+}
+}  // namespace
+
+// Request tensor content into infer request blobs, FP16 is converted into preallocated blob like in model instance
+static void BM_DeserializePredictRequest(benchmark::State& state) {
+    TensorFixture fixture(getPrecision(state.range(0)), state.range(1), state.range(2));
+    PredictRequest request;
+    fixture.fillTensorProto((*request.mutable_inputs())[TENSOR_NAME]);
+    InferenceEngine::InferRequest inferRequest(std::make_shared<BlobStorageInferRequest>());
+    blob_map_t preallocatedBlobs{{TENSOR_NAME, fixture.makeBlob()}};
+    inferRequest.SetBlob(TENSOR_NAME, preallocatedBlobs[TENSOR_NAME]);
+    for (auto _ : state) {
+        auto status = deserializePredictRequest<ConcreteTensorProtoDeserializator>(request, fixture.tensors, inferRequest, &preallocatedBlobs);
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+    }
+    setBytesProcessed(state, fixture);
+}
+BENCHMARK(BM_DeserializePredictRequest)->Apply(tensorSizes);
+
+// Output blobs of infer request into a fresh response, the way each predict request is answered
+static void BM_SerializePredictResponse(benchmark::State& state) {
+    TensorFixture fixture(getPrecision(state.range(0)), state.range(1), state.range(2));
+    InferenceEngine::InferRequest inferRequest(std::make_shared<BlobStorageInferRequest>());
+    inferRequest.SetBlob(TENSOR_NAME, fixture.makeBlob());
+    for (auto _ : state) {
+        PredictResponse response;
+        auto status = serializePredictResponse(inferRequest, fixture.tensors, &response);
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(response);
+    }
+    setBytesProcessed(state, fixture);
+}
+BENCHMARK(BM_SerializePredictResponse)->Apply(tensorSizes);
+
+static void restParserParse(benchmark::State& state, Order order) {
+    TensorFixture fixture(getPrecision(state.range(0)), state.range(1), state.range(2));
+    const std::string json = fixture.makeRequestJson(order);
+    RestParser parser(fixture.tensors);
+    for (auto _ : state) {
+        parser.reset(fixture.tensors);
+        auto status = parser.parse(json.c_str());
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+    }
+    setBytesProcessed(state, fixture);
+    state.counters["json_bytes"] = static_cast<double>(json.size());
+}
+
+// Bytes processed are counted in tensor bytes, json_bytes counter shows the size of parsed text
+static void BM_RestParserParseRow(benchmark::State& state) {
+    restParserParse(state, Order::ROW);
+}
+BENCHMARK(BM_RestParserParseRow)->Apply(tensorSizes);
+
+static void BM_RestParserParseColumn(benchmark::State& state) {
+    restParserParse(state, Order::COLUMN);
+}
+BENCHMARK(BM_RestParserParseColumn)->Apply(tensorSizes);
+
+static void writeJson(benchmark::State& state, Order order) {
+    TensorFixture fixture(getPrecision(state.range(0)), state.range(1), state.range(2));
+    PredictResponse response;
+    fixture.fillTensorProto((*response.mutable_outputs())[TENSOR_NAME]);
+    std::string json;
+    for (auto _ : state) {
+        auto status = makeJsonFromPredictResponse(response, &json, order);
+        if (!status.ok()) {
+            state.SkipWithError(status.string().c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(json);
+    }
+    setBytesProcessed(state, fixture);
+    state.counters["json_bytes"] = static_cast<double>(json.size());
+}
+
+static void BM_MakeJsonFromPredictResponseRow(benchmark::State& state) {
+    writeJson(state, Order::ROW);
+}
+BENCHMARK(BM_MakeJsonFromPredictResponseRow)->Apply(tensorSizes);
+
+static void BM_MakeJsonFromPredictResponseColumn(benchmark::State& state) {
+    writeJson(state, Order::COLUMN);
+}
+BENCHMARK(BM_MakeJsonFromPredictResponseColumn)->Apply(tensorSizes);
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::err);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
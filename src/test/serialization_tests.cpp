@@ -62,7 +62,7 @@ const std::vector<Precision> SUPPORTED_OUTPUT_PRECISIONS{
     Precision::I32,
     Precision::I64,
     // Precision::BIN,
-    // Precision::BOOL
+    Precision::BOOL
     // //Precision::CUSTOM)
 };
 
@@ -79,7 +79,7 @@ const std::vector<Precision> UNSUPPORTED_OUTPUT_PRECISIONS{
     // Precision::I32,
     // Precision::I64,
     Precision::BIN,
-    Precision::BOOL
+    // Precision::BOOL
     // Precision::CUSTOM),
 };
 
@@ -163,6 +163,86 @@ TEST_P(SerializeTFTensorProto, SerializeTensorProtoShouldSucceedForPrecision) {
         << "should succeed";
 }
 
+TEST(SerializeTFTensorProtoFp16, ShouldWidenFp16OutputToFp32) {
+    auto networkOutput = std::make_shared<ovms::TensorInfo>("output", Precision::FP16, shape_t{1, 3}, InferenceEngine::Layout::NC);
+    std::vector<uint16_t> data{0x3C00, 0xC000, 0x3800};
+    auto blob = InferenceEngine::make_shared_blob<uint16_t>(networkOutput->getTensorDesc(), data.data());
+    TensorProto responseOutput;
+    auto status = serializeBlobToTensorProto(responseOutput, networkOutput, blob);
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(responseOutput.dtype(), tensorflow::DataType::DT_FLOAT);
+    ASSERT_EQ(responseOutput.tensor_content().size(), data.size() * sizeof(float));
+    const float* values = reinterpret_cast<const float*>(responseOutput.tensor_content().data());
+    EXPECT_EQ(values[0], 1.0f);
+    EXPECT_EQ(values[1], -2.0f);
+    EXPECT_EQ(values[2], 0.5f);
+}
+
+TEST(SerializeTFTensorProtoFp16, ShouldSendPackedHalfValuesWhenConfigured) {
+    auto networkOutput = std::make_shared<ovms::TensorInfo>("output", Precision::FP16, shape_t{2, 3}, InferenceEngine::Layout::NC);
+    networkOutput->setHalfPrecisionResponse(true);
+    std::vector<uint16_t> data{0x3C00, 0xC000, 0x3800, 0x0001, 0x7BFF, 0x8000};
+    auto blob = InferenceEngine::make_shared_blob<uint16_t>(networkOutput->getTensorDesc(), data.data());
+    TensorProto responseOutput;
+    auto status = serializeBlobBatchToTensorProto(responseOutput, networkOutput, blob, 1, 1);
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(responseOutput.dtype(), tensorflow::DataType::DT_HALF);
+    EXPECT_EQ(responseOutput.tensor_content(), std::string(reinterpret_cast<const char*>(data.data() + 3), 3 * sizeof(uint16_t)));
+}
+
+TEST(SerializeTFTensorProtoEncoding, ShouldNarrowFp32OutputWhenConfigured) {
+    auto networkOutput = std::make_shared<ovms::TensorInfo>("output", Precision::FP32, shape_t{1, 3}, InferenceEngine::Layout::NC);
+    std::vector<float> data{1.0f, -2.0f, 0.5f};
+    auto blob = InferenceEngine::make_shared_blob<float>(networkOutput->getTensorDesc(), data.data());
+    TensorProto responseOutput;
+    networkOutput->setOutputEncoding(ovms::OutputEncoding::FP16);
+    ASSERT_TRUE(serializeBlobToTensorProto(responseOutput, networkOutput, blob).ok());
+    EXPECT_EQ(responseOutput.dtype(), tensorflow::DataType::DT_HALF);
+    std::vector<uint16_t> expected{0x3C00, 0xC000, 0x3800};
+    EXPECT_EQ(responseOutput.tensor_content(), std::string(reinterpret_cast<const char*>(expected.data()), 3 * sizeof(uint16_t)));
+    networkOutput->setOutputEncoding(ovms::OutputEncoding::BF16);
+    ASSERT_TRUE(serializeBlobToTensorProto(responseOutput, networkOutput, blob).ok());
+    EXPECT_EQ(responseOutput.dtype(), tensorflow::DataType::DT_BFLOAT16);
+    expected = {0x3F80, 0xC000, 0x3F00};
+    EXPECT_EQ(responseOutput.tensor_content(), std::string(reinterpret_cast<const char*>(expected.data()), 3 * sizeof(uint16_t)));
+}
+
+TEST(SerializeTFTensorProtoEncoding, ShouldQuantizeEachBatchOfFp32OutputToI8) {
+    auto networkOutput = std::make_shared<ovms::TensorInfo>("output", Precision::FP32, shape_t{2, 4}, InferenceEngine::Layout::NC);
+    networkOutput->setOutputEncoding(ovms::OutputEncoding::I8);
+    std::vector<float> data{-1.0f, 0.0f, 1.0f, 1.55f, 10.0f, 20.0f, 40.0f, 51.0f};
+    auto blob = InferenceEngine::make_shared_blob<float>(networkOutput->getTensorDesc(), data.data());
+    TensorProto responseOutput;
+    OutputQuantization quantization;
+    ASSERT_TRUE(serializeBlobToTensorProto(responseOutput, networkOutput, blob, &quantization).ok());
+    EXPECT_EQ(responseOutput.dtype(), tensorflow::DataType::DT_INT8);
+    ASSERT_EQ(responseOutput.tensor_content().size(), data.size());
+    ASSERT_EQ(quantization.scales.size(), 2);
+    ASSERT_EQ(quantization.zeroPoints.size(), 2);
+    // first batch range is [-1, 1.55], second one is extended with zero to [0, 51]
+    EXPECT_FLOAT_EQ(quantization.scales[0], 0.01f);
+    EXPECT_EQ(quantization.zeroPoints[0], -28);
+    EXPECT_FLOAT_EQ(quantization.scales[1], 0.2f);
+    EXPECT_EQ(quantization.zeroPoints[1], -128);
+    const int8_t* values = reinterpret_cast<const int8_t*>(responseOutput.tensor_content().data());
+    for (size_t i = 0; i < data.size(); i++) {
+        const size_t batch = i / 4;
+        const float decoded = quantization.scales[batch] * (values[i] - quantization.zeroPoints[batch]);
+        EXPECT_NEAR(decoded, data[i], quantization.scales[batch] / 2 + 1e-5f) << "value: " << i;
+    }
+
+    PredictResponse response;
+    serializeOutputQuantization(response, "output", quantization);
+    const auto& scales = response.outputs().at("output_scale");
+    const auto& zeroPoints = response.outputs().at("output_zero_point");
+    EXPECT_EQ(scales.dtype(), tensorflow::DataType::DT_FLOAT);
+    EXPECT_EQ(zeroPoints.dtype(), tensorflow::DataType::DT_INT32);
+    ASSERT_EQ(scales.tensor_shape().dim_size(), 1);
+    EXPECT_EQ(scales.tensor_shape().dim(0).size(), 2);
+    EXPECT_EQ(scales.tensor_content(), std::string(reinterpret_cast<const char*>(quantization.scales.data()), 2 * sizeof(float)));
+    EXPECT_EQ(zeroPoints.tensor_content(), std::string(reinterpret_cast<const char*>(quantization.zeroPoints.data()), 2 * sizeof(int32_t)));
+}
+
 class SerializeTFTensorProtoNegative : public SerializeTFTensorProto {};
 
 TEST_P(SerializeTFTensorProtoNegative, SerializeTensorProtoShouldSucceedForPrecision) {
@@ -210,6 +290,35 @@ TEST_P(SerializeTFGRPCPredictResponse, ShouldSuccessForSupportedPrecision) {
     EXPECT_TRUE(status.ok());
 }
 
+TEST_F(SerializeTFGRPCPredictResponse, ShouldSkipOutputsNotInOutputFilter) {
+    auto inputs = getInputs(Precision::FP32);
+    InferenceEngine::InferRequest inferRequest = std::get<0>(inputs);
+    InferenceEngine::IInferRequest::Ptr& mInferRequestPtr(inferRequest);
+    MockIInferRequestProperGetBlob* mInferRequest = static_cast<MockIInferRequestProperGetBlob*>(mInferRequestPtr.get());
+    // unrequested output is not fetched from infer request
+    EXPECT_CALL(*mInferRequest, GetBlob_mocked(_, _, _)).Times(0);
+    PredictRequest request;
+    request.add_output_filter("Second");
+    PredictResponse response;
+    auto status = serializePredictResponse(inferRequest, std::get<1>(inputs), &response, nullptr, &request.output_filter());
+    EXPECT_TRUE(status.ok());
+    EXPECT_EQ(response.outputs_size(), 0);
+}
+
+TEST_F(SerializeTFGRPCPredictResponse, ShouldSerializeOutputsInOutputFilter) {
+    auto inputs = getInputs(Precision::FP32);
+    InferenceEngine::InferRequest inferRequest = std::get<0>(inputs);
+    InferenceEngine::IInferRequest::Ptr& mInferRequestPtr(inferRequest);
+    MockIInferRequestProperGetBlob* mInferRequest = static_cast<MockIInferRequestProperGetBlob*>(mInferRequestPtr.get());
+    EXPECT_CALL(*mInferRequest, GetBlob_mocked(_, _, _)).Times(1);
+    PredictRequest request;
+    request.add_output_filter("First");
+    PredictResponse response;
+    auto status = serializePredictResponse(inferRequest, std::get<1>(inputs), &response, nullptr, &request.output_filter());
+    EXPECT_TRUE(status.ok());
+    EXPECT_EQ(response.outputs().count("First"), 1);
+}
+
 class SerializeTFGRPCPredictResponseNegative : public SerializeTFGRPCPredictResponse {};
 
 TEST_P(SerializeTFGRPCPredictResponseNegative, ShouldFailForUnsupportedPrecision) {
@@ -236,6 +345,60 @@ TEST_F(SerializeTFGRPCPredictResponseNegative, OutputNameNotCreatedInInferenceSh
     EXPECT_EQ(status, ovms::StatusCode::OV_INTERNAL_SERIALIZATION_ERROR);
 }
 
+class ResponseOutputBlobsGuardTest : public ::testing::Test {
+public:
+    ovms::tensor_map_t getOutputs(const InferenceEngine::TensorDesc& tensorDesc) {
+        ovms::tensor_map_t tenMap;
+        tenMap["First"] = std::make_shared<ovms::TensorInfo>(
+            std::string("First"),
+            tensorDesc.getPrecision(),
+            tensorDesc.getDims(),
+            tensorDesc.getLayout());
+        return tenMap;
+    }
+};
+
+TEST_F(ResponseOutputBlobsGuardTest, SmallOutputShouldBeLeftForSerialization) {
+    InferenceEngine::TensorDesc tensorDesc(Precision::FP32, shape_t{1, 10}, InferenceEngine::Layout::NC);
+    std::shared_ptr<MockIInferRequestProperGetBlob> mInferRequestPtr =
+        std::make_shared<MockIInferRequestProperGetBlob>(tensorDesc);
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    EXPECT_CALL(*mInferRequestPtr, GetBlob_mocked(_, _, _)).Times(0);
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(0);
+    PredictResponse response;
+    ResponseOutputBlobsGuard guard(inferRequest);
+    auto status = guard.prepare(getOutputs(tensorDesc), &response);
+    EXPECT_TRUE(status.ok());
+    EXPECT_FALSE(guard.isInPlace("First"));
+    EXPECT_EQ(response.outputs().count("First"), 0);
+}
+
+TEST_F(ResponseOutputBlobsGuardTest, LargeOutputShouldBeSetOverResponseAndRestored) {
+    InferenceEngine::TensorDesc tensorDesc(Precision::FP32, shape_t{1, 256 * 1024}, InferenceEngine::Layout::NC);
+    std::shared_ptr<MockIInferRequestProperGetBlob> mInferRequestPtr =
+        std::make_shared<MockIInferRequestProperGetBlob>(tensorDesc);
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    // original blob is fetched once, serialization does not need it afterwards
+    EXPECT_CALL(*mInferRequestPtr, GetBlob_mocked(_, _, _)).Times(1);
+    // set over response content and set back on restore
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(2);
+    PredictResponse response;
+    auto outputs = getOutputs(tensorDesc);
+    {
+        ResponseOutputBlobsGuard guard(inferRequest);
+        auto status = guard.prepare(outputs, &response);
+        ASSERT_TRUE(status.ok());
+        EXPECT_TRUE(guard.isInPlace("First"));
+        status = serializePredictResponse(inferRequest, outputs, &response, &guard);
+        EXPECT_TRUE(status.ok());
+    }
+    const auto& output = response.outputs().at("First");
+    EXPECT_EQ(output.dtype(), tensorflow::DataType::DT_FLOAT);
+    ASSERT_EQ(output.tensor_shape().dim_size(), 2);
+    EXPECT_EQ(output.tensor_shape().dim(1).size(), 256 * 1024);
+    EXPECT_EQ(output.tensor_content().size(), 256 * 1024 * sizeof(float));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Test,
     SerializeTFTensorProto,
@@ -259,3 +422,99 @@ INSTANTIATE_TEST_SUITE_P(
     SerializeTFGRPCPredictResponseNegative,
     ::testing::ValuesIn(UNSUPPORTED_OUTPUT_PRECISIONS),
     ::testing::PrintToStringParamName());
+
+class SerializeReducedOutput : public ::testing::Test {
+public:
+    std::shared_ptr<ovms::TensorInfo> getOutput(ovms::OutputReductionType type, size_t k = 1) {
+        auto output = std::make_shared<ovms::TensorInfo>(std::string("prob"), Precision::FP32, shape_t{2, 6}, InferenceEngine::Layout::NC);
+        ovms::OutputReduction reduction;
+        reduction.type = type;
+        reduction.k = k;
+        output->setOutputReduction(reduction);
+        return output;
+    }
+
+    const std::vector<float> values{
+        0.1f, 0.5f, 0.2f, 0.0f, 0.9f, 0.3f,
+        0.7f, 0.1f, 0.1f, 0.8f, 0.0f, 0.2f};
+};
+
+TEST_F(SerializeReducedOutput, ArgmaxDropsLastDimension) {
+    PredictResponse response;
+    auto status = serializeReducedOutput(response, getOutput(ovms::OutputReductionType::ARGMAX), reinterpret_cast<const char*>(values.data()), shape_t{2, 6});
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    const auto& output = response.outputs().at("prob");
+    EXPECT_EQ(output.dtype(), tensorflow::DataType::DT_INT64);
+    ASSERT_EQ(output.tensor_shape().dim_size(), 1);
+    EXPECT_EQ(output.tensor_shape().dim(0).size(), 2);
+    ASSERT_EQ(output.tensor_content().size(), 2 * sizeof(int64_t));
+    auto indices = reinterpret_cast<const int64_t*>(output.tensor_content().data());
+    EXPECT_EQ(indices[0], 4);
+    EXPECT_EQ(indices[1], 3);
+}
+
+TEST_F(SerializeReducedOutput, TopKSendsValuesAndIndices) {
+    PredictResponse response;
+    auto status = serializeReducedOutput(response, getOutput(ovms::OutputReductionType::TOP_K, 2), reinterpret_cast<const char*>(values.data()), shape_t{2, 6});
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    const auto& topValues = response.outputs().at("prob");
+    const auto& topIndices = response.outputs().at("prob_indices");
+    EXPECT_EQ(topValues.dtype(), tensorflow::DataType::DT_FLOAT);
+    EXPECT_EQ(topIndices.dtype(), tensorflow::DataType::DT_INT64);
+    ASSERT_EQ(topValues.tensor_shape().dim_size(), 2);
+    EXPECT_EQ(topValues.tensor_shape().dim(1).size(), 2);
+    EXPECT_EQ(topIndices.tensor_shape().DebugString(), topValues.tensor_shape().DebugString());
+    ASSERT_EQ(topIndices.tensor_content().size(), 4 * sizeof(int64_t));
+    auto resultValues = reinterpret_cast<const float*>(topValues.tensor_content().data());
+    auto resultIndices = reinterpret_cast<const int64_t*>(topIndices.tensor_content().data());
+    EXPECT_EQ(std::vector<float>(resultValues, resultValues + 4), (std::vector<float>{0.9f, 0.5f, 0.8f, 0.7f}));
+    EXPECT_EQ(std::vector<int64_t>(resultIndices, resultIndices + 4), (std::vector<int64_t>{4, 1, 3, 0}));
+}
+
+TEST_F(SerializeReducedOutput, Fp16OutputIsWidenedBeforeReduction) {
+    auto output = std::make_shared<ovms::TensorInfo>(std::string("prob"), Precision::FP16, shape_t{2, 3}, InferenceEngine::Layout::NC);
+    ovms::OutputReduction reduction;
+    reduction.type = ovms::OutputReductionType::TOP_K;
+    reduction.k = 2;
+    output->setOutputReduction(reduction);
+    // 1.0, -2.0, 0.5 and 0.5, 2.0, -1.0
+    std::vector<uint16_t> data{0x3C00, 0xC000, 0x3800, 0x3800, 0x4000, 0xBC00};
+    PredictResponse response;
+    auto status = serializeReducedOutput(response, output, reinterpret_cast<const char*>(data.data()), shape_t{2, 3});
+    ASSERT_EQ(status, ovms::StatusCode::OK);
+    const auto& topValues = response.outputs().at("prob");
+    const auto& topIndices = response.outputs().at("prob_indices");
+    EXPECT_EQ(topValues.dtype(), tensorflow::DataType::DT_FLOAT);
+    ASSERT_EQ(topValues.tensor_content().size(), 4 * sizeof(float));
+    ASSERT_EQ(topIndices.tensor_content().size(), 4 * sizeof(int64_t));
+    auto resultValues = reinterpret_cast<const float*>(topValues.tensor_content().data());
+    auto resultIndices = reinterpret_cast<const int64_t*>(topIndices.tensor_content().data());
+    EXPECT_EQ(std::vector<float>(resultValues, resultValues + 4), (std::vector<float>{1.0f, 0.5f, 2.0f, 0.5f}));
+    EXPECT_EQ(std::vector<int64_t>(resultIndices, resultIndices + 4), (std::vector<int64_t>{0, 2, 1, 0}));
+
+    reduction.type = ovms::OutputReductionType::ARGMAX;
+    output->setOutputReduction(reduction);
+    PredictResponse argmaxResponse;
+    ASSERT_EQ(serializeReducedOutput(argmaxResponse, output, reinterpret_cast<const char*>(data.data()), shape_t{2, 3}), ovms::StatusCode::OK);
+    const auto& indices = argmaxResponse.outputs().at("prob");
+    ASSERT_EQ(indices.tensor_content().size(), 2 * sizeof(int64_t));
+    auto argmaxIndices = reinterpret_cast<const int64_t*>(indices.tensor_content().data());
+    EXPECT_EQ(argmaxIndices[0], 0);
+    EXPECT_EQ(argmaxIndices[1], 1);
+}
+
+TEST_F(ResponseOutputBlobsGuardTest, ReducedOutputShouldBeLeftForSerialization) {
+    InferenceEngine::TensorDesc tensorDesc(Precision::FP32, shape_t{1, 256 * 1024}, InferenceEngine::Layout::NC);
+    std::shared_ptr<MockIInferRequestProperGetBlob> mInferRequestPtr =
+        std::make_shared<MockIInferRequestProperGetBlob>(tensorDesc);
+    InferenceEngine::InferRequest inferRequest(mInferRequestPtr);
+    EXPECT_CALL(*mInferRequestPtr, SetBlob(_, _, _)).Times(0);
+    PredictResponse response;
+    auto outputs = getOutputs(tensorDesc);
+    ovms::OutputReduction reduction;
+    reduction.type = ovms::OutputReductionType::ARGMAX;
+    outputs["First"]->setOutputReduction(reduction);
+    ResponseOutputBlobsGuard guard(inferRequest);
+    ASSERT_TRUE(guard.prepare(outputs, &response).ok());
+    EXPECT_FALSE(guard.isInPlace("First"));
+}
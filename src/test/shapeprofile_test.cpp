@@ -0,0 +1,113 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../shapeprofile.hpp"
+#include "test_utils.hpp"
+
+using ovms::ShapeHistogram;
+using ovms::ShapePrecompilationQueue;
+using ovms::ShapeProfileStore;
+
+TEST(ShapeHistogram, TopKeysAreMostFrequentFirst) {
+    ShapeHistogram histogram;
+    for (int i = 0; i < 3; ++i) {
+        histogram.record("input:(1,3,300,300);");
+    }
+    histogram.record("batch_size:4");
+    histogram.record("batch_size:8");
+    histogram.record("batch_size:8");
+    EXPECT_EQ(histogram.getTopKeys(2), (std::vector<std::string>{"input:(1,3,300,300);", "batch_size:8"}));
+    EXPECT_EQ(histogram.getTopKeys(10).size(), 3);
+    EXPECT_TRUE(histogram.takeChanged());
+    EXPECT_FALSE(histogram.takeChanged());
+}
+
+TEST(ShapeHistogram, MergedHistoryIsWeighted) {
+    ShapeHistogram histogram;
+    histogram.record("batch_size:2");
+    histogram.merge({{"batch_size:2", 10}, {"batch_size:4", 1}}, 0.5);
+    EXPECT_EQ(histogram.getCounts(), (std::map<std::string, uint64_t>{{"batch_size:2", 6}}));
+}
+
+TEST(ShapeHistogram, DistinctKeysAreLimited) {
+    ShapeHistogram histogram;
+    for (size_t i = 0; i < ovms::MAX_SHAPE_HISTOGRAM_KEYS + 10; ++i) {
+        histogram.record("batch_size:" + std::to_string(i + 1));
+    }
+    EXPECT_EQ(histogram.getCounts().size(), ovms::MAX_SHAPE_HISTOGRAM_KEYS);
+}
+
+TEST(ShapeSignature, BatchSizeAndShapesAreParsed) {
+    size_t batchSize = 0;
+    std::map<std::string, std::vector<size_t>> shapes;
+    ASSERT_TRUE(ovms::parseShapeSignature("batch_size:16", batchSize, shapes));
+    EXPECT_EQ(batchSize, 16);
+    EXPECT_TRUE(shapes.empty());
+    ASSERT_TRUE(ovms::parseShapeSignature("data:(1,3,224,224);ns:info:(1,2);", batchSize, shapes));
+    EXPECT_EQ(batchSize, 0);
+    EXPECT_EQ(shapes, (std::map<std::string, std::vector<size_t>>{{"data", {1, 3, 224, 224}}, {"ns:info", {1, 2}}}));
+    for (const auto* malformed : {"", "batch_size:", "batch_size:0", "batch_size:x", "data:(1,a);", "data:(1,2)", ":(1);", "data"}) {
+        EXPECT_FALSE(ovms::parseShapeSignature(malformed, batchSize, shapes)) << malformed;
+    }
+}
+
+class ShapeProfileStoreTest : public TestWithTempDir {};
+
+TEST_F(ShapeProfileStoreTest, StoredHistogramIsLoaded) {
+    ShapeProfileStore store(directoryPath);
+    const std::map<std::string, uint64_t> counts{{"batch_size:4", 7}, {"input:(1,3,300,300);", 2}};
+    store.store("resnet", 1, counts);
+    std::map<std::string, uint64_t> loaded;
+    ASSERT_TRUE(store.load("resnet", 1, loaded));
+    EXPECT_EQ(loaded, counts);
+    EXPECT_FALSE(store.load("other", 1, loaded));
+}
+
+TEST_F(ShapeProfileStoreTest, NewVersionStartsFromClosestOlderVersion) {
+    ShapeProfileStore store(directoryPath);
+    store.store("resnet", 1, {{"batch_size:1", 1}});
+    store.store("resnet", 2, {{"batch_size:2", 1}});
+    store.store("resnet", 4, {{"batch_size:4", 1}});
+    std::map<std::string, uint64_t> loaded;
+    ASSERT_TRUE(store.load("resnet", 3, loaded));
+    EXPECT_EQ(loaded, (std::map<std::string, uint64_t>{{"batch_size:2", 1}}));
+}
+
+TEST_F(ShapeProfileStoreTest, CorruptedProfileIsIgnored) {
+    ShapeProfileStore store(directoryPath);
+    store.store("resnet", 1, {{"batch_size:1", 1}});
+    std::ofstream(store.getProfilePath("resnet", 1)) << "ovms_shape_profile 1\nnot a count\n";
+    std::map<std::string, uint64_t> loaded;
+    EXPECT_FALSE(store.load("resnet", 1, loaded));
+}
+
+TEST(ShapePrecompilationQueue, TasksRunInSubmissionOrder) {
+    ShapePrecompilationQueue queue;
+    std::vector<int> order;
+    for (int i = 0; i < 3; ++i) {
+        queue.submit([&order, i]() { order.push_back(i); });
+    }
+    queue.waitIdle();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
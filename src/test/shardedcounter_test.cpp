@@ -0,0 +1,78 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../shardedcounter.hpp"
+
+using ovms::ShardedCounter;
+
+TEST(ShardedCounter, SumsShardsOfAllThreads) {
+    ShardedCounter counter;
+    EXPECT_TRUE(counter.isZero());
+    std::vector<size_t> shards(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        threads.emplace_back([&counter, &shards, i]() { shards[i] = counter.increment(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.get(), shards.size());
+    EXPECT_FALSE(counter.isZero());
+    for (size_t shard : shards) {
+        counter.decrement(shard);
+    }
+    EXPECT_EQ(counter.get(), 0);
+    EXPECT_TRUE(counter.isZero());
+}
+
+TEST(ShardedCounter, DecrementOnOtherThreadKeepsShardOfIncrement) {
+    ShardedCounter counter;
+    const size_t shard = counter.increment();
+    size_t otherThreadShard = 0;
+    std::thread other([&counter, &otherThreadShard, shard]() {
+        otherThreadShard = counter.increment();
+        counter.decrement(otherThreadShard);
+        counter.decrement(shard);
+    });
+    other.join();
+    EXPECT_TRUE(counter.isZero());
+}
+
+TEST(ShardedCounter, ConcurrentIncrementsAndDecrementsBalanceOut) {
+    ShardedCounter counter;
+    const size_t heldShard = counter.increment();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&counter]() {
+            for (size_t j = 0; j < 100000; ++j) {
+                counter.decrement(counter.increment());
+            }
+        });
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+        EXPECT_FALSE(counter.isZero()) << "operation in progress has to be visible during concurrent updates";
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.get(), 1);
+    counter.decrement(heldShard);
+    EXPECT_TRUE(counter.isZero());
+}
@@ -0,0 +1,208 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "../serialization.hpp"
+#include "../sharedmemory.hpp"
+
+using ovms::SharedMemoryReference;
+using ovms::SharedMemoryRegistry;
+using ovms::StatusCode;
+
+namespace {
+const size_t REGION_SIZE = 4096;
+
+/**
+ * @brief Creates shared memory object as a client would, region is unregistered when the test ends
+ */
+class SharedMemoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        key = "/ovms_test_" + std::to_string(getpid());
+        int fd = shm_open(key.c_str(), O_CREAT | O_RDWR, 0600);
+        ASSERT_NE(fd, -1);
+        ASSERT_EQ(ftruncate(fd, REGION_SIZE), 0);
+        void* mapped = mmap(nullptr, REGION_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        ASSERT_NE(mapped, MAP_FAILED);
+        clientData = static_cast<char*>(mapped);
+        ASSERT_EQ(SharedMemoryRegistry::getInstance().registerRegion("region", key, REGION_SIZE), StatusCode::OK);
+    }
+
+    void TearDown() override {
+        SharedMemoryRegistry::getInstance().unregisterRegion("region");
+        munmap(clientData, REGION_SIZE);
+        shm_unlink(key.c_str());
+    }
+
+    tensorflow::TensorProto createReference(const std::string& reference) {
+        tensorflow::TensorProto proto;
+        proto.set_dtype(tensorflow::DataType::DT_FLOAT);
+        proto.mutable_tensor_shape()->add_dim()->set_size(1);
+        proto.mutable_tensor_shape()->add_dim()->set_size(4);
+        proto.add_string_val(reference);
+        return proto;
+    }
+
+    std::string key;
+    char* clientData = nullptr;
+};
+}  // namespace
+
+TEST(SharedMemoryReference, ShouldParseValidReference) {
+    SharedMemoryReference reference;
+    ASSERT_EQ(ovms::parseSharedMemoryReference("shm:images:128:4096", reference), StatusCode::OK);
+    EXPECT_EQ(reference.regionName, "images");
+    EXPECT_EQ(reference.offset, 128u);
+    EXPECT_EQ(reference.byteSize, 4096u);
+    EXPECT_EQ(ovms::sharedMemoryReferenceToString(reference), "shm:images:128:4096");
+}
+
+TEST(SharedMemoryReference, ShouldRejectMalformedReference) {
+    SharedMemoryReference reference;
+    for (const char* text : {"", "shm:", "shm::0:16", "shm:images:0", "shm:images:-1:16", "shm:images:0:16:32",
+             "shm:images:0:1x", "file:images:0:16", "shm:images:0:99999999999999999999"}) {
+        EXPECT_EQ(ovms::parseSharedMemoryReference(text, reference), StatusCode::INVALID_SHARED_MEMORY_REFERENCE) << text;
+    }
+}
+
+TEST(SharedMemoryReference, ShouldDetectOnlyNonStringTensorsWithSingleReference) {
+    tensorflow::TensorProto proto;
+    proto.set_dtype(tensorflow::DataType::DT_FLOAT);
+    proto.add_string_val("shm:region:0:16");
+    EXPECT_TRUE(ovms::isSharedMemoryReference(proto));
+    proto.mutable_tensor_content()->assign(16, '\0');
+    EXPECT_FALSE(ovms::isSharedMemoryReference(proto));
+    proto.clear_tensor_content();
+    proto.set_dtype(tensorflow::DataType::DT_STRING);
+    EXPECT_FALSE(ovms::isSharedMemoryReference(proto));
+}
+
+TEST(SharedMemoryReference, ShouldSplitOutputFilterEntry) {
+    std::optional<SharedMemoryReference> destination;
+    EXPECT_EQ(ovms::getOutputFilterEntryName("output"), "output");
+    ASSERT_EQ(ovms::getOutputFilterEntryDestination("output", destination), StatusCode::OK);
+    EXPECT_FALSE(destination);
+
+    EXPECT_EQ(ovms::getOutputFilterEntryName("output@shm:region:64:16"), "output");
+    ASSERT_EQ(ovms::getOutputFilterEntryDestination("output@shm:region:64:16", destination), StatusCode::OK);
+    ASSERT_TRUE(destination);
+    EXPECT_EQ(destination->regionName, "region");
+    EXPECT_EQ(destination->offset, 64u);
+    EXPECT_EQ(destination->byteSize, 16u);
+
+    EXPECT_EQ(ovms::getOutputFilterEntryDestination("output@region", destination), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+}
+
+TEST(SharedMemoryReference, OutputWithDestinationShouldBeRequested) {
+    ovms::output_filter_t outputFilter;
+    outputFilter.Add("output@shm:region:0:16");
+    EXPECT_TRUE(ovms::isOutputRequested(&outputFilter, "output"));
+    EXPECT_FALSE(ovms::isOutputRequested(&outputFilter, "out"));
+}
+
+TEST_F(SharedMemoryTest, ShouldRejectDuplicatedAndUnknownRegions) {
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().registerRegion("region", key, REGION_SIZE), StatusCode::SHM_REGION_ALREADY_REGISTERED);
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().unregisterRegion("unknown"), StatusCode::SHM_REGION_NOT_REGISTERED);
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().registerRegion("missing", "/ovms_test_missing_object", REGION_SIZE), StatusCode::SHM_REGION_MAPPING_FAILED);
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().registerRegion("oversized", key, REGION_SIZE * 2), StatusCode::SHM_REGION_MAPPING_FAILED);
+}
+
+TEST_F(SharedMemoryTest, ShouldResolveReferenceWithinRegionBounds) {
+    std::shared_ptr<ovms::SharedMemoryRegion> region;
+    char* data = nullptr;
+    ASSERT_EQ(SharedMemoryRegistry::getInstance().resolve({"region", 1024, 1024}, region, data), StatusCode::OK);
+    std::memcpy(clientData + 1024, "abcd", 4);
+    EXPECT_EQ(std::string(data, 4), "abcd");
+
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().resolve({"region", 0, REGION_SIZE + 1}, region, data), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().resolve({"region", REGION_SIZE, 1}, region, data), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().resolve({"region", 1, SIZE_MAX}, region, data), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+    EXPECT_EQ(SharedMemoryRegistry::getInstance().resolve({"unknown", 0, 16}, region, data), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+}
+
+TEST_F(SharedMemoryTest, ValidationShouldCheckReferencedByteSize) {
+    EXPECT_EQ(ovms::validateSharedMemoryReference(createReference("shm:region:64:16"), 16), StatusCode::OK);
+    EXPECT_EQ(ovms::validateSharedMemoryReference(createReference("shm:region:64:12"), 16), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+    EXPECT_EQ(ovms::validateSharedMemoryReference(createReference("shm:unknown:64:16"), 16), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+}
+
+TEST_F(SharedMemoryTest, BlobShouldPointToRegionMemory) {
+    const std::vector<float> values{1.0, 2.0, 3.0, 4.0};
+    std::memcpy(clientData + 64, values.data(), values.size() * sizeof(float));
+    InferenceEngine::TensorDesc tensorDesc(InferenceEngine::Precision::FP32, {1, 4}, InferenceEngine::Layout::NC);
+
+    InferenceEngine::Blob::Ptr blob;
+    ASSERT_EQ(ovms::deserializeSharedMemoryReference(createReference("shm:region:64:16"), tensorDesc, blob), StatusCode::OK);
+    EXPECT_EQ(blob->buffer().as<char*>(), SharedMemoryRegistry::getInstance().findRegion("region")->getData() + 64);
+    EXPECT_EQ(std::memcmp(blob->buffer().as<float*>(), values.data(), values.size() * sizeof(float)), 0);
+
+    // Blob keeps region mapped after it is unregistered
+    ASSERT_EQ(SharedMemoryRegistry::getInstance().unregisterRegion("region"), StatusCode::OK);
+    EXPECT_EQ(blob->buffer().as<float*>()[3], 4.0);
+    ASSERT_EQ(SharedMemoryRegistry::getInstance().registerRegion("region", key, REGION_SIZE), StatusCode::OK);
+}
+
+TEST_F(SharedMemoryTest, ShouldCopyReferencedMemory) {
+    std::memcpy(clientData + 32, "0123456789abcdef", 16);
+    std::vector<char> destination(16);
+    ASSERT_EQ(ovms::copySharedMemoryReference(createReference("shm:region:32:16"), destination.data(), destination.size()), StatusCode::OK);
+    EXPECT_EQ(std::string(destination.data(), destination.size()), "0123456789abcdef");
+    EXPECT_EQ(ovms::copySharedMemoryReference(createReference("shm:region:32:16"), destination.data(), 8), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+}
+
+TEST_F(SharedMemoryTest, ShouldWriteOutputsIntoDestinationRegion) {
+    tensorflow::serving::PredictResponse response;
+    auto& output = (*response.mutable_outputs())["output"];
+    output.set_dtype(tensorflow::DataType::DT_FLOAT);
+    output.mutable_tensor_shape()->add_dim()->set_size(4);
+    output.mutable_tensor_content()->assign("0123456789abcdef");
+    (*response.mutable_outputs())["other"].mutable_tensor_content()->assign("kept");
+
+    ovms::output_filter_t outputFilter;
+    outputFilter.Add("output@shm:region:256:16");
+    outputFilter.Add("other");
+    ASSERT_EQ(ovms::writeOutputsToSharedMemory(&response, &outputFilter), StatusCode::OK);
+    EXPECT_EQ(std::string(clientData + 256, 16), "0123456789abcdef");
+    EXPECT_TRUE(output.tensor_content().empty());
+    ASSERT_EQ(output.string_val_size(), 1);
+    EXPECT_EQ(output.string_val(0), "shm:region:256:16");
+    EXPECT_EQ(output.dtype(), tensorflow::DataType::DT_FLOAT);
+    EXPECT_EQ(response.outputs().at("other").tensor_content(), "kept");
+}
+
+TEST_F(SharedMemoryTest, ShouldRejectOutputNotMatchingDestinationSize) {
+    tensorflow::serving::PredictResponse response;
+    (*response.mutable_outputs())["output"].mutable_tensor_content()->assign(32, 'a');
+    ovms::output_filter_t outputFilter;
+    outputFilter.Add("output@shm:region:0:16");
+    EXPECT_EQ(ovms::writeOutputsToSharedMemory(&response, &outputFilter), StatusCode::INVALID_SHARED_MEMORY_REFERENCE);
+}
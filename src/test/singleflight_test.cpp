@@ -0,0 +1,117 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../singleflight.hpp"
+
+using namespace ovms;
+
+using tensorflow::serving::PredictResponse;
+
+TEST(SingleFlight, FirstRequestLeads) {
+    SingleFlight singleFlight;
+    bool called = false;
+    EXPECT_TRUE(singleFlight.join("key", [&called](const Status&, const PredictResponse&) { called = true; }));
+    singleFlight.complete("key", StatusCode::OK, PredictResponse());
+    EXPECT_FALSE(called);
+    EXPECT_EQ(singleFlight.getCoalescedCount(), 0);
+}
+
+TEST(SingleFlight, FollowersGetLeaderResponse) {
+    SingleFlight singleFlight;
+    ASSERT_TRUE(singleFlight.join("key", nullptr));
+    std::vector<std::string> contents;
+    for (int i = 0; i < 2; i++) {
+        EXPECT_FALSE(singleFlight.join("key", [&contents](const Status& status, const PredictResponse& response) {
+            EXPECT_EQ(status, StatusCode::OK);
+            contents.push_back(response.outputs().at("a").tensor_content());
+        }));
+    }
+    EXPECT_TRUE(contents.empty());
+
+    PredictResponse response;
+    (*response.mutable_outputs())["a"].set_tensor_content("abcd");
+    singleFlight.complete("key", StatusCode::OK, response);
+    EXPECT_EQ(contents, std::vector<std::string>({"abcd", "abcd"}));
+    EXPECT_EQ(singleFlight.getCoalescedCount(), 2);
+}
+
+TEST(SingleFlight, FollowersGetLeaderError) {
+    SingleFlight singleFlight;
+    ASSERT_TRUE(singleFlight.join("key", nullptr));
+    Status followerStatus = StatusCode::OK;
+    ASSERT_FALSE(singleFlight.join("key", [&followerStatus](const Status& status, const PredictResponse&) { followerStatus = status; }));
+    singleFlight.complete("key", StatusCode::OV_INTERNAL_INFERENCE_ERROR, PredictResponse());
+    EXPECT_EQ(followerStatus, StatusCode::OV_INTERNAL_INFERENCE_ERROR);
+}
+
+TEST(SingleFlight, DifferentKeysAreNotCoalesced) {
+    SingleFlight singleFlight;
+    EXPECT_TRUE(singleFlight.join("first", nullptr));
+    EXPECT_TRUE(singleFlight.join("second", nullptr));
+    singleFlight.complete("first", StatusCode::OK, PredictResponse());
+    singleFlight.complete("second", StatusCode::OK, PredictResponse());
+    EXPECT_EQ(singleFlight.getCoalescedCount(), 0);
+}
+
+TEST(SingleFlight, KeyCanBeReusedAfterComplete) {
+    SingleFlight singleFlight;
+    ASSERT_TRUE(singleFlight.join("key", nullptr));
+    singleFlight.complete("key", StatusCode::OK, PredictResponse());
+    EXPECT_TRUE(singleFlight.join("key", nullptr));
+    singleFlight.complete("key", StatusCode::OK, PredictResponse());
+}
+
+TEST(SingleFlightWaiter, WaitsForLeaderResponse) {
+    SingleFlight singleFlight;
+    ASSERT_TRUE(singleFlight.join("key", nullptr));
+    PredictResponse followerResponse;
+    SingleFlightWaiter waiter(&followerResponse);
+    ASSERT_FALSE(singleFlight.join("key", waiter.createFollower()));
+    std::thread leader([&singleFlight]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        PredictResponse response;
+        (*response.mutable_outputs())["a"].set_tensor_content("abcd");
+        singleFlight.complete("key", StatusCode::OK, response);
+    });
+    EXPECT_EQ(waiter.wait(NO_DEADLINE), StatusCode::OK);
+    leader.join();
+    EXPECT_EQ(followerResponse.outputs().at("a").tensor_content(), "abcd");
+}
+
+TEST(SingleFlightWaiter, GivesUpAtDeadline) {
+    SingleFlight singleFlight;
+    ASSERT_TRUE(singleFlight.join("key", nullptr));
+    PredictResponse followerResponse;
+    {
+        SingleFlightWaiter waiter(&followerResponse);
+        ASSERT_FALSE(singleFlight.join("key", waiter.createFollower()));
+        const auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(waiter.wait(deadlineAfter(std::chrono::milliseconds(20))), StatusCode::DEADLINE_EXCEEDED);
+        EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    }
+    // leader completing after the follower gave up does not touch its response
+    PredictResponse response;
+    (*response.mutable_outputs())["a"].set_tensor_content("abcd");
+    singleFlight.complete("key", StatusCode::OK, response);
+    EXPECT_EQ(followerResponse.outputs_size(), 0);
+    EXPECT_EQ(singleFlight.getCoalescedCount(), 1);
+}
@@ -0,0 +1,89 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../stageexecutor.hpp"
+#include "../status.hpp"
+
+using ovms::StageExecutor;
+using ovms::Status;
+using ovms::StatusCode;
+
+namespace net_http = tensorflow::serving::net_http;
+
+TEST(StageExecutor, ScheduledTasksAreExecuted) {
+    StageExecutor executor("stagetest", 2);
+    std::promise<void> first, second;
+    ASSERT_TRUE(executor.Schedule([&first]() { first.set_value(); }));
+    ASSERT_TRUE(executor.Schedule([&second]() { second.set_value(); }));
+    EXPECT_EQ(first.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(second.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+TEST(StageExecutor, TasksAboveQueueSizeLimitAreRejected) {
+    StageExecutor executor("stagetest", 1, 1);
+    std::promise<void> started, release, queuedDone;
+    auto releaseFuture = release.get_future().share();
+    ASSERT_TRUE(executor.Schedule([&started, releaseFuture]() {
+        started.set_value();
+        releaseFuture.wait();
+    }));
+    // running task no longer waits in the queue
+    ASSERT_EQ(started.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(executor.queue_depth(), 0);
+    ASSERT_TRUE(executor.Schedule([&queuedDone]() { queuedDone.set_value(); }));
+    EXPECT_EQ(executor.queue_depth(), 1);
+
+    bool rejectedExecuted = false;
+    EXPECT_FALSE(executor.Schedule([&rejectedExecuted]() { rejectedExecuted = true; }));
+    EXPECT_EQ(executor.queue_depth(), 1);
+
+    release.set_value();
+    ASSERT_EQ(queuedDone.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    std::promise<void> afterDrain;
+    EXPECT_TRUE(executor.Schedule([&afterDrain]() { afterDrain.set_value(); }));
+    EXPECT_EQ(afterDrain.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_FALSE(rejectedExecuted);
+}
+
+TEST(StageExecutor, QueueIsNotLimitedWithZeroSize) {
+    StageExecutor executor("stagetest", 1);
+    std::promise<void> release;
+    auto releaseFuture = release.get_future().share();
+    ASSERT_TRUE(executor.Schedule([releaseFuture]() { releaseFuture.wait(); }));
+    std::atomic<int> executed{0};
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(executor.Schedule([&executed]() { ++executed; }));
+    }
+    EXPECT_GE(executor.queue_depth(), 100);
+    release.set_value();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (executed < 100 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(executed, 100);
+    EXPECT_EQ(executor.queue_depth(), 0);
+}
+
+TEST(StageExecutor, RejectedInferenceIsAnsweredWithTooManyRequests) {
+    // REST dispatcher replies with this status when inference stage rejects the parsed request
+    EXPECT_EQ(Status(StatusCode::REST_INFERENCE_QUEUE_FULL).http(), net_http::HTTPStatusCode::TOO_MANY_REQUESTS);
+}
@@ -0,0 +1,108 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <set>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../status.hpp"
+
+using ovms::Status;
+using ovms::StatusCode;
+
+TEST(TestStatus, CodeWithoutDetailsUsesCodeMessage) {
+    Status ok;
+    EXPECT_TRUE(ok.ok());
+    EXPECT_EQ(ok.string(), "");
+
+    Status status = StatusCode::TOO_MANY_PENDING_REQUESTS;
+    EXPECT_EQ(status.getCode(), StatusCode::TOO_MANY_PENDING_REQUESTS);
+    EXPECT_EQ(status.string(), "Model pending requests limit reached");
+    EXPECT_EQ(Status(StatusCode::STATUS_CODE_END).string(), "Unknown error");
+}
+
+TEST(TestStatus, DetailsAreAppendedToCodeMessage) {
+    Status status(StatusCode::INVALID_PRECISION, "Expected: FP32; Actual: U8");
+    EXPECT_EQ(status.string(), "Invalid input precision - Expected: FP32; Actual: U8");
+    EXPECT_EQ(status.grpc().error_message(), "Invalid input precision - Expected: FP32; Actual: U8");
+}
+
+TEST(TestStatus, WithDetailsConcatenatesStringsAndIntegers) {
+    auto status = Status::withDetails(StatusCode::INVALID_BATCH_SIZE,
+        "Expected: ", std::string("at most "), size_t(8), "; Actual: ", int64_t(-1));
+    EXPECT_EQ(status.getCode(), StatusCode::INVALID_BATCH_SIZE);
+    EXPECT_EQ(status.string(), "Invalid input batch size - Expected: at most 8; Actual: -1");
+}
+
+TEST(TestStatus, CopiesOutliveOriginal) {
+    static_assert(std::is_trivially_copyable<Status>::value, "Status has to stay cheap to copy");
+    Status copy;
+    {
+        auto original = Status::withDetails(StatusCode::INVALID_BATCH_SIZE, "Expected: ", 2, "; Actual: ", 3);
+        copy = original;
+    }
+    EXPECT_EQ(copy.string(), "Invalid input batch size - Expected: 2; Actual: 3");
+    EXPECT_EQ(copy.getCode(), StatusCode::INVALID_BATCH_SIZE);
+}
+
+TEST(TestStatus, IdenticalMessagesAreInternedOnce) {
+    Status first(StatusCode::INVALID_MISSING_INPUT, "Required input: interned");
+    const auto count = Status::internedMessagesCount();
+    auto second = Status::withDetails(StatusCode::INVALID_MISSING_INPUT, "Required input: ", "interned");
+    EXPECT_EQ(second.string(), first.string());
+    EXPECT_EQ(Status::internedMessagesCount(), count);
+}
+
+TEST(TestStatus, IntegersOfDetailsDoNotInternNewFormats) {
+    auto first = Status::withDetails(StatusCode::SEQUENCE_MISSING, "Sequence id: ", uint64_t(1));
+    const auto count = Status::internedMessagesCount();
+    for (uint64_t id = 2; id < 100; id++) {
+        auto status = Status::withDetails(StatusCode::SEQUENCE_MISSING, "Sequence id: ", id);
+        EXPECT_EQ(status.string(), "Sequence with provided id does not exist - Sequence id: " + std::to_string(id));
+    }
+    EXPECT_EQ(Status::internedMessagesCount(), count);
+    EXPECT_EQ(first.string(), "Sequence with provided id does not exist - Sequence id: 1");
+}
+
+TEST(TestStatus, PlaceholderIsRemovedFromStringsOfDetails) {
+    std::string name = "a";
+    name += Status::VALUE_PLACEHOLDER;
+    name += "b";
+    auto status = Status::withDetails(StatusCode::INVALID_MISSING_INPUT, "Required input: ", name, "; batch: ", -1);
+    EXPECT_EQ(status.string(), "Missing input with specific name - Required input: ab; batch: -1");
+}
+
+TEST(TestStatus, ConcurrentMessagesWithDetails) {
+    std::vector<std::thread> threads;
+    std::vector<std::set<std::string>> messages(4);
+    for (size_t i = 0; i < messages.size(); i++) {
+        threads.emplace_back([&messages, i]() {
+            for (int j = 0; j < 100; j++) {
+                messages[i].insert(Status::withDetails(StatusCode::INVALID_SHAPE, "concurrent ", j).string());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& threadMessages : messages) {
+        EXPECT_EQ(threadMessages, messages[0]);
+    }
+    EXPECT_EQ(messages[0].size(), 100);
+}
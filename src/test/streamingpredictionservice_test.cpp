@@ -0,0 +1,241 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/create_channel.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+#include <gtest/gtest.h>
+
+#include "../modelmanager.hpp"
+#include "../streaming_prediction_service.hpp"
+#include "test_utils.hpp"
+
+using namespace ovms;
+
+using tensorflow::serving::PredictRequest;
+using tensorflow::serving::PredictResponse;
+
+static const char* streamingServiceConfig = R"(
+{
+    "model_config_list": [
+        {
+            "config": {
+                "name": "dummy",
+                "base_path": "/ovms/src/test/dummy",
+                "target_device": "CPU",
+                "nireq": 2
+            }
+        }
+    ]
+})";
+
+// room for streamed input of one dummy request at once
+const size_t CHUNKED_REQUESTS_BUDGET_BYTE_SIZE = DUMMY_MODEL_INPUT_SIZE * sizeof(float) + 8;
+const std::chrono::milliseconds CHUNKED_REQUEST_READ_TIMEOUT{500};
+
+class StreamingPredictionServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(ModelManager::getInstance().startFromFile(createConfigFileWithContent(streamingServiceConfig)), StatusCode::OK);
+        grpc::ServerBuilder builder;
+        builder.RegisterService(&service);
+        server = builder.BuildAndStart();
+        ASSERT_NE(server, nullptr);
+        stub = StreamingPredictionService::NewStub(server->InProcessChannel(grpc::ChannelArguments()));
+    }
+
+    void TearDown() override {
+        if (server) {
+            server->Shutdown();
+        }
+    }
+
+    static PredictRequest prepareDummyRequest(const std::vector<float>& data, const std::string& modelName = "dummy") {
+        PredictRequest request;
+        request.mutable_model_spec()->set_name(modelName);
+        auto& input = (*request.mutable_inputs())[DUMMY_MODEL_INPUT_NAME];
+        input.set_dtype(tensorflow::DataType::DT_FLOAT);
+        input.mutable_tensor_shape()->add_dim()->set_size(1);
+        input.mutable_tensor_shape()->add_dim()->set_size(DUMMY_MODEL_INPUT_SIZE);
+        input.mutable_tensor_content()->assign(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+        return request;
+    }
+
+    /**
+     * @brief First chunk with dummy input streamed in next chunks
+     */
+    static PredictChunk prepareDummyHeader() {
+        PredictChunk chunk;
+        *chunk.mutable_request() = prepareDummyRequest({});
+        return chunk;
+    }
+
+    static PredictChunk prepareDummyChunk(const std::vector<float>& data, size_t first, size_t count) {
+        PredictChunk chunk;
+        chunk.set_input_name(DUMMY_MODEL_INPUT_NAME);
+        chunk.set_data(reinterpret_cast<const char*>(data.data() + first), count * sizeof(float));
+        return chunk;
+    }
+
+    bool waitForReservedBudget(size_t byteSize) {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (service.getChunkedRequestsBudget().getReservedByteSize() != byteSize) {
+            if (std::chrono::steady_clock::now() > end) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    static std::vector<float> dummyData(float first) {
+        std::vector<float> data(DUMMY_MODEL_INPUT_SIZE);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = first + i;
+        }
+        return data;
+    }
+
+    StreamingPredictionServiceImpl service{DEFAULT_CHUNKED_REQUEST_MAX_MB * 1024 * 1024, CHUNKED_REQUESTS_BUDGET_BYTE_SIZE, CHUNKED_REQUEST_READ_TIMEOUT};
+    std::unique_ptr<grpc::Server> server;
+    std::unique_ptr<StreamingPredictionService::Stub> stub;
+};
+
+TEST_F(StreamingPredictionServiceTest, PredictStreamRespondsInOrderOfRequests) {
+    const size_t requestsCount = 2 * MAX_PREDICT_STREAM_REQUESTS_IN_FLIGHT;
+    std::vector<PredictRequest> requests;
+    std::vector<std::vector<float>> data;
+    for (size_t i = 0; i < requestsCount; i++) {
+        data.push_back(dummyData(i * 100.0));
+        requests.push_back(prepareDummyRequest(data.back()));
+    }
+
+    grpc::ClientContext context;
+    auto stream = stub->PredictStream(&context);
+    for (const auto& request : requests) {
+        ASSERT_TRUE(stream->Write(request));
+    }
+    ASSERT_TRUE(stream->WritesDone());
+
+    PredictStreamResponse response;
+    size_t responded = 0;
+    while (stream->Read(&response)) {
+        ASSERT_LT(responded, requestsCount);
+        EXPECT_TRUE(response.error_message().empty()) << response.error_message();
+        checkDummyResponse(DUMMY_MODEL_OUTPUT_NAME, data[responded], requests[responded], *response.mutable_response(), 1);
+        responded++;
+    }
+    EXPECT_EQ(responded, requestsCount);
+    EXPECT_TRUE(stream->Finish().ok());
+}
+
+TEST_F(StreamingPredictionServiceTest, PredictStreamFailedRequestDoesNotCloseStream) {
+    auto first = dummyData(1.0);
+    auto last = dummyData(7.0);
+    std::vector<PredictRequest> requests{
+        prepareDummyRequest(first),
+        prepareDummyRequest(first, "non_existing_model"),
+        prepareDummyRequest(last)};
+    // wrong shape is rejected by request validation
+    requests.push_back(prepareDummyRequest(last));
+    (*requests.back().mutable_inputs())[DUMMY_MODEL_INPUT_NAME].mutable_tensor_shape()->mutable_dim(1)->set_size(DUMMY_MODEL_INPUT_SIZE + 1);
+
+    grpc::ClientContext context;
+    auto stream = stub->PredictStream(&context);
+    for (const auto& request : requests) {
+        ASSERT_TRUE(stream->Write(request));
+    }
+    ASSERT_TRUE(stream->WritesDone());
+
+    std::vector<PredictStreamResponse> responses;
+    PredictStreamResponse response;
+    while (stream->Read(&response)) {
+        responses.push_back(response);
+    }
+    EXPECT_TRUE(stream->Finish().ok());
+    ASSERT_EQ(responses.size(), requests.size());
+    EXPECT_TRUE(responses[0].error_message().empty());
+    checkDummyResponse(DUMMY_MODEL_OUTPUT_NAME, first, requests[0], *responses[0].mutable_response(), 1);
+    EXPECT_FALSE(responses[1].error_message().empty());
+    EXPECT_FALSE(responses[1].has_response());
+    EXPECT_TRUE(responses[2].error_message().empty());
+    checkDummyResponse(DUMMY_MODEL_OUTPUT_NAME, last, requests[2], *responses[2].mutable_response(), 1);
+    EXPECT_FALSE(responses[3].error_message().empty());
+}
+
+TEST_F(StreamingPredictionServiceTest, PredictChunkedInfersStreamedInput) {
+    auto data = dummyData(3.0);
+    grpc::ClientContext context;
+    PredictResponse response;
+    auto writer = stub->PredictChunked(&context, &response);
+    ASSERT_TRUE(writer->Write(prepareDummyHeader()));
+    ASSERT_TRUE(writer->Write(prepareDummyChunk(data, 0, 4)));
+    ASSERT_TRUE(writer->Write(prepareDummyChunk(data, 4, DUMMY_MODEL_INPUT_SIZE - 4)));
+    ASSERT_TRUE(writer->WritesDone());
+    auto status = writer->Finish();
+    ASSERT_TRUE(status.ok()) << status.error_message();
+    auto request = prepareDummyRequest(data);
+    checkDummyResponse(DUMMY_MODEL_OUTPUT_NAME, data, request, response, 1);
+    // memory of the input is released with the request
+    EXPECT_TRUE(waitForReservedBudget(0));
+}
+
+TEST_F(StreamingPredictionServiceTest, PredictChunkedRequestsShareMemoryBudget) {
+    auto data = dummyData(1.0);
+    grpc::ClientContext firstContext;
+    PredictResponse firstResponse;
+    auto first = stub->PredictChunked(&firstContext, &firstResponse);
+    ASSERT_TRUE(first->Write(prepareDummyHeader()));
+    ASSERT_TRUE(first->Write(prepareDummyChunk(data, 0, 1)));
+    // budget is taken when the first chunk of the input arrives
+    ASSERT_TRUE(waitForReservedBudget(DUMMY_MODEL_INPUT_SIZE * sizeof(float)));
+
+    grpc::ClientContext secondContext;
+    PredictResponse secondResponse;
+    auto second = stub->PredictChunked(&secondContext, &secondResponse);
+    second->Write(prepareDummyHeader());
+    second->Write(prepareDummyChunk(data, 0, DUMMY_MODEL_INPUT_SIZE));
+    second->WritesDone();
+    EXPECT_EQ(second->Finish().error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED);
+
+    ASSERT_TRUE(first->Write(prepareDummyChunk(data, 1, DUMMY_MODEL_INPUT_SIZE - 1)));
+    ASSERT_TRUE(first->WritesDone());
+    auto status = first->Finish();
+    ASSERT_TRUE(status.ok()) << status.error_message();
+    auto request = prepareDummyRequest(data);
+    checkDummyResponse(DUMMY_MODEL_OUTPUT_NAME, data, request, firstResponse, 1);
+}
+
+TEST_F(StreamingPredictionServiceTest, PredictChunkedIsCancelledWhenChunksAreNotReceivedInTime) {
+    auto data = dummyData(1.0);
+    grpc::ClientContext context;
+    PredictResponse response;
+    auto writer = stub->PredictChunked(&context, &response);
+    ASSERT_TRUE(writer->Write(prepareDummyHeader()));
+    ASSERT_TRUE(writer->Write(prepareDummyChunk(data, 0, 1)));
+    ASSERT_TRUE(waitForReservedBudget(DUMMY_MODEL_INPUT_SIZE * sizeof(float)));
+    // client stalls without sending the rest of the input
+    std::this_thread::sleep_for(2 * CHUNKED_REQUEST_READ_TIMEOUT);
+    writer->WritesDone();
+    auto status = writer->Finish();
+    EXPECT_TRUE(status.error_code() == grpc::StatusCode::CANCELLED || status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) << status.error_message();
+    EXPECT_TRUE(waitForReservedBudget(0));
+}
@@ -0,0 +1,98 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <chrono>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../streamsbudget.hpp"
+
+using ovms::ModelStreamsLoad;
+using ovms::StreamsBudget;
+
+namespace {
+ModelStreamsLoad load(const std::string& name, uint32_t streams, uint64_t streamHoldMicroseconds, size_t waitingRequests = 0) {
+    ModelStreamsLoad load;
+    load.name = name;
+    load.version = 1;
+    load.streams = streams;
+    load.streamHoldMicroseconds = streamHoldMicroseconds;
+    load.waitingRequests = waitingRequests;
+    return load;
+}
+}  // namespace
+
+TEST(StreamsBudget, DistributeGivesEachModelAtLeastOneStream) {
+    EXPECT_EQ(StreamsBudget::distribute(2, {5.0, 1.0, 0.0}), std::vector<uint32_t>({1, 1, 1}));
+    EXPECT_EQ(StreamsBudget::distribute(8, {0.0, 0.0}), std::vector<uint32_t>({1, 1}));
+    EXPECT_EQ(StreamsBudget::distribute(8, {3.0, 1.0, 0.0}), std::vector<uint32_t>({5, 2, 1}));
+    const auto streams = StreamsBudget::distribute(10, {1.0, 1.0, 1.0});
+    EXPECT_EQ(std::accumulate(streams.begin(), streams.end(), 0u), 10);
+}
+
+TEST(StreamsBudget, SmallChangesAreNotSignificant) {
+    EXPECT_FALSE(StreamsBudget::isSignificantChange(4, 4));
+    EXPECT_FALSE(StreamsBudget::isSignificantChange(4, 5));
+    EXPECT_FALSE(StreamsBudget::isSignificantChange(4, 3));
+    EXPECT_TRUE(StreamsBudget::isSignificantChange(4, 6));
+    EXPECT_TRUE(StreamsBudget::isSignificantChange(1, 2));
+    EXPECT_TRUE(StreamsBudget::isSignificantChange(2, 1));
+}
+
+TEST(StreamsBudget, FirstRebalanceKeepsStreams) {
+    StreamsBudget budget;
+    budget.configure(8);
+    EXPECT_EQ(budget.rebalance({load("a", 1, 1000000), load("b", 1, 0)}), std::vector<uint32_t>({1, 1}));
+}
+
+TEST(StreamsBudget, HotModelGrowsAndIdleModelShrinks) {
+    StreamsBudget budget;
+    budget.configure(8);
+    const auto start = std::chrono::steady_clock::now();
+    budget.rebalance({load("hot", 2, 0), load("idle", 4, 0)}, start);
+    // hot one used both of its streams for the whole second and had requests waiting
+    const auto streams = budget.rebalance({load("hot", 2, 2000000, 3), load("idle", 4, 0)}, start + std::chrono::seconds(1));
+    EXPECT_EQ(streams, std::vector<uint32_t>({7, 1}));
+    const auto assignments = budget.getAssignments();
+    ASSERT_EQ(assignments.size(), 2);
+    EXPECT_EQ(assignments[0].name, "hot");
+    EXPECT_DOUBLE_EQ(assignments[0].busyStreams, 2.0);
+    EXPECT_DOUBLE_EQ(assignments[1].busyStreams, 0.0);
+}
+
+TEST(StreamsBudget, GrowthIsTrimmedWhenShrinkIsSkipped) {
+    StreamsBudget budget;
+    budget.configure(8);
+    const auto start = std::chrono::steady_clock::now();
+    budget.rebalance({load("a", 2, 0), load("b", 5, 0)}, start);
+    // b should shrink to 4 which is too small change to recompile, a has only one spare stream to grow into
+    const auto streams = budget.rebalance({load("a", 2, 2000000, 1), load("b", 5, 3600000)}, start + std::chrono::seconds(1));
+    EXPECT_EQ(streams[1], 5);
+    EXPECT_LE(streams[0] + streams[1], 8);
+    EXPECT_EQ(streams[0], 3);
+}
+
+TEST(StreamsBudget, ReloadedQueueCountsFromZero) {
+    StreamsBudget budget;
+    budget.configure(4);
+    const auto start = std::chrono::steady_clock::now();
+    budget.rebalance({load("a", 2, 5000000), load("b", 2, 0)}, start);
+    budget.rebalance({load("a", 2, 1000000), load("b", 2, 0)}, start + std::chrono::seconds(1));
+    const auto assignments = budget.getAssignments();
+    ASSERT_EQ(assignments.size(), 2);
+    EXPECT_DOUBLE_EQ(assignments[0].busyStreams, 1.0);
+}
@@ -0,0 +1,151 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../deserialization.hpp"
+#include "../tensorarena.hpp"
+
+using ovms::TensorArena;
+
+namespace {
+uint64_t sum(const std::vector<ovms::TensorArenaStatistics>& statistics, uint64_t ovms::TensorArenaStatistics::*field) {
+    uint64_t total = 0;
+    for (const auto& node : statistics) {
+        total += node.*field;
+    }
+    return total;
+}
+
+/**
+ * @brief Disables the global arena when test ends, also when it fails
+ */
+class GlobalArenaGuard {
+public:
+    explicit GlobalArenaGuard(size_t maxReservedBytes) {
+        TensorArena::instance().configure(maxReservedBytes);
+    }
+    ~GlobalArenaGuard() {
+        TensorArena::instance().configure(0);
+    }
+};
+}  // namespace
+
+TEST(TensorArena, DisabledArenaAllocatesAlignedHeapBuffers) {
+    TensorArena arena;
+    EXPECT_FALSE(arena.isEnabled());
+    void* buffer = arena.allocate(100);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) % TensorArena::ALIGNMENT, 0);
+    std::memset(buffer, 1, 100);
+    arena.deallocate(buffer);
+    EXPECT_EQ(arena.getHeapAllocations(), 1);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::reservedBytes), 0);
+}
+
+TEST(TensorArena, BuffersAreAlignedAndReused) {
+    TensorArena arena;
+    arena.configure(16 * TensorArena::HUGE_PAGE_SIZE);
+    void* first = arena.allocate(1000);
+    void* second = arena.allocate(3000);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % TensorArena::ALIGNMENT, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % TensorArena::ALIGNMENT, 0);
+    std::memset(first, 1, 1000);
+    std::memset(second, 2, 3000);
+    auto statistics = arena.getStatistics();
+    EXPECT_EQ(sum(statistics, &ovms::TensorArenaStatistics::reservedBytes), 16 * TensorArena::HUGE_PAGE_SIZE);
+    EXPECT_EQ(sum(statistics, &ovms::TensorArenaStatistics::allocations), 2);
+    EXPECT_GT(sum(statistics, &ovms::TensorArenaStatistics::usedBytes), 0);
+
+    arena.deallocate(first);
+    void* reused = arena.allocate(900);
+    EXPECT_EQ(reused, first);
+    arena.deallocate(reused);
+    arena.deallocate(second);
+    statistics = arena.getStatistics();
+    EXPECT_EQ(sum(statistics, &ovms::TensorArenaStatistics::reusedAllocations), 1);
+    EXPECT_EQ(sum(statistics, &ovms::TensorArenaStatistics::usedBytes), 0);
+    EXPECT_EQ(arena.getHeapAllocations(), 0);
+}
+
+TEST(TensorArena, MemoryIsReservedWhenConfigured) {
+    TensorArena arena;
+    arena.configure(4 * TensorArena::HUGE_PAGE_SIZE + 100);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::reservedBytes), 4 * TensorArena::HUGE_PAGE_SIZE);
+    void* buffer = arena.allocate(TensorArena::HUGE_PAGE_SIZE);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::reservedBytes), 4 * TensorArena::HUGE_PAGE_SIZE);
+    arena.deallocate(buffer);
+
+    arena.configure(8 * TensorArena::HUGE_PAGE_SIZE);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::reservedBytes), 8 * TensorArena::HUGE_PAGE_SIZE);
+    arena.configure(2 * TensorArena::HUGE_PAGE_SIZE);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::reservedBytes), 8 * TensorArena::HUGE_PAGE_SIZE);
+}
+
+TEST(TensorArena, LargeBuffersAreMappedInWholeHugePages) {
+    TensorArena arena;
+    arena.configure(16 * TensorArena::HUGE_PAGE_SIZE);
+    const size_t size = 3 * TensorArena::HUGE_PAGE_SIZE;
+    char* buffer = static_cast<char*>(arena.allocate(size));
+    ASSERT_NE(buffer, nullptr);
+    buffer[0] = 1;
+    buffer[size - 1] = 2;
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::reservedBytes) % TensorArena::HUGE_PAGE_SIZE, 0);
+    arena.deallocate(buffer);
+}
+
+TEST(TensorArena, FallsBackToHeapAboveLimit) {
+    TensorArena arena;
+    arena.configure(TensorArena::HUGE_PAGE_SIZE);
+    void* buffer = arena.allocate(2 * TensorArena::HUGE_PAGE_SIZE);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) % TensorArena::ALIGNMENT, 0);
+    EXPECT_EQ(arena.getHeapAllocations(), 1);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::reservedBytes), TensorArena::HUGE_PAGE_SIZE);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::usedBytes), 0);
+    arena.deallocate(buffer);
+}
+
+TEST(TensorArena, BuffersStayValidAfterDisabling) {
+    TensorArena arena;
+    arena.configure(4 * TensorArena::HUGE_PAGE_SIZE);
+    void* buffer = arena.allocate(4096);
+    arena.configure(0);
+    std::memset(buffer, 1, 4096);
+    arena.deallocate(buffer);
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::usedBytes), 0);
+}
+
+TEST(TensorArena, ConvertedBlobsUseGlobalArenaWhenEnabled) {
+    GlobalArenaGuard guard(4 * TensorArena::HUGE_PAGE_SIZE);
+    auto& arena = TensorArena::instance();
+    const uint64_t allocationsBefore = sum(arena.getStatistics(), &ovms::TensorArenaStatistics::allocations);
+    {
+        auto blob = ovms::allocateConvertedBlob({InferenceEngine::Precision::FP32, {1, 3, 16, 16}, InferenceEngine::Layout::NCHW});
+        ASSERT_NE(blob, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(blob->buffer().as<void*>()) % TensorArena::ALIGNMENT, 0);
+        std::memset(blob->buffer().as<void*>(), 0, blob->byteSize());
+        EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::allocations), allocationsBefore + 1);
+    }
+    EXPECT_EQ(sum(arena.getStatistics(), &ovms::TensorArenaStatistics::usedBytes), 0);
+}
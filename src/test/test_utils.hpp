@@ -154,6 +154,10 @@ public:
     void updateConfigurationWithoutConfigFile() {
         ModelManager::updateConfigurationWithoutConfigFile();
     }
+
+    void setPipelineModelsFusionEnabled(bool enabled) {
+        pipelineModelsFusionEnabled = enabled;
+    }
 };
 class TestWithTempDir : public ::testing::Test {
 protected:
@@ -71,6 +71,23 @@ TEST(TestThreadSafeQueue, NoElementsPushed) {
     EXPECT_EQ(std::nullopt, queue.tryPull(WAIT_FOR_ELEMENT_TIMEOUT_MICROSECONDS));
 }
 
+TEST(TestThreadSafeQueue, PullWaitsForElement) {
+    ThreadSafeQueue<int> queue;
+    std::thread producerThread([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.push(7);
+    });
+    EXPECT_EQ(7, queue.pull());
+    producerThread.join();
+}
+
+TEST(TestThreadSafeQueue, TryPullUntilTimesOut) {
+    ThreadSafeQueue<int> queue;
+    EXPECT_EQ(std::nullopt, queue.tryPullUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+    queue.push(3);
+    EXPECT_EQ(3, queue.tryPullUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+}
+
 const uint ELEMENTS_TO_INSERT = 500;
 
 void producer(ThreadSafeQueue<int>& queue, std::future<void> startSignal) {
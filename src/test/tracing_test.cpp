@@ -0,0 +1,178 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../tracing.hpp"
+
+using ovms::Span;
+using ovms::SpanData;
+using ovms::TraceContext;
+using ovms::Tracer;
+using ovms::TraceScope;
+
+namespace {
+const char SAMPLED_TRACEPARENT[] = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+const char NOT_SAMPLED_TRACEPARENT[] = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00";
+
+class TracingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Tracer::instance().configure([this](const std::string& body) {
+            std::unique_lock<std::mutex> lock(mtx);
+            exported.push_back(body);
+            return true;
+        },
+            0.0);
+    }
+    void TearDown() override {
+        Tracer::instance().shutdown();
+    }
+
+    std::vector<std::string> getExported() {
+        Tracer::instance().flush();
+        std::unique_lock<std::mutex> lock(mtx);
+        return exported;
+    }
+
+    std::mutex mtx;
+    std::vector<std::string> exported;
+};
+}  // namespace
+
+TEST(TraceContext, ParsesTraceparent) {
+    TraceContext context;
+    ASSERT_TRUE(TraceContext::parseTraceparent(SAMPLED_TRACEPARENT, context));
+    EXPECT_TRUE(context.isValid());
+    EXPECT_TRUE(context.sampled);
+    EXPECT_EQ(context.traceId[0], 0x4b);
+    EXPECT_EQ(context.spanId[7], 0xb7);
+    EXPECT_EQ(context.toTraceparent(), SAMPLED_TRACEPARENT);
+
+    ASSERT_TRUE(TraceContext::parseTraceparent(NOT_SAMPLED_TRACEPARENT, context));
+    EXPECT_FALSE(context.sampled);
+}
+
+TEST(TraceContext, RejectsMalformedTraceparent) {
+    TraceContext context;
+    EXPECT_FALSE(TraceContext::parseTraceparent("", context));
+    EXPECT_FALSE(TraceContext::parseTraceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7", context));
+    EXPECT_FALSE(TraceContext::parseTraceparent("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01", context));
+    EXPECT_FALSE(TraceContext::parseTraceparent("00-00000000000000000000000000000000-00f067aa0ba902b7-01", context));
+    EXPECT_FALSE(TraceContext::parseTraceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01", context));
+    EXPECT_FALSE(TraceContext::parseTraceparent("ff-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01", context));
+    EXPECT_FALSE(TraceContext::parseTraceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-extra", context));
+    // future versions may append fields
+    EXPECT_TRUE(TraceContext::parseTraceparent("01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-extra", context));
+    EXPECT_TRUE(context.sampled);
+}
+
+TEST(Tracing, SpansAreNotRecordedWhenTracingIsDisabled) {
+    auto context = Tracer::instance().startRequest(SAMPLED_TRACEPARENT);
+    EXPECT_FALSE(context.sampled);
+    Span span("predict", &context);
+    EXPECT_FALSE(span.isRecording());
+}
+
+TEST_F(TracingTest, SampledRequestSpansAreExported) {
+    auto context = Tracer::instance().startRequest(SAMPLED_TRACEPARENT);
+    ASSERT_TRUE(context.sampled);
+    {
+        Span requestSpan("predict", &context, true);
+        ASSERT_TRUE(requestSpan.isRecording());
+        requestSpan.setAttribute("model.name", "dummy");
+        TraceScope scope(requestSpan.getContext());
+        Span childSpan("inference");
+        ASSERT_TRUE(childSpan.isRecording());
+        EXPECT_EQ(childSpan.getContext().traceId, context.traceId);
+        childSpan.setError("failed");
+    }
+    EXPECT_EQ(TraceScope::current(), nullptr);
+    auto exported = getExported();
+    ASSERT_EQ(exported.size(), 1);
+    const auto& body = exported[0];
+    EXPECT_NE(body.find("\"traceId\":\"4bf92f3577b34da6a3ce929d0e0e4736\""), std::string::npos);
+    EXPECT_NE(body.find("\"parentSpanId\":\"00f067aa0ba902b7\""), std::string::npos);
+    EXPECT_NE(body.find("\"name\":\"predict\""), std::string::npos);
+    EXPECT_NE(body.find("\"name\":\"inference\""), std::string::npos);
+    EXPECT_NE(body.find("\"model.name\""), std::string::npos);
+    EXPECT_NE(body.find("\"code\":2"), std::string::npos);
+    EXPECT_NE(body.find("\"service.name\""), std::string::npos);
+}
+
+TEST_F(TracingTest, MoveAssignedSpanEndsPreviousOneAndKeepsItselfOnSelfAssignment) {
+    auto context = Tracer::instance().startRequest(SAMPLED_TRACEPARENT);
+    {
+        Span span("first", &context);
+        span = Span("second", &context);
+        ASSERT_TRUE(span.isRecording());
+        auto& sameSpan = span;
+        span = std::move(sameSpan);
+        EXPECT_TRUE(span.isRecording());
+        span.setAttribute("kept", "yes");
+    }
+    auto exported = getExported();
+    ASSERT_EQ(exported.size(), 1);
+    const auto& body = exported[0];
+    EXPECT_NE(body.find("\"name\":\"first\""), std::string::npos);
+    EXPECT_NE(body.find("\"name\":\"second\""), std::string::npos);
+    EXPECT_NE(body.find("\"kept\""), std::string::npos);
+}
+
+TEST_F(TracingTest, NotSampledRequestIsNotRecorded) {
+    auto context = Tracer::instance().startRequest(NOT_SAMPLED_TRACEPARENT);
+    EXPECT_FALSE(context.sampled);
+    {
+        Span requestSpan("predict", &context);
+        EXPECT_FALSE(requestSpan.isRecording());
+        TraceScope scope(requestSpan.getContext());
+        Span childSpan("inference");
+        EXPECT_FALSE(childSpan.isRecording());
+    }
+    // request without traceparent follows sampling ratio, which is 0
+    auto rootContext = Tracer::instance().startRequest("");
+    EXPECT_TRUE(rootContext.isValid());
+    EXPECT_FALSE(rootContext.sampled);
+    EXPECT_TRUE(getExported().empty());
+}
+
+TEST_F(TracingTest, RootRequestsAreSampledWithRatio) {
+    Tracer::instance().configure([](const std::string&) { return true; }, 1.0);
+    auto context = Tracer::instance().startRequest("invalid");
+    EXPECT_TRUE(context.isValid());
+    EXPECT_TRUE(context.sampled);
+    Span span("predict", &context);
+    EXPECT_TRUE(span.isRecording());
+}
+
+TEST(TracingOtlp, SpanWithoutParentHasNoParentSpanId) {
+    std::vector<std::unique_ptr<SpanData>> spans;
+    spans.push_back(std::make_unique<SpanData>());
+    spans[0]->traceId[0] = 1;
+    spans[0]->spanId[0] = 2;
+    spans[0]->name = "root";
+    spans[0]->startTimeUnixNano = 1000;
+    spans[0]->endTimeUnixNano = 2000;
+    auto body = Tracer::serializeOtlp(spans, "service");
+    EXPECT_EQ(body.find("parentSpanId"), std::string::npos);
+    EXPECT_NE(body.find("\"spanId\":\"0200000000000000\""), std::string::npos);
+    EXPECT_NE(body.find("\"startTimeUnixNano\":\"1000\""), std::string::npos);
+    EXPECT_NE(body.find("\"kind\":1"), std::string::npos);
+}
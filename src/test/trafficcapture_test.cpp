@@ -0,0 +1,174 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../trafficcapture.hpp"
+
+using ovms::CapturedRequest;
+using ovms::CapturedTarget;
+using ovms::Status;
+using ovms::StatusCode;
+using ovms::TrafficCapture;
+using ovms::TrafficLogReader;
+
+namespace {
+const char TRAFFIC_LOG_PATH[] = "/tmp/ovms_test_traffic_capture.bin";
+
+tensorflow::serving::PredictRequest makeRequest(const std::string& name, float value) {
+    tensorflow::serving::PredictRequest request;
+    request.mutable_model_spec()->set_name(name);
+    auto& input = (*request.mutable_inputs())["input"];
+    input.set_dtype(tensorflow::DataType::DT_FLOAT);
+    input.mutable_tensor_shape()->add_dim()->set_size(1);
+    input.mutable_tensor_content()->assign(reinterpret_cast<const char*>(&value), sizeof(value));
+    return request;
+}
+
+class TrafficCaptureTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove(TRAFFIC_LOG_PATH);
+    }
+};
+}  // namespace
+
+TEST_F(TrafficCaptureTest, CapturedRequestsAreReadBackInArrivalOrder) {
+    TrafficCapture capture;
+    ASSERT_EQ(capture.configure(TRAFFIC_LOG_PATH, 1.0, 1024 * 1024), StatusCode::OK);
+    EXPECT_TRUE(capture.isEnabled());
+    for (int i = 0; i < 10; i++) {
+        capture.capture(makeRequest(i % 2 ? "pipeline" : "model", i), i % 2 ? CapturedTarget::PIPELINE : CapturedTarget::MODEL);
+    }
+    capture.shutdown();
+    EXPECT_FALSE(capture.isEnabled());
+    EXPECT_EQ(capture.getCapturedCount(), 10);
+    EXPECT_EQ(capture.getDroppedCount(), 0);
+
+    TrafficLogReader reader;
+    ASSERT_EQ(reader.open(TRAFFIC_LOG_PATH), StatusCode::OK);
+    EXPECT_GT(reader.getStartMicroseconds(), 0);
+    CapturedRequest record;
+    Status status;
+    std::chrono::microseconds previousArrival{0};
+    uint64_t count = 0;
+    while (reader.next(record, status)) {
+        EXPECT_GE(record.arrival, previousArrival);
+        previousArrival = record.arrival;
+        const bool isPipeline = record.request.model_spec().name() == "pipeline";
+        EXPECT_EQ(record.target, isPipeline ? CapturedTarget::PIPELINE : CapturedTarget::MODEL);
+        ASSERT_EQ(record.request.inputs().at("input").tensor_content().size(), sizeof(float));
+        count++;
+    }
+    EXPECT_EQ(status, StatusCode::OK);
+    EXPECT_EQ(count, capture.getCapturedCount());
+}
+
+TEST_F(TrafficCaptureTest, RecordsQueuedAtShutdownAreWritten) {
+    TrafficCapture capture;
+    ASSERT_EQ(capture.configure(TRAFFIC_LOG_PATH, 1.0, 64 * 1024 * 1024), StatusCode::OK);
+    const uint64_t requestsCount = 1000;
+    for (uint64_t i = 0; i < requestsCount; i++) {
+        capture.capture(makeRequest("model", i), CapturedTarget::MODEL);
+    }
+    // shutdown right after capture, most of the records are still queued
+    capture.shutdown();
+    EXPECT_EQ(capture.getCapturedCount(), requestsCount);
+    EXPECT_EQ(capture.getDroppedCount(), 0);
+    TrafficLogReader reader;
+    ASSERT_EQ(reader.open(TRAFFIC_LOG_PATH), StatusCode::OK);
+    CapturedRequest record;
+    Status status;
+    uint64_t count = 0;
+    while (reader.next(record, status)) {
+        count++;
+    }
+    EXPECT_EQ(status, StatusCode::OK);
+    EXPECT_EQ(count, requestsCount);
+}
+
+TEST_F(TrafficCaptureTest, RequestsAboveQueuedBytesLimitAreDropped) {
+    TrafficCapture capture;
+    ASSERT_EQ(capture.configure(TRAFFIC_LOG_PATH, 1.0, 1024 * 1024 * 1024), StatusCode::OK);
+    auto large = makeRequest("model", 1);
+    (*large.mutable_inputs())["input"].mutable_tensor_content()->assign(TrafficCapture::MAX_QUEUED_BYTES + 1, 'x');
+    capture.capture(large, CapturedTarget::MODEL);
+    capture.capture(makeRequest("model", 2), CapturedTarget::MODEL);
+    capture.shutdown();
+    EXPECT_EQ(capture.getDroppedCount(), 1);
+    EXPECT_EQ(capture.getCapturedCount(), 1);
+}
+
+TEST_F(TrafficCaptureTest, NothingIsCapturedWithZeroRatio) {
+    TrafficCapture capture;
+    ASSERT_EQ(capture.configure(TRAFFIC_LOG_PATH, 0.0, 1024 * 1024), StatusCode::OK);
+    for (int i = 0; i < 100; i++) {
+        capture.capture(makeRequest("model", i), CapturedTarget::MODEL);
+    }
+    capture.shutdown();
+    EXPECT_EQ(capture.getCapturedCount(), 0);
+    TrafficLogReader reader;
+    ASSERT_EQ(reader.open(TRAFFIC_LOG_PATH), StatusCode::OK);
+    CapturedRequest record;
+    Status status;
+    EXPECT_FALSE(reader.next(record, status));
+    EXPECT_EQ(status, StatusCode::OK);
+}
+
+TEST_F(TrafficCaptureTest, CaptureStopsAtSizeLimit) {
+    TrafficCapture capture;
+    // header and a few records of about 40 bytes
+    ASSERT_EQ(capture.configure(TRAFFIC_LOG_PATH, 1.0, 200), StatusCode::OK);
+    for (int i = 0; i < 100; i++) {
+        capture.capture(makeRequest("model", i), CapturedTarget::MODEL);
+    }
+    capture.shutdown();
+    EXPECT_GT(capture.getCapturedCount(), 0);
+    EXPECT_LT(capture.getCapturedCount(), 10);
+    std::ifstream log(TRAFFIC_LOG_PATH, std::ios::binary | std::ios::ate);
+    EXPECT_LE(static_cast<size_t>(log.tellg()), 200);
+}
+
+TEST_F(TrafficCaptureTest, ReaderRejectsDamagedLog) {
+    {
+        std::ofstream log(TRAFFIC_LOG_PATH, std::ios::binary);
+        log << "not a traffic log at all";
+    }
+    TrafficLogReader reader;
+    EXPECT_EQ(reader.open(TRAFFIC_LOG_PATH), StatusCode::FILE_INVALID);
+
+    TrafficCapture capture;
+    ASSERT_EQ(capture.configure(TRAFFIC_LOG_PATH, 1.0, 1024 * 1024), StatusCode::OK);
+    capture.capture(makeRequest("model", 1), CapturedTarget::MODEL);
+    capture.shutdown();
+    ASSERT_EQ(capture.getCapturedCount(), 1);
+    {
+        // cut the last byte of the record
+        std::ifstream input(TRAFFIC_LOG_PATH, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        std::ofstream output(TRAFFIC_LOG_PATH, std::ios::binary | std::ios::trunc);
+        output.write(content.data(), content.size() - 1);
+    }
+    TrafficLogReader truncated;
+    ASSERT_EQ(truncated.open(TRAFFIC_LOG_PATH), StatusCode::OK);
+    CapturedRequest record;
+    Status status;
+    EXPECT_FALSE(truncated.next(record, status));
+    EXPECT_EQ(status, StatusCode::FILE_INVALID);
+}
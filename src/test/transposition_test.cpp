@@ -0,0 +1,66 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../transposition.hpp"
+
+namespace {
+template <typename T>
+std::vector<T> transposeReference(const std::vector<T>& source, size_t n, size_t c, size_t h, size_t w) {
+    std::vector<T> destination(source.size());
+    for (size_t in = 0; in < n; in++) {
+        for (size_t ic = 0; ic < c; ic++) {
+            for (size_t ih = 0; ih < h; ih++) {
+                for (size_t iw = 0; iw < w; iw++) {
+                    destination[((in * c + ic) * h + ih) * w + iw] = source[((in * h + ih) * w + iw) * c + ic];
+                }
+            }
+        }
+    }
+    return destination;
+}
+
+template <typename T>
+void checkTransposition(size_t n, size_t c, size_t h, size_t w) {
+    std::vector<T> source(n * c * h * w);
+    for (size_t i = 0; i < source.size(); i++) {
+        source[i] = static_cast<T>(i * 2654435761u);
+    }
+    std::vector<T> actual(source.size());
+    ovms::transposeNhwcToNchw(source.data(), actual.data(), {n, c, h, w}, sizeof(T));
+    EXPECT_EQ(actual, transposeReference(source, n, c, h, w)) << "shape: " << n << "," << c << "," << h << "," << w;
+}
+}  // namespace
+
+TEST(Transposition, MatchesReferenceForAllElementSizes) {
+    const std::vector<std::vector<size_t>> shapes{
+        {1, 1, 5, 7}, {1, 3, 224, 224}, {2, 3, 17, 5}, {1, 4, 9, 9}, {3, 5, 6, 7}, {1, 64, 13, 11}, {2, 35, 33, 3}};
+    for (const auto& shape : shapes) {
+        checkTransposition<uint8_t>(shape[0], shape[1], shape[2], shape[3]);
+        checkTransposition<uint16_t>(shape[0], shape[1], shape[2], shape[3]);
+        checkTransposition<uint32_t>(shape[0], shape[1], shape[2], shape[3]);
+        checkTransposition<uint64_t>(shape[0], shape[1], shape[2], shape[3]);
+    }
+}
+
+TEST(Transposition, ReordersShapeDimensions) {
+    EXPECT_EQ(ovms::nchwToNhwcShape({1, 3, 224, 112}), (std::vector<size_t>{1, 224, 112, 3}));
+    EXPECT_EQ(ovms::nhwcToNchwShape({1, 224, 112, 3}), (std::vector<size_t>{1, 3, 224, 112}));
+    EXPECT_EQ(ovms::nchwToNhwcShape({1, 3}), (std::vector<size_t>{1, 3}));
+}
@@ -0,0 +1,100 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../weightsregistry.hpp"
+#include "test_utils.hpp"
+
+using ovms::WeightsBuffer;
+using ovms::WeightsRegistry;
+
+class WeightsRegistryTest : public TestWithTempDir {
+protected:
+    std::string writeWeights(const std::string& name, const std::string& content) {
+        const std::string path = directoryPath + "/" + name;
+        std::ofstream(path, std::ios::binary) << content;
+        return path;
+    }
+};
+
+TEST_F(WeightsRegistryTest, IdenticalFilesShareBuffer) {
+    const auto first = writeWeights("1.bin", "model weights content");
+    const auto second = writeWeights("2.bin", "model weights content");
+    auto& registry = WeightsRegistry::instance();
+    const size_t reusedBefore = registry.getReusedCount();
+    std::shared_ptr<const WeightsBuffer> firstWeights, secondWeights;
+    ASSERT_EQ(registry.acquire(first, false, firstWeights), ovms::StatusCode::OK);
+    ASSERT_EQ(registry.acquire(second, false, secondWeights), ovms::StatusCode::OK);
+    EXPECT_EQ(firstWeights, secondWeights);
+    EXPECT_EQ(registry.getReusedCount(), reusedBefore + 1);
+    ASSERT_EQ(firstWeights->size, std::string("model weights content").size());
+    EXPECT_EQ(std::memcmp(firstWeights->data, "model weights content", firstWeights->size), 0);
+}
+
+TEST_F(WeightsRegistryTest, SameFileLoadedAgainIsReused) {
+    const auto path = writeWeights("1.bin", "abc");
+    auto& registry = WeightsRegistry::instance();
+    std::shared_ptr<const WeightsBuffer> first, second;
+    ASSERT_EQ(registry.acquire(path, true, first), ovms::StatusCode::OK);
+    ASSERT_EQ(registry.acquire(path, true, second), ovms::StatusCode::OK);
+    EXPECT_EQ(first, second);
+}
+
+TEST_F(WeightsRegistryTest, DifferentFilesAreNotShared) {
+    auto& registry = WeightsRegistry::instance();
+    std::shared_ptr<const WeightsBuffer> first, second;
+    ASSERT_EQ(registry.acquire(writeWeights("1.bin", "abc"), false, first), ovms::StatusCode::OK);
+    ASSERT_EQ(registry.acquire(writeWeights("2.bin", "abd"), false, second), ovms::StatusCode::OK);
+    EXPECT_NE(first, second);
+    EXPECT_NE(first->hash, second->hash);
+}
+
+TEST_F(WeightsRegistryTest, BufferIsReleasedWithLastReference) {
+    const auto path = writeWeights("1.bin", "released weights");
+    auto& registry = WeightsRegistry::instance();
+    std::shared_ptr<const WeightsBuffer> weights;
+    ASSERT_EQ(registry.acquire(path, false, weights), ovms::StatusCode::OK);
+    std::weak_ptr<const WeightsBuffer> observer = weights;
+    weights.reset();
+    EXPECT_TRUE(observer.expired());
+    ASSERT_EQ(registry.acquire(path, false, weights), ovms::StatusCode::OK);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(weights->data), weights->size), "released weights");
+}
+
+TEST_F(WeightsRegistryTest, MemoryBufferSharesLoadedFile) {
+    const auto path = writeWeights("1.bin", "streamed weights");
+    auto& registry = WeightsRegistry::instance();
+    std::shared_ptr<const WeightsBuffer> fromFile;
+    ASSERT_EQ(registry.acquire(path, false, fromFile), ovms::StatusCode::OK);
+    auto contents = std::make_shared<const std::string>("streamed weights");
+    auto fetched = std::make_shared<WeightsBuffer>();
+    fetched->data = reinterpret_cast<const uint8_t*>(contents->data());
+    fetched->size = contents->size();
+    fetched->owner = contents;
+    EXPECT_EQ(registry.share(fetched), fromFile);
+}
+
+TEST_F(WeightsRegistryTest, MissingFileIsInvalid) {
+    std::shared_ptr<const WeightsBuffer> weights;
+    EXPECT_EQ(WeightsRegistry::instance().acquire(directoryPath + "/missing.bin", false, weights), ovms::StatusCode::FILE_INVALID);
+    EXPECT_EQ(weights, nullptr);
+}
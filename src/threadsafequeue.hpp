@@ -15,7 +15,10 @@
 //*****************************************************************************
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <optional>
 #include <queue>
 #include <thread>
@@ -29,15 +32,35 @@ public:
     void push(const T& element) {
         std::unique_lock<std::mutex> lock(mtx);
         queue.push(std::move(element));
-        lock.unlock();
+        // notified under the lock, consumer may destroy the queue as soon as it gets the element
         signal.notify_one();
+        const bool hasPushListener = static_cast<bool>(pushListener);
+        lock.unlock();
+        if (hasPushListener) {
+            pushListener();
+        }
     }
 
     void push(T&& element) {
         std::unique_lock<std::mutex> lock(mtx);
         queue.push(std::move(element));
-        lock.unlock();
+        // notified under the lock, consumer may destroy the queue as soon as it gets the element
         signal.notify_one();
+        const bool hasPushListener = static_cast<bool>(pushListener);
+        lock.unlock();
+        if (hasPushListener) {
+            pushListener();
+        }
+    }
+
+    /**
+     * @brief Sets function called after each push, used to process elements without a thread blocked on pull
+     *
+     * Has to be set before any element is pushed. Consumer has to keep the queue alive until listener of the element
+     * it pulled was called.
+     */
+    void setPushListener(std::function<void()> listener) {
+        pushListener = std::move(listener);
     }
 
     std::optional<T> tryPull(const uint waitDurationMicroseconds) {
@@ -53,7 +76,34 @@ public:
         }
     }
 
+    /**
+     * @brief Blocks until there is an element in the queue
+     */
+    T pull() {
+        std::unique_lock<std::mutex> lock(mtx);
+        signal.wait(lock, [this]() { return queue.size() > 0; });
+        T element = std::move(queue.front());
+        queue.pop();
+        return element;
+    }
+
+    /**
+     * @brief Waits for an element until given point in time
+     */
+    template <typename Clock, typename Duration>
+    std::optional<T> tryPullUntil(const std::chrono::time_point<Clock, Duration>& timePoint) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (signal.wait_until(lock, timePoint, [this]() { return queue.size() > 0; })) {
+            T element = std::move(queue.front());
+            queue.pop();
+            return std::optional<T>{std::move(element)};
+        } else {
+            return std::nullopt;
+        }
+    }
+
     size_t size() {
+        std::unique_lock<std::mutex> lock(mtx);
         return queue.size();
     }
 
@@ -61,5 +111,6 @@ private:
     std::mutex mtx;
     std::queue<T> queue;
     std::condition_variable signal;
+    std::function<void()> pushListener;
 };
 }  // namespace ovms
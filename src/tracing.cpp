@@ -0,0 +1,370 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "tracing.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+namespace {
+thread_local const TraceContext* currentContext = nullptr;
+
+uint64_t randomUint64() {
+    thread_local std::mt19937_64 generator{std::random_device{}()};
+    return generator();
+}
+
+template <size_t N>
+void fillRandomId(std::array<uint8_t, N>& id) {
+    do {
+        for (size_t i = 0; i < N; i += 8) {
+            auto value = randomUint64();
+            for (size_t j = 0; j < 8 && i + j < N; ++j) {
+                id[i + j] = static_cast<uint8_t>(value >> (8 * j));
+            }
+        }
+    } while (std::all_of(id.begin(), id.end(), [](uint8_t byte) { return byte == 0; }));
+}
+
+template <size_t N>
+bool isZero(const std::array<uint8_t, N>& id) {
+    return std::all_of(id.begin(), id.end(), [](uint8_t byte) { return byte == 0; });
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+template <size_t N>
+bool parseHex(std::string_view text, std::array<uint8_t, N>& id) {
+    if (text.size() != 2 * N) {
+        return false;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        int high = hexValue(text[2 * i]);
+        int low = hexValue(text[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        id[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+template <size_t N>
+std::string toHex(const std::array<uint8_t, N>& id) {
+    static const char digits[] = "0123456789abcdef";
+    std::string result(2 * N, '0');
+    for (size_t i = 0; i < N; ++i) {
+        result[2 * i] = digits[id[i] >> 4];
+        result[2 * i + 1] = digits[id[i] & 0xf];
+    }
+    return result;
+}
+
+uint64_t toUnixNano(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+}  // namespace
+
+bool TraceContext::isValid() const {
+    return !isZero(traceId);
+}
+
+bool TraceContext::parseTraceparent(std::string_view traceparent, TraceContext& context) {
+    // version-traceid-parentid-flags, later versions may append fields
+    if (traceparent.size() < 55 || traceparent[2] != '-' || traceparent[35] != '-' || traceparent[52] != '-') {
+        return false;
+    }
+    if (traceparent.substr(0, 2) == "ff" || (traceparent.substr(0, 2) == "00" && traceparent.size() != 55)) {
+        return false;
+    }
+    std::array<uint8_t, 1> version;
+    std::array<uint8_t, 1> flags;
+    TraceContext parsed;
+    if (!parseHex(traceparent.substr(0, 2), version) ||
+        !parseHex(traceparent.substr(3, 32), parsed.traceId) ||
+        !parseHex(traceparent.substr(36, 16), parsed.spanId) ||
+        !parseHex(traceparent.substr(53, 2), flags)) {
+        return false;
+    }
+    if (isZero(parsed.traceId) || isZero(parsed.spanId)) {
+        return false;
+    }
+    parsed.sampled = flags[0] & 0x01;
+    context = parsed;
+    return true;
+}
+
+std::string TraceContext::toTraceparent() const {
+    return "00-" + toHex(traceId) + "-" + toHex(spanId) + (sampled ? "-01" : "-00");
+}
+
+Span::Span(std::string_view name, const TraceContext* parent, bool server) {
+    if (parent == nullptr) {
+        parent = TraceScope::current();
+    }
+    if (parent == nullptr || !parent->sampled || !Tracer::instance().isEnabled()) {
+        return;
+    }
+    data = std::make_unique<SpanData>();
+    data->name = name;
+    data->server = server;
+    data->traceId = parent->traceId;
+    data->parentSpanId = parent->spanId;
+    fillRandomId(data->spanId);
+    data->startTimeUnixNano = toUnixNano(std::chrono::system_clock::now());
+    context.traceId = data->traceId;
+    context.spanId = data->spanId;
+    context.sampled = true;
+}
+
+Span::Span(std::string_view name, const TraceContext* parent, std::chrono::system_clock::time_point start) :
+    Span(name, parent) {
+    if (data) {
+        data->startTimeUnixNano = toUnixNano(start);
+    }
+}
+
+void Span::setAttribute(const char* key, std::string value) {
+    if (data) {
+        data->attributes.emplace_back(key, std::move(value));
+    }
+}
+
+void Span::setError(const std::string& message) {
+    if (data) {
+        data->error = true;
+        data->errorMessage = message;
+    }
+}
+
+void Span::end() {
+    if (!data) {
+        return;
+    }
+    data->endTimeUnixNano = toUnixNano(std::chrono::system_clock::now());
+    Tracer::instance().submit(std::move(data));
+}
+
+TraceScope::TraceScope(const TraceContext& context) :
+    previous(currentContext) {
+    currentContext = &context;
+}
+
+TraceScope::~TraceScope() {
+    currentContext = previous;
+}
+
+const TraceContext* TraceScope::current() {
+    return currentContext;
+}
+
+Tracer::~Tracer() {
+    shutdown();
+}
+
+void Tracer::configure(exporter_t exporter, double samplingRatio, const std::string& serviceName) {
+    shutdown();
+    this->exporter = std::move(exporter);
+    this->samplingRatio = std::clamp(samplingRatio, 0.0, 1.0);
+    this->serviceName = serviceName;
+    worker = std::thread([this]() { run(); });
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::shutdown() {
+    enabled.store(false, std::memory_order_relaxed);
+    {
+        std::unique_lock<std::mutex> lock(queueMtx);
+        if (!worker.joinable()) {
+            return;
+        }
+        stopRequested = true;
+    }
+    queueCondition.notify_all();
+    worker.join();
+    std::unique_lock<std::mutex> lock(queueMtx);
+    stopRequested = false;
+}
+
+TraceContext Tracer::startRequest(std::string_view traceparent) {
+    TraceContext context;
+    if (!isEnabled()) {
+        return context;
+    }
+    if (!traceparent.empty() && TraceContext::parseTraceparent(traceparent, context)) {
+        return context;
+    }
+    fillRandomId(context.traceId);
+    // spans of sampled request are children of its trace id, without parent span
+    context.sampled = samplingRatio > 0.0 && (randomUint64() >> 11) * 0x1.0p-53 < samplingRatio;
+    return context;
+}
+
+void Tracer::submit(std::unique_ptr<SpanData> span) {
+    if (!isEnabled()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(queueMtx);
+    if (queue.size() >= MAX_QUEUED_SPANS) {
+        droppedSpansCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queue.push_back(std::move(span));
+    if (queue.size() >= MAX_EXPORT_BATCH_SIZE) {
+        lock.unlock();
+        queueCondition.notify_one();
+    }
+}
+
+void Tracer::flush() {
+    std::unique_lock<std::mutex> lock(queueMtx);
+    if (!worker.joinable()) {
+        return;
+    }
+    flushRequested = true;
+    queueCondition.notify_one();
+    flushedCondition.wait(lock, [this]() { return queue.empty() && !exporting; });
+}
+
+void Tracer::run() {
+    std::unique_lock<std::mutex> lock(queueMtx);
+    while (true) {
+        queueCondition.wait_for(lock, EXPORT_INTERVAL, [this]() {
+            return stopRequested || flushRequested || queue.size() >= MAX_EXPORT_BATCH_SIZE;
+        });
+        flushRequested = false;
+        while (!queue.empty()) {
+            std::vector<std::unique_ptr<SpanData>> batch;
+            const auto batchSize = std::min(queue.size(), MAX_EXPORT_BATCH_SIZE);
+            batch.reserve(batchSize);
+            for (size_t i = 0; i < batchSize; ++i) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            exporting = true;
+            lock.unlock();
+            exportBatch(batch);
+            lock.lock();
+            exporting = false;
+        }
+        flushedCondition.notify_all();
+        if (stopRequested) {
+            return;
+        }
+    }
+}
+
+void Tracer::exportBatch(std::vector<std::unique_ptr<SpanData>>& batch) {
+    if (!exporter(serializeOtlp(batch, serviceName))) {
+        SPDLOG_DEBUG("Exporting {} spans failed, spans are dropped", batch.size());
+        droppedSpansCount.fetch_add(batch.size(), std::memory_order_relaxed);
+    }
+}
+
+std::string Tracer::serializeOtlp(const std::vector<std::unique_ptr<SpanData>>& spans, const std::string& serviceName) {
+    // OTLP/JSON encoding of ExportTraceServiceRequest, ids are hex encoded and 64 bit integers are strings
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    auto writeStringAttribute = [&writer](const std::string& key, const std::string& value) {
+        writer.StartObject();
+        writer.Key("key");
+        writer.String(key.c_str(), key.size());
+        writer.Key("value");
+        writer.StartObject();
+        writer.Key("stringValue");
+        writer.String(value.c_str(), value.size());
+        writer.EndObject();
+        writer.EndObject();
+    };
+    writer.StartObject();
+    writer.Key("resourceSpans");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("resource");
+    writer.StartObject();
+    writer.Key("attributes");
+    writer.StartArray();
+    writeStringAttribute("service.name", serviceName);
+    writer.EndArray();
+    writer.EndObject();
+    writer.Key("scopeSpans");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("scope");
+    writer.StartObject();
+    writer.Key("name");
+    writer.String("ovms");
+    writer.EndObject();
+    writer.Key("spans");
+    writer.StartArray();
+    for (const auto& span : spans) {
+        writer.StartObject();
+        writer.Key("traceId");
+        writer.String(toHex(span->traceId).c_str());
+        writer.Key("spanId");
+        writer.String(toHex(span->spanId).c_str());
+        if (!isZero(span->parentSpanId)) {
+            writer.Key("parentSpanId");
+            writer.String(toHex(span->parentSpanId).c_str());
+        }
+        writer.Key("name");
+        writer.String(span->name.c_str(), span->name.size());
+        writer.Key("kind");
+        // SPAN_KIND_SERVER or SPAN_KIND_INTERNAL
+        writer.Int(span->server ? 2 : 1);
+        writer.Key("startTimeUnixNano");
+        writer.String(std::to_string(span->startTimeUnixNano).c_str());
+        writer.Key("endTimeUnixNano");
+        writer.String(std::to_string(span->endTimeUnixNano).c_str());
+        writer.Key("attributes");
+        writer.StartArray();
+        for (const auto& [key, value] : span->attributes) {
+            writeStringAttribute(key, value);
+        }
+        writer.EndArray();
+        if (span->error) {
+            writer.Key("status");
+            writer.StartObject();
+            writer.Key("code");
+            // STATUS_CODE_ERROR
+            writer.Int(2);
+            writer.Key("message");
+            writer.String(span->errorMessage.c_str(), span->errorMessage.size());
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+}  // namespace ovms
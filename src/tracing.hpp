@@ -0,0 +1,238 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief W3C trace context header, gRPC metadata keys are lowercase
+ */
+const char TRACEPARENT_HEADER[] = "traceparent";
+
+/**
+ * @brief W3C trace context of a span, passed to its children
+ */
+struct TraceContext {
+    std::array<uint8_t, 16> traceId{};
+    std::array<uint8_t, 8> spanId{};
+    bool sampled = false;
+
+    bool isValid() const;
+
+    /**
+     * @brief Parses traceparent header value, e.g. 00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01
+     *
+     * @return false when value is malformed, context is left unchanged then
+     */
+    static bool parseTraceparent(std::string_view traceparent, TraceContext& context);
+
+    std::string toTraceparent() const;
+};
+
+/**
+ * @brief Finished span waiting for export
+ */
+struct SpanData {
+    std::array<uint8_t, 16> traceId{};
+    std::array<uint8_t, 8> spanId{};
+    std::array<uint8_t, 8> parentSpanId{};
+    std::string name;
+    bool server = false;
+    uint64_t startTimeUnixNano = 0;
+    uint64_t endTimeUnixNano = 0;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::string errorMessage;
+    bool error = false;
+};
+
+/**
+ * @brief Measures one operation of a sampled request, does nothing and allocates nothing for requests which are not sampled
+ *
+ * Span is ended and handed over to the tracer when it is destroyed or when end is called.
+ */
+class Span {
+    std::unique_ptr<SpanData> data;
+    TraceContext context;
+
+public:
+    Span() = default;
+
+    /**
+     * @param name
+     * @param parent context of parent span or of remote caller, thread current context when nullptr
+     * @param server span of request received by the server
+     */
+    Span(std::string_view name, const TraceContext* parent = nullptr, bool server = false);
+
+    /**
+     * @brief Creates span which started earlier, e.g. pipeline node measured by the pipeline
+     */
+    Span(std::string_view name, const TraceContext* parent, std::chrono::system_clock::time_point start);
+
+    Span(Span&&) = default;
+    Span& operator=(Span&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        end();
+        data = std::move(other.data);
+        context = other.context;
+        return *this;
+    }
+
+    ~Span() {
+        end();
+    }
+
+    bool isRecording() const {
+        return data != nullptr;
+    }
+
+    /**
+     * @brief Context of this span for its children, not sampled when span is not recorded
+     */
+    const TraceContext& getContext() const {
+        return context;
+    }
+
+    void setAttribute(const char* key, std::string value);
+
+    void setError(const std::string& message);
+
+    void end();
+};
+
+/**
+ * @brief Makes span context current in the thread for the lifetime of the scope, spans created without parent are its children
+ */
+class TraceScope {
+    const TraceContext* previous;
+
+public:
+    TraceScope(const TraceContext& context);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    /**
+     * @return context of the innermost scope of the thread, nullptr outside of any scope
+     */
+    static const TraceContext* current();
+};
+
+/**
+ * @brief Samples requests and exports their spans in OTLP JSON format from a background thread
+ *
+ * Spans are queued without blocking, exported in batches of up to MAX_EXPORT_BATCH_SIZE at least every EXPORT_INTERVAL.
+ * When the queue is full new spans are dropped, so slow collector does not slow down inference.
+ */
+class Tracer {
+public:
+    /**
+     * @brief Sends serialized OTLP request, returns false when export failed
+     */
+    using exporter_t = std::function<bool(const std::string&)>;
+
+    static constexpr size_t MAX_QUEUED_SPANS = 8192;
+    static constexpr size_t MAX_EXPORT_BATCH_SIZE = 512;
+    static constexpr std::chrono::milliseconds EXPORT_INTERVAL{1000};
+
+    static Tracer& instance() {
+        static Tracer instance;
+        return instance;
+    }
+
+    Tracer() = default;
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief Enables tracing and starts export thread
+     *
+     * @param exporter
+     * @param samplingRatio part of requests without sampled traceparent which are traced
+     * @param serviceName reported as service.name resource attribute
+     */
+    void configure(exporter_t exporter, double samplingRatio, const std::string& serviceName = "ovms");
+
+    /**
+     * @brief Stops export thread after exporting queued spans
+     */
+    void shutdown();
+
+    bool isEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Creates context of received request, continuing the caller trace when traceparent is valid
+     *
+     * Sampling decision of the caller is respected, requests without traceparent are sampled with sampling ratio.
+     */
+    TraceContext startRequest(std::string_view traceparent);
+
+    void submit(std::unique_ptr<SpanData> span);
+
+    /**
+     * @brief Exports queued spans right away, returns when they are passed to exporter
+     */
+    void flush();
+
+    size_t getDroppedSpansCount() const {
+        return droppedSpansCount.load(std::memory_order_relaxed);
+    }
+
+    static std::string serializeOtlp(const std::vector<std::unique_ptr<SpanData>>& spans, const std::string& serviceName);
+
+private:
+    void run();
+    void exportBatch(std::vector<std::unique_ptr<SpanData>>& batch);
+
+    std::atomic<bool> enabled{false};
+    double samplingRatio = 0.0;
+    std::string serviceName;
+    exporter_t exporter;
+
+    std::mutex queueMtx;
+    std::condition_variable queueCondition;
+    std::condition_variable flushedCondition;
+    std::deque<std::unique_ptr<SpanData>> queue;
+    bool stopRequested = false;
+    bool flushRequested = false;
+    bool exporting = false;
+    std::atomic<size_t> droppedSpansCount{0};
+    std::thread worker;
+};
+
+}  // namespace ovms
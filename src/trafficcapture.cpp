@@ -0,0 +1,215 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "trafficcapture.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace ovms {
+
+namespace {
+const size_t TRAFFIC_LOG_HEADER_SIZE = sizeof(TrafficCapture::TRAFFIC_LOG_MAGIC) + sizeof(uint32_t) + sizeof(uint64_t);
+const size_t RECORD_HEADER_SIZE = sizeof(uint64_t) + sizeof(uint8_t) + sizeof(uint32_t);
+
+void appendLittleEndian(std::string& destination, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        destination.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint64_t readLittleEndian(const char* source, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(source[i])) << (8 * i);
+    }
+    return value;
+}
+
+bool isSampled(double samplingRatio) {
+    if (samplingRatio >= 1.0) {
+        return true;
+    }
+    thread_local std::mt19937_64 generator{std::random_device{}()};
+    return (generator() >> 11) * 0x1.0p-53 < samplingRatio;
+}
+}  // namespace
+
+TrafficCapture::~TrafficCapture() {
+    shutdown();
+}
+
+Status TrafficCapture::configure(const std::string& path, double samplingRatio, uint64_t maxBytes) {
+    shutdown();
+    log.open(path, std::ios::binary | std::ios::trunc);
+    if (!log.is_open()) {
+        SPDLOG_ERROR("Cannot create traffic capture log: {}", path);
+        return StatusCode::FILE_INVALID;
+    }
+    std::string header(TRAFFIC_LOG_MAGIC, sizeof(TRAFFIC_LOG_MAGIC));
+    appendLittleEndian(header, TRAFFIC_LOG_VERSION, sizeof(uint32_t));
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    appendLittleEndian(header, std::chrono::duration_cast<std::chrono::microseconds>(now).count(), sizeof(uint64_t));
+    log.write(header.data(), header.size());
+    this->samplingRatio = std::clamp(samplingRatio, 0.0, 1.0);
+    this->maxBytes = maxBytes;
+    this->writtenBytes = header.size();
+    this->start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        stopRequested = false;
+        queuedBytes = 0;
+    }
+    thread = std::thread(&TrafficCapture::run, this);
+    // sampling settings are published together with enabling
+    enabled.store(true, std::memory_order_release);
+    SPDLOG_INFO("Capturing {}% of predict requests into: {}", this->samplingRatio * 100, path);
+    return StatusCode::OK;
+}
+
+void TrafficCapture::shutdown() {
+    enabled.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        stopRequested = true;
+    }
+    queueCondition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (log.is_open()) {
+        log.close();
+        SPDLOG_INFO("Traffic capture finished, captured requests: {} dropped: {}", getCapturedCount(), getDroppedCount());
+    }
+}
+
+void TrafficCapture::captureSampled(const tensorflow::serving::PredictRequest& request, CapturedTarget target) {
+    if (!isSampled(samplingRatio)) {
+        return;
+    }
+    const auto arrival = std::chrono::steady_clock::now();
+    // space is reserved first, so that requests which would be dropped are not serialized
+    const size_t size = request.ByteSizeLong();
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        if (stopRequested || queuedBytes + size > MAX_QUEUED_BYTES) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queuedBytes += size;
+    }
+    Record record;
+    record.arrivalMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(arrival - start).count();
+    record.target = target;
+    record.reservedBytes = size;
+    const bool serialized = request.SerializeToString(&record.serialized);
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        if (!serialized || stopRequested) {
+            queuedBytes -= size;
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queue.push_back(std::move(record));
+    }
+    queueCondition.notify_one();
+}
+
+void TrafficCapture::run() {
+    std::string header;
+    // queued records are written after shutdown was requested, only the size limit drops them
+    bool sizeLimitReached = false;
+    for (;;) {
+        Record record;
+        {
+            std::unique_lock<std::mutex> lock(queueMtx);
+            queueCondition.wait(lock, [this]() { return stopRequested || !queue.empty(); });
+            if (queue.empty()) {
+                break;
+            }
+            record = std::move(queue.front());
+            queue.pop_front();
+            queuedBytes -= record.reservedBytes;
+        }
+        const uint64_t recordBytes = RECORD_HEADER_SIZE + record.serialized.size();
+        if (sizeLimitReached || writtenBytes + recordBytes > maxBytes) {
+            if (!sizeLimitReached) {
+                SPDLOG_WARN("Traffic capture log reached the size limit of {} bytes, capture is stopped", maxBytes);
+                sizeLimitReached = true;
+                enabled.store(false, std::memory_order_relaxed);
+            }
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        header.clear();
+        appendLittleEndian(header, record.arrivalMicroseconds, sizeof(uint64_t));
+        appendLittleEndian(header, static_cast<uint8_t>(record.target), sizeof(uint8_t));
+        appendLittleEndian(header, record.serialized.size(), sizeof(uint32_t));
+        log.write(header.data(), header.size());
+        log.write(record.serialized.data(), record.serialized.size());
+        writtenBytes += recordBytes;
+        capturedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    log.flush();
+}
+
+Status TrafficLogReader::open(const std::string& path) {
+    log.open(path, std::ios::binary);
+    if (!log.is_open()) {
+        return Status(StatusCode::FILE_INVALID, "cannot open traffic log: " + path);
+    }
+    char header[TRAFFIC_LOG_HEADER_SIZE];
+    if (!log.read(header, sizeof(header)) ||
+        std::memcmp(header, TrafficCapture::TRAFFIC_LOG_MAGIC, sizeof(TrafficCapture::TRAFFIC_LOG_MAGIC)) != 0) {
+        return Status(StatusCode::FILE_INVALID, "not a traffic log: " + path);
+    }
+    const uint64_t version = readLittleEndian(header + sizeof(TrafficCapture::TRAFFIC_LOG_MAGIC), sizeof(uint32_t));
+    if (version != TrafficCapture::TRAFFIC_LOG_VERSION) {
+        return Status(StatusCode::FILE_INVALID, "unsupported traffic log version: " + std::to_string(version));
+    }
+    startMicroseconds = readLittleEndian(header + sizeof(TrafficCapture::TRAFFIC_LOG_MAGIC) + sizeof(uint32_t), sizeof(uint64_t));
+    return StatusCode::OK;
+}
+
+bool TrafficLogReader::next(CapturedRequest& record, Status& status) {
+    status = StatusCode::OK;
+    char header[RECORD_HEADER_SIZE];
+    if (!log.read(header, sizeof(header))) {
+        if (log.gcount() != 0) {
+            status = Status(StatusCode::FILE_INVALID, "traffic log record header is truncated");
+        }
+        return false;
+    }
+    record.arrival = std::chrono::microseconds(readLittleEndian(header, sizeof(uint64_t)));
+    const uint64_t target = readLittleEndian(header + sizeof(uint64_t), sizeof(uint8_t));
+    const uint64_t size = readLittleEndian(header + sizeof(uint64_t) + sizeof(uint8_t), sizeof(uint32_t));
+    if (target > static_cast<uint8_t>(CapturedTarget::PIPELINE)) {
+        status = Status(StatusCode::FILE_INVALID, "traffic log record has unknown target: " + std::to_string(target));
+        return false;
+    }
+    record.target = static_cast<CapturedTarget>(target);
+    std::string serialized(size, '\0');
+    if (!log.read(&serialized[0], size) || !record.request.ParseFromString(serialized)) {
+        status = Status(StatusCode::FILE_INVALID, "traffic log record is truncated or damaged");
+        return false;
+    }
+    return true;
+}
+
+}  // namespace ovms
@@ -0,0 +1,173 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wall"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#pragma GCC diagnostic pop
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Kind of servable captured request was sent to
+ */
+enum class CapturedTarget : uint8_t {
+    MODEL = 0,
+    PIPELINE = 1
+};
+
+struct CapturedRequest {
+    /**
+     * @brief Arrival time since the start of the capture
+     */
+    std::chrono::microseconds arrival{0};
+    CapturedTarget target = CapturedTarget::MODEL;
+    tensorflow::serving::PredictRequest request;
+};
+
+/**
+ * @brief Writes sampled predict requests with their arrival times into a binary log, which can be replayed by load generator.
+ *
+ * The log starts with TRAFFIC_LOG_MAGIC, uint32 format version and uint64 wall clock start of the capture in microseconds
+ * since epoch. Each record holds uint64 arrival in microseconds since the start, uint8 target, uint32 size and serialized
+ * PredictRequest. Numbers are little endian. Requests are serialized on the calling thread and written by a background
+ * thread, records which do not fit into the queue of MAX_QUEUED_BYTES are dropped before serialization so capture never
+ * blocks inference. Records queued before shutdown are written.
+ */
+class TrafficCapture {
+public:
+    static constexpr char TRAFFIC_LOG_MAGIC[8] = {'O', 'V', 'M', 'S', 'C', 'A', 'P', '\0'};
+    static constexpr uint32_t TRAFFIC_LOG_VERSION = 1;
+    static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+    static TrafficCapture& instance() {
+        static TrafficCapture instance;
+        return instance;
+    }
+
+    TrafficCapture() = default;
+    ~TrafficCapture();
+
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    /**
+     * @brief Creates the log and starts writing thread
+     *
+     * @param path of the log, overwritten when exists
+     * @param samplingRatio part of predict requests which are captured
+     * @param maxBytes capture stops when the log reaches this size
+     */
+    Status configure(const std::string& path, double samplingRatio, uint64_t maxBytes);
+
+    /**
+     * @brief Stops writing thread after writing queued records
+     */
+    void shutdown();
+
+    bool isEnabled() const {
+        return enabled.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Queues the request for writing when it is sampled
+     *
+     * @param request with model_spec of the target
+     */
+    void capture(const tensorflow::serving::PredictRequest& request, CapturedTarget target) {
+        if (isEnabled()) {
+            captureSampled(request, target);
+        }
+    }
+
+    uint64_t getCapturedCount() const {
+        return capturedCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getDroppedCount() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Record {
+        uint64_t arrivalMicroseconds;
+        CapturedTarget target;
+        size_t reservedBytes;
+        std::string serialized;
+    };
+
+    void captureSampled(const tensorflow::serving::PredictRequest& request, CapturedTarget target);
+    void run();
+
+    std::atomic<bool> enabled{false};
+    double samplingRatio = 0.0;
+    uint64_t maxBytes = 0;
+    uint64_t writtenBytes = 0;
+    std::chrono::steady_clock::time_point start;
+    std::ofstream log;
+
+    std::mutex queueMtx;
+    std::condition_variable queueCondition;
+    std::deque<Record> queue;
+    // serialized size of queued records, reserved before serialization
+    size_t queuedBytes = 0;
+    bool stopRequested = false;
+    std::thread thread;
+
+    std::atomic<uint64_t> capturedCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+};
+
+/**
+ * @brief Reads records of traffic log written by TrafficCapture
+ */
+class TrafficLogReader {
+public:
+    Status open(const std::string& path);
+
+    /**
+     * @brief Reads next record
+     *
+     * @return false at the end of the log or when the record is damaged, status tells which one
+     */
+    bool next(CapturedRequest& record, Status& status);
+
+    /**
+     * @brief Wall clock start of the capture in microseconds since epoch
+     */
+    uint64_t getStartMicroseconds() const {
+        return startMicroseconds;
+    }
+
+private:
+    std::ifstream log;
+    uint64_t startMicroseconds = 0;
+};
+
+}  // namespace ovms
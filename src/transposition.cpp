@@ -0,0 +1,143 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "transposition.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define OVMS_TRANSPOSITION_SSE
+#endif
+
+namespace ovms {
+
+namespace {
+// 32x32 block of 4 byte values takes 4KB, so source and destination blocks fit into L1 cache
+constexpr size_t BLOCK_SIZE = 32;
+
+template <typename T>
+void transposeBlock(const T* source, T* destination, size_t rows, size_t columns,
+    size_t rowBegin, size_t rowEnd, size_t columnBegin, size_t columnEnd) {
+    for (size_t column = columnBegin; column < columnEnd; column++) {
+        for (size_t row = rowBegin; row < rowEnd; row++) {
+            destination[column * rows + row] = source[row * columns + column];
+        }
+    }
+}
+
+#ifdef OVMS_TRANSPOSITION_SSE
+void transposeBlock(const uint32_t* source, uint32_t* destination, size_t rows, size_t columns,
+    size_t rowBegin, size_t rowEnd, size_t columnBegin, size_t columnEnd) {
+    const size_t rowVectorEnd = rowBegin + (rowEnd - rowBegin) / 4 * 4;
+    const size_t columnVectorEnd = columnBegin + (columnEnd - columnBegin) / 4 * 4;
+    for (size_t row = rowBegin; row < rowVectorEnd; row += 4) {
+        for (size_t column = columnBegin; column < columnVectorEnd; column += 4) {
+            // values are only moved, so float loads keep integer bit patterns intact
+            const float* in = reinterpret_cast<const float*>(source + row * columns + column);
+            __m128 row0 = _mm_loadu_ps(in);
+            __m128 row1 = _mm_loadu_ps(in + columns);
+            __m128 row2 = _mm_loadu_ps(in + 2 * columns);
+            __m128 row3 = _mm_loadu_ps(in + 3 * columns);
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+            float* out = reinterpret_cast<float*>(destination + column * rows + row);
+            _mm_storeu_ps(out, row0);
+            _mm_storeu_ps(out + rows, row1);
+            _mm_storeu_ps(out + 2 * rows, row2);
+            _mm_storeu_ps(out + 3 * rows, row3);
+        }
+    }
+    transposeBlock<uint32_t>(source, destination, rows, columns, rowBegin, rowEnd, columnVectorEnd, columnEnd);
+    transposeBlock<uint32_t>(source, destination, rows, columns, rowVectorEnd, rowEnd, columnBegin, columnVectorEnd);
+}
+#endif
+
+template <typename T>
+void transposeMatrix(const T* source, T* destination, size_t rows, size_t columns) {
+    if (columns == 1) {
+        std::memcpy(destination, source, rows * sizeof(T));
+        return;
+    }
+    if (columns <= 4) {
+        // Few channels, e.g. RGB images: each channel plane is written sequentially
+        for (size_t row = 0; row < rows; row++) {
+            for (size_t column = 0; column < columns; column++) {
+                destination[column * rows + row] = source[row * columns + column];
+            }
+        }
+        return;
+    }
+    for (size_t rowBegin = 0; rowBegin < rows; rowBegin += BLOCK_SIZE) {
+        const size_t rowEnd = std::min(rows, rowBegin + BLOCK_SIZE);
+        for (size_t columnBegin = 0; columnBegin < columns; columnBegin += BLOCK_SIZE) {
+            const size_t columnEnd = std::min(columns, columnBegin + BLOCK_SIZE);
+            transposeBlock(source, destination, rows, columns, rowBegin, rowEnd, columnBegin, columnEnd);
+        }
+    }
+}
+
+template <typename T>
+void transposeImages(const void* source, void* destination, size_t batch, size_t channels, size_t spatialSize) {
+    const T* in = static_cast<const T*>(source);
+    T* out = static_cast<T*>(destination);
+    const size_t imageSize = channels * spatialSize;
+    for (size_t n = 0; n < batch; n++) {
+        transposeMatrix(in + n * imageSize, out + n * imageSize, spatialSize, channels);
+    }
+}
+}  // namespace
+
+void transposeNhwcToNchw(const void* source, void* destination, const std::vector<size_t>& nchwShape, size_t elementSize) {
+    if (nchwShape.size() != 4) {
+        return;
+    }
+    const size_t batch = nchwShape[0];
+    const size_t channels = nchwShape[1];
+    const size_t spatialSize = nchwShape[2] * nchwShape[3];
+    switch (elementSize) {
+    case 1:
+        transposeImages<uint8_t>(source, destination, batch, channels, spatialSize);
+        break;
+    case 2:
+        transposeImages<uint16_t>(source, destination, batch, channels, spatialSize);
+        break;
+    case 4:
+        transposeImages<uint32_t>(source, destination, batch, channels, spatialSize);
+        break;
+    case 8:
+        transposeImages<uint64_t>(source, destination, batch, channels, spatialSize);
+        break;
+    default:
+        break;
+    }
+}
+
+std::vector<size_t> nchwToNhwcShape(const std::vector<size_t>& nchwShape) {
+    if (nchwShape.size() != 4) {
+        return nchwShape;
+    }
+    return {nchwShape[0], nchwShape[2], nchwShape[3], nchwShape[1]};
+}
+
+std::vector<size_t> nhwcToNchwShape(const std::vector<size_t>& nhwcShape) {
+    if (nhwcShape.size() != 4) {
+        return nhwcShape;
+    }
+    return {nhwcShape[0], nhwcShape[3], nhwcShape[1], nhwcShape[2]};
+}
+
+}  // namespace ovms
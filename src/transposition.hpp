@@ -0,0 +1,44 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace ovms {
+
+/**
+ * @brief Transposes NHWC data into NCHW order. Each image is transposed separately as HW x C matrix,
+ * in cache sized blocks. 32 bit values are transposed with SSE 4x4 blocks.
+ *
+ * @param source NHWC data
+ * @param destination buffer of the same size for NCHW data
+ * @param nchwShape shape of the destination
+ * @param elementSize size of a single value in bytes, 1, 2, 4 or 8
+ */
+void transposeNhwcToNchw(const void* source, void* destination, const std::vector<size_t>& nchwShape, size_t elementSize);
+
+/**
+ * @brief Reorders NCHW dimensions into NHWC dimensions
+ */
+std::vector<size_t> nchwToNhwcShape(const std::vector<size_t>& nchwShape);
+
+/**
+ * @brief Reorders NHWC dimensions into NCHW dimensions
+ */
+std::vector<size_t> nhwcToNchwShape(const std::vector<size_t>& nhwcShape);
+
+}  // namespace ovms
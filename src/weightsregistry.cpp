@@ -0,0 +1,151 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#include "weightsregistry.hpp"
+
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <sys/stat.h>
+
+#include "compilednetworkcache.hpp"
+#include "mappedfile.hpp"
+
+namespace ovms {
+
+namespace {
+Status readWeights(const std::string& path, bool mapped, WeightsBuffer& buffer) {
+    if (mapped) {
+        std::shared_ptr<MappedFile> mapping;
+        auto status = MappedFile::map(path, mapping);
+        if (!status.ok()) {
+            return status;
+        }
+        buffer.data = mapping->data();
+        buffer.size = mapping->size();
+        buffer.owner = std::move(mapping);
+        return StatusCode::OK;
+    }
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Cannot open weights file: {}", path);
+        return StatusCode::FILE_INVALID;
+    }
+    const std::streamoff size = file.tellg();
+    if (size <= 0) {
+        SPDLOG_ERROR("Cannot read empty or unreadable weights file: {}", path);
+        return StatusCode::FILE_INVALID;
+    }
+    auto contents = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(contents->data()), size)) {
+        SPDLOG_ERROR("Cannot read weights file: {}", path);
+        return StatusCode::FILE_INVALID;
+    }
+    buffer.data = contents->data();
+    buffer.size = contents->size();
+    buffer.owner = std::move(contents);
+    return StatusCode::OK;
+}
+}  // namespace
+
+WeightsRegistry& WeightsRegistry::instance() {
+    static WeightsRegistry registry;
+    return registry;
+}
+
+Status WeightsRegistry::acquire(const std::string& path, bool mapped, std::shared_ptr<const WeightsBuffer>& weights) {
+    struct stat fileStat;
+    const bool identified = stat(path.c_str(), &fileStat) == 0;
+    file_identity_t identity;
+    if (identified) {
+        identity = file_identity_t{fileStat.st_dev, fileStat.st_ino, fileStat.st_size,
+            static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1'000'000'000 + fileStat.st_mtim.tv_nsec};
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = hashesByFile.find(identity);
+        if (it != hashesByFile.end()) {
+            if (auto alive = findAlive(it->second)) {
+                reusedCount++;
+                SPDLOG_DEBUG("Reusing weights of file: {} already loaded from the same file", path);
+                weights = std::move(alive);
+                return StatusCode::OK;
+            }
+        }
+    }
+    // files are read outside of the lock, so that loads of different models are not serialized
+    auto buffer = std::make_shared<WeightsBuffer>();
+    auto status = readWeights(path, mapped, *buffer);
+    if (!status.ok()) {
+        return status;
+    }
+    weights = share(std::move(buffer), identified ? &identity : nullptr, path);
+    return StatusCode::OK;
+}
+
+std::shared_ptr<const WeightsBuffer> WeightsRegistry::share(std::shared_ptr<WeightsBuffer> buffer) {
+    return share(std::move(buffer), nullptr, "memory");
+}
+
+std::shared_ptr<const WeightsBuffer> WeightsRegistry::share(std::shared_ptr<WeightsBuffer> buffer, const file_identity_t* identity, const std::string& source) {
+    buffer->hash = CompiledNetworkCache::hashBuffer(buffer->data, buffer->size);
+    if (buffer->hash.empty()) {
+        SPDLOG_WARN("Cannot hash weights from: {}, weights will not be shared", source);
+        return buffer;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    removeExpired();
+    if (identity) {
+        hashesByFile[*identity] = buffer->hash;
+    }
+    if (auto alive = findAlive(buffer->hash)) {
+        reusedCount++;
+        SPDLOG_INFO("Weights from: {} are identical to weights already loaded, sharing {} bytes", source, alive->size);
+        return alive;
+    }
+    buffers[buffer->hash] = buffer;
+    return buffer;
+}
+
+std::shared_ptr<const WeightsBuffer> WeightsRegistry::findAlive(const std::string& hash) const {
+    auto it = buffers.find(hash);
+    return it == buffers.end() ? nullptr : it->second.lock();
+}
+
+void WeightsRegistry::removeExpired() {
+    for (auto it = buffers.begin(); it != buffers.end();) {
+        it = it->second.expired() ? buffers.erase(it) : std::next(it);
+    }
+    for (auto it = hashesByFile.begin(); it != hashesByFile.end();) {
+        it = buffers.count(it->second) == 0 ? hashesByFile.erase(it) : std::next(it);
+    }
+}
+
+size_t WeightsRegistry::getReusedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return reusedCount;
+}
+
+size_t WeightsRegistry::getBuffersCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& [hash, buffer] : buffers) {
+        count += buffer.expired() ? 0 : 1;
+    }
+    return count;
+}
+
+}  // namespace ovms
@@ -0,0 +1,101 @@
+//*****************************************************************************
+// Copyright 2020 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//*****************************************************************************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "status.hpp"
+
+namespace ovms {
+
+/**
+ * @brief Weights of IR model kept in memory, either read into the heap or mapped
+ */
+struct WeightsBuffer {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    /** @brief hex encoded SHA-256 of the contents */
+    std::string hash;
+    /** @brief keeps the memory alive */
+    std::shared_ptr<const void> owner;
+};
+
+/**
+ * @brief Shares weights buffers between networks of model versions and models deployed with identical weights files
+ *
+ * Buffers are identified by content hash, so copies of the same file under different paths are deduplicated as well.
+ * The registry holds only weak references, a buffer is released once the last network reading it is unloaded.
+ * Hash of a file is remembered by its device, inode, size and modification time, so loading the same unchanged file
+ * again while its buffer is alive does not read it at all.
+ */
+class WeightsRegistry {
+public:
+    static WeightsRegistry& instance();
+
+    /**
+     * @brief Gets weights buffer with contents of the file, reusing one already held by another network
+     *
+     * @param path
+     * @param mapped map the file instead of reading it into the heap when a new buffer is created
+     * @param weights
+     *
+     * @return Status FILE_INVALID if file cannot be read or is empty
+     */
+    Status acquire(const std::string& path, bool mapped, std::shared_ptr<const WeightsBuffer>& weights);
+
+    /**
+     * @brief Registers weights already in memory, e.g. fetched from cloud storage
+     *
+     * @param buffer without hash set
+     *
+     * @return buffer with identical contents already held by another network, or the given one
+     */
+    std::shared_ptr<const WeightsBuffer> share(std::shared_ptr<WeightsBuffer> buffer);
+
+    /**
+     * @brief Gets number of acquisitions served by an already loaded buffer
+     */
+    size_t getReusedCount() const;
+
+    /**
+     * @brief Gets number of buffers currently alive
+     */
+    size_t getBuffersCount() const;
+
+private:
+    WeightsRegistry() = default;
+
+    using file_identity_t = std::tuple<uint64_t, uint64_t, int64_t, int64_t>;
+
+    std::shared_ptr<const WeightsBuffer> findAlive(const std::string& hash) const;
+
+    std::shared_ptr<const WeightsBuffer> share(std::shared_ptr<WeightsBuffer> buffer, const file_identity_t* identity, const std::string& source);
+
+    void removeExpired();
+
+    mutable std::mutex mutex;
+    std::map<file_identity_t, std::string> hashesByFile;
+    std::map<std::string, std::weak_ptr<const WeightsBuffer>> buffers;
+    size_t reusedCount = 0;
+};
+
+}  // namespace ovms